@@ -0,0 +1,135 @@
+# coding=utf-8
+"""Run the motion benchmark over G-code programs in the simulator.
+
+Build the simulator first (from g2core/: make BOARD=sim), then from this directory:
+
+    python3 benchmark.py                        # the default set, JSON summary on stdout
+    python3 benchmark.py -o base.json           # ...and keep it
+    python3 benchmark.py -b base.json           # compare - exit 1 on a regression
+    python3 benchmark.py ../gcode/gcode_hacdc.h my_job.nc
+    python3 benchmark.py --setup 50             # text mode $ settings, host time per line
+
+Each program is one simulator run. The last line the simulator writes is the {bm:n}
+report (see g2core/benchmark.h). Job time, starvations, queue depth and back-planning are
+simulated and repeat exactly, so they are compared. The exec ISR time (x) is measured on
+the host and only reported.
+
+--setup runs setup_script.txt (a write and a read of each axis and motor setting) the given
+number of times in text mode, and reports the host time per line. It is host time, so it
+is only reported, to be compared by hand between builds on the same machine.
+"""
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SIM = os.path.join(HERE, '..', '..', 'g2core', 'bin', 'sim', 'g2core')
+GCODE = os.path.join(HERE, '..', 'gcode')
+SETUP = os.path.join(HERE, 'setup_script.txt')
+
+DEFAULT_SET = [
+    'gcode_braid_short.h',
+    'gcode_braid2d.h',
+    'gcode_roadrunner.h',
+    'gcode_hacdc.h',
+    'gcode_mudflap.h',
+]
+
+FIELDS = ['t', 'b', 's', 'q', 'x', 'i', 'm']
+
+
+def run(sim, path, max_seconds):
+    proc = subprocess.run([sim, '-m', str(max_seconds), path],
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+    if proc.returncode != 0:
+        raise RuntimeError('%s: simulator exit %d\n%s' % (path, proc.returncode, proc.stderr))
+    for line in reversed(proc.stdout.splitlines()):
+        if line.startswith('{"bm":'):
+            bm = json.loads(line)['bm']
+            return dict((f, bm[f]) for f in FIELDS)
+    raise RuntimeError('%s: no {"bm":...} report' % path)
+
+
+def run_setup(sim, repeats):
+    with open(SETUP) as fp:
+        script = fp.read()
+    lines = script.count('\n') * repeats
+    with tempfile.NamedTemporaryFile('w', suffix='.txt', delete=False) as fp:
+        fp.write('$ej=0\n' + script * repeats)
+        path = fp.name
+    try:
+        proc = subprocess.run([sim, path], stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                              universal_newlines=True)
+    finally:
+        os.unlink(path)
+    if proc.returncode != 0:
+        raise RuntimeError('setup: simulator exit %d\n%s' % (proc.returncode, proc.stderr))
+    errors = proc.stdout.count(' err[')
+    match = re.search(r'([0-9.]+) s host', proc.stderr)
+    if errors or not match:
+        raise RuntimeError('setup: %d lines failed, or no host time\n%s' % (errors, proc.stderr))
+    host_ms = float(match.group(1)) * 1000
+    return {'lines': lines, 'host_ms': host_ms, 'us_per_line': round(host_ms * 1000 / lines, 2)}
+
+
+def compare(name, now, base, tolerance):
+    """Return the regressions of one program against its baseline."""
+    worse = []
+    limit = 1 + tolerance / 100.0
+    for f in ('t', 'i', 'm'):                   # larger is worse, within the tolerance
+        if now[f] > base[f] * limit:
+            worse.append('%s: %s %s -> %s' % (name, f, base[f], now[f]))
+    if now['s'] > base['s']:                    # any new starvation is a regression
+        worse.append('%s: s %s -> %s' % (name, base['s'], now['s']))
+    if now['q'] < base['q']:                    # the queue ran lower than it used to
+        worse.append('%s: q %s -> %s' % (name, base['q'], now['q']))
+    if now['b'] != base['b']:                   # a different job, or a different planner
+        worse.append('%s: b %s -> %s' % (name, base['b'], now['b']))
+    return worse
+
+
+def main():
+    parser = argparse.ArgumentParser(description='g2core motion benchmark')
+    parser.add_argument('files', nargs='*', help='G-code files or Resources/gcode .h programs')
+    parser.add_argument('--sim', default=SIM, help='simulator binary')
+    parser.add_argument('-o', '--output', help='also write the summary to this file')
+    parser.add_argument('-b', '--baseline', help='summary to compare against')
+    parser.add_argument('--tolerance', type=float, default=2.0, help='percent allowed on t, i and m')
+    parser.add_argument('--max-seconds', type=int, default=3600, help='simulated time limit per program')
+    parser.add_argument('--setup', type=int, metavar='N', help='time N passes of the setup script instead')
+    args = parser.parse_args()
+
+    if args.setup:
+        print(json.dumps({'setup': run_setup(args.sim, args.setup)}, indent=2, sort_keys=True))
+        return 0
+
+    files = args.files or [os.path.join(GCODE, f) for f in DEFAULT_SET]
+    summary = {}
+    for path in files:
+        summary[os.path.basename(path)] = run(args.sim, path, args.max_seconds)
+
+    text = json.dumps(summary, indent=2, sort_keys=True)
+    print(text)
+    if args.output:
+        with open(args.output, 'w') as fp:
+            fp.write(text + '\n')
+
+    if args.baseline:
+        with open(args.baseline) as fp:
+            baseline = json.load(fp)
+        worse = []
+        for name, now in sorted(summary.items()):
+            if name in baseline:
+                worse += compare(name, now, baseline[name], args.tolerance)
+        for line in worse:
+            sys.stderr.write('regression ' + line + '\n')
+        return 1 if worse else 0
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+compress_gcode.py - compress a gcode program for use as a compressed xio_flash_file
+
+    python3 compress_gcode.py gcode_mudflap.h > gcode_mudflap_bpe.h
+
+The input is a gcode file, or a header in the form of the others in this directory (the
+string literals of its first array are the program). The output header holds the program
+compressed by byte pair encoding, in gcode_file_bpe[], and its pair table, in
+gcode_file_pairs[]. Use them with:
+
+    make_xio_flash_file(gcode_file_bpe, gcode_file_pairs)
+
+See xio_flash_file in g2core/xio.h for the format. PAIRS and MAX_DEPTH must agree with
+XIO_FLASH_PAIRS and XIO_FLASH_PAIR_DEPTH there.
+"""
+import os
+import re
+import sys
+from collections import Counter
+
+PAIRS = 128         # codes 0x80-0xFF
+MAX_DEPTH = 12      # deepest nesting of pairs the decoder's stack holds
+MIN_COUNT = 4       # a pair must save more than its 2 table bytes
+
+
+def read_program(path):
+    text = open(path).read()
+    if not path.endswith('.h'):
+        return text
+    body = text[text.index('=') + 1:]
+    body = body[:re.search(r'"\s*;', body).end()]
+    body = body.replace('\\\n', '')                         # line continuations
+    program = ''
+    for literal in re.findall(r'"((?:\\.|[^"\\])*)"', body):
+        program += bytes(literal, 'latin-1').decode('unicode_escape')
+    return program
+
+
+def compress(program):
+    data = list(program.encode('ascii'))
+    if any(b >= 0x80 for b in data):
+        raise ValueError('the program must be 7 bit ASCII')
+    depth = [0] * 256
+    pairs = []
+    while len(pairs) < PAIRS:
+        counts = Counter(zip(data, data[1:]))
+        best = None
+        for pair, count in counts.most_common():
+            if count < MIN_COUNT:
+                break
+            if max(depth[pair[0]], depth[pair[1]]) < MAX_DEPTH:
+                best = pair
+                break
+        if best is None:
+            break
+        code = 0x80 + len(pairs)
+        pairs.append(best)
+        depth[code] = max(depth[best[0]], depth[best[1]]) + 1
+        out = []
+        i = 0
+        while i < len(data):
+            if (i + 1 < len(data)) and (data[i] == best[0]) and (data[i + 1] == best[1]):
+                out.append(code)
+                i += 2
+            else:
+                out.append(data[i])
+                i += 1
+        data = out
+    return data, pairs
+
+
+def expand(data, pairs):
+    out = []
+    stack = []
+    for b in data:
+        stack.append(b)
+        while stack:
+            c = stack.pop()
+            if c < 0x80:
+                out.append(c)
+            else:
+                stack.extend(reversed(pairs[c - 0x80]))
+    return bytes(out).decode('ascii')
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ','.join('0x%02x' % b for b in data[i:i + 16]) + ',')
+    return '\n'.join(lines)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    path = sys.argv[1]
+    program = read_program(path)
+    data, pairs = compress(program)
+    if expand(data, pairs) != program:
+        sys.exit('compress_gcode.py: the program does not expand back to itself')
+    table = [b for pair in pairs for b in pair]
+    table += [0] * (PAIRS * 2 - len(table))
+
+    name = os.path.basename(path)
+    print('/* %s - %s compressed by compress_gcode.py - do not edit' % (name.rsplit('.', 1)[0] + '_bpe.h', name))
+    print(' *')
+    print(' * %d bytes of gcode in %d bytes, plus %d bytes of pair table' % (len(program), len(data), len(table)))
+    print(' */')
+    print('const uint8_t PROGMEM gcode_file_pairs[] = {')
+    print(c_bytes(table))
+    print('};')
+    print('const uint8_t PROGMEM gcode_file_bpe[] = {')
+    print(c_bytes(data))
+    print('};')
+
+
+if __name__ == '__main__':
+    main()
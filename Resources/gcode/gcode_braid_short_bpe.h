@@ -0,0 +1,261 @@
+/* gcode_braid_short_bpe.h - gcode_braid_short.h compressed by compress_gcode.py - do not edit
+ *
+ * 8993 bytes of gcode in 3780 bytes, plus 256 bytes of pair table
+ */
+const uint8_t PROGMEM gcode_file_pairs[] = {
+    0x0a,0x4e,0x20,0x58,0x59,0x2d,0x81,0x2d,0x82,0x33,0x80,0x32,0x35,0x2e,0x83,0x31,
+    0x34,0x2e,0x30,0x2e,0x80,0x33,0x80,0x31,0x82,0x32,0x82,0x34,0x37,0x2e,0x83,0x32,
+    0x33,0x2e,0x36,0x2e,0x39,0x2e,0x31,0x2e,0x30,0x30,0x38,0x2e,0x84,0x86,0x32,0x2e,
+    0x8c,0x86,0x35,0x31,0x82,0x35,0x9a,0x89,0x84,0x90,0x84,0x88,0x38,0x37,0x34,0x39,
+    0x36,0x30,0x37,0x37,0x20,0x47,0x35,0x30,0x35,0x39,0x33,0x32,0x83,0x88,0x8f,0x89,
+    0x35,0x32,0x38,0x32,0x34,0x31,0x87,0x88,0x33,0x39,0x81,0x8e,0x31,0x31,0x94,0x30,
+    0x35,0x33,0x36,0x32,0x35,0x37,0x36,0x31,0x8f,0x86,0x36,0x85,0x34,0x38,0x39,0x30,
+    0x34,0x30,0x34,0x33,0x8d,0x92,0x35,0x85,0x36,0x37,0x81,0x93,0x33,0x30,0x87,0x90,
+    0x31,0x37,0x81,0x89,0x34,0x32,0x34,0x37,0x39,0x37,0x8c,0x91,0x36,0x33,0x31,0x33,
+    0x35,0x38,0x36,0x38,0x39,0x33,0x39,0x31,0x87,0x93,0x38,0x34,0x8d,0x95,0x39,0x32,
+    0x83,0x86,0xaf,0x85,0xa2,0x30,0x35,0x34,0x39,0x34,0x37,0x32,0x35,0x35,0x33,0x33,
+    0x8d,0x8e,0x39,0x38,0x36,0x34,0x32,0x32,0x87,0x97,0xa2,0x31,0x36,0x8b,0x31,0x32,
+    0x37,0x33,0x30,0x37,0x83,0x91,0x87,0x89,0x87,0x92,0x8c,0x8e,0x8c,0x88,0x36,0x8a,
+    0x30,0x31,0x38,0x33,0x8d,0x91,0x87,0x95,0x81,0x91,0x8a,0x32,0x38,0x39,0x38,0x31,
+    0x83,0x95,0x87,0x8e,0x8c,0x92,0x8c,0x95,0x38,0x85,0x34,0x36,0x84,0x91,0x84,0x8e,
+    0x30,0x32,0x36,0x39,0x30,0x33,0x84,0x97,0x84,0x93,0xe6,0x39,0x80,0x37,0xd2,0x5a,
+};
+const uint8_t PROGMEM gcode_file_bpe[] = {
+    0x4e,0x31,0x20,0x54,0x31,0x4d,0xb5,0xa2,0xc0,0x8a,0xa2,0x32,0x31,0x20,0x28,0x6d,
+    0x6d,0x29,0x80,0x34,0x20,0x28,0x53,0x38,0xaf,0x29,0x80,0x35,0x20,0x28,0x4d,0x33,
+    0x29,0x80,0x36,0xa2,0xcf,0x58,0x89,0xa5,0x37,0x9c,0xa8,0x31,0x5a,0x2d,0x93,0xaf,
+    0xfe,0xff,0x88,0xaf,0x80,0x38,0x20,0x46,0xa0,0x89,0x30,0x80,0x39,0xdd,0x58,0x89,
+    0xa5,0x37,0x9c,0xa8,0x31,0x8b,0x30,0xdd,0x5a,0x2d,0x93,0xaf,0x8b,0x31,0xc1,0x36,
+    0xd3,0x9c,0xa8,0xde,0x32,0xc1,0xd9,0x30,0x9c,0xb0,0x34,0x8b,0x33,0xbd,0xbe,0x34,
+    0x9c,0xd3,0xde,0x34,0xbd,0xb1,0x36,0x9c,0x35,0xb1,0x8b,0x35,0xbd,0xd4,0x36,0x9c,
+    0xc8,0x30,0x8b,0x36,0x81,0x97,0x32,0xb1,0x9c,0xa0,0x32,0x8b,0x37,0x81,0x97,0xb2,
+    0x34,0x9c,0xb1,0x38,0x8b,0x38,0x81,0x97,0x38,0xa9,0x9c,0x36,0x35,0xde,0x39,0x81,
+    0x90,0x31,0x38,0x35,0x9c,0xc9,0xf4,0x30,0x81,0x90,0xb6,0x33,0x9c,0xd5,0x34,0x85,
+    0x31,0x81,0x90,0xa1,0x35,0x9c,0x37,0xb1,0x85,0x32,0x81,0x88,0x30,0xa0,0x9c,0x38,
+    0x30,0xbb,0x33,0x81,0x88,0x33,0xac,0x9c,0x38,0xa3,0x85,0x34,0x81,0x88,0xb3,0x30,
+    0x9c,0x38,0xd9,0x85,0x35,0x81,0x88,0x9e,0x34,0x9c,0x39,0xa3,0x85,0x36,0x81,0x86,
+    0x31,0xbe,0x9d,0x94,0xbb,0x37,0x81,0x86,0x33,0x37,0x36,0x9d,0x30,0xda,0x85,0x38,
+    0x81,0x86,0xb3,0x34,0x9d,0xdf,0xbb,0x39,0x81,0x86,0x38,0xc2,0x9d,0x31,0xb7,0x8a,
+    0x30,0xec,0x30,0xa0,0x9d,0x32,0xb2,0x8a,0x31,0xec,0x32,0xc9,0x9d,0xa5,0x38,0xed,
+    0xec,0xf5,0x36,0x9d,0xb8,0x32,0x8a,0x33,0xec,0x36,0xa8,0x9d,0xc3,0x39,0x8a,0x34,
+    0xec,0xa9,0x37,0x9d,0x35,0xa4,0x8a,0x35,0xec,0x39,0xb7,0x9d,0x36,0xc2,0x8a,0x36,
+    0xad,0x31,0xaa,0x9d,0xd5,0x38,0x8a,0x37,0xad,0x32,0x38,0x30,0x9d,0x38,0xc0,0x8a,
+    0x38,0xad,0xb8,0x37,0x9d,0xb7,0x39,0x8a,0x39,0xad,0xa8,0x31,0x96,0x94,0x33,0x80,
+    0xb8,0xad,0xb1,0x31,0x96,0x31,0xe8,0x80,0xaa,0xad,0x37,0x30,0x39,0x96,0x32,0xe8,
+    0x80,0xc2,0xad,0x37,0xe9,0x96,0xbe,0x34,0x80,0xb9,0xad,0x38,0xb9,0x96,0xaa,0x30,
+    0x80,0x34,0x34,0xad,0x38,0xb7,0x96,0x99,0x38,0x80,0x34,0x35,0xad,0xcf,0x33,0x96,
+    0xb1,0x39,0x80,0xf5,0xad,0x39,0xc2,0x96,0x37,0xb9,0x80,0xc3,0xad,0xd4,0x36,0x96,
+    0x38,0xa4,0x80,0xb6,0xad,0xca,0x37,0x96,0x39,0xa1,0x80,0x9f,0xad,0xcb,0x34,0xf6,
+    0x30,0xd9,0x80,0xa3,0xad,0x9e,0x36,0xf6,0xdb,0x31,0x80,0x99,0xad,0xa9,0x34,0xf6,
+    0x33,0xc3,0x80,0xa8,0xad,0x37,0xc8,0xf6,0xc3,0x35,0x80,0xb0,0xad,0x36,0xa1,0xf6,
+    0xa0,0x35,0x80,0xd3,0xad,0xc8,0x33,0xf6,0xe0,0x38,0x80,0xd6,0xad,0xc3,0x34,0xf6,
+    0x9e,0x32,0x80,0x35,0x36,0xad,0x33,0xa8,0xf7,0x94,0x39,0x80,0xb2,0xad,0x32,0x31,
+    0x36,0xf7,0x31,0xb6,0x80,0xc8,0xad,0x30,0x36,0x36,0xf7,0x32,0xee,0x80,0xa4,0xec,
+    0xb7,0x33,0xf7,0xb9,0x31,0x80,0xa0,0xec,0xb0,0x36,0xf7,0xd5,0x32,0x80,0xb3,0xec,
+    0xd7,0x33,0xf7,0x9e,0x30,0x80,0xb1,0xec,0xae,0x38,0x84,0x95,0xf8,0x30,0x80,0xc6,
+    0x81,0x86,0x36,0xa3,0x84,0x95,0xa5,0x34,0x80,0xda,0x81,0x86,0xac,0x39,0x84,0x95,
+    0xc3,0x39,0x80,0x36,0x35,0x81,0x86,0xc7,0x35,0x84,0x95,0xc6,0x35,0x80,0x36,0x36,
+    0x81,0x88,0xb2,0x36,0x84,0x95,0x39,0x99,0x80,0xbc,0x81,0x90,0xd7,0x34,0x84,0x92,
+    0xa4,0x38,0x80,0xc9,0x81,0x97,0xc4,0x31,0x84,0x92,0xa1,0x36,0x80,0xf9,0x81,0x97,
+    0xa4,0x39,0x84,0x92,0x39,0xd6,0xfe,0x30,0xbd,0xa9,0x38,0x8d,0x89,0x33,0xc0,0xfe,
+    0x31,0xc1,0x31,0xca,0x8d,0x93,0x30,0xa3,0x80,0xd5,0x83,0x90,0xbe,0x32,0x8d,0x97,
+    0xb0,0x37,0x80,0xe0,0x83,0x90,0x37,0xc3,0x8d,0x97,0xd5,0x33,0xfe,0x34,0xa6,0x31,
+    0xcb,0x8d,0x97,0xb7,0x38,0xfe,0x35,0xd0,0xe1,0x34,0x8d,0x90,0x32,0x37,0x38,0xfe,
+    0x36,0xe2,0x38,0xfa,0x8d,0x88,0x30,0xdf,0x80,0xa1,0x83,0x92,0x39,0xb3,0x8d,0x86,
+    0x34,0xa5,0xfe,0x38,0xe3,0x33,0x31,0x35,0x8d,0x86,0xa0,0x33,0xfe,0x39,0xe3,0x36,
+    0xa4,0x8d,0x86,0xa1,0x33,0x80,0x38,0x30,0xcc,0x33,0xdf,0xea,0x31,0xe1,0x80,0xef,
+    0xcc,0xb1,0x30,0xea,0x32,0xd5,0x80,0xa9,0xcc,0xcb,0x35,0xea,0xb9,0x34,0x80,0xe9,
+    0xdc,0xf5,0x36,0xea,0x37,0xb0,0x80,0xcd,0xdc,0xd5,0x30,0xea,0xb7,0x39,0x80,0x38,
+    0x35,0xdc,0x39,0xa0,0xd8,0x30,0xc6,0x80,0x38,0x36,0xbf,0x31,0x38,0x36,0xd8,0x32,
+    0x31,0x34,0x80,0x9e,0xbf,0xac,0x36,0xd8,0x33,0xda,0x80,0x38,0x38,0xbf,0xa4,0x31,
+    0xd8,0x99,0x30,0x80,0xee,0xbf,0xa1,0x30,0xd8,0x36,0xd3,0x80,0xb7,0xbf,0xca,0x33,
+    0xd8,0x37,0x39,0x36,0x80,0xcb,0xab,0x30,0x38,0x30,0xd8,0xca,0x35,0x80,0xcf,0xab,
+    0x32,0xae,0xce,0xe1,0x31,0x80,0xca,0xab,0xa5,0x36,0xce,0x32,0x30,0x34,0x80,0xd4,
+    0xab,0xc2,0x34,0xce,0xd7,0x34,0x80,0x39,0x35,0xab,0xa3,0x35,0xce,0x34,0xb1,0x80,
+    0x39,0x36,0xab,0xb2,0x30,0xce,0xc8,0x36,0x80,0xc4,0xab,0xb3,0x38,0xce,0x37,0xe1,
+    0x80,0xd9,0xab,0x36,0x9f,0xce,0xa9,0x35,0x80,0x39,0x39,0xab,0x36,0xc6,0xce,0x39,
+    0xb8,0x8b,0x94,0xab,0x36,0xb3,0xba,0x30,0xa8,0x8b,0xe8,0xab,0x36,0xc2,0xba,0x31,
+    0xa0,0x8b,0xf8,0xab,0xa0,0x37,0xba,0x32,0x36,0x35,0x8b,0xfa,0xab,0xd6,0x36,0xba,
+    0x33,0x36,0xde,0x30,0x34,0xab,0xb6,0x38,0xba,0x34,0xda,0x8b,0x30,0x35,0xab,0xb8,
+    0x34,0xba,0x35,0xa4,0x8b,0x30,0x36,0xab,0xbe,0x35,0xba,0x36,0x9f,0x8b,0xe1,0xab,
+    0x31,0xb7,0xba,0xe0,0x37,0x8b,0x30,0x38,0xab,0x30,0xc9,0xba,0xef,0x35,0x8b,0x30,
+    0x39,0xbf,0xca,0x34,0xba,0x38,0xee,0x8b,0x31,0x30,0xbf,0x37,0x9e,0xba,0x39,0xb3,
+    0x8b,0xae,0xbf,0xb1,0x38,0x9b,0xf8,0x39,0x8b,0xdf,0xbf,0x34,0x35,0x36,0x9b,0x30,
+    0xd4,0x8b,0xc7,0xbf,0x32,0xe0,0x9b,0x31,0xd6,0x8b,0x31,0x34,0xbf,0xe1,0x38,0x9b,
+    0x32,0xc7,0x8b,0x31,0x35,0xdc,0x9e,0x32,0x9b,0x32,0xbc,0x8b,0x31,0x36,0xdc,0x36,
+    0xd6,0x9b,0x33,0x31,0x38,0x8b,0xc0,0xdc,0xc2,0x38,0x9b,0x33,0x36,0xde,0x31,0x38,
+    0xdc,0x31,0xb7,0x9b,0xaa,0x30,0x8b,0x31,0x39,0xcc,0xd4,0x34,0x9b,0x34,0xa3,0x8b,
+    0x32,0x30,0xcc,0xc9,0x38,0x9b,0x34,0x9e,0x8b,0x32,0x31,0xcc,0xc2,0x33,0x9b,0xa8,
+    0x30,0x8b,0xdb,0xcc,0x31,0xa3,0x9b,0x35,0x9f,0x8b,0x32,0x33,0xe3,0x9e,0x30,0x9b,
+    0xb2,0x35,0x8b,0x32,0x34,0xe3,0x35,0xa9,0x9b,0xa4,0x37,0x8b,0x32,0x35,0xe3,0x32,
+    0x9e,0x9b,0xb3,0xde,0x32,0x36,0x83,0x92,0x39,0x9e,0x9b,0x36,0xbe,0x8b,0x32,0x37,
+    0x83,0x92,0xc9,0x30,0x9b,0x36,0xaa,0x8b,0x32,0x38,0x83,0x92,0x33,0xc9,0x9b,0x36,
+    0x9f,0x8b,0x32,0x39,0x83,0x92,0x30,0xa8,0x9b,0x36,0xa8,0x8b,0xbe,0xf0,0x37,0xa5,
+    0x9b,0x36,0xa8,0x8b,0x33,0x31,0xf0,0xb8,0x38,0x9b,0x36,0xb6,0x8b,0xa5,0xf0,0x30,
+    0xef,0x9b,0x36,0xb8,0x8b,0xd7,0x83,0x8e,0x37,0x99,0x9b,0xb1,0x38,0x8b,0x33,0x34,
+    0x83,0x8e,0xc2,0x30,0x9b,0xb3,0x33,0x8b,0x33,0x35,0x83,0x8e,0x30,0x9e,0x9b,0xa4,
+    0x34,0x8b,0x33,0x36,0xe2,0x37,0xd3,0x9b,0xb2,0x31,0x8b,0x33,0x37,0xe2,0xc2,0x30,
+    0x9b,0xd3,0x34,0x8b,0x33,0x38,0xe2,0x30,0x9e,0x9b,0x99,0x33,0x8b,0xac,0xd0,0x37,
+    0xd3,0x9b,0xc3,0x39,0x8b,0xb8,0xd0,0xc2,0x34,0x9b,0x34,0xaa,0x8b,0xaa,0xd0,0x30,
+    0x39,0x35,0x9b,0xac,0x39,0x8b,0xc2,0xa6,0x37,0xf9,0x9b,0x33,0xb0,0x8b,0xb9,0xa6,
+    0x34,0xf5,0x9b,0xbe,0x34,0x8b,0x34,0x34,0xa6,0xdf,0x37,0x9b,0x32,0xa3,0x8b,0x34,
+    0x35,0x83,0x90,0x38,0xdf,0x9b,0x31,0xca,0x8b,0xf5,0x83,0x90,0x31,0xd9,0x9b,0x30,
+    0xc9,0x8b,0xc3,0x8f,0x2e,0xee,0x39,0x9b,0xaf,0x8b,0xb6,0x8f,0x2e,0xa0,0x36,0xba,
+    0xcf,0x38,0x8b,0x9f,0x8f,0x2e,0xa5,0x31,0xba,0x38,0xa8,0x8b,0xa3,0x8f,0x2e,0x30,
+    0xb9,0xba,0xa1,0x33,0x8b,0x99,0x87,0x2e,0xa1,0x33,0xba,0x36,0xb7,0x8b,0xa8,0x87,
+    0x2e,0x99,0x31,0xba,0xa0,0x33,0x8b,0xb0,0x87,0x2e,0xe8,0x35,0xba,0xaa,0x39,0x8b,
+    0xd3,0x83,0x89,0x37,0xef,0xba,0xa5,0x32,0x8b,0xd6,0x83,0x89,0x35,0xb2,0xba,0xdb,
+    0x31,0x8b,0x35,0x36,0x83,0x89,0x33,0xb9,0xba,0xae,0xde,0xb2,0x83,0x89,0x31,0xaa,
+    0xba,0x94,0x39,0x8b,0xc8,0xc1,0x30,0xa3,0xce,0x38,0xc4,0x8b,0xa4,0xc1,0x32,0xbe,
+    0xce,0x37,0xe9,0x8b,0xa0,0xc1,0xac,0x38,0xce,0x36,0xda,0x8b,0xb3,0xc1,0x35,0xb0,
+    0xce,0x35,0xb9,0x8b,0xb1,0xc1,0xf9,0x36,0xce,0xaa,0x38,0x8b,0xc6,0xc1,0xa9,0x36,
+    0xce,0x32,0xb7,0x8b,0xda,0xc1,0x39,0xb9,0xce,0x31,0xa4,0x8b,0x36,0x35,0xbd,0x30,
+    0xf5,0xce,0xf8,0x34,0x8b,0x36,0x36,0xbd,0xc7,0x36,0xd8,0x38,0x9e,0x8b,0xbc,0xbd,
+    0x32,0xc7,0xd8,0x37,0x34,0xde,0xc9,0xbd,0x32,0x37,0x35,0xd8,0xa0,0x32,0x8b,0xf9,
+    0xbd,0xa5,0x33,0xd8,0x34,0xd6,0x8b,0x37,0x30,0xbd,0x33,0xb2,0xd8,0xbe,0x38,0x8b,
+    0x37,0x31,0xbd,0x33,0xa1,0xd8,0x31,0xa4,0x8b,0xd5,0xbd,0x33,0xe9,0xd8,0x94,0xde,
+    0xe0,0xbd,0x33,0x37,0x35,0xea,0x38,0x99,0x8b,0x37,0x34,0xbd,0x33,0xb0,0xea,0x36,
+    0xca,0x8b,0x37,0x35,0xbd,0x33,0xc0,0xea,0x35,0xa5,0x8b,0x37,0x36,0xbd,0x32,0xbc,
+    0xea,0x33,0xf9,0x8b,0xa1,0xbd,0x32,0xfa,0xea,0x32,0xfa,0x8b,0x37,0x38,0xbd,0xdf,
+    0x36,0xea,0xfa,0x35,0x8b,0x37,0x39,0xbd,0xfa,0x34,0x8d,0x86,0x38,0xda,0x8b,0x38,
+    0x30,0xc1,0xcf,0x39,0x8d,0x86,0x36,0xcb,0x8b,0xef,0xc1,0xef,0x30,0x8d,0x86,0x99,
+    0x35,0x8b,0xa9,0xc1,0x36,0xa1,0x8d,0x86,0xd7,0x38,0x8b,0xe9,0xc1,0xb0,0x31,0x8d,
+    0x86,0x31,0xb2,0x8b,0xcd,0xc1,0x31,0x39,0x39,0x8d,0x88,0x37,0xcb,0x8b,0x38,0x35,
+    0xc1,0xe8,0x34,0x8d,0x88,0xa0,0x34,0x8b,0x38,0x36,0x83,0x89,0x31,0xcd,0x8d,0x88,
+    0xaa,0xde,0x9e,0x83,0x89,0xb3,0x37,0x8d,0x88,0x30,0xd7,0x8b,0x38,0x38,0x87,0x2e,
+    0xb1,0x34,0x8d,0x90,0x32,0x34,0x35,0x8b,0xee,0x87,0x2e,0xb7,0x33,0x8d,0x90,0x30,
+    0x34,0x34,0x8b,0xb7,0x8f,0x2e,0x31,0xca,0x8d,0x97,0x38,0xaa,0x8b,0xcb,0x8f,0x2e,
+    0x38,0xe8,0x8d,0x97,0x34,0xa5,0x8b,0xcf,0xa6,0xdf,0x35,0x8d,0x93,0xa4,0xde,0xca,
+    0xa6,0xc3,0x35,0x8d,0x93,0x33,0xcd,0x8b,0xd4,0xa6,0x38,0xd7,0x8d,0x93,0xc0,0x31,
+    0x8b,0x39,0x35,0xd0,0x35,0xbc,0x8d,0x89,0x37,0xb9,0x8b,0x39,0x36,0x83,0x8e,0x30,
+    0xd9,0x84,0x92,0x9e,0xde,0xc4,0xe3,0x32,0x39,0x36,0x84,0x95,0xae,0x38,0x8b,0xd9,
+    0xe3,0x36,0xd9,0xf7,0x38,0xc4,0x8b,0x39,0x39,0xcc,0x30,0x39,0x39,0xf7,0xbc,0xb5,
+    0x94,0xcc,0x38,0xd4,0xf7,0x32,0x33,0xbb,0xe8,0xbf,0x34,0xb6,0xf6,0x33,0x35,0xb5,
+    0xf8,0xbf,0xa9,0x35,0xf6,0xc7,0x37,0x85,0xfa,0xab,0x31,0xc4,0x96,0xcb,0x39,0x85,
+    0x30,0x34,0xab,0xcf,0x33,0x96,0xb6,0xbb,0x30,0x35,0x87,0x91,0x32,0x38,0x38,0x9d,
+    0xb1,0xbb,0x30,0x36,0x87,0x91,0xc6,0x36,0x9d,0xac,0xbb,0xe1,0x87,0x91,0xc4,0x33,
+    0x9d,0x31,0x36,0xbb,0x30,0x38,0xf1,0xb3,0x33,0x9c,0x37,0xae,0x85,0x30,0x39,0xf1,
+    0xcb,0x35,0x9c,0xb6,0xb5,0x31,0x30,0xeb,0x32,0x30,0x34,0x9c,0x32,0xb1,0x85,0xae,
+    0xeb,0x37,0xb9,0xfb,0xa9,0x31,0x85,0xdf,0xeb,0x39,0xcf,0xfb,0xa0,0x32,0x85,0xc7,
+    0xe4,0xdb,0x37,0xfb,0x33,0x38,0xb5,0x31,0x34,0xe4,0x34,0xc3,0xfb,0xc0,0x31,0x85,
+    0x31,0x35,0xe4,0x36,0xa8,0xfc,0x39,0xa4,0x85,0x31,0x36,0xe4,0x38,0xb9,0xfc,0x37,
+    0x9f,0x85,0xc0,0xa7,0x30,0xc0,0xfc,0x35,0xb8,0x85,0x31,0x38,0xa7,0xc0,0x36,0xfc,
+    0xd7,0xbb,0x31,0x39,0xa7,0xa5,0x30,0xfc,0xc7,0x31,0x85,0x32,0x30,0xa7,0x34,0xc3,
+    0x84,0x89,0x39,0xbe,0x85,0x32,0x31,0xa7,0x35,0xc8,0x84,0x89,0xe0,0x31,0x85,0xdb,
+    0xa7,0x36,0xb0,0x84,0x89,0xb0,0xbb,0x32,0x33,0xa7,0xe0,0x31,0x84,0x89,0x33,0xaa,
+    0x85,0x32,0x34,0xa7,0x37,0xca,0x84,0x89,0x31,0xa3,0x85,0x32,0x35,0xa7,0xe9,0x38,
+    0xf2,0x39,0xb3,0x85,0x32,0x36,0xa7,0x38,0xbc,0xf2,0xa1,0xb5,0x32,0x37,0xa7,0x9e,
+    0x39,0xf2,0xa4,0x33,0x85,0x32,0x38,0xa7,0x9e,0x35,0xf2,0xaa,0x33,0x85,0x32,0x39,
+    0xa7,0x38,0xd3,0xf2,0x32,0x33,0xb5,0xbe,0xa7,0x38,0xc0,0xf2,0x30,0xb1,0x85,0x33,
+    0x31,0xa7,0x37,0xda,0xf3,0x38,0xcb,0x85,0xa5,0xa7,0xf9,0x35,0xf3,0xd5,0x33,0x85,
+    0xd7,0xa7,0xb3,0x30,0xf3,0x35,0xa4,0x85,0x33,0x34,0xa7,0x99,0x30,0xf3,0xac,0x37,
+    0x85,0x33,0x35,0xa7,0xac,0x34,0xf3,0x32,0xac,0x85,0x33,0x36,0xa7,0x32,0xc6,0xf3,
+    0x30,0xcd,0x85,0x33,0x37,0xa7,0xae,0x37,0xe5,0x39,0xa5,0x85,0x33,0x38,0xe4,0x39,
+    0xb2,0xe5,0x37,0xcd,0x85,0xac,0xe4,0x37,0xa9,0xe5,0x36,0xac,0x85,0xb8,0xe4,0xa4,
+    0x34,0xe5,0x9f,0xf4,0xaa,0xe4,0xac,0x32,0xe5,0x33,0xa0,0x85,0xc2,0xe4,0x31,0xa1,
+    0xe5,0xdb,0xb5,0xb9,0xeb,0x39,0xa3,0xe5,0x30,0x39,0xbb,0x34,0x34,0xeb,0x37,0x31,
+    0x30,0xc5,0x39,0xc9,0x85,0x34,0x35,0xeb,0x34,0xa4,0xc5,0xcd,0xbb,0xf5,0xeb,0x31,
+    0xc4,0xc5,0xd5,0xbb,0xc3,0xf1,0xcf,0x34,0xc5,0xa0,0x39,0x85,0xb6,0xf1,0x36,0xaa,
+    0xc5,0x9f,0x37,0x85,0x9f,0xf1,0x33,0x9f,0xc5,0x33,0xee,0x85,0xa3,0x87,0x91,0xe0,
+    0x37,0xc5,0x31,0xe9,0x85,0x99,0x87,0x91,0xaa,0x39,0xc5,0x30,0x38,0xb5,0xa8,0x87,
+    0x91,0x30,0xd4,0x98,0x39,0xca,0x85,0xb0,0x87,0x86,0x37,0xc6,0x98,0xb7,0x34,0x85,
+    0xd3,0x87,0x86,0xc2,0x36,0x98,0xef,0xf4,0xd6,0x87,0x86,0x30,0xe9,0x98,0xe0,0x37,
+    0x85,0x35,0x36,0xab,0xe0,0x36,0x98,0x36,0xa0,0x85,0xb2,0xab,0x30,0xbe,0x98,0x99,
+    0xb5,0xc8,0xbf,0xbc,0x32,0x98,0x34,0x99,0x85,0xa4,0xbf,0x33,0xc7,0x98,0x33,0xee,
+    0x85,0xa0,0xdc,0x39,0xb0,0x98,0x33,0xa5,0x85,0xb3,0xdc,0xa4,0x31,0x98,0x32,0x37,
+    0xf4,0xb1,0xdc,0x32,0xbe,0x98,0xdb,0xf4,0xc6,0xcc,0x9e,0x30,0x98,0x31,0xa9,0x85,
+    0xda,0xcc,0x99,0x31,0x98,0x31,0xb8,0x85,0x36,0x35,0xcc,0x31,0xd6,0x98,0x31,0xfa,
+    0x85,0x36,0x36,0xe3,0xa9,0x34,0x98,0xe1,0x31,0x85,0xbc,0xe3,0x9f,0x37,0x98,0x30,
+    0xb9,0x85,0xc9,0xe3,0xc0,0x33,0x98,0xe8,0xf4,0xf9,0x83,0x92,0x38,0xb0,0xfd,0x39,
+    0xb5,0x37,0x30,0x83,0x92,0xb0,0x38,0xe6,0xc4,0xf4,0x37,0x31,0x83,0x92,0xdb,0x38,
+    0xfd,0xda,0x85,0xd5,0xf0,0xcf,0x34,0xfd,0xa8,0x85,0xe0,0xf0,0xb1,0x35,0xe6,0xd4,
+    0x34,0x85,0x37,0x34,0xf0,0xd7,0x34,0xfd,0xb8,0x85,0x37,0x35,0xf0,0x30,0x9f,0xfd,
+    0xac,0x85,0x37,0x36,0x83,0x8e,0xa1,0x32,0xfd,0xaa,0x85,0xa1,0x83,0x8e,0xa3,0x34,
+    0xe6,0xd4,0xb5,0x37,0x38,0x83,0x8e,0x32,0xb9,0xfd,0x35,0xbb,0x37,0x39,0xe2,0x39,
+    0xcf,0xfd,0xbc,0x85,0x38,0x30,0xe2,0x37,0xa3,0xfd,0xa9,0x85,0xef,0xe2,0x99,0x38,
+    0x98,0xd1,0xa9,0xe2,0x32,0x39,0x35,0x98,0x30,0xdb,0x85,0xe9,0xe2,0x30,0xcd,0x98,
+    0x30,0xc3,0x85,0xcd,0xd0,0x38,0xe9,0x98,0xe1,0xbb,0x38,0x35,0xd0,0x36,0xd4,0x98,
+    0x31,0x30,0xb5,0x38,0x36,0xd0,0x99,0x37,0x98,0x31,0xb8,0x85,0x9e,0xd0,0x33,0x99,
+    0x98,0x31,0xa1,0x85,0x38,0x38,0xd0,0x31,0xc4,0x98,0x32,0xc0,0x85,0xee,0xd0,0x30,
+    0xb2,0x98,0x32,0xa0,0x85,0xb7,0xa6,0xcf,0x38,0x98,0xbe,0xb5,0xcb,0xa6,0x38,0xc7,
+    0x98,0x33,0x35,0xbb,0xcf,0xa6,0x37,0xae,0x98,0xb8,0x37,0x85,0xca,0xa6,0xb1,0x33,
+    0x98,0x34,0xb3,0x85,0xd4,0xa6,0x35,0xb6,0x98,0x99,0xf4,0x39,0x35,0xa6,0x34,0x9e,
+    0x98,0xb2,0xf4,0x39,0x36,0xa6,0x34,0xac,0x98,0x36,0xaa,0x85,0xc4,0xa6,0xb8,0x36,
+    0x98,0x37,0xe1,0x85,0xd9,0xa6,0x33,0x9e,0x98,0xa1,0xbb,0x39,0x39,0xa6,0x33,0xa9,
+    0x98,0xcd,0x35,0x8a,0x94,0xa6,0xac,0x32,0x98,0xcb,0x38,0x8a,0xe8,0xa6,0xaa,0x36,
+    0x98,0x39,0xd4,0x8a,0xf8,0xa6,0x34,0xd3,0xc5,0x30,0xd5,0x8a,0xfa,0xa6,0xa3,0x36,
+    0xc5,0x31,0xa8,0x8a,0x30,0x34,0xa6,0xb2,0x32,0xc5,0x32,0x33,0x35,0x8a,0x30,0x35,
+    0xa6,0x36,0xb0,0xc5,0xa5,0x30,0x8a,0x30,0x36,0xa6,0x37,0xb6,0xc5,0xb8,0x37,0x8a,
+    0xe1,0xa6,0x38,0xb2,0xc5,0x9f,0xe7,0x30,0x38,0xa6,0xd9,0x30,0xc5,0xc8,0x38,0x8a,
+    0x30,0x39,0xd0,0xae,0x37,0xc5,0xc9,0x31,0x8a,0x31,0x30,0xd0,0x32,0xbc,0xc5,0xa1,
+    0x37,0x8a,0xae,0xd0,0xb9,0x31,0xc5,0x9e,0x34,0x8a,0xdf,0xd0,0x37,0xd9,0xe5,0xe1,
+    0x34,0x8a,0xc7,0xe2,0x94,0x31,0xe5,0x31,0xa1,0x8a,0x31,0x34,0xe2,0x32,0x31,0x36,
+    0xe5,0x32,0xa9,0x8a,0x31,0x35,0xe2,0xc9,0x33,0xe5,0x9f,0xe7,0x31,0x36,0x83,0x8e,
+    0x37,0xd6,0xe5,0x39,0xc2,0x8a,0xc0,0xf0,0x30,0x9f,0xf3,0x30,0xb2,0x8a,0x31,0x38,
+    0xf0,0x33,0xb0,0xf3,0xc0,0x33,0x8a,0x31,0x39,0xf0,0x39,0xb7,0xf3,0xb8,0x39,0xed,
+    0x30,0xe3,0x33,0xb1,0xf3,0x38,0xcb,0xed,0x31,0xe3,0x37,0xb0,0xf2,0xf8,0x34,0x8a,
+    0xdb,0xcc,0x31,0x99,0xf2,0x31,0xc8,0xed,0x33,0xcc,0x39,0xc9,0xf2,0xc2,0x38,0xed,
+    0x34,0xbf,0x36,0xc8,0xf2,0xc4,0x33,0xed,0x35,0xf1,0xae,0x33,0xfc,0x30,0xbc,0xed,
+    0x36,0xf1,0xb0,0x38,0xfc,0x32,0xf8,0xed,0x37,0xf1,0x39,0xa4,0xfc,0xd7,0x37,0xed,
+    0x38,0xeb,0x37,0x38,0x38,0xfc,0xa0,0x34,0xed,0x39,0xa7,0x33,0x37,0x30,0xfb,0xdf,
+    0x37,0x8a,0xbe,0xa7,0x37,0xf5,0xfb,0x32,0xd6,0x8a,0x33,0x31,0x8f,0x93,0xae,0x33,
+    0xfb,0x33,0xa9,0x8a,0xa5,0x8f,0x93,0x38,0xc0,0xfb,0xc6,0x31,0x8a,0xd7,0x8f,0x90,
+    0x30,0xca,0x9c,0xae,0x31,0x8a,0x33,0x34,0x8f,0x90,0x33,0xef,0x9c,0xdb,0xe7,0x33,
+    0x35,0x8f,0x90,0x36,0x35,0x36,0x9c,0x33,0xac,0x8a,0x33,0x36,0x8f,0x88,0x31,0xda,
+    0x9c,0x35,0xa0,0x8a,0x33,0x37,0x8f,0x88,0xac,0x37,0x9c,0x36,0xbc,0x8a,0x33,0x38,
+    0x8f,0x88,0xb3,0x35,0x9c,0xa1,0x32,0x8a,0xac,0xb4,0x94,0x35,0x9c,0xc4,0x34,0x8a,
+    0xb8,0xb4,0x31,0xa1,0x9d,0x30,0xd5,0x8a,0xaa,0xb4,0x33,0xa5,0x9d,0x31,0xbc,0x8a,
+    0xc2,0xb4,0xc3,0x32,0x9d,0x32,0xa4,0x8a,0xb9,0xb4,0xa4,0x35,0x9d,0x33,0x9f,0x8a,
+    0x34,0x34,0xb4,0x37,0xe8,0x9d,0xb9,0xe7,0x34,0x35,0xb4,0x37,0xcb,0x9d,0xa8,0x30,
+    0x8a,0xf5,0xb4,0x38,0xda,0x9d,0xa0,0x31,0x8a,0xc3,0xb4,0xcf,0x30,0x9d,0xbc,0x39,
+    0x8a,0xb6,0xb4,0x39,0xa0,0x9d,0x37,0xd3,0x8a,0x9f,0xb4,0x39,0xa9,0x9d,0xa9,0xe7,
+    0xa3,0xb4,0x39,0x9e,0x9d,0xee,0x35,0x8a,0x99,0xb4,0xc4,0x36,0x9d,0x39,0xb3,0x8a,
+    0xa8,0xb4,0x39,0xb6,0x96,0xf8,0x33,0x8a,0xb0,0xb4,0xb7,0x33,0x96,0x30,0xa9,0x8a,
+    0xd3,0xb4,0x38,0xaa,0x96,0xc7,0x38,0x8a,0xd6,0xb4,0x37,0xc6,0x96,0x31,0xb7,0x8a,
+    0x35,0x36,0xb4,0x36,0xf9,0x96,0x32,0xac,0x8a,0xb2,0xb4,0x35,0xa4,0x96,0x32,0xcd,
+    0x8a,0xc8,0xb4,0xb9,0x33,0x96,0xa5,0x35,0x8a,0xa4,0xb4,0x32,0xcb,0x96,0x33,0xc6,
+    0x8a,0xa0,0xb4,0xc7,0x34,0x96,0xac,0x37,0x8a,0xb3,0x8f,0x88,0x39,0xc6,0x96,0xc2,
+    0x38,0x8a,0xb1,0x8f,0x88,0xa1,0x37,0x96,0x34,0xd6,0x8a,0xc6,0x8f,0x88,0x35,0xa1,
+    0x96,0x34,0xa1,0x8a,0xda,0x8f,0x88,0x33,0xbc,0x96,0x9f,0xe7,0x36,0x35,0x8f,0x88,
+    0x31,0x34,0x34,0x96,0x99,0x31,0x8a,0x36,0x36,0x8f,0x90,0xb7,0x39,0x96,0xa8,0x32,
+    0x8a,0xbc,0x8f,0x90,0x36,0xb3,0x96,0xa8,0x39,0x8a,0xc9,0x8f,0x90,0xb8,0x33,0x96,
+    0x35,0xa5,0x8a,0xf9,0x8f,0x90,0xc7,0x33,0x96,0x35,0xa5,0x8a,0x37,0x30,0x8f,0x97,
+    0x38,0xb0,0x96,0xa8,0x37,0x8a,0x37,0x31,0x8f,0x97,0x35,0xc6,0x96,0x99,0x39,0x8a,
+    0xd5,0x8f,0x97,0x32,0xc6,0x96,0xa3,0xe7,0xe0,0x8f,0x93,0x39,0xd6,0x96,0x9f,0x30,
+    0x8a,0x37,0x34,0x8f,0x93,0xc6,0x38,0x96,0xc3,0x30,0x8a,0x37,0x35,0x8f,0x93,0x33,
+    0xc7,0x96,0x34,0x34,0x35,0x8a,0x37,0x36,0xa7,0xd9,0x31,0x96,0xaa,0xe7,0xa1,0xa7,
+    0x36,0xb9,0x96,0x33,0xcd,0x8a,0x37,0x38,0xa7,0x32,0x39,0x39,0x96,0x33,0xc3,0x8a,
+    0x37,0x39,0xe4,0x39,0x9f,0x96,0xbe,0xe7,0x38,0x30,0xe4,0xa4,0x35,0x96,0x32,0xb3,
+    0x8a,0xef,0xe4,0x32,0x33,0x37,0x96,0x32,0xdf,0x8a,0xa9,0xeb,0x9e,0x35,0x96,0x31,
+    0xc8,0x8a,0xe9,0xeb,0x99,0x31,0x96,0x31,0xe8,0x8a,0xcd,0xeb,0x31,0x34,0x35,0x96,
+    0x30,0xac,0x8a,0x38,0x35,0xf1,0xa1,0x37,0x9d,0xc4,0x33,0x8a,0x38,0x36,0xf1,0x30,
+    0xaa,0x9d,0xa9,0x39,0x8a,0x9e,0x87,0x91,0xbc,0x33,0x9d,0x37,0x99,0x8a,0x38,0x38,
+    0x87,0x91,0xbe,0x36,0x9d,0x36,0xc9,0x8a,0xee,0x87,0x86,0xc8,0x30,0x9d,0x9f,0x31,
+    0x8a,0xb7,0x87,0x86,0xdb,0x32,0x9d,0xac,0xe7,0xcb,0xab,0x38,0xbc,0x9d,0x32,0xc4,
+    0x8a,0xcf,0xab,0xc0,0x32,0x9d,0x30,0x38,0xe7,0xca,0xbf,0x38,0xd7,0x9c,0xc4,0x35,
+    0x8a,0xd4,0xbf,0xa3,0x31,0x9c,0x38,0xa4,0x8a,0x39,0x35,0xbf,0xc0,0x36,0x9c,0x37,
+    0xb8,0x8a,0x39,0x36,0xdc,0x38,0xc8,0x9c,0xb3,0xe7,0xc4,0xdc,0x35,0xb6,0x9c,0xb6,
+    0x38,0x8a,0xd9,0xdc,0x32,0xb6,0x9c,0x33,0xb2,0x8a,0x39,0x39,0xcc,0xbc,0x35,0x9c,
+    0x30,0xa9,0x80,0x34,0x94,0xcc,0xb8,0x34,0xfb,0xca,0x38,0x0a,0x28,0x73,0x74,0x61,
+    0x72,0x74,0x20,0x62,0x6f,0x78,0x65,0x73,0x29,0x85,0xb6,0x35,0xc1,0xaf,0x9c,0x99,
+    0x39,0x85,0xb6,0x36,0xff,0x88,0xd1,0x34,0x9e,0xd2,0x58,0x33,0x8e,0x35,0xa0,0x59,
+    0x31,0x97,0xa5,0x37,0x5a,0x91,0xd1,0xb6,0x38,0xdd,0x5a,0x2d,0x93,0xd1,0xb6,0x39,
+    0xdd,0x59,0x89,0x9e,0xb5,0x9f,0x30,0x81,0x34,0x92,0x30,0xae,0x85,0x9f,0x31,0x20,
+    0x59,0x31,0x97,0xa5,0x37,0x85,0x9f,0x32,0x81,0x33,0x8e,0x35,0xa0,0x85,0x9f,0x33,
+    0xff,0x88,0xd1,0x9f,0x34,0xd2,0x59,0x89,0x9e,0xb5,0x9f,0x35,0xdd,0x5a,0x2d,0x93,
+    0xd1,0x9f,0x36,0xdd,0x82,0x31,0x89,0xb2,0xbb,0x9f,0x37,0x81,0x34,0x92,0x30,0xae,
+    0x85,0x9f,0x38,0x20,0x59,0x89,0x9e,0xb5,0x9f,0x39,0x81,0x33,0x8e,0x35,0xa0,0x85,
+    0x35,0x94,0xff,0x88,0xd1,0xa3,0x31,0xd2,0x58,0x34,0x92,0x30,0xae,0x59,0x31,0x97,
+    0xa5,0x37,0x85,0xa3,0x32,0xdd,0x5a,0x2d,0x93,0xd1,0xa3,0x33,0xdd,0x58,0x35,0x97,
+    0x30,0xcd,0x59,0x31,0x86,0x30,0xae,0x85,0xa3,0x34,0xff,0x88,0xd1,0xa3,0x35,0xd2,
+    0x58,0x34,0x92,0x30,0xae,0x59,0x89,0x9e,0xb5,0xa3,0x36,0xdd,0x5a,0x2d,0x93,0xd1,
+    0xa3,0x37,0xdd,0x58,0x35,0x97,0x30,0xcd,0x59,0x91,0x32,0xc7,0x85,0xa3,0x38,0x20,
+    0x59,0x31,0x86,0x30,0xae,0x85,0xa3,0x39,0x81,0x34,0x90,0x32,0x38,0xb5,0x99,0x30,
+    0x81,0x33,0x8e,0x35,0xa0,0x59,0x31,0x97,0xa5,0x37,0x85,0x99,0x31,0xff,0x88,0xd1,
+    0x99,0x32,0xd2,0x58,0x34,0x92,0x30,0xae,0x82,0x31,0x89,0xb2,0xbb,0x99,0x33,0xdd,
+    0x5a,0x2d,0x93,0xd1,0x99,0x34,0xdd,0x58,0x35,0x97,0x30,0xcd,0x8c,0x2e,0xc8,0xbb,
+    0x99,0x35,0x20,0x59,0x91,0x32,0xc7,0x85,0x99,0x36,0x81,0x34,0x92,0x30,0xae,0x59,
+    0x89,0x9e,0xb5,0x99,0x37,0xff,0x88,0xd1,0x99,0x38,0xff,0x32,0x89,0xd1,0x99,0x39,
+    0xd2,0x58,0x89,0xaf,0x59,0x89,0xd1,0x99,0x39,0xc1,0x36,0xd3,0x9c,0xa8,0xb5,0xa8,
+    0x30,0x20,0x4d,0xbe,
+};
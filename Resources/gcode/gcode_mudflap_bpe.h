@@ -0,0 +1,174 @@
+/* gcode_mudflap_bpe.h - gcode_mudflap.h compressed by compress_gcode.py - do not edit
+ *
+ * 6260 bytes of gcode in 2392 bytes, plus 256 bytes of pair table
+ */
+const uint8_t PROGMEM gcode_file_pairs[] = {
+    0x0a,0x4e,0x20,0x58,0x20,0x59,0x32,0x2e,0x30,0x2e,0x30,0x81,0x35,0x81,0x80,0x31,
+    0x31,0x2e,0x82,0x84,0x33,0x2e,0x82,0x88,0x86,0x8a,0x85,0x8a,0x82,0x83,0x85,0x83,
+    0x86,0x83,0x35,0x34,0x31,0x87,0x35,0x80,0x34,0x37,0x34,0x30,0x85,0x84,0x32,0x36,
+    0x32,0x37,0x89,0x31,0x86,0x84,0x80,0x37,0x32,0x38,0x33,0x30,0x35,0x37,0x80,0x39,
+    0x33,0x39,0x34,0x31,0x35,0x39,0x80,0x36,0x87,0x31,0x33,0x36,0x33,0x38,0x87,0x30,
+    0x35,0x31,0x80,0x32,0x80,0x38,0x33,0x33,0x36,0x37,0x34,0x36,0x34,0x38,0x34,0x39,
+    0x34,0x8b,0x32,0x39,0x31,0x31,0x35,0x38,0x34,0x32,0x80,0x35,0x36,0x38,0x37,0x8b,
+    0x35,0x8b,0x34,0x89,0x35,0x87,0x37,0x39,0x86,0x88,0x32,0x32,0x32,0x30,0x35,0x30,
+    0x36,0x30,0x31,0x89,0x33,0x32,0x33,0x34,0x30,0x8b,0x30,0x20,0x37,0x36,0x35,0x32,
+    0x85,0x88,0x36,0x31,0x8b,0x38,0x8e,0x30,0x38,0x89,0x35,0x89,0x33,0x31,0x39,0x31,
+    0x39,0x37,0x8d,0x36,0x8e,0x37,0x20,0x47,0x32,0x33,0x90,0x38,0x39,0x30,0x32,0x31,
+    0x34,0x34,0x32,0x8b,0x39,0x39,0x35,0x36,0x8e,0x31,0x32,0x89,0x39,0x89,0x35,0x33,
+    0x35,0x8f,0x36,0x36,0x93,0x38,0x92,0x30,0x33,0x87,0x30,0x89,0x34,0x87,0x39,0x38,
+    0x35,0x90,0x8f,0x38,0x33,0x8c,0x35,0x8c,0x30,0x8c,0x32,0x8c,0x8e,0x32,0x91,0x87,
+    0x30,0x36,0x35,0xd3,0x80,0x34,0x37,0x89,0x33,0xa4,0x33,0x89,0x37,0x87,0x39,0x34,
+    0x37,0x80,0x33,0x37,0x31,0x39,0x35,0x8d,0x30,0x8d,0x32,0x8d,0x36,0x33,0x36,0x8d,
+};
+const uint8_t PROGMEM gcode_file_bpe[] = {
+    0x28,0x53,0x75,0x70,0x65,0x72,0x43,0x61,0x6d,0x20,0x56,0x65,0x72,0x20,0x83,0x32,
+    0x61,0x20,0x53,0x50,0x49,0x4e,0x44,0x4c,0x45,0x29,0x87,0xd3,0xbe,0x20,0x28,0x73,
+    0x65,0x74,0x20,0x69,0x6e,0x63,0x68,0x65,0x73,0x20,0x6d,0x6f,0x64,0x65,0x29,0xb5,
+    0xd3,0x95,0xd3,0x31,0x37,0xa7,0x20,0x54,0x31,0x20,0x4d,0xf0,0x0a,0x28,0x4e,0x31,
+    0xf1,0x39,0xc5,0x47,0x85,0x30,0x82,0xc5,0x5a,0x30,0x29,0xa9,0xc5,0x53,0xbf,0x30,
+    0xc5,0x4d,0x30,0x33,0x20,0xa9,0xf1,0x39,0x32,0x81,0x30,0x82,0xc5,0x5a,0xc5,0x28,
+    0x7a,0x65,0x72,0x6f,0x20,0x74,0x61,0x62,0x6c,0x65,0x29,0x80,0x33,0x96,0x30,0xc6,
+    0x89,0x33,0xa1,0x0a,0x28,0x73,0x65,0x74,0x20,0x66,0x65,0x65,0x64,0x20,0x72,0x61,
+    0x74,0x65,0x29,0xf2,0xf1,0x30,0x31,0x20,0x46,0x32,0x35,0x2e,0x30,0xb5,0x96,0xf0,
+    0xb9,0x33,0x97,0xb5,0x9a,0x30,0xc0,0x89,0xb1,0x33,0xa3,0x96,0x30,0x37,0xf3,0x97,
+    0x37,0xa3,0x9a,0xb2,0xc1,0x32,0x9e,0x9b,0x96,0x31,0xaf,0x89,0x32,0xc7,0x9b,0x9a,
+    0x31,0x38,0xcc,0x32,0x35,0xe2,0x96,0x32,0x98,0x89,0x97,0x38,0xaa,0x9a,0x32,0x9e,
+    0x89,0x98,0x31,0x9f,0x96,0xab,0xcd,0x97,0x93,0x39,0x9a,0xa1,0xdd,0x98,0xe3,0x96,
+    0x94,0xb9,0x9c,0x37,0xa7,0x9a,0xaf,0xc1,0x9c,0x39,0xa4,0x96,0xa8,0xf3,0x98,0xf4,
+    0x9a,0x91,0xb9,0x97,0xe4,0x32,0x96,0xb3,0xe5,0x97,0x92,0x32,0x9a,0xa2,0xcd,0x97,
+    0xe4,0x33,0x96,0x36,0x32,0xc1,0x98,0xe6,0x33,0x9a,0x36,0xa2,0x89,0x9d,0x36,0x87,
+    0x34,0x96,0xac,0xf5,0xab,0xba,0x34,0x9a,0xac,0xde,0xa5,0x92,0x35,0x96,0xac,0xcc,
+    0xa6,0x39,0x87,0x35,0x9a,0xac,0xe5,0xb4,0x30,0x87,0x36,0x96,0xac,0xe5,0x34,0xad,
+    0x87,0x36,0x9a,0xb6,0xe5,0x94,0xe6,0x37,0x96,0x37,0x30,0xb9,0xaf,0xf6,0x37,0x9a,
+    0x37,0xc2,0x89,0xa8,0xba,0x38,0x96,0xbb,0xb9,0xdf,0xba,0x38,0x9a,0x38,0x37,0xdd,
+    0x35,0xac,0x87,0x39,0x96,0x39,0xbf,0x89,0xc0,0xe6,0x39,0xbc,0x30,0x33,0xc1,0x36,
+    0x94,0xa9,0x30,0xc8,0x31,0xaf,0x89,0x37,0xbd,0xa9,0x30,0xbc,0x9d,0xcc,0x38,0x91,
+    0xa9,0x31,0xc8,0x34,0x9d,0x89,0xe7,0x34,0xa9,0x31,0xbc,0x34,0x94,0x89,0xe7,0x36,
+    0xa9,0x32,0xc8,0x36,0x9c,0x89,0x38,0xbd,0xa9,0x32,0xbc,0x37,0xc2,0x89,0x37,0x31,
+    0x34,0xa9,0x33,0x8f,0x30,0x30,0xde,0xa6,0x31,0xa9,0x33,0x90,0xb2,0x36,0x89,0x97,
+    0x36,0xa9,0x34,0x8f,0x32,0x9c,0x99,0x9e,0xa9,0x34,0x90,0x9c,0x30,0x99,0xd4,0xa9,
+    0xe0,0xab,0xdd,0x30,0xf7,0xa9,0xe8,0xb4,0xf5,0x30,0x37,0x30,0x80,0x97,0x8f,0xae,
+    0xde,0xf0,0x93,0x97,0x90,0x35,0x9e,0x89,0x30,0xe1,0x80,0x98,0x8f,0x36,0x98,0x89,
+    0x30,0x38,0x34,0x80,0x98,0x90,0x36,0x39,0x33,0x99,0x30,0x39,0x80,0x9c,0x8f,0x37,
+    0x9d,0x99,0xab,0x80,0x9c,0xd5,0x30,0x35,0x99,0xd6,0xa9,0x39,0xe9,0xb1,0x89,0xd7,
+    0x36,0xa9,0x39,0xd5,0x38,0xe5,0xb1,0x31,0x80,0x9d,0xe9,0x38,0xb9,0x9d,0x30,0x80,
+    0x9d,0xd5,0x39,0xcc,0xab,0x32,0x80,0xce,0x8f,0xd6,0xcd,0xa5,0xf8,0xce,0x90,0xcf,
+    0xe5,0x95,0xf8,0xc2,0x8f,0xd6,0xcc,0x34,0xad,0x80,0xc2,0x90,0xd6,0xc1,0xaf,0x93,
+    0xab,0xe9,0xd0,0x89,0xaf,0x93,0xab,0xd5,0xd6,0x89,0xc7,0x34,0x80,0xc3,0xe9,0xb4,
+    0x89,0xc0,0x34,0x80,0xc3,0xd5,0x31,0xb9,0xe1,0x93,0x33,0xe0,0xbb,0xb9,0x37,0xbf,
+    0x80,0x33,0xe8,0xbb,0xc1,0x38,0xa6,0x80,0xa5,0xe9,0x31,0xde,0x39,0xc6,0x80,0xa5,
+    0xd5,0x33,0xb7,0x30,0xd8,0x80,0xf9,0xe9,0x36,0xd9,0xb2,0x32,0x80,0xf9,0xd5,0x37,
+    0xb7,0x31,0x34,0x93,0xa6,0x8f,0xcf,0xd9,0xd7,0xf8,0xa6,0x90,0xcf,0xb7,0x32,0x97,
+    0x80,0xa0,0x8f,0x39,0xa8,0x8b,0x9c,0x31,0x80,0xa0,0x90,0xd0,0xc4,0xb1,0x93,0x95,
+    0x8f,0xda,0x36,0x8b,0xb1,0x93,0x95,0x8c,0x30,0x31,0x33,0x8b,0x98,0x93,0xa1,0x8d,
+    0x30,0x32,0xb0,0x32,0x91,0x80,0xa1,0x8c,0x30,0x37,0xc4,0x31,0xa8,0x80,0xb4,0x8d,
+    0x30,0x37,0xb7,0x31,0xc3,0x80,0xb4,0x8c,0x31,0x32,0xb8,0x30,0xa0,0xf2,0x33,0x8d,
+    0x31,0xa6,0x8b,0x30,0xfa,0xf2,0xea,0xbe,0xcd,0xd6,0x38,0x80,0xd8,0x8d,0x9c,0xdd,
+    0xbb,0xf8,0xd8,0x8c,0xa5,0xc1,0x36,0xcf,0xf2,0xfb,0x34,0x97,0x89,0xa2,0x32,0xf2,
+    0xeb,0x34,0xdb,0x89,0x91,0x33,0x80,0xad,0x8d,0x94,0xde,0xaf,0x33,0x80,0xad,0x8c,
+    0xaf,0xb9,0x94,0x32,0x80,0x94,0x8d,0xbf,0xcd,0x34,0xad,0x80,0x94,0x8c,0xa8,0xcc,
+    0xa1,0xf8,0xae,0x8d,0x35,0x9d,0x89,0xa0,0x31,0x80,0xae,0x8c,0xdb,0xb9,0x9d,0x30,
+    0x80,0xaf,0x8d,0x9e,0xf3,0x32,0xdf,0x80,0xaf,0x8c,0x35,0xb6,0x89,0xd7,0x32,0xb5,
+    0xfc,0x91,0x34,0x99,0xc6,0xb5,0xec,0x91,0x31,0x99,0xad,0x80,0xa8,0x8d,0x35,0xdf,
+    0x99,0xfa,0x80,0xa8,0x8c,0x9e,0x36,0x99,0xf0,0xb5,0xfd,0xa2,0x37,0x99,0x30,0x32,
+    0xb5,0xed,0xc9,0x38,0x99,0x30,0x39,0xb5,0x33,0xd1,0xa0,0x99,0xb1,0xb5,0xea,0x36,
+    0xbf,0x99,0xa2,0x80,0x91,0xd1,0xfe,0x99,0x37,0x38,0x80,0x91,0x8c,0xac,0x38,0x99,
+    0x39,0x32,0xb5,0x35,0xd1,0xda,0x99,0xd0,0xb5,0xeb,0x37,0xd4,0x99,0x39,0x36,0xb5,
+    0xff,0xc6,0x34,0x99,0xbb,0xb5,0x36,0x8c,0x38,0x30,0x35,0x99,0x36,0x93,0x9e,0x8d,
+    0x38,0x38,0x34,0x99,0xa2,0x80,0x9e,0x8c,0x39,0xaf,0x99,0x36,0x93,0xb3,0x8d,0x39,
+    0xe1,0x99,0x37,0x93,0xb3,0x8c,0xd0,0x38,0x99,0xf7,0x80,0xa2,0x8d,0xd0,0xcc,0xbd,
+    0x33,0x80,0xa2,0x8c,0x39,0xc0,0x89,0x32,0x34,0x93,0xc0,0x8d,0x38,0x33,0xb9,0x33,
+    0xb2,0xa3,0xec,0xc6,0xdd,0xc3,0x93,0xc9,0x8d,0x37,0x97,0x89,0xa6,0x39,0xa3,0x31,
+    0x8c,0x37,0x30,0xf5,0x34,0xb3,0xa3,0xfd,0xb6,0xdd,0x35,0x9d,0xa3,0xed,0xac,0xde,
+    0x35,0xc3,0xa3,0x33,0xd1,0x97,0x89,0xb6,0x31,0xa3,0xea,0x35,0xb6,0x89,0x38,0x9c,
+    0xa3,0x34,0x8d,0xd8,0xb0,0x30,0x38,0x30,0xa3,0x34,0x8c,0x95,0xb8,0x31,0xac,0xa3,
+    0xfb,0x95,0xb0,0x31,0xac,0xa3,0xeb,0xa6,0xb7,0xbe,0x38,0xa3,0xff,0xa6,0xb0,0xbe,
+    0x38,0xa3,0x36,0x8c,0xa5,0xb8,0x97,0x93,0xac,0x8d,0x33,0x35,0xb8,0x9c,0x93,0xac,
+    0x8c,0x33,0xae,0x8b,0x9d,0x38,0xa3,0x38,0x8d,0xab,0x33,0x8b,0x33,0xbf,0xa3,0x38,
+    0x8c,0xc2,0x31,0x8b,0xa0,0x31,0xa3,0x39,0x8d,0x33,0xb2,0x8b,0x34,0x9c,0xa3,0x39,
+    0x8c,0x33,0xa0,0x8b,0xb4,0x33,0x9b,0xfc,0x34,0x95,0x8b,0x95,0x36,0x9b,0xec,0xa8,
+    0xc4,0x95,0x38,0x9b,0x31,0x8d,0xb3,0xb8,0xb4,0x31,0x9b,0x31,0x8c,0x36,0xb2,0x8b,
+    0x34,0xa0,0x9b,0x32,0xd1,0xb2,0x8b,0x34,0xa1,0x9b,0xed,0xc9,0xb8,0x34,0xa1,0x9b,
+    0x33,0xd1,0xa5,0x8b,0xae,0x38,0x9b,0xea,0xfe,0xb0,0xa8,0x37,0x9b,0x34,0xd1,0xbd,
+    0x8b,0x91,0x33,0x9b,0x34,0x8c,0xc0,0xb8,0xdb,0x33,0x9b,0xfb,0x9e,0x36,0x8b,0x9e,
+    0x93,0x37,0xeb,0x91,0xb0,0xb3,0x31,0x9b,0xff,0x94,0x39,0x8b,0xa2,0x32,0x9b,0x36,
+    0x8c,0x34,0xa8,0x8b,0xa2,0x38,0x9b,0x37,0x8d,0xa6,0xb7,0x36,0x97,0x9b,0x37,0x8c,
+    0xa0,0xc4,0x36,0xa5,0x9b,0x38,0x8d,0x35,0xc2,0x8b,0xc0,0x32,0x9b,0x38,0x8c,0xc0,
+    0x31,0x8b,0xa2,0x37,0x9b,0x39,0xd1,0xb6,0x8b,0xa2,0x38,0x9b,0x39,0x8c,0x37,0x38,
+    0xd9,0xc9,0x32,0xaa,0xfc,0xbb,0xb0,0xc9,0x38,0xaa,0xec,0x38,0xb6,0x8b,0x36,0xa5,
+    0xaa,0x31,0x8d,0xcf,0x38,0x8b,0x36,0x35,0xe2,0x31,0x8c,0xf7,0xb8,0x36,0xac,0xaa,
+    0xfd,0x39,0x36,0xb0,0xb6,0xe2,0xed,0x39,0xac,0x8b,0xb6,0xe2,0x33,0x8d,0xd0,0xb0,
+    0x36,0xda,0xaa,0xea,0xe7,0xb0,0x37,0x32,0xe2,0x34,0x8d,0xe7,0xb0,0x37,0xb3,0xaa,
+    0x34,0x8c,0xd0,0xc4,0xbb,0x30,0xaa,0xfb,0xf7,0xb8,0x38,0x31,0x37,0xaa,0xeb,0xcf,
+    0x38,0xca,0x97,0xaa,0xff,0x38,0xcf,0xca,0x98,0xaa,0x36,0x8c,0x38,0xb4,0xca,0x30,
+    0x39,0xaa,0x37,0x8d,0xbb,0x38,0x8b,0x37,0x38,0x34,0xaa,0x37,0x8c,0x37,0xad,0x8b,
+    0x37,0x37,0x32,0xaa,0x38,0xd1,0xe7,0x8b,0xc6,0x34,0xaa,0x38,0x8c,0xfe,0xb8,0xc6,
+    0x36,0xaa,0x39,0x8d,0x35,0xdf,0x8b,0x37,0x38,0xe2,0x39,0x8c,0x94,0x38,0xca,0xbe,
+    0x9f,0xfc,0x95,0x39,0xca,0x36,0x34,0x9f,0xec,0xc3,0xb8,0xcf,0x38,0x9f,0x31,0x8d,
+    0x97,0x34,0xcb,0xd4,0x9f,0x31,0x8c,0x32,0xae,0xcb,0xa8,0x9f,0xfd,0x32,0x95,0xcb,
+    0x38,0x31,0x9f,0xed,0xce,0x36,0xcb,0x38,0x36,0x9f,0x33,0x8d,0xa0,0x30,0xdc,0x30,
+    0x34,0x9f,0xea,0xa1,0x34,0xdc,0xd7,0x9f,0x34,0x8d,0x34,0xce,0xdc,0xdf,0x9f,0x34,
+    0x8c,0x34,0xab,0xdc,0x38,0x30,0x9f,0xfb,0x34,0x98,0x8e,0xbe,0x93,0x39,0xeb,0xa1,
+    0x33,0x8e,0xbd,0x34,0x9f,0xff,0xa0,0x32,0xee,0xb4,0x9f,0x36,0x8c,0xab,0x35,0xee,
+    0xd8,0x9f,0x37,0x8d,0x98,0x38,0xee,0xa5,0x9f,0x37,0x8c,0x32,0xdb,0xee,0xb4,0x9f,
+    0x38,0x8d,0x32,0xa0,0xee,0xa8,0x9f,0x38,0x8c,0x32,0xb2,0x8e,0x9c,0x30,0x9f,0x39,
+    0x8d,0x31,0x37,0x34,0x8e,0x33,0xdb,0x9f,0x39,0x8c,0x31,0xa2,0x8e,0xa0,0x37,0xa7,
+    0xfc,0x31,0xbf,0x8e,0x34,0xa6,0xa7,0xec,0x31,0x95,0x8e,0xae,0xe3,0x31,0x8d,0x31,
+    0xc2,0x8e,0xa8,0x30,0xa7,0x31,0x8c,0xb2,0x38,0x8e,0x91,0x33,0xa7,0xfd,0x30,0xda,
+    0x8e,0x9e,0x36,0xa7,0xed,0x30,0xa8,0x8e,0xfe,0xe3,0x33,0x8d,0x30,0x30,0x33,0x8e,
+    0xe1,0x36,0xa7,0x33,0x90,0x39,0x9e,0x8e,0xb6,0x35,0xa7,0x34,0x8f,0xd6,0x37,0x8e,
+    0x36,0xda,0xa7,0x34,0xd5,0xc0,0xd2,0x31,0xe3,0xe0,0x38,0xfa,0xd2,0x98,0xa7,0xe8,
+    0x37,0xb6,0xd2,0x34,0x35,0xa7,0x36,0x8f,0x37,0x31,0x36,0xd2,0x9e,0xa7,0x36,0x90,
+    0xac,0x35,0xd2,0x9e,0xa7,0x37,0x8f,0x9e,0x39,0xd2,0x33,0xe3,0x37,0x90,0x9e,0x30,
+    0xd2,0xd4,0xa7,0x38,0x8f,0x35,0xa2,0xd2,0xbe,0xa7,0x38,0x90,0x35,0x9d,0xd2,0x30,
+    0xe3,0x39,0x8f,0xbf,0x31,0x8e,0x36,0x39,0x33,0xa7,0x39,0x90,0x94,0x31,0x8e,0xb6,
+    0xf4,0x30,0x8f,0xd8,0x33,0x8e,0x36,0xb6,0xa4,0x30,0x90,0xa0,0x36,0x8e,0x36,0xc3,
+    0xa4,0x31,0x8f,0x33,0x91,0x8e,0xa2,0x92,0xb2,0x90,0x33,0xc7,0x8e,0xa2,0x92,0x31,
+    0x32,0x8f,0xc2,0x35,0x8e,0x91,0xf4,0x32,0x90,0xce,0x35,0x8e,0xc7,0x92,0x31,0x33,
+    0x8f,0x9d,0x37,0x8e,0xaf,0x38,0xa4,0x33,0x90,0xb1,0x36,0x8e,0xad,0x34,0xa4,0x34,
+    0x8f,0xb1,0x33,0x8e,0x34,0x98,0xa4,0x34,0x90,0xb1,0x35,0x8e,0xa5,0x36,0xa4,0xe0,
+    0xc2,0x31,0x8e,0x9d,0xf4,0xe8,0x33,0xb3,0xee,0x94,0xa4,0x36,0x8f,0xa1,0x39,0x8e,
+    0xbe,0xf4,0x36,0x90,0xa1,0x39,0xdc,0xbb,0xa4,0x37,0x8f,0x95,0x35,0xdc,0xb3,0xa4,
+    0x37,0x90,0xa5,0x32,0xdc,0xd4,0xa4,0x38,0x8f,0x33,0x91,0xdc,0x30,0x34,0xa4,0x38,
+    0x90,0x33,0x91,0xcb,0x39,0x92,0xfa,0x8f,0xa6,0x30,0xcb,0x36,0x35,0xa4,0x39,0x90,
+    0xa1,0x30,0xcb,0x35,0x92,0xbe,0x8f,0xa1,0x30,0xcb,0x94,0x87,0xbe,0x90,0x95,0x35,
+    0xcb,0x9c,0x87,0xd7,0x8f,0x95,0x38,0xcb,0x31,0x30,0x87,0xd7,0x90,0xa1,0x36,0x8b,
+    0xda,0xba,0xbd,0x8f,0x34,0xab,0x8b,0xe7,0x32,0x87,0xbd,0x90,0x34,0xa6,0x8b,0x39,
+    0x36,0xe4,0xd4,0x8f,0x34,0x94,0x8b,0x39,0xae,0x87,0xd4,0x90,0xad,0x31,0x8b,0x39,
+    0xa6,0x87,0x32,0x34,0x8f,0xae,0xc4,0x39,0x33,0x92,0x32,0x34,0x90,0x94,0x38,0xca,
+    0xda,0x87,0x32,0xe0,0xae,0xb7,0x38,0x37,0xba,0x32,0xe8,0xbf,0xb0,0x38,0xef,0x97,
+    0x8f,0x35,0x98,0xca,0xae,0x87,0x97,0x90,0x91,0x39,0xca,0xaf,0x87,0x98,0x8f,0x9e,
+    0xb7,0x38,0x36,0x92,0x98,0x90,0xc0,0xb0,0x38,0xe1,0x87,0x9c,0x8f,0x36,0xce,0xca,
+    0xef,0x9c,0x90,0x36,0x95,0xca,0x98,0x87,0xb1,0x8f,0x36,0x95,0x8b,0xbb,0x32,0x87,
+    0xb1,0x90,0x36,0xb1,0x8b,0x37,0xa2,0x87,0x9d,0x8f,0xc9,0xd9,0x37,0x98,0x87,0x9d,
+    0x90,0x9e,0x36,0x8b,0x36,0x39,0xe6,0xce,0x8f,0x35,0xa5,0x8b,0xe1,0x32,0x87,0xce,
+    0x90,0x94,0xc4,0xc9,0x36,0x87,0xc2,0x8f,0xc3,0xb8,0x35,0x35,0x92,0xc2,0x90,0x9d,
+    0xb7,0xc7,0x92,0xab,0x8f,0x97,0xc4,0xae,0x32,0x87,0xab,0x90,0x32,0x34,0x33,0x8b,
+    0x94,0xf6,0xc3,0x8f,0x32,0x9c,0x8b,0xad,0x39,0x87,0xc3,0x90,0xbd,0xd9,0x34,0xae,
+    0x87,0x33,0xe0,0x32,0x9c,0x8b,0xb4,0xba,0x33,0xe8,0x32,0x91,0x8b,0x95,0xba,0xa5,
+    0x8f,0x97,0x38,0x8b,0xf9,0xe4,0xa5,0x90,0x98,0x39,0x8b,0x33,0xb4,0x87,0xf9,0x8f,
+    0x9d,0x38,0x8b,0x9c,0xf6,0xf9,0x90,0x33,0x95,0x8b,0x32,0xef,0xa6,0x8f,0x95,0xb7,
+    0xbe,0x92,0xa6,0x90,0x34,0xa1,0x8b,0x31,0xdb,0x87,0xa0,0x8f,0x34,0x91,0x8b,0x31,
+    0x33,0x92,0xa0,0x90,0xad,0xc4,0x31,0xf0,0x87,0x95,0x8f,0xad,0xb0,0x31,0x30,0x32,
+    0x87,0x95,0x90,0x94,0x31,0x8b,0x30,0xa5,0x87,0xa1,0x8f,0xad,0x36,0x89,0xd0,0x92,
+    0xa1,0x90,0x34,0xa8,0x89,0x38,0xd0,0x87,0xb4,0x8f,0xa1,0xcd,0xbb,0x92,0xb4,0x90,
+    0x95,0xf5,0x37,0xac,0x87,0x34,0x33,0x8f,0xa6,0xcc,0xc6,0xba,0x34,0x33,0x90,0x9d,
+    0x36,0x89,0x38,0x34,0x92,0xd8,0x8f,0xbd,0xdd,0xcf,0x92,0xd8,0x90,0xb2,0xb9,0xda,
+    0xba,0x34,0xe0,0x30,0x30,0xd9,0x30,0xc6,0x87,0x34,0x35,0xbc,0xd6,0xb8,0x31,0xa0,
+    0x87,0xad,0xc8,0x37,0x91,0x8b,0xbd,0xe4,0xad,0xbc,0xfe,0xb7,0x98,0x38,0x87,0x94,
+    0xc8,0xb3,0xd9,0x9d,0x92,0x94,0xbc,0x35,0xb3,0x8b,0xce,0xba,0xae,0xc8,0xad,0xc4,
+    0x33,0xc7,0x87,0xae,0xbc,0xa0,0x39,0x8b,0xa5,0x30,0x87,0xaf,0xc8,0x33,0xa6,0x8b,
+    0x33,0xef,0xaf,0xbc,0x9c,0xb7,0x33,0xb1,0x87,0xbf,0xc8,0x32,0xae,0x8b,0xb1,0xe6,
+    0xbf,0xbc,0xd7,0xb7,0x32,0xef,0xa8,0xc8,0xd7,0xb0,0x32,0xc7,0x87,0xa8,0xbc,0x31,
+    0x37,0xd9,0xfa,0xba,0xc7,0xc8,0x31,0x9c,0x8b,0x31,0xa0,0x87,0xc7,0xbc,0xb2,0xc4,
+    0xb2,0xf6,0xdf,0x96,0x39,0xb3,0x89,0xf7,0x92,0xdf,0x9a,0x38,0x39,0xc1,0x38,0x37,
+    0xe4,0x91,0x96,0x38,0x32,0xcd,0x38,0x30,0x38,0x87,0x91,0x9a,0x37,0x35,0xcd,0x37,
+    0x94,0x87,0x35,0x35,0x96,0xc9,0xde,0x36,0xab,0x87,0x35,0x35,0x9a,0x94,0xf3,0x35,
+    0x97,0x87,0xdb,0x96,0x94,0xf3,0xc7,0xe6,0xdb,0x9a,0xa1,0xc1,0x94,0x36,0x87,0x9e,
+    0x96,0xab,0xc1,0x34,0xef,0x9e,0x9a,0x98,0xcc,0x34,0x98,0x87,0xb3,0x96,0xd4,0xc1,
+    0xa0,0xf6,0xb3,0x9a,0x31,0x38,0xf5,0x33,0xbb,0x87,0xa2,0x96,0x31,0x33,0xcd,0xa5,
+    0xba,0xa2,0x9a,0x30,0xc6,0x89,0xc3,0x92,0xc0,0xf1,0x30,0xc5,0x46,0x33,0x84,0x30,
+    0x87,0xc9,0xc5,0x4d,0x30,0x35,0x20,0x87,0xc9,0xf1,0x39,0x85,0x30,0x82,0xc5,0x5a,
+    0xc5,0x4d,0x9d,0x0a,0x28,0x45,0x6e,0x64,0x20,0x6f,0x66,0x20,0x43,0x4e,0x43,0x20,
+    0x50,0x72,0x6f,0x67,0x72,0x61,0x6d,0x29,
+};
@@ -0,0 +1,166 @@
+/*
+ * adaptive.cpp - adaptive feedrate control from a load signal
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "adaptive.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "temperature.h"
+#include "text_parser.h"
+#include "util.h"
+
+afSingleton_t af;
+
+/*
+ * _apply() - pass the M50 factor times the adaptive factor to the override ramp
+ */
+
+static void _apply()
+{
+    if (!cm->gmx.m48_enable) {
+        return;
+    }
+    float base = cm->gmx.mfo_enable ? cm->gmx.mfo_factor : 1.0;
+    float target = min(max(base * af.factor, (float)FEED_OVERRIDE_MIN), (float)FEED_OVERRIDE_MAX);
+    if (fabs(target - af.applied) > AF_FACTOR_DEADBAND) {
+        af.applied = target;
+        mp_start_feed_override(FEED_OVERRIDE_RAMP_TIME, target);
+    }
+}
+
+/*
+ * adaptive_reset() - return the adaptive factor to 1.0 - called by temperature_reset()
+ */
+
+void adaptive_reset()
+{
+    af.load = 0;
+    af.factor = 1.0;
+    af.applied = 1.0;
+}
+
+/*
+ * adaptive_feed_update() - run the load loop one PID tick of dt seconds
+ *
+ *  Called from temperature_callback() once the sensors have been sampled.
+ */
+
+void adaptive_feed_update(const float dt)
+{
+    if (af.input == 0) {
+        return;
+    }
+    af.load = temperature_get_load(af.input);
+
+    if (cm->machine_state != MACHINE_CYCLE) {
+        if (af.factor != 1.0) {                 // the next cycle starts from the programmed feed
+            af.factor = 1.0;
+            _apply();
+        }
+        return;
+    }
+    if ((cm->motion_state != MOTION_RUN) || (cm->hold_state != FEEDHOLD_OFF) ||
+        (cm_get_motion_mode(RUNTIME) == MOTION_MODE_STRAIGHT_TRAVERSE)) {
+        return;                                 // the load means nothing unless a feed is cutting
+    }
+    float error = (af.set_point - af.load) / af.set_point;
+    af.factor = min(max(af.factor + af.gain * error * dt, af.factor_min), af.factor_max);
+    _apply();
+}
+
+static stat_t _adaptive_restart()               // after a config change
+{
+    af.factor = min(max(af.factor, af.factor_min), af.factor_max);
+    if (af.input == 0) {
+        af.factor = 1.0;
+    }
+    _apply();
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+stat_t af_get_afi(nvObj_t *nv) { return (get_integer(nv, af.input)); }
+stat_t af_get_afs(nvObj_t *nv) { return (get_float(nv, af.set_point)); }
+stat_t af_get_afg(nvObj_t *nv) { return (get_float(nv, af.gain)); }
+stat_t af_get_afn(nvObj_t *nv) { return (get_float(nv, af.factor_min)); }
+stat_t af_get_afx(nvObj_t *nv) { return (get_float(nv, af.factor_max)); }
+stat_t af_get_afl(nvObj_t *nv) { return (get_float(nv, af.load)); }
+stat_t af_get_aff(nvObj_t *nv) { return (get_float(nv, af.factor)); }
+
+stat_t af_set_afi(nvObj_t *nv)
+{
+    int32_t input;
+    ritorno(set_int32(nv, input, 0, HEATERS));
+    af.input = input;
+    return (_adaptive_restart());
+}
+
+stat_t af_set_afs(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, af.set_point, 0.01, 1.0));
+    return (_adaptive_restart());
+}
+
+stat_t af_set_afg(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, af.gain, 0, AF_GAIN_MAX));
+    return (_adaptive_restart());
+}
+
+stat_t af_set_afn(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, af.factor_min, FEED_OVERRIDE_MIN, 1.0));
+    return (_adaptive_restart());
+}
+
+stat_t af_set_afx(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, af.factor_max, 1.0, FEED_OVERRIDE_MAX));
+    return (_adaptive_restart());
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_afi[] = "[afi]  adaptive feed load input%8d [0=off,1-N=heater ADC]\n";
+static const char fmt_afs[] = "[afs]  adaptive feed load set point%8.3f [fraction of full scale]\n";
+static const char fmt_afg[] = "[afg]  adaptive feed gain%18.3f /s\n";
+static const char fmt_afn[] = "[afn]  adaptive feed minimum factor%8.3f\n";
+static const char fmt_afx[] = "[afx]  adaptive feed maximum factor%8.3f\n";
+static const char fmt_afl[] = "Adaptive feed load:%14.3f\n";
+static const char fmt_aff[] = "Adaptive feed factor:%12.3f\n";
+
+void af_print_afi(nvObj_t *nv) { text_print(nv, fmt_afi);}
+void af_print_afs(nvObj_t *nv) { text_print(nv, fmt_afs);}
+void af_print_afg(nvObj_t *nv) { text_print(nv, fmt_afg);}
+void af_print_afn(nvObj_t *nv) { text_print(nv, fmt_afn);}
+void af_print_afx(nvObj_t *nv) { text_print(nv, fmt_afx);}
+void af_print_afl(nvObj_t *nv) { text_print(nv, fmt_afl);}
+void af_print_aff(nvObj_t *nv) { text_print(nv, fmt_aff);}
+
+#endif // __TEXT_MODE
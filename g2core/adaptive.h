@@ -0,0 +1,99 @@
+/*
+ * adaptive.h - adaptive feedrate control from a load signal
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * ADAPTIVE FEED
+ *
+ *  Adaptive feed holds a load signal - typically spindle current - at a set point by
+ *  scaling the feed override. Light cuts run faster, heavy cuts slow down.
+ *
+ *  The load is read from a heater's ADC channel {afi:} (1..HEATERS, 0 = off), as a
+ *  fraction of the ADC's full scale {afl:}. The channel is sampled with the heater sensors
+ *  once every PID tick, whether or not its heater is enabled, so a spare heater input can
+ *  be wired to the spindle drive's load output.
+ *
+ *  Each tick the adaptive factor {aff:} is moved by {afg:} per second for each unit of
+ *  load error relative to the set point {afs:}, and kept within {afn:} to {afx:}. It only
+ *  moves while a feed is running - traverses and holds leave it where it is - and returns
+ *  to 1.0 when the cycle ends. The feed override is the M50 factor times the adaptive
+ *  factor, and is passed to the planner's override ramp (mp_start_feed_override()) when
+ *  it changes by more than AF_FACTOR_DEADBAND. M48 disables it with the other overrides.
+ *
+ *  The planner replans the queue on each change unless {frm:1} is set, where slowing down
+ *  only stretches the exec's time. {frm:1} is the better choice with adaptive feed.
+ */
+
+#ifndef ADAPTIVE_H_ONCE
+#define ADAPTIVE_H_ONCE
+
+#include "config.h"  // needed for nvObj_t definition
+
+#define AF_FACTOR_DEADBAND 0.01     // smallest change in the override passed to the planner
+#define AF_GAIN_MAX 10.0            // factor per second per unit of load error
+
+typedef struct afSingleton {
+    // config
+    uint8_t input;                  // heater whose ADC channel is the load, 0 = off
+    float set_point;                // load held, fraction of ADC full scale
+    float gain;                     // factor change per second per unit of relative load error
+    float factor_min;               // adaptive factor bounds
+    float factor_max;
+
+    // runtime
+    float load;                     // last load read, fraction of ADC full scale
+    float factor;                   // adaptive factor
+    float applied;                  // override last passed to the planner
+} afSingleton_t;
+
+extern afSingleton_t af;
+
+void adaptive_reset(void);
+void adaptive_feed_update(const float dt);
+
+stat_t af_get_afi(nvObj_t *nv);
+stat_t af_set_afi(nvObj_t *nv);
+stat_t af_get_afs(nvObj_t *nv);
+stat_t af_set_afs(nvObj_t *nv);
+stat_t af_get_afg(nvObj_t *nv);
+stat_t af_set_afg(nvObj_t *nv);
+stat_t af_get_afn(nvObj_t *nv);
+stat_t af_set_afn(nvObj_t *nv);
+stat_t af_get_afx(nvObj_t *nv);
+stat_t af_set_afx(nvObj_t *nv);
+stat_t af_get_afl(nvObj_t *nv);
+stat_t af_get_aff(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void af_print_afi(nvObj_t *nv);
+    void af_print_afs(nvObj_t *nv);
+    void af_print_afg(nvObj_t *nv);
+    void af_print_afn(nvObj_t *nv);
+    void af_print_afx(nvObj_t *nv);
+    void af_print_afl(nvObj_t *nv);
+    void af_print_aff(nvObj_t *nv);
+#else
+    #define af_print_afi tx_print_stub
+    #define af_print_afs tx_print_stub
+    #define af_print_afg tx_print_stub
+    #define af_print_afn tx_print_stub
+    #define af_print_afx tx_print_stub
+    #define af_print_afl tx_print_stub
+    #define af_print_aff tx_print_stub
+#endif
+
+#endif  // End of include guard: ADAPTIVE_H_ONCE
@@ -36,6 +36,7 @@
 #include "coolant.h"
 #include "temperature.h"
 #include "util.h"
+#include "trace.h"
 
 /****************************************************************************************
  * ALARM, SHUTDOWN, and PANIC are nested dolls.
@@ -167,8 +168,9 @@ stat_t cm_alarm(const stat_t status, const char *msg)
         return (STAT_OK);                       // don't alarm if already in an alarm state
     }
     cm_request_feedhold(FEEDHOLD_TYPE_SCRAM, FEEDHOLD_EXIT_ALARM);  // fast stop and alarm
-    rpt_exception(status, msg);                 // send alarm message
-    sr_request_status_report(SR_REQUEST_TIMED);
+    rpt_fatal_exception(status, msg);           // send alarm message
+    tr_freeze_and_dump();                       // keep the segments leading up to the alarm
+    rpt_post_event(RPT_EVENT_ALARM);
     return (status);
 }
 
@@ -205,11 +207,12 @@ stat_t cm_shutdown(const stat_t status, const char *msg)
         cm->homed[i] = false;
     }
     cm->homing_state = HOMING_NOT_HOMED;
+    cm_update_soft_limits();
 
 //    cm1.machine_state = MACHINE_SHUTDOWN;       // shut down both machines...
 //    cm2.machine_state = MACHINE_SHUTDOWN;       //...do this after all other activity
-    rpt_exception(status, msg);                 // send exception report
-    sr_request_status_report(SR_REQUEST_TIMED);
+    rpt_fatal_exception(status, msg);           // send exception report
+    rpt_post_event(RPT_EVENT_ALARM);
     return (status);
 }
 
@@ -237,6 +240,6 @@ stat_t cm_panic(const stat_t status, const char *msg)
 
     cm1.machine_state = MACHINE_PANIC;          // don't reset anything. Panics are not recoverable
     cm2.machine_state = MACHINE_PANIC;          // don't reset anything. Panics are not recoverable
-    rpt_exception(status, msg);                 // send panic report
+    rpt_fatal_exception(status, msg);           // send panic report
     return (status);
 }
@@ -0,0 +1,221 @@
+/*
+ * benchmark.cpp - motion throughput benchmark
+ * This file is part of g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "benchmark.h"
+#include "canonical_machine.h"
+#include "json_parser.h"
+#include "planner.h"
+#include "text_parser.h"
+#include "util.h"
+#include "xio.h"
+
+#ifdef __BENCHMARK
+
+bmBenchmark_t bm;
+
+/**** Compiled-in jobs ****/
+
+#define PROGMEM                         // the Resources/gcode programs were written for AVR
+namespace bm_braid {
+#include "../Resources/gcode/gcode_braid_short_bpe.h"
+}
+namespace bm_mudflap {
+#include "../Resources/gcode/gcode_mudflap_bpe.h"
+}
+#undef PROGMEM
+
+static xio_flash_file _jobs[] = {                   // compressed - see xio_flash_file
+    make_xio_flash_file(bm_braid::gcode_file_bpe, bm_braid::gcode_file_pairs),      // {bmj:1}
+    make_xio_flash_file(bm_mudflap::gcode_file_bpe, bm_mudflap::gcode_file_pairs)   // {bmj:2}
+};
+#define BM_JOBS (sizeof(_jobs) / sizeof(xio_flash_file))
+
+/*
+ * bm_init() - nothing armed and no results
+ * bm_arm()  - clear the results and measure the next job
+ */
+
+void bm_init()
+{
+    memset(&bm, 0, sizeof(bm));
+}
+
+void bm_arm(const uint8_t job)
+{
+    bm.state = BM_OFF;                              // keep the hooks out while clearing
+    bm.job = job;
+    bm.starving = false;
+    bm.blocks = 0;
+    bm.starvations = 0;
+    bm.queue_min = mp->q.queue_size;                // "never below full" if nothing was waiting
+    bm.backplan_passes = 0;
+    bm.backplan_iterations = 0;
+    bm.backplan_max = 0;
+    bm.start_ms = bm.end_ms = bm.idle_ms = SysTickTimer_getValue();
+    mp_seg.exec_cycles_max = 0;                     // as {segx:0}
+    bm.state = BM_ARMED;
+}
+
+/*
+ * bm_callback() - track the end of the job and report it
+ *
+ *  Reports the {bm:n} group as a JSON object regardless of the communications mode, as
+ *  the report is meant to be read by a script.
+ */
+
+static void _bm_report()
+{
+    nvObj_t *nv = nv_reset_nv_list();
+    strcpy(nv->token, "bm");
+    nv->index = nv_get_index((const char *)"", nv->token);
+    get_grp(nv);
+    json_print_list(STAT_OK, JSON_OBJECT_FORMAT);
+}
+
+stat_t bm_callback()
+{
+    if (bm.state == BM_OFF) {
+        return (STAT_NOOP);
+    }
+    bm.input_pending = xio_rx_pending();
+    if (bm.state != BM_RUNNING) {
+        return (STAT_OK);
+    }
+    uint32_t now = SysTickTimer_getValue();
+    if (cm->motion_state != MOTION_STOP) {
+        bm.end_ms = now;
+    }
+    if ((cm->motion_state != MOTION_STOP) || bm.input_pending ||
+        mp_has_runnable_buffer(mp) || !mp_runtime_is_idle()) {
+        bm.idle_ms = now;
+        return (STAT_OK);
+    }
+    if ((now - bm.idle_ms) < BM_IDLE_MS) {
+        return (STAT_OK);
+    }
+    bm.state = BM_OFF;
+    _bm_report();
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * bm_get_bma() - get the benchmark state - 0=off, 1=armed, 2=running
+ * bm_set_bma() - arm the benchmark for the next job (true), or disarm it (false)
+ * bm_get_bmj() - get the compiled-in job number of the last or current job
+ * bm_set_bmj() - arm the benchmark and run compiled-in job N
+ */
+
+stat_t bm_get_bma(nvObj_t *nv) { return (get_integer(nv, bm.state)); }
+
+stat_t bm_set_bma(nvObj_t *nv)
+{
+    if (nv->value_int) {
+        bm_arm(0);
+    } else {
+        bm.state = BM_OFF;
+    }
+    return (STAT_OK);
+}
+
+stat_t bm_get_bmj(nvObj_t *nv) { return (get_integer(nv, bm.job)); }
+
+stat_t bm_set_bmj(nvObj_t *nv)
+{
+    if ((nv->value_int < 1) || (nv->value_int > (int32_t)BM_JOBS)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    if (cm->machine_state == MACHINE_CYCLE) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    bm_arm(nv->value_int);
+    if (!xio_send_file(_jobs[nv->value_int - 1])) {
+        bm.state = BM_OFF;
+        return (STAT_COMMAND_NOT_ACCEPTED);         // a file is already running
+    }
+    return (STAT_OK);
+}
+
+/*
+ * bm_get_bmt() - job time in seconds
+ * bm_get_bmb() - blocks run
+ * bm_get_bms() - starvation events
+ * bm_get_bmq() - minimum queue depth
+ * bm_get_bmx() - longest exec ISR in microseconds
+ * bm_get_bmi() - mean back-planning iterations per block
+ * bm_get_bmm() - most back-planning iterations in one pass
+ */
+
+stat_t bm_get_bmt(nvObj_t *nv) { return (get_float(nv, (float)(bm.end_ms - bm.start_ms) / 1000)); }
+stat_t bm_get_bmb(nvObj_t *nv) { return (get_integer(nv, bm.blocks)); }
+stat_t bm_get_bms(nvObj_t *nv) { return (get_integer(nv, bm.starvations)); }
+stat_t bm_get_bmq(nvObj_t *nv) { return (get_integer(nv, bm.queue_min)); }
+stat_t bm_get_bmx(nvObj_t *nv) { return (get_float(nv, mp_get_exec_usec_max())); }
+stat_t bm_get_bmm(nvObj_t *nv) { return (get_integer(nv, bm.backplan_max)); }
+
+stat_t bm_get_bmi(nvObj_t *nv)
+{
+    float mean = (bm.backplan_passes == 0) ? 0 : (float)bm.backplan_iterations / bm.backplan_passes;
+    return (get_float(nv, mean));
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_bma[] = "[bma] benchmark state%14d [0=off,1=armed,2=running]\n";
+static const char fmt_bmj[] = "[bmj] benchmark job%16d\n";
+static const char fmt_bmt[] = "[bmt] job time%21.3f s\n";
+static const char fmt_bmb[] = "[bmb] blocks run%19d\n";
+static const char fmt_bms[] = "[bms] starvation events%12d\n";
+static const char fmt_bmq[] = "[bmq] minimum queue depth%10d blocks\n";
+static const char fmt_bmx[] = "[bmx] longest exec ISR%13.1f us\n";
+static const char fmt_bmi[] = "[bmi] back-plan iterations%9.2f per block\n";
+static const char fmt_bmm[] = "[bmm] back-plan iterations%9d max\n";
+
+void bm_print_bma(nvObj_t *nv) { text_print(nv, fmt_bma);}     // TYPE_INT
+void bm_print_bmj(nvObj_t *nv) { text_print(nv, fmt_bmj);}     // TYPE_INT
+void bm_print_bmt(nvObj_t *nv) { text_print(nv, fmt_bmt);}     // TYPE_FLOAT
+void bm_print_bmb(nvObj_t *nv) { text_print(nv, fmt_bmb);}     // TYPE_INT
+void bm_print_bms(nvObj_t *nv) { text_print(nv, fmt_bms);}     // TYPE_INT
+void bm_print_bmq(nvObj_t *nv) { text_print(nv, fmt_bmq);}     // TYPE_INT
+void bm_print_bmx(nvObj_t *nv) { text_print(nv, fmt_bmx);}     // TYPE_FLOAT
+void bm_print_bmi(nvObj_t *nv) { text_print(nv, fmt_bmi);}     // TYPE_FLOAT
+void bm_print_bmm(nvObj_t *nv) { text_print(nv, fmt_bmm);}     // TYPE_INT
+
+#endif // __TEXT_MODE
+
+#endif  // __BENCHMARK
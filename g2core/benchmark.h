@@ -0,0 +1,186 @@
+/*
+ * benchmark.h - motion throughput benchmark
+ * This file is part of g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * BENCHMARK
+ *
+ *  An instrumentation build (define __BENCHMARK in g2core.h - the simulator build always
+ *  does) that measures one job at a time and reports it as a single JSON line when the
+ *  job is done, so runs can be compared by a script:
+ *
+ *    {"bm":{"a":0,"j":2,"t":42.822,"b":311,"s":0,"q":39,"x":28.1,"i":2.24,"m":45}}
+ *
+ *    bmj   job - the compiled-in job that was run ({bmj:N}), 0 for any other input
+ *    bmt   job time in seconds, from the first block starting to the last one ending
+ *    bmb   blocks (ALINEs) run
+ *    bms   starvation events - times exec found nothing planned to run in mid cycle
+ *    bmq   fewest blocks queued when a block started, while more input was waiting
+ *    bmx   longest exec ISR in microseconds - mp_exec_move() + st_prep_line()
+ *    bmi   mean back-planning iterations per planned block
+ *    bmm   most back-planning iterations in one pass
+ *
+ *  {bma:t} arms the benchmark for whatever runs next - a streamed job or a spooled one
+ *  ({spr:t}). {bmj:N} arms it and plays compiled-in job N through xio_send_file():
+ *
+ *    1  Resources/gcode/gcode_braid_short.h    (compiled in as gcode_braid_short_bpe.h)
+ *    2  Resources/gcode/gcode_mudflap.h        (compiled in as gcode_mudflap_bpe.h)
+ *
+ *  The larger programs in Resources/gcode don't fit in flash alongside the firmware; run
+ *  them in the simulator (Resources/benchmark/benchmark.py) or spool them first.
+ *
+ *  The job is done once the machine has been stopped for BM_IDLE_MS with no more input
+ *  waiting. The results stay readable as {bm:n} until the benchmark is armed again.
+ */
+
+#ifndef BENCHMARK_H_ONCE
+#define BENCHMARK_H_ONCE
+
+#ifdef __BENCHMARK
+
+#include "config.h"
+#include "util.h"
+
+#define BM_IDLE_MS 250                  // stopped this long with no input waiting ends the job
+
+typedef enum {
+    BM_OFF = 0,                         // not armed - results are from the last job, if any
+    BM_ARMED,                           // waiting for the first block to start
+    BM_RUNNING                          // job in progress
+} bmState;
+
+typedef struct bmBenchmark {
+    volatile bmState state;
+    uint8_t job;                        // compiled-in job number, 0 for none
+    volatile bool input_pending;        // more input is waiting to be read (set by bm_callback())
+    volatile bool starving;             // exec ran dry in a cycle - counts one event until it's fed
+
+    uint32_t start_ms;                  // SysTick when the first block started
+    uint32_t end_ms;                    // SysTick when motion was last seen
+    uint32_t idle_ms;                   // SysTick when the machine was first seen idle
+
+    volatile uint32_t blocks;           // ALINE blocks run
+    volatile uint32_t starvations;      // starvation events
+    volatile uint8_t queue_min;         // fewest blocks queued at a block start with input waiting
+    uint32_t backplan_passes;           // back-planning passes (one per planned block)
+    uint32_t backplan_iterations;       // blocks visited by all back-planning passes
+    uint32_t backplan_max;              // most blocks visited by one pass
+    uint32_t pass_iterations;           // blocks visited by the pass in progress
+} bmBenchmark_t;
+
+extern bmBenchmark_t bm;
+
+// Hooks - called from the exec (ISR) and the planner. The names say where they go.
+
+inline void bm_exec_starved() {         // mp_exec_move() has nothing runnable while in MOTION_RUN
+    if ((bm.state == BM_RUNNING) && !bm.starving) {
+        bm.starving = true;
+        bm.starvations++;
+    }
+}
+
+inline void bm_block_start(const uint8_t queued) {  // an ALINE block has started running
+    if (bm.state == BM_OFF) {
+        return;
+    }
+    if (bm.state == BM_ARMED) {
+        bm.start_ms = SysTickTimer_getValue();
+        bm.state = BM_RUNNING;
+    }
+    bm.starving = false;
+    bm.blocks++;
+    if (bm.input_pending && (queued < bm.queue_min)) {
+        bm.queue_min = queued;
+    }
+}
+
+inline void bm_backplan_iteration() {   // _plan_block() has visited one block going backwards
+    bm.pass_iterations++;
+}
+
+inline void bm_backplan_end() {         // _plan_block() has finished the back-planning pass
+    if (bm.state != BM_OFF) {
+        bm.backplan_passes++;
+        bm.backplan_iterations += bm.pass_iterations;
+        if (bm.pass_iterations > bm.backplan_max) {
+            bm.backplan_max = bm.pass_iterations;
+        }
+    }
+    bm.pass_iterations = 0;
+}
+
+#define BM_EXEC_STARVED() bm_exec_starved()
+#define BM_BLOCK_START(queued) bm_block_start(queued)
+#define BM_BACKPLAN_ITERATION() bm_backplan_iteration()
+#define BM_BACKPLAN_END() bm_backplan_end()
+
+void bm_init(void);
+void bm_arm(const uint8_t job);
+stat_t bm_callback(void);
+
+stat_t bm_get_bma(nvObj_t *nv);
+stat_t bm_set_bma(nvObj_t *nv);
+stat_t bm_get_bmj(nvObj_t *nv);
+stat_t bm_set_bmj(nvObj_t *nv);
+stat_t bm_get_bmt(nvObj_t *nv);
+stat_t bm_get_bmb(nvObj_t *nv);
+stat_t bm_get_bms(nvObj_t *nv);
+stat_t bm_get_bmq(nvObj_t *nv);
+stat_t bm_get_bmx(nvObj_t *nv);
+stat_t bm_get_bmi(nvObj_t *nv);
+stat_t bm_get_bmm(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void bm_print_bma(nvObj_t *nv);
+    void bm_print_bmj(nvObj_t *nv);
+    void bm_print_bmt(nvObj_t *nv);
+    void bm_print_bmb(nvObj_t *nv);
+    void bm_print_bms(nvObj_t *nv);
+    void bm_print_bmq(nvObj_t *nv);
+    void bm_print_bmx(nvObj_t *nv);
+    void bm_print_bmi(nvObj_t *nv);
+    void bm_print_bmm(nvObj_t *nv);
+#else
+    #define bm_print_bma tx_print_stub
+    #define bm_print_bmj tx_print_stub
+    #define bm_print_bmt tx_print_stub
+    #define bm_print_bmb tx_print_stub
+    #define bm_print_bms tx_print_stub
+    #define bm_print_bmq tx_print_stub
+    #define bm_print_bmx tx_print_stub
+    #define bm_print_bmi tx_print_stub
+    #define bm_print_bmm tx_print_stub
+#endif // __TEXT_MODE
+
+#else
+
+#define BM_EXEC_STARVED()
+#define BM_BLOCK_START(queued)
+#define BM_BACKPLAN_ITERATION()
+#define BM_BACKPLAN_END()
+
+#endif  // __BENCHMARK
+
+#endif  // End of include guard: BENCHMARK_H_ONCE
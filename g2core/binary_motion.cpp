@@ -0,0 +1,415 @@
+/*
+ * binary_motion.cpp - compact binary motion channel on the second USB endpoint
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/* See binary_motion.h for the frame format */
+
+#include "g2core.h"
+#include "config.h"
+#include "controller.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "spindle.h"
+#include "report.h"
+#include "binary_motion.h"
+#include "text_parser.h"
+#include "xio.h"
+
+#if BINARY_MOTION_ENABLED == true
+
+bmBinaryMotion_t bm;
+bmTelemetry_t tl;
+
+static stat_t _execute_frame(void);
+static void _send_ack(const stat_t status);
+static void _send_frame(const uint8_t type, const uint8_t *payload, const uint8_t len);
+
+/*
+ * binary_motion_init()
+ */
+
+void binary_motion_init()
+{
+    memset(&bm, 0, sizeof(bm));
+    bm.state = BM_STATE_SYNC;
+}
+
+/*
+ * binary_motion_callback() - read and execute one binary frame
+ *
+ *  Like _dispatch_command() this only reads when the planner has room, and executes at
+ *  most one frame per pass. Bytes are read no further than the end of the frame being
+ *  decoded, so anything after it stays in the USB buffer until the next pass.
+ */
+
+stat_t binary_motion_callback()
+{
+    if ((cs.controller_state == CONTROLLER_PAUSED) || mp_planner_is_full(mp) || mp_planner_is_time_full(mp)) {
+        return (STAT_NOOP);
+    }
+    if (mp_get_raster_line() == NULL) {     // every scanline is queued - wait, as the next frame may need one
+        return (STAT_NOOP);
+    }
+    char c;
+    while (xio_read_binary(&c, 1) == 1) {
+        uint8_t b = (uint8_t)c;
+        switch (bm.state) {
+            case BM_STATE_SYNC: {
+                if (b == BM_SYNC) {
+                    bm.state = BM_STATE_LEN;
+                }
+                break;
+            }
+            case BM_STATE_LEN: {
+                if (b > BM_PAYLOAD_MAX) {
+                    bm.errors++;
+                    bm.state = BM_STATE_SYNC;   // not a frame - resync
+                    break;
+                }
+                bm.len = b;
+                bm.state = BM_STATE_TYPE;
+                break;
+            }
+            case BM_STATE_TYPE: {
+                bm.type = b;
+                bm.check = b;
+                bm.count = 0;
+                bm.state = (bm.len == 0) ? BM_STATE_CHECK : BM_STATE_PAYLOAD;
+                break;
+            }
+            case BM_STATE_PAYLOAD: {        // take the rest of the payload in one read
+                bm.payload[bm.count++] = b;
+                bm.count += xio_read_binary((char *)&bm.payload[bm.count], bm.len - bm.count);
+                if (bm.count == bm.len) {
+                    for (uint8_t i = 0; i < bm.len; i++) {
+                        bm.check ^= bm.payload[i];
+                    }
+                    bm.state = BM_STATE_CHECK;
+                }
+                break;
+            }
+            case BM_STATE_CHECK: {
+                bm.state = BM_STATE_SYNC;
+                bm.frames++;
+                if (b != bm.check) {
+                    bm.errors++;
+                    _send_ack(STAT_CHECKSUM_MATCH_FAILED);
+                    return (STAT_OK);
+                }
+                stat_t status = _execute_frame();
+                sr_mark_changed();
+                if (status != STAT_OK) {
+                    bm.errors++;
+                }
+                _send_ack(status);
+                return (STAT_OK);
+            }
+        }
+    }
+    return (STAT_NOOP);
+}
+
+/*
+ * _get_xxx() - little-endian payload field readers, advance the read pointer
+ */
+
+static int16_t _get_int16(const uint8_t *&p)
+{
+    int16_t v = (int16_t)(p[0] | (p[1] << 8));
+    p += 2;
+    return (v);
+}
+
+static int32_t _get_int32(const uint8_t *&p)
+{
+    int32_t v = (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+    p += 4;
+    return (v);
+}
+
+static float _get_float(const uint8_t *&p)
+{
+    float v;
+    memcpy(&v, p, sizeof(v));                   // the SAM is little-endian
+    p += 4;
+    return (v);
+}
+
+/*
+ * _raster_data() - copy BM_RASTER_DATA pixels into the next free scanline
+ */
+
+static stat_t _raster_data()
+{
+    if (bm.len < 2) {
+        return (STAT_INPUT_LESS_THAN_MIN_VALUE);
+    }
+    const uint8_t *p = bm.payload;
+    uint16_t offset = (uint16_t)_get_int16(p);
+    uint16_t count = bm.len - 2;
+    if (offset + count > RASTER_PIXELS_MAX) {
+        return (STAT_INPUT_EXCEEDS_MAX_VALUE);
+    }
+    memcpy(&mp_get_raster_line()->pixel[offset], p, count);
+    return (STAT_OK);
+}
+
+/*
+ * _execute_frame() - feed a decoded frame to the canonical machine
+ *
+ *  Moves are handed to cm_straight_feed(), cm_straight_traverse() or cm_raster_feed() the
+ *  same way _execute_gcode_block() does, so they go through the same unit, offset and soft
+ *  limit handling as Gcode.
+ */
+
+static stat_t _execute_frame()
+{
+    if (bm.type == BM_QUERY) {
+        return (STAT_OK);
+    }
+    if (bm.type == BM_RASTER_DATA) {
+        return (_raster_data());
+    }
+    if ((bm.type != BM_MOVE_FEED) && (bm.type != BM_MOVE_TRAVERSE) && (bm.type != BM_MOVE_RASTER)) {
+        return (STAT_UNRECOGNIZED_NAME);
+    }
+    bool raster = (bm.type == BM_MOVE_RASTER);
+    if (bm.len < (raster ? 8 : 6)) {
+        return (STAT_INPUT_LESS_THAN_MIN_VALUE);
+    }
+    ritorno(cm_is_alarmed());
+
+    const uint8_t *p = bm.payload;
+    uint8_t flags = *p++;
+    uint8_t axes = *p++;
+    bm.line = _get_int32(p);
+    uint16_t pixels = raster ? (uint16_t)_get_int16(p) : 0;
+
+    // check the length before using any of the payload
+    uint8_t length = (raster ? 8 : 6) + ((flags & BM_FLAG_FEED) ? 4 : 0) + ((flags & BM_FLAG_SPINDLE) ? 4 : 0);
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (axes & (1 << axis)) {
+            length += (flags & BM_FLAG_DELTA) ? 2 : 4;
+        }
+    }
+    if (length != bm.len) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+
+    cm_set_model_linenum(bm.line);
+    if (flags & BM_FLAG_FEED) {
+        ritorno(cm_set_feed_rate(_get_float(p)));
+    }
+    if (flags & BM_FLAG_SPINDLE) {
+        ritorno(spindle_speed_sync(_get_float(p)));
+    }
+
+    float target[AXES];
+    bool flag[AXES];
+    bool incremental = (cm_get_distance_mode(MODEL) == INCREMENTAL_DISTANCE_MODE);
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        flag[axis] = (axes & (1 << axis));
+        target[axis] = 0;
+        if (!flag[axis]) {
+            continue;
+        }
+        if (flags & BM_FLAG_DELTA) {
+            target[axis] = _get_int16(p) * BM_DELTA_UNIT;
+            if (!incremental) {
+                target[axis] += cm_get_display_position(MODEL, axis);
+            }
+        } else {
+            target[axis] = _get_float(p);
+            if (incremental) {
+                target[axis] -= cm_get_display_position(MODEL, axis);
+            }
+        }
+    }
+    if (raster) {
+        mpRasterLine_t *line = mp_get_raster_line();
+        line->count = pixels;
+        return (cm_raster_feed(target, flag, line));
+    }
+    if (bm.type == BM_MOVE_TRAVERSE) {
+        return (cm_straight_traverse(target, flag, PROFILE_NORMAL));
+    }
+    return (cm_straight_feed(target, flag, PROFILE_NORMAL));
+}
+
+/*
+ * _put_xxx() - little-endian payload field writers, advance the write pointer
+ */
+
+static void _put_int16(uint8_t *&p, const uint16_t v)
+{
+    *p++ = v & 0xFF;
+    *p++ = (v >> 8) & 0xFF;
+}
+
+static void _put_int32(uint8_t *&p, const uint32_t v)
+{
+    for (uint8_t i = 0; i < 4; i++) {
+        *p++ = (v >> (i * 8)) & 0xFF;
+    }
+}
+
+/*
+ * _send_frame() - frame and write a payload
+ * _send_ack()   - return line, status and the planner buffers available
+ */
+
+static void _send_frame(const uint8_t type, const uint8_t *payload, const uint8_t len)
+{
+    char frame[3 + 255 + 1];
+    uint8_t check = type;
+
+    frame[0] = BM_SYNC;
+    frame[1] = len;
+    frame[2] = type;
+    for (uint8_t i = 0; i < len; i++) {
+        frame[3+i] = (char)payload[i];
+        check ^= payload[i];
+    }
+    frame[3+len] = (char)check;
+    xio_write_binary(frame, 4 + len);
+}
+
+static void _send_ack(const stat_t status)
+{
+    uint8_t ack[6];
+    uint8_t *p = ack;
+
+    _put_int32(p, (uint32_t)bm.line);
+    *p++ = (uint8_t)status;
+    *p++ = (uint8_t)mp_get_planner_buffers(mp);
+    _send_frame(BM_ACK, ack, sizeof(ack));
+}
+
+/*
+ * binary_motion_status_report() - send the values in an SR list as a BM_STATUS frame
+ *
+ *  Called by sr_status_report_callback() when $sv is SR_BINARY. Takes the SR elements
+ *  that follow the "sr" parent, skipping any the filter emptied out. Floats go through
+ *  convert_outgoing_float() so units match the JSON report.
+ */
+
+void binary_motion_status_report(nvObj_t *nv)
+{
+    uint8_t payload[BM_STATUS_MAX];
+    uint8_t *p = payload;
+
+    for (uint8_t i = 0; (i < NV_STATUS_REPORT_LEN) && (nv != NULL); i++, nv = nv->nx) {
+        if (nv->valuetype == TYPE_EMPTY) {
+            continue;
+        }
+        _put_int16(p, nv->index);
+        if (nv->valuetype == TYPE_FLOAT) {
+            convert_outgoing_float(nv);
+            uint32_t v;
+            memcpy(&v, &nv->value_flt, sizeof(v));
+            _put_int32(p, v);
+        } else {
+            _put_int32(p, (uint32_t)nv->value_int);
+        }
+    }
+    if (p != payload) {
+        _send_frame(BM_STATUS, payload, p - payload);
+    }
+}
+
+/*
+ * binary_telemetry_callback() - send buffered telemetry samples as a BM_TELEMETRY frame
+ *
+ *  Sends one frame per pass, and waits for a full frame unless the runtime has stopped.
+ */
+
+stat_t binary_telemetry_callback()
+{
+    uint8_t available = (tl.head - tl.tail) & (BM_TELEMETRY_RING - 1);
+    if ((available == 0) || ((available < BM_TELEMETRY_FRAME) && !mp_runtime_is_idle())) {
+        return (STAT_NOOP);
+    }
+    if (available > BM_TELEMETRY_FRAME) {
+        available = BM_TELEMETRY_FRAME;
+    }
+    uint8_t payload[6 + BM_TELEMETRY_FRAME * (1 + AXES) * 4];
+    uint8_t *p = payload;
+    uint8_t tail = tl.tail;
+    uint32_t v;
+
+    _put_int32(p, tl.ring[tail].sequence);
+    _put_int16(p, tl.axes);
+    for (uint8_t i = 0; i < available; i++) {
+        const bmTelemetrySample_t *s = &tl.ring[tail];
+        memcpy(&v, &s->velocity, sizeof(v));
+        _put_int32(p, v);
+        for (uint8_t axis = 0; axis < AXES; axis++) {
+            if (tl.axes & (1 << axis)) {
+                memcpy(&v, &s->position[axis], sizeof(v));
+                _put_int32(p, v);
+            }
+        }
+        tail = (tail + 1) & (BM_TELEMETRY_RING - 1);
+    }
+    tl.tail = tail;                             // free the samples before the (possibly slow) write
+    _send_frame(BM_TELEMETRY, payload, p - payload);
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ ***********************************************************************************/
+
+stat_t bm_get_tlr(nvObj_t *nv) { return (get_integer(nv, tl.rate)); }
+stat_t bm_get_tla(nvObj_t *nv) { return (get_integer(nv, tl.axes)); }
+
+stat_t bm_set_tlr(nvObj_t *nv)
+{
+    int32_t rate;
+    ritorno(set_int32(nv, rate, 0, 1000));
+    tl.count = 0;
+    tl.rate = rate;
+    return (STAT_OK);
+}
+
+stat_t bm_set_tla(nvObj_t *nv)
+{
+    int32_t axes;
+    ritorno(set_int32(nv, axes, 0, (1 << AXES) - 1));
+    tl.axes = axes;
+    return (STAT_OK);
+}
+
+#ifdef __TEXT_MODE
+
+static const char fmt_tlr[] = "[tlr] telemetry rate%15d segments per sample [0=off]\n";
+static const char fmt_tla[] = "[tla] telemetry axes%15d [axis bit mask]\n";
+
+void bm_print_tlr(nvObj_t *nv) { text_print(nv, fmt_tlr);}
+void bm_print_tla(nvObj_t *nv) { text_print(nv, fmt_tla);}
+
+#endif // __TEXT_MODE
+
+#endif // BINARY_MOTION_ENABLED
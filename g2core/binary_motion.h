@@ -0,0 +1,213 @@
+/*
+ * binary_motion.h - compact binary motion channel on the second USB endpoint
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * BINARY MOTION CHANNEL
+ *
+ *  When BINARY_MOTION_ENABLED is true (requires USB_SERIAL_PORTS_EXPOSED == 2) SerialUSB1
+ *  no longer carries text. It carries framed binary move records that are decoded straight
+ *  into canonical machine calls, bypassing text formatting and gcode_parser(). It is meant
+ *  for raster work: long streams of short G1 moves with S values. SerialUSB is unchanged
+ *  and remains the control channel for JSON, feedhold, queue flush and so on.
+ *
+ *  All multi-byte fields are little-endian. A frame is:
+ *
+ *    SYNC(0xA5) LEN TYPE PAYLOAD[LEN] CHECK
+ *
+ *  LEN is the payload length (not counting TYPE). CHECK is the XOR of TYPE and the payload
+ *  bytes - the same checksum Gcode uses for *nn. Bytes that are not a SYNC are skipped when
+ *  looking for the start of a frame.
+ *
+ *  BM_MOVE payload:
+ *
+ *    uint8   flags       BM_FLAG_xxx below
+ *    uint8   axes        bit mask of axes present, bit 0 = X ... (AXES bits)
+ *    int32   line        line number, reported by the SR and returned in the ack
+ *    float   F           if BM_FLAG_FEED - feed rate, as the F word
+ *    float   S           if BM_FLAG_SPINDLE - spindle speed / laser power, as the S word
+ *    values  one per axis present, in axis order:
+ *              float   absolute position in work coordinates and current units, or
+ *              int16   delta from the previous target in BM_DELTA_UNIT steps (BM_FLAG_DELTA)
+ *
+ *  Records are always absolute or delta as flagged, whatever the G90/G91 state.
+ *
+ *  BM_MOVE_RASTER is a feed move that carries a scanline of laser intensities (see mp_raster()).
+ *  Its payload is a BM_MOVE payload with a uint16 pixel count inserted after the line number.
+ *  The pixels are sent first, in BM_RASTER_DATA frames:
+ *
+ *    uint16  offset      index of the first pixel in this frame
+ *    uint8   pixels      up to BM_RASTER_CHUNK intensities, 0 - 255, scaling the current S
+ *
+ *  Raster frames are held in the USB buffer while all RASTER_LINES scanlines are queued.
+ *
+ *  BM_QUERY has no payload and only returns an ack.
+ *
+ *  Every frame is answered with a 10 byte BM_ACK frame:
+ *
+ *    SYNC(0xA5) LEN(6) TYPE(BM_ACK) int32 line, uint8 status, uint8 planner buffers available, CHECK
+ *
+ *  line is the line of the last move frame received, status is a stat_t code. Frames
+ *  are only decoded when the planner has room, so unread bytes stay in the USB buffer and
+ *  the host is flow controlled by the endpoint. The buffer count lets the host keep the
+ *  planner full without waiting on each ack.
+ *
+ *  With {"sv":3} automatic status reports are sent here as BM_STATUS frames instead of
+ *  JSON on the control channel. Like filtered reports only changed values are sent (all
+ *  of them on the first report after setting sv). The payload is one record per value:
+ *
+ *    uint16  index       cfgArray index of the value - the value of the matching seNN setting
+ *    value   float or int32, by the type of the value
+ *
+ *  Telemetry is independent of status reports. With {"tlr":n} the runtime samples its
+ *  position and velocity every n segments into a ring (0 turns it off), and the ring is
+ *  drained as BM_TELEMETRY frames whenever the main loop gets to it. If the host doesn't
+ *  keep up samples are dropped, never waited on. The payload is:
+ *
+ *    uint32  sequence    sequence number of the first sample - gaps are dropped samples
+ *    uint16  axes        bit mask of the axes in each sample, from {"tla":n}
+ *    samples up to BM_TELEMETRY_FRAME of:
+ *              float   velocity (mm/min)
+ *              float   one per axis in the mask - runtime machine position (mm)
+ */
+
+#ifndef BINARY_MOTION_H_ONCE
+#define BINARY_MOTION_H_ONCE
+
+#if BINARY_MOTION_ENABLED == true
+
+#define BM_SYNC             0xA5            // start of frame
+#define BM_MOVE_MAX         (2 + 4 + 2 + 4 + 4 + (AXES * 4))   // largest move - an absolute scanline on all axes
+#define BM_RASTER_CHUNK     128             // most pixels in a BM_RASTER_DATA frame
+#define BM_PAYLOAD_MAX      ((BM_MOVE_MAX > (2 + BM_RASTER_CHUNK)) ? BM_MOVE_MAX : (2 + BM_RASTER_CHUNK))
+static_assert(BM_PAYLOAD_MAX <= 255, "binary motion payloads must fit a one byte length");
+#define BM_STATUS_MAX       (NV_STATUS_REPORT_LEN * 6)   // an index and a value for every SR element
+static_assert(BM_STATUS_MAX <= 255, "binary status reports must fit a one byte length");
+#define BM_DELTA_UNIT       ((float)0.001)  // delta moves are in microns (or thousandths of an inch)
+#define BM_TELEMETRY_RING   32              // telemetry samples buffered - must be a power of 2
+#define BM_TELEMETRY_FRAME  4               // most samples in a BM_TELEMETRY frame
+static_assert((6 + BM_TELEMETRY_FRAME * (1 + AXES) * 4) <= 255, "telemetry frames must fit a one byte length");
+
+typedef enum {                              // frame types
+    BM_QUERY = 0,                           // return an ack with the planner buffer count
+    BM_MOVE_FEED,                           // feed move (G1)
+    BM_MOVE_TRAVERSE,                       // traverse move (G0)
+    BM_RASTER_DATA,                         // pixels for the next scanline
+    BM_MOVE_RASTER,                         // scanline feed move (G1 with pixels)
+    BM_ACK = 0x80,                          // response to every frame
+    BM_STATUS,                              // binary status report
+    BM_TELEMETRY                            // position and velocity samples
+} bmFrameType;
+
+#define BM_FLAG_DELTA       0x01            // axis values are int16 deltas, not absolute floats
+#define BM_FLAG_FEED        0x02            // F value is present
+#define BM_FLAG_SPINDLE     0x04            // S value is present
+
+typedef enum {                              // frame decoder states
+    BM_STATE_SYNC = 0,                      // waiting for a SYNC byte
+    BM_STATE_LEN,                           // waiting for the length
+    BM_STATE_TYPE,                          // waiting for the type
+    BM_STATE_PAYLOAD,                       // reading payload
+    BM_STATE_CHECK                          // waiting for the checksum
+} bmState;
+
+typedef struct bmBinaryMotion {
+    bmState state;                          // frame decoder state
+    uint8_t type;                           // frame type being read
+    uint8_t len;                            // payload length of the frame being read
+    uint8_t count;                          // payload bytes read so far
+    uint8_t check;                          // running checksum
+    uint8_t payload[BM_PAYLOAD_MAX];
+    int32_t line;                           // line number of the last move frame
+    uint32_t frames;                        // frames received (diagnostic)
+    uint32_t errors;                        // frames rejected (diagnostic)
+} bmBinaryMotion_t;
+
+typedef struct bmTelemetrySample {
+    uint32_t sequence;
+    float velocity;
+    float position[AXES];
+} bmTelemetrySample_t;
+
+typedef struct bmTelemetry {                // kept apart from bm - it holds settings that binary_motion_init() mustn't clear
+    uint16_t rate;                          // take a sample every rate segments, 0 = off
+    uint16_t axes;                          // axes to send
+    uint16_t count;                         // segments since the last sample
+    uint32_t sequence;                      // next sample number
+    volatile uint8_t head;                  // written by the runtime
+    volatile uint8_t tail;                  // written by the main loop
+    bmTelemetrySample_t ring[BM_TELEMETRY_RING];
+} bmTelemetry_t;
+
+extern bmBinaryMotion_t bm;
+extern bmTelemetry_t tl;
+
+/*
+ * binary_motion_telemetry_sample() - called by the runtime for each segment
+ */
+
+inline void binary_motion_telemetry_sample(const float position[], const float velocity)
+{
+    if ((tl.rate == 0) || (++tl.count < tl.rate)) {
+        return;
+    }
+    tl.count = 0;
+    uint8_t head = tl.head;
+    uint32_t sequence = tl.sequence++;
+    if (((head + 1) & (BM_TELEMETRY_RING - 1)) == tl.tail) {
+        return;                             // full - drop it, the host sees the gap
+    }
+    bmTelemetrySample_t *s = &tl.ring[head];
+    s->sequence = sequence;
+    s->velocity = velocity;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        s->position[axis] = position[axis];
+    }
+    tl.head = (head + 1) & (BM_TELEMETRY_RING - 1);
+}
+
+/**** function prototypes ****/
+
+void binary_motion_init(void);
+stat_t binary_motion_callback(void);
+void binary_motion_status_report(nvObj_t *nv);
+stat_t binary_telemetry_callback(void);
+
+stat_t bm_get_tlr(nvObj_t *nv);
+stat_t bm_set_tlr(nvObj_t *nv);
+stat_t bm_get_tla(nvObj_t *nv);
+stat_t bm_set_tla(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void bm_print_tlr(nvObj_t *nv);
+    void bm_print_tla(nvObj_t *nv);
+#else
+    #define bm_print_tlr tx_print_stub
+    #define bm_print_tla tx_print_stub
+#endif
+
+#endif // BINARY_MOTION_ENABLED
+
+#endif // BINARY_MOTION_H_ONCE
@@ -59,6 +59,9 @@ ifeq ("$(BASE_BOARD)","g2core-due")
     export CHIP
     CHIP_LOWERCASE = sam3x8e
 
+    # HOT_PATH functions go in .ramfunc, which the SAM3X linker script puts in .relocate
+    DEVICE_DEFINES += RAMFUNC_HOT_PATHS=$(RAMFUNC_HOT_PATHS)
+
     # Note: we call it "g2core-due" instead of "due" since the Motate built-in provides
     # a "due" BASE_BOARD.
     BOARD_PATH = ./board/ArduinoDue
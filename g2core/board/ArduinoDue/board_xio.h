@@ -64,6 +64,16 @@ extern Motate::SPI<Motate::kSocket4_SPISlaveSelectPinNumber> spi;
 extern Motate::UART<Motate::kSerial_RXPinNumber, Motate::kSerial_TXPinNumber, Motate::kSerial_RTSPinNumber, Motate::kSerial_CTSPinNumber> Serial;
 #endif
 
+//******** Buffer sizes ********
+// RX and TX ring sizes per device, in bytes - must be powers of 2. Lines longer
+// than XIO_LINE_BUFFER_SIZE are split. {rxs:n} reports the RAM these take and the
+// overflow counters to size them by.
+#define XIO_USB_RX_BUFFER_SIZE      1024
+#define XIO_USB_TX_BUFFER_SIZE      1024
+#define XIO_UART_RX_BUFFER_SIZE     1024
+#define XIO_UART_TX_BUFFER_SIZE     1024
+#define XIO_LINE_BUFFER_SIZE        RX_BUFFER_SIZE
+
 //******* Generic Functions *******
 void board_hardware_init(void);  // called 1st
 void board_xio_init(void);       // called later
@@ -39,6 +39,9 @@ ifeq ("$(BASE_BOARD)","g2v9")
     export CHIP
     CHIP_LOWERCASE = sam3x8c
 
+    # HOT_PATH functions go in .ramfunc, which the SAM3X linker script puts in .relocate
+    DEVICE_DEFINES += RAMFUNC_HOT_PATHS=$(RAMFUNC_HOT_PATHS)
+
     BOARD_PATH = ./board/G2v9
     SOURCE_DIRS += ${BOARD_PATH} device/step_dir_driver
 
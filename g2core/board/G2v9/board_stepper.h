@@ -86,6 +86,9 @@ extern StepDirStepper<Motate::kSocket4_StepPinNumber,
 //    Motate::kSocket6_Microstep_2PinNumber,
 //    Motate::kSocket6_VrefPinNumber> motor_6 {};
 
+// PIO ports carrying the step and direction pins - enables port-grouped step writes (see stepper.cpp)
+#define STEP_PORT_LETTERS 'A', 'B', 'C', 'D'
+
 extern Stepper* Motors[MOTORS];
 
 void board_stepper_init();
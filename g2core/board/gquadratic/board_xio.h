@@ -64,6 +64,42 @@ extern Motate::SPI<Motate::kSocket4_SPISlaveSelectPinNumber> spi;
 extern Motate::UART<Motate::kSerial_RXPinNumber, Motate::kSerial_TXPinNumber, Motate::kSerial_RTSPinNumber, Motate::kSerial_CTSPinNumber> Serial;
 #endif
 
+//******** Network ********
+// Each TCP client on XIO_NET_PORT is a serial device with the same interface as SerialUSB.
+// The first client to connect is ctrl+data, later ones become data channels - the same
+// role mapping as the two USB endpoints.
+#if XIO_HAS_NET
+#include "MotateEthernet.h"
+
+#ifndef XIO_NET_PORT
+#define XIO_NET_PORT 23
+#endif
+#ifndef XIO_NET_CLIENTS
+#define XIO_NET_CLIENTS 2   // 1 or 2
+#endif
+
+typedef Motate::EthernetServer<XIO_NET_PORT, XIO_NET_CLIENTS> XIONetDevice_t;
+
+extern XIONetDevice_t net;
+extern decltype(net.client<0>)& NetClient0;
+#if XIO_NET_CLIENTS == 2
+extern decltype(net.client<1>)& NetClient1;
+#endif
+#endif  // XIO_HAS_NET
+
+
+//******** Buffer sizes ********
+// RX and TX ring sizes per device, in bytes - must be powers of 2. Lines longer
+// than XIO_LINE_BUFFER_SIZE are split. {rxs:n} reports the RAM these take and the
+// overflow counters to size them by.
+#define XIO_USB_RX_BUFFER_SIZE      1024
+#define XIO_USB_TX_BUFFER_SIZE      1024
+#define XIO_UART_RX_BUFFER_SIZE     1024
+#define XIO_UART_TX_BUFFER_SIZE     1024
+#define XIO_NET_RX_BUFFER_SIZE      1024
+#define XIO_NET_TX_BUFFER_SIZE      1024
+#define XIO_LINE_BUFFER_SIZE        RX_BUFFER_SIZE
+
 //******* Generic Functions *******
 void board_hardware_init(void);  // called 1st
 void board_xio_init(void);       // called later
@@ -93,6 +93,7 @@
 #define XIO_HAS_USB 1
 #define XIO_HAS_UART 1
 #define XIO_HAS_SPI 0
+#define XIO_HAS_NET 0       // Ethernet MAC - TCP clients as xio devices
 #define XIO_HAS_I2C 0
 
 #define TEMPERATURE_OUTPUT_ON 0  // NO ADC yet
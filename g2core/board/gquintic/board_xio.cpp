@@ -62,6 +62,17 @@ Motate::SPI<kSocket4_SPISlaveSelectPinNumber> spi;
 #endif
 
 
+//******** Network ********
+#if XIO_HAS_NET
+XIONetDevice_t net;
+
+decltype(net.client<0>) &NetClient0 = net.client<0>;
+#if XIO_NET_CLIENTS == 2
+decltype(net.client<1>) &NetClient1 = net.client<1>;
+#endif
+#endif // XIO_HAS_NET
+
+
 //******** UART ********
 #if XIO_HAS_UART
 Motate::UART<Motate::kSerial_RXPinNumber, Motate::kSerial_TXPinNumber, Motate::kSerial_RTSPinNumber, Motate::kSerial_CTSPinNumber> Serial {115200, Motate::UARTMode::RTSCTSFlowControl};
@@ -87,4 +98,9 @@ void board_xio_init(void) // called later than board_hardware_init (there are th
 #if XIO_HAS_UART
     Serial.init();
 #endif
+
+    // Init network
+#if XIO_HAS_NET
+    net.init();
+#endif
 }
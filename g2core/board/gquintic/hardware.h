@@ -46,6 +46,7 @@
 
 #define MOTORS 4                    // number of motors supported the hardware
 #define PWMS 2                      // number of PWM channels supported the hardware
+#define HEATERS 3                   // number of heaters (thermistor, PID and output) supported the hardware
 
 /*************************
  * Global System Defines *
@@ -55,6 +56,9 @@
 #define SYS_ID_DIGITS 16            // actual digits in system ID (up to 16)
 #define SYS_ID_LEN 24               // total length including dashes and NUL
 
+#define PLANNER_QUEUE_SIZE ((uint8_t)96)    // SAMS70 has the RAM for a deeper look-ahead queue
+#define PLANNER_DOUBLE 1                    // SAMS70 has a double precision FPU - see planner.h
+
 /*************************
  * Motate Setup          *
  *************************/
@@ -32,6 +32,9 @@ ifeq ("$(BASE_BOARD)","printrboardg2")
     export CHIP
     CHIP_LOWERCASE = sam3x8c
 
+    # HOT_PATH functions go in .ramfunc, which the SAM3X linker script puts in .relocate
+    DEVICE_DEFINES += RAMFUNC_HOT_PATHS=$(RAMFUNC_HOT_PATHS)
+
     BOARD_PATH = ./board/printrboardg2
     SOURCE_DIRS += ${BOARD_PATH} device/step_dir_driver device/neopixel
 
@@ -46,6 +46,7 @@
 
 #define MOTORS 4                    // number of motors supported the hardware
 #define PWMS 2                      // number of PWM channels supported the hardware
+#define HEATERS 3                   // number of heaters (thermistor, PID and output) supported the hardware
 
 /*************************
  * Global System Defines *
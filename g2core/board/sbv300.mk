@@ -43,6 +43,9 @@ ifeq ("$(BASE_BOARD)","sbv300")
     export CHIP
     CHIP_LOWERCASE = sam3x8e
 
+    # HOT_PATH functions go in .ramfunc, which the SAM3X linker script puts in .relocate
+    DEVICE_DEFINES += RAMFUNC_HOT_PATHS=$(RAMFUNC_HOT_PATHS)
+
     BOARD_PATH = ./board/sbv300
     SOURCE_DIRS += ${BOARD_PATH} device/step_dir_driver
 
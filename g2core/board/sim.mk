@@ -0,0 +1,61 @@
+# ----------------------------------------------------------------------------
+# This file is part of the Synthetos g2core project
+#
+# Host simulator - see board/sim/sim_main.cpp
+#
+# To compile:
+#   make BOARD=sim
+# And run:
+#   ./bin/sim/g2core ../Resources/gcode/gcode_roadrunner.h
+#
+# SIM_MOTORS sets the motor count (4 to 9, default 4) - clean first when changing it.
+# This builds the firmware for the machine make is run on, with the host C++ compiler and
+# the Motate stand-ins in board/sim/motate instead of Motate. It does not include Motate.mk.
+# SETTINGS_FILE and OPTIMIZATION are honoured. CONFIG is not - the sim has its own board.
+
+SIM_BUILD_DIR ?= build/sim
+SIM_BIN_DIR ?= bin/sim
+SIM_CXX ?= $(CXX)
+
+SIM_BOARD_PATH = ./board/sim
+
+# settings_default.h leaves every axis and motor disabled - run a 3 axis mill unless told otherwise
+ifeq ("$(SETTINGS_FILE)","settings_default.h")
+    SETTINGS_FILE = settings_shapeoko2.h
+endif
+
+# xio.cpp is replaced by board/sim/sim_xio.cpp
+SIM_SOURCES = $(filter-out ./xio.cpp,$(sort $(wildcard ./*.cpp))) $(sort $(wildcard $(SIM_BOARD_PATH)/*.cpp))
+SIM_OBJECTS = $(patsubst ./%.cpp,$(SIM_BUILD_DIR)/%.o,$(SIM_SOURCES))
+
+SIM_MOTORS ?= 4
+
+SIM_DEFINES = __SIMULATOR __BENCHMARK SETTINGS_FILE=$(SETTINGS_FILE) MOTORS=$(SIM_MOTORS)
+ifeq ($(DEBUG),0)
+    SIM_DEFINES += DEBUG=0 IN_DEBUGGER=0
+else
+    SIM_DEFINES += DEBUG=1 IN_DEBUGGER=0
+endif
+
+SIM_INCLUDES = . $(SIM_BOARD_PATH) $(SIM_BOARD_PATH)/motate device/step_dir_driver
+
+SIM_CXXFLAGS = -std=gnu++17 -O$(OPTIMIZATION) -g -Wall -Wno-unused-variable -Wno-unused-function \
+               -fno-exceptions -fno-rtti -fsingle-precision-constant -MMD -MP \
+               $(addprefix -D,$(SIM_DEFINES)) $(addprefix -I,$(SIM_INCLUDES))
+
+.PHONY: all clean
+
+all: $(SIM_BIN_DIR)/$(PROJECT)
+
+$(SIM_BIN_DIR)/$(PROJECT): $(SIM_OBJECTS)
+	@mkdir -p $(dir $@)
+	$(SIM_CXX) -o $@ $^ -lm
+
+$(SIM_BUILD_DIR)/%.o: ./%.cpp
+	@mkdir -p $(dir $@)
+	$(SIM_CXX) $(SIM_CXXFLAGS) -c $< -o $@
+
+clean:
+	rm -rf $(SIM_BUILD_DIR) $(SIM_BIN_DIR)
+
+-include $(SIM_OBJECTS:.o=.d)
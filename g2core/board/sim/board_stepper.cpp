@@ -0,0 +1,68 @@
+/*
+ * board_stepper.cpp - board-specific code for stepper.cpp
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "board_stepper.h"
+
+SimStepper motor_1;
+SimStepper motor_2;
+SimStepper motor_3;
+SimStepper motor_4;
+#if (MOTORS >= 5)
+SimStepper motor_5;
+#endif
+#if (MOTORS >= 6)
+SimStepper motor_6;
+#endif
+#if (MOTORS >= 7)
+SimStepper motor_7;
+#endif
+#if (MOTORS >= 8)
+SimStepper motor_8;
+#endif
+#if (MOTORS >= 9)
+SimStepper motor_9;
+#endif
+
+Stepper* Motors[MOTORS] = {&motor_1, &motor_2, &motor_3, &motor_4
+#if (MOTORS >= 5)
+    , &motor_5
+#endif
+#if (MOTORS >= 6)
+    , &motor_6
+#endif
+#if (MOTORS >= 7)
+    , &motor_7
+#endif
+#if (MOTORS >= 8)
+    , &motor_8
+#endif
+#if (MOTORS >= 9)
+    , &motor_9
+#endif
+};
+
+void board_stepper_init() {
+    for (uint8_t motor = 0; motor < MOTORS; motor++) { Motors[motor]->init(); }
+}
@@ -0,0 +1,81 @@
+/*
+ * board_stepper.h - board-specific code for stepper.h
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  SimStepper stands in for a step/direction driver. It keeps the running step count and
+ *  the direction of its motor, which the simulator samples for the step trace. The motors
+ *  are declared as the concrete final type so the DDA calls stepStart() directly, the same
+ *  way it does for StepDirStepper on the ARM boards.
+ */
+#ifndef BOARD_STEPPER_H_ONCE
+#define BOARD_STEPPER_H_ONCE
+
+#include "hardware.h"  // for MOTORS
+#include "stepper.h"
+
+struct SimStepper final : Stepper {
+    int32_t position = 0;               // steps, counted in the direction last set
+    int8_t step_sign = 1;               // +1 for DIRECTION_CW, -1 for DIRECTION_CCW
+    bool enabled = false;
+
+    SimStepper() : Stepper{} {};
+
+    bool canStep() override { return true; };
+    void _enableImpl() override { enabled = true; };
+    void _disableImpl() override { enabled = false; };
+    void stepStart() override { position += step_sign; };
+    void stepEnd() override {};
+    void setDirection(uint8_t new_direction) override {
+        step_sign = (new_direction == DIRECTION_CW) ? 1 : -1;
+    };
+    uint32_t getDirectionSetupNs() const override { return DIRECTION_SETUP_NS; };
+    uint32_t getDirectionHoldNs() const override { return DIRECTION_HOLD_NS; };
+};
+
+extern SimStepper motor_1;
+extern SimStepper motor_2;
+extern SimStepper motor_3;
+extern SimStepper motor_4;
+#if (MOTORS >= 5)
+extern SimStepper motor_5;
+#endif
+#if (MOTORS >= 6)
+extern SimStepper motor_6;
+#endif
+#if (MOTORS >= 7)
+extern SimStepper motor_7;
+#endif
+#if (MOTORS >= 8)
+extern SimStepper motor_8;
+#endif
+#if (MOTORS >= 9)
+extern SimStepper motor_9;
+#endif
+
+extern Stepper* Motors[MOTORS];
+
+void board_stepper_init();
+
+#endif  // BOARD_STEPPER_H_ONCE
@@ -0,0 +1,53 @@
+/*
+ * board_xio.h - extended IO functions that are board-specific
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ *  The simulator has no serial devices. board/sim/sim_xio.cpp takes the place of xio.cpp:
+ *  lines are read from the G-code file given on the command line and everything written
+ *  goes to stdout.
+ */
+
+#ifndef board_xio_h
+#define board_xio_h
+
+#include "settings.h"
+
+#define XIO_LINE_BUFFER_SIZE        RX_BUFFER_SIZE
+
+//******* Generic Functions *******
+void board_hardware_init(void);  // called 1st
+void board_xio_init(void);       // called later
+
+//******* Simulator Functions *******
+bool sim_xio_open(const char *path);    // load the G-code file to play - false if it can't be read
+bool sim_xio_input_done(void);          // true once every line has been read
+void sim_xio_set_link(uint32_t bytes_per_s);    // pace the file as a link this fast - 0 for no link
+const char *sim_xio_text(size_t &len);  // text of the loaded file - the literals of a .h file
+bool sim_xio_open_replay(const char *path);     // load a captured session to play instead - see capture.h
+void sim_xio_replay_tick(void);         // called after each controller pass while replaying
+void sim_xio_replay_report(void);       // write the replay measurements to stderr
+
+#endif  // board_xio_h
@@ -0,0 +1,149 @@
+/*
+ * hardware.h - system hardware configuration
+ * For: /board/sim
+ * THIS FILE IS HARDWARE PLATFORM SPECIFIC - host simulator version
+ *
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/> .
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+#include "error.h"
+
+#ifndef HARDWARE_H_ONCE
+#define HARDWARE_H_ONCE
+
+/*--- Hardware platform enumerations ---*/
+
+#define G2CORE_HARDWARE_PLATFORM    "sim"
+#define G2CORE_HARDWARE_VERSION     "na"
+
+/***** Motors & PWM channels supported by this hardware *****/
+// These must be defines (not enums) so expressions like this:
+//  #if (MOTORS >= 6)  will work
+
+#ifndef MOTORS                      // make BOARD=sim SIM_MOTORS=9 builds the other motor counts
+#define MOTORS 4                    // number of motors supported the hardware
+#endif
+#define PWMS 2                      // number of PWM channels supported the hardware
+#define HEATERS 3                   // number of heaters (thermistor, PID and output) supported the hardware
+
+/*************************
+ * Global System Defines *
+ *************************/
+
+#define MILLISECONDS_PER_TICK 1     // MS for system tick (systick * N)
+#define SYS_ID_DIGITS 16            // actual digits in system ID (up to 16)
+#define SYS_ID_LEN 24               // total length including dashes and NUL
+
+/*************************
+ * Motate Setup          *
+ *************************/
+
+#include "MotatePins.h"
+#include "MotateTimers.h"           // for TimerChanel<> and related...
+#include "MotateServiceCall.h"      // for ServiceCall<>
+
+using Motate::TimerChannel;
+using Motate::ServiceCall;
+
+using Motate::pin_number;
+using Motate::Pin;
+using Motate::PWMOutputPin;
+using Motate::OutputPin;
+
+/************************************************************************************
+ **** HOST SIMULATOR ****************************************************************
+ ************************************************************************************/
+
+/* There are no interrupts. The simulator (sim_main.cpp) runs the timer "interrupts" between
+ * controller passes, in the order of their priority on the ARM boards:
+ *
+ *   1. FWD_PLAN and EXEC software interrupts, if they have been requested
+ *   2. DDA_TIMER ticks, and SysTick every millisecond of DDA time, while the DDA runs
+ *   3. SysTick alone (1 ms per controller pass) while the DDA is stopped
+ */
+
+/**** Stepper DDA and dwell timer settings ****/
+
+#define FREQUENCY_DDA		150000UL		// Hz step frequency - DDA ticks per second of simulated time
+#define FREQUENCY_DWELL		1000UL
+#define FREQUENCY_SGI		200000UL		// not used - software interrupts run on the next simulator pass
+
+/**** Motate Definitions ****/
+
+// Timer definitions. See stepper.h and other headers for setup
+typedef TimerChannel<3,0> dda_timer_type;	// stepper pulse generation in stepper.cpp
+typedef TimerChannel<4,0> exec_timer_type;	// request exec timer in stepper.cpp
+typedef TimerChannel<5,0> fwd_plan_timer_type;	// request exec timer in stepper.cpp
+
+// Pin assignments
+
+pin_number indicator_led_pin_num = Motate::kLED_USBRXPinNumber;
+static PWMOutputPin<indicator_led_pin_num> IndicatorLed;
+
+/**** Motate Global Pin Allocations ****/
+
+static OutputPin<Motate::kSpindle_EnablePinNumber> spindle_enable_pin;
+static OutputPin<Motate::kSpindle_DirPinNumber> spindle_dir_pin;
+
+static OutputPin<Motate::kCoolant_EnablePinNumber> flood_enable_pin;
+static OutputPin<Motate::kCoolant_EnablePinNumber> mist_enable_pin;
+
+// Input pins are defined in gpio.cpp
+
+/********************************
+ * Function Prototypes (Common) *
+ ********************************/
+
+void hardware_init(void);			// master hardware init
+stat_t hardware_periodic();  // callback from the main loop (time sensitive)
+void hw_hard_reset(void);
+stat_t hw_flash(nvObj_t *nv);
+
+stat_t hw_get_fb(nvObj_t *nv);
+stat_t hw_get_fv(nvObj_t *nv);
+stat_t hw_get_hp(nvObj_t *nv);
+stat_t hw_get_hv(nvObj_t *nv);
+stat_t hw_get_fbs(nvObj_t *nv);
+stat_t hw_get_fbc(nvObj_t *nv);
+stat_t hw_get_id(nvObj_t *nv);
+
+void sim_run_interrupts(void);      // sim_main.cpp - called by the controller after every pass
+double sim_time_ms(void);           // sim_main.cpp - simulated time
+int sim_bench(uint32_t rounds, int count, char *paths[]);   // sim_bench.cpp - micro-benchmarks (-u)
+
+#ifdef __TEXT_MODE
+
+    void hw_print_fb(nvObj_t *nv);
+    void hw_print_fv(nvObj_t *nv);
+    void hw_print_fbs(nvObj_t *nv);
+    void hw_print_fbc(nvObj_t *nv);
+    void hw_print_hp(nvObj_t *nv);
+    void hw_print_hv(nvObj_t *nv);
+    void hw_print_id(nvObj_t *nv);
+
+#else
+
+    #define hw_print_fb tx_print_stub
+    #define hw_print_fv tx_print_stub
+    #define hw_print_fbs tx_print_stub
+    #define hw_print_fbc tx_print_stub
+    #define hw_print_hp tx_print_stub
+    #define hw_print_hv tx_print_stub
+    #define hw_print_id tx_print_stub
+
+#endif // __TEXT_MODE
+
+#endif	// end of include guard: HARDWARE_H_ONCE
@@ -0,0 +1,185 @@
+/*
+ * MotatePins.h - host stand-in for the Motate pins used by g2core
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  Pins only hold their value. Outputs remember what was written and inputs read back as
+ *  pulled up (high) - nothing is driven from outside yet. Pin number -1 is the null pin,
+ *  as in Motate, and every named pin in sim-pinout.h has its own number so templates
+ *  specialized per pin (ADCPin<>::interrupt() in temperature.cpp) stay distinct.
+ */
+
+#ifndef MOTATE_PINS_H_ONCE
+#define MOTATE_PINS_H_ONCE
+
+#include <stdint.h>
+#include <functional>
+
+#include "sim_cmsis.h"
+#include "MotateTimers.h"
+
+namespace Motate {
+
+typedef const int16_t pin_number;
+
+enum PinMode {
+    kUnchanged      = 0,
+    kOutput         = 1,
+    kInput          = 2,
+    kPeripheralA    = 3,
+    kPeripheralB    = 4,
+    kPeripheralC    = 5,
+    kPeripheralD    = 6,
+};
+
+enum PinOptions {
+    kNormal         = 0,
+    kTotem          = 0,
+    kPullUp         = 1<<1,
+    kWiredAnd       = 1<<2,
+    kDriveLowOnly   = 1<<3,
+    kDeglitch       = 1<<4,
+    kDebounce       = 1<<5,
+    kStartHigh      = 1<<6,
+    kStartLow       = 1<<7,
+    kPWMPinInverted = 1<<8,
+};
+
+enum PinInterruptOptions {
+    kPinInterruptsOff           = 0,
+    kPinInterruptOnChange       = 1,
+    kPinInterruptOnRisingEdge   = 2,
+    kPinInterruptOnFallingEdge  = 3,
+    kPinInterruptOnLowLevel     = 4,
+    kPinInterruptOnHighLevel    = 5,
+    kPinInterruptTypeMask       = 0x7,
+
+    kPinInterruptPriorityHighest = 1<<5,
+    kPinInterruptPriorityHigh    = 1<<6,
+    kPinInterruptPriorityMedium  = 1<<7,
+    kPinInterruptPriorityLow     = 1<<8,
+    kPinInterruptPriorityLowest  = 1<<9,
+};
+
+/**** Pins ****/
+
+template <pin_number pinNum>
+struct Pin {
+    bool _value = true;                 // as read - inputs are pulled up
+    uint32_t _options = 0;
+
+    Pin() {};
+    Pin(const PinMode mode, const uint32_t options = kNormal) : _options{options} {};
+
+    static constexpr bool isNull() { return (pinNum < 0); };
+    void setMode(const PinMode mode) {};
+    void setOptions(const uint32_t options, const bool fromConstructor = false) { _options = options; };
+    uint32_t getOptions() { return (_options); };
+    void set() { _value = true; };
+    void clear() { _value = false; };
+    void toggle() { _value = !_value; };
+    void write(const bool value) { _value = value; };
+    bool get() { return (_value); };
+    bool getInputValue() { return (_value); };
+    bool getOutputValue() { return (_value); };
+
+    Pin &operator=(const bool value) { write(value); return (*this); };
+    operator bool() { return (_value); };
+};
+
+template <pin_number pinNum>
+struct OutputPin : Pin<pinNum> {
+    OutputPin() : Pin<pinNum>(kOutput) { Pin<pinNum>::_value = false; };
+    OutputPin(const uint32_t options) : Pin<pinNum>(kOutput, options) {
+        Pin<pinNum>::_value = (options & kStartHigh);
+    };
+    using Pin<pinNum>::operator=;
+};
+
+template <pin_number pinNum>
+struct InputPin : Pin<pinNum> {
+    InputPin() : Pin<pinNum>(kInput, kPullUp) {};
+    InputPin(const uint32_t options) : Pin<pinNum>(kInput, options) {};
+};
+
+template <pin_number pinNum>
+struct IRQPin : InputPin<pinNum> {
+    std::function<void(void)> _callback;
+    uint32_t _interrupts = kPinInterruptOnChange;
+
+    IRQPin(const uint32_t options, const std::function<void(void)> &&callback,
+           const uint32_t interrupts = kPinInterruptOnChange|kPinInterruptPriorityMedium)
+        : InputPin<pinNum>(options), _callback{callback}, _interrupts{interrupts} {};
+
+    void setInterrupts(const uint32_t interrupts) { _interrupts = interrupts; };
+    void setInterruptHandler(std::function<void(void)> &&callback) { _callback = callback; };
+};
+
+template <pin_number pinNum>
+struct PWMOutputPin : Pin<pinNum> {
+    float _duty = 0.0;
+    uint32_t _frequency = 0;
+
+    PWMOutputPin() : Pin<pinNum>(kOutput) {};
+    PWMOutputPin(const uint32_t options, const uint32_t freq = 0) : Pin<pinNum>(kOutput, options), _frequency{freq} {};
+
+    void setFrequency(const uint32_t freq) { _frequency = freq; };
+    uint32_t getFrequency() { return (_frequency); };
+    void write(const float duty) { _duty = duty; Pin<pinNum>::_value = (duty > 0.0); };
+    float get() { return (_duty); };
+    PWMOutputPin &operator=(const float duty) { write(duty); return (*this); };
+    operator float() { return (_duty); };
+};
+
+template <pin_number pinNum>
+struct PWMLikeOutputPin : PWMOutputPin<pinNum> {
+    PWMLikeOutputPin() : PWMOutputPin<pinNum>() {};
+    PWMLikeOutputPin(const uint32_t options, const uint32_t freq = 0) : PWMOutputPin<pinNum>(options, freq) {};
+    using PWMOutputPin<pinNum>::operator=;
+};
+
+template <pin_number pinNum>
+struct ADCPin : Pin<pinNum> {
+    uint32_t _raw = 0;
+
+    ADCPin() : Pin<pinNum>(kInput) {};
+
+    void setInterrupts(const uint32_t interrupts) {};
+    int32_t getRaw() { return (_raw); };
+    uint32_t getTop() { return (4095); };
+    void startSampling() {};
+
+    void interrupt();                   // specialized by the user of the pin (temperature.cpp)
+};
+
+template <pin_number pinNum>
+using NullPin = Pin<-1>;
+
+template <char portLetter>
+struct Port32 {
+    uint32_t _value = 0;
+
+    void set(const uint32_t mask) { _value |= mask; };
+    void clear(const uint32_t mask) { _value &= ~mask; };
+    void write(const uint32_t value) { _value = value; };
+    uint32_t getInputValues(const uint32_t mask = 0xffffffff) { return (_value & mask); };
+};
+
+} // namespace Motate
+
+#include "sim-pinout.h"
+
+#endif // MOTATE_PINS_H_ONCE
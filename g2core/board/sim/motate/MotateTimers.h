@@ -0,0 +1,159 @@
+/*
+ * MotateTimers.h - host stand-in for the Motate timers used by g2core
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  Nothing here runs on its own. Time only moves when the simulator (sim_main.cpp) moves it:
+ *  SysTick is a virtual millisecond counter and a TimerChannel interrupt is called when the
+ *  simulator decides it fires. Software triggered timers (exec, forward plan) are marked
+ *  pending and run by sim_run_interrupts() between controller passes.
+ */
+
+#ifndef MOTATE_TIMERS_H_ONCE
+#define MOTATE_TIMERS_H_ONCE
+
+#include <stdint.h>
+#include <functional>
+
+#include "sim_cmsis.h"
+
+namespace Motate {
+
+/**** SysTick ****/
+
+struct SysTickEvent {
+    const std::function<void(void)> callback;
+    SysTickEvent *next;
+};
+
+struct SimSysTick {
+    volatile uint32_t _value = 0;       // virtual milliseconds since start
+    SysTickEvent *_first_event = nullptr;
+
+    uint32_t getValue() { return _value; };
+
+    void registerEvent(SysTickEvent *new_event) {
+        if (_first_event == nullptr) {
+            _first_event = new_event;
+            return;
+        }
+        SysTickEvent *event = _first_event;
+        while (event->next != nullptr) {
+            if (event == new_event) { return; }
+            event = event->next;
+        }
+        if (event != new_event) {
+            event->next = new_event;
+            new_event->next = nullptr;
+        }
+    };
+
+    void unregisterEvent(SysTickEvent *old_event) {
+        if (_first_event == old_event) {
+            _first_event = old_event->next;
+            old_event->next = nullptr;
+            return;
+        }
+        for (SysTickEvent *event = _first_event; event != nullptr; event = event->next) {
+            if (event->next == old_event) {
+                event->next = old_event->next;
+                old_event->next = nullptr;
+                return;
+            }
+        }
+    };
+
+    void _tick() {                      // one virtual millisecond - called by the simulator
+        _value++;
+        SysTickEvent *event = _first_event;
+        while (event != nullptr) {
+            SysTickEvent *next = event->next;   // the callback may unregister itself
+            event->callback();
+            event = next;
+        }
+    };
+};
+
+extern SimSysTick SysTickTimer;
+
+/**** Timeout ****/
+
+struct Timeout {
+    uint32_t _start = 0;
+    uint32_t _delay = 0;
+    bool _set = false;
+
+    bool isSet() { return _set; };
+    bool isPast() { return (_set && ((SysTickTimer.getValue() - _start) >= _delay)); };
+    void set(uint32_t delay) { _start = SysTickTimer.getValue(); _delay = delay; _set = true; };
+    void clear() { _set = false; };
+};
+
+void delay(uint32_t ms);                // advances virtual time
+
+/**** Timers ****/
+
+enum TimerMode {
+    kTimerUpToMatch = 0,
+    kTimerUp,
+    kTimerUpDown,
+    kTimerUpToMatchAndDown,
+};
+
+enum TimerChannelInterruptOptions {
+    kInterruptsOff              = 0,
+    kInterruptOnMatch           = 1<<1,
+    kInterruptOnOverflow        = 1<<2,
+    kInterruptOnSoftwareTrigger = 1<<3,
+
+    kInterruptPriorityHighest   = 1<<5,
+    kInterruptPriorityHigh      = 1<<6,
+    kInterruptPriorityMedium    = 1<<7,
+    kInterruptPriorityLow       = 1<<8,
+    kInterruptPriorityLowest    = 1<<9,
+};
+
+enum TimerSyncMode {
+    kTimerSyncManually = 0,
+    kTimerSyncDMA      = 1,
+};
+
+template <uint8_t timerNum, uint8_t channelNum>
+struct TimerChannel {
+    bool _running = false;
+    bool _pending = false;
+    uint32_t _frequency = 0;
+    uint32_t _interrupts = 0;
+
+    TimerChannel() {};
+    TimerChannel(const TimerMode mode, const uint32_t freq) : _frequency{freq} {};
+
+    void setModeAndFrequency(const TimerMode mode, const uint32_t freq) { _frequency = freq; };
+    void setInterrupts(const uint32_t interrupts) { _interrupts = interrupts; };
+    uint32_t getInterruptCause() { _pending = false; return (kInterruptOnOverflow); };
+    void setInterruptPending() { _pending = true; };
+    bool isPending() { return (_pending); };
+    bool isRunning() { return (_running); };
+    void start() { _running = true; };
+    void stop() { _running = false; };
+    uint32_t getFrequency() { return (_frequency); };
+
+    void interrupt();                   // defined by the user of the timer (stepper.cpp)
+};
+
+} // namespace Motate
+
+#endif // MOTATE_TIMERS_H_ONCE
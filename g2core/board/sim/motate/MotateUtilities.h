@@ -0,0 +1,35 @@
+/*
+ * MotateUtilities.h - host stand-in for the Motate string and byte order helpers
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MOTATE_UTILITIES_H_ONCE
+#define MOTATE_UTILITIES_H_ONCE
+
+#include <stdint.h>
+#include <string.h>
+
+namespace Motate {
+    inline size_t strlen(const char *p) { return (::strlen(p)); }
+    inline char *strncpy(char *t, const char *f, size_t size) { return (::strncpy(t, f, size)); }
+
+    inline uint16_t fromBigEndian(const uint16_t value) { return (__builtin_bswap16(value)); }
+    inline uint32_t fromBigEndian(const uint32_t value) { return (__builtin_bswap32(value)); }
+    inline uint16_t toBigEndian(const uint16_t value) { return (__builtin_bswap16(value)); }
+    inline uint32_t toBigEndian(const uint32_t value) { return (__builtin_bswap32(value)); }
+}
+
+#endif // MOTATE_UTILITIES_H_ONCE
@@ -0,0 +1,66 @@
+/*
+ * sim_cmsis.h - host stand-ins for the CMSIS core registers and intrinsics g2core uses
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  The DWT cycle counter reads the host's monotonic clock in nanoseconds, and SystemCoreClock
+ *  is 1 GHz to match, so cycle_count() / cycles_to_usec() based measurements ({segx:},
+ *  {prof:}) report host execution time. Interrupt masking is a no-op - the simulator only
+ *  runs "interrupts" between controller passes, never inside one.
+ */
+
+#ifndef SIM_CMSIS_H_ONCE
+#define SIM_CMSIS_H_ONCE
+
+#include <stdint.h>
+
+#define __CORTEX_M (0x00)               // no D-cache, no FPU specifics
+
+extern uint32_t SystemCoreClock;
+
+uint32_t sim_host_nanoseconds(void);
+
+struct SimCycleCounter {
+    operator uint32_t() const { return (sim_host_nanoseconds()); };
+    SimCycleCounter &operator=(uint32_t) { return (*this); };
+};
+
+struct SimDWT_Type {
+    SimCycleCounter CYCCNT;
+    uint32_t CTRL;
+    uint32_t LAR;
+};
+
+struct SimCoreDebug_Type {
+    uint32_t DEMCR;
+};
+
+extern SimDWT_Type sim_dwt;
+extern SimCoreDebug_Type sim_core_debug;
+
+#define DWT (&sim_dwt)
+#define CoreDebug (&sim_core_debug)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+inline void __NOP(void) {}
+inline void __DSB(void) {}
+inline void __DMB(void) {}
+inline void __WFI(void) {}
+inline void __disable_irq(void) {}
+inline void __enable_irq(void) {}
+
+#endif // SIM_CMSIS_H_ONCE
@@ -0,0 +1,201 @@
+/*
+ * sim-pinout.h - pin names for the host simulator
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  The numbers mean nothing beyond being distinct. The ADCn_AVAILABLE flags are left
+ *  undefined, so temperature.cpp builds its thermistors without ADC interrupts.
+ */
+
+#ifndef SIM_PINOUT_H_ONCE
+#define SIM_PINOUT_H_ONCE
+
+namespace Motate {
+// Motor socket 1
+constexpr pin_number kSocket1_StepPinNumber               =   1;
+constexpr pin_number kSocket1_DirPinNumber                =   2;
+constexpr pin_number kSocket1_EnablePinNumber             =   3;
+constexpr pin_number kSocket1_Microstep_0PinNumber        =   4;
+constexpr pin_number kSocket1_Microstep_1PinNumber        =   5;
+constexpr pin_number kSocket1_Microstep_2PinNumber        =   6;
+constexpr pin_number kSocket1_VrefPinNumber               =   7;
+constexpr pin_number kSocket1_InterruptPinNumber          =   8;
+constexpr pin_number kSocket1_SPISlaveSelectPinNumber     =   9;
+
+// Motor socket 2
+constexpr pin_number kSocket2_StepPinNumber               =  10;
+constexpr pin_number kSocket2_DirPinNumber                =  11;
+constexpr pin_number kSocket2_EnablePinNumber             =  12;
+constexpr pin_number kSocket2_Microstep_0PinNumber        =  13;
+constexpr pin_number kSocket2_Microstep_1PinNumber        =  14;
+constexpr pin_number kSocket2_Microstep_2PinNumber        =  15;
+constexpr pin_number kSocket2_VrefPinNumber               =  16;
+constexpr pin_number kSocket2_InterruptPinNumber          =  17;
+constexpr pin_number kSocket2_SPISlaveSelectPinNumber     =  18;
+
+// Motor socket 3
+constexpr pin_number kSocket3_StepPinNumber               =  19;
+constexpr pin_number kSocket3_DirPinNumber                =  20;
+constexpr pin_number kSocket3_EnablePinNumber             =  21;
+constexpr pin_number kSocket3_Microstep_0PinNumber        =  22;
+constexpr pin_number kSocket3_Microstep_1PinNumber        =  23;
+constexpr pin_number kSocket3_Microstep_2PinNumber        =  24;
+constexpr pin_number kSocket3_VrefPinNumber               =  25;
+constexpr pin_number kSocket3_InterruptPinNumber          =  26;
+constexpr pin_number kSocket3_SPISlaveSelectPinNumber     =  27;
+
+// Motor socket 4
+constexpr pin_number kSocket4_StepPinNumber               =  28;
+constexpr pin_number kSocket4_DirPinNumber                =  29;
+constexpr pin_number kSocket4_EnablePinNumber             =  30;
+constexpr pin_number kSocket4_Microstep_0PinNumber        =  31;
+constexpr pin_number kSocket4_Microstep_1PinNumber        =  32;
+constexpr pin_number kSocket4_Microstep_2PinNumber        =  33;
+constexpr pin_number kSocket4_VrefPinNumber               =  34;
+constexpr pin_number kSocket4_InterruptPinNumber          =  35;
+constexpr pin_number kSocket4_SPISlaveSelectPinNumber     =  36;
+
+// Motor socket 5
+constexpr pin_number kSocket5_StepPinNumber               =  37;
+constexpr pin_number kSocket5_DirPinNumber                =  38;
+constexpr pin_number kSocket5_EnablePinNumber             =  39;
+constexpr pin_number kSocket5_Microstep_0PinNumber        =  40;
+constexpr pin_number kSocket5_Microstep_1PinNumber        =  41;
+constexpr pin_number kSocket5_Microstep_2PinNumber        =  42;
+constexpr pin_number kSocket5_VrefPinNumber               =  43;
+constexpr pin_number kSocket5_InterruptPinNumber          =  44;
+constexpr pin_number kSocket5_SPISlaveSelectPinNumber     =  45;
+
+// Motor socket 6
+constexpr pin_number kSocket6_StepPinNumber               =  46;
+constexpr pin_number kSocket6_DirPinNumber                =  47;
+constexpr pin_number kSocket6_EnablePinNumber             =  48;
+constexpr pin_number kSocket6_Microstep_0PinNumber        =  49;
+constexpr pin_number kSocket6_Microstep_1PinNumber        =  50;
+constexpr pin_number kSocket6_Microstep_2PinNumber        =  51;
+constexpr pin_number kSocket6_VrefPinNumber               =  52;
+constexpr pin_number kSocket6_InterruptPinNumber          =  53;
+constexpr pin_number kSocket6_SPISlaveSelectPinNumber     =  54;
+
+// Digital inputs
+constexpr pin_number kInput1_PinNumber                    =  55;
+constexpr pin_number kInput2_PinNumber                    =  56;
+constexpr pin_number kInput3_PinNumber                    =  57;
+constexpr pin_number kInput4_PinNumber                    =  58;
+constexpr pin_number kInput5_PinNumber                    =  59;
+constexpr pin_number kInput6_PinNumber                    =  60;
+constexpr pin_number kInput7_PinNumber                    =  61;
+constexpr pin_number kInput8_PinNumber                    =  62;
+constexpr pin_number kInput9_PinNumber                    =  63;
+constexpr pin_number kInput10_PinNumber                   =  64;
+constexpr pin_number kInput11_PinNumber                   =  65;
+constexpr pin_number kInput12_PinNumber                   =  66;
+constexpr pin_number kInput13_PinNumber                   =  67;
+constexpr pin_number kInput14_PinNumber                   =  68;
+
+// Digital outputs
+constexpr pin_number kOutput1_PinNumber                   =  69;
+constexpr pin_number kOutput2_PinNumber                   =  70;
+constexpr pin_number kOutput3_PinNumber                   =  71;
+constexpr pin_number kOutput4_PinNumber                   =  72;
+constexpr pin_number kOutput5_PinNumber                   =  73;
+constexpr pin_number kOutput6_PinNumber                   =  74;
+constexpr pin_number kOutput7_PinNumber                   =  75;
+constexpr pin_number kOutput8_PinNumber                   =  76;
+constexpr pin_number kOutput9_PinNumber                   =  77;
+constexpr pin_number kOutput10_PinNumber                  =  78;
+constexpr pin_number kOutput11_PinNumber                  =  79;
+constexpr pin_number kOutput12_PinNumber                  =  80;
+constexpr pin_number kOutput13_PinNumber                  =  81;
+constexpr pin_number kOutput14_PinNumber                  =  82;
+constexpr pin_number kOutput15_PinNumber                  =  83;
+constexpr pin_number kOutput16_PinNumber                  =  84;
+
+// Analog inputs
+constexpr pin_number kADC0_PinNumber                      =  85;
+constexpr pin_number kADC1_PinNumber                      =  86;
+constexpr pin_number kADC2_PinNumber                      =  87;
+constexpr pin_number kADC3_PinNumber                      =  88;
+constexpr pin_number kADC4_PinNumber                      =  89;
+constexpr pin_number kADC5_PinNumber                      =  90;
+constexpr pin_number kADC6_PinNumber                      =  91;
+constexpr pin_number kADC7_PinNumber                      =  92;
+constexpr pin_number kADC8_PinNumber                      =  93;
+constexpr pin_number kADC9_PinNumber                      =  94;
+constexpr pin_number kADC10_PinNumber                     =  95;
+constexpr pin_number kADC11_PinNumber                     =  96;
+constexpr pin_number kADC12_PinNumber                     =  97;
+constexpr pin_number kADC13_PinNumber                     =  98;
+constexpr pin_number kADC14_PinNumber                     =  99;
+
+// Axis switches
+constexpr pin_number kXAxis_MinPinNumber                  = 100;
+constexpr pin_number kXAxis_MaxPinNumber                  = 101;
+constexpr pin_number kYAxis_MinPinNumber                  = 102;
+constexpr pin_number kYAxis_MaxPinNumber                  = 103;
+constexpr pin_number kZAxis_MinPinNumber                  = 104;
+constexpr pin_number kZAxis_MaxPinNumber                  = 105;
+constexpr pin_number kAAxis_MinPinNumber                  = 106;
+constexpr pin_number kAAxis_MaxPinNumber                  = 107;
+constexpr pin_number kBAxis_MinPinNumber                  = 108;
+constexpr pin_number kBAxis_MaxPinNumber                  = 109;
+constexpr pin_number kCAxis_MinPinNumber                  = 110;
+constexpr pin_number kCAxis_MaxPinNumber                  = 111;
+
+// Spindle, coolant and safety
+constexpr pin_number kSpindle_EnablePinNumber             = 112;
+constexpr pin_number kSpindle_DirPinNumber                = 113;
+constexpr pin_number kSpindle_PwmPinNumber                = 114;
+constexpr pin_number kSpindle_Pwm2PinNumber               = 115;
+constexpr pin_number kCoolant_EnablePinNumber             = 116;
+constexpr pin_number kOutputSAFE_PinNumber                = 117;
+constexpr pin_number kOutputInterrupt_PinNumber           = 118;
+constexpr pin_number kInterlock_InPinNumber               = 119;
+
+// Indicators and debug
+constexpr pin_number kLED_USBRXPinNumber                  = 120;
+constexpr pin_number kLED_USBTXPinNumber                  = 121;
+constexpr pin_number kLEDPWM_PinNumber                    = 122;
+constexpr pin_number kLED_RGBWPixelPinNumber              = 123;
+constexpr pin_number kDebug1_PinNumber                    = 124;
+constexpr pin_number kDebug2_PinNumber                    = 125;
+constexpr pin_number kDebug3_PinNumber                    = 126;
+constexpr pin_number kDebug4_PinNumber                    = 127;
+
+// Shield and bus pins
+constexpr pin_number kKinen_SyncPinNumber                 = 128;
+constexpr pin_number kGRBL_ResetPinNumber                 = 129;
+constexpr pin_number kGRBL_FeedHoldPinNumber              = 130;
+constexpr pin_number kGRBL_CycleStartPinNumber            = 131;
+constexpr pin_number kGRBL_CommonEnablePinNumber          = 132;
+constexpr pin_number kSPI_MISOPinNumber                   = 133;
+constexpr pin_number kSPI_MOSIPinNumber                   = 134;
+constexpr pin_number kSPI_SCKPinNumber                    = 135;
+constexpr pin_number kSPI0_MISOPinNumber                  = 136;
+constexpr pin_number kSPI0_MOSIPinNumber                  = 137;
+constexpr pin_number kSPI0_SCKPinNumber                   = 138;
+constexpr pin_number kSerial_RXPinNumber                  = 139;
+constexpr pin_number kSerial_TXPinNumber                  = 140;
+constexpr pin_number kSerial_RTSPinNumber                 = 141;
+constexpr pin_number kSerial_CTSPinNumber                 = 142;
+constexpr pin_number kServo1_PinNumber                    = 143;
+constexpr pin_number kServo2_PinNumber                    = 144;
+constexpr pin_number kServo3_PinNumber                    = 145;
+constexpr pin_number kExternalClock1_PinNumber            = 146;
+
+} // namespace Motate
+
+#endif // SIM_PINOUT_H_ONCE
@@ -0,0 +1,301 @@
+/*
+ * sim_bench.cpp - parser and formatter micro-benchmarks for the host simulator
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  ./bin/sim/g2core -u rounds file [file...]
+ *
+ *  Times the parsers and formatters one call at a time over recorded traffic - the lines of
+ *  the files, played rounds times - instead of running a job. Lines starting with '{' are
+ *  JSON commands (see Resources/benchmark/json_corpus.txt), the rest are Gcode. Files ending
+ *  in .h are read as the compiled-in programs in Resources/gcode, as when playing a job.
+ *
+ *    gcode_parser()        each Gcode line, with the machine and planner behind it
+ *    json_parse_for_exec() each JSON line, parsed but not run
+ *    json_serialize()      the response body of each JSON line, run by json_parser()
+ *    nv_get_index()        the token of every config table entry
+ *    strtofloat()          each number in the Gcode lines
+ *    c_atof()              the same numbers
+ *    floattoa()            the values of those numbers, to 3 places
+ *
+ *  The rest of the firmware is linked in, so gcode_parser() calls run through the canonical
+ *  machine into the planner. Nothing runs the queue: it is emptied with planner_reset(), and
+ *  arcs are run out with cm_arc_callback(), between calls and outside the timing.
+ *
+ *  Each call is timed with the host clock and the cost of reading the clock is taken off.
+ *  Results go to stderr as ns per call and calls per second - lines per second for the two
+ *  parsers. Host timing is noisy: compare runs on the same machine, with enough rounds.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "hardware.h"
+#include "canonical_machine.h"
+#include "gcode_parser.h"
+#include "json_parser.h"
+#include "plan_arc.h"
+#include "planner.h"
+#include "util.h"
+#include "xio.h"
+#include "board_xio.h"
+
+#include <string>
+#include <vector>
+
+#define SIM_BENCH_CLOCK_SAMPLES 10000   // clock reads averaged for the timing overhead
+#define SIM_BENCH_OUT_LEN 1024          // json_serialize() output buffer
+
+typedef struct simBenchStats {
+    const char *name;
+    uint32_t calls;
+    uint64_t ns;
+    uint32_t errors;                    // calls that returned an error - still timed
+} simBenchStats_t;
+
+static uint32_t _clock_ns;              // cost of a clock read - one falls inside each timing
+
+static inline uint32_t _elapsed(const uint32_t start)
+{
+    uint32_t ns = sim_host_nanoseconds() - start;
+    return ((ns > _clock_ns) ? ns - _clock_ns : 0);
+}
+
+static void _report(const simBenchStats_t &st)
+{
+    double ns = st.calls ? (double)st.ns / st.calls : 0;
+    fprintf(stderr, "sim: %-20s %9u calls %9.1f ns/call %12.0f /s", st.name, st.calls, ns, (ns > 0) ? 1e9 / ns : 0);
+    if (st.errors) {
+        fprintf(stderr, "  (%u errors)", st.errors);
+    }
+    fprintf(stderr, "\n");
+}
+
+/*
+ * _load() - split the files into Gcode lines, JSON lines and the numbers in the Gcode
+ */
+
+static bool _load(int count, char *paths[], std::vector<std::string> &gcode,
+                  std::vector<std::string> &json, std::vector<std::string> &numbers)
+{
+    for (int f = 0; f < count; f++) {
+        if (!sim_xio_open(paths[f])) {
+            fprintf(stderr, "sim: can't read %s\n", paths[f]);
+            return (false);
+        }
+        size_t len;
+        const char *text = sim_xio_text(len);
+        size_t start = 0;
+        while (start < len) {
+            size_t end = start;
+            while ((end < len) && (text[end] != '\n') && (text[end] != '\r')) {
+                end++;
+            }
+            std::string line(text + start, end - start);
+            start = end + 1;
+            if ((line.size() == 0) || (line.size() > RX_BUFFER_SIZE)) {
+                continue;
+            }
+            if (line[0] == '{') {
+                json.push_back(line);
+                continue;
+            }
+            if (strchr("%$!~^Oo", line[0]) != nullptr) {    // controls and O-words aren't Gcode blocks
+                continue;
+            }
+            gcode.push_back(line);
+
+            for (size_t i = 1; i < line.size(); i++) {      // the value of each word
+                if (!isalpha(line[i-1])) {
+                    continue;
+                }
+                size_t n = i;
+                if ((line[n] == '-') || (line[n] == '+')) {
+                    n++;
+                }
+                while ((n < line.size()) && (isdigit(line[n]) || (line[n] == '.'))) {
+                    n++;
+                }
+                if (isdigit(line[n-1])) {
+                    numbers.push_back(line.substr(i, n - i));
+                }
+            }
+        }
+    }
+    return (true);
+}
+
+/*
+ * _bench_gcode() - gcode_parser() over the Gcode lines
+ */
+
+static void _bench_gcode(const std::vector<std::string> &gcode, uint32_t rounds, simBenchStats_t &st)
+{
+    char buf[RX_BUFFER_SIZE+1];
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (const std::string &line : gcode) {
+            while (cm_arc_callback(cm) == STAT_EAGAIN) {
+                planner_reset(mp);
+            }
+            if (mp_planner_is_full(mp)) {
+                planner_reset(mp);
+            }
+            strcpy(buf, line.c_str());
+            uint32_t start = sim_host_nanoseconds();
+            stat_t status = gcode_parser(buf);
+            st.ns += _elapsed(start);
+            st.calls++;
+            if ((status != STAT_OK) && (status != STAT_NOOP)) {
+                st.errors++;
+            }
+        }
+    }
+    while (cm_arc_callback(cm) == STAT_EAGAIN) {
+        planner_reset(mp);
+    }
+    planner_reset(mp);
+}
+
+/*
+ * _bench_json() - json_parse_for_exec() and json_serialize() over the JSON lines
+ */
+
+static void _bench_json(const std::vector<std::string> &json, uint32_t rounds,
+                        simBenchStats_t &parse, simBenchStats_t &serialize)
+{
+    char buf[RX_BUFFER_SIZE+1];
+    char out[SIM_BENCH_OUT_LEN];
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (const std::string &line : json) {
+            strcpy(buf, line.c_str());
+            uint32_t start = sim_host_nanoseconds();
+            json_parse_for_exec(buf, false);
+            parse.ns += _elapsed(start);
+            parse.calls++;
+
+            strcpy(buf, line.c_str());                      // run it as a command to get its response
+            json_parser(buf, true);
+            start = sim_host_nanoseconds();
+            uint16_t len = json_serialize(nv_body, out, sizeof(out));
+            serialize.ns += _elapsed(start);
+            serialize.calls++;
+            if (len == (uint16_t)-1) {
+                serialize.errors++;
+            }
+        }
+    }
+    planner_reset(mp);                                      // {gc:...} lines queue moves
+}
+
+/*
+ * _bench_index() - nv_get_index() over the config table tokens
+ */
+
+static void _bench_index(uint32_t rounds, simBenchStats_t &st)
+{
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (index_t i = 0; i < nv_index_max(); i++) {
+            uint32_t start = sim_host_nanoseconds();
+            index_t index = nv_get_index("", cfgArray[i].token);
+            st.ns += _elapsed(start);
+            st.calls++;
+            if (index == NO_MATCH) {
+                st.errors++;
+            }
+        }
+    }
+}
+
+/*
+ * _bench_numbers() - strtofloat(), c_atof() and floattoa() over the Gcode numbers
+ */
+
+static void _bench_numbers(const std::vector<std::string> &numbers, uint32_t rounds,
+                           simBenchStats_t &atof_st, simBenchStats_t &catof_st, simBenchStats_t &ftoa_st)
+{
+    char buf[32];
+    char out[32];
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (const std::string &number : numbers) {
+            strncpy(buf, number.c_str(), sizeof(buf)-1);
+            buf[sizeof(buf)-1] = NUL;
+
+            char *end;
+            uint32_t start = sim_host_nanoseconds();
+            float value = strtofloat(buf, &end);
+            atof_st.ns += _elapsed(start);
+            atof_st.calls++;
+
+            char *p = buf;
+            start = sim_host_nanoseconds();
+            float c_value = c_atof(p);
+            catof_st.ns += _elapsed(start);
+            catof_st.calls++;
+            if (fp_NE(value, c_value)) {                    // the two readers disagree
+                catof_st.errors++;
+            }
+
+            start = sim_host_nanoseconds();
+            floattoa(out, value, 3);
+            ftoa_st.ns += _elapsed(start);
+            ftoa_st.calls++;
+        }
+    }
+}
+
+/*
+ * sim_bench() - run the micro-benchmarks. Returns the process exit code
+ */
+
+int sim_bench(uint32_t rounds, int count, char *paths[])
+{
+    std::vector<std::string> gcode, json, numbers;
+    if (!_load(count, paths, gcode, json, numbers)) {
+        return (1);
+    }
+
+    uint32_t start = sim_host_nanoseconds();
+    for (uint32_t i = 0; i < SIM_BENCH_CLOCK_SAMPLES; i++) {
+        (void)sim_host_nanoseconds();
+    }
+    _clock_ns = (sim_host_nanoseconds() - start) / SIM_BENCH_CLOCK_SAMPLES;
+
+    simBenchStats_t gc    = { "gcode_parser" };
+    simBenchStats_t jp    = { "json_parse_for_exec" };
+    simBenchStats_t js    = { "json_serialize" };
+    simBenchStats_t ix    = { "nv_get_index" };
+    simBenchStats_t atof  = { "strtofloat" };
+    simBenchStats_t catof = { "c_atof" };
+    simBenchStats_t ftoa  = { "floattoa" };
+
+    _bench_gcode(gcode, rounds, gc);
+    _bench_json(json, rounds, jp, js);
+    _bench_index(rounds, ix);
+    _bench_numbers(numbers, rounds, atof, catof, ftoa);
+
+    fprintf(stderr, "sim: %u rounds of %u Gcode lines, %u JSON lines, %u numbers - clock read %u ns\n",
+            rounds, (unsigned)gcode.size(), (unsigned)json.size(), (unsigned)numbers.size(), _clock_ns);
+    _report(gc);
+    _report(jp);
+    _report(js);
+    _report(ix);
+    _report(atof);
+    _report(catof);
+    _report(ftoa);
+    return (0);
+}
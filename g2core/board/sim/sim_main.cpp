@@ -0,0 +1,362 @@
+/*
+ * sim_main.cpp - host simulator: runs the controller, planner and exec against a G-code file
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  Build with "make BOARD=sim" and run as:
+ *
+ *    ./bin/sim/g2core [-t segments.csv] [-s steps.csv] [-p pass_us] [-m max_seconds] [-b bytes_per_s] [-r] file
+ *
+ *  file is plain G-code, or one of the .h programs in Resources/gcode. Firmware output goes to
+ *  stdout and the statistics to stderr when the job is done.
+ *
+ *  With -u the parsers and formatters are timed over the files instead - see sim_bench.cpp.
+ *
+ *  Time is simulated. Each controller pass is taken to last pass_us (default 100 us) of
+ *  machine time, and the "interrupts" that would have fired in that time are run after the
+ *  pass (sim_run_interrupts()), in priority order:
+ *
+ *    - exec and forward plan, if they have been requested (software interrupts)
+ *    - the DDA, at the rate the stepper set on the timer (FREQUENCY_DDA or a fraction of it -
+ *      see DDA_DIVISOR_MAX), while it is running. Exec and forward plan requested by the
+ *      loader are run between DDA interrupts
+ *    - SysTick, once every millisecond of simulated time
+ *
+ *  So the planner sees the same fill and drain it would on the board if the main loop took
+ *  pass_us per pass. The controller's own run time is not modelled. Host execution times are
+ *  measured for the exec and forward plan interrupts - these, and {segx:} and {prof:}, are
+ *  host figures and only useful relative to one another.
+ *
+ *  -t writes one line per segment as exec prepares it: simulated time the segment was
+ *     prepared, section (0=head, 1=body, 2=tail), velocity (mm/min), segment time (us)
+ *     and the steps commanded for each motor.
+ *  -s writes every motor's step position once every simulated millisecond while it moves.
+ *  -b plays the file over a link of that many bytes per second (11520 for 115200 baud), from
+ *     a host that keeps up to SIM_LINK_WINDOW bytes ahead of the controller - see sim_xio.cpp.
+ *     Without it the file is read as fast as the controller asks.
+ *  -r plays a session captured on a controller ({cap:2} - see capture.h), each line at the
+ *     time it was read there, and reports the read delays, response times and hold times
+ *     seen in the simulator - see sim_xio.cpp. Long sessions need a larger -m.
+ *
+ *  The benchmark (benchmark.h) is armed for the file, so its {"bm":...} line is the last
+ *  thing written to stdout. Resources/benchmark/benchmark.py runs a set of files this way.
+ *
+ *  The job is done once the whole file has been read and the machine has been idle for
+ *  SIM_DONE_MS. Exit status is 0, 1 if the file couldn't be read, and 2 if the job did not
+ *  finish in max_seconds of simulated time (default 3600).
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "hardware.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "stepper.h"
+#include "board_xio.h"
+#include "board_stepper.h"
+#include "benchmark.h"
+
+#include <unistd.h>
+#include <chrono>
+
+#define SIM_DONE_MS 1000                // idle time after the last line before the job is over
+#define SIM_TICKS_PER_MS (FREQUENCY_DDA / 1000)
+
+extern dda_timer_type dda_timer;
+extern exec_timer_type exec_timer;
+extern fwd_plan_timer_type fwd_plan_timer;
+
+void setup(void);
+void loop(void);
+
+/**** Motate stand-ins ****/
+
+uint32_t SystemCoreClock = 1000000000;  // 1 GHz - one "cycle" per host nanosecond
+SimDWT_Type sim_dwt;
+SimCoreDebug_Type sim_core_debug;
+
+namespace Motate {
+    SimSysTick SysTickTimer;
+
+    void delay(uint32_t ms) {
+        while (ms--) { SysTickTimer._tick(); }
+    }
+
+    namespace System {
+        void reset(bool bootloader) {
+            fprintf(stderr, "sim: reset requested - exiting\n");
+            exit(0);
+        }
+    }
+}
+
+uint32_t sim_host_nanoseconds()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return ((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+/**** Simulator state ****/
+
+typedef struct simIsrStats {
+    uint32_t count;
+    uint64_t total_ns;
+    uint32_t max_ns;
+} simIsrStats_t;
+
+typedef struct simState {
+    const char *path;                   // file being played
+    FILE *segment_trace;                // -t
+    FILE *step_trace;                   // -s
+    uint32_t pass_ticks;                // DDA ticks of simulated time per controller pass
+    uint64_t max_ticks;                 // give up after this much simulated time
+
+    uint64_t ticks;                     // simulated time in DDA ticks
+    uint32_t ms_ticks;                  // ticks into the current millisecond
+    uint64_t dda_ticks;                 // ticks the DDA was running
+    uint64_t dda_interrupts;            // DDA interrupts run
+    uint32_t dda_phase;                 // DDA timer phase - an interrupt is due at FREQUENCY_DDA
+    uint32_t idle_ms;                   // ms the machine has been idle with the file read
+    uint64_t passes;                    // controller passes
+
+    uint32_t segments;
+    float velocity_max;
+    simIsrStats_t exec;
+    simIsrStats_t fwd_plan;
+    int32_t last_position[MOTORS];
+} simState_t;
+
+static simState_t sim;
+
+static inline double _sim_ms() { return ((double)sim.ticks * 1000 / FREQUENCY_DDA); }
+
+double sim_time_ms() { return (_sim_ms()); }
+
+/*
+ * sim_trace_segment() - called from exec for each segment (see TRACE_SEGMENT in trace.h)
+ */
+
+void sim_trace_segment(const uint8_t section, const float velocity, const float time, const float travel_steps[])
+{
+    sim.segments++;
+    if (velocity > sim.velocity_max) {
+        sim.velocity_max = velocity;
+    }
+    if (sim.segment_trace == nullptr) {
+        return;
+    }
+    fprintf(sim.segment_trace, "%.3f,%d,%.3f,%.1f", _sim_ms(), section, velocity, time * 60000000);
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        fprintf(sim.segment_trace, ",%.3f", travel_steps[motor]);
+    }
+    fprintf(sim.segment_trace, "\n");
+}
+
+/*
+ * _run_isr()                 - run a timer interrupt and time it on the host
+ * _run_software_interrupts() - run the requested exec and forward plan interrupts
+ */
+
+template <typename T>
+static void _run_isr(T &timer, simIsrStats_t &stats)
+{
+    uint32_t start = sim_host_nanoseconds();
+    timer.interrupt();
+    uint32_t ns = sim_host_nanoseconds() - start;
+    stats.count++;
+    stats.total_ns += ns;
+    if (ns > stats.max_ns) {
+        stats.max_ns = ns;
+    }
+}
+
+static void _run_software_interrupts()
+{
+    while (exec_timer.isPending() || fwd_plan_timer.isPending()) {
+        if (exec_timer.isPending()) {           // exec is the higher priority
+            _run_isr(exec_timer, sim.exec);
+        } else {
+            _run_isr(fwd_plan_timer, sim.fwd_plan);
+        }
+    }
+}
+
+/*
+ * _tick() - advance simulated time by one DDA tick, and SysTick every millisecond
+ */
+
+static void _sample_steps()
+{
+    bool moved = false;
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        int32_t position = ((SimStepper *)Motors[motor])->position;
+        moved |= (position != sim.last_position[motor]);
+        sim.last_position[motor] = position;
+    }
+    if (!moved || (sim.step_trace == nullptr)) {
+        return;
+    }
+    fprintf(sim.step_trace, "%.0f", _sim_ms());
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        fprintf(sim.step_trace, ",%d", sim.last_position[motor]);
+    }
+    fprintf(sim.step_trace, "\n");
+}
+
+static void _tick()
+{
+    sim.ticks++;
+    if (++sim.ms_ticks < SIM_TICKS_PER_MS) {
+        return;
+    }
+    sim.ms_ticks = 0;
+    _sample_steps();
+    SysTickTimer._tick();
+}
+
+/*
+ * _report() - write the statistics to stderr
+ */
+
+static void _report()
+{
+    uint32_t host_ms = sim_host_nanoseconds() / 1000000;
+    double job_s = _sim_ms() / 1000 - (double)SIM_DONE_MS / 1000;
+
+    fprintf(stderr, "sim: %s\n", sim.path);
+    fprintf(stderr, "sim: job time %.3f s simulated, %.3f s host, %u controller passes\n",
+            job_s, (double)host_ms / 1000, (unsigned)sim.passes);
+    fprintf(stderr, "sim: DDA ran %.3f s, %llu interrupts, %u segments, max segment velocity %.1f mm/min\n",
+            (double)sim.dda_ticks / FREQUENCY_DDA, (unsigned long long)sim.dda_interrupts, (unsigned)sim.segments,
+            sim.velocity_max);
+    fprintf(stderr, "sim: exec ISR %u runs, avg %.2f us, max %.2f us (host)\n", (unsigned)sim.exec.count,
+            sim.exec.count ? (double)sim.exec.total_ns / sim.exec.count / 1000 : 0.0, (double)sim.exec.max_ns / 1000);
+    fprintf(stderr, "sim: fwd plan ISR %u runs, avg %.2f us, max %.2f us (host)\n", (unsigned)sim.fwd_plan.count,
+            sim.fwd_plan.count ? (double)sim.fwd_plan.total_ns / sim.fwd_plan.count / 1000 : 0.0, (double)sim.fwd_plan.max_ns / 1000);
+    sim_xio_replay_report();
+    fprintf(stderr, "sim: final steps");
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        fprintf(stderr, " m%d:%d", motor+1, ((SimStepper *)Motors[motor])->position);
+    }
+    fprintf(stderr, "\n");
+}
+
+static void _finish(const int status)
+{
+    fflush(stdout);
+    _report();
+    if (sim.segment_trace != nullptr) { fclose(sim.segment_trace); }
+    if (sim.step_trace != nullptr) { fclose(sim.step_trace); }
+    exit(status);
+}
+
+/*
+ * sim_run_interrupts() - run what would have interrupted the controller pass that just ended
+ */
+
+void sim_run_interrupts()
+{
+    uint32_t ms = SysTickTimer.getValue();
+    sim.passes++;
+    sim_xio_replay_tick();
+    _run_software_interrupts();
+
+    for (uint32_t tick = 0; tick < sim.pass_ticks; tick++) {
+        if (dda_timer.isRunning()) {
+            sim.dda_ticks++;
+            if ((sim.dda_phase += dda_timer.getFrequency()) >= FREQUENCY_DDA) {
+                sim.dda_phase -= FREQUENCY_DDA;
+                dda_timer.interrupt();
+                sim.dda_interrupts++;
+                _run_software_interrupts();
+            }
+        }
+        _tick();
+    }
+
+    bool idle = sim_xio_input_done() && !dda_timer.isRunning() && (cm->motion_state == MOTION_STOP) &&
+                !mp_has_runnable_buffer(mp) && mp_runtime_is_idle();
+    sim.idle_ms = idle ? sim.idle_ms + (SysTickTimer.getValue() - ms) : 0;
+    if (sim.idle_ms >= SIM_DONE_MS) {
+        _finish(0);
+    }
+    if (sim.ticks > sim.max_ticks) {
+        fprintf(stderr, "sim: job did not finish in %u s of simulated time\n", (unsigned)(sim.max_ticks / FREQUENCY_DDA));
+        _finish(2);
+    }
+}
+
+/*
+ * main() - set up the simulator and run the firmware as Motate's main() does
+ */
+
+int main(int argc, char *argv[])
+{
+    uint32_t pass_us = 100;
+    uint32_t max_seconds = 3600;
+    uint32_t bench_rounds = 0;
+    bool replay = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:s:p:m:b:u:r")) != -1) {
+        switch (opt) {
+            case 't': { sim.segment_trace = fopen(optarg, "w"); break; }
+            case 's': { sim.step_trace = fopen(optarg, "w"); break; }
+            case 'p': { pass_us = atoi(optarg); break; }
+            case 'm': { max_seconds = atoi(optarg); break; }
+            case 'b': { sim_xio_set_link(atoi(optarg)); break; }
+            case 'u': { bench_rounds = atoi(optarg); break; }
+            case 'r': { replay = true; break; }
+            default:  {
+                fprintf(stderr, "usage: %s [-t segments.csv] [-s steps.csv] [-p pass_us] [-m max_seconds] [-b bytes_per_s] [-r] file\n", argv[0]);
+                fprintf(stderr, "       %s -u rounds file [file...]\n", argv[0]);
+                return (1);
+            }
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-t segments.csv] [-s steps.csv] [-p pass_us] [-m max_seconds] [-b bytes_per_s] [-r] file\n", argv[0]);
+        fprintf(stderr, "       %s -u rounds file [file...]\n", argv[0]);
+        return (1);
+    }
+    if (bench_rounds > 0) {             // parser micro-benchmarks instead of a job - see sim_bench.cpp
+        setup();
+        return (sim_bench(bench_rounds, argc - optind, &argv[optind]));
+    }
+    sim.path = argv[optind];
+    if (!(replay ? sim_xio_open_replay(sim.path) : sim_xio_open(sim.path))) {
+        fprintf(stderr, "sim: can't read %s\n", sim.path);
+        return (1);
+    }
+    sim.pass_ticks = std::max((uint32_t)1, (uint32_t)((uint64_t)pass_us * FREQUENCY_DDA / 1000000));
+    sim.max_ticks = (uint64_t)max_seconds * FREQUENCY_DDA;
+
+    if (sim.segment_trace != nullptr) {
+        fprintf(sim.segment_trace, "time_ms,section,velocity,time_us");
+        for (uint8_t motor = 0; motor < MOTORS; motor++) { fprintf(sim.segment_trace, ",steps%d", motor+1); }
+        fprintf(sim.segment_trace, "\n");
+    }
+    if (sim.step_trace != nullptr) {
+        fprintf(sim.step_trace, "time_ms");
+        for (uint8_t motor = 0; motor < MOTORS; motor++) { fprintf(sim.step_trace, ",m%d", motor+1); }
+        fprintf(sim.step_trace, "\n");
+    }
+
+    setup();
+    bm_arm(0);                          // measure the whole file - reported as {"bm":...} on stdout
+    loop();                             // does not return - _finish() ends the run
+    return (0);
+}
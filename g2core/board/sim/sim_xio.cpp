@@ -0,0 +1,537 @@
+/*
+ * sim_xio.cpp - the xio functions for the host simulator
+ * For: /board/sim
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  This replaces xio.cpp in the simulator build. There is one device, always connected and
+ *  always both control and data. Its input is a G-code file, read a line at a time as the
+ *  controller asks for it, so the planner fills and drains as it would behind a streaming
+ *  host that never falls behind. Output goes to stdout.
+ *
+ *  Files ending in .h are taken to be the compiled-in programs in Resources/gcode. The text
+ *  of the string literals of the first array (gcode_file) is played and everything else is
+ *  ignored - as on the target, where only gcode_file is compiled in.
+ *
+ *  A control-only read (_dispatch_control()) returns the next line only if it is a control:
+ *  a JSON line or one of the single character controls. Unlike the USB and UART devices the
+ *  simulator never reaches past data lines for a control - the file plays in order.
+ *
+ *  With sim_xio_set_link() (-b) the played file comes over a link of that many bytes per
+ *  second. Each line arrives one line time after the one before, or, if the controller was
+ *  slow to ask for it, as if the host had sent it as soon as the controller had read to
+ *  within SIM_LINK_WINDOW bytes of it - so up to a window's worth of lines wait in the RX
+ *  buffer while the planner is full, as with a streaming host.
+ *
+ *  sim_xio_open_replay() (-r) plays a session captured on a controller ({cap:2} - see
+ *  capture.h) instead: the {"cap":[ms,"line"]} lines of the file, each line held back until
+ *  its ms after the controller is ready. Nothing else in the file is played. As the session
+ *  is played, the simulator measures (sim_xio_replay_report()):
+ *
+ *    read delay    time a line arrived before the controller read it - the planner or the
+ *                  controller holding up the host
+ *    response      time from a line arriving to its {"r":...} response, for lines answered
+ *                  in order (JSON mode, not single character controls)
+ *    hold          time from a ! arriving to motion stopping
+ *
+ *  Planner starvations are counted by the benchmark, and reported in the {"bm":...} line.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "hardware.h"
+#include "canonical_machine.h"
+#include "controller.h"
+#include "text_parser.h"
+#include "xio.h"
+#include "eta.h"
+#include "cpuload.h"
+#include "board_xio.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+xioStats_t xio_stats;
+uint8_t xio_tx_coalesce = XIO_TX_COALESCE;     // stdout is buffered by stdio - held for {txc:} only
+
+static std::string _input;              // text of the file being played
+static size_t _read_offset = 0;
+static bool _input_scanned = false;    // eta_file_start() has seen _input
+static xio_flash_file *_flash_file = nullptr;
+static char _line[RX_BUFFER_SIZE+1];
+
+#define SIM_LINK_WINDOW 256             // bytes the host keeps in flight - a UART RX buffer
+static double _link_ms_per_byte = 0;    // 0 for no link
+static double _link_arrival_ms = 0;     // when the line being sent has arrived
+static bool _link_sending = false;      // _link_arrival_ms is for the next line
+
+typedef struct simReplay {
+    std::vector<double> arrival_ms;     // arrival time of each line of _input, from the start
+    size_t line;                        // next line to play
+    double start_ms;                    // simulated time the session started, -1 until it has
+    std::vector<double> responding;     // arrival times of the lines awaiting a response
+    size_t responded;                   // of responding, the lines already answered
+    double hold_ms;                     // arrival time of a ! waiting for motion to stop, -1 for none
+    std::vector<double> read_delay;     // ms
+    std::vector<double> response;
+    std::vector<double> hold;
+} simReplay_t;
+
+static simReplay_t _replay;
+static bool _replaying = false;         // playing a captured session - see sim_xio_open_replay()
+
+/*
+ * _decode_literals() - return the text of the C string literals of the first array in src
+ */
+
+static std::string _decode_literals(const std::string &src)
+{
+    std::string out;
+    size_t i = 0;
+    while (i < src.size()) {
+        if (src.compare(i, 2, "//") == 0) {                 // skip comments
+            i = src.find('\n', i);
+            continue;
+        }
+        if (src.compare(i, 2, "/*") == 0) {
+            i = src.find("*/", i);
+            i = (i == std::string::npos) ? i : i+2;
+            continue;
+        }
+        if ((src[i] == ';') && !out.empty()) {             // end of the first array
+            break;
+        }
+        if (src[i++] != '"') {
+            continue;
+        }
+        while ((i < src.size()) && (src[i] != '"')) {       // inside a literal
+            char c = src[i++];
+            if ((c == '\\') && (i < src.size())) {
+                c = src[i++];
+                switch (c) {
+                    case '\n': { continue; }                // line continuation
+                    case 'n':  { c = '\n'; break; }
+                    case 'r':  { c = '\r'; break; }
+                    case 't':  { c = '\t'; break; }
+                    default:   { break; }                   // \" \\ and the rest stand for themselves
+                }
+            }
+            out += c;
+        }
+        i++;                                                // closing quote
+    }
+    return (out);
+}
+
+/*
+ * sim_xio_open()       - load the file to play
+ * sim_xio_text()       - the text that is played, for sim_bench()
+ * sim_xio_input_done() - true once the file, and any xio_send_file() file, have been read
+ */
+
+bool sim_xio_open(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr) {
+        return (false);
+    }
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        text.append(chunk, n);
+    }
+    fclose(f);
+
+    size_t len = strlen(path);
+    _input = ((len > 2) && (strcmp(path + len - 2, ".h") == 0)) ? _decode_literals(text) : text;
+    _read_offset = 0;
+    _input_scanned = false;
+    return (true);
+}
+
+/*
+ * sim_xio_open_replay() - load a captured session to play - the {"cap":[ms,"line"]} lines of the file
+ */
+
+static bool _parse_capture_line(const char *s, double &ms, std::string &text)
+{
+    static const char prefix[] = "{\"cap\":[";
+    if (strncmp(s, prefix, sizeof(prefix)-1) != 0) {
+        return (false);
+    }
+    char *end;
+    ms = strtod(s + sizeof(prefix)-1, &end);
+    if ((end[0] != ',') || (end[1] != '"')) {
+        return (false);
+    }
+    text.clear();
+    for (s = end + 2; *s != '"'; s++) {
+        if (*s == NUL) {
+            return (false);
+        }
+        if (*s != '\\') {
+            text += *s;
+            continue;
+        }
+        switch (*++s) {
+            case 'n': { text += '\n'; break; }
+            case 'r': { text += '\r'; break; }
+            case 't': { text += '\t'; break; }
+            case 'u': {
+                if (strlen(s) < 5) { return (false); }
+                text += (char)strtol(std::string(s+1, 4).c_str(), nullptr, 16);
+                s += 4;
+                break;
+            }
+            case NUL: { return (false); }
+            default:  { text += *s; break; }         // \" \\ \/
+        }
+    }
+    return (true);
+}
+
+bool sim_xio_open_replay(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr) {
+        return (false);
+    }
+    _input.clear();
+    _replay = simReplay_t();
+    _replay.start_ms = -1;
+    _replay.hold_ms = -1;
+    char buf[4 * RX_BUFFER_SIZE];
+    double ms;
+    std::string text;
+    while (fgets(buf, sizeof(buf), f) != nullptr) {
+        if (!_parse_capture_line(buf, ms, text) || text.empty() ||
+            (text.find_first_of("\r\n") != std::string::npos)) {
+            continue;
+        }
+        _input += text;
+        _input += '\n';
+        _replay.arrival_ms.push_back(ms);
+    }
+    fclose(f);
+    _read_offset = 0;
+    _input_scanned = false;
+    _replaying = true;
+    return (true);
+}
+
+const char *sim_xio_text(size_t &len)
+{
+    len = _input.size();
+    return (_input.data());
+}
+
+void sim_xio_set_link(uint32_t bytes_per_s)
+{
+    _link_ms_per_byte = bytes_per_s ? 1000.0 / bytes_per_s : 0;
+}
+
+bool sim_xio_input_done()
+{
+    return ((_read_offset >= _input.size()) && (_flash_file == nullptr));
+}
+
+/*
+ * sim_xio_replay_tick()   - called after each controller pass - see a hold to its end
+ * sim_xio_replay_report() - write the replay measurements to stderr
+ */
+
+void sim_xio_replay_tick()
+{
+    if ((_replay.hold_ms >= 0) && (cm->motion_state == MOTION_STOP)) {
+        _replay.hold.push_back(sim_time_ms() - _replay.hold_ms);
+        _replay.hold_ms = -1;
+    }
+}
+
+static void _report_times(const char *name, std::vector<double> &ms)
+{
+    if (ms.empty()) {
+        fprintf(stderr, "sim: replay %s: none\n", name);
+        return;
+    }
+    std::sort(ms.begin(), ms.end());
+    double total = 0;
+    for (double t : ms) { total += t; }
+    fprintf(stderr, "sim: replay %s: %u, mean %.1f ms, p50 %.1f ms, p99 %.1f ms, max %.1f ms\n", name,
+            (unsigned)ms.size(), total / ms.size(), ms[ms.size() / 2], ms[(ms.size() * 99) / 100], ms.back());
+}
+
+void sim_xio_replay_report()
+{
+    if (!_replaying) {
+        return;
+    }
+    fprintf(stderr, "sim: replay %u of %u lines played\n", (unsigned)_replay.line, (unsigned)_replay.arrival_ms.size());
+    _report_times("read delay", _replay.read_delay);
+    _report_times("response", _replay.response);
+    _report_times("hold", _replay.hold);
+}
+
+/*
+ * _is_control() - true if the line would be read by a control-only read
+ */
+
+static bool _is_control(const char *line)
+{
+    char c = line[0];
+    return ((c == '{') || (c == '!') || (c == '~') || (c == ENQ) ||
+            (c == CHAR_RESET) || (c == CHAR_ALARM) || ((c == '%') && cm_has_hold()));
+}
+
+/*
+ * xio_init()            - nothing to set up beyond the board
+ * xio_test_assertions() - there are no buffers to corrupt
+ */
+
+void xio_init()
+{
+    board_xio_init();
+}
+
+stat_t xio_test_assertions()
+{
+    return (STAT_OK);
+}
+
+stat_t xio_callback()
+{
+    return (STAT_NOOP);
+}
+
+/*
+ * xio_write()     - write a buffer to stdout
+ * xio_writeline() - write a NUL terminated line to stdout
+ */
+
+size_t xio_write(const char *buffer, size_t size, bool only_to_muted /*= false*/)
+{
+    ldScope _ld(LOAD_COMMS);                            // xio_writeline() comes through here
+    if (only_to_muted) {
+        return (0);
+    }
+    xio_stats.tx_writes++;
+    if ((size > 0) && (buffer[size-1] == '\n')) {
+        xio_stats.tx_lines++;
+    }
+    if (_replaying && (strncmp(buffer, "{\"r\":", 5) == 0) && (_replay.responded < _replay.responding.size())) {
+        _replay.response.push_back(sim_time_ms() - _replay.responding[_replay.responded++]);
+    }
+    return (fwrite(buffer, 1, size, stdout));
+}
+
+int16_t xio_writeline(const char *buffer, bool only_to_muted /*= false*/)
+{
+    return (xio_write(buffer, strlen(buffer), only_to_muted));
+}
+
+/*
+ * xio_readline() - return the next line of the xio_send_file() file, or of the played file
+ */
+
+char *xio_readline(devflags_t &flags, uint16_t &size)
+{
+    ldScope _ld(LOAD_COMMS);
+    bool control_only = !(flags & DEV_IS_DATA);
+    size = 0;
+
+    if (_flash_file != nullptr) {
+        const char *line = _flash_file->readline(control_only, size, _line, RX_BUFFER_SIZE+1);
+        if (_flash_file->isDone()) {
+            _flash_file = nullptr;
+            eta_file_end();
+        }
+        if (line != nullptr) {
+            eta_file_line(_line);
+            flags = DEV_IS_BOTH;
+            return (_line);
+        }
+        if (control_only) {
+            flags = 0;
+            return (nullptr);
+        }
+    }
+
+    if (cs.controller_state != CONTROLLER_READY) {     // a host waits for SYSTEM READY, which resets the comm mode
+        flags = 0;
+        return (nullptr);
+    }
+    if (!_input_scanned) {                              // the machine isn't set up when the file is opened
+        eta_file_start(_input.data(), _input.size());
+        _input_scanned = true;
+    }
+    while (_read_offset < _input.size()) {
+        size_t end = _input.find_first_of("\r\n", _read_offset);
+        if (end == std::string::npos) {
+            end = _input.size();
+        }
+        size_t len = end - _read_offset;
+        if (len == 0) {                                 // skip empty lines and the LF of a CRLF
+            _read_offset++;
+            continue;
+        }
+        if (_replaying) {
+            if (_replay.start_ms < 0) {
+                _replay.start_ms = sim_time_ms();   // the session starts when the controller is ready
+            }
+            if (sim_time_ms() < _replay.start_ms + _replay.arrival_ms[_replay.line]) {
+                break;
+            }
+        } else if (_link_ms_per_byte > 0) {
+            double now = sim_time_ms();
+            if (!_link_sending) {
+                _link_arrival_ms = std::max(_link_arrival_ms, now - SIM_LINK_WINDOW * _link_ms_per_byte) +
+                                   (len + 1) * _link_ms_per_byte;
+                _link_sending = true;
+            }
+            if (now < _link_arrival_ms) {
+                break;
+            }
+        }
+        if (len > RX_BUFFER_SIZE) {
+            xio_stats.lines_too_long++;
+            len = RX_BUFFER_SIZE;
+        }
+        strncpy(_line, _input.data() + _read_offset, len);
+        _line[len] = NUL;
+        if (control_only && !_is_control(_line)) {
+            break;
+        }
+        _read_offset = end;
+        _link_sending = false;
+        if (_replaying) {
+            const double arrival = _replay.start_ms + _replay.arrival_ms[_replay.line++];
+            _replay.read_delay.push_back(sim_time_ms() - arrival);
+            if (_line[0] == '!') {
+                _replay.hold_ms = (_replay.hold_ms < 0) ? arrival : _replay.hold_ms;
+            } else if ((len > 1) || !_is_control(_line)) {
+                _replay.responding.push_back(arrival);
+            }
+        }
+        size = len;
+        eta_file_line(_line);
+        flags = DEV_IS_BOTH;
+        return (_line);
+    }
+    flags = 0;
+    return (nullptr);
+}
+
+/*
+ * xio_get_rx_space()     - the file is already "received" - there is always room
+ * xio_rx_pending()       - true while there are lines left to read
+ * xio_connected()        - always connected
+ * xio_flush_to_command() - nothing is buffered ahead of the command that was read
+ */
+
+uint16_t xio_get_rx_space()
+{
+    return (RX_BUFFER_SIZE);
+}
+
+bool xio_rx_pending()
+{
+    return (!sim_xio_input_done());
+}
+
+bool xio_connected()
+{
+    return (true);
+}
+
+void xio_flush_to_command()
+{
+}
+
+#if MARLIN_COMPAT_ENABLED == true
+void xio_exit_fake_bootloader()
+{
+}
+#endif
+
+/*
+ * xio_send_file() - play a xio_flash_file ahead of the rest of the input
+ */
+
+bool xio_send_file(xio_flash_file &file)
+{
+    if (_flash_file != nullptr) {
+        return (false);
+    }
+    _flash_file = &file;
+    _flash_file->reset();
+    eta_file_start(file);
+    return (true);
+}
+
+/***********************************************************************************
+ * newlib-nano support functions
+ ***********************************************************************************/
+
+int _write( int file, char *ptr, int len )
+{
+    return xio_write(ptr, len);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+stat_t xio_get_rxsb(nvObj_t *nv)
+{
+    nv->value_int = sizeof(_line);
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t xio_set_rxs(nvObj_t *nv)
+{
+    memset(&xio_stats, 0, sizeof(xio_stats));
+    return (STAT_OK);
+}
+
+stat_t xio_get_txc(nvObj_t *nv) { return (get_integer(nv, xio_tx_coalesce)); }
+stat_t xio_set_txc(nvObj_t *nv) { return (set_integer(nv, xio_tx_coalesce, 0, 1)); }
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_rxsb[] = "[rxsb] buffer RAM%18d bytes\n";
+static const char fmt_rxsd[] = "[rxsd] lines dropped%15d\n";
+static const char fmt_rxsl[] = "[rxsl] lines too long%14d\n";
+static const char fmt_rxsf[] = "[rxsf] RX buffer full%14d ms\n";
+void xio_print_rxsb(nvObj_t *nv) { text_print(nv, fmt_rxsb);} // TYPE_INT
+void xio_print_rxsd(nvObj_t *nv) { text_print(nv, fmt_rxsd);} // TYPE_INT
+void xio_print_rxsl(nvObj_t *nv) { text_print(nv, fmt_rxsl);} // TYPE_INT
+void xio_print_rxsf(nvObj_t *nv) { text_print(nv, fmt_rxsf);} // TYPE_INT
+static const char fmt_rxsw[] = "[rxsw] TX writes%19d\n";
+static const char fmt_rxsr[] = "[rxsr] TX lines%20d\n";
+static const char fmt_txc[]  = "[txc]  TX coalescing%15d [0=off,1=on]\n";
+void xio_print_rxsw(nvObj_t *nv) { text_print(nv, fmt_rxsw);} // TYPE_INT
+void xio_print_rxsr(nvObj_t *nv) { text_print(nv, fmt_rxsr);} // TYPE_INT
+void xio_print_txc(nvObj_t *nv)  { text_print(nv, fmt_txc);}  // TYPE_INT
+
+#endif // __TEXT_MODE
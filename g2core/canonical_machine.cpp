@@ -100,6 +100,7 @@
 #include "planner.h"
 #include "stepper.h"
 #include "encoder.h"
+#include "kinematics.h"
 //#include "toolhead.h"
 #include "spindle.h"
 #include "coolant.h"
@@ -118,6 +119,7 @@
 cmMachine_t *cm;            // pointer to active canonical machine
 cmMachine_t cm1;            // canonical machine primary machine
 cmMachine_t cm2;            // canonical machine secondary machine
+uint16_t cm_config_generation = 1;  // starts non-zero so the first p2 entry copies the configuration
 cmToolTable_t tt;           // global tool table
 
 /****************************************************************************************
@@ -138,6 +140,7 @@ static int8_t _axis(const nvObj_t *nv);     // return axis number from token/gro
  * canonical_machine_init()  - initialize cm struct
  * canonical_machine_reset() - apply startup settings or reset to startup
  * canonical_machine_reset_rotation()
+ * canonical_machine_update_rotation() - call after writing rotation_matrix
  */
 
 void canonical_machine_inits()
@@ -160,6 +163,7 @@ void canonical_machine_init(cmMachine_t *_cm, void *_mp)
 
     canonical_machine_init_assertions(_cm);         // establish assertions
     cm_arc_init(_cm);                               // setup arcs. Note: spindle and coolant inits are independent
+    cm_drill_init(_cm);                             // setup drilling cycles
     _cm->mp = _mp;                                  // point to associated planner
     _cm->am = MODEL;                                // setup initial Gcode model pointer
 }
@@ -221,6 +225,21 @@ void canonical_machine_reset_rotation(cmMachine_t *_cm) {
     // Separately handle a z-offset so that the new plane maintains a consistent 
     // distance from the old one. We only need z, since we are rotating to the z axis.
     _cm->rotation_z_offset = 0.0;
+    _cm->rotation_identity = true;
+}
+
+// Most machines are never trammed. With an identity matrix the rotation of a move target
+// is a copy plus the z-offset, so the per-move code tests this flag instead of the matrix.
+void canonical_machine_update_rotation(cmMachine_t *_cm) {
+
+    _cm->rotation_identity = true;
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            if (_cm->rotation_matrix[i][j] != ((i == j) ? 1.0f : 0.0f)) {
+                _cm->rotation_identity = false;
+            }
+        }
+    }
 }
 
 /****************************************************************************************
@@ -256,6 +275,9 @@ stat_t canonical_machine_test_assertions(cmMachine_t *_cm)
  */
 void cm_set_motion_state(const cmMotionState motion_state)
 {
+    if (cm->motion_state != motion_state) {
+        rpt_post_event(RPT_EVENT_MOTION_STATE);
+    }
     cm->motion_state = motion_state;
     ACTIVE_MODEL = ((motion_state == MOTION_STOP) ? MODEL : RUNTIME);
 }
@@ -296,6 +318,7 @@ cmCombinedState cm_get_combined_state(cmMachine_t *_cm)
                 case CYCLE_HOMING:    { return (COMBINED_HOMING); }
                 case CYCLE_PROBE:     { return (COMBINED_PROBE); }
                 case CYCLE_JOG:       { return (COMBINED_JOG); }
+                case CYCLE_AUTOTUNE:  { return (COMBINED_CYCLE); }
             }
         }
     }
@@ -375,6 +398,7 @@ stat_t cm_check_linenum() {
  * cm_get_display_offset()  - return the current display offset from pecified Gcode model
  * cm_set_display_offsets() - capture combined offsets from the model into absolute values 
  *                            in the active Gcode dynamic model
+ * cm_update_work_offsets() - recompute the combined offsets after any of the offsets change
  *
  * Notes on Coordinate System and Offset functions
  *
@@ -402,6 +426,8 @@ stat_t cm_check_linenum() {
  *
  *    - cm_get_combined_offset() puts the above together to provide a combined, active offset. 
  *      G92 offsets are only included if g92 is active (gmx.g92_offset_enable == true)
+ *    - The combination is held in cm.work_offset[] so moves and displays don't recompute it.
+ *      cm_update_work_offsets() must be called every time one of the above changes
  *
  *  Display offsets
  *      *** Display offsets are for display only and CANNOT be used to set positions ***
@@ -428,11 +454,7 @@ float cm_get_combined_offset(const uint8_t axis)
     if (cm->gm.absolute_override >= ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS) {
         return (0);
     }
-    float offset = cm->coord_offset[cm->gm.coord_system][axis] + cm->tool_offset[axis];
-    if (cm->gmx.g92_offset_enable == true) {
-        offset += cm->gmx.g92_offset[axis];
-    }
-    return (offset);
+    return (cm->work_offset[axis]);
 }    
 
 float cm_get_display_offset(const GCodeState_t *gcode_state, const uint8_t axis)
@@ -442,22 +464,29 @@ float cm_get_display_offset(const GCodeState_t *gcode_state, const uint8_t axis)
 
 void cm_set_display_offsets(GCodeState_t *gcode_state)
 {
-    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
-        
-        // if absolute override is on for G53 so position should be displayed with no offsets
-        if (cm->gm.absolute_override == ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_NO_OFFSETS) {
+    // if absolute override is on for G53 so position should be displayed with no offsets
+    if (cm->gm.absolute_override == ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_NO_OFFSETS) {
+        for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
             gcode_state->display_offset[axis] = 0;
-        } 
-
-        // all other cases: position should be displayed with currently active offsets
-        else {
-            gcode_state->display_offset[axis] = cm->coord_offset[cm->gm.coord_system][axis] + 
-                                                cm->tool_offset[axis];
-            if (cm->gmx.g92_offset_enable == true) {
-                gcode_state->display_offset[axis] += cm->gmx.g92_offset[axis];
-            }
         }
     }
+
+    // all other cases: position should be displayed with currently active offsets
+    else {
+        copy_vector(gcode_state->display_offset, cm->work_offset);
+    }
+}
+
+void cm_update_work_offsets()
+{
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        cm->work_offset[axis] = cm->coord_offset[cm->gm.coord_system][axis] + cm->tool_offset[axis];
+        if (cm->gmx.g92_offset_enable == true) {
+            cm->work_offset[axis] += cm->gmx.g92_offset[axis];
+        }
+    }
+    cm->xform.valid = false;                // rebuild the target transform with the new offsets
+    cm_set_display_offsets(MODEL);
 }
 
 /*
@@ -539,6 +568,18 @@ stat_t cm_deferred_write_callback()
                 nv_persist(&nv);    // Note: nv_persist() only writes values that have changed
             }
         }
+        for (uint8_t i=1; i<=TOOLS; i++) {                  // only the tools G10 L1/L10 or G37 changed
+            if (!(cm->deferred_write_tools & (1UL << (i-1)))) {
+                continue;
+            }
+            for (uint8_t j=0; j<AXES; j++) {
+                sprintf((char *)nv.token, "tt%d%c", i, ("xyzuvwabc")[j]);
+                nv.index = nv_get_index((const char *)"", nv.token);
+                nv.value_flt = tt.tt_offset[i][j];
+                nv_persist(&nv);
+            }
+        }
+        cm->deferred_write_tools = 0;
     }
     return (STAT_OK);
 }
@@ -578,6 +619,17 @@ stat_t cm_set_tram(nvObj_t *nv)
         return (STAT_OK);
     }
  
+    return (cm_tram_from_probes());
+}
+
+/*
+ * cm_tram_from_probes() - set the rotation matrix from the three stored probes
+ *
+ *  Called by {tram:1} and at the end of the G29 tramming cycle.
+ */
+
+stat_t cm_tram_from_probes()
+{
     // check to make sure we have three valid probes in a row
     if (!((cm->probe_state[0] == PROBE_SUCCEEDED) &&
           (cm->probe_state[1] == PROBE_SUCCEEDED) &&
@@ -654,6 +706,7 @@ stat_t cm_set_tram(nvObj_t *nv)
     cm->rotation_z_offset = (n_x*cm->probe_results[1][0] + 
                              n_y*cm->probe_results[1][1]) / 
                              n_z + cm->probe_results[1][2];
+    canonical_machine_update_rotation(cm);
     return (STAT_OK);
 }
 
@@ -697,93 +750,126 @@ stat_t cm_get_nxln(nvObj_t *nv)
  *
  *  Target coordinates are provided in target[]
  *  Axes that need processing are signaled in flag[]
+ *
+ *  All of the above only changes with the units, distance mode, absolute override, offsets
+ *  and axis configuration, so _update_target_transform() reduces it to a table - an axis
+ *  mask, a scale, an offset and an absolute/incremental mask - and the per-move work is a
+ *  multiply-add for each flagged axis. The table is rebuilt when the modes it was built
+ *  for change, the configuration changes (cm_config_generation), or the offsets change
+ *  (cm_update_work_offsets() invalidates it).
  */
 
-// ESTEE: _calc_ABC is a fix to workaround a gcc compiler bug wherein it runs out of spill
-//        registers we moved this block into its own function so that we get a fresh stack push
-// ALDEN: This shows up in avr-gcc 4.7.0 and avr-libc 1.8.0
-
-static float _calc_ABC(const uint8_t axis, const float target[])
+static uint32_t _target_transform_modes()
 {
-    if ((cm->a[axis].axis_mode == AXIS_STANDARD) || (cm->a[axis].axis_mode == AXIS_INHIBITED)) {
-        return(target[axis]);    // no mm conversion - it's in degrees
-    }
-    // radius mode
-    return (_to_millimeters(target[axis]) * 360.0 / (2 * M_PI * cm->a[axis].radius));
+    uint32_t modes = cm->gm.units_mode |
+                     (cm->gm.distance_mode << 8) |
+                     ((cm->gm.absolute_override >= ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS) << 16);
+#if MARLIN_COMPAT_ENABLED == true
+    modes |= (mst.marlin_flavor << 24) | (mst.extruder_mode << 25);
+#endif
+    return (modes);
 }
 
-void cm_set_model_target(const float target[], const bool flags[])
+static void _update_target_transform(const uint32_t modes)
 {
-    uint8_t axis;
-    float tmp = 0;
+    cmTargetTransform_t *x = &cm->xform;
+    float unit_scale = (cm->gm.units_mode == INCHES) ? MM_PER_INCH : 1;
+    bool absolute = (cm->gm.distance_mode == ABSOLUTE_DISTANCE_MODE);
 
-    // copy position to target so it always starts correctly
-    copy_vector(cm->gm.target, cm->gmx.position);
-
-    // process linear axes (XYZUVW) first
-    for (axis=AXIS_X; axis<=AXIS_W; axis++) {
-        if (!flags[axis] || cm->a[axis].axis_mode == AXIS_DISABLED) {
-            continue;        // skip axis if not flagged for update or its disabled
-        } else if ((cm->a[axis].axis_mode == AXIS_STANDARD) || (cm->a[axis].axis_mode == AXIS_INHIBITED)) {
-            if (cm->gm.distance_mode == ABSOLUTE_DISTANCE_MODE) {
-                cm->gm.target[axis] = cm_get_combined_offset(axis) + _to_millimeters(target[axis]);
-            } else {
-                cm->gm.target[axis] += _to_millimeters(target[axis]);
-            }
-            cm->return_flags[axis] = true;  // used to make a synthetic G28/G30 intermediate move
+    x->axes = 0;
+    x->absolute = 0;
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        cmAxisMode axis_mode = cm->a[axis].axis_mode;
+        bool radius_mode = (axis >= AXIS_A) && (axis_mode == AXIS_RADIUS);
+        if ((axis_mode != AXIS_STANDARD) && (axis_mode != AXIS_INHIBITED) && !radius_mode) {
+            continue;       // disabled, or radius mode on a linear axis
         }
-    }
-    // FYI: The ABC loop below relies on the XYZUVW loop having been run first
-    for (axis=AXIS_A; axis<=AXIS_C; axis++) {
-        if (!flags[axis] || cm->a[axis].axis_mode == AXIS_DISABLED) {
-            continue;        // skip axis if not flagged for update or its disabled
+        x->axes |= (1 << axis);
+        if (axis < AXIS_A) {
+            x->scale[axis] = unit_scale;
+        } else if (radius_mode) {
+            x->scale[axis] = unit_scale * 360.0 / (2 * M_PI * cm->a[axis].radius);
         } else {
-            tmp = _calc_ABC(axis, target);
+            x->scale[axis] = 1;                     // no mm conversion - it's in degrees
         }
-
+        bool axis_absolute = absolute;
 #if MARLIN_COMPAT_ENABLED == true
         // If we are in absolute mode (generally), but the extruder is relative,
         // then we adjust the extruder to a relative position
-        if (mst.marlin_flavor && (cm->a[axis].axis_mode == AXIS_RADIUS)) {
-            if ((cm->gm.distance_mode == INCREMENTAL_DISTANCE_MODE) || (mst.extruder_mode == EXTRUDER_MOVES_RELATIVE)) {
-                cm->gm.target[axis] += tmp;
-            }
-            else { // if (cm.gmx.extruder_mode == EXTRUDER_MOVES_NORMAL)
-                cm->gm.target[axis] = tmp + cm_get_combined_offset(axis);
-            }
-            // TODO - volumetric filament conversion
-//            else {
-//                cm->gm.target[axis] += tmp * cm.gmx.volume_to_filament_length[axis-3];
-//            }
+        if (mst.marlin_flavor && radius_mode && (mst.extruder_mode == EXTRUDER_MOVES_RELATIVE)) {
+            axis_absolute = false;
         }
-        else
-#endif // MARLIN_COMPAT_ENABLED
-
-        if (cm->gm.distance_mode == ABSOLUTE_DISTANCE_MODE) {
-            cm->gm.target[axis] = tmp + cm_get_combined_offset(axis); // sacidu93's fix to Issue #22
+#endif
+        if (axis_absolute) {
+            x->absolute |= (1 << axis);
         }
-        else {
-            cm->gm.target[axis] += tmp;
+        x->offset[axis] = cm_get_combined_offset(axis);
+    }
+    x->modes = modes;
+    x->config_generation = cm_config_generation;
+    x->valid = true;
+}
+
+void cm_set_model_target(const float target[], const bool flags[])
+{
+    cmTargetTransform_t *x = &cm->xform;
+    uint32_t modes = _target_transform_modes();
+    if (!x->valid || (x->modes != modes) || (x->config_generation != cm_config_generation)) {
+        _update_target_transform(modes);
+    }
+
+    // copy position to target so it always starts correctly
+    copy_vector(cm->gm.target, cm->gmx.position);
+
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        if (!flags[axis] || !(x->axes & (1 << axis))) {
+            continue;        // skip axis if not flagged for update or its disabled
         }
-        cm->return_flags[axis] = true;
+        float base = (x->absolute & (1 << axis)) ? x->offset[axis] : cm->gm.target[axis];
+        cm->gm.target[axis] = base + target[axis] * x->scale[axis];
+        cm->return_flags[axis] = true;  // used to make a synthetic G28/G30 intermediate move
     }
 }
 
 /****************************************************************************************
  * cm_get_soft_limits()
  * cm_set_soft_limits()
+ * cm_update_soft_limits() - rebuild the soft limit envelope
  * cm_test_soft_limits() - return error code if soft limit is exceeded
  *
  *  The target[] arg must be in absolute machine coordinates. Best done after cm_set_model_target().
  *
  *  Tests for soft limit for any homed axis if min and max are different values. You can set min
  *  and max to the same value (e.g. 0,0) to disable soft limits for an axis. Also will not test
- *  a min or a max if the value is more than +/- 1000000 (plus or minus 1 million ).
- *  This allows a single end to be tested w/the other disabled, should that requirement ever arise.
+ *  an axis if its min or max is more than +/- 1000000 (plus or minus 1 million).
+ *
+ *  Which axes qualify only changes when soft limits are turned on or off, a travel limit is
+ *  set, or an axis is homed or unhomed, so cm_update_soft_limits() works it out on those
+ *  events and leaves a bitmask and an envelope. The per-move test is then a compare over
+ *  the axes in the mask. Anything that writes soft_limit_enable, travel_min, travel_max
+ *  or homed[] must call cm_update_soft_limits() afterwards.
  */
 
 bool cm_get_soft_limits() { return (cm->soft_limit_enable); }
-void cm_set_soft_limits(bool enable) { cm->soft_limit_enable = enable; }
+void cm_set_soft_limits(bool enable) { cm->soft_limit_enable = enable; cm_update_soft_limits(); cm_config_changed(); }
+
+void cm_update_soft_limits()
+{
+    cm->soft_limit_axes = 0;
+    if (cm->soft_limit_enable != true) {
+        return;
+    }
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        if (cm->homed[axis] != true) { continue; }                               // skip axis if not homed
+        if (fp_EQ(cm->a[axis].travel_min, cm->a[axis].travel_max)) { continue; } // skip axis if identical
+        if (fabs(cm->a[axis].travel_min) > DISABLE_SOFT_LIMIT) { continue; }     // skip axis if min disabled
+        if (fabs(cm->a[axis].travel_max) > DISABLE_SOFT_LIMIT) { continue; }     // skip axis if max disabled
+
+        cm->soft_limit_min[axis] = cm->a[axis].travel_min;
+        cm->soft_limit_max[axis] = cm->a[axis].travel_max;
+        cm->soft_limit_axes |= (1 << axis);
+    }
+}
 
 static stat_t _finalize_soft_limits(const stat_t status)
 {
@@ -794,19 +880,14 @@ static stat_t _finalize_soft_limits(const stat_t status)
 
 stat_t cm_test_soft_limits(const float target[])
 {
-    if (cm->soft_limit_enable == true) {
-        for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
-            if (cm->homed[axis] != true) { continue; }                               // skip axis if not homed
-            if (fp_EQ(cm->a[axis].travel_min, cm->a[axis].travel_max)) { continue; } // skip axis if identical
-            if (fabs(cm->a[axis].travel_min) > DISABLE_SOFT_LIMIT) { continue; }     // skip min test if disabled
-            if (fabs(cm->a[axis].travel_max) > DISABLE_SOFT_LIMIT) { continue; }     // skip max test if disabled
-
-            if (target[axis] < cm->a[axis].travel_min) {
-                return (_finalize_soft_limits(STAT_SOFT_LIMIT_EXCEEDED_XMIN + 2*axis));
-            }
-            if (target[axis] > cm->a[axis].travel_max) {
-                return (_finalize_soft_limits(STAT_SOFT_LIMIT_EXCEEDED_XMAX + 2*axis));
-            }
+    uint16_t axes = cm->soft_limit_axes;
+    for (uint8_t axis = AXIS_X; axes != 0; axis++, axes >>= 1) {
+        if (!(axes & 1)) { continue; }
+        if (target[axis] < cm->soft_limit_min[axis]) {
+            return (_finalize_soft_limits(STAT_SOFT_LIMIT_EXCEEDED_XMIN + 2*axis));
+        }
+        if (target[axis] > cm->soft_limit_max[axis]) {
+            return (_finalize_soft_limits(STAT_SOFT_LIMIT_EXCEEDED_XMAX + 2*axis));
         }
     }
     return (STAT_OK);
@@ -891,6 +972,7 @@ stat_t cm_set_g10_data(const uint8_t P_word, const bool P_flag,
                         cm->tool_offset[axis];
                 }
                 cm->deferred_write_flag = true;         // persist offsets once machining cycle is over
+                cm_config_changed();
             }
         }
     }
@@ -909,13 +991,14 @@ stat_t cm_set_g10_data(const uint8_t P_word, const bool P_flag,
                         (cm->gmx.g92_offset[axis] * cm->gmx.g92_offset_enable);
                 }
                 cm->deferred_write_flag = true;         // persist offsets once machining cycle is over
+                cm->deferred_write_tools |= (1UL << (P_word-1));
             }
         }
     }
     else {
         return (STAT_L_WORD_IS_INVALID);
     }
-    cm_set_display_offsets(MODEL);
+    cm_update_work_offsets();
     return (STAT_OK);
 }
 
@@ -963,7 +1046,9 @@ stat_t cm_set_tl_offset(const uint8_t H_word, const bool H_flag, const bool appl
             cm->tool_offset[axis] = tt.tt_offset[tool][axis];
         }
     }
-    cm_set_display_offsets(MODEL);                      // display new offsets in the model right now
+    cm->tool_offset[AXIS_Z] += tt.length_wear[tool];
+    cm_config_changed();
+    cm_update_work_offsets();                           // display new offsets in the model right now
 
     float value[] = { (float)cm->gm.coord_system };     // pass coordinate system in value[0] element
     mp_queue_command(_exec_offset, value, nullptr);     // second vector (flags) is not used, so fake it
@@ -975,7 +1060,8 @@ stat_t cm_cancel_tl_offset()
     for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
         cm->tool_offset[axis] = 0;
     }
-    cm_set_display_offsets(MODEL);                      // display new offsets in the model right now
+    cm_config_changed();
+    cm_update_work_offsets();                           // display new offsets in the model right now
 
     float value[] = { (float)cm->gm.coord_system };
     mp_queue_command(_exec_offset, value, nullptr);     // changes it in the runtime when executed
@@ -985,7 +1071,7 @@ stat_t cm_cancel_tl_offset()
 stat_t cm_set_coord_system(const uint8_t coord_system)  // set coordinate system sync'd with planner
 {
     cm->gm.coord_system = (cmCoordSystem)coord_system;
-    cm_set_display_offsets(MODEL);                      // must reset display offsets if you change coordinate system
+    cm_update_work_offsets();                           // must reset display offsets if you change coordinate system
 
     float value[] = { (float)coord_system };
     mp_queue_command(_exec_offset, value, nullptr);
@@ -1052,6 +1138,7 @@ static void _exec_absolute_origin(float *value, bool *flag)
             cm->homed[axis] = true;    // G28.3 is not considered homed until you get here
         }
     }
+    cm_update_soft_limits();
     mp_set_steps_to_runtime_position();
 }
 
@@ -1097,7 +1184,7 @@ stat_t cm_set_g92_offsets(const float offset[], const bool flag[])
     // now pass the offset to the callback - setting the coordinate system also applies the offsets
     float value[] = { (float)cm->gm.coord_system }; // pass coordinate system in value[0] element
     mp_queue_command(_exec_offset, value, nullptr);
-    cm_set_display_offsets(MODEL);
+    cm_update_work_offsets();
     return (STAT_OK);
 }
 
@@ -1109,7 +1196,7 @@ stat_t cm_reset_g92_offsets()
     }
     float value[] = { (float)cm->gm.coord_system };
     mp_queue_command(_exec_offset, value, nullptr);
-    cm_set_display_offsets(MODEL);
+    cm_update_work_offsets();
     return (STAT_OK);
 }
 
@@ -1118,7 +1205,7 @@ stat_t cm_suspend_g92_offsets()
     cm->gmx.g92_offset_enable = false;
     float value[] = { (float)cm->gm.coord_system };
     mp_queue_command(_exec_offset, value, nullptr);
-    cm_set_display_offsets(MODEL);
+    cm_update_work_offsets();
     return (STAT_OK);
 }
 
@@ -1127,7 +1214,7 @@ stat_t cm_resume_g92_offsets()
     cm->gmx.g92_offset_enable = true;
     float value[] = { (float)cm->gm.coord_system };
     mp_queue_command(_exec_offset, value, nullptr);
-    cm_set_display_offsets(MODEL);
+    cm_update_work_offsets();
     return (STAT_OK);
 }
 
@@ -1272,6 +1359,16 @@ stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode)
     return (STAT_OK);
 }
 
+/****************************************************************************************
+ * cm_set_path_tolerance() - G64 P - set the corner blending tolerance (see mp_blend_corner())
+ */
+
+stat_t cm_set_path_tolerance(GCodeState_t *gcode_state, const float tolerance)
+{
+    gcode_state->path_tolerance = max(_to_millimeters(tolerance), (float)0);
+    return (STAT_OK);
+}
+
 /****************************************************************************************
  **** Machining Functions (4.3.6) *******************************************************
  ****************************************************************************************/
@@ -1310,9 +1407,17 @@ stat_t cm_straight_feed(const float *target, const bool *flags, const uint8_t mo
 
     cm_set_model_target(target, flags);
     ritorno (cm_test_soft_limits(cm->gm.target));   // test soft limits; exit if thrown
+    ritorno(spindle_spinup_wait_sync());            // wait out an overlapped spinup
     cm_set_display_offsets(&cm->gm);                // capture the fully resolved offsets to the state
     cm_cycle_start();                               // required for homing & other cycles
-    stat_t status = mp_aline(&cm->gm);              // send the move to the planner
+    stat_t status = STAT_NOOP;
+    if (motion_profile == PROFILE_NORMAL) {
+        status = mp_merge_aline(&cm->gm);           // try to fold the move into the previous block
+    }
+    if (status == STAT_NOOP) {
+        ritorno(mp_blend_corner(&cm->gm));          // G64 P: blend the corner into this move
+        status = mp_aline(&cm->gm);                 // send the move to the planner
+    }
     cm_update_model_position();                     // <-- ONLY safe because we don't care about status...
 
     if (status == STAT_MINIMUM_LENGTH_MOVE) {
@@ -1324,6 +1429,39 @@ stat_t cm_straight_feed(const float *target, const bool *flags, const uint8_t mo
     return (status);
 }
 
+/*
+ * cm_raster_feed() - G1 that carries a scanline of laser intensities
+ *
+ *  line comes from mp_get_raster_line() and holds the pixels, spread evenly over the move.
+ *  The move is never merged or blended with its neighbors. See mp_raster().
+ */
+
+stat_t cm_raster_feed(const float *target, const bool *flags, struct mpRasterLine *line)
+{
+    if (fp_ZERO(cm->gm.feed_rate)) {
+        return (STAT_FEEDRATE_NOT_SPECIFIED);
+    }
+    if ((line->count == 0) || (line->count > RASTER_PIXELS_MAX)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    cm->gm.motion_mode = MOTION_MODE_STRAIGHT_FEED;
+
+    cm_set_model_target(target, flags);
+    ritorno (cm_test_soft_limits(cm->gm.target));   // test soft limits; exit if thrown
+    cm_set_display_offsets(&cm->gm);                // capture the fully resolved offsets to the state
+    cm_cycle_start();                               // required for homing & other cycles
+    stat_t status = mp_raster(&cm->gm, line);       // send the scanline to the planner
+    cm_update_model_position();
+
+    if (status == STAT_MINIMUM_LENGTH_MOVE) {       // a scanline with no length is dropped
+        if (!mp_has_runnable_buffer(mp)) {
+            cm_cycle_end();
+        }
+        status = STAT_OK;
+    }
+    return (status);
+}
+
 /****************************************************************************************
  **** Spindle Functions (4.3.7) *********************************************************
  ****************************************************************************************/
@@ -1334,32 +1472,27 @@ stat_t cm_straight_feed(const float *target, const bool *flags, const uint8_t mo
  ****************************************************************************************/
 /*
  * cm_select_tool()     - T parameter
- * _exec_select_tool()  - execution callback
  *
  * cm_change_tool()     - M6 (This might become a complete tool change cycle)
  * _exec_change_tool()  - execution callback
  *
- * Note: These functions don't actually do anything for now, and there's a bug
- *       where T and M in different blocks don't work correctly
+ *  T is taken into the model at once, so M6 in the same block or a later one changes to it.
+ *  M6 is queued, and switches the spindle to the new tool's PWM channel in queue order.
  */
-static void _exec_select_tool(float *value, bool *flag)
-{
-    cm->gm.tool_select = (uint8_t)value[0];
-}
 
 stat_t cm_select_tool(const uint8_t tool_select)
 {
     if (tool_select > TOOLS) {
         return (STAT_T_WORD_IS_INVALID);
     }
-    float value[] = { (float)tool_select };
-    mp_queue_command(_exec_select_tool, value, nullptr);
+    cm->gm.tool_select = tool_select;
     return (STAT_OK);
 }
 
 static void _exec_change_tool(float *value, bool *flag)
 {
     cm->gm.tool = (uint8_t)value[0];
+    spindle_set_pwm_channel(tt.pwm_channel[cm->gm.tool] - 1);  // runs in queue order with the PWM
     // TODO - change tool offsets and update display offsets
 }
 
@@ -1384,6 +1517,40 @@ void cm_message(const char *message)
     nv_add_string((const char *)"msg", message);    // add message to the response object
 }
 
+/****************************************************************************************
+ * cm_set_output() - M62, M63, M64, M65 - switch digital output P
+ *
+ *  M64 and M65 switch the output now. M62 and M63 switch it Q (in the current units, 0 if
+ *  omitted) into the next move, from the runtime - see mp_sync_output().
+ */
+
+stat_t cm_set_output(const uint8_t control,
+                     const float P_word, const bool P_flag,
+                     const float Q_word, const bool Q_flag)
+{
+    if (!P_flag) {
+        return (STAT_P_WORD_IS_MISSING);
+    }
+    if (floor(P_word) != P_word) {
+        return (STAT_P_WORD_IS_NOT_AN_INTEGER);
+    }
+    if ((P_word < 1) || (P_word > D_OUT_CHANNELS)) {
+        return (STAT_P_WORD_IS_INVALID);
+    }
+    uint8_t output_num = (uint8_t)P_word;
+    if (control == OUTPUT_ON) {
+        return (gpio_set_output(output_num-1, 1.0));
+    }
+    if (control == OUTPUT_OFF) {
+        return (gpio_set_output(output_num-1, 0.0));
+    }
+    if (Q_flag && (Q_word < 0)) {
+        return (STAT_Q_WORD_IS_INVALID);
+    }
+    mp_sync_output(output_num, (control == OUTPUT_SYNC_ON), Q_flag ? _to_millimeters(Q_word) : 0);
+    return (STAT_OK);
+}
+
 /****************************************************************************************
  **** Overrides *************************************************************************
  ****************************************************************************************/
@@ -1399,6 +1566,7 @@ void cm_reset_overrides()
     cm->gmx.mfo_factor = 1.0;
     cm->gmx.mto_enable = false;  // traverse overrides
     cm->gmx.mto_factor = 1.0;
+    mp_reset_overrides();        // and the planner and exec ramps that carry them out
 }
 
 /****************************************************************************************
@@ -1521,10 +1689,10 @@ stat_t cm_tro_control(const float P_word, const bool P_flag) // M50.1
         }
     }
     if (cm->gmx.m48_enable) {               // if master enable is ON
-        if (new_enable && (new_override || !cm->gmx.mfo_enable)) {   // 3 cases to start a ramp
-            mp_start_traverse_override(FEED_OVERRIDE_RAMP_TIME, cm->gmx.mto_factor);
+        if (new_enable && (new_override || !cm->gmx.mto_enable)) {   // 3 cases to start a ramp
+            mp_start_traverse_override(TRAVERSE_OVERRIDE_RAMP_TIME, cm->gmx.mto_factor);
         } else if (cm->gmx.mto_enable && !new_enable) {              // case to turn off the ramp
-            mp_end_traverse_override(FEED_OVERRIDE_RAMP_TIME);
+            mp_end_traverse_override(TRAVERSE_OVERRIDE_RAMP_TIME);
         }
     }
     cm->gmx.mto_enable = new_enable;        // always update the enable state
@@ -1631,6 +1799,7 @@ void cm_cycle_start()
 
 void cm_cycle_end()
 {
+    spindle_override_settle();              // finish a spindle override ramp the motion ran out on
     if (cm->cycle_type == CYCLE_MACHINING) {
         float value[] = { (float)MACHINE_PROGRAM_STOP };
         _exec_program_finalize(value, nullptr);
@@ -1709,6 +1878,7 @@ stat_t cm_run_home(nvObj_t *nv)
  *
  * cm_get_jogging_dest()
  * cm_run_jog()
+ * cm_run_jgv() - velocity in the current units per minute
  */
 
 float cm_get_jogging_dest(void)
@@ -1723,6 +1893,15 @@ stat_t cm_run_jog(nvObj_t *nv)
     return (STAT_OK);
 }
 
+stat_t cm_run_jgv(nvObj_t *nv)
+{
+    float velocity = nv->value_flt;
+    if (cm_get_axis_type(nv) == AXIS_TYPE_LINEAR) {
+        velocity = _to_millimeters(velocity);   // rotary axes are always in degrees
+    }
+    return (cm_velocity_jog(_axis(nv), velocity));
+}
+
 /**************************************
  * END OF CANONICAL MACHINE FUNCTIONS *
  **************************************/
@@ -1778,6 +1957,13 @@ static int8_t _axis(const nvObj_t *nv)
         return(st_cfg.mot[c-0x31].motor_map);   // return the axis associated with the motor
     }
 
+    // tool geometry (ttNrd, ttNlw, ttNrw) is a length that belongs to no axis
+    const char *token = cfgArray[nv->index].token;
+    uint8_t len = strlen(token);
+    if ((token[0] == 't') && (token[1] == 't') && (len >= 5) && isalpha(token[len-2])) {
+        return (AXIS_TYPE_SYSTEM);
+    }
+
     // otherwise it's an axis. Or undefined, which is usually a global.
     char *ptr;
     char axes[] = {"xyzuvwabc"};
@@ -1949,7 +2135,23 @@ static const char msg_g01[] = "G1  - linear feed";
 static const char msg_g02[] = "G2  - clockwise arc feed";
 static const char msg_g03[] = "G3  - counter clockwise arc feed";
 static const char msg_g80[] = "G80 - cancel motion mode (none active)";
-static const char *const msg_momo[] = { msg_g00, msg_g01, msg_g02, msg_g03, msg_g80 };
+static const char msg_g05[] = "G5  - cubic spline feed";
+static const char msg_g051[] = "G5.1 - quadratic spline feed";
+static const char msg_g382[] = "G38.2 - straight probe";
+static const char msg_g81[] = "G81 - drilling";
+static const char msg_g82[] = "G82 - drilling with dwell";
+static const char msg_g83[] = "G83 - peck drilling";
+static const char msg_g84[] = "G84 - right hand tapping";
+static const char msg_g85[] = "G85 - boring, feed out";
+static const char msg_g86[] = "G86 - boring, spindle stop, rapid out";
+static const char msg_g87[] = "G87 - back boring";
+static const char msg_g88[] = "G88 - boring, spindle stop, manual out";
+static const char msg_g89[] = "G89 - boring, dwell, feed out";
+static const char msg_g73[] = "G73 - chip breaking peck drilling";
+static const char msg_g33[] = "G33 - spindle synchronized motion";
+static const char *const msg_momo[] = { msg_g00, msg_g01, msg_g02, msg_g03, msg_g80, msg_g05, msg_g051, msg_g382,
+                                        msg_g81, msg_g82, msg_g83, msg_g84, msg_g85, msg_g86, msg_g87, msg_g88, msg_g89,
+                                        msg_g73, msg_g33 };
 
 static const char msg_g17[] = "G17 - XY plane";
 static const char msg_g18[] = "G18 - XZ plane";
@@ -2021,15 +2223,22 @@ stat_t cm_get_frmo(nvObj_t *nv) { return(_get_msg_helper(nv, msg_frmo, cm_get_fe
 
 stat_t cm_get_toolv(nvObj_t *nv) { return(get_integer(nv, cm_get_tool(ACTIVE_MODEL))); }
 stat_t cm_get_mline(nvObj_t *nv) { return(get_integer(nv, cm_get_linenum(MODEL))); }
-stat_t cm_get_line(nvObj_t *nv)  { return(get_integer(nv, cm_get_linenum(ACTIVE_MODEL))); }
+stat_t cm_get_line(nvObj_t *nv)
+{
+    if (ACTIVE_MODEL == MODEL) {
+        return(get_integer(nv, cm_get_linenum(MODEL)));
+    }
+    return(get_integer(nv, mp_get_runtime_snapshot()->linenum));
+}
 
 stat_t cm_get_vel(nvObj_t *nv)
 {
     if (cm_get_motion_state() == MOTION_STOP) {
         nv->value_flt = 0;
     } else {
-        nv->value_flt = mp_get_runtime_velocity();
-        if (cm_get_units_mode(RUNTIME) == INCHES) {
+        const mpRuntimeSnapshot_t *s = mp_get_runtime_snapshot();
+        nv->value_flt = s->velocity;
+        if (s->units_mode == INCHES) {
             nv->value_flt *= INCHES_PER_MM;
         }
     }
@@ -2038,9 +2247,51 @@ stat_t cm_get_vel(nvObj_t *nv)
     return (STAT_OK);
 }
 
-stat_t cm_get_feed(nvObj_t *nv) { return (get_float(nv, cm_get_feed_rate(ACTIVE_MODEL))); }
-stat_t cm_get_pos(nvObj_t *nv)  { return (get_float(nv, cm_get_display_position(ACTIVE_MODEL, _axis(nv)))); }
-stat_t cm_get_mpo(nvObj_t *nv)  { return (get_float(nv, cm_get_absolute_position(ACTIVE_MODEL, _axis(nv)))); }
+stat_t cm_get_hdst(nvObj_t *nv)
+{
+    nv->value_flt = cm->hold_distance;
+    if (cm_get_units_mode(RUNTIME) == INCHES) {
+        nv->value_flt *= INCHES_PER_MM;
+    }
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+/*
+ * Position, feed and line getters read the runtime through its segment snapshot while
+ * in motion, so the fields of one status report all describe the same segment.
+ */
+
+stat_t cm_get_feed(nvObj_t *nv)
+{
+    if (ACTIVE_MODEL == MODEL) {
+        return (get_float(nv, cm_get_feed_rate(MODEL)));
+    }
+    return (get_float(nv, mp_get_runtime_snapshot()->feed_rate));
+}
+
+stat_t cm_get_pos(nvObj_t *nv)
+{
+    const uint8_t axis = _axis(nv);
+    if (ACTIVE_MODEL == MODEL) {
+        return (get_float(nv, cm_get_display_position(MODEL, axis)));
+    }
+    const mpRuntimeSnapshot_t *s = mp_get_runtime_snapshot();
+    float position = mp_get_snapshot_display_position(s, axis);
+    if ((axis <= AXIS_W) && (s->units_mode == INCHES)) {
+        position /= MM_PER_INCH;
+    }
+    return (get_float(nv, position));
+}
+
+stat_t cm_get_mpo(nvObj_t *nv)
+{
+    if (ACTIVE_MODEL == MODEL) {
+        return (get_float(nv, cm_get_absolute_position(MODEL, _axis(nv))));
+    }
+    return (get_float(nv, mp_get_runtime_snapshot()->position[_axis(nv)]));
+}
 stat_t cm_get_ofs(nvObj_t *nv)  { return (get_float(nv, cm_get_display_offset(ACTIVE_MODEL, _axis(nv)))); }
 
 stat_t cm_get_home(nvObj_t *nv) { return(_get_msg_helper(nv, msg_home, cm_get_homing_state())); }
@@ -2051,7 +2302,12 @@ stat_t cm_get_prob(nvObj_t *nv) { return(_get_msg_helper(nv, msg_probe, cm_get_p
 stat_t cm_get_prb(nvObj_t *nv)  { return (get_float(nv, cm->probe_results[0][_axis(nv)])); }
 
 stat_t cm_get_coord(nvObj_t *nv) { return (get_float(nv, cm->coord_offset[_coord(nv)][_axis(nv)])); }
-stat_t cm_set_coord(nvObj_t *nv) { return (set_float(nv, cm->coord_offset[_coord(nv)][_axis(nv)])); }
+stat_t cm_set_coord(nvObj_t *nv)
+{
+    ritorno(set_float(nv, cm->coord_offset[_coord(nv)][_axis(nv)]));
+    cm_update_work_offsets();
+    return (STAT_OK);
+}
 
 stat_t cm_get_g92e(nvObj_t *nv)  { return (get_integer(nv, cm->gmx.g92_offset_enable)); }
 stat_t cm_get_g92(nvObj_t *nv)   { return (get_float(nv, cm->gmx.g92_offset[_axis(nv)])); }
@@ -2071,7 +2327,12 @@ static uint8_t _tool(nvObj_t *nv)
 }
 
 stat_t cm_get_tof(nvObj_t *nv) { return (get_float(nv, cm->tool_offset[_axis(nv)])); }
-stat_t cm_set_tof(nvObj_t *nv) { return (set_float(nv, cm->tool_offset[_axis(nv)])); }
+stat_t cm_set_tof(nvObj_t *nv)
+{
+    ritorno(set_float(nv, cm->tool_offset[_axis(nv)]));
+    cm_update_work_offsets();
+    return (STAT_OK);
+}
 
 stat_t cm_get_tt(nvObj_t *nv)
 {   
@@ -2091,6 +2352,96 @@ stat_t cm_set_tt(nvObj_t *nv)
     return(set_float(nv, tt.tt_offset[toolnum][_axis(nv)]));
 }
 
+stat_t cm_get_ttk(nvObj_t *nv)
+{
+    uint8_t toolnum = _tool(nv);
+    if ((toolnum == 0) || (toolnum > EXTRUDER_TOOLS)) {
+        return (STAT_INPUT_EXCEEDS_MAX_VALUE);
+    }
+    return (get_float(nv, tt.pressure_advance[toolnum]));
+}
+
+stat_t cm_set_ttk(nvObj_t *nv)
+{
+    uint8_t toolnum = _tool(nv);
+    if ((toolnum == 0) || (toolnum > EXTRUDER_TOOLS)) {
+        return (STAT_INPUT_EXCEEDS_MAX_VALUE);
+    }
+    return(set_float_range(nv, tt.pressure_advance[toolnum], 0, PRESSURE_ADVANCE_MAX));
+}
+
+/*
+ * cm_get_ttrd(), cm_set_ttrd() - tool radius
+ * cm_get_ttlw(), cm_set_ttlw() - tool length wear - applied by the next G43
+ * cm_get_ttrw(), cm_set_ttrw() - tool radius wear
+ */
+
+static float *_tool_geometry(nvObj_t *nv, float *field)
+{
+    uint8_t toolnum = _tool(nv);
+    return ((toolnum > TOOLS) ? nullptr : &field[toolnum]);
+}
+
+stat_t cm_get_ttrd(nvObj_t *nv)
+{
+    float *value = _tool_geometry(nv, tt.radius);
+    return ((value == nullptr) ? STAT_INPUT_EXCEEDS_MAX_VALUE : get_float(nv, *value));
+}
+
+stat_t cm_set_ttrd(nvObj_t *nv)
+{
+    float *value = _tool_geometry(nv, tt.radius);
+    return ((value == nullptr) ? STAT_INPUT_EXCEEDS_MAX_VALUE : set_float_range(nv, *value, 0, TOOL_RADIUS_MAX));
+}
+
+stat_t cm_get_ttlw(nvObj_t *nv)
+{
+    float *value = _tool_geometry(nv, tt.length_wear);
+    return ((value == nullptr) ? STAT_INPUT_EXCEEDS_MAX_VALUE : get_float(nv, *value));
+}
+
+stat_t cm_set_ttlw(nvObj_t *nv)
+{
+    float *value = _tool_geometry(nv, tt.length_wear);
+    return ((value == nullptr) ? STAT_INPUT_EXCEEDS_MAX_VALUE : set_float(nv, *value));
+}
+
+stat_t cm_get_ttrw(nvObj_t *nv)
+{
+    float *value = _tool_geometry(nv, tt.radius_wear);
+    return ((value == nullptr) ? STAT_INPUT_EXCEEDS_MAX_VALUE : get_float(nv, *value));
+}
+
+stat_t cm_set_ttrw(nvObj_t *nv)
+{
+    float *value = _tool_geometry(nv, tt.radius_wear);
+    return ((value == nullptr) ? STAT_INPUT_EXCEEDS_MAX_VALUE : set_float(nv, *value));
+}
+
+/*
+ * cm_get_ttpw(), cm_set_ttpw() - PWM channel of the tool's spindle or laser (1-N)
+ *
+ *  Takes effect at the tool's next M6.
+ */
+
+stat_t cm_get_ttpw(nvObj_t *nv)
+{
+    uint8_t toolnum = _tool(nv);
+    if (toolnum > TOOLS) {
+        return (STAT_INPUT_EXCEEDS_MAX_VALUE);
+    }
+    return (get_integer(nv, tt.pwm_channel[toolnum]));
+}
+
+stat_t cm_set_ttpw(nvObj_t *nv)
+{
+    uint8_t toolnum = _tool(nv);
+    if (toolnum > TOOLS) {
+        return (STAT_INPUT_EXCEEDS_MAX_VALUE);
+    }
+    return (set_integer(nv, tt.pwm_channel[toolnum], 1, PWMS));
+}
+
 /************************************
  **** AXIS GET AND SET FUNCTIONS ****
  ************************************/
@@ -2125,13 +2476,24 @@ stat_t cm_set_am(nvObj_t *nv)        // axis mode
     }
     nv->valuetype = TYPE_INTEGER;
     cm->a[_axis(nv)].axis_mode = (cmAxisMode)nv->value_int;
+    kn_config_changed();
     return(STAT_OK);    
 }
 
 stat_t cm_get_tn(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].travel_min)); }
-stat_t cm_set_tn(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].travel_min)); }
+stat_t cm_set_tn(nvObj_t *nv)
+{
+    ritorno(set_float(nv, cm->a[_axis(nv)].travel_min));
+    cm_update_soft_limits();
+    return (STAT_OK);
+}
 stat_t cm_get_tm(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].travel_max)); }
-stat_t cm_set_tm(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].travel_max)); }
+stat_t cm_set_tm(nvObj_t *nv)
+{
+    ritorno(set_float(nv, cm->a[_axis(nv)].travel_max));
+    cm_update_soft_limits();
+    return (STAT_OK);
+}
 stat_t cm_get_ra(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].radius)); }
 stat_t cm_set_ra(nvObj_t *nv) { return (set_float_range(nv, cm->a[_axis(nv)].radius, RADIUS_MIN, 1000000)); }
 
@@ -2157,12 +2519,14 @@ void _cm_recalc_junction_accel(const uint8_t axis) {
 void cm_set_axis_max_jerk(const uint8_t axis, const float jerk)
 {
     cm->a[axis].jerk_max = jerk;
+    cm->a[axis].recip_jerk_max = 1/jerk;
     _cm_recalc_junction_accel(axis);    // Must recalculate the max_junction_accel now that the jerk has changed.
 }
 
 void cm_set_axis_high_jerk(const uint8_t axis, const float jerk)
 {
     cm->a[axis].jerk_high = jerk;
+    cm->a[axis].recip_jerk_high = 1/jerk;
     _cm_recalc_junction_accel(axis);    // Must recalculate the max_junction_accel now that the jerk has changed.
 }
 
@@ -2176,6 +2540,8 @@ void cm_set_axis_high_jerk(const uint8_t axis, const float jerk)
  * cm_set_jm() - set jerk max value     - called from dispatch table
  * cm_get_jh() - get jerk homing value  - called from dispatch table
  * cm_set_jh() - set jerk homing value  - called from dispatch table
+ * cm_get_ac() - get accel max value    - called from dispatch table
+ * cm_set_ac() - set accel max value    - called from dispatch table
  *
  *  Jerk values can be rather large, often in the billions. This makes for some pretty big
  *  numbers for people to deal with. Jerk values are stored in the system in truncated format;
@@ -2184,6 +2550,9 @@ void cm_set_axis_high_jerk(const uint8_t axis, const float jerk)
  *  The axis_jerk() functions expect the jerk in divided-by 1,000,000 form.
  *  The set_xjm() and set_xjh() functions accept values divided by 1,000,000. 
  *  This is corrected to mm/min^3 by the internals of the code.
+ *
+ *  Acceleration values are likewise stored divided by 1,000 (ACCEL_MULTIPLIER). An axis
+ *  with an acceleration max of 0 is limited by its jerk alone. See _calculate_jerk().
  */
 
 stat_t cm_get_vm(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].velocity_max)); }
@@ -2222,9 +2591,79 @@ stat_t cm_set_jh(nvObj_t *nv)
     return(STAT_OK);
 }
 
+stat_t cm_get_ac(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].accel_max)); }
+stat_t cm_set_ac(nvObj_t *nv)
+{
+    uint8_t axis = _axis(nv);
+    ritorno(set_float_range(nv, cm->a[axis].accel_max, 0, MAX_LONG));
+    cm->a[axis].recip_accel_max = (nv->value_flt > 0) ? 1/nv->value_flt : 0;
+    return(STAT_OK);
+}
+
+/**** Backlash Settings - see Backlash compensation in stepper.h
+ * cm_get_bl() - get backlash
+ * cm_set_bl() - set backlash and convert it to steps for the motors on the axis
+ */
+
+stat_t cm_get_bl(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].backlash)); }
+stat_t cm_set_bl(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, cm->a[_axis(nv)].backlash, 0, BACKLASH_MAX));
+    kn_config_changed();
+    return(STAT_OK);
+}
+
+/**** Input Shaper Settings - see plan_shaper.cpp
+ * cm_get_sf()  - get input shaper frequency
+ * cm_set_sf()  - set input shaper frequency - 0 for no shaping
+ * cm_get_sz()  - get input shaper damping ratio
+ * cm_set_sz()  - set input shaper damping ratio
+ * cm_get_shp() - get input shaper type
+ * cm_set_shp() - set input shaper type for all axes
+ */
+
+static void _shaper_configure(const uint8_t axis)
+{
+    mp_shaper_configure(axis, cm->shaper_type, cm->a[axis].shaper_frequency, cm->a[axis].shaper_damping);
+}
+
+stat_t cm_get_sf(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].shaper_frequency)); }
+stat_t cm_set_sf(nvObj_t *nv)
+{
+    uint8_t axis = _axis(nv);
+    if ((nv->value_flt > 0) && (nv->value_flt < SHAPER_FREQUENCY_MIN)) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_INPUT_LESS_THAN_MIN_VALUE);
+    }
+    ritorno(set_float_range(nv, cm->a[axis].shaper_frequency, 0, SHAPER_FREQUENCY_MAX));
+    _shaper_configure(axis);
+    return(STAT_OK);
+}
+
+stat_t cm_get_sz(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].shaper_damping)); }
+stat_t cm_set_sz(nvObj_t *nv)
+{
+    uint8_t axis = _axis(nv);
+    ritorno(set_float_range(nv, cm->a[axis].shaper_damping, 0, SHAPER_DAMPING_MAX));
+    _shaper_configure(axis);
+    return(STAT_OK);
+}
+
+stat_t cm_get_shp(nvObj_t *nv) { return (get_integer(nv, cm->shaper_type)); }
+stat_t cm_set_shp(nvObj_t *nv)
+{
+    ritorno(set_integer(nv, cm->shaper_type, SHAPER_TYPE_ZV, SHAPER_TYPE_EI));
+    for (uint8_t axis=0; axis<SHAPER_AXES; axis++) {
+        _shaper_configure(axis);
+    }
+    return(STAT_OK);
+}
+
 /**** Axis Homing Settings
  * cm_get_hi() - get homing input
  * cm_set_hi() - set homing input
+ * cm_get_hs() - get gantry squaring homing input
+ * cm_set_hs() - set gantry squaring homing input
  * cm_get_hd() - get homing direction
  * cm_set_hd() - set homing direction
  * cm_get_sv() - get homing search velocity
@@ -2239,6 +2678,8 @@ stat_t cm_set_jh(nvObj_t *nv)
 
 stat_t cm_get_hi(nvObj_t *nv) { return (get_integer(nv, cm->a[_axis(nv)].homing_input)); }
 stat_t cm_set_hi(nvObj_t *nv) { return (set_integer(nv, cm->a[_axis(nv)].homing_input, 0, D_IN_CHANNELS)); }
+stat_t cm_get_hs(nvObj_t *nv) { return (get_integer(nv, cm->a[_axis(nv)].homing_input_2)); }
+stat_t cm_set_hs(nvObj_t *nv) { return (set_integer(nv, cm->a[_axis(nv)].homing_input_2, 0, D_IN_CHANNELS)); }
 stat_t cm_get_hd(nvObj_t *nv) { return (get_integer(nv, cm->a[_axis(nv)].homing_dir)); }
 stat_t cm_set_hd(nvObj_t *nv) { return (set_integer(nv, cm->a[_axis(nv)].homing_dir, 0, 1)); }
 stat_t cm_get_sv(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].search_velocity)); }
@@ -2257,8 +2698,12 @@ stat_t cm_set_zb(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].zero_back
  * cm_set_jt()  - set junction integration time
  * cm_get_ct()  - get chordal tolerance
  * cm_set_ct()  - set chordal tolerance
+ * cm_get_plr() - get planner acceleration runs enable
+ * cm_set_plr() - set planner acceleration runs enable
  * cm_get_sl()  - get soft limit enable
  * cm_set_sl()  - set soft limit enable
+ * cm_get_hsm() - get simultaneous homing enable
+ * cm_set_hsm() - set simultaneous homing enable
  * cm_get_lim() - get hard limit enable
  * cm_set_lim() - set hard limit enable
  * cm_get_saf() - get safety interlock enable
@@ -2280,11 +2725,53 @@ stat_t cm_set_jt(nvObj_t *nv)
 stat_t cm_get_ct(nvObj_t *nv) { return(get_float(nv, cm->chordal_tolerance)); }
 stat_t cm_set_ct(nvObj_t *nv) { return(set_float_range(nv, cm->chordal_tolerance, CHORDAL_TOLERANCE_MIN, 10000000)); }
 
+stat_t cm_get_arcb(nvObj_t *nv) { return(get_float(nv, cm->arc_time_budget)); }
+stat_t cm_set_arcb(nvObj_t *nv) { return(set_float_range(nv, cm->arc_time_budget, 0, ARC_TIME_BUDGET_MAX)); }
+
+stat_t cm_get_qt(nvObj_t *nv) { return(get_float(nv, cm->planner_time_target)); }
+stat_t cm_set_qt(nvObj_t *nv) { return(set_float_range(nv, cm->planner_time_target, 0, PLANNER_TIME_TARGET_MAX)); }
+
+stat_t cm_get_mgt(nvObj_t *nv) { return(get_float(nv, cm->merge_tolerance)); }
+stat_t cm_set_mgt(nvObj_t *nv) { return(set_float_range(nv, cm->merge_tolerance, 0, 1)); }
+
+stat_t cm_get_plr(nvObj_t *nv) { return(get_integer(nv, cm->planner_runs)); }
+stat_t cm_set_plr(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->planner_runs, 0, 1)); }
+
+stat_t cm_get_seg(nvObj_t *nv) { return(get_float(nv, mp_seg.min_segment_ms)); }
+stat_t cm_set_seg(nvObj_t *nv)
+{
+    float segment_ms;
+    ritorno(set_float_range(nv, segment_ms, MIN_SEGMENT_MS_FLOOR, MIN_SEGMENT_MS));
+    nv->value_flt = mp_set_segment_ms(segment_ms);
+    if (nv->value_flt > segment_ms) {
+        nv_add_conditional_message("Raised to fit measured exec time - see $segx");
+    }
+    return(STAT_OK);
+}
+
+stat_t cm_get_segx(nvObj_t *nv) { return(get_float(nv, mp_get_exec_usec_max())); }
+stat_t cm_set_segx(nvObj_t *nv) { mp_seg.exec_cycles_max = 0; return(STAT_OK); }   // any write clears it
+
 stat_t cm_get_zl(nvObj_t *nv) { return(get_float(nv, cm->feedhold_z_lift)); }
 stat_t cm_set_zl(nvObj_t *nv) { return(set_float(nv, cm->feedhold_z_lift)); }
 
+stat_t cm_get_prbn(nvObj_t *nv) { return(get_integer(nv, cm->probe_touches)); }
+stat_t cm_set_prbn(nvObj_t *nv) { return(set_integer(nv, cm->probe_touches, 0, PROBE_TOUCHES_MAX)); }
+stat_t cm_get_prbk(nvObj_t *nv) { return(get_float(nv, cm->probe_backoff)); }
+stat_t cm_set_prbk(nvObj_t *nv) { return(set_float_range(nv, cm->probe_backoff, 0, PROBE_BACKOFF_MAX)); }
+stat_t cm_get_prbs(nvObj_t *nv) { return(get_float(nv, cm->probe_slow_feed)); }
+stat_t cm_set_prbs(nvObj_t *nv) { return(set_float(nv, cm->probe_slow_feed)); }
+
 stat_t cm_get_sl(nvObj_t *nv) { return(get_integer(nv, cm->soft_limit_enable)); }
-stat_t cm_set_sl(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->soft_limit_enable, 0, 1)); }
+stat_t cm_set_sl(nvObj_t *nv)
+{
+    ritorno(set_integer(nv, (uint8_t &)cm->soft_limit_enable, 0, 1));
+    cm_update_soft_limits();
+    return (STAT_OK);
+}
+
+stat_t cm_get_hsm(nvObj_t *nv) { return(get_integer(nv, cm->homing_simultaneous)); }
+stat_t cm_set_hsm(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->homing_simultaneous, 0, 1)); }
 
 stat_t cm_get_lim(nvObj_t *nv) { return(get_integer(nv, cm->limit_enable)); }
 stat_t cm_set_lim(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->limit_enable, 0, 1)); }
@@ -2298,7 +2785,19 @@ stat_t cm_set_m48(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->gmx.m48_e
 stat_t cm_get_froe(nvObj_t *nv) { return(get_integer(nv, cm->gmx.mfo_enable)); }
 stat_t cm_set_froe(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->gmx.mfo_enable, 0, 1)); }
 stat_t cm_get_fro(nvObj_t *nv)  { return(get_float(nv, cm->gmx.mfo_factor)); }
-stat_t cm_set_fro(nvObj_t *nv)  { return(set_float_range(nv, cm->gmx.mfo_factor, FEED_OVERRIDE_MIN, FEED_OVERRIDE_MAX)); }
+stat_t cm_set_fro(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, cm->gmx.mfo_factor, FEED_OVERRIDE_MIN, FEED_OVERRIDE_MAX));
+    if (cm->gmx.m48_enable && cm->gmx.mfo_enable) {    // apply it now if the override is in effect
+        mp_start_feed_override(FEED_OVERRIDE_RAMP_TIME, cm->gmx.mfo_factor);
+    }
+    return (STAT_OK);
+}
+
+stat_t cm_get_frm(nvObj_t *nv)  { return(get_integer(nv, cm->mfo_mode)); }
+stat_t cm_set_frm(nvObj_t *nv)  { return(set_integer(nv, (uint8_t &)cm->mfo_mode, MFO_MODE_REPLAN, MFO_MODE_TIME_SCALE)); }
+stat_t cm_get_rfm(nvObj_t *nv)  { return(get_integer(nv, cm->rotary_feed_mode)); }
+stat_t cm_set_rfm(nvObj_t *nv)  { return(set_integer(nv, (uint8_t &)cm->rotary_feed_mode, ROTARY_FEED_STANDARD, ROTARY_FEED_TOOL_TIP)); }
 
 stat_t cm_get_troe(nvObj_t *nv) { return(get_integer(nv, cm->gmx.mto_enable)); }
 stat_t cm_set_troe(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->gmx.mto_enable, 0, 1)); }
@@ -2368,6 +2867,7 @@ static const char fmt_macs[] = "Raw machine state:   %s\n"; // raw machine state
 static const char fmt_cycs[] = "Cycle state:         %s\n";
 static const char fmt_mots[] = "Motion state:        %s\n";
 static const char fmt_hold[] = "Feedhold state:      %s\n";
+static const char fmt_hdst[] = "Hold stop distance:%7.3f%s\n";
 static const char fmt_home[] = "Homing state:        %s\n";
 static const char fmt_unit[] = "Units:               %s\n"; // units mode as ASCII string
 static const char fmt_coor[] = "Coordinate system:   %s\n";
@@ -2390,6 +2890,7 @@ void cm_print_macs(nvObj_t *nv) { text_print_str(nv, fmt_macs);} // See _get_msg
 void cm_print_cycs(nvObj_t *nv) { text_print_str(nv, fmt_cycs);}
 void cm_print_mots(nvObj_t *nv) { text_print_str(nv, fmt_mots);}
 void cm_print_hold(nvObj_t *nv) { text_print_str(nv, fmt_hold);}
+void cm_print_hdst(nvObj_t *nv) { text_print_flt_units(nv, fmt_hdst, GET_UNITS(ACTIVE_MODEL));}
 void cm_print_home(nvObj_t *nv) { text_print_str(nv, fmt_home);}
 void cm_print_unit(nvObj_t *nv) { text_print_str(nv, fmt_unit);}
 void cm_print_coor(nvObj_t *nv) { text_print_str(nv, fmt_coor);}
@@ -2416,21 +2917,45 @@ void cm_print_gdi(nvObj_t *nv) { text_print(nv, fmt_gdi);}  // TYPE_INT
 
 static const char fmt_jt[] = "[jt]  junction integration time%7.2f\n";
 static const char fmt_ct[] = "[ct]  chordal tolerance%17.4f%s\n";
+static const char fmt_mgt[] ="[mgt] segment merge tolerance%11.4f%s [0=disable]\n";
+static const char fmt_plr[] ="[plr] planner acceleration runs%4d [0=per block,1=over several blocks]\n";
+static const char fmt_arcb[]="[arcb] arc segment time budget%10.0f us [0=one segment per pass]\n";
+static const char fmt_qt[] = "[qt]  planner time target%15.0f ms [0=disable]\n";
+static const char fmt_seg[] ="[seg] minimum segment time%13.3f ms\n";
+static const char fmt_segx[]="[segx] worst case exec time%12.1f us\n";
 static const char fmt_zl[] = "[zl]  Z lift on feedhold%16.3f%s\n";
+static const char fmt_prbn[]="[prbn] probe slow touches%9d [0=single touch]\n";
+static const char fmt_prbk[]="[prbk] probe backoff%19.3f%s\n";
+static const char fmt_prbs[]="[prbs] probe slow feed rate%13.0f%s/min\n";
 static const char fmt_sl[] = "[sl]  soft limit enable%12d [0=disable,1=enable]\n";
+static const char fmt_hsm[] ="[hsm] simultaneous homing%10d [0=one axis at a time,1=non-Z axes together]\n";
 static const char fmt_lim[] ="[lim] limit switch enable%10d [0=disable,1=enable]\n";
 static const char fmt_saf[] ="[saf] safety interlock enable%6d [0=disable,1=enable]\n";
+static const char fmt_shp[] = "[shp] input shaper type%12d [0=ZV,1=ZVD,2=EI]\n";
 
 void cm_print_jt(nvObj_t *nv) { text_print(nv, fmt_jt);}        // TYPE FLOAT
 void cm_print_ct(nvObj_t *nv) { text_print_flt_units(nv, fmt_ct, GET_UNITS(ACTIVE_MODEL));}
+void cm_print_plr(nvObj_t *nv){ text_print(nv, fmt_plr);}       // TYPE_INT
+void cm_print_arcb(nvObj_t *nv){ text_print(nv, fmt_arcb);}     // TYPE FLOAT
+void cm_print_qt(nvObj_t *nv) { text_print(nv, fmt_qt);}        // TYPE FLOAT
+void cm_print_mgt(nvObj_t *nv){ text_print_flt_units(nv, fmt_mgt, GET_UNITS(ACTIVE_MODEL));}
+void cm_print_seg(nvObj_t *nv){ text_print(nv, fmt_seg);}       // TYPE FLOAT
+void cm_print_segx(nvObj_t *nv){ text_print(nv, fmt_segx);}     // TYPE FLOAT
 void cm_print_zl(nvObj_t *nv) { text_print_flt_units(nv, fmt_zl, GET_UNITS(ACTIVE_MODEL));}
+void cm_print_prbn(nvObj_t *nv){ text_print(nv, fmt_prbn);}     // TYPE_INT
+void cm_print_prbk(nvObj_t *nv){ text_print_flt_units(nv, fmt_prbk, GET_UNITS(ACTIVE_MODEL));}
+void cm_print_prbs(nvObj_t *nv){ text_print_flt_units(nv, fmt_prbs, GET_UNITS(ACTIVE_MODEL));}
 void cm_print_sl(nvObj_t *nv) { text_print(nv, fmt_sl);}        // TYPE_INT
+void cm_print_hsm(nvObj_t *nv){ text_print(nv, fmt_hsm);}       // TYPE_INT
 void cm_print_lim(nvObj_t *nv){ text_print(nv, fmt_lim);}       // TYPE_INT
 void cm_print_saf(nvObj_t *nv){ text_print(nv, fmt_saf);}       // TYPE_INT
+void cm_print_shp(nvObj_t *nv){ text_print(nv, fmt_shp);}       // TYPE_INT
 
 static const char fmt_m48[]  = "[m48] overrides enabled%12d [0=disable,1=enable]\n";
 static const char fmt_froe[] = "[froe] feed override enable%8d [0=disable,1=enable]\n";
 static const char fmt_fro[]  = "[fro]  feedrate override%15.3f [0.05 < mfo < 2.00]\n";
+static const char fmt_frm[]  = "[frm]  feed override mode%10d [0=replan,1=time-scale]\n";
+static const char fmt_rfm[]  = "[rfm]  rotary feed mode%12d [0=standard,1=tool tip]\n";
 static const char fmt_troe[] = "[troe] traverse over enable%8d [0=disable,1=enable]\n";
 static const char fmt_tro[]  = "[tro]  traverse override%15.3f [0.05 < mto < 1.00]\n";
 static const char fmt_tram[] = "[tram] is coordinate space rotated to be tram %s\n";
@@ -2439,6 +2964,8 @@ static const char fmt_nxln[] = "[nxln] next line number %lu\n";
 void cm_print_m48(nvObj_t *nv)  { text_print(nv, fmt_m48);}    // TYPE_INT
 void cm_print_froe(nvObj_t *nv) { text_print(nv, fmt_froe);}    // TYPE INT
 void cm_print_fro(nvObj_t *nv)  { text_print(nv, fmt_fro);}     // TYPE FLOAT
+void cm_print_frm(nvObj_t *nv)  { text_print(nv, fmt_frm);}     // TYPE INT
+void cm_print_rfm(nvObj_t *nv)  { text_print(nv, fmt_rfm);}     // TYPE INT
 void cm_print_troe(nvObj_t *nv) { text_print(nv, fmt_troe);}    // TYPE INT
 void cm_print_tro(nvObj_t *nv)  { text_print(nv, fmt_tro);}     // TYPE FLOAT
 void cm_print_tram(nvObj_t *nv) { text_print(nv, fmt_tram);};   // TYPE BOOL
@@ -2458,6 +2985,10 @@ void cm_print_nxln(nvObj_t *nv) { text_print(nv, fmt_nxln);};   // TYPE INT
  *    cm_print_tn()
  *    cm_print_jm()
  *    cm_print_jh()
+ *    cm_print_ac()
+ *    cm_print_bl()
+ *    cm_print_sf()
+ *    cm_print_sz()
  *    cm_print_ra()
  *    cm_print_hi()
  *    cm_print_hd()
@@ -2477,8 +3008,18 @@ static const char fmt_Xtm[] = "[%s%s] %s travel maximum%17.3f%s\n";
 static const char fmt_Xtn[] = "[%s%s] %s travel minimum%17.3f%s\n";
 static const char fmt_Xjm[] = "[%s%s] %s jerk maximum%15.0f%s/min^3 * 1 million\n";
 static const char fmt_Xjh[] = "[%s%s] %s jerk homing%16.0f%s/min^3 * 1 million\n";
+static const char fmt_Xac[] = "[%s%s] %s accel maximum%14.0f%s/min^2 * 1 thousand [0=jerk limit only]\n";
+static const char fmt_Xbl[] = "[%s%s] %s backlash%19.4f%s [0=no compensation]\n";
+static const char fmt_Xsf[] = "[%s%s] %s shaper frequency%11.1f Hz [0=no input shaping]\n";
+static const char fmt_Xsz[] = "[%s%s] %s shaper damping%13.3f\n";
+static const char fmt_ttk[] = "[%s%s] %s pressure advance%11.3f s\n";
+static const char fmt_ttrd[] = "[%s%s] %s tool radius%20.3f%s\n";
+static const char fmt_ttlw[] = "[%s%s] %s length wear%20.3f%s\n";
+static const char fmt_ttrw[] = "[%s%s] %s radius wear%20.3f%s\n";
+static const char fmt_ttpw[] = "[%s%s] %s pwm channel%16d\n";
 static const char fmt_Xra[] = "[%s%s] %s radius value%20.4f%s\n";
 static const char fmt_Xhi[] = "[%s%s] %s homing input%15d [input 1-N or 0 to disable homing this axis]\n";
+static const char fmt_Xhs[] = "[%s%s] %s squaring input%13d [second gantry switch 1-N or 0 for none]\n";
 static const char fmt_Xhd[] = "[%s%s] %s homing direction%11d [0=search-to-negative, 1=search-to-positive]\n";
 static const char fmt_Xsv[] = "[%s%s] %s search velocity%12.0f%s/min\n";
 static const char fmt_Xlv[] = "[%s%s] %s latch velocity%13.2f%s/min\n";
@@ -2511,6 +3052,18 @@ static void _print_axis_flt(nvObj_t *nv, const char *format)
     xio_writeline(cs.out_buf);
 }
 
+static void _print_linear_flt(nvObj_t *nv, const char *format)
+{
+    sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_flt, GET_UNITS(MODEL));
+    xio_writeline(cs.out_buf);
+}
+
+static void _print_axis_unitless_flt(nvObj_t *nv, const char *format)
+{
+    sprintf(cs.out_buf, format, nv->group, nv->token, nv->group, nv->value_flt);
+    xio_writeline(cs.out_buf);
+}
+
 static void _print_axis_coord_flt(nvObj_t *nv, const char *format)
 {
     char *units;
@@ -2553,9 +3106,14 @@ void cm_print_tm(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xtm);}
 void cm_print_tn(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xtn);}
 void cm_print_jm(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xjm);}
 void cm_print_jh(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xjh);}
+void cm_print_ac(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xac);}
+void cm_print_bl(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xbl);}
+void cm_print_sf(nvObj_t *nv) { _print_axis_unitless_flt(nv, fmt_Xsf);}
+void cm_print_sz(nvObj_t *nv) { _print_axis_unitless_flt(nv, fmt_Xsz);}
 void cm_print_ra(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xra);}
 
 void cm_print_hi(nvObj_t *nv) { _print_axis_ui8(nv, fmt_Xhi);}
+void cm_print_hs(nvObj_t *nv) { _print_axis_ui8(nv, fmt_Xhs);}
 void cm_print_hd(nvObj_t *nv) { _print_axis_ui8(nv, fmt_Xhd);}
 void cm_print_sv(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xsv);}
 void cm_print_lv(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xlv);}
@@ -2564,6 +3122,11 @@ void cm_print_zb(nvObj_t *nv) { _print_axis_flt(nv, fmt_Xzb);}
 
 void cm_print_cofs(nvObj_t *nv) { _print_axis_coord_flt(nv, fmt_cofs);}
 void cm_print_cpos(nvObj_t *nv) { _print_axis_coord_flt(nv, fmt_cpos);}
+void cm_print_ttk(nvObj_t *nv) { _print_axis_unitless_flt(nv, fmt_ttk);}
+void cm_print_ttrd(nvObj_t *nv) { _print_linear_flt(nv, fmt_ttrd);}
+void cm_print_ttlw(nvObj_t *nv) { _print_linear_flt(nv, fmt_ttlw);}
+void cm_print_ttrw(nvObj_t *nv) { _print_linear_flt(nv, fmt_ttrw);}
+void cm_print_ttpw(nvObj_t *nv) { _print_axis_ui8(nv, fmt_ttpw);}
 
 void cm_print_pos(nvObj_t *nv) { _print_pos(nv, fmt_pos, cm_get_units_mode(MODEL));}
 void cm_print_mpo(nvObj_t *nv) { _print_pos(nv, fmt_mpo, MILLIMETERS);}
@@ -54,6 +54,11 @@
 #define JERK_INPUT_MIN      (0.01)          // minimum allowable jerk setting in millions mm/min^3
 #define JERK_INPUT_MAX      (1000000)       // maximum allowable jerk setting in millions mm/min^3
 #define PROBES_STORED       3               // we store three probes for coordinate rotation computation
+#ifndef PROBE_GRID_MAX
+#define PROBE_GRID_MAX      16              // grid probing points along X and along Y
+#endif
+#define PROBE_TOUCHES_MAX   10              // slow touches averaged by a multi-touch probe
+#define PROBE_BACKOFF_MAX   50              // mm - the backoff is a short retract, not a move
 #define MAX_LINENUM         2000000000      // set 2 billion as max line number
 
 /*****************************************************************************
@@ -108,7 +113,8 @@ typedef enum {
     CYCLE_MACHINING,                // in normal machining cycle
     CYCLE_HOMING,                   // in homing cycle
     CYCLE_PROBE,                    // in probe cycle
-    CYCLE_JOG                       // in jogging cycle
+    CYCLE_JOG,                      // in jogging cycle
+    CYCLE_AUTOTUNE                  // in heater PID autotune cycle
 //  CYCLE_G81                       // illustration of canned cycles
 //  ...
 } cmCycleType;
@@ -186,12 +192,29 @@ typedef enum {                      // feed override state machine
     MFO_SYNC
 } cmOverrideState;
 
+typedef enum {                      // how feed overrides are applied - see mp_start_feed_override()
+    MFO_MODE_REPLAN = 0,            // replan the queue with a ramp to the new factor
+    MFO_MODE_TIME_SCALE             // scale time in the exec, replanning only to go faster than planned
+} cmOverrideMode;
+
+typedef enum {                      // what F means for moves that turn a rotary axis - see _calculate_vmaxes()
+    ROTARY_FEED_STANDARD = 0,       // XYZ length, or ABC degrees if no XYZ moves
+    ROTARY_FEED_TOOL_TIP            // tool tip length, taking each rotary degree as {xra} * pi/180 mm
+} cmRotaryFeedMode;
+
 typedef enum {                      // job kill state machine
     JOB_KILL_OFF = 0,
     JOB_KILL_REQUESTED,
     JOB_KILL_RUNNING    
 } cmJobKillState;
 
+typedef enum {                      // digital output control - see cm_set_output()
+    OUTPUT_SYNC_ON = 0,             // M62 - on a distance into the next move
+    OUTPUT_SYNC_OFF,                // M63 - off a distance into the next move
+    OUTPUT_ON,                      // M64 - on now
+    OUTPUT_OFF                      // M65 - off now
+} cmOutputControl;
+
 /*****************************************************************************
  * CANONICAL MACHINE STRUCTURES
  */
@@ -204,18 +227,26 @@ typedef struct cmAxis {
     float feedrate_max;                     // max velocity in mm/min or deg/min
     float jerk_max;                         // max jerk (Jm) in mm/min^3 divided by 1 million
     float jerk_high;                        // high speed deceleration jerk (Jh) in mm/min^3 divided by 1 million
+    float accel_max;                        // max acceleration in mm/min^2 divided by 1000, 0 for no limit
+    float backlash;                         // backlash in mm or deg taken up in the steps on reversal, 0 for none
     float travel_min;                       // min work envelope for soft limits
     float travel_max;                       // max work envelope for soft limits
     float radius;                           // radius in mm for rotary axis modes
+    float shaper_frequency;                 // input shaper frequency in Hz, 0 for none (X, Y and Z only)
+    float shaper_damping;                   // input shaper damping ratio
 
     // internal derived variables - computed during data entry and cached for computational efficiency
     float recip_velocity_max;
     float recip_feedrate_max;
+    float recip_jerk_max;
+    float recip_jerk_high;
+    float recip_accel_max;                  // 0 if the axis has no acceleration limit
     float max_junction_accel;
     float high_junction_accel;
 
     // homing settings
     uint8_t homing_input;                   // set 1-N for homing input. 0 will disable homing
+    uint8_t homing_input_2;                 // second input for a gantry-squared axis, 0 if the axis has one switch
     uint8_t homing_dir;                     // 0=search to negative, 1=search to positive
     float search_velocity;                  // homing search velocity
     float latch_velocity;                   // homing latch velocity
@@ -249,11 +280,65 @@ typedef struct cmArc {                      // planner and runtime variables for
     float   segment_linear_travel;          // linear motion per segment
     float   center_0;                       // center of circle at plane axis 0 (e.g. X for G17)
     float   center_1;                       // center of circle at plane axis 1 (e.g. Y for G17)
+    float   segment_sin;                    // sin and cos of segment_theta for the rotation recurrence
+    float   segment_cos;
+    float   radial_0;                       // current position relative to the center in plane axis 0
+    float   radial_1;                       // current position relative to the center in plane axis 1
+
+    float   extent_min[AXES];               // bounding box of the whole arc sweep - see _compute_arc_extents()
+    float   extent_max[AXES];
+    float   velocity_fraction_0;            // peak share of arc velocity seen by plane axis 0
+    float   velocity_fraction_1;            // peak share of arc velocity seen by plane axis 1
 
     GCodeState_t gm;                        // Gcode state struct is passed for each arc segment.
     magic_t magic_end;
 } cmArc_t;
 
+typedef enum {                              // drilling cycle steps - see _drill_step()
+    DRILL_CLEAR = 0,                        // rapid up to the R plane if starting below it
+    DRILL_HOLE,                             // rapid to the hole in XY
+    DRILL_R_PLANE,                          // rapid down to the R plane
+    DRILL_REENTER,                          // G83: rapid back down to just above the last peck
+    DRILL_FEED,                             // feed to the next peck depth or the bottom
+    DRILL_PECK_RETRACT,                     // G73: back off to break the chip, G83: rapid out to R
+    DRILL_DWELL,                            // G82: dwell at the bottom
+    DRILL_RETRACT                           // rapid out to the clearance plane
+} cmDrillStep;
+
+typedef struct cmDrill {                    // planner and runtime variables for drilling cycles
+    magic_t magic_start;
+    uint8_t run_state;                      // runtime state machine sequence
+    cmDrillStep step;                       // next move of the current hole
+    cmMotionMode cycle;                     // G73, G81, G82 or G83
+    cmRetractMode retract_mode;             // G98, G99
+
+    float R_word;                           // sticky words of the cycle, in mm as programmed
+    float Z_word;
+    float Q_word;                           // peck depth
+    float P_word;                           // dwell seconds
+
+    float hole[2];                          // XY of the current hole
+    float hole_step[2];                     // XY from one hole to the next for L repeats (G91)
+    uint8_t holes;                          // holes left to drill, including the current one
+    float r_plane;                          // Z of the R plane, bottom and clearance plane
+    float bottom;
+    float clear_z;
+    float depth;                            // Z reached by the last peck
+
+    GCodeState_t gm;                        // Gcode state struct is passed for each move
+    magic_t magic_end;
+} cmDrill_t;
+
+typedef struct cmTargetTransform {          // per-axis transform of Gcode input to the model target
+    bool valid;                             // cleared when the offsets change
+    uint16_t config_generation;             // cm_config_generation it was built for
+    uint32_t modes;                         // units, distance mode and absolute override it was built for
+    uint16_t axes;                          // axes that take input - not disabled
+    uint16_t absolute;                      // axes whose target is offset + input, the rest are position + input
+    float scale[AXES];                      // input units to mm, or to degrees for ABC in radius mode
+    float offset[AXES];                     // combined offset
+} cmTargetTransform_t;
+
 typedef struct cmMachine {                  // struct to manage canonical machine globals and state
     magic_t magic_start;                    // magic number to test memory integrity
 
@@ -262,9 +347,17 @@ typedef struct cmMachine {                  // struct to manage canonical machin
     // System group settings
     float junction_integration_time;        // how aggressively will the machine corner? 1.6 or so is about the upper limit
     float chordal_tolerance;                // arc chordal accuracy setting in mm
+    float arc_time_budget;                  // us cm_arc_callback() may spend queuing segments per pass
+    float planner_time_target;              // ms of planned motion to hold before pausing input, 0 = disabled
+    float merge_tolerance;                  // chordal tolerance for merging collinear G1s in mm, 0 = disabled
+    bool planner_runs;                      // true to plan accelerations as runs over several blocks
     float feedhold_z_lift;                  // mm to move Z axis on feedhold, or 0 to disable
     bool soft_limit_enable;                 // true to enable soft limit testing on Gcode inputs
     bool limit_enable;                      // true to enable limit switches (disabled is same as override)
+    bool homing_simultaneous;               // true to home all non-Z axes with independent switches together
+    cmOverrideMode mfo_mode;                // how feed overrides are applied
+    cmRotaryFeedMode rotary_feed_mode;      // how F applies to moves that turn a rotary axis
+    uint8_t shaper_type;                    // input shaper impulse train - see mpShaperType
 
     // Coordinate systems and offsets
     float coord_offset[COORDS+1][AXES];     // persistent coordinate offsets: absolute (G53) + G54,G55,G56,G57,G58,G59
@@ -292,6 +385,7 @@ typedef struct cmMachine {                  // struct to manage canonical machin
     cmFeedholdExit  hold_exit;              // hold: final state of hold on exit
     cmMotionProfile hold_profile;           // hold: motion profile to use for deceleration
     cmFeedholdState hold_state;             // hold: feedhold state machine
+    float hold_distance;                    // hdst: predicted stopping distance of the latest hold (mm)
 
     cmFlushState    queue_flush_state;      // queue flush state machine
     cmCycleState    cycle_start_state;      // used to manage cycle starts and restarts
@@ -299,10 +393,13 @@ typedef struct cmMachine {                  // struct to manage canonical machin
     cmOverrideState mfo_state;              // feed override state machine
 
     bool return_flags[AXES];                // flags for recording which axes moved - used in feedhold exit move
+    float work_offset[AXES];                // combined coord, tool and G92 offsets - see cm_update_work_offsets()
+    cmTargetTransform_t xform;              // input to model target transform - see cm_set_model_target()
 
     uint8_t limit_requested;                // set non-zero to request limit switch processing (value is input number)
     uint8_t shutdown_requested;             // set non-zero to request shutdown in support of external estop (value is input number)
     bool deferred_write_flag;               // G10 data has changed (e.g. offsets) - flag to persist them
+    uint32_t deferred_write_tools;          // tool table entries among them, bit 0 for tool 1
     
     bool safety_interlock_enable;           // true to enable safety interlock system
     bool request_interlock;                 // enter interlock
@@ -314,19 +411,28 @@ typedef struct cmMachine {                  // struct to manage canonical machin
 
     cmHomingState homing_state;             // home: homing cycle sub-state machine
     uint8_t homed[AXES];                    // individual axis homing flags
+    uint16_t soft_limit_axes;               // bitmask of axes soft limits are tested on - see cm_update_soft_limits()
+    float soft_limit_min[AXES];             // soft limit envelope of those axes in absolute machine coordinates
+    float soft_limit_max[AXES];
 
     bool probe_report_enable;                 // 0=disabled, 1=enabled
     cmProbeState probe_state[PROBES_STORED];  // probing state machine (simple)
     float probe_results[PROBES_STORED][AXES]; // probing results
+    uint8_t probe_touches;                    // slow touches averaged after the fast one, 0 for one touch - see cycle_probing.cpp
+    float probe_backoff;                      // mm to back off the contact before each slow touch
+    float probe_slow_feed;                    // slow touch feed rate in mm/min
 
     float rotation_matrix[3][3];            // three-by-three rotation matrix. We ignore UVW and ABC axes
     float rotation_z_offset;                // separately handle a z-offset to maintain consistent distance to bed
+    bool rotation_identity;                 // rotation_matrix is exactly identity - moves only take the z-offset
 
     float jogging_dest;                     // jogging destination as a relative move from current position
 
   /**** Model state structures ****/
     void *mp;                               // linked mpPlanner_t - use a void pointer to avoid circular header files
     cmArc_t arc;                            // arc parameters
+    cmDrill_t drill;                        // drilling cycle parameters
+    float spline_pq[2];                     // P Q of the last G5 - the I J of a G5 that leaves them out
     GCodeState_t *am;                       // active Gcode model is maintained by state management
     GCodeState_t  gm;                       // core gcode model state
     GCodeStateX_t gmx;                      // extended gcode model state
@@ -334,16 +440,71 @@ typedef struct cmMachine {                  // struct to manage canonical machin
     magic_t magic_end;
 } cmMachine_t;
 
+#define EXTRUDER_TOOLS 2                    // tools 1 and 2 extrude on A and B - see the E word in gcode_parser.cpp
+#define PRESSURE_ADVANCE_MAX 1.0            // seconds
+#define TOOL_RADIUS_MAX 500.0               // mm
+
+/*
+ * cmToolTable_t - tool offsets and geometry, persisted with the other settings
+ *
+ *  Each tool has an offset per axis {ttNx:}..{ttNc:}, a radius {ttNrd:}, a length wear {ttNlw:}
+ *  and a radius wear {ttNrw:}. G43 loads the tool's offsets plus its length wear (on Z) into
+ *  cm->tool_offset in one pass and updates the work offsets - nothing waits on the planner,
+ *  so back to back M6/G43 sequences don't stall. The radius and radius wear are kept for the
+ *  host; g2core does no cutter compensation.
+ *
+ *  {ttNpw:} maps the tool to the PWM channel its spindle or laser runs on. Each channel has
+ *  its own speed ranges and phase curves ({p1...}, {p2...}), so M6 switches between a spindle
+ *  and a laser without the host reloading the PWM settings - see spindle_set_pwm_channel().
+ */
 typedef struct cmToolTable {                // struct to keep a global tool table
     float tt_offset[TOOLS+1][AXES];         // persistent tool table offsets
+    float radius[TOOLS+1];                  // tool radius
+    float length_wear[TOOLS+1];             // added to the Z offset by G43
+    float radius_wear[TOOLS+1];             // added to the radius by whatever compensates for it
+    uint8_t pwm_channel[TOOLS+1];           // PWM channel (1-N) the tool's spindle or laser runs on
+    float pressure_advance[EXTRUDER_TOOLS+1];   // extruder lead in seconds of its velocity - see _exec_pressure_advance()
 } cmToolTable_t;
 
+typedef struct cmProbeGrid {                // surface grid for grid probing (cycle_probing.cpp)
+    // settings - machine coordinates in mm
+    float x_min;                            // first column
+    float x_max;                            // columns run every pitch up to here
+    float y_min;                            // first row
+    float y_max;                            // rows run every pitch up to here
+    float pitch;                            // spacing between points in X and Y
+    float z_clear;                          // Z travel height between points
+    float z_probe;                          // Z probe target - a point fails if there is no contact above this
+    float feed_rate;                        // probe feed rate in mm/min
+
+    // results
+    cmProbeState state;                     // PROBE_WAITING while running, then SUCCEEDED or FAILED
+    uint8_t nx;                             // columns
+    uint8_t ny;                             // rows
+    uint16_t points;                        // points probed so far
+    float z[PROBE_GRID_MAX][PROBE_GRID_MAX];// contact Z as [row][column]
+} cmProbeGrid_t;
+
+typedef struct cmToolSetter {               // tool setter for G37 tool measurement (cycle_probing.cpp)
+    float x;                                // setter position - machine coordinates in mm
+    float y;
+    float z_clear;                          // Z travel height to and from the setter
+    float z_probe;                          // Z probe target - the tool fails if there is no contact above this
+    float feed_rate;                        // fast touch feed rate in mm/min - the slow touches use {prbs:}
+    float z_reference;                      // contact Z of a zero length tool
+} cmToolSetter_t;
+
 /**** Externs - See canonical_machine.cpp for allocation ****/
 
 extern cmMachine_t *cm;                     // pointer to active canonical machine
 extern cmMachine_t cm1;                     // canonical machine primary machine
 extern cmMachine_t cm2;                     // canonical machine secondary machine
 extern cmToolTable_t tt;
+extern cmProbeGrid_t probe_grid;            // allocated in cycle_probing.cpp
+extern cmToolSetter_t tool_setter;          // allocated in cycle_probing.cpp
+extern uint16_t cm_config_generation;       // changes whenever cm configuration is written - see _enter_p2()
+
+inline void cm_config_changed() { cm_config_generation++; }
 
 /*****************************************************************************
  * FUNCTION PROTOTYPES
@@ -388,6 +549,7 @@ stat_t cm_check_linenum();
 float cm_get_combined_offset(const uint8_t axis);
 float cm_get_display_offset(const GCodeState_t *gcode_state, const uint8_t axis);
 void cm_set_display_offsets(GCodeState_t *gcode_state);
+void cm_update_work_offsets(void);
 float cm_get_display_position(const GCodeState_t *gcode_state, const uint8_t axis);
 float cm_get_absolute_position(const GCodeState_t *gcode_state, const uint8_t axis);
 
@@ -398,6 +560,7 @@ void cm_set_model_target(const float target[], const bool flag[]);
 bool cm_get_soft_limits(void);
 void cm_set_soft_limits(bool enable);
 
+void cm_update_soft_limits(void);
 stat_t cm_test_soft_limits(const float target[]);
 
 /*--- Canonical machining functions (loosely) defined by NIST [organized by NIST Gcode doc] ---*/
@@ -406,6 +569,7 @@ stat_t cm_test_soft_limits(const float target[]);
 void canonical_machine_inits(void);
 void canonical_machine_init(cmMachine_t *_cm, void *_mp);
 void canonical_machine_reset_rotation(cmMachine_t *_cm);        // NOT in NIST
+void canonical_machine_update_rotation(cmMachine_t *_cm);       // NOT in NIST
 void canonical_machine_reset(cmMachine_t *_cm);
 void canonical_machine_init_assertions(cmMachine_t *_cm);
 stat_t canonical_machine_test_assertions(cmMachine_t *_cm);
@@ -444,9 +608,11 @@ stat_t cm_goto_g30_position(const float target[], const bool flags[]);      // G
 stat_t cm_set_feed_rate(const float feed_rate);                             // F parameter
 stat_t cm_set_feed_rate_mode(const uint8_t mode);                           // G93, G94, (G95 unimplemented)
 stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode);  // G61, G61.1, G64
+stat_t cm_set_path_tolerance(GCodeState_t *gcode_state, const float tolerance); // G64 P
 
 // Machining Functions (4.3.6)
 stat_t cm_straight_feed(const float *target, const bool *flags, const uint8_t motion_profile); //G1
+stat_t cm_raster_feed(const float *target, const bool *flags, struct mpRasterLine *line);      // G1 scanline
 stat_t cm_dwell(const float seconds);                                       // G4, P parameter
 
 stat_t cm_arc_feed(const float target[], const bool target_f[],             // G2/G3 - target endpoint
@@ -456,6 +622,12 @@ stat_t cm_arc_feed(const float target[], const bool target_f[],             // G
                    const bool modal_g1_f,                                   // modal group flag for motion group
                    const cmMotionMode motion_mode);                         // defined motion mode
 
+stat_t cm_spline_feed(const float target[], const bool target_f[],          // G5/G5.1 - target endpoint
+                      const float offset[], const bool offset_f[],          // IJ first control point offset
+                      const float P_word, const bool P_word_f,              // PQ second control point offset
+                      const float Q_word, const bool Q_word_f,
+                      const cmMotionMode motion_mode);                      // defined motion mode
+
 // Spindle Functions (4.3.7)
 // see spindle.h for spindle functions - which would go right here
 
@@ -467,6 +639,9 @@ stat_t cm_change_tool(const uint8_t tool);                      // M6
 // see coolant.h for coolant functions - which would go right here
 
 void cm_message(const char *message);                           // msg to console (e.g. Gcode comments)
+stat_t cm_set_output(const uint8_t control,                     // M62, M63, M64, M65
+                     const float P_word, const bool P_flag,
+                     const float Q_word, const bool Q_flag);
 
 void cm_reset_overrides(void);
 stat_t cm_m48_enable(uint8_t enable);                           // M48, M49
@@ -506,6 +681,8 @@ bool cm_has_hold(void);                                         // has hold in p
 stat_t cm_homing_cycle_start(const float axes[], const bool flags[]);        // G28.2
 stat_t cm_homing_cycle_start_no_set(const float axes[], const bool flags[]); // G28.4
 stat_t cm_homing_cycle_callback(void);                          // G28.2/.4 main loop callback
+bool cm_homing_input_hit(const uint8_t input_num_ext);          // homing switch edge from GPIO (ISR)
+bool cm_homing_motor_stalled(const uint8_t motor);              // sensorless homing stall from a driver (ISR)
 
 // Probe cycles
 stat_t cm_straight_probe(float target[], bool flags[],          // G38.x
@@ -513,10 +690,38 @@ stat_t cm_straight_probe(float target[], bool flags[],          // G38.x
 stat_t cm_probing_cycle_callback(void);                         // G38.x main loop callback
 stat_t cm_get_prbr(nvObj_t *nv);                                // enable/disable probe report
 stat_t cm_set_prbr(nvObj_t *nv);
+stat_t cm_probe_grid_start(void);                               // probe the grid in probe_grid
+stat_t cm_probe_tram_start(const float points[PROBES_STORED][2], float z_clear, float z_probe, float feed_rate); // G29
+stat_t cm_tram_from_probes(void);                               // set the rotation matrix from the stored probes
+stat_t cm_run_prgs(nvObj_t *nv);                                // start grid probing
+stat_t cm_get_prgn(nvObj_t *nv);                                // get grid points probed
+stat_t cm_get_prgd(nvObj_t *nv);                                // send the grid results
+stat_t cm_measure_tool(const uint8_t H_word, const bool H_flag);// G37
+stat_t cm_get_tls(nvObj_t *nv);                                 // get a tool setter setting
+stat_t cm_set_tls(nvObj_t *nv);                                 // set a tool setter setting
+
+// Drilling cycles (cycle_drilling.cpp)
+void cm_drill_init(cmMachine_t *_cm);
+void cm_abort_drill(cmMachine_t *_cm);
+stat_t cm_drill_callback(cmMachine_t *_cm);                     // G73, G81-G83 main loop callback
+stat_t cm_set_retract_mode(const uint8_t mode);                 // G98, G99
+stat_t cm_drill_cycle(const float target[], const bool target_f[], // G73, G81, G82, G83
+                      const float R_word, const bool R_word_f,
+                      const float P_word, const bool P_word_f,
+                      const float Q_word, const bool Q_word_f,
+                      const uint8_t L_word, const bool L_word_f,
+                      const bool modal_g1_f,
+                      const cmMotionMode motion_mode);
+
+// Spindle synchronized motion (cycle_threading.cpp)
+stat_t cm_thread_feed(const float target[], const bool target_f[], // G33
+                      const float K_word, const bool K_word_f);
 
 // Jogging cycle (cycle_jogging.cpp)
 stat_t cm_jogging_cycle_callback(void);                         // jogging cycle main loop
 stat_t cm_jogging_cycle_start(uint8_t axis);                    // {"jogx":-100.3}
+stat_t cm_velocity_jog(uint8_t axis, float velocity);           // {"jgv":{"x":1200,"y":-300}}
+bool cm_velocity_jog_is_running(void);                          // true while a velocity jog owns the machine
 float cm_get_jogging_dest(void);                                // get jogging destination
 
 // Alarm management (alarm.cpp)
@@ -547,6 +752,7 @@ stat_t cm_get_macs(nvObj_t *nv);        // get raw machine state as value and st
 stat_t cm_get_cycs(nvObj_t *nv);        // get raw cycle state
 stat_t cm_get_mots(nvObj_t *nv);        // get raw motion state
 stat_t cm_get_hold(nvObj_t *nv);        // get raw hold state
+stat_t cm_get_hdst(nvObj_t *nv);        // get predicted hold stopping distance
 
 stat_t cm_get_home(nvObj_t *nv);        // get machine homing state
 stat_t cm_set_home(nvObj_t *nv);        // set machine homing state
@@ -554,6 +760,7 @@ stat_t cm_get_hom(nvObj_t *nv);         // get homing state for axis
 stat_t cm_get_prob(nvObj_t *nv);        // get probe state
 stat_t cm_get_prb (nvObj_t *nv);        // get probe result for axis
 stat_t cm_run_jog(nvObj_t *nv);         // start jogging cycle
+stat_t cm_run_jgv(nvObj_t *nv);         // start or steer a velocity jog
 
 stat_t cm_get_unit(nvObj_t *nv);        // get unit mode
 stat_t cm_get_coor(nvObj_t *nv);        // get coordinate system in effect
@@ -588,6 +795,16 @@ stat_t cm_get_tof(nvObj_t *nv);         // get tool offset
 stat_t cm_set_tof(nvObj_t *nv);         // set tool offset
 stat_t cm_get_tt(nvObj_t *nv);          // get tool table value
 stat_t cm_set_tt(nvObj_t *nv);          // set tool table value
+stat_t cm_get_ttk(nvObj_t *nv);         // get tool pressure advance
+stat_t cm_set_ttk(nvObj_t *nv);         // set tool pressure advance
+stat_t cm_get_ttrd(nvObj_t *nv);        // get tool radius
+stat_t cm_set_ttrd(nvObj_t *nv);        // set tool radius
+stat_t cm_get_ttlw(nvObj_t *nv);        // get tool length wear
+stat_t cm_set_ttlw(nvObj_t *nv);        // set tool length wear
+stat_t cm_get_ttrw(nvObj_t *nv);        // get tool radius wear
+stat_t cm_set_ttrw(nvObj_t *nv);        // set tool radius wear
+stat_t cm_get_ttpw(nvObj_t *nv);        // get tool PWM channel
+stat_t cm_set_ttpw(nvObj_t *nv);        // set tool PWM channel
 
 stat_t cm_get_am(nvObj_t *nv);          // get axis mode
 stat_t cm_set_am(nvObj_t *nv);          // set axis mode
@@ -610,9 +827,19 @@ stat_t cm_get_jm(nvObj_t *nv);          // get jerk max with 1,000,000 correctio
 stat_t cm_set_jm(nvObj_t *nv);          // set jerk max with 1,000,000 correction
 stat_t cm_get_jh(nvObj_t *nv);          // get jerk high with 1,000,000 correction
 stat_t cm_set_jh(nvObj_t *nv);          // set jerk high with 1,000,000 correction
+stat_t cm_get_ac(nvObj_t *nv);          // get acceleration max with 1,000 correction
+stat_t cm_set_ac(nvObj_t *nv);          // set acceleration max and reciprocal
+stat_t cm_get_bl(nvObj_t *nv);          // get backlash
+stat_t cm_set_bl(nvObj_t *nv);          // set backlash
+stat_t cm_get_sf(nvObj_t *nv);          // get input shaper frequency
+stat_t cm_set_sf(nvObj_t *nv);          // set input shaper frequency
+stat_t cm_get_sz(nvObj_t *nv);          // get input shaper damping ratio
+stat_t cm_set_sz(nvObj_t *nv);          // set input shaper damping ratio
 
 stat_t cm_get_hi(nvObj_t *nv);          // get homing input
 stat_t cm_set_hi(nvObj_t *nv);          // set homing input
+stat_t cm_get_hs(nvObj_t *nv);          // get gantry squaring homing input
+stat_t cm_set_hs(nvObj_t *nv);          // set gantry squaring homing input
 stat_t cm_get_hd(nvObj_t *nv);          // get homing direction
 stat_t cm_set_hd(nvObj_t *nv);          // set homing direction
 stat_t cm_get_sv(nvObj_t *nv);          // get homing search velocity
@@ -628,10 +855,30 @@ stat_t cm_get_jt(nvObj_t *nv);          // get junction integration time constan
 stat_t cm_set_jt(nvObj_t *nv);          // set junction integration time constant
 stat_t cm_get_ct(nvObj_t *nv);          // get chordal tolerance
 stat_t cm_set_ct(nvObj_t *nv);          // set chordal tolerance
+stat_t cm_get_arcb(nvObj_t *nv);        // get arc callback time budget
+stat_t cm_set_arcb(nvObj_t *nv);        // set arc callback time budget
+stat_t cm_get_qt(nvObj_t *nv);          // get planner time target
+stat_t cm_set_qt(nvObj_t *nv);          // set planner time target
+stat_t cm_get_mgt(nvObj_t *nv);         // get segment merge tolerance
+stat_t cm_set_mgt(nvObj_t *nv);         // set segment merge tolerance
+stat_t cm_get_plr(nvObj_t *nv);         // get planner acceleration runs enable
+stat_t cm_set_plr(nvObj_t *nv);         // set planner acceleration runs enable
+stat_t cm_get_seg(nvObj_t *nv);         // get minimum segment time
+stat_t cm_set_seg(nvObj_t *nv);         // set minimum segment time
+stat_t cm_get_segx(nvObj_t *nv);        // get worst case exec + prep time
+stat_t cm_set_segx(nvObj_t *nv);        // clear worst case exec + prep time
 stat_t cm_get_zl(nvObj_t *nv);          // get feedhold Z lift
 stat_t cm_set_zl(nvObj_t *nv);          // set feedhold Z lift
+stat_t cm_get_prbn(nvObj_t *nv);        // get probe slow touches
+stat_t cm_set_prbn(nvObj_t *nv);        // set probe slow touches
+stat_t cm_get_prbk(nvObj_t *nv);        // get probe backoff distance
+stat_t cm_set_prbk(nvObj_t *nv);        // set probe backoff distance
+stat_t cm_get_prbs(nvObj_t *nv);        // get probe slow touch feed rate
+stat_t cm_set_prbs(nvObj_t *nv);        // set probe slow touch feed rate
 stat_t cm_get_sl(nvObj_t *nv);          // get soft limit enable
 stat_t cm_set_sl(nvObj_t *nv);          // set soft limit enable
+stat_t cm_get_hsm(nvObj_t *nv);         // get simultaneous homing enable
+stat_t cm_set_hsm(nvObj_t *nv);         // set simultaneous homing enable
 stat_t cm_get_lim(nvObj_t *nv);         // get hard limit enable
 stat_t cm_set_lim(nvObj_t *nv);         // set hard limit enable
 stat_t cm_get_saf(nvObj_t *nv);         // get safety interlock enable
@@ -643,6 +890,12 @@ stat_t cm_get_froe(nvObj_t *nv);        // get feedrate override enable
 stat_t cm_set_froe(nvObj_t *nv);        // set feedrate override enable
 stat_t cm_get_fro(nvObj_t *nv);         // get feedrate override factor
 stat_t cm_set_fro(nvObj_t *nv);         // set feedrate override factor
+stat_t cm_get_frm(nvObj_t *nv);         // get feedrate override mode
+stat_t cm_set_frm(nvObj_t *nv);         // set feedrate override mode
+stat_t cm_get_rfm(nvObj_t *nv);         // get rotary feed mode
+stat_t cm_set_rfm(nvObj_t *nv);         // set rotary feed mode
+stat_t cm_get_shp(nvObj_t *nv);         // get input shaper type
+stat_t cm_set_shp(nvObj_t *nv);         // set input shaper type
 
 stat_t cm_get_troe(nvObj_t *nv);        // get traverse override enable
 stat_t cm_set_troe(nvObj_t *nv);        // set traverse override enable
@@ -678,6 +931,7 @@ stat_t cm_set_gdi(nvObj_t *nv);         // set gcode default distance mode
     void cm_print_cycs(nvObj_t *nv);
     void cm_print_mots(nvObj_t *nv);
     void cm_print_hold(nvObj_t *nv);
+    void cm_print_hdst(nvObj_t *nv);
     void cm_print_home(nvObj_t *nv);
     void cm_print_hom(nvObj_t *nv);
     void cm_print_unit(nvObj_t *nv);
@@ -705,14 +959,27 @@ stat_t cm_set_gdi(nvObj_t *nv);         // set gcode default distance mode
 
     void cm_print_jt(nvObj_t *nv);          // global CM settings
     void cm_print_ct(nvObj_t *nv);
+    void cm_print_arcb(nvObj_t *nv);
+    void cm_print_qt(nvObj_t *nv);
+    void cm_print_mgt(nvObj_t *nv);
+    void cm_print_plr(nvObj_t *nv);
+    void cm_print_seg(nvObj_t *nv);
+    void cm_print_segx(nvObj_t *nv);
     void cm_print_zl(nvObj_t *nv);
+    void cm_print_prbn(nvObj_t *nv);
+    void cm_print_prbk(nvObj_t *nv);
+    void cm_print_prbs(nvObj_t *nv);
     void cm_print_sl(nvObj_t *nv);
+    void cm_print_hsm(nvObj_t *nv);
     void cm_print_lim(nvObj_t *nv);
     void cm_print_saf(nvObj_t *nv);
 
     void cm_print_m48(nvObj_t *nv);
     void cm_print_froe(nvObj_t *nv);
     void cm_print_fro(nvObj_t *nv);
+    void cm_print_frm(nvObj_t *nv);
+    void cm_print_rfm(nvObj_t *nv);
+    void cm_print_shp(nvObj_t *nv);
     void cm_print_troe(nvObj_t *nv);
     void cm_print_tro(nvObj_t *nv);
 
@@ -726,15 +993,25 @@ stat_t cm_set_gdi(nvObj_t *nv);         // set gcode default distance mode
     void cm_print_tn(nvObj_t *nv);
     void cm_print_jm(nvObj_t *nv);
     void cm_print_jh(nvObj_t *nv);
+    void cm_print_ac(nvObj_t *nv);
+    void cm_print_bl(nvObj_t *nv);
+    void cm_print_sf(nvObj_t *nv);
+    void cm_print_sz(nvObj_t *nv);
     void cm_print_ra(nvObj_t *nv);
 
     void cm_print_hi(nvObj_t *nv);
+    void cm_print_hs(nvObj_t *nv);
     void cm_print_hd(nvObj_t *nv);
     void cm_print_sv(nvObj_t *nv);
     void cm_print_lv(nvObj_t *nv);
     void cm_print_lb(nvObj_t *nv);
     void cm_print_zb(nvObj_t *nv);
     void cm_print_cofs(nvObj_t *nv);
+    void cm_print_ttk(nvObj_t *nv);
+    void cm_print_ttrd(nvObj_t *nv);
+    void cm_print_ttlw(nvObj_t *nv);
+    void cm_print_ttrw(nvObj_t *nv);
+    void cm_print_ttpw(nvObj_t *nv);
     void cm_print_cpos(nvObj_t *nv);
 
 #else // __TEXT_MODE
@@ -747,6 +1024,7 @@ stat_t cm_set_gdi(nvObj_t *nv);         // set gcode default distance mode
     #define cm_print_cycs tx_print_stub
     #define cm_print_mots tx_print_stub
     #define cm_print_hold tx_print_stub
+    #define cm_print_hdst tx_print_stub
     #define cm_print_home tx_print_stub
     #define cm_print_hom tx_print_stub
     #define cm_print_unit tx_print_stub
@@ -773,14 +1051,27 @@ stat_t cm_set_gdi(nvObj_t *nv);         // set gcode default distance mode
 
     #define cm_print_jt tx_print_stub       // global CM settings
     #define cm_print_ct tx_print_stub
+    #define cm_print_arcb tx_print_stub
+    #define cm_print_qt tx_print_stub
+    #define cm_print_mgt tx_print_stub
+    #define cm_print_plr tx_print_stub
+    #define cm_print_seg tx_print_stub
+    #define cm_print_segx tx_print_stub
     #define cm_print_zl tx_print_stub
+    #define cm_print_prbn tx_print_stub
+    #define cm_print_prbk tx_print_stub
+    #define cm_print_prbs tx_print_stub
     #define cm_print_sl tx_print_stub
+    #define cm_print_hsm tx_print_stub
     #define cm_print_lim tx_print_stub
     #define cm_print_saf tx_print_stub
 
     #define cm_print_m48 tx_print_stub
     #define cm_print_froe tx_print_stub
     #define cm_print_fro tx_print_stub
+    #define cm_print_frm tx_print_stub
+    #define cm_print_rfm tx_print_stub
+    #define cm_print_shp tx_print_stub
     #define cm_print_troe tx_print_stub
     #define cm_print_tro tx_print_stub
     #define cm_print_tram tx_print_stub
@@ -795,15 +1086,25 @@ stat_t cm_set_gdi(nvObj_t *nv);         // set gcode default distance mode
     #define cm_print_tn tx_print_stub
     #define cm_print_jm tx_print_stub
     #define cm_print_jh tx_print_stub
+    #define cm_print_ac tx_print_stub
+    #define cm_print_bl tx_print_stub
+    #define cm_print_sf tx_print_stub
+    #define cm_print_sz tx_print_stub
     #define cm_print_ra tx_print_stub
 
     #define cm_print_hi tx_print_stub
+    #define cm_print_hs tx_print_stub
     #define cm_print_hd tx_print_stub
     #define cm_print_sv tx_print_stub
     #define cm_print_lv tx_print_stub
     #define cm_print_lb tx_print_stub
     #define cm_print_zb tx_print_stub
     #define cm_print_cofs tx_print_stub
+    #define cm_print_ttk tx_print_stub
+    #define cm_print_ttrd tx_print_stub
+    #define cm_print_ttlw tx_print_stub
+    #define cm_print_ttrw tx_print_stub
+    #define cm_print_ttpw tx_print_stub
     #define cm_print_cpos tx_print_stub
 
     #define cm_print_pdt txt_print_stub
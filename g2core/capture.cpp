@@ -0,0 +1,150 @@
+/*
+ * capture.cpp - session capture for replay in the simulator
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "controller.h"
+#include "capture.h"
+#include "hardware.h"
+#include "util.h"
+#include "xio.h"
+
+#ifdef __SESSION_CAPTURE
+
+capCapture_t cap;
+
+/*
+ * cap_line_read() - record a line the controller has read - see CAPTURE_LINE()
+ */
+
+void cap_line_read(const char *line)
+{
+    uint16_t len = strlen(line);
+    if ((cap.used + sizeof(capRecordHeader_t) + len) > CAPTURE_BUFFER_SIZE) {
+        cap.enabled = false;
+        cap.overflow = true;
+        return;
+    }
+    capRecordHeader_t h = { SysTickTimer_getValue() - cap.start_ms, len };
+    memcpy(&cap.buf[cap.used], &h, sizeof(h));
+    memcpy(&cap.buf[cap.used + sizeof(h)], line, len);
+    cap.last = cap.used;
+    cap.used += sizeof(h) + len;
+    cap.lines++;
+}
+
+/*
+ * capture_callback() - send one capture line per pass through the main loop
+ *
+ *  The line is written as a JSON string. Long lines are written in pieces, so an escaped
+ *  line can be longer than the output buffer.
+ */
+
+stat_t capture_callback()
+{
+    if (!cap.dump_pending) {
+        return (STAT_NOOP);
+    }
+    if (cap.dump_offset >= cap.used) {
+        cap.dump_pending = false;
+        return (STAT_OK);
+    }
+    capRecordHeader_t h;
+    memcpy(&h, &cap.buf[cap.dump_offset], sizeof(h));
+    const char *text = (const char *)&cap.buf[cap.dump_offset + sizeof(h)];
+    cap.dump_offset += sizeof(h) + h.len;
+
+    char *b = cs.out_buf;
+    b += sprintf(b, "{\"cap\":[%lu,\"", (unsigned long)h.ms);
+    for (uint16_t i = 0; i < h.len; i++) {
+        if ((b - cs.out_buf) > (OUTPUT_BUFFER_LEN - 8)) {
+            xio_write(cs.out_buf, b - cs.out_buf);
+            b = cs.out_buf;
+        }
+        char c = text[i];
+        if ((c == '"') || (c == '\\')) {
+            *b++ = '\\';
+            *b++ = c;
+        } else if ((uint8_t)c < 0x20) {
+            b += sprintf(b, "\\u%04x", c);
+        } else {
+            *b++ = c;
+        }
+    }
+    sprintf(b, "\"]}\n");
+    xio_writeline(cs.out_buf);
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * cap_get() - return the number of lines held, negative if the capture was cut short
+ * cap_set() - 0 stops recording, 1 clears and starts it, 2 stops it and dumps the capture
+ *
+ *  Stopping drops the last line, which is the one asking to stop - unless recording had
+ *  already stopped.
+ */
+
+stat_t cap_get(nvObj_t *nv)
+{
+    return (get_integer(nv, cap.overflow ? -(int32_t)cap.lines : (int32_t)cap.lines));
+}
+
+stat_t cap_set(nvObj_t *nv)
+{
+    switch (nv->value_int) {
+        case 0:
+        case 2: {
+            if (cap.enabled && (cap.lines > 0)) {
+                cap.used = cap.last;
+                cap.lines--;
+            }
+            cap.enabled = false;
+            if (nv->value_int == 2) {
+                cap.dump_offset = 0;
+                cap.dump_pending = true;
+            }
+            break;
+        }
+        case 1: {
+            cap.enabled = false;
+            cap.dump_pending = false;
+            cap.used = 0;
+            cap.lines = 0;
+            cap.overflow = false;
+            cap.start_ms = SysTickTimer_getValue();
+            cap.enabled = true;
+            break;
+        }
+        default: { return (STAT_INPUT_VALUE_RANGE_ERROR); }
+    }
+    return (cap_get(nv));
+}
+
+#endif  // __SESSION_CAPTURE
@@ -0,0 +1,95 @@
+/*
+ * capture.h - session capture for replay in the simulator
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * SESSION CAPTURE
+ *
+ *  Records each line the controller reads - from any device, controls included - with the
+ *  time it was read, so a session from the field can be played back in the simulator with
+ *  its original timing (board/sim, -r):
+ *
+ *    {cap:n}   returns the number of lines held
+ *    {cap:0}   stops recording
+ *    {cap:1}   clears the capture and starts recording
+ *    {cap:2}   stops recording and dumps the capture, oldest line first, one line per record:
+ *              {"cap":[ms,"line"]} - ms after recording started, the line as a JSON string
+ *
+ *  The line that stops recording isn't kept. Save the dump lines (anything else in the log is ignored) and run the simulator on them
+ *  with -r. Start recording from a known state - just after a reset, or with the settings
+ *  the machine was given sent first - as the simulator starts from its own defaults.
+ *
+ *  Lines are held in a CAPTURE_BUFFER_SIZE byte RAM buffer, 6 bytes plus the text each.
+ *  Recording stops when it is full, and {cap:n} returns the count as a negative number to
+ *  say the capture was cut short. The time is the SysTick time the line was taken from the
+ *  RX buffer, so it's the time the host's line arrived unless the RX buffer was full. Frames
+ *  on the binary motion channel are not recorded.
+ *
+ *  Build with __SESSION_CAPTURE (g2core.h) to compile it in.
+ */
+
+#ifndef CAPTURE_H_ONCE
+#define CAPTURE_H_ONCE
+
+#ifdef __SESSION_CAPTURE
+
+#include "config.h"  // needed for nvObj_t definition
+
+#ifndef CAPTURE_BUFFER_SIZE
+#define CAPTURE_BUFFER_SIZE 8192        // bytes of RAM for the capture
+#endif
+
+typedef struct capRecordHeader {        // followed by len bytes of text, no NUL
+    uint32_t ms;                        // SysTick ms after recording started
+    uint16_t len;
+} __attribute__((packed)) capRecordHeader_t;
+
+typedef struct capCapture {
+    uint8_t buf[CAPTURE_BUFFER_SIZE];
+    uint16_t used;                      // bytes of buf holding records
+    uint16_t last;                      // offset of the last record
+    uint16_t lines;                     // records held
+    bool enabled;                       // record lines
+    bool overflow;                      // a line didn't fit - recording stopped
+    uint32_t start_ms;                  // SysTick time recording started
+    bool dump_pending;                  // capture_callback() has lines to send
+    uint16_t dump_offset;               // next record to dump
+} capCapture_t;
+
+extern capCapture_t cap;
+
+void cap_line_read(const char *line);
+
+#define CAPTURE_LINE(line) { if (cap.enabled && ((line) != nullptr)) { cap_line_read(line); } }
+
+stat_t capture_callback(void);
+stat_t cap_get(nvObj_t *nv);
+stat_t cap_set(nvObj_t *nv);
+
+#else
+
+#define CAPTURE_LINE(line)
+
+#endif  // __SESSION_CAPTURE
+
+#endif  // End of include guard: CAPTURE_H_ONCE
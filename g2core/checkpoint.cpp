@@ -0,0 +1,349 @@
+/*
+ * checkpoint.cpp - job checkpoints for resuming after a power loss
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "checkpoint.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "spindle.h"
+#include "coolant.h"
+#include "spool.h"
+#include "text_parser.h"
+#include "util.h"
+
+#include <cstddef>
+
+/***********************************************************************************
+ **** STRUCTURE ALLOCATIONS ********************************************************
+ ***********************************************************************************/
+
+ckSingleton_t ck;
+
+/***********************************************************************************
+ **** GENERIC STATIC FUNCTIONS AND VARIABLES ***************************************
+ ***********************************************************************************/
+
+static uint32_t _record_crc(const ckRecord_t *r)
+{
+    return (crc32((const uint8_t *)r, offsetof(ckRecord_t, crc)));
+}
+
+static bool _is_valid(const ckRecord_t *r)
+{
+    return ((r->magic == CHECKPOINT_MAGIC) && (r->crc == _record_crc(r)));
+}
+
+/*
+ * _ck_load()  - find the newest stored checkpoint
+ * _ck_ready() - true if a checkpoint can be stored now
+ * _ck_store() - store ck.record
+ */
+
+#if CHECKPOINT_ENABLED == true
+
+#if !(defined(__SAM3X8E__) || defined(__SAM3X8C__))
+#error CHECKPOINT_ENABLED is only supported on SAM3X
+#endif
+#if PERSISTENCE_ENABLED != true
+#error CHECKPOINT_ENABLED needs PERSISTENCE_ENABLED - the ring sits below its areas
+#endif
+
+#define CHECKPOINT_ADDR (IFLASH1_ADDR + IFLASH1_SIZE - (2 * 64 * 256) - CHECKPOINT_RESERVED)
+
+static_assert(CHECKPOINT_PAGE_SIZE == IFLASH1_PAGE_SIZE, "CHECKPOINT_PAGE_SIZE must match the flash page size");
+static_assert(sizeof(ckRecord_t) <= CHECKPOINT_PAGE_SIZE, "ckRecord_t must fit in a flash page");
+
+static const ckRecord_t *_page(uint16_t page)
+{
+    return ((const ckRecord_t *)(CHECKPOINT_ADDR + (page * CHECKPOINT_PAGE_SIZE)));
+}
+
+static void _ck_load()
+{
+    int16_t newest = -1;
+    for (uint16_t page = 0; page < CHECKPOINT_PAGES; page++) {
+        const ckRecord_t *r = _page(page);
+        if (_is_valid(r) && ((newest < 0) || ((int32_t)(r->sequence - _page(newest)->sequence) > 0))) {
+            newest = page;
+        }
+    }
+    if (newest >= 0) {
+        ck.record = *_page(newest);
+        ck.page = (newest + 1) % CHECKPOINT_PAGES;
+    }
+}
+
+static bool _ck_ready()
+{
+    return ((EFC1->EEFC_FSR & EEFC_FSR_FRDY) != 0);         // persistence or the spool may be programming
+}
+
+static void _ck_store()
+{
+    uint32_t addr = (uint32_t)_page(ck.page);
+    volatile uint32_t *latch = (volatile uint32_t *)addr;
+    const uint32_t *words = (const uint32_t *)&ck.record;
+    for (uint8_t i=0; i < (CHECKPOINT_PAGE_SIZE / 4); i++) {
+        latch[i] = (i < (sizeof(ckRecord_t) / 4)) ? words[i] : 0xFFFFFFFF;
+    }
+    __DSB();
+    EFC1->EEFC_FCR = EEFC_FCR_FKEY(0x5A) |
+                     EEFC_FCR_FARG((addr - IFLASH1_ADDR) / CHECKPOINT_PAGE_SIZE) |
+                     EEFC_FCR_FCMD(0x03);                   // EWP - not waited for
+    ck.page = (ck.page + 1) % CHECKPOINT_PAGES;
+}
+
+#else // CHECKPOINT_ENABLED
+
+static void _ck_load() {}
+static bool _ck_ready() { return (true); }
+static void _ck_store() {}                                  // ck.record is the store
+
+#endif // CHECKPOINT_ENABLED
+
+/*
+ * _ck_take_mark() - copy the latest mark, again if the exec interrupt wrote it meanwhile
+ */
+
+static void _ck_take_mark(ckMark_t *mark)
+{
+    uint32_t seq;
+    do {
+        while ((seq = ck.mark_seq) & 1);
+        __DMB();
+        *mark = ck.mark;
+        __DMB();
+    } while (seq != ck.mark_seq);
+}
+
+static void _ck_seal()
+{
+    ck.record.magic = CHECKPOINT_MAGIC;
+    ck.record.sequence++;
+    ck.record.crc = _record_crc(&ck.record);
+}
+
+/*
+ * _exec_end() - the job ended - queued by checkpoint_end() so it runs when the runtime gets there
+ */
+
+static void _exec_end(float *value, bool *flag)
+{
+    ck.mark.gm.linenum = 0;                                 // the next job's first line is marked
+    ck.end_requested = true;
+}
+
+/***********************************************************************************
+ **** CODE *************************************************************************
+ ***********************************************************************************/
+
+void checkpoint_init()
+{
+    memset(&ck, 0, sizeof(ck));
+    _ck_load();
+}
+
+void checkpoint_end()
+{
+    mp_queue_command(_exec_end, nullptr, nullptr);
+}
+
+/*
+ * checkpoint_callback() - store the latest mark if the interval is up and the line has moved on
+ *
+ *  Called from the main loop every TASK_CHECKPOINT_MS. A store that finds the flash busy is
+ *  left for the next call.
+ */
+
+stat_t checkpoint_callback()
+{
+    if (ck.end_requested) {
+        if (!_ck_ready()) {
+            return (STAT_NOOP);
+        }
+        ck.end_requested = false;
+        if (ck.record.mark.gm.linenum != 0) {               // ended record - nothing to resume
+            memset(&ck.record.mark, 0, sizeof(ck.record.mark));
+            _ck_seal();
+            _ck_store();
+        }
+        return (STAT_OK);
+    }
+    if (ck.interval == 0) {
+        return (STAT_NOOP);
+    }
+    uint32_t now = SysTickTimer_getValue();
+    if ((now - ck.stored_ms) < (uint32_t)(ck.interval * 1000)) {
+        return (STAT_NOOP);
+    }
+    if ((ck.mark.gm.linenum == 0) || (ck.mark.gm.linenum == ck.record.mark.gm.linenum) || !_ck_ready()) {
+        return (STAT_NOOP);                                 // nothing new, or try again next call
+    }
+    _ck_take_mark(&ck.record.mark);
+    copy_vector(ck.record.tool_offset, cm->tool_offset);
+    ck.record.spindle = (spindle.state == SPINDLE_OFF) ? SPINDLE_OFF : spindle.direction;
+    ck.record.spindle_speed = spindle.speed;
+    ck.record.coolant = ((coolant.mist.state != COOLANT_OFF) ? COOLANT_MIST : 0) |
+                        ((coolant.flood.state != COOLANT_OFF) ? COOLANT_FLOOD : 0);
+    ck.record.job = spool_running_job();
+    _ck_seal();
+    _ck_store();
+    ck.stored_ms = now;
+    return (STAT_OK);
+}
+
+/*
+ * _ck_resume() - move to the checkpoint, restore its state and re-enter the job
+ */
+
+static stat_t _ck_resume(const ckRecord_t *r)
+{
+    const GCodeState_t *gm = &r->mark.gm;
+    if ((r->magic != CHECKPOINT_MAGIC) || (gm->linenum == 0)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);                 // no checkpoint, or the job finished
+    }
+    if ((cm->cycle_type != CYCLE_NONE) || cm_get_runtime_busy()) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        if ((cm->a[axis].axis_mode != AXIS_DISABLED) && !cm->homed[axis]) {
+            return (STAT_COMMAND_NOT_ACCEPTED);             // machine coordinates aren't known
+        }
+    }
+    uint32_t offset = 0;
+    stat_t spooled = spool_find_line(r->job, gm->linenum, &offset);
+    if ((spooled != STAT_OK) && (spooled != STAT_FILE_NOT_OPEN)) {
+        return (spooled);                                   // a spooled job without the line
+    }
+
+    // move to the start of the line in machine coordinates: over at this Z height, then down
+    float target[AXES];
+    bool flags[AXES];
+    copy_vector(target, r->mark.position);
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        flags[axis] = (axis != AXIS_Z) && (cm->a[axis].axis_mode != AXIS_DISABLED);
+    }
+    cm_set_units_mode(MILLIMETERS);
+    cm_set_distance_mode(ABSOLUTE_DISTANCE_MODE);
+    cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS);
+    stat_t status = cm_straight_traverse(target, flags, PROFILE_NORMAL);
+    if (status == STAT_OK) {
+        if (r->spindle != SPINDLE_OFF) {
+            spindle_speed_sync(r->spindle_speed);
+            spindle_control_sync((spControl)r->spindle);
+        }
+        if (r->coolant != COOLANT_NONE) {
+            coolant_control_sync(COOLANT_ON, (coSelect)r->coolant);
+        }
+        for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+            flags[axis] = (axis == AXIS_Z);
+        }
+        if ((gm->feed_rate_mode == UNITS_PER_MINUTE_MODE) && (gm->feed_rate > 0)) {
+            cm_set_feed_rate_mode(UNITS_PER_MINUTE_MODE);
+            cm_set_feed_rate(gm->feed_rate);
+            status = cm_straight_feed(target, flags, PROFILE_NORMAL);
+        } else {
+            status = cm_straight_traverse(target, flags, PROFILE_NORMAL);
+        }
+    }
+    cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_OFF);
+    ritorno(status);
+
+    // offsets: G92 is what's left of the line's work offsets after the coordinate system and tool
+    copy_vector(cm->tool_offset, r->tool_offset);
+    cm->gm.tool = gm->tool;
+    cm->gm.tool_select = gm->tool;
+    cm->gmx.g92_offset_enable = false;
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        cm->gmx.g92_offset[axis] = gm->display_offset[axis] - cm->coord_offset[gm->coord_system][axis] - r->tool_offset[axis];
+        if (fp_NOT_ZERO(cm->gmx.g92_offset[axis])) {
+            cm->gmx.g92_offset_enable = true;
+        }
+    }
+    cm_set_coord_system(gm->coord_system);                  // applies the offsets in the runtime too
+
+    // modal state - after the moves, which were made in millimeters
+    cm_set_units_mode(gm->units_mode);
+    cm_set_distance_mode(gm->distance_mode);
+    cm_set_arc_distance_mode(gm->arc_distance_mode);
+    cm_select_plane(gm->select_plane);
+    cm_set_feed_rate_mode(gm->feed_rate_mode);
+    cm->gm.feed_rate = gm->feed_rate;                       // stored normalized - see cm_set_feed_rate()
+    cm_set_path_control(MODEL, gm->path_control);
+    cm->gm.path_tolerance = gm->path_tolerance;
+    cm_set_motion_mode(MODEL, gm->motion_mode);             // for lines that carry only axis words
+
+    if (spooled == STAT_OK) {
+        ritorno(spool_run(r->job, offset));
+    }
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+stat_t ck_get_cki(nvObj_t *nv) { return (get_float(nv, ck.interval)); }
+stat_t ck_set_cki(nvObj_t *nv) { return (set_float_range(nv, ck.interval, 0, CHECKPOINT_INTERVAL_MAX)); }
+
+/*
+ * ck_get_ckl() - get the line of the stored checkpoint, 0 if none
+ * ck_set_ckr() - resume at the checkpoint and return its line
+ */
+
+stat_t ck_get_ckl(nvObj_t *nv)
+{
+    nv->value_int = (ck.record.magic == CHECKPOINT_MAGIC) ? ck.record.mark.gm.linenum : 0;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t ck_set_ckr(nvObj_t *nv)
+{
+    if (!nv->value_int) {
+        return (STAT_OK);
+    }
+    ritorno(_ck_resume(&ck.record));
+    nv->value_int = ck.record.mark.gm.linenum;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_cki[] = "[cki] checkpoint interval%13.1f seconds\n";
+static const char fmt_ckl[] = "[ckl] checkpoint line%17d\n";
+
+void ck_print_cki(nvObj_t *nv) { text_print(nv, fmt_cki);}      // TYPE_FLOAT
+void ck_print_ckl(nvObj_t *nv) { text_print(nv, fmt_ckl);}      // TYPE_INTEGER
+
+#endif // __TEXT_MODE
@@ -0,0 +1,155 @@
+/*
+ * checkpoint.h - job checkpoints for resuming after a power loss
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * JOB CHECKPOINTS
+ *
+ *  A checkpoint is where a job can be picked up again: the line the runtime is working on,
+ *  the machine position it started from, and the modal state, offsets, tool, spindle and
+ *  coolant in force for it. Only lines with an N word are checkpointed - the line number
+ *  is how the job is re-entered.
+ *
+ *    {cki:n}   seconds between checkpoints while a job runs, 0 = off
+ *    {ckl:n}   line of the stored checkpoint, 0 if there is none (cleared by M2/M30)
+ *    {ckr:t}   resume at the stored checkpoint - returns the line
+ *
+ *  The exec interrupt marks each new line as it starts (checkpoint_mark()): a copy of the
+ *  block's Gcode state and the runtime position, only when the line number changes. The
+ *  main loop takes the latest mark every {cki:} seconds and stores it, so there is at most
+ *  one write per interval however short the lines are, and none if the line hasn't changed.
+ *
+ *  Resume needs the machine idle and its axes homed, so machine coordinates mean what they
+ *  did. It moves to the checkpoint in machine coordinates - every axis but Z at the current
+ *  Z height, then the spindle and coolant, then Z down at the checkpoint feed rate - restores
+ *  the offsets and modal state, and restarts the line. If the job was run from the spool
+ *  (spool.h) it is run again from that line; otherwise the host re-sends the job from the
+ *  returned line. A job queue isn't picked up again - start it afresh for the jobs left.
+ *
+ *  With CHECKPOINT_ENABLED on SAM3X the checkpoints are kept in CHECKPOINT_PAGES pages of
+ *  flash bank 1 just below the persistence areas, one record per page written round-robin
+ *  so the wear is spread. A page is erased and written (EWP, about 5 ms) by EFC1 without
+ *  waiting - motion runs on from bank 0, and the next write is skipped until the flash is
+ *  ready. Boot takes the newest record that checks out, so a write cut short by the power
+ *  going leaves the one before. At 32 pages and 10,000 cycles a page that is 320,000
+ *  checkpoints - about 900 hours of cutting at the default 10 s interval.
+ *
+ *  Otherwise the checkpoint is held in RAM. That doesn't survive a power loss, but resumes
+ *  a job stopped by an alarm or a kill, and lets the rest be tried in the simulator.
+ */
+
+#ifndef CHECKPOINT_H_ONCE
+#define CHECKPOINT_H_ONCE
+
+#include "config.h"  // needed for nvObj_t definition
+#include "gcode.h"
+
+#define CHECKPOINT_MAGIC 0x544B4843                         // "CHKT"
+#define CHECKPOINT_INTERVAL_MAX 3600.0                      // {cki:} seconds
+#ifndef TASK_CHECKPOINT_MS
+#define TASK_CHECKPOINT_MS 100                              // checkpoint_callback()
+#endif
+
+#if CHECKPOINT_ENABLED == true
+#define CHECKPOINT_PAGE_SIZE 256                            // bytes per flash page
+#ifndef CHECKPOINT_PAGES
+#define CHECKPOINT_PAGES 32                                 // pages in the ring
+#endif
+#define CHECKPOINT_RESERVED (CHECKPOINT_PAGES * CHECKPOINT_PAGE_SIZE)
+#else
+#define CHECKPOINT_RESERVED 0                               // flash taken below the persistence areas
+#endif
+
+typedef struct ckMark {             // marked by the exec interrupt
+    GCodeState_t gm;                // Gcode state of the line - linenum, modes, feed, offsets
+    float position[AXES];           // machine position at the start of the line
+} ckMark_t;
+
+typedef struct ckRecord {           // a stored checkpoint
+    uint32_t magic;                 // CHECKPOINT_MAGIC
+    uint32_t sequence;              // newest wins
+    ckMark_t mark;                  // mark.gm.linenum 0 means the job ended
+    float tool_offset[AXES];        // cm->tool_offset when it was stored
+    float spindle_speed;
+    uint8_t spindle;                // spControl: OFF, CW or CCW
+    uint8_t coolant;                // coSelect bits of the coolants on
+    uint8_t job;                    // spooled job that was running, 0 if streamed
+    uint32_t crc;                   // CRC32 over the bytes above
+} ckRecord_t;
+
+//**** checkpoint singleton ****
+
+typedef struct ckSingleton {
+    float interval;                 // {cki:} seconds between checkpoints, 0 = off
+    volatile uint32_t mark_seq;     // odd while the exec interrupt is writing mark
+    ckMark_t mark;                  // latest line started
+    uint32_t stored_ms;             // SysTick time of the last store
+    bool end_requested;             // set by M2/M30 - store an ended record
+    ckRecord_t record;              // the stored checkpoint, or the one being written
+#if CHECKPOINT_ENABLED == true
+    uint16_t page;                  // page the next record goes to
+#endif
+} ckSingleton_t;
+
+extern ckSingleton_t ck;
+
+/*
+ * checkpoint_mark() - note the start of a line - called from the exec interrupt for each new block
+ *
+ *  Blocks in machine coordinates (G53) carry no work offsets, so they aren't marked.
+ */
+
+static inline void checkpoint_mark(const GCodeState_t *gm, const float position[])
+{
+    if ((gm->linenum == 0) || (gm->linenum == ck.mark.gm.linenum) ||
+        (gm->absolute_override != ABSOLUTE_OVERRIDE_OFF) || (ck.interval == 0)) {
+        return;
+    }
+    ck.mark_seq++;
+    __DMB();
+    ck.mark.gm = *gm;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        ck.mark.position[axis] = position[axis];
+    }
+    __DMB();
+    ck.mark_seq++;
+}
+
+void checkpoint_init(void);
+stat_t checkpoint_callback(void);
+void checkpoint_end(void);
+
+stat_t ck_get_cki(nvObj_t *nv);
+stat_t ck_set_cki(nvObj_t *nv);
+stat_t ck_get_ckl(nvObj_t *nv);
+stat_t ck_set_ckr(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void ck_print_cki(nvObj_t *nv);
+    void ck_print_ckl(nvObj_t *nv);
+#else
+    #define ck_print_cki tx_print_stub
+    #define ck_print_ckl tx_print_stub
+#endif
+
+#endif  // End of include guard: CHECKPOINT_H_ONCE
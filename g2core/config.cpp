@@ -36,20 +36,27 @@
 #include "json_parser.h"
 #include "text_parser.h"
 #include "persistence.h"
+#include "stepper.h"
 #include "hardware.h"
 #include "help.h"
 #include "util.h"
 #include "xio.h"
 
 static void _set_defa(nvObj_t *nv, bool print);
+static void _set_profile(nvObj_t *nv);
+#if PERSISTENCE_ENABLED == true
+static void _load_persisted(nvObj_t *nv);
+#endif
 
 /***********************************************************************************
  **** STRUCTURE ALLOCATIONS ********************************************************
  ***********************************************************************************/
 
-nvStr_t nvStr;
+nvArena_t nvArena;
 nvList_t nvl;
 
+static bool cfg_loading = false;        // settings are being loaded in bulk - see set_mpro()
+
 /***********************************************************************************
  **** CODE *************************************************************************
  ***********************************************************************************/
@@ -67,6 +74,7 @@ stat_t nv_set(nvObj_t *nv)
     if (nv->index >= nv_index_max()) {
         return(STAT_INTERNAL_RANGE_ERROR);
     }
+    cm_config_changed();                    // p2 re-copies cm1 configuration on its next entry
     return (((fptrCmd)cfgArray[nv->index].set)(nv));
 }
 
@@ -113,7 +121,17 @@ void config_init()
 {
     nvObj_t *nv = nv_reset_nv_list();
     config_init_assertions();
+    nv_group_init();
     js.json_mode = JSON_MODE;                    // initial value until persistence is read
+#if PERSISTENCE_ENABLED == true
+    nv->index = 0;                              // fb is first - NVM is only used if it's from this build
+    if ((read_persistent_value(nv) == STAT_OK) && (fp_EQ(nv->value_flt, cs.fw_build))) {
+        _load_persisted(nv);
+        rpt_print_loading_configs_message();
+        return;
+    }
+    st_restore_odometers();                     // a new build keeps the motor odometers
+#endif
     _set_defa(nv, false);
     rpt_print_loading_configs_message();
 }
@@ -123,17 +141,23 @@ void config_init()
  * _set_defa() - helper function and called directly from config_init()
  */
 
+static void _get_default(nvObj_t *nv)
+{
+    if ((cfgArray[nv->index].flags & TYPE_INTEGER) ||
+        (cfgArray[nv->index].flags & TYPE_BOOLEAN)) {    // Fix for Issue #357
+        nv->value_int = cfgArray[nv->index].def_value;
+    } else {
+        nv->value_flt = cfgArray[nv->index].def_value;
+    }
+}
+
 static void _set_defa(nvObj_t *nv, bool print)
 {
     cm_set_units_mode(MILLIMETERS);             // must do inits in MM mode
+    persistence_rewrite_begin();                // the defaults replace the whole store
     for (nv->index=0; nv_index_is_single(nv->index); nv->index++) {
         if (cfgArray[nv->index].flags & F_INITIALIZE) {
-            if ((cfgArray[nv->index].flags & TYPE_INTEGER) ||
-                (cfgArray[nv->index].flags & TYPE_BOOLEAN)) {    // Fix for Issue #357
-                nv->value_int = cfgArray[nv->index].def_value;
-            } else {
-                nv->value_flt = cfgArray[nv->index].def_value;
-            }
+            _get_default(nv);
             strncpy(nv->token, cfgArray[nv->index].token, TOKEN_LEN);
             cfgArray[nv->index].set(nv);        // run the set method, nv_set(nv);
             if (cfgArray[nv->index].flags & F_PERSIST) {
@@ -141,12 +165,49 @@ static void _set_defa(nvObj_t *nv, bool print)
             }            
         }
     }
+    _set_profile(nv);
     sr_init_status_report();                    // reset status reports
+    st_persist_odometers();                     // the motor odometers aren't defaults - carry them over
+    persistence_rewrite_end();
+#if PERSISTENCE_ENABLED == true
+    nv->index = 0;                              // mark NVM as holding this build's values - after all the others
+    nv->value_flt = cs.fw_build;
+    write_persistent_value(nv);
+#endif
     if (print) {
         rpt_print_initializing_message();       // don't start TX until all the NVM persistence is done
     }
 }
 
+#if PERSISTENCE_ENABLED == true
+/*
+ * _load_persisted() - config_init() helper to load persisted values, or defaults for any not persisted
+ *
+ *  Sets the defaults, then the persisted values over them in one pass over the store.
+ *  Looking each index up in the log instead made boot time grow with the log length.
+ */
+
+static void _load_persisted(nvObj_t *nv)
+{
+    cm_set_units_mode(MILLIMETERS);             // persisted values are in canonical units
+    cfg_loading = true;
+    for (nv->index=0; nv_index_is_single(nv->index); nv->index++) {
+        if (cfgArray[nv->index].flags & F_INITIALIZE) {
+            _get_default(nv);
+            strncpy(nv->token, cfgArray[nv->index].token, TOKEN_LEN);
+            cfgArray[nv->index].set(nv);
+        }
+    }
+    load_persistent_values(nv);
+    cfg_loading = false;
+    if (sr.status_report_list[0] == 0) {        // no SR list was persisted
+        sr_init_status_report();
+    } else {
+        sr_restore_status_report();
+    }
+}
+#endif
+
 stat_t set_defaults(nvObj_t *nv)
 {
     // failsafe. nv->value_int must be true or no action occurs
@@ -165,6 +226,313 @@ stat_t set_defaults(nvObj_t *nv)
     return (STAT_OK);
 }
 
+/*
+ * CONFIGURATION SNAPSHOTS
+ *
+ *  get_cfg() - return the number of chunks in a snapshot of the persisted settings
+ *  set_cfg() - given a chunk number, return that chunk; given a chunk, restore it
+ *
+ *  A snapshot is every F_PERSIST single in cfgArray order, as raw values in canonical units.
+ *  It's too big for one line so it's read and restored in CFG_CHUNK_VALUES chunks:
+ *
+ *    {"cfg":n}       returns {"cfg":"<hex>"} - chunk n of the count returned by {"cfg":null}
+ *    {"cfg":"<hex>"} restores the chunk and returns {"cfg":n}
+ *
+ *  A chunk is hex (JSON strings are lowercased so base64 won't survive the parser):
+ *
+ *    uint8   CFG_SNAPSHOT_VERSION
+ *    uint8   chunk number
+ *    uint8   chunk count
+ *    uint8   values in this chunk
+ *    uint32  fingerprint of the token and type layout of the persisted settings
+ *    uint32  values[] - float or int32 bits, by type
+ *    uint32  CRC32 of all the above
+ *
+ *  All fields are little-endian. A chunk is only applied if its CRC, version and fingerprint
+ *  match, so a snapshot can only be restored into firmware with the same settings layout.
+ *  Chunks must be restored in order. Values are set directly (no per-value token lookup)
+ *  and persisted, and the status report is rebuilt after the last chunk.
+ */
+
+#define CFG_SNAPSHOT_VERSION 1
+#define CFG_CHUNK_VALUES 48             // 408 hex characters - fits an RX line with the JSON wrapper
+#define CFG_CHUNK_HEADER 8
+#define CFG_CHUNK_MAX (CFG_CHUNK_HEADER + (CFG_CHUNK_VALUES * 4) + 4)
+static_assert((CFG_CHUNK_MAX * 2 + 16) < RX_BUFFER_SIZE, "a configuration snapshot chunk must fit an RX line");
+
+static uint8_t cfg_next_chunk = 0;      // next chunk expected by a restore
+
+static inline bool _cfg_in_snapshot(const index_t index)
+{
+    return (cfgArray[index].flags & F_PERSIST);
+}
+
+static uint32_t _cfg_fingerprint(uint16_t &count)
+{
+    uint32_t h = 2166136261;            // FNV-1a
+    count = 0;
+    for (index_t i=0; nv_index_is_single(i); i++) {
+        if (!_cfg_in_snapshot(i)) {
+            continue;
+        }
+        for (const char *c = cfgArray[i].token; *c != NUL; c++) {
+            h = (h ^ (uint8_t)*c) * 16777619;
+        }
+        h = (h ^ (cfgArray[i].flags & F_TYPE_MASK)) * 16777619;
+        count++;
+    }
+    return (h);
+}
+
+static void _cfg_put_uint32(uint8_t *p, const uint32_t v)
+{
+    for (uint8_t i=0; i<4; i++) {
+        p[i] = (v >> (i * 8)) & 0xFF;
+    }
+}
+
+static uint32_t _cfg_get_uint32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+static index_t _cfg_chunk_start(const uint8_t chunk)       // cfgArray index of the first value in a chunk
+{
+    uint16_t skip = chunk * CFG_CHUNK_VALUES;
+    index_t i;
+    for (i=0; nv_index_is_single(i); i++) {
+        if (_cfg_in_snapshot(i) && (skip-- == 0)) {
+            break;
+        }
+    }
+    return (i);
+}
+
+stat_t get_cfg(nvObj_t *nv)
+{
+    uint16_t count;
+    _cfg_fingerprint(count);
+    nv->value_int = (count + CFG_CHUNK_VALUES - 1) / CFG_CHUNK_VALUES;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+static stat_t _cfg_read_chunk(nvObj_t *nv)
+{
+    uint16_t count;
+    uint32_t fingerprint = _cfg_fingerprint(count);
+    uint8_t chunks = (count + CFG_CHUNK_VALUES - 1) / CFG_CHUNK_VALUES;
+    if ((nv->value_flt < 0) || (nv->value_flt >= chunks)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    uint8_t chunk = (uint8_t)nv->value_flt;
+    uint8_t blob[CFG_CHUNK_MAX];
+    uint8_t *p = &blob[CFG_CHUNK_HEADER];
+    uint8_t values = 0;
+
+    for (index_t i = _cfg_chunk_start(chunk); nv_index_is_single(i) && (values < CFG_CHUNK_VALUES); i++) {
+        if (!_cfg_in_snapshot(i)) {
+            continue;
+        }
+        nv->index = i;
+        cfgArray[i].get(nv);
+        uint32_t v = (uint32_t)nv->value_int;
+        if (nv->valuetype == TYPE_FLOAT) {
+            memcpy(&v, &nv->value_flt, sizeof(v));
+        }
+        _cfg_put_uint32(p, v);
+        p += 4;
+        values++;
+    }
+    blob[0] = CFG_SNAPSHOT_VERSION;
+    blob[1] = chunk;
+    blob[2] = chunks;
+    blob[3] = values;
+    _cfg_put_uint32(&blob[4], fingerprint);
+    _cfg_put_uint32(p, crc32(blob, p - blob));
+    p += 4;
+
+    char hex[CFG_CHUNK_MAX * 2 + 1];
+    char *h = hex;
+    for (uint8_t *b = blob; b < p; b++) {
+        *h++ = "0123456789abcdef"[*b >> 4];
+        *h++ = "0123456789abcdef"[*b & 0x0F];
+    }
+    *h = NUL;
+    nv->index = nv_get_index("", "cfg");
+    strncpy(nv->token, "cfg", TOKEN_LEN);
+    nv->valuetype = TYPE_STRING;
+    return (nv_copy_string(nv, hex));
+}
+
+static stat_t _cfg_restore_chunk(nvObj_t *nv)
+{
+    uint8_t blob[CFG_CHUNK_MAX];
+    uint16_t len = 0;
+    for (const char *h = *nv->stringp; *h != NUL; h += 2) {
+        if ((len == CFG_CHUNK_MAX) || !isxdigit(h[0]) || !isxdigit(h[1])) {
+            return (STAT_INPUT_VALUE_RANGE_ERROR);
+        }
+        blob[len++] = (uint8_t)((isdigit(h[0]) ? h[0] - '0' : tolower(h[0]) - 'a' + 10) << 4 |
+                                (isdigit(h[1]) ? h[1] - '0' : tolower(h[1]) - 'a' + 10));
+    }
+    if ((len < CFG_CHUNK_HEADER + 4) || (len != CFG_CHUNK_HEADER + (blob[3] * 4) + 4)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    if (crc32(blob, len - 4) != _cfg_get_uint32(&blob[len - 4])) {
+        return (STAT_CHECKSUM_MATCH_FAILED);
+    }
+    uint16_t count;
+    if ((blob[0] != CFG_SNAPSHOT_VERSION) || (_cfg_get_uint32(&blob[4]) != _cfg_fingerprint(count))) {
+        return (STAT_UNSUPPORTED_TYPE);                 // snapshot is from a different settings layout
+    }
+    uint8_t chunk = blob[1];
+    if ((chunk != 0) && (chunk != cfg_next_chunk)) {
+        cfg_next_chunk = 0;
+        return (STAT_INPUT_VALUE_RANGE_ERROR);          // out of order - start again from chunk 0
+    }
+    cfg_next_chunk = chunk + 1;
+
+    const uint8_t *p = &blob[CFG_CHUNK_HEADER];
+    uint8_t values = blob[3];
+    cfg_loading = true;
+    for (index_t i = _cfg_chunk_start(chunk); nv_index_is_single(i) && (values > 0); i++) {
+        if (!_cfg_in_snapshot(i)) {
+            continue;
+        }
+        uint32_t v = _cfg_get_uint32(p);
+        p += 4;
+        values--;
+        nv->index = i;
+        uint8_t type = cfgArray[i].flags & F_TYPE_MASK;
+        if ((type == TYPE_INTEGER) || (type == TYPE_BOOLEAN)) {
+            nv->value_int = (int32_t)v;
+            nv->valuetype = TYPE_INTEGER;
+        } else {
+            memcpy(&nv->value_flt, &v, sizeof(v));
+            nv->valuetype = TYPE_FLOAT;
+        }
+        strncpy(nv->token, cfgArray[i].token, TOKEN_LEN);
+        cfgArray[i].set(nv);
+        nv_persist(nv);
+    }
+    cfg_loading = false;
+    if (cfg_next_chunk == blob[2]) {                    // that was the last one
+        sr_restore_status_report();
+        cfg_next_chunk = 0;
+    }
+    nv->index = nv_get_index("", "cfg");
+    strncpy(nv->token, "cfg", TOKEN_LEN);
+    nv->value_int = chunk;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t set_cfg(nvObj_t *nv)
+{
+    if (cm->cycle_type != CYCLE_NONE) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    if (nv->valuetype == TYPE_STRING) {
+        return (_cfg_restore_chunk(nv));
+    }
+    return (_cfg_read_chunk(nv));
+}
+
+/*
+ * MACHINE PROFILES
+ *
+ *  get_mpro()     - return the active profile
+ *  set_mpro()     - switch profile: {mpro:n}
+ *  print_mpro()   - print the active profile and its name in text mode
+ *  _set_profile() - _set_defa() helper to apply the active profile over the defaults
+ *
+ *  One machine can carry several compiled-in profiles - a laser head and a spindle head,
+ *  say. Profile 0 is the settings file as it is. The others come from PROFILES_FILE in
+ *  settings/, named in the settings file. Each is a table of token and value pairs that
+ *  are applied over the settings file defaults (see settings/profiles_laser_spindle.h):
+ *
+ *    static const cfgProfileValue_t profile_laser[] = { { "spmo", 2 }, { "p1frq", 5000 } };
+ *    #define MACHINE_PROFILES MACHINE_PROFILE("laser", profile_laser),
+ *
+ *  Switching is a defaults load ($defa=1) with the new profile on top, so every setting
+ *  changed since the last one is lost. It goes through the bulk path - one pass over
+ *  cfgArray and one fresh persistence area - and is refused unless the machine is idle.
+ *  The profile number is persisted with the values. While settings are being loaded in
+ *  bulk (boot or a snapshot restore) setting mpro just records it.
+ */
+
+#define MACHINE_PROFILE(name, values) { name, values, sizeof(values) / sizeof(cfgProfileValue_t) }
+
+#ifdef PROFILES_FILE
+#define PROFILES_FILE_PATH <settings/PROFILES_FILE>
+#include PROFILES_FILE_PATH
+#endif
+#ifndef MACHINE_PROFILES
+#define MACHINE_PROFILES
+#endif
+
+static const cfgProfile_t cfgProfiles[] = {
+    { "settings file", nullptr, 0 },
+    MACHINE_PROFILES
+};
+#define MACHINE_PROFILE_COUNT (sizeof(cfgProfiles) / sizeof(cfgProfile_t))
+
+static void _set_profile(nvObj_t *nv)
+{
+    const cfgProfile_t *profile = &cfgProfiles[cfg.profile];
+    for (uint8_t i=0; i < profile->count; i++) {
+        nv->index = nv_get_index("", profile->values[i].token);
+        if (!nv_index_is_single(nv->index)) {
+            rpt_exception(STAT_UNRECOGNIZED_NAME, profile->values[i].token);
+            continue;
+        }
+        if ((cfgArray[nv->index].flags & TYPE_INTEGER) || (cfgArray[nv->index].flags & TYPE_BOOLEAN)) {
+            nv->value_int = profile->values[i].value;
+        } else {
+            nv->value_flt = profile->values[i].value;
+        }
+        strncpy(nv->token, cfgArray[nv->index].token, TOKEN_LEN);
+        cfgArray[nv->index].set(nv);
+        nv_persist(nv);
+    }
+    nv->index = nv_get_index("", "mpro");
+    nv->value_int = cfg.profile;
+    nv_persist(nv);
+}
+
+stat_t get_mpro(nvObj_t *nv) { return (get_integer(nv, cfg.profile)); }
+
+stat_t set_mpro(nvObj_t *nv)
+{
+    if ((nv->value_int < 0) || (nv->value_int >= (int32_t)MACHINE_PROFILE_COUNT)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    if (cfg_loading) {
+        cfg.profile = nv->value_int;
+        return (STAT_OK);
+    }
+    if ((cm->cycle_type != CYCLE_NONE) || (cm->motion_state != MOTION_STOP)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    cfg.profile = nv->value_int;
+    _set_defa(nv, false);
+    nv_reset_nv_list();                         // the nvlist was used for the load
+    nv->index = nv_get_index("", "mpro");
+    strncpy(nv->token, "mpro", TOKEN_LEN);
+    nv->valuetype = TYPE_INTEGER;
+    nv->value_int = cfg.profile;
+    return (STAT_OK);
+}
+
+static const char fmt_mpro[] = "[mpro] machine profile%14d [%s]\n";
+
+void print_mpro(nvObj_t *nv)
+{
+    sprintf(cs.out_buf, fmt_mpro, cfg.profile, cfgProfiles[cfg.profile].name);
+    xio_writeline(cs.out_buf);
+}
+
 /*
  * config_init_assertions()
  * config_test_assertions() - check memory integrity of config sub-system
@@ -176,8 +544,8 @@ void config_init_assertions()
     cfg.magic_end = MAGICNUM;
     nvl.magic_start = MAGICNUM;
     nvl.magic_end = MAGICNUM;
-    nvStr.magic_start = MAGICNUM;
-    nvStr.magic_end = MAGICNUM;
+    nvArena.magic_start = MAGICNUM;
+    nvArena.magic_end = MAGICNUM;
 }
 
 stat_t config_test_assertions()
@@ -186,8 +554,8 @@ stat_t config_test_assertions()
         (BAD_MAGIC(cfg.magic_end)) ||
         (BAD_MAGIC(nvl.magic_start)) ||
         (BAD_MAGIC(nvl.magic_end)) ||
-        (BAD_MAGIC(nvStr.magic_start)) ||
-        (BAD_MAGIC(nvStr.magic_end))) {
+        (BAD_MAGIC(nvArena.magic_start)) ||
+        (BAD_MAGIC(nvArena.magic_end))) {
         return(cm_panic(STAT_CONFIG_ASSERTION_FAILURE, "config_test_assertions()"));
     }
     return (STAT_OK);
@@ -323,13 +691,22 @@ stat_t set_data(nvObj_t *nv)
 stat_t get_grp(nvObj_t *nv)
 {
     char group[GROUP_LEN+1];
+    index_t first, last;
+    bool contiguous;
 
     strcpy(group, nv->token);                       // save the group string
+    if (!nv_group_range(nv->index, first, last, contiguous)) {  // only search the group's own range if it has one
+        first = 0;
+        last = nv_index_max();
+        contiguous = false;
+    }
     nv_reset_nv_list();                             // start with a clean list
     strcpy(nv->token, group);                       // re-write the group string
     nv->valuetype = TYPE_PARENT;                    // make first object the parent
-    for (index_t i=0; nv_index_is_single(i); i++) {
-        if (strcmp(group, cfgArray[i].group) != 0) { continue; }
+    uint8_t count = 0;
+    for (index_t i=first; (i <= last) && nv_index_is_single(i); i++) {
+        if (!contiguous && (strcmp(group, cfgArray[i].group) != 0)) { continue; }
+        if (++count > NV_MAX_OBJECTS) { break; }    // the rest won't fit in the body
         (++nv)->index = i;
         nv_get_nvObj(nv);
     }
@@ -373,11 +750,45 @@ stat_t set_grp(nvObj_t *nv)
  */
 
 /* nv_get_index() - get index from mnenonic token + group
+ * _nv_hash()      - hash the first 5 characters of a token, the most nv_get_index() compares
+ * _nv_hash_init() - build the hash chains over cfgArray
  *
- * nv_get_index() is the most expensive routine in the whole config. It does a
- * linear table scan of the strings, which of course could be further
- * optimized with indexes or hashing.
+ * nv_get_index() used to be the most expensive routine in the whole config - a
+ * linear table scan of the strings. Lookups now hash the group+token string and
+ * only compare the cfgArray entries in its bucket. nvHashNext[] chains entries with
+ * the same hash in index order, so the first match is the same one the linear scan
+ * found. The chains are built on the first lookup.
  */
+#define NV_HASH_SIZE 256                // number of hash buckets - must be a power of 2
+
+static index_t nv_hash_head[NV_HASH_SIZE];
+static bool nv_hash_ready = false;
+
+static inline uint8_t _nv_hash(const char *str)
+{
+    uint16_t hash = 0;
+    for (uint8_t j=0; (j < 5) && (str[j] != NUL); j++) {
+        hash = (hash * 31) + str[j];
+    }
+    return (hash & (NV_HASH_SIZE-1));
+}
+
+static void _nv_hash_init()
+{
+    char str[TOKEN_LEN+1];
+    for (index_t i=0; i < NV_HASH_SIZE; i++) {
+        nv_hash_head[i] = NO_MATCH;
+    }
+    for (index_t i = nv_index_max(); i > 0; i--) { // insert from the end so chains run in index order
+        strncpy(str, cfgArray[i-1].token, TOKEN_LEN);
+        str[TOKEN_LEN] = NUL;
+        uint8_t hash = _nv_hash(str);
+        nvHashNext[i-1] = nv_hash_head[hash];
+        nv_hash_head[hash] = i-1;
+    }
+    nv_hash_ready = true;
+}
+
 index_t nv_get_index(const char *group, const char *token)
 {
     char c;
@@ -385,10 +796,12 @@ index_t nv_get_index(const char *group, const char *token)
     strncpy(str, group, GROUP_LEN+1);
     strncat(str, token, TOKEN_LEN+1);
 
+    if (!nv_hash_ready) {
+        _nv_hash_init();
+    }
     index_t i;
-    index_t index_max = nv_index_max();
 
-    for (i=0; i < index_max; i++) {
+    for (i = nv_hash_head[_nv_hash(str)]; i != NO_MATCH; i = nvHashNext[i]) {
         if ((c = GET_TOKEN_BYTE(token[0])) != str[0]) {    continue; }              // 1st character mismatch
         if ((c = GET_TOKEN_BYTE(token[1])) == NUL) { if (str[1] == NUL) return(i);} // one character match
         if (c != str[1]) continue;                                                  // 2nd character mismatch
@@ -450,6 +863,9 @@ void nv_coerce_types(nvObj_t *nv)
  * nv_reset_nv()        - quick clear for a new nv object
  * nv_reset_nv_list()   - clear entire header, body and footer for a new use
  * nv_copy_string()     - used to write a string to shared string storage and link it
+ * nv_arena_alloc()     - take bytes from the arena - strings unless scratch is set
+ * nv_arena_mark()      - note the arena's fill before taking scratch
+ * nv_arena_release()   - hand back everything taken since the mark
  * nv_add_object()      - write contents of parameter to  first free object in the body
  * nv_add_integer()     - add an integer value to end of nv body (Note 1)
  * nv_add_float()       - add a floating point value to end of nv body
@@ -477,18 +893,16 @@ void nv_get_nvObj(nvObj_t *nv)
     nv_reset_nv(nv);
     nv->index = tmp;
 
-    strcpy(nv->token, cfgArray[nv->index].token); // token field is always terminated
-    strcpy(nv->group, cfgArray[nv->index].group); // group field is always terminated
+    const cfgItem_t *item = &cfgArray[nv->index];
 
     // special processing for system groups and stripping tokens for groups
-    if (nv->group[0] != NUL) {
-        if (cfgArray[nv->index].flags & F_NOSTRIP) {
-            nv->group[0] = NUL;
-        } else {
-            strcpy(nv->token, &nv->token[strlen(nv->group)]); // strip group from the token
-        }
+    if ((item->group[0] == NUL) || (item->flags & F_NOSTRIP)) {
+        strcpy(nv->token, item->token);         // token field is always terminated
+    } else {
+        strcpy(nv->group, item->group);         // group field is always terminated
+        strcpy(nv->token, &item->token[strlen(item->group)]); // copy the token with the group stripped
     }
-    ((fptrCmd)cfgArray[nv->index].get)(nv);     // populate the value
+    ((fptrCmd)item->get)(nv);                   // populate the value
 }
 
 nvObj_t *nv_reset_nv(nvObj_t *nv)               // clear a single nvObj structure
@@ -514,23 +928,44 @@ nvObj_t *nv_reset_nv(nvObj_t *nv)               // clear a single nvObj structur
     return (nv);                                // return pointer to nv as a convenience to callers
 }
 
-void _nv_reset_a_list(nvObj_t *nv, uint8_t length) // clear some nv list (called from below)
+/*
+ * _nv_reset_a_list() - clear some nv list (called from below)
+ *
+ *  Lists are filled front to back, and most responses and reports only use a few objects,
+ *  so the clear stops at the first object past the header that is still as it was left by
+ *  the last clear. Everything after it has not been touched since. An object counts as
+ *  touched if any field the clear sets differs, so a relinked or terminated object, one
+ *  left at another depth, or a filtered-out object that still carries its token is cleared.
+ *  The links are only ever rewritten where a list was terminated early (e.g. the footer).
+ *  At power-up the list is zeroed, which doesn't look cleared, so the first call does it all.
+ */
+
+static bool _nv_is_clear(const nvObj_t *nv, const nvObj_t *nx)
+{
+    return ((nv->valuetype == TYPE_EMPTY) && (nv->token[0] == NUL) && (nv->index == 0) &&
+            (nv->depth == 1) && (nv->precision == 0) && (nv->nx == nx) && (nv->pv == (nv-1)));
+}
+
+void _nv_reset_a_list(nvObj_t *nv, uint8_t length)
 {
     for (uint8_t i=0; i<length; i++, nv++) {
-        nv->pv = (nv-1);                        // the ends are bogus & corrected later
-        nv->nx = (nv+1);
+        nvObj_t *nx = (i < length-1) ? (nv+1) : NULL;
+        if ((i > 0) && _nv_is_clear(nv, nx)) {
+            break;                              // the rest of the list is clear
+        }
+        nv->pv = (nv-1);                        // the first is bogus & corrected later
+        nv->nx = nx;
         nv->index = 0;
         nv->depth = 1;                          // header and footer are corrected later
         nv->precision = 0;
         nv->valuetype = TYPE_EMPTY;
         nv->token[0] = NUL;
     }
-    (--nv)->nx = NULL;
 }
 
 nvObj_t *nv_reset_nv_list()                     // clear the header and response body
 {
-    nvStr.wp = 0;                               // reset the shared string
+    nvArena.wp = 0;                             // empty the arena
     nvObj_t *nv = nvl.list;                     // set up linked list and initialize elements
 
     _nv_reset_a_list(nv, NV_LIST_LEN);
@@ -554,15 +989,28 @@ nvObj_t *nv_reset_exec_nv_list()                // clear the exec body
     return (nv_exec);                           // this is a convenience for calling routines
 }
 
+char *nv_arena_alloc(const uint16_t size, const bool scratch)
+{
+    uint16_t end = scratch ? NV_ARENA_LEN : (NV_ARENA_LEN - NV_ARENA_RESERVE);
+    if (size > end - nvArena.wp) {
+        return (nullptr);
+    }
+    char *p = &nvArena.buf[nvArena.wp];
+    nvArena.wp += size;
+    return (p);
+}
+
+uint16_t nv_arena_mark() { return (nvArena.wp); }
+
+void nv_arena_release(const uint16_t mark) { nvArena.wp = mark; }
+
 stat_t nv_copy_string(nvObj_t *nv, const char *src)
 {
-    if ((nvStr.wp + strlen(src)) > NV_SHARED_STRING_LEN) {
+    char *dst = nv_arena_alloc(strlen(src)+1);
+    if (dst == nullptr) {
         return (STAT_BUFFER_FULL);
     }
-    char *dst = &nvStr.string[nvStr.wp];
-    strcpy(dst, src);                           // copy string to current head position
-                                                // string has already been tested for overflow, above
-    nvStr.wp += strlen(src)+1;                  // advance head for next string
+    strcpy(dst, src);
     nv->stringp = (char (*)[])dst;
     return (STAT_OK);
 }
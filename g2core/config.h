@@ -116,7 +116,8 @@
  *  To use the nvObj list first reset it by calling nv_reset_nv_list(). This initializes the
  *  header, marks the the objects as TYPE_EMPTY (-1), resets the shared string, relinks all objects
  *  with NX and PV pointers, and makes the last element the terminating element by setting its NX
- *  pointer to NULL. The terminating element may carry data, and will be processed.
+ *  pointer to NULL. The terminating element may carry data, and will be processed. Only the
+ *  objects used since the last reset are actually cleared (see _nv_reset_a_list()).
  *
  *  When you use the list you can terminate your own last element, or just leave the EMPTY elements
  *  to be skipped over during output serialization.
@@ -147,10 +148,14 @@
 /*  --- nv object string handling ---
  *
  *  It's very expensive to allocate sufficient string space to each nvObj, so nv uses a cheater's
- *  malloc. A single string of length NV_SHARED_STRING_LEN is shared by all nvObjs for all strings.
- *  The observation is that the total rendered output in JSON or text mode cannot exceed the size of
- *  the output buffer (typ 256 bytes), So some number less than that is sufficient for shared strings.
- *  This is all mediated through nv_copy_string(), nv_copy_string_P(), and nv_reset_nv_list().
+ *  malloc: a bump arena of NV_ARENA_LEN bytes that is emptied by nv_reset_nv_list(). Strings
+ *  linked to nvObjs are taken from it by nv_copy_string(), and live until the next reset.
+ *
+ *  The arena also serves scratch space for building a response - the serializer's output chunk,
+ *  the footer and the text mode prompt line. Scratch is taken with nv_arena_alloc(size, true)
+ *  between an nv_arena_mark() and nv_arena_release(), so it is handed back once the response has
+ *  been written. Strings stop NV_ARENA_RESERVE bytes short of the end and scratch may use the
+ *  rest, so a list whose strings fill the arena still gets its footer and is still written out.
  */
 /*  --- Setting nvObj indexes ---
  *
@@ -178,7 +183,8 @@ typedef uint16_t index_t;               // use this if there are > 255 indexed o
 #define NV_MESSAGE_LEN 128              // sufficient space to contain end-user messages
 
                                         // pre-allocated defines (take RAM permanently)
-#define NV_SHARED_STRING_LEN 1024        // shared string for string values
+#define NV_ARENA_LEN 1280                // strings linked to nvObjs and response scratch space
+#define NV_ARENA_RESERVE 256            // end of the arena only scratch can use
 #define NV_BODY_LEN 40                  // body elements - allow for 1 parent + N children
 #define NV_EXEC_LEN 10                  // elements reserved for exec, which won't directly respond
 // (each body element takes about 30 bytes of RAM)
@@ -283,16 +289,12 @@ typedef enum {                      // value typing for config and JSON
 
 /**** Structures ****/
 
-typedef struct nvString {               // shared string object
+typedef struct nvArena {                // shared string and scratch arena
     uint16_t magic_start;
-#if (NV_SHARED_STRING_LEN < 256)
-    uint8_t wp;                         // use this string array index value if string len < 256 bytes
-#else
-    uint16_t wp;                        // use this string array index value is string len > 255 bytes
-#endif
-    char string[NV_SHARED_STRING_LEN];
-    uint16_t magic_end;                 // guard to detect string buffer underruns
-} nvStr_t;
+    uint16_t wp;                        // next free byte
+    char buf[NV_ARENA_LEN];
+    uint16_t magic_end;                 // guard to detect arena underruns
+} nvArena_t;
 
 typedef struct nvObject {               // depending on use, not all elements may be populated
     struct nvObject *pv;                // pointer to previous object or NULL if first object
@@ -329,11 +331,23 @@ typedef struct cfgItem {
     float def_value;                    // default value for config item
 } cfgItem_t;
 
+typedef struct cfgProfileValue {        // one setting in a machine profile
+    char token[TOKEN_LEN+1];            // full token, as in JSON
+    float value;                        // in mm, like the settings file
+} cfgProfileValue_t;
+
+typedef struct cfgProfile {             // a machine profile - see MACHINE PROFILES in config.cpp
+    const char *name;
+    const cfgProfileValue_t *values;    // applied over the settings file defaults
+    uint8_t count;
+} cfgProfile_t;
+
 /**** static allocation and definitions ****/
 
-extern nvStr_t nvStr;
+extern nvArena_t nvArena;
 extern nvList_t nvl;
 extern const cfgItem_t cfgArray[];
+extern index_t nvHashNext[];           // hash chains for nv_get_index() (see config_app.cpp)
 
 //#define nv_header nv.list
 #define nv_header (&nvl.list[0])
@@ -344,6 +358,11 @@ extern const cfgItem_t cfgArray[];
 
 void config_init(void);
 stat_t set_defaults(nvObj_t *nv);       // reset config to default values
+stat_t get_cfg(nvObj_t *nv);            // get the number of configuration snapshot chunks
+stat_t set_cfg(nvObj_t *nv);            // read or restore a configuration snapshot chunk
+stat_t get_mpro(nvObj_t *nv);           // get the active machine profile
+stat_t set_mpro(nvObj_t *nv);           // switch machine profile
+void print_mpro(nvObj_t *nv);
 void config_init_assertions(void);
 stat_t config_test_assertions(void);
 
@@ -362,6 +381,8 @@ bool nv_index_is_single(index_t index); // (see config_app.c)
 bool nv_index_is_group(index_t index);  // (see config_app.c)
 bool nv_index_lt_groups(index_t index); // (see config_app.c)
 bool nv_group_is_prefixed(char *group);
+void nv_group_init(void);               // (see config_app.c)
+bool nv_group_range(index_t index, index_t &first, index_t &last, bool &contiguous); // (see config_app.c)
 
 // generic internal functions and accessors
 stat_t get_nul(nvObj_t *nv);            // get null value type
@@ -385,6 +406,9 @@ nvObj_t *nv_reset_nv(nvObj_t *nv);
 nvObj_t *nv_reset_nv_list(void);
 nvObj_t *nv_reset_exec_nv_list();
 stat_t nv_copy_string(nvObj_t *nv, const char *src);
+char *nv_arena_alloc(const uint16_t size, const bool scratch = false);
+uint16_t nv_arena_mark(void);
+void nv_arena_release(const uint16_t mark);
 nvObj_t *nv_add_object(const char *token);
 nvObj_t *nv_add_integer(const char *token, const uint32_t value);
 nvObj_t *nv_add_float(const char *token, const float value);
@@ -36,6 +36,7 @@
 #include "settings.h"
 #include "planner.h"
 #include "plan_arc.h"
+#include "kinematics.h"
 #include "stepper.h"
 #include "gpio.h"
 #include "spindle.h"
@@ -46,7 +47,19 @@
 #include "hardware.h"
 #include "util.h"
 #include "help.h"
+#include "profiler.h"
+#include "benchmark.h"
+#include "trace.h"
+#include "latency.h"
+#include "capture.h"
 #include "xio.h"
+#include "spool.h"
+#include "eta.h"
+#include "pso.h"
+#include "sync.h"
+#include "adaptive.h"
+#include "cpuload.h"
+#include "checkpoint.h"
 
 /*** structures ***/
 
@@ -102,6 +115,40 @@ static stat_t get_tick(nvObj_t *nv);        // get system tick count
  *    and convert_outgoing_float(). Apply conversion flags to all axes, not just linear,
  *    as rotary axes may be treated as linear if in radius mode, so the flag is needed.
  */
+// Temperature entries are the same for every heater, so they are generated per heater number.
+// pid active values are read-only; he entries are the heater set values (read-write).
+
+#define PID_CONFIG(n) \
+    { "pid" #n,"pid" #n "p",_fip, 3, tx_print_nul, cm_get_pid_p, set_ro, nullptr, 0 }, \
+    { "pid" #n,"pid" #n "i",_fip, 5, tx_print_nul, cm_get_pid_i, set_ro, nullptr, 0 }, \
+    { "pid" #n,"pid" #n "d",_fip, 5, tx_print_nul, cm_get_pid_d, set_ro, nullptr, 0 },
+
+// tool geometry - radius, length wear and radius wear - follows each tool's offsets (see cmToolTable_t)
+// ...and the PWM channel the tool's spindle or laser runs on
+
+#define TOOL_GEOMETRY(n) \
+    { "tt" #n,"tt" #n "rd",_fipc, 5, cm_print_ttrd, cm_get_ttrd, cm_set_ttrd, nullptr, 0 }, \
+    { "tt" #n,"tt" #n "lw",_fipc, 5, cm_print_ttlw, cm_get_ttlw, cm_set_ttlw, nullptr, 0 }, \
+    { "tt" #n,"tt" #n "rw",_fipc, 5, cm_print_ttrw, cm_get_ttrw, cm_set_ttrw, nullptr, 0 }, \
+    { "tt" #n,"tt" #n "pw",_iip,  0, cm_print_ttpw, cm_get_ttpw, cm_set_ttpw, nullptr, TOOL_PWM_CHANNEL },
+
+#define HEATER_CONFIG(n) \
+    { "he" #n,"he" #n "e", _bip, 0, tx_print_nul, cm_get_heater_enable,   cm_set_heater_enable,   nullptr, H ## n ## _DEFAULT_ENABLE }, \
+    { "he" #n,"he" #n "at",_b0,  0, tx_print_nul, cm_get_at_temperature,  set_ro,                 nullptr, 0 }, \
+    { "he" #n,"he" #n "p", _fip, 3, tx_print_nul, cm_get_heater_p,        cm_set_heater_p,        nullptr, H ## n ## _DEFAULT_P }, \
+    { "he" #n,"he" #n "i", _fip, 5, tx_print_nul, cm_get_heater_i,        cm_set_heater_i,        nullptr, H ## n ## _DEFAULT_I }, \
+    { "he" #n,"he" #n "d", _fip, 5, tx_print_nul, cm_get_heater_d,        cm_set_heater_d,        nullptr, H ## n ## _DEFAULT_D }, \
+    { "he" #n,"he" #n "tu",_f0,  1, tx_print_nul, cm_get_heater_autotune, cm_set_heater_autotune, nullptr, 0 }, \
+    { "he" #n,"he" #n "st",_fi,  1, tx_print_nul, cm_get_set_temperature, cm_set_set_temperature, nullptr, 0 }, \
+    { "he" #n,"he" #n "t", _fi,  1, tx_print_nul, cm_get_temperature,     set_ro,                 nullptr, 0 }, \
+    { "he" #n,"he" #n "op",_fi,  3, tx_print_nul, cm_get_heater_output,   set_ro,                 nullptr, 0 }, \
+    { "he" #n,"he" #n "tr",_fi,  3, tx_print_nul, cm_get_thermistor_resistance, set_ro,           nullptr, 0 }, \
+    { "he" #n,"he" #n "an",_fi,  0, tx_print_nul, cm_get_heater_adc,      set_ro,                 nullptr, 0 }, \
+    { "he" #n,"he" #n "fp",_fi,  1, tx_print_nul, cm_get_fan_power,       cm_set_fan_power,       nullptr, 0 }, \
+    { "he" #n,"he" #n "fm",_fi,  1, tx_print_nul, cm_get_fan_min_power,   cm_set_fan_min_power,   nullptr, 0 }, \
+    { "he" #n,"he" #n "fl",_fi,  1, tx_print_nul, cm_get_fan_low_temp,    cm_set_fan_low_temp,    nullptr, 0 }, \
+    { "he" #n,"he" #n "fh",_fi,  1, tx_print_nul, cm_get_fan_high_temp,   cm_set_fan_high_temp,   nullptr, 0 },
+
 const cfgItem_t cfgArray[] = {
 
     // group token flags p, print_func,   get_func,   set_func, get/set target,    default value
@@ -118,12 +165,24 @@ const cfgItem_t cfgArray[] = {
     { "","stat2",_i0, 0, cm_print_stat, cm_get_stat2,set_ro, nullptr, 0 },    // combined machine state
     { "", "n",   _ii, 0, cm_print_line, cm_get_mline,set_noop,nullptr,0 },    // Model line number
     { "", "line",_ii, 0, cm_print_line, cm_get_line, set_ro, nullptr, 0 },    // Active line number - model or runtime line number
+    { "", "eta", _f0, 0, eta_print_eta, eta_get_eta, set_ro, nullptr, 0 },    // Remaining job time in seconds
+    { "", "psoc",_i0, 0, pso_print_psoc,pso_get_psoc,set_ro, nullptr, 0 },    // position synchronized output firings
+    { "", "syne",_f0, 0, sync_print_syne,sync_get_syne,set_ro, nullptr, 0 },   // sync follower phase error in us
+    { "", "afl", _f0, 3, af_print_afl,  af_get_afl,  set_ro, nullptr, 0 },    // adaptive feed load
+    { "", "aff", _f0, 3, af_print_aff,  af_get_aff,  set_ro, nullptr, 0 },    // adaptive feed factor
+    { "", "load",_f0, 1, ld_print_load, ld_get_load, set_ro, nullptr, 0 },    // CPU load percent - see cpuload.h
+    { "", "ldd", _f0, 1, ld_print_ldd,  ld_get_ldd,  set_ro, nullptr, 0 },    // CPU percent in the DDA interrupt
+    { "", "lde", _f0, 1, ld_print_lde,  ld_get_lde,  set_ro, nullptr, 0 },    // CPU percent in the exec interrupt
+    { "", "ldp", _f0, 1, ld_print_ldp,  ld_get_ldp,  set_ro, nullptr, 0 },    // CPU percent in the forward planning interrupt
+    { "", "ldc", _f0, 1, ld_print_ldc,  ld_get_ldc,  set_ro, nullptr, 0 },    // CPU percent in comms
+    { "", "ldm", _f0, 1, ld_print_ldm,  ld_get_ldm,  set_ro, nullptr, 0 },    // CPU percent in main loop work
     { "", "vel", _f0, 2, cm_print_vel,  cm_get_vel,  set_ro, nullptr, 0 },    // current velocity
     { "", "feed",_f0, 2, cm_print_feed, cm_get_feed, set_ro, nullptr, 0 },    // feed rate
     { "", "macs",_i0, 0, cm_print_macs, cm_get_macs, set_ro, nullptr, 0 },    // raw machine state
     { "", "cycs",_i0, 0, cm_print_cycs, cm_get_cycs, set_ro, nullptr, 0 },    // cycle state
     { "", "mots",_i0, 0, cm_print_mots, cm_get_mots, set_ro, nullptr, 0 },    // motion state
     { "", "hold",_i0, 0, cm_print_hold, cm_get_hold, set_ro, nullptr, 0 },    // feedhold state
+    { "", "hdst",_f0, 3, cm_print_hdst, cm_get_hdst, set_ro, nullptr, 0 },    // predicted hold stopping distance
     { "", "unit",_i0, 0, cm_print_unit, cm_get_unit, set_ro, nullptr, 0 },    // units mode
     { "", "coor",_i0, 0, cm_print_coor, cm_get_coor, set_ro, nullptr, 0 },    // coordinate system
     { "", "momo",_i0, 0, cm_print_momo, cm_get_momo, set_ro, nullptr, 0 },    // motion mode
@@ -190,6 +249,25 @@ const cfgItem_t cfgArray[] = {
     { "prb","prbb",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr, 0 },    // B probe results
     { "prb","prbc",_f0, 5, tx_print_nul, cm_get_prb, set_ro, nullptr, 0 },    // C probe results
 
+    { "prg","prgxn",_f0, 3, tx_print_nul, get_flt, set_flt, (float *)&probe_grid.x_min, 0 },    // grid X minimum
+    { "prg","prgxm",_f0, 3, tx_print_nul, get_flt, set_flt, (float *)&probe_grid.x_max, 0 },    // grid X maximum
+    { "prg","prgyn",_f0, 3, tx_print_nul, get_flt, set_flt, (float *)&probe_grid.y_min, 0 },    // grid Y minimum
+    { "prg","prgym",_f0, 3, tx_print_nul, get_flt, set_flt, (float *)&probe_grid.y_max, 0 },    // grid Y maximum
+    { "prg","prgp", _f0, 3, tx_print_nul, get_flt, set_flt, (float *)&probe_grid.pitch, 0 },    // grid pitch
+    { "prg","prgzc",_f0, 3, tx_print_nul, get_flt, set_flt, (float *)&probe_grid.z_clear, 0 },  // grid Z travel height
+    { "prg","prgzp",_f0, 3, tx_print_nul, get_flt, set_flt, (float *)&probe_grid.z_probe, 0 },  // grid Z probe target
+    { "prg","prgf", _f0, 0, tx_print_nul, get_flt, set_flt, (float *)&probe_grid.feed_rate, 0 },// grid probe feed rate
+    { "prg","prgn", _i0, 0, tx_print_nul, cm_get_prgn, set_ro, nullptr, 0 },   // grid points probed
+    { "prg","prgs", _i0, 0, tx_print_nul, get_nul, cm_run_prgs, nullptr, 0 },  // start grid probing
+    { "","prgd",_i0, 0, tx_print_nul, cm_get_prgd, set_ro, nullptr, 0 },      // send grid results (not in prg group)
+
+    { "tls","tlsx",_fipc, 3, tx_print_nul, cm_get_tls, cm_set_tls, nullptr, TOOL_SETTER_X },      // tool setter X
+    { "tls","tlsy",_fipc, 3, tx_print_nul, cm_get_tls, cm_set_tls, nullptr, TOOL_SETTER_Y },      // tool setter Y
+    { "tls","tlsc",_fipc, 3, tx_print_nul, cm_get_tls, cm_set_tls, nullptr, TOOL_SETTER_Z_CLEAR },// Z travel height
+    { "tls","tlsp",_fipc, 3, tx_print_nul, cm_get_tls, cm_set_tls, nullptr, TOOL_SETTER_Z_PROBE },// Z probe target
+    { "tls","tlsf",_fipc, 0, tx_print_nul, cm_get_tls, cm_set_tls, nullptr, TOOL_SETTER_FEED },   // fast touch feed rate
+    { "tls","tlsr",_fipc, 3, tx_print_nul, cm_get_tls, cm_set_tls, nullptr, TOOL_SETTER_Z_REFERENCE }, // contact Z of a zero length tool
+
     { "jog","jogx",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr, 0},    // jog in X axis
     { "jog","jogy",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr, 0},    // jog in Y axis
     { "jog","jogz",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr, 0},    // jog in Z axis
@@ -200,6 +278,16 @@ const cfgItem_t cfgArray[] = {
     { "jog","jogb",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr, 0},    // jog in B axis
     { "jog","jogc",_f0, 0, tx_print_nul, get_nul, cm_run_jog, nullptr, 0},    // jog in C axis
 
+    { "jgv","jgvx",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr, 0},    // velocity jog in X axis
+    { "jgv","jgvy",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr, 0},    // velocity jog in Y axis
+    { "jgv","jgvz",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr, 0},    // velocity jog in Z axis
+    { "jgv","jgvu",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr, 0},    // velocity jog in U axis
+    { "jgv","jgvv",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr, 0},    // velocity jog in V axis
+    { "jgv","jgvw",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr, 0},    // velocity jog in W axis
+    { "jgv","jgva",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr, 0},    // velocity jog in A axis
+    { "jgv","jgvb",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr, 0},    // velocity jog in B axis
+    { "jgv","jgvc",_f0, 0, tx_print_nul, get_nul, cm_run_jgv, nullptr, 0},    // velocity jog in C axis
+
 	{ "pwr","pwr1",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr, 0},	  // motor power readouts
 	{ "pwr","pwr2",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr, 0},
 #if (MOTORS > 2)
@@ -214,6 +302,15 @@ const cfgItem_t cfgArray[] = {
 #if (MOTORS > 5)
 	{ "pwr","pwr6",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr, 0},
 #endif
+#if (MOTORS > 6)
+	{ "pwr","pwr7",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr, 0},
+#endif
+#if (MOTORS > 7)
+	{ "pwr","pwr8",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr, 0},
+#endif
+#if (MOTORS > 8)
+	{ "pwr","pwr9",_f0, 3, st_print_pwr, st_get_pwr, set_ro, nullptr, 0},
+#endif
 
     // Motor parameters
     { "1","1ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr, M1_MOTOR_MAP },
@@ -224,8 +321,17 @@ const cfgItem_t cfgArray[] = {
     { "1","1po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr, M1_POLARITY },
     { "1","1pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr, M1_POWER_MODE },
     { "1","1pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr, M1_POWER_LEVEL },
+    { "1","1ec",_fip, 3, st_print_ec, st_get_ec, st_set_ec, nullptr, M1_ENCODER_COUNTS_PER_STEP },
     { "1","1ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr, M1_ENABLE_POLARITY },
     { "1","1sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr, M1_STEP_POLARITY },
+    { "1","1sm",_iip, 0, st_print_sm, st_get_sm, st_set_sm, nullptr, M1_STALL_MODE },
+    { "1","1sg",_fip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr, M1_STALL_THRESHOLD },
+    { "1","1sq",_fipc,3, st_print_sq, st_get_sq, st_set_sq, nullptr, M1_SQUARING_OFFSET },
+    { "1","1ost",_fp,  0, st_print_ost, st_get_ost, st_set_ost, nullptr, 0 },      // motor odometers - see stepper.h
+    { "1","1orv",_fp,  0, st_print_orv, st_get_orv, st_set_orv, nullptr, 0 },
+    { "1","1oen",_fp,  2, st_print_oen, st_get_oen, st_set_oen, nullptr, 0 },
+    { "1","1opw",_fp,  2, st_print_opw, st_get_opw, st_set_opw, nullptr, 0 },
+    { "1","1opk",_fp,  0, st_print_opk, st_get_opk, st_set_opk, nullptr, 0 },
 //  { "1","1pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_1].power_idle,     M1_POWER_IDLE },
 //  { "1","1mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt, (float *)&st_cfg.mot[MOTOR_1].motor_timeout,  M1_MOTOR_TIMEOUT },
 #if (MOTORS >= 2)
@@ -237,8 +343,17 @@ const cfgItem_t cfgArray[] = {
     { "2","2po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr, M2_POLARITY },
     { "2","2pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr, M2_POWER_MODE },
     { "2","2pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr, M2_POWER_LEVEL},
+    { "2","2ec",_fip, 3, st_print_ec, st_get_ec, st_set_ec, nullptr, M2_ENCODER_COUNTS_PER_STEP },
     { "2","2ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr, M2_ENABLE_POLARITY },
     { "2","2sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr, M2_STEP_POLARITY },
+    { "2","2sm",_iip, 0, st_print_sm, st_get_sm, st_set_sm, nullptr, M2_STALL_MODE },
+    { "2","2sg",_fip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr, M2_STALL_THRESHOLD },
+    { "2","2sq",_fipc,3, st_print_sq, st_get_sq, st_set_sq, nullptr, M2_SQUARING_OFFSET },
+    { "2","2ost",_fp,  0, st_print_ost, st_get_ost, st_set_ost, nullptr, 0 },
+    { "2","2orv",_fp,  0, st_print_orv, st_get_orv, st_set_orv, nullptr, 0 },
+    { "2","2oen",_fp,  2, st_print_oen, st_get_oen, st_set_oen, nullptr, 0 },
+    { "2","2opw",_fp,  2, st_print_opw, st_get_opw, st_set_opw, nullptr, 0 },
+    { "2","2opk",_fp,  0, st_print_opk, st_get_opk, st_set_opk, nullptr, 0 },
 //  { "2","2pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_2].power_idle,     M2_POWER_IDLE },
 //  { "2","2mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt,  float *)&st_cfg.mot[MOTOR_2].motor_timeout,  M2_MOTOR_TIMEOUT },
 #endif
@@ -251,8 +366,17 @@ const cfgItem_t cfgArray[] = {
     { "3","3po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr, M3_POLARITY },
     { "3","3pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr, M3_POWER_MODE },
     { "3","3pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr, M3_POWER_LEVEL },
+    { "3","3ec",_fip, 3, st_print_ec, st_get_ec, st_set_ec, nullptr, M3_ENCODER_COUNTS_PER_STEP },
     { "3","3ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr, M3_ENABLE_POLARITY },
     { "3","3sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr, M3_STEP_POLARITY },
+    { "3","3sm",_iip, 0, st_print_sm, st_get_sm, st_set_sm, nullptr, M3_STALL_MODE },
+    { "3","3sg",_fip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr, M3_STALL_THRESHOLD },
+    { "3","3sq",_fipc,3, st_print_sq, st_get_sq, st_set_sq, nullptr, M3_SQUARING_OFFSET },
+    { "3","3ost",_fp,  0, st_print_ost, st_get_ost, st_set_ost, nullptr, 0 },
+    { "3","3orv",_fp,  0, st_print_orv, st_get_orv, st_set_orv, nullptr, 0 },
+    { "3","3oen",_fp,  2, st_print_oen, st_get_oen, st_set_oen, nullptr, 0 },
+    { "3","3opw",_fp,  2, st_print_opw, st_get_opw, st_set_opw, nullptr, 0 },
+    { "3","3opk",_fp,  0, st_print_opk, st_get_opk, st_set_opk, nullptr, 0 },
 //  { "3","3pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_3].power_idle,     M3_POWER_IDLE },
 //  { "3","3mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt, (float *)&st_cfg.mot[MOTOR_3].motor_timeout,  M3_MOTOR_TIMEOUT },
 #endif
@@ -265,8 +389,17 @@ const cfgItem_t cfgArray[] = {
     { "4","4po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr, M4_POLARITY },
     { "4","4pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr, M4_POWER_MODE },
     { "4","4pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr, M4_POWER_LEVEL },
+    { "4","4ec",_fip, 3, st_print_ec, st_get_ec, st_set_ec, nullptr, M4_ENCODER_COUNTS_PER_STEP },
     { "4","4ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr, M4_ENABLE_POLARITY },
     { "4","4sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr, M4_STEP_POLARITY },
+    { "4","4sm",_iip, 0, st_print_sm, st_get_sm, st_set_sm, nullptr, M4_STALL_MODE },
+    { "4","4sg",_fip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr, M4_STALL_THRESHOLD },
+    { "4","4sq",_fipc,3, st_print_sq, st_get_sq, st_set_sq, nullptr, M4_SQUARING_OFFSET },
+    { "4","4ost",_fp,  0, st_print_ost, st_get_ost, st_set_ost, nullptr, 0 },
+    { "4","4orv",_fp,  0, st_print_orv, st_get_orv, st_set_orv, nullptr, 0 },
+    { "4","4oen",_fp,  2, st_print_oen, st_get_oen, st_set_oen, nullptr, 0 },
+    { "4","4opw",_fp,  2, st_print_opw, st_get_opw, st_set_opw, nullptr, 0 },
+    { "4","4opk",_fp,  0, st_print_opk, st_get_opk, st_set_opk, nullptr, 0 },
 //  { "4","4pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_4].power_idle,     M4_POWER_IDLE },
 //  { "4","4mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt, (float *)&st_cfg.mot[MOTOR_4].motor_timeout,  M4_MOTOR_TIMEOUT },
 #endif
@@ -279,8 +412,17 @@ const cfgItem_t cfgArray[] = {
     { "5","5po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr, M5_POLARITY },
     { "5","5pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr, M5_POWER_MODE },
     { "5","5pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr, M5_POWER_LEVEL },
+    { "5","5ec",_fip, 3, st_print_ec, st_get_ec, st_set_ec, nullptr, M5_ENCODER_COUNTS_PER_STEP },
     { "5","5ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr, M5_ENABLE_POLARITY },
     { "5","5sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr, M5_STEP_POLARITY },
+    { "5","5sm",_iip, 0, st_print_sm, st_get_sm, st_set_sm, nullptr, M5_STALL_MODE },
+    { "5","5sg",_fip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr, M5_STALL_THRESHOLD },
+    { "5","5sq",_fipc,3, st_print_sq, st_get_sq, st_set_sq, nullptr, M5_SQUARING_OFFSET },
+    { "5","5ost",_fp,  0, st_print_ost, st_get_ost, st_set_ost, nullptr, 0 },
+    { "5","5orv",_fp,  0, st_print_orv, st_get_orv, st_set_orv, nullptr, 0 },
+    { "5","5oen",_fp,  2, st_print_oen, st_get_oen, st_set_oen, nullptr, 0 },
+    { "5","5opw",_fp,  2, st_print_opw, st_get_opw, st_set_opw, nullptr, 0 },
+    { "5","5opk",_fp,  0, st_print_opk, st_get_opk, st_set_opk, nullptr, 0 },
 //  { "5","5pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_5].power_idle,     M5_POWER_IDLE },
 //  { "5","5mt",_fip, 2, st_print_mt, get_flt, st_set_mt,   (float *)&st_cfg.mot[MOTOR_5].motor_timeout,  M5_MOTOR_TIMEOUT },
 #endif
@@ -293,11 +435,68 @@ const cfgItem_t cfgArray[] = {
     { "6","6po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr, M6_POLARITY },
     { "6","6pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr, M6_POWER_MODE },
     { "6","6pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr, M6_POWER_LEVEL },
+    { "6","6ec",_fip, 3, st_print_ec, st_get_ec, st_set_ec, nullptr, M6_ENCODER_COUNTS_PER_STEP },
     { "6","6ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr, M6_ENABLE_POLARITY },
     { "6","6sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr, M6_STEP_POLARITY },
+    { "6","6sm",_iip, 0, st_print_sm, st_get_sm, st_set_sm, nullptr, M6_STALL_MODE },
+    { "6","6sg",_fip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr, M6_STALL_THRESHOLD },
+    { "6","6sq",_fipc,3, st_print_sq, st_get_sq, st_set_sq, nullptr, M6_SQUARING_OFFSET },
+    { "6","6ost",_fp,  0, st_print_ost, st_get_ost, st_set_ost, nullptr, 0 },
+    { "6","6orv",_fp,  0, st_print_orv, st_get_orv, st_set_orv, nullptr, 0 },
+    { "6","6oen",_fp,  2, st_print_oen, st_get_oen, st_set_oen, nullptr, 0 },
+    { "6","6opw",_fp,  2, st_print_opw, st_get_opw, st_set_opw, nullptr, 0 },
+    { "6","6opk",_fp,  0, st_print_opk, st_get_opk, st_set_opk, nullptr, 0 },
 //  { "6","6pi",_fip, 3, st_print_pi, st_get_pi, st_set_pi, (float *)&st_cfg.mot[MOTOR_6].power_idle,     M6_POWER_IDLE },
 //  { "6","6mt",_fip, 2, st_print_mt, st_get_mt, st_set_mt, (float *)&st_cfg.mot[MOTOR_6].motor_timeout,  M6_MOTOR_TIMEOUT },
 // >>>>>>> refs/heads/edge
+#endif
+#if (MOTORS >= 7)
+    { "7","7ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr, M7_MOTOR_MAP },
+    { "7","7sa",_fip, 3, st_print_sa, st_get_sa, st_set_sa, nullptr, M7_STEP_ANGLE },
+    { "7","7tr",_fipc,5, st_print_tr, st_get_tr, st_set_tr, nullptr, M7_TRAVEL_PER_REV },
+    { "7","7su",_fipi,5, st_print_su, st_get_su, st_set_su, nullptr, M7_STEPS_PER_UNIT },
+    { "7","7mi",_iip, 0, st_print_mi, st_get_mi, st_set_mi, nullptr, M7_MICROSTEPS },
+    { "7","7po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr, M7_POLARITY },
+    { "7","7pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr, M7_POWER_MODE },
+    { "7","7pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr, M7_POWER_LEVEL },
+    { "7","7ec",_fip, 3, st_print_ec, st_get_ec, st_set_ec, nullptr, M7_ENCODER_COUNTS_PER_STEP },
+    { "7","7ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr, M7_ENABLE_POLARITY },
+    { "7","7sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr, M7_STEP_POLARITY },
+    { "7","7sm",_iip, 0, st_print_sm, st_get_sm, st_set_sm, nullptr, M7_STALL_MODE },
+    { "7","7sg",_fip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr, M7_STALL_THRESHOLD },
+    { "7","7sq",_fipc,3, st_print_sq, st_get_sq, st_set_sq, nullptr, M7_SQUARING_OFFSET },
+#endif
+#if (MOTORS >= 8)
+    { "8","8ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr, M8_MOTOR_MAP },
+    { "8","8sa",_fip, 3, st_print_sa, st_get_sa, st_set_sa, nullptr, M8_STEP_ANGLE },
+    { "8","8tr",_fipc,5, st_print_tr, st_get_tr, st_set_tr, nullptr, M8_TRAVEL_PER_REV },
+    { "8","8su",_fipi,5, st_print_su, st_get_su, st_set_su, nullptr, M8_STEPS_PER_UNIT },
+    { "8","8mi",_iip, 0, st_print_mi, st_get_mi, st_set_mi, nullptr, M8_MICROSTEPS },
+    { "8","8po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr, M8_POLARITY },
+    { "8","8pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr, M8_POWER_MODE },
+    { "8","8pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr, M8_POWER_LEVEL },
+    { "8","8ec",_fip, 3, st_print_ec, st_get_ec, st_set_ec, nullptr, M8_ENCODER_COUNTS_PER_STEP },
+    { "8","8ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr, M8_ENABLE_POLARITY },
+    { "8","8sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr, M8_STEP_POLARITY },
+    { "8","8sm",_iip, 0, st_print_sm, st_get_sm, st_set_sm, nullptr, M8_STALL_MODE },
+    { "8","8sg",_fip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr, M8_STALL_THRESHOLD },
+    { "8","8sq",_fipc,3, st_print_sq, st_get_sq, st_set_sq, nullptr, M8_SQUARING_OFFSET },
+#endif
+#if (MOTORS >= 9)
+    { "9","9ma",_iip, 0, st_print_ma, st_get_ma, st_set_ma, nullptr, M9_MOTOR_MAP },
+    { "9","9sa",_fip, 3, st_print_sa, st_get_sa, st_set_sa, nullptr, M9_STEP_ANGLE },
+    { "9","9tr",_fipc,5, st_print_tr, st_get_tr, st_set_tr, nullptr, M9_TRAVEL_PER_REV },
+    { "9","9su",_fipi,5, st_print_su, st_get_su, st_set_su, nullptr, M9_STEPS_PER_UNIT },
+    { "9","9mi",_iip, 0, st_print_mi, st_get_mi, st_set_mi, nullptr, M9_MICROSTEPS },
+    { "9","9po",_iip, 0, st_print_po, st_get_po, st_set_po, nullptr, M9_POLARITY },
+    { "9","9pm",_iip, 0, st_print_pm, st_get_pm, st_set_pm, nullptr, M9_POWER_MODE },
+    { "9","9pl",_fip, 3, st_print_pl, st_get_pl, st_set_pl, nullptr, M9_POWER_LEVEL },
+    { "9","9ec",_fip, 3, st_print_ec, st_get_ec, st_set_ec, nullptr, M9_ENCODER_COUNTS_PER_STEP },
+    { "9","9ep",_iip, 0, st_print_ep, st_get_ep, st_set_ep, nullptr, M9_ENABLE_POLARITY },
+    { "9","9sp",_iip, 0, st_print_sp, st_get_sp, st_set_sp, nullptr, M9_STEP_POLARITY },
+    { "9","9sm",_iip, 0, st_print_sm, st_get_sm, st_set_sm, nullptr, M9_STALL_MODE },
+    { "9","9sg",_fip, 0, st_print_sg, st_get_sg, st_set_sg, nullptr, M9_STALL_THRESHOLD },
+    { "9","9sq",_fipc,3, st_print_sq, st_get_sq, st_set_sq, nullptr, M9_SQUARING_OFFSET },
 #endif
 
     // Axis parameters
@@ -308,7 +507,12 @@ const cfgItem_t cfgArray[] = {
     { "x","xtm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr, X_TRAVEL_MAX },
     { "x","xjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr, X_JERK_MAX },
     { "x","xjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr, X_JERK_HIGH_SPEED },
+    { "x","xac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr, X_ACCEL_MAX },
+    { "x","xbl",_fipc, 4, cm_print_bl, cm_get_bl, cm_set_bl, nullptr, X_BACKLASH },
+    { "x","xsf",_fip,  1, cm_print_sf, cm_get_sf, cm_set_sf, nullptr, X_SHAPER_FREQUENCY },
+    { "x","xsz",_fip,  3, cm_print_sz, cm_get_sz, cm_set_sz, nullptr, X_SHAPER_DAMPING },
     { "x","xhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr, X_HOMING_INPUT },
+    { "x","xhs",_iip,  0, cm_print_hs, cm_get_hs, cm_set_hs, nullptr, X_HOMING_INPUT_2 },
     { "x","xhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr, X_HOMING_DIRECTION },
     { "x","xsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr, X_SEARCH_VELOCITY },
     { "x","xlv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr, X_LATCH_VELOCITY },
@@ -322,7 +526,12 @@ const cfgItem_t cfgArray[] = {
     { "y","ytm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr, Y_TRAVEL_MAX },
     { "y","yjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr, Y_JERK_MAX },
     { "y","yjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr, Y_JERK_HIGH_SPEED },
+    { "y","yac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr, Y_ACCEL_MAX },
+    { "y","ybl",_fipc, 4, cm_print_bl, cm_get_bl, cm_set_bl, nullptr, Y_BACKLASH },
+    { "y","ysf",_fip,  1, cm_print_sf, cm_get_sf, cm_set_sf, nullptr, Y_SHAPER_FREQUENCY },
+    { "y","ysz",_fip,  3, cm_print_sz, cm_get_sz, cm_set_sz, nullptr, Y_SHAPER_DAMPING },
     { "y","yhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr, Y_HOMING_INPUT },
+    { "y","yhs",_iip,  0, cm_print_hs, cm_get_hs, cm_set_hs, nullptr, Y_HOMING_INPUT_2 },
     { "y","yhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr, Y_HOMING_DIRECTION },
     { "y","ysv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr, Y_SEARCH_VELOCITY },
     { "y","ylv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr, Y_LATCH_VELOCITY },
@@ -336,7 +545,12 @@ const cfgItem_t cfgArray[] = {
     { "z","ztm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr, Z_TRAVEL_MAX },
     { "z","zjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr, Z_JERK_MAX },
     { "z","zjh",_fipc, 0, cm_print_jh, cm_get_jm, cm_set_jh, nullptr, Z_JERK_HIGH_SPEED },
+    { "z","zac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr, Z_ACCEL_MAX },
+    { "z","zbl",_fipc, 4, cm_print_bl, cm_get_bl, cm_set_bl, nullptr, Z_BACKLASH },
+    { "z","zsf",_fip,  1, cm_print_sf, cm_get_sf, cm_set_sf, nullptr, Z_SHAPER_FREQUENCY },
+    { "z","zsz",_fip,  3, cm_print_sz, cm_get_sz, cm_set_sz, nullptr, Z_SHAPER_DAMPING },
     { "z","zhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr, Z_HOMING_INPUT },
+    { "z","zhs",_iip,  0, cm_print_hs, cm_get_hs, cm_set_hs, nullptr, Z_HOMING_INPUT_2 },
     { "z","zhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr, Z_HOMING_DIRECTION },
     { "z","zsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr, Z_SEARCH_VELOCITY },
     { "z","zlv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr, Z_LATCH_VELOCITY },
@@ -350,7 +564,10 @@ const cfgItem_t cfgArray[] = {
     { "u","utm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr, U_TRAVEL_MAX },
     { "u","ujm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr, U_JERK_MAX },
     { "u","ujh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr, U_JERK_HIGH_SPEED },
+    { "u","uac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr, U_ACCEL_MAX },
+    { "u","ubl",_fipc, 4, cm_print_bl, cm_get_bl, cm_set_bl, nullptr, U_BACKLASH },
     { "u","uhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr, U_HOMING_INPUT },
+    { "u","uhs",_iip,  0, cm_print_hs, cm_get_hs, cm_set_hs, nullptr, U_HOMING_INPUT_2 },
     { "u","uhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr, U_HOMING_DIRECTION },
     { "u","usv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr, U_SEARCH_VELOCITY },
     { "u","ulv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr, U_LATCH_VELOCITY },
@@ -364,7 +581,10 @@ const cfgItem_t cfgArray[] = {
     { "v","vtm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr, V_TRAVEL_MAX },
     { "v","vjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr, V_JERK_MAX },
     { "v","vjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr, V_JERK_HIGH_SPEED },
+    { "v","vac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr, V_ACCEL_MAX },
+    { "v","vbl",_fipc, 4, cm_print_bl, cm_get_bl, cm_set_bl, nullptr, V_BACKLASH },
     { "v","vhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr, V_HOMING_INPUT },
+    { "v","vhs",_iip,  0, cm_print_hs, cm_get_hs, cm_set_hs, nullptr, V_HOMING_INPUT_2 },
     { "v","vhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr, V_HOMING_DIRECTION },
     { "v","vsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr, V_SEARCH_VELOCITY },
     { "v","vlv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr, V_LATCH_VELOCITY },
@@ -378,7 +598,10 @@ const cfgItem_t cfgArray[] = {
     { "w","wtm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr, W_TRAVEL_MAX },
     { "w","wjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr, W_JERK_MAX },
     { "w","wjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr, W_JERK_HIGH_SPEED },
+    { "w","wac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr, W_ACCEL_MAX },
+    { "w","wbl",_fipc, 4, cm_print_bl, cm_get_bl, cm_set_bl, nullptr, W_BACKLASH },
     { "w","whi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr, W_HOMING_INPUT },
+    { "w","whs",_iip,  0, cm_print_hs, cm_get_hs, cm_set_hs, nullptr, W_HOMING_INPUT_2 },
     { "w","whd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr, W_HOMING_DIRECTION },
     { "w","wsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr, W_SEARCH_VELOCITY },
     { "w","wlv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr, W_LATCH_VELOCITY },
@@ -392,8 +615,11 @@ const cfgItem_t cfgArray[] = {
     { "a","atm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr, A_TRAVEL_MAX },
     { "a","ajm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr, A_JERK_MAX },
     { "a","ajh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr, A_JERK_HIGH_SPEED },
+    { "a","aac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr, A_ACCEL_MAX },
+    { "a","abl",_fipc, 4, cm_print_bl, cm_get_bl, cm_set_bl, nullptr, A_BACKLASH },
     { "a","ara",_fipc, 5, cm_print_ra, cm_get_ra, cm_set_ra, nullptr, A_RADIUS},
     { "a","ahi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr, A_HOMING_INPUT },
+    { "a","ahs",_iip,  0, cm_print_hs, cm_get_hs, cm_set_hs, nullptr, A_HOMING_INPUT_2 },
     { "a","ahd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr, A_HOMING_DIRECTION },
     { "a","asv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr, A_SEARCH_VELOCITY },
     { "a","alv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr, A_LATCH_VELOCITY },
@@ -407,8 +633,11 @@ const cfgItem_t cfgArray[] = {
     { "b","btm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr, B_TRAVEL_MAX },
     { "b","bjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr, B_JERK_MAX },
     { "b","bjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr, B_JERK_HIGH_SPEED },
+    { "b","bac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr, B_ACCEL_MAX },
+    { "b","bbl",_fipc, 4, cm_print_bl, cm_get_bl, cm_set_bl, nullptr, B_BACKLASH },
     { "b","bra",_fipc, 5, cm_print_ra, cm_get_ra, cm_set_ra, nullptr, B_RADIUS },
     { "b","bhi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr, B_HOMING_INPUT },
+    { "b","bhs",_iip,  0, cm_print_hs, cm_get_hs, cm_set_hs, nullptr, B_HOMING_INPUT_2 },
     { "b","bhd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr, B_HOMING_DIRECTION },
     { "b","bsv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr, B_SEARCH_VELOCITY },
     { "b","blv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr, B_LATCH_VELOCITY },
@@ -422,8 +651,11 @@ const cfgItem_t cfgArray[] = {
     { "c","ctm",_fipc, 5, cm_print_tm, cm_get_tm, cm_set_tm, nullptr, C_TRAVEL_MAX },
     { "c","cjm",_fipc, 0, cm_print_jm, cm_get_jm, cm_set_jm, nullptr, C_JERK_MAX },
     { "c","cjh",_fipc, 0, cm_print_jh, cm_get_jh, cm_set_jh, nullptr, C_JERK_HIGH_SPEED },
+    { "c","cac",_fipc, 0, cm_print_ac, cm_get_ac, cm_set_ac, nullptr, C_ACCEL_MAX },
+    { "c","cbl",_fipc, 4, cm_print_bl, cm_get_bl, cm_set_bl, nullptr, C_BACKLASH },
     { "c","cra",_fipc, 5, cm_print_ra, cm_get_ra, cm_set_ra, nullptr, C_RADIUS },
     { "c","chi",_iip,  0, cm_print_hi, cm_get_hi, cm_set_hi, nullptr, C_HOMING_INPUT },
+    { "c","chs",_iip,  0, cm_print_hs, cm_get_hs, cm_set_hs, nullptr, C_HOMING_INPUT_2 },
     { "c","chd",_iip,  0, cm_print_hd, cm_get_hd, cm_set_hd, nullptr, C_HOMING_DIRECTION },
     { "c","csv",_fipc, 0, cm_print_sv, cm_get_sv, cm_set_sv, nullptr, C_SEARCH_VELOCITY },
     { "c","clv",_fipc, 2, cm_print_lv, cm_get_lv, cm_set_lv, nullptr, C_LATCH_VELOCITY },
@@ -545,67 +777,52 @@ const cfgItem_t cfgArray[] = {
     { "p1","p1wpl",_fip, 3, pwm_print_p1wpl, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].ccw_phase_lo, P1_CCW_PHASE_LO },
     { "p1","p1wph",_fip, 3, pwm_print_p1wph, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].ccw_phase_hi, P1_CCW_PHASE_HI },
     { "p1","p1pof",_fip, 3, pwm_print_p1pof, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_1].phase_off,    P1_PWM_PHASE_OFF },
+    { "p2","p2frq",_fip, 0, pwm_print_p2frq, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].frequency,    P2_PWM_FREQUENCY },
+    { "p2","p2csl",_fip, 0, pwm_print_p2csl, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].cw_speed_lo,  P2_CW_SPEED_LO },
+    { "p2","p2csh",_fip, 0, pwm_print_p2csh, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].cw_speed_hi,  P2_CW_SPEED_HI },
+    { "p2","p2cpl",_fip, 3, pwm_print_p2cpl, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].cw_phase_lo,  P2_CW_PHASE_LO },
+    { "p2","p2cph",_fip, 3, pwm_print_p2cph, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].cw_phase_hi,  P2_CW_PHASE_HI },
+    { "p2","p2wsl",_fip, 0, pwm_print_p2wsl, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].ccw_speed_lo, P2_CCW_SPEED_LO },
+    { "p2","p2wsh",_fip, 0, pwm_print_p2wsh, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].ccw_speed_hi, P2_CCW_SPEED_HI },
+    { "p2","p2wpl",_fip, 3, pwm_print_p2wpl, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].ccw_phase_lo, P2_CCW_PHASE_LO },
+    { "p2","p2wph",_fip, 3, pwm_print_p2wph, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].ccw_phase_hi, P2_CCW_PHASE_HI },
+    { "p2","p2pof",_fip, 3, pwm_print_p2pof, get_flt, pwm_set_pwm,(float *)&pwm.c[PWM_2].phase_off,    P2_PWM_PHASE_OFF },
+
+    // temperature configs - one set of pid and he entries per heater (HEATERS is set in hardware.h)
+    // NOTICE: If you change these heater or PID group keys, you MUST change the get/set functions too!
+    PID_CONFIG(1)
+#if (HEATERS >= 2)
+    PID_CONFIG(2)
+#endif
+#if (HEATERS >= 3)
+    PID_CONFIG(3)
+#endif
+#if (HEATERS >= 4)
+    PID_CONFIG(4)
+#endif
+#if (HEATERS >= 5)
+    PID_CONFIG(5)
+#endif
+#if (HEATERS >= 6)
+    PID_CONFIG(6)
+#endif
 
-    // temperature configs - pid active values (read-only)
-    // NOTICE: If you change these PID group keys, you MUST change the get/set functions too!
-    { "pid1","pid1p",_fip, 3, tx_print_nul, cm_get_pid_p, set_ro, nullptr, 0 },
-    { "pid1","pid1i",_fip, 5, tx_print_nul, cm_get_pid_i, set_ro, nullptr, 0 },
-    { "pid1","pid1d",_fip, 5, tx_print_nul, cm_get_pid_d, set_ro, nullptr, 0 },
-
-    { "pid2","pid2p",_fip, 3, tx_print_nul, cm_get_pid_p, set_ro, nullptr, 0 },
-    { "pid2","pid2i",_fip, 5, tx_print_nul, cm_get_pid_i, set_ro, nullptr, 0 },
-    { "pid2","pid2d",_fip, 5, tx_print_nul, cm_get_pid_d, set_ro, nullptr, 0 },
-
-    { "pid3","pid3p",_fip, 3, tx_print_nul, cm_get_pid_p, set_ro, nullptr, 0 },
-    { "pid3","pid3i",_fip, 5, tx_print_nul, cm_get_pid_i, set_ro, nullptr, 0 },
-    { "pid3","pid3d",_fip, 5, tx_print_nul, cm_get_pid_d, set_ro, nullptr, 0 },
-
-    // temperature configs - heater set values (read-write)
-    // NOTICE: If you change these heater group keys, you MUST change the get/set functions too!
-    { "he1","he1e", _bip, 0, tx_print_nul, cm_get_heater_enable,   cm_set_heater_enable,   nullptr, H1_DEFAULT_ENABLE },
-    { "he1","he1at",_b0,  0, tx_print_nul, cm_get_at_temperature,  set_ro,                 nullptr, 0 },
-    { "he1","he1p", _fip, 3, tx_print_nul, cm_get_heater_p,        cm_set_heater_p,        nullptr, H1_DEFAULT_P },
-    { "he1","he1i", _fip, 5, tx_print_nul, cm_get_heater_i,        cm_set_heater_i,        nullptr, H1_DEFAULT_I },
-    { "he1","he1d", _fip, 5, tx_print_nul, cm_get_heater_d,        cm_set_heater_d,        nullptr, H1_DEFAULT_D },
-    { "he1","he1st",_fi,  1, tx_print_nul, cm_get_set_temperature, cm_set_set_temperature, nullptr, 0 },
-    { "he1","he1t", _fi,  1, tx_print_nul, cm_get_temperature,     set_ro,                 nullptr, 0 },
-    { "he1","he1op",_fi,  3, tx_print_nul, cm_get_heater_output,   set_ro,                 nullptr, 0 },
-    { "he1","he1tr",_fi,  3, tx_print_nul, cm_get_thermistor_resistance, set_ro,           nullptr, 0 },
-    { "he1","he1an",_fi,  0, tx_print_nul, cm_get_heater_adc,      set_ro,                 nullptr, 0 },
-    { "he1","he1fp",_fi,  1, tx_print_nul, cm_get_fan_power,       cm_set_fan_power,       nullptr, 0 },
-    { "he1","he1fm",_fi,  1, tx_print_nul, cm_get_fan_min_power,   cm_set_fan_min_power,   nullptr, 0 },
-    { "he1","he1fl",_fi,  1, tx_print_nul, cm_get_fan_low_temp,    cm_set_fan_low_temp,    nullptr, 0 },
-    { "he1","he1fh",_fi,  1, tx_print_nul, cm_get_fan_high_temp,   cm_set_fan_high_temp,   nullptr, 0 },
-
-    { "he2","he2e", _iip, 0, tx_print_nul, cm_get_heater_enable,   cm_set_heater_enable,   nullptr, H2_DEFAULT_ENABLE },
-    { "he2","he2at",_b0,  0, tx_print_nul, cm_get_at_temperature,  set_ro,                 nullptr, 0 },
-    { "he2","he2p", _fip, 3, tx_print_nul, cm_get_heater_p,        cm_set_heater_p,        nullptr, H2_DEFAULT_P },
-    { "he2","he2i", _fip, 5, tx_print_nul, cm_get_heater_i,        cm_set_heater_i,        nullptr, H2_DEFAULT_I },
-    { "he2","he2d", _fip, 5, tx_print_nul, cm_get_heater_d,        cm_set_heater_d,        nullptr, H2_DEFAULT_D },
-    { "he2","he2st",_fi,  0, tx_print_nul, cm_get_set_temperature, cm_set_set_temperature, nullptr, 0 },
-    { "he2","he2t", _fi,  1, tx_print_nul, cm_get_temperature,     set_ro,                 nullptr, 0 },
-    { "he2","he2op",_fi,  3, tx_print_nul, cm_get_heater_output,   set_ro,                 nullptr, 0 },
-    { "he2","he2tr",_fi,  3, tx_print_nul, cm_get_thermistor_resistance, set_ro,           nullptr, 0 },
-    { "he2","he2an",_fi,  0, tx_print_nul, cm_get_heater_adc,      set_ro,                 nullptr, 0 },
-    { "he2","he2fp",_fi,  1, tx_print_nul, cm_get_fan_power,       cm_set_fan_power,       nullptr, 0 },
-    { "he2","he2fm",_fi,  1, tx_print_nul, cm_get_fan_min_power,   cm_set_fan_min_power,   nullptr, 0 },
-    { "he2","he2fl",_fi,  1, tx_print_nul, cm_get_fan_low_temp,    cm_set_fan_low_temp,    nullptr, 0 },
-    { "he2","he2fh",_fi,  1, tx_print_nul, cm_get_fan_high_temp,   cm_set_fan_high_temp,   nullptr, 0 },
-
-    { "he3","he3e", _iip, 0, tx_print_nul, cm_get_heater_enable,   cm_set_heater_enable,   nullptr, H3_DEFAULT_ENABLE },
-    { "he3","he3at",_b0,  0, tx_print_nul, cm_get_at_temperature,  set_ro,                 nullptr, 0 },
-    { "he3","he3p", _fip, 3, tx_print_nul, cm_get_heater_p,        cm_set_heater_p,        nullptr, H3_DEFAULT_P },
-    { "he3","he3i", _fip, 5, tx_print_nul, cm_get_heater_i,        cm_set_heater_i,        nullptr, H3_DEFAULT_I },
-    { "he3","he3d", _fip, 5, tx_print_nul, cm_get_heater_d,        cm_set_heater_d,        nullptr, H3_DEFAULT_D },
-    { "he3","he3st",_fi,  0, tx_print_nul, cm_get_set_temperature, cm_set_set_temperature, nullptr, 0 },
-    { "he3","he3t", _fi,  1, tx_print_nul, cm_get_temperature,     set_ro,                 nullptr, 0 },
-    { "he3","he3op",_fi,  3, tx_print_nul, cm_get_heater_output,   set_ro,                 nullptr, 0 },
-    { "he3","he3tr",_fi,  3, tx_print_nul, cm_get_thermistor_resistance, set_ro,           nullptr, 0 },
-    { "he3","he3an",_fi,  0, tx_print_nul, cm_get_heater_adc,      set_ro,                 nullptr, 0 },
-    { "he3","he3fp",_fi,  1, tx_print_nul, cm_get_fan_power,       cm_set_fan_power,       nullptr, 0 },
-    { "he3","he3fm",_fi,  1, tx_print_nul, cm_get_fan_min_power,   cm_set_fan_min_power,   nullptr, 0 },
-    { "he3","he3fl",_fi,  1, tx_print_nul, cm_get_fan_low_temp,    cm_set_fan_low_temp,    nullptr, 0 },
-    { "he3","he3fh",_fi,  1, tx_print_nul, cm_get_fan_high_temp,   cm_set_fan_high_temp,   nullptr, 0 },
+    HEATER_CONFIG(1)
+#if (HEATERS >= 2)
+    HEATER_CONFIG(2)
+#endif
+#if (HEATERS >= 3)
+    HEATER_CONFIG(3)
+#endif
+#if (HEATERS >= 4)
+    HEATER_CONFIG(4)
+#endif
+#if (HEATERS >= 5)
+    HEATER_CONFIG(5)
+#endif
+#if (HEATERS >= 6)
+    HEATER_CONFIG(6)
+#endif
 
     // Coordinate system offsets (G54-G59 and G92)
     { "g54","g54x",_fipc, 5, cm_print_cofs, cm_get_coord, cm_set_coord, nullptr, G54_X_OFFSET },
@@ -709,17 +926,26 @@ const cfgItem_t cfgArray[] = {
     { "sp","spmo", _iip, 0, sp_print_spmo, sp_get_spmo, sp_set_spmo, nullptr, SPINDLE_MODE },
     { "sp","spph", _bip, 0, sp_print_spph, sp_get_spph, sp_set_spph, nullptr, SPINDLE_PAUSE_ON_HOLD },
     { "sp","spde", _fip, 2, sp_print_spde, sp_get_spde, sp_set_spde, nullptr, SPINDLE_SPINUP_DELAY },
+    { "sp","spup", _bip, 0, sp_print_spup, sp_get_spup, sp_set_spup, nullptr, SPINDLE_SPINUP_OVERLAP },
     { "sp","spsn", _fip, 2, sp_print_spsn, sp_get_spsn, sp_set_spsn, nullptr, SPINDLE_SPEED_MIN},
     { "sp","spsm", _fip, 2, sp_print_spsm, sp_get_spsm, sp_set_spsm, nullptr, SPINDLE_SPEED_MAX},
+    { "sp","sptp", _fip, 1, sp_print_sptp, sp_get_sptp, sp_set_sptp, nullptr, SPINDLE_TACH_PPR},
+    { "sp","spat", _fip, 3, sp_print_spat, sp_get_spat, sp_set_spat, nullptr, SPINDLE_AT_SPEED_TOLERANCE},
+    { "sp","spvs", _bip, 0, sp_print_spvs, sp_get_spvs, sp_set_spvs, nullptr, SPINDLE_VELOCITY_SYNC},
+    { "sp","spv0", _fip, 3, sp_print_spv0, sp_get_spv0, sp_set_spv0, nullptr, SPINDLE_VELOCITY_POWER_LO},
+    { "sp","spv1", _fip, 3, sp_print_spv1, sp_get_spv1, sp_set_spv1, nullptr, SPINDLE_VELOCITY_POWER_HI},
     { "sp","spep", _iip, 0, sp_print_spep, sp_get_spep, sp_set_spep, nullptr, SPINDLE_ENABLE_POLARITY },
     { "sp","spdp", _iip, 0, sp_print_spdp, sp_get_spdp, sp_set_spdp, nullptr, SPINDLE_DIR_POLARITY },
     { "sp","spoe", _bip, 0, sp_print_spoe, sp_get_spoe, sp_set_spoe, nullptr, SPINDLE_OVERRIDE_ENABLE},
     { "sp","spo",  _fip, 3, sp_print_spo,  sp_get_spo,  sp_set_spo,  nullptr, SPINDLE_OVERRIDE_FACTOR},
+    { "sp","spfl", _bip, 0, sp_print_spfl, sp_get_spfl, sp_set_spfl, nullptr, SPINDLE_FEED_LINK},
     { "sp","spc",  _i0,  0, sp_print_spc,  sp_get_spc,  sp_set_spc,  nullptr, 0 },   // spindle state
     { "sp","sps",  _f0,  0, sp_print_sps,  sp_get_sps,  sp_set_sps,  nullptr, 0 },   // spindle speed
+    { "sp","spsa", _f0,  0, sp_print_spsa, sp_get_spsa, set_ro,      nullptr, 0 },   // spindle speed from the tach
 
     // Coolant functions
     { "co","coph", _bip, 0, co_print_coph, co_get_coph, co_set_coph, nullptr, COOLANT_PAUSE_ON_HOLD },
+    { "co","cosu", _fip, 2, co_print_cosu, co_get_cosu, co_set_cosu, nullptr, COOLANT_SPINUP_DELAY },
     { "co","comp", _iip, 0, co_print_comp, co_get_comp, co_set_comp, nullptr, COOLANT_MIST_POLARITY },
     { "co","cofp", _iip, 0, co_print_cofp, co_get_cofp, co_set_cofp, nullptr, COOLANT_FLOOD_POLARITY },
     { "co","com",  _i0,  0, co_print_com,  co_get_com,  co_set_com,  nullptr, 0 },   // mist coolant enable
@@ -728,16 +954,43 @@ const cfgItem_t cfgArray[] = {
     // General system parameters
     { "sys","jt",  _fipn, 2, cm_print_jt,  cm_get_jt,  cm_set_jt,  nullptr, JUNCTION_INTEGRATION_TIME },
     { "sys","ct",  _fipnc,4, cm_print_ct,  cm_get_ct,  cm_set_ct,  nullptr, CHORDAL_TOLERANCE },
+    { "sys","arcb",_fipn, 0, cm_print_arcb,cm_get_arcb,cm_set_arcb,nullptr, ARC_TIME_BUDGET },
+    { "sys","qt",  _fipn, 0, cm_print_qt,  cm_get_qt,  cm_set_qt,  nullptr, PLANNER_TIME_TARGET },
+    { "sys","mgt", _fipnc,4, cm_print_mgt, cm_get_mgt, cm_set_mgt, nullptr, SEGMENT_MERGE_TOLERANCE },
+    { "sys","plr", _bipn, 0, cm_print_plr, cm_get_plr, cm_set_plr, nullptr, PLANNER_ACCEL_RUNS },
+    { "sys","seg", _fipn, 3, cm_print_seg, cm_get_seg, cm_set_seg, nullptr, MIN_SEGMENT_MS },
+    { "sys","segx",_f0,   1, cm_print_segx,cm_get_segx,cm_set_segx,nullptr, 0 },    // worst case exec + prep in us (write clears)
+    { "sys","ilat",_f0,   1, io_print_ilat,io_get_ilat,io_set_ilat,nullptr, 0 },    // worst case input edge to handler in us (write clears)
     { "sys","zl",  _fipnc,3, cm_print_zl,  cm_get_zl,  cm_set_zl,  nullptr, FEEDHOLD_Z_LIFT },
+    { "sys","prbn",_iipn, 0, cm_print_prbn,cm_get_prbn,cm_set_prbn,nullptr, PROBE_TOUCHES },    // multi-touch probing - see cycle_probing.cpp
+    { "sys","prbk",_fipnc,3, cm_print_prbk,cm_get_prbk,cm_set_prbk,nullptr, PROBE_BACKOFF },
+    { "sys","prbs",_fipnc,0, cm_print_prbs,cm_get_prbs,cm_set_prbs,nullptr, PROBE_SLOW_FEED },
     { "sys","sl",  _bipn, 0, cm_print_sl,  cm_get_sl,  cm_set_sl,  nullptr, SOFT_LIMIT_ENABLE },
+    { "sys","hsm", _bipn, 0, cm_print_hsm, cm_get_hsm, cm_set_hsm, nullptr, HOMING_SIMULTANEOUS },
     { "sys","lim", _bipn, 0, cm_print_lim, cm_get_lim, cm_set_lim, nullptr, HARD_LIMIT_ENABLE },
     { "sys","saf", _bipn, 0, cm_print_saf, cm_get_saf, cm_set_saf, nullptr, SAFETY_INTERLOCK_ENABLE },
     { "sys","m48", _bin, 0, cm_print_m48,  cm_get_m48, cm_get_m48, nullptr, 1 },   // M48/M49 feedrate & spindle override enable
     { "sys","froe",_bin, 0, cm_print_froe, cm_get_froe,cm_get_froe,nullptr, FEED_OVERRIDE_ENABLE},
     { "sys","fro", _fin, 3, cm_print_fro,  cm_get_fro, cm_set_fro, nullptr, FEED_OVERRIDE_FACTOR},
+    { "sys","frm", _iipn, 0, cm_print_frm, cm_get_frm, cm_set_frm, nullptr, FEED_OVERRIDE_MODE},
+    { "sys","rfm", _iipn, 0, cm_print_rfm, cm_get_rfm, cm_set_rfm, nullptr, ROTARY_FEED_MODE},
+    { "sys","shp", _iipn, 0, cm_print_shp, cm_get_shp, cm_set_shp, nullptr, INPUT_SHAPER_TYPE},
     { "sys","troe",_bin, 0, cm_print_troe, cm_get_troe,cm_get_troe,nullptr, TRAVERSE_OVERRIDE_ENABLE},
     { "sys","tro", _fin, 3, cm_print_tro,  cm_get_tro, cm_set_tro, nullptr, TRAVERSE_OVERRIDE_FACTOR},
     { "sys","mt",  _fipn, 2, st_print_mt,  st_get_mt,  st_set_mt,  nullptr, MOTOR_POWER_TIMEOUT}, // N is seconds of timeout
+    { "sys","mcp", _fipn, 3, st_print_mcp, st_get_mcp, st_set_mcp, nullptr, MOTOR_CRUISE_POWER},
+    { "sys","mhp", _fipn, 3, st_print_mhp, st_get_mhp, st_set_mhp, nullptr, MOTOR_HOLD_POWER},
+    { "sys","kin", _iipn, 0, kn_print_kin, kn_get_kin, kn_set_kin, nullptr, KINEMATICS},
+    { "sys","kdl", _fipnc,3, kn_print_kdl, kn_get_kdl, kn_set_kdl, nullptr, DELTA_ROD_LENGTH},
+    { "sys","kdr", _fipnc,3, kn_print_kdr, kn_get_kdr, kn_set_kdr, nullptr, DELTA_RADIUS},
+    { "sys","ksl1",_fipnc,3, kn_print_ksl1,kn_get_ksl1,kn_set_ksl1,nullptr, SCARA_LINK1_LENGTH},
+    { "sys","ksl2",_fipnc,3, kn_print_ksl2,kn_get_ksl2,kn_set_ksl2,nullptr, SCARA_LINK2_LENGTH},
+    { "sys","ktpx",_fipnc,3, kn_print_ktpx,kn_get_ktpx,kn_set_ktpx,nullptr, ROTARY_PIVOT_X},
+    { "sys","ktpy",_fipnc,3, kn_print_ktpy,kn_get_ktpy,kn_set_ktpy,nullptr, ROTARY_PIVOT_Y},
+    { "sys","ktpz",_fipnc,3, kn_print_ktpz,kn_get_ktpz,kn_set_ktpz,nullptr, ROTARY_PIVOT_Z},
+    { "sys","khl", _fipnc,3, kn_print_khl, kn_get_khl, kn_set_khl, nullptr, ROTARY_HEAD_LENGTH},
+    { "sys","hmap",_i0, 0, kn_print_hmap,kn_get_hmap,kn_set_hmap,nullptr, 0 },
+    { "sys","ktol",_fipn, 3, kn_print_ktol,kn_get_ktol,kn_set_ktol,nullptr, KINEMATICS_SEGMENT_TOLERANCE},
     { "",   "me",  _f0,   0, st_print_me,  get_nul,    st_set_me,  nullptr, 0 },    // SET to enable motors
     { "",   "md",  _f0,   0, st_print_md,  get_nul,    st_set_md,  nullptr, 0 },    // SET to disable motors
 
@@ -747,9 +1000,40 @@ const cfgItem_t cfgArray[] = {
 #endif
     { "sys","ej", _iipn, 0, js_print_ej,  js_get_ej, js_set_ej, nullptr, COMM_MODE },
     { "sys","jv", _iipn, 0, js_print_jv,  js_get_jv, js_set_jv, nullptr, JSON_VERBOSITY },
+    { "sys","jab",_iipn, 0, js_print_jab, js_get_jab,js_set_jab,nullptr, JSON_ACK_BATCH },
+    { "sys","txc",_iip,  0, xio_print_txc, xio_get_txc, xio_set_txc, nullptr, XIO_TX_COALESCE },
+    { "sys","lkth",_iipn,0, cs_print_lkth,cs_get_lkth,cs_set_lkth,nullptr, LINK_THROTTLE },
+    { "sys","lkt", _f0,  3, cs_print_lkt, cs_get_lkt, set_ro,     nullptr, 0 },    // measured host link line time in ms
+    { "sys","lkb", _f0,  1, cs_print_lkb, cs_get_lkb, set_ro,     nullptr, 0 },    // measured host line length in bytes
+    { "sys","lcm",_iipn, 0, gc_print_lcm, gc_get_lcm,gc_set_lcm,nullptr, LINE_CHECKSUM_MODE },
     { "sys","qv", _iipn, 0, qr_print_qv,  qr_get_qv, qr_set_qv, nullptr, QUEUE_REPORT_VERBOSITY },
+    { "sys","qvi",_iipn, 0, qr_print_qvi, qr_get_qvi,qr_set_qvi,nullptr, QUEUE_REPORT_INTERVAL_MS },
+    { "sys","qvh",_iipn, 0, qr_print_qvh, qr_get_qvh,qr_set_qvh,nullptr, QUEUE_REPORT_HYSTERESIS },
     { "sys","sv", _iipn, 0, sr_print_sv,  sr_get_sv, sr_set_sv, nullptr, STATUS_REPORT_VERBOSITY },
     { "sys","si", _iipn, 0, sr_print_si,  sr_get_si, sr_set_si, nullptr, STATUS_REPORT_INTERVAL_MS },
+    { "sys","psoi",_fipnc,3, pso_print_psoi,pso_get_psoi,pso_set_psoi,nullptr, PSO_INTERVAL },
+    { "sys","psoa",_iipn, 0, pso_print_psoa,pso_get_psoa,pso_set_psoa,nullptr, PSO_AXES },
+    { "sys","psom",_iipn, 0, pso_print_psom,pso_get_psom,pso_set_psom,nullptr, PSO_MODE },
+    { "sys","psow",_fipn, 1, pso_print_psow,pso_get_psow,pso_set_psow,nullptr, PSO_PULSE_WIDTH },
+    { "sys","psoo",_iipn, 0, pso_print_psoo,pso_get_psoo,pso_set_psoo,nullptr, PSO_OUTPUT },
+    { "sys","syn", _iipn, 0, sync_print_syn, sync_get_syn, sync_set_syn, nullptr, SYNC_MODE },
+    { "sys","synp",_fipn, 1, sync_print_synp,sync_get_synp,sync_set_synp,nullptr, SYNC_PERIOD },
+    { "sys","synk",_iipn, 0, sync_print_synk,sync_get_synk,sync_set_synk,nullptr, SYNC_CLOCK_OUTPUT },
+    { "sys","synr",_iipn, 0, sync_print_synr,sync_get_synr,sync_set_synr,nullptr, SYNC_RUN_OUTPUT },
+    { "sys","afs", _fipn, 3, af_print_afs, af_get_afs, af_set_afs, nullptr, AF_SET_POINT },
+    { "sys","afg", _fipn, 3, af_print_afg, af_get_afg, af_set_afg, nullptr, AF_GAIN },
+    { "sys","afn", _fipn, 3, af_print_afn, af_get_afn, af_set_afn, nullptr, AF_FACTOR_MIN },
+    { "sys","afx", _fipn, 3, af_print_afx, af_get_afx, af_set_afx, nullptr, AF_FACTOR_MAX },
+    { "sys","afi", _iipn, 0, af_print_afi, af_get_afi, af_set_afi, nullptr, AF_INPUT },
+#if SPOOL_ENABLED == true
+    { "sys","spqp",_iipn, 0, spool_print_spqp,spool_get_spqp,spool_set_spqp,nullptr, SPOOL_PALLET_JOB },  // job queue - see spool.h
+    { "sys","spqw",_iipn, 0, spool_print_spqw,spool_get_spqw,spool_set_spqw,nullptr, SPOOL_QUEUE_WAIT },
+#endif
+    { "sys","cki", _fipn, 1, ck_print_cki, ck_get_cki, ck_set_cki, nullptr, CHECKPOINT_INTERVAL },   // job checkpoints - see checkpoint.h
+#if BINARY_MOTION_ENABLED == true
+    { "sys","tlr",_iipn, 0, bm_print_tlr, bm_get_tlr,bm_set_tlr,nullptr, TELEMETRY_RATE },
+    { "sys","tla",_iipn, 0, bm_print_tla, bm_get_tla,bm_set_tla,nullptr, TELEMETRY_AXES },
+#endif
 
     // Gcode defaults
     // NOTE: The ordering within the gcode defaults is important for token resolution. gc must follow gco
@@ -766,9 +1050,19 @@ const cfgItem_t cfgArray[] = {
     { "", "qr",   _n0, 0, qr_print_qr,   qr_get,    set_nul,   nullptr, 0 },    // get queue value - planner buffers available
     { "", "qi",   _n0, 0, qr_print_qi,   qi_get,    set_nul,   nullptr, 0 },    // get queue value - buffers added to queue
     { "", "qo",   _n0, 0, qr_print_qo,   qo_get,    set_nul,   nullptr, 0 },    // get queue value - buffers removed from queue
+    { "", "qp",   _n0, 1, qr_print_qp,   qp_get,    set_nul,   nullptr, 0 },    // get queue value - planned time in queue (ms)
     { "", "er",   _n0, 0, tx_print_nul,  rpt_er,    set_nul,   nullptr, 0 },    // get bogus exception report for testing
     { "", "rx",   _n0, 0, tx_print_int,  get_rx,    set_nul,   nullptr, 0 },    // get RX buffer bytes or packets
     { "", "dw",   _i0, 0, tx_print_int,  st_get_dw, set_noop,  nullptr, 0 },    // get dwell time remaining
+#ifdef __SEGMENT_TRACE
+    { "", "trc",  _i0, 0, tx_print_int,  tr_get,    tr_set,    nullptr, 0 },    // segment trace - see trace.h
+#endif
+#ifdef __LATENCY_TRACE
+    { "", "lat",  _i0, 0, tx_print_int,  lat_get,   lat_set,   nullptr, 0 },    // latency trace - see latency.h
+#endif
+#ifdef __SESSION_CAPTURE
+    { "", "cap",  _i0, 0, tx_print_int,  cap_get,   cap_set,   nullptr, 0 },    // session capture - see capture.h
+#endif
     { "", "msg",  _s0, 0, tx_print_str,  get_nul,   set_noop,  nullptr, 0 },    // no operation on messages
     { "", "alarm",_n0, 0, tx_print_nul,  cm_alrm,   cm_alrm,   nullptr, 0 },    // trigger alarm
     { "", "panic",_n0, 0, tx_print_nul,  cm_pnic,   cm_pnic,   nullptr, 0 },    // trigger panic
@@ -778,7 +1072,63 @@ const cfgItem_t cfgArray[] = {
     { "", "tick", _n0, 0, tx_print_int,  get_tick,  set_nul,   nullptr, 0 },    // get system time tic
     { "", "tram", _b0, 0, cm_print_tram,cm_get_tram,cm_set_tram,nullptr,0 },    // SET to attempt setting rotation matrix from probes
     { "", "defa", _b0, 0, tx_print_nul,  help_defa,set_defaults,nullptr,0 },    // set/print defaults / help screen
+    { "", "cfg",  _s0, 0, tx_print,      get_cfg,  set_cfg,   nullptr, 0 },    // read or restore a configuration snapshot
+    { "", "mpro", _ip, 0, print_mpro,    get_mpro, set_mpro,  nullptr, 0 },    // switch machine profile
     { "", "flash",_b0, 0, tx_print_nul,  help_flash,hw_flash,  nullptr, 0 },
+    { "", "ckl",  _n0, 0, ck_print_ckl, ck_get_ckl, set_nul,   nullptr, 0 },   // line of the stored job checkpoint, 0 if none
+    { "", "ckr",  _b0, 0, tx_print_nul, get_nul,    ck_set_ckr,nullptr, 0 },   // resume the job at the checkpoint
+#if SPOOL_ENABLED == true
+    { "", "spu",  _b0, 0, spool_print_spu, spool_get_spu, spool_set_spu, nullptr, 0 },   // clear the spool and upload job 1 / end an upload
+    { "", "spa",  _b0, 0, spool_print_spu, spool_get_spu, spool_set_spa, nullptr, 0 },   // upload the next job / end an upload
+    { "", "spj",  _n0, 0, spool_print_spj, spool_get_spj, set_nul,       nullptr, 0 },   // spooled jobs
+    { "", "spl",  _n0, 0, spool_print_spl, spool_get_spl, set_nul,       nullptr, 0 },   // last spooled job length, 0 if none
+    { "", "spn",  _n0, 0, spool_print_spn, spool_get_spn, set_nul,       nullptr, 0 },   // last spooled job line count
+    { "", "spr",  _i0, 0, tx_print_nul,    get_nul,       spool_set_spr, nullptr, 0 },   // run spooled job n
+    { "", "spq",  _s0, 0, spool_print_spq, spool_get_spq, spool_set_spq, nullptr, 0 },   // job queue - "1,2,2,3"
+    { "", "spqr", _b0, 0, tx_print_nul,    spool_get_spqr,spool_set_spqr,nullptr, 0 },   // start / stop the job queue
+    { "", "spqs", _i0, 0, spool_print_spqs,spool_get_spqs,set_ro,        nullptr, 0 },   // job queue state
+    { "", "spqi", _i0, 0, spool_print_spqi,spool_get_spqi,set_ro,        nullptr, 0 },   // job queue position
+#endif
+
+    // RX buffer statistics - see xioStats in xio.h
+    { "rxs","rxsb",_n0, 0, xio_print_rxsb, xio_get_rxsb, set_nul,     nullptr, 0 },                   // RAM taken by device buffers
+    { "rxs","rxsd",_n0, 0, xio_print_rxsd, get_int32,    xio_set_rxs, &xio_stats.lines_dropped, 0 },  // lines dropped by flushes
+    { "rxs","rxsl",_n0, 0, xio_print_rxsl, get_int32,    xio_set_rxs, &xio_stats.lines_too_long, 0 }, // lines split for length
+    { "rxs","rxsf",_n0, 0, xio_print_rxsf, get_int32,    xio_set_rxs, &xio_stats.rx_full_ms, 0 },     // ms with an RX buffer full
+    { "rxs","rxsw",_n0, 0, xio_print_rxsw, get_int32,    xio_set_rxs, &xio_stats.tx_writes, 0 },      // writes passed to TX buffers
+    { "rxs","rxsr",_n0, 0, xio_print_rxsr, get_int32,    xio_set_rxs, &xio_stats.tx_lines, 0 },       // lines written
+
+    // RAM map - stack and heap high water and the big static structures - see controller.cpp
+    { "ram","ramss",_n0, 0, cs_print_ramss, cs_get_ramss, set_ro, nullptr, 0 },     // stack region size
+    { "ram","ramsu",_n0, 0, cs_print_ramsu, cs_get_ramsu, set_ro, nullptr, 0 },     // most stack used since boot
+    { "ram","ramhp",_n0, 0, cs_print_ramhp, cs_get_ramhp, set_ro, nullptr, 0 },     // heap in use
+    { "ram","rampq",_n0, 0, cs_print_rampq, cs_get_rampq, set_ro, nullptr, 0 },     // planner queues (mp1_queue, mp2_queue)
+    { "ram","rampr",_n0, 0, cs_print_rampr, cs_get_rampr, set_ro, nullptr, 0 },     // planner runtimes (mr1, mr2)
+    { "ram","ramcm",_n0, 0, cs_print_ramcm, cs_get_ramcm, set_ro, nullptr, 0 },     // canonical machines (cm1, cm2)
+    { "ram","ramnv",_n0, 0, cs_print_ramnv, cs_get_ramnv, set_ro, nullptr, 0 },     // nvObj list (nvl)
+    { "ram","ramcs",_n0, 0, cs_print_ramcs, cs_get_ramcs, set_ro, nullptr, 0 },     // controller and its serial buffers (cs)
+    { "ram","ramxb",_n0, 0, xio_print_rxsb, xio_get_rxsb, set_ro, nullptr, 0 },     // xio device buffers
+
+    // Planner health - see mpHealth in planner.h
+    { "ph","phb0",_n0, 0, mp_print_phb, get_int32, mp_set_ph, &mp_health.buffers[0], 0 },   // blocks started with this queue depth
+    { "ph","phb1",_n0, 0, mp_print_phb, get_int32, mp_set_ph, &mp_health.buffers[1], 0 },   // blocks started with this queue depth
+    { "ph","phb2",_n0, 0, mp_print_phb, get_int32, mp_set_ph, &mp_health.buffers[2], 0 },   // blocks started with this queue depth
+    { "ph","phb3",_n0, 0, mp_print_phb, get_int32, mp_set_ph, &mp_health.buffers[3], 0 },   // blocks started with this queue depth
+    { "ph","phb4",_n0, 0, mp_print_phb, get_int32, mp_set_ph, &mp_health.buffers[4], 0 },   // blocks started with this queue depth
+    { "ph","phb5",_n0, 0, mp_print_phb, get_int32, mp_set_ph, &mp_health.buffers[5], 0 },   // blocks started with this queue depth
+    { "ph","phb6",_n0, 0, mp_print_phb, get_int32, mp_set_ph, &mp_health.buffers[6], 0 },   // blocks started with this queue depth
+    { "ph","phb7",_n0, 0, mp_print_phb, get_int32, mp_set_ph, &mp_health.buffers[7], 0 },   // blocks started with this queue depth
+    { "ph","pht0",_n0, 0, mp_print_pht, get_int32, mp_set_ph, &mp_health.plannable[0], 0 }, // blocks started with this plannable time
+    { "ph","pht1",_n0, 0, mp_print_pht, get_int32, mp_set_ph, &mp_health.plannable[1], 0 }, // blocks started with this plannable time
+    { "ph","pht2",_n0, 0, mp_print_pht, get_int32, mp_set_ph, &mp_health.plannable[2], 0 }, // blocks started with this plannable time
+    { "ph","pht3",_n0, 0, mp_print_pht, get_int32, mp_set_ph, &mp_health.plannable[3], 0 }, // blocks started with this plannable time
+    { "ph","pht4",_n0, 0, mp_print_pht, get_int32, mp_set_ph, &mp_health.plannable[4], 0 }, // blocks started with this plannable time
+    { "ph","pht5",_n0, 0, mp_print_pht, get_int32, mp_set_ph, &mp_health.plannable[5], 0 }, // blocks started with this plannable time
+    { "ph","pht6",_n0, 0, mp_print_pht, get_int32, mp_set_ph, &mp_health.plannable[6], 0 }, // blocks started with this plannable time
+    { "ph","pht7",_n0, 0, mp_print_pht, get_int32, mp_set_ph, &mp_health.plannable[7], 0 }, // blocks started with this plannable time
+    { "ph","phs", _n0, 0, mp_print_phs, get_int32, mp_set_ph, &mp_health.starvations, 0 },  // starvation events
+    { "ph","phm", _n0, 0, mp_print_phm, get_int32, mp_set_ph, &mp_health.plan_misses, 0 },  // forward-plan deadline misses
+    { "ph","phk", _n0, 0, mp_print_phk, get_int32, mp_set_ph, &mp_health.blocks, 0 },       // blocks started
 
 #ifdef __HELP_SCREENS
     { "", "help",_b0, 0, tx_print_nul, help_config, set_nul, nullptr, 0 },  // prints config help screen
@@ -829,6 +1179,8 @@ const cfgItem_t cfgArray[] = {
     { "tt1","tt1a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT1_A_OFFSET },
     { "tt1","tt1b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT1_B_OFFSET },
     { "tt1","tt1c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT1_C_OFFSET },
+    { "tt1","tt1k",_fip,  3, cm_print_ttk, cm_get_ttk, cm_set_ttk, nullptr, TT1_PRESSURE_ADVANCE },
+    TOOL_GEOMETRY(1)
 
     { "tt2","tt2x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT2_X_OFFSET },
     { "tt2","tt2y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT2_Y_OFFSET },
@@ -839,6 +1191,8 @@ const cfgItem_t cfgArray[] = {
     { "tt2","tt2a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT2_A_OFFSET },
     { "tt2","tt2b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT2_B_OFFSET },
     { "tt2","tt2c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT2_C_OFFSET },
+    { "tt2","tt2k",_fip,  3, cm_print_ttk, cm_get_ttk, cm_set_ttk, nullptr, TT2_PRESSURE_ADVANCE },
+    TOOL_GEOMETRY(2)
 
     { "tt3","tt3x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT3_X_OFFSET },
     { "tt3","tt3y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT3_Y_OFFSET },
@@ -849,6 +1203,7 @@ const cfgItem_t cfgArray[] = {
     { "tt3","tt3a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT3_A_OFFSET },
     { "tt3","tt3b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT3_B_OFFSET },
     { "tt3","tt3c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT1_C_OFFSET },
+    TOOL_GEOMETRY(3)
 
     { "tt4","tt4x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT4_X_OFFSET },
     { "tt4","tt4y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT4_Y_OFFSET },
@@ -859,6 +1214,7 @@ const cfgItem_t cfgArray[] = {
     { "tt4","tt4a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT4_A_OFFSET },
     { "tt4","tt4b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT4_B_OFFSET },
     { "tt4","tt4c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT4_C_OFFSET },
+    TOOL_GEOMETRY(4)
 
     { "tt5","tt5x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT5_X_OFFSET },
     { "tt5","tt5y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT5_Y_OFFSET },
@@ -869,6 +1225,7 @@ const cfgItem_t cfgArray[] = {
     { "tt5","tt5a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT5_A_OFFSET },
     { "tt5","tt5b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT5_B_OFFSET },
     { "tt5","tt5c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT5_C_OFFSET },
+    TOOL_GEOMETRY(5)
 
     { "tt6","tt6x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT6_X_OFFSET },
     { "tt6","tt6y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT6_Y_OFFSET },
@@ -879,6 +1236,7 @@ const cfgItem_t cfgArray[] = {
     { "tt6","tt6a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT6_A_OFFSET },
     { "tt6","tt6b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT6_B_OFFSET },
     { "tt6","tt6c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT6_C_OFFSET },
+    TOOL_GEOMETRY(6)
 
     { "tt7","tt7x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT7_X_OFFSET },
     { "tt7","tt7y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT7_Y_OFFSET },
@@ -889,6 +1247,7 @@ const cfgItem_t cfgArray[] = {
     { "tt7","tt7a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT7_A_OFFSET },
     { "tt7","tt7b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT7_B_OFFSET },
     { "tt7","tt7c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT7_C_OFFSET },
+    TOOL_GEOMETRY(7)
 
     { "tt8","tt8x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT8_X_OFFSET },
     { "tt8","tt8y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT8_Y_OFFSET },
@@ -899,6 +1258,7 @@ const cfgItem_t cfgArray[] = {
     { "tt8","tt8a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT8_A_OFFSET },
     { "tt8","tt8b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT8_B_OFFSET },
     { "tt8","tt8c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT8_C_OFFSET },
+    TOOL_GEOMETRY(8)
 
     { "tt9","tt9x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT9_X_OFFSET },
     { "tt9","tt9y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT9_Y_OFFSET },
@@ -909,6 +1269,7 @@ const cfgItem_t cfgArray[] = {
     { "tt9","tt9a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT9_A_OFFSET },
     { "tt9","tt9b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT9_B_OFFSET },
     { "tt9","tt9c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT9_C_OFFSET },
+    TOOL_GEOMETRY(9)
 
     { "tt10","tt10x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT10_X_OFFSET },
     { "tt10","tt10y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT10_Y_OFFSET },
@@ -919,6 +1280,7 @@ const cfgItem_t cfgArray[] = {
     { "tt10","tt10a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT10_A_OFFSET },
     { "tt10","tt10b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT10_B_OFFSET },
     { "tt10","tt10c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT10_C_OFFSET },
+    TOOL_GEOMETRY(10)
 
     { "tt11","tt11x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT11_X_OFFSET },
     { "tt11","tt11y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT11_Y_OFFSET },
@@ -929,6 +1291,7 @@ const cfgItem_t cfgArray[] = {
     { "tt11","tt11a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT11_A_OFFSET },
     { "tt11","tt11b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT11_B_OFFSET },
     { "tt11","tt11c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT11_C_OFFSET },
+    TOOL_GEOMETRY(11)
 
     { "tt12","tt12x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT12_X_OFFSET },
     { "tt12","tt12y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT12_Y_OFFSET },
@@ -939,6 +1302,7 @@ const cfgItem_t cfgArray[] = {
     { "tt12","tt12a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT12_A_OFFSET },
     { "tt12","tt12b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT12_B_OFFSET },
     { "tt12","tt12c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT12_C_OFFSET },
+    TOOL_GEOMETRY(12)
 
     { "tt13","tt13x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT13_X_OFFSET },
     { "tt13","tt13y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT13_Y_OFFSET },
@@ -949,6 +1313,7 @@ const cfgItem_t cfgArray[] = {
     { "tt13","tt13a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT13_A_OFFSET },
     { "tt13","tt13b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT13_B_OFFSET },
     { "tt13","tt13c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT13_C_OFFSET },
+    TOOL_GEOMETRY(13)
 
     { "tt14","tt14x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT14_X_OFFSET },
     { "tt14","tt14y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT14_Y_OFFSET },
@@ -959,6 +1324,7 @@ const cfgItem_t cfgArray[] = {
     { "tt14","tt14a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT14_A_OFFSET },
     { "tt14","tt14b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT14_B_OFFSET },
     { "tt14","tt14c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT14_C_OFFSET },
+    TOOL_GEOMETRY(14)
 
     { "tt15","tt15x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT15_X_OFFSET },
     { "tt15","tt15y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT15_Y_OFFSET },
@@ -969,6 +1335,7 @@ const cfgItem_t cfgArray[] = {
     { "tt15","tt15a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT15_A_OFFSET },
     { "tt15","tt15b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT15_B_OFFSET },
     { "tt15","tt15c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT15_C_OFFSET },
+    TOOL_GEOMETRY(15)
 
     { "tt16","tt16x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT16_X_OFFSET },
     { "tt16","tt16y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT16_Y_OFFSET },
@@ -979,6 +1346,7 @@ const cfgItem_t cfgArray[] = {
     { "tt16","tt16a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT16_A_OFFSET },
     { "tt16","tt16b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT16_B_OFFSET },
     { "tt16","tt16c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT16_C_OFFSET },
+    TOOL_GEOMETRY(16)
 
     { "tt17","tt17x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT17_X_OFFSET },
     { "tt17","tt17y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT17_Y_OFFSET },
@@ -989,6 +1357,7 @@ const cfgItem_t cfgArray[] = {
     { "tt17","tt17a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT17_A_OFFSET },
     { "tt17","tt17b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT17_B_OFFSET },
     { "tt17","tt17c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT17_C_OFFSET },
+    TOOL_GEOMETRY(17)
 
     { "tt18","tt18x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT18_X_OFFSET },
     { "tt18","tt18y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT18_Y_OFFSET },
@@ -999,6 +1368,7 @@ const cfgItem_t cfgArray[] = {
     { "tt18","tt18a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT18_A_OFFSET },
     { "tt18","tt18b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT18_B_OFFSET },
     { "tt18","tt18c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT18_C_OFFSET },
+    TOOL_GEOMETRY(18)
 
     { "tt19","tt19x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT19_X_OFFSET },
     { "tt19","tt19y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT19_Y_OFFSET },
@@ -1009,6 +1379,7 @@ const cfgItem_t cfgArray[] = {
     { "tt19","tt19a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT19_A_OFFSET },
     { "tt19","tt19b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT19_B_OFFSET },
     { "tt19","tt19c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT19_C_OFFSET },
+    TOOL_GEOMETRY(19)
 
     { "tt20","tt20x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT20_X_OFFSET },
     { "tt20","tt20y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT20_Y_OFFSET },
@@ -1019,6 +1390,7 @@ const cfgItem_t cfgArray[] = {
     { "tt20","tt20a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT20_A_OFFSET },
     { "tt20","tt20b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT20_B_OFFSET },
     { "tt20","tt20c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT20_C_OFFSET },
+    TOOL_GEOMETRY(20)
 
     { "tt21","tt21x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT21_X_OFFSET },
     { "tt21","tt21y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT21_Y_OFFSET },
@@ -1029,6 +1401,7 @@ const cfgItem_t cfgArray[] = {
     { "tt21","tt21a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT21_A_OFFSET },
     { "tt21","tt21b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT21_B_OFFSET },
     { "tt21","tt21c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT21_C_OFFSET },
+    TOOL_GEOMETRY(21)
 
     { "tt22","tt22x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT22_X_OFFSET },
     { "tt22","tt22y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT22_Y_OFFSET },
@@ -1039,6 +1412,7 @@ const cfgItem_t cfgArray[] = {
     { "tt22","tt22a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT22_A_OFFSET },
     { "tt22","tt22b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT22_B_OFFSET },
     { "tt22","tt22c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT22_C_OFFSET },
+    TOOL_GEOMETRY(22)
 
     { "tt23","tt23x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT23_X_OFFSET },
     { "tt23","tt23y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT23_Y_OFFSET },
@@ -1049,6 +1423,7 @@ const cfgItem_t cfgArray[] = {
     { "tt23","tt23a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT23_A_OFFSET },
     { "tt23","tt23b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT23_B_OFFSET },
     { "tt23","tt23c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT23_C_OFFSET },
+    TOOL_GEOMETRY(23)
 
     { "tt24","tt24x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT24_X_OFFSET },
     { "tt24","tt24y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT24_Y_OFFSET },
@@ -1059,6 +1434,7 @@ const cfgItem_t cfgArray[] = {
     { "tt24","tt24a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT24_A_OFFSET },
     { "tt24","tt24b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT24_B_OFFSET },
     { "tt24","tt24c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT24_C_OFFSET },
+    TOOL_GEOMETRY(24)
 
     { "tt25","tt25x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT25_X_OFFSET },
     { "tt25","tt25y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT25_Y_OFFSET },
@@ -1069,6 +1445,7 @@ const cfgItem_t cfgArray[] = {
     { "tt25","tt25a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT25_A_OFFSET },
     { "tt25","tt25b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT25_B_OFFSET },
     { "tt25","tt25c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT25_C_OFFSET },
+    TOOL_GEOMETRY(25)
 
     { "tt26","tt26x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT26_X_OFFSET },
     { "tt26","tt26y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT26_Y_OFFSET },
@@ -1079,6 +1456,7 @@ const cfgItem_t cfgArray[] = {
     { "tt26","tt26a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT26_A_OFFSET },
     { "tt26","tt26b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT26_B_OFFSET },
     { "tt26","tt26c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT26_C_OFFSET },
+    TOOL_GEOMETRY(26)
 
     { "tt27","tt27x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT27_X_OFFSET },
     { "tt27","tt27y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT27_Y_OFFSET },
@@ -1089,6 +1467,7 @@ const cfgItem_t cfgArray[] = {
     { "tt27","tt27a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT27_A_OFFSET },
     { "tt27","tt27b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT27_B_OFFSET },
     { "tt27","tt27c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT27_C_OFFSET },
+    TOOL_GEOMETRY(27)
 
     { "tt28","tt28x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT28_X_OFFSET },
     { "tt28","tt28y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT28_Y_OFFSET },
@@ -1099,6 +1478,7 @@ const cfgItem_t cfgArray[] = {
     { "tt28","tt28a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT28_A_OFFSET },
     { "tt28","tt28b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT28_B_OFFSET },
     { "tt28","tt28c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT28_C_OFFSET },
+    TOOL_GEOMETRY(28)
 
     { "tt29","tt29x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT29_X_OFFSET },
     { "tt29","tt29y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT29_Y_OFFSET },
@@ -1109,6 +1489,7 @@ const cfgItem_t cfgArray[] = {
     { "tt29","tt29a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT29_A_OFFSET },
     { "tt29","tt29b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT29_B_OFFSET },
     { "tt29","tt29c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT29_C_OFFSET },
+    TOOL_GEOMETRY(29)
 
     { "tt30","tt30x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT30_X_OFFSET },
     { "tt30","tt30y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT30_Y_OFFSET },
@@ -1119,6 +1500,7 @@ const cfgItem_t cfgArray[] = {
     { "tt30","tt30a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT30_A_OFFSET },
     { "tt30","tt30b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT30_B_OFFSET },
     { "tt30","tt30c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT30_C_OFFSET },
+    TOOL_GEOMETRY(30)
 
     { "tt31","tt31x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT31_X_OFFSET },
     { "tt31","tt31y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT31_Y_OFFSET },
@@ -1129,6 +1511,7 @@ const cfgItem_t cfgArray[] = {
     { "tt31","tt31a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT31_A_OFFSET },
     { "tt31","tt31b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT31_B_OFFSET },
     { "tt31","tt31c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT31_C_OFFSET },
+    TOOL_GEOMETRY(31)
 
     { "tt32","tt32x",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT32_X_OFFSET },
     { "tt32","tt32y",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT32_Y_OFFSET },
@@ -1139,6 +1522,7 @@ const cfgItem_t cfgArray[] = {
     { "tt32","tt32a",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT32_A_OFFSET },
     { "tt32","tt32b",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT32_B_OFFSET },
     { "tt32","tt32c",_fipc, 5, cm_print_cofs, cm_get_tt, cm_set_tt, nullptr, TT32_C_OFFSET },
+    TOOL_GEOMETRY(32)
 
     // Diagnostic parameters
 #ifdef __DIAGNOSTIC_PARAMETERS
@@ -1164,7 +1548,7 @@ const cfgItem_t cfgArray[] = {
     { "_cs","_cs1",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_1], 0 },   // Motor 1 commanded steps (delayed steps)
     { "_es","_es1",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_1], 0 },     // Motor 1 encoder steps
     { "_xs","_xs1",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_1].corrected_steps, 0 }, // Motor 1 correction steps applied
-    { "_fe","_fe1",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_1], 0 },   // Motor 1 following error in steps
+    { "_fe","_fe1",_f0, 2, tx_print_flt, mp_get_fe, set_nul, nullptr, 0 },   // Motor 1 following error in steps
 #endif
 #if (MOTORS >= 2)
     { "_ts","_ts2",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_2], 0 },
@@ -1172,7 +1556,7 @@ const cfgItem_t cfgArray[] = {
     { "_cs","_cs2",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_2], 0 },
     { "_es","_es2",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_2], 0 },
     { "_xs","_xs2",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_2].corrected_steps, 0 },
-    { "_fe","_fe2",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_2], 0 },
+    { "_fe","_fe2",_f0, 2, tx_print_flt, mp_get_fe, set_nul, nullptr, 0 },
 #endif
 #if (MOTORS >= 3)
     { "_ts","_ts3",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_3], 0 },
@@ -1180,7 +1564,7 @@ const cfgItem_t cfgArray[] = {
     { "_cs","_cs3",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_3], 0 },
     { "_es","_es3",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_3], 0 },
     { "_xs","_xs3",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_3].corrected_steps, 0 },
-    { "_fe","_fe3",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_3], 0 },
+    { "_fe","_fe3",_f0, 2, tx_print_flt, mp_get_fe, set_nul, nullptr, 0 },
 #endif
 #if (MOTORS >= 4)
     { "_ts","_ts4",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_4], 0 },
@@ -1188,27 +1572,109 @@ const cfgItem_t cfgArray[] = {
     { "_cs","_cs4",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_4], 0 },
     { "_es","_es4",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_4], 0 },
     { "_xs","_xs4",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_4].corrected_steps, 0 },
-    { "_fe","_fe4",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_4], 0 },
+    { "_fe","_fe4",_f0, 2, tx_print_flt, mp_get_fe, set_nul, nullptr, 0 },
 #endif
 #if (MOTORS >= 5)
     { "_ts","_ts5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_5], 0 },
     { "_ps","_ps5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_5], 0 },
     { "_cs","_cs5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_5], 0 },
     { "_es","_es5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_5], 0 },
-    { "_xs","_xs6",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_5].corrected_steps, 0 },
-    { "_fe","_fe5",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_5], 0 },
+    { "_xs","_xs5",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_5].corrected_steps, 0 },
+    { "_fe","_fe5",_f0, 2, tx_print_flt, mp_get_fe, set_nul, nullptr, 0 },
 #endif
 #if (MOTORS >= 6)
     { "_ts","_ts6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_6], 0 },
     { "_ps","_ps6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_6], 0 },
     { "_cs","_cs6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_6], 0 },
     { "_es","_es6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_6], 0 },
-    { "_xs","_xs5",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_6].corrected_steps, 0 },
-    { "_fe","_fe6",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->following_error[MOTOR_6], 0 },
+    { "_xs","_xs6",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_6].corrected_steps, 0 },
+    { "_fe","_fe6",_f0, 2, tx_print_flt, mp_get_fe, set_nul, nullptr, 0 },
+#endif
+#if (MOTORS >= 7)
+    { "_ts","_ts7",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_7], 0 },
+    { "_ps","_ps7",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_7], 0 },
+    { "_cs","_cs7",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_7], 0 },
+    { "_es","_es7",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_7], 0 },
+    { "_xs","_xs7",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_7].corrected_steps, 0 },
+    { "_fe","_fe7",_f0, 2, tx_print_flt, mp_get_fe, set_nul, nullptr, 0 },
+#endif
+#if (MOTORS >= 8)
+    { "_ts","_ts8",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_8], 0 },
+    { "_ps","_ps8",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_8], 0 },
+    { "_cs","_cs8",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_8], 0 },
+    { "_es","_es8",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_8], 0 },
+    { "_xs","_xs8",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_8].corrected_steps, 0 },
+    { "_fe","_fe8",_f0, 2, tx_print_flt, mp_get_fe, set_nul, nullptr, 0 },
+#endif
+#if (MOTORS >= 9)
+    { "_ts","_ts9",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->target_steps[MOTOR_9], 0 },
+    { "_ps","_ps9",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->position_steps[MOTOR_9], 0 },
+    { "_cs","_cs9",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->commanded_steps[MOTOR_9], 0 },
+    { "_es","_es9",_f0, 2, tx_print_flt, get_flt, set_nul, &mr->encoder_steps[MOTOR_9], 0 },
+    { "_xs","_xs9",_f0, 2, tx_print_flt, get_flt, set_nul, &st_pre.mot[MOTOR_9].corrected_steps, 0 },
+    { "_fe","_fe9",_f0, 2, tx_print_flt, mp_get_fe, set_nul, nullptr, 0 },
 #endif
 
 #endif  //  __DIAGNOSTIC_PARAMETERS
 
+#ifdef __PROFILER
+    { "prof","prof00",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+0], 0 },  // DISPATCH() entries in order
+    { "prof","prof01",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+1], 0 },
+    { "prof","prof02",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+2], 0 },
+    { "prof","prof03",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+3], 0 },
+    { "prof","prof04",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+4], 0 },
+    { "prof","prof05",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+5], 0 },
+    { "prof","prof06",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+6], 0 },
+    { "prof","prof07",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+7], 0 },
+    { "prof","prof08",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+8], 0 },
+    { "prof","prof09",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+9], 0 },
+    { "prof","prof10",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+10], 0 },
+    { "prof","prof11",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+11], 0 },
+    { "prof","prof12",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+12], 0 },
+    { "prof","prof13",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+13], 0 },
+    { "prof","prof14",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+14], 0 },
+    { "prof","prof15",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+15], 0 },
+    { "prof","prof16",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+16], 0 },
+    { "prof","prof17",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+17], 0 },
+    { "prof","prof18",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+18], 0 },
+    { "prof","prof19",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+19], 0 },
+    { "prof","prof20",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+20], 0 },
+    { "prof","prof21",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+21], 0 },
+    { "prof","prof22",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+22], 0 },
+    { "prof","prof23",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+23], 0 },
+    { "prof","prof24",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+24], 0 },
+    { "prof","prof25",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DISPATCH+25], 0 },
+    { "prof","profdd",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_DDA_ISR], 0 },       // DDA ISR
+    { "prof","profld",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_LOAD], 0 },          // _load_move()
+    { "prof","profex",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_EXEC_ISR], 0 },      // exec ISR
+    { "prof","proffp",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_FWD_PLAN_ISR], 0 },  // forward plan ISR
+    { "prof","profki",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_KIN_INVERSE], 0 },   // inverse kinematics
+    { "prof","profkf",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_KIN_FORWARD], 0 },   // forward kinematics
+    { "prof","profmr",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_MARLIN_RESPONSE], 0 },// marlin_response()
+    { "prof","profpl",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_PREP], 0 },          // st_prep_line()
+    { "prof","profrm",_f0, 0, prof_print, prof_get, prof_set, &prof[PROF_RAMPS], 0 },         // mp_calculate_ramps()
+#endif  //  __PROFILER
+
+#ifdef __BENCHMARK
+    { "bm","bma",_i0, 0, bm_print_bma, bm_get_bma, bm_set_bma, nullptr, 0 },  // arm for the next job
+    { "bm","bmj",_i0, 0, bm_print_bmj, bm_get_bmj, bm_set_bmj, nullptr, 0 },  // run compiled-in job N
+    { "bm","bmt",_f0, 3, bm_print_bmt, bm_get_bmt, set_ro, nullptr, 0 },      // job time in seconds
+    { "bm","bmb",_i0, 0, bm_print_bmb, bm_get_bmb, set_ro, nullptr, 0 },      // blocks run
+    { "bm","bms",_i0, 0, bm_print_bms, bm_get_bms, set_ro, nullptr, 0 },      // starvation events
+    { "bm","bmq",_i0, 0, bm_print_bmq, bm_get_bmq, set_ro, nullptr, 0 },      // minimum queue depth
+    { "bm","bmx",_f0, 1, bm_print_bmx, bm_get_bmx, set_ro, nullptr, 0 },      // longest exec ISR (us)
+    { "bm","bmi",_f0, 2, bm_print_bmi, bm_get_bmi, set_ro, nullptr, 0 },      // back-plan iterations per block
+    { "bm","bmm",_i0, 0, bm_print_bmm, bm_get_bmm, set_ro, nullptr, 0 },      // most back-plan iterations
+#endif  //  __BENCHMARK
+
+#ifdef __LATENCY_TRACE     // the stage is passed in the default value
+    { "latp","latpp",_f0, 0, lat_print_pct, lat_get_pct, set_ro, nullptr, LAT_PARSE },   // rx to parsed
+    { "latp","latpc",_f0, 0, lat_print_pct, lat_get_pct, set_ro, nullptr, LAT_COMMIT },  // rx to first block queued
+    { "latp","latpf",_f0, 0, lat_print_pct, lat_get_pct, set_ro, nullptr, LAT_PLAN },    // rx to first block forward planned
+    { "latp","latpr",_f0, 0, lat_print_pct, lat_get_pct, set_ro, nullptr, LAT_RUN },     // rx to first segment
+    { "latp","latpd",_f0, 0, lat_print_pct, lat_get_pct, set_ro, nullptr, LAT_DONE },    // rx to last block done
+#endif  //  __LATENCY_TRACE
+
     // Persistence for status report - must be in sequence
     // *** Count must agree with NV_STATUS_REPORT_LEN in report.h ***
     { "","se00",_fp, 0, tx_print_nul, get_int32, set_int32, &sr.status_report_list[0],0 },
@@ -1259,9 +1725,13 @@ const cfgItem_t cfgArray[] = {
     // *** If you adjust the number of entries in a group you must also adjust the count for that group ***
     // *** COUNT STARTS FROM HERE ***
 
-#define FIXED_GROUPS 4
+#define FIXED_GROUPS 8
     { "","sys",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // system group
+    { "","rxs",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // RX buffer statistics group
+    { "","ph", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // planner health group
+    { "","ram",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // RAM map group
     { "","p1", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // PWM 1 group
+    { "","p2", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // PWM 2 group
     { "","sp", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // Spindle group
     { "","co", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // Coolant group
 
@@ -1293,6 +1763,15 @@ const cfgItem_t cfgArray[] = {
 #if (MOTORS >= 6)
     { "","6",  _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
 #endif
+#if (MOTORS >= 7)
+    { "","7",  _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (MOTORS >= 8)
+    { "","8",  _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (MOTORS >= 9)
+    { "","9",  _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
 
 #define DIGITAL_IN_GROUPS 10
     { "","in",  _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // input state
@@ -1368,23 +1847,52 @@ const cfgItem_t cfgArray[] = {
     { "","tt31",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // tt offsets
     { "","tt32",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // tt offsets
         
-#define MACHINE_STATE_GROUPS 8
+#define MACHINE_STATE_GROUPS 10
     { "","mpo",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // machine position group
     { "","pos",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // work position group
     { "","ofs",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // work offset group
     { "","hom",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // axis homing state group
     { "","prb",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // probing state group
+    { "","prg",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // grid probing group
+    { "","tls",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // tool setter group (G37)
     { "","pwr",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // motor power enagled group
     { "","jog",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // axis jogging state group
+    { "","jgv",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // velocity jogging group
     { "","jid",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // job ID group
 
-#define TEMPERATURE_GROUPS 6
-    { "","he1", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // heater 1 group
-    { "","he2", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // heater 2 group
-    { "","he3", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // heater 3 group
-    { "","pid1",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // PID 1 group
-    { "","pid2",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // PID 2 group
-    { "","pid3",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // PID 3 group
+#define TEMPERATURE_GROUPS (2*HEATERS)
+    { "","he1", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // heater groups
+#if (HEATERS >= 2)
+    { "","he2", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (HEATERS >= 3)
+    { "","he3", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (HEATERS >= 4)
+    { "","he4", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (HEATERS >= 5)
+    { "","he5", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (HEATERS >= 6)
+    { "","he6", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+    { "","pid1",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // PID groups
+#if (HEATERS >= 2)
+    { "","pid2",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (HEATERS >= 3)
+    { "","pid3",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (HEATERS >= 4)
+    { "","pid4",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (HEATERS >= 5)
+    { "","pid5",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
+#if (HEATERS >= 6)
+    { "","pid6",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },
+#endif
 
 #ifdef __USER_DATA
 #define USER_DATA_GROUPS 4
@@ -1406,6 +1914,27 @@ const cfgItem_t cfgArray[] = {
     { "","_fe",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // following error group
 #endif
 
+#ifdef __PROFILER
+#define PROFILER_GROUPS 1
+    { "","prof",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // profiler group
+#else
+#define PROFILER_GROUPS 0
+#endif
+
+#ifdef __BENCHMARK
+#define BENCHMARK_GROUPS 1
+    { "","bm",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },     // benchmark group
+#else
+#define BENCHMARK_GROUPS 0
+#endif
+
+#ifdef __LATENCY_TRACE
+#define LATENCY_GROUPS 1
+    { "","latp",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },   // latency percentiles group
+#else
+#define LATENCY_GROUPS 0
+#endif
+
 #define NV_COUNT_UBER_GROUPS 6
     // Uber-group (groups of groups, for text-mode displays only)
     // *** Must agree with NV_COUNT_UBER_GROUPS below ****
@@ -1429,7 +1958,10 @@ const cfgItem_t cfgArray[] = {
                         + MACHINE_STATE_GROUPS \
                         + TEMPERATURE_GROUPS \
                         + USER_DATA_GROUPS \
-                        + DIAGNOSTIC_GROUPS)
+                        + DIAGNOSTIC_GROUPS \
+                        + PROFILER_GROUPS \
+                        + BENCHMARK_GROUPS \
+                        + LATENCY_GROUPS)
 
 /* <DO NOT MESS WITH THESE DEFINES> */
 #define NV_INDEX_MAX (sizeof(cfgArray) / sizeof(cfgItem_t))
@@ -1438,6 +1970,63 @@ const cfgItem_t cfgArray[] = {
 #define NV_INDEX_START_UBER_GROUPS (NV_INDEX_MAX - NV_COUNT_UBER_GROUPS)
 /* </DO NOT MESS WITH THESE DEFINES> */
 
+static_assert(NV_INDEX_MAX < NO_MATCH, "cfgArray has outgrown index_t");
+
+index_t nvHashNext[NV_INDEX_MAX];       // one link per cfgArray entry for nv_get_index()
+
+/*
+ * nv_group_init()  - record the range of singles belonging to each group
+ * nv_group_range() - return the range for a group index, false if it has none
+ *
+ *  Group members are laid out in runs in cfgArray, so get_grp() only has to look
+ *  between the first and last member instead of comparing every single's group string.
+ *  Most groups are a single run with nothing else in it - contiguous is set for those,
+ *  and get_grp() takes the whole range without comparing any group strings.
+ */
+
+static index_t nv_group_first[NV_COUNT_GROUPS];
+static index_t nv_group_last[NV_COUNT_GROUPS];
+static index_t nv_group_count[NV_COUNT_GROUPS];
+
+void nv_group_init()
+{
+    for (index_t g=0; g < NV_COUNT_GROUPS; g++) {
+        nv_group_first[g] = NO_MATCH;
+        nv_group_last[g] = 0;
+        nv_group_count[g] = 0;
+    }
+    for (index_t i=0; nv_index_is_single(i); i++) {
+        if (cfgArray[i].group[0] == NUL) {
+            continue;
+        }
+        index_t parent = nv_get_index((const char *)"", cfgArray[i].group);
+        if ((parent == NO_MATCH) || (!nv_index_is_group(parent))) {
+            continue;
+        }
+        index_t g = parent - NV_INDEX_START_GROUPS;
+        if (nv_group_first[g] == NO_MATCH) {
+            nv_group_first[g] = i;
+        }
+        nv_group_last[g] = i;
+        nv_group_count[g]++;
+    }
+}
+
+bool nv_group_range(index_t index, index_t &first, index_t &last, bool &contiguous)
+{
+    if (!nv_index_is_group(index)) {
+        return (false);
+    }
+    index_t g = index - NV_INDEX_START_GROUPS;
+    if (nv_group_first[g] == NO_MATCH) {
+        return (false);
+    }
+    first = nv_group_first[g];
+    last = nv_group_last[g];
+    contiguous = (nv_group_count[g] == last - first + 1);
+    return (true);
+}
+
 index_t nv_index_max() { return ( NV_INDEX_MAX );}
 bool nv_index_is_single(index_t index) { return ((index <= NV_INDEX_END_SINGLES) ? true : false);}
 bool nv_index_is_group(index_t index) { return (((index >= NV_INDEX_START_GROUPS) && (index < NV_INDEX_START_UBER_GROUPS)) ? true : false);}
@@ -1694,7 +2283,7 @@ static stat_t _do_outputs(nvObj_t *nv)  // print parameters for all output group
 static stat_t _do_heaters(nvObj_t *nv)  // print parameters for all heater groups
 {
     char group[GROUP_LEN];
-    for (uint8_t i=1; i < 4; i++) {
+    for (uint8_t i=1; i < HEATERS+1; i++) {
         sprintf(group, "he%d", i);
         _do_group(nv, group);
     }
@@ -1709,7 +2298,8 @@ static stat_t _do_all(nvObj_t *nv)  // print all parameters
     _do_inputs(nv);
     _do_outputs(nv);
     _do_heaters(nv);                // there are no text mode prints for heaters
-    _do_group(nv, (char *)"p1");    // PWM group
+    _do_group(nv, (char *)"p1");    // PWM groups
+    _do_group(nv, (char *)"p2");
     _do_offsets(nv);                // coordinate system offsets
     return (STAT_COMPLETE);         // STAT_COMPLETE suppresses a second JSON write that would cause a fault
 }
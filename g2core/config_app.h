@@ -52,6 +52,8 @@ typedef struct cfgParameters {  // mostly communications variables at this point
     uint32_t user_data_d[4];
 #endif
 
+    uint8_t profile;            // active machine profile {mpro:}
+
     uint16_t magic_end;
 } cfgParameters_t;
 extern cfgParameters_t cfg;
@@ -45,9 +45,23 @@
 #include "util.h"
 #include "xio.h"
 #include "settings.h"
+#include "profiler.h"
+#include "benchmark.h"
+#include "trace.h"
+#include "latency.h"
+#include "capture.h"
+#include "binary_motion.h"
+#include "persistence.h"
+#include "spool.h"
+#include "gcode_oword.h"
+#include "sync.h"
+#include "cpuload.h"
+#include "checkpoint.h"
 
 #include "MotatePower.h"
 
+#include <unistd.h>                             // sbrk()
+
 #if MARLIN_COMPAT_ENABLED == true
 #include "marlin_compatibility.h"
 #endif
@@ -58,12 +72,20 @@
 
 controller_t cs;        // controller state structure
 
+// Lines read ahead while the planner is full - see _prefetch_lines()
+static bool _line_is_prefetched;                // cs.bufp is the line taken from gcode_prefetch_next()
+static bool _pending_line_valid;                // a line that could not be prefetched is waiting
+static devflags_t _pending_line_flags;
+static char _pending_line[RX_BUFFER_SIZE+1];
+
 /****************************************************************************************
  **** STATICS AND LOCALS ****************************************************************
  ****************************************************************************************/
 
 static void _controller_HSM(void);
+static void _idle_sleep(void);
 static stat_t _led_indicator(void);             // twiddle the LED indicator
+static stat_t _step_halt_handler(void);
 static stat_t _shutdown_handler(void);          // new (replaces _interlock_estop_handler)
 static stat_t _interlock_handler(void);         // new (replaces _interlock_estop_handler)
 static stat_t _limit_switch_handler(void);      // revised for new GPIO code
@@ -71,12 +93,68 @@ static stat_t _limit_switch_handler(void);      // revised for new GPIO code
 static void _init_assertions(void);
 static stat_t _test_assertions(void);
 static stat_t _test_system_assertions(void);
+#define ASSERTION_CHECKS 10                     // subsystem checks run round-robin by _test_system_assertions()
 
 static stat_t _sync_to_planner(void);
 static stat_t _sync_to_tx_buffer(void);
 static stat_t _dispatch_command(void);
 static stat_t _dispatch_control(void);
 static void _dispatch_kernel(const devflags_t flags);
+/*
+ * _read_line() - read a data line from xio, measuring the host link as it goes
+ * controller_line_ms() - time the planner should give each move from the host, 0 for none
+ *
+ *  The link's rate can only be seen when the controller is left waiting on it: the reads
+ *  ran dry right after the last line and kept asking until the next one came. The time
+ *  between the two lines is then what the link takes to deliver it, whether the link is
+ *  byte bound (a UART) or round trip bound (a host that waits for each response), and is
+ *  averaged per byte. Lines that are waiting when asked for say nothing about the link -
+ *  they may have sat in the RX buffer while the planner was full. So does a wait longer
+ *  than LINK_SAMPLE_MAX_MS, which is the host pausing. A fast link is still measured, as
+ *  the reads run dry now and then and the next line comes within the millisecond.
+ *
+ *  With {lkth:} on, controller_line_ms() is the time the link takes to deliver a line of the
+ *  average length, and the planner holds each move to at least that (see _throttle_to_link()
+ *  in plan_line.cpp), so a slow link slows the short moves down to the rate it can feed them
+ *  instead of starving the planner. It is 0 while an O-word program runs from the cache.
+ */
+
+static char *_read_line(devflags_t &flags)
+{
+    char *line = xio_readline(flags, cs.linelen);
+    uint32_t now = SysTickTimer_getValue();
+
+    if (line == NULL) {
+        if (!cs.link_empty) {
+            cs.link_empty = true;
+            cs.link_waiting = ((now - cs.link_line_tick) <= 1);
+        }
+        cs.link_empty_tick = now;
+        return (NULL);
+    }
+    float bytes = cs.linelen + 1;
+    cs.link_bytes_per_line += (bytes - cs.link_bytes_per_line) * LINK_FILTER;
+    uint32_t wait = now - cs.link_line_tick;
+    if (cs.link_waiting && ((now - cs.link_empty_tick) <= 1) && (wait <= LINK_SAMPLE_MAX_MS)) {
+        cs.link_ms_per_byte += (wait / bytes - cs.link_ms_per_byte) * LINK_FILTER;
+    }
+    cs.link_line_tick = now;
+    cs.link_empty = false;
+    cs.link_waiting = false;
+    return (line);
+}
+
+float controller_line_ms()
+{
+    if (!cs.link_throttle || oword_is_running()) {
+        return (0);
+    }
+    return (cs.link_ms_per_byte * cs.link_bytes_per_line);
+}
+
+static char *_read_line(devflags_t &flags);
+static bool _next_line(devflags_t &flags);
+static void _prefetch_lines(void);
 static stat_t _controller_state(void);          // manage controller state transitions
 
 static Motate::OutputPin<Motate::kOutputSAFE_PinNumber> safe_pin;
@@ -95,6 +173,7 @@ void controller_init()
 
     memset(&cs, 0, sizeof(controller_t));           // clear all values, job_id's, pointers and status
     _init_assertions();
+    cpuload_init();
 
     cs.comm_mode = comm_mode;                       // restore parameters
     cs.fw_build = G2CORE_FIRMWARE_BUILD;            // set up identification
@@ -136,12 +215,68 @@ void controller_run()
 {
     while (true) {
         _controller_HSM();
+        _idle_sleep();
+#ifdef __SIMULATOR
+        sim_run_interrupts();           // board/sim - run what would have interrupted the pass
+#endif
     }
 }
 
+/*
+ * _idle_sleep() - WFI until the next interrupt if there is nothing for the controller to do
+ *
+ *  Idle means: no cycle and no motion, nothing in the planner, and no input that readline()
+ *  could act on. Everything else the main loop waits on is an interrupt or a SysTick time
+ *  compare (reports, acks, Timeouts, LED, motor power), and the 1 ms SysTick wakes the core,
+ *  so no timeout is more than a tick late. USB, UART and input interrupts wake it at once.
+ *
+ *  Interrupts are masked across the last check and the WFI so an interrupt that lands in
+ *  between leaves the WFI to fall straight through rather than sleeping on it.
+ */
+
+static void _idle_sleep()
+{
+#if CONTROLLER_IDLE_SLEEP == true
+    if ((cs.controller_state != CONTROLLER_READY) && (cs.controller_state != CONTROLLER_NOT_CONNECTED)) {
+        return;
+    }
+    if ((cm->cycle_type != CYCLE_NONE) || (cm->motion_state != MOTION_STOP) ||
+        mp_has_runnable_buffer(mp) || !mp_runtime_is_idle() || oword_is_running()) {
+        return;
+    }
+    __disable_irq();
+    if (!xio_rx_pending()) {
+        __WFI();
+    }
+    __enable_irq();
+#endif
+}
+
+/*
+ * DISPATCH(func)           - run a task on every pass; STAT_EAGAIN ends the pass
+ * DISPATCH_EVERY(ms, func) - run a task at most once every ms milliseconds
+ *
+ *  Periodic tasks cost one SysTick compare on the passes they sit out, so the time goes
+ *  to the planner and the parsers instead. Only tasks that never return STAT_EAGAIN may
+ *  be periodic - a task that's skipped can't hold up the ones after it. The order of the
+ *  DISPATCH() lines is still the priority order.
+ */
+#ifdef __PROFILER
+#define DISPATCH(func) { PROF_BEGIN(_start); stat_t _status = func; PROF_END(_start, _probe++); \
+                         if (_status == STAT_EAGAIN) return; }
+#define DISPATCH_SKIP() _probe++                // keep the probe numbers in DISPATCH() order
+#else
 #define DISPATCH(func) if (func == STAT_EAGAIN) return;
+#define DISPATCH_SKIP()
+#endif
+#define DISPATCH_EVERY(ms, func) { static uint32_t _due = 0; uint32_t _now = SysTickTimer_getValue(); \
+                                   if ((int32_t)(_now - _due) >= 0) { _due = _now + (ms); DISPATCH(func); } \
+                                   else { DISPATCH_SKIP(); } }
 static void _controller_HSM()
 {
+#ifdef __PROFILER
+    uint8_t _probe = PROF_DISPATCH;             // probes are numbered in DISPATCH() order
+#endif
 //----- Interrupt Service Routines are the highest priority controller functions ----//
 //      See hardware.h for a list of ISRs and their priorities.
 //
@@ -150,40 +285,69 @@ static void _controller_HSM()
     // Order is important, and line breaks indicate dependency groups
 
     DISPATCH(hardware_periodic());              // give the hardware a chance to do stuff
-    DISPATCH(_led_indicator());                 // blink LEDs at the current rate
+    DISPATCH_EVERY(TASK_LED_MS, _led_indicator());                  // blink LEDs at the current rate
+    DISPATCH(gpio_event_callback());            // deliver queued input edge events
+    DISPATCH(_step_halt_handler());             // finish a halt started by an input interrupt
     DISPATCH(_shutdown_handler());              // invoke shutdown
     DISPATCH(_interlock_handler());             // invoke / remove safety interlock
-    DISPATCH(temperature_callback());           // makes sure temperatures are under control
+    DISPATCH_EVERY(TASK_TEMPERATURE_MS, temperature_callback());    // makes sure temperatures are under control
     DISPATCH(_limit_switch_handler());          // invoke limit switch
     DISPATCH(_controller_state());              // controller state management
-    DISPATCH(_test_system_assertions());        // system integrity assertions
+    DISPATCH_EVERY(TASK_ASSERTIONS_MS / ASSERTION_CHECKS, _test_system_assertions());  // one subsystem's assertions
     DISPATCH(_dispatch_control());              // read any control messages prior to executing cycles
 
 //----- planner hierarchy for gcode and cycles ---------------------------------------//
 
     DISPATCH(st_motor_power_callback());        // stepper motor power sequencing
-    DISPATCH(sr_status_report_callback());      // conditionally send status report
-    DISPATCH(qr_queue_report_callback());       // conditionally send queue report
+    DISPATCH_EVERY(TASK_ODOMETER_MS, st_odometer_callback());       // motor wear counters - see stepper.h
+    DISPATCH(sync_callback());                  // sync master's run output
+    DISPATCH_EVERY(LOAD_WINDOW_MS, cpuload_callback());             // close the CPU load window - before the reports
+    DISPATCH(rpt_event_callback());             // send status and queue reports on events and timers
+    DISPATCH(json_ack_callback());              // send cumulative gcode acks in JV_ACK mode
+    DISPATCH(xio_callback());                   // pass on TX writes held for coalescing
+#if BINARY_MOTION_ENABLED == true
+    DISPATCH(binary_telemetry_callback());      // send telemetry samples on SerialUSB1
+#endif
 
     // these 3 must be in this exact order:
     DISPATCH(mp_planner_callback());            // motion planner
     DISPATCH(cm_operation_runner_callback());   // operation action runner
     DISPATCH(cm_arc_callback(cm));              // arc generation runs as a cycle above lines
+    DISPATCH(cm_drill_callback(cm));            // so do drilling cycles (G73, G81-G83)
 
     DISPATCH(cm_homing_cycle_callback());       // homing cycle operation (G28.2)
     DISPATCH(cm_probing_cycle_callback());      // probing cycle operation (G38.2)
     DISPATCH(cm_jogging_cycle_callback());      // jog cycle operation
-    DISPATCH(cm_deferred_write_callback());     // persist G10 changes when not in machining cycle
+    DISPATCH(cm_autotune_cycle_callback());     // heater PID autotune ({heNtu:})
+    DISPATCH_EVERY(TASK_PERSIST_MS, cm_deferred_write_callback());  // persist G10 changes when not in machining cycle
+    DISPATCH_EVERY(TASK_PERSIST_MS, persistence_callback());        // commit or compact the NVM log when not in machining cycle
+    DISPATCH_EVERY(TASK_CHECKPOINT_MS, checkpoint_callback());      // store a job checkpoint - see checkpoint.h
+    DISPATCH_EVERY(TASK_SPOOL_QUEUE_MS, spool_queue_callback());    // see spooled jobs to their end and run the job queue
 
     DISPATCH(cm_feedhold_command_blocker());    // blocks new Gcode from arriving while in feedhold
 #if MARLIN_COMPAT_ENABLED == true
     DISPATCH(marlin_callback());                // handle Marlin stuff - may return EAGAIN, must be after planner_callback!
 #endif
+#ifdef __SEGMENT_TRACE
+    DISPATCH(trace_callback());                 // send segment trace lines, if a dump was requested
+#endif
+#ifdef __LATENCY_TRACE
+    DISPATCH(latency_callback());               // send latency trace lines, if a dump was requested
+#endif
+#ifdef __SESSION_CAPTURE
+    DISPATCH(capture_callback());               // send capture lines, if a dump was requested
+#endif
+#ifdef __BENCHMARK
+    DISPATCH(bm_callback());                    // report the benchmark when the job is done
+#endif
 
 //----- command readers and parsers --------------------------------------------------//
 
     DISPATCH(_sync_to_planner());               // ensure there is at least one free buffer in planning queue
     DISPATCH(_sync_to_tx_buffer());             // sync with TX buffer (pseudo-blocking)
+#if BINARY_MOTION_ENABLED == true
+    DISPATCH(binary_motion_callback());         // read and execute a binary motion frame from SerialUSB1
+#endif
     DISPATCH(_dispatch_command());              // MUST BE LAST - read and execute next command
 }
 
@@ -196,7 +360,13 @@ static void _controller_HSM()
  *  Reads next command line and dispatches to relevant parser or action
  *
  *  Note: The dispatchers must only read and process a single line from the
- *        RX queue before returning control to the main loop.
+ *        RX queue before returning control to the main loop. The exception is a
+ *        run of plain gcode lines: _dispatch_command() will take up to
+ *        DISPATCH_BATCH_LINES of those in one pass while the planner has room,
+ *        there is no hold, and the pass is within DISPATCH_BATCH_US. Anything
+ *        else (JSON, $ commands, controls) ends the batch once it has run.
+ *        While an O-word subroutine or loop runs its lines are taken from the
+ *        program cache instead, ahead of any more input (see gcode_oword.h).
  */
 
 static stat_t _dispatch_control()
@@ -204,25 +374,161 @@ static stat_t _dispatch_control()
     if (cs.controller_state != CONTROLLER_PAUSED) {
         devflags_t flags = DEV_IS_CTRL;
         if ((cs.bufp = xio_readline(flags, cs.linelen)) != NULL) {
+            LAT_LINE_TAKEN(false);
             _dispatch_kernel(flags);
         }
     }
     return (STAT_OK);
 }
 
+static bool _is_plain_gcode(const char *line)
+{
+    while ((*line == SPC) || (*line == TAB)) {
+        line++;
+    }
+    return ((*line > SPC) && (strchr("{$?Hh!~%", *line) == NULL));
+}
+
 static stat_t _dispatch_command()
 {
-    if (cs.controller_state != CONTROLLER_PAUSED) {
-        devflags_t flags = DEV_IS_BOTH | DEV_IS_MUTED; // expressly state we'll handle muted devices
-        if ((!mp_planner_is_full(mp)) && (cs.bufp = xio_readline(flags, cs.linelen)) != NULL) {
+    uint32_t start = cycle_count();
+    uint32_t budget = DISPATCH_BATCH_US * (SystemCoreClock / 1000000);
+
+    for (uint8_t lines = 0; lines < DISPATCH_BATCH_LINES; lines++) {
+        if (cs.controller_state == CONTROLLER_PAUSED) {
+            break;
+        }
+        if (mp_planner_is_full(mp) || mp_planner_is_time_full(mp)) {
+            break;
+        }
+        bool gcode = true;
+        if (oword_is_running()) {               // a subroutine or loop runs ahead of any more input
+            oword_run_line();
+        } else {
+            devflags_t flags = DEV_IS_BOTH | DEV_IS_MUTED; // expressly state we'll handle muted devices
+            if (!_next_line(flags)) {
+                break;
+            }
+            gcode = _is_plain_gcode(cs.bufp) && !(flags & DEV_IS_MUTED);
             _dispatch_kernel(flags);
         }
+        if (!gcode || cm_has_hold() || ((cycle_count() - start) > budget)) {
+            break;
+        }
+        if ((cm->arc.run_state != BLOCK_INACTIVE) || (cm->drill.run_state != BLOCK_INACTIVE)) {
+            break;                              // the line started an arc or drilling cycle - let its callback queue it
+        }
     }
     return (STAT_OK);
 }
 
+/*
+ * _next_line()       - get the next line to dispatch into cs.bufp
+ * _prefetch_lines()  - read lines ahead while the planner is full
+ * controller_flush_prefetch() - discard the lines read ahead and any O-word program (queue flush)
+ *
+ *  While the planner is full, plain gcode lines are read and tokenized by gcode_prefetch() so
+ *  only the parse and plan are left to do when a buffer frees up. The first line that can't be
+ *  prefetched (not plain gcode, muted, or too long) is held as the pending line and reading
+ *  stops there. _next_line() returns the prefetched lines, then the pending line, then reads
+ *  from xio again, so lines are always dispatched in the order they were received.
+ */
+
+static bool _next_line(devflags_t &flags)
+{
+    if ((cs.bufp = gcode_prefetch_next()) != NULL) {
+        _line_is_prefetched = true;
+        flags = DEV_IS_BOTH;
+        LAT_LINE_TAKEN(true);
+        return (true);
+    }
+    _line_is_prefetched = false;
+    if (_pending_line_valid) {
+        _pending_line_valid = false;
+        cs.bufp = _pending_line;
+        flags = _pending_line_flags;
+        LAT_LINE_TAKEN(true);
+        return (true);
+    }
+    if ((cs.bufp = _read_line(flags)) == NULL) {
+        return (false);
+    }
+    LAT_LINE_TAKEN(false);
+    return (true);
+}
+
+static void _prefetch_lines()
+{
+    ldScope _ld(LOAD_MAIN);
+    if (_pending_line_valid || cm_has_hold() || (cs.controller_state != CONTROLLER_READY) ||
+        spool_is_recording() || cm_velocity_jog_is_running()) {
+        return;
+    }
+#if MARLIN_COMPAT_ENABLED == true
+    if (js.json_mode == MARLIN_COMM_MODE) {     // may carry binary stk500 messages
+        return;
+    }
+#endif
+    while (gcode_prefetch_has_room()) {
+        devflags_t flags = DEV_IS_BOTH | DEV_IS_MUTED;
+        char *line = _read_line(flags);
+        if (line == NULL) {
+            return;
+        }
+        LAT_LINE_READ();
+        while ((*line == SPC) || (*line == TAB)) {
+            line++;
+        }
+        if (!(flags & DEV_IS_MUTED) && _is_plain_gcode(line) && gcode_prefetch(line)) {
+            continue;
+        }
+        strncpy(_pending_line, line, RX_BUFFER_SIZE);
+        _pending_line[RX_BUFFER_SIZE] = NUL;
+        _pending_line_flags = flags;
+        _pending_line_valid = true;
+        return;
+    }
+}
+
+void controller_flush_prefetch()
+{
+    gcode_prefetch_flush();
+    oword_flush();
+    _pending_line_valid = false;
+    LAT_LINE_FLUSH();
+}
+
+/*
+ * _run_gcode() - run a gcode line, or store it if a job is being uploaded to the spool
+ *
+ *  O-word lines, and the lines of an O-word subroutine or loop being defined, go to
+ *  gcode_oword.cpp instead of the parser.
+ */
+
+static stat_t _run_gcode(char *line)
+{
+    if (spool_is_recording()) {
+        return (spool_write_line(line));
+    }
+    if (oword_takes_line(line)) {
+        _line_is_prefetched = false;
+        return (oword_host_line(line));
+    }
+    if (cm_velocity_jog_is_running()) {     // the model position is stale until the jog ends
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    if (_line_is_prefetched) {              // already tokenized - see _prefetch_lines()
+        _line_is_prefetched = false;
+        LAT_GCODE_START();
+        return (gcode_prefetch_run());
+    }
+    LAT_GCODE_START();
+    return (gcode_parser(line));
+}
+
 static void _dispatch_kernel(const devflags_t flags)
 {
+    ldScope _ld(LOAD_MAIN);
     stat_t status;
 
     if (flags & DEV_IS_MUTED) {
@@ -249,6 +555,7 @@ static void _dispatch_kernel(const devflags_t flags)
         cs.bufp++;
     }
     strncpy(cs.saved_buf, cs.bufp, SAVED_BUFFER_LEN-1);     // save input buffer for reporting
+    sr_mark_changed();                                      // any command may change a reported value
 
     if (*cs.bufp == NUL) {                                  // blank line - just a CR or the 2nd termination in a CRLF
         if (js.json_mode == TEXT_MODE) {
@@ -283,14 +590,14 @@ static void _dispatch_kernel(const devflags_t flags)
     }
     else if (js.json_mode == TEXT_MODE) {                   // anything else is interpreted as Gcode
         cs.comm_request_mode = TEXT_MODE;                   // mode of this command
-        text_response(gcode_parser(cs.bufp), cs.saved_buf);
+        text_response(_run_gcode(cs.bufp), cs.saved_buf);
     }
 #endif
 
 #if MARLIN_COMPAT_ENABLED == true
     else if (js.json_mode == MARLIN_COMM_MODE) {            // handle marlin-specific protocol gcode
         cs.comm_request_mode = MARLIN_COMM_MODE;            // mode of this command
-        marlin_response(gcode_parser(cs.bufp), cs.saved_buf);
+        marlin_response(_run_gcode(cs.bufp), cs.saved_buf);
     }
 #endif
     else {  // anything else is interpreted as Gcode
@@ -301,7 +608,7 @@ static void _dispatch_kernel(const devflags_t flags)
         strcpy(nv->token, "gc");                            // label is as a Gcode block (do not get an index - not necessary)
         nv_copy_string(nv, cs.bufp);                        // copy the Gcode line
         nv->valuetype = TYPE_STRING;
-        status = gcode_parser(cs.bufp);
+        status = _run_gcode(cs.bufp);
         
 #if MARLIN_COMPAT_ENABLED == true
         if (js.json_mode == MARLIN_COMM_MODE) {             // in case a marlin-specific M-code was found
@@ -454,7 +761,8 @@ static stat_t _sync_to_tx_buffer()
 
 static stat_t _sync_to_planner()
 {
-    if (mp_planner_is_full(mp)) {   // allow up to N planner buffers for this line
+    if (mp_planner_is_full(mp) || mp_planner_is_time_full(mp)) {   // allow up to N planner buffers for this line
+        _prefetch_lines();                      // use the wait to tokenize the lines behind
         return (STAT_EAGAIN);
     }
     return (STAT_OK);
@@ -463,6 +771,7 @@ static stat_t _sync_to_planner()
 /****************************************************************************************
  * ALARM STATE HANDLERS
  *
+ * _step_halt_handler() - halt the machine after an input stopped the steps (INPUT_ACTION_HALT_STEPS)
  * _shutdown_handler() - put system into shutdown state
  * _limit_switch_handler() - shut down system if limit switch fired
  * _interlock_handler() - feedhold and resume depending on edge
@@ -474,6 +783,14 @@ static stat_t _sync_to_planner()
  *   - safety_interlock_requested == INPUT_EDGE_LEADING is interlock onset
  *   - safety_interlock_requested == INPUT_EDGE_TRAILING is interlock offset
  */
+static stat_t _step_halt_handler(void)
+{
+    if (st_steps_halted()) {            // the steps stopped in the input interrupt...
+        cm_halt_motion();               // ...the planner and runtime stop here. This resets the stepper
+    }
+    return (STAT_OK);
+}
+
 static stat_t _shutdown_handler(void)
 {
     if (cm->shutdown_requested != 0) {  // request may contain the (non-zero) input number
@@ -527,15 +844,40 @@ static stat_t _interlock_handler(void)
 }
 
 /****************************************************************************************
- * _init_assertions() - initialize controller memory integrity assertions
+ * _init_assertions() - initialize controller memory integrity assertions and the stack canary
  * _test_assertions() - check controller memory integrity assertions
- * _test_system_assertions() - check assertions for entire system
+ * _test_stack()      - check the stack canary
+ * _test_system_assertions() - check assertions for one subsystem per call
+ *
+ *  The stack canary is a magic number in the lowest word of the stack region (_sstack, from
+ *  the linker script). The stack grows down onto it before it runs into the data below, so
+ *  a clobbered canary means the stack has overflowed, or very nearly. The simulator runs on
+ *  the host's stack and has no canary.
+ *
+ *  _test_system_assertions() walks the subsystems round-robin, one check per call, so each
+ *  check costs about the same small slice of a controller pass. It's dispatched often enough
+ *  to sweep every subsystem once per TASK_ASSERTIONS_MS.
  */
 
+#ifndef __SIMULATOR
+extern uint32_t _sstack;                        // bottom of the stack region - see the linker script
+extern uint32_t _estack;                        // top of the stack region
+extern uint32_t _end;                           // end of the static data - the heap starts here
+#endif
+
 static void _init_assertions()
 {
     cs.magic_start = MAGICNUM;
     cs.magic_end = MAGICNUM;
+#ifndef __SIMULATOR
+    _sstack = MAGICNUM;
+
+    // paint the unused stack for the high-water mark - see cs_get_ramsu()
+    uint32_t here;
+    for (uint32_t *p = &_sstack + 1; p < &here - STACK_PAINT_MARGIN; p++) {
+        *p = STACK_PAINT;
+    }
+#endif
 }
 
 static stat_t _test_assertions()
@@ -546,19 +888,145 @@ static stat_t _test_assertions()
     return (STAT_OK);
 }
 
-stat_t _test_system_assertions()
+static stat_t _test_stack()
 {
-    // these functions will panic if an assertion fails
-    _test_assertions();         // controller assertions (local)
-    config_test_assertions();
-    canonical_machine_test_assertions(&cm1);
-    canonical_machine_test_assertions(&cm2);
-    planner_assert(&mp1);
-    planner_assert(&mp2);
-    stepper_test_assertions();
-    encoder_test_assertions();
-    xio_test_assertions();
+#ifndef __SIMULATOR
+    if (_sstack != MAGICNUM) {
+        return(cm_panic(STAT_STACK_OVERFLOW, "controller stack canary"));
+    }
+#endif
     return (STAT_OK);
 }
 
+static stat_t _test_cm1() { return (canonical_machine_test_assertions(&cm1)); }
+static stat_t _test_cm2() { return (canonical_machine_test_assertions(&cm2)); }
+static stat_t _test_mp1() { return (planner_assert(&mp1)); }
+static stat_t _test_mp2() { return (planner_assert(&mp2)); }
+
+static stat_t (*const _assertions[])(void) = {  // these functions will panic if an assertion fails
+    _test_assertions,                           // controller assertions (local)
+    _test_stack,
+    config_test_assertions,
+    _test_cm1,
+    _test_cm2,
+    _test_mp1,
+    _test_mp2,
+    stepper_test_assertions,
+    encoder_test_assertions,
+    xio_test_assertions
+};
+static_assert(sizeof(_assertions) / sizeof(_assertions[0]) == ASSERTION_CHECKS, "ASSERTION_CHECKS must match _assertions[]");
+
+stat_t _test_system_assertions()
+{
+    static uint8_t next = 0;
+
+    stat_t status = _assertions[next]();
+    if (++next == ASSERTION_CHECKS) {
+        next = 0;
+    }
+    return (status);
+}
+
     
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * cs_get_ramss() - get the size of the stack region
+ * cs_get_ramsu() - get the most stack ever used - the painted words still untouched tell
+ * cs_get_ramhp() - get the heap in use (newlib's heap only grows, so this is also its high water)
+ * cs_get_rampq() - get RAM taken by the planner queues
+ * cs_get_rampr() - get RAM taken by the planner runtimes
+ * cs_get_ramcm() - get RAM taken by the canonical machines
+ * cs_get_ramnv() - get RAM taken by the nvObj list
+ * cs_get_ramcs() - get RAM taken by the controller and its serial buffers
+ *
+ *  The simulator runs on the host's stack and heap, so it reports them as 0. The xio device
+ *  buffers are reported by xio_get_rxsb().
+ */
+
+stat_t cs_get_ramss(nvObj_t *nv)
+{
+#ifndef __SIMULATOR
+    return (get_integer(nv, (uint32_t)((uint8_t *)&_estack - (uint8_t *)&_sstack)));
+#else
+    return (get_integer(nv, 0));
+#endif
+}
+
+stat_t cs_get_ramsu(nvObj_t *nv)
+{
+#ifndef __SIMULATOR
+    uint32_t *p = &_sstack + 1;
+    while ((p < &_estack) && (*p == STACK_PAINT)) {
+        p++;
+    }
+    return (get_integer(nv, (uint32_t)((uint8_t *)&_estack - (uint8_t *)p)));
+#else
+    return (get_integer(nv, 0));
+#endif
+}
+
+stat_t cs_get_ramhp(nvObj_t *nv)
+{
+#ifndef __SIMULATOR
+    return (get_integer(nv, (uint32_t)((uint8_t *)sbrk(0) - (uint8_t *)&_end)));
+#else
+    return (get_integer(nv, 0));
+#endif
+}
+
+stat_t cs_get_rampq(nvObj_t *nv) { return (get_integer(nv, sizeof(mp1_queue) + sizeof(mp2_queue))); }
+stat_t cs_get_rampr(nvObj_t *nv) { return (get_integer(nv, sizeof(mr1) + sizeof(mr2))); }
+stat_t cs_get_ramcm(nvObj_t *nv) { return (get_integer(nv, sizeof(cm1) + sizeof(cm2))); }
+stat_t cs_get_ramnv(nvObj_t *nv) { return (get_integer(nv, sizeof(nvl))); }
+stat_t cs_get_ramcs(nvObj_t *nv) { return (get_integer(nv, sizeof(cs))); }
+
+/*
+ * cs_get_lkth() - get host link throttle enable
+ * cs_set_lkth() - set host link throttle enable
+ * cs_get_lkt()  - get the measured time for the host link to deliver a line, in ms
+ * cs_get_lkb()  - get the measured average line length, in bytes
+ */
+
+stat_t cs_get_lkth(nvObj_t *nv) { return (get_integer(nv, cs.link_throttle)); }
+stat_t cs_set_lkth(nvObj_t *nv) { return (set_integer(nv, cs.link_throttle, 0, 1)); }
+stat_t cs_get_lkt(nvObj_t *nv) { return (get_float(nv, cs.link_ms_per_byte * cs.link_bytes_per_line)); }
+stat_t cs_get_lkb(nvObj_t *nv) { return (get_float(nv, cs.link_bytes_per_line)); }
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_ramss[] = "[ramss] stack size%17d bytes\n";
+static const char fmt_ramsu[] = "[ramsu] stack high water%11d bytes\n";
+static const char fmt_ramhp[] = "[ramhp] heap in use%16d bytes\n";
+static const char fmt_rampq[] = "[rampq] planner queues%13d bytes\n";
+static const char fmt_rampr[] = "[rampr] planner runtimes%11d bytes\n";
+static const char fmt_ramcm[] = "[ramcm] canonical machines%9d bytes\n";
+static const char fmt_ramnv[] = "[ramnv] nvObj list%17d bytes\n";
+static const char fmt_ramcs[] = "[ramcs] controller%17d bytes\n";
+void cs_print_ramss(nvObj_t *nv) { text_print(nv, fmt_ramss);} // TYPE_INT
+void cs_print_ramsu(nvObj_t *nv) { text_print(nv, fmt_ramsu);} // TYPE_INT
+void cs_print_ramhp(nvObj_t *nv) { text_print(nv, fmt_ramhp);} // TYPE_INT
+void cs_print_rampq(nvObj_t *nv) { text_print(nv, fmt_rampq);} // TYPE_INT
+void cs_print_rampr(nvObj_t *nv) { text_print(nv, fmt_rampr);} // TYPE_INT
+void cs_print_ramcm(nvObj_t *nv) { text_print(nv, fmt_ramcm);} // TYPE_INT
+void cs_print_ramnv(nvObj_t *nv) { text_print(nv, fmt_ramnv);} // TYPE_INT
+void cs_print_ramcs(nvObj_t *nv) { text_print(nv, fmt_ramcs);} // TYPE_INT
+
+static const char fmt_lkth[] = "[lkth] link throttle%15d [0=off,1=on]\n";
+static const char fmt_lkt[] = "[lkt]  link line time%14.3f ms\n";
+static const char fmt_lkb[] = "[lkb]  link line length%12.1f bytes\n";
+void cs_print_lkth(nvObj_t *nv) { text_print(nv, fmt_lkth);} // TYPE_INT
+void cs_print_lkt(nvObj_t *nv) { text_print(nv, fmt_lkt);}   // TYPE_FLOAT
+void cs_print_lkb(nvObj_t *nv) { text_print(nv, fmt_lkb);}   // TYPE_FLOAT
+
+#endif // __TEXT_MODE
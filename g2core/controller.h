@@ -34,6 +34,43 @@
 #define SAVED_BUFFER_LEN RX_BUFFER_SIZE // saved buffer size (for reporting only)
 #define OUTPUT_BUFFER_LEN 512           // text buffer size
 
+#ifndef DISPATCH_BATCH_LINES
+#define DISPATCH_BATCH_LINES 4          // most gcode lines _dispatch_command() runs in a pass (1 = one per pass)
+#endif
+#ifndef DISPATCH_BATCH_US
+#define DISPATCH_BATCH_US 200           // ...and it does not start another once this much time has gone
+#endif
+
+// Periods for the _controller_HSM() tasks that don't need to run on every pass (ms)
+#ifndef TASK_LED_MS
+#define TASK_LED_MS 10                  // _led_indicator()
+#endif
+#ifndef TASK_TEMPERATURE_MS
+#define TASK_TEMPERATURE_MS 100         // temperature_callback() - the PID loop runs at this rate anyway
+#endif
+#ifndef TASK_ASSERTIONS_MS
+#define TASK_ASSERTIONS_MS 1000         // _test_system_assertions() - one sweep of all subsystems
+#endif
+#ifndef CONTROLLER_IDLE_SLEEP
+#define CONTROLLER_IDLE_SLEEP true      // WFI between interrupts when there is nothing to do
+#endif
+#ifndef TASK_PERSIST_MS
+#define TASK_PERSIST_MS 100             // cm_deferred_write_callback() and persistence_callback()
+#endif
+#ifndef TASK_ODOMETER_MS
+#define TASK_ODOMETER_MS 1000           // st_odometer_callback()
+#endif
+#ifndef TASK_SPOOL_QUEUE_MS
+#define TASK_SPOOL_QUEUE_MS 100         // spool_queue_callback()
+#endif
+
+// Host link measurement - see _read_line() in controller.cpp
+#define LINK_SAMPLE_MAX_MS 50           // a longer wait for a line is the host pausing, not the link
+#define LINK_FILTER 0.125               // weight of a new sample in the link averages
+
+#define STACK_PAINT 0xA5A5A5A5          // unused stack is painted with this at boot - see {ram:}
+#define STACK_PAINT_MARGIN 16           // words left unpainted below the stack pointer at the time
+
 #define LED_NORMAL_BLINK_RATE 3000      // blink rate for normal operation (in ms)
 #define LED_ALARM_BLINK_RATE 750        // blink rate for alarm state (in ms)
 #define LED_SHUTDOWN_BLINK_RATE 300     // blink rate for shutdown state (in ms)
@@ -68,6 +105,15 @@ typedef struct controllerSingleton {    // main TG controller struct
     commMode comm_mode;                 // ej: 0=text mode sticky, 1=JSON mode sticky, 2=auto mode
     commMode comm_request_mode;         // mode of request (may be different than the setting)
     bool responses_suppressed;          // if true, responses are to be suppressed (for internal-file delivery)
+
+    // host link measurement
+    uint8_t link_throttle;              // {lkth:} hold short moves to the measured line rate
+    float link_ms_per_byte;             // measured time for the link to deliver a byte, 0 until measured
+    float link_bytes_per_line;          // average line length, including the line end
+    uint32_t link_line_tick;            // SysTick when the last line was read
+    uint32_t link_empty_tick;           // SysTick of the latest empty read since then
+    bool link_empty;                    // there has been an empty read since the last line...
+    bool link_waiting;                  // ...and the first came right after that line
     
     // controller serial buffers
     char *bufp;                         // pointer to primary or secondary in buffer
@@ -90,5 +136,46 @@ void controller_run(void);
 void controller_set_connected(bool is_connected);
 void controller_set_muted(bool is_muted);
 bool controller_parse_control(char *p);
+void controller_flush_prefetch(void);
+float controller_line_ms(void);
+
+stat_t cs_get_ramss(nvObj_t *nv);
+stat_t cs_get_ramsu(nvObj_t *nv);
+stat_t cs_get_ramhp(nvObj_t *nv);
+stat_t cs_get_rampq(nvObj_t *nv);
+stat_t cs_get_rampr(nvObj_t *nv);
+stat_t cs_get_ramcm(nvObj_t *nv);
+stat_t cs_get_ramnv(nvObj_t *nv);
+stat_t cs_get_ramcs(nvObj_t *nv);
+stat_t cs_get_lkth(nvObj_t *nv);
+stat_t cs_set_lkth(nvObj_t *nv);
+stat_t cs_get_lkt(nvObj_t *nv);
+stat_t cs_get_lkb(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void cs_print_ramss(nvObj_t *nv);
+    void cs_print_ramsu(nvObj_t *nv);
+    void cs_print_ramhp(nvObj_t *nv);
+    void cs_print_rampq(nvObj_t *nv);
+    void cs_print_rampr(nvObj_t *nv);
+    void cs_print_ramcm(nvObj_t *nv);
+    void cs_print_ramnv(nvObj_t *nv);
+    void cs_print_ramcs(nvObj_t *nv);
+    void cs_print_lkth(nvObj_t *nv);
+    void cs_print_lkt(nvObj_t *nv);
+    void cs_print_lkb(nvObj_t *nv);
+#else
+    #define cs_print_ramss tx_print_stub
+    #define cs_print_ramsu tx_print_stub
+    #define cs_print_ramhp tx_print_stub
+    #define cs_print_rampq tx_print_stub
+    #define cs_print_rampr tx_print_stub
+    #define cs_print_ramcm tx_print_stub
+    #define cs_print_ramnv tx_print_stub
+    #define cs_print_ramcs tx_print_stub
+    #define cs_print_lkth tx_print_stub
+    #define cs_print_lkt tx_print_stub
+    #define cs_print_lkb tx_print_stub
+#endif // __TEXT_MODE
 
 #endif // End of include guard: CONTROLLER_H_ONCE
@@ -32,6 +32,7 @@
 
 #include "coolant.h"
 #include "planner.h"
+#include "spindle.h"
 #include "hardware.h"
 #include "util.h"
 
@@ -61,11 +62,16 @@ void coolant_reset() {
  * coolant_control_immediate() - execute coolant control immediately
  * coolant_control_sync()      - queue a coolant control to the planner buffer
  * _exec_coolant_control()     - actually execute the coolant command
+ *
+ *  A queued coolant start with a spinup delay {cosu:} holds motion for the delay. With
+ *  {spup:1} the delay is overlapped with traverses like a spindle start, and only the
+ *  next feed waits for it (see spindle_spinup_wait_sync()). Resuming from a feedhold and
+ *  coolant_control_immediate() don't wait.
  */
 
 stat_t coolant_control_immediate(coControl control, coSelect select)
 {
-    float value[] = { (float)control };
+    float value[] = { (float)control, 0 };
     bool flags[] = { (select & COOLANT_MIST), (select & COOLANT_FLOOD) };
     _exec_coolant_control(value, flags);
     return(STAT_OK);       
@@ -80,9 +86,11 @@ stat_t coolant_control_sync(coControl control, coSelect select)
     }
     
     // queue the coolant control
-    float value[] = { (float)control };
+    bool spinup = (control == COOLANT_ON) && fp_NOT_ZERO(coolant.spinup_delay);
+    float value[] = { (float)control, (float)spinup };
     bool flags[]  = { (select & COOLANT_MIST), (select & COOLANT_FLOOD) };
     mp_queue_command(_exec_coolant_control, value, flags);
+    spindle.spinup_planned |= (spinup && spindle.spinup_overlap);
     return(STAT_OK);
 }
 
@@ -147,6 +155,13 @@ static void _exec_coolant_control(float* value, bool* flag) {
     if (flag[1]) {          // Flood, M8
         _exec_coolant_helper(coolant.flood, control);
     }
+    if (value[1] != 0) {    // a queued start
+        if (spindle.spinup_overlap) {
+            spindle_spinup_start(coolant.spinup_delay);
+        } else {
+            mp_request_out_of_band_dwell(coolant.spinup_delay);
+        }
+    }
 }
 
 /****************************************************************************************
@@ -165,6 +180,9 @@ stat_t co_set_coph(nvObj_t *nv)
     return (set_integer(nv, (uint8_t &)coolant.flood.pause_enable, 0, 1));
 }
 
+stat_t co_get_cosu(nvObj_t *nv) { return(get_float(nv, coolant.spinup_delay)); }
+stat_t co_set_cosu(nvObj_t *nv) { return(set_float_range(nv, coolant.spinup_delay, 0, SPINDLE_DWELL_MAX)); }
+
 stat_t co_get_comp(nvObj_t *nv) { return(get_integer(nv, coolant.mist.polarity)); }
 stat_t co_set_comp(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)coolant.mist.polarity, 0, 1)); }
 stat_t co_get_cofp(nvObj_t *nv) { return(get_integer(nv, coolant.flood.polarity)); }
@@ -178,12 +196,14 @@ stat_t co_set_cofp(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)coolant.floo
 #ifdef __TEXT_MODE
 
 const char fmt_coph[] = "[coph] coolant pause on hold%7d [0=no,1=pause_on_hold]\n";
+const char fmt_cosu[] = "[cosu] coolant spinup delay%10.1f seconds\n";
 const char fmt_comp[] = "[comp] coolant mist polarity%7d [0=low is ON,1=high is ON]\n";
 const char fmt_cofp[] = "[cofp] coolant flood polarity%6d [0=low is ON,1=high is ON]\n";
 const char fmt_com[]  = "[com]  coolant mist%16d [0=OFF,1=ON]\n";
 const char fmt_cof[]  = "[cof]  coolant flood%15d [0=OFF,1=ON]\n";
 
 void co_print_coph(nvObj_t* nv) { text_print(nv, fmt_coph); }  // TYPE_INT
+void co_print_cosu(nvObj_t* nv) { text_print(nv, fmt_cosu); }  // TYPE_FLOAT
 void co_print_comp(nvObj_t* nv) { text_print(nv, fmt_comp); }  // TYPE_INT
 void co_print_cofp(nvObj_t* nv) { text_print(nv, fmt_cofp); }  // TYPE_INT
 void co_print_com(nvObj_t* nv) { text_print(nv, fmt_com); }    // TYPE_INT
@@ -66,6 +66,7 @@ typedef struct coCoolantChannel {
 typedef struct coCoolant {
     coCoolantChannel_t mist;        // M7 - treated as the "master" for reading pause setting
     coCoolantChannel_t flood;       // M8
+    float       spinup_delay;       // {cosu:} seconds to hold feeds after coolant is turned on
 } coCoolant_t;
 extern coCoolant_t coolant;
 
@@ -81,6 +82,8 @@ stat_t coolant_control_sync(coControl control, coSelect select);
 
 stat_t co_get_coph(nvObj_t *nv);
 stat_t co_set_coph(nvObj_t *nv);
+stat_t co_get_cosu(nvObj_t *nv);
+stat_t co_set_cosu(nvObj_t *nv);
 
 stat_t co_get_comp(nvObj_t *nv);
 stat_t co_set_comp(nvObj_t *nv);
@@ -97,6 +100,7 @@ stat_t co_set_cof(nvObj_t *nv);
 #ifdef __TEXT_MODE
 
 void co_print_coph(nvObj_t* nv);  // coolant pause on hold
+void co_print_cosu(nvObj_t* nv);  // coolant spinup delay
 void co_print_comp(nvObj_t* nv);  // coolant polarity mist
 void co_print_cofp(nvObj_t* nv);  // coolant polarity flood
 void co_print_com(nvObj_t* nv);   // report mist coolant state
@@ -105,6 +109,7 @@ void co_print_cof(nvObj_t* nv);   // report flood coolant state
 #else
 
 #define co_print_coph tx_print_stub
+#define co_print_cosu tx_print_stub
 #define co_print_comp tx_print_stub
 #define co_print_cofp tx_print_stub
 #define co_print_com tx_print_stub
@@ -0,0 +1,99 @@
+/*
+ * cpuload.cpp - where the CPU time goes, for status reports
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "cpuload.h"
+#include "text_parser.h"
+#include "util.h"
+
+ldSingleton_t ld;
+
+/*
+ * cpuload_init()     - start the first window
+ * cpuload_callback() - close the window every LOAD_WINDOW_MS - from the main loop
+ *
+ *  The window is measured in cycles, so it doesn't matter if the callback runs late.
+ */
+
+void cpuload_init()
+{
+    memset(&ld, 0, sizeof(ld));
+    ld.window_start = cycle_count();
+}
+
+stat_t cpuload_callback()
+{
+    uint32_t now = cycle_count();
+    uint32_t window = now - ld.window_start;
+    if (window == 0) {
+        return (STAT_NOOP);
+    }
+    ld.load = 0;
+    for (uint8_t s = 0; s < LOAD_SOURCES; s++) {
+        uint32_t cycles = ld.cycles[s];
+        ld.percent[s] = min(100.0f, (float)(cycles - ld.window_cycles[s]) * 100 / window);
+        ld.window_cycles[s] = cycles;
+        ld.load += ld.percent[s];
+    }
+    ld.load = min(100.0f, ld.load);
+    ld.window_start = now;
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+stat_t ld_get_load(nvObj_t *nv) { return (get_float(nv, ld.load)); }
+stat_t ld_get_ldd(nvObj_t *nv) { return (get_float(nv, ld.percent[LOAD_DDA])); }
+stat_t ld_get_lde(nvObj_t *nv) { return (get_float(nv, ld.percent[LOAD_EXEC])); }
+stat_t ld_get_ldp(nvObj_t *nv) { return (get_float(nv, ld.percent[LOAD_FWD_PLAN])); }
+stat_t ld_get_ldc(nvObj_t *nv) { return (get_float(nv, ld.percent[LOAD_COMMS])); }
+stat_t ld_get_ldm(nvObj_t *nv) { return (get_float(nv, ld.percent[LOAD_MAIN])); }
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_load[] = "CPU load:%21.1f %%\n";
+static const char fmt_ldd[] = "CPU DDA interrupt:%12.1f %%\n";
+static const char fmt_lde[] = "CPU exec interrupt:%11.1f %%\n";
+static const char fmt_ldp[] = "CPU planning interrupt:%7.1f %%\n";
+static const char fmt_ldc[] = "CPU comms:%20.1f %%\n";
+static const char fmt_ldm[] = "CPU main loop:%16.1f %%\n";
+
+void ld_print_load(nvObj_t *nv) { text_print(nv, fmt_load);}   // TYPE_FLOAT
+void ld_print_ldd(nvObj_t *nv) { text_print(nv, fmt_ldd);}     // TYPE_FLOAT
+void ld_print_lde(nvObj_t *nv) { text_print(nv, fmt_lde);}     // TYPE_FLOAT
+void ld_print_ldp(nvObj_t *nv) { text_print(nv, fmt_ldp);}     // TYPE_FLOAT
+void ld_print_ldc(nvObj_t *nv) { text_print(nv, fmt_ldc);}     // TYPE_FLOAT
+void ld_print_ldm(nvObj_t *nv) { text_print(nv, fmt_ldm);}     // TYPE_FLOAT
+
+#endif // __TEXT_MODE
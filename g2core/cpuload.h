@@ -0,0 +1,142 @@
+/*
+ * cpuload.h - where the CPU time goes, for status reports
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * CPU LOAD
+ *
+ *  The DWT cycle counter is read at the entry and exit of each interrupt priority and of
+ *  the main loop's real work, and the cycles are summed per source. Every LOAD_WINDOW_MS
+ *  the sums are turned into percentages of the cycles in the window:
+ *
+ *    {load:n}  all of the below - 100 means the controller is saturated
+ *    {ldd:n}   DDA interrupt, including the _load_move() it runs at the end of a segment
+ *    {lde:n}   exec interrupt - mp_exec_move() and st_prep_line()
+ *    {ldp:n}   forward planning interrupt
+ *    {ldc:n}   comms - xio reads and writes on the main loop
+ *    {ldm:n}   main loop - dispatching lines (parse and execute), prefetch, arcs and back-planning
+ *
+ *  They can be put in status reports like any other value, e.g. {sr:{load:t,ldd:t}}. The rest
+ *  of the time is idle: the main loop sleeping in WFI, or polling tasks that have nothing to do.
+ *
+ *  Each source only counts its own time. A source preempted by a higher one (lower in the
+ *  list above, the other way round for the main loop) takes off the cycles the higher ones
+ *  added while it ran, so the sum can't pass 100. The USB and UART interrupts are in Motate
+ *  and aren't measured - their time is counted in whatever they interrupted.
+ *
+ *  The DDA pays two cycle counter reads a tick. Set LOAD_MEASURE false in hardware.h to
+ *  build without the measurement, and the values read 0.
+ */
+
+#ifndef CPULOAD_H_ONCE
+#define CPULOAD_H_ONCE
+
+#include "config.h"  // needed for nvObj_t definition
+#include "util.h"
+
+#ifndef LOAD_MEASURE
+#define LOAD_MEASURE true
+#endif
+#define LOAD_WINDOW_MS 1000             // percentages are over this long - keep it under 2^32 cycles
+
+typedef enum {                          // highest priority first
+    LOAD_DDA = 0,
+    LOAD_EXEC,
+    LOAD_FWD_PLAN,
+    LOAD_COMMS,                         // main loop sources nest the other way round: comms
+    LOAD_MAIN,                          // ...is taken off main, as main calls xio
+    LOAD_SOURCES
+} ldSource;
+
+typedef struct ldSingleton {
+    volatile uint32_t cycles[LOAD_SOURCES]; // running sums, each written by its own source only
+    uint32_t window_start;              // cycle count at the start of the window
+    uint32_t window_cycles[LOAD_SOURCES];   // sums at the start of the window
+    float percent[LOAD_SOURCES];        // last window
+    float load;                         // sum of percent[]
+} ldSingleton_t;
+
+extern ldSingleton_t ld;
+
+/*
+ * ldScope - count the cycles from here to the end of the block against a source
+ *
+ *  The cycles the sources above it added in the meantime are taken off. Put one at the top
+ *  of an ISR, or around main loop work: { ldScope _ld(LOAD_MAIN); work(); }
+ */
+
+#if LOAD_MEASURE == true
+
+static inline uint32_t ld_above(const uint8_t source)
+{
+    uint32_t sum = 0;
+    for (uint8_t s = 0; s < source; s++) {
+        sum += ld.cycles[s];
+    }
+    return (sum);
+}
+
+struct ldScope {
+    const uint8_t source;
+    const uint32_t start;
+    const uint32_t above;
+
+    ldScope(const uint8_t _source) : source(_source), start(cycle_count()), above(ld_above(_source)) {}
+    ~ldScope() { ld.cycles[source] += (cycle_count() - start) - (ld_above(source) - above); }
+};
+
+#else
+
+struct ldScope {
+    ldScope(const uint8_t _source) {}
+};
+
+#endif
+
+void cpuload_init(void);
+stat_t cpuload_callback(void);
+
+stat_t ld_get_load(nvObj_t *nv);
+stat_t ld_get_ldd(nvObj_t *nv);
+stat_t ld_get_lde(nvObj_t *nv);
+stat_t ld_get_ldp(nvObj_t *nv);
+stat_t ld_get_ldc(nvObj_t *nv);
+stat_t ld_get_ldm(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void ld_print_load(nvObj_t *nv);
+    void ld_print_ldd(nvObj_t *nv);
+    void ld_print_lde(nvObj_t *nv);
+    void ld_print_ldp(nvObj_t *nv);
+    void ld_print_ldc(nvObj_t *nv);
+    void ld_print_ldm(nvObj_t *nv);
+#else
+    #define ld_print_load tx_print_stub
+    #define ld_print_ldd tx_print_stub
+    #define ld_print_lde tx_print_stub
+    #define ld_print_ldp tx_print_stub
+    #define ld_print_ldc tx_print_stub
+    #define ld_print_ldm tx_print_stub
+#endif
+
+#endif  // End of include guard: CPULOAD_H_ONCE
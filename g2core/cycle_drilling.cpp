@@ -0,0 +1,331 @@
+/*
+ * cycle_drilling.cpp - canned drilling cycles (G73, G81, G82, G83)
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * DRILLING CYCLES
+ *
+ *  A drilling cycle is one line per hole - the cycle and its words are modal, so
+ *  "G81 X10 Y10 Z-5 R1 F100" is followed by lines of "X20 Y10" until G80 or another
+ *  motion mode. The moves of each hole are queued from cm_drill_callback() as planner
+ *  space frees up, the same way cm_arc_callback() queues arc segments.
+ *
+ *    G81  rapid to XY, rapid to R, feed to Z, rapid out
+ *    G82  same, with a dwell of P seconds at Z
+ *    G83  peck Q at a time, rapid out to R after each peck
+ *    G73  peck Q at a time, backing off DRILL_PECK_CLEARANCE after each peck to break the chip
+ *
+ *  The cycle retracts to the R plane in G99, and in G98 to the Z it started from, or R
+ *  if that is higher. If the cycle starts below R it first rapids up to R. In G91 R is
+ *  from the starting Z, Z is from R, XY is from the last hole and L repeats the hole that
+ *  many times. R, Z, P and Q are sticky while the machine stays in a drilling cycle.
+ *  Cycles run in the G17 plane only.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "util.h"
+
+#define DRILL_PECK_CLEARANCE ((float)0.25)  // mm a G73 backs off, and a G83 stops short of the last peck
+
+static stat_t _drill_step(cmMachine_t *_cm);
+
+static bool _is_drill_cycle(const cmMotionMode motion_mode)
+{
+    return ((motion_mode == MOTION_MODE_CANNED_CYCLE_73) ||
+            (motion_mode == MOTION_MODE_CANNED_CYCLE_81) ||
+            (motion_mode == MOTION_MODE_CANNED_CYCLE_82) ||
+            (motion_mode == MOTION_MODE_CANNED_CYCLE_83));
+}
+
+/*
+ * cm_drill_init() - initialize drilling cycle structures
+ */
+
+void cm_drill_init(cmMachine_t *_cm)
+{
+    _cm->drill.magic_start = MAGICNUM;
+    _cm->drill.magic_end = MAGICNUM;
+}
+
+/*
+ * cm_abort_drill() - stop a drilling cycle without maintaining position
+ *
+ *  OK to call if no cycle is running
+ */
+
+void cm_abort_drill(cmMachine_t *_cm)
+{
+    _cm->drill.run_state = BLOCK_INACTIVE;
+}
+
+/*
+ * cm_set_retract_mode() - G98, G99
+ */
+
+stat_t cm_set_retract_mode(const uint8_t mode)
+{
+    cm->drill.retract_mode = (cmRetractMode)mode;
+    return (STAT_OK);
+}
+
+/*
+ * cm_drill_cycle() - canonical machine entry point for G73, G81, G82 and G83
+ *
+ *  Checks the cycle and sets it up to run from the callback. The model position is set to
+ *  the end of the cycle - above the last hole at the clearance plane - right away.
+ */
+
+stat_t cm_drill_cycle(const float target[], const bool target_f[],
+                      const float R_word, const bool R_word_f,
+                      const float P_word, const bool P_word_f,
+                      const float Q_word, const bool Q_word_f,
+                      const uint8_t L_word, const bool L_word_f,
+                      const bool modal_g1_f,
+                      const cmMotionMode motion_mode)
+{
+    cmDrill_t *d = &cm->drill;
+
+    // as with arcs, a block with no position words while in the cycle is not a hole
+    if ((!modal_g1_f) && (!(target_f[AXIS_X] | target_f[AXIS_Y] | target_f[AXIS_Z] | R_word_f))) {
+        return (STAT_OK);
+    }
+    if (cm->gm.select_plane != CANON_PLANE_XY) {
+        return (STAT_ACTIVE_PLANE_IS_INVALID);
+    }
+    if (cm->gm.feed_rate_mode == INVERSE_TIME_MODE) {
+        return (STAT_INVERSE_TIME_MODE_CANNOT_BE_USED);
+    }
+    if (fp_ZERO(cm->gm.feed_rate)) {
+        return (STAT_FEEDRATE_NOT_SPECIFIED);
+    }
+
+    // resolve the sticky words, which a new cycle must supply
+    bool starting = !_is_drill_cycle(cm->gm.motion_mode);
+    if (starting && !target_f[AXIS_Z]) {
+        return (STAT_AXIS_IS_MISSING);
+    }
+    if (starting && !R_word_f) {
+        return (STAT_R_WORD_IS_MISSING);
+    }
+    float z = target_f[AXIS_Z] ? _to_millimeters(target[AXIS_Z]) : d->Z_word;
+    float r = R_word_f ? _to_millimeters(R_word) : d->R_word;
+    float q = Q_word_f ? _to_millimeters(Q_word) : (starting ? 0 : d->Q_word);
+    float p = P_word_f ? P_word : (starting ? 0 : d->P_word);
+
+    if (Q_word_f && (q <= 0)) {
+        return (STAT_Q_WORD_IS_INVALID);
+    }
+    if (((motion_mode == MOTION_MODE_CANNED_CYCLE_73) || (motion_mode == MOTION_MODE_CANNED_CYCLE_83)) && (q <= 0)) {
+        return (STAT_Q_WORD_IS_MISSING);
+    }
+    if (p < 0) {
+        return (STAT_P_WORD_IS_NEGATIVE);
+    }
+    if (L_word_f && (L_word == 0)) {
+        return (STAT_L_WORD_IS_INVALID);
+    }
+
+    // locate the planes and the first hole in the model coordinate system
+    float start_z = cm->gmx.position[AXIS_Z];
+    float r_plane, bottom, hole[2], hole_step[2];
+    for (uint8_t axis = AXIS_X; axis <= AXIS_Y; axis++) {
+        float value = target_f[axis] ? _to_millimeters(target[axis]) : 0;
+        if (cm->gm.distance_mode == ABSOLUTE_DISTANCE_MODE) {
+            hole[axis] = target_f[axis] ? cm_get_combined_offset(axis) + value : cm->gmx.position[axis];
+            hole_step[axis] = 0;
+        } else {
+            hole[axis] = cm->gmx.position[axis] + value;
+            hole_step[axis] = value;
+        }
+    }
+    if (cm->gm.distance_mode == ABSOLUTE_DISTANCE_MODE) {
+        r_plane = cm_get_combined_offset(AXIS_Z) + r;
+        bottom = cm_get_combined_offset(AXIS_Z) + z;
+    } else {
+        r_plane = start_z + r;
+        bottom = r_plane + z;
+    }
+    if (bottom > r_plane) {
+        return (STAT_R_WORD_IS_INVALID);                // the R plane must be above the bottom
+    }
+    float clear_z = r_plane;
+    if (d->retract_mode == RETRACT_TO_INITIAL) {
+        clear_z = std::max(start_z, r_plane);
+    }
+    uint8_t holes = L_word_f ? L_word : 1;
+
+    // test the corners of the cycle's travel - the holes are in a line
+    float limit[AXES];
+    copy_vector(limit, cm->gmx.position);
+    for (uint8_t corner = 0; corner < 4; corner++) {
+        uint8_t n = (corner & 1) ? holes-1 : 0;
+        limit[AXIS_X] = hole[AXIS_X] + hole_step[AXIS_X] * n;
+        limit[AXIS_Y] = hole[AXIS_Y] + hole_step[AXIS_Y] * n;
+        limit[AXIS_Z] = (corner & 2) ? std::max(start_z, r_plane) : bottom;
+        ritorno(cm_test_soft_limits(limit));
+    }
+
+    // commit the cycle
+    d->cycle = motion_mode;
+    d->Z_word = z;
+    d->R_word = r;
+    d->Q_word = q;
+    d->P_word = p;
+    d->hole[AXIS_X] = hole[AXIS_X];
+    d->hole[AXIS_Y] = hole[AXIS_Y];
+    d->hole_step[AXIS_X] = hole_step[AXIS_X];
+    d->hole_step[AXIS_Y] = hole_step[AXIS_Y];
+    d->holes = holes;
+    d->r_plane = r_plane;
+    d->bottom = bottom;
+    d->clear_z = clear_z;
+
+    cm->gm.motion_mode = motion_mode;
+    cm_set_display_offsets(&cm->gm);                    // capture the fully resolved offsets to gm
+    copy_vector(cm->gm.target, cm->gmx.position);
+    memcpy(&d->gm, &cm->gm, sizeof(GCodeState_t));      // the cycle's moves start from the model position
+
+    cm->gm.target[AXIS_X] = limit[AXIS_X];              // the model ends above the last hole
+    cm->gm.target[AXIS_Y] = limit[AXIS_Y];
+    cm->gm.target[AXIS_Z] = clear_z;
+
+    d->step = DRILL_CLEAR;
+    d->run_state = BLOCK_ACTIVE;                        // enable the cycle to be run from the callback
+    cm_cycle_start();                                   // if not already started
+    cm_update_model_position();
+    return (STAT_OK);
+}
+
+/*
+ * cm_drill_callback() - queue the moves of a drilling cycle
+ *
+ *  Called from the controller main loop. Queues moves until the planner is down to
+ *  PLANNER_BUFFER_HEADROOM, then returns STAT_EAGAIN - which also holds off the next
+ *  Gcode block until the whole cycle is queued.
+ */
+
+stat_t cm_drill_callback(cmMachine_t *_cm)
+{
+    if (_cm->drill.run_state == BLOCK_INACTIVE) {
+        return (STAT_NOOP);
+    }
+    while (!mp_planner_is_full(mp)) {
+        if (_drill_step(_cm) == STAT_OK) {
+            _cm->drill.run_state = BLOCK_INACTIVE;
+            if (!mp_has_runnable_buffer(mp)) {          // the whole cycle may have been zero length moves
+                cm_cycle_end();
+            }
+            return (STAT_OK);
+        }
+    }
+    return (STAT_EAGAIN);
+}
+
+/*
+ * _drill_move() - queue a rapid or feed to XY and Z, unless it's already there
+ * _drill_step() - queue the next move of the cycle. Returns STAT_OK after the last one
+ */
+
+static void _drill_move(cmDrill_t *d, const cmMotionMode motion_mode, const float x, const float y, const float z)
+{
+    if (fp_EQ(d->gm.target[AXIS_X], x) && fp_EQ(d->gm.target[AXIS_Y], y) && fp_EQ(d->gm.target[AXIS_Z], z)) {
+        return;
+    }
+    d->gm.motion_mode = motion_mode;
+    d->gm.target[AXIS_X] = x;
+    d->gm.target[AXIS_Y] = y;
+    d->gm.target[AXIS_Z] = z;
+    mp_aline(&d->gm);
+}
+
+static void _drill_z(cmDrill_t *d, const cmMotionMode motion_mode, const float z)
+{
+    _drill_move(d, motion_mode, d->gm.target[AXIS_X], d->gm.target[AXIS_Y], z);
+}
+
+static stat_t _drill_step(cmMachine_t *_cm)
+{
+    cmDrill_t *d = &_cm->drill;
+    bool pecking = (d->cycle == MOTION_MODE_CANNED_CYCLE_73) || (d->cycle == MOTION_MODE_CANNED_CYCLE_83);
+
+    switch (d->step) {
+        case DRILL_CLEAR: {
+            if (d->gm.target[AXIS_Z] < d->r_plane) {
+                _drill_z(d, MOTION_MODE_STRAIGHT_TRAVERSE, d->r_plane);
+            }
+            d->step = DRILL_HOLE;
+            break;
+        }
+        case DRILL_HOLE: {
+            _drill_move(d, MOTION_MODE_STRAIGHT_TRAVERSE, d->hole[AXIS_X], d->hole[AXIS_Y], d->gm.target[AXIS_Z]);
+            d->step = DRILL_R_PLANE;
+            break;
+        }
+        case DRILL_R_PLANE: {
+            _drill_z(d, MOTION_MODE_STRAIGHT_TRAVERSE, d->r_plane);
+            d->depth = d->r_plane;
+            d->step = DRILL_FEED;
+            break;
+        }
+        case DRILL_REENTER: {
+            _drill_z(d, MOTION_MODE_STRAIGHT_TRAVERSE, std::min(d->depth + DRILL_PECK_CLEARANCE, d->r_plane));
+            d->step = DRILL_FEED;
+            break;
+        }
+        case DRILL_FEED: {
+            d->depth = pecking ? std::max(d->depth - d->Q_word, d->bottom) : d->bottom;
+            _drill_z(d, MOTION_MODE_STRAIGHT_FEED, d->depth);
+            if (d->depth > d->bottom) {
+                d->step = DRILL_PECK_RETRACT;
+            } else if ((d->cycle == MOTION_MODE_CANNED_CYCLE_82) && (d->P_word > 0)) {
+                d->step = DRILL_DWELL;
+            } else {
+                d->step = DRILL_RETRACT;
+            }
+            break;
+        }
+        case DRILL_PECK_RETRACT: {
+            if (d->cycle == MOTION_MODE_CANNED_CYCLE_73) {
+                _drill_z(d, MOTION_MODE_STRAIGHT_TRAVERSE, std::min(d->depth + DRILL_PECK_CLEARANCE, d->r_plane));
+                d->step = DRILL_FEED;
+            } else {
+                _drill_z(d, MOTION_MODE_STRAIGHT_TRAVERSE, d->r_plane);
+                d->step = DRILL_REENTER;
+            }
+            break;
+        }
+        case DRILL_DWELL: {
+            mp_dwell(d->P_word);
+            d->step = DRILL_RETRACT;
+            break;
+        }
+        case DRILL_RETRACT: {
+            _drill_z(d, MOTION_MODE_STRAIGHT_TRAVERSE, d->clear_z);
+            if (--d->holes == 0) {
+                return (STAT_OK);
+            }
+            d->hole[AXIS_X] += d->hole_step[AXIS_X];
+            d->hole[AXIS_Y] += d->hole_step[AXIS_Y];
+            d->step = DRILL_HOLE;
+            break;
+        }
+    }
+    return (STAT_EAGAIN);
+}
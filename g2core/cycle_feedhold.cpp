@@ -29,6 +29,7 @@
 #include "g2core.h"     // #1
 #include "config.h"     // #2
 #include "gcode.h"      // #3
+#include "controller.h"
 #include "canonical_machine.h"
 #include "planner.h"
 #include "plan_arc.h"
@@ -36,8 +37,11 @@
 #include "spindle.h"
 #include "coolant.h"
 #include "util.h"
+#include "spool.h"
 //#include "xio.h"        // DIAGNOSTIC
 
+#include <stddef.h>     // for offsetof()
+
 //static void _start_feedhold(void);
 static void _start_cycle_restart(void);
 static void _start_queue_flush(void);
@@ -339,6 +343,7 @@ void cm_request_cycle_start()
             cm1.cycle_start_state = CYCLE_START_REQUESTED; 
         }
     } else {                                        // execute cycle start directly
+        spool_queue_cycle_start();                  // may release a job queue waiting for the operator
         if (mp_has_runnable_buffer(&mp1)) {
             cm_cycle_start();
             st_request_exec_move();
@@ -410,7 +415,11 @@ static void _start_queue_flush()
 static stat_t _run_queue_flush()            // typically runs from cm1 planner
 {
     cm_abort_arc(cm);                       // kill arcs so they don't just create more alines
+    cm_abort_drill(cm);                     // and drilling cycles
+    spindle_sync_end();                     // and drop the lock of a spindle synchronized move
     planner_reset((mpPlanner_t *)cm->mp);   // reset primary planner. also resets the mr under the planner
+    controller_flush_prefetch();            // drop the lines read ahead of the planner, like the rest of the input
+    spool_queue_abort();                    // the spooled job's file has been flushed too
     cm_reset_position_to_absolute_position(cm);
     cm1.queue_flush_state = QUEUE_FLUSH_OFF;
     qr_request_queue_report(0);             // request a queue report, since we've changed the number of buffers available
@@ -540,6 +549,13 @@ void cm_request_feedhold(cmFeedholdType type, cmFeedholdExit exit)
             case FEEDHOLD_EXIT_RESET_POSITION: { op.add_action(_run_reset_position); break; }
             default: {}
         }
+        // Start the deceleration now rather than when the operation first runs. The exec
+        // picks up SYNC on its next segment, so the stop begins without waiting for the
+        // controller to come around again. The hold actions see SYNC and wait for the stop.
+        if (cm1.hold_type != FEEDHOLD_TYPE_SCRAM) {     // SCRAM has no hold action to finish the hold
+            cm1.hold_distance = 0;
+            cm1.hold_state = FEEDHOLD_SYNC;
+        }
         return;
     }
 
@@ -574,26 +590,46 @@ static void _start_p2_feedhold()
  * Encapsulate entering and exiting p2, as this is tricky and must be done exactly right
  */
 
+/*
+ *  cm2 is initialized at startup with its own planner (mp2/mr2) and arc, so entering p2
+ *  copies only what p1 can have changed since. The configuration block (system settings,
+ *  offsets, axis settings and gcode defaults) is copied only when cm_config_generation says
+ *  something was written since the last entry. The runtime flags and the gcode models are
+ *  always transferred - they are small and describe where p1 stopped.
+ */
+#define CM_CONFIG_START  offsetof(cmMachine_t, junction_integration_time)
+#define CM_RUNTIME_START offsetof(cmMachine_t, machine_state)
+#define CM_RUNTIME_END   offsetof(cmMachine_t, mp)
+
+static uint16_t _p2_config_generation = 0;  // generation of the cm1 configuration held in cm2
+
 static void _enter_p2()
 {
-    // Copy the primary canonical machine to the secondary. Here it's OK to co a memcpy.
+    // Transfer state from the primary canonical machine to the secondary
+    if (_p2_config_generation != cm_config_generation) {
+        memcpy((char *)&cm2 + CM_CONFIG_START, (char *)&cm1 + CM_CONFIG_START, CM_RUNTIME_START - CM_CONFIG_START);
+        _p2_config_generation = cm_config_generation;
+    }
+    memcpy((char *)&cm2 + CM_RUNTIME_START, (char *)&cm1 + CM_RUNTIME_START, CM_RUNTIME_END - CM_RUNTIME_START);
+    cm2.gm = cm1.gm;
+    cm2.gmx = cm1.gmx;
+    cm2.am = &cm2.gm;                       // motion has stopped, so the active model is the model
+
     // Set parameters in cm, gm and gmx so you can actually use it
-    memcpy(&cm2, &cm1, sizeof(cmMachine_t));
     cm2.hold_state = FEEDHOLD_OFF;
     cm2.gm.motion_mode = MOTION_MODE_CANCEL_MOTION_MODE;
     cm2.gm.absolute_override = ABSOLUTE_OVERRIDE_OFF;
     cm2.queue_flush_state = QUEUE_FLUSH_OFF;
     cm2.gm.feed_rate = 0;
     cm2.arc.run_state = BLOCK_INACTIVE;     // Stop a running p1 arc from continuing to execute in p2
+    cm2.drill.run_state = BLOCK_INACTIVE;   // ...or a drilling cycle
 
-    // Set mp planner to p2 and reset it
-    cm2.mp = &mp2;
+    // Reset the p2 planner. cm2.mp was linked to mp2 by canonical_machine_init()
     planner_reset((mpPlanner_t *)cm2.mp);   // mp is a void pointer
 
     // Clear the target and set the positions to the current hold position
     memset(&(cm2.return_flags), 0, sizeof(cm2.return_flags));
     memset(&(cm2.gm.target), 0, sizeof(cm2.gm.target));
-    memset(&(cm2.gm.target_comp), 0, sizeof(cm2.gm.target_comp)); // zero Kahan compensation
 
     copy_vector(cm2.gmx.position, mr1.position);
     copy_vector(mp2.position, mr1.position);
@@ -630,10 +666,12 @@ static void _check_motion_stopped()
             copy_vector(mp->position, mr->position);    // update planner position to the final runtime position
             mp_free_run_buffer();                       // advance to next block, discarding the rest of the move
         } else { // Otherwise setup the block to complete motion (regardless of how hold will ultimately be exited)
+            mp_hold_sync_output(bf);                    // outputs not switched yet go with the rest of the move
             bf->length = get_axis_vector_length(mr->position, mr->target); // update bf w/remaining length in move
             bf->block_state = BLOCK_INITIAL_ACTION;     // tell _exec to re-use the bf buffer
             bf->buffer_state = MP_BUFFER_BACK_PLANNED;  // so it can be forward planned again
             bf->plannable = true;                       // needed so block can be re-planned
+            bf->converged = false;
         }
         mr->reset();                                    // reset MR for next use and for forward planning
         cm_set_motion_state(MOTION_STOP);
@@ -659,8 +697,8 @@ static stat_t _feedhold_skip()
 
 static stat_t _feedhold_no_actions()
 {
-    // initiate the feedhold
-    if (cm1.hold_state == FEEDHOLD_OFF) {       // start a feedhold
+    // initiate the feedhold - SYNC was set by the request, but motion may have stopped before exec saw it
+    if ((cm1.hold_state == FEEDHOLD_OFF) || (cm1.hold_state == FEEDHOLD_SYNC)) {
         cm1.hold_type = FEEDHOLD_TYPE_HOLD;
 //      cm1.hold_exit = FEEDHOLD_EXIT_STOP;     // default exit for NO_ACTIONS is STOP...
 
@@ -692,8 +730,8 @@ static void _feedhold_actions_done_callback(float* vect, bool* flag)
 
 static stat_t _feedhold_with_actions()          // Execute Case (5)
 {
-    // if entered while OFF start a feedhold
-    if (cm1.hold_state == FEEDHOLD_OFF) {
+    // if entered while OFF start a feedhold - SYNC was set by the request, but motion may have stopped before exec saw it
+    if ((cm1.hold_state == FEEDHOLD_OFF) || (cm1.hold_state == FEEDHOLD_SYNC)) {
         cm1.hold_type = FEEDHOLD_TYPE_ACTIONS;
 //      cm1.hold_exit = FEEDHOLD_EXIT_STOP;     // default exit for ACTIONS is STOP...
         if (cm1.motion_state == MOTION_STOP) {  // if motion has already stopped declare that you are in a feedhold
@@ -36,30 +36,44 @@
 #include "encoder.h"
 #include "kinematics.h"
 #include "gpio.h"
+#include "stepper.h"
 #include "report.h"
 #include "util.h"
 
 /**** Homing singleton structure ****/
 
+static_assert(D_IN_CHANNELS <= 32, "homing input bitmasks hold at most 32 inputs");
+
+typedef struct hmAxis {             // per-axis parameters
+    uint32_t input_mask;            // homing input(s) for the axis as bits (bit 0 = input 1)
+    float search_travel;            // signed distance to travel in search
+    float search_velocity;          // search speed as positive number
+    float latch_backoff;            // max distance to back off switch during latch phase
+    float latch_velocity;           // latch speed as positive number
+    float zero_backoff;             // distance to back off switch before setting zero
+    float setpoint;                 // ultimate setpoint, usually zero, but not always
+    float saved_jerk;               // saved and restored for each axis homed
+} hmAxis_t;
+
 struct hmHomingSingleton {          // persistent homing runtime variables
                                     // controls for homing cycle
     bool   waiting_for_motion_end;  // true when waiting for motion to complete.
     int8_t axis;                    // axis currently being homed
     int8_t homing_input;            // homing input for current axis
+    bool   sensorless;              // current axis homes on motor stall instead of an input
+    volatile bool stall_armed;      // a stall ends the current search or latch move
     bool   set_coordinates;         // G28.4 flag. true = set coords to zero at the end of homing cycle
     stat_t (*func)(int8_t axis);    // binding for callback function state machine
 
     bool axis_flags[AXES];          // local storage for axis flags
+    hmAxis_t ax[AXES];              // per-axis parameters
 
-    // per-axis parameters
-    float direction;                // set to 1 for positive (max), -1 for negative (to min);
-    float search_travel;            // signed distance to travel in search
-    float search_velocity;          // search speed as positive number
-    float latch_backoff;            // max distance to back off switch during latch phase
-    float latch_velocity;           // latch speed as positive number
-    float zero_backoff;             // distance to back off switch before setting zero
-    float max_clear_backoff;        // maximum distance of switch clearing backoffs before erring out
-    float setpoint;                 // ultimate setpoint, usually zero, but not always
+    // group homing - several axes, or both sides of a squared gantry, in one pass
+    bool group[AXES];                       // axes being homed in the current group pass
+    volatile bool group_active;             // a group pass owns the homing inputs
+    volatile uint32_t pending_inputs;       // inputs yet to fire in the current search or latch move
+    uint16_t input_motors[D_IN_CHANNELS];   // motors each input stops during a group pass
+    uint8_t square_motor;                   // next motor to check for a gantry squaring offset
 
     // state saved from gcode model
     cmUnitsMode    saved_units_mode;      // G20,G21 global setting
@@ -67,7 +81,6 @@ struct hmHomingSingleton {          // persistent homing runtime variables
     cmDistanceMode saved_distance_mode;   // G90, G91 global setting
     cmFeedRateMode saved_feed_rate_mode;  // G93, G94 global setting
     float          saved_feed_rate;       // F setting
-    float          saved_jerk;            // saved and restored for each axis homed
 };
 static struct hmHomingSingleton hm;
 
@@ -75,6 +88,7 @@ static struct hmHomingSingleton hm;
 
 static stat_t _set_homing_func(stat_t (*func)(int8_t axis));
 static stat_t _homing_axis_start(int8_t axis);
+static stat_t _homing_axis_init(int8_t axis);
 static stat_t _homing_axis_clear_init(int8_t axis);
 static stat_t _homing_axis_search(int8_t axis);
 static stat_t _homing_axis_clear(int8_t axis);
@@ -82,6 +96,16 @@ static stat_t _homing_axis_latch(int8_t axis);
 static stat_t _homing_axis_setpoint_backoff(int8_t axis);
 static stat_t _homing_axis_set_position(int8_t axis);
 static stat_t _homing_axis_move(int8_t axis, float target, float velocity);
+static uint8_t _homing_group_select(int8_t axis);
+static stat_t _homing_group_start(int8_t axis);
+static stat_t _homing_group_clear_init(int8_t axis);
+static stat_t _homing_group_search(int8_t axis);
+static stat_t _homing_group_clear(int8_t axis);
+static stat_t _homing_group_latch(int8_t axis);
+static stat_t _homing_group_square(int8_t axis);
+static stat_t _homing_group_setpoint_backoff(int8_t axis);
+static stat_t _homing_group_set_position(int8_t axis);
+static void _homing_group_release(void);
 static stat_t _homing_error_exit(int8_t axis, stat_t status);
 static stat_t _homing_finalize_exit(int8_t axis);
 static int8_t _get_next_axis(int8_t axis);
@@ -128,6 +152,23 @@ static int8_t _get_next_axis(int8_t axis);
  *
  *  Once all moves for an axis are complete the next axis in the sequence is homed
  *
+ *  Group homing runs the same steps for several axes in one pass - each axis keeps its
+ *  own parameters and switch, and each move is a single multi-axis move. A switch hit
+ *  stops only the motors of its own axis (st_inhibit_motors()) and the move is ended
+ *  with a feedhold once every switch in the pass has fired. A group pass is used:
+ *
+ *    - when simultaneous homing is enabled {hsm:1}. Z is still homed first on its own,
+ *      then all remaining flagged axes with switches not shared with any other axis
+ *      are homed together. Axes with shared switches are homed one at a time after.
+ *    - for a gantry-squared axis - an axis with a second homing input {xhs:N}. The
+ *      first motor mapped to the axis stops on the homing input, the other motor(s)
+ *      on the second input, so each side of the gantry is latched on its own switch.
+ *      After the latch each of these motors with a squaring offset {1sq:} is stepped that
+ *      far on its own, to take out any difference between the two switches, then all the
+ *      motors are locked back together for the backoff.
+ *
+ *  G28.4 always homes one axis at a time.
+ *
  *  When a homing cycle is initiated the homing state is set to HOMING_NOT_HOMED
  *  When homing completes successfully this is set to HOMING_HOMED, otherwise it
  *  remains HOMING_NOT_HOMED.
@@ -165,6 +206,7 @@ stat_t cm_homing_cycle_start(const float axes[], const bool flags[]) {
 
     // clear rotation matrix
     canonical_machine_reset_rotation(cm);
+    _homing_group_release();                // left over if the last cycle was halted
 
     hm.axis          = -1;                  // set to retrieve initial axis
     hm.func          = _homing_axis_start;  // bind initial processing function
@@ -220,11 +262,61 @@ static stat_t _homing_axis_start(int8_t axis) {
             return (_homing_error_exit(-2, STAT_HOMING_ERROR_BAD_OR_NO_AXIS));
         }
     }
+    hm.axis = axis;                                             // persist the axis
+    if (_homing_group_select(axis)) {                           // home with other axes or as a gantry
+        return (_set_homing_func(_homing_group_start));
+    }
+    ritorno(_homing_axis_init(axis));
+
+    // Nothing to do about direction now that direction is explicit
+    // However, here's a good place to stash the homing_switch:
+    hm.homing_input = cm->a[axis].homing_input;
+    hm.sensorless = (hm.homing_input == 0);                     // _homing_axis_init() checked it can sense stalls
+    gpio_set_homing_mode(hm.homing_input, true);
+    return (_set_homing_func(_homing_axis_clear_init));         // perform an initial clear
+}
+
+/***********************************************************************************
+ * _homing_stall_arm()       - arm or disarm sensorless homing for the current axis' moves
+ * cm_homing_motor_stalled() - handle a motor stall. Called from the driver, possibly in an ISR
+ *
+ *  An axis with no homing input homes on the stall its drivers sense when it runs into the
+ *  end of travel (see st_motor_stalled()). The stall stands in for the switch closing, so it
+ *  is armed only for the search and latch moves. Returns false if the stall isn't for homing.
+ */
+static void _homing_stall_arm(int8_t axis, bool armed)
+{
+    if (!hm.sensorless) {
+        return;
+    }
+    hm.stall_armed = armed;
+    st_set_axis_stall_detect(axis, armed);
+}
+
+bool cm_homing_motor_stalled(const uint8_t motor)
+{
+    if (!hm.stall_armed || (st_cfg.mot[motor].motor_map != hm.axis)) {
+        return (false);
+    }
+    hm.stall_armed = false;
+    en_take_encoder_snapshot();
+    cm_request_feedhold(FEEDHOLD_TYPE_SKIP, FEEDHOLD_EXIT_RESET_POSITION);
+    return (true);
+}
+
+/***********************************************************************************
+ * _homing_axis_init() - check axis configuration and set up its homing parameters
+ */
+static stat_t _homing_axis_init(int8_t axis) {
+
+    hmAxis_t *ax = &hm.ax[axis];
+
     // clear the homed flag for axis so we'll be able to move w/o triggering soft limits
     cm->homed[axis] = false;
+    cm_update_soft_limits();
 
     // trap axis mis-configurations
-    if (fp_ZERO(cm->a[axis].homing_input)) {
+    if (fp_ZERO(cm->a[axis].homing_input) && !st_axis_can_sense_stall(axis)) {
         return (_homing_error_exit(axis, STAT_HOMING_ERROR_HOMING_INPUT_MISCONFIGURED));
     }
     if (fp_ZERO(cm->a[axis].search_velocity)) {
@@ -240,36 +332,29 @@ static stat_t _homing_axis_start(int8_t axis) {
         return (_homing_error_exit(axis, STAT_HOMING_ERROR_TRAVEL_MIN_MAX_IDENTICAL));
     }
 
-    // Nothing to do about direction now that direction is explicit
-    // However, here's a good place to stash the homing_switch:
-    hm.homing_input = cm->a[axis].homing_input;
-    gpio_set_homing_mode(hm.homing_input, true);
-    hm.axis            = axis;                                  // persist the axis
-    hm.search_velocity = fabs(cm->a[axis].search_velocity);     // search velocity is always positive
-    hm.latch_velocity  = fabs(cm->a[axis].latch_velocity);      // latch velocity is always positive
+    ax->search_velocity = fabs(cm->a[axis].search_velocity);   // search velocity is always positive
+    ax->latch_velocity  = fabs(cm->a[axis].latch_velocity);    // latch velocity is always positive
 
     bool homing_to_max = cm->a[axis].homing_dir;
 
     // setup parameters for positive or negative travel (homing to the max or min switch)
     if (homing_to_max) {
-        hm.search_travel = travel_distance;                     // search travels in positive direction
-        hm.latch_backoff = fabs(cm->a[axis].latch_backoff);     // latch travels in positive direction
-        hm.zero_backoff  = -max(0.0f, cm->a[axis].zero_backoff);// zero backoff is negative direction (or zero)
+        ax->search_travel = travel_distance;                    // search travels in positive direction
+        ax->latch_backoff = fabs(cm->a[axis].latch_backoff);    // latch travels in positive direction
+        ax->zero_backoff  = -max(0.0f, cm->a[axis].zero_backoff);// zero backoff is negative direction (or zero)
                                                                 // will set the maximum position
                                                                 //     (plus any negative backoff)
-        hm.setpoint = cm->a[axis].travel_max + (max(0.0f, -cm->a[axis].zero_backoff));
+        ax->setpoint = cm->a[axis].travel_max + (max(0.0f, -cm->a[axis].zero_backoff));
     } else {
-        hm.search_travel = -travel_distance;                    // search travels in negative direction
-        hm.latch_backoff = -fabs(cm->a[axis].latch_backoff);    // latch travels in negative direction
-        hm.zero_backoff  = max(0.0f, cm->a[axis].zero_backoff); // zero backoff is positive direction (or zero)
+        ax->search_travel = -travel_distance;                   // search travels in negative direction
+        ax->latch_backoff = -fabs(cm->a[axis].latch_backoff);   // latch travels in negative direction
+        ax->zero_backoff  = max(0.0f, cm->a[axis].zero_backoff);// zero backoff is positive direction (or zero)
                                                                 // will set the minimum position
                                                                 //     (minus any negative backoff)
-        hm.setpoint = cm->a[axis].travel_min + (max(0.0f, -cm->a[axis].zero_backoff));
+        ax->setpoint = cm->a[axis].travel_min + (max(0.0f, -cm->a[axis].zero_backoff));
     }
-
-    // if homing is disabled for the axis then skip to the next axis
-    hm.saved_jerk = cm_get_axis_jerk(axis);                     // save the max jerk value
-    return (_set_homing_func(_homing_axis_clear_init));         // perform an initial clear
+    ax->saved_jerk = cm_get_axis_jerk(axis);                    // save the max jerk value
+    return (STAT_OK);
 }
 
 /***********************************************************************************
@@ -289,7 +374,7 @@ static stat_t _homing_axis_clear_init(int8_t axis)  // first clear move
                     axis, STAT_HOMING_ERROR_MUST_CLEAR_SWITCHES_BEFORE_HOMING));  // axis cannot be homed
             }
         }
-        _homing_axis_move(axis, -hm.latch_backoff, hm.search_velocity);  // otherwise back off the switch
+        _homing_axis_move(axis, -hm.ax[axis].latch_backoff, hm.ax[axis].search_velocity);  // otherwise back off the switch
     }
     return (_set_homing_func(_homing_axis_search));  // start the search
 }
@@ -300,7 +385,8 @@ static stat_t _homing_axis_clear_init(int8_t axis)  // first clear move
 static stat_t _homing_axis_search(int8_t axis)  // drive to switch
 {
     cm_set_axis_max_jerk(axis, cm->a[axis].jerk_high);  // use the high-speed jerk for search onward
-    _homing_axis_move(axis, hm.search_travel, hm.search_velocity);
+    _homing_stall_arm(axis, true);
+    _homing_axis_move(axis, hm.ax[axis].search_travel, hm.ax[axis].search_velocity);
     return (_set_homing_func(_homing_axis_clear));
 }
 
@@ -309,7 +395,8 @@ static stat_t _homing_axis_search(int8_t axis)  // drive to switch
  */
 static stat_t _homing_axis_clear(int8_t axis)  // drive away from switch at search speed
 {
-    _homing_axis_move(axis, -hm.latch_backoff, hm.search_velocity);
+    _homing_stall_arm(axis, false);
+    _homing_axis_move(axis, -hm.ax[axis].latch_backoff, hm.ax[axis].search_velocity);
     return (_set_homing_func(_homing_axis_latch));
 }
 
@@ -318,7 +405,8 @@ static stat_t _homing_axis_clear(int8_t axis)  // drive away from switch at sear
  */
 static stat_t _homing_axis_latch(int8_t axis)  // drive to switch at low speed
 {
-    _homing_axis_move(axis, hm.latch_backoff, hm.latch_velocity);
+    _homing_stall_arm(axis, true);
+    _homing_axis_move(axis, hm.ax[axis].latch_backoff, hm.ax[axis].latch_velocity);
     return (_set_homing_func(_homing_axis_setpoint_backoff));
 }
 
@@ -327,7 +415,8 @@ static stat_t _homing_axis_latch(int8_t axis)  // drive to switch at low speed
  */
 static stat_t _homing_axis_setpoint_backoff(int8_t axis)  // 
 {
-    _homing_axis_move(axis, hm.zero_backoff, hm.search_velocity);
+    _homing_stall_arm(axis, false);
+    _homing_axis_move(axis, hm.ax[axis].zero_backoff, hm.ax[axis].search_velocity);
     return (_set_homing_func(_homing_axis_set_position));
 }
 
@@ -337,15 +426,16 @@ static stat_t _homing_axis_setpoint_backoff(int8_t axis)  //
 static stat_t _homing_axis_set_position(int8_t axis)
 {
     if (hm.set_coordinates) {
-        cm_set_position_by_axis(axis, hm.setpoint);
+        cm_set_position_by_axis(axis, hm.ax[axis].setpoint);
         cm->homed[axis] = true;
+        cm_update_soft_limits();
 
     } else {  // handle G28.4 cycle - set position to the point of switch closure
         float contact_position[AXES];
         kn_forward_kinematics(en_get_encoder_snapshot_vector(), contact_position);
-        _homing_axis_move(axis, contact_position[AXIS_Z], hm.search_velocity);
+        _homing_axis_move(axis, contact_position[AXIS_Z], hm.ax[axis].search_velocity);
     }
-    cm_set_axis_max_jerk(axis, hm.saved_jerk);  // restore the max jerk value
+    cm_set_axis_max_jerk(axis, hm.ax[axis].saved_jerk);  // restore the max jerk value
 
     gpio_set_homing_mode(hm.homing_input, false);  // end homing mode
     return (_set_homing_func(_homing_axis_start));
@@ -381,6 +471,362 @@ static stat_t _homing_axis_move(int8_t axis, float target, float velocity) {
     return (STAT_EAGAIN);
 }
 
+/***********************************************************************************
+ * Group homing - homes the axes in hm.group[] together (see cm_homing_cycle_start())
+ ***********************************************************************************/
+
+/*
+ * _homing_inputs_unique() - true if the axis' homing input(s) are not shared with any other axis
+ * _homing_group_candidate() - true if the axis can join a simultaneous pass
+ */
+static bool _homing_inputs_unique(int8_t axis)
+{
+    const uint8_t input_1 = cm->a[axis].homing_input;
+    const uint8_t input_2 = cm->a[axis].homing_input_2;
+
+    if (input_1 == input_2) {                   // also rejects a disabled homing input
+        return (false);
+    }
+    for (uint8_t check_axis = AXIS_X; check_axis < AXES; check_axis++) {
+        if (check_axis == axis) {
+            continue;
+        }
+        const uint8_t check_1 = cm->a[check_axis].homing_input;
+        const uint8_t check_2 = cm->a[check_axis].homing_input_2;
+        if (((check_1 != 0) && ((check_1 == input_1) || (check_1 == input_2))) ||
+            ((check_2 != 0) && ((check_2 == input_1) || (check_2 == input_2)))) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+static bool _homing_group_candidate(int8_t axis)
+{
+    return (((axis == AXIS_X) || (axis == AXIS_Y) || (axis >= AXIS_A)) &&  // Z is always homed by itself
+            hm.axis_flags[axis] && (cm->a[axis].homing_input != 0) && _homing_inputs_unique(axis));
+}
+
+/*
+ * _homing_group_select() - choose the axes to home along with this one
+ *
+ *  Returns the number of axes in the group, or 0 to home the axis one at a time.
+ *  Axes added to the group are taken off the axis_flags list so they are not homed again.
+ */
+static uint8_t _homing_group_select(int8_t axis)
+{
+    if (!hm.set_coordinates || (cm->a[axis].homing_input == 0)) {     // sensorless axes home alone
+        return (0);
+    }
+    const bool is_gantry = (cm->a[axis].homing_input_2 != 0);
+    const bool is_simultaneous = (cm->homing_simultaneous && _homing_group_candidate(axis));
+    if ((!is_gantry && !is_simultaneous) || !_homing_inputs_unique(axis)) {
+        return (0);
+    }
+    for (uint8_t i = AXIS_X; i < AXES; i++) {
+        hm.group[i] = false;
+    }
+    hm.group[axis] = true;
+    uint8_t count = 1;
+    if (is_simultaneous) {
+        for (uint8_t i = AXIS_X; i < AXES; i++) {
+            if ((i != axis) && _homing_group_candidate(i)) {
+                hm.group[i] = true;
+                count++;
+            }
+        }
+    }
+    if ((count == 1) && !is_gantry) {           // nothing to home alongside - use the axis sequence
+        return (0);
+    }
+    for (uint8_t i = AXIS_X; i < AXES; i++) {
+        if (hm.group[i]) {
+            hm.axis_flags[i] = false;
+        }
+    }
+    return (count);
+}
+
+/*
+ * _homing_group_start() - set up every axis in the group and assign its switches to motors
+ *
+ *  With one homing input all motors mapped to the axis stop on it. With a second input the
+ *  first motor mapped to the axis stops on the homing input and the other motors on the second.
+ */
+static stat_t _homing_group_start(int8_t axis)
+{
+    for (uint8_t i = 0; i < D_IN_CHANNELS; i++) {
+        hm.input_motors[i] = 0;
+    }
+    for (uint8_t i = AXIS_X; i < AXES; i++) {
+        if (!hm.group[i]) {
+            continue;
+        }
+        ritorno(_homing_axis_init(i));
+
+        const uint8_t input_1 = cm->a[i].homing_input;
+        const uint8_t input_2 = cm->a[i].homing_input_2;
+        uint8_t motor_count = 0;
+        for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
+            if (st_cfg.mot[motor].motor_map != i) {
+                continue;
+            }
+            uint8_t input = ((input_2 == 0) || (motor_count == 0)) ? input_1 : input_2;
+            hm.input_motors[input-1] |= (1 << motor);
+            motor_count++;
+        }
+        if ((input_2 != 0) && (motor_count < 2)) {   // a squaring input needs a second motor to square
+            return (_homing_error_exit(i, STAT_HOMING_ERROR_HOMING_INPUT_MISCONFIGURED));
+        }
+        hm.ax[i].input_mask = (1UL << (input_1-1)) | ((input_2 != 0) ? (1UL << (input_2-1)) : 0);
+        gpio_set_homing_mode(input_1, true);
+        gpio_set_homing_mode(input_2, true);    // ignores input 0
+    }
+    hm.pending_inputs = 0;
+    hm.square_motor = MOTOR_1;
+    hm.group_active = true;
+    return (_set_homing_func(_homing_group_clear_init));
+}
+
+/*
+ * _homing_group_move() - run one multi-axis move for the group
+ *
+ *  Each axis moves its own travel[] distance. The feed rate is set so that no axis exceeds its
+ *  own velocity[]. Returns STAT_OK if the move was queued or no axis has anywhere to go.
+ */
+static stat_t _homing_group_move(const float travel[], const float velocity[])
+{
+    float vect[]  = INIT_AXES_ZEROES;
+    bool  flags[] = INIT_AXES_ZEROES;
+    float length = 0;
+
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        if (hm.group[axis] && fp_NOT_ZERO(travel[axis])) {
+            vect[axis] = travel[axis];
+            flags[axis] = true;
+            length += square(travel[axis]);
+        }
+    }
+    if (fp_ZERO(length)) {
+        return (STAT_OK);
+    }
+    length = sqrt(length);
+    float feed_rate = MAX_LONG;
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        if (flags[axis]) {
+            feed_rate = min(feed_rate, velocity[axis] * length / fabs(vect[axis]));
+        }
+    }
+    hm.waiting_for_motion_end = true;
+    cm_set_feed_rate(feed_rate);
+
+    stat_t status = cm_straight_feed(vect, flags, PROFILE_FAST);
+    if (status != STAT_OK) {
+        rpt_exception(status, "Homing move failed. Check min/max settings");
+        return (_homing_error_exit(hm.axis, STAT_HOMING_CYCLE_FAILED));
+    }
+    mp_queue_command(_motion_end_callback, nullptr, nullptr);
+    return (STAT_OK);
+}
+
+/*
+ * _homing_group_arm()    - start watching every switch in the group before a search or latch move
+ * _homing_group_disarm() - check all switches fired and bring the inhibited motors back in step
+ */
+static void _homing_group_arm()
+{
+    uint32_t inputs = 0;
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        if (hm.group[axis]) {
+            inputs |= hm.ax[axis].input_mask;
+        }
+    }
+    st_clear_motor_inhibits();
+    hm.pending_inputs = inputs;
+}
+
+static stat_t _homing_group_disarm()
+{
+    uint32_t missed = hm.pending_inputs;
+    hm.pending_inputs = 0;
+    st_clear_motor_inhibits();
+    mp_set_steps_to_runtime_position();         // inhibited motors stopped short of the runtime position
+
+    if (missed != 0) {                          // the move ran out before a switch was found
+        for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+            if (hm.group[axis] && (hm.ax[axis].input_mask & missed)) {
+                return (_homing_error_exit(axis, STAT_HOMING_CYCLE_FAILED));
+            }
+        }
+    }
+    return (STAT_OK);
+}
+
+/*
+ * _homing_group_clear_init()       - back axes off switches that are closed at the start
+ * _homing_group_search()           - fast search for all switches
+ * _homing_group_clear()            - clear off the switches
+ * _homing_group_latch()            - slow drive until each switch closes again
+ * _homing_group_square()           - step each gantry motor with a squaring offset on its own
+ * _homing_group_setpoint_backoff() - backoff to zero or max setpoint positions
+ * _homing_group_set_position()     - set all axes in the group and go on to the next axis
+ */
+static stat_t _homing_group_clear_init(int8_t axis)
+{
+    float travel[AXES] = INIT_AXES_ZEROES;
+    float velocity[AXES] = INIT_AXES_ZEROES;
+    for (uint8_t i = AXIS_X; i < AXES; i++) {
+        if (hm.group[i] && ((gpio_read_input(cm->a[i].homing_input) == INPUT_ACTIVE) ||
+                            (gpio_read_input(cm->a[i].homing_input_2) == INPUT_ACTIVE))) {
+            travel[i] = -hm.ax[i].latch_backoff;
+            velocity[i] = hm.ax[i].search_velocity;
+        }
+    }
+    ritorno(_homing_group_move(travel, velocity));
+    return (_set_homing_func(_homing_group_search));
+}
+
+static stat_t _homing_group_search(int8_t axis)
+{
+    float travel[AXES] = INIT_AXES_ZEROES;
+    float velocity[AXES] = INIT_AXES_ZEROES;
+    for (uint8_t i = AXIS_X; i < AXES; i++) {
+        if (hm.group[i]) {
+            cm_set_axis_max_jerk(i, cm->a[i].jerk_high);   // use the high-speed jerk for search onward
+            travel[i] = hm.ax[i].search_travel;
+            velocity[i] = hm.ax[i].search_velocity;
+        }
+    }
+    _homing_group_arm();
+    ritorno(_homing_group_move(travel, velocity));
+    return (_set_homing_func(_homing_group_clear));
+}
+
+static stat_t _homing_group_clear(int8_t axis)
+{
+    ritorno(_homing_group_disarm());
+
+    float travel[AXES] = INIT_AXES_ZEROES;
+    float velocity[AXES] = INIT_AXES_ZEROES;
+    for (uint8_t i = AXIS_X; i < AXES; i++) {
+        if (hm.group[i]) {
+            travel[i] = -hm.ax[i].latch_backoff;
+            velocity[i] = hm.ax[i].search_velocity;
+        }
+    }
+    ritorno(_homing_group_move(travel, velocity));
+    return (_set_homing_func(_homing_group_latch));
+}
+
+static stat_t _homing_group_latch(int8_t axis)
+{
+    float travel[AXES] = INIT_AXES_ZEROES;
+    float velocity[AXES] = INIT_AXES_ZEROES;
+    for (uint8_t i = AXIS_X; i < AXES; i++) {
+        if (hm.group[i]) {
+            travel[i] = hm.ax[i].latch_backoff;
+            velocity[i] = hm.ax[i].latch_velocity;
+        }
+    }
+    _homing_group_arm();
+    ritorno(_homing_group_move(travel, velocity));
+    return (_set_homing_func(_homing_group_square));
+}
+
+static stat_t _homing_group_square(int8_t axis)
+{
+    ritorno(_homing_group_disarm());            // also locks the last squared motor back in step
+
+    while (hm.square_motor < MOTORS) {
+        const uint8_t motor = hm.square_motor++;
+        const uint8_t motor_axis = st_cfg.mot[motor].motor_map;
+        if ((motor_axis >= AXES) || !hm.group[motor_axis] || (cm->a[motor_axis].homing_input_2 == 0) ||
+            fp_ZERO(st_cfg.mot[motor].squaring_offset)) {
+            continue;
+        }
+        float travel[AXES] = INIT_AXES_ZEROES;
+        float velocity[AXES] = INIT_AXES_ZEROES;
+        travel[motor_axis] = st_cfg.mot[motor].squaring_offset;
+        velocity[motor_axis] = hm.ax[motor_axis].latch_velocity;
+        st_inhibit_motors(((1 << MOTORS) - 1) & ~(1 << motor));    // hold every other motor
+        ritorno(_homing_group_move(travel, velocity));
+        return (_set_homing_func(_homing_group_square));
+    }
+    return (_homing_group_setpoint_backoff(axis));
+}
+
+static stat_t _homing_group_setpoint_backoff(int8_t axis)
+{
+    ritorno(_homing_group_disarm());
+
+    float travel[AXES] = INIT_AXES_ZEROES;
+    float velocity[AXES] = INIT_AXES_ZEROES;
+    for (uint8_t i = AXIS_X; i < AXES; i++) {
+        if (hm.group[i]) {
+            travel[i] = hm.ax[i].zero_backoff;
+            velocity[i] = hm.ax[i].search_velocity;
+        }
+    }
+    ritorno(_homing_group_move(travel, velocity));
+    return (_set_homing_func(_homing_group_set_position));
+}
+
+static stat_t _homing_group_set_position(int8_t axis)
+{
+    for (uint8_t i = AXIS_X; i < AXES; i++) {
+        if (hm.group[i]) {
+            cm_set_position_by_axis(i, hm.ax[i].setpoint);
+            cm->homed[i] = true;
+        }
+    }
+    cm_update_soft_limits();
+    _homing_group_release();                    // restores jerk and ends homing mode
+    return (_set_homing_func(_homing_axis_start));
+}
+
+/*
+ * _homing_group_release() - end homing mode for the group's inputs and restore the axes
+ */
+static void _homing_group_release()
+{
+    if (!hm.group_active) {
+        return;
+    }
+    hm.group_active = false;
+    hm.pending_inputs = 0;
+    st_clear_motor_inhibits();
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        if (hm.group[axis]) {
+            cm_set_axis_max_jerk(axis, hm.ax[axis].saved_jerk);
+            gpio_set_homing_mode(cm->a[axis].homing_input, false);
+            gpio_set_homing_mode(cm->a[axis].homing_input_2, false);
+            hm.group[axis] = false;
+        }
+    }
+}
+
+/***********************************************************************************
+ * cm_homing_input_hit() - handle a homing switch leading edge. Called from the GPIO ISR
+ *
+ *  Returns false if the input is not part of a group pass, in which case the caller stops
+ *  the move. Otherwise the motors for the switch are stopped where they are, and the move is
+ *  ended once every switch being watched has fired. Edges during clear moves are ignored.
+ */
+bool cm_homing_input_hit(const uint8_t input_num_ext)
+{
+    if (!hm.group_active) {
+        return (false);
+    }
+    const uint32_t input_bit = 1UL << (input_num_ext-1);
+    if (hm.pending_inputs & input_bit) {
+        st_inhibit_motors(hm.input_motors[input_num_ext-1]);
+        if ((hm.pending_inputs &= ~input_bit) == 0) {
+            cm_request_feedhold(FEEDHOLD_TYPE_SKIP, FEEDHOLD_EXIT_RESET_POSITION);
+        }
+    }
+    return (true);
+}
+
 /***********************************************************************************
  * _homing_error_exit()
  *
@@ -409,6 +855,10 @@ static stat_t _homing_error_exit(int8_t axis, stat_t status) {
 
 static stat_t _homing_finalize_exit(int8_t axis)  // third part of return to home
 {
+    _homing_group_release();                     // in case a group pass ended in an error
+    hm.stall_armed = false;                      // in case homing ended in a search or latch
+    hm.sensorless = false;
+    st_reset_stall_detect();
     cm_set_coord_system(hm.saved_coord_system);  // restore to work coordinate system
     cm_set_units_mode(hm.saved_units_mode);
     cm_set_distance_mode(hm.saved_distance_mode);
@@ -31,6 +31,7 @@
 #include "text_parser.h"
 #include "canonical_machine.h"
 #include "planner.h"
+#include "report.h"
 #include "util.h"
 #include "xio.h"
 
@@ -56,6 +57,9 @@ struct jmJoggingSingleton {         // persistent jogging runtime variables
     uint8_t saved_distance_mode;    // G90,G91 global setting
     uint8_t saved_feed_rate_mode;
     float   saved_jerk;             // saved and restored for each axis jogged
+
+    // velocity jog (see cm_velocity_jog())
+    bool    velocity_mode;          // a velocity jog cycle is running
 };
 static struct jmJoggingSingleton jog;
 
@@ -67,6 +71,7 @@ static stat_t _jogging_axis_start(int8_t axis);
 static stat_t _jogging_axis_ramp_jog(int8_t axis);
 static stat_t _jogging_axis_move(int8_t axis, float target, float velocity);
 static stat_t _jogging_finalize_exit(int8_t axis);
+static stat_t _velocity_jog_finalize_exit(void);
 
 /*****************************************************************************
  * cm_jogging_cycle_start() - jogging cycle using soft limits
@@ -127,6 +132,12 @@ stat_t cm_jogging_cycle_callback(void) {
     if (cm->cycle_type != CYCLE_JOG) {
         return (STAT_NOOP);  // exit if not in a jogging cycle
     }
+    if (jog.velocity_mode) {
+        if (mp_vjog.active || !mp_runtime_is_idle()) {
+            return (STAT_NOOP);  // not EAGAIN - velocity commands must keep being read
+        }
+        return (_velocity_jog_finalize_exit());
+    }
     if (jog.func == _jogging_finalize_exit && cm_get_runtime_busy() == true) {
         return (STAT_EAGAIN);  // sync to planner move ends
     }
@@ -202,6 +213,70 @@ static stat_t _jogging_finalize_exit(int8_t axis)  // finish a jog
     return (STAT_OK);
 }
 
+/*****************************************************************************
+ * cm_velocity_jog()            - start or steer a velocity jog on one axis
+ * cm_velocity_jog_is_running() - true from the first velocity command until the cycle ends
+ * _velocity_jog_finalize_exit()
+ *
+ *  Each command sets the target velocity for one axis (mm or degrees per minute) and feeds
+ *  the watchdog. The exec follows the targets directly - see _exec_velocity_jog() - so
+ *  the first command is only accepted with the machine idle and the queue empty. Sending
+ *  zeros, or simply going quiet, brings the axes to rest and the cycle ends.
+ */
+
+stat_t cm_velocity_jog(uint8_t axis, float velocity)
+{
+    if (axis >= AXES) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    if ((cm->a[axis].axis_mode == AXIS_DISABLED) || (cm->hold_state != FEEDHOLD_OFF)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    velocity = max(-cm->a[axis].velocity_max, min(cm->a[axis].velocity_max, velocity));
+
+    if (jog.velocity_mode) {
+        mp_vjog.target[axis] = velocity;
+        mp_vjog.fed_tick = SysTickTimer_getValue();
+        if (!mp_vjog.active) {
+            mp_velocity_jog_start();    // came to rest but the cycle has not ended yet
+        }
+        return (STAT_OK);
+    }
+
+    ritorno(cm_is_alarmed());
+    if ((cm != &cm1) || (cm->machine_state == MACHINE_CYCLE) || !mp_runtime_is_idle() ||
+        (mp_get_planner_buffers(mp) != mp->q.queue_size)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    for (uint8_t a = 0; a < AXES; a++) {
+        mp_vjog.target[a] = 0;
+    }
+    mp_vjog.target[axis] = velocity;
+    jog.velocity_mode = true;
+    cm->machine_state = MACHINE_CYCLE;
+    cm->cycle_type = CYCLE_JOG;
+    cm_set_motion_state(MOTION_RUN);
+    mp_velocity_jog_start();
+    return (STAT_OK);
+}
+
+bool cm_velocity_jog_is_running() { return (jog.velocity_mode); }
+
+static stat_t _velocity_jog_finalize_exit()
+{
+    jog.velocity_mode = false;
+    cm_reset_position_to_absolute_position(cm); // the model and planner catch up with the runtime
+    cm_set_motion_state(MOTION_STOP);
+    if (cm->hold_state != FEEDHOLD_OFF) {       // a feedhold stopped the jog - let the hold finish the cycle
+        cm->cycle_type = CYCLE_MACHINING;
+        cm->hold_state = FEEDHOLD_MOTION_STOPPED;
+        return (STAT_OK);
+    }
+    cm_canned_cycle_end();
+    sr_request_status_report(SR_REQUEST_IMMEDIATE);
+    return (STAT_OK);
+}
+
 /*
 static stat_t _jogging_error_exit(int8_t axis)
 {
@@ -58,23 +58,62 @@ struct pbProbingSingleton {             // persistent probing runtime variables
     bool waiting_for_motion_complete;   // true if waiting for a motion to complete
     stat_t (*func)();                   // binding for callback function state machine
 
+    // multi-touch G38.x - see _probing_backoff()
+    uint8_t touches;                    // slow touches to average, 0 for a single touch
+    uint8_t touch;                      // probe moves that have made contact so far
+    float start[AXES];                  // position at the start of the cycle
+    float direction[AXES];              // unit vector of the probe move
+    float touch_sum[AXES];              // sum of the slow touch contact positions
+    stat_t (*done)();                   // where _probing_backoff() goes when the touches are over
+
+    // tool measurement (G37)
+    uint8_t tool;                       // tool table entry being measured
+
+    // grid and tram cycles
+    bool tram;                          // probing the tram points (G29), not the grid
+    float tram_xy[PROBES_STORED][2];    // tram points, machine coordinates
+    uint16_t point;                     // point being probed
+    uint16_t point_count;               // points to probe
+    float z_clear;                      // Z travel height between points
+    float z_probe;                      // Z probe target
+    float feed_rate;                    // probe feed rate
+
     // saved gcode model state
     cmUnitsMode saved_units_mode;       // G20,G21 setting
     cmDistanceMode saved_distance_mode; // G90,G91 global setting
     bool saved_soft_limits;             // turn off soft limits during probing
+    float saved_feed_rate;              // the cycles set their own feed rates
     float saved_jerk[AXES];             // saved and restored for each axis
 };
 static struct pbProbingSingleton pb;
 
+cmProbeGrid_t probe_grid;               // grid probing settings and results
+cmToolSetter_t tool_setter;             // tool setter settings for G37
+static volatile bool grid_tripped_at_arm;   // probe was already in contact when a grid probe was armed
+
 /**** NOTE: global prototypes and other .h info is located in canonical_machine.h ****/
 
 static stat_t _probing_start();
 static stat_t _probing_backoff();
+static stat_t _probing_touch();
+static stat_t _probe_first_touch();
+static void _probe_roll_results();
 static stat_t _probing_finish();
+static void _probe_save_settings();
+static stat_t _grid_cycle_start();
+static stat_t _grid_point_done();
+static stat_t _grid_finish();
+static void _send_grid_report(void);
+static stat_t _tram_start();
 static stat_t _probing_exception_exit(stat_t status);
 static stat_t _probe_move(const float target[], const bool flags[]);
 static void _motion_end_callback(float* vect, bool* flag);
 static void _send_probe_report(void);
+static stat_t _tool_start();
+static stat_t _tool_probe();
+static stat_t _tool_measured();
+static stat_t _tool_finish();
+static void _send_tool_report(void);
 
 /***********************************************************************************
  **** G38.x Probing Cycle **********************************************************
@@ -147,15 +186,42 @@ uint8_t cm_straight_probe(float target[], bool flags[], bool trip_sense, bool al
         return(cm_alarm(STAT_NO_PROBE_INPUT_CONFIGURED, "Probe input not configured"));
     }
 
+    // multi-touch needs somewhere to back off to and a feed to come back in at
+    pb.touches = cm->probe_touches;
+    if (pb.touches) {
+        if (fp_ZERO(cm->probe_slow_feed)) {
+            return(cm_alarm(STAT_FEEDRATE_NOT_SPECIFIED, "Probe slow feed rate is zero"));
+        }
+        if (cm->probe_backoff < MINIMUM_PROBE_TRAVEL) {
+            return(cm_alarm(STAT_PROBE_TRAVEL_TOO_SMALL, "Probe backoff is too small"));
+        }
+    }
+
     // setup
     pb.alarm_flag = alarm_flag;             // set true to enable probe fail alarms (all exceptions alarm regardless)
     pb.trip_sense = trip_sense;             // set to sense of "tripped" contact
     pb.func = _probing_start;               // bind probing start function
+    pb.done = _probing_finish;
 
     cm_set_model_target(target, flags);     // convert target to canonical form taking all offsets into account
     copy_vector(pb.target, cm->gm.target);   // cm_set_model_target() sets target in gm, move it to pb
     copy_vector(pb.flags, flags);           // set axes involved in the move
 
+    _probe_roll_results();
+
+    // queue a function to let us know when we can start probing
+    cm->probe_state[0] = PROBE_WAITING;      // wait until planner queue empties before starting movement
+    pb.waiting_for_motion_complete = true;
+    mp_queue_command(_motion_end_callback, nullptr, nullptr);  // note: these args are ignored
+    return (STAT_OK);
+} 
+
+/*
+ * _probe_roll_results() - make room for a new probe in cm->probe_results[0]
+ */
+
+static void _probe_roll_results()
+{
     // if the previous probe succeeded, roll probes to the next position
     if (cm->probe_state[0] == PROBE_SUCCEEDED) {
         for (uint8_t n = PROBES_STORED - 1; n > 0; n--) {
@@ -167,13 +233,7 @@ uint8_t cm_straight_probe(float target[], bool flags[], bool trip_sense, bool al
     }
     // clear the old probe results
     clear_vector(cm->probe_results[0]);      // NOTE: relying on cm->probe_results will not detect a probe to 0,0,0.
-
-    // queue a function to let us know when we can start probing
-    cm->probe_state[0] = PROBE_WAITING;      // wait until planner queue empties before starting movement
-    pb.waiting_for_motion_complete = true;
-    mp_queue_command(_motion_end_callback, nullptr, nullptr);  // note: these args are ignored
-    return (STAT_OK);
-} 
+}
 
 /***********************************************************************************
  *  cm_probing_cycle_callback() - handle probing progress
@@ -217,7 +277,8 @@ static stat_t _probe_move(const float target[], const bool flags[])
 }
 
 /***********************************************************************************
- * _probing_start() - start the probe or skip it if contact is already active
+ * _probing_start()     - start the probe or skip it if contact is already active
+ * _probe_first_touch() - run the probe move to pb.target - shared with G37
  */
 
 static uint8_t _probing_start() 
@@ -231,28 +292,17 @@ static uint8_t _probing_start()
     cm->probe_state[0] = PROBE_FAILED;
     cm->machine_state = MACHINE_CYCLE;
     cm->cycle_type = CYCLE_PROBE;
-
-    // save relevant non-axis parameters from Gcode model
-    pb.saved_distance_mode = (cmDistanceMode)cm_get_distance_mode(ACTIVE_MODEL);
-    pb.saved_units_mode = (cmUnitsMode)cm_get_units_mode(ACTIVE_MODEL);
-    pb.saved_soft_limits = cm_get_soft_limits();
-    cm_set_soft_limits(false);
-    
-    // set working values
-    cm_set_distance_mode(ABSOLUTE_DISTANCE_MODE);
-    cm_set_units_mode(MILLIMETERS);
-
-    // Save the current jerk settings & change to the high-speed jerk settings
-    for (uint8_t axis = 0; axis < AXES; axis++) {
-        pb.saved_jerk[axis] = cm_get_axis_jerk(axis);  // save the max jerk value
-        cm_set_axis_max_jerk(axis, cm->a[axis].jerk_high);  // use the high-speed jerk for probe
-    }
+    _probe_save_settings();
 
     // Error if the probe target is too close to the current position
     if (get_axis_vector_length(cm->gmx.position, pb.target) < MINIMUM_PROBE_TRAVEL) {
         return(_probing_exception_exit(STAT_PROBE_TRAVEL_TOO_SMALL));
     }
+    return (_probe_first_touch());
+}
 
+static stat_t _probe_first_touch()
+{
     gpio_set_probing_mode(pb.probe_input, true);
 
     // Get initial probe state, and don't probe if we're already tripped.
@@ -261,6 +311,16 @@ static uint8_t _probing_start()
         return(_probing_exception_exit(STAT_PROBE_IS_ALREADY_TRIPPED));
     }
 
+    // Set up for multi-touch. The feed rate is the fast one until the first contact
+    pb.touch = 0;
+    pb.feed_rate = cm->gm.feed_rate;
+    copy_vector(pb.start, cm->gmx.position);
+    clear_vector(pb.touch_sum);
+    float length = get_axis_vector_length(pb.start, pb.target);
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        pb.direction[axis] = (pb.target[axis] - pb.start[axis]) / length;
+    }
+
     // Everything checks out. Run the probe move    
     _probe_move(pb.target, pb.flags);
     pb.func = _probing_backoff;
@@ -269,8 +329,19 @@ static uint8_t _probing_start()
 
 /***********************************************************************************
  * _probing_backoff() - runs after the probe move, whether it contacted or not
+ * _probing_touch()   - runs after a multi-touch backoff, to start the next slow touch
  *
  * Back off to the measured touch position captured by encoder snapshot
+ *
+ *  Multi-touch: with {prbn:} set to N the first touch is made at the programmed feed
+ *  rate and only finds the surface. The cycle then backs off {prbk:} mm along the
+ *  probe move and comes back in at {prbs:} mm/min, N times, and the slow contact
+ *  positions are averaged. It runs as one cycle with one report at the end, so the
+ *  host doesn't wait out a round trip and a planner drain for each touch.
+ *
+ *  Probing mode is off for the backoffs, as any edge on the probe input trips it,
+ *  and the probe opens on the way out. A touch that doesn't make contact fails the
+ *  cycle as a single touch probe would.
  */
 
 static stat_t _probing_backoff() 
@@ -279,31 +350,96 @@ static stat_t _probing_backoff()
     // captured from the encoder in step space to steps to mm. The encoder snapshot 
     // was taken by input interrupt at the time of closure.
 
-    if (pb.trip_sense == gpio_read_input(pb.probe_input)) {  // exclusive or for booleans
+    if (pb.trip_sense != gpio_read_input(pb.probe_input)) {  // exclusive or for booleans
+        cm->probe_state[0] = PROBE_FAILED;
+        pb.func = pb.done;
+        return (STAT_EAGAIN);
+    }
+    float contact_position[AXES];
+    kn_forward_kinematics(en_get_encoder_snapshot_vector(), contact_position);
+
+    if (pb.touches == 0) {
         cm->probe_state[0] = PROBE_SUCCEEDED;
-        float contact_position[AXES];
-        kn_forward_kinematics(en_get_encoder_snapshot_vector(), contact_position);
         _probe_move(contact_position, pb.flags);   // NB: feed rate is the same as the probe move
-    } else {
-        cm->probe_state[0] = PROBE_FAILED;
+        pb.func = pb.done;
+        return (STAT_EAGAIN);
+    }
+
+    if (pb.touch++ > 0) {                           // the first touch only finds the surface
+        for (uint8_t axis = 0; axis < AXES; axis++) {
+            pb.touch_sum[axis] += contact_position[axis];
+        }
+    }
+    gpio_set_probing_mode(pb.probe_input, false);
+    if (pb.touch > pb.touches) {                    // done - go to the average at the slow feed rate
+        cm->probe_state[0] = PROBE_SUCCEEDED;
+        for (uint8_t axis = 0; axis < AXES; axis++) {
+            contact_position[axis] = pb.touch_sum[axis] / pb.touches;
+        }
+        _probe_move(contact_position, pb.flags);
+        pb.func = pb.done;
+        return (STAT_EAGAIN);
     }
-    pb.func = _probing_finish;
+
+    // back off along the probe move, but not past where the cycle started
+    float backoff = min(cm->probe_backoff, get_axis_vector_length(pb.start, contact_position));
+    float target[AXES];
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        target[axis] = contact_position[axis] - pb.direction[axis] * backoff;
+    }
+    cm->gm.feed_rate = pb.feed_rate;
+    _probe_move(target, pb.flags);
+    pb.func = _probing_touch;
+    return (STAT_EAGAIN);
+}
+
+static stat_t _probing_touch()
+{
+    if (pb.trip_sense == gpio_read_input(pb.probe_input)) { // the backoff didn't clear the surface
+        return(_probing_exception_exit(STAT_PROBE_IS_ALREADY_TRIPPED));
+    }
+    gpio_set_probing_mode(pb.probe_input, true);
+    cm->gm.feed_rate = cm->probe_slow_feed;
+    _probe_move(pb.target, pb.flags);
+    pb.func = _probing_backoff;
     return (STAT_EAGAIN);
 }
 
 /***********************************************************************************
+ * _probe_save_settings()    - save the model state probing changes and set working values
  * _probe_restore_settings() - helper for both exits
  * _probing_exception_exit() - exit for probes that hit an exception
  * _probing_finish()         - exit for successful and non-contacted (failed) probes
  */
 
+static void _probe_save_settings()
+{
+    // save relevant non-axis parameters from Gcode model
+    pb.saved_distance_mode = (cmDistanceMode)cm_get_distance_mode(ACTIVE_MODEL);
+    pb.saved_units_mode = (cmUnitsMode)cm_get_units_mode(ACTIVE_MODEL);
+    pb.saved_soft_limits = cm_get_soft_limits();
+    pb.saved_feed_rate = cm->gm.feed_rate;
+    cm_set_soft_limits(false);
+
+    // set working values
+    cm_set_distance_mode(ABSOLUTE_DISTANCE_MODE);
+    cm_set_units_mode(MILLIMETERS);
+
+    // Save the current jerk settings & change to the high-speed jerk settings
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        pb.saved_jerk[axis] = cm_get_axis_jerk(axis);  // save the max jerk value
+        cm_set_axis_max_jerk(axis, cm->a[axis].jerk_high);  // use the high-speed jerk for probe
+    }
+}
+
 static void _probe_restore_settings() 
 {
     gpio_set_probing_mode(pb.probe_input, false);       // set input back to normal operation
 
     for (uint8_t axis = 0; axis < AXES; axis++) {       // restore axis jerks
-        cm->a[axis].jerk_max = pb.saved_jerk[axis]; 
+        cm_set_axis_max_jerk(axis, pb.saved_jerk[axis]); 
     }
+    cm->gm.feed_rate = pb.saved_feed_rate;              // the slow touches and the grid leave their own
     cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_OFF); // release abs override and restore work offsets
     cm_set_distance_mode(pb.saved_distance_mode);
     cm_set_units_mode(pb.saved_units_mode);
@@ -371,6 +507,436 @@ static void _send_probe_report() {
     }
 }
 
+/***********************************************************************************
+ **** Grid Probing Cycle ***********************************************************
+ ***********************************************************************************/
+
+/***********************************************************************************
+ * cm_probe_grid_start() - probe a grid of points over a surface and keep the results
+ *
+ *  {prgs:1} probes the grid set by the prg group: columns from prgxn every prgp up
+ *  to prgxm, rows from prgyn every prgp up to prgym (machine coordinates, mm). Each
+ *  point probes down from the prgzc travel height towards prgzp at prgf mm/min.
+ *  Rows run in alternating directions to keep the moves between points short.
+ *
+ *  The retract, the move to the next point and the next probe move are queued as
+ *  one batch, so the planner runs them as a continuous path and the cycle only
+ *  waits on the probe move itself. A queued command arms probing mode just before
+ *  each probe move so that lifting off the surface is not taken as a trip.
+ *
+ *  Contact Z (machine coordinates) goes into probe_grid.z[][], and the whole grid
+ *  is sent as one JSON report when the cycle ends: {"prg":{"e":1,"nx":..,"z":[[..]]}}
+ *  {prgd:n} sends the report again. A point that makes no contact ends the cycle
+ *  with an alarm, as G38.2 does.
+ */
+
+static void _grid_index(uint16_t point, uint8_t &row, uint8_t &col)
+{
+    row = point / probe_grid.nx;
+    col = point % probe_grid.nx;
+    if (row & 1) {                          // odd rows run back
+        col = probe_grid.nx - 1 - col;
+    }
+}
+
+static void _grid_arm_callback(float* vect, bool* flag)
+{
+    grid_tripped_at_arm = (pb.trip_sense == gpio_read_input(pb.probe_input));
+    gpio_set_probing_mode(pb.probe_input, true);
+}
+
+static stat_t _grid_traverse_z(float z)
+{
+    float target[AXES] = INIT_AXES_ZEROES;
+    bool flags[AXES] = INIT_AXES_ZEROES;
+
+    target[AXIS_Z] = z;
+    flags[AXIS_Z] = true;
+    return (cm_straight_traverse(target, flags, PROFILE_NORMAL));
+}
+
+static stat_t _grid_queue_point(uint16_t point)
+{
+    float target[AXES] = INIT_AXES_ZEROES;
+    bool flags[AXES] = INIT_AXES_ZEROES;
+    uint8_t row, col;
+
+    cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS);
+    ritorno(_grid_traverse_z(pb.z_clear));
+
+    if (pb.tram) {
+        target[AXIS_X] = pb.tram_xy[point][0];
+        target[AXIS_Y] = pb.tram_xy[point][1];
+    } else {
+        _grid_index(point, row, col);
+        target[AXIS_X] = probe_grid.x_min + col * probe_grid.pitch;
+        target[AXIS_Y] = probe_grid.y_min + row * probe_grid.pitch;
+    }
+    flags[AXIS_X] = true;
+    flags[AXIS_Y] = true;
+    ritorno(cm_straight_traverse(target, flags, PROFILE_NORMAL));
+    mp_queue_command(_grid_arm_callback, nullptr, nullptr);
+
+    flags[AXIS_X] = false;
+    flags[AXIS_Y] = false;
+    flags[AXIS_Z] = true;
+    target[AXIS_Z] = pb.z_probe;
+    cm_set_feed_rate(pb.feed_rate);
+    pb.waiting_for_motion_complete = true;
+    ritorno(cm_straight_feed(target, flags, PROFILE_FAST));
+    mp_queue_command(_motion_end_callback, nullptr, nullptr);
+    return (STAT_OK);
+}
+
+stat_t cm_probe_grid_start()
+{
+    ritorno(cm_is_alarmed());
+    if ((cm->machine_state == MACHINE_CYCLE) || !mp_runtime_is_idle() ||
+        (mp_get_planner_buffers(mp) != mp->q.queue_size)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    if ((pb.probe_input = gpio_get_probing_input()) == -1) {
+        return (STAT_NO_PROBE_INPUT_CONFIGURED);
+    }
+    if ((probe_grid.pitch <= 0) || (probe_grid.feed_rate <= 0) || (probe_grid.x_max < probe_grid.x_min) ||
+        (probe_grid.y_max < probe_grid.y_min) || (probe_grid.z_probe >= probe_grid.z_clear)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    float nx = floor((probe_grid.x_max - probe_grid.x_min) / probe_grid.pitch + EPSILON) + 1;
+    float ny = floor((probe_grid.y_max - probe_grid.y_min) / probe_grid.pitch + EPSILON) + 1;
+    if ((nx > PROBE_GRID_MAX) || (ny > PROBE_GRID_MAX)) {
+        return (STAT_INPUT_EXCEEDS_MAX_VALUE);
+    }
+    probe_grid.nx = (uint8_t)nx;
+    probe_grid.ny = (uint8_t)ny;
+    probe_grid.points = 0;
+    probe_grid.state = PROBE_WAITING;
+
+    pb.tram = false;
+    pb.point_count = (uint16_t)probe_grid.nx * probe_grid.ny;
+    pb.z_clear = probe_grid.z_clear;
+    pb.z_probe = probe_grid.z_probe;
+    pb.feed_rate = probe_grid.feed_rate;
+    return (_grid_cycle_start());
+}
+
+static stat_t _grid_cycle_start()
+{
+    pb.trip_sense = true;                   // grid points are G38.2 style probes
+    pb.alarm_flag = true;
+    pb.touches = 0;                         // one touch a point - multi-touch is for G38.x
+    pb.point = 0;
+    cm->machine_state = MACHINE_CYCLE;
+    cm->cycle_type = CYCLE_PROBE;
+    _probe_save_settings();
+
+    pb.func = _grid_point_done;
+    stat_t status = _grid_queue_point(0);
+    if (status != STAT_OK) {
+        return (_probing_exception_exit(status));
+    }
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * _grid_point_done() - record the point just probed and queue the next one
+ * _grid_finish()     - exit once the final retract has completed
+ */
+
+static stat_t _grid_point_done()
+{
+    gpio_set_probing_mode(pb.probe_input, false);   // lifting off must not trip
+
+    if (grid_tripped_at_arm || (pb.trip_sense != gpio_read_input(pb.probe_input))) {
+        if (pb.tram) {
+            cm->probe_state[pb.point] = PROBE_FAILED;
+        } else {
+            probe_grid.state = PROBE_FAILED;
+            _send_grid_report();
+        }
+        return (_probing_exception_exit(STAT_PROBE_CYCLE_FAILED));
+    }
+    float contact_position[AXES];
+    kn_forward_kinematics(en_get_encoder_snapshot_vector(), contact_position);
+    if (pb.tram) {
+        copy_vector(cm->probe_results[pb.point], contact_position);
+        cm->probe_state[pb.point] = PROBE_SUCCEEDED;
+    } else {
+        uint8_t row, col;
+        _grid_index(pb.point, row, col);
+        probe_grid.z[row][col] = contact_position[AXIS_Z];
+        probe_grid.points = pb.point + 1;
+    }
+
+    stat_t status;
+    if (++pb.point < pb.point_count) {
+        status = _grid_queue_point(pb.point);
+    } else {
+        pb.waiting_for_motion_complete = true;
+        status = _grid_traverse_z(pb.z_clear);
+        mp_queue_command(_motion_end_callback, nullptr, nullptr);
+        pb.func = _grid_finish;
+    }
+    if (status != STAT_OK) {
+        return (_probing_exception_exit(status));
+    }
+    return (STAT_EAGAIN);
+}
+
+static stat_t _grid_finish()
+{
+    _probe_restore_settings();
+    if (pb.tram) {
+        stat_t status = cm_tram_from_probes();
+        xio_writeline((status == STAT_OK) ? "{\"tram\":true}\n" : "{\"tram\":false}\n");
+        return (status);
+    }
+    probe_grid.state = PROBE_SUCCEEDED;
+    _send_grid_report();
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * cm_probe_tram_start() - G29: probe three points and tram the bed from them
+ * _tram_start()         - start probing once the moves ahead of it have run
+ *
+ *  Runs the grid probing cycle over the three points given (machine coordinates, mm)
+ *  instead of a grid. The contacts go into cm->probe_results[0..2], and the rotation
+ *  matrix is set from them as {tram:1} would, so the whole bed is trammed as one
+ *  queued path with no lines or responses going through the host. {"tram":true} is
+ *  sent when it is done. The old rotation is dropped first, so the points are probed
+ *  in machine space. A point that makes no contact ends the cycle with an alarm.
+ *
+ *  Called from the gcode parser, so it waits for the moves already queued to finish
+ *  before it takes over the planner, the same way G38.2 does.
+ */
+
+stat_t cm_probe_tram_start(const float points[PROBES_STORED][2], float z_clear, float z_probe, float feed_rate)
+{
+    if ((pb.probe_input = gpio_get_probing_input()) == -1) {
+        return (STAT_NO_PROBE_INPUT_CONFIGURED);
+    }
+    if ((feed_rate <= 0) || (z_probe >= z_clear)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    pb.tram = true;
+    memcpy(pb.tram_xy, points, sizeof(pb.tram_xy));
+    pb.point_count = PROBES_STORED;
+    pb.z_clear = z_clear;
+    pb.z_probe = z_probe;
+    pb.feed_rate = feed_rate;
+
+    pb.func = _tram_start;
+    cm->probe_state[0] = PROBE_WAITING;     // lets cm_probing_cycle_callback() run _tram_start()
+    pb.waiting_for_motion_complete = true;
+    mp_queue_command(_motion_end_callback, nullptr, nullptr);
+    return (STAT_OK);
+}
+
+static stat_t _tram_start()
+{
+    canonical_machine_reset_rotation(cm);
+    for (uint8_t n = 0; n < PROBES_STORED; n++) {
+        cm->probe_state[n] = PROBE_FAILED;
+        clear_vector(cm->probe_results[n]);
+    }
+    ritorno(_grid_cycle_start());
+    return (STAT_EAGAIN);
+}
+
+/*
+ * _send_grid_report() - send the grid as one JSON object, a row at a time. Points not probed are null
+ */
+
+static void _send_grid_report()
+{
+    char buf[PROBE_GRID_MAX * 12 + 64];     // room for one row
+    char* bufp;
+
+    sprintf(buf, "{\"prg\":{\"e\":%i,\"nx\":%i,\"ny\":%i,\"p\":%0.3f,\"z\":[",
+            (int)probe_grid.state, (int)probe_grid.nx, (int)probe_grid.ny, probe_grid.pitch);
+    xio_writeline(buf);
+
+    for (uint8_t row = 0; row < probe_grid.ny; row++) {
+        bufp = buf;
+        bufp += sprintf(bufp, "%s[", (row == 0) ? "" : ",");
+        for (uint8_t col = 0; col < probe_grid.nx; col++) {
+            uint16_t point = row * probe_grid.nx + ((row & 1) ? (probe_grid.nx - 1 - col) : col);
+            if (point < probe_grid.points) {
+                bufp += sprintf(bufp, "%s%0.3f", (col == 0) ? "" : ",", probe_grid.z[row][col]);
+            } else {
+                bufp += sprintf(bufp, "%snull", (col == 0) ? "" : ",");
+            }
+        }
+        sprintf(bufp, "]");
+        xio_writeline(buf);
+    }
+    xio_writeline("]}}\n");
+}
+
+/***********************************************************************************
+ **** Tool Measurement Cycle (G37) ************************************************
+ ***********************************************************************************/
+
+/***********************************************************************************
+ * cm_measure_tool() - G37 Hn: measure tool n on the tool setter and set its length
+ * _tool_start()     - go to the setter once the moves ahead of it have run
+ * _tool_probe()     - probe down onto the setter
+ * _tool_measured()  - set the length and go back up
+ * _tool_finish()    - exit once the retract has completed
+ *
+ *  Goes up to the {tlsc:} travel height, over to the setter at {tlsx:} {tlsy:}, and
+ *  probes down towards {tlsp:} at {tlsf:} mm/min. It is a two-stage probe: the fast
+ *  touch finds the setter, then the slow touches of the multi-touch G38.x probe
+ *  ({prbn:} of them, at least one, {prbk:} backoff, {prbs:} feed rate) measure it.
+ *  The averaged contact Z less {tlsr:}, the contact Z of a zero length tool, is the
+ *  tool's Z offset in the tool table, as G10 L1 Pn Z would set it. It is persisted
+ *  when the cycle is over, and applies at the next G43. The cycle ends back at the
+ *  travel height and sends {"tlm":{"e":1,"t":n,"z":contact,"l":length}}.
+ *
+ *  H0 or no H measures the selected tool. Measuring a set of tools is a loop of M6
+ *  and G37 lines, with no host round trips in between. Use the contact Z ("z") from
+ *  measuring the reference tool or a gauge to set {tlsr:}. A tool that makes no
+ *  contact ends the cycle with an alarm and leaves the table alone.
+ *
+ *  Called from the gcode parser, so it waits for the moves already queued to finish
+ *  before it takes over the planner, the same way G38.2 does.
+ */
+
+stat_t cm_measure_tool(const uint8_t H_word, const bool H_flag)
+{
+    uint8_t tool = ((H_flag && (H_word > 0)) ? H_word : cm->gm.tool);
+    if ((tool < 1) || (tool > TOOLS)) {
+        return (STAT_H_WORD_IS_INVALID);
+    }
+    if ((pb.probe_input = gpio_get_probing_input()) == -1) {
+        return (STAT_NO_PROBE_INPUT_CONFIGURED);
+    }
+    if ((tool_setter.feed_rate <= 0) || (tool_setter.z_probe >= tool_setter.z_clear) ||
+        fp_ZERO(cm->probe_slow_feed) || (cm->probe_backoff < MINIMUM_PROBE_TRAVEL)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    pb.tool = tool;
+    _probe_roll_results();
+
+    pb.func = _tool_start;
+    cm->probe_state[0] = PROBE_WAITING;     // lets cm_probing_cycle_callback() run _tool_start()
+    pb.waiting_for_motion_complete = true;
+    mp_queue_command(_motion_end_callback, nullptr, nullptr);
+    return (STAT_OK);
+}
+
+static stat_t _tool_start()
+{
+    float target[AXES] = INIT_AXES_ZEROES;
+    bool flags[AXES] = INIT_AXES_ZEROES;
+
+    pb.trip_sense = true;                   // a G38.2 style probe
+    pb.alarm_flag = true;
+    pb.touches = max(cm->probe_touches, (uint8_t)1);
+    pb.done = _tool_measured;
+    cm->probe_state[0] = PROBE_FAILED;
+    cm->machine_state = MACHINE_CYCLE;
+    cm->cycle_type = CYCLE_PROBE;
+    _probe_save_settings();
+
+    cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS);
+    stat_t status = _grid_traverse_z(tool_setter.z_clear);
+    if (status == STAT_OK) {
+        target[AXIS_X] = tool_setter.x;
+        target[AXIS_Y] = tool_setter.y;
+        flags[AXIS_X] = true;
+        flags[AXIS_Y] = true;
+        pb.waiting_for_motion_complete = true;
+        status = cm_straight_traverse(target, flags, PROFILE_NORMAL);
+        mp_queue_command(_motion_end_callback, nullptr, nullptr);
+    }
+    if (status != STAT_OK) {
+        return (_probing_exception_exit(status));
+    }
+    pb.func = _tool_probe;
+    return (STAT_EAGAIN);
+}
+
+static stat_t _tool_probe()
+{
+    copy_vector(pb.target, cm->gmx.position);
+    pb.target[AXIS_Z] = tool_setter.z_probe;
+    clear_vector(pb.flags);
+    pb.flags[AXIS_Z] = true;
+    cm->gm.feed_rate = tool_setter.feed_rate;
+    return (_probe_first_touch());
+}
+
+static stat_t _tool_measured()
+{
+    gpio_set_probing_mode(pb.probe_input, false);   // lifting off must not trip
+    copy_vector(cm->probe_results[0], cm->gmx.position);
+    if (cm->probe_state[0] != PROBE_SUCCEEDED) {
+        _send_tool_report();
+        return (_probing_exception_exit(STAT_PROBE_CYCLE_FAILED));
+    }
+    tt.tt_offset[pb.tool][AXIS_Z] = cm->probe_results[0][AXIS_Z] - tool_setter.z_reference;
+    cm->deferred_write_flag = true;                 // persist the table once the cycle is over
+    cm->deferred_write_tools |= (1UL << (pb.tool - 1));
+
+    pb.waiting_for_motion_complete = true;
+    stat_t status = _grid_traverse_z(tool_setter.z_clear);
+    mp_queue_command(_motion_end_callback, nullptr, nullptr);
+    if (status != STAT_OK) {
+        return (_probing_exception_exit(status));
+    }
+    pb.func = _tool_finish;
+    return (STAT_EAGAIN);
+}
+
+static stat_t _tool_finish()
+{
+    _probe_restore_settings();
+    _send_tool_report();
+    return (STAT_OK);
+}
+
+/*
+ * _send_tool_report() - report a G37 measurement
+ */
+
+static void _send_tool_report()
+{
+    char buf[96];
+    if (cm->probe_state[0] == PROBE_SUCCEEDED) {
+        sprintf(buf, "{\"tlm\":{\"e\":1,\"t\":%i,\"z\":%0.3f,\"l\":%0.3f}}\n",
+                (int)pb.tool, cm->probe_results[0][AXIS_Z], tt.tt_offset[pb.tool][AXIS_Z]);
+    } else {
+        sprintf(buf, "{\"tlm\":{\"e\":0,\"t\":%i}}\n", (int)pb.tool);
+    }
+    xio_writeline(buf);
+}
+
+/*
+ * cm_run_prgs() - start grid probing
+ * cm_get_prgn() - get number of grid points probed
+ * cm_get_prgd() - send the grid results report, return the number of points probed
+ */
+
+stat_t cm_run_prgs(nvObj_t *nv)
+{
+    return (cm_probe_grid_start());
+}
+
+stat_t cm_get_prgn(nvObj_t *nv)
+{
+    nv->value_int = probe_grid.points;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t cm_get_prgd(nvObj_t *nv)
+{
+    _send_grid_report();
+    return (cm_get_prgn(nv));
+}
+
 /*
  * cm_get_prbr() - get probe report enable setting
  * cm_set_prbr() - set probe report enable setting
@@ -388,3 +954,23 @@ stat_t cm_set_prbr(nvObj_t *nv)
     cm->probe_report_enable = nv->value_int;
     return (STAT_OK);
 }
+
+/*
+ * cm_get_tls() - get a tool setter setting
+ * cm_set_tls() - set a tool setter setting
+ */
+
+static float &_tls(nvObj_t *nv)
+{
+    switch (cfgArray[nv->index].token[3]) {
+        case 'x': return (tool_setter.x);
+        case 'y': return (tool_setter.y);
+        case 'c': return (tool_setter.z_clear);
+        case 'p': return (tool_setter.z_probe);
+        case 'f': return (tool_setter.feed_rate);
+        default:  return (tool_setter.z_reference);
+    }
+}
+
+stat_t cm_get_tls(nvObj_t *nv) { return (get_float(nv, _tls(nv))); }
+stat_t cm_set_tls(nvObj_t *nv) { return (set_float(nv, _tls(nv))); }
@@ -0,0 +1,86 @@
+/*
+ * cycle_threading.cpp - spindle synchronized motion (G33)
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * SPINDLE SYNCHRONIZED MOTION
+ *
+ *  "G33 Z-20 K1.5" feeds to the target advancing K per spindle revolution. G33 is modal,
+ *  and K must be given on each line. Each G33 line is a pass that starts from rest on the
+ *  next spindle index, so a thread is cut in several passes from the same start point,
+ *  each a little deeper, and they all land in the same groove. A multi-pass cycle like
+ *  G76 is generated as a series of G33 passes by the CAM or the operator.
+ *
+ *  S must be non-zero, and an input must be set to the spindle index function. A pass
+ *  that sees no index within SPINDLE_SYNC_INDEX_TIMEOUT_MS alarms. The move is planned at K * S, then run locked to the index as
+ *  described in spindle.cpp (see spindle_sync_segment_time()). Keep the feed override at
+ *  100% while threading; a feedhold drops the lock for the rest of the pass.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "spindle.h"
+#include "util.h"
+
+static void _thread_end(float* value, bool* flag)
+{
+    spindle_sync_end();
+}
+
+/*
+ * cm_thread_feed() - canonical machine entry point for G33
+ *
+ *  Queues a wait for the index, the move at the synchronized feed, and the end of the lock.
+ *  The wait and the end are command blocks, so the move starts and stops at zero velocity.
+ */
+
+stat_t cm_thread_feed(const float target[], const bool target_f[], const float K_word, const bool K_word_f)
+{
+    if (!(target_f[AXIS_X] | target_f[AXIS_Y] | target_f[AXIS_Z] |
+          target_f[AXIS_U] | target_f[AXIS_V] | target_f[AXIS_W] |
+          target_f[AXIS_A] | target_f[AXIS_B] | target_f[AXIS_C])) {
+        cm->gm.motion_mode = MOTION_MODE_SPINDLE_SYNC;
+        return (STAT_OK);
+    }
+    if (!spindle_has_index()) {
+        return (STAT_SPINDLE_INDEX_NOT_CONFIGURED);
+    }
+    if (fp_ZERO(spindle.planned_speed)) {           // a stopped spindle times out waiting for the index
+        return (STAT_SPINDLE_MUST_BE_TURNING);
+    }
+    if (!K_word_f || (K_word <= 0)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    // the blocks fit in the PLANNER_BUFFER_HEADROOM held for each line
+    ritorno(spindle_spinup_wait_sync());            // ahead of the index wait, which times out
+    float value[AXES] = { spindle.planned_speed / 60 };     // revolutions per second
+    mp_queue_wait(spindle_sync_wait, value);
+
+    float feed_rate = cm->gm.feed_rate;
+    cmFeedRateMode feed_rate_mode = cm->gm.feed_rate_mode;
+    cm->gm.feed_rate = _to_millimeters(K_word) * spindle.planned_speed;
+    cm->gm.feed_rate_mode = UNITS_PER_MINUTE_MODE;
+    stat_t status = cm_straight_feed(target, target_f, PROFILE_NORMAL);
+    cm->gm.feed_rate = feed_rate;
+    cm->gm.feed_rate_mode = feed_rate_mode;
+    cm->gm.motion_mode = MOTION_MODE_SPINDLE_SYNC;
+
+    mp_queue_command(_thread_end, nullptr, nullptr);
+    return (status);
+}
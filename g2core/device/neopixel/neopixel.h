@@ -407,7 +407,14 @@ struct NeoPixel {
     // 1 bit of "buffer"
     // 32 bits per pixel
     // 1 bit to turn the PWM off
-    uint16_t _period_buffer[1 + 32 * pixel_count + 1];
+    //
+    // The period buffers are double buffered: the PWM DMA reads one while the other is being
+    // encoded. Each buffer remembers the pixel values it holds, so update() only re-encodes
+    // the pixels that changed since that buffer was last sent.
+    uint16_t _period_buffer[2][1 + 32 * pixel_count + 1];
+    uint32_t _encoded_value[2][pixel_count];
+    uint32_t _pixel_value[pixel_count];
+    uint8_t  _back_buffer = 0;
 
     Motate::Timeout _update_timeout;
     const uint32_t  _update_timeout_ms;
@@ -431,13 +438,20 @@ struct NeoPixel {
         // ... on every period
         _pixel_pin.setSyncMode(Motate::kTimerSyncDMA, 1);
 
+        // Make every pixel of both buffers differ from its (black) value so the first update encodes it all
+        for (uint8_t pixel = 0; pixel < pixel_count; pixel++) {
+            _pixel_value[pixel]      = 0;
+            _encoded_value[0][pixel] = ~0UL;
+            _encoded_value[1][pixel] = ~0UL;
+        }
+
         _update_timeout.set(0);
     };
 
+    // setPixel() only records the value - the encoding is done by update() for changed pixels
     void setPixel(uint8_t pixel, uint8_t red, uint8_t green, uint8_t blue, int16_t white = -1) {
-        uint8_t data_width = 32;
-        if (!_has_white) {
-            data_width = 24;
+        if (pixel >= pixel_count) {
+            return;
         }
         if (_has_white && (white == -1)) {
             // Adjust all of the RGB to accomodate white
@@ -446,45 +460,14 @@ struct NeoPixel {
             // green -= white;
             // blue -= white;
         }
-        _period_buffer[0 + 1 + _red_offset + (pixel * data_width)] = (red & 0b10000000) ? led_ON : led_OFF;
-        _period_buffer[1 + 1 + _red_offset + (pixel * data_width)] = (red & 0b01000000) ? led_ON : led_OFF;
-        _period_buffer[2 + 1 + _red_offset + (pixel * data_width)] = (red & 0b00100000) ? led_ON : led_OFF;
-        _period_buffer[3 + 1 + _red_offset + (pixel * data_width)] = (red & 0b00010000) ? led_ON : led_OFF;
-        _period_buffer[4 + 1 + _red_offset + (pixel * data_width)] = (red & 0b00001000) ? led_ON : led_OFF;
-        _period_buffer[5 + 1 + _red_offset + (pixel * data_width)] = (red & 0b00000100) ? led_ON : led_OFF;
-        _period_buffer[6 + 1 + _red_offset + (pixel * data_width)] = (red & 0b00000010) ? led_ON : led_OFF;
-        _period_buffer[7 + 1 + _red_offset + (pixel * data_width)] = (red & 0b00000001) ? led_ON : led_OFF;
-
-        _period_buffer[0 + 1 + _green_offset + (pixel * data_width)] = (green & 0b10000000) ? led_ON : led_OFF;
-        _period_buffer[1 + 1 + _green_offset + (pixel * data_width)] = (green & 0b01000000) ? led_ON : led_OFF;
-        _period_buffer[2 + 1 + _green_offset + (pixel * data_width)] = (green & 0b00100000) ? led_ON : led_OFF;
-        _period_buffer[3 + 1 + _green_offset + (pixel * data_width)] = (green & 0b00010000) ? led_ON : led_OFF;
-        _period_buffer[4 + 1 + _green_offset + (pixel * data_width)] = (green & 0b00001000) ? led_ON : led_OFF;
-        _period_buffer[5 + 1 + _green_offset + (pixel * data_width)] = (green & 0b00000100) ? led_ON : led_OFF;
-        _period_buffer[6 + 1 + _green_offset + (pixel * data_width)] = (green & 0b00000010) ? led_ON : led_OFF;
-        _period_buffer[7 + 1 + _green_offset + (pixel * data_width)] = (green & 0b00000001) ? led_ON : led_OFF;
-
-        _period_buffer[0 + 1 + _blue_offset + (pixel * data_width)] = (blue & 0b10000000) ? led_ON : led_OFF;
-        _period_buffer[1 + 1 + _blue_offset + (pixel * data_width)] = (blue & 0b01000000) ? led_ON : led_OFF;
-        _period_buffer[2 + 1 + _blue_offset + (pixel * data_width)] = (blue & 0b00100000) ? led_ON : led_OFF;
-        _period_buffer[3 + 1 + _blue_offset + (pixel * data_width)] = (blue & 0b00010000) ? led_ON : led_OFF;
-        _period_buffer[4 + 1 + _blue_offset + (pixel * data_width)] = (blue & 0b00001000) ? led_ON : led_OFF;
-        _period_buffer[5 + 1 + _blue_offset + (pixel * data_width)] = (blue & 0b00000100) ? led_ON : led_OFF;
-        _period_buffer[6 + 1 + _blue_offset + (pixel * data_width)] = (blue & 0b00000010) ? led_ON : led_OFF;
-        _period_buffer[7 + 1 + _blue_offset + (pixel * data_width)] = (blue & 0b00000001) ? led_ON : led_OFF;
-
+        uint32_t value = ((uint32_t)red << 24) | ((uint32_t)green << 16) | ((uint32_t)blue << 8);
         if (_has_white) {
-            _period_buffer[0 + 1 + _white_offset + (pixel * 32)] = (white & 0b10000000) ? led_ON : led_OFF;
-            _period_buffer[1 + 1 + _white_offset + (pixel * 32)] = (white & 0b01000000) ? led_ON : led_OFF;
-            _period_buffer[2 + 1 + _white_offset + (pixel * 32)] = (white & 0b00100000) ? led_ON : led_OFF;
-            _period_buffer[3 + 1 + _white_offset + (pixel * 32)] = (white & 0b00010000) ? led_ON : led_OFF;
-            _period_buffer[4 + 1 + _white_offset + (pixel * 32)] = (white & 0b00001000) ? led_ON : led_OFF;
-            _period_buffer[5 + 1 + _white_offset + (pixel * 32)] = (white & 0b00000100) ? led_ON : led_OFF;
-            _period_buffer[6 + 1 + _white_offset + (pixel * 32)] = (white & 0b00000010) ? led_ON : led_OFF;
-            _period_buffer[7 + 1 + _white_offset + (pixel * 32)] = (white & 0b00000001) ? led_ON : led_OFF;
+            value |= (uint8_t)white;
+        }
+        if (value != _pixel_value[pixel]) {
+            _pixel_value[pixel] = value;
+            _pixels_changed     = true;
         }
-
-        _pixels_changed = true;
     };
 
     template <
@@ -502,15 +485,43 @@ struct NeoPixel {
         }
     }
 
+    void _encodeByte(uint16_t* periods, uint8_t value) {
+        for (uint8_t bit = 0b10000000; bit; bit >>= 1) {
+            *periods++ = (value & bit) ? led_ON : led_OFF;
+        }
+    }
+
+    // Encode the pixels that differ from what the back buffer last held
+    void _encodeChangedPixels() {
+        uint16_t* buffer     = _period_buffer[_back_buffer];
+        uint8_t   data_width = _has_white ? 32 : 24;
+
+        for (uint8_t pixel = 0; pixel < pixel_count; pixel++) {
+            uint32_t value = _pixel_value[pixel];
+            if (value == _encoded_value[_back_buffer][pixel]) {
+                continue;
+            }
+            _encoded_value[_back_buffer][pixel] = value;
+
+            uint16_t* periods = buffer + 1 + (pixel * data_width);
+            _encodeByte(periods + _red_offset, value >> 24);
+            _encodeByte(periods + _green_offset, value >> 16);
+            _encodeByte(periods + _blue_offset, value >> 8);
+            if (_has_white) {
+                _encodeByte(periods + _white_offset, value);
+            }
+        }
+    }
+
     void update() {
-        if (!_pixel_pin.isTransferDone()) {
+        if (!_pixels_changed || !_pixel_pin.isTransferDone()) {
             return;
         }
-        //        if (!_pixels_changed) { return; }
-        //        _pixels_changed = false;
-
         if (_update_timeout.isPast()) {
-            _pixel_pin.startTransfer(_period_buffer);
+            _pixels_changed = false;
+            _encodeChangedPixels();
+            _pixel_pin.startTransfer(_period_buffer[_back_buffer]);
+            _back_buffer ^= 1;
             _update_timeout.set(_update_timeout_ms);
         }
     }
@@ -53,6 +53,9 @@ template <pin_number step_num,  // Setup a stepper template to hold our pins
 struct StepDirStepper final : Stepper  {
     /* stepper pin assignments */
 
+    typedef OutputPin<step_num> step_pin_type;  // exposed for port-grouped writes (STEP_PORT_LETTERS)
+    typedef OutputPin<dir_num>  dir_pin_type;
+
     OutputPin<step_num>    _step;
     uint8_t                _step_downcount;
     OutputPin<dir_num>     _dir;
@@ -65,14 +68,20 @@ struct StepDirStepper final : Stepper  {
     ioMode _step_polarity;                   // IO_ACTIVE_LOW or IO_ACTIVE_HIGH
     ioMode _enable_polarity;                 // IO_ACTIVE_LOW or IO_ACTIVE_HIGH
 
+    uint32_t _dir_setup_ns;                  // direction setup and hold times of the driver
+    uint32_t _dir_hold_ns;                   // ...see Direction timing in stepper.h
+
     // sets default pwm freq for all motor vrefs (commented line below also sets HiZ)
-    StepDirStepper(ioMode step_polarity, ioMode enable_polarity, const uint32_t frequency = 250000) :
+    StepDirStepper(ioMode step_polarity, ioMode enable_polarity, const uint32_t frequency = 250000,
+                   const uint32_t dir_setup_ns = DIRECTION_SETUP_NS, const uint32_t dir_hold_ns = DIRECTION_HOLD_NS) :
         Stepper{},
         _step{step_polarity==IO_ACTIVE_LOW?kStartHigh:kStartLow},
         _enable{enable_polarity==IO_ACTIVE_LOW?kStartHigh:kStartLow},
         _vref{kNormal, frequency},
         _step_polarity{step_polarity},
-        _enable_polarity{enable_polarity}
+        _enable_polarity{enable_polarity},
+        _dir_setup_ns{dir_setup_ns},
+        _dir_hold_ns{dir_hold_ns}
     {};
 
     /* Optional override of init */
@@ -168,6 +177,9 @@ struct StepDirStepper final : Stepper  {
         }
     };
 
+    uint32_t getDirectionSetupNs() const override { return _dir_setup_ns; };
+    uint32_t getDirectionHoldNs() const override { return _dir_hold_ns; };
+
     void setPowerLevel(float new_pl) override {
         if (!_vref.isNull()) {
             _vref = new_pl;
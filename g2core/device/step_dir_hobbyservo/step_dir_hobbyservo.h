@@ -40,6 +40,18 @@ using Motate::kStartHigh;
 using Motate::kNormal;
 using Motate::Timeout;
 
+/*
+ *  The servo is a position motor (see Position motors in stepper.h): it is sent the target of
+ *  each segment by the loader and takes no steps from the DDA. The full 750-2000 us pulse range
+ *  is 6400 steps at 32 microsteps, scaled for the motor's microsteps, from machine zero.
+ *
+ *  The pulse follows the target through a first-order filter with a time constant of
+ *  smoothing_ms, 0 for none, which takes the segment steps out of the servo's motion. The
+ *  filter settles on the target once motion has stopped.
+ */
+#ifndef HOBBY_SERVO_SMOOTHING_MS
+#define HOBBY_SERVO_SMOOTHING_MS    0.0     // pulse width smoothing time constant, 0 = none
+#endif
 
 // Motor structures
 template <pin_number pwm_pin_num>  // Setup a stepper template to hold our pins
@@ -47,18 +59,19 @@ struct StepDirHobbyServo final : Stepper {
     /* stepper pin assignments */
 
     int16_t                _microsteps_per_step = 1;
-    bool                   _step_is_forward = false;
-    int32_t                _position = 0; // in steps from 0 - 6400 for a full "rotation"
-    int32_t                _position_computed = 0; // in steps from 0 - 6400 for a full "rotation"
+    float                  _target = 0;             // in steps from 0 - 6400 for a full "rotation"
+    float                  _position = 0;           // smoothed target, in the same steps
+    float                  _position_computed = 0;  // PWM duty value for _position
     float                  _min_value;
     float                  _max_value;
     float                  _value_range;
+    float                  _smoothing;              // filter time constant in seconds
     bool                   _enabled = false;
     PWMOutputPin<pwm_pin_num> _pwm_pin;
-    Motate::Timeout check_timer;
 
     // sets default pwm freq for all motor vrefs (commented line below also sets HiZ)
-    StepDirHobbyServo(const uint32_t frequency = 50) : Stepper{}, _pwm_pin{kNormal, frequency} {
+    StepDirHobbyServo(const uint32_t frequency = 50, const float smoothing_ms = HOBBY_SERVO_SMOOTHING_MS) :
+        Stepper{}, _pwm_pin{kNormal, frequency} {
         _pwm_pin.setFrequency(frequency); // redundant due to a bug
         uint16_t _top_value = _pwm_pin.getTopValue();
         float frequency_inv = 1.0/(float)frequency;
@@ -66,7 +79,7 @@ struct StepDirHobbyServo final : Stepper {
         _max_value = (float)_top_value / ((frequency_inv)/(2000.0/1000000.0));
         _value_range = _max_value - _min_value;
         _position_computed = _min_value;
-        check_timer.set(1);
+        _smoothing = smoothing_ms / 1000.0;
     };
 
     /* Optional override of init */
@@ -114,35 +127,45 @@ struct StepDirHobbyServo final : Stepper {
         _pwm_pin.setExactDutyCycle(0, true);
     };
 
-    void stepStart() override {
-        if (!_enabled) return;
-
-        if (_step_is_forward) {
-            _position += _microsteps_per_step;
-        } else {
-            _position -= _microsteps_per_step;
+    void _setPosition(const float position) {
+        _position = position;
+        _position_computed = _min_value + ((_position/6400.0) * _value_range);
+        if (_enabled) {
+            _pwm_pin.setExactDutyCycle(_position_computed, true); // apply the change
         }
+    };
 
-        if (!check_timer.isPast()) { return; }
-        check_timer.set(10);
+    bool takesPosition() override { return true; };
 
-        float used_position = _position;
-        if (used_position > 6400.0) {
-            used_position = 6400.0;
+    void setTargetPosition(const float target_steps, const float seconds) override {
+        _target = target_steps * _microsteps_per_step;
+        if (_target > 6400.0) {
+            _target = 6400.0;
         }
-        if (used_position < 0.0) {
-            used_position = 0.0;
+        if (_target < 0.0) {
+            _target = 0.0;
         }
+        if (seconds < _smoothing) {
+            _setPosition(_position + (_target - _position) * (seconds / _smoothing));
+        } else {
+            _setPosition(_target);
+        }
+    };
 
-        _position_computed = _min_value + ((used_position/6400.0) * _value_range);
-        _pwm_pin.setExactDutyCycle(_position_computed, true); // apply the change
+    void periodicCheck(bool have_actually_stopped) override {
+        if (have_actually_stopped && (_position != _target)) {    // the loader is idle - settle the filter
+            _setPosition(_target);
+        }
+        Stepper::periodicCheck(have_actually_stopped);
+    };
+
+    void stepStart() override {
     };
 
     void stepEnd() override {
     };
 
     void setDirection(uint8_t new_direction) override {
-        _step_is_forward = new_direction;
     };
 
     void setPowerLevel(float new_pl) override {
@@ -40,6 +40,36 @@ using Motate::SPIDeviceMode;
 using Motate::fromBigEndian;
 using Motate::toBigEndian;
 
+// All Trinamic2130 drivers poll their status on one shared schedule. Every driver queues
+// its status reads in the same main loop pass, so the bus runs the whole set back to back
+// once per period instead of as staggered per-driver trickles.
+#define TRINAMIC2130_POLL_MS 100
+
+// StallGuard2 only works above a minimum velocity. TCOOLTHRS is the slowest step period
+// (TSTEP, in 1/fCLK units per microstep) that reports stalls while stall detection is armed.
+#ifndef TRINAMIC2130_STALL_TCOOLTHRS
+#define TRINAMIC2130_STALL_TCOOLTHRS 0x00000800
+#endif
+
+struct Trinamic2130PollSchedule {
+    Motate::Timeout timer;
+    uint32_t period_count = 0;
+
+    // Returns a new count once per poll period - drivers poll when it changes
+    uint32_t currentPeriod() {
+        if (!timer.isSet() || timer.isPast()) {
+            timer.set(TRINAMIC2130_POLL_MS);
+            period_count++;
+        }
+        return period_count;
+    };
+};
+
+inline Trinamic2130PollSchedule &trinamic2130PollSchedule() {
+    static Trinamic2130PollSchedule schedule;
+    return schedule;
+}
+
 // Complete class for Trinamic2130 drivers.
 // It's also a proper Stepper object.
 template <typename device_t,
@@ -84,8 +114,13 @@ struct Trinamic2130 final : Stepper {
     // data requested. Otherwise we'll loop forever.
     bool _reading_only = false;
 
-    // Timer to keep track of when we need to do another periodic update
-    Motate::Timeout check_timer;
+    // The shared poll period this driver last queued its status reads for
+    uint32_t _polled_period = 0;
+
+    // Power level and the run and hold current scales applied to it
+    float _power_level = 0.0;
+    float _run_scale = 1.0;
+    float _hold_scale = 1.0;
 
     // Constructor - this is the only time we directly use the SBIBus
     template <typename SPIBus_t, typename chipSelect_t>
@@ -147,16 +182,56 @@ struct Trinamic2130 final : Stepper {
 
     void setPowerLevel(float new_pl) override
     {
-        // scale the 0.0-1.0 to 0-31
-        IHOLD_IRUN.IRUN = (new_pl * 31.0);
+        _power_level = new_pl;
+        _updatePowerLevel();
+    };
 
-        // for now, we'll have the holding be the same
-        IHOLD_IRUN.IHOLD = (new_pl * 31.0);
+    // The run current is scaled down in the cruise section of a move, and the hold current
+    // is a fixed fraction of the power level.
+    void setPowerScale(const float run_scale, const float hold_scale) override
+    {
+        _run_scale = run_scale;
+        _hold_scale = hold_scale;
+        _updatePowerLevel();
+    };
+
+    void _updatePowerLevel()
+    {
+        // scale the 0.0-1.0 to 0-31
+        uint8_t irun = (_power_level * _run_scale * 31.0);
+        uint8_t ihold = (_power_level * _hold_scale * 31.0);
+        if ((irun == IHOLD_IRUN.IRUN) && (ihold == IHOLD_IRUN.IHOLD)) {
+            return;
+        }
+        IHOLD_IRUN.IRUN = irun;
+        IHOLD_IRUN.IHOLD = ihold;
 
         IHOLD_IRUN_needs_written = true;
         _startNextReadWrite();
     };
 
+    // Stall sensing uses the StallGuard2 flag in DRV_STATUS. While armed, DRV_STATUS is read
+    // on every periodicCheck() pass rather than once per poll period, and TCOOLTHRS enables
+    // StallGuard above the minimum velocity where its reading is meaningful.
+    bool canSenseStall() override { return true; };
+
+    void setStallThreshold(const float threshold) override
+    {
+        COOLCONF.sgt = ((int8_t)threshold) & 0x7F;
+        COOLCONF.sfilt = 0;             // unfiltered for the fastest response
+        COOLCONF_needs_written = true;
+        _startNextReadWrite();
+    };
+
+    void setStallDetect(const bool armed) override
+    {
+        _stall_armed = armed;
+        _stall_reported = false;
+        TCOOLTHRS.value = armed ? TRINAMIC2130_STALL_TCOOLTHRS : 0;
+        TCOOLTHRS_needs_written = true;
+        _startNextReadWrite();
+    };
+
     // Note that init() and periodicCheck(bool have_actually_stopped) are both below
 
 
@@ -400,10 +475,23 @@ struct Trinamic2130 final : Stepper {
     volatile bool CHOPCONF_needs_read;
     volatile bool CHOPCONF_needs_written;
 
-    struct {
+    union {
         volatile uint32_t value;
         //        uint8_t bytes[4];
-    } COOLCONF; // 0x6D - READ ONLY
+        volatile struct {
+            uint32_t semin        : 4; //  0- 3
+            uint32_t              : 1; //  4
+            uint32_t seup         : 2; //  5- 6
+            uint32_t              : 1; //  7
+            uint32_t semax        : 4; //  8-11
+            uint32_t              : 1; // 12
+            uint32_t sedn         : 2; // 13-14
+            uint32_t seimin       : 1; // 15
+            uint32_t sgt          : 7; // 16-22 - signed, -64 to 63
+            uint32_t              : 1; // 23
+            uint32_t sfilt        : 1; // 24
+        }  __attribute__ ((packed));
+    } COOLCONF; // 0x6D - WRITE ONLY
     void _postReadCoolConf() {
         COOLCONF.value = fromBigEndian(in_buffer.value);
     };
@@ -434,9 +522,21 @@ struct Trinamic2130 final : Stepper {
     } DRV_STATUS; // 0x6F- READ ONLY
     void _postReadDriverStatus() {
         DRV_STATUS.value = fromBigEndian(in_buffer.value);
+
+        // Report a stall once per motion - standstill re-arms the report
+        if (DRV_STATUS.stst) {
+            _stall_reported = false;
+        } else if (_stall_armed && DRV_STATUS.stallGuard && !_stall_reported) {
+            _stall_reported = true;
+            st_motor_stalled(this);
+        }
     };
     volatile bool DRV_STATUS_needs_read;
 
+    // Stall detection state - see setStallDetect()
+    volatile bool _stall_armed = false;
+    volatile bool _stall_reported = false;
+
     union {
         volatile uint32_t value;
         //        uint8_t bytes[4];
@@ -621,7 +721,6 @@ struct Trinamic2130 final : Stepper {
 
         _inited = true;
         _startNextReadWrite();
-        check_timer.set(100);
 
         Stepper::init();
     };
@@ -629,12 +728,19 @@ struct Trinamic2130 final : Stepper {
     void periodicCheck(bool have_actually_stopped) override
     {
         Stepper::periodicCheck(have_actually_stopped);
-        if (check_timer.isPast()) {
-            check_timer.set(100);
+        uint32_t period = trinamic2130PollSchedule().currentPeriod();
+        if (period != _polled_period) {
+            _polled_period = period;
             IOIN_needs_read = true;
             CHOPCONF_needs_read = true;
             DRV_STATUS_needs_read = true;
-            _startNextReadWrite();
         }
+        if (_stall_armed) {
+            DRV_STATUS_needs_read = true;   // high rate readout while stall detection is armed
+        }
+        // Queue the next pending register every pass, not only when the poll fires. Each
+        // read request also clocks in the previous read's response, so a poll costs one
+        // transaction per register plus one to collect the last reply.
+        _startNextReadWrite();
     };
 };
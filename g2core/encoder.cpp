@@ -29,11 +29,16 @@
 #include "config.h"
 #include "encoder.h"
 #include "canonical_machine.h"  // needed for cm_panic() in assertions
+#include "stepper.h"            // for st_get_step_phase() and FREQUENCY_DDA
 
 /**** Allocate Structures ****/
 
 enEncoders_t en;
 
+static void _qdec_init(void);
+static void _probe_capture_init(void);
+static float _probe_capture_ticks_ago(void);
+
 /************************************************************************************
  **** CODE **************************************************************************
  ************************************************************************************/
@@ -46,6 +51,8 @@ enEncoders_t en;
 void encoder_init() {
     memset(&en, 0, sizeof(en));  // clear all values, pointers and status
     encoder_init_assertions();
+    _qdec_init();
+    _probe_capture_init();
 }
 
 void encoder_reset() { encoder_init(); }
@@ -74,19 +81,160 @@ stat_t encoder_test_assertions() {
  *	position except if the machine is at zero.
  */
 
-void en_set_encoder_steps(uint8_t motor, float steps) { en.en[motor].encoder_steps = (int32_t)round(steps); }
+void en_set_encoder_steps(uint8_t motor, float steps)
+{
+    enEncoder_t *e = &en.en[motor];
+    e->encoder_steps = (int32_t)round(steps);
+#ifdef ENCODER_QDEC
+    if (e->qdec != nullptr) {
+        e->count_offset = (int32_t)e->qdec->TC_CHANNEL[0].TC_CV - (int32_t)round(steps * e->counts_per_step);
+    }
+#endif
+    e->target_steps = steps;                // nothing is running, so there is no following error
+    e->commanded_steps = steps;
+    e->following_error = 0;
+}
 
 /*
- * en_read_encoder()
+ * en_set_counts_per_step() - enable a hardware encoder for a motor, or 0 to count steps
  *
- *	The stepper ISR count steps into steps_run(). These values are accumulated to
- *	encoder_position during LOAD (HI interrupt level). The encoder position is
- *	therefore always stable. But be advised: the position lags target and position
- *	valaes elsewhere in the system because the sample is taken when the steps for
- *	that segment are complete.
+ *	The encoder is zeroed to the current step count so switching over does not show up as
+ *	following error.
  */
 
-float en_read_encoder(uint8_t motor) { return ((float)en.en[motor].encoder_steps); }
+stat_t en_set_counts_per_step(uint8_t motor, float counts_per_step)
+{
+    enEncoder_t *e = &en.en[motor];
+    if (counts_per_step < 0) {
+        return (STAT_INPUT_LESS_THAN_MIN_VALUE);
+    }
+#ifdef ENCODER_QDEC
+    if ((counts_per_step > 0) && (e->qdec == nullptr)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);      // no encoder input wired to this motor
+    }
+    float steps = en_read_encoder(motor);
+    e->counts_per_step = counts_per_step;
+    e->steps_per_count = (counts_per_step > 0) ? 1/counts_per_step : 0;
+    en_set_encoder_steps(motor, steps);
+#else
+    if (counts_per_step > 0) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);      // this board has no encoder inputs
+    }
+    e->counts_per_step = 0;
+#endif
+    return (STAT_OK);
+}
+
+/*
+ * _qdec_init() - set up the timer-counter QDEC blocks assigned to motors in hardware.h
+ *
+ *	Channel 0 counts position in quadrature (4 counts per encoder line) with the input
+ *	filter on. Channel 1 would count index pulses and is clocked but not used.
+ */
+
+#ifdef ENCODER_QDEC
+
+#if !(defined(__SAM3X8E__) || defined(__SAM3X8C__))
+#error QDEC_MOTOR_n is only supported on SAM3X
+#endif
+
+static void _qdec_enable(uint8_t motor, Tc *tc)
+{
+    if (tc == TC0) {
+        PMC->PMC_PCER0 = (1 << ID_TC0) | (1 << ID_TC1);
+        PIOB->PIO_PDR = PIO_PB25 | PIO_PB27;        // TIOA0, TIOB0 - peripheral B
+        PIOB->PIO_ABSR |= PIO_PB25 | PIO_PB27;
+    } else if (tc == TC2) {
+        PMC->PMC_PCER1 = (1 << (ID_TC6 - 32)) | (1 << (ID_TC7 - 32));
+        PIOC->PIO_PDR = PIO_PC25 | PIO_PC26;        // TIOA6, TIOB6 - peripheral B
+        PIOC->PIO_ABSR |= PIO_PC25 | PIO_PC26;
+    } else {
+        cm_panic(STAT_INTERNAL_ERROR, "QDEC_MOTOR_n must be TC0 or TC2");
+        return;
+    }
+    tc->TC_CHANNEL[0].TC_CMR = TC_CMR_TCCLKS_XC0 | TC_CMR_ETRGEDG_RISING | TC_CMR_ABETRG;
+    tc->TC_CHANNEL[1].TC_CMR = TC_CMR_TCCLKS_XC0;
+    tc->TC_BMR = TC_BMR_QDEN | TC_BMR_POSEN | TC_BMR_EDGPHA | TC_BMR_MAXFILT(1);
+    tc->TC_CHANNEL[0].TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+    tc->TC_CHANNEL[1].TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+    en.en[motor].qdec = tc;
+}
+
+static void _qdec_init()
+{
+#ifdef QDEC_MOTOR_1
+    _qdec_enable(MOTOR_1, QDEC_MOTOR_1);
+#endif
+#ifdef QDEC_MOTOR_2
+    _qdec_enable(MOTOR_2, QDEC_MOTOR_2);
+#endif
+#ifdef QDEC_MOTOR_3
+    _qdec_enable(MOTOR_3, QDEC_MOTOR_3);
+#endif
+#ifdef QDEC_MOTOR_4
+    _qdec_enable(MOTOR_4, QDEC_MOTOR_4);
+#endif
+#ifdef QDEC_MOTOR_5
+    _qdec_enable(MOTOR_5, QDEC_MOTOR_5);
+#endif
+#ifdef QDEC_MOTOR_6
+    _qdec_enable(MOTOR_6, QDEC_MOTOR_6);
+#endif
+}
+
+#else
+
+static void _qdec_init() {}
+
+#endif // ENCODER_QDEC
+
+/*
+ * _probe_capture_init()      - set up TC2 channel 2 to latch its counter on probe edges (TIOA8)
+ * _probe_capture_ticks_ago() - DDA ticks since the latched probe edge, 0 if there is none
+ *
+ *	The channel free-runs at MCK/2 and loads RA on either edge, so the latency from the edge
+ *	to this read is CV - RA. A latch older than PROBE_CAPTURE_MAX_US is from an earlier edge that
+ *	was never read and is ignored.
+ */
+
+#ifdef PROBE_CAPTURE_TC8
+
+#if !(defined(__SAM3X8E__) || defined(__SAM3X8C__))
+#error PROBE_CAPTURE_TC8 is only supported on SAM3X
+#endif
+
+#ifndef PROBE_CAPTURE_MAX_US
+#define PROBE_CAPTURE_MAX_US 1000           // longest believable edge-to-ISR latency
+#endif
+
+static void _probe_capture_init()
+{
+    PMC->PMC_PCER1 = (1 << (ID_TC8 - 32));
+    PIOD->PIO_PDR = PIO_PD7;                // TIOA8 - peripheral B
+    PIOD->PIO_ABSR |= PIO_PD7;
+    TC2->TC_CHANNEL[2].TC_CMR = TC_CMR_TCCLKS_TIMER_CLOCK1 | TC_CMR_LDRA_EDGE;
+    TC2->TC_CHANNEL[2].TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+}
+
+static float _probe_capture_ticks_ago()
+{
+    TcChannel *ch = &TC2->TC_CHANNEL[2];
+    if (!(ch->TC_SR & TC_SR_LDRAS)) {       // reading SR also clears the latch flag
+        return (0);
+    }
+    const uint32_t elapsed = ch->TC_CV - ch->TC_RA;       // MCK/2 counts, wraps cleanly
+    if (elapsed > (uint32_t)PROBE_CAPTURE_MAX_US * (SystemCoreClock / 2000000)) {
+        return (0);
+    }
+    return ((float)elapsed * ((2.0 * FREQUENCY_DDA) / SystemCoreClock));
+}
+
+#else
+
+static void _probe_capture_init() {}
+static float _probe_capture_ticks_ago() { return (0); }
+
+#endif // PROBE_CAPTURE_TC8
 
 /*
  * en_take_encoder_snapshot()
@@ -98,11 +246,23 @@ float en_read_encoder(uint8_t motor) { return ((float)en.en[motor].encoder_steps
  *  presumably in the middle of a switch closure interrupt. Taking the snapshot
  *  does not affect the normal accumulation run by the stepper DDA.
  *
+ *  Step counts are refined by the DDA phase, backdated to the probe edge if the board
+ *  timestamps it (see PROBE_CAPTURE_TC8 in encoder.h).
+ *
  *  The results are in STEPS, which may need to be converted back to position using
  *  forward kinematics, depending on your use. See probe cycle for example.
  */
 void en_take_encoder_snapshot() {
-    for (uint8_t m = 0; m < MOTORS; m++) { en.snapshot[m] = en.en[m].encoder_steps + en.en[m].steps_run; }
+    const float ticks_ago = _probe_capture_ticks_ago();
+    for (uint8_t m = 0; m < MOTORS; m++) {
+        en.snapshot[m] = en.en[m].encoder_steps + en.en[m].steps_run +
+                         en.en[m].step_sign * st_get_step_phase(m, ticks_ago) - st_get_backlash_steps(m);
+    }
+#ifdef ENCODER_QDEC
+    for (uint8_t m = 0; m < MOTORS; m++) {
+        if (en.en[m].counts_per_step > 0) { en.snapshot[m] = en_read_encoder(m) - st_get_backlash_steps(m); }
+    }
+#endif
 
     /* loop unrolled version for faster execution
         en.snapshot[MOTOR_1] = en.en[MOTOR_1].encoder_steps + en.en[MOTOR_1].steps_run;
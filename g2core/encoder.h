@@ -27,10 +27,28 @@
 /*
  * ENCODERS
  *
- *	Calling this file "encoders" is kind of a lie, at least for now. There are no encoders.
- *	Instead the steppers count steps to provide a "truth" reference for position. In the
- *	future when we have real encoders we'll stop counting steps and actually measure the
- *	position. Which should be a lot easier than how this module currently works.
+ *	By default there are no encoders. Instead the steppers count steps to provide a "truth"
+ *	reference for position. That can only catch numerical error, not lost steps.
+ *
+ *	A motor can instead be read from a hardware quadrature encoder if the board wires one to
+ *	a timer-counter QDEC block and assigns it to the motor in hardware.h. On the SAM3X TC0
+ *	and TC2 have QDEC inputs (TC1 is used for the DDA, exec and forward plan timers):
+ *
+ *	  #define QDEC_MOTOR_1 TC0      // TIOA0/TIOB0 on PB25/PB27
+ *	  #define QDEC_MOTOR_2 TC2      // TIOA6/TIOB6 on PC25/PC26
+ *
+ *	The encoder is then enabled by setting the motor's encoder counts per step, e.g. {1ec:2.5}
+ *	for a 4000 count/rev encoder on a 200 step, 8 microstep motor. {1ec:0} goes back to
+ *	counting steps.
+ *
+ *	*** Snapshots ***
+ *
+ *	Step counted snapshots (probing, homing) add the motor's DDA phase - how far it has moved
+ *	towards its next step - so the captured position is not rounded down to the last step.
+ *	A board can also timestamp the probe edge in hardware so the interrupt latency is taken
+ *	out at the segment's step rate. Wire the probe to TIOA8 (PD7) as well as to its input and:
+ *	  #define PROBE_CAPTURE_TC8     // TC2 channel 2 latches the counter on each probe edge
+ *	This is what allows fast probe feeds without losing accuracy.
  *
  *	*** Measuring position ***
  *
@@ -57,6 +75,11 @@
  *	so the moveA target needs to be saved somewhere. Targets are propagated downward to the planner
  *	runtime (the EXEC), but the exec will have moved on to moveB by the time we need it. So moveA's
  *	target needs to be saved somewhere.
+ *
+ *	Each prepped segment therefore carries its target steps. When the loader starts a segment
+ *	the previous one has just finished, so it latches the error between the encoder and the
+ *	finished segment's target (LATCH_FOLLOWING_ERROR) then takes the new segment's target. The
+ *	error stays aligned however far exec runs ahead in the prep ring.
  */
 /*
  * ERROR CORRECTION
@@ -101,6 +124,15 @@
 #define ACCUMULATE_ENCODER(m)                     \
     en.en[m].encoder_steps += en.en[m].steps_run; \
     en.en[m].steps_run = 0;
+#define LATCH_FOLLOWING_ERROR(m, target)                                        \
+    en.en[m].commanded_steps = en.en[m].target_steps;                           \
+    en.en[m].following_error = en_read_encoder(m) - en.en[m].commanded_steps;   \
+    en.en[m].target_steps = target;
+
+#if defined(QDEC_MOTOR_1) || defined(QDEC_MOTOR_2) || defined(QDEC_MOTOR_3) || \
+    defined(QDEC_MOTOR_4) || defined(QDEC_MOTOR_5) || defined(QDEC_MOTOR_6)
+#define ENCODER_QDEC                        // at least one hardware quadrature encoder
+#endif
 
 /**** Structures ****/
 
@@ -108,6 +140,17 @@ typedef struct enEncoder {          // one real or virtual encoder per controlle
     int8_t  step_sign;              // set to +1 or -1
     int16_t steps_run;              // + or - steps counted during stepper interrupt
     int32_t encoder_steps;          // counted encoder position	in steps
+
+    float target_steps;             // target of the segment now running
+    float commanded_steps;          // target of the last finished segment
+    float following_error;          // encoder position - commanded_steps when that segment finished
+
+    float counts_per_step;          // hardware encoder counts per step. 0 = count steps instead
+#ifdef ENCODER_QDEC
+    Tc *qdec;                       // QDEC block for this motor, or nullptr if it has none
+    float steps_per_count;          // reciprocal of counts_per_step
+    int32_t count_offset;           // hardware count at encoder_steps == 0
+#endif
 } enEncoder_t;
 
 typedef struct enEncoders {
@@ -128,7 +171,28 @@ void encoder_init_assertions(void);
 stat_t encoder_test_assertions(void);
 
 void en_set_encoder_steps(uint8_t motor, float steps);
-float en_read_encoder(uint8_t motor);
+
+/*
+ * en_read_encoder() - position in steps
+ *
+ *	Step counted encoders are accumulated to encoder_steps during LOAD (HI interrupt level).
+ *	The position is therefore always stable. But be advised: the position lags target and
+ *	position values elsewhere in the system because the sample is taken when the steps for
+ *	that segment are complete. Hardware encoders are read directly.
+ */
+
+inline float en_read_encoder(uint8_t motor)
+{
+#ifdef ENCODER_QDEC
+    const enEncoder_t *e = &en.en[motor];
+    if (e->counts_per_step > 0) {
+        return ((float)((int32_t)e->qdec->TC_CHANNEL[0].TC_CV - e->count_offset) * e->steps_per_count);
+    }
+#endif
+    return ((float)en.en[motor].encoder_steps);
+}
+
+stat_t en_set_counts_per_step(uint8_t motor, float counts_per_step);
 
 void en_take_encoder_snapshot();
 float en_get_encoder_snapshot_steps(uint8_t motor);
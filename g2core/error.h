@@ -315,15 +315,15 @@ char *get_status_message(stat_t status);
 #define STAT_TEMPERATURE_CONTROL_ERROR 209      // temperature controls err'd out
 
 #define STAT_G29_NOT_CONFIGURED 210
-#define STAT_ERROR_211 211
-#define STAT_ERROR_212 212
-#define STAT_ERROR_213 213
-#define STAT_ERROR_214 214
-#define STAT_ERROR_215 215
-#define STAT_ERROR_216 216
-#define STAT_ERROR_217 217
-#define STAT_ERROR_218 218
-#define STAT_ERROR_219 219
+#define STAT_SPINDLE_NOT_AT_SPEED 211          // spindle tachometer did not reach the commanded speed
+#define STAT_MOTOR_STALL 212                   // driver reported a motor stall while moving
+#define STAT_SPINDLE_INDEX_NOT_CONFIGURED 213   // spindle synchronized motion needs an index input
+#define STAT_EXPRESSION_INVALID 214             // malformed Gcode expression, or too long for the block
+#define STAT_PARAMETER_NOT_SET 215              // named parameter read before it was set
+#define STAT_PARAMETER_INVALID 216              // parameter number out of range, or no room for the name
+#define STAT_OWORD_INVALID 217                  // malformed or unmatched O-word, or nested too deep
+#define STAT_OWORD_CACHE_FULL 218               // no room to store an O-word subroutine or loop
+#define STAT_OWORD_SUB_NOT_FOUND 219            // O-word call to a subroutine that was never defined
 
 #define STAT_SOFT_LIMIT_EXCEEDED 220            // soft limit error - axis unspecified
 #define STAT_SOFT_LIMIT_EXCEEDED_XMIN 221       // soft limit error - X minimum
@@ -606,15 +606,15 @@ static const char stat_208[] = "No GPIO for this value";
 static const char stat_209[] = "209";
 
 static const char stat_210[] = "Marlin G29 command was not configured at compile-time";
-static const char stat_211[] = "211";
-static const char stat_212[] = "212";
-static const char stat_213[] = "213";
-static const char stat_214[] = "214";
-static const char stat_215[] = "215";
-static const char stat_216[] = "216";
-static const char stat_217[] = "217";
-static const char stat_218[] = "218";
-static const char stat_219[] = "219";
+static const char stat_211[] = "Spindle did not reach speed";
+static const char stat_212[] = "Motor stall detected";
+static const char stat_213[] = "Spindle synchronized motion requires a spindle index input";
+static const char stat_214[] = "Gcode expression is malformed or too long";
+static const char stat_215[] = "Named parameter has not been set";
+static const char stat_216[] = "Parameter number is out of range or too many named parameters";
+static const char stat_217[] = "O-word is malformed, unmatched or nested too deep";
+static const char stat_218[] = "O-word program cache is full";
+static const char stat_219[] = "O-word subroutine is not defined";
 
 static const char stat_220[] = "Soft limit";
 static const char stat_221[] = "Soft limit - X min";
@@ -0,0 +1,327 @@
+/*
+ * eta.cpp - remaining job time estimate
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "eta.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "text_parser.h"
+#include "util.h"
+#include "xio.h"
+
+etaSingleton_t eta;
+
+static const char _axis_letters[] = "XYZUVWABC";    // in axis order
+
+/*
+ * _eta_scan_init() - start a scan from the machine's current modes and position
+ */
+
+static void _eta_scan_init(etaScan_t *s)
+{
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        s->position[axis] = cm->gmx.position[axis];
+    }
+    s->feed_rate = cm->gm.feed_rate;
+    s->motion = (cm->gm.motion_mode <= MOTION_MODE_CCW_ARC) ? cm->gm.motion_mode : 0xFF;
+    s->plane = cm->gm.select_plane;
+    s->inches = (cm->gm.units_mode == INCHES);
+    s->incremental = (cm->gm.distance_mode == INCREMENTAL_DISTANCE_MODE);
+    s->inverse_time = (cm->gm.feed_rate_mode == INVERSE_TIME_MODE);
+    s->time = 0;
+}
+
+/*
+ * _eta_move_time() - minutes for a move of length (mm) over the axis distances in d[]
+ *
+ *  A move takes the longer of its feed rate time and the time of its slowest axis at the
+ *  axis limit: velocity_max for traverses, feedrate_max for feeds.
+ */
+
+static float _eta_move_time(const etaScan_t *s, const float d[], float length)
+{
+    float time = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        float vmax = (s->motion == MOTION_MODE_STRAIGHT_TRAVERSE) ? cm->a[axis].velocity_max
+                                                                   : cm->a[axis].feedrate_max;
+        if ((d[axis] != 0) && (vmax > 0)) {
+            time = std::max(time, std::abs(d[axis]) / vmax);
+        }
+    }
+    if (s->motion != MOTION_MODE_STRAIGHT_TRAVERSE) {
+        if (s->inverse_time) {
+            if (s->feed_rate > 0) {
+                time = std::max(time, 1 / s->feed_rate);
+            }
+        } else if (s->feed_rate > 0) {
+            time = std::max(time, length / s->feed_rate);
+        }
+    }
+    return (time);
+}
+
+/*
+ * _eta_scan_line() - follow one line of G-code, adding the time of any move it makes
+ *
+ *  This is not a G-code parser. It reads words, not blocks - so a line the real parser
+ *  would reject is still timed - and it skips what it can't time: JSON and $ commands,
+ *  comments, and the axis words of G10, G28, G30 and G92 (which do set the position).
+ */
+
+static void _eta_scan_line(etaScan_t *s, const char *line)
+{
+    if ((*line == '{') || (*line == '$')) {
+        return;
+    }
+    float target[AXES];
+    bool has_target[AXES] = { false };
+    float offset[3] = { 0, 0, 0 };
+    float radius = 0;
+    float dwell = -1;
+    bool axis_words = false;
+    bool no_move = false;                           // G10, G28, G30 - axis words aren't a move
+    bool set_position = false;                      // G92
+
+    const char *p = line;
+    while (*p != NUL) {
+        char c = toupper(*p);
+        if (c == '(') {                             // skip a comment
+            while ((*p != NUL) && (*p != ')')) { p++; }
+            if (*p != NUL) { p++; }
+            continue;
+        }
+        if (c == ';') {
+            break;
+        }
+        if ((c < 'A') || (c > 'Z')) {
+            p++;
+            continue;
+        }
+        char *end;
+        float value = strtof(p+1, &end);
+        if (end == p+1) {                           // a letter with no number
+            p++;
+            continue;
+        }
+        p = end;
+
+        if (c == 'G') {
+            int code = (int)(value * 10 + 0.5);
+            switch (code) {
+                case 0: case 10: case 20: case 30: { s->motion = code / 10; break; }
+                case 40: { dwell = 0; break; }
+                case 100: case 280: case 281: case 300: case 301: { no_move = true; break; }
+                case 170: case 180: case 190: { s->plane = (code - 170) / 10; break; }
+                case 200: { s->inches = true; break; }
+                case 210: { s->inches = false; break; }
+                case 900: { s->incremental = false; break; }
+                case 910: { s->incremental = true; break; }
+                case 920: { set_position = true; break; }
+                case 930: { s->inverse_time = true; break; }
+                case 940: { s->inverse_time = false; break; }
+                case 800: { s->motion = 0xFF; break; }
+                default: {}
+            }
+            continue;
+        }
+        if (c == 'F') {
+            s->feed_rate = (s->inches && !s->inverse_time) ? value * MM_PER_INCH : value;
+            continue;
+        }
+        if ((c == 'P') && (dwell >= 0)) {
+            dwell = value;
+            continue;
+        }
+        if ((c >= 'I') && (c <= 'K')) {
+            offset[c - 'I'] = s->inches ? value * MM_PER_INCH : value;
+            continue;
+        }
+        if (c == 'R') {
+            radius = s->inches ? value * MM_PER_INCH : value;
+            continue;
+        }
+        const char *letter = strchr(_axis_letters, c);
+        if (letter != nullptr) {
+            uint8_t axis = letter - _axis_letters;
+            if (axis < AXES) {
+                target[axis] = (s->inches && (axis < AXIS_A)) ? value * MM_PER_INCH : value;
+                has_target[axis] = true;
+                axis_words = true;
+            }
+        }
+    }
+
+    if (dwell > 0) {
+        s->time += dwell / 60;
+        return;
+    }
+    if (!axis_words || no_move) {
+        return;
+    }
+    if (set_position) {
+        for (uint8_t axis = 0; axis < AXES; axis++) {
+            if (has_target[axis]) { s->position[axis] = target[axis]; }
+        }
+        return;
+    }
+    if (s->motion > MOTION_MODE_CCW_ARC) {
+        return;
+    }
+
+    float d[AXES];
+    float length = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        d[axis] = 0;
+        if (has_target[axis]) {
+            d[axis] = s->incremental ? target[axis] : target[axis] - s->position[axis];
+            s->position[axis] += d[axis];
+        }
+        length += square(d[axis]);
+    }
+    length = sqrt(length);
+
+    if ((s->motion == MOTION_MODE_CW_ARC) || (s->motion == MOTION_MODE_CCW_ARC)) {
+        static const uint8_t plane_axes[3][3] = {   // first, second and linear axes per plane
+            { AXIS_X, AXIS_Y, AXIS_Z }, { AXIS_X, AXIS_Z, AXIS_Y }, { AXIS_Y, AXIS_Z, AXIS_X } };
+        const uint8_t *pa = plane_axes[s->plane];
+        float d0 = d[pa[0]];
+        float d1 = d[pa[1]];
+        float chord = sqrt(square(d0) + square(d1));
+        float r, theta;
+        if (radius != 0) {
+            r = std::abs(radius);
+            theta = 2 * asin(std::min(chord / (2 * r), (float)1.0));
+            if (radius < 0) { theta = 2 * M_PI - theta; }
+        } else {
+            float o0 = offset[pa[0]];
+            float o1 = offset[pa[1]];
+            r = sqrt(square(o0) + square(o1));
+            float start = atan2(-o1, -o0);
+            float end = atan2(d1 - o1, d0 - o0);
+            theta = (s->motion == MOTION_MODE_CW_ARC) ? start - end : end - start;
+            if (theta <= 0) { theta += 2 * M_PI; }  // a full circle has its end on its start
+        }
+        length = sqrt(square(r * theta) + square(d[pa[2]]));
+    }
+    s->time += _eta_move_time(s, d, length);
+}
+
+/*
+ * eta_file_start() - scan a file that is starting to play - text, or a flash file
+ * eta_file_line()  - follow a line of it as it is read
+ * eta_file_end()   - the file is done, or was flushed
+ */
+
+static void _eta_file_started(const etaScan_t &scan)
+{
+    eta.file_time = scan.time;
+    _eta_scan_init(&eta.read);
+    eta.start_ms = SysTickTimer_getValue();
+    eta.file = true;
+}
+
+void eta_file_start(const char *data, int32_t length)
+{
+    etaScan_t scan;
+    char line[RX_BUFFER_SIZE+1];
+
+    _eta_scan_init(&scan);
+    for (int32_t i = 0; i < length; ) {
+        uint16_t len = 0;
+        while ((i < length) && (data[i] != '\r') && (data[i] != '\n')) {
+            if (len < RX_BUFFER_SIZE) { line[len++] = data[i]; }
+            i++;
+        }
+        line[len] = NUL;
+        _eta_scan_line(&scan, line);
+        i++;
+    }
+    _eta_file_started(scan);
+}
+
+void eta_file_start(const xio_flash_file &file)
+{
+    xio_flash_file reader = file;           // a compressed file can only be read in order
+    etaScan_t scan;
+    char line[RX_BUFFER_SIZE+1];
+    uint16_t len;
+
+    reader.reset();
+    _eta_scan_init(&scan);
+    while (reader.readline(false, len, line, sizeof(line)) != nullptr) {
+        _eta_scan_line(&scan, line);
+    }
+    _eta_file_started(scan);
+}
+
+void eta_file_line(const char *line)
+{
+    if (eta.file) {
+        _eta_scan_line(&eta.read, line);
+    }
+}
+
+void eta_file_end()
+{
+    eta.file = false;
+}
+
+/*
+ * eta_get_remaining() - minutes left in the job
+ *
+ *  The queue time is the planner's. Lines not read yet are their scan time, scaled by how
+ *  the lines that have been read compare - their scan time against the time they have run
+ *  and have left in the queue.
+ */
+
+float eta_get_remaining()
+{
+    float queue = mp_get_queue_time();
+    if (!eta.file) {
+        return (queue);
+    }
+    float unread = std::max(eta.file_time - eta.read.time, (float)0);
+    float scale = 1;
+    if (eta.read.time > ETA_SCALE_AFTER) {
+        float elapsed = (SysTickTimer_getValue() - eta.start_ms) / 60000.0;
+        scale = std::min(std::max((elapsed + queue) / eta.read.time, (float)ETA_SCALE_MIN), (float)ETA_SCALE_MAX);
+    }
+    return (queue + unread * scale);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+stat_t eta_get_eta(nvObj_t *nv) { return(get_float(nv, eta_get_remaining() * 60)); }
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_eta[] = "Remaining job time:%12.0f sec\n";
+
+void eta_print_eta(nvObj_t *nv) { text_print(nv, fmt_eta);}
+
+#endif // __TEXT_MODE
@@ -0,0 +1,81 @@
+/*
+ * eta.h - remaining job time estimate
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * REMAINING JOB TIME
+ *
+ *  {eta:} is the time left in the job in seconds, for a status report or a query. It is
+ *  the planner's own time for everything queued (mp_get_queue_time()) - so the accel and
+ *  jerk the host doesn't know about are in it - plus, for a file played from flash
+ *  (xio_send_file(), a spooled job), a projection for the lines not read yet.
+ *
+ *  The projection comes from a scan of the file when it starts. The scan follows the
+ *  G-code modes that change the time of a move - G0-G3, G4, G17-G19, G20/G21, G90/G91,
+ *  G93/G94, F - and times each move at its feed rate or the axis velocity limits, with no
+ *  accelerations. The lines are scanned again as they are read, and the scan time of the
+ *  unread ones is scaled by how long the read ones are really taking - the time run so
+ *  far plus the queue, over their scan time - so the projection learns the job's
+ *  accel and jerk overhead as it goes.
+ *
+ *  Streamed jobs have no projection: {eta:} is the time in the queue.
+ */
+
+#ifndef ETA_H_ONCE
+#define ETA_H_ONCE
+
+#include "config.h"  // needed for nvObj_t definition
+
+#define ETA_SCALE_MIN 0.5           // bounds on the learned scan time correction
+#define ETA_SCALE_MAX 4.0
+#define ETA_SCALE_AFTER 0.1         // minutes of scan time read before the correction is trusted
+
+typedef struct etaScan {            // the G-code modes a scan follows
+    float position[AXES];           // mm or degrees
+    float feed_rate;                // mm/min, or 1/min in inverse time mode
+    uint8_t motion;                 // 0-3 for G0-G3, anything else is not a move
+    uint8_t plane;                  // 0=G17, 1=G18, 2=G19
+    bool inches;                    // G20
+    bool incremental;               // G91
+    bool inverse_time;              // G93
+    float time;                     // minutes of scan time so far
+} etaScan_t;
+
+typedef struct etaSingleton {
+    bool file;                      // a scanned file is playing
+    float file_time;                // scan time of the whole file, minutes
+    uint32_t start_ms;              // when it started
+    etaScan_t read;                 // scan of the lines read so far
+} etaSingleton_t;
+
+struct xio_flash_file;
+
+void eta_file_start(const char *data, int32_t length);
+void eta_file_start(const xio_flash_file &file);
+void eta_file_line(const char *line);
+void eta_file_end(void);
+float eta_get_remaining(void);
+
+stat_t eta_get_eta(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void eta_print_eta(nvObj_t *nv);
+#else
+    #define eta_print_eta tx_print_stub
+#endif
+
+#endif  // End of include guard: ETA_H_ONCE
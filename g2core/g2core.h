@@ -49,6 +49,26 @@
 
 #define __DIAGNOSTICS               // enables various debug functions
 #define __DIAGNOSTIC_PARAMETERS     // enables system diagnostic parameters (_xx) in config_app
+//#define __PROFILER                  // enables cycle-count profiling of dispatches and ISRs {prof:n}
+//#define __BENCHMARK                 // enables the motion throughput benchmark {bm:n} (always on in BOARD=sim)
+#define __SEGMENT_TRACE             // keeps a RAM trace of recent motion segments {trc:n}
+#define __LATENCY_TRACE             // keeps per-line latency from receipt to motion {lat:n}
+//#define __SESSION_CAPTURE           // records the lines read, for replay in the simulator {cap:n}
+
+/****** HOT PATH PLACEMENT ******/
+
+// HOT_PATH marks the functions that run every DDA tick or every segment. With
+// RAMFUNC_HOT_PATHS=1 on the make line (SAM3X boards only - see the board .mk files) they go
+// in .ramfunc, which startup copies to SRAM along with .data, and are built at -O2 whatever
+// OPTIMIZATION is. SAM3X flash needs 4 wait states at 84 MHz and its accelerator misses on
+// every branch out of the prefetch buffer; SRAM doesn't. The linker adds the long branch
+// veneers between flash and SRAM. Build with __PROFILER both ways and compare {prof:n}.
+
+#if defined(RAMFUNC_HOT_PATHS) && (RAMFUNC_HOT_PATHS == 1)
+#define HOT_PATH __attribute__((section(".ramfunc"), noinline, optimize("O2")))
+#else
+#define HOT_PATH
+#endif
 
 /******************************************************************************
  ***** APPLICATION DEFINITIONS ************************************************
@@ -24,12 +24,14 @@
 
 /**** Gcode-specific definitions ****/
 
-typedef enum {                          // G Modal Group 1
+typedef enum : uint8_t {                          // G Modal Group 1
     MOTION_MODE_STRAIGHT_TRAVERSE=0,    // G0 - straight traverse
     MOTION_MODE_STRAIGHT_FEED,          // G1 - straight feed
     MOTION_MODE_CW_ARC,                 // G2 - clockwise arc feed
     MOTION_MODE_CCW_ARC,                // G3 - counter-clockwise arc feed
     MOTION_MODE_CANCEL_MOTION_MODE,     // G80
+    MOTION_MODE_CUBIC_SPLINE,           // G5 - cubic spline feed
+    MOTION_MODE_QUADRATIC_SPLINE,       // G5.1 - quadratic spline feed
     MOTION_MODE_STRAIGHT_PROBE,         // G38.2
     MOTION_MODE_CANNED_CYCLE_81,        // G81 - drilling
     MOTION_MODE_CANNED_CYCLE_82,        // G82 - drilling with dwell
@@ -39,23 +41,25 @@ typedef enum {                          // G Modal Group 1
     MOTION_MODE_CANNED_CYCLE_86,        // G86 - boring, spindle stop, rapid out
     MOTION_MODE_CANNED_CYCLE_87,        // G87 - back boring
     MOTION_MODE_CANNED_CYCLE_88,        // G88 - boring, spindle stop, manual out
-    MOTION_MODE_CANNED_CYCLE_89         // G89 - boring, dwell, feed out
+    MOTION_MODE_CANNED_CYCLE_89,        // G89 - boring, dwell, feed out
+    MOTION_MODE_CANNED_CYCLE_73,        // G73 - chip breaking peck drilling
+    MOTION_MODE_SPINDLE_SYNC            // G33 - spindle synchronized motion
 } cmMotionMode;
 
-typedef enum {              // canonical plane - translates to:
+typedef enum : uint8_t {              // canonical plane - translates to:
                             //     axis_0  axis_1  axis_2
     CANON_PLANE_XY = 0,     // G17    X      Y      Z
     CANON_PLANE_XZ,         // G18    X      Z      Y
     CANON_PLANE_YZ          // G19    Y      Z      X
 } cmCanonicalPlane;
 
-typedef enum {
+typedef enum : uint8_t {
     INCHES = 0,             // G20
     MILLIMETERS,            // G21
     DEGREES                 // ABC axes (this value used for displays only)
 } cmUnitsMode;
 
-typedef enum {
+typedef enum : uint8_t {
     ABSOLUTE_COORDS = 0,    // machine coordinate system
     G54,                    // G54 coordinate system
     G55,                    // G55 coordinate system
@@ -66,24 +70,24 @@ typedef enum {
 } cmCoordSystem;
 #define COORD_SYSTEM_MAX G59 // set this manually to the last one
 
-typedef enum {
+typedef enum : uint8_t {
     ABSOLUTE_OVERRIDE_OFF = 0,          // G53 disabled
     ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS,   // G53 enabled for movement, displays use current offsets
     ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_NO_OFFSETS // G53 enabled for movement, displays use no offset
 } cmAbsoluteOverride;
 
-typedef enum {              // G Modal Group 13
+typedef enum : uint8_t {              // G Modal Group 13
     PATH_EXACT_PATH = 0,    // G61 - hits corners but does not stop if it does not need to.
     PATH_EXACT_STOP,        // G61.1 - stops at all corners
     PATH_CONTINUOUS         // G64 and typically the default mode
 } cmPathControl;
 
-typedef enum {
+typedef enum : uint8_t {
     ABSOLUTE_DISTANCE_MODE = 0, // G90 / G90.1
     INCREMENTAL_DISTANCE_MODE   // G91 / G91.1
 } cmDistanceMode;
 
-typedef enum {
+typedef enum : uint8_t {
     INVERSE_TIME_MODE = 0,   // G93
     UNITS_PER_MINUTE_MODE,   // G94
     UNITS_PER_REVOLUTION_MODE// G95 (unimplemented)
@@ -96,11 +100,21 @@ typedef enum {
     ORIGIN_OFFSET_RESUME    // G92.3 - resume application of the suspended offsets
 } cmOriginOffset;
 
+typedef enum : uint8_t {              // G Modal Group 9
+    RETRACT_TO_INITIAL = 0, // G98 - canned cycles retract to the Z they started from, or R if higher
+    RETRACT_TO_R            // G99 - canned cycles retract to the R plane
+} cmRetractMode;
+
 typedef enum {
     PROGRAM_STOP = 0,
     PROGRAM_END
 } cmProgramFlow;
 
+typedef enum {              // line checksum after '*' - see _verify_checksum()
+    LINE_CHECKSUM_XOR = 0,  // XOR of the line bytes, in decimal (RepRap / Marlin)
+    LINE_CHECKSUM_CRC32     // zlib CRC32 of the line bytes, in hex
+} gcLineChecksum;
+
 typedef enum {              // used for spindle and arc dir
     DIRECTION_CW = 0,
     DIRECTION_CCW
@@ -160,16 +174,17 @@ typedef enum {              // axis modes (ordered: see _cm_get_feed_time())
 
 typedef struct GCodeState {             // Gcode model state - used by model, planning and runtime
     int32_t linenum;                    // Gcode block line number
-    cmMotionMode motion_mode;           // Group1: G0, G1, G2, G3, G38.2, G80, G81, G82
-                                        //         G83, G84, G85, G86, G87, G88, G89
 
     float target[AXES];                 // XYZABC target where the move should go
-    float target_comp[AXES];            // summation compensation (Kahan) overflow value
     float display_offset[AXES];         // work offsets from the machine coordinate system (for reporting only)
 
     float feed_rate;                    // F - normalized to millimeters/minute or in inverse time mode
     float P_word;                       // P - parameter used for dwell time in seconds, G10 coord select...
+    float path_tolerance;               // G64 P - corner blending tolerance in mm, 0 = no blending
 
+    // Modal state is held in byte-sized enums and packed together - this struct is in every planner buffer
+    cmMotionMode motion_mode;           // Group1: G0, G1, G2, G3, G38.2, G80, G81, G82
+                                        //         G83, G84, G85, G86, G87, G88, G89
     cmFeedRateMode feed_rate_mode;      // See cmFeedRateMode for settings
     cmCanonicalPlane select_plane;      // G17,G18,G19 - values to set plane to
     cmUnitsMode units_mode;             // G20,G21 - 0=inches (G20), 1 = mm (G21)
@@ -197,6 +212,7 @@ typedef struct GCodeState {             // Gcode model state - used by model, pl
         select_plane = CANON_PLANE_XY;
         units_mode = INCHES;
         path_control = PATH_EXACT_PATH;
+        path_tolerance = 0.0;
         distance_mode = ABSOLUTE_DISTANCE_MODE;
         arc_distance_mode = ABSOLUTE_DISTANCE_MODE;
         absolute_override = ABSOLUTE_OVERRIDE_OFF;
@@ -236,7 +252,21 @@ typedef struct GCodeStateExtended {     // Gcode dynamic state extensions - used
  */
 void gcode_parser_init(void);
 stat_t gcode_parser(char* block);
+
+bool gcode_prefetch(const char* line);
+char* gcode_prefetch_next(void);
+stat_t gcode_prefetch_run(void);
+bool gcode_prefetch_has_room(void);
+void gcode_prefetch_flush(void);
 stat_t gc_get_gc(nvObj_t* nv);
 stat_t gc_run_gc(nvObj_t* nv);
+stat_t gc_get_lcm(nvObj_t* nv);
+stat_t gc_set_lcm(nvObj_t* nv);
+
+#ifdef __TEXT_MODE
+    void gc_print_lcm(nvObj_t* nv);
+#else
+    #define gc_print_lcm tx_print_stub
+#endif
 
 #endif  // End of include guard: GCODE_H_ONCE
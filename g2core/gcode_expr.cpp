@@ -0,0 +1,667 @@
+/*
+ * gcode_expr.cpp - Gcode parameters and expressions
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "gcode_expr.h"
+#include "util.h"
+#include "xio.h"                    // for char definitions
+
+static_assert (GC_PARAMS_NUMBERED <= 255, "numbered parameters are addressed with one byte");
+static_assert (GC_PARAMS_NAMED <= 255, "named parameters are addressed with one byte");
+
+/*
+ * Bytecode - a value is run on a stack of floats. References to parameters are numbers:
+ * positive for a numbered parameter, -(slot+1) for a named one.
+ */
+
+typedef enum {
+    GC_OP_END = 0,                      // the value (or reference and value) is on the stack
+    GC_OP_CONST,                        // push the float in the next 4 bytes
+    GC_OP_PARAM,                        // push the numbered parameter in the next byte
+    GC_OP_NAMED,                        // push the named parameter in the slot in the next byte
+    GC_OP_PARAM_AT,                     // replace a reference with its parameter
+
+    GC_OP_AND,                          // binary operators pop b, then a, and push a op b
+    GC_OP_OR,
+    GC_OP_XOR,
+    GC_OP_EQ,
+    GC_OP_NE,
+    GC_OP_GT,
+    GC_OP_GE,
+    GC_OP_LT,
+    GC_OP_LE,
+    GC_OP_ADD,
+    GC_OP_SUB,
+    GC_OP_MUL,
+    GC_OP_DIV,
+    GC_OP_MOD,
+    GC_OP_POW,
+    GC_OP_ATAN2,                        // atan[a]/[b]
+
+    GC_OP_NEG,                          // unary operators replace the top of the stack
+    GC_OP_ABS,
+    GC_OP_ACOS,
+    GC_OP_ASIN,
+    GC_OP_ATAN,
+    GC_OP_COS,
+    GC_OP_EXP,
+    GC_OP_FIX,
+    GC_OP_FUP,
+    GC_OP_LN,
+    GC_OP_ROUND,
+    GC_OP_SIN,
+    GC_OP_SQRT,
+    GC_OP_TAN
+} gcOp;
+
+typedef struct gcOpName {
+    char name[4];                       // upper case, NUL padded
+    uint8_t op;
+    uint8_t precedence;                 // binary operators only
+} gcOpName_t;
+
+static const gcOpName_t gc_word_ops[] = {   // binary operators that are words
+    { "AND", GC_OP_AND, 0 }, { "OR",  GC_OP_OR,  0 }, { "XOR", GC_OP_XOR, 0 },
+    { "EQ",  GC_OP_EQ,  1 }, { "NE",  GC_OP_NE,  1 }, { "GT",  GC_OP_GT,  1 },
+    { "GE",  GC_OP_GE,  1 }, { "LT",  GC_OP_LT,  1 }, { "LE",  GC_OP_LE,  1 },
+    { "MOD", GC_OP_MOD, 3 }
+};
+
+typedef struct gcFuncName {
+    char name[6];
+    uint8_t op;
+} gcFuncName_t;
+
+static const gcFuncName_t gc_funcs[] = {
+    { "ABS",  GC_OP_ABS  }, { "ACOS", GC_OP_ACOS }, { "ASIN", GC_OP_ASIN }, { "ATAN", GC_OP_ATAN },
+    { "COS",  GC_OP_COS  }, { "EXP",  GC_OP_EXP  }, { "FIX",  GC_OP_FIX  }, { "FUP",  GC_OP_FUP  },
+    { "LN",   GC_OP_LN   }, { "ROUND",GC_OP_ROUND}, { "SIN",  GC_OP_SIN  }, { "SQRT", GC_OP_SQRT },
+    { "TAN",  GC_OP_TAN  }
+};
+
+#define GC_ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
+
+// Parameters
+static float gc_param[GC_PARAMS_NUMBERED];
+static struct gcNamedParam {
+    char name[GC_PARAM_NAME_LEN];       // lower case, no spaces
+    float value;
+    bool set;
+} gc_named[GC_PARAMS_NAMED];
+static uint8_t gc_named_count;
+
+// Compiler state for one value
+typedef struct gcCompiler {
+    char *rd;                           // text being compiled
+    gcCode_t *code;
+    uint8_t depth;                      // stack depth the code leaves
+    uint8_t consts;                     // CONST ops ending the code, to fold into
+    uint8_t nesting;                    // brackets open
+    stat_t status;
+} gcCompiler_t;
+
+/*
+ * gc_param_reset() - clear all parameters
+ * _param_get()     - read a parameter by reference
+ * gc_param_set()   - set a parameter by reference - called for "#n=value" settings
+ */
+
+void gc_param_reset()
+{
+    memset(gc_param, 0, sizeof(gc_param));
+    memset(gc_named, 0, sizeof(gc_named));
+    gc_named_count = 0;
+}
+
+static stat_t _param_slot(const float ref, float **value, bool **set)
+{
+    if (ref != floorf(ref)) {
+        return (STAT_PARAMETER_INVALID);
+    }
+    if ((ref >= 1) && (ref <= GC_PARAMS_NUMBERED)) {
+        *value = &gc_param[(uint8_t)ref - 1];
+        *set = nullptr;
+        return (STAT_OK);
+    }
+    if ((ref < 0) && (-ref <= gc_named_count)) {
+        struct gcNamedParam *p = &gc_named[(uint8_t)(-ref) - 1];
+        *value = &p->value;
+        *set = &p->set;
+        return (STAT_OK);
+    }
+    return (STAT_PARAMETER_INVALID);
+}
+
+static stat_t _param_get(const float ref, float *value)
+{
+    float *v;
+    bool *set;
+    ritorno(_param_slot(ref, &v, &set));
+    if ((set != nullptr) && !*set) {
+        return (STAT_PARAMETER_NOT_SET);
+    }
+    *value = *v;
+    return (STAT_OK);
+}
+
+stat_t gc_param_set(const float ref, const float value)
+{
+    float *v;
+    bool *set;
+    ritorno(_param_slot(ref, &v, &set));
+    *v = value;
+    if (set != nullptr) {
+        *set = true;
+    }
+    return (STAT_OK);
+}
+
+/*
+ * _apply() - run an operator - shared by the evaluator and the constant folder
+ */
+
+static stat_t _apply(const uint8_t op, const float a, const float b, float *result)
+{
+    float r;
+    switch (op) {
+        case GC_OP_AND:   { r = ((a != 0) && (b != 0)) ? 1 : 0; break; }
+        case GC_OP_OR:    { r = ((a != 0) || (b != 0)) ? 1 : 0; break; }
+        case GC_OP_XOR:   { r = ((a != 0) != (b != 0)) ? 1 : 0; break; }
+        case GC_OP_EQ:    { r = fp_EQ(a, b) ? 1 : 0; break; }
+        case GC_OP_NE:    { r = fp_NE(a, b) ? 1 : 0; break; }
+        case GC_OP_GT:    { r = (a > b) ? 1 : 0; break; }
+        case GC_OP_GE:    { r = (a >= b) ? 1 : 0; break; }
+        case GC_OP_LT:    { r = (a < b) ? 1 : 0; break; }
+        case GC_OP_LE:    { r = (a <= b) ? 1 : 0; break; }
+        case GC_OP_ADD:   { r = a + b; break; }
+        case GC_OP_SUB:   { r = a - b; break; }
+        case GC_OP_MUL:   { r = a * b; break; }
+        case GC_OP_DIV:   {
+            if (b == 0) { return (STAT_DIVIDE_BY_ZERO); }
+            r = a / b;
+            break;
+        }
+        case GC_OP_MOD:   {
+            if (b == 0) { return (STAT_DIVIDE_BY_ZERO); }
+            r = fmodf(a, b);
+            if (r < 0) { r += fabsf(b); }           // NIST: the result is never negative
+            break;
+        }
+        case GC_OP_POW:   { r = powf(a, b); break; }
+        case GC_OP_ATAN2: { r = atan2f(a, b) * (180 / M_PI); break; }
+        case GC_OP_NEG:   { r = -a; break; }
+        case GC_OP_ABS:   { r = fabsf(a); break; }
+        case GC_OP_ACOS:  { r = acosf(a) * (180 / M_PI); break; }
+        case GC_OP_ASIN:  { r = asinf(a) * (180 / M_PI); break; }
+        case GC_OP_ATAN:  { r = atanf(a) * (180 / M_PI); break; }
+        case GC_OP_COS:   { r = cosf(a * (M_PI / 180)); break; }
+        case GC_OP_EXP:   { r = expf(a); break; }
+        case GC_OP_FIX:   { r = floorf(a); break; }
+        case GC_OP_FUP:   { r = ceilf(a); break; }
+        case GC_OP_LN:    { r = logf(a); break; }
+        case GC_OP_ROUND: { r = roundf(a); break; }
+        case GC_OP_SIN:   { r = sinf(a * (M_PI / 180)); break; }
+        case GC_OP_SQRT:  { r = sqrtf(a); break; }
+        case GC_OP_TAN:   { r = tanf(a * (M_PI / 180)); break; }
+        default:          { return (STAT_EXPRESSION_INVALID); }
+    }
+    if (isnan(r)) {
+        return (STAT_FLOAT_IS_NAN);                 // e.g. sqrt[-1] or ln[0]
+    }
+    if (isinf(r)) {
+        return (STAT_FLOAT_IS_INFINITE);
+    }
+    *result = r;
+    return (STAT_OK);
+}
+
+/*
+ * gc_expr_eval() - run the bytecode of a value
+ *
+ *  result[0] is the value. A parameter setting leaves the reference in result[0] and the
+ *  value in result[1]. The compiler has checked the stack depth, so it isn't checked here.
+ */
+
+stat_t gc_expr_eval(const uint8_t *code, float result[2])
+{
+    float stack[GC_EXPR_STACK];
+    uint8_t sp = 0;                                 // entries on the stack
+
+    for (;;) {
+        uint8_t op = *code++;
+        if (op == GC_OP_END) {
+            result[0] = stack[0];
+            result[1] = (sp > 1) ? stack[1] : 0;
+            return (STAT_OK);
+        }
+        if (op == GC_OP_CONST) {
+            memcpy(&stack[sp++], code, sizeof(float));
+            code += sizeof(float);
+        } else if (op == GC_OP_PARAM) {
+            stack[sp++] = gc_param[*code++ - 1];
+        } else if (op == GC_OP_NAMED) {
+            struct gcNamedParam *p = &gc_named[*code++];
+            if (!p->set) {
+                return (STAT_PARAMETER_NOT_SET);
+            }
+            stack[sp++] = p->value;
+        } else if (op == GC_OP_PARAM_AT) {
+            ritorno(_param_get(stack[sp-1], &stack[sp-1]));
+        } else if (op >= GC_OP_NEG) {
+            ritorno(_apply(op, stack[sp-1], 0, &stack[sp-1]));
+        } else {
+            sp--;
+            ritorno(_apply(op, stack[sp-1], stack[sp], &stack[sp-1]));
+        }
+    }
+}
+
+/****************************************************************************************
+ * Compiler
+ *
+ *  A recursive descent over the text that emits postfix bytecode. Binary operators are
+ *  taken by precedence climbing. An operator whose operands are both constants is run at
+ *  once and replaced by its result, so "[2*#1+[1/3]]" compiles to PARAM 1, CONST 2, MUL,
+ *  CONST 0.333, ADD. Errors are left in c->status, and everything after the first one is
+ *  skipped.
+ */
+
+static void _compile_primary(gcCompiler_t *c);
+static void _compile_unary(gcCompiler_t *c);
+
+static void _skip_spaces(gcCompiler_t *c)
+{
+    while ((*c->rd == ' ') || (*c->rd == '\t')) {
+        c->rd++;
+    }
+}
+
+static bool _room(gcCompiler_t *c, const uint8_t bytes)
+{
+    if ((c->code->len + bytes) >= GC_CODE_MAX) {    // leave room for the END
+        c->status = STAT_EXPRESSION_INVALID;
+        return (false);
+    }
+    return (true);
+}
+
+static float _last_const(gcCompiler_t *c, const uint8_t back)  // back = 1 for the last CONST
+{
+    float value;
+    memcpy(&value, &c->code->buf[c->code->len - (back * (1 + sizeof(float))) + 1], sizeof(float));
+    return (value);
+}
+
+static void _emit_const(gcCompiler_t *c, const float value)
+{
+    if ((c->depth >= GC_EXPR_STACK) || !_room(c, 1 + sizeof(float))) {
+        c->status = STAT_EXPRESSION_INVALID;
+        return;
+    }
+    c->code->buf[c->code->len++] = GC_OP_CONST;
+    memcpy(&c->code->buf[c->code->len], &value, sizeof(float));
+    c->code->len += sizeof(float);
+    c->depth++;
+    c->consts++;
+}
+
+static void _emit_push(gcCompiler_t *c, const uint8_t op, const uint8_t arg)   // PARAM or NAMED
+{
+    if ((c->depth >= GC_EXPR_STACK) || !_room(c, 2)) {
+        c->status = STAT_EXPRESSION_INVALID;
+        return;
+    }
+    c->code->buf[c->code->len++] = op;
+    c->code->buf[c->code->len++] = arg;
+    c->depth++;
+    c->consts = 0;
+}
+
+static void _emit_op(gcCompiler_t *c, const uint8_t op)
+{
+    bool unary = (op >= GC_OP_NEG) || (op == GC_OP_PARAM_AT);
+    if ((op != GC_OP_PARAM_AT) && (c->consts >= (unary ? 1 : 2))) {    // fold
+        float a = _last_const(c, unary ? 1 : 2);
+        float b = unary ? 0 : _last_const(c, 1);
+        float r;
+        if ((c->status = _apply(op, a, b, &r)) != STAT_OK) {
+            return;
+        }
+        uint8_t operands = unary ? 1 : 2;
+        c->code->len -= operands * (1 + sizeof(float));
+        c->depth -= operands;
+        c->consts -= operands;
+        _emit_const(c, r);
+        return;
+    }
+    if (!_room(c, 1)) {
+        return;
+    }
+    c->code->buf[c->code->len++] = op;
+    if (!unary) {
+        c->depth--;
+    }
+    c->consts = 0;
+}
+
+/*
+ * _match_word() - match an upper case word at rd, case insensitive. Returns its length or 0
+ */
+
+static uint8_t _match_word(const char *rd, const char *word)
+{
+    uint8_t i = 0;
+    for ( ; word[i] != NUL; i++) {
+        if ((rd[i] & ~0x20) != word[i]) {
+            return (0);
+        }
+    }
+    return (i);
+}
+
+static const gcFuncName_t *_match_func(const char *rd, uint8_t *len)
+{
+    uint8_t letters = 0;
+    while (isalpha(rd[letters])) {
+        letters++;
+    }
+    for (uint8_t i = 0; i < GC_ARRAY_SIZE(gc_funcs); i++) {
+        if ((_match_word(rd, gc_funcs[i].name) == letters) && (letters > 0)) {
+            *len = letters;
+            return (&gc_funcs[i]);
+        }
+    }
+    return (nullptr);
+}
+
+bool gc_expr_is_function(const char *text)
+{
+    uint8_t len;
+    if (_match_func(text, &len) == nullptr) {
+        return (false);
+    }
+    text += len;
+    while ((*text == ' ') || (*text == '\t')) {
+        text++;
+    }
+    return (*text == '[');
+}
+
+/*
+ * _binary_op() - the binary operator at rd, if any. Returns its length, or 0
+ */
+
+static uint8_t _binary_op(const char *rd, uint8_t *op, uint8_t *precedence)
+{
+    switch (*rd) {
+        case '*': {
+            if (rd[1] == '*') { *op = GC_OP_POW; *precedence = 4; return (2); }
+            *op = GC_OP_MUL; *precedence = 3; return (1);
+        }
+        case '/': { *op = GC_OP_DIV; *precedence = 3; return (1); }
+        case '+': { *op = GC_OP_ADD; *precedence = 2; return (1); }
+        case '-': { *op = GC_OP_SUB; *precedence = 2; return (1); }
+    }
+    for (uint8_t i = 0; i < GC_ARRAY_SIZE(gc_word_ops); i++) {
+        uint8_t len = _match_word(rd, gc_word_ops[i].name);
+        if ((len > 0) && !isalpha(rd[len])) {
+            *op = gc_word_ops[i].op;
+            *precedence = gc_word_ops[i].precedence;
+            return (len);
+        }
+    }
+    return (0);
+}
+
+static void _compile_expr(gcCompiler_t *c, const uint8_t min_precedence)
+{
+    _compile_unary(c);
+    while (c->status == STAT_OK) {
+        _skip_spaces(c);
+        uint8_t op, precedence;
+        uint8_t len = _binary_op(c->rd, &op, &precedence);
+        if ((len == 0) || (precedence < min_precedence)) {
+            return;
+        }
+        c->rd += len;
+        _compile_expr(c, precedence + 1);           // left associative
+        if (c->status == STAT_OK) {
+            _emit_op(c, op);
+        }
+    }
+}
+
+static void _compile_bracket(gcCompiler_t *c)      // rd is on the '['
+{
+    if (++c->nesting > GC_EXPR_STACK) {
+        c->status = STAT_EXPRESSION_INVALID;
+        return;
+    }
+    c->rd++;
+    _compile_expr(c, 0);
+    _skip_spaces(c);
+    if ((c->status == STAT_OK) && (*c->rd != ']')) {
+        c->status = STAT_EXPRESSION_INVALID;
+    }
+    c->rd++;
+    c->nesting--;
+}
+
+/*
+ * _compile_name() - find or add the named parameter at rd (on the '<'). Returns the slot
+ */
+
+static uint8_t _compile_name(gcCompiler_t *c)
+{
+    char name[GC_PARAM_NAME_LEN];
+    uint8_t len = 0;
+    for (c->rd++; *c->rd != '>'; c->rd++) {
+        if ((*c->rd == NUL) || (len == GC_PARAM_NAME_LEN-1)) {
+            c->status = STAT_EXPRESSION_INVALID;
+            return (0);
+        }
+        if ((*c->rd != ' ') && (*c->rd != '\t')) {
+            name[len++] = tolower(*c->rd);
+        }
+    }
+    c->rd++;
+    name[len] = NUL;
+    if (len == 0) {
+        c->status = STAT_EXPRESSION_INVALID;
+        return (0);
+    }
+    for (uint8_t i = 0; i < gc_named_count; i++) {
+        if (strcmp(gc_named[i].name, name) == 0) {
+            return (i);
+        }
+    }
+    if (gc_named_count == GC_PARAMS_NAMED) {
+        c->status = STAT_PARAMETER_INVALID;
+        return (0);
+    }
+    strcpy(gc_named[gc_named_count].name, name);
+    gc_named[gc_named_count].set = false;
+    return (gc_named_count++);
+}
+
+/*
+ * _compile_reference() - a parameter after its '#', left on the stack as a reference
+ *
+ *  A constant reference is checked here. Returns true if it is one.
+ */
+
+static bool _compile_reference(gcCompiler_t *c)
+{
+    _skip_spaces(c);
+    if (*c->rd == '<') {
+        uint8_t slot = _compile_name(c);
+        if (c->status == STAT_OK) {
+            _emit_const(c, -(float)(slot + 1));
+        }
+        return (true);
+    }
+    _compile_primary(c);
+    if ((c->status != STAT_OK) || (c->consts == 0)) {
+        return (false);
+    }
+    float ref = _last_const(c, 1);
+    if ((ref != floorf(ref)) || (ref < 1) || (ref > GC_PARAMS_NUMBERED)) {
+        c->status = STAT_PARAMETER_INVALID;
+    }
+    return (true);
+}
+
+static void _compile_param(gcCompiler_t *c)        // rd is after the '#'
+{
+    if (!_compile_reference(c) || (c->status != STAT_OK)) {
+        _emit_op(c, GC_OP_PARAM_AT);                // worked out when it is read
+        return;
+    }
+    float ref = _last_const(c, 1);                  // the usual case - a fixed parameter
+    c->code->len -= 1 + sizeof(float);
+    c->depth--;
+    c->consts--;
+    if (ref > 0) {
+        _emit_push(c, GC_OP_PARAM, (uint8_t)ref);
+    } else {
+        _emit_push(c, GC_OP_NAMED, (uint8_t)(-ref) - 1);
+    }
+}
+
+static void _compile_primary(gcCompiler_t *c)
+{
+    _skip_spaces(c);
+    char ch = *c->rd;
+    if (ch == '[') {
+        _compile_bracket(c);
+    } else if (ch == '#') {
+        c->rd++;
+        _compile_param(c);
+    } else if (isdigit(ch) || (ch == '.')) {
+        _emit_const(c, c_atof(c->rd));
+    } else {
+        uint8_t len;
+        const gcFuncName_t *f = _match_func(c->rd, &len);
+        if (f == nullptr) {
+            c->status = STAT_EXPRESSION_INVALID;
+            return;
+        }
+        c->rd += len;
+        _skip_spaces(c);
+        if (*c->rd != '[') {
+            c->status = STAT_EXPRESSION_INVALID;
+            return;
+        }
+        _compile_bracket(c);
+        if ((c->status == STAT_OK) && (f->op == GC_OP_ATAN)) {    // atan[y]/[x] is the NIST form
+            char *rd = c->rd;
+            _skip_spaces(c);
+            if (*c->rd == '/') {
+                c->rd++;
+                _skip_spaces(c);
+                if (*c->rd == '[') {
+                    _compile_bracket(c);
+                    if (c->status == STAT_OK) {
+                        _emit_op(c, GC_OP_ATAN2);
+                    }
+                    return;
+                }
+            }
+            c->rd = rd;                             // a one argument atan
+        }
+        if (c->status == STAT_OK) {
+            _emit_op(c, f->op);
+        }
+    }
+}
+
+static void _compile_unary(gcCompiler_t *c)
+{
+    _skip_spaces(c);
+    if (*c->rd == '-') {
+        c->rd++;
+        _compile_unary(c);
+        if (c->status == STAT_OK) {
+            _emit_op(c, GC_OP_NEG);
+        }
+    } else if (*c->rd == '+') {
+        c->rd++;
+        _compile_unary(c);
+    } else {
+        _compile_primary(c);
+    }
+}
+
+/*
+ * gc_expr_compile()         - compile the value at *text, which is a '#', '[' or function
+ * gc_expr_compile_setting() - compile a parameter setting at *text, which is on the '#'
+ *
+ *  The code is added to the block's code. *start is set to its offset + 1, or to 0 if the
+ *  value folded to a constant, which is returned in *value instead. *text is left on the
+ *  first character after the value.
+ */
+
+static stat_t _compile_end(gcCompiler_t *c, char **text, const uint16_t start)
+{
+    *text = c->rd;
+    if ((c->status == STAT_OK) && _room(c, 0)) {
+        c->code->buf[c->code->len++] = GC_OP_END;
+    }
+    if (c->status != STAT_OK) {
+        c->code->len = start;
+    }
+    return (c->status);
+}
+
+stat_t gc_expr_compile(char **text, const bool negate, gcCode_t *code, uint16_t *start, float *value)
+{
+    gcCompiler_t c = { *text, code, 0, 0, 0, STAT_OK };
+    uint16_t begin = code->len;
+    _compile_primary(&c);
+    if (negate && (c.status == STAT_OK)) {
+        _emit_op(&c, GC_OP_NEG);
+    }
+    if ((c.status == STAT_OK) && (c.consts == 1) && (code->len == begin + 1 + sizeof(float))) {
+        *value = _last_const(&c, 1);               // nothing to run later
+        code->len = begin;
+        *start = 0;
+        *text = c.rd;
+        return (STAT_OK);
+    }
+    *start = begin + 1;
+    return (_compile_end(&c, text, begin));
+}
+
+stat_t gc_expr_compile_setting(char **text, gcCode_t *code, uint16_t *start)
+{
+    gcCompiler_t c = { *text + 1, code, 0, 0, 0, STAT_OK };
+    uint16_t begin = code->len;
+    _compile_reference(&c);
+    _skip_spaces(&c);
+    if ((c.status == STAT_OK) && (*c.rd != '=')) {
+        c.status = STAT_EXPRESSION_INVALID;
+    }
+    c.rd++;
+    if (c.status == STAT_OK) {
+        _compile_unary(&c);
+    }
+    *start = begin + 1;
+    return (_compile_end(&c, text, begin));
+}
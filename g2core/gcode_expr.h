@@ -0,0 +1,67 @@
+/*
+ * gcode_expr.h - Gcode parameters and expressions
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * PARAMETERS AND EXPRESSIONS
+ *
+ *  Wherever a word takes a number it may instead take (per NIST RS274/NGC section 3.5):
+ *
+ *    - a numbered parameter        #7          #1 to #GC_PARAMS_NUMBERED, 0 until set
+ *    - a named parameter           #<depth>    case and spaces are ignored in the name
+ *    - a parameter by number       ##1  #[#1+2]
+ *    - an expression in brackets   [#1 * 2 + 0.5]
+ *    - a function                  sin[30]  atan[#2]/[#3]
+ *
+ *  Binary operators, lowest to highest precedence: AND OR XOR; EQ NE GT GE LT LE (1 or 0);
+ *  + -; * / MOD; ** (power). Functions are ABS ACOS ASIN ATAN COS EXP FIX FUP LN ROUND SIN
+ *  SQRT TAN, with angles in degrees. A value may be preceded by - or +.
+ *
+ *  "#1=12.5" or "#<depth>=[#<depth> - 0.5]" sets a parameter. All values on a line are read
+ *  before any of its parameters are set, so "#1=2 #2=#1" sets #2 to the old #1. A line may
+ *  hold nothing but parameter settings. Reading a named parameter that was never set is an
+ *  error. Parameters are kept until reset and are not persisted.
+ *
+ *  Each value is compiled once, as the line is tokenized, into a short stack bytecode in
+ *  the block's gcCode_t. Constant parts are folded as they are compiled, so a value that
+ *  reads no parameters becomes a plain number and costs nothing later. The rest is run by
+ *  gc_expr_eval() as the block is parsed, after the blocks ahead of it have set their
+ *  parameters. Prefetched lines carry their bytecode with their words.
+ */
+
+#ifndef GCODE_EXPR_H_ONCE
+#define GCODE_EXPR_H_ONCE
+
+#define GC_PARAMS_NUMBERED 100          // #1 - #100
+#define GC_PARAMS_NAMED 32              // most named parameters
+#define GC_PARAM_NAME_LEN 16            // longest name, including the NUL
+#define GC_EXPR_STACK 16                // deepest evaluation stack
+#define GC_CODE_MAX 192                 // bytecode for the values of one block
+
+typedef struct gcCode {                 // compiled values of one block
+    uint16_t len;
+    uint8_t buf[GC_CODE_MAX];
+} gcCode_t;
+
+stat_t gc_expr_compile(char **text, const bool negate, gcCode_t *code, uint16_t *start, float *value);
+stat_t gc_expr_compile_setting(char **text, gcCode_t *code, uint16_t *start);
+bool gc_expr_is_function(const char *text);
+stat_t gc_expr_eval(const uint8_t *code, float result[2]);
+stat_t gc_param_set(const float ref, const float value);
+void gc_param_reset(void);
+
+#endif  // End of include guard: GCODE_EXPR_H_ONCE
@@ -0,0 +1,456 @@
+/*
+ * gcode_oword.cpp - O-word subroutines and loops run from a RAM program cache
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "gcode_oword.h"
+#include "gcode_expr.h"
+#include "gcode.h"
+#include "report.h"
+#include "util.h"
+#include "xio.h"                    // for char definitions
+
+/*
+ * The cache holds NUL terminated lines. The subroutines are kept at the bottom; a loop sent
+ * by the host is stored above them while it is defined and run. Offsets are cache indexes.
+ */
+
+typedef enum {
+    OW_NONE = 0,                    // an O-word with no keyword we know
+    OW_SUB,
+    OW_ENDSUB,
+    OW_RETURN,
+    OW_CALL,
+    OW_WHILE,
+    OW_ENDWHILE,
+    OW_REPEAT,
+    OW_ENDREPEAT
+} owKeyword;
+
+static const char ow_keyword[][10] = { "", "sub", "endsub", "return", "call", "while", "endwhile", "repeat", "endrepeat" };
+
+typedef struct owLine {
+    uint16_t number;                // O number
+    uint8_t keyword;                // owKeyword
+    const char *args;               // text after the keyword
+} owLine_t;
+
+typedef struct owSub {
+    uint16_t number;
+    uint16_t start;                 // offset of its "sub" line
+    uint16_t length;                // bytes through its "endsub" line
+} owSub_t;
+
+typedef struct owFrame {            // a call or loop being run
+    uint16_t number;
+    uint8_t keyword;                // OW_CALL, OW_WHILE or OW_REPEAT
+    uint16_t back;                  // CALL: line to return to; WHILE: its while line; REPEAT: its first line
+    int32_t count;                  // REPEAT: passes left, including this one
+} owFrame_t;
+
+typedef struct owSingleton {
+    char cache[OWORD_CACHE_SIZE];
+    uint16_t top;                   // bytes of the cache in use
+    owSub_t sub[OWORD_SUBS];
+    uint8_t subs;
+
+    uint8_t record;                 // keyword of the sub or loop being stored, OW_NONE if none
+    uint16_t record_number;
+    uint16_t record_start;          // offset it is being stored at
+    bool record_failed;             // the cache filled - lines are dropped until its end line
+
+    bool running;                   // lines are being taken from the cache
+    uint16_t pc;                    // next line to run
+    uint16_t run_end;               // the run is done when it gets here with nothing on the stack
+    uint16_t run_top;               // top to go back to once the run is done
+    owFrame_t stack[OWORD_STACK];
+    uint8_t depth;
+
+    char line[RX_BUFFER_SIZE+1];    // line being run - the parser normalizes it in place
+} owSingleton_t;
+
+static owSingleton_t ow;
+
+/*
+ * _parse() - split an O-word line into number, keyword and arguments. False if not one
+ */
+
+static bool _parse(const char *line, owLine_t *o)
+{
+    while ((*line == SPC) || (*line == TAB)) {
+        line++;
+    }
+    if (((*line & ~0x20) != 'O') || !isdigit(line[1])) {
+        return (false);
+    }
+    uint32_t number = 0;
+    for (line++; isdigit(*line); line++) {
+        number = min(number * 10 + (*line - '0'), (uint32_t)UINT16_MAX);
+    }
+    while ((*line == SPC) || (*line == TAB)) {
+        line++;
+    }
+    o->number = number;
+    o->keyword = OW_NONE;
+    for (uint8_t k = OW_SUB; k <= OW_ENDREPEAT; k++) {
+        uint8_t i = 0;
+        while ((ow_keyword[k][i] != NUL) && (tolower(line[i]) == ow_keyword[k][i])) {
+            i++;
+        }
+        if ((ow_keyword[k][i] == NUL) && !isalpha(line[i])) {
+            o->keyword = k;
+            line += i;
+            break;
+        }
+    }
+    o->args = line;
+    return (true);
+}
+
+static const char *_skip_spaces(const char *p)
+{
+    while ((*p == SPC) || (*p == TAB)) {
+        p++;
+    }
+    return (p);
+}
+
+static bool _at_end(const char *p)              // nothing but a comment is left
+{
+    p = _skip_spaces(p);
+    return ((*p == NUL) || (*p == '(') || (*p == ';'));
+}
+
+/*
+ * _eval() - read and run the bracketed expression at *p
+ */
+
+static stat_t _eval(const char **p, float *value)
+{
+    char *rd = (char *)_skip_spaces(*p);
+    if (*rd != '[') {
+        return (STAT_OWORD_INVALID);
+    }
+    gcCode_t code;
+    uint16_t start;
+    code.len = 0;
+    ritorno(gc_expr_compile(&rd, false, &code, &start, value));
+    if (start != 0) {
+        float result[2];
+        ritorno(gc_expr_eval(&code.buf[start-1], result));
+        *value = result[0];
+    }
+    *p = rd;
+    return (STAT_OK);
+}
+
+static int8_t _find_sub(const uint16_t number)
+{
+    for (uint8_t i = 0; i < ow.subs; i++) {
+        if (ow.sub[i].number == number) {
+            return (i);
+        }
+    }
+    return (-1);
+}
+
+/*
+ * _define() - keep the subroutine just stored, replacing one with the same number
+ */
+
+static stat_t _define()
+{
+    uint16_t length = ow.top - ow.record_start;
+    int8_t old = _find_sub(ow.record_number);
+    if (old >= 0) {
+        owSub_t s = ow.sub[old];
+        memmove(&ow.cache[s.start], &ow.cache[s.start + s.length], ow.top - (s.start + s.length));
+        ow.top -= s.length;
+        ow.sub[old] = ow.sub[--ow.subs];
+        for (uint8_t i = 0; i < ow.subs; i++) {
+            if (ow.sub[i].start > s.start) {
+                ow.sub[i].start -= s.length;
+            }
+        }
+    }
+    if (ow.subs == OWORD_SUBS) {
+        ow.top -= length;
+        return (STAT_OWORD_CACHE_FULL);
+    }
+    ow.sub[ow.subs++] = { ow.record_number, (uint16_t)(ow.top - length), length };
+    return (STAT_OK);
+}
+
+/*
+ * _record() - store a line of the subroutine or loop being defined
+ */
+
+static stat_t _record(const char *line, const owLine_t *o)
+{
+    bool end = (o != nullptr) && (o->number == ow.record_number) &&
+               (o->keyword == ow.record + 1);   // the end keywords follow the openers
+    line = _skip_spaces(line);
+    uint16_t length = strlen(line) + 1;
+    stat_t status = STAT_OK;
+    if (!ow.record_failed && ((ow.top + length) > OWORD_CACHE_SIZE)) {
+        ow.record_failed = true;
+        ow.top = ow.record_start;
+        status = STAT_OWORD_CACHE_FULL;         // reported once, and again at the end line
+    }
+    if (!ow.record_failed) {
+        memcpy(&ow.cache[ow.top], line, length);
+        ow.top += length;
+    }
+    if (!end) {
+        return (status);
+    }
+    uint8_t record = ow.record;
+    ow.record = OW_NONE;
+    if (ow.record_failed) {
+        return (STAT_OWORD_CACHE_FULL);
+    }
+    if (record == OW_SUB) {
+        return (_define());
+    }
+    ow.run_top = ow.record_start;               // a loop - run it now
+    ow.run_end = ow.top;
+    ow.pc = ow.record_start;
+    ow.depth = 0;
+    ow.running = true;
+    return (STAT_OK);
+}
+
+static void _stop()
+{
+    ow.running = false;
+    ow.depth = 0;
+    ow.top = ow.run_top;                        // give back the room of a loop sent by the host
+}
+
+static stat_t _push(const owLine_t *o, const uint8_t keyword, const uint16_t back, const int32_t count)
+{
+    if (ow.depth == OWORD_STACK) {
+        return (STAT_OWORD_INVALID);
+    }
+    ow.stack[ow.depth++] = { o->number, keyword, back, count };
+    return (STAT_OK);
+}
+
+/*
+ * _skip() - move past the end line of a loop that runs no passes
+ */
+
+static stat_t _skip(const owLine_t *o, const uint8_t end_keyword)
+{
+    owLine_t e;
+    for (uint16_t pc = ow.pc; pc < ow.top; ) {
+        const char *line = &ow.cache[pc];
+        pc += strlen(line) + 1;
+        if (_parse(line, &e) && (e.number == o->number) && (e.keyword == end_keyword)) {
+            ow.pc = pc;
+            return (STAT_OK);
+        }
+    }
+    return (STAT_OWORD_INVALID);
+}
+
+static stat_t _call(const owLine_t *o)
+{
+    int8_t s = _find_sub(o->number);
+    if (s < 0) {
+        return (STAT_OWORD_SUB_NOT_FOUND);
+    }
+    float arg[OWORD_ARGS];
+    uint8_t args = 0;
+    const char *p = _skip_spaces(o->args);
+    for ( ; *p == '['; p = _skip_spaces(p)) {
+        if (args == OWORD_ARGS) {
+            return (STAT_OWORD_INVALID);
+        }
+        ritorno(_eval(&p, &arg[args++]));
+    }
+    if (!_at_end(p)) {
+        return (STAT_OWORD_INVALID);
+    }
+    for (uint8_t i = 0; i < args; i++) {        // all are read before any is set
+        ritorno(gc_param_set(i + 1, arg[i]));
+    }
+    ritorno(_push(o, OW_CALL, ow.pc, 0));
+    const char *sub = &ow.cache[ow.sub[s].start];
+    ow.pc = ow.sub[s].start + strlen(sub) + 1;  // the line after "sub"
+    return (STAT_OK);
+}
+
+/*
+ * _run_oword() - run an O-word line taken from the cache. line_at is its offset
+ */
+
+static stat_t _run_oword(const owLine_t *o, const uint16_t line_at)
+{
+    owFrame_t *f = (ow.depth > 0) ? &ow.stack[ow.depth-1] : nullptr;
+    float value;
+    const char *p = o->args;
+
+    switch (o->keyword) {
+        case OW_CALL: {
+            return (_call(o));
+        }
+        case OW_ENDSUB:
+        case OW_RETURN: {
+            while (ow.depth > 0) {              // unwind any loops the return is in
+                f = &ow.stack[--ow.depth];
+                if (f->keyword == OW_CALL) {
+                    if (f->number != o->number) {
+                        return (STAT_OWORD_INVALID);
+                    }
+                    ow.pc = f->back;
+                    return (STAT_OK);
+                }
+            }
+            return (STAT_OWORD_INVALID);
+        }
+        case OW_WHILE: {
+            ritorno(_eval(&p, &value));
+            if (!_at_end(p)) {
+                return (STAT_OWORD_INVALID);
+            }
+            if (fp_ZERO(value)) {
+                return (_skip(o, OW_ENDWHILE));
+            }
+            return (_push(o, OW_WHILE, line_at, 0));
+        }
+        case OW_REPEAT: {
+            ritorno(_eval(&p, &value));
+            if (!_at_end(p)) {
+                return (STAT_OWORD_INVALID);
+            }
+            int32_t count = (int32_t)roundf(value);
+            if (count <= 0) {
+                return (_skip(o, OW_ENDREPEAT));
+            }
+            return (_push(o, OW_REPEAT, ow.pc, count));
+        }
+        case OW_ENDWHILE:
+        case OW_ENDREPEAT: {
+            if ((f == nullptr) || (f->number != o->number) || (f->keyword + 1 != o->keyword)) {
+                return (STAT_OWORD_INVALID);
+            }
+            if ((f->keyword == OW_REPEAT) && (--f->count > 0)) {
+                ow.pc = f->back;                // the next pass
+                return (STAT_OK);
+            }
+            ow.depth--;
+            if (f->keyword == OW_WHILE) {
+                ow.pc = f->back;                // test it again
+            }
+            return (STAT_OK);
+        }
+        default: {                              // a sub can't be defined from the cache
+            return (STAT_OWORD_INVALID);
+        }
+    }
+}
+
+/***********************************************************************************
+ **** CODE *************************************************************************
+ ***********************************************************************************/
+
+/*
+ * oword_takes_line() - true if oword_host_line() handles this gcode line from the host
+ * oword_host_line()  - an O-word line from the host, or a line of a sub or loop being stored
+ */
+
+bool oword_takes_line(const char *line)
+{
+    owLine_t o;
+    return ((ow.record != OW_NONE) || _parse(line, &o));
+}
+
+stat_t oword_host_line(const char *line)
+{
+    owLine_t o;
+    bool is_oword = _parse(line, &o);
+    if (ow.record != OW_NONE) {
+        return (_record(line, is_oword ? &o : nullptr));
+    }
+    switch (o.keyword) {
+        case OW_SUB:
+        case OW_WHILE:
+        case OW_REPEAT: {
+            ow.record = o.keyword;
+            ow.record_number = o.number;
+            ow.record_start = ow.top;
+            ow.record_failed = false;
+            return (_record(line, &o));
+        }
+        case OW_CALL: {
+            ow.run_top = ow.top;
+            ow.run_end = ow.top;
+            ow.pc = ow.top;                     // where the call returns to
+            ow.depth = 0;
+            ritorno(_call(&o));
+            ow.running = true;
+            return (STAT_OK);
+        }
+        default: {
+            return (STAT_OWORD_INVALID);
+        }
+    }
+}
+
+/*
+ * oword_is_running() - true if lines are to be taken from the cache
+ * oword_run_line()    - run the next line from the cache. Call only if oword_is_running()
+ * oword_flush()       - stop the program being run or stored (queue flush)
+ */
+
+bool oword_is_running()
+{
+    return (ow.running);
+}
+
+void oword_run_line()
+{
+    uint16_t line_at = ow.pc;
+    uint16_t length = strlen(&ow.cache[line_at]) + 1;
+    memcpy(ow.line, &ow.cache[line_at], length);
+    ow.pc += length;
+
+    owLine_t o;
+    stat_t status = _parse(ow.line, &o) ? _run_oword(&o, line_at) : gcode_parser(ow.line);
+    if ((status != STAT_OK) && (status != STAT_NOOP) && (status != STAT_COMPLETE)) {
+        rpt_exception(status, "O-word program stopped");
+        _stop();
+        return;
+    }
+    if ((ow.depth == 0) && (ow.pc >= ow.run_end)) {
+        _stop();
+    }
+}
+
+void oword_flush()
+{
+    if (ow.record != OW_NONE) {
+        ow.top = ow.record_start;               // drop the part that was stored
+        ow.record = OW_NONE;
+    }
+    if (ow.running) {
+        _stop();
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * gcode_oword.h - O-word subroutines and loops run from a RAM program cache
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * O-WORD SUBROUTINES AND LOOPS
+ *
+ *  A line starting with an O-word controls the flow of the program, as in LinuxCNC:
+ *
+ *    O100 sub              ...  O100 endsub        define subroutine 100
+ *    O100 call [1] [#2]                            run it, setting #1, #2... to the arguments
+ *    O100 return                                   leave the subroutine early
+ *    O101 while [#1 LT 5]  ...  O101 endwhile      loop while the expression is not 0
+ *    O102 repeat [4]       ...  O102 endrepeat     loop a number of times
+ *
+ *  The lines of a subroutine are stored in the program cache as they are received, and are
+ *  not run. The subroutine stays defined until it is defined again, so a host that sends a
+ *  job twice does not run out of room. A loop sent by the host is stored up to its end line
+ *  and then run from the cache, and its room is given back when it is done. Loops and calls
+ *  may nest inside subroutines and loops, OWORD_STACK deep.
+ *
+ *  Lines run from the cache are taken by the controller ahead of any more input, whenever the
+ *  planner has room, and are parsed as if they had been received. They get no response: the
+ *  host sees one response for each line it sent. A line that fails stops the program and is
+ *  reported as an exception. A queue flush stops a program or a definition in progress.
+ *
+ *  Expressions are those of gcode_expr.h. The arguments of a call are global parameters here,
+ *  not local to the call as in LinuxCNC. Only gcode lines are stored; JSON and $ commands
+ *  received during a definition are run right away.
+ */
+
+#ifndef GCODE_OWORD_H_ONCE
+#define GCODE_OWORD_H_ONCE
+
+#ifndef OWORD_CACHE_SIZE
+#define OWORD_CACHE_SIZE 2048           // bytes of stored lines, including a NUL per line
+#endif
+#define OWORD_SUBS 16                   // most subroutines defined at once
+#define OWORD_STACK 8                   // deepest nesting of calls and loops being run
+#define OWORD_ARGS 8                    // most arguments to a call
+
+bool oword_takes_line(const char *line);
+stat_t oword_host_line(const char *line);
+bool oword_is_running(void);
+void oword_run_line(void);
+void oword_flush(void);
+
+#endif  // End of include guard: GCODE_OWORD_H_ONCE
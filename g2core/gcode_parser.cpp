@@ -22,11 +22,16 @@
 #include "controller.h"
 #include "gcode.h"
 #include "canonical_machine.h"
+#include "planner.h"
 #include "settings.h"
 #include "spindle.h"
 #include "coolant.h"
+#include "gcode_expr.h"
 #include "util.h"
 #include "xio.h"                    // for char definitions
+#include "text_parser.h"
+#include "latency.h"
+#include "checkpoint.h"
 
 #if MARLIN_COMPAT_ENABLED == true
 #include "marlin_compatibility.h"
@@ -41,7 +46,7 @@ static stat_t _execute_gcode_block_marlin(void);
 
 typedef enum {                          // Used for detecting gcode errors. See NIST section 3.4
     MODAL_GROUP_G0 = 0,                 // {G10,G28,G28.1,G92}  non-modal axis commands (note 1)
-    MODAL_GROUP_G1,                     // {G0,G1,G2,G3,G80}    motion
+    MODAL_GROUP_G1,                     // {G0,G1,G2,G3,G5,G80}  motion
     MODAL_GROUP_G2,                     // {G17,G18,G19}        plane selection
     MODAL_GROUP_G3,                     // {G90,G91}            distance mode
     MODAL_GROUP_G5,                     // {G93,G94}            feed rate mode
@@ -51,13 +56,15 @@ typedef enum {                          // Used for detecting gcode errors. See
     MODAL_GROUP_G9,                     // {G98,G99}            return mode in canned cycles
     MODAL_GROUP_G12,                    // {G54,G55,G56,G57,G58,G59} coordinate system selection
     MODAL_GROUP_G13,                    // {G61,G61.1,G64}      path control mode
+    MODAL_GROUP_G14,                    // {G96,G97}            spindle speed mode
     MODAL_GROUP_M4,                     // {M0,M1,M2,M30,M60}   stopping
     MODAL_GROUP_M6,                     // {M6}                 tool change
     MODAL_GROUP_M7,                     // {M3,M4,M5}           spindle turning
     MODAL_GROUP_M8,                     // {M7,M8,M9}           coolant (M7 & M8 may be active together)
-    MODAL_GROUP_M9                      // {M48,M49}            speed/feed override switches
+    MODAL_GROUP_M9,                     // {M48,M49}            speed/feed override switches
+    MODAL_GROUP_M5                      // {M62,M63,M64,M65}    digital outputs
 } cmModalGroup;
-#define MODAL_GROUP_COUNT (MODAL_GROUP_M9+1)
+#define MODAL_GROUP_COUNT (MODAL_GROUP_M5+1)
 // Note 1: Our G0 omits G4,G30,G53,G92.1,G92.2,G92.3 as these have no axis components to error check
 
 /* The difference between NextAction and MotionMode (in canonical machine) is that 
@@ -80,6 +87,7 @@ typedef enum {                                  // these are in order to optimiz
     NEXT_ACTION_STRAIGHT_PROBE,                 // G38.3
     NEXT_ACTION_STRAIGHT_PROBE_AWAY_ERR,        // G38.4
     NEXT_ACTION_STRAIGHT_PROBE_AWAY,            // G38.5
+    NEXT_ACTION_MEASURE_TOOL,                   // G37
     NEXT_ACTION_SET_TL_OFFSET,                  // G43
     NEXT_ACTION_SET_ADDITIONAL_TL_OFFSET,       // G43.2
     NEXT_ACTION_CANCEL_TL_OFFSET,               // G49
@@ -115,18 +123,19 @@ typedef enum {                                  // these are in order to optimiz
 typedef struct GCodeInputValue {    // Gcode inputs - meaning depends on context
 
     gpNextAction next_action;       // handles G modal group 1 moves & non-modals
-    cmMotionMode motion_mode;       // Group1: G0, G1, G2, G3, G38.2, G80, G81, G82, G83, G84, G85, G86, G87, G88, G89
+    cmMotionMode motion_mode;       // Group1: G0, G1, G2, G3, G5, G5.1, G38.2, G73, G80, G81, G82, G83, G84, G85, G86, G87, G88, G89
     uint8_t program_flow;           // used only by the gcode_parser
     uint32_t linenum;               // gcode N word
 
     float target[AXES];             // XYZABC where the move should go
     float arc_offset[3];            // IJK - used by arc commands
-    float arc_radius;               // R word - radius value in arc radius mode
+    float arc_radius;               // R word - radius value in arc radius mode, R plane in drilling cycles
     float F_word;                   // F word - feedrate as present in the F word (will be normalized later)
-    float P_word;                   // P word - parameter used for dwell time in seconds, G10 commands
+    float P_word;                   // P word - parameter used for dwell time in seconds, G10 commands, G5 control point X offset
+    float Q_word;                   // Q word - G5 second control point Y offset, peck depth in G73 and G83
     float S_word;                   // S word - usually in RPM
     uint8_t H_word;                 // H word - used by G43s
-    uint8_t L_word;                 // L word - used by G10s
+    uint8_t L_word;                 // L word - used by G10s, repeats in drilling cycles
 
     uint8_t feed_rate_mode;         // See cmFeedRateMode for settings
     uint8_t select_plane;           // G17,G18,G19 - values to set plane to
@@ -135,6 +144,8 @@ typedef struct GCodeInputValue {    // Gcode inputs - meaning depends on context
     uint8_t path_control;           // G61... EXACT_PATH, EXACT_STOP, CONTINUOUS
     uint8_t distance_mode;          // G91   0=use absolute coords(G90), 1=incremental movement
     uint8_t arc_distance_mode;      // G90.1=use absolute IJK offsets, G91.1=incremental IJK offsets
+    uint8_t retract_mode;           // G98, G99 - drilling cycle retract
+    uint8_t spindle_speed_mode;     // G96, G97 - constant surface speed or RPM
     uint8_t origin_offset_mode;     // G92...TRUE=in origin offset mode
     uint8_t absolute_override;      // G53 TRUE = move using machine coordinates - this block only (G53)
     
@@ -145,6 +156,7 @@ typedef struct GCodeInputValue {    // Gcode inputs - meaning depends on context
     uint8_t coolant_flood;          // TRUE = flood on (M8)
     uint8_t coolant_off;            // TRUE = turn off all coolants (M9)
     uint8_t spindle_control;        // 0=OFF (M5), 1=CW (M3), 2=CCW (M4)
+    uint8_t output_control;         // cmOutputControl - M62, M63, M64, M65
 
     bool m48_enable;                // M48/M49 input (enables for feed and spindle)
     bool fro_control;               // M50 feedrate override control
@@ -171,6 +183,7 @@ typedef struct GCodeFlags {         // Gcode input flags
 
     bool F_word;
     bool P_word;
+    bool Q_word;
     bool S_word;
     bool H_word;
     bool L_word;
@@ -182,6 +195,8 @@ typedef struct GCodeFlags {         // Gcode input flags
     bool path_control;
     bool distance_mode;
     bool arc_distance_mode;
+    bool retract_mode;
+    bool spindle_speed_mode;
     bool origin_offset_mode;
     bool absolute_override;
 
@@ -192,6 +207,7 @@ typedef struct GCodeFlags {         // Gcode input flags
     bool coolant_flood;
     bool coolant_off;
     bool spindle_control;
+    bool output_control;
 
     bool m48_enable;
     bool fro_control;
@@ -208,8 +224,46 @@ typedef struct GCodeFlags {         // Gcode input flags
 
 } GCodeFlag_t;
 
+#define GC_WORDS_MAX 40                 // words in a block, including the terminating word
+
+#ifndef GC_PREFETCH_BLOCKS
+#define GC_PREFETCH_BLOCKS 4            // lines tokenized ahead while the planner is full - see gcode_prefetch()
+#endif
+#define GC_PREFETCH_WORDS 12            // most words in a prefetched line
+#define GC_PREFETCH_LINE_LEN 64         // longest prefetched line, including the NUL
+#define GC_PREFETCH_CODE 64             // most expression bytecode in a prefetched line
+
+typedef struct gcWord {
+    char letter;                        // upper case word letter, '#' for a parameter setting, NUL for the terminating word
+    stat_t status;                      // STAT_OK, or the error to report when the parser gets here
+    float value;                        // word value
+    int32_t value_int;                  // integer part of the value, exact for large line numbers
+    char *rest;                         // normalized block following this word
+    uint16_t code;                      // offset + 1 of the value's bytecode in gc_code, 0 if the value is a number
+} gcWord_t;
+
+typedef enum {                          // character classes for the tokenizer
+    GC_CHAR_SKIP = 0,                   // whitespace, control and invalid characters
+    GC_CHAR_LETTER,
+    GC_CHAR_DIGIT,
+    GC_CHAR_POINT,
+    GC_CHAR_MINUS,
+    GC_CHAR_COMMENT,                    // '(' starts an embedded comment
+    GC_CHAR_EXPR,                       // '#' or '[' starts a parameter or expression
+    GC_CHAR_END                         // NUL, ';' or '%' ends the block
+} gcCharClass;
+
+static uint8_t _char_class[128];        // filled in by gcode_parser_init()
+static gcWord_t gc_word[GC_WORDS_MAX];
+static gcCode_t gc_code;                // compiled expressions of the words in gc_word[]
+static char _active_comment[RX_BUFFER_SIZE];
+
+static const float _pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+#define GC_FRACTION_DIGITS_MAX 9        // further fraction digits are below float precision
+
 typedef struct GCodeParser {
     bool modals[MODAL_GROUP_COUNT];
+    uint8_t line_checksum;              // {lcm:} line checksum after '*' - gcLineChecksum
 } GCodeParser_t;
 
 GCodeParser_t gp;   // main parser struct
@@ -217,13 +271,15 @@ GCodeValue_t gv;    // gcode input values
 GCodeFlag_t gf;     // gcode input flags
 
 // local helper functions and macros
-static void _normalize_gcode_block(char *str, char **active_comment, uint8_t *block_delete_flag);
-static stat_t _get_next_gcode_word(char **pstr, char *letter, float *value, int32_t *value_int);
+static void _init_char_class(void);
+static void _tokenize_gcode_block(char *str, char **active_comment, uint8_t *block_delete_flag);
 static stat_t _point(float value);
 static stat_t _verify_checksum(char *str);
 static stat_t _validate_gcode_block(char *active_comment);
-static stat_t _parse_gcode_block(char *line, char *active_comment); // Parse the block into the GN/GF structs
+static stat_t _parse_gcode_block(char *active_comment);             // Parse the words into the GN/GF structs
 static stat_t _execute_gcode_block(char *active_comment);           // Execute the gcode block
+static stat_t _run_tokenized_block(char *str, char *active_comment, uint8_t block_delete_flag);
+static stat_t _evaluate_words(void);
 
 #define SET_MODAL(m,parm,val) ({gv.parm=val; gf.parm=true; gp.modals[m]=true; break;})
 #define SET_NON_MODAL(parm,val) ({gv.parm=val; gf.parm=true; break;})
@@ -237,12 +293,14 @@ void gcode_parser_init()
 {
     memset(&gv, 0, sizeof(GCodeValue_t));
     memset(&gf, 0, sizeof(GCodeFlag_t));
+    _init_char_class();
+    gc_param_reset();
 }
 
 /*
  * gcode_parser() - parse a block (line) of gcode
  *
- *  Top level of gcode parser. Normalizes block and looks for special cases
+ *  Top level of gcode parser. Tokenizes block and looks for special cases
  */
 
 stat_t gcode_parser(char *block)
@@ -257,11 +315,19 @@ stat_t gcode_parser(char *block)
         return check_ret;
     }
 
-    _normalize_gcode_block(str, &active_comment, &block_delete_flag);
+    _tokenize_gcode_block(str, &active_comment, &block_delete_flag);
+    return (_run_tokenized_block(str, active_comment, block_delete_flag));
+}
 
+/*
+ * _run_tokenized_block() - parse and execute a block once its words are in gc_word[]
+ */
+
+static stat_t _run_tokenized_block(char *str, char *active_comment, uint8_t block_delete_flag)
+{
     // TODO, now MSG is put in the active comment, handle that.
 
-    if (str[0] == NUL) {                    // normalization returned null string
+    if ((str[0] == NUL) && (gc_word[0].status == STAT_OK)) {  // tokenizing returned null string
         return (STAT_OK);                   // most likely a comment line
     }
 
@@ -275,12 +341,184 @@ stat_t gcode_parser(char *block)
     if (block_delete_flag == true) {
         return (STAT_NOOP);
     }
-    return(_parse_gcode_block(block, active_comment));
+    if (gc_code.len > 0) {
+        ritorno(_evaluate_words());
+        if ((gc_word[0].letter == NUL) && (gc_word[0].status == STAT_OK)) {
+            return (STAT_OK);               // the line only set parameters
+        }
+    }
+    return(_parse_gcode_block(active_comment));
+}
+
+/*
+ * _evaluate_words() - run the compiled values of the words and apply the parameter settings
+ *
+ *  Every value is read before any parameter is set, and the settings are applied in order
+ *  only if all of them were read. A value that fails is left in its word's status so it is
+ *  reported when the parser gets there. The setting words are then taken out of gc_word[].
+ *  Returns an error only for a setting that could not be applied.
+ */
+
+static stat_t _evaluate_words()
+{
+    gcWord_t *w;
+    bool failed = false;
+
+    for (w = gc_word; w->letter != NUL; w++) {
+        if ((w->code == 0) || (w->status != STAT_OK)) {
+            continue;
+        }
+        float result[2];
+        w->status = gc_expr_eval(&gc_code.buf[w->code - 1], result);
+        if (w->letter == '#') {                 // the parameter, then its value
+            if ((w->status == STAT_OK) && (result[0] != floorf(result[0]))) {
+                w->status = STAT_PARAMETER_INVALID;
+            }
+            w->value_int = (int32_t)result[0];
+            w->value = result[1];
+        } else {
+            w->value = result[0];
+            w->value_int = (int32_t)result[0];
+        }
+        failed |= (w->status != STAT_OK);
+    }
+    failed |= (w->status != STAT_OK);           // the line did not tokenize to the end
+
+    for (w = gc_word; (w->letter != NUL) && !failed; w++) {
+        if (w->letter == '#') {
+            ritorno(gc_param_set((float)w->value_int, w->value));
+        }
+    }
+
+    gcWord_t *keep = gc_word;
+    for (w = gc_word; w->letter != NUL; w++) {
+        if ((w->letter != '#') || (w->status != STAT_OK)) {
+            *(keep++) = *w;
+        }
+    }
+    *keep = *w;                                 // the terminating word
+    return (STAT_OK);
+}
+
+/*
+ * gcode_prefetch()          - tokenize a plain gcode line ahead of time while the planner is full
+ * gcode_prefetch_next()     - take the oldest prefetched line and return its text, or NULL if none
+ * gcode_prefetch_run()      - parse and execute the line taken by gcode_prefetch_next()
+ * gcode_prefetch_has_room() - true if another line can be prefetched
+ * gcode_prefetch_flush()    - discard the prefetched lines (queue flush)
+ *
+ *  When the planner is full the controller keeps reading lines and hands the plain gcode ones
+ *  to gcode_prefetch(). The checksum and tokenizing do not depend on the gcode model, so they
+ *  are done right away and the words are held here. Parsing the words into gv/gf needs the
+ *  model state left by the block before, so that is done by gcode_prefetch_run() once the
+ *  planner has room, in order.
+ *
+ *  A line is not prefetched (returns false) if it does not fit the fixed size entry, has more
+ *  than GC_PREFETCH_WORDS words or carries an active comment. The caller must then keep the
+ *  line and run it after the prefetched ones.
+ */
+
+typedef struct gcPrefetch {
+    stat_t checksum_status;                 // result of _verify_checksum()
+    uint8_t block_delete_flag;
+    char line[GC_PREFETCH_LINE_LEN];        // line as received - for the response
+    char block[GC_PREFETCH_LINE_LEN];       // normalized block
+    gcWord_t word[GC_PREFETCH_WORDS+1];     // words, including the terminating word
+    uint8_t code_len;
+    uint8_t code[GC_PREFETCH_CODE];         // compiled expressions of the words
+} gcPrefetch_t;
+
+static gcPrefetch_t gc_prefetch[GC_PREFETCH_BLOCKS];
+static uint8_t gc_prefetch_r;               // oldest prefetched line
+static uint8_t gc_prefetch_count;           // lines prefetched
+static gcPrefetch_t *gc_prefetch_taken;     // line taken by gcode_prefetch_next(), not yet run
+
+bool gcode_prefetch_has_room() { return (gc_prefetch_count < GC_PREFETCH_BLOCKS); }
+
+void gcode_prefetch_flush()
+{
+    gc_prefetch_count = 0;
+    gc_prefetch_taken = nullptr;
+}
+
+bool gcode_prefetch(const char *line)
+{
+    if (!gcode_prefetch_has_room() || (strlen(line) >= GC_PREFETCH_LINE_LEN)) {
+        return (false);
+    }
+    gc_prefetch_taken = nullptr;            // its entry may be reused from here on
+    gcPrefetch_t *pf = &gc_prefetch[(gc_prefetch_r + gc_prefetch_count) % GC_PREFETCH_BLOCKS];
+    strcpy(pf->line, line);
+    strcpy(pf->block, line);
+
+    char *active_comment;
+    pf->checksum_status = _verify_checksum(pf->block);
+    if (pf->checksum_status == STAT_OK) {
+        _tokenize_gcode_block(pf->block, &active_comment, &pf->block_delete_flag);
+        if (*active_comment != NUL) {
+            return (false);
+        }
+        uint8_t words = 0;
+        while (gc_word[words].letter != NUL) {
+            if (++words > GC_PREFETCH_WORDS) {
+                return (false);
+            }
+        }
+        if (gc_code.len > GC_PREFETCH_CODE) {
+            return (false);
+        }
+        memcpy(pf->word, gc_word, (words+1) * sizeof(gcWord_t));
+        memcpy(pf->code, gc_code.buf, gc_code.len);
+        pf->code_len = gc_code.len;
+    } else {
+        pf->code_len = 0;
+    }
+    gc_prefetch_count++;
+    return (true);
+}
+
+char *gcode_prefetch_next()
+{
+    if (gc_prefetch_count == 0) {
+        return (NULL);
+    }
+    gc_prefetch_taken = &gc_prefetch[gc_prefetch_r];
+    gc_prefetch_r = (gc_prefetch_r + 1) % GC_PREFETCH_BLOCKS;
+    gc_prefetch_count--;
+    return (gc_prefetch_taken->line);
+}
+
+stat_t gcode_prefetch_run()
+{
+    gcPrefetch_t *pf = gc_prefetch_taken;
+    if (pf == nullptr) {
+        return (STAT_NOOP);
+    }
+    gc_prefetch_taken = nullptr;
+    if (pf->checksum_status != STAT_OK) {
+        return (pf->checksum_status);
+    }
+    uint8_t words = 0;
+    while (pf->word[words].letter != NUL) {
+        words++;
+    }
+    memcpy(gc_word, pf->word, (words+1) * sizeof(gcWord_t));
+    memcpy(gc_code.buf, pf->code, pf->code_len);
+    gc_code.len = pf->code_len;
+    _active_comment[0] = NUL;
+    return (_run_tokenized_block(pf->block, _active_comment, pf->block_delete_flag));
 }
 
 /*
  * _verify_checksum() - ensure that, if there is a checksum, that it's valid
  *
+ *  The checksum follows a '*' at the end of the line and covers everything before it. In
+ *  LINE_CHECKSUM_XOR mode (RepRap / Marlin) it's the XOR of the bytes, in decimal. In
+ *  LINE_CHECKSUM_CRC32 mode it's the standard (zlib) CRC32 of the bytes, in hex - XOR misses
+ *  any pair of flips in the same bit, which a noisy cable makes easily. Either way the line is
+ *  read once, in the same scan that finds the '*'. A '*' in an expression's brackets is a
+ *  multiply, not the checksum.
+ *
  * Returns STAT_OK is it's valid.
  * Returns STAT_CHECKSUM_MATCH_FAILED if the checksum doesn't match.
  */
@@ -291,11 +529,23 @@ static stat_t _verify_checksum(char *str)
         has_line_number = true;
     }
 
-    char checksum = 0;
+    uint32_t checksum = 0;
+    uint8_t brackets = 0;                   // expression brackets open
     char c = *str++;
-    while (c && (c != '*') && (c != '\n') && (c != '\r')) {
-        checksum ^= c;
-        c = *str++;
+    if (gp.line_checksum == LINE_CHECKSUM_CRC32) {
+        checksum = ~checksum;
+        while (c && ((c != '*') || brackets) && (c != '\n') && (c != '\r')) {
+            brackets += (c == '[') - ((c == ']') && brackets);
+            checksum = crc32_update(checksum, c);
+            c = *str++;
+        }
+        checksum = ~checksum;
+    } else {
+        while (c && ((c != '*') || brackets) && (c != '\n') && (c != '\r')) {
+            brackets += (c == '[') - ((c == ']') && brackets);
+            checksum ^= (uint8_t)c;
+            c = *str++;
+        }
     }
 
     // c might be 0 here, in which case we didn't get a checksum and we return STAT_OK
@@ -303,7 +553,7 @@ static stat_t _verify_checksum(char *str)
     if (c == '*') {
         *(str-1) = 0; // null terminate, the parser won't like this * here!
         gf.checksum = true;
-        if (strtol(str, NULL, 10) != checksum) {
+        if (strtoul(str, NULL, (gp.line_checksum == LINE_CHECKSUM_CRC32) ? 16 : 10) != checksum) {
             debug_trap("checksum failure");
             return STAT_CHECKSUM_MATCH_FAILED;
         }
@@ -316,294 +566,298 @@ static stat_t _verify_checksum(char *str)
 }
 
 /****************************************************************************************
- * _normalize_gcode_block() - normalize a block (line) of gcode in place
+ * _tokenize_gcode_block() - split a block (line) of gcode into words in a single pass
  *
- *  Baseline normalization functions:
- *   - Isolate comments. See below.
- *   The rest of this applies just to the GCODE string itself (not the comments):
- *   - Remove white space, control and other invalid characters
- *   - Convert all letters to upper case
- *   - Remove (erroneous) leading zeros that might be taken to mean Octal
+ *  Each character is looked up once in a character class table and handled in the same pass:
+ *   - Whitespace, control and other invalid characters are skipped, anywhere in the line
+ *   - Letters start a new word and are converted to upper case
+ *   - Numbers are accumulated as they are read, into both the float value and the exact
+ *     integer value needed for line numbers > 8,388,608. Leading zeros are not octal
+ *   - A '#', '[' or function where a number is expected starts an expression, which is
+ *     compiled into gc_code (see gcode_expr.h). A '#' where a letter is expected starts a
+ *     parameter setting, which is kept as a word with a '#' letter
+ *   - Comments are isolated. See below.
  *   - Signal if a block-delete character (/) was encountered in the first space
  *   - NOTE: Assumes no leading whitespace as this was removed at the controller dispatch level
  *
- *  So this: "g1 x100 Y100 f400" becomes this: "G1X100Y100F400"
+ *  The words are left in gc_word[], terminated by a word with a NUL letter. Errors are not
+ *  returned right away: they are stored in the word where they were found and reported when
+ *  the parser reaches that word. This keeps the old behavior for M-codes that stop parsing
+ *  the line, like Marlin's M117 message text, where the rest of the line is not gcode.
+ *
+ *  The block is also normalized in place as it is read, for cm_parse_clear() and the Marlin
+ *  M23 filename, so this: "g1 x100 Y100 f400" becomes this: "G1X100Y100F400"
  *
  *  Comment, active comment and message handling:
  *   - Comment fields start with a '(' char or alternately a semicolon ';' or percent '%'
  *   - Semicolon ';' or percent '%' end the line. All characters past are discarded
  *   - Multiple embedded comments are acceptable if '(' form
  *   - Active comments start with exactly "({" and end with "})" (no relaxing, invalid is invalid)
- *   - Active comments are moved to the end of the string
- *   - Multiple active comments are merged and moved to the end of the string
+ *   - Active comments are copied to a separate string as they are found
+ *   - Multiple active comments are merged
  *   - Gcode message comments (MSG) are converted to ({msg:"blah"}) active comments
  *     - The 'MSG' specifier in comment can have mixed case but cannot cannot have embedded white spaces
  *     - Only ONE MSG comment will be accepted
  *   - Other "plain" comments are discarded
  *
  *  Returns:
- *   - com points to comment string or to NUL if no comment
- *   - msg points to message string or to NUL if no comment
+ *   - active_comment points to active comment string or to NUL if no comment
  *   - block_delete_flag is set true if block delete encountered, false otherwise
  */
 /* Active comment notes:
  *
  *   We will convert as follows:
  *   FROM: G0 ({blah: t}) x10 (comment)
- *   TO  : g0x10\0{blah:t}
- *   NOTES: Active comments moved to the end, stripped of (), everything lowercased, and plain comment removed.
+ *   TO  : G0X10 and {blah:t}
+ *   NOTES: Active comments stripped of (), and plain comment removed.
  *
  *   FROM: M100 ({a:t}) (comment) ({b:f}) (comment)
- *   TO  : m100\0{a:t,b:f}
+ *   TO  : M100 and {a:t,b:f}
  *   NOTES: multiple active comments merged, stripped of (), and actual comments ignored.
  */
 
-char _normalize_scratch[RX_BUFFER_SIZE];
 
-void _normalize_gcode_block(char *str, char **active_comment, uint8_t *block_delete_flag)
+static void _init_char_class()
 {
-    _normalize_scratch[0] = 0;
+    for (uint8_t c = 0; c < sizeof(_char_class); c++) {
+        if (isalpha(c))     { _char_class[c] = GC_CHAR_LETTER; }
+        else if (isdigit(c)){ _char_class[c] = GC_CHAR_DIGIT; }
+        else                { _char_class[c] = GC_CHAR_SKIP; }
+    }
+    _char_class['.'] = GC_CHAR_POINT;
+    _char_class['-'] = GC_CHAR_MINUS;
+    _char_class['('] = GC_CHAR_COMMENT;
+    _char_class['#'] = GC_CHAR_EXPR;
+    _char_class['['] = GC_CHAR_EXPR;
+    _char_class[NUL] = GC_CHAR_END;
+    _char_class[';'] = GC_CHAR_END;
+    _char_class['%'] = GC_CHAR_END;
+}
 
-    char *gc_rd = str;                  // read pointer
-    char *gc_wr = _normalize_scratch;   // write pointer
-    char *ac_rd = str;                  // Active Comment read pointer
-    char *ac_wr = _normalize_scratch;   // Active Comment write pointer
-    bool last_char_was_digit = false;   // used for octal stripping
+static inline bool _is_msg(const char *s)
+{
+    return (((s[0] == 'm') || (s[0] == 'M')) && ((s[1] == 's') || (s[1] == 'S')) && ((s[2] == 'g') || (s[2] == 'G')));
+}
+
+/*
+ * _copy_active_comment() - copy an active comment or MSG comment, merging with any before it
+ *
+ *  rd points to the character after the '('. Returns a pointer to the closing ')' or the NUL.
+ */
+
+static char *_copy_active_comment(char *rd, char **wr_p)
+{
+    char *wr = *wr_p;
+    char *end = _active_comment + sizeof(_active_comment) - 3;  // room for '"', '}' and NUL
+    bool in_msg = false;
+
+    if (_is_msg(rd)) {
+        rd += 3;
+        if (*rd == ' ') {
+            rd++;                               // skip the first space.
+        }
+        if ((wr > _active_comment) && (*(wr-1) == '}')) {
+            *(wr-1) = ',';
+        } else {
+            *(wr++) = '{';
+        }
+        *(wr++) = 'm';
+        *(wr++) = 's';
+        *(wr++) = 'g';
+        *(wr++) = ':';
+        *(wr++) = '"';
+        in_msg = true;
+    } else if ((wr > _active_comment) && (*(wr-1) == '}')) {   // merge json comments
+        *(wr-1) = ',';
+        rd++;                                   // don't copy the '{'
+    }
+
+    // copy the comment, handling strings carefully
+    bool in_string = false;
+    bool escaped = false;
+    while (*rd != NUL) {
+        if (in_string && (*rd == '\\')) {
+            escaped = true;
+        } else if (!escaped && (*rd == '"')) {
+            if (in_msg) {                       // In msg comments, we have to escape "
+                if (wr < end) { *(wr++) = '\\'; }
+            } else {
+                in_string = !in_string;
+            }
+        } else if (!in_string && (*rd == ')')) {
+            if (in_msg) {
+                *(wr++) = '"';
+                *(wr++) = '}';
+            }
+            break;
+        } else {
+            escaped = false;
+        }
+        // Skip spaces if we're not in a string or msg (implicit string)
+        if ((in_string || in_msg || (*rd != ' ')) && (wr < end)) {
+            *(wr++) = *rd;
+        }
+        rd++;
+    }
+    *wr_p = wr;
+    return (rd);
+}
 
-    // Move the ac_wr point forward one for every non-AC character we KEEP (plus one for a NULL in between)
-    ac_wr++;                            // account for the in-between NULL
+static void _tokenize_gcode_block(char *str, char **active_comment, uint8_t *block_delete_flag)
+{
+    char *rd = str;                         // read pointer
+    char *wr = str;                         // normalized block write pointer - never passes rd
+    char *ac_wr = _active_comment;          // active comment write pointer
+    int8_t words = 0;                       // words started so far
+    gcWord_t *w = gc_word;                  // word being accumulated, once words > 0
+
+    // number accumulators for the current word
+    bool has_digits = false;                // true once a digit or expression follows the letter
+    bool expr = false;                      // the value is an expression, compiled into gc_code
+    bool negative = false;
+    bool fraction = false;
+    bool last_char_was_digit = false;       // used for octal stripping of the normalized block
+    uint8_t fraction_digits = 0;
+    int32_t integer = 0;
+    uint32_t fraction_part = 0;
+    stat_t status = STAT_OK;                // error that ends tokenizing
 
     // mark block deletes
-    if (*gc_rd == '/') {
+    if (*rd == '/') {
         *block_delete_flag = true;
-        gc_rd++;
+        rd++;
     } else {
         *block_delete_flag = false;
     }
-
-    while (*gc_rd != 0) {
-        if ((*gc_rd == ';') || (*gc_rd == '%')) {   // check for ';' or '%' comments that end the line
-            *gc_rd = 0;                             // go ahead and snap the string off cleanly here
-            break;
+    gc_code.len = 0;
+
+    for (;; rd++) {
+        char c = *rd;
+        uint8_t cc = ((uint8_t)c < sizeof(_char_class)) ? _char_class[(uint8_t)c] : GC_CHAR_SKIP;
+        char *end = rd;                     // end of an expression
+
+        // a parameter, expression or function in place of the number
+        if ((words > 0) && !has_digits && !fraction &&
+            ((cc == GC_CHAR_EXPR) || ((cc == GC_CHAR_LETTER) && gc_expr_is_function(rd)))) {
+            if ((status = gc_expr_compile(&end, negative, &gc_code, &w->code, &w->value)) != STAT_OK) {
+                break;
+            }
+            w->value_int = (int32_t)w->value;   // if it folded to a number
+            has_digits = true;
+            expr = true;
+        }
+        if (end > rd) {                     // copy the expression to the normalized block
+            for ( ; rd < end; rd++) {
+                if ((*rd != ' ') && (*rd != '\t')) { *(wr++) = *rd; }
+            }
+            rd--;
+            continue;
         }
 
-        // check for comment '('
-        else if (*gc_rd == '(') {
-            // We only care if it's a "({" in order to handle string-skipping properly
-            gc_rd++;
-            if ((*gc_rd == '{') || (((* gc_rd    == 'm') || (* gc_rd    == 'M')) &&
-                                    ((*(gc_rd+1) == 's') || (*(gc_rd+1) == 'S')) &&
-                                    ((*(gc_rd+2) == 'g') || (*(gc_rd+2) == 'G'))
-                )) {
-                if (ac_rd == nullptr) {
-                    ac_rd = gc_rd;      // note the start of the first AC
+        if ((cc == GC_CHAR_LETTER) || (cc == GC_CHAR_END) || (c == '#')) {
+            if (words > 0) {                // finish the previous word
+                if (!expr) {
+                    w->value_int = negative ? -integer : integer;
+                    w->value = (float)integer + ((float)fraction_part / _pow10[fraction_digits]);
+                    if (negative) { w->value = -w->value; }
                 }
-
-                // skip the comment, handling strings carefully
-                bool in_string = false;
-                while (*(++gc_rd) != 0) {
-                    if (*gc_rd=='"') {
-                        in_string = true;
-                    } else if (in_string) {
-                        if ((*gc_rd == '\\') && (*(gc_rd+1) != 0)) {
-                            gc_rd++; // Skip it, it's escaped.
-                        }
-                    } else if ((*gc_rd == ')')) {
-                        break;
-                    }
+                w->rest = wr;
+                if (!has_digits) {
+                    w->status = STAT_BAD_NUMBER_FORMAT; // Marlin flavor is decided in the parser
                 }
-                if (*gc_rd == 0) {      // We don't want the rd++ later to skip the NULL if we're at one
+            }
+            if (cc == GC_CHAR_END) {
+                break;
+            }
+            if (words == GC_WORDS_MAX-1) {  // no room for this word and the terminating word
+                status = STAT_INVALID_OR_MALFORMED_COMMAND;
+                break;
+            }
+            if (words++ > 0) {
+                w++;
+            }
+            w->letter = (c == '#') ? c : (c & ~0x20);   // upper case
+            w->status = STAT_OK;
+            w->code = 0;
+            *(wr++) = w->letter;
+            has_digits = false;
+            expr = false;
+            negative = false;
+            fraction = false;
+            last_char_was_digit = false;
+            fraction_digits = 0;
+            integer = 0;
+            fraction_part = 0;
+            if (c == '#') {                 // a parameter setting, e.g. #1=[#1+2]
+                if ((status = gc_expr_compile_setting(&end, &gc_code, &w->code)) != STAT_OK) {
                     break;
                 }
-            } else {
-                *(gc_rd-1) = ' ';       // Change the '(' to a space to simplify the comment copy later
-                while ((*gc_rd != 0) && (*gc_rd != ')')) {  // skip ahead until we find a ')' (or NULL)
-                    gc_rd++;
+                for (rd++; rd < end; rd++) {
+                    if ((*rd != ' ') && (*rd != '\t')) { *(wr++) = *rd; }
                 }
+                rd--;
+                has_digits = true;
+                expr = true;
             }
-        } else if (!isspace(*gc_rd)) {
-            bool do_copy = false;
-
-            // Perform Octal stripping - remove invalid leading zeros in number strings
-            // Otherwise number conversions can fail, as Gcode does not support octal but C libs do
-            // Change 0123.004 to 123.004, or -0234.003 to -234.003
-            if (isdigit(*gc_rd) || (*gc_rd == '.')) { // treat '.' as a digit so we don't strip after one
-                if (last_char_was_digit || (*gc_rd != '0') || !isdigit(*(gc_rd+1))) {
-                    do_copy = true;
+            continue;
+        }
+        if (cc == GC_CHAR_SKIP) {
+            continue;
+        }
+        if (cc == GC_CHAR_COMMENT) {
+            rd++;
+            if ((*rd == '{') || _is_msg(rd)) {
+                rd = _copy_active_comment(rd, &ac_wr);
+            } else {
+                while ((*rd != NUL) && (*rd != ')')) {  // skip ahead until we find a ')' (or NUL)
+                    rd++;
                 }
-                last_char_was_digit = true;
-            }
-            else if ((isalnum((char)*gc_rd)) || (strchr("-.", *gc_rd))) { // all valid characters
-                last_char_was_digit = false;
-                do_copy = true;
             }
-            if (do_copy) {
-                *(gc_wr++) = toupper(*gc_rd);
-                ac_wr++; // move the ac start position
+            if (*rd == NUL) {
+                rd--;                       // let the next pass end the block
             }
+            continue;
         }
-        gc_rd++;
-    }
 
-    // Enforce null termination
-    *gc_wr = 0;
-    char *comment_start = ac_wr;    // note the beginning of the comments
-    if (ac_rd != nullptr) {
-
-        // Now we'll copy the comments to the scratch
-        while (*ac_rd != 0) {
-            // check for comment '('
-            // Remember: we're only "counting characters" at this point, no more.
-            if (*ac_rd == '(') {
-                // We only care if it's a "({" in order to handle string-skipping properly
-                ac_rd++;
-
-                bool do_copy = false;
-                bool in_msg = false;
-                if (((* ac_rd    == 'm') || (* ac_rd    == 'M')) &&
-                    ((*(ac_rd+1) == 's') || (*(ac_rd+1) == 'S')) &&
-                    ((*(ac_rd+2) == 'g') || (*(ac_rd+2) == 'G'))
-                    ) {
-
-                    ac_rd += 3;
-                    if (*ac_rd == ' ') {
-                        ac_rd++; // skip the first space.
-                    }
-
-                    if (*(ac_wr-1) == '}') {
-                        *(ac_wr-1) = ',';
-                    } else {
-                        *(ac_wr++) = '{';
-                    }
-                    *(ac_wr++) = 'm';
-                    *(ac_wr++) = 's';
-                    *(ac_wr++) = 'g';
-                    *(ac_wr++) = ':';
-                    *(ac_wr++) = '"';
-
-                    // TODO - FIX BUFFER OVERFLOW POTENTIAL
-                    // "(msg)" is four characters. "{msg:" is five. If the write buffer is full, we'll overflow.
-                    // Also " is MSG will be quoted, making one character into two.
-
-                    in_msg = true;
-                    do_copy = true;
-                }
-
-                else if (*ac_rd == '{') {
-                    // merge json comments
-                    if (*(ac_wr-1) == '}') {
-                        *(ac_wr-1) = ',';
-
-                        // don't copy the '{'
-                        ac_rd++;
-                    }
-
-                    do_copy = true;
-                }
-
-                if (do_copy) {
-                    // skip the comment, handling strings carefully
-                    bool in_string = false;
-                    bool escaped = false;
-                    while (*ac_rd != 0) {
-                        if (in_string && (*ac_rd == '\\')) {
-                            escaped = true;
-                        } else if (!escaped && (*ac_rd == '"')) {
-                            // In msg comments, we have to escape "
-                            if (in_msg) {
-                                *(ac_wr++) = '\\';
-                            } else {
-                                in_string = !in_string;
-                            }
-                        } else if (!in_string && (*ac_rd == ')')) {
-                            ac_rd++;
-                            if (in_msg) {
-                                *(ac_wr++) = '"';
-                                *(ac_wr++) = '}';
-                            }
-                            break;
-                        } else {
-                            escaped = false;
-                        }
-
-                        // Skip spaces if we're not in a string or msg (implicit string)
-                        if (in_string || in_msg || (*ac_rd != ' ')) {
-                            *ac_wr = *ac_rd;
-                            ac_wr++;
-                        }
-
-                        ac_rd++;
-                    }
-                }
-
-                // We don't want the rd++ later to skip the NULL if we're at one
-                if (*ac_rd == 0) {
-                    break;
-                }
+        // everything else is part of a number, which must follow a letter
+        if ((words == 0) || (cc == GC_CHAR_EXPR) ||
+            ((cc == GC_CHAR_MINUS) && (negative || fraction || has_digits)) ||
+            ((cc == GC_CHAR_POINT) && fraction)) {
+            status = STAT_INVALID_OR_MALFORMED_COMMAND;
+            break;
+        }
+        if (cc == GC_CHAR_MINUS) {
+            negative = true;
+            last_char_was_digit = false;
+        } else if (cc == GC_CHAR_POINT) {
+            fraction = true;
+            last_char_was_digit = true;     // treat '.' as a digit so we don't strip after one
+        } else if (!fraction) {
+            has_digits = true;
+            integer = (integer * 10) + (c - '0');
+            if (!last_char_was_digit && (c == '0') && isdigit(*(rd+1))) {
+                continue;                   // strip the leading zero from the normalized block
             }
-            ac_rd++;
+            last_char_was_digit = true;
+        } else if (fraction_digits < GC_FRACTION_DIGITS_MAX) {
+            has_digits = true;
+            fraction_part = (fraction_part * 10) + (c - '0');
+            fraction_digits++;
         }
+        *(wr++) = c;
     }
 
-    // Enforce null termination
-    *ac_wr = 0;
-
-    // Now copy it all back
-    memcpy(str, _normalize_scratch, (ac_wr-_normalize_scratch)+1);
-
-    *active_comment = str + (comment_start - _normalize_scratch);
-}
-
-/****************************************************************************************
- * _get_next_gcode_word() - get gcode word consisting of a letter and a value
- *
- *  This function requires the Gcode string to be normalized.
- *  Normalization must remove any leading zeros or they will be converted to Octal
- *  G0X... is not interpreted as hexadecimal. This is trapped.
- */
-
-static stat_t _get_next_gcode_word(char **pstr, char *letter, float *value, int32_t *value_int)
-{
-    if (**pstr == NUL) { return (STAT_COMPLETE); }    // no more words
-
-    // get letter part
-    if(isupper(**pstr) == false) {
-        return (STAT_INVALID_OR_MALFORMED_COMMAND);
+    // terminate the words, the normalized block and the active comment. A malformed
+    // number replaces the word it was found in, unless the words ran out of room
+    if ((words > 0) && ((status == STAT_OK) || (words == GC_WORDS_MAX-1))) {
+        w++;
     }
-    *letter = **pstr;
-    (*pstr)++;
-
-// Removed support for hex numbers
-//    // X-axis-becomes-a-hexadecimal-number get-value case, e.g. G0X100 --> G255
-//    if ((**pstr == '0') && (*(*pstr+1) == 'X')) {
-//        *value = 0;
-//        (*pstr)++;
-//        return (STAT_OK);                           // pointer points to X
-//    }
-//
-//    // get-value general case
-//    char *end;
-//    *value_int = atol(*pstr);                       // needed to get an accurate line number for N > 8,388,608
-//    *value = strtof(*pstr, &end);
-
-    // get-value general case
-    char *end = *pstr;
-    *value = c_atof(end);
-    *value_int = atol(*pstr);                       // needed to get an accurate line number for N > 8,388,608
-
-    if (end == *pstr) {
-#if MARLIN_COMPAT_ENABLED == true
-        if (mst.marlin_flavor) {
-            *value = 0;
-        } else {
-            return(STAT_BAD_NUMBER_FORMAT);
-        }
-#else
-        return(STAT_BAD_NUMBER_FORMAT);
-#endif
-    }    // more robust test then checking for value=0;
-    *pstr = end;
-    return (STAT_OK);                               // pointer points to next character after the word
+    w->letter = NUL;
+    w->status = status;
+    w->rest = wr;
+    *wr = NUL;
+    *ac_wr = NUL;
+    *active_comment = _active_comment;
 }
 
 /*
@@ -644,13 +898,13 @@ static stat_t _validate_gcode_block(char *active_comment)
  * _parse_gcode_block() - parses one line of NULL terminated G-Code.
  *
  *  All the parser does is load the state values in gn (next model state) and set flags
- *  in gf (model state flags). The execute routine applies them. The buffer is assumed to
- *  contain only uppercase characters and signed floats (no whitespace).
+ *  in gf (model state flags). The execute routine applies them. The words were split
+ *  out by _tokenize_gcode_block().
  */
 
-static stat_t _parse_gcode_block(char *buf, char *active_comment)
+static stat_t _parse_gcode_block(char *active_comment)
 {
-    char *pstr = (char *)buf;                   // persistent pointer into gcode block for parsing words
+    gcWord_t *w = gc_word;                      // word being parsed
     char letter;                                // parsed letter, eg.g. G or X or Y
     float value = 0;                            // value parsed from letter (e.g. 2 for G2)
     int32_t value_int = 0;                      // integer value parsed from letter - needed for line numbers
@@ -670,7 +924,22 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
     }
 
     // extract commands and parameters
-    while((status = _get_next_gcode_word(&pstr, &letter, &value, &value_int)) == STAT_OK) {
+    for (;; w++) {
+        status = w->status;
+#if MARLIN_COMPAT_ENABLED == true
+        if ((status == STAT_BAD_NUMBER_FORMAT) && mst.marlin_flavor) {
+            status = STAT_OK;                   // Marlin allows a letter with no value, e.g. G28 X
+        }
+#endif
+        if (status != STAT_OK) {
+            break;
+        }
+        if ((letter = w->letter) == NUL) {
+            status = STAT_COMPLETE;             // no more words
+            break;
+        }
+        value = w->value;
+        value_int = w->value_int;
         switch(letter) {
             case 'G':
             switch((uint8_t)value) {
@@ -679,6 +948,14 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
                 case 2:  SET_MODAL (MODAL_GROUP_G1, motion_mode, MOTION_MODE_CW_ARC);
                 case 3:  SET_MODAL (MODAL_GROUP_G1, motion_mode, MOTION_MODE_CCW_ARC);
                 case 4:  SET_NON_MODAL (next_action, NEXT_ACTION_DWELL);
+                case 5: {
+                    switch (_point(value)) {
+                        case 0: SET_MODAL (MODAL_GROUP_G1, motion_mode, MOTION_MODE_CUBIC_SPLINE);
+                        case 1: SET_MODAL (MODAL_GROUP_G1, motion_mode, MOTION_MODE_QUADRATIC_SPLINE);
+                        default: status = STAT_GCODE_COMMAND_UNSUPPORTED;
+                    }
+                    break;
+                }
                 case 10: SET_MODAL (MODAL_GROUP_G0, next_action, NEXT_ACTION_SET_G10_DATA);
                 case 17: SET_MODAL (MODAL_GROUP_G2, select_plane, CANON_PLANE_XY);
                 case 18: SET_MODAL (MODAL_GROUP_G2, select_plane, CANON_PLANE_XZ);
@@ -707,6 +984,8 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
                     }
                     break;
                 }
+                case 33: SET_MODAL (MODAL_GROUP_G1, motion_mode, MOTION_MODE_SPINDLE_SYNC);
+                case 37: SET_NON_MODAL (next_action, NEXT_ACTION_MEASURE_TOOL);
                 case 38: {
                     switch (_point(value)) {
                         case 2: SET_NON_MODAL (next_action, NEXT_ACTION_STRAIGHT_PROBE_ERR);
@@ -743,7 +1022,11 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
                     break;
                 }
                 case 64: SET_MODAL (MODAL_GROUP_G13,path_control, PATH_CONTINUOUS);
+                case 73: SET_MODAL (MODAL_GROUP_G1, motion_mode,  MOTION_MODE_CANNED_CYCLE_73);
                 case 80: SET_MODAL (MODAL_GROUP_G1, motion_mode,  MOTION_MODE_CANCEL_MOTION_MODE);
+                case 81: SET_MODAL (MODAL_GROUP_G1, motion_mode,  MOTION_MODE_CANNED_CYCLE_81);
+                case 82: SET_MODAL (MODAL_GROUP_G1, motion_mode,  MOTION_MODE_CANNED_CYCLE_82);
+                case 83: SET_MODAL (MODAL_GROUP_G1, motion_mode,  MOTION_MODE_CANNED_CYCLE_83);
                 case 90: {
                     switch (_point(value)) {
                         case 0: SET_MODAL (MODAL_GROUP_G3, distance_mode, ABSOLUTE_DISTANCE_MODE);
@@ -773,6 +1056,10 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
                 case 93: SET_MODAL (MODAL_GROUP_G5, feed_rate_mode, INVERSE_TIME_MODE);
                 case 94: SET_MODAL (MODAL_GROUP_G5, feed_rate_mode, UNITS_PER_MINUTE_MODE);
 //              case 95: SET_MODAL (MODAL_GROUP_G5, feed_rate_mode, UNITS_PER_REVOLUTION_MODE);
+                case 96: SET_MODAL (MODAL_GROUP_G14, spindle_speed_mode, SPINDLE_SPEED_CSS);
+                case 97: SET_MODAL (MODAL_GROUP_G14, spindle_speed_mode, SPINDLE_SPEED_RPM);
+                case 98: SET_MODAL (MODAL_GROUP_G9, retract_mode, RETRACT_TO_INITIAL);
+                case 99: SET_MODAL (MODAL_GROUP_G9, retract_mode, RETRACT_TO_R);
 
                 default: status = STAT_GCODE_COMMAND_UNSUPPORTED;
             }
@@ -801,6 +1088,10 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
                     }
                     break;
                 case 51: SET_MODAL (MODAL_GROUP_M9, spo_control, true);
+                case 62: SET_MODAL (MODAL_GROUP_M5, output_control, OUTPUT_SYNC_ON);
+                case 63: SET_MODAL (MODAL_GROUP_M5, output_control, OUTPUT_SYNC_OFF);
+                case 64: SET_MODAL (MODAL_GROUP_M5, output_control, OUTPUT_ON);
+                case 65: SET_MODAL (MODAL_GROUP_M5, output_control, OUTPUT_OFF);
                 case 100:
                     switch (_point(value)) {
                         case 0: SET_NON_MODAL (next_action, NEXT_ACTION_JSON_COMMAND_SYNC);
@@ -814,7 +1105,7 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
                 case 20:marlin_list_sd_response();        status = STAT_COMPLETE; break;    // List SD card
                 case 21:                                                                    // Initialize SD card
                 case 22:                                  status = STAT_COMPLETE; break;    // Release SD card
-                case 23: marlin_select_sd_response(pstr); status = STAT_COMPLETE; break;    // Select SD file
+                case 23: marlin_select_sd_response(w->rest); status = STAT_COMPLETE; break;    // Select SD file
 
                 case 82: SET_NON_MODAL (marlin_relative_extruder_mode, false);              // set relative extruder mode off
                 case 83: SET_NON_MODAL (marlin_relative_extruder_mode, true);               // set relative extruder mode on
@@ -849,6 +1140,7 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
             case 'T': SET_NON_MODAL (tool_select, (uint8_t)trunc(value));
             case 'F': SET_NON_MODAL (F_word, value);
             case 'P': SET_NON_MODAL (P_word, value);                // used for dwell time, G10 coord select
+            case 'Q': SET_NON_MODAL (Q_word, value);                // G5 second control point
             case 'S': SET_NON_MODAL (S_word, value);
             case 'X': SET_NON_MODAL (target[AXIS_X], value);
             case 'Y': SET_NON_MODAL (target[AXIS_Y], value);
@@ -901,6 +1193,7 @@ static stat_t _parse_gcode_block(char *buf, char *active_comment)
  *    6. change tool (M6)
  *    7. spindle on or off (M3, M4, M5)
  *    8. coolant on or off (M7, M8, M9)
+ *    8a. digital outputs (M62, M63, M64, M65)
  * // 9. enable or disable overrides (M48, M49, M50, M51) (see 1a)
  *    10. dwell (G4)
  *    11. set active plane (G17, G18, G19)
@@ -929,6 +1222,7 @@ stat_t _execute_gcode_block(char *active_comment)
     if (gf.linenum) {
         cm_set_model_linenum(gv.linenum);
     }
+    LAT_GCODE_PARSED(cm->gm.linenum);
         
     EXEC_FUNC(cm_m48_enable, m48_enable);
 
@@ -950,6 +1244,7 @@ stat_t _execute_gcode_block(char *active_comment)
         ritorno(cm_check_linenum());
     }
         
+    EXEC_FUNC(spindle_speed_mode_sync, spindle_speed_mode); // G96, G97 - before S, which it changes the meaning of
     EXEC_FUNC(spindle_speed_sync, S_word);                  // S
     EXEC_FUNC(cm_select_tool, tool_select);                 // T - tool_select is where it's written
     EXEC_FUNC(cm_change_tool, tool_change);                 // M6 - is where it's effected
@@ -966,6 +1261,9 @@ stat_t _execute_gcode_block(char *active_comment)
     if (gf.coolant_off) {
         ritorno(coolant_control_sync((coControl)gv.coolant_off, COOLANT_BOTH));     // M9
     }
+    if (gf.output_control) {                                // M62, M63, M64, M65
+        ritorno(cm_set_output(gv.output_control, gv.P_word, gf.P_word, gv.Q_word, gf.Q_word));
+    }
     if (gv.next_action == NEXT_ACTION_DWELL) {              // G4 - dwell
         ritorno(cm_dwell(gv.P_word));                       // return if error, otherwise complete the block
     }
@@ -993,11 +1291,14 @@ stat_t _execute_gcode_block(char *active_comment)
 
     if (gf.path_control) {                                  // G61, G61.1, G64
         status = cm_set_path_control(MODEL, gv.path_control);
+        if (gv.path_control == PATH_CONTINUOUS) {           // G64 P sets the blending tolerance. No P clears it
+            cm_set_path_tolerance(MODEL, gf.P_word ? gv.P_word : 0);
+        }
     }
 
     EXEC_FUNC(cm_set_distance_mode, distance_mode);         // G90, G91
     EXEC_FUNC(cm_set_arc_distance_mode, arc_distance_mode); // G90.1, G91.1
-    //--> set retract mode goes here
+    EXEC_FUNC(cm_set_retract_mode, retract_mode);           // G98, G99
 
     switch (gv.next_action) {
         case NEXT_ACTION_SET_G28_POSITION:  { status = cm_set_g28_position(); break;}                               // G28.1
@@ -1013,6 +1314,7 @@ stat_t _execute_gcode_block(char *active_comment)
         case NEXT_ACTION_STRAIGHT_PROBE:         { status = cm_straight_probe(gv.target, gf.target, true, false); break;} // G38.3
         case NEXT_ACTION_STRAIGHT_PROBE_AWAY_ERR:{ status = cm_straight_probe(gv.target, gf.target, false, true); break;} // G38.4
         case NEXT_ACTION_STRAIGHT_PROBE_AWAY:    { status = cm_straight_probe(gv.target, gf.target, false, false); break;}// G38.5
+        case NEXT_ACTION_MEASURE_TOOL:           { status = cm_measure_tool(gv.H_word, gf.H_word); break;}                // G37
 
         case NEXT_ACTION_SET_G10_DATA:           { status = cm_set_g10_data(gv.P_word, gf.P_word,               // G10
                                                                             gv.L_word, gf.L_word,
@@ -1042,6 +1344,30 @@ stat_t _execute_gcode_block(char *active_comment)
                                                                  gv.motion_mode);
                                             break;
                                           }
+                case MOTION_MODE_CUBIC_SPLINE:                                                                      // G5
+                case MOTION_MODE_QUADRATIC_SPLINE: { status = cm_spline_feed(gv.target,     gf.target,              // G5.1
+                                                                         gv.arc_offset, gf.arc_offset,
+                                                                         gv.P_word,     gf.P_word,
+                                                                         gv.Q_word,     gf.Q_word,
+                                                                         gv.motion_mode);
+                                                     break;
+                                                   }
+                case MOTION_MODE_CANNED_CYCLE_73:                                                                   // G73
+                case MOTION_MODE_CANNED_CYCLE_81:                                                                   // G81
+                case MOTION_MODE_CANNED_CYCLE_82:                                                                   // G82
+                case MOTION_MODE_CANNED_CYCLE_83: { status = cm_drill_cycle(gv.target,     gf.target,               // G83
+                                                                        gv.arc_radius, gf.arc_radius,
+                                                                        gv.P_word,     gf.P_word,
+                                                                        gv.Q_word,     gf.Q_word,
+                                                                        gv.L_word,     gf.L_word,
+                                                                        gp.modals[MODAL_GROUP_G1],
+                                                                        gv.motion_mode);
+                                                    break;
+                                                  }
+                case MOTION_MODE_SPINDLE_SYNC: { status = cm_thread_feed(gv.target, gf.target,                     // G33
+                                                                     gv.arc_offset[2], gf.arc_offset[2]);
+                                                 break;
+                                               }
                 default: break;
             }
             cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_OFF);  // un-set absolute override once the move is planned
@@ -1056,6 +1382,7 @@ stat_t _execute_gcode_block(char *active_comment)
         if (gv.program_flow == PROGRAM_STOP) {
             cm_program_stop();
         } else {
+            checkpoint_end();                               // the job is done - nothing to resume
             cm_program_end();
         }
     }
@@ -1249,11 +1576,49 @@ stat_t gc_get_gc(nvObj_t *nv)
     return (STAT_OK);
 }
 
+/*
+ * gc_run_gc() - run a {"gc":} block, or a {"gc":[...]} batch of them
+ *
+ *  A batch runs its blocks in order and stops at the first that fails, or when there is no
+ *  room to take the next - the same limits the controller reads lines against. The value is
+ *  replaced by {"gcn":n}, the number of blocks taken, and the status is the first failure,
+ *  or STAT_BUFFER_FULL if it stopped for room. The host resends the blocks after the first n.
+ */
+
 stat_t gc_run_gc(nvObj_t *nv)
 {
-    return(gcode_parser(*nv->stringp));
+    if (nv->valuetype != TYPE_ARRAY) {
+        return(gcode_parser(*nv->stringp));
+    }
+    stat_t status = STAT_OK;
+    int32_t taken = 0;
+    for (char *block = *nv->stringp; block != nullptr; taken++) {
+        if ((taken > 0) && (mp_planner_is_full(mp) || mp_planner_is_time_full(mp) || cm_has_hold() ||
+            (cm->arc.run_state != BLOCK_INACTIVE) || (cm->drill.run_state != BLOCK_INACTIVE))) {
+            status = STAT_BUFFER_FULL;
+            break;
+        }
+        char *next = strchr(block, '\n');
+        if (next != nullptr) {
+            *next++ = NUL;
+        }
+        if ((status = gcode_parser(block)) != STAT_OK) {
+            if (status != STAT_NOOP) {
+                break;
+            }
+            status = STAT_OK;
+        }
+        block = next;
+    }
+    strcpy(nv->token, "gcn");                   // answer with the count, not the blocks
+    nv->valuetype = TYPE_INTEGER;
+    nv->value_int = taken;
+    return (status);
 }
 
+stat_t gc_get_lcm(nvObj_t *nv) { return (get_integer(nv, gp.line_checksum)); }
+stat_t gc_set_lcm(nvObj_t *nv) { return (set_integer(nv, gp.line_checksum, LINE_CHECKSUM_XOR, LINE_CHECKSUM_CRC32)); }
+
 /***********************************************************************************
  * TEXT MODE SUPPORT
  * Functions to print variables from the cfgArray table
@@ -1261,6 +1626,7 @@ stat_t gc_run_gc(nvObj_t *nv)
 
 #ifdef __TEXT_MODE
 
-// no text mode functions here. Move along
+static const char fmt_lcm[] = "[lcm] line checksum mode%12d [0=XOR,1=CRC32]\n";
+void gc_print_lcm(nvObj_t *nv) { text_print(nv, fmt_lcm);}    // TYPE_INT
 
 #endif // __TEXT_MODE
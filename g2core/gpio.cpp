@@ -38,6 +38,13 @@
  *
  *  The normally closed switch modes (NC) trigger an interrupt on the rising edge
  *  and lockout subsequent interrupts for the defined lockout period. Ditto on the method.
+ *
+ *  Where the PIO has a debounce filter (SAM3X, SAMS70) bounces are removed in hardware
+ *  and never reach the interrupt. The filter is chosen from the input function ($diNfn):
+ *  limit, shutdown, interlock and unassigned inputs use the debounce filter, which
+ *  passes an edge once it has been stable for INPUT_DEBOUNCE_US. Probe, tach and sync
+ *  clock inputs only use the glitch filter so their edges aren't delayed. The software
+ *  lockout is only used when there is no hardware debounce.
  */
 
 #include "g2core.h"  // #1
@@ -47,6 +54,8 @@
 #include "encoder.h"
 #include "hardware.h"
 #include "canonical_machine.h"
+#include "spindle.h"
+#include "sync.h"
 
 #include "text_parser.h"
 #include "controller.h"
@@ -64,6 +73,47 @@ d_out_t  d_out[D_OUT_CHANNELS];
 a_in_t   a_in[A_IN_CHANNELS];
 a_out_t  a_out[A_OUT_CHANNELS];
 
+#if defined(PIO_SCDR_DIV_Msk)
+#define GPIO_HW_DEBOUNCE                    // PIO debounce filter is available
+#endif
+
+/**** Input event queue ****/
+
+// Single producer, single consumer ring. The pin change interrupts all run at the same
+// priority so they can't preempt each other - only they advance head. Only the main loop
+// advances tail. Events that find the ring full are counted and dropped.
+typedef struct gpioEventQueue {
+    gpio_event_t event[GPIO_EVENT_QUEUE_SIZE];
+    volatile uint8_t head;                  // next slot to write (ISR)
+    volatile uint8_t tail;                  // next slot to read (main loop)
+    volatile uint16_t dropped;              // events lost to a full ring
+    uint32_t latency_cycles_max;            // worst case edge to handler time
+    uint8_t subscribers;
+    gpio_event_handler_t handler[GPIO_EVENT_SUBSCRIBERS];
+} gpioEventQueue_t;
+
+static gpioEventQueue_t gq;
+
+static void _report_input_event(const gpio_event_t *event)
+{
+    sr_request_status_report(SR_REQUEST_TIMED);
+}
+
+static void _queue_event(const uint8_t input, const inputEdgeFlag edge)
+{
+    uint8_t head = gq.head;
+    uint8_t next = (head + 1) & (GPIO_EVENT_QUEUE_SIZE - 1);
+    if (next == gq.tail) {
+        gq.dropped++;
+        return;
+    }
+    gq.event[head].cycles = cycle_count();
+    gq.event[head].input = input;
+    gq.event[head].edge = edge;
+    __DMB();                                // event must be visible before the head moves
+    gq.head = next;
+}
+
 /**** Extended DI structure ****/
 
 // To be merged with ioDigitalInput later.
@@ -100,6 +150,14 @@ struct ioDigitalInputExt {
             return;
         }
 
+#ifdef GPIO_HW_DEBOUNCE
+        if ((in->function == INPUT_FUNCTION_PROBE) || (in->function == INPUT_FUNCTION_TACH) ||
+            (in->function == INPUT_FUNCTION_SYNC_CLOCK) || (in->function == INPUT_FUNCTION_SPINDLE_INDEX)) {
+            input_pin.setOptions(kPullUp|kDeglitch);
+        } else {
+            input_pin.setOptions(kPullUp|kDebounce);
+        }
+#endif
         bool pin_value = (bool)input_pin;
         int8_t pin_value_corrected = (pin_value ^ ((int)in->mode ^ 1));    // correct for NO or NC mode
         in->state = (ioState)pin_value_corrected;
@@ -117,20 +175,54 @@ struct ioDigitalInputExt {
             return;
         }
 
+        bool pin_value = (bool)input_pin;
+        int8_t pin_value_corrected = (pin_value ^ ((int)in->mode ^ 1));    // correct for NO or NC mode
+
+        // a tachometer times every leading edge, so it can't use the debounce lockout
+        if (in->function == INPUT_FUNCTION_TACH) {
+            if (in->state != (ioState)pin_value_corrected) {
+                in->state = (ioState)pin_value_corrected;
+                if (pin_value_corrected == INPUT_ACTIVE) {
+                    spindle_tach_pulse(cycle_count());
+                }
+            }
+            return;
+        }
+
+        // the spindle index is timed the same way - it is the phase reference for G33
+        if (in->function == INPUT_FUNCTION_SPINDLE_INDEX) {
+            if (in->state != (ioState)pin_value_corrected) {
+                in->state = (ioState)pin_value_corrected;
+                if (pin_value_corrected == INPUT_ACTIVE) {
+                    spindle_index_pulse(cycle_count());
+                }
+            }
+            return;
+        }
+
+        // ...nor can a sync clock, and both of its edges count
+        if (in->function == INPUT_FUNCTION_SYNC_CLOCK) {
+            if (in->state != (ioState)pin_value_corrected) {
+                in->state = (ioState)pin_value_corrected;
+                sync_clock_edge();
+            }
+            return;
+        }
+
         // return if the input is in lockout period (take no action)
         if (in->lockout_timer.isSet() && !in->lockout_timer.isPast()) {
             return;
         }
 
         // return if no change in state
-        bool pin_value = (bool)input_pin;
-        int8_t pin_value_corrected = (pin_value ^ ((int)in->mode ^ 1));    // correct for NO or NC mode
         if (in->state == (ioState)pin_value_corrected) {
             return;
         }
 
-        // lockout the pin for lockout_ms
-        in->lockout_timer.set(in->lockout_ms);
+        // lockout the pin for lockout_ms (zero if debounced in hardware)
+        if (in->lockout_ms) {
+            in->lockout_timer.set(in->lockout_ms);
+        }
 
         // record the changed state (we know it changed or we would have exited beforehand)
         in->state = (ioState)pin_value_corrected;
@@ -139,13 +231,16 @@ struct ioDigitalInputExt {
         } else {
             in->edge = INPUT_EDGE_TRAILING;
         }
+        _queue_event(ext_pin_number, in->edge);
 
         // perform homing operations if in homing mode
         if (in->homing_mode) {
             if (in->edge == INPUT_EDGE_LEADING) {   // we only want the leading edge to fire
                 en_take_encoder_snapshot();
-//                cm_request_feedhold(FEEDHOLD_TYPE_SKIP, FEEDHOLD_EXIT_STOP);
-                cm_request_feedhold(FEEDHOLD_TYPE_SKIP, FEEDHOLD_EXIT_RESET_POSITION);
+                if (!cm_homing_input_hit(ext_pin_number)) { // per-axis stops are handled by homing
+//                    cm_request_feedhold(FEEDHOLD_TYPE_SKIP, FEEDHOLD_EXIT_STOP);
+                    cm_request_feedhold(FEEDHOLD_TYPE_SKIP, FEEDHOLD_EXIT_RESET_POSITION);
+                }
             }
             return;
         }
@@ -166,6 +261,9 @@ struct ioDigitalInputExt {
 
         // trigger the action on leading edges
         if (in->edge == INPUT_EDGE_LEADING) {
+            if (in->action == INPUT_ACTION_HALT_STEPS) {
+                st_halt_steps();                        // the main loop halts the machine to match
+            }
             if (in->action == INPUT_ACTION_STOP) {
                 cm_request_feedhold(FEEDHOLD_TYPE_HOLD, FEEDHOLD_EXIT_STOP);
             }
@@ -205,6 +303,9 @@ struct ioDigitalInputExt {
 
             } else if (in->function == INPUT_FUNCTION_INTERLOCK) {
                 cm->safety_interlock_disengaged = ext_pin_number;
+
+            } else if (in->function == INPUT_FUNCTION_SYNC_RUN) {
+                sync_run_edge(true);
             }
         }
 
@@ -212,9 +313,10 @@ struct ioDigitalInputExt {
         if (in->edge == INPUT_EDGE_TRAILING) {
             if (in->function == INPUT_FUNCTION_INTERLOCK) {
                 cm->safety_interlock_reengaged = ext_pin_number;
+            } else if (in->function == INPUT_FUNCTION_SYNC_RUN) {
+                sync_run_edge(false);
             }
         }
-        sr_request_status_report(SR_REQUEST_TIMED);
     };
 };
 
@@ -306,6 +408,36 @@ static PWMLikeOutputPin<kOutput13_PinNumber>  output_13_pin;
 /************************************************************************************
  **** CODE **************************************************************************
  ************************************************************************************/
+/*
+ * _set_debounce_period() - set the PIO debounce filter period for all ports
+ *
+ *  The period is 2*(DIV+1) slow clock (32768 Hz) cycles and is shared by every pin on
+ *  a PIO controller, so it is set once here. Which pins use it is set per input.
+ */
+
+static void _set_debounce_period(void)
+{
+#ifdef GPIO_HW_DEBOUNCE
+    uint32_t div = (uint32_t)((INPUT_DEBOUNCE_US * 32768.0) / 2000000.0) - 1;
+    div = PIO_SCDR_DIV(div);
+#ifdef PIOA
+    PIOA->PIO_SCDR = div;
+#endif
+#ifdef PIOB
+    PIOB->PIO_SCDR = div;
+#endif
+#ifdef PIOC
+    PIOC->PIO_SCDR = div;
+#endif
+#ifdef PIOD
+    PIOD->PIO_SCDR = div;
+#endif
+#ifdef PIOE
+    PIOE->PIO_SCDR = div;
+#endif
+#endif
+}
+
 /*
  * gpio_init() - initialize inputs and outputs
  * gpio_reset() - reset inputs and outputs (no initialization)
@@ -333,6 +465,8 @@ void gpio_init(void)
     output_13_pin.setFrequency(200000);
     // END generated
 
+    _set_debounce_period();
+    gpio_event_subscribe(_report_input_event);
     return(gpio_reset());
 }
 
@@ -388,7 +522,11 @@ void inputs_reset(void) {
             in->state = INPUT_DISABLED;
             continue;
         }
+#ifdef GPIO_HW_DEBOUNCE
+        in->lockout_ms = 0;
+#else
         in->lockout_ms = INPUT_LOCKOUT_MS;
+#endif
         in->lockout_timer.clear();
     }
 
@@ -413,6 +551,45 @@ void gpio_reset(void)
     outputs_reset();
 }
 
+/*
+ * gpio_event_subscribe() - add a handler to be called for every input edge event
+ * gpio_event_callback()  - drain the input event queue into the subscribed handlers
+ *
+ *  Handlers run in the main loop, in the order they subscribed. They must not block.
+ *  The time from the edge to the first handler call is tracked as a worst case in
+ *  latency_cycles_max and can be read (and cleared) with $ilat.
+ */
+
+bool gpio_event_subscribe(gpio_event_handler_t handler)
+{
+    if (gq.subscribers >= GPIO_EVENT_SUBSCRIBERS) {
+        return (false);
+    }
+    gq.handler[gq.subscribers++] = handler;
+    return (true);
+}
+
+stat_t gpio_event_callback(void)
+{
+    while (gq.tail != gq.head) {
+        __DMB();                                // read the event only after seeing the head
+        gpio_event_t *event = &gq.event[gq.tail];
+        uint32_t latency = cycle_count() - event->cycles;
+        if (latency > gq.latency_cycles_max) {
+            gq.latency_cycles_max = latency;
+        }
+        for (uint8_t i=0; i < gq.subscribers; i++) {
+            gq.handler[i](event);
+        }
+        gq.tail = (gq.tail + 1) & (GPIO_EVENT_QUEUE_SIZE - 1);
+    }
+    if (gq.dropped) {
+        rpt_exception(STAT_BUFFER_FULL, "input event queue overflow");
+        gq.dropped = 0;
+    }
+    return (STAT_OK);
+}
+
 /******************************
  * Interrupt Service Routines *
  ******************************/
@@ -529,7 +706,7 @@ static uint8_t _io(const index_t index)
         if (isdigit(*ptr)) { 
             return (atoi(ptr)-1);   // need to reduce by 1 for internal 0-based arrays
         }
-    } while (++ptr != NUL);
+    } while (*(++ptr) != NUL);
 
     return (0);
 }
@@ -664,6 +841,14 @@ stat_t io_set_output(nvObj_t *nv)
 
 }
 
+/*
+ *  io_get_ilat() - get worst case input edge to event handler latency in microseconds
+ *  io_set_ilat() - clear it (any write)
+ */
+
+stat_t io_get_ilat(nvObj_t *nv) { return(get_float(nv, cycles_to_usec(gq.latency_cycles_max))); }
+stat_t io_set_ilat(nvObj_t *nv) { gq.latency_cycles_max = 0; return(STAT_OK); }
+
 
 /***********************************************************************************
  * TEXT MODE SUPPORT
@@ -673,12 +858,13 @@ stat_t io_set_output(nvObj_t *nv)
 #ifdef __TEXT_MODE
 
     static const char fmt_gpio_mo[] = "[%smo] input mode%17d [0=active-low,1=active-hi,2=disabled]\n";
-    static const char fmt_gpio_ac[] = "[%sac] input action%15d [0=none,1=stop,2=fast_stop,3=halt,4=alarm,5=shutdown,6=panic,7=reset]\n";
-    static const char fmt_gpio_fn[] = "[%sfn] input function%13d [0=none,1=limit,2=interlock,3=shutdown,4=probe]\n";
+    static const char fmt_gpio_ac[] = "[%sac] input action%15d [0=none,1=stop,2=fast_stop,3=halt,5=alarm,6=shutdown,7=panic,8=reset,9=halt_steps]\n";
+    static const char fmt_gpio_fn[] = "[%sfn] input function%13d [0=none,1=limit,2=interlock,3=shutdown,4=probe,5=tach,6=sync clock,7=sync run,8=spindle index]\n";
     static const char fmt_gpio_in[] = "Input %s state: %5d\n";
 
     static const char fmt_gpio_domode[] = "[%smo] output mode%16d [0=active low,1=active high,2=disabled]\n";
     static const char fmt_gpio_out[] = "Output %s state: %5d\n";
+    static const char fmt_gpio_ilat[] = "[ilat] worst case input event latency%6.1f us\n";
 
     static void _print_di(nvObj_t *nv, const char *format)
     {
@@ -698,4 +884,5 @@ stat_t io_set_output(nvObj_t *nv)
         sprintf(cs.out_buf, fmt_gpio_out, nv->token, (int)nv->value_int);
         xio_writeline(cs.out_buf);
     }
+    void io_print_ilat(nvObj_t *nv) { text_print(nv, fmt_gpio_ilat);}      // TYPE FLOAT
 #endif
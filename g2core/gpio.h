@@ -33,11 +33,11 @@
  */
 //--- change as required for board and switch hardware ---//
 
-#define INPUT_LOCKOUT_MS    10          // milliseconds to go dead after input firing
+#define INPUT_LOCKOUT_MS    10          // milliseconds to go dead after input firing (software fallback)
+#define INPUT_DEBOUNCE_US   2000        // hardware debounce filter period (PIO slow clock divider)
 
 #define D_IN_CHANNELS       9  // v9    // number of digital inputs supported
-//#define D_OUT_CHANNELS    13          // number of digital outputs supported
-#define D_OUT_CHANNELS	    9           // number of digital outputs supported
+#define D_OUT_CHANNELS	    13          // number of digital outputs supported - must cover the do1..do13 configs
 #define A_IN_CHANNELS	    0           // number of analog inputs supported
 #define A_OUT_CHANNELS	    0           // number of analog outputs supported
 
@@ -79,18 +79,23 @@ typedef enum {                          // actions are initiated from within the
     INPUT_ACTION_ALARM,                 // initiate an alarm. stops everything immediately - preserves position
     INPUT_ACTION_SHUTDOWN,              // initiate a shutdown. stops everything immediately - does not preserve position
     INPUT_ACTION_PANIC,                 // initiate a panic. stops everything immediately - does not preserve position
-    INPUT_ACTION_RESET                  // reset system
+    INPUT_ACTION_RESET,                 // reset system
+    INPUT_ACTION_HALT_STEPS             // stop step output in the interrupt - does not preserve position
 } inputAction;
-#define INPUT_ACTION_MAX    INPUT_ACTION_RESET 
+#define INPUT_ACTION_MAX    INPUT_ACTION_HALT_STEPS
 
 typedef enum {                          // functions are requested from the ISR, run from the main loop
     INPUT_FUNCTION_NONE = 0,
     INPUT_FUNCTION_LIMIT = 1,           // limit switch processing
     INPUT_FUNCTION_INTERLOCK = 2,       // interlock processing
     INPUT_FUNCTION_SHUTDOWN = 3,        // shutdown in support of external emergency stop
-    INPUT_FUNCTION_PROBE = 4            // assign input as probe input
+    INPUT_FUNCTION_PROBE = 4,           // assign input as probe input
+    INPUT_FUNCTION_TACH = 5,            // spindle tachometer pulses - see spindle_tach_pulse()
+    INPUT_FUNCTION_SYNC_CLOCK = 6,      // sync master's clock - see sync.h
+    INPUT_FUNCTION_SYNC_RUN = 7,        // sync master's run line
+    INPUT_FUNCTION_SPINDLE_INDEX = 8    // once per revolution spindle index - see spindle_index_pulse()
 } inputFunc;
-#define INPUT_FUNCTION_MAX  INPUT_FUNCTION_PROBE
+#define INPUT_FUNCTION_MAX  INPUT_FUNCTION_SPINDLE_INDEX
 
 typedef enum {
     INPUT_INACTIVE = 0,                 // aka switch open, also read as 'false'
@@ -120,6 +125,26 @@ typedef struct ioDigitalInput {		    // one struct per digital input
     Motate::Timeout lockout_timer;      // time to expire current debounce lockout, or 0 if no lockout
 } d_in_t;
 
+/*
+ * Input edge events
+ *
+ *  Every debounced edge is recorded by the pin change interrupt with a cycle counter
+ *  timestamp and queued for the main loop. gpio_event_callback() drains the queue and
+ *  passes each event to the subscribed handlers. Safety reactions (limits, shutdown,
+ *  interlock, homing and probe stops) are still taken in the interrupt - the queue is
+ *  for consumers that can run in task context, and measures how long they waited.
+ */
+#define GPIO_EVENT_QUEUE_SIZE 16        // must be a power of 2
+#define GPIO_EVENT_SUBSCRIBERS 4        // max number of event handlers
+
+typedef struct gpioInputEvent {         // one edge seen by the pin change interrupt
+    uint32_t cycles;                    // cycle_count() when the edge was accepted
+    uint8_t input;                      // external input number (1 based)
+    inputEdgeFlag edge;                 // leading or trailing
+} gpio_event_t;
+
+typedef void (*gpio_event_handler_t)(const gpio_event_t *event);
+
 typedef struct gpioDigitalOutput {      // one struct per digital output
     ioMode mode;
 } d_out_t;
@@ -152,6 +177,9 @@ int8_t gpio_get_probing_input(void);
 bool gpio_read_input(const uint8_t input_num);
 stat_t gpio_set_output(uint8_t output_num, float value);
 
+bool gpio_event_subscribe(gpio_event_handler_t handler);
+stat_t gpio_event_callback(void);
+
 stat_t io_get_mo(nvObj_t *nv);
 stat_t io_set_mo(nvObj_t *nv);
 stat_t io_get_ac(nvObj_t *nv);
@@ -166,6 +194,9 @@ stat_t io_set_domode(nvObj_t *nv);			// output sense
 stat_t io_get_output(nvObj_t *nv);
 stat_t io_set_output(nvObj_t *nv);
 
+stat_t io_get_ilat(nvObj_t *nv);            // worst case input edge to event handler latency
+stat_t io_set_ilat(nvObj_t *nv);            // any write clears it
+
 #ifdef __TEXT_MODE
     void io_print_mo(nvObj_t *nv);
     void io_print_ac(nvObj_t *nv);
@@ -173,6 +204,7 @@ stat_t io_set_output(nvObj_t *nv);
     void io_print_in(nvObj_t *nv);
     void io_print_domode(nvObj_t *nv);
     void io_print_out(nvObj_t *nv);
+    void io_print_ilat(nvObj_t *nv);
 #else
     #define io_print_mo tx_print_stub
     #define io_print_ac tx_print_stub
@@ -181,6 +213,7 @@ stat_t io_set_output(nvObj_t *nv);
     #define io_print_st tx_print_stub
     #define io_print_domode tx_print_stub
     #define io_print_out tx_print_stub
+    #define io_print_ilat tx_print_stub
 #endif // __TEXT_MODE
 
 #endif // End of include guard: GPIO_H_ONCE
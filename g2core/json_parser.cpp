@@ -32,6 +32,7 @@
 #include "json_parser.h"
 #include "text_parser.h"
 #include "canonical_machine.h"
+#include "planner.h"
 #include "report.h"
 #include "util.h"
 #include "xio.h"
@@ -44,14 +45,12 @@ jsSingleton_t js;
 
 static stat_t _json_parser_kernal(nvObj_t *nv, char *str);
 static stat_t _json_parser_execute(nvObj_t *nv);
-static stat_t _normalize_json_string(char *str, uint16_t size);
 static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth);
 
 /****************************************************************************
  * json_parser() - exposed part of JSON parser
  * _json_parser_kernal()
- * _normalize_json_string()
- * _get_nv_pair_strict()
+ * _get_nv_pair()
  *
  *  This is a dumbed down JSON parser to fit in limited memory with no malloc
  *  or practical way to do recursion ("depth" tracks parent/child levels).
@@ -65,6 +64,7 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth);
  *    {"parent_name":{"name1":"value1", "n2":"v2", ... "nN":"vN"}}
  *
  *    "value" can be a string, number, true, false, or null (2 types)
+ *    {"gc":["block1", "block2", ... "blockN"]} is the one array form taken
  *
  *  Numbers
  *    - number values are not quoted and can start with a digit or -.
@@ -73,6 +73,7 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth);
  *    - hexadecimal or other non-decimal number bases are not supported
  *
  *  The parser:
+ *    - reads the input string in a single pass without first rewriting it
  *    - extracts an array of one or more JSON object structs from the input string
  *    - once the array is built it executes the object(s) in order in the array
  *    - passes the executed array to the response handler to generate the response string
@@ -150,12 +151,7 @@ static stat_t _json_parser_kernal(nvObj_t *nv, char *str)
     int8_t depth;
     char group[GROUP_LEN+1] = {""};                 // group identifier - starts as NUL
     int8_t i = NV_BODY_LEN;
-
-    status = _normalize_json_string(str, JSON_INPUT_STRING_MAX);
-    if (status != STAT_OK) {
-        nv->valuetype = TYPE_NULL;
-        return (status);
-    }
+    char *start = str;
 
     // parse the JSON command into the nv body
     do {
@@ -168,6 +164,10 @@ static stat_t _json_parser_kernal(nvObj_t *nv, char *str)
             nv->valuetype = TYPE_NULL;
             return (status);
         }
+        if ((str - start) > JSON_INPUT_STRING_MAX) {
+            nv->valuetype = TYPE_NULL;
+            return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
+        }
         // propagate the group from previous NV pair (if relevant)
         if (group[0] != NUL) {
             strncpy(nv->group, group, GROUP_LEN);   // copy the parent's group to this child
@@ -181,6 +181,10 @@ static stat_t _json_parser_kernal(nvObj_t *nv, char *str)
             strncpy(group, nv->token, GROUP_LEN);   // record the group ID
         }
         nv_coerce_types(nv);                        // adjust types based on type fields in configApp table
+        if ((nv->valuetype == TYPE_ARRAY) && (nv_get_type(nv) != NV_TYPE_GCODE)) {
+            nv->valuetype = TYPE_NULL;
+            return (STAT_VALUE_TYPE_ERROR);         // only gcode takes an array (see _get_nv_pair())
+        }
         if ((nv = nv->nx) == NULL) {
             return (STAT_JSON_TOO_MANY_PAIRS);      // Not supposed to encounter a NULL
         }
@@ -190,31 +194,39 @@ static stat_t _json_parser_kernal(nvObj_t *nv, char *str)
 }
 
 /*
- * _normalize_json_string - normalize a JSON string in place
- *
- *  Validate string size limits, remove all whitespace and convert
- *  to lower case, with the exception of gcode comments
+ * _is_json_space() - true for the characters the parser ignores: controls, whitespace and DEL
  */
 
-static stat_t _normalize_json_string(char *str, uint16_t size)
+static inline bool _is_json_space(const char c)
 {
-    char *wr;                                       // write pointer
-    uint8_t in_comment = false;
+    return (((c > NUL) && (c <= ' ')) || (c == DEL));
+}
 
-    if (strlen(str) > size) {
-        return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
-    }
-    for (wr = str; *str != NUL; str++) {
-        if (!in_comment) {                          // normal processing
-            if (*str == '(') in_comment = true;
-            if ((*str <= ' ') || (*str == DEL)) continue; // toss ctrls, WS & DEL
-            *wr++ = tolower(*str);
-        } else {                                    // Gcode comment processing
-            if (*str == ')') in_comment = false;
-            *wr++ = *str;
+/*
+ * _compact_string() - compact a string value in place, from just past its opening quote
+ *
+ *  Whitespace and controls are removed and the rest lowercased, except in gcode comments.
+ *  Leaves *rd just past the closing quote and *wr just past the last character written.
+ */
+
+static stat_t _compact_string(char **rd, char **wr)
+{
+    bool in_comment = false;
+    char *tmp;
+    for (tmp = *rd; *tmp != '\"'; tmp++) {
+        if (*tmp == NUL) {
+            return (STAT_JSON_SYNTAX_ERROR);            // no end to the string
+        }
+        if (in_comment) {                               // Gcode comments are left as they are
+            if (*tmp == ')') in_comment = false;
+            *(*wr)++ = *tmp;
+            continue;
         }
+        if (*tmp == '(') in_comment = true;
+        if (_is_json_space(*tmp)) continue;             // toss ctrls, WS & DEL
+        *(*wr)++ = tolower(*tmp);
     }
-    *wr = NUL;
+    *rd = ++tmp;
     return (STAT_OK);
 }
 
@@ -231,7 +243,14 @@ static stat_t _normalize_json_string(char *str, uint16_t size)
  *  If this were to be extended to track multiple parents or more than two
  *  levels deep it would have to track closing curlies - which it does not.
  *
- *  ASSUMES INPUT STRING HAS FIRST BEEN NORMALIZED BY _normalize_json_string()
+ *  Works directly on the raw input string. Whitespace and control characters are
+ *  skipped as they are read, names are lowercased as they are copied into the token,
+ *  and numbers are converted where they lie. String values are compacted in place
+ *  (whitespace removed and lowercased, except in gcode comments) before being copied
+ *  to the nv string pool, so the rest of the input is never rewritten.
+ *
+ *  An array of strings is taken as one TYPE_ARRAY value, the strings one to a line - so
+ *  {"gc":["g1x1","g1x2"]} carries two blocks (see gc_run_gc()). Other arrays are refused.
  *
  *  If a group prefix is passed in it will be pre-pended to any name parsed
  *  to form a token string. For example, if "x" is provided as a group and
@@ -251,83 +270,115 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
     uint8_t i;
     char *tmp;
     char leaders[] = {"{,\""};      // open curly, quote and leading comma
-    char separators[] = {":\""};    // colon and quote
     char terminators[] = {"},\""};  // close curly, comma and quote
-    char value[] = {"{\".-+"};      // open curly, quote, period, minus and plus
+    char value[] = {"{[\".-+"};     // open curly, open bracket, quote, period, minus and plus
 
     nv_reset_nv(nv);                // wipes the object and sets the depth
 
     // --- Process name part ---
-    // Find, terminate and set pointers for the name. Allow for leading and trailing name quotes.
-    char * name = *pstr;
-    for (i=0; true; i++, (*pstr)++) {
-        if (strchr(leaders, (int)**pstr) == NULL) {     // find leading character of name
-            name = (*pstr)++;
+    // Find the leading character of the name. Allow for leading and trailing name quotes.
+    for (i=0; true; (*pstr)++) {
+        if (_is_json_space(**pstr)) {
+            continue;
+        }
+        if (strchr(leaders, (int)**pstr) == NULL) {
             break;
         }
-        if (i == MAX_PAD_CHARS) {
+        if (i++ == MAX_PAD_CHARS) {
             return (STAT_JSON_SYNTAX_ERROR);
         }
     }
 
-    // Find the end of name, NUL terminate and copy token
-    for (i=0; true; i++, (*pstr)++) {
-        if (strchr(separators, (int)**pstr) != NULL) {
-            *(*pstr)++ = NUL;
-            strncpy(nv->token, name, TOKEN_LEN+1);      // copy the string to the token
+    // Copy the name into the token up to the separator (colon or quote)
+    for (i=0; true; (*pstr)++) {
+        char c = **pstr;
+        if ((c == ':') || (c == '\"')) {
+            (*pstr)++;
             break;
         }
+        if (c == NUL) {
+            return (STAT_JSON_SYNTAX_ERROR);
+        }
+        if (_is_json_space(c)) {
+            continue;
+        }
         if (i == TOKEN_LEN) {
             return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
         }
+        nv->token[i++] = tolower(c);
     }
+    nv->token[i] = NUL;
 
     // --- Process value part ---  (organized from most to least frequently encountered)
 
     // Find the start of the value part
-    for (i=0; true; i++, (*pstr)++) {
+    for (i=0; true; (*pstr)++) {
+        if (_is_json_space(**pstr)) {
+            continue;
+        }
         if (isalnum((int)**pstr)) break;
         if (strchr(value, (int)**pstr) != NULL) break;
-        if (i == MAX_PAD_CHARS) {
+        if (i++ == MAX_PAD_CHARS) {
             return (STAT_JSON_SYNTAX_ERROR);
         }
     }
+    char c = tolower(**pstr);
 
     // nulls (gets)
-    if ((**pstr == 'n') || ((**pstr == '\"') && (*(*pstr+1) == '\"'))) { // process null value
+    if ((c == 'n') || ((c == '\"') && (*(*pstr+1) == '\"'))) { // process null value
         nv->valuetype = TYPE_NULL;
         nv->value_int = TYPE_NULL;
 
     // numbers
-    } else if (isdigit(**pstr) || (**pstr == '-')) {    // value is a number
-        nv->value_int = atol(*pstr);                    // get the number as an integer
-        nv->value_flt = (float)strtod(*pstr, &tmp);     // get the number as a float - tmp is the end pointer
-
-        if ((tmp == *pstr) ||                           // if start pointer equals end the conversion failed
-            (strchr(terminators, *tmp) == NULL)) {      // terminators are the only legal chars at the end of a number
+    } else if (isdigit(c) || (c == '-')) {              // value is a number
+        tmp = *pstr;
+        bool negative = (*tmp == '-');
+        if (negative) {
+            tmp++;
+        }
+        char *digits = tmp;
+        uint32_t integer = 0;
+        while (isdigit(*tmp)) {                         // accumulate the integer part as we go
+            integer = (integer * 10) + (*tmp++ - '0');
+        }
+        if (tmp == digits) {                            // no digits means the conversion failed
+            nv->valuetype = TYPE_NULL;
+            return (STAT_BAD_NUMBER_FORMAT);
+        }
+        nv->value_int = negative ? -(int32_t)integer : (int32_t)integer;
+        if ((*tmp == '.') || (*tmp == 'e') || (*tmp == 'E')) {
+            nv->value_flt = strtofloat(*pstr, &tmp);    // only fractions and exponents need the float parser
+        } else {
+            nv->value_flt = (float)nv->value_int;
+        }
+        while (_is_json_space(*tmp)) {
+            tmp++;
+        }
+        if (strchr(terminators, *tmp) == NULL) {        // terminators are the only legal chars at the end of a number
             nv->valuetype = TYPE_NULL;                  // report back an error
             return (STAT_BAD_NUMBER_FORMAT);
         }
+        *pstr = tmp;
         nv->valuetype = TYPE_FLOAT;
 
     // object parent
-    } else if (**pstr == '{') {
+    } else if (c == '{') {
         nv->valuetype = TYPE_PARENT;
 //        *depth += 1;                                  // nv_reset_nv() sets the next object's level so this is redundant
         (*pstr)++;
         return(STAT_EAGAIN);                            // signal that there is more to parse
 
     // strings
-    } else if (**pstr == '\"') {                        // value is a string
+    } else if (c == '\"') {                            // value is a string
         (*pstr)++;
         nv->valuetype = TYPE_STRING;
-        if ((tmp = strchr(*pstr, '\"')) == NULL) {
-            return (STAT_JSON_SYNTAX_ERROR);            // find the end of the string
-        }
-        *tmp = NUL;
+        char *wr = *pstr;                               // compact the string in place as we find its end
+        tmp = *pstr;
+        ritorno(_compact_string(&tmp, &wr));
+        *wr = NUL;
 
         // if string begins with 0x it might be data, needs to be at least 3 chars long
-        if( strlen(*pstr)>=3 && (*pstr)[0]=='0' && (*pstr)[1]=='x')
+        if( (wr - *pstr)>=3 && (*pstr)[0]=='0' && (*pstr)[1]=='x')
         {
             uint32_t *v = (uint32_t*)&nv->value_flt;
             *v = strtoul((const char *)*pstr, 0L, 0);
@@ -335,21 +386,43 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
         } else {
             ritorno(nv_copy_string(nv, *pstr));
         }
-        *pstr = ++tmp;
+        *pstr = tmp;
 
     // boolean true/false
-    } else if (**pstr == 't') {
+    } else if (c == 't') {
         nv->valuetype = TYPE_BOOLEAN;
         nv->value_int = true;
-    } else if (**pstr == 'f') {
+    } else if (c == 'f') {
         nv->valuetype = TYPE_BOOLEAN;
         nv->value_int = false;
 
     // arrays
-    } else if (**pstr == '[') {
+    } else if (c == '[') {
         nv->valuetype = TYPE_ARRAY;
-        ritorno(nv_copy_string(nv, *pstr));     // copy array into string for error displays
-        return (STAT_VALUE_TYPE_ERROR);         // return error as the parser doesn't do input arrays yet
+        for (tmp = *pstr+1; _is_json_space(*tmp); tmp++);
+        if (*tmp != '\"') {
+            ritorno(nv_copy_string(nv, *pstr)); // copy array into string for error displays
+            return (STAT_VALUE_TYPE_ERROR);     // only arrays of strings are taken
+        }
+        char *wr = *pstr;                       // compact the strings in place, one to a line
+        while (true) {
+            if (*tmp++ != '\"') {
+                return (STAT_VALUE_TYPE_ERROR);
+            }
+            ritorno(_compact_string(&tmp, &wr));
+            while (_is_json_space(*tmp)) tmp++;
+            if (*tmp == ']') {
+                break;
+            }
+            if (*tmp++ != ',') {
+                return (STAT_JSON_SYNTAX_ERROR);
+            }
+            while (_is_json_space(*tmp)) tmp++;
+            *wr++ = '\n';
+        }
+        *wr = NUL;
+        ritorno(nv_copy_string(nv, *pstr));
+        *pstr = ++tmp;
 
     // general error condition
     } else {
@@ -363,6 +436,9 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
     if (**pstr == '}') {
         *depth -= 1;                            // pop up a nesting level
         (*pstr)++;                              // advance to comma or whatever follows
+        while (_is_json_space(**pstr)) {
+            (*pstr)++;
+        }
     }
     if (**pstr == ',') {
         return (STAT_EAGAIN);                   // signal that there is more to parse
@@ -403,92 +479,175 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
  *    - If a JSON object is empty omit the object altogether (no curlies)
  */
 
-uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size)
+/*
+ * jsOutput_t    - destination for the serializer: a caller's buffer, or a chunk streamed to xio
+ * _json_room()  - make room for n characters, flushing the chunk if streaming
+ * _json_flush() - write the chunk to the output devices
+ * _json_putc()  - put a character
+ * _json_puts()  - put a string
+ *
+ *  When streaming, a full chunk is handed to xio_write(), which waits for room in the
+ *  device TX buffers, so a response of any length only needs JSON_OUTPUT_CHUNK bytes.
+ */
+
+typedef struct jsOutput {
+    char *buf;                                  // start of the buffer or chunk
+    char *str;                                  // write pointer
+    char *str_max;                              // end of the buffer or chunk
+    bool stream;                                // true to flush chunks to xio, false for a single buffer
+    bool only_to_muted;                         // passed to xio_write() when streaming
+    bool overrun;                               // set if a buffer (not a stream) ran out of room
+    uint16_t count;                             // characters already flushed
+} jsOutput_t;
+
+static void _json_flush(jsOutput_t &out)
+{
+    if (out.stream && (out.str > out.buf)) {
+        xio_write(out.buf, out.str - out.buf, out.only_to_muted);
+        out.count += out.str - out.buf;
+        out.str = out.buf;
+    }
+}
+
+static bool _json_room(jsOutput_t &out, uint16_t n)
+{
+    if (out.str + n <= out.str_max) {
+        return (true);
+    }
+    _json_flush(out);
+    if (out.str + n <= out.str_max) {
+        return (true);
+    }
+    out.overrun = true;
+    return (false);
+}
+
+static void _json_putc(jsOutput_t &out, const char c)
+{
+    if (_json_room(out, 1)) {
+        *out.str++ = c;
+    }
+}
+
+static void _json_puts(jsOutput_t &out, const char *s)
+{
+    while (*s != NUL) {
+        _json_putc(out, *s++);
+    }
+}
+
+static void _json_serialize(nvObj_t *nv, jsOutput_t &out)
 {
-    char *str = out_buf;
-    char *str_max = out_buf + size;
     int8_t initial_depth = nv->depth;
     int8_t prev_depth = 0;
     uint8_t need_a_comma = false;
 
-    *str++ = '{';                                 // write opening curly
+    _json_putc(out, '{');                       // write opening curly
 
     while (true) {
         if (nv->valuetype != TYPE_EMPTY) {
-            if (need_a_comma) { *str++ = ',';}
+            if (need_a_comma) { _json_putc(out, ',');}
             need_a_comma = true;
-            strcpy(str++, "\"");
-            strcpy(str, nv->token); str += strlen(nv->token);
-            strcpy(str++, "\":"); str++;
+            _json_putc(out, '"');
+            _json_puts(out, nv->token);
+            _json_puts(out, "\":");
 
             switch (nv->valuetype)  {
                 case (TYPE_EMPTY):  {   break; }
-                case (TYPE_NULL):   {   strcpy(str, "null");
-                                        str += 4;
+                case (TYPE_NULL):   {   _json_puts(out, "null");
                                         break;
                                     }
-                case (TYPE_PARENT): {   *str++ = '{';
+                case (TYPE_PARENT): {   _json_putc(out, '{');
                                         need_a_comma = false;
                                         break;
                                     }
                 case (TYPE_FLOAT):  {   convert_outgoing_float(nv);
-                                        str += floattoa(str, nv->value_flt, nv->precision);
+                                        if (_json_room(out, JSON_NUMBER_MAX)) {
+                                            out.str += floattoa(out.str, nv->value_flt, nv->precision);
+                                        }
                                         break;
                                     }
-//                case (TYPE_INT):    {   // str += inttoa(str, (int)nv->value); // doesn't handle negative numbers
-//                                        str += sprintf(str, "%d", (int)nv->value);
-//                                        break;
-//                                    }
-                case (TYPE_INTEGER):{   str += sprintf(str, "%d", (int)nv->value_int);
+                case (TYPE_INTEGER):{   if (_json_room(out, JSON_NUMBER_MAX)) {
+                                            out.str += sprintf(out.str, "%d", (int)nv->value_int);
+                                        }
                                         break;
                                     }
-                case (TYPE_STRING): {   *str++ = '"';
-                                        strcpy(str, *nv->stringp);
-                                        str += strlen(*nv->stringp);
-                                        *str++ = '"';
+                case (TYPE_STRING): {   _json_putc(out, '"');
+                                        _json_puts(out, *nv->stringp);
+                                        _json_putc(out, '"');
                                         break;
                                     }
                 case (TYPE_BOOLEAN):{   if (nv->value_int) {
-                                            strcpy(str, "false");
-                                            str += 5;
+                                            _json_puts(out, "false");
                                         } else {
-                                            strcpy(str, "true");
-                                            str += 4;
+                                            _json_puts(out, "true");
                                         }
                                         break;
                                     }
                 case (TYPE_DATA):   {   uint32_t *v = (uint32_t*)&nv->value_flt;
-                                        str += sprintf(str, "\"0x%lx\"", *v);
+                                        if (_json_room(out, JSON_NUMBER_MAX)) {
+                                            out.str += sprintf(out.str, "\"0x%lx\"", *v);
+                                        }
                                         break;
                                     }
-                case (TYPE_ARRAY):  {   strcpy(str++, "[");
-                                        strcpy(str, *nv->stringp);
-                                        str += strlen(*nv->stringp);
-                                        strcpy(str++, "]");
+                case (TYPE_ARRAY):  {   _json_putc(out, '[');
+                                        _json_puts(out, *nv->stringp);
+                                        _json_putc(out, ']');
                                         break;
                                     }
                 default: {}
             }
         }
-        if (str >= str_max) { return (-1);}     // signal buffer overrun
+        if (out.overrun) { return;}             // signal buffer overrun
         if ((nv = nv->nx) == NULL) { break;}    // end of the list
 
         while (nv->depth < prev_depth--) {      // iterate the closing curlies
             need_a_comma = true;
-            *str++ = '}';
+            _json_putc(out, '}');
         }
         prev_depth = nv->depth;
     }
 
     // closing curlies and NEWLINE
     while (prev_depth-- > initial_depth) {
-        *str++ = '}';
+        _json_putc(out, '}');
     }
-    str += sprintf((char *)str, "}\n");         // using sprintf for this last one ensures a NUL termination
-    if (str > out_buf + size) {
+    _json_puts(out, "}\n");
+}
+
+uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size)
+{
+    jsOutput_t out = { out_buf, out_buf, out_buf + size - 1, false, false, false, 0 }; // leave room for the NUL
+    _json_serialize(nv, out);
+    if (out.overrun) {
         return (-1);
     }
-    return (str - out_buf);
+    *out.str = NUL;
+    return (out.str - out_buf);
+}
+
+/*
+ * json_stream() - serialize the nvObj list straight to the output devices
+ *
+ *  Same output as json_serialize() followed by xio_writeline(), but written out in
+ *  chunks as it is produced. The chunk is scratch from the nv arena and is handed back
+ *  when done. Returns the number of characters written.
+ */
+
+static_assert(JSON_OUTPUT_CHUNK + NV_FOOTER_LEN <= NV_ARENA_RESERVE, "the chunk and footer must fit the nv arena reserve");
+
+uint16_t json_stream(nvObj_t *nv, const bool only_to_muted)
+{
+    uint16_t mark = nv_arena_mark();
+    char *chunk = nv_arena_alloc(JSON_OUTPUT_CHUNK, true);
+    if (chunk == nullptr) {
+        return (0);
+    }
+    jsOutput_t out = { chunk, chunk, chunk + JSON_OUTPUT_CHUNK, true, only_to_muted, false, 0 };
+    _json_serialize(nv, out);
+    _json_flush(out);
+    nv_arena_release(mark);
+    return (out.count);
 }
 
 /*
@@ -500,8 +659,7 @@ uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size)
  */
 void json_print_object(nvObj_t *nv)
 {
-    json_serialize(nv, cs.out_buf, sizeof(cs.out_buf));
-    xio_writeline(cs.out_buf);
+    json_stream(nv);
 }
 
 /*
@@ -538,11 +696,78 @@ void json_print_list(stat_t status, uint8_t flags)
  *  on all the (non-silent) responses.
  */
 
+/*
+ * json_ack_callback() - send a cumulative ack for the gcode lines accepted in JV_ACK mode
+ * _json_send_ack()    - send it now
+ *
+ *  In JV_ACK mode a gcode line that is accepted gets no response of its own. Instead
+ *  {"ak":[n,lines,bytes]} is sent for a run of up to {jab:} lines, or after JSON_ACK_MS
+ *  if the run stops. {jab:1} acks every line as soon as it is accepted. n is the line number of the last line accepted (hosts
+ *  should send N words), lines is how many more the planner will take and bytes is the
+ *  room left in the RX buffer. A host can keep sending while both credits last, which
+ *  pipelines a stream instead of waiting on each response. Errors, and responses to
+ *  anything other than gcode, are sent as usual - after an ack for the lines before them.
+ *
+ *  An ack is also sent with no new lines once the planner frees up, so a host that ran
+ *  out of credit finds out when it can carry on.
+ */
+
+static uint8_t _json_ack_credits()
+{
+    uint8_t buffers = mp_get_planner_buffers(mp);
+    return ((buffers > PLANNER_BUFFER_HEADROOM) ? (buffers - PLANNER_BUFFER_HEADROOM) : 0);
+}
+
+static void _json_send_ack()
+{
+    if ((js.ack_pending == 0) && (js.ack_tick == 0)) {
+        return;                                             // nothing has been sent to ack
+    }
+    char ack[48];
+    js.ack_credits = _json_ack_credits();
+    sprintf(ack, "{\"ak\":[%lu,%d,%d]}\n", (unsigned long)js.ack_linenum, js.ack_credits, xio_get_rx_space());
+    xio_writeline(ack);
+    js.ack_pending = 0;
+    js.ack_tick = SysTickTimer_getValue();
+}
+
+stat_t json_ack_callback()
+{
+    if (js.json_verbosity != JV_ACK) {
+        return (STAT_NOOP);
+    }
+    uint32_t elapsed = SysTickTimer_getValue() - js.ack_tick;
+    if (js.ack_pending > 0) {
+        if ((js.ack_pending < js.ack_batch) && (elapsed < JSON_ACK_MS))  {
+            return (STAT_NOOP);
+        }
+    } else if ((js.ack_tick == 0) || (js.ack_credits >= js.ack_batch) ||
+               (_json_ack_credits() < js.ack_credits + js.ack_batch) || (elapsed < JSON_ACK_MS)) {
+        return (STAT_NOOP);                                 // only re-advertise when credit opens back up
+    }
+    _json_send_ack();
+    return (STAT_OK);
+}
+
 void json_print_response(uint8_t status, const bool only_to_muted /*= false*/)
 {
     if ((js.json_verbosity == JV_SILENT) || (cs.responses_suppressed)) {                   // silent means no responses
         return;
     }
+    if (js.json_verbosity == JV_ACK) {                      // gcode lines are acked later, in bulk
+        if ((status == STAT_OK) && (cm->machine_state != MACHINE_INITIALIZING) && (nv_get_type(nv_body) == NV_TYPE_GCODE)) {
+            if (js.ack_pending++ == 0) {
+                js.ack_tick = SysTickTimer_getValue();
+            }
+            js.ack_linenum = cm_get_linenum(MODEL);
+            cs.linelen = 0;
+            if (js.ack_pending >= js.ack_batch) {           // a full batch goes out without waiting for the callback
+                _json_send_ack();
+            }
+            return;
+        }
+        _json_send_ack();                                   // anything else goes out in order, after the lines before it
+    }
     if (js.json_verbosity == JV_EXCEPTIONS)    {            // cutout for JV_EXCEPTIONS mode
         if (status == STAT_OK) {
             if (cm->machine_state != MACHINE_INITIALIZING) { // always do full echo during startup
@@ -601,7 +826,11 @@ void json_print_response(uint8_t status, const bool only_to_muted /*= false*/)
     // to ensure that the correct number of bytes are reported back to the host we add a +1 to
     // cs.linelen so that the number of bytes received matches the number of bytes reported
 
-    char footer_string[NV_FOOTER_LEN];
+    uint16_t mark = nv_arena_mark();                        // the footer is scratch - see config.h
+    char *footer_string = nv_arena_alloc(NV_FOOTER_LEN, true);
+    if (footer_string == nullptr) {
+        return;
+    }
     char *str = footer_string;
 
     strcpy(str, "1,"); str += 2;                            // '1' is the footer revision hard coded
@@ -610,16 +839,15 @@ void json_print_response(uint8_t status, const bool only_to_muted /*= false*/)
     str += inttoa(str, cs.linelen+1);
     cs.linelen = 0;                                            // reset linelen so it's only reported once
 
-    nv_copy_string(nv, footer_string);                      // link string to nv object
+    nv->stringp = (char (*)[])footer_string;                // link string to nv object
     nv->depth = 0;                                          // footer 'f' is a peer to response 'r' (hard wired to 0)
     nv->valuetype = TYPE_ARRAY;                             // declare it as an array
     strcpy(nv->token, "f");                                 // set it to Footer
     nv->nx = NULL;                                          // terminate the list
 
-    // serialize the JSON response and print it if there were no errors
-    if (json_serialize(nv_header, cs.out_buf, sizeof(cs.out_buf)) >= 0) {
-        xio_writeline(cs.out_buf, only_to_muted);
-    }
+    // serialize the JSON response straight to the output devices
+    json_stream(nv_header, only_to_muted);
+    nv_arena_release(mark);
 }
 
 /***********************************************************************************
@@ -665,7 +893,9 @@ stat_t js_set_jv(nvObj_t *nv)
     js.echo_json_linenum = false;
     js.echo_json_gcode_block = false;
 
-    if (js.json_verbosity == JV_EXCEPTIONS) {
+    js.ack_pending = 0;
+    js.ack_tick = 0;
+    if ((js.json_verbosity == JV_EXCEPTIONS) || (js.json_verbosity == JV_ACK)) {
         js.echo_json_footer = true;
         js.echo_json_messages = true;
         js.echo_json_configs = true;
@@ -679,6 +909,14 @@ stat_t js_set_jv(nvObj_t *nv)
     return(STAT_OK);
 }
 
+/*
+ * js_get_jab() - get the most gcode lines covered by one ack in JV_ACK mode
+ * js_set_jab() - set it
+ */
+
+stat_t js_get_jab(nvObj_t *nv) { return(get_integer(nv, js.ack_batch)); }
+stat_t js_set_jab(nvObj_t *nv) { return(set_integer(nv, js.ack_batch, 1, JSON_ACK_BATCH_MAX)); }
+
 /*
  * json_set_ej() - set JSON communications mode
  */
@@ -714,16 +952,19 @@ stat_t json_set_ej(nvObj_t *nv)
  * js_print_jv()
  * js_print_js()
  * js_print_jf()
+ * js_print_jab()
  */
 
 static const char fmt_ej[] = "[ej]  enable json mode%13d [0=text,1=JSON,2=auto]\n";
-static const char fmt_jv[] = "[jv]  json verbosity%15d [0=silent,1=footer,2=messages,3=configs,4=linenum,5=verbose]\n";
+static const char fmt_jv[] = "[jv]  json verbosity%15d [0=silent,1=footer,2=messages,3=configs,4=linenum,5=verbose,9=ack]\n";
 static const char fmt_js[] = "[js]  json serialize style%9d [0=relaxed,1=strict]\n";
 static const char fmt_jf[] = "[jf]  json footer style%12d [1=checksum,2=window report]\n";
+static const char fmt_jab[] = "[jab] json ack batch%15d lines\n";
 
 void js_print_ej(nvObj_t *nv) { text_print(nv, fmt_ej);}    // TYPE_INT
 void js_print_jv(nvObj_t *nv) { text_print(nv, fmt_jv);}    // TYPE_INT
 void js_print_js(nvObj_t *nv) { text_print(nv, fmt_js);}    // TYPE_INT
 void js_print_jf(nvObj_t *nv) { text_print(nv, fmt_jf);}    // TYPE_INT
+void js_print_jab(nvObj_t *nv) { text_print(nv, fmt_jab);}  // TYPE_INT
 
 #endif // __TEXT_MODE
@@ -40,6 +40,8 @@
 #define JSON_INPUT_STRING_MAX 512   // set an arbitrary max
 #define JSON_OUTPUT_STRING_MAX (OUTPUT_BUFFER_LEN)
 #define MAX_PAD_CHARS 8             // JSON whitespace padding allowable
+#define JSON_OUTPUT_CHUNK 64        // json_stream() writes the response out in chunks of this size
+#define JSON_NUMBER_MAX 24          // room needed to print any number or 0x data value
 
 typedef enum {
     JV_SILENT = 0,                  // [0] no response is provided for any command
@@ -50,9 +52,13 @@ typedef enum {
     JV_VERBOSE,                     // [5] returns footer, messages, config commands, gcode blocks
     JV_EXCEPTIONS,                  // [6] returns only on messages, configs, and non-zero status
     JV_STATUS,                      // [7] returns status and any messages in abbreviated format
-    JV_STATUS_COUNT                 // [8] returns status, count and messages in abbreviated format
+    JV_STATUS_COUNT,                // [8] returns status, count and messages in abbreviated format
+    JV_ACK                          // [9] as JV_EXCEPTIONS, but gcode lines get cumulative {"ak":} acks
 } jsonVerbosity;
-#define JV_MAX_VALUE JV_STATUS_COUNT
+#define JV_MAX_VALUE JV_ACK
+
+#define JSON_ACK_BATCH_MAX 32       // most gcode lines {jab:} lets one ack cover
+#define JSON_ACK_MS 2               // longest an ack is held back waiting for more lines
 
 typedef enum {                      // json output print modes
     JSON_NO_PRINT = 0,              // don't print anything if you find yourself in JSON mode
@@ -71,8 +77,13 @@ typedef struct jsSingleton {
     bool echo_json_configs;
     bool echo_json_linenum;
     bool echo_json_gcode_block;
+    uint8_t ack_batch;              // most gcode lines covered by one ack in JV_ACK mode
 
     /*** runtime values (PRIVATE) ***/
+    uint8_t ack_pending;            // gcode lines accepted since the last ack
+    uint32_t ack_linenum;           // line number of the last one
+    uint32_t ack_tick;              // time of the first line since the last ack (or of the last ack)
+    uint8_t ack_credits;            // planner credits sent in the last ack
 
 } jsSingleton_t;
 
@@ -85,6 +96,8 @@ extern jsSingleton_t js;
 stat_t json_parser(char *str, bool suppress_response = false);
 void json_parse_for_exec(char *str, bool execute);
 uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size);
+uint16_t json_stream(nvObj_t *nv, const bool only_to_muted = false);
+stat_t json_ack_callback(void);
 void json_print_object(nvObj_t *nv);
 void json_print_response(uint8_t status, const bool only_to_muted = false);
 void json_print_list(stat_t status, uint8_t flags);
@@ -93,6 +106,8 @@ stat_t js_get_ej(nvObj_t *nv);
 stat_t js_set_ej(nvObj_t *nv);
 stat_t js_get_jv(nvObj_t *nv);
 stat_t js_set_jv(nvObj_t *nv);
+stat_t js_get_jab(nvObj_t *nv);
+stat_t js_set_jab(nvObj_t *nv);
 
 #ifdef __TEXT_MODE
 
@@ -100,6 +115,7 @@ stat_t js_set_jv(nvObj_t *nv);
     void js_print_jv(nvObj_t *nv);
     void js_print_js(nvObj_t *nv);
     void js_print_jf(nvObj_t *nv);
+    void js_print_jab(nvObj_t *nv);
 
 #else
 
@@ -107,6 +123,7 @@ stat_t js_set_jv(nvObj_t *nv);
     #define js_print_jv tx_print_stub
     #define js_print_js tx_print_stub
     #define js_print_jf tx_print_stub
+    #define js_print_jab tx_print_stub
 
 #endif // __TEXT_MODE
 
@@ -29,11 +29,120 @@
 #include "g2core.h"
 #include "config.h"
 #include "canonical_machine.h"
+#include "planner.h"
 #include "stepper.h"
 #include "kinematics.h"
+#include "profiler.h"
+#include "text_parser.h"
 #include "util.h"
 
-static void _inverse_kinematics(const float travel[], float joint[]);
+static void _cartesian_inverse(const float travel[], float joint[]);
+static void _cartesian_forward(const float joint[], float travel[]);
+static void _corexy_inverse(const float travel[], float joint[]);
+static void _corexy_forward(const float joint[], float travel[]);
+static void _delta_inverse(const float travel[], float joint[]);
+static void _delta_forward(const float joint[], float travel[]);
+static void _scara_inverse(const float travel[], float joint[]);
+static void _scara_forward(const float joint[], float travel[]);
+static void _table_table_inverse(const float travel[], float joint[]);
+static void _table_table_forward(const float joint[], float travel[]);
+static void _head_table_inverse(const float travel[], float joint[]);
+static void _head_table_forward(const float joint[], float travel[]);
+
+static const knKinematics_t kinematics[] = {    // indexed by knKinematicsType
+    { _cartesian_inverse, _cartesian_forward },
+    { _corexy_inverse,    _corexy_forward },
+    { _delta_inverse,     _delta_forward },
+    { _scara_inverse,     _scara_forward },
+    { _table_table_inverse, _table_table_forward },
+    { _head_table_inverse,  _head_table_forward }
+};
+
+knConfig_t kn = { KINEMATICS_CARTESIAN, &kinematics[KINEMATICS_CARTESIAN] };  // usable before config_init()
+
+static struct knForwardCache {              // last forward kinematics solution
+    bool valid;                             // cleared by any kinematics or motor map change
+    float steps[MOTORS];                    // input it was solved for
+    float travel[AXES];                     // result
+} fk;
+
+/*
+ * _height_map_offset() - bilinear Z offset of the height map at a machine XY
+ *
+ *	Positions outside the grid are clamped to its edge. A single row or column grid
+ *	degenerates to linear interpolation along the other direction.
+ */
+
+static float _height_map_offset(const float x, const float y) {
+    const knHeightMap_t *hm = &kn.hmap;
+    uint8_t last_x = hm->nx - 1;
+    uint8_t last_y = hm->ny - 1;
+
+    float fx = std::min(std::max((x - hm->x_min) * hm->recip_pitch, 0.0f), (float)last_x);
+    float fy = std::min(std::max((y - hm->y_min) * hm->recip_pitch, 0.0f), (float)last_y);
+    uint8_t i = std::min((uint8_t)fx, (uint8_t)(last_x ? last_x - 1 : 0));
+    uint8_t j = std::min((uint8_t)fy, (uint8_t)(last_y ? last_y - 1 : 0));
+    uint8_t i1 = last_x ? i + 1 : i;
+    uint8_t j1 = last_y ? j + 1 : j;
+    float tx = fx - i;
+    float ty = fy - j;
+
+    float z0 = hm->z[j][i]  + tx * (hm->z[j][i1]  - hm->z[j][i]);
+    float z1 = hm->z[j1][i] + tx * (hm->z[j1][i1] - hm->z[j1][i]);
+    return (z0 + ty * (z1 - z0));
+}
+
+/*
+ * kn_config_changed() - rebuild the motor map after a mapping or resolution change
+ *
+ *	Called by any setting that changes motor_map, steps_per_unit or axis_mode ($1ma, $1sa,
+ *	$1tr, $1mi, $1su, $xam), or the axis backlash ($xbl). Each motor gets the joint it follows
+ *	and its conversion in both directions, so neither kinematics direction has to scan axes
+ *	against motors, and its backlash in steps.
+ *
+ *	For forward kinematics only the best resolution motors on each joint contribute, and
+ *	motors with equal best resolution are averaged by splitting units_per_step between them.
+ */
+
+void kn_config_changed() {
+    float best_steps_per_unit[AXES];
+
+    fk.valid = false;
+    uint8_t best_count[AXES];
+
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        best_steps_per_unit[axis] = -1.0;
+        best_count[axis]          = 0;
+    }
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        knMotorMap_t *map = &kn.mot[motor];
+        uint8_t axis = st_cfg.mot[motor].motor_map;
+
+        if ((axis >= AXES) || (cm->a[axis].axis_mode == AXIS_INHIBITED)) {
+            map->joint = -1;
+            st_cfg.mot[motor].backlash_steps = 0;
+            continue;
+        }
+        map->joint = axis;
+        map->steps_per_unit = st_cfg.mot[motor].steps_per_unit;
+        st_cfg.mot[motor].backlash_steps = cm->a[axis].backlash * map->steps_per_unit;
+
+        if (best_steps_per_unit[axis] < map->steps_per_unit) {
+            best_steps_per_unit[axis] = map->steps_per_unit;
+            best_count[axis] = 1;
+        } else if (fp_EQ(best_steps_per_unit[axis], map->steps_per_unit)) {
+            best_count[axis]++;
+        }
+    }
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        knMotorMap_t *map = &kn.mot[motor];
+        if ((map->joint >= 0) && fp_EQ(best_steps_per_unit[map->joint], map->steps_per_unit)) {
+            map->units_per_step = st_cfg.mot[motor].units_per_step / best_count[map->joint];
+        } else {
+            map->units_per_step = 0;
+        }
+    }
+}
 
 /*
  * kn_kinematics() - wrapper routine for inverse kinematics
@@ -45,117 +154,556 @@ static void _inverse_kinematics(const float travel[], float joint[]);
  *	fractional DDA steps. The DDA deals with fractional step values as fixed-point binary in
  *	order to get the smoothest possible operation. Steps are passed to the move prep routine
  *	as floats and converted to fixed-point binary during queue loading. See stepper.c for details.
+ *
+ *	The inverse transform is run during the _exec() portion of the cycle and is therefore
+ *	run once per interpolation segment. The total time for the segment load, including the
+ *	inverse kinematics transformation, cannot exceed the segment time and ideally should be
+ *	no more than SEGMENT_EXEC_BUDGET of it (see planner.h). The worst case exec time is
+ *	reported as {segx:} and the transform alone as {profki:} in a __PROFILER build.
+ *	Cartesian and CoreXY are a few adds; delta is 3 square roots and SCARA is a square root
+ *	and 3 arctangents, which on a SAM3X without an FPU is in the tens of microseconds.
+ *
+ *	Motors that are unmapped or on an inhibited axis are left untouched.
+ *
+ *	The height map (if on) is applied here rather than in the planner so every segment, and
+ *	every resync of the steps to the runtime position, sees the same compensated surface.
  */
 
 void kn_inverse_kinematics(const float travel[], float steps[]) {
     float joint[AXES];
 
-    _inverse_kinematics(travel, joint);  // insert inverse kinematics transformations here
-
-// We'll time-test each and see if unrolling is worth it.
-#if 0
-    // Map motors to axes and convert length units to steps
-    // Most of the conversion math has already been done in during config in steps_per_unit()
-    // which takes axis travel, step angle and microsteps into account.
-    for (uint8_t axis=0; axis<AXES; axis++) {
-        if (cm->a[axis].axis_mode == AXIS_INHIBITED) { joint[axis] = 0;}
-        if (st_cfg.mot[MOTOR_1].motor_map == axis) {
-            steps[MOTOR_1] = joint[axis] * st_cfg.mot[MOTOR_1].steps_per_unit;
-        }
-        if (st_cfg.mot[MOTOR_2].motor_map == axis) {
-            steps[MOTOR_2] = joint[axis] * st_cfg.mot[MOTOR_2].steps_per_unit;
-        }
-        if (st_cfg.mot[MOTOR_3].motor_map == axis) {
-            steps[MOTOR_3] = joint[axis] * st_cfg.mot[MOTOR_3].steps_per_unit;
-        }
-        if (st_cfg.mot[MOTOR_4].motor_map == axis) {
-            steps[MOTOR_4] = joint[axis] * st_cfg.mot[MOTOR_4].steps_per_unit;
-        }
-#if (MOTORS >= 5)
-        if (st_cfg.mot[MOTOR_5].motor_map == axis) {
-            steps[MOTOR_5] = joint[axis] * st_cfg.mot[MOTOR_5].steps_per_unit;
-        }
-#endif
-#if (MOTORS >= 6)
-        if (st_cfg.mot[MOTOR_6].motor_map == axis) {
-            steps[MOTOR_6] = joint[axis] * st_cfg.mot[MOTOR_6].steps_per_unit;
+    PROF_BEGIN(_start);
+    if (kn.hmap.enable) {
+        float surface[AXES];
+        memcpy(surface, travel, sizeof(surface));
+        surface[AXIS_Z] += _height_map_offset(travel[AXIS_X], travel[AXIS_Y]);
+        kn.kin->inverse(surface, joint);
+    } else {
+        kn.kin->inverse(travel, joint); // Cartesian travel to joint space
+    }
+    PROF_END(_start, PROF_KIN_INVERSE);
+
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        const knMotorMap_t *map = &kn.mot[motor];
+        if (map->joint >= 0) {
+            steps[motor] = joint[map->joint] * map->steps_per_unit;
         }
-#endif
     }
+}
 
-#else
+/*
+ * kn_forward_kinematics() - forward kinematics
+ *
+ *	Converts steps to joint positions using the best resolution motor(s) for each joint,
+ *	then runs the forward transform of the selected kinematics.
+ *
+ *	The last solution is cached against its step vector, so repeated queries of the same
+ *	snapshot (e.g. reading a probe or homing contact once per axis) only solve once.
+ */
+
+void kn_forward_kinematics(const float steps[], float travel[]) {
+    float joint[AXES];
+
+    if (fk.valid && (memcmp(fk.steps, steps, sizeof(fk.steps)) == 0)) {
+        memcpy(travel, fk.travel, sizeof(fk.travel));
+        return;
+    }
 
     for (uint8_t axis = 0; axis < AXES; axis++) {
-        if (cm->a[axis].axis_mode == AXIS_INHIBITED) {
-            joint[axis] = 0;
-            continue;
-        }
-        for (uint8_t motor = 0; motor < MOTORS; motor++) {
-            if (st_cfg.mot[motor].motor_map == axis) {
-                steps[motor] = joint[axis] * st_cfg.mot[motor].steps_per_unit;
-            }
+        joint[axis] = 0.0;
+    }
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        const knMotorMap_t *map = &kn.mot[motor];
+        if (map->joint >= 0) {
+            joint[map->joint] += steps[motor] * map->units_per_step;
         }
     }
-#endif
+    PROF_BEGIN(_start);
+    kn.kin->forward(joint, travel);     // joint space to Cartesian travel
+    if (kn.hmap.enable) {
+        travel[AXIS_Z] -= _height_map_offset(travel[AXIS_X], travel[AXIS_Y]);
+    }
+    PROF_END(_start, PROF_KIN_FORWARD);
+
+    memcpy(fk.steps, steps, sizeof(fk.steps));
+    memcpy(fk.travel, travel, sizeof(fk.travel));
+    fk.valid = true;
 }
 
 /*
- * _inverse_kinematics() - inverse kinematics - example is for a cartesian machine
- *
- *	You can glue in inverse kinematics here, but be aware of time budget constraints.
- *	This function is run during the _exec() portion of the cycle and will therefore
- *	be run once per interpolation segment. The total time for the segment load,
- *	including the inverse kinematics transformation cannot exceed the segment time,
- *	and ideally should be no more than 25-50% of the segment time. Currently segments
- *	run every 1.5 ms, but this might be lowered. To profile this time look at the
- *	time it takes to complete the mp_exec_move() function.
+ * _cartesian_inverse() - joints are the axes
+ * _cartesian_forward()
  *
- *	Note: the compiler will  inline trivial functions (like memcpy) so there is no
+ *	Note: the compiler will inline trivial functions (like memcpy) so there is no
  *	size or performance penalty for breaking this out
  */
-static void _inverse_kinematics(const float travel[], float joint[]) {
+
+static void _cartesian_inverse(const float travel[], float joint[]) {
     memcpy(joint, travel, sizeof(float) * AXES);  // just do a memcpy for Cartesian machines
+}
+
+static void _cartesian_forward(const float joint[], float travel[]) {
+    memcpy(travel, joint, sizeof(float) * AXES);
+}
+
+/*
+ * _corexy_inverse() - A = X+Y, B = X-Y
+ * _corexy_forward() - X = (A+B)/2, Y = (A-B)/2
+ */
+
+static void _corexy_inverse(const float travel[], float joint[]) {
+    memcpy(joint, travel, sizeof(float) * AXES);
+    joint[AXIS_X] = travel[AXIS_X] + travel[AXIS_Y];
+    joint[AXIS_Y] = travel[AXIS_X] - travel[AXIS_Y];
+}
+
+static void _corexy_forward(const float joint[], float travel[]) {
+    memcpy(travel, joint, sizeof(float) * AXES);
+    travel[AXIS_X] = (joint[AXIS_X] + joint[AXIS_Y]) * 0.5;
+    travel[AXIS_Y] = (joint[AXIS_X] - joint[AXIS_Y]) * 0.5;
+}
 
-    //	for (uint8_t i=0; i<AXES; i++) {
-    //		joint[i] = travel[i];
-    //	}
+/*
+ * _delta_inverse() - carriage heights for an effector position
+ *
+ *	Each carriage sits rod_length away from its effector joint, so its height above the
+ *	effector is sqrt(rod_length^2 - horizontal distance^2). Positions out of reach of a rod
+ *	are clamped to the rod lying flat - keeping moves inside the build envelope is the job
+ *	of the travel limits.
+ */
+
+static void _delta_inverse(const float travel[], float joint[]) {
+    memcpy(joint, travel, sizeof(float) * AXES);
+    for (uint8_t tower = 0; tower < 3; tower++) {
+        float dx = kn.delta_tower_x[tower] - travel[AXIS_X];
+        float dy = kn.delta_tower_y[tower] - travel[AXIS_Y];
+        float h2 = kn.delta_rod_length_sq - (dx*dx) - (dy*dy);
+        joint[AXIS_X + tower] = travel[AXIS_Z] + ((h2 > 0) ? sqrtf(h2) : 0);
+    }
 }
 
 /*
- * kn_forward_kinematics() - forward kinematics for a cartesian machine
+ * _delta_forward() - effector position for a set of carriage heights
  *
- * This is designed for PRECISION, not PERFORMANCE!
+ *	Trilateration: the effector is the lower intersection of three spheres of rod_length
+ *	radius centered on the carriages. Works in a frame with tower A at the origin, B on the
+ *	x axis and C in the xy plane, then transforms back.
+ */
+
+static void _delta_forward(const float joint[], float travel[]) {
+    memcpy(travel, joint, sizeof(float) * AXES);
+
+    float p1[3] = { kn.delta_tower_x[0], kn.delta_tower_y[0], joint[AXIS_X] };
+    float p12[3] = { kn.delta_tower_x[1] - p1[0], kn.delta_tower_y[1] - p1[1], joint[AXIS_Y] - p1[2] };
+    float p13[3] = { kn.delta_tower_x[2] - p1[0], kn.delta_tower_y[2] - p1[1], joint[AXIS_Z] - p1[2] };
+
+    float d = sqrtf(square(p12[0]) + square(p12[1]) + square(p12[2]));
+    float ex[3] = { p12[0]/d, p12[1]/d, p12[2]/d };                 // unit vector tower A to B
+    float i = (ex[0]*p13[0]) + (ex[1]*p13[1]) + (ex[2]*p13[2]);    // C's component along ex
+    float ey[3] = { p13[0] - i*ex[0], p13[1] - i*ex[1], p13[2] - i*ex[2] };
+    float j = sqrtf(square(ey[0]) + square(ey[1]) + square(ey[2]));
+    ey[0] /= j; ey[1] /= j; ey[2] /= j;                             // unit vector towards C, normal to ex
+    float ez[3] = { (ex[1]*ey[2]) - (ex[2]*ey[1]),                  // ex cross ey
+                    (ex[2]*ey[0]) - (ex[0]*ey[2]),
+                    (ex[0]*ey[1]) - (ex[1]*ey[0]) };
+
+    // all three radii are equal, so this is simpler than the general case
+    float x = d * 0.5;
+    float y = (((i*i) + (j*j)) * 0.5 - (i*x)) / j;
+    float z2 = kn.delta_rod_length_sq - (x*x) - (y*y);
+    float z = (z2 > 0) ? sqrtf(z2) : 0;
+
+    travel[AXIS_X] = p1[0] + (ex[0]*x) + (ey[0]*y) - (ez[0]*z);
+    travel[AXIS_Y] = p1[1] + (ex[1]*x) + (ey[1]*y) - (ez[1]*z);
+    travel[AXIS_Z] = p1[2] + (ex[2]*x) + (ey[2]*y) - (ez[2]*z);
+}
+
+/*
+ * _scara_inverse() - shoulder and elbow angles for an XY position
  *
- * This function is NOT to be used where high-speed is important. If that becomes the case,
- * there are many opportunities for caching and optimization for performance here.
+ *	Shoulder is at the XY origin. Uses the right-handed (elbow counter-clockwise) solution.
+ *	Positions out of reach are clamped to the arm fully extended or folded. The shoulder
+ *	angle is in (-180, 180], so the work area should not cross the negative X axis.
  */
 
-void kn_forward_kinematics(const float steps[], float travel[]) {
-    float best_steps_per_unit[AXES];
+static void _scara_inverse(const float travel[], float joint[]) {
+    memcpy(joint, travel, sizeof(float) * AXES);
+    float x = travel[AXIS_X];
+    float y = travel[AXIS_Y];
+
+    float c2 = ((x*x) + (y*y) - kn.scara_link_sum_sq) * kn.scara_link_recip;
+    c2 = std::min(std::max(c2, -1.0f), 1.0f);
+    float s2 = sqrtf(1 - (c2*c2));
+
+    joint[AXIS_X] = (atan2f(y, x) - atan2f(kn.scara_link2 * s2, kn.scara_link1 + (kn.scara_link2 * c2))) * RADIAN;
+    joint[AXIS_Y] = atan2f(s2, c2) * RADIAN;
+}
+
+static void _scara_forward(const float joint[], float travel[]) {
+    memcpy(travel, joint, sizeof(float) * AXES);
+    float shoulder = joint[AXIS_X] / RADIAN;
+    float elbow = shoulder + (joint[AXIS_Y] / RADIAN);
+    travel[AXIS_X] = (kn.scara_link1 * cosf(shoulder)) + (kn.scara_link2 * cosf(elbow));
+    travel[AXIS_Y] = (kn.scara_link1 * sinf(shoulder)) + (kn.scara_link2 * sinf(elbow));
+}
+
+/*
+ * _rotate_x() - rotate a vector about X, Y or Z by an angle in degrees
+ * _rotate_y()
+ * _rotate_z()
+ */
+
+static void _rotate_x(float v[], const float degrees) {
+    float c = cosf(degrees / RADIAN);
+    float s = sinf(degrees / RADIAN);
+    float y = v[1];
+    v[1] = (c * y) - (s * v[2]);
+    v[2] = (s * y) + (c * v[2]);
+}
+
+static void _rotate_y(float v[], const float degrees) {
+    float c = cosf(degrees / RADIAN);
+    float s = sinf(degrees / RADIAN);
+    float x = v[0];
+    v[0] = (c * x) + (s * v[2]);
+    v[2] = (c * v[2]) - (s * x);
+}
+
+static void _rotate_z(float v[], const float degrees) {
+    float c = cosf(degrees / RADIAN);
+    float s = sinf(degrees / RADIAN);
+    float x = v[0];
+    v[0] = (c * x) - (s * v[1]);
+    v[1] = (s * x) + (c * v[1]);
+}
+
+/*
+ * _table_table_inverse() - linear joints that put the tool tip on a point of the part
+ * _table_table_forward()
+ *
+ *	The tip is the travel less the tool length. The part is turned by C then tilted by A
+ *	about the pivot, and the tool length is added back, as it doesn't turn with the part.
+ */
+
+static void _table_table_inverse(const float travel[], float joint[]) {
+    memcpy(joint, travel, sizeof(float) * AXES);
+    float tool = cm->tool_offset[AXIS_Z];
+    float v[3] = { travel[AXIS_X] - kn.pivot[0], travel[AXIS_Y] - kn.pivot[1], travel[AXIS_Z] - tool - kn.pivot[2] };
+    _rotate_z(v, travel[AXIS_C]);
+    _rotate_x(v, travel[AXIS_A]);
+    joint[AXIS_X] = v[0] + kn.pivot[0];
+    joint[AXIS_Y] = v[1] + kn.pivot[1];
+    joint[AXIS_Z] = v[2] + kn.pivot[2] + tool;
+}
+
+static void _table_table_forward(const float joint[], float travel[]) {
+    memcpy(travel, joint, sizeof(float) * AXES);
+    float tool = cm->tool_offset[AXIS_Z];
+    float v[3] = { joint[AXIS_X] - kn.pivot[0], joint[AXIS_Y] - kn.pivot[1], joint[AXIS_Z] - tool - kn.pivot[2] };
+    _rotate_x(v, -joint[AXIS_A]);
+    _rotate_z(v, -joint[AXIS_C]);
+    travel[AXIS_X] = v[0] + kn.pivot[0];
+    travel[AXIS_Y] = v[1] + kn.pivot[1];
+    travel[AXIS_Z] = v[2] + kn.pivot[2] + tool;
+}
+
+/*
+ * _head_table_inverse() - linear joints that put the tool tip on a point of the part
+ * _head_table_forward()
+ *
+ *	The table turns the tip by C about the pivot's XY. The joints are where the spindle
+ *	gauge line would be with the head at B0, which is the tip plus the pivot to tip length
+ *	along the tilted tool axis, less the head length along Z. At B0 that is the travel.
+ */
+
+static void _head_table_inverse(const float travel[], float joint[]) {
+    memcpy(joint, travel, sizeof(float) * AXES);
+    float tool = cm->tool_offset[AXIS_Z];
+    float length = kn.head_length + tool;
+    float v[3] = { travel[AXIS_X] - kn.pivot[0], travel[AXIS_Y] - kn.pivot[1], travel[AXIS_Z] - tool };
+    _rotate_z(v, travel[AXIS_C]);
+    float axis[3] = { 0, 0, length };                   // tip to head pivot
+    _rotate_y(axis, travel[AXIS_B]);
+    joint[AXIS_X] = v[0] + kn.pivot[0] + axis[0];
+    joint[AXIS_Y] = v[1] + kn.pivot[1] + axis[1];
+    joint[AXIS_Z] = v[2] + axis[2] - kn.head_length;
+}
+
+static void _head_table_forward(const float joint[], float travel[]) {
+    memcpy(travel, joint, sizeof(float) * AXES);
+    float tool = cm->tool_offset[AXIS_Z];
+    float length = kn.head_length + tool;
+    float axis[3] = { 0, 0, length };
+    _rotate_y(axis, joint[AXIS_B]);
+    float v[3] = { joint[AXIS_X] - axis[0] - kn.pivot[0],
+                   joint[AXIS_Y] - axis[1] - kn.pivot[1],
+                   joint[AXIS_Z] - axis[2] + kn.head_length };
+    _rotate_z(v, -joint[AXIS_C]);
+    travel[AXIS_X] = v[0] + kn.pivot[0];
+    travel[AXIS_Y] = v[1] + kn.pivot[1];
+    travel[AXIS_Z] = v[2] + tool;
+}
+
+/*
+ * kn_is_tool_center_point() - true if the kinematics is one of the 5-axis transforms
+ * kn_joint_travel()          - distance each joint travels on a straight move
+ * kn_is_sub_step()           - true if no motor moves a whole step between start and end
+ *
+ *	A straight move of the tool tip is a curve in joint space when the rotaries move. The
+ *	joint travel is measured from the start through the midpoint to the end, which is
+ *	close enough for the segment-sized rotations of CAM output and is never short of the
+ *	chord. Used by the planner to hold a block to the joint limits.
+ */
+
+bool kn_is_tool_center_point() {
+    return ((kn.type == KINEMATICS_TABLE_TABLE) || (kn.type == KINEMATICS_HEAD_TABLE));
+}
+
+void kn_joint_travel(const float start[], const float end[], float joint_length[]) {
+    float middle[AXES];
+    float j0[AXES], j1[AXES], j2[AXES];
 
-    // Setup
     for (uint8_t axis = 0; axis < AXES; axis++) {
-        travel[axis]              = 0.0;
-        best_steps_per_unit[axis] = -1.0;
+        middle[axis] = (start[axis] + end[axis]) * 0.5;
     }
-
-    // Scan through each axis then through each motor
+    kn.kin->inverse(start, j0);
+    kn.kin->inverse(middle, j1);
+    kn.kin->inverse(end, j2);
     for (uint8_t axis = 0; axis < AXES; axis++) {
-        if (cm->a[axis].axis_mode == AXIS_INHIBITED) {
-            travel[axis] = 0.0;
+        joint_length[axis] = fabs(j1[axis] - j0[axis]) + fabs(j2[axis] - j1[axis]);
+    }
+}
+
+/*
+ *	kn_is_sub_step() compares the joint positions of the ends, without the height map, whose
+ *	offset changes by far less than a step over a sub-step move. Axes with no motor don't count.
+ */
+
+bool kn_is_sub_step(const float start[], const float end[]) {
+    float j0[AXES], j1[AXES];
+
+    kn.kin->inverse(start, j0);
+    kn.kin->inverse(end, j1);
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        const knMotorMap_t *map = &kn.mot[motor];
+        if ((map->joint >= 0) && (fabs(j1[map->joint] - j0[map->joint]) * map->steps_per_unit >= 1.0)) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+/*
+ * kn_chord_deviation() - joint space deviation of a straight line as one chord, in steps
+ *
+ *	The chord of a curve over a span s deviates from it by about |j''| s^2 / 8, so the
+ *	curvature is taken from second differences of the inverse transform at the quarter points
+ *	of the line: the midpoint against the whole chord, and the midpoint of each half against
+ *	its half chord, times 4 to scale it to the whole line. The largest for any motor is the
+ *	estimate, so a chord of a fraction f of the line deviates by about f^2 times it. Using the
+ *	halves as well catches a line that swings through a tight spot (e.g. past a SCARA's
+ *	shoulder) that the whole chord alone averages out. Linear kinematics return 0.
+ */
+
+float kn_chord_deviation(const float start[], const float end[]) {
+    if ((kn.type == KINEMATICS_CARTESIAN) || (kn.type == KINEMATICS_COREXY)) {
+        return (0);
+    }
+    float point[AXES];
+    float j[5][AXES];
+
+    for (uint8_t i = 0; i < 5; i++) {
+        for (uint8_t axis = 0; axis < AXES; axis++) {
+            point[axis] = start[axis] + (end[axis] - start[axis]) * (i * 0.25);
+        }
+        kn.kin->inverse(point, j[i]);
+    }
+    float deviation = 0;
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        const knMotorMap_t *map = &kn.mot[motor];
+        if (map->joint < 0) {
             continue;
         }
-        for (uint8_t motor = 0; motor < MOTORS; motor++) {
-            if (st_cfg.mot[motor].motor_map == axis) {
-                // If this motor has a better (or the only) resolution, then use this motor's value
-                if (best_steps_per_unit[axis] < st_cfg.mot[motor].steps_per_unit) {
-                    best_steps_per_unit[axis] = st_cfg.mot[motor].steps_per_unit;
-                    travel[axis]              = steps[motor] * st_cfg.mot[motor].units_per_step;
-                } // If a second motor has the same resolution for the same axis average their values
-                else if (fp_EQ(best_steps_per_unit[axis], st_cfg.mot[motor].steps_per_unit)) {
-                    travel[axis] = (travel[axis] + (steps[motor] * st_cfg.mot[motor].units_per_step)) / 2.0;
-                }
+        const uint8_t a = map->joint;
+        float d = max3(fabs(j[2][a] - (j[0][a] + j[4][a]) * 0.5),
+                       fabs(j[1][a] - (j[0][a] + j[2][a]) * 0.5) * 4,
+                       fabs(j[3][a] - (j[2][a] + j[4][a]) * 0.5) * 4);
+        deviation = max(deviation, d * map->steps_per_unit);
+    }
+    return (deviation);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * _update_derived() - recompute geometry that depends on the kinematics settings
+ *
+ *	Towers A, B and C are at 210, 330 and 90 degrees around the center of the bed.
+ */
+
+static void _update_derived() {
+    kn.kin = &kinematics[kn.type];
+    fk.valid = false;
+
+    kn.delta_rod_length_sq = square(kn.delta_rod_length);
+    kn.delta_tower_x[0] = -0.866025404 * kn.delta_radius;
+    kn.delta_tower_y[0] = -0.5 * kn.delta_radius;
+    kn.delta_tower_x[1] =  0.866025404 * kn.delta_radius;
+    kn.delta_tower_y[1] = -0.5 * kn.delta_radius;
+    kn.delta_tower_x[2] =  0;
+    kn.delta_tower_y[2] =  kn.delta_radius;
+
+    kn.scara_link_sum_sq = square(kn.scara_link1) + square(kn.scara_link2);
+    kn.scara_link_recip = 1 / (2 * kn.scara_link1 * kn.scara_link2);
+}
+
+/*
+ * _set_geometry() - set a kinematics length and recompute the derived values
+ *
+ *	Only allowed outside a cycle. Steps are resynced to the current position afterwards,
+ *	as the same position is now a different set of joint positions. Lengths must be
+ *	positive; the 5-axis pivot may be anywhere.
+ */
+
+static stat_t _set_geometry(nvObj_t *nv, float &value, const float min_value = EPSILON)
+{
+    if (cm_get_machine_state() == MACHINE_CYCLE) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    ritorno(set_float_range(nv, value, min_value, 100000));
+    _update_derived();
+    mp_set_steps_to_runtime_position();
+    return (STAT_OK);
+}
+
+stat_t kn_get_kin(nvObj_t *nv) { return (get_integer(nv, kn.type)); }
+stat_t kn_set_kin(nvObj_t *nv)
+{
+    if (cm_get_machine_state() == MACHINE_CYCLE) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    uint8_t type = kn.type;
+    ritorno(set_integer(nv, type, KINEMATICS_CARTESIAN, KINEMATICS_MAX));
+    kn.type = (knKinematicsType)type;
+    _update_derived();
+    mp_set_steps_to_runtime_position();
+    return (STAT_OK);
+}
+
+stat_t kn_get_kdl(nvObj_t *nv) { return (get_float(nv, kn.delta_rod_length)); }
+stat_t kn_set_kdl(nvObj_t *nv) { return (_set_geometry(nv, kn.delta_rod_length)); }
+stat_t kn_get_kdr(nvObj_t *nv) { return (get_float(nv, kn.delta_radius)); }
+stat_t kn_set_kdr(nvObj_t *nv) { return (_set_geometry(nv, kn.delta_radius)); }
+stat_t kn_get_ksl1(nvObj_t *nv) { return (get_float(nv, kn.scara_link1)); }
+stat_t kn_set_ksl1(nvObj_t *nv) { return (_set_geometry(nv, kn.scara_link1)); }
+stat_t kn_get_ksl2(nvObj_t *nv) { return (get_float(nv, kn.scara_link2)); }
+stat_t kn_set_ksl2(nvObj_t *nv) { return (_set_geometry(nv, kn.scara_link2)); }
+stat_t kn_get_ktpx(nvObj_t *nv) { return (get_float(nv, kn.pivot[0])); }
+stat_t kn_set_ktpx(nvObj_t *nv) { return (_set_geometry(nv, kn.pivot[0], -100000)); }
+stat_t kn_get_ktpy(nvObj_t *nv) { return (get_float(nv, kn.pivot[1])); }
+stat_t kn_set_ktpy(nvObj_t *nv) { return (_set_geometry(nv, kn.pivot[1], -100000)); }
+stat_t kn_get_ktpz(nvObj_t *nv) { return (get_float(nv, kn.pivot[2])); }
+stat_t kn_set_ktpz(nvObj_t *nv) { return (_set_geometry(nv, kn.pivot[2], -100000)); }
+stat_t kn_get_khl(nvObj_t *nv)  { return (get_float(nv, kn.head_length)); }
+stat_t kn_set_khl(nvObj_t *nv)  { return (_set_geometry(nv, kn.head_length, 0)); }
+
+/*
+ * kn_get_ktol() - segment chord tolerance in steps
+ * kn_set_ktol() - takes effect from the next line queued (see _calculate_chord_deviation())
+ */
+
+stat_t kn_get_ktol(nvObj_t *nv) { return (get_float(nv, kn.segment_tolerance)); }
+stat_t kn_set_ktol(nvObj_t *nv) { return (set_float_range(nv, kn.segment_tolerance, 0, 1000)); }
+
+/*
+ * kn_get_hmap() - height map on or off
+ * kn_set_hmap() - 1 loads the last probing grid and turns the map on, 0 turns it off
+ *
+ *	Only allowed with the machine stopped. The physical Z is kept where it is, so the model
+ *	Z changes by the surface offset at the current XY instead of the motors moving.
+ */
+
+stat_t kn_get_hmap(nvObj_t *nv) { return (get_integer(nv, kn.hmap.enable)); }
+stat_t kn_set_hmap(nvObj_t *nv)
+{
+    if ((cm_get_machine_state() == MACHINE_CYCLE) || !mp_runtime_is_idle()) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    uint8_t enable = kn.hmap.enable;
+    ritorno(set_integer(nv, enable, 0, 1));
+    if (enable && (probe_grid.state != PROBE_SUCCEEDED)) {
+        nv->valuetype = TYPE_NULL;
+        kn.hmap.enable = false;             // don't leave a stale map on
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+
+    float x = cm_get_absolute_position(ACTIVE_MODEL, AXIS_X);
+    float y = cm_get_absolute_position(ACTIVE_MODEL, AXIS_Y);
+    float z = cm_get_absolute_position(ACTIVE_MODEL, AXIS_Z);
+    if (kn.hmap.enable) {
+        z += _height_map_offset(x, y);      // Z of the surface actually under the tool
+    }
+    kn.hmap.enable = false;
+    if (enable) {
+        knHeightMap_t *hm = &kn.hmap;
+        hm->nx = probe_grid.nx;
+        hm->ny = probe_grid.ny;
+        hm->x_min = probe_grid.x_min;
+        hm->y_min = probe_grid.y_min;
+        hm->recip_pitch = 1 / probe_grid.pitch;
+        for (uint8_t row = 0; row < hm->ny; row++) {
+            for (uint8_t col = 0; col < hm->nx; col++) {
+                hm->z[row][col] = probe_grid.z[row][col] - probe_grid.z[0][0];
             }
         }
+        hm->enable = true;
+        z -= _height_map_offset(x, y);
     }
+    fk.valid = false;
+    cm_set_position_by_axis(AXIS_Z, z);
+    return (STAT_OK);
 }
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char msg_units0[] = " in";    // used by generic print functions
+static const char msg_units1[] = " mm";
+static const char msg_units2[] = " deg";
+static const char *const msg_units[] = { msg_units0, msg_units1, msg_units2 };
+
+static const char fmt_kin[] = "[kin] kinematics%24d [0=cartesian,1=corexy,2=delta,3=scara,4=table-table,5=head-table]\n";
+static const char fmt_kdl[] = "[kdl] delta diagonal rod length%13.3f%s\n";
+static const char fmt_kdr[] = "[kdr] delta radius%26.3f%s\n";
+static const char fmt_ksl1[] = "[ksl1] scara shoulder link length%10.3f%s\n";
+static const char fmt_ksl2[] = "[ksl2] scara elbow link length%13.3f%s\n";
+static const char fmt_ktpx[] = "[ktpx] 5-axis pivot X%22.3f%s\n";
+static const char fmt_ktpy[] = "[ktpy] 5-axis pivot Y%22.3f%s\n";
+static const char fmt_ktpz[] = "[ktpz] 5-axis pivot Z%22.3f%s\n";
+static const char fmt_khl[] = "[khl]  5-axis head pivot length%13.3f%s\n";
+static const char fmt_hmap[] = "[hmap] height map compensation%12d [0=off,1=load probe grid]\n";
+static const char fmt_ktol[] = "[ktol] segment chord tolerance%12.3f steps [0=fixed segments]\n";
+
+void kn_print_kin(nvObj_t *nv) { text_print(nv, fmt_kin);}     // TYPE_INT
+void kn_print_kdl(nvObj_t *nv) { text_print_flt_units(nv, fmt_kdl, GET_UNITS(ACTIVE_MODEL));}
+void kn_print_kdr(nvObj_t *nv) { text_print_flt_units(nv, fmt_kdr, GET_UNITS(ACTIVE_MODEL));}
+void kn_print_ksl1(nvObj_t *nv){ text_print_flt_units(nv, fmt_ksl1, GET_UNITS(ACTIVE_MODEL));}
+void kn_print_ksl2(nvObj_t *nv){ text_print_flt_units(nv, fmt_ksl2, GET_UNITS(ACTIVE_MODEL));}
+void kn_print_ktpx(nvObj_t *nv){ text_print_flt_units(nv, fmt_ktpx, GET_UNITS(ACTIVE_MODEL));}
+void kn_print_ktpy(nvObj_t *nv){ text_print_flt_units(nv, fmt_ktpy, GET_UNITS(ACTIVE_MODEL));}
+void kn_print_ktpz(nvObj_t *nv){ text_print_flt_units(nv, fmt_ktpz, GET_UNITS(ACTIVE_MODEL));}
+void kn_print_khl(nvObj_t *nv) { text_print_flt_units(nv, fmt_khl, GET_UNITS(ACTIVE_MODEL));}
+void kn_print_hmap(nvObj_t *nv){ text_print(nv, fmt_hmap);}     // TYPE_INT
+void kn_print_ktol(nvObj_t *nv){ text_print(nv, fmt_ktol);}     // TYPE_FLOAT
+
+#endif // __TEXT_MODE
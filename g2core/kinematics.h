@@ -28,11 +28,191 @@
 #ifndef KINEMATICS_H_ONCE
 #define KINEMATICS_H_ONCE
 
+#include "config.h"                         // for nvObj_t
+#include "canonical_machine.h"              // for AXES and MOTORS
+
+/*
+ * KINEMATICS
+ *
+ *  The machine kinematics is selected with {kin:n}. Every kinematics maps the Cartesian
+ *  travel vector to and from a joint vector indexed by axis. Motors are mapped to joints
+ *  exactly as they are mapped to axes on a Cartesian machine ($1ma etc.), so joint units
+ *  are what the motor steps_per_unit are set up in:
+ *
+ *    0 = Cartesian     joints are the axes
+ *    1 = CoreXY        X joint is A = X+Y, Y joint is B = X-Y (both in length units)
+ *    2 = linear delta  X, Y and Z joints are the height of tower A (front left, 210 degrees),
+ *                      B (front right, 330 degrees) and C (back, 90 degrees) carriages
+ *                      above the effector plane, in length units. Set {kdl:} and {kdr:}
+ *    3 = SCARA         X joint is the shoulder angle, Y joint is the elbow angle relative
+ *                      to the first link, both in degrees. Set {ksl1:} and {ksl2:}
+ *    4 = 5-axis table-table (AC trunnion), tool center point
+ *    5 = 5-axis head-table (B head, C table), tool center point
+ *
+ *  Joints the kinematics does not use (Z on CoreXY and SCARA, the rotary axes) pass through.
+ *  Changing {kin:} is refused while a cycle is running. It resets the step positions to the
+ *  current machine position so the motors are not commanded to jump.
+ *
+ *  5-AXIS TOOL CENTER POINT
+ *
+ *  With {kin:4} or {kin:5} XYZ are the tool tip in the coordinates of the part on the table,
+ *  and A/B/C are the rotary joint angles in degrees, which pass through. Each segment's tip
+ *  is transformed to the linear joints the machine has to be at for the tip to be there
+ *  with the rotaries at their angles, so a 5-axis program moves in straight lines at the
+ *  programmed feed without being posted to joint space.
+ *
+ *    table-table  A tilts the trunnion about X, C turns the table on it about Z. Both
+ *                 axes pass through the pivot {ktpx:}, {ktpy:}, {ktpz:} (machine
+ *                 coordinates, at A0).
+ *    head-table   B tilts the head about Y, C turns the table about Z through {ktpx:},
+ *                 {ktpy:}. {khl:} is the head pivot to the spindle gauge line.
+ *
+ *  Positive rotations turn the table (or head) by the right hand rule about +X, +Y and +Z.
+ *  The tool length is the current G43 Z offset, so change it with the machine at rest. The
+ *  planner holds each block to the joint velocity, acceleration and jerk limits along the
+ *  joints' actual path (see kn_joint_travel()), which is much longer than the tip's when
+ *  the rotaries swing the part far from the pivot.
+ *
+ *  HEIGHT MAP
+ *
+ *  {hmap:1} loads the last successful probing grid ({prgs:1}) as a Z height map and
+ *  {hmap:0} turns it off. While on, the Z offset of the surface at the current XY is
+ *  bilinearly interpolated from the grid and added to Z in front of every inverse transform
+ *  (and removed after every forward transform), so compensation is continuous along each
+ *  segment rather than only at the end points of a move. Offsets are relative to the first
+ *  grid point, and the map is held flat beyond the edges of the grid. The map is not
+ *  persisted, and toggling it resets Z so the motors are not commanded to jump.
+ *
+ *  SEGMENT TOLERANCE
+ *
+ *  Each segment moves the joints in a straight line to the inverse transform of its end, so
+ *  on delta, SCARA and 5-axis the tool follows chords of the joint space curve rather than
+ *  the programmed line. {ktol:} is the most a chord may deviate from that curve, in steps.
+ *  The deviation of every line is estimated when it is queued (kn_chord_deviation()) and the
+ *  exec sizes the line's segments to it, from the minimum segment time up to the longest
+ *  nominal segment (see _block_segment_time() in plan_exec.cpp), so the transforms are spent
+ *  where the joints curve. 0 runs every line at the nominal segment time. Arcs and splines
+ *  always do. Cartesian and CoreXY chords are exact, so are not affected.
+ */
+
+typedef enum {
+    KINEMATICS_CARTESIAN = 0,
+    KINEMATICS_COREXY,
+    KINEMATICS_DELTA,
+    KINEMATICS_SCARA,
+    KINEMATICS_TABLE_TABLE,
+    KINEMATICS_HEAD_TABLE,
+    KINEMATICS_MAX = KINEMATICS_HEAD_TABLE
+} knKinematicsType;
+
+typedef struct knKinematics {               // one per kinematics type
+    void (*inverse)(const float travel[], float joint[]);   // Cartesian travel to joint positions
+    void (*forward)(const float joint[], float travel[]);   // joint positions to Cartesian travel
+} knKinematics_t;
+
+typedef struct knMotorMap {                // joint to steps conversion for one motor
+    int8_t joint;                           // joint (axis) driving this motor, -1 if unmapped or inhibited
+    float steps_per_unit;                   // joint units to steps
+    float units_per_step;                   // steps to joint units, 0 if not used for forward kinematics
+} knMotorMap_t;
+
+typedef struct knHeightMap {               // Z height map - see kn_set_hmap()
+    bool enable;                            // true if applied to the transforms
+    uint8_t nx;                             // grid columns (X)
+    uint8_t ny;                             // grid rows (Y)
+    float x_min;                            // machine coordinates of z[0][0]
+    float y_min;
+    float recip_pitch;                      // 1 / grid pitch
+    float z[PROBE_GRID_MAX][PROBE_GRID_MAX];// offsets relative to z[0][0], indexed [row][column]
+} knHeightMap_t;
+
+typedef struct knConfig {
+    knKinematicsType type;                  // selected kinematics
+    const knKinematics_t *kin;              // implementation for the selected type
+    knMotorMap_t mot[MOTORS];               // rebuilt by kn_config_changed() - see kinematics.cpp
+
+    float delta_rod_length;                 // linear delta diagonal rod length
+    float delta_radius;                     // linear delta horizontal tower to effector joint distance
+    float scara_link1;                      // SCARA shoulder to elbow length
+    float scara_link2;                      // SCARA elbow to end effector length
+    float pivot[3];                         // 5-axis rotary pivot, machine XYZ
+    float head_length;                      // 5-axis head pivot to spindle gauge line
+    knHeightMap_t hmap;                     // surface compensation, off unless loaded
+    float segment_tolerance;                // {ktol:} joint space chord deviation in steps, 0 = fixed segments
+
+    // derived values - computed when the settings above change
+    float delta_rod_length_sq;              // square of the rod length
+    float delta_tower_x[3];                 // tower positions, A,B,C
+    float delta_tower_y[3];
+    float scara_link_sum_sq;                // link1^2 + link2^2
+    float scara_link_recip;                 // 1 / (2 * link1 * link2)
+} knConfig_t;
+
+extern knConfig_t kn;
+
 /*
  * Global Scope Functions
  */
 
 void kn_inverse_kinematics(const float travel[], float steps[]);
 void kn_forward_kinematics(const float steps[], float travel[]);
+void kn_config_changed(void);
+bool kn_is_tool_center_point(void);
+void kn_joint_travel(const float start[], const float end[], float joint_length[]);
+bool kn_is_sub_step(const float start[], const float end[]);
+float kn_chord_deviation(const float start[], const float end[]);
+
+stat_t kn_get_kin(nvObj_t *nv);
+stat_t kn_set_kin(nvObj_t *nv);
+stat_t kn_get_kdl(nvObj_t *nv);
+stat_t kn_set_kdl(nvObj_t *nv);
+stat_t kn_get_kdr(nvObj_t *nv);
+stat_t kn_set_kdr(nvObj_t *nv);
+stat_t kn_get_ksl1(nvObj_t *nv);
+stat_t kn_set_ksl1(nvObj_t *nv);
+stat_t kn_get_ksl2(nvObj_t *nv);
+stat_t kn_set_ksl2(nvObj_t *nv);
+stat_t kn_get_ktpx(nvObj_t *nv);
+stat_t kn_set_ktpx(nvObj_t *nv);
+stat_t kn_get_ktpy(nvObj_t *nv);
+stat_t kn_set_ktpy(nvObj_t *nv);
+stat_t kn_get_ktpz(nvObj_t *nv);
+stat_t kn_set_ktpz(nvObj_t *nv);
+stat_t kn_get_khl(nvObj_t *nv);
+stat_t kn_set_khl(nvObj_t *nv);
+stat_t kn_get_hmap(nvObj_t *nv);
+stat_t kn_set_hmap(nvObj_t *nv);
+stat_t kn_get_ktol(nvObj_t *nv);
+stat_t kn_set_ktol(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+    void kn_print_kin(nvObj_t *nv);
+    void kn_print_kdl(nvObj_t *nv);
+    void kn_print_kdr(nvObj_t *nv);
+    void kn_print_ksl1(nvObj_t *nv);
+    void kn_print_ksl2(nvObj_t *nv);
+    void kn_print_ktpx(nvObj_t *nv);
+    void kn_print_ktpy(nvObj_t *nv);
+    void kn_print_ktpz(nvObj_t *nv);
+    void kn_print_khl(nvObj_t *nv);
+    void kn_print_hmap(nvObj_t *nv);
+    void kn_print_ktol(nvObj_t *nv);
+
+#else
+
+    #define kn_print_kin tx_print_stub
+    #define kn_print_kdl tx_print_stub
+    #define kn_print_kdr tx_print_stub
+    #define kn_print_ksl1 tx_print_stub
+    #define kn_print_ksl2 tx_print_stub
+    #define kn_print_ktpx tx_print_stub
+    #define kn_print_ktpy tx_print_stub
+    #define kn_print_ktpz tx_print_stub
+    #define kn_print_khl tx_print_stub
+    #define kn_print_hmap tx_print_stub
+    #define kn_print_ktol tx_print_stub
+
+#endif // __TEXT_MODE
 
 #endif  // End of include Guard: KINEMATICS_H_ONCE
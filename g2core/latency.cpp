@@ -0,0 +1,225 @@
+/*
+ * latency.cpp - per-line command latency from receipt to motion
+ * This file is part of g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "controller.h"
+#include "latency.h"
+#include "util.h"
+#include "xio.h"
+
+#ifdef __LATENCY_TRACE
+
+latTrace_t lt;
+
+/*
+ * lat_line_read()  - stamp a line read ahead by the controller
+ * lat_line_taken() - a line is being dispatched - take its rx stamp
+ * lat_line_flush() - the lines read ahead were discarded
+ *
+ *  Read-ahead lines are dispatched in the order they were read, so their stamps are a
+ *  FIFO. The stamps are queued whether or not recording is on, so they stay in step with
+ *  the read-ahead lines when it is turned on. Taking any line ends the previous one: blocks
+ *  committed after this (e.g. by a JSON command) aren't charged to it.
+ */
+
+void lat_line_read()
+{
+    if ((uint8_t)(lt.rx_head - lt.rx_tail) < LATENCY_RX_QUEUE) {
+        lt.rx_queue[lt.rx_head++ & (LATENCY_RX_QUEUE-1)] = lat_now();
+    }
+}
+
+void lat_line_taken(const bool read_ahead)
+{
+    if (read_ahead && (lt.rx_tail != lt.rx_head)) {
+        lt.rx_stamp = lt.rx_queue[lt.rx_tail++ & (LATENCY_RX_QUEUE-1)];
+    } else {
+        lt.rx_stamp = lat_now();
+    }
+    lt.open_seq = 0;
+}
+
+void lat_line_flush()
+{
+    lt.rx_tail = lt.rx_head;
+}
+
+/*
+ * lat_gcode_start()  - start a record for the gcode line being dispatched
+ * lat_gcode_parsed() - the line has been parsed and is about to be executed
+ * lat_block_commit() - a block is being committed - return the record it belongs to
+ *
+ *  The record stays open after the line is parsed, so blocks queued later by its arc or
+ *  canned cycle callback are charged to it.
+ */
+
+void lat_gcode_start()
+{
+    if (!lt.enabled) {
+        lt.open_seq = 0;
+        return;
+    }
+    uint32_t seq = ++lt.seq;
+    latRecord_t *r = &lt.rec[seq & (LATENCY_TRACE_SIZE-1)];
+    r->seq = 0;                                 // keep the ISRs off the record while it is set up
+    memset(r->stamp, 0, sizeof(r->stamp));
+    r->linenum = 0;
+    r->stamp[LAT_RX] = (lt.rx_stamp != 0) ? lt.rx_stamp : lat_now();
+    r->seq = seq;
+    lt.open_seq = seq;
+}
+
+void lat_gcode_parsed(const uint32_t linenum)
+{
+    latRecord_t *r = &lt.rec[lt.open_seq & (LATENCY_TRACE_SIZE-1)];
+    if ((lt.open_seq == 0) || (r->seq != lt.open_seq) || (r->stamp[LAT_PARSE] != 0)) {
+        return;
+    }
+    r->linenum = linenum;
+    r->stamp[LAT_PARSE] = lat_now();
+}
+
+uint32_t lat_block_commit()
+{
+    lat_stamp(lt.open_seq, LAT_COMMIT);
+    return (lt.open_seq);
+}
+
+/*
+ * latency_callback() - send one trace line per pass through the main loop
+ */
+
+static float _lat_usec(const latRecord_t *r, const uint8_t stage)
+{
+    if ((r->stamp[stage] == 0) || (r->stamp[LAT_RX] == 0)) {
+        return (-1);
+    }
+    return (cycles_to_usec(r->stamp[stage] - r->stamp[LAT_RX]));
+}
+
+stat_t latency_callback()
+{
+    if (!lt.dump_pending) {
+        return (STAT_NOOP);
+    }
+    if (lt.dump_seq > lt.seq) {
+        lt.dump_pending = false;
+        return (STAT_OK);
+    }
+    latRecord_t *r = &lt.rec[lt.dump_seq & (LATENCY_TRACE_SIZE-1)];
+    uint32_t seq = lt.dump_seq++;
+    if (r->seq != seq) {                        // overwritten while dumping
+        return (STAT_OK);
+    }
+    char *b = cs.out_buf;
+    b += sprintf(b, "{\"lat\":[%lu,%lu", (unsigned long)seq, (unsigned long)r->linenum);
+    for (uint8_t stage = LAT_PARSE; stage < LAT_STAGES; stage++) {
+        b += sprintf(b, ",%0.0f", (double)_lat_usec(r, stage));
+    }
+    sprintf(b, "]}\n");
+    xio_writeline(cs.out_buf);
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * lat_get()       - return the number of lines held
+ * lat_set()       - 0 stops recording, 1 clears and starts it, 2 dumps the trace
+ * lat_get_pct()   - return [p50,p90,p99] us after rx for the stage in the cfgArray default
+ * lat_print_pct() - print the percentiles in text mode
+ */
+
+stat_t lat_get(nvObj_t *nv)
+{
+    return (get_integer(nv, (lt.seq > LATENCY_TRACE_SIZE) ? LATENCY_TRACE_SIZE : lt.seq));
+}
+
+stat_t lat_set(nvObj_t *nv)
+{
+    switch (nv->value_int) {
+        case 0: { lt.enabled = false; break; }
+        case 1: {
+            lt.enabled = false;
+            lt.open_seq = 0;                    // blocks already queued keep their old seq - see lat_stamp()
+            lt.dump_pending = false;
+            memset(lt.rec, 0, sizeof(lt.rec));
+            lt.seq = 0;
+            lt.enabled = true;
+            break;
+        }
+        case 2: {
+            lt.dump_seq = (lt.seq > LATENCY_TRACE_SIZE) ? (lt.seq - LATENCY_TRACE_SIZE + 1) : 1;
+            lt.dump_pending = true;
+            break;
+        }
+        default: { return (STAT_INPUT_VALUE_RANGE_ERROR); }
+    }
+    return (lat_get(nv));
+}
+
+stat_t lat_get_pct(nvObj_t *nv)
+{
+    uint8_t stage = (uint8_t)GET_TABLE_FLOAT(def_value);
+    float v[LATENCY_TRACE_SIZE];
+    uint8_t n = 0;
+
+    for (uint8_t i = 0; i < LATENCY_TRACE_SIZE; i++) {
+        float us = (lt.rec[i].seq == 0) ? -1 : _lat_usec(&lt.rec[i], stage);
+        if (us < 0) {
+            continue;
+        }
+        uint8_t j = n++;                        // insertion sort - the ring is small
+        for (; (j > 0) && (v[j-1] > us); j--) {
+            v[j] = v[j-1];
+        }
+        v[j] = us;
+    }
+    char buf[36];
+    if (n == 0) {
+        sprintf(buf, "-1,-1,-1");
+    } else {
+        sprintf(buf, "%0.0f,%0.0f,%0.0f", (double)v[(n-1)*50/100], (double)v[(n-1)*90/100], (double)v[(n-1)*99/100]);
+    }
+    ritorno(nv_copy_string(nv, buf));
+    nv->valuetype = TYPE_ARRAY;
+    return (STAT_OK);
+}
+
+static const char fmt_latp[] = "[%s] us after rx p50,p90,p99 %s\n";
+
+void lat_print_pct(nvObj_t *nv)
+{
+    sprintf(cs.out_buf, fmt_latp, nv->token, *nv->stringp);
+    xio_writeline(cs.out_buf);
+}
+
+#endif  // __LATENCY_TRACE
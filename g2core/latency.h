@@ -0,0 +1,141 @@
+/*
+ * latency.h - per-line command latency from receipt to motion
+ * This file is part of g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * LATENCY TRACE
+ *
+ *  Stamps each gcode line with the cycle counter as it passes through the controller and
+ *  planner, and keeps the last LATENCY_TRACE_SIZE lines in a RAM ring:
+ *
+ *    rx        the controller took the line from the RX buffer (when it was read ahead
+ *              into the prefetch queue, the time it was read ahead)
+ *    parse     the parser finished the line and started executing it
+ *    commit    the line's first block was committed to the planner queue
+ *    plan      the first block was forward planned
+ *    run       the exec started preparing the first block's first segment
+ *    done      the line's last block finished and was freed
+ *
+ *  Blocks queued by a line (including the later blocks of an arc) carry its record number
+ *  in bf->latency_seq, so the ISRs can stamp the record without searching. A record that
+ *  has been overwritten by a newer line is left alone.
+ *
+ *    {lat:n}   returns the number of lines held
+ *    {lat:0}   stops recording
+ *    {lat:1}   clears the trace and starts recording
+ *    {lat:2}   dumps the trace, oldest line first, one line per record:
+ *              {"lat":[seq,linenum,parse,commit,plan,run,done]} in us after rx, -1 if not reached
+ *    {latp:n}  returns [p50,p90,p99] in us after rx for each stage over the lines held
+ *
+ *  Recording is off until {lat:1}. The cycle counter wraps every 2^32 cycles (51 seconds
+ *  at 84 MHz), so only lines that finish within that are measured correctly.
+ */
+
+#ifndef LATENCY_H_ONCE
+#define LATENCY_H_ONCE
+
+#ifdef __LATENCY_TRACE
+
+#include "util.h"
+
+#define LATENCY_TRACE_SIZE 32           // lines held - must be a power of 2
+#define LATENCY_RX_QUEUE 8              // read-ahead stamps - must be a power of 2, more than GC_PREFETCH_BLOCKS+1
+
+typedef enum {
+    LAT_RX = 0,
+    LAT_PARSE,
+    LAT_COMMIT,
+    LAT_PLAN,
+    LAT_RUN,
+    LAT_DONE,
+    LAT_STAGES                          // count of stages
+} latStage;
+
+typedef struct latRecord {
+    uint32_t seq;                       // line number since the trace was cleared, from 1
+    uint32_t linenum;                   // N word line number, if any
+    uint32_t stamp[LAT_STAGES];         // cycle counts, 0 = not reached
+} latRecord_t;
+
+typedef struct latTrace {
+    latRecord_t rec[LATENCY_TRACE_SIZE];
+    uint32_t seq;                       // lines recorded since cleared - line seq goes in rec[seq % size]
+    uint32_t open_seq;                  // line whose blocks are being queued, 0 = none
+    volatile bool enabled;              // record lines
+    uint32_t rx_stamp;                  // rx stamp of the line being dispatched
+    uint32_t rx_queue[LATENCY_RX_QUEUE];// rx stamps of the lines read ahead
+    uint8_t rx_head;
+    uint8_t rx_tail;
+    bool dump_pending;                  // latency_callback() has lines to send
+    uint32_t dump_seq;                  // next line to dump
+} latTrace_t;
+
+extern latTrace_t lt;
+
+inline uint32_t lat_now() { return (cycle_count() | 1); }   // 0 is "not reached"
+
+inline void lat_stamp(const uint32_t seq, const latStage stage)
+{
+    latRecord_t *r = &lt.rec[seq & (LATENCY_TRACE_SIZE-1)];
+    if ((seq == 0) || (r->seq != seq)) { return; }
+    if ((stage == LAT_DONE) || (r->stamp[stage] == 0)) {
+        r->stamp[stage] = lat_now();
+    }
+}
+
+void lat_line_read(void);
+void lat_line_taken(const bool read_ahead);
+void lat_line_flush(void);
+void lat_gcode_start(void);
+void lat_gcode_parsed(const uint32_t linenum);
+uint32_t lat_block_commit(void);
+
+#define LAT_LINE_READ() lat_line_read()
+#define LAT_LINE_TAKEN(read_ahead) lat_line_taken(read_ahead)
+#define LAT_LINE_FLUSH() lat_line_flush()
+#define LAT_GCODE_START() lat_gcode_start()
+#define LAT_GCODE_PARSED(linenum) lat_gcode_parsed(linenum)
+#define LAT_BLOCK_COMMIT(bf) { (bf)->latency_seq = lat_block_commit(); }
+#define LAT_BLOCK_STAMP(bf, stage) lat_stamp((bf)->latency_seq, stage)
+
+stat_t latency_callback(void);
+stat_t lat_get(nvObj_t *nv);
+stat_t lat_set(nvObj_t *nv);
+stat_t lat_get_pct(nvObj_t *nv);
+void lat_print_pct(nvObj_t *nv);
+
+#else
+
+#define LAT_LINE_READ()
+#define LAT_LINE_TAKEN(read_ahead)
+#define LAT_LINE_FLUSH()
+#define LAT_GCODE_START()
+#define LAT_GCODE_PARSED(linenum)
+#define LAT_BLOCK_COMMIT(bf)
+#define LAT_BLOCK_STAMP(bf, stage)
+
+#endif  // __LATENCY_TRACE
+
+#endif  // End of include guard: LATENCY_H_ONCE
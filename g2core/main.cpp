@@ -24,6 +24,8 @@
 #include "config.h"  // #2
 #include "hardware.h"
 #include "persistence.h"
+#include "spool.h"
+#include "checkpoint.h"
 #include "controller.h"
 #include "canonical_machine.h"
 #include "json_parser.h"			// required for unit tests only
@@ -37,6 +39,9 @@
 #include "gpio.h"
 #include "pwm.h"
 #include "xio.h"
+#include "profiler.h"
+#include "benchmark.h"
+#include "binary_motion.h"
 
 #include "util.h"
 #include "MotateUniqueID.h"
@@ -97,7 +102,15 @@ extern OutputPin<kDebug4_PinNumber> debug_pin4;
 void application_init_services(void)
 {
     hardware_init();				    // system hardware setup 			- must be first
+#ifdef __PROFILER
+    profiler_init();                    // instrumentation build only - see profiler.h
+#endif
+#ifdef __BENCHMARK
+    bm_init();                          // instrumentation build only - see benchmark.h
+#endif
     persistence_init();				    // set up EEPROM or other NVM		- must be second
+    spool_init();                       // job spool in flash
+    checkpoint_init();                  // find the last job checkpoint - before config_init() sets {cki:}
     xio_init();						    // xtended io subsystem				- must be third
 }
 
@@ -126,6 +139,9 @@ void application_init_startup(void)
     coolant_reset();
     temperature_init();
     gpio_reset();
+#if BINARY_MOTION_ENABLED == true
+    binary_motion_init();               // binary motion channel on SerialUSB1
+#endif
 }
 
 /*
@@ -145,7 +161,9 @@ void setup(void)
 {
     // application setup
     application_init_services();
+#ifndef __SIMULATOR
     while (SysTickTimer_getValue() < 400);  // delay 400 ms for USB to come up
+#endif
 
     application_init_machine();
     application_init_startup();
@@ -162,7 +180,9 @@ void loop() {
  * Traps for debugging. These must be in main.cpp for proper linker ordering
  */
 
+#ifndef __SIMULATOR
 void MemManage_Handler  ( void ) { __asm__("BKPT"); }
 void BusFault_Handler   ( void ) { __asm__("BKPT"); }
 void UsageFault_Handler ( void ) { __asm__("BKPT"); }
 void HardFault_Handler  ( void ) { __asm__("BKPT"); }
+#endif
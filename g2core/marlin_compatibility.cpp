@@ -38,11 +38,13 @@
 #include "util.h"
 #include "xio.h"                // for char definitions
 #include "temperature.h"        // for temperature controls
+#include "gpio.h"               // for the fan output
 #include "json_parser.h"
 #include "planner.h"
 #include "stepper.h"            // for MOTOR_TIMEOUT_SECONDS_MIN/MOTOR_TIMEOUT_SECONDS_MAX
 #include "MotateTimers.h"       // for char definitions
 #include "MotateUniqueID.h"     // for Motate::UUID
+#include "profiler.h"
 
 // Structures used
 enum STK500 {
@@ -89,23 +91,6 @@ Motate::Timeout temperature_update_timeout;
 
 // local helper functions and macros
 
-/***********************************************************************************
- * _get_specific_nv() - convenience function to get an NV object
- */
-nvObj_t *_get_specific_nv(const char *key) {
-    nvObj_t *nv = nv_reset_nv_list();           // returns first object in the body
-
-    strncpy(nv->token, key, TOKEN_LEN);
-
-    // validate and post-process the token
-    if ((nv->index = nv_get_index((const char *)"", nv->token)) == NO_MATCH) { // get index or fail it
-        return nullptr;        // since we JUST provided the keys, this should never happen
-    }
-    strcpy(nv->group, cfgArray[nv->index].group); // capture the group string if there is one
-    nv_get(nv);
-    return nv;
-}
-
 /***********************************************************************************
  * _report_temperatures() - convenience function called from marlin_response() and marlin_callback()
  */
@@ -144,7 +129,7 @@ void _report_position(char *(&str)) {
     uint8_t tool = cm->gm.tool;
     if ((tool > 0) && (tool < 3)) {
         str_concat(str, " E:");
-        str += floattoa(str, cm_get_display_position(ACTIVE_MODEL, 2), tool + 2); // A or B, depending on tool
+        str += floattoa(str, cm_get_display_position(ACTIVE_MODEL, tool + 2), 2); // A or B, depending on tool
     }
 }
 
@@ -155,19 +140,20 @@ void _report_position(char *(&str)) {
 
 /***********************************************************************************
  * marlin_start_tramming_bed() - G29 called from gcode parser
- * marlin G29 support - run a script to emulate a G29 homing command
+ * marlin G29 support - probe the MARLIN_G29_POINTS and tram the bed from them
+ *  (see cm_probe_tram_start())
  */
 
-#ifdef MARLIN_G29_SCRIPT
-auto marlin_g29_file = make_xio_flash_file(MARLIN_G29_SCRIPT);
+#ifdef MARLIN_G29_POINTS
+static const float marlin_g29_points[PROBES_STORED][2] = MARLIN_G29_POINTS;
 #endif
 
 stat_t marlin_start_tramming_bed() {
-#ifndef MARLIN_G29_SCRIPT
+#ifndef MARLIN_G29_POINTS
     return (STAT_G29_NOT_CONFIGURED);
 #else
-    xio_send_file(marlin_g29_file);
-    return (STAT_OK);
+    cm_message("Tramming started");
+    return (cm_probe_tram_start(marlin_g29_points, MARLIN_G29_Z_CLEAR, MARLIN_G29_Z_PROBE, MARLIN_G29_FEED_RATE));
 #endif
 }
 
@@ -262,6 +248,11 @@ stat_t marlin_set_motor_timeout(float s) // M18 Sxxx, M84 Sxxx, M85 Sxxx
  * _queue_next_temperature_comands() - returns true if it finished
  * _marlin_start_temperature_updates()
  * _marlin_end_temperature_updates()
+ * _marlin_set_set_temperature() - runtime: vect[0] is the heater, vect[1] the setpoint
+ * _marlin_at_temperature()      - wait condition: vect[0] is the heater
+ *
+ *  Setpoints and at-temperature waits are queued as native planner commands, so they
+ *  don't go through the JSON parser and config table lookup at runtime.
  */
 
 void _marlin_start_temperature_updates(float* vect, bool* flag) {
@@ -273,6 +264,14 @@ void _marlin_end_temperature_updates(float* vect, bool* flag) {
     temperature_updates_requested = false;
 }
 
+void _marlin_set_set_temperature(float* vect, bool* flag) {
+    cm_set_set_temperature((uint8_t)vect[0], vect[1]);
+}
+
+bool _marlin_at_temperature(const float* vect) {
+    return cm_get_at_temperature((uint8_t)vect[0]);
+}
+
 bool _queue_next_temperature_commands()
 {
     if (MarlinSetTempState::Idle != set_temp_state) {
@@ -280,18 +279,15 @@ bool _queue_next_temperature_commands()
             return false;
         }
 
-        char buffer[128];
-        char *str = buffer;
+        float value[] = INIT_AXES_ZEROES;
+        bool flags[] = INIT_AXES_FALSE;
+        value[0] = next_temperature_tool;
+        value[1] = next_temperature;
 
         if ((MarlinSetTempState::SettingTemperature == set_temp_state) ||
             (MarlinSetTempState::SettingTemperatureNoWait == set_temp_state))
         {
-            str_concat(str, "{he");
-            str += inttoa(str, next_temperature_tool);
-            str_concat(str, "st:");
-            str += floattoa(str, next_temperature, 2);
-            str_concat(str, "}");
-            cm_json_command(buffer);
+            mp_queue_command(_marlin_set_set_temperature, value, flags);
 
             if (MarlinSetTempState::SettingTemperatureNoWait == set_temp_state) {
                 set_temp_state = MarlinSetTempState::Idle;
@@ -305,7 +301,7 @@ bool _queue_next_temperature_commands()
         }
 
         if (MarlinSetTempState::StartingUpdates == set_temp_state) {
-            mp_queue_command(_marlin_start_temperature_updates, nullptr, nullptr);
+            mp_queue_command(_marlin_start_temperature_updates, value, flags);
 
             set_temp_state = MarlinSetTempState::StartingWait;
             if (mp_planner_is_full(mp)) {
@@ -314,11 +310,7 @@ bool _queue_next_temperature_commands()
         }
 
         if (MarlinSetTempState::StartingWait == set_temp_state) {
-            str = buffer;
-            str_concat(str, "{he");
-            str += inttoa(str, next_temperature_tool);
-            str_concat(str, "at:t}");
-            cm_json_wait(buffer);
+            mp_queue_wait(_marlin_at_temperature, value);
 
             set_temp_state = MarlinSetTempState::StoppingUpdates;
             if (mp_planner_is_full(mp)) {
@@ -327,7 +319,7 @@ bool _queue_next_temperature_commands()
         }
 
         if (MarlinSetTempState::StoppingUpdates == set_temp_state) {
-            mp_queue_command(_marlin_end_temperature_updates, nullptr, nullptr);
+            mp_queue_command(_marlin_end_temperature_updates, value, flags);
 
             set_temp_state = MarlinSetTempState::Idle;
         }
@@ -370,20 +362,21 @@ stat_t marlin_request_temperature_report() // M105
  * marlin_set_fan_speed() - M106, M107 called from gcode parser
  */
 
+void _marlin_set_fan_output(float* vect, bool* flag) {
+    gpio_set_output(4-1, vect[0]);  // out4, 0-based
+}
+
 stat_t marlin_set_fan_speed(const uint8_t fan, float speed)
 {
-    char buffer[128];
-    char *str = buffer;
     if ((fan != 0) || (speed < 0.0) || (speed > 255.0)) {
         return STAT_INPUT_VALUE_RANGE_ERROR;
     }
 
     // TODO: support other fans, or remapping output
-    str_concat(str, "{out4:");
-    str += floattoa(str, (speed < 1.0) ? speed : (speed / 255.0), 4);
-    str_concat(str, "}");
-
-    cm_json_command(buffer);
+    float value[] = INIT_AXES_ZEROES;
+    bool flags[] = INIT_AXES_FALSE;
+    value[0] = (speed < 1.0) ? speed : (speed / 255.0);
+    mp_queue_command(_marlin_set_fan_output, value, flags);
 
     return (STAT_OK);
 }
@@ -488,19 +481,26 @@ stat_t marlin_callback()
 
 /***********************************************************************************
  * marlin_response() - marlin mirror of text_response(), called from _dispatch_kernel() in controller.cpp
+ * _marlin_response() - format and write the response line
+ *
+ *  This runs once for every line a Marlin host sends, so it formats straight from the
+ *  temperature and position state and never touches the nvObj list. A bare "ok" (the
+ *  common case) is written from a constant. Timing is recorded in {prof:profmr}.
  */
-void marlin_response(const stat_t status, char *buf)
+static void _marlin_response(const stat_t status)
 {
     char buffer[128];
     char *str = buffer;
 
     bool request_resend = false;
 
-    if (cs.responses_suppressed) {
+    bool ok = ((status == STAT_OK) || (status == STAT_EAGAIN) || (status == STAT_NOOP));
+    if (ok && !temperature_requested && !position_requested) {
+        xio_writeline("ok\n");
         return;
     }
 
-    if ((status == STAT_OK) || (status == STAT_EAGAIN) || (status == STAT_NOOP)) {
+    if (ok) {
         str_concat(str, "ok");
 
         if (temperature_requested) {
@@ -553,6 +553,16 @@ void marlin_response(const stat_t status, char *buf)
     }
 }
 
+void marlin_response(const stat_t status, char *buf)
+{
+    if (cs.responses_suppressed) {
+        return;
+    }
+    PROF_BEGIN(_start);
+    _marlin_response(status);
+    PROF_END(_start, PROF_MARLIN_RESPONSE);
+}
+
 /***********************************************************************************
  * marlin_handle_fake_stk500() - returns true if it handled something (IOW, don't futher process the line)
  * _marlin_fake_stk500_response() - convenience function for formang responses from marlin_handle_fake_stk500()
@@ -30,6 +30,12 @@
 #include "report.h"
 //#include "util.h"
 
+#if PERSISTENCE_ENABLED == true
+
+#if !(defined(__SAM3X8E__) || defined(__SAM3X8C__))
+#error PERSISTENCE_ENABLED is only supported on SAM3X
+#endif
+
 /***********************************************************************************
  **** STRUCTURE ALLOCATIONS ********************************************************
  ***********************************************************************************/
@@ -40,28 +46,349 @@ nvmSingleton_t nvm;
  **** GENERIC STATIC FUNCTIONS AND VARIABLES ***************************************
  ***********************************************************************************/
 
+#define NVM_AREA_SIZE (NVM_AREA_PAGES * NVM_PAGE_SIZE)
+#define NVM_AREA_ADDR(a) (IFLASH1_ADDR + IFLASH1_SIZE - ((2 - (a)) * NVM_AREA_SIZE))
+
+static_assert(NVM_PAGE_SIZE == IFLASH1_PAGE_SIZE, "NVM_PAGE_SIZE must match the flash page size");
+static_assert(sizeof(nvmRecord_t) == 8, "nvmRecord_t must pack into 8 bytes");
+
+static const nvmRecord_t *_record(uint8_t area, uint16_t slot)
+{
+    return ((const nvmRecord_t *)NVM_AREA_ADDR(area) + slot);
+}
+
+static uint8_t _crc8(const nvmRecord_t *r)
+{
+    const uint8_t *b = (const uint8_t *)r;
+    uint8_t crc = 0;
+    for (uint8_t i=0; i < sizeof(nvmRecord_t); i++) {
+        if (i == offsetof(nvmRecord_t, crc)) {
+            continue;
+        }
+        crc ^= b[i];
+        for (uint8_t j=0; j < 8; j++) {
+            crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+        }
+    }
+    return (crc);
+}
+
+static bool _is_valid(const nvmRecord_t *r, uint32_t generation)
+{
+    return ((r->index != 0xFFFF) && (r->generation == (generation & 0xFF)) && (r->crc == _crc8(r)));
+}
+
+static void _make_record(nvmRecord_t *r, uint16_t index, uint32_t value, uint32_t generation)
+{
+    r->index = index;
+    r->generation = generation & 0xFF;
+    r->value = value;
+    r->crc = _crc8(r);
+}
+
+/*
+ * _nvm_wait()    - wait for the last flash command to finish. Flash bank 1 can't be read until it has.
+ *                  FRDY is always checked, as checkpoint.cpp starts writes it doesn't wait for.
+ * _nvm_command() - load a page into the latch buffer and start a write (WP) or erase-and-write (EWP)
+ */
+
+static void _nvm_wait()
+{
+    while ((EFC1->EEFC_FSR & EEFC_FSR_FRDY) == 0);
+    nvm.busy = false;
+}
+
+static void _nvm_command(uint8_t area, uint16_t page, const nvmRecord_t *src, bool erase)
+{
+    _nvm_wait();
+    uint32_t addr = NVM_AREA_ADDR(area) + (page * NVM_PAGE_SIZE);
+    volatile uint32_t *latch = (volatile uint32_t *)addr;
+    const uint32_t *words = (const uint32_t *)src;
+    for (uint8_t i=0; i < (NVM_PAGE_SIZE / 4); i++) {
+        latch[i] = words[i];
+    }
+    __DSB();
+    EFC1->EEFC_FCR = EEFC_FCR_FKEY(0x5A) |
+                     EEFC_FCR_FARG((addr - IFLASH1_ADDR) / NVM_PAGE_SIZE) |
+                     EEFC_FCR_FCMD(erase ? 0x03 : 0x01);    // EWP : WP
+    nvm.busy = true;
+}
+
+/*
+ * _nvm_load_page() - set up the staged page for the page holding nvm.next
+ * _nvm_program()   - start programming the staged page. Its first program also erases it.
+ */
+
+static void _nvm_load_page()
+{
+    uint16_t first = nvm.next - (nvm.next % NVM_RECORDS_PER_PAGE);
+    memset(nvm.page, 0xFF, sizeof(nvm.page));
+    _nvm_wait();
+    for (uint16_t slot = first; slot < nvm.next; slot++) {
+        nvm.page[slot - first] = *_record(nvm.area, slot);
+    }
+    nvm.page_erased = (nvm.next != first);  // a partly used page has already been erased
+    nvm.dirty = false;
+}
+
+static void _nvm_program()
+{
+    _nvm_command(nvm.area, (nvm.next - 1) / NVM_RECORDS_PER_PAGE, nvm.page, !nvm.page_erased);
+    nvm.page_erased = true;
+    nvm.dirty = false;
+}
+
+/*
+ * _nvm_find() - find the latest value for an index, looking at the staged page first
+ */
+
+static bool _nvm_find(uint16_t index, uint32_t &value)
+{
+    uint16_t first = nvm.next - (nvm.next % NVM_RECORDS_PER_PAGE);
+    for (uint16_t slot = nvm.next; slot > first; slot--) {
+        if (nvm.page[slot - first - 1].index == index) {
+            value = nvm.page[slot - first - 1].value;
+            return (true);
+        }
+    }
+    _nvm_wait();
+    for (uint16_t slot = first; slot > 1; slot--) {     // slot 0 is the header
+        const nvmRecord_t *r = _record(nvm.area, slot-1);
+        if (r->index == index) {
+            value = r->value;
+            return (true);
+        }
+    }
+    return (false);
+}
+
+/*
+ * _nvm_rewrite_begin()  - start filling the other area under the next generation
+ * _nvm_rewrite_append() - add a record to it, programming each page as it fills
+ * _nvm_rewrite_end()    - finish the area and make it the active one
+ *
+ *  Blocking. Each page of the new area is erased as it is written, and the header goes in
+ *  last so the new area isn't used unless the rewrite completed. The page after the last
+ *  record is left erased, so stale records from an old generation never follow the end of
+ *  the log.
+ */
+
+static void _nvm_rewrite_begin(nvmRewrite_t *rw)
+{
+    rw->area = nvm.area ^ 1;
+    rw->generation = nvm.generation + 1;
+    rw->slot = 1;
+    memset(rw->page, 0xFF, sizeof(rw->page));
+}
+
+static void _nvm_rewrite_append(nvmRewrite_t *rw, uint16_t index, uint32_t value)
+{
+    if (rw->slot == NVM_AREA_RECORDS) {
+        rpt_exception(STAT_PERSISTENCE_ERROR, "persistence area too small for all persisted values");
+        return;
+    }
+    _make_record(&rw->page[rw->slot % NVM_RECORDS_PER_PAGE], index, value, rw->generation);
+    if ((++rw->slot % NVM_RECORDS_PER_PAGE) == 0) {
+        _nvm_command(rw->area, (rw->slot-1) / NVM_RECORDS_PER_PAGE, rw->page, true);
+        _nvm_wait();                                    // the page is reused for the next one
+        memset(rw->page, 0xFF, sizeof(rw->page));
+    }
+}
+
+static void _nvm_rewrite_end(nvmRewrite_t *rw)
+{
+    if ((rw->slot % NVM_RECORDS_PER_PAGE) != 0) {
+        _nvm_command(rw->area, rw->slot / NVM_RECORDS_PER_PAGE, rw->page, true);
+        _nvm_wait();
+    } else if (rw->slot < NVM_AREA_RECORDS) {           // ended on a page boundary - erase the next page
+        _nvm_command(rw->area, rw->slot / NVM_RECORDS_PER_PAGE, rw->page, true);
+        _nvm_wait();
+    }
+
+    // write the header into slot 0, which every program above left erased
+    memset(rw->page, 0xFF, sizeof(rw->page));
+    _make_record(&rw->page[0], NVM_HEADER, rw->generation, rw->generation);
+    _nvm_command(rw->area, 0, rw->page, false);
+    _nvm_wait();
+
+    nvm.area = rw->area;
+    nvm.generation = rw->generation;
+    nvm.next = rw->slot;
+    _nvm_load_page();
+    nvm.page_erased = true;
+}
+
+/*
+ * _nvm_compact() - copy the latest value of every persisted index to the other area and swap
+ *
+ *  Normally run from persistence_callback() before the area fills, so it happens outside a
+ *  machining cycle.
+ */
+
+static void _nvm_compact()
+{
+    nvmRewrite_t rw;
+    uint32_t value;
+
+    _nvm_rewrite_begin(&rw);
+    for (index_t i=0; nv_index_is_single(i); i++) {
+        if ((i != 0) && !(cfgArray[i].flags & F_PERSIST)) {     // index 0 (fb) is always kept
+            continue;
+        }
+        if (_nvm_find(i, value)) {
+            _nvm_rewrite_append(&rw, i, value);
+        }
+    }
+    _nvm_rewrite_end(&rw);
+}
+
+/*
+ * _nvm_append() - stage a record, and start programming the page if that filled it
+ */
+
+static void _nvm_append(uint16_t index, uint32_t value)
+{
+    if (nvm.next == NVM_AREA_RECORDS) {
+        _nvm_compact();
+    }
+    _make_record(&nvm.page[nvm.next % NVM_RECORDS_PER_PAGE], index, value, nvm.generation);
+    nvm.next++;
+    nvm.dirty = true;
+    if ((nvm.next % NVM_RECORDS_PER_PAGE) == 0) {       // the latch is loaded on the command, so
+        _nvm_program();                                 // the page copy can be reset straight away
+        memset(nvm.page, 0xFF, sizeof(nvm.page));
+        nvm.page_erased = false;
+        if (nvm.next < NVM_AREA_RECORDS) {              // erase the next page now, so the log always
+            _nvm_command(nvm.area, nvm.next / NVM_RECORDS_PER_PAGE, nvm.page, true); // ends on erased flash
+            nvm.page_erased = true;
+        }
+    }
+}
 
 /***********************************************************************************
  **** CODE *************************************************************************
  ***********************************************************************************/
 
+/*
+ * persistence_init() - find the active area and the end of its log, or format a new one
+ */
+
 void persistence_init()
 {
-    return;
+    memset(&nvm, 0, sizeof(nvm));
+    uint32_t generation[2] = { 0, 0 };
+
+    for (uint8_t a=0; a < 2; a++) {
+        const nvmRecord_t *r = _record(a, 0);
+        if ((r->index == NVM_HEADER) && _is_valid(r, r->value)) {
+            generation[a] = r->value;
+        }
+    }
+    if ((generation[0] == 0) && (generation[1] == 0)) { // nothing valid - start a new log in area 0
+        nvm.area = 0;
+        nvm.generation = 1;
+        nvm.next = 0;
+        _nvm_load_page();
+        _nvm_append(NVM_HEADER, nvm.generation);
+        nvm.ready = true;
+        return;
+    }
+    nvm.area = (generation[1] > generation[0]) ? 1 : 0;
+    nvm.generation = generation[nvm.area];
+    for (nvm.next = 1; nvm.next < NVM_AREA_RECORDS; nvm.next++) {
+        if (!_is_valid(_record(nvm.area, nvm.next), nvm.generation)) {
+            break;
+        }
+    }
+    _nvm_load_page();
+    nvm.ready = true;
 }
 
 /*
- * read_persistent_value()	- return value (as float) by index
+ * read_persistent_value()	- return value by index
  *
  *	It's the responsibility of the caller to make sure the index does not exceed range
+ *  Returns STAT_NOOP if the index has never been persisted.
  */
 
 stat_t read_persistent_value(nvObj_t *nv)
 {
-    nv->value_flt = 0;
+    uint32_t value;
+    if (!nvm.ready || !_nvm_find(nv->index, value)) {
+        return (STAT_NOOP);
+    }
+    uint8_t type = cfgArray[nv->index].flags & F_TYPE_MASK;
+    if ((type == TYPE_INTEGER) || (type == TYPE_BOOLEAN)) {
+        nv->value_int = (int32_t)value;
+    } else {
+        memcpy(&nv->value_flt, &value, sizeof(value));
+    }
     return (STAT_OK);
 }
 
+/*
+ * load_persistent_values() - set every persisted value, oldest record first
+ *
+ *  One pass over the log instead of a search per index, so it's the cost of reading the
+ *  area once. A value changed more than once is set more than once, and the latest record
+ *  is the one left standing - the same value read_persistent_value() would return.
+ */
+
+void load_persistent_values(nvObj_t *nv)
+{
+    if (!nvm.ready) {
+        return;
+    }
+    uint16_t first = nvm.next - (nvm.next % NVM_RECORDS_PER_PAGE);
+    _nvm_wait();
+    for (uint16_t slot = 1; slot < nvm.next; slot++) {  // slot 0 is the header
+        const nvmRecord_t *r = (slot < first) ? _record(nvm.area, slot) : &nvm.page[slot - first];
+        if (!nv_index_is_single(r->index) || !(cfgArray[r->index].flags & F_PERSIST)) {
+            continue;
+        }
+        nv->index = r->index;
+        uint8_t type = cfgArray[nv->index].flags & F_TYPE_MASK;
+        if ((type == TYPE_INTEGER) || (type == TYPE_BOOLEAN)) {
+            nv->value_int = (int32_t)r->value;
+        } else {
+            memcpy(&nv->value_flt, &r->value, sizeof(r->value));
+        }
+        strncpy(nv->token, cfgArray[nv->index].token, TOKEN_LEN);
+        cfgArray[nv->index].set(nv);
+    }
+}
+
+/*
+ * persistence_rewrite_begin() - send the writes that follow to a fresh area
+ * persistence_rewrite_end()   - make that area the active one
+ *
+ *  For writing every persisted value at once, as a defaults load does. Each write is
+ *  appended without looking for a previous value, and the old area stays in charge until
+ *  the end, so a reset part way through leaves the settings as they were.
+ */
+
+void persistence_rewrite_begin()
+{
+    if (!nvm.ready) {
+        return;
+    }
+    if (nvm.dirty) {                                    // commit what's staged in the old area
+        _nvm_program();
+    }
+    _nvm_wait();
+    _nvm_rewrite_begin(&nvm.rw);
+    nvm.rewriting = true;
+}
+
+void persistence_rewrite_end()
+{
+    if (!nvm.rewriting) {
+        return;
+    }
+    nvm.rewriting = false;
+    _nvm_rewrite_end(&nvm.rw);
+}
+
 /*
  * write_persistent_value() - write to NVM by index, but only if the value has changed
  *
@@ -74,5 +401,75 @@ stat_t write_persistent_value(nvObj_t *nv)
 //    if (cm->cycle_state != CYCLE_OFF) { // can't write when machine is moving
 //        return(rpt_exception(STAT_FILE_NOT_OPEN, "write_persistent_value() can't write when machine is in cycle"));
 //    }
+    if (!nvm.ready) {
+        return (STAT_OK);
+    }
+    uint32_t value, previous;
+    uint8_t type = cfgArray[nv->index].flags & F_TYPE_MASK;
+    if ((type == TYPE_INTEGER) || (type == TYPE_BOOLEAN)) {
+        value = (uint32_t)nv->value_int;
+    } else {
+        memcpy(&value, &nv->value_flt, sizeof(value));
+    }
+    if (nvm.rewriting) {                                // the new area starts empty - nothing to compare
+        _nvm_rewrite_append(&nvm.rw, nv->index, value);
+        return (STAT_OK);
+    }
+    if (_nvm_find(nv->index, previous) && (previous == value)) {
+        return (STAT_OK);                               // unchanged
+    }
+    _nvm_append(nv->index, value);
     return (STAT_OK);
 }
+
+/*
+ * persistence_callback() - commit staged records and swap areas when not in a machining cycle
+ */
+
+stat_t persistence_callback()
+{
+    if (nvm.busy && (EFC1->EEFC_FSR & EEFC_FSR_FRDY)) {
+        nvm.busy = false;
+    }
+    if (!nvm.ready || nvm.busy || (cm->cycle_type != CYCLE_NONE)) {
+        return (STAT_NOOP);
+    }
+    if (nvm.next >= (NVM_AREA_RECORDS - NVM_COMPACT_MARGIN)) {
+        _nvm_compact();
+        return (STAT_OK);
+    }
+    if (nvm.dirty) {
+        _nvm_program();
+        return (STAT_OK);
+    }
+    return (STAT_NOOP);
+}
+
+#else // PERSISTENCE_ENABLED
+
+void persistence_init()
+{
+    return;
+}
+
+stat_t read_persistent_value(nvObj_t *nv)
+{
+    nv->value_flt = 0;
+    return (STAT_NOOP);
+}
+
+stat_t write_persistent_value(nvObj_t *nv)
+{
+    return (STAT_OK);
+}
+
+void load_persistent_values(nvObj_t *nv) {}
+void persistence_rewrite_begin() {}
+void persistence_rewrite_end() {}
+
+stat_t persistence_callback()
+{
+    return (STAT_NOOP);
+}
+
+#endif // PERSISTENCE_ENABLED
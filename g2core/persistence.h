@@ -25,28 +25,92 @@
  * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+/*
+ * FLASH PERSISTENCE
+ *
+ *  When PERSISTENCE_ENABLED is true, settings marked F_PERSIST are kept in the top of the
+ *  internal flash so they survive a reset. Without it (the default) every boot loads the
+ *  settings file defaults, as before.
+ *
+ *  The store is a log of 8 byte records keyed by cfgArray index, in one of two equal
+ *  areas. A changed value is appended; the latest record for an index wins. When the
+ *  active area fills, the latest value of every persisted index is copied to the other
+ *  area under the next generation number and the areas swap, which spreads erases over
+ *  both. Each record carries a CRC-8 and the low byte of its area's generation, so the
+ *  end of the log is the first record that doesn't check out. Each area starts with a
+ *  header record holding the full generation; it is written last when an area is filled,
+ *  so an interrupted copy leaves the old area in charge.
+ *
+ *  Appends are staged in a RAM copy of the page being filled. A page is programmed when it
+ *  fills, and partial pages are committed from persistence_callback() once the machine isn't
+ *  in a cycle - the same rule cm_deferred_write_callback() uses. Records that are still
+ *  being staged when the power goes are lost.
+ *
+ *  The record for index 0 (fb, the firmware build) is written after a defaults load. At boot
+ *  the persisted values are used only if it matches the running build, so a new build or
+ *  $defa=1 reloads the settings file.
+ *
+ *  Boot reads the store in one pass: the defaults are set, then every record in the log is
+ *  set in order (load_persistent_values()). A defaults load writes its values into a fresh
+ *  area (persistence_rewrite_begin()) rather than looking each one up in the old log.
+ *
+ *  The flash backend is SAM3X only: the store sits at the top of flash bank 1 and is
+ *  programmed by EFC1 while code runs from bank 0.
+ */
+
 #ifndef PERSISTENCE_H_ONCE
 #define PERSISTENCE_H_ONCE
 
 #include "config.h"  // needed for nvObj_t definition
 
-#define NVM_VALUE_LEN 4       // NVM value length (float, fixed length)
-#define NVM_BASE_ADDR 0x0000  // base address of usable NVM
+#if PERSISTENCE_ENABLED == true
+
+#define NVM_PAGE_SIZE 256                                   // bytes per flash page
+#define NVM_AREA_PAGES 64                                   // pages in each of the two log areas
+#define NVM_RECORDS_PER_PAGE (NVM_PAGE_SIZE / sizeof(nvmRecord_t))
+#define NVM_AREA_RECORDS (NVM_AREA_PAGES * NVM_RECORDS_PER_PAGE)
+#define NVM_HEADER 0xFFFE                                   // record index of an area header
+#define NVM_COMPACT_MARGIN (2 * NVM_RECORDS_PER_PAGE)       // start copying to the other area when this close to full
+
+typedef struct nvmRecord {
+    uint16_t index;                 // cfgArray index, or NVM_HEADER
+    uint8_t generation;             // low byte of the area generation
+    uint8_t crc;                    // CRC-8 over the other 7 bytes
+    uint32_t value;                 // value bits - float or int32 by the cfgArray type; generation in a header
+} nvmRecord_t;
+
+typedef struct nvmRewrite {         // an area being filled from scratch - see _nvm_rewrite_begin()
+    uint8_t area;                   // area being filled
+    uint32_t generation;            // generation it will have
+    uint16_t slot;                  // next free record
+    nvmRecord_t page[NVM_RECORDS_PER_PAGE]; // the page holding 'slot'
+} nvmRewrite_t;
 
 //**** persistence singleton ****
 
 typedef struct nvmSingleton {
-    uint16_t base_addr;     // NVM base address
-    uint16_t profile_base;  // NVM base address of current profile]
-    uint16_t address;
-    float    tmp_value;
-    int8_t   byte_array[NVM_VALUE_LEN];
+    bool ready;                     // persistence_init() has found or formatted a log
+    bool busy;                      // a flash command has been started and not yet finished
+    bool dirty;                     // the staged page has records not yet programmed
+    bool page_erased;               // the staged page has been erased by an earlier program
+    uint8_t area;                   // active area, 0 or 1
+    uint32_t generation;            // generation of the active area
+    uint16_t next;                  // next free record in the active area
+    nvmRecord_t page[NVM_RECORDS_PER_PAGE]; // RAM copy of the page holding 'next'
+    bool rewriting;                 // writes go to rw - see persistence_rewrite_begin()
+    nvmRewrite_t rw;
 } nvmSingleton_t;
 
+#endif // PERSISTENCE_ENABLED
+
 //**** persistence function prototypes ****
 
 void persistence_init(void);
 stat_t read_persistent_value(nvObj_t* nv);
 stat_t write_persistent_value(nvObj_t* nv);
+void load_persistent_values(nvObj_t* nv);
+void persistence_rewrite_begin(void);
+void persistence_rewrite_end(void);
+stat_t persistence_callback(void);
 
 #endif  // End of include guard: PERSISTENCE_H_ONCE
@@ -22,14 +22,21 @@
 #include "canonical_machine.h"
 #include "plan_arc.h"
 #include "planner.h"
+#include "spindle.h"
+#include "cpuload.h"
 #include "util.h"
 
 // Local functions
 
 static stat_t _compute_arc(const bool radius_f);
 static void _compute_arc_offsets_from_radius(void);
+static void _compute_arc_extents(void);
 static float _estimate_arc_time (float arc_time);
 static stat_t _test_arc_soft_limits(void);
+static bool _arc_is_native(void);
+static stat_t _test_spline_soft_limits(const float control[4][3]);
+static stat_t _queue_native_arc(void);
+static stat_t _arc_segment(cmMachine_t *_cm);
 
 /*****************************************************************************
  * Canonical Machining arc functions (arc prep for planning and runtime)
@@ -64,7 +71,17 @@ void cm_abort_arc(cmMachine_t *_cm)
  * cm_arc_callback() - generate an arc
  *
  *  cm_arc_cycle_callback() is called from the controller main loop. Each time it's called
- *  it queues as many arc segments (lines) as it can before it blocks, then returns.
+ *  it queues as many arc segments (lines) as it can before it blocks, then returns. It stops
+ *  when the planner is down to PLANNER_BUFFER_HEADROOM or when the pass has used the {arcb:}
+ *  time budget, so an arc fills the queue as fast as short lines do without starving the
+ *  rest of the main loop. A zero budget queues one segment per pass. Only arcs that cannot
+ *  be queued as a native arc block are run this way (see _arc_is_native()).
+ *
+ *  Segment endpoints are generated by rotating the radial vector from the center through
+ *  segment_theta with a precomputed rotation matrix - 4 multiplies instead of a sin and a cos.
+ *  Float round-off makes the radius and angle drift slowly, so every ARC_RESYNC_SEGMENTS the
+ *  vector is recomputed exactly from the accumulated theta. That bounds the error to what
+ *  the recurrence can accumulate in those few segments, far below a step.
  */
 
 stat_t cm_arc_callback(cmMachine_t *_cm)
@@ -72,12 +89,38 @@ stat_t cm_arc_callback(cmMachine_t *_cm)
     if (_cm->arc.run_state == BLOCK_INACTIVE) {
         return (STAT_NOOP);
     }
-    if (mp_planner_is_full(mp)) {
-        return (STAT_EAGAIN);
-    }
+    ldScope _ld(LOAD_MAIN);
+    uint32_t budget = (uint32_t)(_cm->arc_time_budget * (SystemCoreClock / 1000000));
+    uint32_t start = cycle_count();
+    do {
+        if (mp_planner_is_full(mp)) {
+            return (STAT_EAGAIN);
+        }
+        if (_arc_segment(_cm) == STAT_OK) {
+            _cm->arc.run_state = BLOCK_INACTIVE;
+            return (STAT_OK);
+        }
+    } while ((cycle_count() - start) < budget);
+    return (STAT_EAGAIN);
+}
+
+/*
+ * _arc_segment() - queue the next arc segment. Returns STAT_OK after the last one
+ */
+
+static stat_t _arc_segment(cmMachine_t *_cm)
+{
     _cm->arc.theta += _cm->arc.segment_theta;
-    _cm->arc.gm.target[_cm->arc.plane_axis_0] = _cm->arc.center_0 + sin(_cm->arc.theta) * _cm->arc.radius;
-    _cm->arc.gm.target[_cm->arc.plane_axis_1] = _cm->arc.center_1 + cos(_cm->arc.theta) * _cm->arc.radius;
+    if (((_cm->arc.segment_count - 1) % ARC_RESYNC_SEGMENTS) == 0) {     // includes the last segment
+        _cm->arc.radial_0 = sin(_cm->arc.theta) * _cm->arc.radius;
+        _cm->arc.radial_1 = cos(_cm->arc.theta) * _cm->arc.radius;
+    } else {
+        float radial_0 = _cm->arc.radial_0;
+        _cm->arc.radial_0 = radial_0 * _cm->arc.segment_cos + _cm->arc.radial_1 * _cm->arc.segment_sin;
+        _cm->arc.radial_1 = _cm->arc.radial_1 * _cm->arc.segment_cos - radial_0 * _cm->arc.segment_sin;
+    }
+    _cm->arc.gm.target[_cm->arc.plane_axis_0] = _cm->arc.center_0 + _cm->arc.radial_0;
+    _cm->arc.gm.target[_cm->arc.plane_axis_1] = _cm->arc.center_1 + _cm->arc.radial_1;
     _cm->arc.gm.target[_cm->arc.linear_axis] += _cm->arc.segment_linear_travel;
 
     mp_aline(&(_cm->arc.gm));                            // run the line
@@ -86,15 +129,14 @@ stat_t cm_arc_callback(cmMachine_t *_cm)
     if (--(_cm->arc.segment_count) > 0) {
         return (STAT_EAGAIN);
     }
-    _cm->arc.run_state = BLOCK_INACTIVE;
     return (STAT_OK);
 }
 
 /*
  * cm_arc_feed() - canonical machine entry point for arcs
  *
- * Generates an arc by queuing line segments to the move buffer. The arc is
- * approximated by generating a large number of tiny, linear segments.
+ * Queues the arc as a single planner block if it can (see mp_arc()). Otherwise the arc is
+ * approximated by queuing a large number of tiny, linear segments from cm_arc_callback().
  */
 
 stat_t cm_arc_feed(const float target[], const bool target_f[],     // target endpoint
@@ -250,12 +292,169 @@ stat_t cm_arc_feed(const float target[], const bool target_f[],     // target en
         return (cm_alarm(status, "arc soft_limits"));       // throw an alarm
     }
 
+    ritorno(spindle_spinup_wait_sync());                    // wait out an overlapped spinup
     cm_cycle_start();                                       // if not already started
-    cm->arc.run_state = BLOCK_ACTIVE;                       // enable arc to be run from the callback
+    if (_arc_is_native()) {
+        ritorno(_queue_native_arc());
+    } else {
+        if (cm->arc.gm.feed_rate_mode == INVERSE_TIME_MODE) {
+            cm->arc.gm.feed_rate /= cm->arc.segments;       // inverse time applies to each segment
+        }
+        cm->arc.gm.target[cm->arc.linear_axis] = cm->arc.position[cm->arc.linear_axis];    // initialize the linear target
+        cm->arc.segment_sin = sin(cm->arc.segment_theta);  // rotation for the segment recurrence
+        cm->arc.segment_cos = cos(cm->arc.segment_theta);
+        cm->arc.radial_0 = sin(cm->arc.theta) * cm->arc.radius;
+        cm->arc.radial_1 = cos(cm->arc.theta) * cm->arc.radius;
+        cm->arc.run_state = BLOCK_ACTIVE;                   // enable arc to be run from the callback
+    }
     cm_update_model_position();
     return (STAT_OK);
 }
 
+/*
+ * cm_spline_feed() - canonical machine entry point for splines (G5, G5.1)
+ *
+ *  G5 X Y I J P Q runs a cubic Bezier from the current position to X Y. I J is the offset
+ *  from the start to the first control point and P Q the offset from the end to the second.
+ *  A G5 that follows a G5 may leave out I J; it then leaves in the direction the last one
+ *  arrived (I J = -P -Q of the last G5). G5.1 X Y I J is a quadratic with its one control
+ *  point at I J from the start, run as the equivalent cubic. The offsets are always
+ *  incremental. Splines are in the G17 (XY) plane; Z may move, linearly in the curve
+ *  parameter. The whole spline is one planner block (see mp_spline()).
+ */
+
+stat_t cm_spline_feed(const float target[], const bool target_f[],
+                      const float offset[], const bool offset_f[],
+                      const float P_word, const bool P_word_f,
+                      const float Q_word, const bool Q_word_f,
+                      const cmMotionMode motion_mode)
+{
+    // as with arcs, a non-modal word in G5 motion mode is not a move
+    if (!(target_f[AXIS_X] | target_f[AXIS_Y] | target_f[AXIS_Z] |
+          offset_f[OFS_I] | offset_f[OFS_J] | P_word_f | Q_word_f)) {
+        return (STAT_OK);
+    }
+
+    // trap missing feed rate
+    if (fp_ZERO(cm->gm.feed_rate)) {
+        return (STAT_FEEDRATE_NOT_SPECIFIED);
+    }
+
+    // the spline block only runs X, Y and Z
+    if (cm->gm.select_plane != CANON_PLANE_XY) {
+        return (STAT_ARC_SPECIFICATION_ERROR);
+    }
+    for (uint8_t axis = AXIS_Z+1; axis < AXES; axis++) {
+        if (target_f[axis]) {
+            return (STAT_ARC_SPECIFICATION_ERROR);
+        }
+    }
+
+    // first control point offset - I J, or carried over from the last G5
+    float offset_i, offset_j;
+    if (offset_f[OFS_I] && offset_f[OFS_J]) {
+        offset_i = _to_millimeters(offset[OFS_I]);
+        offset_j = _to_millimeters(offset[OFS_J]);
+    } else if (!offset_f[OFS_I] && !offset_f[OFS_J] &&
+               (motion_mode == MOTION_MODE_CUBIC_SPLINE) && (cm->gm.motion_mode == MOTION_MODE_CUBIC_SPLINE)) {
+        offset_i = -cm->spline_pq[0];
+        offset_j = -cm->spline_pq[1];
+    } else {
+        return (STAT_ARC_OFFSETS_MISSING_FOR_SELECTED_PLANE);
+    }
+    if ((motion_mode == MOTION_MODE_CUBIC_SPLINE) && !(P_word_f && Q_word_f)) {
+        return (STAT_ARC_OFFSETS_MISSING_FOR_SELECTED_PLANE);
+    }
+
+    // set values in the Gcode model state
+    cm_set_model_target(target, target_f);
+
+    float control[4][3];
+    for (uint8_t a = 0; a < 3; a++) {
+        control[0][a] = cm->gmx.position[a];
+        control[3][a] = cm->gm.target[a];
+    }
+    float z_third = (control[3][AXIS_Z] - control[0][AXIS_Z]) / 3;
+    control[1][AXIS_Z] = control[0][AXIS_Z] + z_third;
+    control[2][AXIS_Z] = control[3][AXIS_Z] - z_third;
+    if (motion_mode == MOTION_MODE_CUBIC_SPLINE) {
+        cm->spline_pq[0] = _to_millimeters(P_word);
+        cm->spline_pq[1] = _to_millimeters(Q_word);
+        control[1][AXIS_X] = control[0][AXIS_X] + offset_i;
+        control[1][AXIS_Y] = control[0][AXIS_Y] + offset_j;
+        control[2][AXIS_X] = control[3][AXIS_X] + cm->spline_pq[0];
+        control[2][AXIS_Y] = control[3][AXIS_Y] + cm->spline_pq[1];
+    } else {                                                // raise the quadratic to a cubic
+        float quad_x = control[0][AXIS_X] + offset_i;
+        float quad_y = control[0][AXIS_Y] + offset_j;
+        control[1][AXIS_X] = control[0][AXIS_X] + (quad_x - control[0][AXIS_X]) * 2/3;
+        control[1][AXIS_Y] = control[0][AXIS_Y] + (quad_y - control[0][AXIS_Y]) * 2/3;
+        control[2][AXIS_X] = control[3][AXIS_X] + (quad_x - control[3][AXIS_X]) * 2/3;
+        control[2][AXIS_Y] = control[3][AXIS_Y] + (quad_y - control[3][AXIS_Y]) * 2/3;
+    }
+    ritorno(_test_spline_soft_limits(control));             // test soft limits; exit if thrown
+
+    cm->gm.motion_mode = motion_mode;
+    cm_set_display_offsets(&cm->gm);                        // capture the fully resolved offsets to the state
+    cm_cycle_start();                                       // if not already started
+    stat_t status = mp_spline(&cm->gm, control);
+    cm_update_model_position();
+
+    if (status == STAT_MINIMUM_LENGTH_MOVE) {
+        if (!mp_has_runnable_buffer(mp)) {                  // handle condition where zero-length move is last or only move
+            cm_cycle_end();                                 // ...otherwise cycle will not end properly
+        }
+        status = STAT_OK;
+    }
+    return (status);
+}
+
+/*
+ * _arc_is_native() - true if the arc can be queued as a single planner block
+ *
+ *  The planner runs arcs in its own coordinate space, so the arc must still be a circle
+ *  after _rotate_target(): the rotation matrix must be identity. Axes outside the arc plane
+ *  and linear axis must not move, as the arc block has no way to interpolate them.
+ */
+
+static bool _arc_is_native()
+{
+    for (uint8_t i = 0; (i < 3) && !cm->rotation_identity; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            if (!fp_EQ(cm->rotation_matrix[i][j], ((i == j) ? 1.0 : 0.0))) {
+                return (false);
+            }
+        }
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if ((axis != cm->arc.plane_axis_0) && (axis != cm->arc.plane_axis_1) && (axis != cm->arc.linear_axis) &&
+            (!fp_EQ(cm->arc.gm.target[axis], cm->arc.position[axis]))) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+/*
+ * _queue_native_arc() - hand the arc to the planner as helix geometry over path length
+ */
+
+static stat_t _queue_native_arc()
+{
+    mpArc_t arc;
+    arc.center_0 = cm->arc.center_0;
+    arc.center_1 = cm->arc.center_1;
+    arc.radius = cm->arc.radius;
+    arc.theta = cm->arc.theta;
+    arc.theta_per_mm = cm->arc.angular_travel / cm->arc.length;
+    arc.linear_start = cm->arc.position[cm->arc.linear_axis];
+    arc.linear_per_mm = cm->arc.linear_travel / cm->arc.length;
+    arc.plane_axis_0 = cm->arc.plane_axis_0;
+    arc.plane_axis_1 = cm->arc.plane_axis_1;
+    arc.linear_axis = cm->arc.linear_axis;
+    return (mp_arc(&(cm->arc.gm), &arc, cm->arc.length));
+}
+
 /*
  * _compute_arc() - compute arc from I and J (arc center point)
  *
@@ -339,25 +538,26 @@ static stat_t _compute_arc(const bool radius_f)
     cm->arc.linear_travel = cm->arc.gm.target[cm->arc.linear_axis] - cm->arc.position[cm->arc.linear_axis];
     cm->arc.planar_travel = cm->arc.angular_travel * cm->arc.radius;
     cm->arc.length = hypotf(cm->arc.planar_travel, fabs(cm->arc.linear_travel));
+    cm->arc.center_0 = cm->arc.position[cm->arc.plane_axis_0] - sin(cm->arc.theta) * cm->arc.radius;
+    cm->arc.center_1 = cm->arc.position[cm->arc.plane_axis_1] - cos(cm->arc.theta) * cm->arc.radius;
 
-    // Find the minimum number of segments that meet accuracy and time constraints...
-    // Note: removed segment_length test as segment_time accounts for this (build 083.37)
+    // Find the number of segments that meet the chordal tolerance, no shorter than a minimum
+    // block at the planned feed. A chord through angle a deviates r(1 - cos(a/2)) from the
+    // circle, so the widest chord is 2 acos(1 - ct/r). It is taken on the angle rather than
+    // the length so a helix is cut the same as its planar arc - the linear travel is straight.
     float arc_time;
-    float segments_for_minimum_time = _estimate_arc_time(arc_time) * (MICROSECONDS_PER_MINUTE / MIN_ARC_SEGMENT_USEC);
-    float segments_for_chordal_accuracy = cm->arc.length / sqrt(4*cm->chordal_tolerance * (2 * cm->arc.radius - cm->chordal_tolerance));
-    cm->arc.segments = floor(min(segments_for_chordal_accuracy, segments_for_minimum_time));
+    _compute_arc_extents();
+    float chord_angle = 2 * acos(max((float)(1 - cm->chordal_tolerance / cm->arc.radius), (float)-1.0));
+    float segments_for_chordal_accuracy = fabs(cm->arc.angular_travel) / min(chord_angle, ARC_CHORD_ANGLE_MAX);
+    float segments_for_minimum_time = _estimate_arc_time(arc_time) / MIN_BLOCK_TIME;
+    cm->arc.segments = ceil(segments_for_chordal_accuracy);
+    cm->arc.segments = min(cm->arc.segments, (float)floor(segments_for_minimum_time));
     cm->arc.segments = max(cm->arc.segments, (float)1.0);        //...but is at least 1 segment
 
-    if (cm->arc.gm.feed_rate_mode == INVERSE_TIME_MODE) {
-        cm->arc.gm.feed_rate /= cm->arc.segments;
-    }
     // setup the rest of the arc parameters
     cm->arc.segment_count = (int32_t)cm->arc.segments;
     cm->arc.segment_theta = cm->arc.angular_travel / cm->arc.segments;
     cm->arc.segment_linear_travel = cm->arc.linear_travel / cm->arc.segments;
-    cm->arc.center_0 = cm->arc.position[cm->arc.plane_axis_0] - sin(cm->arc.theta) * cm->arc.radius;
-    cm->arc.center_1 = cm->arc.position[cm->arc.plane_axis_1] - cos(cm->arc.theta) * cm->arc.radius;
-    cm->arc.gm.target[cm->arc.linear_axis] = cm->arc.position[cm->arc.linear_axis];    // initialize the linear target
     return (STAT_OK);
 }
 
@@ -477,15 +677,76 @@ static void _compute_arc_offsets_from_radius()
     cm->arc.ijk_offset[cm->arc.linear_axis] = 0;
 }
 
+/*
+ * _compute_arc_extents() - analytic bounding box and per-axis velocity share of the arc
+ *
+ *  With theta measured from the positive plane axis 1 the arc is:
+ *
+ *      p0 = center_0 + radius * sin(theta)     velocity share |cos(theta)|
+ *      p1 = center_1 + radius * cos(theta)     velocity share |sin(theta)|
+ *
+ *  so plane axis 0 peaks at theta = +/-PI/2 and plane axis 1 at theta = 0 and PI. Each
+ *  axis's box is the span of the start and end points, widened to center +/- radius for
+ *  every one of those quadrant crossings that falls inside the sweep. The tangent points
+ *  purely along one plane axis exactly where the other one peaks, so the same crossings
+ *  give the peak velocity share of each plane axis. The linear axis and any other axes
+ *  move linearly, so their endpoints bound them.
+ *
+ *  This is constant cost regardless of arc length or rotations. Must be called after
+ *  theta, angular_travel and the center are set.
+ */
+
+static bool _arc_crosses(const float angle)
+{
+    if (fabs(cm->arc.angular_travel) >= 2*M_PI) {
+        return (true);
+    }
+    float theta_end = cm->arc.theta + cm->arc.angular_travel;
+    float start = min(cm->arc.theta, theta_end);
+    float end = max(cm->arc.theta, theta_end);
+    float first = angle + 2*M_PI * ceil((start - angle) / (2*M_PI)); // first angle + 2k*PI at or after start
+    return (first <= end);
+}
+
+static void _compute_arc_extents()
+{
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        cm->arc.extent_min[axis] = min(cm->arc.position[axis], cm->arc.gm.target[axis]);
+        cm->arc.extent_max[axis] = max(cm->arc.position[axis], cm->arc.gm.target[axis]);
+    }
+    uint8_t axis_0 = cm->arc.plane_axis_0;
+    uint8_t axis_1 = cm->arc.plane_axis_1;
+    bool max_0 = _arc_crosses(M_PI/2);
+    bool min_0 = _arc_crosses(-M_PI/2);
+    bool max_1 = _arc_crosses(0);
+    bool min_1 = _arc_crosses(M_PI);
+    if (max_0) { cm->arc.extent_max[axis_0] = max(cm->arc.extent_max[axis_0], cm->arc.center_0 + cm->arc.radius); }
+    if (min_0) { cm->arc.extent_min[axis_0] = min(cm->arc.extent_min[axis_0], cm->arc.center_0 - cm->arc.radius); }
+    if (max_1) { cm->arc.extent_max[axis_1] = max(cm->arc.extent_max[axis_1], cm->arc.center_1 + cm->arc.radius); }
+    if (min_1) { cm->arc.extent_min[axis_1] = min(cm->arc.extent_min[axis_1], cm->arc.center_1 - cm->arc.radius); }
+
+    float theta_end = cm->arc.theta + cm->arc.angular_travel;
+    if (max_1 || min_1) {
+        cm->arc.velocity_fraction_0 = 1.0;
+    } else {
+        cm->arc.velocity_fraction_0 = max((float)fabs(cos(cm->arc.theta)), (float)fabs(cos(theta_end)));
+    }
+    if (max_0 || min_0) {
+        cm->arc.velocity_fraction_1 = 1.0;
+    } else {
+        cm->arc.velocity_fraction_1 = max((float)fabs(sin(cm->arc.theta)), (float)fabs(sin(theta_end)));
+    }
+}
+
 /*
  * _estimate_arc_time ()
  *
  *  Returns a naiive estimate of arc execution time to inform segment calculation.
  *  The arc time is computed not to exceed the time taken in the slowest dimension
  *  in the arc plane or in linear travel. Maximum feed rates are compared in each
- *  dimension, but the comparison assumes that the arc will have at least one segment
- *  where the unit vector is 1 in that dimension. This is not true for any arbitrary arc,
- *  with the result that the time returned may be less than optimal.
+ *  dimension, scaled by the peak share of the arc velocity that dimension actually sees
+ *  over the sweep (see _compute_arc_extents()). Arcs that never run parallel to an axis
+ *  are not held to that axis's maximum feed rate.
  */
 static float _estimate_arc_time (float arc_time)
 {
@@ -497,8 +758,8 @@ static float _estimate_arc_time (float arc_time)
     }
 
     // Downgrade the time if there is a rate-limiting axis
-    arc_time = max(arc_time, (float)fabs(cm->arc.planar_travel/cm->a[cm->arc.plane_axis_0].feedrate_max));
-    arc_time = max(arc_time, (float)fabs(cm->arc.planar_travel/cm->a[cm->arc.plane_axis_1].feedrate_max));
+    arc_time = max(arc_time, (float)fabs(cm->arc.planar_travel * cm->arc.velocity_fraction_0 / cm->a[cm->arc.plane_axis_0].feedrate_max));
+    arc_time = max(arc_time, (float)fabs(cm->arc.planar_travel * cm->arc.velocity_fraction_1 / cm->a[cm->arc.plane_axis_1].feedrate_max));
     if (fabs(cm->arc.linear_travel) > 0) {
         arc_time = max(arc_time, (float)fabs(cm->arc.linear_travel/cm->a[cm->arc.linear_axis].feedrate_max));
     }
@@ -508,87 +769,70 @@ static float _estimate_arc_time (float arc_time)
 /*
  * _test_arc_soft_limits() - return error code if soft limit is exceeded
  *
- *  Test if arc extends beyond arc plane boundaries set in soft limits.
- *
- *  The arc starting position (P) and target (T) define 2 points that divide the
- *  arc plane into 9 rectangles. The center of the arc is (C). P and T define the
- *  endpoints of two possible arcs; one that is less than or equal to 180 degrees (acute)
- *  and one that is greater than 180 degrees (obtuse), depending on the location of (C).
- *
- *  -------------------------------  plane boundaries in X and Y
- *  |         |         |         |
- *  |    1    |    2    |    3    |
- *  |                   |         |
- *  --------- P -------------------
- *  |                   |         |
- *  |    4    |    5    |    6    |
- *  |         |                   |
- *  ------------------- T ---------
- *  |        C|                   |  C shows one of many possible center locations
- *  |    7    |    8    |    9    |
- *  |         |         |         |
- *  -------------------------------
- *
- *  C will fall along a diagonal bisecting 7, 5 and 3, but there is some tolerance in the
- *  circle algorithm that allows C to deviate from the centerline slightly. As the centerline
- *  approaches the line connecting S and T the acute arcs will be "above" S and T in sections
- *  5 or 3, and the obtuse arcs will be "below" in sections 5 or 7. But it's simpler, because
- *  we know that the arc is > 180 degrees (obtuse) if the angular travel value is > pi.
- *
- *  The example below only tests the X axis (0 axis), but testing the other axis is similar
- *
- *    (1) If Cx <= Px and arc is acute; no test is needed
- *
- *    (2) If Cx <= Px and arc is obtuse; test if the radius is greater than
- *          the distance from Cx to the negative X boundary
- *
- *    (3) If Px < Cx < Tx and arc is acute; test if the radius is greater than
- *          the distance from Cx to the positive X boundary
- *
- *    (4) If Px < Cx < Tx and arc is obtuse; test if the radius is greater than
- *          the distance from Cx to the positive X boundary
- *
- *  The arc plane is defined by 0 and 1 depending on G17/G18/G19 plane selected,
- *  corresponding to arc planes XY, XZ, YZ, respectively.
- *
- *  Must be called with all the following set in the arc struct
- *    -    arc starting position (arc.position)
- *    - arc ending position (arc.gm.target)
- *    - arc center (arc.center_0, arc.center_1)
- *    - arc.radius (arc.radius)
- *    - arc angular travel in radians (arc.angular_travel)
- *    - max and min travel in axis 0 and axis 1 (in cm struct)
+ *  Tests the arc bounding box from _compute_arc_extents() against the soft limit envelope,
+ *  so the whole sweep is checked, not just the target. This covers the plane axes, the
+ *  linear (helix) axis and any other axes moving with the arc, at a cost that does not
+ *  depend on the size of the arc or the number of rotations.
  */
-/*
-static stat_t _test_arc_soft_limit_plane_axis(float center, uint8_t plane_axis)
+
+static stat_t _test_arc_soft_limits()
 {
-    if (center <= arc.position[plane_axis]) {
-        if (arc.angular_travel < M_PI) {                            // case (1)
-            return (STAT_OK);
+    uint16_t axes = cm->soft_limit_axes;
+    for (uint8_t axis = AXIS_X; axes != 0; axis++, axes >>= 1) {
+        if (!(axes & 1)) { continue; }
+        if (cm->arc.extent_min[axis] < cm->soft_limit_min[axis]) {
+            return (STAT_SOFT_LIMIT_EXCEEDED_XMIN + 2*axis);
         }
-        if ((center - arc.radius) < cm->a[plane_axis].travel_min) {    // case (2)
-            return (STAT_SOFT_LIMIT_EXCEEDED);
+        if (cm->arc.extent_max[axis] > cm->soft_limit_max[axis]) {
+            return (STAT_SOFT_LIMIT_EXCEEDED_XMAX + 2*axis);
         }
     }
-    if ((center + arc.radius) > cm->a[plane_axis].travel_max) {        // cases (3) and (4)
-        return (STAT_SOFT_LIMIT_EXCEEDED);
-    }
     return(STAT_OK);
 }
-*/
-static stat_t _test_arc_soft_limits()
-{
-/*
-    if (cm->soft_limit_enable == true) {
 
-        // Test if target falls outside boundaries. This is a 3 dimensional test
-        // so it also checks the linear axis of the arc (helix axis)
-        ritorno(cm_test_soft_limits(arc.gm.target));
+/*
+ * _test_spline_soft_limits() - test the extents of a spline against the soft limits
+ *
+ *  A Bezier's extents on an axis are at its ends or where its derivative - a quadratic in
+ *  the curve parameter - is zero.
+ */
 
-        // test arc extents
-        ritorno(_test_arc_soft_limit_plane_axis(arc.center_0, arc.plane_axis_0));
-        ritorno(_test_arc_soft_limit_plane_axis(arc.center_1, arc.plane_axis_1));
+static stat_t _test_spline_soft_limits(const float control[4][3])
+{
+    float extent_min[AXES];
+    float extent_max[AXES];
+    copy_vector(extent_min, cm->gm.target);
+    copy_vector(extent_max, cm->gm.target);
+
+    for (uint8_t a = 0; a < 3; a++) {
+        float d0 = control[1][a] - control[0][a];           // B'/3 = A t^2 + B t + C
+        float d1 = control[2][a] - control[1][a];
+        float d2 = control[3][a] - control[2][a];
+        float A = d0 - 2*d1 + d2;
+        float B = 2 * (d1 - d0);
+        float C = d0;
+        float root[2];
+        uint8_t roots = 0;
+        if (fabs(A) < EPSILON) {
+            if (fabs(B) > EPSILON) { root[roots++] = -C / B; }
+        } else {
+            float disc = B*B - 4*A*C;
+            if (disc >= 0) {
+                root[roots++] = (-B + sqrt(disc)) / (2*A);
+                root[roots++] = (-B - sqrt(disc)) / (2*A);
+            }
+        }
+        extent_min[a] = min(control[0][a], control[3][a]);
+        extent_max[a] = max(control[0][a], control[3][a]);
+        for (uint8_t r = 0; r < roots; r++) {
+            float t = root[r];
+            if ((t <= 0) || (t >= 1)) { continue; }
+            float u = 1 - t;
+            float x = u*u*u * control[0][a] + 3*u*u*t * control[1][a] + 3*u*t*t * control[2][a] + t*t*t * control[3][a];
+            extent_min[a] = min(extent_min[a], x);
+            extent_max[a] = max(extent_max[a], x);
+        }
     }
-*/
-    return(STAT_OK);
+    ritorno(cm_test_soft_limits(extent_min));
+    return (cm_test_soft_limits(extent_max));
 }
@@ -22,7 +22,7 @@
 
 #define MIN_ARC_RADIUS ((float)0.1)             // min radius that can be executed
 #define MIN_ARC_SEGMENT_LENGTH ((float)0.05)    // Arc segment size (mm).(0.03)
-#define MIN_ARC_SEGMENT_USEC ((float)10000)     // minimum arc segment time
+#define ARC_CHORD_ANGLE_MAX ((float)(M_PI / 2)) // widest chord, however loose {ct:} is
 
 // Arc radius tests. See http://linuxcnc.org/docs/html/gcode/gcode.html#sec:G2-G3-Arc
 //#define ARC_RADIUS_ERROR_MAX ((float)0.5)     // max allowable mm between start and end radius
@@ -32,6 +32,9 @@
 
 #define CHORDAL_TOLERANCE_MIN (0.001)           // values below this are not accepted
 
+#define ARC_RESYNC_SEGMENTS 16                  // segments between exact sin/cos re-syncs of the rotation
+#define ARC_TIME_BUDGET_MAX ((float)10000)      // {arcb:} maximum in microseconds
+
 /* arc function prototypes */
 
 void   cm_arc_init(cmMachine_t *_cm);
@@ -35,18 +35,40 @@
 #include "encoder.h"
 #include "report.h"
 #include "util.h"
+#include "profiler.h"
 #include "spindle.h"
 #include "xio.h"    // DIAGNOSTIC
+#include "trace.h"
+#include "binary_motion.h"
+#include "pso.h"
+#include "sync.h"
+#include "benchmark.h"
+#include "latency.h"
+#include "checkpoint.h"
 
 // execute routines (NB: These are all called from the LO interrupt)
 static stat_t _exec_aline_head(mpBuf_t *bf); // passing bf because body might need it, and it might call body
 static stat_t _exec_aline_body(mpBuf_t *bf); // passing bf so that body can extend itself if the exit velocity rises.
 static stat_t _exec_aline_tail(mpBuf_t *bf);
 static stat_t _exec_aline_segment(void);
+static void _exec_curve_point(const float s, float point[]);
+static stat_t _exec_segment_to_target(const float target[], const float segment_time, const float segment_velocity, const int16_t raster_intensity);
+static stat_t _exec_aline_settle(void);
+static const float *_exec_pressure_advance(const float target[], const float velocity, const float dt);
+static stat_t _exec_velocity_jog(void);
 static void   _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b);
+static void   _block_segment_time(const mpBuf_t *bf);
+static float  _section_segments(const float section_time);
 static stat_t _exec_aline_feedhold(mpBuf_t *bf);
+static void   _exec_aline_hold_jerk(mpBuf_t *bf);
 
-static void _init_forward_diffs(float v_0, float v_1);
+static void _init_velocity_curve(const float v_0, const float v_1, const float u_0, const float u_1);
+static void _advance_velocity_curve(void);
+static void _step_velocity_curve(void);
+
+static bool _time_scale_active(void);
+static void _scale_section(void);
+static stat_t _exec_scaled_segment(const float section_time, const float v_0, const float v_1, const float u_0, const float u_1);
 
 /****************************************************************************************
  * mp_forward_plan() - plan commands and moves ahead of exec; call ramping for moves
@@ -171,7 +193,9 @@ static void _init_forward_diffs(float v_0, float v_1);
 static stat_t _plan_aline(mpBuf_t *bf, float entry_velocity)
 {
     mpBlockRuntimeBuf_t* block = mr->p;             // set a local planning block so pointer doesn't change on you
+    PROF_BEGIN(_start);
     mp_calculate_ramps(block, bf, entry_velocity);  // (which it will if you don't do this)
+    PROF_END(_start, PROF_RAMPS);
 
     debug_trap_if_true((block->exit_velocity > block->cruise_velocity), 
         "_plan_line() exit velocity > cruise velocity after calculate_ramps()");
@@ -180,6 +204,7 @@ static stat_t _plan_aline(mpBuf_t *bf, float entry_velocity)
         "_plan_line() zero or negative length block after calculate_ramps()");
 
     bf->buffer_state = MP_BUFFER_FULLY_PLANNED;     //...here
+    LAT_BLOCK_STAMP(bf, LAT_PLAN);
     bf->plannable = false;
     return (STAT_OK);                               // report that we planned something...
 }
@@ -213,6 +238,7 @@ stat_t mp_forward_plan()
         while (bf->block_type >= BLOCK_TYPE_COMMAND) {
             if (bf->buffer_state == MP_BUFFER_BACK_PLANNED) {
                 bf->buffer_state = MP_BUFFER_FULLY_PLANNED; // "planning" is just setting the state (for now)
+                LAT_BLOCK_STAMP(bf, LAT_PLAN);
                 planned_something = true;
             }            
             bf = bf->nx;
@@ -259,8 +285,29 @@ stat_t mp_exec_move()
         return (STAT_OK);
     }
 
+    // Hold motion while the spindle comes up to speed on its tachometer
+    if (spindle_is_spinning_up()) {
+        st_prep_out_of_band_dwell(SPINDLE_AT_SPEED_POLL_MS * 1000);
+        return (STAT_OK);
+    }
+
+    // A sync follower waits for the master's run line to start motion (see sync.h)
+    if ((cm->motion_state != MOTION_RUN) && sync_hold_start() && mp_has_runnable_buffer(mp)) {
+        st_prep_out_of_band_dwell(SYNC_START_POLL_MS * 1000);
+        return (STAT_OK);
+    }
+
+    // A velocity jog owns the runtime until it has stopped
+    if (mp_vjog.active && (mr == &mr1)) {
+        return (_exec_velocity_jog());
+    }
+
     // Getting a NULL buffer means nothing's running in the queue - this is OK
     if ((bf = mp_get_run_buffer()) == NULL) {
+        if (cm->motion_state == MOTION_RUN) {
+            BM_EXEC_STARVED();                          // the queue ran dry mid-cycle
+            mp_health_starved();
+        }
         st_prep_null();
         return (STAT_NOOP);
     }
@@ -271,6 +318,8 @@ stat_t mp_exec_move()
         if (bf->buffer_state != MP_BUFFER_RUNNING) {
             if ((bf->buffer_state < MP_BUFFER_BACK_PLANNED) && (cm->motion_state == MOTION_RUN)) {
 //                debug_trap("mp_exec_move() buffer is not prepped. Starvation"); // IMPORTANT: can't rpt_exception from here!
+                BM_EXEC_STARVED();
+                mp_health_starved();
                 st_prep_null();
                 return (STAT_NOOP);
             }
@@ -286,16 +335,19 @@ stat_t mp_exec_move()
                 // IMPORTANT: can't rpt_exception from here!
                 // We need to have it planned. We don't want to do this here,
                 // as it might already be happening in a lower interrupt.
+                mp_health_plan_missed();
                 st_request_forward_plan();
                 return (STAT_NOOP);
             }
 
             if (bf->buffer_state == MP_BUFFER_FULLY_PLANNED) {
                 bf->buffer_state = MP_BUFFER_RUNNING;       // must precede mp_planner_time_acccounting()
+                BM_BLOCK_START(mp->q.queue_size - mp_get_planner_buffers(mp));
             } else {
                 return (STAT_NOOP);
             }
             mp_planner_time_accounting();
+            mp_health_block_start();
         }
 
         // Go ahead and *ask* for a forward planning of the next move.
@@ -309,6 +361,8 @@ stat_t mp_exec_move()
     if (bf->bf_func == NULL) {
         return(cm_panic(STAT_INTERNAL_ERROR, "mp_exec_move()")); // never supposed to get here
     }
+    sr_mark_changed();                                      // position, velocity or the runtime model may change
+    LAT_BLOCK_STAMP(bf, LAT_RUN);                           // first call only - see lat_stamp()
     return (bf->bf_func(bf));                               // run the move callback in the planner buffer
 }
 
@@ -400,7 +454,7 @@ stat_t mp_exec_move()
  **
  **** NOTICE ** NOTICE ** NOTICE ****/
 
-stat_t mp_exec_aline(mpBuf_t *bf)
+HOT_PATH stat_t mp_exec_aline(mpBuf_t *bf)
 {
     // don't run the block if the machine is not in cycle
     if (cm_get_machine_state() != MACHINE_CYCLE) {
@@ -438,8 +492,10 @@ stat_t mp_exec_aline(mpBuf_t *bf)
 
         // Start a new move by setting up the runtime singleton (mr)
         memcpy(&mr->gm, &(bf->gm), sizeof(GCodeState_t));   // copy in the gcode model state
+        checkpoint_mark(&bf->gm, mr->position);             // a new line starts here
         bf->block_state = BLOCK_ACTIVE;                     // note that this buffer is running
         mr->block_state = BLOCK_INITIAL_ACTION;             // note the planner doesn't look at block_state
+        mp->run_time_remaining = bf->block_time;            // counted down by the segments - see mp_get_queue_time()
 
         // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
         // !!! THIS IS THE ONLY PLACE WHERE mr->r AND mr->p ARE ALLOWED TO BE CHANGED !!!
@@ -450,12 +506,43 @@ stat_t mp_exec_aline(mpBuf_t *bf)
        
         // Check to make sure no sections are less than MIN_SEGMENT_TIME & adjust if necessary
         _exec_aline_normalize_block(mr->r);
+        _block_segment_time(bf);                            // segment time to hold the joint chords to {ktol:}
 
         // transfer move parameters from planner buffer to the runtime
         copy_vector(mr->unit, bf->unit);
         copy_vector(mr->target, bf->gm.target);
         copy_vector(mr->axis_flags, bf->axis_flags);
 
+        // Pressure advance is for printing moves - an extruder going forward along with X or Y.
+        // Tool 1 extrudes on A and tool 2 on B, as the E word is mapped in gcode_parser.cpp
+        mr->advance_k = 0;
+        if (mr->axis_flags[AXIS_X] || mr->axis_flags[AXIS_Y]) {
+            for (uint8_t tool=1; tool<=EXTRUDER_TOOLS; tool++) {
+                uint8_t axis = AXIS_A + tool - 1;
+                if ((tt.pressure_advance[tool] > 0) && (mr->unit[axis] > 0) &&
+                    ((mr->advance == 0) || (mr->advance_axis == axis))) {
+                    mr->advance_axis = axis;
+                    mr->advance_k = tt.pressure_advance[tool];
+                    break;
+                }
+            }
+        }
+        if ((mr->arc_block = bf->arc_block)) {
+            mr->arc = bf->arc;
+        }
+        if ((mr->spline_block = bf->spline_block)) {
+            mr->spline = bf->spline;
+        }
+        mr->arc_length = bf->length;
+        mr->arc_s = 0;
+        mr->line_s = 0;
+        if ((mr->raster_block = bf->raster_block)) {
+            mr->raster = bf->raster;
+            mr->raster_s = 0;
+        }
+        mr->velocity_sync_vmax = (mr->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) ? 0 : bf->cruise_vmax;
+        mr->sync_out = bf->sync_out;
+
         mr->run_bf = bf;                                // DIAGNOSTIC: points to running bf
         mr->plan_bf = bf->nx;                           // DIAGNOSTIC: points to next bf to forward plan
 
@@ -470,17 +557,27 @@ stat_t mp_exec_aline(mpBuf_t *bf)
         }
 
         // generate the way points for position correction at section ends
-        for (uint8_t axis=0; axis<AXES; axis++) {
-            mr->waypoint[SECTION_HEAD][axis] = mr->position[axis] + mr->unit[axis] * mr->r->head_length;
-            mr->waypoint[SECTION_BODY][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length);
-            mr->waypoint[SECTION_TAIL][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length + mr->r->tail_length);
+        if (mr->arc_block || mr->spline_block) {        // curves only move the axes on the curve
+            copy_vector(mr->waypoint[SECTION_HEAD], mr->position);
+            copy_vector(mr->waypoint[SECTION_BODY], mr->position);
+            _exec_curve_point(mr->r->head_length, mr->waypoint[SECTION_HEAD]);
+            _exec_curve_point(mr->r->head_length + mr->r->body_length, mr->waypoint[SECTION_BODY]);
+            copy_vector(mr->waypoint[SECTION_TAIL], mr->target);
+        } else {
+            copy_vector(mr->line_start, mr->position);  // linear segment targets are taken from here
+            for (uint8_t axis=0; axis<AXES; axis++) {
+                mr->waypoint[SECTION_HEAD][axis] = mr->position[axis] + mr->unit[axis] * mr->r->head_length;
+                mr->waypoint[SECTION_BODY][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length);
+                mr->waypoint[SECTION_TAIL][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length + mr->r->tail_length);
+            }
         }
     }
 
     // Feed Override Processing - We need to handle the following cases (listed in rough sequence order):
 
     // Feedhold Processing - We need to handle the following cases (listed in rough sequence order):
-    if (cm->hold_state != FEEDHOLD_OFF) {
+    // (A block settling the input shaper or pressure advance has already stopped - let it finish first)
+    if ((cm->hold_state != FEEDHOLD_OFF) && !mr->shaper_settling) {
         // if running actions, or in HOLD state, or exiting with actions
         if (cm->hold_state >= FEEDHOLD_MOTION_STOPPED) { // handles _exec_aline_feedhold_processing case (7)
             return (STAT_NOOP);                    // VERY IMPORTANT to exit as a NOOP. Do not load another move
@@ -499,11 +596,19 @@ stat_t mp_exec_aline(mpBuf_t *bf)
 
     //**** main dispatcher to process segments ***
     status = STAT_OK;
-         if (mr->section == SECTION_HEAD) { status = _exec_aline_head(bf); }
+         if (mr->shaper_settling)         { status = _exec_aline_settle(); }
+    else if (mr->section == SECTION_HEAD) { status = _exec_aline_head(bf); }
     else if (mr->section == SECTION_BODY) { status = _exec_aline_body(bf); }
     else if (mr->section == SECTION_TAIL) { status = _exec_aline_tail(bf); }
     else    { return(cm_panic(STAT_INTERNAL_ERROR, "exec_aline()"));}    // never supposed to get here
 
+    // A block that ends at rest isn't done until the steps have caught up with the runtime -
+    // the input shaper has played out and the pressure advance has gone back to zero
+    if ((status == STAT_OK) && (mr->r->exit_velocity < EPSILON2) && (mp_shaper_active() || (mr->advance != 0))) {
+        mr->shaper_settling = true;
+        status = STAT_EAGAIN;
+    }
+
     // Conditionally set the move to be unplannable. We can't use the if/else block above, 
     // since the head may call a body or a tail, and a body call tail, so we wait till after.
     //
@@ -518,6 +623,12 @@ stat_t mp_exec_aline(mpBuf_t *bf)
         bf->plannable = false;
     }
 
+    // Merged blocks (see mp_merge_aline()) report the first line until the final section starts
+    if ((bf->merged_linenum != 0) &&
+        ((mr->section == SECTION_TAIL) || ((mr->section == SECTION_BODY) && fp_ZERO(mr->r->tail_length)))) {
+        mr->gm.linenum = bf->merged_linenum;
+    }
+
     // Feedhold Case (3): Look for the end of the deceleration to transition HOLD states
     // This code sets states used by _exec_feedhold_processing() helper.
     if (cm->hold_state == FEEDHOLD_DECEL_TO_ZERO) {
@@ -663,11 +774,25 @@ stat_t mp_exec_aline(mpBuf_t *bf)
  *        F_2 = 300Ah^5 + 24Bh^4
  *        F_1 = 120Ah^5
  *
- *  Note that with our current control points, D and E are actually 0.
+ *  Note that with our current control points, D and E are actually 0 - except for a head that is
+ *  a slice [u_0, u_1] of an acceleration run (see plan_zoid.cpp). The slice is re-expanded about
+ *  u_0 in t = (u - u_0)/(u_1 - u_0), which takes its coefficients from the derivatives of
+ *  S(u) = 10u^3 - 15u^4 + 6u^5 at u_0:
+ *
+ *        A = dV 6 w^5                                  w = u_1 - u_0, dV = P_t - P_i
+ *        B = dV (-15 + 30u_0) w^4
+ *        C = dV (10 - 60u_0 + 60u_0^2) w^3
+ *        D = dV (30u_0 - 90u_0^2 + 60u_0^3) w^2
+ *        E = dV (30u_0^2 - 60u_0^3 + 30u_0^4) w
+ *        F = P_i + dV S(u_0)
+ *
+ *  With u_0 = 0 and u_1 = 1 these are the coefficients above.
  */
 
+#ifndef __DIRECT_VELOCITY
+
 // Total time: 147us
-static void _init_forward_diffs(const float v_0, const float v_1)
+static void _init_forward_diffs(const float v_0, const float v_1, const float u_0, const float u_1)
 {
     // Times from *here*
 /* Full formulation:
@@ -689,12 +814,18 @@ static void _init_forward_diffs(const float v_0, const float v_1)
      const float E =  5*( P_1 - P_0 );
      //const float F = P_0;
 */
-    float A =  -6.0*v_0 +  6.0*v_1;
-    float B =  15.0*v_0 - 15.0*v_1;
-    float C = -10.0*v_0 + 10.0*v_1;
-    // D = 0
-    // E = 0
-    // F = Vi
+    const float dv  = v_1 - v_0;
+    const float u   = u_0;
+    const float w   = u_1 - u_0;
+    const float w_2 = w * w;
+    const float w_3 = w_2 * w;
+
+    float A = 6.0 * dv * w_3 * w_2;
+    float B = dv * (-15.0 + 30.0*u) * w_2 * w_2;
+    float C = dv * (10.0 + u*(-60.0 + 60.0*u)) * w_3;
+    float D = dv * u * (30.0 + u*(-90.0 + 60.0*u)) * w_2;   // 0 unless a run slice
+    float E = dv * u*u * (30.0 + u*(-60.0 + 30.0*u)) * w;   // 0 unless a run slice
+    float F = v_0 + dv * u*u*u * (10.0 + u*(-15.0 + 6.0*u));
 
     const float h   = 1/(mr->segments);
     const float h_2 = h   * h;
@@ -705,6 +836,8 @@ static void _init_forward_diffs(const float v_0, const float v_1)
     const float Ah_5 = A * h_5;
     const float Bh_4 = B * h_4;
     const float Ch_3 = C * h_3;
+    const float Dh_2 = D * h_2;
+    const float Eh   = E * h;
 
     const float const1 = 7.5625; // (121.0/16.0)
     const float const2 = 3.25;   // ( 13.0/ 4.0)
@@ -718,15 +851,16 @@ static void _init_forward_diffs(const float v_0, const float v_1)
      *  F_1 =     120 A h^5
      */
 
-    mr->forward_diff_5 = const1*Ah_5 +  5.0*Bh_4 + const2*Ch_3;
-    mr->forward_diff_4 = const3*Ah_5 + 29.0*Bh_4 +    9.0*Ch_3;
+    mr->forward_diff_5 = const1*Ah_5 +  5.0*Bh_4 + const2*Ch_3 + 2.0*Dh_2 + Eh;
+    mr->forward_diff_4 = const3*Ah_5 + 29.0*Bh_4 +    9.0*Ch_3 + 2.0*Dh_2;
     mr->forward_diff_3 = 255.0*Ah_5 + 48.0*Bh_4 +    6.0*Ch_3;
     mr->forward_diff_2 = 300.0*Ah_5 + 24.0*Bh_4;
     mr->forward_diff_1 = 120.0*Ah_5;
 
     // Calculate the initial velocity by calculating V(h/2)
     const float half_h   = h * 0.5; // h/2
-    const float half_h_3 = half_h   * half_h * half_h;
+    const float half_h_2 = half_h   * half_h;
+    const float half_h_3 = half_h_2 * half_h;
     const float half_h_4 = half_h_3 * half_h;
     const float half_h_5 = half_h_4 * half_h;
 
@@ -734,7 +868,138 @@ static void _init_forward_diffs(const float v_0, const float v_1)
     const float half_Bh_4 = B * half_h_4;
     const float half_Ah_5 = A * half_h_5;
 
-    mr->segment_velocity = half_Ah_5 + half_Bh_4 + half_Ch_3 + v_0;
+    mr->segment_velocity = half_Ah_5 + half_Bh_4 + half_Ch_3 + D*half_h_2 + E*half_h + F;
+}
+
+#endif // __DIRECT_VELOCITY
+
+/*
+ * _init_velocity_curve()    - set up the velocity curve for a head or tail, and the first segment velocity
+ * _advance_velocity_curve() - set segment_velocity for the next segment
+ * _step_velocity_curve()    - advance state after a segment that was not the first
+ *
+ *  With __DIRECT_VELOCITY the quintic is evaluated at each segment midpoint. With control
+ *  points as above V(t) = P_i + (P_t - P_i)(10t^3 - 15t^4 + 6t^5), which in Horner form is
+ *  V(t) = P_i + (P_t - P_i) * t^3 * (10 + t*(-15 + 6t)), and segment n of I has t = (n + 1/2)/I.
+ *  This costs more per segment than forward differencing, but the cost is the same for every
+ *  segment and round-off does not accumulate over long heads and tails. A run slice [u_0, u_1]
+ *  evaluates the same curve at u = u_0 + (u_1 - u_0)t.
+ */
+
+#ifdef __DIRECT_VELOCITY
+
+static void _advance_velocity_curve()
+{
+    // segment_count is decremented by _exec_aline_segment(), so this is the index of the next segment
+    const float t = mr->velocity_u0 + ((mr->segments - mr->segment_count) + 0.5) * mr->segment_h * mr->velocity_w;
+    mr->segment_velocity = mr->velocity_start + mr->velocity_delta * (t*t*t * (10.0 + t*(-15.0 + 6.0*t)));
+}
+
+static void _init_velocity_curve(const float v_0, const float v_1, const float u_0, const float u_1)
+{
+    mr->velocity_start = v_0;
+    mr->velocity_delta = v_1 - v_0;
+    mr->velocity_u0 = u_0;
+    mr->velocity_w = u_1 - u_0;
+    mr->segment_h = 1/(mr->segments);
+    _advance_velocity_curve();
+}
+
+static void _step_velocity_curve() {}
+
+#else
+
+static void _init_velocity_curve(const float v_0, const float v_1, const float u_0, const float u_1) { _init_forward_diffs(v_0, v_1, u_0, u_1); }
+static void _advance_velocity_curve() { mr->segment_velocity += mr->forward_diff_5; }
+
+static void _step_velocity_curve()
+{
+    mr->forward_diff_5 += mr->forward_diff_4;
+    mr->forward_diff_4 += mr->forward_diff_3;
+    mr->forward_diff_3 += mr->forward_diff_2;
+    mr->forward_diff_2 += mr->forward_diff_1;
+}
+
+#endif // __DIRECT_VELOCITY
+
+/*********************************************************************************************
+ * Exec time scaling - the feed override in time-scale mode (see mp_start_feed_override())
+ *
+ * mp_set_time_scale()      - set the scale to ramp to (main loop)
+ * mp_reset_time_scale()    - return to 1.0 at once (only when stopped)
+ * _time_scale_active()     - true if the scale is, or is going to be, other than 1.0
+ * _scale_section()         - switch a running section over to time-scaled segments
+ * _exec_scaled_segment()   - run the next segment of a time-scaled section
+ *
+ *  A time-scaled section is walked in planned time. Each segment is a nominal segment long in
+ *  real time and covers scale times that much of the plan, so the segment runs the planned
+ *  path at scale times the planned velocity. Segments stay nominal length as the scale goes
+ *  down - the DDA is sized for nothing longer. The scale follows the same quintic as the
+ *  heads and tails between factors, over FEED_OVERRIDE_RAMP_TIME, so the extra acceleration
+ *  it adds starts and ends at zero.
+ */
+
+typedef struct mpTimeScale {
+    volatile float target;              // scale to ramp to - set by the main loop
+    float scale;                        // scale of the last segment
+    float from;                         // scale at the start of the ramp
+    float to;                           // scale at the end of the ramp
+    float elapsed;                      // real time into the ramp, in minutes
+} mpTimeScale_t;
+
+static mpTimeScale_t ts = { 1.0, 1.0, 1.0, 1.0, 0 };
+
+void mp_set_time_scale(const float scale) { ts.target = scale; }
+
+void mp_reset_time_scale()
+{
+    ts.target = ts.scale = ts.from = ts.to = 1.0;
+}
+
+static bool _time_scale_active() { return ((ts.scale != 1.0) || (ts.target != 1.0)); }
+
+static float _advance_time_scale(const float dt)     // returns the scale for a segment dt long
+{
+    if (ts.target != ts.to) {                       // a new target re-starts the ramp from here
+        ts.from = ts.scale;
+        ts.to = ts.target;
+        ts.elapsed = 0;
+    }
+    if (ts.scale != ts.to) {
+        const float t = (ts.elapsed + dt/2) / FEED_OVERRIDE_RAMP_TIME;
+        ts.elapsed += dt;
+        if (t >= 1.0) {
+            ts.scale = ts.to;
+        } else {
+            ts.scale = ts.from + (ts.to - ts.from) * (t*t*t * (10.0 + t*(-15.0 + 6.0*t)));
+        }
+    }
+    return (ts.scale);
+}
+
+static void _scale_section()
+{
+    mr->section_tau = (mr->segments - mr->segment_count) * mr->segment_time;
+    mr->section_scaled = true;
+}
+
+static stat_t _exec_scaled_segment(const float section_time, const float v_0, const float v_1, const float u_0, const float u_1)
+{
+    const float scale = _advance_time_scale(NOM_SEGMENT_TIME);
+    const float remaining = section_time - mr->section_tau;
+    float tau = scale * mr->block_segment_time;     // planned time this segment covers
+    if (remaining <= tau) {                         // end the section on one or two segments no
+        tau = remaining;                            // shorter than half a nominal segment
+    } else if (remaining < 2*tau) {
+        tau = remaining / 2;
+    }
+    const float t = u_0 + (u_1 - u_0) * (mr->section_tau + tau/2) / section_time;   // velocity at the middle of the segment
+    mr->segment_velocity = v_0 + (v_1 - v_0) * (t*t*t * (10.0 + t*(-15.0 + 6.0*t)));
+    mr->segment_time = tau;
+    mr->segment_scale = scale;
+    mr->segment_count = (uint32_t)ceil(remaining / tau);  // 1 on the last segment of the section
+    mr->section_tau += tau;
+    return (_exec_aline_segment());
 }
 
 /*********************************************************************************************
@@ -743,6 +1008,13 @@ static void _init_forward_diffs(const float v_0, const float v_1)
 
 static stat_t _exec_aline_head(mpBuf_t *bf)
 {
+    // A head that is a slice of an acceleration run follows the run's curve (see plan_zoid.cpp)
+    const mpBlockRuntimeBuf_t *b = mr->r;
+    const float v_0 = b->head_run ? b->head_v0 : mr->entry_velocity;
+    const float v_1 = b->head_run ? b->head_v1 : b->cruise_velocity;
+    const float u_0 = b->head_run ? b->head_u0 : 0;
+    const float u_1 = b->head_run ? b->head_u1 : 1;
+
     bool first_pass = false;
     if (mr->section_state == SECTION_NEW) {                 // INITIALIZATION
         first_pass = true;
@@ -750,40 +1022,48 @@ static stat_t _exec_aline_head(mpBuf_t *bf)
             mr->section = SECTION_BODY;
             return(_exec_aline_body(bf));                   // skip ahead to the body generator
         }
-        mr->segments = ceil(uSec(mr->r->head_time) / NOM_SEGMENT_USEC);// # of segments for the section
-        mr->segment_count = (uint32_t)mr->segments;
-        mr->segment_time = mr->r->head_time / mr->segments; // time to advance for each segment
-
-        if (mr->segment_count == 1) {
-            // We will only have one segment, simply average the velocities
-            mr->segment_velocity = mr->r->head_length / mr->segment_time;
-        } else {
-            _init_forward_diffs(mr->entry_velocity, mr->r->cruise_velocity); // sets initial segment_velocity
-        }
-        if (mr->segment_time < MIN_SEGMENT_TIME) {
-            debug_trap("mr->segment_time < MIN_SEGMENT_TIME (head)");
-            return (STAT_OK);                               // exit without advancing position, say we're done
+        mr->section_tau = 0;
+        if (!(mr->section_scaled = _time_scale_active())) {
+            mr->segments = _section_segments(mr->r->head_time);       // # of segments for the section
+            mr->segment_count = (uint32_t)mr->segments;
+            mr->segment_time = mr->r->head_time / mr->segments; // time to advance for each segment
+            mr->segment_scale = 1.0;
+
+            if (mr->segment_count == 1) {
+                // We will only have one segment, simply average the velocities
+                mr->segment_velocity = mr->r->head_length / mr->segment_time;
+            } else {
+                _init_velocity_curve(v_0, v_1, u_0, u_1);   // sets initial segment_velocity
+            }
+            if (mr->segment_time < MIN_SEGMENT_TIME) {
+                debug_trap("mr->segment_time < MIN_SEGMENT_TIME (head)");
+                return (STAT_OK);                           // exit without advancing position, say we're done
+            }
         }
         // If this trap ever fires put this statement back in: mr->section = SECTION_HEAD;
         debug_trap_if_true(mr->section != SECTION_HEAD, "exec_aline() Not section head");
 
         mr->section_state = SECTION_RUNNING;
-    } else {
-        mr->segment_velocity += mr->forward_diff_5;
+    } else if (!mr->section_scaled) {
+        if (_time_scale_active()) {
+            _scale_section();                               // the rest of the section runs time-scaled
+        } else {
+            _advance_velocity_curve();
+        }
     }
 
-    if (_exec_aline_segment() == STAT_OK) {                 // set up for second half
+    stat_t status = (mr->section_scaled) ?
+        _exec_scaled_segment(mr->r->head_time, v_0, v_1, u_0, u_1) :
+        _exec_aline_segment();
+    if (status == STAT_OK) {                                // set up for second half
         if ((fp_ZERO(mr->r->body_length)) && (fp_ZERO(mr->r->tail_length))) {
             return (STAT_OK);                               // ends the move
         }
         mr->section = SECTION_BODY;                         // advance to body
         mr->section_state = SECTION_NEW;
     }
-    else if (!first_pass) {
-        mr->forward_diff_5 += mr->forward_diff_4;
-        mr->forward_diff_4 += mr->forward_diff_3;
-        mr->forward_diff_3 += mr->forward_diff_2;
-        mr->forward_diff_2 += mr->forward_diff_1;
+    else if (!first_pass && !mr->section_scaled) {
+        _step_velocity_curve();
     }
     return (STAT_EAGAIN);
 }
@@ -801,21 +1081,30 @@ static stat_t _exec_aline_body(mpBuf_t *bf)
             mr->section = SECTION_TAIL;
             return(_exec_aline_tail(bf));                   // skip ahead to tail generator
         }
-        float body_time = mr->r->body_time;
-        mr->segments = ceil(uSec(body_time) / NOM_SEGMENT_USEC);
-        mr->segment_time = body_time / mr->segments;
-        mr->segment_velocity = mr->r->cruise_velocity;
-        mr->segment_count = (uint32_t)mr->segments;
-        if (mr->segment_time < MIN_SEGMENT_TIME) {
-            debug_trap("mr->segment_time < MIN_SEGMENT_TIME (body)");
-            return (STAT_OK);                               // exit without advancing position, say we're done
+        mr->section_tau = 0;
+        if (!(mr->section_scaled = _time_scale_active())) {
+            float body_time = mr->r->body_time;
+            mr->segments = _section_segments(body_time);
+            mr->segment_time = body_time / mr->segments;
+            mr->segment_velocity = mr->r->cruise_velocity;
+            mr->segment_count = (uint32_t)mr->segments;
+            mr->segment_scale = 1.0;
+            if (mr->segment_time < MIN_SEGMENT_TIME) {
+                debug_trap("mr->segment_time < MIN_SEGMENT_TIME (body)");
+                return (STAT_OK);                           // exit without advancing position, say we're done
+            }
         }
         // If this trap ever fires put this statement back in: mr->section = SECTION_BODY;
         debug_trap_if_true(mr->section != SECTION_BODY, "exec_aline() Not section body");
 
         mr->section_state = SECTION_RUNNING;                // uses PERIOD_2 so last segment detection works
+    } else if (!mr->section_scaled && _time_scale_active()) {
+        _scale_section();                                   // the rest of the section runs time-scaled
     }
-    if (_exec_aline_segment() == STAT_OK) {                 // OK means this section is done
+    stat_t status = (mr->section_scaled) ?
+        _exec_scaled_segment(mr->r->body_time, mr->r->cruise_velocity, mr->r->cruise_velocity, 0, 1) :
+        _exec_aline_segment();
+    if (status == STAT_OK) {                                // OK means this section is done
         if (fp_ZERO(mr->r->tail_length)) {
             return (STAT_OK);                               // ends the move
         }
@@ -839,46 +1128,112 @@ static stat_t _exec_aline_tail(mpBuf_t *bf)
         if (fp_ZERO(mr->r->tail_length)) {                  // Needed here as feedhold may have changed the block
             return(STAT_OK);                                // end the move
         }
-        mr->segments = ceil(uSec(mr->r->tail_time) / NOM_SEGMENT_USEC);// # of segments for the section
-        mr->segment_count = (uint32_t)mr->segments;
-        mr->segment_time = mr->r->tail_time / mr->segments; // time to advance for each segment
-
-        if (mr->segment_count == 1) {
-            mr->segment_velocity = mr->r->tail_length / mr->segment_time;
-        } else {
-            _init_forward_diffs(mr->r->cruise_velocity, mr->r->exit_velocity); // sets initial segment_velocity
-        }
-        if (mr->segment_time < MIN_SEGMENT_TIME) {
-            debug_trap("mr->segment_time < MIN_SEGMENT_TIME (tail)");
-            return (STAT_OK);                               // exit without advancing position, say we're done
+        mr->section_tau = 0;
+        if (!(mr->section_scaled = _time_scale_active())) {
+            mr->segments = _section_segments(mr->r->tail_time);       // # of segments for the section
+            mr->segment_count = (uint32_t)mr->segments;
+            mr->segment_time = mr->r->tail_time / mr->segments; // time to advance for each segment
+            mr->segment_scale = 1.0;
+
+            if (mr->segment_count == 1) {
+                mr->segment_velocity = mr->r->tail_length / mr->segment_time;
+            } else {
+                _init_velocity_curve(mr->r->cruise_velocity, mr->r->exit_velocity, 0, 1); // sets initial segment_velocity
+            }
+            if (mr->segment_time < MIN_SEGMENT_TIME) {
+                debug_trap("mr->segment_time < MIN_SEGMENT_TIME (tail)");
+                return (STAT_OK);                           // exit without advancing position, say we're done
+            }
         }
         // If this trap ever fires put this statement back in: mr->section = SECTION_TAIL;
         debug_trap_if_true(mr->section != SECTION_TAIL, "exec_aline() Not section tail");
 
         mr->section_state = SECTION_RUNNING;
-    } else {
-        mr->segment_velocity += mr->forward_diff_5;
+    } else if (!mr->section_scaled) {
+        if (_time_scale_active()) {
+            _scale_section();                               // the rest of the section runs time-scaled
+        } else {
+            _advance_velocity_curve();
+        }
     }
 
-    if (_exec_aline_segment() == STAT_OK) {
+    stat_t status = (mr->section_scaled) ?
+        _exec_scaled_segment(mr->r->tail_time, mr->r->cruise_velocity, mr->r->exit_velocity, 0, 1) :
+        _exec_aline_segment();
+    if (status == STAT_OK) {
         return (STAT_OK);                                   // STAT_OK completes the move
     } 
-    else if (!first_pass) {
-        mr->forward_diff_5 += mr->forward_diff_4;
-        mr->forward_diff_4 += mr->forward_diff_3;
-        mr->forward_diff_3 += mr->forward_diff_2;
-        mr->forward_diff_2 += mr->forward_diff_1;
+    else if (!first_pass && !mr->section_scaled) {
+        _step_velocity_curve();
     }
     return (STAT_EAGAIN);
 }
 
+/*
+ * _exec_curve_point() - set point[] to the running arc or spline at path length s
+ */
+
+static void _exec_curve_point(const float s, float point[])
+{
+    if (mr->arc_block) {
+        mp_arc_point(&mr->arc, s, point);
+    } else {
+        mp_spline_point(&mr->spline, s, point);
+    }
+}
+
+/*
+ * _line_s_fixed() - path length in mm as line_s fixed-point
+ *
+ *  Line segment targets are the block start plus the unit vector times line_s. The sum of
+ *  the segment lengths is kept as a 64 bit integer so it is exact however many segments a
+ *  block runs, and each target carries one float rounding instead of an accumulated one.
+ */
+
+static int64_t _line_s_fixed(const float s)
+{
+    return ((int64_t)llroundf(s * MP_LINE_S_PER_MM));
+}
+
+/*
+ * _exec_block_s()       - path length run so far in the running block
+ * _exec_last_section()  - true if the running section is the last one in the block
+ * mp_hold_sync_output() - carry the outputs not switched yet into a block re-used after a hold
+ *
+ *  The re-used block starts where the hold stopped, so the distance is taken back by the
+ *  path length already run.
+ */
+
+static float _exec_block_s()
+{
+    if (mr->arc_block || mr->spline_block) {
+        return (mr->arc_s);
+    }
+    return ((float)mr->line_s / MP_LINE_S_PER_MM);
+}
+
+static bool _exec_last_section()
+{
+    return ((mr->section == SECTION_TAIL) ||
+            (fp_ZERO(mr->r->tail_length) && ((mr->section == SECTION_BODY) || fp_ZERO(mr->r->body_length))));
+}
+
+void mp_hold_sync_output(mpBuf_t *bf)
+{
+    bf->sync_out = mr->sync_out;
+    if (bf->sync_out.set || bf->sync_out.clear) {
+        bf->sync_out.distance = max(bf->sync_out.distance - _exec_block_s(), (float)0);
+    }
+}
+
 /*********************************************************************************************
  * _exec_aline_segment() - segment runner helper
  *
  * NOTES ON STEP ERROR CORRECTION:
  *
- *  The commanded_steps are the target_steps delayed by one more segment.
- *  This lines them up in time with the encoder readings so a following error can be generated
+ *  The commanded_steps are the target of the last segment the steppers finished, and the
+ *  following error is the encoder reading at that moment. Both are latched by the loader
+ *  (see LATCH_FOLLOWING_ERROR in encoder.h) so they line up in time however far exec runs ahead.
  *
  *  The following_error term is positive if the encoder reading is greater than (ahead of)
  *  the commanded steps, and negative (behind) if the encoder reading is less than the
@@ -894,7 +1249,17 @@ static stat_t _exec_aline_tail(mpBuf_t *bf)
 
 static stat_t _exec_aline_segment()
 {
-    float travel_steps[MOTORS];
+    int16_t raster_intensity = -1;                      // -1 leaves the spindle PWM alone
+
+    // Scanlines take the pixel at the middle of the segment. Other feed moves may scale the
+    // spindle (laser) power with velocity - see spindle_velocity_intensity()
+    if (mr->raster_block) {
+        float segment_length = mr->segment_velocity * mr->segment_time;
+        raster_intensity = mp_get_raster_pixel(&mr->raster, mr->raster_s + segment_length / 2);
+        mr->raster_s += segment_length;
+    } else if (mr->velocity_sync_vmax > 0) {
+        raster_intensity = spindle_velocity_intensity(mr->segment_velocity * mr->segment_scale / mr->velocity_sync_vmax);
+    }
 
     // Set target position for the segment
     // If the segment ends on a section waypoint synchronize to the head, body or tail end
@@ -903,20 +1268,138 @@ static stat_t _exec_aline_segment()
 
     if ((--mr->segment_count == 0) && (cm->hold_state == FEEDHOLD_OFF)) {
         copy_vector(mr->gm.target, mr->waypoint[mr->section]);
-    } else {
-        float segment_length = mr->segment_velocity * mr->segment_time;
-        // See https://en.wikipedia.org/wiki/Kahan_summation_algorithm
-        // for the summation compensation description
+        if (mr->arc_block || mr->spline_block) {        // keep the curve distance in step with the waypoint
+            mr->arc_s = mr->r->head_length;
+            if (mr->section != SECTION_HEAD) { mr->arc_s += mr->r->body_length; }
+            if (mr->section == SECTION_TAIL) { mr->arc_s += mr->r->tail_length; }
+        }
+        if (!(mr->arc_block || mr->spline_block)) {     // ...and the line distance
+            float line_s = mr->r->head_length;
+            if (mr->section != SECTION_HEAD) { line_s += mr->r->body_length; }
+            if (mr->section == SECTION_TAIL) { line_s += mr->r->tail_length; }
+            mr->line_s = _line_s_fixed(line_s);
+        }
+        if (mr->raster_block) {                         // same for the scanline distance
+            mr->raster_s = mr->r->head_length;
+            if (mr->section != SECTION_HEAD) { mr->raster_s += mr->r->body_length; }
+            if (mr->section == SECTION_TAIL) { mr->raster_s += mr->r->tail_length; }
+        }
+    } else if (mr->arc_block || mr->spline_block) {     // curves are interpolated on the curve at every segment
+        mr->arc_s += mr->segment_velocity * mr->segment_time;
+        _exec_curve_point(mr->arc_s, mr->gm.target);
+    } else {                                            // lines are taken from the block start at every segment
+        mr->line_s += _line_s_fixed(mr->segment_velocity * mr->segment_time);
+        float s = (float)mr->line_s / MP_LINE_S_PER_MM;
         for (uint8_t a=0; a<AXES; a++) {
-            float to_add = (mr->unit[a] * segment_length) - mr->gm.target_comp[a];
-            float target = mr->position[a] + to_add;
-            mr->gm.target_comp[a] = (target - mr->position[a]) - to_add;
-            mr->gm.target[a] = target;
-            // the above replaces this line:
-            // mr->gm.target[a] = mr->position[a] + (mr->unit[a] * segment_length);
+            mr->gm.target[a] = mr->line_start[a] + (mr->unit[a] * s);
         }
     }
 
+    // Switch M62/M63 outputs with the segment that reaches their distance, or the block's last
+    if ((mr->sync_out.set || mr->sync_out.clear) &&
+        ((_exec_block_s() >= mr->sync_out.distance) || ((mr->segment_count == 0) && _exec_last_section()))) {
+        st_prep_outputs(mr->sync_out.set, mr->sync_out.clear);
+        mr->sync_out = {};
+    }
+
+    // Reduce the motor run current in the cruise. Full current is requested ahead of the end
+    // of the body so it is in place for the tail, and on any feedhold.
+    if ((mr->section == SECTION_BODY) && (cm->hold_state == FEEDHOLD_OFF) &&
+        ((mr->segment_count * mr->segment_time) > MOTOR_POWER_RESTORE_LEAD)) {
+        st_request_power_scale(st_cfg.cruise_power);
+    } else {
+        st_request_power_scale(1.0);
+    }
+
+    // The spindle override ramps with the segments, and G96 follows the X radius of the
+    // segment - see spindle_override_update() and spindle_css_update()
+    spindle_override_update(mr->segment_time / mr->segment_scale);
+    spindle_css_update(mr->gm.target[AXIS_X] - mr->gm.display_offset[AXIS_X]);
+
+    // Update the mb->run_time_remaining -- we know it's missing the current segment's time before it's loaded, that's ok.
+    mp->run_time_remaining -= mr->segment_time;
+    if (mp->run_time_remaining < 0) {
+        mp->run_time_remaining = 0.0;
+    }
+
+    // a time-scaled segment runs the planned distance in 1/segment_scale the planned time
+    float segment_time = mr->segment_time / mr->segment_scale;
+    float segment_velocity = mr->segment_velocity * mr->segment_scale;
+    const float *target = mp_shaper_shape(mr->position, mr->gm.target, segment_time);
+    target = _exec_pressure_advance(target, segment_velocity, segment_time);
+    ritorno(_exec_segment_to_target(target, segment_time, segment_velocity, raster_intensity));
+    if (mr->segment_count == 0) {
+        return (STAT_OK);                                   // this section has run all its segments
+    }
+    return (STAT_EAGAIN);                                   // this section still has more segments to run
+}
+
+/*
+ * _exec_aline_settle() - run a segment holding at the end of a block that ended at rest
+ *
+ *  The runtime is already at the end of the block; the steps still trail it by the input
+ *  shaper delay (see plan_shaper.cpp) or lead it by the pressure advance. Returns STAT_OK
+ *  once they have caught up.
+ */
+
+static stat_t _exec_aline_settle()
+{
+    const float *target = mp_shaper_settle(mr->position, NOM_SEGMENT_TIME);
+    target = _exec_pressure_advance(target, 0, NOM_SEGMENT_TIME);
+    ritorno(_exec_segment_to_target(target, NOM_SEGMENT_TIME, 0, -1));
+    if (mp_shaper_active() || (mr->advance != 0)) {
+        return (STAT_EAGAIN);
+    }
+    mr->shaper_settling = false;
+    return (STAT_OK);
+}
+
+/*
+ * _exec_pressure_advance() - lead the extruder by the tool's advance times its velocity
+ *
+ *  Nozzle pressure lags the extruder, so the extruder is run ahead of its planned position
+ *  by K * extruder velocity ({tt1k:} is K in seconds). That pushes extra filament while
+ *  the move accelerates and draws it back while it decelerates. Like input shaping the
+ *  offset only goes into the steps, not the runtime position.
+ *
+ *  The offset moves toward its target no faster than the axis' velocity maximum, so a
+ *  junction into a block that doesn't extrude lets it down over a few segments instead of
+ *  in one step. Returns the target to step to - target itself if there is no advance.
+ */
+
+static float _advanced[AXES];
+
+static const float *_exec_pressure_advance(const float target[], const float velocity, const float dt)
+{
+    if ((mr->advance_k == 0) && (mr->advance == 0)) {
+        return (target);
+    }
+    uint8_t axis = mr->advance_axis;
+    float advance = mr->advance_k * velocity * mr->unit[axis] / 60;    // K in seconds, velocity in mm/min
+    float limit = cm->a[axis].velocity_max * dt;
+    if (advance > mr->advance + limit) {
+        advance = mr->advance + limit;
+    } else if (advance < mr->advance - limit) {
+        advance = mr->advance - limit;
+    }
+    mr->advance = advance;
+    copy_vector(_advanced, target);
+    _advanced[axis] += advance;
+    return (_advanced);
+}
+
+/*********************************************************************************************
+ * _exec_segment_to_target() - convert target to steps and load the segment
+ *
+ *  Shared by aline segments and the velocity jog. The caller has set mr->gm.target, which
+ *  becomes the runtime position. target is where the steps go - mr->gm.target, or the
+ *  input shaped version of it (see plan_shaper.cpp).
+ */
+
+static stat_t _exec_segment_to_target(const float target[], const float segment_time, const float segment_velocity, const int16_t raster_intensity)
+{
+    float travel_steps[MOTORS];
+
     // Convert target position to steps
     // Bucket-brigade the old target down the chain before getting the new target from kinematics
     //
@@ -929,12 +1412,12 @@ static stat_t _exec_aline_segment()
     //     Other kinematics may require transforming travel distance as opposed to simply subtracting steps.
 
     for (uint8_t m=0; m<MOTORS; m++) {
-        mr->commanded_steps[m] = mr->position_steps[m];     // previous segment's position, delayed by 1 segment
+        mr->commanded_steps[m] = en.en[m].commanded_steps;  // target of the last finished segment
         mr->position_steps[m] = mr->target_steps[m];        // previous segment's target becomes position
-        mr->encoder_steps[m] = en_read_encoder(m);          // get current encoder position (time aligns to commanded_steps)
-        mr->following_error[m] = mr->encoder_steps[m] - mr->commanded_steps[m];
+        mr->following_error[m] = en.en[m].following_error;  // encoder - commanded, latched when it finished
+        mr->encoder_steps[m] = mr->commanded_steps[m] + mr->following_error[m];
     }
-    kn_inverse_kinematics(mr->gm.target, mr->target_steps); // now determine the target steps...
+    kn_inverse_kinematics(target, mr->target_steps);        // now determine the target steps...
 
     for (uint8_t m=0; m<MOTORS; m++) {                      // and compute the distances to be traveled
         travel_steps[m] = mr->target_steps[m] - mr->position_steps[m];
@@ -943,19 +1426,150 @@ static stat_t _exec_aline_segment()
         }
     }
 
-    // Update the mb->run_time_remaining -- we know it's missing the current segment's time before it's loaded, that's ok.
-    mp->run_time_remaining -= mr->segment_time;
-    if (mp->run_time_remaining < 0) {
-        mp->run_time_remaining = 0.0;
-    }
-
     // Call the stepper prep function
-    ritorno(st_prep_line(travel_steps, mr->following_error, mr->segment_time));
+    TRACE_SEGMENT(mr->section, segment_velocity, segment_time, travel_steps, mr->following_error);
+    PROF_BEGIN(_prep_start);
+    stat_t status = st_prep_line(travel_steps, mr->following_error, mr->target_steps, segment_time,
+                                 pso_path_length(mr->position, mr->gm.target), raster_intensity);
+    PROF_END(_prep_start, PROF_PREP);
+    ritorno(status);
     copy_vector(mr->position, mr->gm.target);               // update position from target
-    if (mr->segment_count == 0) {
-        return (STAT_OK);                                   // this section has run all its segments
+    mp_publish_runtime_snapshot();                          // reports see segment boundaries only
+#if BINARY_MOTION_ENABLED == true
+    binary_motion_telemetry_sample(mr->position, segment_velocity);
+#endif
+    return (STAT_OK);
+}
+
+/*********************************************************************************************
+ * mp_velocity_jog_start() - hand the runtime to the velocity jog
+ * _exec_velocity_jog()    - run one velocity jog segment
+ *
+ *  Called with the runtime idle and the queue empty (see cm_velocity_jog()). Each axis moves
+ *  its acceleration toward the value that would bring it to the target velocity with the
+ *  acceleration reaching zero at the same time - sqrt(2 * J * dv) - changing it by at most
+ *  J * segment_time per segment. That is the jerk-limited approach with no separate
+ *  acceleration limit, which matches how the planner shapes blocks.
+ *
+ *  Targets are dropped to zero by the watchdog, by a feedhold, and per axis when the axis'
+ *  stopping distance would carry it through a soft limit. When every axis has come to rest
+ *  the jog ends and cm_jogging_cycle_callback() finishes the cycle.
+ */
+
+mpVelocityJog_t mp_vjog;
+
+void mp_velocity_jog_start()
+{
+    for (uint8_t axis = 0; axis < AXES; axis++) {   // targets were set by the caller
+        mp_vjog.velocity[axis] = 0;
+        mp_vjog.accel[axis] = 0;
     }
-    return (STAT_EAGAIN);                                   // this section still has more segments to run
+    mp_vjog.fed_tick = SysTickTimer_getValue();
+    mp_vjog.active = true;
+    st_request_exec_move();
+}
+
+static bool _velocity_jog_reaches_limit(const uint8_t axis, const float velocity, const float jerk)
+{
+    if (!(cm->soft_limit_axes & (1 << axis))) {     // see cm_update_soft_limits()
+        return (false);
+    }
+    const float stop = 1.201405707067378 / sqrt(jerk) * sqrt(fabs(velocity)) * fabs(velocity);   // see mp_get_target_length()
+    if (velocity > 0) {
+        return (mr->position[axis] + stop >= cm->soft_limit_max[axis]);
+    }
+    return (mr->position[axis] - stop <= cm->soft_limit_min[axis]);
+}
+
+static stat_t _exec_velocity_jog()
+{
+    const float dt = NOM_SEGMENT_TIME;
+    const bool stopping = (cm->hold_state != FEEDHOLD_OFF) ||
+                          ((int32_t)(SysTickTimer_getValue() - mp_vjog.fed_tick) > VELOCITY_JOG_WATCHDOG_MS);
+    bool moving = false;
+    float velocity_sq = 0;
+
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        const float jerk = cm->a[axis].jerk_max * JERK_MULTIPLIER;
+        const float v_0 = mp_vjog.velocity[axis];
+        float target = stopping ? 0 : mp_vjog.target[axis];
+        if (fp_NOT_ZERO(v_0) && ((target * v_0) >= 0) && _velocity_jog_reaches_limit(axis, v_0, jerk)) {
+            target = 0;
+        }
+        float v = v_0;
+        float a = mp_vjog.accel[axis];
+        const float dv = target - v;
+
+        if (fabs(dv) < EPSILON2) {
+            v = target;
+            a = 0;
+        } else {
+            const float a_max = sqrt(2 * jerk * fabs(dv));
+            const float da_max = jerk * dt;
+            const float a_want = (dv > 0) ? a_max : -a_max;
+            a += max(-da_max, min(da_max, a_want - a));
+            v += a * dt;
+            if (((target - v) * dv) <= 0) {             // reached or crossed the target this segment
+                v = target;
+                a = 0;
+            }
+        }
+        mp_vjog.velocity[axis] = v;
+        mp_vjog.accel[axis] = a;
+        mr->gm.target[axis] = mr->position[axis] + (v_0 + v) * 0.5 * dt;
+        if (fp_NOT_ZERO(v_0) || fp_NOT_ZERO(v)) {
+            moving = true;
+        }
+        velocity_sq += v * v;
+    }
+
+    if (!moving) {                                      // everything is at rest - the jog is over
+        mp_vjog.active = false;
+        st_prep_null();
+        return (STAT_NOOP);
+    }
+    return (_exec_segment_to_target(mr->gm.target, dt, sqrt(velocity_sq), -1));
+}
+
+/*********************************************************************************************
+ * _block_segment_time() - set the nominal segment time of a new block
+ * _section_segments()   - number of segments to run a section of the block in
+ *
+ *  A line whose joints curve is cut into chords that each deviate from the joint curve by no
+ *  more than {ktol:} steps. bf->chord_deviation is the deviation of the line as one chord, in
+ *  units of {ktol:} (see kn_chord_deviation()). A chord over a fraction f of the line deviates
+ *  by about f^2 of that, and the fastest any of it runs is the cruise velocity, so a segment
+ *  may take up to
+ *
+ *      (length / cruise_velocity) / sqrt(chord_deviation)
+ *
+ *  held to MIN_SEGMENT_TIME at the short end and NOM_SEGMENT_TIME_MAX (which DDA_SUBSTEPS is
+ *  sized for) at the long end. Slow or nearly straight moves take fewer inverse transforms
+ *  than at the nominal time, and fast moves through tight joint curvature more. Arcs, splines
+ *  and linear kinematics run at the nominal segment time, exactly as before.
+ *
+ *  A section is cut into whole segments no longer than that, unless that would make them
+ *  shorter than MIN_SEGMENT_TIME, in which case it gets as many as fit.
+ */
+
+static void _block_segment_time(const mpBuf_t *bf)
+{
+    mr->block_segment_time = NOM_SEGMENT_TIME;
+    mr->block_segment_usec = NOM_SEGMENT_USEC;
+    if ((bf->chord_deviation > 0) && !bf->arc_block && !bf->spline_block && (mr->r->cruise_velocity > 0)) {
+        float t = (bf->length / mr->r->cruise_velocity) / sqrt(bf->chord_deviation);
+        mr->block_segment_time = min(max(t, MIN_SEGMENT_TIME), NOM_SEGMENT_TIME_MAX);
+        mr->block_segment_usec = uSec(mr->block_segment_time);
+    }
+}
+
+static float _section_segments(const float section_time)
+{
+    float segments = ceil(uSec(section_time) / mr->block_segment_usec);
+    if ((segments > 1) && ((section_time / segments) < MIN_SEGMENT_TIME)) {
+        segments = max((float)1.0, floor(section_time / MIN_SEGMENT_TIME));
+    }
+    return (segments);
 }
 
 /*********************************************************************************************
@@ -992,6 +1606,7 @@ static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b)
             if (b->head_length > 0) {           // Split the body to the head and tail
                 b->head_length += b->body_length * 0.5;
                 b->tail_length += b->body_length * 0.5; // let the compiler optimize out one of these *
+                b->head_run = false;            // the head is no longer a slice of a run
                 b->head_time = (2.0 * b->head_length) / (mr->entry_velocity + b->cruise_velocity);
                 b->tail_time = (2.0 * b->tail_length) / (b->cruise_velocity + b->exit_velocity);
                 b->body_length = 0;
@@ -1005,6 +1620,7 @@ static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b)
         }
         else if (b->head_length > 0) {          // Put it all in the head
             b->head_length += b->body_length;
+            b->head_run = false;                // the head is no longer a slice of a run
             b->head_time = (2.0 * b->head_length) / (mr->entry_velocity + b->cruise_velocity);
             b->body_length = 0;
             b->body_time = 0;
@@ -1015,6 +1631,37 @@ static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b)
     }
 }
 
+/*********************************************************************************************
+ * _exec_aline_hold_jerk() - raise the block's braking jerk for a fast hold profile
+ *
+ *  Holds with PROFILE_FAST (SKIP type) stop at the axes' high jerk instead of the jerk the
+ *  block was planned with. Only the terms used to plan the hold tail are rewritten. This is
+ *  safe because a fast hold discards the rest of the block it stops in, so the raised jerk
+ *  is never used to plan the remainder of the move.
+ */
+
+static void _exec_aline_hold_jerk(mpBuf_t *bf)
+{
+    if (cm->hold_profile != PROFILE_FAST) {
+        return;
+    }
+    float jerk = 8675309;                                   // same sentinel as _calculate_jerk()
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (fabs(bf->unit[axis]) > 0) {
+            jerk = min(jerk, cm->a[axis].jerk_high / fabs(bf->unit[axis]));
+        }
+    }
+    jerk *= JERK_MULTIPLIER;
+    if (jerk <= bf->jerk) {                                 // never brake softer than planned
+        return;
+    }
+    bf->jerk = jerk;
+    bf->jerk_sq = jerk * jerk;
+    bf->recip_jerk = 1 / jerk;
+    bf->sqrt_j = sqrt(jerk);
+    bf->q_recip_2_sqrt_j = 2.40281141413 / (2 * bf->sqrt_j);   // q = (sqrt(10)/(3^(1/4)))
+}
+
 /*********************************************************************************************
  * _exec_aline_feedhold() - feedhold helper for mp_exec_aline()
  *
@@ -1035,6 +1682,8 @@ static void _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b)
  *                or tail.
  */
 
+static float _hold_travelled;                       // length of the hold decel in earlier blocks
+
 static stat_t _exec_aline_feedhold(mpBuf_t *bf) 
 {
     // Case (4) - Wait for the steppers to stop and complete the feedhold
@@ -1051,7 +1700,22 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
             
             // Otherwise setup the block to complete motion (regardless of how hold will ultimately be exited)      
             else { 
-                bf->length = get_axis_vector_length(mr->position, mr->target);  // update bf w/remaining length in move
+                mp_hold_sync_output(bf);                    // outputs not switched yet go with the rest of the move
+                if (mr->arc_block) {                        // restart the arc from where it stopped
+                    bf->length = mr->arc_length - mr->arc_s;
+                    bf->arc.theta += mr->arc_s * bf->arc.theta_per_mm;
+                    bf->arc.linear_start += mr->arc_s * bf->arc.linear_per_mm;
+                    mp_arc_tangent(&bf->arc, 0, bf->unit);
+                } else if (mr->spline_block) {              // ...or the spline
+                    bf->length = mr->arc_length - mr->arc_s;
+                    bf->spline.s_start += mr->arc_s;
+                    mp_spline_tangent(&bf->spline, 0, bf->unit);
+                } else {
+                    bf->length = get_axis_vector_length(mr->position, mr->target);  // update bf w/remaining length in move
+                    if (mr->raster_block) {                 // restart the scanline from the pixel it stopped on
+                        bf->raster.pixel_start += mr->raster_s * bf->raster.pixels_per_mm;
+                    }
+                }
                 
                 // If length ~= 0 it's because the deceleration was exact. Handle this exception to avoid planning errors
                 if (bf->length < EPSILON4) {
@@ -1062,6 +1726,7 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
                     while (bf->buffer_state > MP_BUFFER_BACK_PLANNED) {
                         bf->buffer_state = MP_BUFFER_BACK_PLANNED;// revert from RUNNING so it can be forward planned again
                         bf->plannable = true;               // needed so block can be re-planned
+                        bf->converged = false;
                         bf = mp_get_next_buffer(bf);
                     }
                 }
@@ -1086,8 +1751,14 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
     if ((cm->hold_state == FEEDHOLD_SYNC) ||
         ((cm->hold_state == FEEDHOLD_DECEL_CONTINUE) && (mr->block_state == BLOCK_INITIAL_ACTION))) {
 
+        if (cm->hold_state == FEEDHOLD_SYNC) {
+            _hold_travelled = 0;                            // distance decelerated in blocks already finished
+        }
+        _exec_aline_hold_jerk(bf);
+
         // Case (1d) - Already decelerating (in a tail), continue the deceleration.
         if (mr->section == SECTION_TAIL) {                  // if already in a tail don't decelerate. You already are
+            cm->hold_distance = _hold_travelled + mp_get_target_length(0, mr->segment_velocity, bf);
             if (mr->r->exit_velocity < EPSILON2) {          // allow near-zero velocities to be treated as zero
                 cm->hold_state = FEEDHOLD_DECEL_TO_ZERO;
             } else {
@@ -1119,7 +1790,9 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
         // enough (to EPSILON2) (1e). Case 1e happens frequently when the tail in the move was 
         // already planned to zero. EPSILON2 deals with floating point rounding errors that can 
         // mis-classify this case. EPSILON2 is 0.0001, which is 0.1 microns in length.
-        float available_length = get_axis_vector_length(mr->target, mr->position);
+        float available_length = ((mr->arc_block || mr->spline_block) ? (mr->arc_length - mr->arc_s) :
+                                                  get_axis_vector_length(mr->target, mr->position));
+        cm->hold_distance = _hold_travelled + mr->r->tail_length;
 
         // Cases (1b1, 1c1) deceleration will fit in the block
         if ((available_length + EPSILON2 - mr->r->tail_length) > 0) {
@@ -1131,6 +1804,7 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
         // Cases (1b2, 1c2) deceleration will not fit in the block
         else {
             cm->hold_state = FEEDHOLD_DECEL_CONTINUE;
+            _hold_travelled += available_length;            // the stop carries on into the next block
             mr->r->tail_length = available_length;
             mr->r->exit_velocity = mp_get_decel_velocity(mr->r->cruise_velocity, mr->r->tail_length, bf);
             if (mr->r->exit_velocity >= 0) {
@@ -37,6 +37,8 @@
 #include "spindle.h"
 #include "settings.h"
 #include "xio.h"
+#include "benchmark.h"
+#include "kinematics.h"
 
 // using Motate::Timeout;
 
@@ -51,8 +53,17 @@ extern OutputPin<kDebug3_PinNumber> debug_pin3;
 static mpBuf_t* _plan_block(mpBuf_t* bf);
 static void _calculate_override(mpBuf_t* bf);
 static void _calculate_jerk(mpBuf_t* bf);
+static void _set_jerk(mpBuf_t* bf, const float jerk);
 static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const float axis_square[]);
+static void _calculate_joint_limits(mpBuf_t* bf, const float start[]);
+static void _calculate_chord_deviation(mpBuf_t* bf, const float start[]);
+static void _throttle_to_link(mpBuf_t* bf);
 static void _calculate_junction_vmax(mpBuf_t* bf);
+static void _rotate_target(const GCodeState_t* _gm, float target_rotated[]);
+static stat_t _aline(const GCodeState_t* _gm, const float target_rotated[], mpRasterLine_t* line = nullptr);
+static bool _block_is_rewritable(const mpBuf_t* bf);
+static void _reprime_block(mpBuf_t* bf);
+static void _take_sync_output(mpBuf_t* bf);
 
 
 #ifdef __PLANNER_DIAGNOSTICS
@@ -76,31 +87,111 @@ static void _set_bf_diagnostics(mpBuf_t* bf) {}
  *                                      that were in effect at move planning time
  */
 
-void  mp_zero_segment_velocity() { mr->segment_velocity = 0; }
-float mp_get_runtime_velocity(void) { return (mr->segment_velocity); }
+void  mp_zero_segment_velocity() { mr->segment_velocity = 0; mr->snapshot_valid = false; }
+float mp_get_runtime_velocity(void) { return (mr->segment_velocity * mr->segment_scale); }
 float mp_get_runtime_absolute_position(mpPlannerRuntime_t *_mr, uint8_t axis) { return (_mr->position[axis]); }
-void mp_set_runtime_display_offset(float offset[]) { copy_vector(mr->gm.display_offset, offset); }
+void mp_set_runtime_display_offset(float offset[]) { copy_vector(mr->gm.display_offset, offset); mr->snapshot_valid = false; }
 
 // We have to handle rotation - "rotate" by the transverse of the matrix to got "normal" coordinates
-float mp_get_runtime_display_position(uint8_t axis) {
+static float _display_position(const float position[], const float display_offset[], const uint8_t axis) {
     // Shorthand:
     // target_rotated[0] = a x_1 + b x_2 + c x_3
     // target_rotated[1] = a y_1 + b y_2 + c y_3
     // target_rotated[2] = a z_1 + b z_2 + c z_3 + z_offset
 
-    if (axis == AXIS_X) {
-        return mr->position[0] * cm->rotation_matrix[0][0] + mr->position[1] * cm->rotation_matrix[1][0] +
-               mr->position[2] * cm->rotation_matrix[2][0] - mr->gm.display_offset[0];
+    if ((axis > AXIS_Z) || cm->rotation_identity) {
+        // ABC, UVW, we don't rotate them - nor XYZ on an untrammed machine
+        const float z_offset = (axis == AXIS_Z) ? cm->rotation_z_offset : 0;
+        return (position[axis] - z_offset - display_offset[axis]);
+    } else if (axis == AXIS_X) {
+        return position[0] * cm->rotation_matrix[0][0] + position[1] * cm->rotation_matrix[1][0] +
+               position[2] * cm->rotation_matrix[2][0] - display_offset[0];
     } else if (axis == AXIS_Y) {
-        return mr->position[0] * cm->rotation_matrix[0][1] + mr->position[1] * cm->rotation_matrix[1][1] +
-               mr->position[2] * cm->rotation_matrix[2][1] - mr->gm.display_offset[1];
-    } else if (axis == AXIS_Z) {
-        return mr->position[0] * cm->rotation_matrix[0][2] + mr->position[1] * cm->rotation_matrix[1][2] +
-               mr->position[2] * cm->rotation_matrix[2][2] - cm->rotation_z_offset - mr->gm.display_offset[2];
+        return position[0] * cm->rotation_matrix[0][1] + position[1] * cm->rotation_matrix[1][1] +
+               position[2] * cm->rotation_matrix[2][1] - display_offset[1];
     } else {
-        // ABC, UVW, we don't rotate them
-        return (mr->position[axis] - mr->gm.display_offset[axis]);
+        return position[0] * cm->rotation_matrix[0][2] + position[1] * cm->rotation_matrix[1][2] +
+               position[2] * cm->rotation_matrix[2][2] - cm->rotation_z_offset - display_offset[2];
+    }
+}
+
+float mp_get_runtime_display_position(uint8_t axis) {
+    return (_display_position(mr->position, mr->gm.display_offset, axis));
+}
+
+float mp_get_snapshot_display_position(const mpRuntimeSnapshot_t *s, const uint8_t axis) {
+    return (_display_position(s->position, s->display_offset, axis));
+}
+
+/*
+ * mp_publish_runtime_snapshot() - publish the runtime state at the end of a segment - exec only
+ * mp_get_runtime_snapshot()     - the runtime state a report reads - main loop only
+ * mp_hold_runtime_snapshot()    - take a snapshot and keep it until released
+ *
+ *  See mpRuntimeSnapshot_t in planner.h. Reports hold the snapshot while they read their
+ *  fields, so every field comes from the same segment. A lone query takes a fresh one.
+ */
+
+static void _fill_runtime_snapshot(mpRuntimeSnapshot_t *s)
+{
+    copy_vector(s->position, mr->position);
+    copy_vector(s->display_offset, mr->gm.display_offset);
+    s->velocity = mr->segment_velocity * mr->segment_scale;
+    s->feed_rate = mr->gm.feed_rate;
+    s->linenum = mr->gm.linenum;
+    s->units_mode = mr->gm.units_mode;
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        s->following_error[motor] = mr->following_error[motor];
+    }
+}
+
+void mp_publish_runtime_snapshot()
+{
+    const uint32_t seq = mr->snapshot_seq + 1;
+    _fill_runtime_snapshot(&mr->snapshot[seq & 1]);
+    __DMB();
+    mr->snapshot_seq = seq;
+    mr->snapshot_valid = true;
+}
+
+static mpRuntimeSnapshot_t _snapshot;       // the reader's copy
+static bool _snapshot_held = false;
+
+static void _take_runtime_snapshot()
+{
+    if (!mr->snapshot_valid) {              // the runtime was changed outside a segment - read it as it is
+        _fill_runtime_snapshot(&_snapshot);
+        return;
     }
+    uint32_t seq;
+    do {
+        seq = mr->snapshot_seq;
+        __DMB();
+        _snapshot = mr->snapshot[seq & 1];
+        __DMB();
+    } while (seq != mr->snapshot_seq);      // a segment was published during the copy
+}
+
+const mpRuntimeSnapshot_t *mp_get_runtime_snapshot()
+{
+    if (!_snapshot_held) {
+        _take_runtime_snapshot();
+    }
+    return (&_snapshot);
+}
+
+void mp_hold_runtime_snapshot(const bool hold)
+{
+    if (hold) {
+        _take_runtime_snapshot();
+    }
+    _snapshot_held = hold;
+}
+
+stat_t mp_get_fe(nvObj_t *nv)               // _feN - motor N following error in steps
+{
+    const uint8_t motor = nv->token[strlen(nv->token) - 1] - '1';
+    return (get_float(nv, mp_get_runtime_snapshot()->following_error[motor]));
 }
 
 /****************************************************************************************
@@ -139,11 +230,27 @@ bool mp_runtime_is_idle() { return (!st_runtime_isbusy()); }
  *  Note: Returning a status that is not STAT_OK means the endpoint is NOT advanced. So lines
  *        that are too short to move will accumulate and get executed once the accumulated error
  *        exceeds the minimums.
+ *
+ *  Note: A line that moves no motor a whole step (kn_is_sub_step()) is rejected this way before
+ *        any of the vector math, so CAM rounding moves don't take a planner buffer or force a
+ *        near-stop. Its travel is carried into the next line. Scanlines are only rejected for
+ *        zero length, as they carry their pixels.
  */
 
 stat_t mp_aline(GCodeState_t* _gm)
 {
-    float target_rotated[]  = INIT_AXES_ZEROES;
+    float target_rotated[] = INIT_AXES_ZEROES;
+
+    _rotate_target(_gm, target_rotated);
+    return (_aline(_gm, target_rotated));
+}
+
+/*
+ * _aline() - queue a line to a target that is already in the rotated (planner) coordinate space
+ */
+
+static stat_t _aline(const GCodeState_t* _gm, const float target_rotated[], mpRasterLine_t* line)
+{
     float axis_square[]     = INIT_AXES_ZEROES;
     float axis_length[]     = INIT_AXES_ZEROES;
     bool  flags[]           = INIT_AXES_FALSE;
@@ -151,6 +258,401 @@ stat_t mp_aline(GCodeState_t* _gm)
     float length_square = 0;
     float length;
 
+    if ((line == nullptr) && kn_is_sub_step(mp->position, target_rotated)) {
+        sr_request_status_report(SR_REQUEST_TIMED_FULL);
+        return (STAT_MINIMUM_LENGTH_MOVE);
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        axis_length[axis] = target_rotated[axis] - mp->position[axis];
+        if ((flags[axis] = fp_NOT_ZERO(axis_length[axis]))) {  // yes, this supposed to be = not ==
+            axis_square[axis] = square(axis_length[axis]);
+            length_square += axis_square[axis];
+        } else {
+            axis_length[axis] = 0;  // make it truly zero if it was tiny
+            axis_square[axis] = 0;  // Fix bug that can kill feedholds by corrupting block_time in _calculate_times 
+        }
+    }
+    length = sqrt(length_square);
+
+    // exit if the move has zero movement. At all.
+//    if (length < 0.00002) {  // this value is 2x EPSILON and prevents trap failures in _plan_aline()
+    if (length < 0.0001) {      // this value is 0.1 microns. Prevents planner trap failures
+        sr_request_status_report(SR_REQUEST_TIMED_FULL);  // Was SR_REQUEST_IMMEDIATE_FULL
+        return (STAT_MINIMUM_LENGTH_MOVE);                // STAT_MINIMUM_LENGTH_MOVE needed to end cycle
+    }
+
+    // get a cleared buffer and copy in the Gcode model state
+    mpBuf_t* bf = mp_get_write_buffer(); 
+    
+    if (bf == NULL) {                                   // never supposed to fail
+        return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "aline()"));
+    }
+    memcpy(&bf->gm, _gm, sizeof(GCodeState_t));
+    copy_vector(bf->gm.target, target_rotated);         // copy the rotated target in place
+
+    // setup the buffer
+    bf->bf_func = mp_exec_aline;                        // register the callback to the exec function
+    bf->length = length;                                // record the length
+    _take_sync_output(bf);                              // M62/M63 outputs waiting for this move
+    if (line != nullptr) {                              // scanline - spread the pixels over the length
+        bf->raster_block = true;
+        bf->raster.line = line;
+        bf->raster.pixel_start = 0;
+        bf->raster.pixels_per_mm = line->count / length;
+        mp_take_raster_line();
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {       // compute the unit vector and set flags
+        if ((bf->axis_flags[axis] = flags[axis])) {     // yes, this is supposed to be = and not ==
+            bf->unit[axis] = axis_length[axis] / length;// nb: bf-> unit was cleared by mp_get_write_buffer()
+        }
+    }
+    _calculate_jerk(bf);                                // compute bf->jerk values
+    _calculate_vmaxes(bf, axis_length, axis_square);    // compute cruise_vmax and absolute_vmax
+    _calculate_chord_deviation(bf, mp->position);       // sizes the segments - see kinematics.h
+    if (kn_is_tool_center_point()) {
+        _calculate_joint_limits(bf, mp->position);      // 5-axis joints can be the limit
+    }
+    _throttle_to_link(bf);                              // no faster than the host can send them
+    _set_bf_diagnostics(bf);                            // DIAGNOSTIC
+
+    // Note: these next lines must remain in exact order. Position must update before committing the buffer.
+    copy_vector(mp->position, bf->gm.target);           // update the planner position for the next move
+    mp_commit_write_buffer(BLOCK_TYPE_ALINE);           // commit current block (must follow the position update)
+    return (STAT_OK);
+}
+
+/****************************************************************************************
+ * mp_raster() - queue a scanline as a single planner block
+ *
+ *  line must be the one returned by mp_get_raster_line(), filled in with line->count pixels.
+ *  The block is otherwise an ordinary line to the target in _gm. See planner.h.
+ */
+
+stat_t mp_raster(GCodeState_t* _gm, mpRasterLine_t* line)
+{
+    float target_rotated[] = INIT_AXES_ZEROES;
+
+    _rotate_target(_gm, target_rotated);
+    return (_aline(_gm, target_rotated, line));
+}
+
+/****************************************************************************************
+ * mp_arc()         - queue an arc or helix as a single planner block
+ * mp_arc_point()   - set the plane and linear axes of point[] to the arc position at path length s
+ * mp_arc_tangent() - set the plane and linear axes of unit[] to the arc direction at path length s
+ *
+ *  The arc is given in model coordinates and must not need rotation - the caller checks that
+ *  the rotation matrix is identity. _rotate_target() still applies the Z offset.
+ *
+ *  The block is planned as a line of the arc's path length. Axis rates and jerk are limited
+ *  with the largest unit vector each plane axis reaches anywhere on a circle. The junctions
+ *  use the tangents at the ends of the arc. Along the arc the direction turns continuously,
+ *  which _calculate_junction_vmax() would see as many small corners: a delta of v*T/r every
+ *  integration time T. Limiting that to the junction velocity change gives
+ *
+ *      v^2 <= max_junction_accel * r / T
+ *
+ *  so the cruise velocity of an arc follows the same cornering setting {jt:} as its chords did.
+ *  The exec interpolates the arc at segment level, so the chords are one segment long and
+ *  no longer depend on the arc segment count.
+ */
+
+stat_t mp_arc(const GCodeState_t* _gm, const mpArc_t* arc, const float length)
+{
+    float target_rotated[] = INIT_AXES_ZEROES;
+    float axis_length[]    = INIT_AXES_ZEROES;
+    float axis_square[]    = INIT_AXES_ZEROES;
+    const uint8_t p0  = arc->plane_axis_0;
+    const uint8_t p1  = arc->plane_axis_1;
+    const uint8_t lin = arc->linear_axis;
+
+    _rotate_target(_gm, target_rotated);
+
+    mpBuf_t* bf = mp_get_write_buffer();
+    if (bf == NULL) {                                   // never supposed to fail
+        return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "mp_arc()"));
+    }
+    memcpy(&bf->gm, _gm, sizeof(GCodeState_t));
+    copy_vector(bf->gm.target, target_rotated);
+
+    bf->bf_func = mp_exec_aline;
+    bf->length = length;
+    _take_sync_output(bf);
+    bf->arc_block = true;
+    bf->arc = *arc;
+    bf->arc.center_0 += target_rotated[p0] - _gm->target[p0];   // move the arc by the Z offset
+    bf->arc.center_1 += target_rotated[p1] - _gm->target[p1];
+    bf->arc.linear_start += target_rotated[lin] - _gm->target[lin];
+
+    // worst case unit vector over the arc for jerk and axis rate limits
+    float planar = fabs(arc->radius * arc->theta_per_mm);
+    float linear = fabs(arc->linear_per_mm);
+    bf->axis_flags[p0] = true;
+    bf->axis_flags[p1] = true;
+    bf->unit[p0] = planar;
+    bf->unit[p1] = planar;
+    axis_length[p0] = planar * length;
+    axis_length[p1] = planar * length;
+    axis_square[p0] = square(axis_length[p0]);          // one plane axis carries the planar length
+    if ((bf->axis_flags[lin] = fp_NOT_ZERO(arc->linear_per_mm))) {
+        bf->unit[lin] = linear;
+        axis_length[lin] = linear * length;
+        axis_square[lin] = square(axis_length[lin]);
+    }
+    _calculate_jerk(bf);
+    _calculate_vmaxes(bf, axis_length, axis_square);
+
+    // centripetal limit
+    float T = cm->junction_integration_time / 1000.0;
+    float arc_vmax = sqrt(min(cm->a[p0].max_junction_accel, cm->a[p1].max_junction_accel) * arc->radius / T);
+    if (bf->cruise_vset > arc_vmax) {
+        bf->cruise_vset = arc_vmax;
+        bf->cruise_vmax = arc_vmax;
+        bf->block_time = length / arc_vmax;
+    }
+    bf->absolute_vmax = min(bf->absolute_vmax, arc_vmax);
+    _throttle_to_link(bf);
+
+    mp_arc_tangent(&bf->arc, 0, bf->unit);              // entry direction for the junction and runtime
+    _set_bf_diagnostics(bf);
+
+    copy_vector(mp->position, bf->gm.target);           // update the planner position for the next move
+    mp_commit_write_buffer(BLOCK_TYPE_ALINE);           // commit current block (must follow the position update)
+    return (STAT_OK);
+}
+
+void mp_arc_point(const mpArc_t* arc, const float s, float point[])
+{
+    float theta = arc->theta + s * arc->theta_per_mm;
+    point[arc->plane_axis_0] = arc->center_0 + sin(theta) * arc->radius;
+    point[arc->plane_axis_1] = arc->center_1 + cos(theta) * arc->radius;
+    point[arc->linear_axis]  = arc->linear_start + s * arc->linear_per_mm;
+}
+
+void mp_arc_tangent(const mpArc_t* arc, const float s, float unit[])
+{
+    float theta = arc->theta + s * arc->theta_per_mm;
+    float planar = arc->radius * arc->theta_per_mm;
+    unit[arc->plane_axis_0] =  cos(theta) * planar;
+    unit[arc->plane_axis_1] = -sin(theta) * planar;
+    unit[arc->linear_axis]  = arc->linear_per_mm;
+}
+
+/****************************************************************************************
+ * mp_spline()         - queue a cubic Bezier spline (G5, G5.1) as a single planner block
+ * mp_spline_point()   - set X, Y and Z of point[] to the spline position at path length s
+ * mp_spline_tangent() - set X, Y and Z of unit[] to the spline direction at path length s
+ *
+ *  control[] holds the four control points in model coordinates. The first is the current
+ *  position and the last is _gm->target. A Bezier is unchanged in shape by an affine map of
+ *  its control points, so the rotation matrix and Z offset are applied to the control points
+ *  and the rotated curve is exact.
+ *
+ *  The block is planned like a native arc (see mp_arc()): worst case unit vectors for the
+ *  jerk and axis rate limits, the end tangents at the junctions, and a centripetal cruise
+ *  limit. Curvature isn't constant on a spline, so the limit is taken at the smallest radius
+ *  of curvature sampled along the curve (SPLINE_CURVATURE_SAMPLES).
+ */
+
+#define SPLINE_CURVATURE_SAMPLES 32     // points sampled for the smallest radius of curvature
+#define SPLINE_RADIUS_MIN 0.01          // floor for the radius of curvature at a cusp, in mm
+
+static void _spline_derivative(const mpSpline_t* sp, const float t, float d[])
+{
+    float u = 1 - t;
+    for (uint8_t a = 0; a < 3; a++) {
+        d[a] = 3 * (u * u * (sp->p[1][a] - sp->p[0][a]) +
+                    2 * u * t * (sp->p[2][a] - sp->p[1][a]) +
+                    t * t * (sp->p[3][a] - sp->p[2][a]));
+    }
+}
+
+static void _spline_second_derivative(const mpSpline_t* sp, const float t, float d[])
+{
+    for (uint8_t a = 0; a < 3; a++) {
+        d[a] = 6 * ((1 - t) * (sp->p[2][a] - 2 * sp->p[1][a] + sp->p[0][a]) +
+                    t * (sp->p[3][a] - 2 * sp->p[2][a] + sp->p[1][a]));
+    }
+}
+
+static float _spline_speed(const mpSpline_t* sp, const float t)
+{
+    float d[3];
+    _spline_derivative(sp, t, d);
+    return (sqrt(square(d[0]) + square(d[1]) + square(d[2])));
+}
+
+// path length between curve parameters t0 and t1 - 3 point Gauss-Legendre quadrature
+static float _spline_length(const mpSpline_t* sp, const float t0, const float t1)
+{
+    float half = (t1 - t0) / 2;
+    float mid = t0 + half;
+    float node = half * 0.7745966692;   // sqrt(3/5)
+    return (half * (5.0/9.0 * _spline_speed(sp, mid - node) +
+                    8.0/9.0 * _spline_speed(sp, mid) +
+                    5.0/9.0 * _spline_speed(sp, mid + node)));
+}
+
+// curve parameter at path length s from the block start
+static float _spline_parameter(const mpSpline_t* sp, float s)
+{
+    s += sp->s_start;
+    uint8_t k = 0;
+    while ((k < SPLINE_KNOTS-1) && (sp->knot_s[k] < s)) {
+        k++;
+    }
+    float s0 = (k == 0) ? 0 : sp->knot_s[k-1];
+    float t0 = (float)k / SPLINE_KNOTS;
+    float t = t0;
+    if (sp->knot_s[k] - s0 > EPSILON) {
+        t += (s - s0) / (sp->knot_s[k] - s0) / SPLINE_KNOTS;
+    }
+    float speed = _spline_speed(sp, t);                 // one Newton step on the table estimate
+    if (speed > EPSILON) {
+        t -= (s0 + _spline_length(sp, t0, t) - s) / speed;
+    }
+    return (min(max(t, 0.0f), 1.0f));
+}
+
+stat_t mp_spline(const GCodeState_t* _gm, const float control[4][3])
+{
+    float target_rotated[] = INIT_AXES_ZEROES;
+    float axis_length[]    = INIT_AXES_ZEROES;
+    float axis_square[]    = INIT_AXES_ZEROES;
+    mpSpline_t sp;
+
+    _rotate_target(_gm, target_rotated);
+    for (uint8_t i = 1; i < 3; i++) {
+        if (cm->rotation_identity) {
+            memcpy(sp.p[i], control[i], sizeof(sp.p[i]));
+        } else {
+            for (uint8_t a = 0; a < 3; a++) {
+                sp.p[i][a] = control[i][AXIS_X] * cm->rotation_matrix[a][0] +
+                             control[i][AXIS_Y] * cm->rotation_matrix[a][1] +
+                             control[i][AXIS_Z] * cm->rotation_matrix[a][2];
+            }
+        }
+        sp.p[i][AXIS_Z] += cm->rotation_z_offset;
+    }
+    for (uint8_t a = 0; a < 3; a++) {
+        sp.p[0][a] = mp->position[a];                   // the curve starts where the planner is
+        sp.p[3][a] = target_rotated[a];
+    }
+    sp.s_start = 0;
+
+    float length = 0;
+    for (uint8_t k = 0; k < SPLINE_KNOTS; k++) {
+        length += _spline_length(&sp, (float)k / SPLINE_KNOTS, (float)(k+1) / SPLINE_KNOTS);
+        sp.knot_s[k] = length;
+    }
+    if (length < 0.0001) {                              // same minimum as _aline()
+        sr_request_status_report(SR_REQUEST_TIMED_FULL);
+        return (STAT_MINIMUM_LENGTH_MOVE);
+    }
+
+    // smallest radius of curvature: |B'|^3 / |B' x B''|
+    float radius = 8675309;
+    for (uint8_t i = 0; i < SPLINE_CURVATURE_SAMPLES; i++) {
+        float t = (i + 0.5) / SPLINE_CURVATURE_SAMPLES;
+        float d1[3], d2[3];
+        _spline_derivative(&sp, t, d1);
+        _spline_second_derivative(&sp, t, d2);
+        float cross = sqrt(square(d1[1] * d2[2] - d1[2] * d2[1]) +
+                           square(d1[2] * d2[0] - d1[0] * d2[2]) +
+                           square(d1[0] * d2[1] - d1[1] * d2[0]));
+        float speed = sqrt(square(d1[0]) + square(d1[1]) + square(d1[2]));
+        if (cross > EPSILON) {
+            radius = min(radius, speed * speed * speed / cross);
+        }
+    }
+    radius = max(radius, SPLINE_RADIUS_MIN);
+
+    mpBuf_t* bf = mp_get_write_buffer();
+    if (bf == NULL) {                                   // never supposed to fail
+        return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "mp_spline()"));
+    }
+    memcpy(&bf->gm, _gm, sizeof(GCodeState_t));
+    copy_vector(bf->gm.target, target_rotated);
+
+    bf->bf_func = mp_exec_aline;
+    bf->length = length;
+    _take_sync_output(bf);
+    bf->spline_block = true;
+    bf->spline = sp;
+
+    // worst case unit vector for jerk and axis rate limits - any of X, Y and Z can be tangent
+    for (uint8_t a = 0; a < 3; a++) {
+        float lo = min(min(sp.p[0][a], sp.p[1][a]), min(sp.p[2][a], sp.p[3][a]));
+        float hi = max(max(sp.p[0][a], sp.p[1][a]), max(sp.p[2][a], sp.p[3][a]));
+        if ((bf->axis_flags[a] = fp_NOT_ZERO(hi - lo))) {
+            bf->unit[a] = 1;
+            axis_length[a] = length;
+        }
+    }
+    axis_square[AXIS_X] = square(length);               // one axis carries the path length
+    _calculate_jerk(bf);
+    _calculate_vmaxes(bf, axis_length, axis_square);
+
+    // centripetal limit at the tightest point of the curve
+    float T = cm->junction_integration_time / 1000.0;
+    float junction_accel = 8675309;
+    for (uint8_t a = 0; a < 3; a++) {
+        if (bf->axis_flags[a]) {
+            junction_accel = min(junction_accel, cm->a[a].max_junction_accel);
+        }
+    }
+    float spline_vmax = sqrt(junction_accel * radius / T);
+    if (bf->cruise_vset > spline_vmax) {
+        bf->cruise_vset = spline_vmax;
+        bf->cruise_vmax = spline_vmax;
+        bf->block_time = length / spline_vmax;
+    }
+    bf->absolute_vmax = min(bf->absolute_vmax, spline_vmax);
+    _throttle_to_link(bf);
+
+    mp_spline_tangent(&bf->spline, 0, bf->unit);       // entry direction for the junction and runtime
+    _set_bf_diagnostics(bf);
+
+    copy_vector(mp->position, bf->gm.target);           // update the planner position for the next move
+    mp_commit_write_buffer(BLOCK_TYPE_ALINE);           // commit current block (must follow the position update)
+    return (STAT_OK);
+}
+
+void mp_spline_point(const mpSpline_t* spline, const float s, float point[])
+{
+    float t = _spline_parameter(spline, s);
+    float u = 1 - t;
+    for (uint8_t a = 0; a < 3; a++) {
+        point[a] = u * u * u * spline->p[0][a] + 3 * u * u * t * spline->p[1][a] +
+                   3 * u * t * t * spline->p[2][a] + t * t * t * spline->p[3][a];
+    }
+}
+
+void mp_spline_tangent(const mpSpline_t* spline, const float s, float unit[])
+{
+    float t = _spline_parameter(spline, s);
+    float d[3];
+    _spline_derivative(spline, t, d);
+    float speed = sqrt(square(d[0]) + square(d[1]) + square(d[2]));
+    if (speed < EPSILON) {                              // a control point on an end point: B' is zero
+        _spline_second_derivative(spline, t, d);       // ...and the curve leaves along B''
+        speed = sqrt(square(d[0]) + square(d[1]) + square(d[2]));
+    }
+    if (speed < EPSILON) {                              // degenerate - use the chord
+        for (uint8_t a = 0; a < 3; a++) { d[a] = spline->p[3][a] - spline->p[0][a]; }
+        speed = max(sqrt(square(d[0]) + square(d[1]) + square(d[2])), EPSILON);
+    }
+    for (uint8_t a = 0; a < 3; a++) {
+        unit[a] = d[a] / speed;
+    }
+}
+
+/****************************************************************************************
+ * _rotate_target() - apply the rotation matrix and Z offset to a model target
+ */
+
+static void _rotate_target(const GCodeState_t* _gm, float target_rotated[])
+{
     // A few notes about the rotated coordinate space:
     // These are positions PRE-rotation:
     //  _gm.* (anything in _gm)
@@ -169,6 +671,14 @@ stat_t mp_aline(GCodeState_t* _gm)
     //  b being target[1],
     //  c being target[2],
     //  x_1 being cm->rotation_matrix[1][0]
+    //
+    // An untrammed machine has an identity matrix, and only the z_offset applies.
+
+    if (cm->rotation_identity) {
+        memcpy(target_rotated, _gm->target, sizeof(float)*AXES);
+        target_rotated[AXIS_Z] += cm->rotation_z_offset;
+        return;
+    }
 
     target_rotated[AXIS_X] = _gm->target[AXIS_X] * cm->rotation_matrix[0][0] + 
                              _gm->target[AXIS_Y] * cm->rotation_matrix[0][1] +
@@ -192,50 +702,275 @@ stat_t mp_aline(GCodeState_t* _gm)
     target_rotated[AXIS_A] = _gm->target[AXIS_A];
     target_rotated[AXIS_B] = _gm->target[AXIS_B];
     target_rotated[AXIS_C] = _gm->target[AXIS_C];
+}
 
+/****************************************************************************************
+ * mp_merge_aline() - fold a G1 into the newest queued block if the path stays collinear
+ *
+ *  Returns STAT_OK if the move was absorbed into the newest block, or STAT_NOOP if the
+ *  caller should queue it normally with mp_aline(). Merging is enabled by a non-zero
+ *  segment merge tolerance {mgt:}.
+ *
+ *  A move merges if:
+ *    - the newest block is a G1 with the same feed rate and modal state as this move
+ *    - the newest block has not been forward planned, and neither has the block before it,
+ *      so the runtime cannot reach it while it is being rewritten
+ *    - the old endpoint lies between the new start and end points, and within the chordal
+ *      tolerance of the merged line. Deviations accumulate across merges (triangle
+ *      inequality), so every point that was merged away stays within the tolerance.
+ *
+ *  The merged block keeps the line number of the first line in gm.linenum and records the
+ *  last line merged into it in merged_linenum. The runtime reports each in turn.
+ */
+
+static bool _merge_gm_matches(const GCodeState_t* a, const GCodeState_t* b)
+{
+    if ((a->motion_mode    != MOTION_MODE_STRAIGHT_FEED) ||
+        (b->motion_mode    != MOTION_MODE_STRAIGHT_FEED) ||
+        (a->feed_rate_mode != UNITS_PER_MINUTE_MODE) ||
+        (b->feed_rate_mode != UNITS_PER_MINUTE_MODE) ||
+        (a->path_control   == PATH_EXACT_STOP) ||
+        (a->path_control   != b->path_control) ||
+        (a->units_mode     != b->units_mode) ||
+        (a->select_plane   != b->select_plane) ||
+        (a->coord_system   != b->coord_system) ||
+        (a->absolute_override != b->absolute_override) ||
+        (a->tool           != b->tool) ||
+        (!fp_EQ(a->feed_rate, b->feed_rate))) {
+        return (false);
+    }
     for (uint8_t axis = 0; axis < AXES; axis++) {
-        axis_length[axis] = target_rotated[axis] - mp->position[axis];
-        if ((flags[axis] = fp_NOT_ZERO(axis_length[axis]))) {  // yes, this supposed to be = not ==
-            axis_square[axis] = square(axis_length[axis]);
-            length_square += axis_square[axis];
-        } else {
-            axis_length[axis] = 0;  // make it truly zero if it was tiny
-            axis_square[axis] = 0;  // Fix bug that can kill feedholds by corrupting block_time in _calculate_times 
+        if (!fp_EQ(a->display_offset[axis], b->display_offset[axis])) {
+            return (false);
         }
     }
-    length = sqrt(length_square);
+    return (true);
+}
 
-    // exit if the move has zero movement. At all.
-//    if (length < 0.00002) {  // this value is 2x EPSILON and prevents trap failures in _plan_aline()
-    if (length < 0.0001) {      // this value is 0.1 microns. Prevents planner trap failures
-        sr_request_status_report(SR_REQUEST_TIMED_FULL);  // Was SR_REQUEST_IMMEDIATE_FULL
-        return (STAT_MINIMUM_LENGTH_MOVE);                // STAT_MINIMUM_LENGTH_MOVE needed to end cycle
+stat_t mp_merge_aline(GCodeState_t* _gm)
+{
+    if (fp_ZERO(cm->merge_tolerance) || (cm->hold_state != FEEDHOLD_OFF) ||
+        kn_is_tool_center_point() ||                    // joint limits are per block - see _aline()
+        mp->sync_out.set || mp->sync_out.clear) {       // pending outputs belong to a block of their own
+        return (STAT_NOOP);
+    }
+    mpBuf_t* bf = mp_get_w()->pv;                       // newest block in the queue
+    if (!_block_is_rewritable(bf) || !_merge_gm_matches(&bf->gm, _gm)) {
+        return (STAT_NOOP);
     }
 
-    // get a cleared buffer and copy in the Gcode model state
-    mpBuf_t* bf = mp_get_write_buffer(); 
-    
-    if (bf == NULL) {                                   // never supposed to fail
-        return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "aline()"));
+    float target_rotated[] = INIT_AXES_ZEROES;
+    float start[]          = INIT_AXES_ZEROES;
+    float axis_length[]    = INIT_AXES_ZEROES;
+    float axis_square[]    = INIT_AXES_ZEROES;
+    float length_square    = 0;
+    float projection       = 0;
+
+    _rotate_target(_gm, target_rotated);
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        start[axis] = bf->gm.target[axis] - (bf->unit[axis] * bf->length);
+        axis_length[axis] = target_rotated[axis] - start[axis];
+        length_square += square(axis_length[axis]);
+    }
+    float length = sqrt(length_square);
+    if (length < 0.0001) {                              // doubled back on itself - let mp_aline() sort it out
+        return (STAT_NOOP);
     }
-    memcpy(&bf->gm, _gm, sizeof(GCodeState_t));
-    copy_vector(bf->gm.target, target_rotated);         // copy the rotated target in place
 
-    // setup the buffer
-    bf->bf_func = mp_exec_aline;                        // register the callback to the exec function
-    bf->length = length;                                // record the length
-    for (uint8_t axis = 0; axis < AXES; axis++) {       // compute the unit vector and set flags
-        if ((bf->axis_flags[axis] = flags[axis])) {     // yes, this is supposed to be = and not ==
-            bf->unit[axis] = axis_length[axis] / length;// nb: bf-> unit was cleared by mp_get_write_buffer()
+    // distance of the old endpoint (mp->position) from the merged line
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        projection += (mp->position[axis] - start[axis]) * axis_length[axis];
+    }
+    projection /= length;
+    if ((projection <= 0) || (projection >= length)) {  // old endpoint must lie between start and end
+        return (STAT_NOOP);
+    }
+    float deviation_sq = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        deviation_sq += square((mp->position[axis] - start[axis]) - (axis_length[axis] * projection / length));
+    }
+    float deviation = bf->merge_deviation + sqrt(deviation_sq);
+    if (deviation > cm->merge_tolerance) {
+        return (STAT_NOOP);
+    }
+
+    // rewrite the block as a single line from the original start to the new target
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if ((bf->axis_flags[axis] = fp_NOT_ZERO(axis_length[axis]))) {
+            axis_square[axis] = square(axis_length[axis]);
+            bf->unit[axis] = axis_length[axis] / length;
+        } else {
+            axis_length[axis] = 0;
+            bf->unit[axis] = 0;
         }
     }
-    _calculate_jerk(bf);                                // compute bf->jerk values
-    _calculate_vmaxes(bf, axis_length, axis_square);    // compute cruise_vmax and absolute_vmax
-    _set_bf_diagnostics(bf);                            // DIAGNOSTIC
+    copy_vector(bf->gm.target, target_rotated);
+    bf->merged_linenum = _gm->linenum;
+    bf->length = length;
+    bf->merge_deviation = deviation;
+    _calculate_chord_deviation(bf, start);
+    _calculate_jerk(bf);
+    _calculate_vmaxes(bf, axis_length, axis_square);
+    _set_bf_diagnostics(bf);
+    _reprime_block(bf);
 
-    // Note: these next lines must remain in exact order. Position must update before committing the buffer.
     copy_vector(mp->position, bf->gm.target);           // update the planner position for the next move
-    mp_commit_write_buffer(BLOCK_TYPE_ALINE);           // commit current block (must follow the position update)
+    mp_block_arrived();
+    return (STAT_OK);
+}
+
+/*
+ * _block_is_rewritable() - true if the newest block is a line that may still be changed in place
+ *
+ *  Neither the block nor the one before it may have been forward planned. This keeps the
+ *  runtime (which forward plans one block ahead of the running block) at least one whole
+ *  block away from the buffer being rewritten.
+ */
+
+static bool _block_is_rewritable(const mpBuf_t* bf)
+{
+    return ((bf->buffer_state >= MP_BUFFER_INITIALIZING) &&
+            (bf->buffer_state <= MP_BUFFER_BACK_PLANNED) &&
+            (bf->block_type == BLOCK_TYPE_ALINE) && !bf->arc_block && !bf->spline_block && !bf->raster_block &&
+            (bf->pv->buffer_state < MP_BUFFER_FULLY_PLANNED));
+}
+
+/*
+ * _take_sync_output() - give a new motion block the M62/M63 outputs waiting for it
+ *
+ *  The distance is capped at the block length so an output past the end of the move
+ *  still switches, on its last segment.
+ */
+
+static void _take_sync_output(mpBuf_t* bf)
+{
+    if (mp->sync_out.set || mp->sync_out.clear) {
+        bf->sync_out = mp->sync_out;
+        bf->sync_out.distance = min(bf->sync_out.distance, bf->length);
+        mp->sync_out = {};
+    }
+}
+
+/*
+ * _reprime_block() - send a rewritten block back through priming
+ *
+ *  The junction with the previous block and the vmaxes must pick up the new geometry.
+ *  If the block was already primed the planner pointer is backed up to it.
+ */
+
+static void _reprime_block(mpBuf_t* bf)
+{
+    bf->cruise_velocity = 0;
+    bf->exit_velocity = 0;
+    bf->hint = NO_HINT;
+    bf->plannable = true;
+    bf->converged = false;
+    if (bf->buffer_state > MP_BUFFER_INITIALIZING) {
+        bf->buffer_state = MP_BUFFER_INITIALIZING;
+        mp->p = bf;
+    }
+    mp->request_planning = true;
+}
+
+/****************************************************************************************
+ * mp_blend_corner() - replace the corner ahead of a G64 P move with a blend inside the tolerance
+ *
+ *  Returns STAT_OK whether or not the corner was blended. The caller always follows with
+ *  mp_aline(), which queues the rest of the move from wherever the planner position ends up.
+ *  Any other status is an error from queuing the blend.
+ *
+ *  The newest block is shortened by d and the corner is replaced by a quadratic Bezier from
+ *  T1 = P - u1*d to T2 = P + u2*d, with the programmed corner P as its control point. The curve
+ *  passes 0.5 * d * sin(phi/2) from the corner, where phi is the deflection angle, so
+ *  d = 2 * tolerance / sin(phi/2). The tangents at both ends match the two lines. d is capped
+ *  at half of each line so that the neighbouring corners can also be blended.
+ *
+ *  The curve is queued as BLEND_SEGMENTS_MAX or fewer short lines that pass through the curve
+ *  midpoint. Each of the small junctions goes through _calculate_junction_vmax() like any other,
+ *  so the jerk limits (scaled by JERK_MULTIPLIER) still apply. What changes is that the corner
+ *  velocity is now limited by many small deflections instead of one large one. Corners are
+ *  blended only under PATH_CONTINUOUS.
+ */
+
+stat_t mp_blend_corner(GCodeState_t* _gm)
+{
+    if ((_gm->path_control != PATH_CONTINUOUS) || fp_ZERO(_gm->path_tolerance) ||
+        (_gm->motion_mode != MOTION_MODE_STRAIGHT_FEED) || (cm->hold_state != FEEDHOLD_OFF) ||
+        kn_is_tool_center_point() ||                    // ...as above
+        mp->sync_out.set || mp->sync_out.clear) {       // the blend would take the move's outputs
+        return (STAT_OK);
+    }
+    mpBuf_t* bf = mp_get_w()->pv;                       // newest block in the queue
+    if (!_block_is_rewritable(bf) || (bf->gm.motion_mode != MOTION_MODE_STRAIGHT_FEED) ||
+        (bf->gm.path_control == PATH_EXACT_STOP) ||
+        (mp_get_planner_buffers(mp) < (BLEND_SEGMENTS_MAX + PLANNER_BUFFER_HEADROOM))) {
+        return (STAT_OK);
+    }
+
+    float target_rotated[] = INIT_AXES_ZEROES;
+    float u2[]             = INIT_AXES_ZEROES;
+    float length_square    = 0;
+    float cos_phi          = 0;
+
+    _rotate_target(_gm, target_rotated);
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        u2[axis] = target_rotated[axis] - mp->position[axis];
+        length_square += square(u2[axis]);
+    }
+    float length = sqrt(length_square);
+    if (length < 0.0001) {
+        return (STAT_OK);
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        u2[axis] /= length;
+        cos_phi += bf->unit[axis] * u2[axis];
+    }
+    if (cos_phi > BLEND_COS_MIN) {                      // close enough to straight - the junction takes it
+        return (STAT_OK);
+    }
+
+    float sin_half_phi = sqrt((1 - cos_phi) / 2);
+    float d = min3((2 * _gm->path_tolerance / sin_half_phi), (bf->length / 2), (length / 2));
+    if (d < BLEND_LENGTH_MIN) {
+        return (STAT_OK);
+    }
+
+    // shorten the newest block so it ends at the start of the blend (T1)
+    float corner[]      = INIT_AXES_ZEROES;
+    float axis_length[] = INIT_AXES_ZEROES;
+    float axis_square[] = INIT_AXES_ZEROES;
+
+    copy_vector(corner, mp->position);
+    bf->length -= d;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        bf->gm.target[axis] = corner[axis] - bf->unit[axis] * d;
+        axis_length[axis] = bf->unit[axis] * bf->length;
+        axis_square[axis] = square(axis_length[axis]);
+    }
+    _calculate_vmaxes(bf, axis_length, axis_square);
+    _set_bf_diagnostics(bf);
+    _reprime_block(bf);
+    copy_vector(mp->position, bf->gm.target);
+
+    // queue the blend as chords of the Bezier. The deflection sets the chord count (kept even).
+    uint8_t segments = (uint8_t)ceil(acos(cos_phi) / BLEND_SEGMENT_ANGLE);
+    segments += (segments & 1);
+    if (segments < 2) { segments = 2; }
+    if (segments > BLEND_SEGMENTS_MAX) { segments = BLEND_SEGMENTS_MAX; }
+
+    float point[] = INIT_AXES_ZEROES;
+    for (uint8_t i = 1; i <= segments; i++) {
+        float t = (float)i / segments;
+        for (uint8_t axis = 0; axis < AXES; axis++) {
+            float t1 = corner[axis] - bf->unit[axis] * d;
+            float t2 = corner[axis] + u2[axis] * d;
+            point[axis] = (square(1-t) * t1) + (2 * t * (1-t) * corner[axis]) + (square(t) * t2);
+        }
+        stat_t status = _aline(_gm, point);
+        if ((status != STAT_OK) && (status != STAT_MINIMUM_LENGTH_MOVE)) {  // a too-short chord folds into the next
+            return (status);
+        }
+    }
     return (STAT_OK);
 }
 
@@ -291,6 +1026,7 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
     if (mp->planner_state == PLANNER_PRIMING) {
         // Timings from *here*
 
+        _calculate_override(bf);                        // adjust cruise_vmax for feed/traverse override
         if (bf->pv->plannable) {
             _calculate_junction_vmax(bf->pv);  // compute maximum junction velocity constraint
             if (bf->pv->gm.path_control == PATH_EXACT_STOP) {
@@ -299,7 +1035,7 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
                 bf->pv->exit_vmax = min3(bf->pv->junction_vmax, bf->pv->cruise_vmax, bf->cruise_vmax);
             }
         }
-        _calculate_override(bf);                        // adjust cruise_vmax for feed/traverse override
+        bf->converged = false;                          // constraints may have changed - must be back planned again
  //     bf->plannable_time = bf->pv->plannable_time;    // set plannable time - excluding current move
         bf->buffer_state = MP_BUFFER_NOT_PLANNED;
         bf->hint = NO_HINT;                             // ensure we've cleared the hints
@@ -329,11 +1065,20 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
             // Timings from *here*
 
             INC_PLANNER_ITERATIONS    // DIAGNOSTIC
+            BM_BACKPLAN_ITERATION();
             bf->plannable = bf->plannable && !optimal;  // Don't accidentally enable plannable!
 
             // Let's be mindful that forward planning may change exit_vmax, and our exit velocity may be lowered
             braking_velocity = min(braking_velocity, bf->exit_vmax);
 
+            // Incremental back-planning: if this block was settled by a previous pass and its exit
+            // velocity comes out the same as last time, then nothing behind it can change either.
+            // The braking velocity handed to bf->pv depends only on this block's exit velocity and
+            // constants (length, jerk, vmaxes) that were already in effect on the previous pass.
+            if (bf->converged && VELOCITY_EQ(braking_velocity, bf->exit_velocity)) {
+                break;
+            }
+
             // We *must* set cruise before exit, and keep it at least as high as exit.
             bf->cruise_velocity = max(braking_velocity, bf->cruise_velocity);
             bf->exit_velocity   = braking_velocity;
@@ -435,7 +1180,9 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
             if (bf->buffer_state < MP_BUFFER_BACK_PLANNED) {
                 bf->buffer_state = MP_BUFFER_BACK_PLANNED;
             }
+            bf->converged = true;           // exit velocity is now known for this set of constraints
         }  // for loop
+        BM_BACKPLAN_END();
     }      // exits with bf pointing to a locked or EMPTY block
 
     mp->planner_state = PLANNER_PRIMING;  // revert to initial state
@@ -443,7 +1190,7 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
 }
 
 /***** ALINE HELPERS *****
- * _calculate_override() - calculate cruise_vmax given cruise_vset and feed rate factor
+ * _calculate_override() - calculate cruise_vmax given cruise_vset and the feed or traverse override
  * _calculate_jerk()
  * _calculate_vmaxes()
  * _calculate_junction_vmax()
@@ -452,92 +1199,113 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
 
 static void _calculate_override(mpBuf_t* bf)  // execute ramp to adjust cruise velocity
 {
-    // TODO: Account for rapid overrides as well as feed overrides
+    if (bf->block_type != BLOCK_TYPE_ALINE) {
+        return;                                             // commands don't move
+    }
+    // traverses take the traverse override, everything else the feed override
+    mpOverrideRamp_t *o = (bf->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) ? &mp->mto : &mp->mfo;
 
-    // pull in override factor from previous block or seed initial value from the system setting
-    bf->override_factor = fp_ZERO(bf->pv->override_factor) ? cm->gmx.mfo_factor : bf->pv->override_factor;
-    bf->cruise_vmax     = bf->override_factor * bf->cruise_vset;
+    bf->override_factor = o->factor;
+    bf->cruise_vmax = min(bf->override_factor * bf->cruise_vset, bf->absolute_vmax);
+    bf->cruise_velocity = 0;                                // (re)planned from scratch by back-planning
 
-    // generate ramp term is a ramp is active
-    if (mp->ramp_active) {
-        bf->override_factor += mp->ramp_dvdt * bf->block_time;
-        if (mp->ramp_dvdt > 0) {                            // positive is an acceleration ramp
-            if (bf->override_factor > mp->ramp_target) {
-                bf->override_factor = mp->ramp_target;
-                mp->ramp_active = false;                    // detect end of ramp
-            }
-            bf->cruise_velocity *= bf->override_factor;
-            if (bf->cruise_velocity > bf->absolute_vmax) {  // test max cruise_velocity
-                bf->cruise_velocity = bf->absolute_vmax;
-                mp->ramp_active = false;                    // don't allow exceeding absolute_vmax
-            }
-        } else {  // negative is deceleration ramp
-            if (bf->override_factor < mp->ramp_target) {
-                bf->override_factor = mp->ramp_target;
-                mp->ramp_active      = false;
-            }
-            bf->cruise_velocity *= bf->override_factor;     // +++++ this is probably wrong
-            //  bf->exit_velocity *= bf->mfo_factor;        //...but I'm not sure this is right,
-            //  bf->cruise_velocity = bf->pv->exit_velocity;//...either
+    // hold a ramp to cruise_vmax within the axis acceleration limits - see _calculate_jerk()
+    if (bf->accel > 0) {
+        _set_jerk(bf, min(bf->axis_jerk, ACCEL_JERK_FACTOR * square(bf->accel) / bf->cruise_vmax));
+    }
+
+    // step the ramp along by this block's time so the next block of this kind takes the next factor
+    if (o->active) {
+        o->factor += o->dvdt * bf->block_time;
+        if (((o->dvdt > 0) && (o->factor >= o->target)) ||  // positive is an acceleration ramp
+            ((o->dvdt < 0) && (o->factor <= o->target))) {  // negative is a deceleration ramp
+            o->factor = o->target;
+            o->active = false;                              // detect end of ramp
         }
-    } else {
-        bf->cruise_velocity *= bf->override_factor;  // apply original or changed factor
-    }
-    // Correction for velocity constraints
-    // In the case of a acceleration these conditions must hold:
-    //      Ve < Vc = Vx
-    // In the case of a deceleration:
-    //      Ve = Vc > Vx
-    // in the case of "lump":
-    //      Ve < Vc > Vx
-    // if (bf->cruise_velocity < bf->pv->exit_velocity) { // deceleration case
-    //     bf->cruise_velocity = bf->pv->exit_velocity;
-    // } else {                                        // acceleration case
-    //     ...
-    // }
+    }
+}
+
+/*
+ * Jerk term cache - a small direct-mapped cache of the terms derived from a block's jerk.
+ * Most jobs only produce a few distinct jerk values: single-axis moves, repeated directions,
+ * and runs of merged or blended segments. Those blocks skip the sqrt and the divides.
+ */
+#define JERK_CACHE_SIZE 8                  // must be a power of 2
+
+typedef struct jerkCache {
+    float jerk;                            // key - JERK_MULTIPLIER scaled jerk, 0 = empty
+    float jerk_sq;
+    float recip_jerk;
+    float sqrt_j;
+    float q_recip_2_sqrt_j;
+} jerkCache_t;
+
+static jerkCache_t _jerk_cache[JERK_CACHE_SIZE];
+
+static inline uint8_t _jerk_cache_index(const float jerk)
+{
+    uint32_t bits;
+    memcpy(&bits, &jerk, sizeof(bits));    // hash the float's bit pattern
+    return ((bits ^ (bits >> 11) ^ (bits >> 19)) & (JERK_CACHE_SIZE - 1));
 }
 
 /****************************************************************************************
  * _calculate_jerk() - calculate jerk given the dynamic state
+ * _set_jerk()       - set the block's jerk and the terms derived from it
  *
- *  Set the jerk scaling to the lowest axis with a non-zero unit vector.
- *  Go through the axes one by one and compute the scaled jerk, then pick
- *  the highest jerk that does not violate any of the axes in the move.
+ *  Each axis in the move limits the linear jerk to its own jerk divided by its share of the
+ *  unit vector. The block takes the lowest of these - the highest jerk that does not violate
+ *  any of the axes in the move - so each move runs at the real limit of its slowest axis.
+ *  The axis reciprocals are cached by the settings, so this is a multiply per axis and a
+ *  single divide:
  *
- * Cost about ~65 uSec
+ *      Jm = 1 / max(|unit[axis]| / jerk[axis])
+ *
+ *  Axes with an acceleration max ({xac:}) limit the linear acceleration the same way. The
+ *  quintic S-curve reaches its peak acceleration of (15/8)(Vt - Vi)/T in the middle of a
+ *  ramp, so the jerk that keeps a ramp from rest to cruise_vmax under the acceleration limit
+ *  is (q * 8/15)^2 * Am^2 / cruise_vmax. That cap is applied by _calculate_override() once
+ *  cruise_vmax is known. Smaller velocity changes come in under the limit.
  */
 
 static void _calculate_jerk(mpBuf_t* bf) 
 {
-    // compute the jerk as the largest jerk that still meets axis constraints
-    bf->jerk   = 8675309;  // a ridiculously large number
-    float jerk = 0;
+    float recip_jerk  = 0;      // largest |unit| / axis jerk of the axes in the move
+    float recip_accel = 0;      // largest |unit| / axis acceleration of the axes with a limit
 
     for (uint8_t axis = 0; axis < AXES; axis++) {
-        if (fabs(bf->unit[axis]) > 0) {  // if this axis is participating in the move
-            float axis_jerk = 0;
+        const float unit = fabs(bf->unit[axis]);
+        if (unit > 0) {         // if this axis is participating in the move
 #ifdef TRAVERSE_AT_HIGH_JERK
 #warning using experimental feature TRAVERSE_AT_HIGH_JERK!
-            switch (bf->gm.motion_mode) {
-                case MOTION_MODE_STRAIGHT_TRAVERSE:
-                //case MOTION_MODE_STRAIGHT_PROBE: // <-- not sure on this one
-                    axis_jerk = cm->a[axis].jerk_high;
-                    break;
-                default:
-                    axis_jerk = cm->a[axis].jerk_max;
-            }
+            const float axis_recip_jerk = (bf->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) ?
+                                          cm->a[axis].recip_jerk_high : cm->a[axis].recip_jerk_max;
 #else
-            axis_jerk = cm->a[axis].jerk_max;
+            const float axis_recip_jerk = cm->a[axis].recip_jerk_max;
 #endif
-
-            jerk = axis_jerk / fabs(bf->unit[axis]);
-            if (jerk < bf->jerk) {
-                bf->jerk = jerk;
-                //              bf->jerk_axis = axis;           // +++ diagnostic
-            }
+            recip_jerk  = max(recip_jerk, unit * axis_recip_jerk);
+            recip_accel = max(recip_accel, unit * cm->a[axis].recip_accel_max);
         }
     }
-    bf->jerk *= JERK_MULTIPLIER;           // goose it!
+    bf->axis_jerk = JERK_MULTIPLIER / recip_jerk;   // goose it!
+    bf->accel = (recip_accel > 0) ? ACCEL_MULTIPLIER / recip_accel : 0;
+    _set_jerk(bf, bf->axis_jerk);
+}
+
+static void _set_jerk(mpBuf_t* bf, const float jerk)
+{
+    bf->jerk = jerk;
+
+    // Reuse the derived terms if a recent block had the same jerk. They depend only on the jerk
+    // value, so the cache never needs to be invalidated when axis jerk settings change.
+    jerkCache_t *jc_entry = &_jerk_cache[_jerk_cache_index(bf->jerk)];
+    if (jc_entry->jerk == bf->jerk) {
+        bf->jerk_sq          = jc_entry->jerk_sq;
+        bf->recip_jerk       = jc_entry->recip_jerk;
+        bf->sqrt_j           = jc_entry->sqrt_j;
+        bf->q_recip_2_sqrt_j = jc_entry->q_recip_2_sqrt_j;
+        return;
+    }
     bf->jerk_sq    = bf->jerk * bf->jerk;  // pre-compute terms used multiple times during planning
     bf->recip_jerk = 1 / bf->jerk;
 
@@ -545,6 +1313,12 @@ static void _calculate_jerk(mpBuf_t* bf)
     const float sqrt_j   = sqrt(bf->jerk);
     bf->sqrt_j           = sqrt_j;
     bf->q_recip_2_sqrt_j = q / (2 * sqrt_j);
+
+    jc_entry->jerk             = bf->jerk;
+    jc_entry->jerk_sq          = bf->jerk_sq;
+    jc_entry->recip_jerk       = bf->recip_jerk;
+    jc_entry->sqrt_j           = bf->sqrt_j;
+    jc_entry->q_recip_2_sqrt_j = bf->q_recip_2_sqrt_j;
 }
 
 /****************************************************************************************
@@ -639,7 +1413,15 @@ static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const floa
             bf->gm.feed_rate_mode = UNITS_PER_MINUTE_MODE;
         } else {
             // compute length of linear move in millimeters. Feed rate is provided as mm/min
-            feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_Z]) / bf->gm.feed_rate;
+            float feed_square = axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_Z];
+            // {rfm:1} adds the arc the tool tip sweeps at each rotary's radius {xra}, so F is
+            // the tool tip's rate and the CAM need not convert rotary moves to G93
+            if (cm->rotary_feed_mode == ROTARY_FEED_TOOL_TIP) {
+                feed_square += axis_square[AXIS_A] * square(cm->a[AXIS_A].radius / RADIAN) +
+                               axis_square[AXIS_B] * square(cm->a[AXIS_B].radius / RADIAN) +
+                               axis_square[AXIS_C] * square(cm->a[AXIS_C].radius / RADIAN);
+            }
+            feed_time = sqrt(feed_square) / bf->gm.feed_rate;
             // if no linear axes, compute length of multi-axis rotary move in degrees. 
             // Feed rate is provided as degrees/min
             if (fp_ZERO(feed_time)) {
@@ -651,9 +1433,9 @@ static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const floa
     for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
         if (bf->axis_flags[axis]) {
             if (bf->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) {
-                tmp_time = fabs(axis_length[axis]) / cm->a[axis].velocity_max;
+                tmp_time = fabs(axis_length[axis]) * cm->a[axis].recip_velocity_max;
             } else {// gm.motion_mode == MOTION_MODE_STRAIGHT_FEED
-                tmp_time = fabs(axis_length[axis]) / cm->a[axis].feedrate_max;
+                tmp_time = fabs(axis_length[axis]) * cm->a[axis].recip_feedrate_max;
             }
             max_time = max(max_time, tmp_time);
 
@@ -670,6 +1452,102 @@ static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const floa
     bf->block_time    = block_time;               // initial estimate - used for ramp computations
 }
 
+/*
+ * _throttle_to_link() - hold a move to at least the time the host link takes to send a line
+ *
+ *  A run of moves that each take less time than the link needs to deliver the next line
+ *  drains the planner until it starves, and then every move starts and stops. Instead each
+ *  move of a machining cycle is given at least LINK_THROTTLE_MARGIN times the measured line
+ *  time (controller_line_ms()), so the short moves slow down only as far as the link makes
+ *  them and the queue holds. Long moves and fast links are unaffected. Homing, probing and
+ *  jogging don't wait on the link, and the measured time is 0 when it isn't being measured.
+ */
+
+static void _throttle_to_link(mpBuf_t* bf)
+{
+    if (cm->cycle_type != CYCLE_MACHINING) {
+        return;
+    }
+    float line_time = controller_line_ms() * LINK_THROTTLE_MARGIN / 60000; // minutes, as block_time
+    if (line_time <= bf->block_time) {
+        return;
+    }
+    float link_vmax = bf->length / line_time;
+    bf->cruise_vset = min(bf->cruise_vset, link_vmax);
+    bf->cruise_vmax = min(bf->cruise_vmax, link_vmax);
+    bf->absolute_vmax = min(bf->absolute_vmax, link_vmax);
+    bf->block_time = line_time;
+}
+
+/****************************************************************************************
+ * _calculate_joint_limits() - hold a 5-axis tool center point block to the joint limits
+ *
+ *  The unit vector is the tool tip's, but the linear joints of {kin:4} and {kin:5} travel
+ *  further than the tip whenever the rotaries swing the part. The joint travel of the block
+ *  (kn_joint_travel()) is taken through the same cached per-axis terms as the unit vector
+ *  in _calculate_jerk() and _calculate_vmaxes() - recip_jerk_max, recip_accel_max and the
+ *  recip velocity or feed rate max - and the block's jerk, acceleration and cruise are
+ *  lowered to whatever the joints can do. The limits only ever tighten.
+ */
+
+static void _calculate_joint_limits(mpBuf_t* bf, const float start[])
+{
+    float joint_length[AXES];
+    kn_joint_travel(start, bf->gm.target, joint_length);
+
+    float recip_jerk  = 0;
+    float recip_accel = 0;
+    float max_time    = 0;      // time the slowest joint needs at the block's rate limit
+    float abs_time    = 0;      // ...and at its velocity limit, which caps any override
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (joint_length[axis] > EPSILON) {
+            const float unit = joint_length[axis] / bf->length;
+            recip_jerk  = max(recip_jerk, unit * cm->a[axis].recip_jerk_max);
+            recip_accel = max(recip_accel, unit * cm->a[axis].recip_accel_max);
+            max_time    = max(max_time, joint_length[axis] * ((bf->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) ?
+                                        cm->a[axis].recip_velocity_max : cm->a[axis].recip_feedrate_max));
+            abs_time    = max(abs_time, joint_length[axis] * cm->a[axis].recip_velocity_max);
+        }
+    }
+    if (recip_jerk > 0) {
+        const float jerk = JERK_MULTIPLIER / recip_jerk;
+        if (jerk < bf->axis_jerk) {
+            bf->axis_jerk = jerk;
+            _set_jerk(bf, jerk);
+        }
+    }
+    if (recip_accel > 0) {
+        const float accel = ACCEL_MULTIPLIER / recip_accel;
+        if ((bf->accel == 0) || (accel < bf->accel)) {
+            bf->accel = accel;
+        }
+    }
+    if (max_time > bf->block_time) {
+        bf->block_time  = max_time;
+        bf->cruise_vset = bf->length / max_time;
+        bf->cruise_vmax = bf->cruise_vset;
+    }
+    if (abs_time > 0) {
+        bf->absolute_vmax = min(bf->absolute_vmax, bf->length / abs_time);
+    }
+}
+
+/****************************************************************************************
+ * _calculate_chord_deviation() - joint space chord deviation of a line, over {ktol:}
+ *
+ *  Taken when the line is queued so the exec only has to scale it to the cruise velocity
+ *  (see _block_segment_time() in plan_exec.cpp), and so a {ktol:} change applies from the
+ *  next line queued. 0 if {ktol:} is 0 - the line runs at the nominal segment time.
+ */
+
+static void _calculate_chord_deviation(mpBuf_t* bf, const float start[])
+{
+    bf->chord_deviation = 0;
+    if (kn.segment_tolerance > 0) {
+        bf->chord_deviation = kn_chord_deviation(start, bf->gm.target) / kn.segment_tolerance;
+    }
+}
+
 /****************************************************************************************
  * _calculate_junction_vmax() - Giseburt's Algorithm ;-)
  *
@@ -727,9 +1605,20 @@ static void _calculate_junction_vmax(mpBuf_t* bf)
 
     // cmAxes jerk_axis = AXIS_X;   // a diagnostic in case you want to find the limiting axis
 
+    // an arc or spline leaves in the direction of its tangent at the end, not the one it started with
+    float arc_exit[] = INIT_AXES_ZEROES;
+    const float* unit = bf->unit;
+    if (bf->arc_block) {
+        mp_arc_tangent(&bf->arc, bf->length, arc_exit);
+        unit = arc_exit;
+    } else if (bf->spline_block) {
+        mp_spline_tangent(&bf->spline, bf->length, arc_exit);
+        unit = arc_exit;
+    }
+
     for (uint8_t axis = 0; axis < AXES; axis++) {
         if (bf->axis_flags[axis] || bf->nx->axis_flags[axis]) {       // skip axes with no movement
-            float delta = fabs(bf->unit[axis] - bf->nx->unit[axis]);  // formula (1)
+            float delta = fabs(unit[axis] - bf->nx->unit[axis]);      // formula (1)
 
             // Corner case: If an axis has zero delta, we might have a straight line.
             // Corner case: An axis doesn't change (and it's not a straight line).
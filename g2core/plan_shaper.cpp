@@ -0,0 +1,238 @@
+/*
+ * plan_shaper.cpp - input shaping of the segment stream
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * INPUT SHAPING
+ *
+ *  A light gantry rings at its resonant frequency every time the acceleration changes.
+ *  The shaper cancels the ringing by convolving each axis' commanded position with a short
+ *  train of impulses. The first impulse excites the resonance and the later ones arrive
+ *  half a damped period apart, in antiphase, so the oscillations they start cancel out:
+ *
+ *    ZV   2 impulses over half a period - the shortest delay, but exact at one frequency
+ *    ZVD  3 impulses over a full period - tolerates about 20% error in the frequency
+ *    EI   3 impulses over a full period - allows 5% vibration to tolerate a wider error
+ *
+ *  Shaping is done on the X, Y and Z segment targets in Cartesian space, ahead of the
+ *  kinematics. Each segment target goes into a short history and the shaped target is the
+ *  sum of that history sampled at the impulse delays. Only the steps are shaped - the
+ *  runtime position (mr->position) is not, so the motors trail the reported position by
+ *  up to one shaper period ({xsf:} 30 Hz is 33 ms with ZVD or EI).
+ *
+ *  So a move that ends at rest isn't finished when its last segment is. mp_exec_aline()
+ *  plays the shaper out with settling segments (mp_shaper_settle()) before it lets go of
+ *  a block that ends at rest - an exact stop, a feedhold or the end of the job - so the
+ *  machine is really where the runtime says it is before anything that depends on it runs.
+ *
+ *  {shp:} selects the impulse train. {xsf:} sets the axis' frequency (0 to not shape it)
+ *  and {xsz:} its damping ratio. Changes are taken up the next time the shaper starts from
+ *  rest; a change while shaping would move the axis.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "planner.h"
+#include "util.h"
+
+#define SHAPER_IMPULSES 3               // most impulses in a train
+#define SHAPER_HISTORY 80               // segment targets kept - the longest delay (SHAPER_FREQUENCY_MIN) at MIN_SEGMENT_MS
+#define SHAPER_EI_VIBRATION 0.05        // vibration the EI shaper allows at the set frequency
+
+typedef struct mpShaperAxis {
+    uint8_t impulses;                   // 0 if the axis is not shaped
+    float amplitude[SHAPER_IMPULSES];   // sums to 1
+    float delay[SHAPER_IMPULSES];       // in minutes, ascending from 0
+} mpShaperAxis_t;
+
+typedef struct mpShaper {
+    mpShaperAxis_t cfg[SHAPER_AXES];    // as configured
+    mpShaperAxis_t run[SHAPER_AXES];    // in use - taken from cfg when the shaper starts from rest
+    bool enabled;                       // some axis is configured for shaping
+    bool active;                        // from the first shaped segment until the shaper has settled
+    float delay_max;                    // longest delay in run[]
+    float settle_time;                  // time left before the oldest impulse reaches the last target
+
+    uint8_t newest;                     // history ring - index of the newest target
+    uint8_t count;                      // targets in the history
+    float dt[SHAPER_HISTORY];           // time from the previous target to this one, in minutes
+    float target[SHAPER_HISTORY][SHAPER_AXES];
+    float shaped[AXES];                 // shaped target handed back to the exec
+} mpShaper_t;
+
+static mpShaper_t sh;
+
+/*
+ * mp_shaper_configure() - compute the impulse train for an axis
+ *
+ *  frequency is in Hz and damping is the damping ratio (zeta). Frequencies below
+ *  SHAPER_FREQUENCY_MIN turn shaping off for the axis.
+ */
+
+void mp_shaper_configure(const uint8_t axis, const uint8_t type, const float frequency, const float damping)
+{
+    if (axis >= SHAPER_AXES) {
+        return;
+    }
+    mpShaperAxis_t *s = &sh.cfg[axis];
+    s->impulses = 0;
+    if (frequency >= SHAPER_FREQUENCY_MIN) {
+        float df = sqrt(1 - damping * damping);
+        float K = exp(-damping * M_PI / df);
+        float t_d = 1 / (frequency * df) / 60;                  // damped period in minutes
+        float sum;
+
+        s->delay[0] = 0;
+        s->delay[1] = t_d / 2;
+        s->delay[2] = t_d;
+        if (type == SHAPER_TYPE_ZV) {
+            s->impulses = 2;
+            s->amplitude[0] = 1;
+            s->amplitude[1] = K;
+        } else if (type == SHAPER_TYPE_ZVD) {
+            s->impulses = 3;
+            s->amplitude[0] = 1;
+            s->amplitude[1] = 2 * K;
+            s->amplitude[2] = K * K;
+        } else {                                                // SHAPER_TYPE_EI
+            s->impulses = 3;
+            s->amplitude[0] = 0.25 * (1 + SHAPER_EI_VIBRATION);
+            s->amplitude[1] = 0.5 * (1 - SHAPER_EI_VIBRATION) * K;
+            s->amplitude[2] = s->amplitude[0] * K * K;
+        }
+        sum = 0;
+        for (uint8_t i=0; i<s->impulses; i++) { sum += s->amplitude[i]; }
+        for (uint8_t i=0; i<s->impulses; i++) { s->amplitude[i] /= sum; }
+    }
+    sh.enabled = false;
+    for (uint8_t a=0; a<SHAPER_AXES; a++) {
+        if (sh.cfg[a].impulses != 0) { sh.enabled = true; }
+    }
+}
+
+/*
+ * mp_shaper_reset()  - forget the history - the steps have been set to the runtime position
+ * mp_shaper_active() - true while the steps trail the runtime position
+ */
+
+void mp_shaper_reset() { sh.active = false; }
+bool mp_shaper_active() { return (sh.active); }
+
+/*
+ * _shaper_push()   - add a segment target to the history
+ * _shaper_sample() - compute the shaped target from the history
+ */
+
+static void _shaper_push(const float target[], const float dt)
+{
+    if (++sh.newest == SHAPER_HISTORY) {
+        sh.newest = 0;
+    }
+    if (sh.count < SHAPER_HISTORY) {
+        sh.count++;
+    }
+    sh.dt[sh.newest] = dt;
+    for (uint8_t a=0; a<SHAPER_AXES; a++) {
+        sh.target[sh.newest][a] = target[a];
+    }
+}
+
+static void _shaper_sample()
+{
+    for (uint8_t a=0; a<SHAPER_AXES; a++) {
+        mpShaperAxis_t *s = &sh.run[a];
+        if (s->impulses == 0) {
+            continue;
+        }
+        uint8_t k = sh.newest;                                  // walk back from the newest target
+        uint8_t left = sh.count;                                // targets at and before k
+        float age = 0;                                          // age of target k
+        float shaped = 0;
+
+        for (uint8_t i=0; i<s->impulses; i++) {
+            while ((left > 1) && ((age + sh.dt[k]) <= s->delay[i])) {
+                age += sh.dt[k];
+                k = (k == 0) ? SHAPER_HISTORY-1 : k-1;
+                left--;
+            }
+            float x = sh.target[k][a];
+            if (left > 1) {                                     // interpolate toward the target before k
+                uint8_t j = (k == 0) ? SHAPER_HISTORY-1 : k-1;
+                x += (sh.target[j][a] - x) * (s->delay[i] - age) / sh.dt[k];
+            }                                                   // ...or hold the oldest one
+            shaped += s->amplitude[i] * x;
+        }
+        sh.shaped[a] = shaped;
+    }
+}
+
+/*
+ * mp_shaper_shape() - shape a segment target
+ *
+ *  position is where the segment starts, target where it ends and dt how long it takes, in
+ *  minutes. Returns the target to step to - target itself if shaping is off.
+ */
+
+const float *mp_shaper_shape(const float position[], const float target[], const float dt)
+{
+    if (!sh.active) {
+        if (!sh.enabled) {
+            return (target);
+        }
+        memcpy(sh.run, sh.cfg, sizeof(sh.run));                 // start from rest at position
+        sh.delay_max = 0;
+        for (uint8_t a=0; a<SHAPER_AXES; a++) {
+            if (sh.run[a].impulses != 0) {
+                sh.delay_max = max(sh.delay_max, sh.run[a].delay[sh.run[a].impulses-1]);
+            }
+        }
+        sh.newest = 0;
+        sh.count = 1;
+        sh.dt[0] = 0;
+        for (uint8_t a=0; a<SHAPER_AXES; a++) {
+            sh.target[0][a] = position[a];
+        }
+        sh.active = true;
+    }
+    copy_vector(sh.shaped, target);
+    _shaper_push(target, dt);
+    _shaper_sample();
+    sh.settle_time = sh.delay_max;
+    return (sh.shaped);
+}
+
+/*
+ * mp_shaper_settle() - shape a segment that holds at target
+ *
+ *  Once the oldest impulse has reached target the shaper is at rest; the steps are exactly
+ *  at target and mp_shaper_active() is false.
+ */
+
+const float *mp_shaper_settle(const float target[], const float dt)
+{
+    if (!sh.active) {
+        return (target);
+    }
+    copy_vector(sh.shaped, target);
+    _shaper_push(target, dt);
+    if ((sh.settle_time -= dt) > 0) {
+        _shaper_sample();
+    } else {
+        sh.active = false;
+    }
+    return (sh.shaped);
+}
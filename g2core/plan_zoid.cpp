@@ -71,6 +71,8 @@ static float _get_meet_velocity(const float          v_0,
                                 const float          L,
                                 mpBuf_t*             bf,
                                 mpBlockRuntimeBuf_t* block);
+static bool _run_start(mpBuf_t* bf, const float entry_velocity);
+static stat_t _run_plan_block(mpBlockRuntimeBuf_t* block, mpBuf_t* bf);
 
 /****************************************************************************************
  * mp_calculate_ramps() - calculate trapezoid-like ramp parameters for a block
@@ -118,7 +120,7 @@ static float _get_meet_velocity(const float          v_0,
 // Hint will be one of these from back-planning: COMMAND_BLOCK, PERFECT_DECELERATION, PERFECT_CRUISE,
 // MIXED_DECELERATION, ASYMMETRIC_BUMP
 // We are incorporating both the forward planning and ramp-planning into one function, since we use the same data.
-stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float entry_velocity) 
+HOT_PATH stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float entry_velocity)
 {
     // *** Skip non-move commands ***
     if (bf->block_type == BLOCK_TYPE_COMMAND) {
@@ -138,6 +140,7 @@ stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float e
     block->head_length = 0;
     block->body_length = 0;
     block->tail_length = 0;
+    block->head_run = false;
 
     // these conditions should have been met earlier, but if they are not trap and correct them
     debug_trap_if_true((bf->exit_velocity > bf->exit_vmax), "mp_calculate_ramps() - Vexit > Vexit_max");
@@ -147,6 +150,16 @@ stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float e
 //    debug_trap_if_true((bf->cruise_velocity, bf->cruise_vmax), "mp_calculate_ramps() - Vcruise > Vcruise_max");
     block->cruise_velocity = min(bf->cruise_velocity, bf->cruise_vmax);
 
+    // *** Acceleration Run (4r) *** This block carries on an acceleration run planned earlier
+    if (mp->run.next != NULL) {
+        if ((mp->run.next == bf) && cm->planner_runs && VELOCITY_EQ(entry_velocity, mp->run.v_entry)) {
+            if (_run_plan_block(block, bf) == STAT_OK) {
+                return (_ramp_exit_logger(bf, "4r"));
+            }
+        }
+        mp->run.next = NULL;                            // ...otherwise the run is over. Plan the block on its own
+    }
+
     // We *might* do this exact computation later, so cache the value
     float test_velocity = 0;
     bool  test_velocity_valid = false;  // record if we have a validly cached value
@@ -230,6 +243,12 @@ stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float e
 
         if (accel_velocity < block->exit_velocity) {  // still accelerating
 
+            // Try to spread the acceleration across this and the following blocks
+            if (cm->planner_runs && _run_start(bf, entry_velocity) && (_run_plan_block(block, bf) == STAT_OK)) {
+                return (_ramp_exit_logger(bf, "4r"));
+            }
+            mp->run.next = NULL;
+
             mp->entry_changed = true;  // we are changing the *next* block's entry velocity
 
             block->exit_velocity   = accel_velocity;
@@ -330,6 +349,154 @@ stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float e
     return (_ramp_exit_logger(bf, "3c"));  // 550us worst case
 }
 
+/****************************************************************************************
+ * Acceleration runs ({plr:1})
+ *
+ * _run_velocity()   - velocity at curve parameter u of the open run
+ * _run_distance()   - distance from the start of the run to u
+ * _run_parameter()  - curve parameter at distance s, searching up from u_0
+ * _run_start()      - open a run starting at bf, if one fits
+ * _run_plan_block() - plan bf as the next slice of the open run
+ *
+ *  Each block's head and tail normally has to fit inside the block, so a path made of short
+ *  blocks accelerates in little steps - each head ends with the block, at zero acceleration,
+ *  and the next one starts over. A run is one S-curve head laid across several blocks:
+ *
+ *    v(u) = v_0 + (v_1 - v_0) S(u),  S(u) = 10u^3 - 15u^4 + 6u^5,  0 <= u <= 1
+ *    d(u) = T [v_0 u + (v_1 - v_0)(2.5u^4 - 3u^5 + u^6)]
+ *
+ *  T and the run length are the same as a single head from v_0 to v_1 (mp_get_target_length())
+ *  using the lowest jerk of the blocks it covers. Each block in the run gets the slice of the
+ *  curve [u_0, u_1] that covers its length as its head, and the block where the run ends
+ *  cruises at v_1 for the rest of its length. Acceleration carries through the junctions, so
+ *  the jerk limit holds across the whole run and not just inside each block.
+ *
+ *  The run ends at v_1 no higher than the lowest cruise or (back-planned) exit velocity of
+ *  the blocks it covers, so every junction it passes can still brake for what is after it.
+ *  It is planned one block at a time like any other block, just ahead of the runtime. If a
+ *  block no longer fits the run when it gets there - back-planning or an override lowered
+ *  its velocities, a hold stopped the run - the run is dropped and planning goes on block
+ *  by block from the entry velocity.
+ *
+ *  Only accelerations are planned as runs. Decelerations are still fit block by block by
+ *  back-planning.
+ */
+
+static float _run_velocity(const float u)
+{
+    return (mp->run.v_0 + (mp->run.v_1 - mp->run.v_0) * (u*u*u * (10.0 + u*(-15.0 + 6.0*u))));
+}
+
+static float _run_distance(const float u)
+{
+    return (mp->run.time * u * (mp->run.v_0 + (mp->run.v_1 - mp->run.v_0) * (u*u*u * (2.5 + u*(-3.0 + u)))));
+}
+
+// d(u) is convex, so Newton from above the root stays above it and closes in on it
+static float _run_parameter(const float u_0, const float s)
+{
+    float v = _run_velocity(u_0);
+    float u = 1.0;
+    if (v > EPSILON) {                                  // the tangent at u_0 meets s past the root
+        u = min(1.0f, u_0 + (s - _run_distance(u_0)) / (mp->run.time * v));
+    }
+    for (uint8_t i=0; i<RUN_ITERATIONS_MAX; i++) {
+        v = _run_velocity(u);
+        if (v < EPSILON) {
+            break;
+        }
+        const float du = (_run_distance(u) - s) / (mp->run.time * v);
+        u -= du;
+        if (fabs(du) < EPSILON) {
+            break;
+        }
+    }
+    return (max(u, u_0));
+}
+
+static bool _run_start(mpBuf_t* bf, const float entry_velocity)
+{
+    mpBuf_t* jbf = bf;                                  // block with the lowest jerk
+    mpBuf_t* b = bf;
+    float v_cap = bf->cruise_vmax;                      // highest velocity the run can end on
+    float length = 0;                                   // length of the blocks before b
+    float v_1 = 0;
+
+    for (uint8_t i=0; i<RUN_BLOCKS_MAX; i++) {
+        v_cap = min4(v_cap, b->cruise_velocity, b->cruise_vmax, b->exit_velocity);
+        if (b->jerk < jbf->jerk) {
+            jbf = b;
+        }
+        if (v_cap <= entry_velocity) {                  // b can't be accelerated into
+            break;
+        }
+        const float run_length = mp_get_target_length(entry_velocity, v_cap, jbf);
+        if (run_length <= length + b->length) {         // the run reaches v_cap by the end of b
+            v_1 = v_cap;
+            length = run_length;
+            break;
+        }
+        length += b->length;
+        b = b->nx;
+        if ((b->block_type != BLOCK_TYPE_ALINE) || (b->buffer_state != MP_BUFFER_BACK_PLANNED)) {
+            break;
+        }
+    }
+    if (length < bf->length + EPSILON4) {               // the run is no longer than one block
+        return (false);
+    }
+    if (v_1 == 0) {                                     // ...or it accelerates across all the blocks it looked at
+        v_1 = mp_get_target_velocity(entry_velocity, length, jbf);
+        if (v_1 <= entry_velocity) {
+            return (false);
+        }
+    }
+    mp->run.next = bf;
+    mp->run.v_0 = entry_velocity;
+    mp->run.v_1 = v_1;
+    mp->run.v_entry = entry_velocity;
+    mp->run.time = 2 * jbf->q_recip_2_sqrt_j * sqrt(v_1 - entry_velocity);
+    mp->run.length = length;
+    mp->run.u = 0;
+    mp->run.s = 0;
+    return (true);
+}
+
+static stat_t _run_plan_block(mpBlockRuntimeBuf_t* block, mpBuf_t* bf)
+{
+    const float s_1 = mp->run.s + bf->length;
+    const bool last = (s_1 >= mp->run.length - EPSILON4);
+    const float u_1 = last ? 1.0 : _run_parameter(mp->run.u, s_1);
+    const float v = last ? mp->run.v_1 : _run_velocity(u_1);
+
+    if (v > min4(bf->cruise_velocity, bf->cruise_vmax, bf->exit_velocity, bf->exit_vmax) + 0.0001) {
+        return (STAT_NOOP);                             // the block no longer fits the run
+    }
+    block->head_run = true;
+    block->head_u0 = mp->run.u;
+    block->head_u1 = u_1;
+    block->head_v0 = mp->run.v_0;
+    block->head_v1 = mp->run.v_1;
+    block->cruise_velocity = v;
+    block->exit_velocity = v;
+
+    block->head_length = last ? min(bf->length, mp->run.length - mp->run.s) : bf->length;
+    block->head_time = mp->run.time * (u_1 - mp->run.u);
+    block->body_length = bf->length - block->head_length;
+    block->body_time = (block->body_length > 0) ? block->body_length / v : 0;
+    block->tail_length = 0;
+    block->tail_time = 0;
+    bf->block_time = block->head_time + block->body_time;
+    bf->hint = last ? MIXED_ACCELERATION : PERFECT_ACCELERATION;
+    mp->entry_changed = true;                           // we are changing the *next* block's entry velocity
+
+    mp->run.next = last ? NULL : bf->nx;
+    mp->run.v_entry = v;
+    mp->run.u = u_1;
+    mp->run.s = s_1;
+    return (STAT_OK);
+}
+
 /**** Planner helpers ****
  *
  * mp_get_target_length()   - find accel/decel length from delta V and jerk
@@ -353,8 +520,8 @@ stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float e
 
 float mp_get_target_length(const float v_0, const float v_1, const mpBuf_t* bf) 
 {
-    const float q_recip_2_sqrt_j = bf->q_recip_2_sqrt_j;
-    return q_recip_2_sqrt_j * sqrt(fabs(v_1 - v_0)) * (v_1 + v_0);
+    const zfloat_t q_recip_2_sqrt_j = bf->q_recip_2_sqrt_j;
+    return q_recip_2_sqrt_j * sqrt(fabs((zfloat_t)v_1 - v_0)) * ((zfloat_t)v_1 + v_0);
 }
 
 /*
@@ -372,29 +539,29 @@ float mp_get_target_velocity(const float v_0, const float L, const mpBuf_t* bf)
         return (0);
     }
 
-    const float j = bf->jerk;
+    const zfloat_t j = bf->jerk;
 
-    const float a80 = 7.698003589195;       // 80 * a
-    const float a_2 = 0.00925925925926;     // a^2
+    const zfloat_t a80 = 7.698003589195;    // 80 * a
+    const zfloat_t a_2 = 0.00925925925926;  // a^2
 
-    const float v_0_2 = v_0 * v_0;          // v_0^2
-    const float v_0_3 = v_0_2 * v_0;        // v_0^3
+    const zfloat_t v_0_2 = (zfloat_t)v_0 * v_0; // v_0^2
+    const zfloat_t v_0_3 = v_0_2 * v_0;     // v_0^3
 
-    const float L_2 = L * L;                // L^2
+    const zfloat_t L_2 = (zfloat_t)L * L;   // L^2
 
-    const float b_part1 = 9 * j * L_2;      // 9 j L^2
-    const float b_part2 = a80 * v_0_3;      // 80 a v_0^3
+    const zfloat_t b_part1 = 9 * j * L_2;   // 9 j L^2
+    const zfloat_t b_part2 = a80 * v_0_3;   // 80 a v_0^3
 
     //              b^3 = a^2 (3 L sqrt(j (2 b_part2  +  b_part1))  +  b_part2  +  b_part1)
-    const float b_cubed = a_2 * (3 * L * sqrt(j * (2 * b_part2 + b_part1)) + b_part2 + b_part1);
-    const float b       = cbrtf(b_cubed);
+    const zfloat_t b_cubed = a_2 * (3 * L * sqrt(j * (2 * b_part2 + b_part1)) + b_part2 + b_part1);
+    const zfloat_t b       = cbrt(b_cubed);
 
-    const float const1a = 0.8292422988276;    // 4 * 10^(1/3) * a
-    const float const2a = 4.823680612597;     // 1/(10^(1/3) * a)
-    const float const3  = 0.333333333333333;  // 1/3
+    const zfloat_t const1a = 0.8292422988276;   // 4 * 10^(1/3) * a
+    const zfloat_t const2a = 4.823680612597;    // 1/(10^(1/3) * a)
+    const zfloat_t const3  = 0.333333333333333; // 1/3
 
     //          v_1 =    1/3 ((const1a v_0^2)/b  +  b const2a  -  v_0)
-    const float v_1 = const3 * ((const1a * v_0_2) / b + b * const2a - v_0);
+    const zfloat_t v_1 = const3 * ((const1a * v_0_2) / b + b * const2a - v_0);
 
     return fabs(v_1);
 }
@@ -421,15 +588,15 @@ float mp_get_target_velocity(const float v_0, const float L, const mpBuf_t* bf)
 
 float mp_get_decel_velocity(const float v_0, const float L, const mpBuf_t* bf) 
 {
-    const float q_recip_2_sqrt_j = bf->q_recip_2_sqrt_j;
-    float v_1 = 0;              // start the guess at zero
+    const zfloat_t q_recip_2_sqrt_j = bf->q_recip_2_sqrt_j;
+    zfloat_t v_1 = 0;           // start the guess at zero
 
-    int i = 0;                  // limit the iterations
-    while (i++ < 20) {          // If it fails after 20 iterations something's wrong
+    int i = 0;                                  // limit the iterations
+    while (i++ < DECEL_ITERATIONS_MAX) {        // If it fails after this many something's wrong
 
         // l_t is the difference in length between the L provided and the current guessed deceleration length
-        const float sqrt_delta_v_0 = sqrt(v_0 - v_1);
-        const float l_t = q_recip_2_sqrt_j * (sqrt_delta_v_0 * (v_1 + v_0)) - L;
+        const zfloat_t sqrt_delta_v_0 = sqrt(v_0 - v_1);
+        const zfloat_t l_t = q_recip_2_sqrt_j * (sqrt_delta_v_0 * (v_1 + v_0)) - L;
 
         // The return condition allows a minor error in length (in mm). 
         // Note: This comparison does NOT affect actual lengths or steps, which would be bad.
@@ -444,8 +611,8 @@ float mp_get_decel_velocity(const float v_0, const float L, const mpBuf_t* bf)
             v_1 = v_0 - 0.1;
             continue;
         }
-        const float v_1x3 = 3 * v_1;
-        const float recip_l_t = (2 * sqrt_delta_v_0) / ((v_0 - v_1x3) * q_recip_2_sqrt_j);
+        const zfloat_t v_1x3 = 3 * v_1;
+        const zfloat_t recip_l_t = (2 * sqrt_delta_v_0) / ((v_0 - v_1x3) * q_recip_2_sqrt_j);
         v_1 = v_1 - (l_t * recip_l_t);
         
         // In some extreme cases there is no solution because the length is too short
@@ -465,23 +632,70 @@ float mp_get_decel_velocity(const float v_0, const float L, const mpBuf_t* bf)
  * and jerk (J), will locate the velocity v_1 that will allow acceleration from v_0
  * at jerk J to v_1 and then deceleration at jerk J to v_2, all over total length L.
  *
+ * This runs inside forward planning (interrupt level, just in time ahead of the steppers),
+ * so the worst case is bounded:
+ *
+ *  - The symmetric case (1) is closed form.
+ *  - The inversion case (2), where there is no meet above max(v_0, v_2), is detected in
+ *    closed form from the length of the ramp between v_0 and v_2.
+ *  - The asymmetric case (3) is seeded in closed form: ramp from the lower to the higher
+ *    velocity, then a symmetric bump from the higher velocity over the rest of the length.
+ *    Newton usually converges in 1 or 2 steps from there. The iteration is limited to
+ *    MEET_ITERATIONS_MAX steps and clamped to an upper bound (accelerating from the lower
+ *    velocity over all of L). If the budget runs out, the best estimate that fits in L is
+ *    used, with the leftover length as a body.
  */
 
+static float _get_meet_at_min(const float          v_0,
+                              const float          v_2,
+                              const float          L,
+                              mpBuf_t*             bf,
+                              mpBlockRuntimeBuf_t* block)
+{
+    // Case (2)
+    // There is no meet velocity. This is due to an inversion in the velocities of very short moves.
+    // We need to compute the head OR tail length, and the body will be the rest.
+    // Yes, that means we're computing a cruise in here.
+
+    float v_1 = max(v_0, v_2);
+
+    if (v_0 < v_2) {
+        // acceleration - it'll be a head/body
+        block->head_length = mp_get_target_length(v_0, v_2, bf);
+        if (block->head_length > L) {
+            block->head_length = L;
+            block->body_length = 0;
+            v_1 = mp_get_target_velocity(v_0, L, bf);
+        } else {
+            block->body_length = L - block->head_length;
+        }
+        block->tail_length = 0;
+
+    } else {
+        // deceleration - it'll be tail/body
+        block->tail_length = mp_get_target_length(v_2, v_0, bf);
+        if (block->tail_length > L) {
+            block->tail_length = L;
+            block->body_length = 0;
+            v_1 = mp_get_target_velocity(v_2, L, bf);
+        } else {
+            block->body_length = L - block->tail_length;
+        }
+        block->head_length = 0;
+    }
+    return v_1;
+}
+
 static float _get_meet_velocity(const float          v_0,
                                 const float          v_2,
                                 const float          L,
                                 mpBuf_t*             bf,
                                 mpBlockRuntimeBuf_t* block) 
 {
-    const float q_recip_2_sqrt_j = bf->q_recip_2_sqrt_j;
+    const zfloat_t q_recip_2_sqrt_j = bf->q_recip_2_sqrt_j;
 
     // v_1 can never be smaller than v_0 or v_2, so we keep track of this value
-    const float min_v_1 = max(v_0, v_2);
-
-    // v_1 is our estimated return value.
-    // We estimate with the speed obtained by L/2 traveled from the highest speed of v_0 or v_2.
-    float v_1 = mp_get_target_velocity(min_v_1, L / 2.0, bf);
-    // var v_1 = min_v_1 + 100;
+    const zfloat_t min_v_1 = max(v_0, v_2);
 
     if (fp_EQ(v_0, v_2)) {
         // Case (1)
@@ -492,61 +706,46 @@ static float _get_meet_velocity(const float          v_0,
         block->body_length = 0;
         block->tail_length = L - block->head_length;
         SET_PLANNER_ITERATIONS(-1);     // DIAGNOSTIC
-        return v_1;
+        return (mp_get_target_velocity(min_v_1, L / 2.0, bf));
     }
 
-    // Per iteration: 2 sqrt, 2 abs, 6 -, 4 +, 12 *, 3 /
-    int i = 0;          // limit the iterations // 466us - 644us
-    while (i++ < 30) {  // If it fails after 30, something's wrong
-        if (v_1 < min_v_1) {
-            // Case (2)
-            // We have caught a rather nasty problem. There is no meet velocity.
-            // This is due to an inversion in the velocities of very short moves.
-            // We need to compute the head OR tail length, and the body will be the rest.
-            // Yes, that means we're computing a cruise in here.
-
-            v_1 = min_v_1;
-
-            if (v_0 < v_2) {
-                // acceleration - it'll be a head/body
-                block->head_length = mp_get_target_length(v_0, v_2, bf);
-                if (block->head_length > L) {
-                    block->head_length = L;
-                    block->body_length = 0;
-                    v_1 = mp_get_target_velocity(v_0, L, bf);
-                } else {
-                    block->body_length = L - block->head_length;
-                }
-                block->tail_length = 0;
+    // Case (2) test - the ramp between the two velocities alone uses up the block
+    const zfloat_t ramp_length = mp_get_target_length(min(v_0, v_2), min_v_1, bf);
+    if (ramp_length >= L) {
+        SET_MEET_ITERATIONS(0);     // DIAGNOSTIC
+        return (_get_meet_at_min(v_0, v_2, L, bf, block));
+    }
 
-            } else {
-                // deceleration - it'll be tail/body
-                block->tail_length = mp_get_target_length(v_2, v_0, bf);
-                if (block->tail_length > L) {
-                    block->tail_length = L;
-                    block->body_length = 0;
-                    v_1 = mp_get_target_velocity(v_2, L, bf);
-                } else {
-                    block->body_length = L - block->tail_length;
-                }
-                block->head_length = 0;
-            }
+    // Case (3) - seed with ramp + symmetric bump, bound above by accelerating over all of L
+    zfloat_t v_1 = mp_get_target_velocity(min_v_1, (L - ramp_length) / 2.0, bf);
+    const zfloat_t max_v_1 = mp_get_target_velocity(min(v_0, v_2), L, bf);
 
-            break;
+    zfloat_t fit_v_1 = -1;          // best estimate so far that fits within L (l_c < 0), -1 = none
+    zfloat_t fit_l_h = 0;
+    zfloat_t fit_l_t = 0;
+
+    // Per iteration: 2 sqrt, 2 abs, 6 -, 4 +, 12 *, 3 /
+    int i = 0;
+    while (i++ < MEET_ITERATIONS_MAX) {
+        if (v_1 < min_v_1) {
+            // Newton undershot into the inversion region - treat it as case (2)
+            v_1 = _get_meet_at_min(v_0, v_2, L, bf, block);
+            SET_MEET_ITERATIONS(i);     // DIAGNOSTIC
+            return v_1;
         }
 
         // Precompute some common chunks -- note that some attempts may have v_1 < v_0 or v_1 < v_2
-        const float sqrt_delta_v_0 = sqrt(fabs(v_1 - v_0));
-        const float sqrt_delta_v_2 = sqrt(fabs(v_1 - v_2));  // 849us
+        const zfloat_t sqrt_delta_v_0 = sqrt(fabs(v_1 - v_0));
+        const zfloat_t sqrt_delta_v_2 = sqrt(fabs(v_1 - v_2));
 
         // l_c is our total-length calculation with the current v_1 estimate, minus the expected length.
         // This makes l_c == 0 when v_1 is the correct value.
 
         // GAMBLE: At the cost of one more multiply per iteration, we will keep the two length calculations seperate.
         // This allows us to store the resulting head/tail lengths.
-        const float l_h = q_recip_2_sqrt_j * (sqrt_delta_v_0 * (v_1 + v_0));
-        const float l_t = q_recip_2_sqrt_j * (sqrt_delta_v_2 * (v_1 + v_2));
-        const float l_c = (l_h + l_t) - L;
+        const zfloat_t l_h = q_recip_2_sqrt_j * (sqrt_delta_v_0 * (v_1 + v_0));
+        const zfloat_t l_t = q_recip_2_sqrt_j * (sqrt_delta_v_2 * (v_1 + v_2));
+        const zfloat_t l_c = (l_h + l_t) - L;
 
         block->head_length = l_h;
         block->tail_length = l_t;
@@ -566,15 +765,33 @@ static float _get_meet_velocity(const float          v_0,
                 // fix the overlap
                 block->tail_length = L - block->head_length;
             }
-            break;
+            SET_MEET_ITERATIONS(i);     // DIAGNOSTIC
+            return v_1;
+        }
+        if ((l_c < 0) && (v_1 > fit_v_1)) {     // remember the fastest estimate that still fits
+            fit_v_1 = v_1;
+            fit_l_h = l_h;
+            fit_l_t = l_t;
         }
 
-        const float v_1x3     = 3 * v_1;
-        const float recip_l_d = (2 * sqrt_delta_v_0 * sqrt_delta_v_2) /
-                                ((sqrt_delta_v_0 * (v_1x3 - v_2) - (v_0 - v_1x3) * sqrt_delta_v_2) * q_recip_2_sqrt_j);
+        const zfloat_t v_1x3     = 3 * v_1;
+        const zfloat_t recip_l_d = (2 * sqrt_delta_v_0 * sqrt_delta_v_2) /
+                                   ((sqrt_delta_v_0 * (v_1x3 - v_2) - (v_0 - v_1x3) * sqrt_delta_v_2) * q_recip_2_sqrt_j);
 
-        v_1 = v_1 - (l_c * recip_l_d);
+        zfloat_t v_next = v_1 - (l_c * recip_l_d);
+        if (v_next > max_v_1) {                 // keep Newton inside the bracket
+            v_next = (v_1 + max_v_1) / 2;
+        }
+        v_1 = v_next;
     }
     SET_MEET_ITERATIONS(i);     // DIAGNOSTIC
-    return v_1;
+
+    // Iteration budget exhausted. Fall back to the best fit, which leaves a short body.
+    if (fit_v_1 < 0) {
+        return (_get_meet_at_min(v_0, v_2, L, bf, block));
+    }
+    block->head_length = fit_l_h;
+    block->tail_length = fit_l_t;
+    block->body_length = L - (fit_l_h + fit_l_t);
+    return fit_v_1;
 }
@@ -57,12 +57,17 @@
 #include "plan_arc.h"
 #include "planner.h"
 #include "kinematics.h"
+#include "spindle.h"
 #include "stepper.h"
 #include "encoder.h"
 #include "report.h"
+#include "controller.h"
 #include "util.h"
 #include "json_parser.h"
 #include "xio.h"
+#include "text_parser.h"
+#include "latency.h"
+#include "cpuload.h"
 
 // Allocate planner structures
 
@@ -71,16 +76,34 @@ mpPlanner_t mp1;                            // primary planning context
 mpPlanner_t mp2;                            // secondary planning context
 
 mpPlannerRuntime_t *mr;                     // context for planner block runtime
-mpPlannerRuntime_t mr1;                     // primary planner runtime context
-mpPlannerRuntime_t mr2;                     // secondary planner runtime context
+CACHE_ALIGNED mpPlannerRuntime_t mr1;       // primary planner runtime context
+CACHE_ALIGNED mpPlannerRuntime_t mr2;       // secondary planner runtime context
 
 mpBuf_t mp1_queue[PLANNER_QUEUE_SIZE];      // storage allocation for primary planner queue buffers
 mpBuf_t mp2_queue[SECONDARY_QUEUE_SIZE];    // storage allocation for secondary planner queue buffers
 
+static mpRasterLine_t raster_lines[RASTER_LINES];   // scanline pixel FIFO - see mp_raster()
+static uint8_t raster_lines_queued;         // lines in use, oldest first
+static uint8_t raster_line_r;               // oldest line in use
+
+mpHealth_t mp_health;                       // planner health counters - see planner.h
+
+mpSegmentTiming_t mp_seg = {                // runtime segment timing - compiled defaults until {seg:} is loaded
+    MIN_SEGMENT_MS,
+    MIN_SEGMENT_MS / 60000,
+    NOM_SEGMENT_MS_MAX / 60000,
+    NOM_SEGMENT_MS_MAX * 1000,
+    NOM_SEGMENT_MS_MAX / 60000,
+    0,
+    UINT32_MAX
+};
+
 // Execution routines (NB: These are called from the LO interrupt)
 static stat_t _exec_dwell(mpBuf_t *bf);
 static stat_t _exec_command(mpBuf_t *bf);
 
+static inline void _release_buffer(mpBuf_t *bf);
+
 // DIAGNOSTICS
 //static void _planner_time_accounting();
 static void _audit_buffers();
@@ -178,13 +201,28 @@ void _init_planner_queue(mpPlanner_t *_mp, mpBuf_t *queue, uint8_t size)
     q->bf[size-1].nx = queue;
 }
 
+// empty a planner queue in place - only the buffers still in the queue are touched
+static void _reset_planner_queue(mpPlanner_t *_mp)
+{
+    mpPlannerQueue_t *q = &(_mp->q);
+    mpBuf_t *bf = q->r;
+
+    for (uint8_t i=0; (i < q->queue_size) && (bf->buffer_state != MP_BUFFER_EMPTY); i++, bf = bf->nx) {
+        _release_buffer(bf);
+    }
+    q->w = q->r;                            // the ring carries on from where it stopped
+    q->buffers_available = q->queue_size;
+}
+
 void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, uint8_t queue_size)
 {
     // init planner master structure
     memset(_mp, 0, sizeof(mpPlanner_t));    // clear all values, pointers and status    
     _mp->magic_start = MAGICNUM;            // set boundary condition assertions
     _mp->magic_end = MAGICNUM;
-    _mp->mfo_factor = 1.00;
+    _mp->mfo.factor = 1.00;
+    _mp->mto.factor = 1.00;
+    _mp->block_interval_ms = BLOCK_TIMEOUT_MS;  // not streaming
    
     // init planner queues
     _mp->q.bf = queue;                      // assign puffer pool to queue manager structure
@@ -208,7 +246,11 @@ void planner_reset(mpPlanner_t *_mp)        // reset planner queue, cease MR act
     _mp->reset();
     _mp->mr->reset();
     jc.reset();
-    _init_planner_queue(_mp, _mp->q.bf, _mp->q.queue_size); // reset planner buffers
+    _reset_planner_queue(_mp);              // empty planner buffers
+    if (_mp == &mp1) {                      // only the primary planner runs scanlines
+        raster_lines_queued = 0;
+        raster_line_r = 0;
+    }
 }
 
 stat_t planner_assert(const mpPlanner_t *_mp)
@@ -230,6 +272,7 @@ stat_t planner_assert(const mpPlanner_t *_mp)
  */
 void mp_halt_runtime()
 {
+    mp_vjog.active = false;         // a velocity jog stops with everything else
     stepper_reset();                // stop the steppers and dwells
     planner_reset(mp);              // reset the active planner
 }
@@ -260,23 +303,29 @@ void mp_halt_runtime()
  */
 
 void mp_set_planner_position(uint8_t axis, const float position) { mp->position[axis] = position; }
-void mp_set_runtime_position(uint8_t axis, const float position) { mr->position[axis] = position; }
+void mp_set_runtime_position(uint8_t axis, const float position) { mr->position[axis] = position; mr->snapshot_valid = false; }
 
 void mp_set_steps_to_runtime_position()
 {
+    if (mr == nullptr) {                                    // stepper_init() runs before the planners are set up
+        return;
+    }
     float step_position[MOTORS];
     kn_inverse_kinematics(mr->position, step_position);     // convert lengths to steps in floating point
     for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
         mr->target_steps[motor] = step_position[motor];
         mr->position_steps[motor] = step_position[motor];
         mr->commanded_steps[motor] = step_position[motor];
-        en_set_encoder_steps(motor, step_position[motor]);  // write steps to encoder register
-        mr->encoder_steps[motor] = en_read_encoder(motor);
+        const float backlash = st_get_backlash_steps(motor); // the motor keeps any slack it has taken up
+        en_set_encoder_steps(motor, step_position[motor] + backlash);  // write steps to encoder register
+        mr->encoder_steps[motor] = en_read_encoder(motor) - backlash;
 
         // These must be zero:
         mr->following_error[motor] = 0;
         st_pre.mot[motor].corrected_steps = 0;
     }
+    mp_shaper_reset();                                      // the steps no longer trail the runtime
+    mr->advance = 0;                                        // ...nor lead it on the extruder
 }
 
 /****************************************************************************************
@@ -313,9 +362,9 @@ void mp_queue_command(void(*cm_exec)(float *, bool *), float *value, bool *flag)
     bf->bf_func = _exec_command;      // callback to planner queue exec function
     bf->cm_func = cm_exec;            // callback to canonical machine exec function
 
-    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
-        bf->unit[axis] = value[axis];               // use the unit vector to store command values
-        bf->axis_flags[axis] = flag[axis];
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {    // either vector may be passed as nullptr
+        bf->unit[axis] = (value != nullptr) ? value[axis] : 0;  // use the unit vector to store command values
+        bf->axis_flags[axis] = (flag != nullptr) ? flag[axis] : false;
     }
     mp_commit_write_buffer(BLOCK_TYPE_COMMAND);     // must be final operation before exit
 }
@@ -335,6 +384,26 @@ stat_t mp_runtime_command(mpBuf_t *bf)
     return (STAT_OK);
 }
 
+/****************************************************************************************
+ * mp_sync_output() - switch an output a distance into the next motion block (M62, M63)
+ *
+ *  output_num is 1 based. The output goes in the planner's masks, not the queue - see
+ *  mpSyncOutput in planner.h. A later M62/M63 for the same output before the move wins.
+ */
+
+void mp_sync_output(const uint8_t output_num, const bool on, const float distance)
+{
+    uint16_t bit = (1 << (output_num-1));
+    if (on) {
+        mp->sync_out.set |= bit;
+        mp->sync_out.clear &= ~bit;
+    } else {
+        mp->sync_out.clear |= bit;
+        mp->sync_out.set &= ~bit;
+    }
+    mp->sync_out.distance = distance;
+}
+
 /****************************************************************************************
  * _exec_json_command() - execute json string (from exec system)
  * mp_json_command()    - queue a json command
@@ -362,34 +431,52 @@ stat_t mp_json_command_immediate(char *json_string)
 }
 
 /****************************************************************************************
- * _exec_json_wait() - execute json wait string
- * mp_json_wait()    - queue a json wait command
+ * _compile_json_wait() - turn the wait string into a list of conditions in the buffer
+ * _exec_json_wait()    - poll the conditions of a json wait
+ * mp_json_wait()       - queue a json wait command
+ *
+ *  The wait string is parsed once, the first time the block runs - it is parsed into the
+ *  exec nv list, which belongs to the runtime. Each boolean pair becomes a condition: its
+ *  cfgArray index is kept in unit[] and the value it waits for in axis_flags[], up to AXES
+ *  of them. Non-boolean pairs are ignored. After that a poll is one get function per
+ *  condition, so the wait can be polled every MP_WAIT_POLL_US.
  */
 
-static stat_t _exec_json_wait(mpBuf_t *bf)
+static void _compile_json_wait(mpBuf_t *bf)
 {
-    char *json_string = jc.read_buffer();
-
-    // process it
-    json_parse_for_exec(json_string, false); // do NOT execute
-
-    nvObj_t *nv = nv_exec;
-    while ((nv != NULL) && (nv->valuetype != TYPE_EMPTY)) {
-        // For now we ignore non-BOOL
-        if (nv->valuetype == TYPE_BOOLEAN) {
-            bool old_value = (bool)nv->value_int;         // force it to bool
+    json_parse_for_exec(jc.read_buffer(), false);   // do NOT execute
+    jc.free_buffer();
 
-            nv_get_nvObj(nv);
-            bool new_value = (bool)nv->value_int;
-            if (old_value != new_value) {
-                st_prep_dwell((uint32_t)(0.1 * 1000000.0));// 1ms converted to uSec
-                return STAT_OK;
-            }
+    uint8_t conditions = 0;
+    for (nvObj_t *nv = nv_exec; (nv != NULL) && (nv->valuetype != TYPE_EMPTY); nv = nv->nx) {
+        if ((nv->valuetype == TYPE_BOOLEAN) && (conditions < AXES)) {
+            bf->unit[conditions] = nv->index;
+            bf->axis_flags[conditions++] = (bool)nv->value_int;
         }
-        nv = nv->nx;
     }
-    jc.free_buffer();
+    for ( ; conditions < AXES; conditions++) {
+        bf->unit[conditions] = NO_MATCH;
+    }
+}
 
+static stat_t _exec_json_wait(mpBuf_t *bf)
+{
+    if (bf->block_state == BLOCK_INITIAL_ACTION) {
+        _compile_json_wait(bf);
+        bf->block_state = BLOCK_ACTIVE;
+    }
+    nvObj_t nv;
+    nv.pv = NULL;
+    nv.nx = NULL;
+    for (uint8_t i = 0; (i < AXES) && (bf->unit[i] != NO_MATCH); i++) {
+        nv_reset_nv(&nv);
+        nv.index = (index_t)bf->unit[i];
+        nv_get(&nv);
+        if ((bool)nv.value_int != bf->axis_flags[i]) {
+            st_prep_dwell(MP_WAIT_POLL_US);
+            return (STAT_OK);
+        }
+    }
     if (mp_free_run_buffer()) {
         cm_cycle_end();                                    // free buffer & perform cycle_end if planner is empty
     }
@@ -410,10 +497,50 @@ stat_t mp_json_wait(char *json_string)
     }
     bf->block_type = BLOCK_TYPE_COMMAND;
     bf->bf_func = _exec_json_wait;      // callback to planner queue exec function
+    bf->block_state = BLOCK_INITIAL_ACTION;             // compile the wait string on the first run
     mp_commit_write_buffer(BLOCK_TYPE_COMMAND);            // must be final operation before exit
     return (STAT_OK);
 }
 
+/****************************************************************************************
+ * _exec_wait()    - poll a native wait condition
+ * mp_queue_wait() - queue a wait that holds the queue until wait_func(value) is true
+ *
+ *  The native form of mp_json_wait(). The condition is a function instead of a JSON
+ *  string, so nothing is parsed or looked up in the config table at runtime.
+ *  Only value[0] and value[1] are meaningful to the built-in callers.
+ */
+
+static stat_t _exec_wait(mpBuf_t *bf)
+{
+    if (!bf->wait_func(bf->unit)) {
+        st_prep_dwell(MP_WAIT_POLL_US);                    // check again shortly
+        return (STAT_OK);
+    }
+    if (mp_free_run_buffer()) {
+        cm_cycle_end();                                    // free buffer & perform cycle_end if planner is empty
+    }
+    return (STAT_OK);
+}
+
+void mp_queue_wait(cm_wait_t wait_func, const float *value)
+{
+    mpBuf_t *bf;
+
+    // Never supposed to fail as buffer availability was checked upstream in the controller
+    if ((bf = mp_get_write_buffer()) == NULL) {
+        cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "mp_queue_wait()");
+        return;
+    }
+    bf->block_type = BLOCK_TYPE_COMMAND;
+    bf->bf_func = _exec_wait;           // callback to planner queue exec function
+    bf->wait_func = wait_func;
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        bf->unit[axis] = value[axis];   // use the unit vector to store the condition's arguments
+    }
+    mp_commit_write_buffer(BLOCK_TYPE_COMMAND);            // must be final operation before exit
+}
+
 
 /****************************************************************************************
  * mp_dwell()    - queue a dwell
@@ -470,8 +597,12 @@ void mp_request_out_of_band_dwell(float seconds)
  *
  * mp_get_planner_buffers()  - return # of available planner buffers
  * mp_planner_is_full()      - true if planner has no room for a new block
+ * mp_planner_is_time_full() - true if planner already holds the configured look-ahead time
+ * mp_get_planned_time()     - return time of all moves queued behind the run buffer (minutes)
  * mp_has_runnable_buffer()  - true if next buffer is runnable, indicating motion has not stopped.
  * mp_is_it_phat_city_time() - test if there is time for non-essential processes
+ * mp_set_segment_ms()       - set runtime segment timing, clamped to the measured exec budget
+ * mp_get_exec_usec_max()    - return worst case measured exec + prep time in microseconds
  */
 
 uint8_t mp_get_planner_buffers(const mpPlanner_t *_mp)  // which planner are you interested in?
@@ -485,6 +616,33 @@ bool mp_planner_is_full(const mpPlanner_t *_mp)         // which planner are you
     return ((_mp->q.buffers_available < PLANNER_BUFFER_HEADROOM) || (jc.available == 0));
 }
 
+/*
+ *  Time-based admission. If cm->planner_time_target ({qt:}, in ms) is non-zero the controller
+ *  stops reading new lines once that much motion is queued, even if buffers are free. Long moves
+ *  then don't tie up the queue, and the hard limit in mp_planner_is_full() still applies to short
+ *  moves. Block times are the estimates from _calculate_times() until the zoid has been planned.
+ */
+bool mp_planner_is_time_full(const mpPlanner_t *_mp)
+{
+    if (fp_ZERO(cm->planner_time_target)) {
+        return (false);
+    }
+    return (mp_get_planned_time(_mp) >= (cm->planner_time_target / 60000));
+}
+
+float mp_get_planned_time(const mpPlanner_t *_mp)
+{
+    float planned_time = 0;
+    mpBuf_t *bf = _mp->q.r;
+
+    while (((bf = bf->nx) != _mp->q.r) && (bf->buffer_state != MP_BUFFER_EMPTY)) {
+        if (bf->block_type == BLOCK_TYPE_ALINE) {
+            planned_time += bf->block_time;
+        }
+    }
+    return (planned_time);
+}
+
 bool mp_has_runnable_buffer(const mpPlanner_t *_mp)     // which planner are you interested in?)
 {
     return (_mp->q.r->buffer_state);    // anything other than MP_BUFFER_EMPTY returns true
@@ -498,6 +656,39 @@ bool mp_is_phat_city_time()
     return ((mp->plannable_time <= 0.0) || (PHAT_CITY_TIME < mp->plannable_time));
 }
 
+/*
+ *  The exec timer ISR measures mp_exec_move() + st_prep_line() on every call. Each segment
+ *  must leave room for the DDA, the loader and the main loop, so a requested segment time is
+ *  raised until the worst case measured so far fits in SEGMENT_EXEC_BUDGET of it. Settings
+ *  are applied before motion has been run, so the planner callback re-applies the clamp when
+ *  the machine goes idle if the measured worst case has since outgrown the budget.
+ *
+ *  Returns the minimum segment ms actually applied.
+ */
+float mp_set_segment_ms(float segment_ms)
+{
+    float exec_ms = mp_get_exec_usec_max() / 1000;
+    segment_ms = max3(segment_ms, MIN_SEGMENT_MS_FLOOR, exec_ms / SEGMENT_EXEC_BUDGET);
+    if (segment_ms > MIN_SEGMENT_MS) {
+        segment_ms = MIN_SEGMENT_MS;                // DDA_SUBSTEPS can't represent longer segments
+    }
+    mp_seg.min_segment_ms = segment_ms;
+    mp_seg.min_segment_time = segment_ms / 60000;
+    mp_seg.nom_segment_time = segment_ms * 2 / 60000;
+    mp_seg.nom_segment_usec = segment_ms * 2 * 1000;
+    mp_seg.min_block_time = segment_ms * 2 / 60000;
+    mp_seg.exec_cycles_budget = (uint32_t)(segment_ms * SEGMENT_EXEC_BUDGET * (SystemCoreClock / 1000));
+    if (segment_ms == MIN_SEGMENT_MS) {
+        mp_seg.exec_cycles_budget = UINT32_MAX;     // nothing longer to clamp to
+    }
+    return (segment_ms);
+}
+
+float mp_get_exec_usec_max()
+{
+    return (cycles_to_usec(mp_seg.exec_cycles_max));
+}
+
 /****************************************************************************************
  * mp_planner_callback()
  *
@@ -531,6 +722,12 @@ bool mp_is_phat_city_time()
  *    immediately in the latter cases.
  *
  *  - Feedholds require replanning to occur
+ *
+ *  - STARTUP ends when the queue is full, or when no more blocks are coming. A single
+ *    MDI command or the first line of a jog doesn't wait for the block timeout: if
+ *    the host isn't streaming and no further line is waiting in the RX buffer the
+ *    planner starts right away. While streaming, the timeout follows the rate the
+ *    lines are arriving at (see mp_block_arrived()).
  */
 
 stat_t mp_planner_callback()
@@ -539,6 +736,9 @@ stat_t mp_planner_callback()
     if ((mp_get_planner_buffers(mp) == mp->q.queue_size) &&     // detect and set IDLE state
         (cm->motion_state == MOTION_STOP) && (cm->hold_state == FEEDHOLD_OFF)) {
         mp->planner_state = PLANNER_IDLE;
+        if (mp_seg.exec_cycles_max > mp_seg.exec_cycles_budget) {
+            mp_set_segment_ms(mp_seg.min_segment_ms);   // exec outgrew the segment time - re-clamp it
+        }
         return (STAT_OK);
     }
 
@@ -557,11 +757,14 @@ stat_t mp_planner_callback()
         mp->planner_state = PLANNER_STARTUP;
     }
     if (mp->planner_state == PLANNER_STARTUP) {
-        if (!mp_planner_is_full(mp) && !_timed_out) {
+        bool streaming = (mp->block_interval_ms < BLOCK_TIMEOUT_MS);
+        if (!mp_planner_is_full(mp) && !mp_planner_is_time_full(mp) && !_timed_out &&
+            (streaming || xio_rx_pending())) {
             return (STAT_OK);                       // remain in STARTUP
         }
         mp->planner_state = PLANNER_PRIMING;
     }
+    ldScope _ld(LOAD_MAIN);
     mp_plan_block_list();
     return (STAT_OK);
 }
@@ -571,10 +774,21 @@ stat_t mp_planner_callback()
  *
  *  We don't actually need to invalidate back-planning. Only forward planning.
  *
+ *  Called on the way out of a hold with bf = the held block. The back-planned exit velocities
+ *  in the queue are kept as they were when the hold was entered - each one depends only on
+ *  the blocks after it, and a hold changes nothing downstream of the held block. Only the
+ *  held block changed (its remaining length and zero entry), so it is the only one whose
+ *  convergence is cleared. Blocks that had already been forward planned were reverted to
+ *  BACK_PLANNED by the hold in _exec_aline_feedhold(), and reverting FULLY_PLANNED blocks
+ *  below covers the rest. New blocks arriving after the resume stop back-planning at the
+ *  first converged block instead of walking the whole queue back to the held block.
  */
 
 void mp_replan_queue(mpBuf_t *bf)
 {
+    bf->converged = false;                                  // the held block's length has changed
+    mp->run.next = NULL;                                    // any acceleration run was cut short by the hold
+
     do {
         if (bf->buffer_state >= MP_BUFFER_FULLY_PLANNED) {  // revert from FULLY PLANNED state
             bf->buffer_state = MP_BUFFER_BACK_PLANNED;
@@ -589,57 +803,167 @@ void mp_replan_queue(mpBuf_t *bf)
 /*
  *  mp_start_feed_override() - gradually adjust existing and new buffers to target override percentage
  *  mp_end_feed_override() - gradually adjust existing and new buffers to no override percentage
+ *  mp_start_traverse_override() - same for traverse (G0) buffers
+ *  mp_end_traverse_override() - same for traverse (G0) buffers
+ *  mp_relink_feed_override() - re-apply the feed override after the spindle feed link changed
  *
  *  Variables:
- *    - 'mfo_factor' is the override scaling factor normalized to 1.0 = 100%
+ *    - 'override_factor' is the override scaling factor normalized to 1.0 = 100%
  *      Values < 1.0 are speed decreases, > 1.0 are increases. Upper and lower limits are checked.
  *
  *    - 'ramp_time' is approximate, as the ramp dynamically changes move execution times
  *      The ramp will attempt to meet the time specified but it will not be exact.
+ *
+ *  Feed overrides apply to feed blocks (G1 and arcs), traverse overrides to traverse (G0)
+ *  blocks. Each kind keeps its own ramp (mp->mfo, mp->mto), so one can ramp while the other
+ *  holds. Command blocks take neither.
+ *
+ *  The feed override is the factor requested times spindle_feed_link(), which is the
+ *  spindle override if the feed is linked to it ({spfl:1}). The spindle re-applies the last
+ *  request when its override changes, so both ramp together.
  */
 /*  Function:
- *  The override takes effect as close to real-time as possible. Practically, this means about 20 or
- *  so behind the current running move. How it works:
+ *  The override takes effect as close to real-time as possible. Practically, this means the
+ *  first block that has not been forward planned. How it works:
  *
  *    - If the planner is idle just apply the override factor and be done with it. That's easy.
- *    - Otherwise look for the "break point" at 20 ms
+ *    - Otherwise find the "break point" - the first block after the critical region (mp->c).
+ *      Blocks up to there are forward planned and committed to the runtime.
+ *    - Re-seed both ramps from the factors the blocks at the break point were given, then
+ *      re-prime and back-plan from there. _calculate_override() steps the ramp along the
+ *      re-primed blocks, which gives the ramp its shape.
+ *    - If there is no break point the ramp starts with the next new block.
+ *
+ *  In time-scale mode ({frm:1}) the feed override is carried out by the exec instead, which
+ *  runs the planned blocks slower by stretching time (mp_set_time_scale()). A plan slowed down
+ *  uniformly stays within every velocity, acceleration and jerk limit it was planned to, so
+ *  nothing is replanned and the change starts with the next segment. Going faster than the
+ *  queue was planned for still needs the replan above, with the exec scale returning to 1.0.
+ *  The plan is never made slower than 1.0 in this mode, so turning the override back up to
+ *  there is also free. As the exec scale is continuous across block boundaries it applies to
+ *  traverses as well as feeds while the feed override is below what was planned.
  */
 
-void mp_start_feed_override(const float ramp_time, const float override_factor)
+static mpBuf_t *_get_override_break_point()
 {
-    cm->mfo_state = MFO_REQUESTED;
+    mpBuf_t *bf = mp_get_r();
+    for (uint8_t i=0; i < mp->q.queue_size; i++, bf = bf->nx) {
+        if (bf->buffer_state <= MP_BUFFER_INITIALIZING) {
+            return (nullptr);                               // nothing after the critical region
+        }
+        if (bf->buffer_state < MP_BUFFER_FULLY_PLANNED) {
+            return (bf);
+        }
+    }
+    return (nullptr);
+}
+
+static void _seed_override_ramp(mpOverrideRamp_t *o, mpBuf_t *bf, const bool traverse)
+{
+    for ( ; bf->buffer_state > MP_BUFFER_INITIALIZING; bf = bf->nx) {
+        if ((bf->block_type == BLOCK_TYPE_ALINE) && fp_NOT_ZERO(bf->override_factor) &&
+            ((bf->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) == traverse)) {
+            o->factor = bf->override_factor;                // the factor this block was planned with
+            return;
+        }
+        if (bf->nx == mp_get_r()) {
+            return;
+        }
+    }
+}
 
+static void _start_override(mpOverrideRamp_t *o, const float ramp_time, const float override_factor)
+{
+    // Assume that the min and max values for override_factor have been validated upstream
     if (mp->planner_state == PLANNER_IDLE) {
-        mp->mfo_factor = override_factor;             // that was easy
+        o->factor = override_factor;                        // that was easy
+        o->active = false;
         return;
     }
+    mp->c = _get_override_break_point();
+    bool replan = ((mp->c != nullptr) && (mp->planner_state == PLANNER_PRIMING));
+    if (replan) {                                           // the un-committed blocks revert to their ramps
+        _seed_override_ramp(&mp->mfo, mp->c, false);
+        _seed_override_ramp(&mp->mto, mp->c, true);
+    }
 
-    // Assume that the min and max values for override_factor have been validated upstream
     // SUVAT: V = U+AT ==> A = (V-U)/T
-    mp->ramp_target = override_factor;
-    mp->ramp_dvdt = (override_factor - mp->c->override_factor) / ramp_time;
-    mp->mfo_active = true;
-
-    if (fp_NOT_ZERO(mp->ramp_dvdt)) {    // do these things only if you actually have a ramp to run
-        mp->p = mp->c;                    // re-position the planner pointer
-        mp->ramp_active = true;
+    o->target = override_factor;
+    o->dvdt = (override_factor - o->factor) / ramp_time;
+    o->active = fp_NOT_ZERO(o->dvdt);                       // do these things only if you actually have a ramp to run
+
+    if (replan) {
+        for (mpBuf_t *bf = mp->c; bf->buffer_state > MP_BUFFER_INITIALIZING; bf = bf->nx) {
+            bf->plannable = true;                           // re-open blocks that were found optimal
+            bf->converged = false;
+            if (bf->nx == mp_get_r()) {
+                break;
+            }
+        }
+        mp->p = mp->c;                                      // re-position the planner pointer
         mp->request_planning = true;
     }
 }
 
+static float mfo_requested = 1.0;                       // feed override asked for, before the link
+
+void mp_start_feed_override(const float ramp_time, const float requested)
+{
+    mfo_requested = requested;
+    float override_factor = min(max(requested * spindle_feed_link(), (float)FEED_OVERRIDE_MIN), (float)FEED_OVERRIDE_MAX);
+    cm->mfo_state = MFO_REQUESTED;
+    if (cm->mfo_mode != MFO_MODE_TIME_SCALE) {
+        mp_set_time_scale(1.0);
+        _start_override(&mp->mfo, ramp_time, override_factor);
+        return;
+    }
+    if (mp->planner_state == PLANNER_IDLE) {                // plan at no less than 1.0, scale the rest
+        _start_override(&mp->mfo, ramp_time, max(override_factor, (float)1.0));
+    }
+    float planned = mp->mfo.active ? mp->mfo.target : mp->mfo.factor;  // what new blocks are planned to
+    if (override_factor > planned) {
+        _start_override(&mp->mfo, ramp_time, override_factor);
+        mp_set_time_scale(1.0);
+    } else {
+        mp_set_time_scale(override_factor / planned);
+    }
+}
+
 void mp_end_feed_override(const float ramp_time)
 {
-    mp_start_feed_override (FEED_OVERRIDE_RAMP_TIME, 1.00);
+    mp_start_feed_override(ramp_time, 1.00);
+}
+
+void mp_relink_feed_override(const float ramp_time)
+{
+    mp_start_feed_override(ramp_time, mfo_requested);
 }
 
 void mp_start_traverse_override(const float ramp_time, const float override_factor)
 {
-    return;
+    _start_override(&mp->mto, ramp_time, override_factor);
 }
 
 void mp_end_traverse_override(const float ramp_time)
 {
-    return;
+    mp_start_traverse_override(ramp_time, 1.00);
+}
+
+/*
+ *  mp_reset_overrides() - return the feed and traverse ramps and the exec time scale to 1.0
+ *
+ *  For program end and machine reset, when motion has stopped. Blocks already queued keep
+ *  the factors they were planned with.
+ */
+
+void mp_reset_overrides()
+{
+    mfo_requested = 1.00;
+    mp->mfo.active = false;
+    mp->mfo.factor = spindle_feed_link();           // a linked spindle override is not reset
+    mp->mto.active = false;
+    mp->mto.factor = 1.00;
+    mp_reset_time_scale();
 }
 
 /*
@@ -664,6 +988,77 @@ void mp_planner_time_accounting()
     UPDATE_MP_DIAGNOSTICS                           // DIAGNOSTIC
 }
 
+/*
+ * mp_get_queue_time() - time to run everything in the planner queue, in minutes
+ *
+ *  The rest of the running block plus the block time of every block queued behind it.
+ *  Planned blocks have their accel and jerk limited times; blocks not planned yet carry
+ *  the cruise time estimate from _calculate_times(), which is short of the planned time.
+ */
+
+float mp_get_queue_time()
+{
+    mpBuf_t *bf = mp_get_r();
+    float time = 0;
+
+    do {
+        if (bf->buffer_state == MP_BUFFER_EMPTY) {
+            break;
+        }
+        if (bf->block_type == BLOCK_TYPE_DWELL) {
+            time += bf->block_time / 60;            // dwells are in seconds
+        } else if ((bf->buffer_state == MP_BUFFER_RUNNING) && (bf->block_type == BLOCK_TYPE_ALINE) &&
+                   (bf->block_state == BLOCK_ACTIVE)) {
+            time += mp->run_time_remaining;
+        } else if (bf->block_type == BLOCK_TYPE_ALINE) {
+            time += bf->block_time;
+        }
+    } while ((bf = bf->nx) != mp_get_r());
+    return (time);
+}
+
+/*
+ * mp_health_block_start() - sample the queue as a block starts running (after the time accounting)
+ * mp_health_starved()     - the exec found nothing runnable while in MOTION_RUN
+ * mp_health_plan_missed() - the exec found the next block back planned but not forward planned
+ *
+ *  All three are called from the exec. See mpHealth in planner.h.
+ */
+
+void mp_health_block_start()
+{
+    static const float plannable_ms[MP_HEALTH_BINS-1] = { 5, 10, 20, 50, 100, 200, 500 };
+
+    uint8_t bin = ((uint16_t)mp->q.buffers_available * MP_HEALTH_BINS) / (mp->q.queue_size + 1);
+    mp_health.buffers[bin]++;                       // bin 0 is the fullest queue
+
+    for (bin = 0; bin < MP_HEALTH_BINS-1; bin++) {
+        if (mp->plannable_time * 60000 < plannable_ms[bin]) {
+            break;
+        }
+    }
+    mp_health.plannable[bin]++;
+    mp_health.blocks++;
+    mp_health.starving = false;
+    mp_health.plan_missed = false;
+}
+
+void mp_health_starved()
+{
+    if (!mp_health.starving) {
+        mp_health.starving = true;
+        mp_health.starvations++;
+    }
+}
+
+void mp_health_plan_missed()
+{
+    if (!mp_health.plan_missed) {
+        mp_health.plan_missed = true;
+        mp_health.plan_misses++;
+    }
+}
+
 /**** PLANNER BUFFER PRIMITIVES ************************************************************
  *
  *  Planner buffers are used to queue and operate on Gcode blocks. Each buffer contains
@@ -708,6 +1103,8 @@ void mp_planner_time_accounting()
  *
  * Functions Provided:
  *   _clear_buffer(bf)        Zero the contents of a buffer
+ *   _release_buffer(bf)      Return a buffer to the pool. It is cleared when it is next
+ *                            handed out by mp_get_write_buffer()
  *
  *   mp_init_buffers()        Initialize and reset buffers in all planner queues
  *
@@ -746,6 +1143,17 @@ static inline void _clear_buffer(mpBuf_t *bf)
     bf->reset();    // Call a reset method on the buffer object.
 }                   // We'll need something else for C - like bring the method code back into this function.
 
+// A released buffer only has to look finished to the back-planner walking past it: empty,
+// not plannable and stopped. The rest of it is cleared by _clear_buffer() when it's reused.
+static inline void _release_buffer(mpBuf_t *bf)
+{
+    bf->buffer_state = MP_BUFFER_EMPTY;
+    bf->block_type = BLOCK_TYPE_NULL;
+    bf->plannable = false;
+    bf->exit_velocity = 0;
+    bf->exit_vmax = 0;
+}
+
 /*
  * These GET functions are defined here but we use the macros in planner.h instead
 mpBuf_t * mp_get_prev_buffer(const mpBuf_t *bf) { return (bf->pv); }
@@ -761,7 +1169,7 @@ mpBuf_t * mp_get_write_buffer()     // get & clear a buffer
     mpPlannerQueue_t *q = &(mp->q);
        
     if (q->w->buffer_state == MP_BUFFER_EMPTY) {
-        _clear_buffer(q->w);        // NB: this is redundant if the buffer was cleared mp_free_run_buffer()
+        _clear_buffer(q->w);        // released buffers are cleared here, on their way back into the queue
         q->w->buffer_state = MP_BUFFER_INITIALIZING;
         q->buffers_available--;
         return (mp_get_w());
@@ -801,12 +1209,39 @@ void mp_commit_write_buffer(const blockType block_type)
         }
     }
     q->w->plannable = true;                 // enable block for planning
+    LAT_BLOCK_COMMIT(q->w);                 // before the ISRs can see it
     mp->request_planning = true;
     q->w = q->w->nx;                        // advance write buffer pointer
-    mp->block_timeout.set(BLOCK_TIMEOUT_MS);// reset the block timer
+    mp_block_arrived();                     // reset the block timer
     qr_request_queue_report(+1);            // request QR and add to "added buffers" count
 }
 
+/*
+ * mp_block_arrived() - time the arrival of a block and set the block timeout from it
+ *
+ *  The blocks of a stream arrive within BLOCK_TIMEOUT_MS of each other. Their interval is
+ *  smoothed, and the stream is taken to have stalled after BLOCK_TIMEOUT_LINES intervals
+ *  with no block - so a fast stream starts moving sooner than a slow one. A block after
+ *  a longer gap starts a new stream, with the full timeout.
+ */
+
+void mp_block_arrived()
+{
+    uint32_t now = SysTickTimer_getValue();
+    float interval = (float)(now - mp->block_arrival_ms);
+    mp->block_arrival_ms = now;
+
+    if (interval >= BLOCK_TIMEOUT_MS) {
+        mp->block_interval_ms = BLOCK_TIMEOUT_MS;
+    } else if (mp->block_interval_ms >= BLOCK_TIMEOUT_MS) {
+        mp->block_interval_ms = interval;           // second block of a stream
+    } else {
+        mp->block_interval_ms += (interval - mp->block_interval_ms) / 4;
+    }
+    float timeout = std::min(std::max(mp->block_interval_ms * BLOCK_TIMEOUT_LINES, BLOCK_TIMEOUT_MIN_MS), BLOCK_TIMEOUT_MS);
+    mp->block_timeout.set((uint32_t)timeout);
+}
+
 // Note: mp_get_run_buffer() is only called by mp_exec_move(), which is inside an interrupt
 // EMPTY and INITALIZING are the two cases where nothing is returned. This is not an error
 // Otherwise return the buffer. Let mp_exec_move() manage the state machine to sort out:
@@ -830,14 +1265,50 @@ bool mp_free_run_buffer()           // EMPTY current run buffer & advance to the
     mpBuf_t *r_now = q->r;          // save this pointer is to avoid a race condition when clearing the buffer
 
     _audit_buffers();               // DIAGNOSTIC audit for buffer chain integrity (only runs in DEBUG mode)
+    if (r_now->raster_block) {      // release the scanline's pixels - lines are freed in queue order
+        raster_line_r = (raster_line_r + 1) % RASTER_LINES;
+        raster_lines_queued--;
+    }
+    LAT_BLOCK_STAMP(r_now, LAT_DONE);
     q->r = q->r->nx;                // advance to next run buffer first...
-    _clear_buffer(r_now);           // ... then clear out the old buffer (& set MP_BUFFER_EMPTY)
-//    r_now->buffer_state = MP_BUFFER_EMPTY; //... then mark the buffer empty while preserving content for debug inspection
+    _release_buffer(r_now);         // ... then release the old buffer (& set MP_BUFFER_EMPTY)
     q->buffers_available++;
     qr_request_queue_report(-1);    // request a QR and add to the "removed buffers" count
     return (q->w == q->r);          // return true if the queue emptied
 }
 
+/*
+ * mp_get_raster_line()  - return the next free scanline to fill, or NULL if they are all queued
+ * mp_get_raster_pixel() - return the intensity of a raster block at path length s
+ *
+ *  The line returned by mp_get_raster_line() is not taken until it is queued by mp_raster(),
+ *  so a caller can fill it and drop it without cleanup.
+ */
+
+mpRasterLine_t * mp_get_raster_line()
+{
+    if (raster_lines_queued >= RASTER_LINES) {
+        return (NULL);
+    }
+    return (&raster_lines[(raster_line_r + raster_lines_queued) % RASTER_LINES]);
+}
+
+void mp_take_raster_line()          // called by mp_raster() once the line is committed
+{
+    raster_lines_queued++;
+}
+
+uint8_t mp_get_raster_pixel(const mpRaster_t *raster, const float s)
+{
+    int32_t pixel = (int32_t)(raster->pixel_start + s * raster->pixels_per_mm);
+    if (pixel < 0) {
+        pixel = 0;
+    } else if (pixel >= raster->line->count) {
+        pixel = raster->line->count - 1;
+    }
+    return (raster->line->pixel[pixel]);
+}
+
 /* UNUSED FUNCTIONS - left in for completeness and for reference
 void mp_copy_buffer(mpBuf_t *bf, const mpBuf_t *bp)
 {
@@ -1022,7 +1493,39 @@ static void _audit_buffers()
  * Functions to get and set variables from the cfgArray table
  ***********************************************************************************/
 
+/*
+ * mp_set_ph() - clear all planner health counters (the counters are read with get_int32)
+ */
+
+stat_t mp_set_ph(nvObj_t *nv)
+{
+    memset(&mp_health, 0, sizeof(mp_health));
+    return (STAT_OK);
+}
+
 /***********************************************************************************
  * TEXT MODE SUPPORT
  * Functions to print variables from the cfgArray table
  ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_phb[] = "[%s] queue depth bin%17d blocks\n";
+static const char fmt_pht[] = "[%s] plannable time bin%14d blocks\n";
+static const char fmt_phs[] = "[phs] starvation events%13d\n";
+static const char fmt_phm[] = "[phm] forward plan misses%11d\n";
+static const char fmt_phk[] = "[phk] blocks started%16d\n";
+
+static void _print_bin(nvObj_t *nv, const char *format)
+{
+    sprintf(cs.out_buf, format, nv->token, (int)nv->value_int);
+    xio_writeline(cs.out_buf);
+}
+
+void mp_print_phb(nvObj_t *nv) { _print_bin(nv, fmt_phb);}
+void mp_print_pht(nvObj_t *nv) { _print_bin(nv, fmt_pht);}
+void mp_print_phs(nvObj_t *nv) { text_print(nv, fmt_phs);}    // TYPE_INT
+void mp_print_phm(nvObj_t *nv) { text_print(nv, fmt_phm);}    // TYPE_INT
+void mp_print_phk(nvObj_t *nv) { text_print(nv, fmt_phk);}    // TYPE_INT
+
+#endif // __TEXT_MODE
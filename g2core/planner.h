@@ -81,6 +81,7 @@
  *  - mp_queue_command() - queue a canned command
  *  - mp_json_command()  - queue a JSON command for run-time interpretation and execution (M100)  
  *  - mp_json_wait()     - queue a JSON wait for run-time interpretation and execution (M101)
+ *  - mp_queue_wait()    - queue a wait on a native condition (e.g. heater at temperature)
  *  - 
  * In addition, cm_arc_feed() valaidates and sets up a arc paramewters and calls mp_aline() 
  * repeatedly to spool out the arc segments into the planner queue.
@@ -133,7 +134,7 @@
  *
  *  - Feed hold and cycle start (resume) operations
  *
- *  - Feed rate override functions and replanning
+ *  - Feed rate and traverse override functions and replanning
  *
  * Some terms that are useful that we try to use consistently:
  *
@@ -150,6 +151,7 @@
 #define PLANNER_H_ONCE
 
 #include "canonical_machine.h"    // used for GCodeState_t
+#include "util.h"                 // used for CACHE_ALIGNED
 
 using Motate::Timeout;
 
@@ -159,6 +161,7 @@ using Motate::Timeout;
  */
 
 typedef void (*cm_exec_t)(float[], bool[]); // callback to canonical_machine execution function
+typedef bool (*cm_wait_t)(const float[]);   // returns true when a queued wait is satisfied
 
 typedef enum {                      // planner operating state
     PLANNER_IDLE = 0,               // planner and movement are idle
@@ -202,6 +205,12 @@ typedef enum {
 } moveSection;
 #define SECTIONS 3
 
+typedef enum {                      // input shaper impulse trains - see plan_shaper.cpp
+    SHAPER_TYPE_ZV = 0,             // zero vibration - 2 impulses
+    SHAPER_TYPE_ZVD,                // zero vibration and derivative - 3 impulses
+    SHAPER_TYPE_EI                  // extra insensitive - 3 impulses
+} mpShaperType;
+
 typedef enum {
     SECTION_OFF = 0,                // section inactive
     SECTION_NEW,                    // uninitialized section
@@ -226,27 +235,82 @@ typedef enum {                      // code blocks for planning and trapezoid ge
 
 /*** Most of these factors are the result of a lot of tweaking. Change with caution.***/
 
+#ifndef PLANNER_QUEUE_SIZE                              // boards can override this value in hardware.h
 #define PLANNER_QUEUE_SIZE          ((uint8_t)48)       // Suggest 12 min. Limit is 255
+#endif
+#ifndef SECONDARY_QUEUE_SIZE                            // boards can override this value in hardware.h
 #define SECONDARY_QUEUE_SIZE        ((uint8_t)12)       // Secondary planner queue for feedhold operations
+#endif
 #define PLANNER_BUFFER_HEADROOM     ((uint8_t)4)        // Buffers to reserve in planner before processing new input line
 #define JERK_MULTIPLIER             ((float)1000000)    // DO NOT CHANGE - must always be 1 million
+#define ACCEL_MULTIPLIER            ((float)1000)       // DO NOT CHANGE - acceleration settings are in thousands
+#define ACCEL_JERK_FACTOR           ((float)1.642240766)// (q * 8/15)^2 - jerk whose S-curve peaks at a given acceleration
+
+static_assert ( (PLANNER_QUEUE_SIZE >= 12) && (PLANNER_QUEUE_SIZE <= 255), "PLANNER_QUEUE_SIZE must be between 12 and 255" );
+static_assert ( (SECONDARY_QUEUE_SIZE > PLANNER_BUFFER_HEADROOM) && (SECONDARY_QUEUE_SIZE <= 255), "SECONDARY_QUEUE_SIZE must exceed PLANNER_BUFFER_HEADROOM" );
 
 #define JUNCTION_INTEGRATION_MIN    (0.05)              // JT minimum allowable setting
 #define JUNCTION_INTEGRATION_MAX    (5.00)              // JT maximum allowable setting
 
+#define PLANNER_TIME_TARGET_MAX     (10000.0)           // QT maximum allowable setting in ms
+
+#define MP_WAIT_POLL_US             ((uint32_t)1000)    // how often a queued wait (M101, mp_queue_wait()) checks its condition
+
+/* Planner math precision
+ *
+ *  The ramp solvers in plan_zoid.cpp (target length and velocity, meet and decel velocity)
+ *  work in zfloat_t. Boards with a double precision FPU (the Cortex-M7 on the SAMS70 boards)
+ *  set PLANNER_DOUBLE in hardware.h, which makes these double. Block and runtime values
+ *  stay float - only the intermediates of the solvers are widened. In double the meet
+ *  velocity Newton iteration gets inside its length tolerance within a few steps, where
+ *  float can run out of budget and fall back to a short body, so the budget is cut.
+ */
+
+#ifndef PLANNER_DOUBLE                                  // boards can override this value in hardware.h
+#define PLANNER_DOUBLE 0
+#endif
+
+#if (PLANNER_DOUBLE == 1)
+typedef double zfloat_t;
+#else
+typedef float zfloat_t;
+#endif
+
+#if (PLANNER_DOUBLE == 1)
+#define MEET_ITERATIONS_MAX         (5)                 // hard budget for _get_meet_velocity() at forward-plan time
+#else
+#define MEET_ITERATIONS_MAX         (8)                 // hard budget for _get_meet_velocity() at forward-plan time
+#endif
+#define DECEL_ITERATIONS_MAX        (20)                // hard budget for mp_get_decel_velocity()
+#define RUN_BLOCKS_MAX              ((uint8_t)12)       // most blocks an acceleration run is planned across
+#define RUN_ITERATIONS_MAX          (10)                // hard budget for finding where a block ends on a run
+
+#define BLEND_SEGMENTS_MAX          ((uint8_t)8)        // max chords used to replace a G64 P corner (even)
+#define BLEND_SEGMENT_ANGLE         (M_PI / 16)         // target deflection per blend chord (radians)
+#define BLEND_COS_MIN               (0.99999)           // corners straighter than this are not blended
+#define BLEND_LENGTH_MIN            (0.001)             // blends shorter than this (mm) are not worth a block
+
+#define LINK_THROTTLE_MARGIN        ((float)1.25)       // moves from the host take this many line times - see _throttle_to_link()
+
 #ifndef MIN_SEGMENT_MS                                  // boards can override this value in hardware.h
-#define MIN_SEGMENT_MS              ((float)0.75)       // minimum segment milliseconds
+#define MIN_SEGMENT_MS              ((float)0.75)       // minimum segment milliseconds - {seg:} default and upper limit
 #endif
-#define NOM_SEGMENT_MS              ((float)MIN_SEGMENT_MS * 2) // nominal segment ms (at LEAST MIN_SEGMENT_MS * 2)
-#define MIN_BLOCK_MS                ((float)MIN_SEGMENT_MS * 2) // minimum block (whole move) milliseconds
+#define MIN_SEGMENT_MS_FLOOR        ((float)0.25)       // lowest {seg:} accepted regardless of the measured budget
+#define SEGMENT_EXEC_BUDGET         ((float)0.50)       // fraction of a minimum segment that exec + prep may consume
+#define NOM_SEGMENT_MS_MAX          ((float)MIN_SEGMENT_MS * 2) // longest nominal segment ms (sizes DDA_SUBSTEPS)
+
+#define MP_LINE_S_PER_MM            ((float)1000000.0)  // fixed-point resolution of the line distance run - 1 nm
 
 #define BLOCK_TIMEOUT_MS            ((float)30.0)       // MS before deciding there are no new blocks arriving
+#define BLOCK_TIMEOUT_MIN_MS        ((float)2.0)        // shortest block timeout while lines are streaming in
+#define BLOCK_TIMEOUT_LINES         ((float)4.0)        // a stream has stalled after this many line intervals
 #define PHAT_CITY_MS                ((float)100.0)      // if you have at least this much time in the planner
 
-#define NOM_SEGMENT_TIME            ((float)(NOM_SEGMENT_MS / 60000))       // DO NOT CHANGE - time in minutes
-#define NOM_SEGMENT_USEC            ((float)(NOM_SEGMENT_MS * 1000))        // DO NOT CHANGE - time in microseconds
-#define MIN_SEGMENT_TIME            ((float)(MIN_SEGMENT_MS / 60000))       // DO NOT CHANGE - time in minutes
-#define MIN_BLOCK_TIME              ((float)(MIN_BLOCK_MS / 60000))         // DO NOT CHANGE - time in minutes
+#define NOM_SEGMENT_TIME_MAX        ((float)(NOM_SEGMENT_MS_MAX / 60000))   // DO NOT CHANGE - time in minutes
+#define NOM_SEGMENT_TIME            (mp_seg.nom_segment_time)               // runtime - see mp_set_segment_ms()
+#define NOM_SEGMENT_USEC            (mp_seg.nom_segment_usec)               // runtime - see mp_set_segment_ms()
+#define MIN_SEGMENT_TIME            (mp_seg.min_segment_time)               // runtime - see mp_set_segment_ms()
+#define MIN_BLOCK_TIME              (mp_seg.min_block_time)                 // runtime - see mp_set_segment_ms()
 #define PHAT_CITY_TIME              ((float)(PHAT_CITY_MS / 60000))         // DO NOT CHANGE - time in minutes
 
 #define FEED_OVERRIDE_ENABLE        false               // initial value
@@ -258,8 +322,14 @@ typedef enum {                      // code blocks for planning and trapezoid ge
 #define TRAVERSE_OVERRIDE_ENABLE    false               // initial value
 #define TRAVERSE_OVERRIDE_MIN       (0.05)              // 5% minimum
 #define TRAVERSE_OVERRIDE_MAX       (1.00)              // 100% maximum
+#define TRAVERSE_OVERRIDE_RAMP_TIME (0.500/60)          // ramp time for traverse overrides
 #define TRAVERSE_OVERRIDE_FACTOR    (1.00)              // initial value
 
+#define SHAPER_AXES                 3                   // X, Y and Z can be input shaped
+#define SHAPER_FREQUENCY_MIN        (20.0)              // Hz - lower takes more history than is kept
+#define SHAPER_FREQUENCY_MAX        (500.0)             // Hz
+#define SHAPER_DAMPING_MAX          (0.5)               // damping ratio
+
 //// Specialized equalities for comparing velocities with tolerances
 //// These determine allowable velocity discontinuities between blocks (among other tests)
 //// RG: Simulation shows +-0.001 is about as much as we should allow.
@@ -273,6 +343,16 @@ typedef enum {                      // code blocks for planning and trapezoid ge
 #define Veq2_lo 1.0
 #define VELOCITY_ROUGHLY_EQ(v0,v1) ( (v0 > Vthr2) ? fabs(v0-v1) < Veq2_hi : fabs(v0-v1) < Veq2_lo )
 
+/* Segment velocity evaluator
+ *
+ *  By default head and tail segment velocities are generated by forward differencing the
+ *  quintic velocity curve (see plan_exec.cpp). Defining __DIRECT_VELOCITY evaluates the curve
+ *  at each segment midpoint instead - a fixed dozen or so float operations per segment,
+ *  with no error carried from one segment to the next.
+ */
+
+//#define __DIRECT_VELOCITY       // uncomment to evaluate segment velocity directly
+
 /* Planner Diagnostics */
 
 //#define __PLANNER_DIAGNOSTICS   // comment this out to drop diagnostics
@@ -311,7 +391,86 @@ typedef enum {                      // code blocks for planning and trapezoid ge
 
 //**** Planner Queue Structures ****
 
-typedef struct mpBuffer {
+/*
+ *  Native arc geometry
+ *
+ *  An arc that can be planned as a single block carries the helix it runs on, parameterized
+ *  by path length s from the start of the block (0 <= s <= bf->length). Theta follows the
+ *  convention in _compute_arc(): radians from plane axis 1 toward plane axis 0. The block is
+ *  otherwise an ordinary BLOCK_TYPE_ALINE and is planned, held and overridden like a line.
+ */
+typedef struct mpArc {
+    float center_0;                     // center of circle at plane axis 0 (e.g. X for G17)
+    float center_1;                     // center of circle at plane axis 1 (e.g. Y for G17)
+    float radius;                       // arc radius in mm
+    float theta;                        // angle at s == 0
+    float theta_per_mm;                 // angular travel per mm of path. Positive is CW
+    float linear_start;                 // linear axis position at s == 0
+    float linear_per_mm;                // linear axis travel per mm of path (helix)
+    uint8_t plane_axis_0;               // arc plane axis 0
+    uint8_t plane_axis_1;               // arc plane axis 1
+    uint8_t linear_axis;                // axis normal to the arc plane
+} mpArc_t;
+
+/*
+ *  Native spline geometry
+ *
+ *  A G5 or G5.1 spline is queued as a single block carrying its cubic Bezier control points
+ *  in XYZ (after rotation). The exec needs the curve by path length s, which a Bezier doesn't
+ *  have in closed form, so the planner tabulates the path length at SPLINE_KNOTS even steps
+ *  of the curve parameter. mp_spline_point() interpolates that table and corrects the result
+ *  with a Newton step. A hold that restarts the block moves s_start rather than the curve.
+ */
+#define SPLINE_KNOTS 8                  // path length table entries
+
+typedef struct mpSpline {
+    float p[4][3];                      // control points P0 (start) to P3 (end) in X, Y, Z
+    float knot_s[SPLINE_KNOTS];         // path length from P0 to curve parameter (k+1)/SPLINE_KNOTS
+    float s_start;                      // path length of the curve before s == 0
+} mpSpline_t;
+
+/*
+ *  Raster scanlines
+ *
+ *  A raster block is a straight BLOCK_TYPE_ALINE that carries a scanline of laser intensities
+ *  (0-255, scaling the current S). The pixels are spread evenly over the length of the block
+ *  and are applied per segment by the stepper loader, so one planner buffer covers a whole
+ *  scanline. The pixel data lives in a small FIFO of lines (RASTER_LINES) rather than in every
+ *  planner buffer; lines are taken in queue order and released when their block is freed.
+ *  The block is planned like any line, so it accelerates and decelerates at its ends. Hosts
+ *  add overscan moves if they want the pixels to run at constant velocity.
+ */
+#define RASTER_LINES 4                  // scanlines that can be queued at once
+#define RASTER_PIXELS_MAX 512           // pixels in one scanline
+
+typedef struct mpRasterLine {
+    uint16_t count;                     // pixels in the line
+    uint8_t pixel[RASTER_PIXELS_MAX];   // intensity per pixel, 0 - 255
+} mpRasterLine_t;
+
+typedef struct mpRaster {
+    mpRasterLine_t *line;               // pixel data for the block
+    float pixel_start;                  // pixel position at the start of the block
+    float pixels_per_mm;                // pixels per mm of path
+} mpRaster_t;
+
+/*
+ *  Synchronized outputs (M62, M63)
+ *
+ *  M62 Pn turns output n on and M63 Pn turns it off a distance Q into the next move (Q
+ *  defaults to 0, the start of the move). They don't take a planner buffer: the planner
+ *  collects them in bit masks, and the next motion block takes the masks when it is queued.
+ *  Exec hands them to the stepper prep with the segment that reaches the distance, and the
+ *  loader switches the outputs as that segment starts - so they land within a segment of
+ *  the distance. M62s and M63s ahead of the same move share one distance, the last Q given.
+ */
+typedef struct mpSyncOutput {
+    uint16_t set;                       // outputs to turn on - bit 0 is output 1
+    uint16_t clear;                     // outputs to turn off
+    float distance;                     // mm into the block to switch them
+} mpSyncOutput_t;
+
+typedef struct CACHE_ALIGNED mpBuffer {   // each buffer starts on a D-cache line (see util.h)
 
     // *** CAUTION *** These two pointers are not reset by _clear_buffer()
     struct mpBuffer *pv;                // static pointer to previous buffer
@@ -319,7 +478,10 @@ typedef struct mpBuffer {
     uint8_t buffer_number;              // DIAGNOSTIC for easier debugging
 
     stat_t (*bf_func)(struct mpBuffer *bf); // callback to buffer exec function
-    cm_exec_t cm_func;                  // callback to canonical machine execution function
+    union {
+        cm_exec_t cm_func;              // callback to canonical machine execution function
+        cm_wait_t wait_func;            // ...or condition polled by a queued wait
+    };
 
 #ifdef __PLANNER_DIAGNOSTICS
     uint32_t linenum;                   // mirror of bf->gm.linenum
@@ -329,6 +491,9 @@ typedef struct mpBuffer {
     float plannable_length;             // length in planner
     uint8_t meet_iterations;            // iterations needed in _get_meet_velocity
 #endif
+#ifdef __LATENCY_TRACE
+    uint32_t latency_seq;               // latency record of the line that queued the block - see latency.h
+#endif
 
     bufferState buffer_state;           // used to manage queuing/dequeuing
     blockType block_type;               // used to dispatch to run routine
@@ -340,9 +505,16 @@ typedef struct mpBuffer {
     bool axis_flags[AXES];              // set true for axes participating in the move & for command parameters
 
     bool plannable;                     // set true when this block can be used for planning
+    bool converged;                     // set true once back-planning has settled this block's exit velocity
+    float merge_deviation;              // accumulated chordal deviation of G1s merged into this block
+    int32_t merged_linenum;             // line number of the last G1 merged into this block, 0 if none
+    float chord_deviation;              // joint space deviation of the line as one chord over {ktol:}, 0 if off - see _block_segment_time()
 
     float length;                       // total length of line or helix in mm
     float block_time;                   // computed move time for entire block (move)
+    bool arc_block;                     // true if the block runs on arc (see mp_arc())
+    bool spline_block;                  // true if the block runs on spline (see mp_spline())
+    bool raster_block;                  // true if the block is a scanline (see mp_raster())
     float override_factor;              // feed rate or rapid override factor for this block ("override" is a reserved word)
 
     // *** SEE NOTES ON THESE VARIABLES, in aline() ***
@@ -362,6 +534,8 @@ typedef struct mpBuffer {
     // between the NEXT BLOCK AND THIS ONE
 
     float jerk;                         // maximum linear jerk term for this move
+    float axis_jerk;                    // jerk allowed by the axis jerk limits, before any acceleration limit
+    float accel;                        // maximum linear acceleration allowed by the axis limits, 0 if none
     float jerk_sq;                      // Jm^2 is used for planning (computed and cached)
     float recip_jerk;                   // 1/Jm used for planning (computed and cached)
     float sqrt_j;                       // sqrt(jM) used for planning (computed and cached)
@@ -369,6 +543,15 @@ typedef struct mpBuffer {
 
     GCodeState_t gm;                    // Gcode model state - passed from model, used by planner and runtime
 
+    // The arc and scanline data are large and only read when the block starts to run, so they go
+    // last to keep the fields the planner walks the queue for in the first cache lines of the buffer
+    union {
+        mpArc_t arc;                    // arc geometry - only valid if arc_block is true
+        mpSpline_t spline;              // spline geometry - only valid if spline_block is true
+    };
+    mpRaster_t raster;                  // scanline pixels - only valid if raster_block is true
+    mpSyncOutput_t sync_out;            // outputs switched part way into the block (M62, M63)
+
     // clears the above structure
     void reset() {
         bf_func = nullptr;
@@ -381,6 +564,9 @@ typedef struct mpBuffer {
         plannable_time_ms = 0;
         plannable_length = 0;
         meet_iterations = 0;
+#endif
+#ifdef __LATENCY_TRACE
+        latency_seq = 0;
 #endif
         buffer_state = MP_BUFFER_EMPTY;
         block_type = BLOCK_TYPE_NULL;
@@ -392,8 +578,14 @@ typedef struct mpBuffer {
             axis_flags[i] = 0;
         }
         plannable = false;
+        converged = false;
+        merge_deviation = 0.0;
+        merged_linenum = 0;
         length = 0.0;
         block_time = 0.0;
+        arc_block = false;
+        spline_block = false;
+        raster_block = false;
         override_factor = 0.0;
         cruise_velocity = 0.0;
         exit_velocity = 0.0;
@@ -403,10 +595,13 @@ typedef struct mpBuffer {
         absolute_vmax = 0.0;
         junction_vmax = 0.0;
         jerk = 0.0;
+        axis_jerk = 0.0;
+        accel = 0.0;
         jerk_sq = 0.0;
         recip_jerk = 0.0;
         sqrt_j = 0.0;
         q_recip_2_sqrt_j = 0.0;
+        sync_out = {};
         gm.reset();
     }
 } mpBuf_t;
@@ -436,8 +631,34 @@ typedef struct mpBlockRuntimeBuf {      // Data structure for just the parts of
 
     float cruise_velocity;              // velocity at the end of the head and the beginning of the tail
     float exit_velocity;                // velocity at the end of the move
+
+    bool head_run;                      // the head is a slice of an acceleration run - see mpAccelRun_t
+    float head_u0;                      // run curve parameter at the start of the head
+    float head_u1;                      // ...and at the end of the head
+    float head_v0;                      // velocity at the start of the run
+    float head_v1;                      // velocity at the end of the run
 } mpBlockRuntimeBuf_t;
 
+/*
+ *  Runtime snapshot - what the status report reads of the runtime, published by the exec at
+ *  the end of every segment so a report shows one segment rather than fields from several,
+ *  and reading a field is a copy rather than a computation. Two buffers and a sequence count:
+ *  the exec fills the one not being read and then bumps the count, so it never waits; a
+ *  reader copies the latest and tries again if a segment was published meanwhile.
+ *
+ *  The main loop also changes the runtime (G92, homing, offsets) with no segment running.
+ *  Those clear snapshot_valid and the readers take the live values until the next segment.
+ */
+typedef struct mpRuntimeSnapshot {
+    float position[AXES];               // machine position - mr->position
+    float display_offset[AXES];         // offsets in effect - mr->gm.display_offset
+    float velocity;                     // segment velocity (time scaled)
+    float feed_rate;                    // mr->gm.feed_rate
+    uint32_t linenum;                   // mr->gm.linenum
+    uint8_t units_mode;                 // mr->gm.units_mode
+    float following_error[MOTORS];      // mr->following_error, in steps
+} mpRuntimeSnapshot_t;
+
 typedef struct mpPlannerRuntime {       // persistent runtime variables
     //  uint8_t (*run_move)(struct mpMoveRuntimeSingleton *m); // currently running move - left in for reference
     magic_t magic_start;                // magic number to test memory integrity
@@ -454,9 +675,26 @@ typedef struct mpPlannerRuntime {       // persistent runtime variables
     float position[AXES];               // current move position
     float waypoint[SECTIONS][AXES];     // head/body/tail endpoints for correction
 
+    bool arc_block;                     // true if the running block is an arc
+    bool spline_block;                  // true if the running block is a spline
+    union {
+        mpArc_t arc;                    // copy of the running block's arc geometry
+        mpSpline_t spline;              // ...or spline geometry
+    };
+    float arc_length;                   // path length of the arc or spline block when it was started
+    float arc_s;                        // path length run so far in the arc or spline block
+    float line_start[AXES];             // position at the start of a linear block
+    int64_t line_s;                     // path length run so far in a linear block, in 1/MP_LINE_S_PER_MM mm
+
+    bool raster_block;                  // true if the running block is a scanline
+    mpRaster_t raster;                  // copy of the running block's scanline reference
+    float raster_s;                     // path length run so far in the raster block
+    float velocity_sync_vmax;           // velocity for full velocity-synced spindle power, 0 for traverses
+    mpSyncOutput_t sync_out;            // outputs of the running block not switched yet
+
     float target_steps[MOTORS];         // current MR target (absolute target as steps)
     float position_steps[MOTORS];       // current MR position (target from previous segment)
-    float commanded_steps[MOTORS];      // will align with next encoder sample (target from 2nd previous segment)
+    float commanded_steps[MOTORS];      // target of the last segment the steppers finished (aligns with encoder_steps)
     float encoder_steps[MOTORS];        // encoder position in steps - ideally the same as commanded_steps
     float following_error[MOTORS];      // difference between encoder_steps and commanded steps
 
@@ -473,15 +711,35 @@ typedef struct mpPlannerRuntime {       // persistent runtime variables
     uint32_t segment_count;             // count of running segments
     float segment_velocity;             // computed velocity for aline segment
     float segment_time;                 // actual time increment per aline segment
+    float block_segment_time;           // nominal segment time of the running block - see _block_segment_time()
+    float block_segment_usec;           // ...and in microseconds
+    float segment_scale;                // time scale of the segment - real velocity over planned velocity
+    bool section_scaled;                // section is being run time-scaled - see _exec_scaled_segment()
+    float section_tau;                  // planned time of the section run so far, when time-scaled
+    bool shaper_settling;               // block has ended at rest and is settling the shaper and advance
+    uint8_t advance_axis;               // extruder axis carrying the pressure advance
+    float advance_k;                    // pressure advance of the block, seconds - 0 if it doesn't extrude
+    float advance;                      // extruder offset now in the steps, in mm - see _exec_pressure_advance()
 
     float forward_diff_1;               // forward difference level 1
     float forward_diff_2;               // forward difference level 2
     float forward_diff_3;               // forward difference level 3
     float forward_diff_4;               // forward difference level 4
     float forward_diff_5;               // forward difference level 5
+#ifdef __DIRECT_VELOCITY
+    float velocity_start;               // velocity at the start of the head or tail
+    float velocity_delta;               // velocity change across the head or tail
+    float velocity_u0;                  // curve parameter at the start of the section (0 unless a run slice)
+    float velocity_w;                   // curve parameter span of the section (1 unless a run slice)
+    float segment_h;                    // 1/segments - parametric step per segment
+#endif
 
     GCodeState_t gm;                    // gcode model state currently executing
 
+    mpRuntimeSnapshot_t snapshot[2];    // see mp_publish_runtime_snapshot()
+    volatile uint32_t snapshot_seq;     // snapshot[snapshot_seq & 1] is the latest
+    volatile bool snapshot_valid;       // false once the main loop has changed the runtime under it
+
     magic_t magic_end;
 
    // resets mpPlannerRuntime structure without actually wiping it
@@ -492,10 +750,38 @@ typedef struct mpPlannerRuntime {       // persistent runtime variables
         entry_velocity = 0;             // needed to ensure next block in forward planning starts from 0 velocity
         r->exit_velocity = 0;           // ditto
         segment_velocity = 0;
+        segment_scale = 1.0;
+        section_scaled = false;
+        shaper_settling = false;
+        advance_k = 0;
+        advance = 0;
+        snapshot_valid = false;
     }
 
 } mpPlannerRuntime_t;
 
+//**** Override ramp - one each for feed (G1, arcs) and traverse (G0) blocks ***
+
+typedef struct mpOverrideRamp {
+    bool active;                        // true when a ramp is occurring
+    float factor;                       // override factor given to the next block of this kind
+    float target;                       // factor the ramp ends on
+    float dvdt;                         // factor change per minute of block time
+} mpOverrideRamp_t;
+
+//**** Acceleration run - one S-curve head spread over several short blocks ({plr:1}) ***
+
+typedef struct mpAccelRun {
+    mpBuf_t *next;                      // block the run carries on into, or NULL if no run is open
+    float v_0;                          // velocity at the start of the run
+    float v_1;                          // velocity at the end of the run
+    float v_entry;                      // velocity the next block must enter at
+    float time;                         // time of the whole run
+    float length;                       // length of the whole run
+    float u;                            // curve parameter where the next block starts
+    float s;                            // distance from the start of the run to the next block
+} mpAccelRun_t;
+
 //**** Master Planner Structure ***
 
 typedef struct mpPlanner {              // common variables for a planner context
@@ -516,17 +802,18 @@ typedef struct mpPlanner {              // common variables for a planner contex
     plannerState planner_state;         // current state of planner
     bool request_planning;              // set true to request backplanning
     bool backplanning;                  // true if planner is in a back-planning pass
-    bool mfo_active;                    // true if mfo override is in effect
-    bool ramp_active;                   // true when a ramp is occurring
     bool entry_changed;                 // mark if exit_velocity changed to invalidate next block's hint
+    mpAccelRun_t run;                   // acceleration run being forward planned
 
-    // feed overrides and ramp variables (these extend the variables in cm->gmx)
-    float mfo_factor;                   // runtime override factor
-    float ramp_target;
-    float ramp_dvdt;
+    // feed and traverse overrides (these extend the variables in cm->gmx)
+    mpOverrideRamp_t mfo;               // feed override ramp
+    mpOverrideRamp_t mto;               // traverse override ramp
+    mpSyncOutput_t sync_out;            // M62/M63 outputs waiting for the next motion block
 
     // objects
     Timeout block_timeout;              // Timeout object for block planning
+    uint32_t block_arrival_ms;          // SysTick of the last block - see mp_block_arrived()
+    float block_interval_ms;            // smoothed ms between blocks, BLOCK_TIMEOUT_MS when not streaming
 
     // planner pointers
     mpBuf_t *p;                         // planner buffer pointer
@@ -544,15 +831,80 @@ typedef struct mpPlanner {              // common variables for a planner contex
         planner_state = PLANNER_IDLE;
         request_planning = false;
         backplanning = false;
-        mfo_active = false;
-        ramp_active = false;
+        mfo.active = false;
+        mto.active = false;
         entry_changed = false;
+        run.next = NULL;
         block_timeout.clear();
+        block_interval_ms = BLOCK_TIMEOUT_MS;
+        sync_out = {};
     }
 } mpPlanner_t;
 
+/*
+ *  Segment timing is a runtime setting ({seg:}) so boards with cycles to spare can run shorter
+ *  segments. MIN_SEGMENT_MS is the upper limit, as DDA_SUBSTEPS is sized for NOM_SEGMENT_TIME_MAX.
+ *  The nominal segment and minimum block are both twice the minimum segment, as before.
+ */
+typedef struct mpSegmentTiming {        // runtime segment timing
+    float min_segment_ms;               // minimum segment milliseconds ({seg:})
+    float min_segment_time;             // minimum segment time in minutes
+    float nom_segment_time;             // nominal segment time in minutes
+    float nom_segment_usec;             // nominal segment time in microseconds
+    float min_block_time;               // minimum block (whole move) time in minutes
+    uint32_t exec_cycles_max;           // worst case measured mp_exec_move() + st_prep_line() in CPU cycles
+    uint32_t exec_cycles_budget;        // exec_cycles_max above this re-clamps min_segment_ms when idle
+} mpSegmentTiming_t;
+
+/*
+ *  Velocity jog - the exec follows a commanded velocity vector directly, without queuing blocks.
+ *  Each axis ramps to its target at that axis' max jerk. The host feeds targets through the
+ *  jgv group (see cycle_jogging.cpp); if it stops feeding for VELOCITY_JOG_WATCHDOG_MS the
+ *  exec ramps every axis to zero and the jog ends.
+ */
+#ifndef VELOCITY_JOG_WATCHDOG_MS
+#define VELOCITY_JOG_WATCHDOG_MS    250     // ms without a velocity command before the jog is stopped
+#endif
+
+typedef struct mpVelocityJog {
+    volatile bool active;               // exec is running the velocity jog instead of the queue
+    volatile uint32_t fed_tick;         // SysTick of the latest velocity command
+    volatile float target[AXES];        // commanded velocity per axis in mm/min
+    float velocity[AXES];               // current velocity per axis (exec only)
+    float accel[AXES];                  // current acceleration per axis (exec only)
+} mpVelocityJog_t;
+
+/*
+ *  Planner health - how the queue looks to the exec as each block starts, so a job can be
+ *  told apart as line-rate bound (a thin queue, starvations) or planner bound (a full queue
+ *  but little plannable time, forward plans missing their deadline). Read as {ph:n}; setting
+ *  any of the counters clears them all.
+ *
+ *    phb0-phb7  blocks started with buffers_available in each eighth of the queue (phb0 = full queue)
+ *    pht0-pht7  blocks started with plannable_time_ms under 5, 10, 20, 50, 100, 200, 500 ms, and over
+ *    phs        starvation events - the exec ran out of blocks in a cycle (one per dry spell)
+ *    phm        forward-plan deadline misses - a block was due to start but not yet forward planned
+ *    phk        blocks started
+ */
+#define MP_HEALTH_BINS 8
+
+typedef struct mpHealth {
+    uint32_t buffers[MP_HEALTH_BINS];   // buffers_available histogram
+    uint32_t plannable[MP_HEALTH_BINS]; // plannable_time_ms histogram
+    uint32_t starvations;               // starvation events
+    uint32_t plan_misses;               // forward-plan deadline misses
+    uint32_t blocks;                    // blocks started (samples)
+    bool starving;                      // in a dry spell - counts once until the next block starts
+    bool plan_missed;                   // the pending block has been counted as a miss
+} mpHealth_t;
+
 // Reference global scope structures
 
+extern mpHealth_t mp_health;            // planner health counters
+
+extern mpSegmentTiming_t mp_seg;        // runtime segment timing
+extern mpVelocityJog_t mp_vjog;         // velocity jog runtime
+
 extern mpPlanner_t *mp;                 // currently active planner (global variable)
 extern mpPlanner_t mp1;                 // primary planning context
 extern mpPlanner_t mp2;                 // secondary planning context
@@ -586,6 +938,8 @@ stat_t mp_runtime_command(mpBuf_t *bf);
 stat_t mp_json_command(char *json_string);
 stat_t mp_json_command_immediate(char *json_string);
 stat_t mp_json_wait(char *json_string);
+void mp_queue_wait(cm_wait_t wait_func, const float *value);
+void mp_sync_output(const uint8_t output_num, const bool on, const float distance);
 
 stat_t mp_dwell(const float seconds);
 void mp_end_dwell(void);
@@ -594,16 +948,28 @@ void mp_request_out_of_band_dwell(float seconds);
 //**** planner functions and helpers
 uint8_t mp_get_planner_buffers(const mpPlanner_t *_mp);
 bool mp_planner_is_full(const mpPlanner_t *_mp);
+bool mp_planner_is_time_full(const mpPlanner_t *_mp);
+float mp_get_planned_time(const mpPlanner_t *_mp);
 bool mp_has_runnable_buffer(const mpPlanner_t *_mp);
 bool mp_is_phat_city_time(void);
+float mp_set_segment_ms(float segment_ms);
+float mp_get_exec_usec_max(void);
 
 stat_t mp_planner_callback();
 void mp_replan_queue(mpBuf_t *bf);
 void mp_start_feed_override(const float ramp_time, const float override);
 void mp_end_feed_override(const float ramp_time);
+void mp_relink_feed_override(const float ramp_time);
 void mp_start_traverse_override(const float ramp_time, const float override);
 void mp_end_traverse_override(const float ramp_time);
+void mp_reset_overrides(void);
+void mp_set_time_scale(const float scale);
+void mp_reset_time_scale(void);
 void mp_planner_time_accounting(void);
+float mp_get_queue_time(void);
+void mp_health_block_start(void);
+void mp_health_starved(void);
+void mp_health_plan_missed(void);
 
 //**** planner buffer primitives
 //void mp_init_planner_buffers(void);
@@ -619,19 +985,38 @@ mpBuf_t * mp_get_r(void);
 
 mpBuf_t * mp_get_write_buffer(void);
 void mp_commit_write_buffer(const blockType block_type);
+void mp_block_arrived(void);
 mpBuf_t * mp_get_run_buffer(void);
 bool mp_free_run_buffer(void);
 
+mpRasterLine_t * mp_get_raster_line(void);
+void mp_take_raster_line(void);
+uint8_t mp_get_raster_pixel(const mpRaster_t *raster, const float s);
+
 //**** plan_line.c functions
 void mp_zero_segment_velocity(void);                    // getters and setters...
 float mp_get_runtime_velocity(void);
 float mp_get_runtime_absolute_position(mpPlannerRuntime_t *_mr, uint8_t axis);
 float mp_get_runtime_display_position(uint8_t axis);
 void mp_set_runtime_display_offset(float offset[]);
+void mp_publish_runtime_snapshot(void);
+const mpRuntimeSnapshot_t *mp_get_runtime_snapshot(void);
+void mp_hold_runtime_snapshot(const bool hold);
+float mp_get_snapshot_display_position(const mpRuntimeSnapshot_t *s, const uint8_t axis);
+stat_t mp_get_fe(nvObj_t *nv);
 bool mp_get_runtime_busy(void);
 bool mp_runtime_is_idle(void);
 
 stat_t mp_aline(GCodeState_t *_gm);                   // line planning...
+stat_t mp_merge_aline(GCodeState_t *_gm);             // merge a collinear G1 into the newest block
+stat_t mp_blend_corner(GCodeState_t *_gm);            // G64 P corner blending ahead of a new move
+stat_t mp_arc(const GCodeState_t *_gm, const mpArc_t *arc, const float length);  // queue a native arc
+void mp_arc_point(const mpArc_t *arc, const float s, float point[]);
+void mp_arc_tangent(const mpArc_t *arc, const float s, float unit[]);
+stat_t mp_spline(const GCodeState_t *_gm, const float control[4][3]);   // queue a cubic spline
+void mp_spline_point(const mpSpline_t *spline, const float s, float point[]);
+void mp_spline_tangent(const mpSpline_t *spline, const float s, float unit[]);
+stat_t mp_raster(GCodeState_t *_gm, mpRasterLine_t *line);  // queue a scanline
 void mp_plan_block_list(void);
 void mp_plan_block_forward(mpBuf_t *bf);
 
@@ -647,12 +1032,38 @@ float mp_calc_a(const float t, const float v_0, const float v_1, const float T);
 float mp_calc_j(const float t, const float v_0, const float v_1, const float T); // compute jerk over curve accelerating from v_0 to v_1, at position t=[0,1], total time T
 //float mp_calc_l(const float t, const float v_0, const float v_1, const float T); // compute length over curve accelerating from v_0 to v_1, at position t=[0,1], total time T
 
+//**** plan_shaper.cpp functions
+void mp_shaper_configure(const uint8_t axis, const uint8_t type, const float frequency, const float damping);
+void mp_shaper_reset(void);
+bool mp_shaper_active(void);
+const float *mp_shaper_shape(const float position[], const float target[], const float dt);
+const float *mp_shaper_settle(const float target[], const float dt);
+
 //**** plan_exec.c functions
 stat_t mp_forward_plan(void);
 stat_t mp_exec_move(void);
 stat_t mp_exec_aline(mpBuf_t *bf);
+void mp_hold_sync_output(mpBuf_t *bf);
 void mp_exit_hold_state(void);
+void mp_velocity_jog_start(void);
 
 void mp_dump_planner(mpBuf_t *bf_start);
 
+//**** planner health - see mpHealth
+stat_t mp_set_ph(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void mp_print_phb(nvObj_t *nv);
+    void mp_print_pht(nvObj_t *nv);
+    void mp_print_phs(nvObj_t *nv);
+    void mp_print_phm(nvObj_t *nv);
+    void mp_print_phk(nvObj_t *nv);
+#else
+    #define mp_print_phb tx_print_stub
+    #define mp_print_pht tx_print_stub
+    #define mp_print_phs tx_print_stub
+    #define mp_print_phm tx_print_stub
+    #define mp_print_phk tx_print_stub
+#endif // __TEXT_MODE
+
 #endif    // End of include Guard: PLANNER_H_ONCE
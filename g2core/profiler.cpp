@@ -0,0 +1,86 @@
+/*
+ * profiler.cpp - cycle-count profiler for main loop dispatches and ISRs
+ * This file is part of g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "controller.h"
+#include "profiler.h"
+#include "util.h"
+#include "xio.h"
+
+#ifdef __PROFILER
+
+profStats_t prof[PROF_PROBES];
+
+/*
+ * profiler_init() - clear all probes and start the cycle counter
+ */
+
+void profiler_init()
+{
+    memset(&prof, 0, sizeof(prof));
+    cycle_counter_init();
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * prof_get()   - return [min,max,mean] cycles for the probe in the cfgArray target
+ * prof_set()   - clear the probe
+ * prof_print() - print the probe in text mode
+ */
+
+stat_t prof_get(nvObj_t *nv)
+{
+    profStats_t *p = (profStats_t *)GET_TABLE_WORD(target);
+    uint32_t mean = (p->count == 0) ? 0 : (uint32_t)(p->total / p->count);
+    char buf[36];
+
+    sprintf(buf, "%lu,%lu,%lu", (unsigned long)p->min, (unsigned long)p->max, (unsigned long)mean);
+    ritorno(nv_copy_string(nv, buf));
+    nv->valuetype = TYPE_ARRAY;
+    return (STAT_OK);
+}
+
+stat_t prof_set(nvObj_t *nv)
+{
+    memset((profStats_t *)GET_TABLE_WORD(target), 0, sizeof(profStats_t));
+    return (STAT_OK);
+}
+
+static const char fmt_prof[] = "[%s] cycles min,max,mean %s\n";
+
+void prof_print(nvObj_t *nv)
+{
+    sprintf(cs.out_buf, fmt_prof, nv->token, *nv->stringp);
+    xio_writeline(cs.out_buf);
+}
+
+#endif  // __PROFILER
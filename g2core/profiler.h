@@ -0,0 +1,112 @@
+/*
+ * profiler.h - cycle-count profiler for main loop dispatches and ISRs
+ * This file is part of g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * PROFILER
+ *
+ *  An instrumentation build (define __PROFILER in g2core.h) that records the min, max and
+ *  mean CPU cycle count of every DISPATCH() in _controller_HSM() and of the stepper ISRs,
+ *  using the DWT cycle counter. It is meant for finding what delays _dispatch_command()
+ *  or eats into the segment budget, and compiles to nothing when __PROFILER is not defined.
+ *
+ *  Results are read as the {prof:n} group. Each member is an array of [min,max,mean] cycles:
+ *
+ *    prof00 - prof25   DISPATCH() entries in the order they appear in _controller_HSM()
+ *    profdd            DDA ISR, including any _load_move() it triggers
+ *    profld            _load_move() (from the DDA ISR or st_request_load_move())
+ *    profex            exec ISR - mp_exec_move() + st_prep_line()
+ *    proffp            forward planning ISR
+ *    profki            inverse kinematics transform (once per segment)
+ *    profkf            forward kinematics transform
+ *    profmr            marlin_response() - one Marlin "ok" / "Error:" line (Marlin builds)
+ *    profpl            st_prep_line() - one segment
+ *    profrm            mp_calculate_ramps() - one block
+ *
+ *  Writing any member clears it, e.g. {prof00:0}. The Marlin callback only exists in Marlin
+ *  builds, so dispatch numbers after it shift down by one when MARLIN_COMPAT_ENABLED is false.
+ *  The same goes for the binary motion callback and BINARY_MOTION_ENABLED, and for the
+ *  benchmark callback and __BENCHMARK.
+ *  Cycle counts include any higher priority ISRs that preempt the one being measured.
+ *  To see what RAMFUNC_HOT_PATHS buys on a SAM3X board (see HOT_PATH in g2core.h), run the
+ *  same job on builds with and without it and compare profdd, profld, profex, profpl, profrm.
+ */
+
+#ifndef PROFILER_H_ONCE
+#define PROFILER_H_ONCE
+
+#ifdef __PROFILER
+
+#include "util.h"
+
+#define PROF_DISPATCH_MAX 32            // must be at least the number of DISPATCH() calls
+
+typedef enum {
+    PROF_DISPATCH = 0,                  // first of PROF_DISPATCH_MAX dispatch probes
+    PROF_DDA_ISR = PROF_DISPATCH_MAX,
+    PROF_LOAD,
+    PROF_EXEC_ISR,
+    PROF_FWD_PLAN_ISR,
+    PROF_KIN_INVERSE,
+    PROF_KIN_FORWARD,
+    PROF_MARLIN_RESPONSE,
+    PROF_PREP,
+    PROF_RAMPS,
+    PROF_PROBES                         // count of probes
+} profProbe;
+
+typedef struct profStats {
+    uint32_t min;                       // fewest cycles seen
+    uint32_t max;                       // most cycles seen
+    uint32_t count;                     // number of samples
+    uint64_t total;                     // sum of samples, for the mean
+} profStats_t;
+
+extern profStats_t prof[PROF_PROBES];
+
+inline void prof_record(const uint8_t probe, const uint32_t cycles) {
+    profStats_t *p = &prof[probe];
+    if ((cycles < p->min) || (p->count == 0)) { p->min = cycles; }
+    if (cycles > p->max) { p->max = cycles; }
+    p->count++;
+    p->total += cycles;
+}
+
+#define PROF_BEGIN(t) uint32_t t = cycle_count()
+#define PROF_END(t, probe) prof_record(probe, cycle_count() - t)
+
+void profiler_init(void);
+stat_t prof_get(nvObj_t *nv);
+stat_t prof_set(nvObj_t *nv);
+void prof_print(nvObj_t *nv);
+
+#else
+
+#define PROF_BEGIN(t)
+#define PROF_END(t, probe)
+
+#endif  // __PROFILER
+
+#endif  // End of include guard: PROFILER_H_ONCE
@@ -0,0 +1,189 @@
+/*
+ * pso.cpp - position synchronized output
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "pso.h"
+#include "canonical_machine.h"
+#include "stepper.h"
+#include "gpio.h"
+#include "text_parser.h"
+#include "util.h"
+
+psoSingleton_t pso;
+
+/*
+ * pso_reset() - drop the output and clear the accumulator - called by stepper_reset()
+ */
+
+void pso_reset()
+{
+    pso.increment = 0;
+    pso.accumulator = 0;
+    pso.pulse_downcount = 0;
+    pso.level = false;
+    if (pso.output) {
+        gpio_set_output(pso.output-1, 0);
+    }
+}
+
+static stat_t _pso_restart()                    // after a config change
+{
+    pso_reset();
+    pso.count = 0;
+    return (STAT_OK);
+}
+
+/*
+ * pso_path_length()    - mm of path from position to target on the PSO axes, 0 if PSO is off
+ * pso_tick_increment() - fraction of the interval per DDA tick for a segment, scaled to 2^32
+ * pso_pulse_ticks()    - DDA ticks in a pulse at FREQUENCY_DDA / dda_divisor
+ */
+
+float pso_path_length(const float position[], const float target[])
+{
+    if (pso.output == 0) {
+        return (0);
+    }
+    float length = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if (pso.axes & (1 << axis)) {
+            length += square(target[axis] - position[axis]);
+        }
+    }
+    return (sqrt(length));
+}
+
+uint32_t pso_tick_increment(const float length, const uint32_t dda_ticks)
+{
+    if ((length <= 0) || (dda_ticks == 0)) {
+        return (0);
+    }
+    float increment = (length / pso.interval) / dda_ticks * 4294967296.0;
+    if (increment >= 4294967295.0) {            // more than one firing per tick fires once
+        return (0xFFFFFFFF);
+    }
+    return ((uint32_t)increment);
+}
+
+uint32_t pso_pulse_ticks(const uint32_t dda_divisor)
+{
+    uint32_t ticks = (uint32_t)(pso.pulse_width * FREQUENCY_DDA / (1000000.0 * dda_divisor));
+    return (max(ticks, (uint32_t)1));
+}
+
+/*
+ * pso_fire()      - fire the output - from the DDA ISR
+ * pso_end_pulse() - drop a pulse - from the DDA ISR, or when the DDA stops
+ */
+
+void pso_fire()
+{
+    pso.count++;
+    if (pso.mode == PSO_MODE_TOGGLE) {
+        pso.level = !pso.level;
+        gpio_set_output(pso.output-1, pso.level ? 1.0 : 0.0);
+        return;
+    }
+    gpio_set_output(pso.output-1, 1.0);
+    pso.pulse_downcount = pso.pulse_ticks;
+}
+
+void pso_end_pulse()
+{
+    pso.pulse_downcount = 0;
+    gpio_set_output(pso.output-1, 0);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+stat_t pso_get_psoi(nvObj_t *nv) { return (get_float(nv, pso.interval)); }
+stat_t pso_get_psoa(nvObj_t *nv) { return (get_integer(nv, pso.axes)); }
+stat_t pso_get_psoo(nvObj_t *nv) { return (get_integer(nv, pso.output)); }
+stat_t pso_get_psom(nvObj_t *nv) { return (get_integer(nv, pso.mode)); }
+stat_t pso_get_psow(nvObj_t *nv) { return (get_float(nv, pso.pulse_width)); }
+stat_t pso_get_psoc(nvObj_t *nv) { return (get_integer(nv, pso.count)); }
+
+stat_t pso_set_psoi(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, pso.interval, 0.001, 1000000));
+    return (_pso_restart());
+}
+
+stat_t pso_set_psoa(nvObj_t *nv)
+{
+    int32_t axes;
+    ritorno(set_int32(nv, axes, 0, (1 << AXES) - 1));
+    pso.axes = axes;
+    return (_pso_restart());
+}
+
+stat_t pso_set_psoo(nvObj_t *nv)
+{
+    int32_t output;
+    ritorno(set_int32(nv, output, 0, D_OUT_CHANNELS));
+    pso_reset();                                // drop the old output before moving to the new one
+    pso.output = output;
+    return (_pso_restart());
+}
+
+stat_t pso_set_psom(nvObj_t *nv)
+{
+    int32_t mode;
+    ritorno(set_int32(nv, mode, 0, PSO_MODE_MAX));
+    pso.mode = mode;
+    return (_pso_restart());
+}
+
+stat_t pso_set_psow(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, pso.pulse_width, 0, 100000));
+    return (_pso_restart());
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char msg_units0[] = " in";    // used by generic print functions
+static const char msg_units1[] = " mm";
+static const char msg_units2[] = " deg";
+static const char *const msg_units[] = { msg_units0, msg_units1, msg_units2 };
+
+static const char fmt_psoi[] = "[psoi] PSO interval%18.3f%s\n";
+static const char fmt_psoa[] = "[psoa] PSO axes%22d [axis bit mask]\n";
+static const char fmt_psoo[] = "[psoo] PSO output%20d [0=off]\n";
+static const char fmt_psom[] = "[psom] PSO mode%22d [0=pulse,1=toggle]\n";
+static const char fmt_psow[] = "[psow] PSO pulse width%15.1f us\n";
+static const char fmt_psoc[] = "[psoc] PSO count%21d\n";
+
+void pso_print_psoi(nvObj_t *nv) { text_print_flt_units(nv, fmt_psoi, GET_UNITS(ACTIVE_MODEL));}
+void pso_print_psoa(nvObj_t *nv) { text_print(nv, fmt_psoa);}
+void pso_print_psoo(nvObj_t *nv) { text_print(nv, fmt_psoo);}
+void pso_print_psom(nvObj_t *nv) { text_print(nv, fmt_psom);}
+void pso_print_psow(nvObj_t *nv) { text_print(nv, fmt_psow);}
+void pso_print_psoc(nvObj_t *nv) { text_print(nv, fmt_psoc);}
+
+#endif // __TEXT_MODE
@@ -0,0 +1,123 @@
+/*
+ * pso.h - position synchronized output
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * POSITION SYNCHRONIZED OUTPUT (PSO)
+ *
+ *  PSO fires a digital output every {psoi:} mm of path - laser pulse-per-distance, line
+ *  scan camera triggers and the like. The path is measured on the axes in {psoa:} (a bit
+ *  mask, bit 0 = X), so XY travel can fire it while Z moves are ignored.
+ *
+ *  Exec measures each segment's path length on those axes (pso_path_length()). Prep turns
+ *  it into a fixed increment per DDA tick, as a fraction of the interval scaled to 2^32
+ *  (pso_tick_increment()), and the DDA ISR adds it to a 32 bit accumulator every tick. The
+ *  output fires when the accumulator wraps, so it lands within one DDA tick of the exact
+ *  distance, and the phase carries across segments and moves.
+ *
+ *  {psom:0} drives a pulse of {psow:} microseconds on each firing, {psom:1} toggles the
+ *  output instead. {psoo:} is the output number, 0 turns PSO off. {psoc:} counts firings
+ *  and is cleared by setting any of the PSO values.
+ */
+
+#ifndef PSO_H_ONCE
+#define PSO_H_ONCE
+
+#include "config.h"  // needed for nvObj_t definition
+
+typedef enum {
+    PSO_MODE_PULSE = 0,             // pulse the output for pulse_width
+    PSO_MODE_TOGGLE                 // toggle the output
+} psoMode;
+#define PSO_MODE_MAX PSO_MODE_TOGGLE
+
+typedef struct psoSingleton {
+    // config
+    float interval;                 // path length between firings, mm
+    uint32_t axes;                  // bit mask of the axes the path is measured on
+    uint8_t output;                 // output number, 0 = off
+    uint8_t mode;                   // psoMode
+    float pulse_width;              // pulse width, microseconds
+
+    // DDA ISR (HI)
+    uint32_t accumulator;           // fraction of the interval run so far, scaled to 2^32
+    uint32_t increment;             // fraction of the interval run per DDA tick, for this segment
+    uint32_t pulse_ticks;           // DDA ticks in a pulse, for this segment
+    uint32_t pulse_downcount;       // DDA ticks left in the pulse that is up
+    bool level;                     // output level in toggle mode
+    volatile uint32_t count;        // firings since the PSO values were last set
+} psoSingleton_t;
+
+extern psoSingleton_t pso;
+
+void pso_reset(void);
+float pso_path_length(const float position[], const float target[]);
+uint32_t pso_tick_increment(const float length, const uint32_t dda_ticks);
+uint32_t pso_pulse_ticks(const uint32_t dda_divisor);
+void pso_fire(void);
+void pso_end_pulse(void);
+
+/*
+ * pso_dda_tick() - advance the accumulator one DDA tick, and fire on a wrap
+ *
+ *  Called from the DDA ISR - keep it short. Nothing happens unless a segment with PSO
+ *  travel is running or a pulse is up.
+ */
+
+static inline void pso_dda_tick()
+{
+    if (pso.pulse_downcount && (--pso.pulse_downcount == 0)) {
+        pso_end_pulse();
+    }
+    if (pso.increment) {
+        const uint32_t before = pso.accumulator;
+        pso.accumulator += pso.increment;
+        if (pso.accumulator < before) {
+            pso_fire();
+        }
+    }
+}
+
+stat_t pso_get_psoi(nvObj_t *nv);
+stat_t pso_set_psoi(nvObj_t *nv);
+stat_t pso_get_psoa(nvObj_t *nv);
+stat_t pso_set_psoa(nvObj_t *nv);
+stat_t pso_get_psoo(nvObj_t *nv);
+stat_t pso_set_psoo(nvObj_t *nv);
+stat_t pso_get_psom(nvObj_t *nv);
+stat_t pso_set_psom(nvObj_t *nv);
+stat_t pso_get_psow(nvObj_t *nv);
+stat_t pso_set_psow(nvObj_t *nv);
+stat_t pso_get_psoc(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void pso_print_psoi(nvObj_t *nv);
+    void pso_print_psoa(nvObj_t *nv);
+    void pso_print_psoo(nvObj_t *nv);
+    void pso_print_psom(nvObj_t *nv);
+    void pso_print_psow(nvObj_t *nv);
+    void pso_print_psoc(nvObj_t *nv);
+#else
+    #define pso_print_psoi tx_print_stub
+    #define pso_print_psoa tx_print_stub
+    #define pso_print_psoo tx_print_stub
+    #define pso_print_psom tx_print_stub
+    #define pso_print_psow tx_print_stub
+    #define pso_print_psoc tx_print_stub
+#endif
+
+#endif  // End of include guard: PSO_H_ONCE
@@ -33,6 +33,7 @@
 #include "pwm.h"
 #include "canonical_machine.h"
 #include "settings.h"
+#include "util.h"
 
 /***** PWM defines, structures and memory allocation *****/
 
@@ -53,7 +54,14 @@ Motate::PWMOutputPin<Motate::kSpindle_Pwm2PinNumber> secondary_pwm_pin {Motate::
  *    - See system.h for timer and port assignments
  *  - Don't do this: memset(&TIMER_PWM1, 0, sizeof(PWM_TIMER_t)); // zero out the timer registers
  */
-void pwm_init() {}
+void pwm_init()
+{
+    for (uint8_t chan = 0; chan < PWMS; chan++) {
+        pwm.p[chan].frequency = 0;
+        pwm.p[chan].duty = -1;
+        pwm.p[chan].next_posted = false;
+    }
+}
 
 /*
  * pwm_set_freq() - set PWM channel frequency
@@ -63,13 +71,18 @@ void pwm_init() {}
  *
  *  Assumes 32MHz clock.
  *  Doesn't turn time on until duty cycle is set
+ *  Setting the frequency restarts the period, so an unchanged frequency is not written
  */
 
 stat_t pwm_set_freq(uint8_t chan, float freq)
 {
-    if (chan > PWMS) { return (STAT_NO_SUCH_DEVICE);}
+    if (chan >= PWMS) { return (STAT_NO_SUCH_DEVICE);}
     //if (freq < PWM_MIN_FREQ) { return (STAT_INPUT_LESS_THAN_MIN_VALUE);}
     //if (freq > PWM_MAX_FREQ) { return (STAT_INPUT_EXCEEDS_MAX_VALUE);}
+    if (freq == pwm.p[chan].frequency) {
+        return (STAT_OK);
+    }
+    pwm.p[chan].frequency = freq;
 
     if (chan == PWM_1) {
         spindle_pwm_pin.setFrequency(freq);
@@ -91,12 +104,22 @@ stat_t pwm_set_freq(uint8_t chan, float freq)
  *  Setting duty cycle between 0 and 100 enables PWM channel
  *
  *  The frequency must have been set previously
+ *
+ *  An unchanged duty cycle is not written. A direct set also drops any posted duty cycle,
+ *  so the last word is always the latest.
  */
 
 stat_t pwm_set_duty(uint8_t chan, float duty)
 {
     if (duty < 0.0) { return (STAT_INPUT_LESS_THAN_MIN_VALUE);}
     if (duty > 1.0) { return (STAT_INPUT_EXCEEDS_MAX_VALUE);}
+    if (chan >= PWMS) { return (STAT_NO_SUCH_DEVICE);}
+
+    pwm.p[chan].next_posted = false;
+    if (duty == pwm.p[chan].duty) {
+        return (STAT_OK);
+    }
+    pwm.p[chan].duty = duty;
 
     if (chan == PWM_1) {
 //        if (spindle_pwm_pin.isNull()) {
@@ -113,6 +136,37 @@ stat_t pwm_set_duty(uint8_t chan, float duty)
     return (STAT_OK);
 }
 
+/*
+ * pwm_post_duty() - post a duty cycle for the loader to apply as the next segment starts
+ * pwm_latch()     - apply posted duty cycles - called by the loader at each segment start
+ *
+ *  For duty cycles worked out in the exec (e.g. G96 from the segment's radius). The exec
+ *  runs ahead of the steppers, so writing the pin there changes the power before the
+ *  segment it was meant for. Posting is a store and a flag - no pin write at exec level -
+ *  and the loader writes the pin on the segment boundary. The exec is the only writer and
+ *  the loader the only reader, and the loader can preempt the exec but not the reverse,
+ *  so the slot needs no lock: the duty is stored before the flag is set, and at worst a
+ *  value is applied one segment later. Out of range values are clamped.
+ */
+
+void pwm_post_duty(uint8_t chan, float duty)
+{
+    if (chan >= PWMS) {
+        return;
+    }
+    pwm.p[chan].next_duty = min(max(duty, 0.0f), 1.0f);
+    pwm.p[chan].next_posted = true;
+}
+
+void pwm_latch()
+{
+    for (uint8_t chan = 0; chan < PWMS; chan++) {
+        if (pwm.p[chan].next_posted) {
+            pwm_set_duty(chan, pwm.p[chan].next_duty);    // also clears the slot
+        }
+    }
+}
+
 
 /***********************************************************************************
  * CONFIGURATION AND INTERFACE FUNCTIONS
@@ -148,6 +202,17 @@ static const char fmt_p1wpl[] = "[p1wpl] pwm ccw phase lo%15.3f [0..1]\n";
 static const char fmt_p1wph[] = "[p1wph] pwm ccw phase hi%15.3f [0..1]\n";
 static const char fmt_p1pof[] = "[p1pof] pwm phase off%18.3f [0..1]\n";
 
+static const char fmt_p2frq[] = "[p2frq] pwm frequency%18.0f Hz\n";
+static const char fmt_p2csl[] = "[p2csl] pwm cw speed lo%16.0f RPM\n";
+static const char fmt_p2csh[] = "[p2csh] pwm cw speed hi%16.0f RPM\n";
+static const char fmt_p2cpl[] = "[p2cpl] pwm cw phase lo%16.3f [0..1]\n";
+static const char fmt_p2cph[] = "[p2cph] pwm cw phase hi%16.3f [0..1]\n";
+static const char fmt_p2wsl[] = "[p2wsl] pwm ccw speed lo%15.0f RPM\n";
+static const char fmt_p2wsh[] = "[p2wsh] pwm ccw speed hi%15.0f RPM\n";
+static const char fmt_p2wpl[] = "[p2wpl] pwm ccw phase lo%15.3f [0..1]\n";
+static const char fmt_p2wph[] = "[p2wph] pwm ccw phase hi%15.3f [0..1]\n";
+static const char fmt_p2pof[] = "[p2pof] pwm phase off%18.3f [0..1]\n";
+
 void pwm_print_p1frq(nvObj_t *nv) { text_print(nv, fmt_p1frq);}     // all TYPE_FLOAT
 void pwm_print_p1csl(nvObj_t *nv) { text_print(nv, fmt_p1csl);}
 void pwm_print_p1csh(nvObj_t *nv) { text_print(nv, fmt_p1csh);}
@@ -159,4 +224,15 @@ void pwm_print_p1wpl(nvObj_t *nv) { text_print(nv, fmt_p1wpl);}
 void pwm_print_p1wph(nvObj_t *nv) { text_print(nv, fmt_p1wph);}
 void pwm_print_p1pof(nvObj_t *nv) { text_print(nv, fmt_p1pof);}
 
+void pwm_print_p2frq(nvObj_t *nv) { text_print(nv, fmt_p2frq);}     // all TYPE_FLOAT
+void pwm_print_p2csl(nvObj_t *nv) { text_print(nv, fmt_p2csl);}
+void pwm_print_p2csh(nvObj_t *nv) { text_print(nv, fmt_p2csh);}
+void pwm_print_p2cpl(nvObj_t *nv) { text_print(nv, fmt_p2cpl);}
+void pwm_print_p2cph(nvObj_t *nv) { text_print(nv, fmt_p2cph);}
+void pwm_print_p2wsl(nvObj_t *nv) { text_print(nv, fmt_p2wsl);}
+void pwm_print_p2wsh(nvObj_t *nv) { text_print(nv, fmt_p2wsh);}
+void pwm_print_p2wpl(nvObj_t *nv) { text_print(nv, fmt_p2wpl);}
+void pwm_print_p2wph(nvObj_t *nv) { text_print(nv, fmt_p2wph);}
+void pwm_print_p2pof(nvObj_t *nv) { text_print(nv, fmt_p2pof);}
+
 #endif //__TEXT_MODE
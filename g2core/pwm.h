@@ -42,7 +42,10 @@ typedef struct pwmConfigChannel {
 } pwmConfigChannel_t;
 
 typedef struct pwmChannel {
-    // no data required in ARM
+    float frequency;                // frequency last written to the pin, 0 before the first
+    float duty;                     // duty cycle last written to the pin, -1 before the first
+    volatile float next_duty;       // duty cycle posted for the next segment (see pwm_post_duty())
+    volatile bool next_posted;      // next_duty holds a value the loader has yet to apply
 } pwmChannel_t;
 
 typedef struct pwmControl {
@@ -57,6 +60,8 @@ extern pwmControl_t pwm;
 void pwm_init(void);
 stat_t pwm_set_freq(uint8_t channel, float freq);
 stat_t pwm_set_duty(uint8_t channel, float duty);
+void pwm_post_duty(uint8_t channel, float duty);
+void pwm_latch(void);
 
 stat_t pwm_set_pwm(nvObj_t *nv);
 
@@ -73,6 +78,17 @@ stat_t pwm_set_pwm(nvObj_t *nv);
     void pwm_print_p1wph(nvObj_t *nv);
     void pwm_print_p1pof(nvObj_t *nv);
 
+    void pwm_print_p2frq(nvObj_t *nv);
+    void pwm_print_p2csl(nvObj_t *nv);
+    void pwm_print_p2csh(nvObj_t *nv);
+    void pwm_print_p2cpl(nvObj_t *nv);
+    void pwm_print_p2cph(nvObj_t *nv);
+    void pwm_print_p2wsl(nvObj_t *nv);
+    void pwm_print_p2wsh(nvObj_t *nv);
+    void pwm_print_p2wpl(nvObj_t *nv);
+    void pwm_print_p2wph(nvObj_t *nv);
+    void pwm_print_p2pof(nvObj_t *nv);
+
 #else
 
     #define pwm_print_p1frq tx_print_stub
@@ -86,6 +102,17 @@ stat_t pwm_set_pwm(nvObj_t *nv);
     #define pwm_print_p1wph tx_print_stub
     #define pwm_print_p1pof tx_print_stub
 
+    #define pwm_print_p2frq tx_print_stub
+    #define pwm_print_p2csl tx_print_stub
+    #define pwm_print_p2csh tx_print_stub
+    #define pwm_print_p2cpl tx_print_stub
+    #define pwm_print_p2cph tx_print_stub
+    #define pwm_print_p2wsl tx_print_stub
+    #define pwm_print_p2wsh tx_print_stub
+    #define pwm_print_p2wpl tx_print_stub
+    #define pwm_print_p2wph tx_print_stub
+    #define pwm_print_p2pof tx_print_stub
+
 #endif // __TEXT_MODE
 
 #endif    // End of include guard: PWM_H_ONCE
@@ -29,45 +29,136 @@
 #include "config.h"
 #include "report.h"
 #include "controller.h"
+#include "canonical_machine.h"
 #include "json_parser.h"
 #include "text_parser.h"
 #include "planner.h"
 #include "settings.h"
 #include "util.h"
 #include "xio.h"
+#include "binary_motion.h"
 
 
 /**** Allocation ****/
 
 srSingleton_t sr;
 qrSingleton_t qr;
+rptEventSingleton_t rpt;
 
 /**** Exception Reports ************************************************************
  *
- * rpt_exception() - generate an exception message - always in JSON format
+ * rpt_exception()       - generate an exception message - always in JSON format
+ * rpt_fatal_exception() - send an alarm, shutdown or panic report right away
+ * _exception_callback() - send the oldest held back exception, when one is due
  *
  * Returns incoming status value and a message to the exception.
  * Do not use global_string_buf[] for *msg or it will get trampled.
  *
+ *  Exception reports are sent at most once every ER_INTERVAL_MS. An exception that comes
+ *  sooner goes into a ring of ER_RING_LEN entries, one per status: a repeat of a status
+ *  already there only counts up and moves its last time, keeping its first message. The
+ *  ring is sent oldest first from rpt_event_callback(), one report per interval, and a
+ *  report for more than one occurrence carries "cnt" and the SysTick ms of the first and
+ *  last ("t0", "t1"). Exceptions that found the ring full are counted in "lost" on the
+ *  next report. So a stream of bad lines costs one report per interval, not one per line.
+ *
+ *  Fatal exceptions - alarm, shutdown and panic - are never held back. They are sent at
+ *  once and restart the interval, and whatever is in the ring follows them.
+ *
  * WARNING: Do not call this function from MED or HI interrupts (LO is OK)
  *          or there is a potential for deadlock in the TX buffer.
  */
 
+typedef struct erEntry {
+    stat_t status;
+    uint16_t count;                         // occurrences since it was queued
+    uint32_t first_tick;                    // SysTick ms of the first and last
+    uint32_t last_tick;
+    char msg[ER_MSG_LEN];                   // message of the first
+} erEntry_t;
+
+static struct erRing {
+    erEntry_t entry[ER_RING_LEN];
+    uint8_t head;                           // oldest entry
+    uint8_t count;                          // entries held
+    uint16_t lost;                          // exceptions dropped by a full ring
+    uint32_t next_tick;                     // SysTick when the next report may be sent
+} er;
+
+static void _send_exception(const stat_t status, const char *msg, const erEntry_t *e)
+{
+    char buffer[192];
+    char *p = buffer;
+    p += sprintf(p, "{\"er\":{\"fb\":%0.2f,\"st\":%d,\"msg\":\"%s - %s\"",
+                    G2CORE_FIRMWARE_BUILD, status, get_status_message(status), msg);
+    if ((e != NULL) && (e->count > 1)) {
+        p += sprintf(p, ",\"cnt\":%u,\"t0\":%lu,\"t1\":%lu",
+                        e->count, (unsigned long)e->first_tick, (unsigned long)e->last_tick);
+    }
+    if (er.lost) {
+        p += sprintf(p, ",\"lost\":%u", er.lost);
+        er.lost = 0;
+    }
+    strcpy(p, "}}\n");
+    xio_writeline(buffer);
+    er.next_tick = SysTickTimer_getValue() + ER_INTERVAL_MS;
+}
+
 stat_t rpt_exception(stat_t status, const char *msg)
 {
     if (status != STAT_OK) { // makes it possible to call exception reports w/o checking status value
 
         // you cannot send an exception report if the USB has not been set up. Causes a processor exception.
         if (cs.controller_state >= CONTROLLER_READY) {
-            char buffer[128];
-            sprintf(buffer, "{\"er\":{\"fb\":%0.2f,\"st\":%d,\"msg\":\"%s - %s\"}}\n",
-                             G2CORE_FIRMWARE_BUILD, status, get_status_message(status), msg);
-            xio_writeline(buffer);
+            uint32_t now = SysTickTimer_getValue();
+            if ((er.count == 0) && ((int32_t)(now - er.next_tick) >= 0)) {
+                _send_exception(status, msg, NULL);
+                return (status);
+            }
+            for (uint8_t i = 0; i < er.count; i++) {
+                erEntry_t *e = &er.entry[(er.head + i) % ER_RING_LEN];
+                if (e->status == status) {
+                    if (e->count < UINT16_MAX) { e->count++; }
+                    e->last_tick = now;
+                    return (status);
+                }
+            }
+            if (er.count == ER_RING_LEN) {
+                if (er.lost < UINT16_MAX) { er.lost++; }
+                return (status);
+            }
+            erEntry_t *e = &er.entry[(er.head + er.count) % ER_RING_LEN];
+            e->status = status;
+            e->count = 1;
+            e->first_tick = e->last_tick = now;
+            strncpy(e->msg, msg, ER_MSG_LEN-1);
+            e->msg[ER_MSG_LEN-1] = NUL;
+            er.count++;
+            rpt.any = true;                 // have rpt_event_callback() schedule it
         }
     }
     return (status);            // makes it possible to inline, e.g: return(rpt_exception(status));
 }
 
+stat_t rpt_fatal_exception(stat_t status, const char *msg)
+{
+    if ((status != STAT_OK) && (cs.controller_state >= CONTROLLER_READY)) {
+        _send_exception(status, msg, NULL);
+    }
+    return (status);
+}
+
+static void _exception_callback(const uint32_t now)
+{
+    if ((er.count == 0) || ((int32_t)(now - er.next_tick) < 0)) {
+        return;
+    }
+    erEntry_t *e = &er.entry[er.head];
+    _send_exception(e->status, e->msg, e);
+    er.head = (er.head + 1) % ER_RING_LEN;
+    er.count--;
+}
+
 /*
  * rpt_er()    - send a bogus exception report for testing purposes (it's not real)
  */
@@ -188,6 +279,7 @@ void sr_init_status_report()
 {
     nvObj_t *nv = nv_reset_nv_list();    // used for status report persistence locations
     sr.status_report_request = SR_OFF;
+    sr.changed = true;
     char sr_defaults[NV_STATUS_REPORT_LEN][TOKEN_LEN+1] = { STATUS_REPORT_DEFAULTS };
     nv->index = nv_get_index((const char *)"", (char *)"se00");    // set first SR persistence index
 
@@ -209,6 +301,23 @@ void sr_init_status_report()
     }
 }
 
+/*
+ * sr_restore_status_report()
+ *
+ *  Call this after the SR list has been loaded from NVM - it's already in place,
+ *  so only the reporting state needs to be set up
+ */
+
+void sr_restore_status_report()
+{
+    sr.status_report_request = SR_OFF;
+    sr.changed = true;
+    sr.stat_index = nv_get_index((const char *)"", (const char *)"stat");
+    for (uint8_t i=0; i < NV_STATUS_REPORT_LEN ; i++) {
+        sr.status_report_value[i] = -1234567;                   // pre-load values with an unlikely number
+    }
+}
+
 /*
  * sr_set_status_report() - read a list of NV pairs to set up SRs and return a report
  *
@@ -267,6 +376,7 @@ stat_t sr_request_status_report(cmStatusReportRequest request_type)
         return (STAT_OK);
    }
 
+    rpt_post_event(RPT_EVENT_REPORT);
     sr.status_report_systick = SysTickTimer_getValue();
     if (request_type == SR_REQUEST_IMMEDIATE) {
         sr.status_report_request = SR_FILTERED;     // will trigger a filtered or verbose report depending on verbosity setting
@@ -285,6 +395,124 @@ stat_t sr_request_status_report(cmStatusReportRequest request_type)
     return (STAT_OK);
 }
 
+/*
+ * _sr_has_changed() - return false if nothing in a filtered report can have changed
+ *
+ *  Producers of the common SR values call sr_mark_changed() rather than the report
+ *  re-reading every element to find out: the runtime on every move or command it
+ *  executes (positions, velocity, the runtime model), and the controller on every
+ *  line it dispatches (settings, offsets and the gcode model). Machine state changes
+ *  come from too many places to mark, so those are caught by comparing a signature.
+ *
+ *  Anything else (temperatures, inputs...) changes without telling anyone, so if the
+ *  SR list has one of those elements every filtered report walks the whole list.
+ */
+
+static uint32_t _sr_state_signature()
+{
+    return ((uint32_t)cm->machine_state | ((uint32_t)cm->cycle_type << 4) | ((uint32_t)cm->motion_state << 8) |
+            ((uint32_t)cm->hold_state << 12) | ((uint32_t)cm->homing_state << 16) | ((uint32_t)(cm == &cm2) << 20));
+}
+
+static bool _sr_has_changed()
+{
+    uint32_t state = _sr_state_signature();
+    bool changed = (sr.changed || !sr.tracked || (state != sr.state));
+    sr.changed = false;                         // clear before reading values - any marks after this are kept
+    sr.state = state;
+    return (changed);
+}
+
+static bool _sr_is_tracked(const nvObj_t *nv)
+{
+    static const char *const groups[] = { "pos", "mpo", "ofs", "prb", "hom", "g92" };
+    static const char *const tokens[] = { "stat", "macs", "cycs", "mots", "hold", "vel", "feed", "line", "n",
+                                          "momo", "plan", "path", "dist", "admo", "frmo", "unit", "coor", "tool" };
+    if (nv->group[0] != NUL) {
+        for (const char *g : groups) {
+            if (strcmp(nv->group, g) == 0) return (true);
+        }
+        return (false);
+    }
+    for (const char *t : tokens) {
+        if (strcmp(nv->token, t) == 0) return (true);
+    }
+    return (false);
+}
+
+/*
+ * Report event subscribers - see REPORT EVENTS in report.h
+ *
+ *  RPT_EVENT_BUFFER_LEVEL and RPT_EVENT_REPORT carry a request already made, so they only
+ *  need to wake the callback.
+ */
+
+static void _sr_on_motion_state()
+{
+    sr_mark_changed();
+    sr_request_status_report(SR_REQUEST_IMMEDIATE); // hosts wait on stat - send it without the interval
+}
+
+static void _sr_on_timed()
+{
+    sr_request_status_report(SR_REQUEST_TIMED);
+}
+
+typedef struct rptSubscriber {
+    rptEvent event;
+    void (*handler)(void);
+} rptSubscriber_t;
+
+static const rptSubscriber_t rpt_subscribers[] = {
+    { RPT_EVENT_MOTION_STATE, _sr_on_motion_state },
+    { RPT_EVENT_ALARM,        _sr_on_timed },
+    { RPT_EVENT_TEMPERATURE,  _sr_on_timed },
+};
+
+/*
+ * rpt_event_callback() - deliver report events and run the report callbacks
+ *
+ *  A report the callbacks can't send yet - one waiting on its interval, one throttled
+ *  while the planner is short of time, or a held back exception - keeps the callback
+ *  awake until it goes.
+ */
+stat_t rpt_event_callback()                 // called by controller dispatcher
+{
+    uint32_t now = SysTickTimer_getValue();
+    if (!rpt.any && !(rpt.armed && ((int32_t)(now - rpt.wake_tick) >= 0))) {
+        return (STAT_NOOP);
+    }
+    rpt.any = false;
+    for (uint8_t e = 0; e < RPT_EVENT_MAX; e++) {
+        if (rpt.posted[e]) {
+            rpt.posted[e] = false;
+            for (const rptSubscriber_t &s : rpt_subscribers) {
+                if (s.event == e) {
+                    s.handler();
+                }
+            }
+        }
+    }
+    sr_status_report_callback();
+    qr_queue_report_callback();
+    _exception_callback(now);
+
+    rpt.armed = false;
+    if ((sr.status_report_request != SR_OFF) && (sr.status_report_verbosity != SR_OFF)) {
+        rpt.armed = true;
+        rpt.wake_tick = ((int32_t)(sr.status_report_systick - now) > 0) ? sr.status_report_systick : now;
+    }
+    if (qr.queue_report_requested && (qr.queue_report_verbosity != QR_OFF)) {
+        rpt.armed = true;
+        rpt.wake_tick = now;                // coalescing and throttling are decided by the callback
+    }
+    if (er.count && (!rpt.armed || ((int32_t)(er.next_tick - rpt.wake_tick) < 0))) {
+        rpt.armed = true;
+        rpt.wake_tick = er.next_tick;       // the next held back exception report
+    }
+    return (STAT_OK);
+}
+
 /*
  * sr_status_report_callback() - main loop callback to send a report if one is ready
  */
@@ -306,11 +534,19 @@ stat_t sr_status_report_callback()         // called by controller dispatcher
     }
 
     sr.status_report_request = SR_OFF;
+#if BINARY_MOTION_ENABLED == true
+    if (sr.status_report_verbosity == SR_BINARY) {      // changed values only, and no JSON
+        if (_sr_has_changed() && _populate_filtered_status_report()) {
+            binary_motion_status_report(nv_body->nx);
+        }
+        return (STAT_OK);
+    }
+#endif
     if ((sr.status_report_request == SR_VERBOSE) ||
         (sr.status_report_verbosity == SR_VERBOSE)) {
         _populate_unfiltered_status_report();
     } else {
-        if (_populate_filtered_status_report() == false) {  // no new data
+        if (!_sr_has_changed() || (_populate_filtered_status_report() == false)) {  // no new data
             return (STAT_OK);
         }
     }
@@ -344,6 +580,7 @@ static stat_t _populate_unfiltered_status_report()
     nv->index = nv_get_index((const char *)"", sr_str);// set the index - may be needed by calling function
     nv = nv->nx;                            // no need to check for NULL as list has just been reset
 
+    mp_hold_runtime_snapshot(true);         // read every field from the same segment
     for (uint8_t i=0; i<NV_STATUS_REPORT_LEN; i++) {
         if ((nv->index = sr.status_report_list[i]) == 0) { break;}
         nv_get_nvObj(nv);
@@ -353,9 +590,11 @@ static stat_t _populate_unfiltered_status_report()
         strcpy(nv->token, tmp);             //...or here.
 
         if ((nv = nv->nx) == NULL) {
+            mp_hold_runtime_snapshot(false);
             return (cm_panic(STAT_BUFFER_FULL_FATAL, "_populate_unfiltered_status_report() sr link NULL"));    // should never be NULL unless SR length exceeds available buffer array
         }
     }
+    mp_hold_runtime_snapshot(false);
     return (STAT_OK);
 }
 
@@ -389,11 +628,16 @@ static uint8_t _populate_filtered_status_report()
 //    nv->index = nv_get_index((const char *)"", sr_str);// OMITTED - set the index - may be needed by calling function
     nv = nv->nx;                                // no need to check for NULL as list has just been reset
 
+    sr.tracked = true;                          // the list is re-checked every time it's walked
+    mp_hold_runtime_snapshot(true);             // read every field from the same segment
     for (uint8_t i=0; i<NV_STATUS_REPORT_LEN; i++) {
         if ((nv->index = sr.status_report_list[i]) == 0) {  // end of list
             break;
         }
         nv_get_nvObj(nv);
+        if (!_sr_is_tracked(nv)) {
+            sr.tracked = false;
+        }
 
         // extract the value and cast into a float, regardless of value type 
         if ((valueType)(cfgArray[nv->index].flags & F_TYPE_MASK) == TYPE_FLOAT) {
@@ -414,6 +658,7 @@ static uint8_t _populate_filtered_status_report()
             strcpy(nv->token, tmp);            //...or here.
             sr.status_report_value[i] = current_value;
             if ((nv = nv->nx) == NULL) {        // should never be NULL unless SR length exceeds available buffer array
+                mp_hold_runtime_snapshot(false);
                 return (false); 
             }
             has_data = true;
@@ -421,6 +666,7 @@ static uint8_t _populate_filtered_status_report()
             nv->valuetype = TYPE_EMPTY;         // filter this value out of the report
         }
     }
+    mp_hold_runtime_snapshot(false);
     return (has_data);
 }
 
@@ -449,7 +695,16 @@ stat_t sr_get(nvObj_t *nv) { return (_populate_unfiltered_status_report()); }
 stat_t sr_set(nvObj_t *nv) { return (sr_set_status_report(nv)); }
 
 stat_t sr_get_sv(nvObj_t *nv) { return(get_integer(nv, (uint8_t &)sr.status_report_verbosity)); }
-stat_t sr_set_sv(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)sr.status_report_verbosity, SR_OFF, SR_VERBOSE)); }
+stat_t sr_set_sv(nvObj_t *nv)
+{
+    ritorno(set_integer(nv, (uint8_t &)sr.status_report_verbosity, SR_OFF, SR_VERBOSITY_MAX));
+    if (sr.status_report_verbosity == SR_BINARY) {
+        for (uint8_t i=0; i < NV_STATUS_REPORT_LEN; i++) {
+            sr.status_report_value[i] = -1234567;       // report every value the first time
+        }
+    }
+    return (STAT_OK);
+}
 stat_t sr_get_si(nvObj_t *nv) { return(get_integer(nv, sr.status_report_interval)); }
 stat_t sr_set_si(nvObj_t *nv) { return(set_int32(nv, sr.status_report_interval, STATUS_REPORT_MIN_MS, STATUS_REPORT_MAX_MS)); }
 
@@ -458,7 +713,7 @@ stat_t sr_set_si(nvObj_t *nv) { return(set_int32(nv, sr.status_report_interval,
  *********************/
 #ifdef __TEXT_MODE
 
-static const char fmt_sv[] = "[sv]  status report verbosity%6d [0=off,1=filtered,2=verbose]\n";
+static const char fmt_sv[] = "[sv]  status report verbosity%6d [0=off,1=filtered,2=verbose,3=binary]\n";
 static const char fmt_si[] = "[si]  status interval%14d ms\n";
 
 void sr_print_sr(nvObj_t *nv) { _populate_unfiltered_status_report();}
@@ -475,6 +730,7 @@ void sr_print_si(nvObj_t *nv) { text_print(nv, fmt_si);}
  *    - qr    queue depth - # of buffers availabel in planner queue
  *    - qi    buffers added to planner queue since las report
  *    - qo    buffers removed from planner queue since last report
+ *    - qp    planned time in planner queue, in ms (data only - not part of QR_TRIPLE)
  *
  *  A QR_SINGLE report returns qr only. A QR_TRIPLE returns all 3 values
  *
@@ -485,6 +741,12 @@ void sr_print_si(nvObj_t *nv) { text_print(nv, fmt_si);}
  *
  *   2. Add qr, qi and qo (or some combination) to the status report. This will
  *      return queue report data when status reports are generated.
+ *
+ *  A fast stream requests a report for nearly every buffer in and out. Reports can be
+ *  coalesced by setting a minimum interval between them (qvi) and the change in buffers
+ *  available that's worth reporting (qvh). A held-back request is still reported within
+ *  QR_COALESCE_MAX_MS. qi and qo accumulate until they are reported, so the counts a host
+ *  uses for flow control stay exact however many requests were folded together.
  */
 /*
  * qr_init_queue_report() - initialize or clear queue report values
@@ -527,9 +789,28 @@ void qr_request_queue_report(int8_t buffers)
     }
 
     // either return or request a report
-    if (qr.queue_report_verbosity != QR_OFF) {
+    if ((qr.queue_report_verbosity != QR_OFF) && (!qr.queue_report_requested)) {
         qr.queue_report_requested = true;
+        qr.request_tick = SysTickTimer_getValue();
     }
+    rpt_post_event(RPT_EVENT_BUFFER_LEVEL);
+}
+
+/*
+ * _qr_coalesce() - return true if a requested report should be held back for now
+ */
+
+static bool _qr_coalesce()
+{
+    uint32_t tick = SysTickTimer_getValue();
+    if (tick - qr.request_tick >= QR_COALESCE_MAX_MS) {
+        return (false);                             // don't hold anything back for too long
+    }
+    if (tick - qr.init_tick < (uint32_t)qr.queue_report_interval) {
+        return (true);
+    }
+    int16_t change = (int16_t)qr.buffers_available - (int16_t)qr.prev_available;
+    return ((change < qr.queue_report_hysteresis) && (-change < qr.queue_report_hysteresis));
 }
 
 /*
@@ -541,11 +822,13 @@ stat_t qr_queue_report_callback()         // called by controller dispatcher
     if ((qr.queue_report_verbosity == QR_OFF) ||
         (js.json_verbosity == JV_SILENT) ||
         (qr.queue_report_requested == false) ||
-        (!mp_is_phat_city_time())) {
+        (!mp_is_phat_city_time()) ||
+        _qr_coalesce()) {
         return (STAT_NOOP);
     }
 
     qr.queue_report_requested = false;
+    qr.prev_available = qr.buffers_available;
 
     char report[32];    // we know these reports can't be longer than 30 bytes
 
@@ -589,6 +872,7 @@ stat_t qr_queue_report_callback()         // called by controller dispatcher
  * qr_get() - run a queue report (as data)
  * qi_get() - run a queue report - buffers in
  * qo_get() - run a queue report - buffers out
+ * qp_get() - run a queue report - planned time in ms
  */
 stat_t qr_get(nvObj_t *nv)
 {
@@ -613,8 +897,19 @@ stat_t qo_get(nvObj_t *nv)
     return (STAT_OK);
 }
 
+stat_t qp_get(nvObj_t *nv)
+{
+    nv->value_flt = mp_get_planned_time(mp) * 60000;
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
 stat_t qr_get_qv(nvObj_t *nv) { return(get_integer(nv, (uint8_t &)qr.queue_report_verbosity)); }
 stat_t qr_set_qv(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)qr.queue_report_verbosity, QR_OFF, QR_TRIPLE)); }
+stat_t qr_get_qvi(nvObj_t *nv) { return(get_integer(nv, qr.queue_report_interval)); }
+stat_t qr_set_qvi(nvObj_t *nv) { return(set_int32(nv, qr.queue_report_interval, 0, QR_INTERVAL_MAX_MS)); }
+stat_t qr_get_qvh(nvObj_t *nv) { return(get_integer(nv, qr.queue_report_hysteresis)); }
+stat_t qr_set_qvh(nvObj_t *nv) { return(set_integer(nv, qr.queue_report_hysteresis, 0, PLANNER_QUEUE_SIZE)); }
 
 /*****************************************************************************
  * JOB ID REPORTS
@@ -695,11 +990,17 @@ void job_print_job(nvObj_t *nv) { job_populate_job_report();}
 static const char fmt_qr[] = "qr:%d\n";
 static const char fmt_qi[] = "qi:%d\n";
 static const char fmt_qo[] = "qo:%d\n";
+static const char fmt_qp[] = "qp:%1.1f\n";
 static const char fmt_qv[] = "[qv]  queue report verbosity%7d [0=off,1=single,2=triple]\n";
+static const char fmt_qvi[] = "[qvi] queue report interval%8d ms [0=no limit]\n";
+static const char fmt_qvh[] = "[qvh] queue report hysteresis%6d buffers [0=report every change]\n";
 
 void qr_print_qr(nvObj_t *nv) { text_print(nv, fmt_qr);}    // TYPE_INT
 void qr_print_qi(nvObj_t *nv) { text_print(nv, fmt_qi);}    // TYPE_INT
 void qr_print_qo(nvObj_t *nv) { text_print(nv, fmt_qo);}    // TYPE_INT
+void qr_print_qp(nvObj_t *nv) { text_print(nv, fmt_qp);}    // TYPE_FLOAT
 void qr_print_qv(nvObj_t *nv) { text_print(nv, fmt_qv);}    // TYPE_INT
+void qr_print_qvi(nvObj_t *nv) { text_print(nv, fmt_qvi);}
+void qr_print_qvh(nvObj_t *nv) { text_print(nv, fmt_qvh);}
 
 #endif // __TEXT_MODE
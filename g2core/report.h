@@ -36,14 +36,27 @@
 
 #define SR_THROTTLE_COUNT   4       // scale back filtered SR's during time-constrained intervals
 #define MIN_ARC_QR_INTERVAL 200     // minimum interval between QRs during arc generation (in system ticks)
+#define QR_COALESCE_MAX_MS  250     // a coalesced QR is never held back longer than this
+#define QR_INTERVAL_MAX_MS  1000    // largest {qvi:} setting
 #define STATUS_REPORT_MAX_MS (MAX_LONG/1000)
 
+#define ER_RING_LEN         8       // distinct exception statuses held back for reporting
+#define ER_MSG_LEN          48      // message kept with each, including the NUL
+#define ER_INTERVAL_MS      100     // least time between exception reports, except fatal ones
+
 typedef enum {                      // status report enable, verbosity and request type
     SR_OFF = 0,                     // no reports
     SR_FILTERED,                    // reports only values that have changed from the last report
-    SR_VERBOSE                      // reports all values specified
+    SR_VERBOSE,                     // reports all values specified
+    SR_BINARY                       // filtered reports as BM_STATUS frames on the binary channel
 } srVerbosity;
 
+#if BINARY_MOTION_ENABLED == true
+#define SR_VERBOSITY_MAX SR_BINARY
+#else
+#define SR_VERBOSITY_MAX SR_VERBOSE
+#endif
+
 typedef enum {
     SR_REQUEST_IMMEDIATE = 0,       // request a full or filtered status report ASAP (depending on SR_VERBOSITY setting)
     SR_REQUEST_IMMEDIATE_FULL,      // request a full status report ASAP (regardless of SR_VERBOSITY setting)
@@ -70,6 +83,9 @@ typedef struct srSingleton {
     uint8_t throttle_counter;                           // slow down SRs when in a constrained time (not phat_city)
     index_t status_report_list[NV_STATUS_REPORT_LEN];   // status report elements to report
     float status_report_value[NV_STATUS_REPORT_LEN];    // previous values for filtered reporting
+    volatile bool changed;                              // set by sr_mark_changed() - a reported value may have changed
+    bool tracked;                                       // every SR element is covered by sr_mark_changed() (see report.cpp)
+    uint32_t state;                                     // machine state signature at the last filtered report
 
 } srSingleton_t;
 
@@ -77,6 +93,8 @@ typedef struct qrSingleton {        // data for queue reports
 
     /*** config values (PUBLIC) ***/
     qrVerbosity queue_report_verbosity;     // queue reports enabled and verbosity level
+    int32_t queue_report_interval;          // minimum ms between queue reports, 0 = no limit
+    uint8_t queue_report_hysteresis;        // buffers available must move this much to report, 0 = any request
 
     /*** runtime values (PRIVATE) ***/
     uint8_t queue_report_requested;         // set to true to request a report
@@ -86,18 +104,50 @@ typedef struct qrSingleton {        // data for queue reports
     uint16_t buffers_removed;               // buffers removed since last report
     uint8_t motion_mode;                    // used to detect arc movement
     uint32_t init_tick;                     // time when values were last initialized or cleared
+    uint32_t request_tick;                  // time of the oldest request not yet reported
 
 } qrSingleton_t;
 
+/*
+ * REPORT EVENTS
+ *
+ *  Producers post an event when something the reports show has changed, and the
+ *  subscribers in report.cpp turn events into report requests. rpt_event_callback() is
+ *  the controller's only report task: it returns at once unless an event has been posted
+ *  or the next timed report is due, and otherwise delivers the events and runs the SR and
+ *  QR callbacks. Events are byte flags, so they can be posted from interrupts.
+ */
+typedef enum {
+    RPT_EVENT_MOTION_STATE = 0,             // cm_set_motion_state() changed the motion state
+    RPT_EVENT_BUFFER_LEVEL,                 // a planner buffer was queued or freed
+    RPT_EVENT_ALARM,                        // alarm or shutdown
+    RPT_EVENT_TEMPERATURE,                  // a temperature moved past its report threshold
+    RPT_EVENT_REPORT,                       // a status report was requested
+    RPT_EVENT_MAX
+} rptEvent;
+
+typedef struct rptEventSingleton {
+    volatile bool posted[RPT_EVENT_MAX];    // events posted and not yet delivered
+    volatile bool any;                      // an event has been posted since the last delivery
+    bool armed;                             // wake_tick is set
+    uint32_t wake_tick;                     // SysTick when a pending report is due
+} rptEventSingleton_t;
+
 /**** Externs - See report.c for allocation ****/
 
 extern srSingleton_t sr;
 extern qrSingleton_t qr;
+extern rptEventSingleton_t rpt;
 
 /**** Function Prototypes ****/
 
+inline void sr_mark_changed() { sr.changed = true; }    // safe from interrupts
+inline void rpt_post_event(const rptEvent event) { rpt.posted[event] = true; rpt.any = true; }  // safe from interrupts
+stat_t rpt_event_callback(void);
+
 void rpt_print_message(char *msg);
 stat_t rpt_exception(stat_t status, const char *msg);
+stat_t rpt_fatal_exception(stat_t status, const char *msg);
 
 stat_t rpt_er(nvObj_t *nv);
 void rpt_print_loading_configs_message(void);
@@ -105,6 +155,7 @@ void rpt_print_initializing_message(void);
 void rpt_print_system_ready_message(void);
 
 void sr_init_status_report(void);
+void sr_restore_status_report(void);
 stat_t sr_set_status_report(nvObj_t *nv);
 stat_t sr_request_status_report(cmStatusReportRequest request_type);
 stat_t sr_status_report_callback(void);
@@ -128,9 +179,14 @@ stat_t rx_report_callback(void);
 stat_t qr_get(nvObj_t *nv);
 stat_t qi_get(nvObj_t *nv);
 stat_t qo_get(nvObj_t *nv);
+stat_t qp_get(nvObj_t *nv);
 
 stat_t qr_get_qv(nvObj_t *nv);
 stat_t qr_set_qv(nvObj_t *nv);
+stat_t qr_get_qvi(nvObj_t *nv);
+stat_t qr_set_qvi(nvObj_t *nv);
+stat_t qr_get_qvh(nvObj_t *nv);
+stat_t qr_set_qvh(nvObj_t *nv);
 
 #ifdef __TEXT_MODE
 
@@ -138,9 +194,12 @@ stat_t qr_set_qv(nvObj_t *nv);
     void sr_print_si(nvObj_t *nv);
     void sr_print_sv(nvObj_t *nv);
     void qr_print_qv(nvObj_t *nv);
+    void qr_print_qvi(nvObj_t *nv);
+    void qr_print_qvh(nvObj_t *nv);
     void qr_print_qr(nvObj_t *nv);
     void qr_print_qi(nvObj_t *nv);
     void qr_print_qo(nvObj_t *nv);
+    void qr_print_qp(nvObj_t *nv);
 
 #else
 
@@ -148,9 +207,12 @@ stat_t qr_set_qv(nvObj_t *nv);
     #define sr_print_si tx_print_stub
     #define sr_print_sv tx_print_stub
     #define qr_print_qv tx_print_stub
+    #define qr_print_qvi tx_print_stub
+    #define qr_print_qvh tx_print_stub
     #define qr_print_qr tx_print_stub
     #define qr_print_qi tx_print_stub
     #define qr_print_qo tx_print_stub
+    #define qr_print_qp tx_print_stub
 
 #endif // __TEXT_MODE
 
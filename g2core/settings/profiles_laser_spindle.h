@@ -0,0 +1,48 @@
+/*
+ * profiles_laser_spindle.h - laser and spindle heads on one machine
+ * This file is part of the g2core project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/***********************************************************************/
+/**** Laser and spindle machine profiles *******************************/
+/***********************************************************************/
+/*
+ *  Select with PROFILES_FILE in the settings file, e.g. #define PROFILES_FILE profiles_laser_spindle.h
+ *  Each profile is the settings file plus the values below - see MACHINE PROFILES in config.cpp.
+ *  {mpro:1} switches to the laser head, {mpro:2} to the spindle and {mpro:0} back to the
+ *  settings file as it is.
+ */
+
+static const cfgProfileValue_t profile_laser[] = {
+    { "spmo",  2 },             // continuous - the laser runs through corners
+    { "spde",  0 },             // no spin-up
+    { "spph",  1 },             // laser off in a feedhold
+    { "spvs",  1 },             // scale power with velocity
+    { "spv0",  0.1 },
+    { "p1frq", 5000 },          // laser drivers take a fast PWM
+    { "zam",   0 },             // Z is the focus stage, not moved by jobs
+};
+
+static const cfgProfileValue_t profile_spindle[] = {
+    { "spmo",  1 },             // plan to stop at spindle changes
+    { "spde",  2.0 },           // seconds to reach speed
+    { "spph",  1 },
+    { "spvs",  0 },
+    { "p1frq", 100 },
+};
+
+#define MACHINE_PROFILES \
+    MACHINE_PROFILE("laser", profile_laser), \
+    MACHINE_PROFILE("spindle", profile_spindle),
@@ -80,21 +80,10 @@
 #define GCODE_DEFAULT_PATH_CONTROL        PATH_CONTINUOUS
 #define GCODE_DEFAULT_DISTANCE_MODE       ABSOLUTE_DISTANCE_MODE
 
-#define MARLIN_G29_SCRIPT                 \
-    "M100 ({\"_leds\":3})\n" \
-    "G1 X0 Y95 Z6 F20000\n" \
-    "G38.2 Z-10 F200\n" \
-    "G1 Z5 F20000\n" \
-    "M100 ({\"_leds\":5})\n" \
-    "G1 X70 Y45 F20000\n" \
-    "G38.2 Z-10 F200\n" \
-    "G1 Z5 F20000\n" \
-    "M100 ({\"_leds\":6})\n" \
-    "G1 X0 Y5 F20000\n" \
-    "G38.2 Z-10 F200\n" \
-    "G1 Z5 F20000\n" \
-    "M100 ({\"_leds\":3})\n" \
-    "M100 ({\"tram\":1})\n"
+#define MARLIN_G29_POINTS                 {{0, 95}, {70, 45}, {0, 5}}  // X,Y of the points G29 probes to tram the bed
+#define MARLIN_G29_Z_CLEAR                6.0                     // Z travel height between the points
+#define MARLIN_G29_Z_PROBE                -10.0                   // Z probe target
+#define MARLIN_G29_FEED_RATE              200.0                   // probe feed rate, mm/min
 
 
 // *** motor settings ************************************************************************************
@@ -66,14 +66,82 @@
 #define CHORDAL_TOLERANCE           0.01    // {ct: chordal tolerance for arcs (in mm)
 #endif
 
+#ifndef ARC_TIME_BUDGET
+#define ARC_TIME_BUDGET             500     // {arcb: us spent queuing arc segments per main loop pass (0 = one segment per pass)
+#endif
+
+#ifndef SEGMENT_MERGE_TOLERANCE
+#define SEGMENT_MERGE_TOLERANCE     0       // {mgt: chordal tolerance for merging collinear G1 moves (in mm, 0 = disabled)
+#endif
+
+#ifndef PLANNER_ACCEL_RUNS
+#define PLANNER_ACCEL_RUNS          0       // {plr: plan accelerations over several short blocks (0 = per block, 1 = runs)
+#endif
+
+#ifndef PLANNER_TIME_TARGET
+#define PLANNER_TIME_TARGET         0       // {qt: ms of planned motion to hold before pausing input (0 = admit by buffer count only)
+#endif
+
+#ifndef KINEMATICS
+#define KINEMATICS                  KINEMATICS_CARTESIAN // {kin: 0=cartesian, 1=corexy, 2=delta, 3=scara, 4=table-table, 5=head-table
+#endif
+
+#ifndef DELTA_ROD_LENGTH
+#define DELTA_ROD_LENGTH            250.0   // {kdl: linear delta diagonal rod length (in mm)
+#endif
+
+#ifndef DELTA_RADIUS
+#define DELTA_RADIUS                125.0   // {kdr: linear delta radius - tower joint to effector joint, horizontally (in mm)
+#endif
+
+#ifndef SCARA_LINK1_LENGTH
+#define SCARA_LINK1_LENGTH          150.0   // {ksl1: SCARA shoulder to elbow length (in mm)
+#endif
+
+#ifndef SCARA_LINK2_LENGTH
+#define SCARA_LINK2_LENGTH          150.0   // {ksl2: SCARA elbow to end effector length (in mm)
+#endif
+
+#ifndef ROTARY_PIVOT_X
+#define ROTARY_PIVOT_X              0.0     // {ktpx: 5-axis rotary pivot, machine X (in mm)
+#endif
+
+#ifndef ROTARY_PIVOT_Y
+#define ROTARY_PIVOT_Y              0.0     // {ktpy: 5-axis rotary pivot, machine Y (in mm)
+#endif
+
+#ifndef ROTARY_PIVOT_Z
+#define ROTARY_PIVOT_Z              0.0     // {ktpz: 5-axis table-table pivot, machine Z (in mm)
+#endif
+
+#ifndef ROTARY_HEAD_LENGTH
+#define ROTARY_HEAD_LENGTH          0.0     // {khl: 5-axis head pivot to spindle gauge line (in mm)
+#endif
+
+#ifndef KINEMATICS_SEGMENT_TOLERANCE
+#define KINEMATICS_SEGMENT_TOLERANCE 0.5    // {ktol: joint space chord deviation per segment (in steps), 0 = fixed segments
+#endif
+
 #ifndef MOTOR_POWER_TIMEOUT
 #define MOTOR_POWER_TIMEOUT         2.00    // {mt:  motor power timeout in seconds
 #endif
 
+#ifndef MOTOR_CRUISE_POWER
+#define MOTOR_CRUISE_POWER          1.000   // {mcp: run current in the cruise of a move, as a fraction of {1pl:}. 1.0 disables
+#endif
+
+#ifndef MOTOR_HOLD_POWER
+#define MOTOR_HOLD_POWER            1.000   // {mhp: standstill current, as a fraction of {1pl:}
+#endif
+
 #ifndef SOFT_LIMIT_ENABLE
 #define SOFT_LIMIT_ENABLE           0       // {sl: 0=off, 1=on
 #endif
 
+#ifndef HOMING_SIMULTANEOUS
+#define HOMING_SIMULTANEOUS         0       // {hsm: 0=home axes one at a time, 1=home non-Z axes together
+#endif
+
 #ifndef HARD_LIMIT_ENABLE
 #define HARD_LIMIT_ENABLE           1       // {lim: 0=off, 1=on
 #endif
@@ -81,6 +149,18 @@
 #define SAFETY_INTERLOCK_ENABLE     1       // {saf: 0=off, 1=on
 #endif
 
+#ifndef FEED_OVERRIDE_MODE
+#define FEED_OVERRIDE_MODE          0       // {frm: 0=replan the queue, 1=time-scale the exec (see mp_start_feed_override())
+#endif
+
+#ifndef ROTARY_FEED_MODE
+#define ROTARY_FEED_MODE            0       // {rfm: 0=F is XYZ or ABC rate, 1=F is tool tip rate using {xra} (see _calculate_vmaxes())
+#endif
+
+#ifndef INPUT_SHAPER_TYPE
+#define INPUT_SHAPER_TYPE           1       // {shp: 0=ZV, 1=ZVD, 2=EI - see plan_shaper.cpp
+#endif
+
 #ifndef SPINDLE_MODE
 #define SPINDLE_MODE                1       // {spmo; 0=diabled, 1=plan to stop, 2=continuous
 #endif
@@ -101,6 +181,14 @@
 #define SPINDLE_SPINUP_DELAY        0     // {spde:
 #endif
 
+#ifndef SPINDLE_SPINUP_OVERLAP
+#define SPINDLE_SPINUP_OVERLAP      false   // {spup: traverses run during spinup, feeds wait
+#endif
+
+#ifndef SPINDLE_FEED_LINK
+#define SPINDLE_FEED_LINK           false   // {spfl: scale the feed override with the spindle override
+#endif
+
 #ifndef SPINDLE_DWELL_MAX
 #define SPINDLE_DWELL_MAX   10000000.0      // maximum allowable dwell time. May be overridden in settings files
 #endif
@@ -113,6 +201,26 @@
 #define SPINDLE_SPEED_MAX     1000000.0     // {spsm:
 #endif
 
+#ifndef SPINDLE_TACH_PPR
+#define SPINDLE_TACH_PPR            0       // {sptp: tach pulses per revolution, 0 = no tach
+#endif
+
+#ifndef SPINDLE_AT_SPEED_TOLERANCE
+#define SPINDLE_AT_SPEED_TOLERANCE  0.05    // {spat: at speed within this fraction of S
+#endif
+
+#ifndef SPINDLE_VELOCITY_SYNC
+#define SPINDLE_VELOCITY_SYNC       false   // {spvs: scale laser power with segment velocity
+#endif
+
+#ifndef SPINDLE_VELOCITY_POWER_LO
+#define SPINDLE_VELOCITY_POWER_LO   0.0     // {spv0: fraction of S at zero velocity
+#endif
+
+#ifndef SPINDLE_VELOCITY_POWER_HI
+#define SPINDLE_VELOCITY_POWER_HI   1.0     // {spv1: fraction of S at cruise velocity
+#endif
+
 #ifndef COOLANT_MIST_POLARITY
 #define COOLANT_MIST_POLARITY       1       // {comp: 0=active low, 1=active high
 #endif
@@ -125,6 +233,10 @@
 #define COOLANT_PAUSE_ON_HOLD       true    // {coph:
 #endif
 
+#ifndef COOLANT_SPINUP_DELAY
+#define COOLANT_SPINUP_DELAY        0       // {cosu: seconds
+#endif
+
 #ifndef FEEDHOLD_Z_LIFT
 #define FEEDHOLD_Z_LIFT             0       // {zl: mm to lift Z on feedhold
 #endif
@@ -133,6 +245,44 @@
 #define PROBE_REPORT_ENABLE         true    // {prbr: 
 #endif
 
+#ifndef PROBE_TOUCHES
+#define PROBE_TOUCHES               0       // {prbn: slow touches averaged after the fast one, 0 for a single touch
+#endif
+
+#ifndef PROBE_BACKOFF
+#define PROBE_BACKOFF               2.0     // {prbk: mm to back off the contact before each slow touch
+#endif
+
+#ifndef PROBE_SLOW_FEED
+#define PROBE_SLOW_FEED             25.0    // {prbs: mm/min for the slow touches
+#endif
+
+// Tool setter for G37 tool measurement - machine coordinates in mm
+
+#ifndef TOOL_SETTER_X
+#define TOOL_SETTER_X               0       // {tlsx:
+#endif
+
+#ifndef TOOL_SETTER_Y
+#define TOOL_SETTER_Y               0       // {tlsy:
+#endif
+
+#ifndef TOOL_SETTER_Z_CLEAR
+#define TOOL_SETTER_Z_CLEAR         0       // {tlsc: Z travel height to and from the setter
+#endif
+
+#ifndef TOOL_SETTER_Z_PROBE
+#define TOOL_SETTER_Z_PROBE         -50     // {tlsp: Z probe target - no contact above this fails
+#endif
+
+#ifndef TOOL_SETTER_FEED
+#define TOOL_SETTER_FEED            200     // {tlsf: mm/min for the fast touch
+#endif
+
+#ifndef TOOL_SETTER_Z_REFERENCE
+#define TOOL_SETTER_Z_REFERENCE     0       // {tlsr: contact Z of a zero length tool
+#endif
+
 #ifndef MANUAL_FEEDRATE_OVERRIDE_ENABLE
 #define MANUAL_FEEDRATE_OVERRIDE_ENABLE false
 #endif
@@ -155,6 +305,10 @@
 #define COMM_MODE                   JSON_MODE               // {ej: TEXT_MODE, JSON_MODE
 #endif
 
+#ifndef LINE_CHECKSUM_MODE
+#define LINE_CHECKSUM_MODE          LINE_CHECKSUM_XOR       // {lcm: LINE_CHECKSUM_XOR, LINE_CHECKSUM_CRC32
+#endif
+
 #ifndef TEXT_VERBOSITY
 #define TEXT_VERBOSITY              TV_VERBOSE              // {tv: TV_SILENT, TV_VERBOSE
 #endif
@@ -167,12 +321,32 @@
 #define JSON_VERBOSITY              JV_MESSAGES             // {jv: JV_SILENT, JV_FOOTER, JV_CONFIGS, JV_MESSAGES, JV_LINENUM, JV_VERBOSE
 #endif
 
+#ifndef JSON_ACK_BATCH
+#define JSON_ACK_BATCH              8                       // {jab: most gcode lines covered by one {jv:9} ack, 1=ack every line
+#endif
+
+#ifndef XIO_TX_COALESCE
+#define XIO_TX_COALESCE             1                       // {txc: 1=pack small TX writes into full packets
+#endif
+
+#ifndef LINK_THROTTLE
+#define LINK_THROTTLE               1                       // {lkth: 1=hold short moves to the measured host line rate
+#endif
+
 #ifndef QUEUE_REPORT_VERBOSITY
 #define QUEUE_REPORT_VERBOSITY      QR_OFF                  // {qv: QR_OFF, QR_SINGLE, QR_TRIPLE
 #endif
 
+#ifndef QUEUE_REPORT_INTERVAL_MS
+#define QUEUE_REPORT_INTERVAL_MS    0                       // {qvi: minimum ms between queue reports, 0 = no limit
+#endif
+
+#ifndef QUEUE_REPORT_HYSTERESIS
+#define QUEUE_REPORT_HYSTERESIS     0                       // {qvh: change in buffers available worth a queue report, 0 = any
+#endif
+
 #ifndef STATUS_REPORT_VERBOSITY
-#define STATUS_REPORT_VERBOSITY     SR_FILTERED             // {sv: SR_OFF, SR_FILTERED, SR_VERBOSE
+#define STATUS_REPORT_VERBOSITY     SR_FILTERED             // {sv: SR_OFF, SR_FILTERED, SR_VERBOSE, SR_BINARY
 #endif
 
 #ifndef STATUS_REPORT_MIN_MS
@@ -193,6 +367,98 @@
 #define MARLIN_COMPAT_ENABLED       false                   // boolean, either true or false
 #endif
 
+#ifndef BINARY_MOTION_ENABLED
+#define BINARY_MOTION_ENABLED       false                   // binary motion channel on SerialUSB1 - requires USB_SERIAL_PORTS_EXPOSED 2
+#endif
+
+#ifndef TELEMETRY_RATE
+#define TELEMETRY_RATE              0                       // {tlr: segments per telemetry sample on the binary channel, 0=off
+#endif
+
+#ifndef TELEMETRY_AXES
+#define TELEMETRY_AXES              0x07                    // {tla: axes in telemetry samples, bit 0 = X - default XYZ
+#endif
+
+#ifndef PSO_INTERVAL
+#define PSO_INTERVAL                1.0                     // {psoi: mm of path between position synchronized output firings
+#endif
+
+#ifndef PSO_AXES
+#define PSO_AXES                    0x03                    // {psoa: axes the PSO path is measured on, bit 0 = X - default XY
+#endif
+
+#ifndef PSO_MODE
+#define PSO_MODE                    0                       // {psom: 0=pulse, 1=toggle
+#endif
+
+#ifndef PSO_PULSE_WIDTH
+#define PSO_PULSE_WIDTH             10.0                    // {psow: PSO pulse width in microseconds
+#endif
+
+#ifndef PSO_OUTPUT
+#define PSO_OUTPUT                  0                       // {psoo: output fired by PSO, 0=off
+#endif
+
+#ifndef SYNC_MODE
+#define SYNC_MODE                   0                       // {syn: 0=off, 1=master, 2=follower
+#endif
+
+#ifndef SYNC_PERIOD
+#define SYNC_PERIOD                 10.0                    // {synp: sync clock period in ms
+#endif
+
+#ifndef SYNC_CLOCK_OUTPUT
+#define SYNC_CLOCK_OUTPUT           0                       // {synk: master's clock output, 0=none
+#endif
+
+#ifndef SYNC_RUN_OUTPUT
+#define SYNC_RUN_OUTPUT             0                       // {synr: master's run output, 0=none
+#endif
+
+#ifndef AF_INPUT
+#define AF_INPUT                    0                       // {afi: heater ADC read as the adaptive feed load, 0=off
+#endif
+
+#ifndef AF_SET_POINT
+#define AF_SET_POINT                0.5                     // {afs: adaptive feed load set point, fraction of ADC full scale
+#endif
+
+#ifndef AF_GAIN
+#define AF_GAIN                     0.5                     // {afg: adaptive factor change per second per unit of load error
+#endif
+
+#ifndef AF_FACTOR_MIN
+#define AF_FACTOR_MIN               0.25                    // {afn: lowest adaptive feed factor
+#endif
+
+#ifndef AF_FACTOR_MAX
+#define AF_FACTOR_MAX               1.0                     // {afx: highest adaptive feed factor
+#endif
+
+#ifndef PERSISTENCE_ENABLED
+#define PERSISTENCE_ENABLED         false                   // keep settings in flash - SAM3X only, see persistence.h
+#endif
+
+#ifndef SPOOL_ENABLED
+#define SPOOL_ENABLED               false                   // upload jobs to flash and run them locally - SAM3X only, see spool.h
+#endif
+
+#ifndef SPOOL_PALLET_JOB
+#define SPOOL_PALLET_JOB            0                       // {spqp: spooled job run between queued jobs, 0 = none
+#endif
+
+#ifndef SPOOL_QUEUE_WAIT
+#define SPOOL_QUEUE_WAIT            0                       // {spqw: 1 = wait for cycle start before each queued job after the first
+#endif
+
+#ifndef CHECKPOINT_ENABLED
+#define CHECKPOINT_ENABLED          false                   // keep job checkpoints in flash - SAM3X only, see checkpoint.h
+#endif
+
+#ifndef CHECKPOINT_INTERVAL
+#define CHECKPOINT_INTERVAL         10.0                    // {cki: seconds between job checkpoints, 0 = off
+#endif
+
 // *** Gcode Startup Defaults *** //
 
 #ifndef GCODE_DEFAULT_UNITS
@@ -251,6 +517,18 @@
 #ifndef M1_POWER_LEVEL
 #define M1_POWER_LEVEL              0.0                     // {1pl:   0.0=no power, 1.0=max power
 #endif
+#ifndef M1_ENCODER_COUNTS_PER_STEP
+#define M1_ENCODER_COUNTS_PER_STEP  0                       // {1ec:  0=count steps, >0=hardware encoder counts per step
+#endif
+#ifndef M1_STALL_MODE
+#define M1_STALL_MODE               STALL_MODE_OFF          // {1sm:  0=off, 1=sensorless homing, 2=homing and run time stall feedhold
+#endif
+#ifndef M1_STALL_THRESHOLD
+#define M1_STALL_THRESHOLD          0                       // {1sg:  -64=most sensitive to 63=least sensitive
+#endif
+#ifndef M1_SQUARING_OFFSET
+#define M1_SQUARING_OFFSET          0.0                     // {1sq:  mm the motor is stepped alone after a gantry homing latch (see cycle_homing.cpp)
+#endif
 
 // MOTOR 2
 #ifndef M2_MOTOR_MAP
@@ -283,6 +561,18 @@
 #ifndef M2_POWER_LEVEL
 #define M2_POWER_LEVEL              0.0
 #endif
+#ifndef M2_ENCODER_COUNTS_PER_STEP
+#define M2_ENCODER_COUNTS_PER_STEP  0
+#endif
+#ifndef M2_STALL_MODE
+#define M2_STALL_MODE               STALL_MODE_OFF
+#endif
+#ifndef M2_STALL_THRESHOLD
+#define M2_STALL_THRESHOLD          0
+#endif
+#ifndef M2_SQUARING_OFFSET
+#define M2_SQUARING_OFFSET          0.0
+#endif
 
 // MOTOR 3
 #ifndef M3_MOTOR_MAP
@@ -315,6 +605,18 @@
 #ifndef M3_POWER_LEVEL
 #define M3_POWER_LEVEL              0.0
 #endif
+#ifndef M3_ENCODER_COUNTS_PER_STEP
+#define M3_ENCODER_COUNTS_PER_STEP  0
+#endif
+#ifndef M3_STALL_MODE
+#define M3_STALL_MODE               STALL_MODE_OFF
+#endif
+#ifndef M3_STALL_THRESHOLD
+#define M3_STALL_THRESHOLD          0
+#endif
+#ifndef M3_SQUARING_OFFSET
+#define M3_SQUARING_OFFSET          0.0
+#endif
 
 // MOTOR 4
 #ifndef M4_MOTOR_MAP
@@ -347,6 +649,18 @@
 #ifndef M4_POWER_LEVEL
 #define M4_POWER_LEVEL              0.0
 #endif
+#ifndef M4_ENCODER_COUNTS_PER_STEP
+#define M4_ENCODER_COUNTS_PER_STEP  0
+#endif
+#ifndef M4_STALL_MODE
+#define M4_STALL_MODE               STALL_MODE_OFF
+#endif
+#ifndef M4_STALL_THRESHOLD
+#define M4_STALL_THRESHOLD          0
+#endif
+#ifndef M4_SQUARING_OFFSET
+#define M4_SQUARING_OFFSET          0.0
+#endif
 
 // MOTOR 5
 #ifndef M5_MOTOR_MAP
@@ -379,6 +693,18 @@
 #ifndef M5_POWER_LEVEL
 #define M5_POWER_LEVEL              0.0
 #endif
+#ifndef M5_ENCODER_COUNTS_PER_STEP
+#define M5_ENCODER_COUNTS_PER_STEP  0
+#endif
+#ifndef M5_STALL_MODE
+#define M5_STALL_MODE               STALL_MODE_OFF
+#endif
+#ifndef M5_STALL_THRESHOLD
+#define M5_STALL_THRESHOLD          0
+#endif
+#ifndef M5_SQUARING_OFFSET
+#define M5_SQUARING_OFFSET          0.0
+#endif
 
 // MOTOR 6
 #ifndef M6_MOTOR_MAP
@@ -411,6 +737,150 @@
 #ifndef M6_POWER_LEVEL
 #define M6_POWER_LEVEL              0.0
 #endif
+#ifndef M6_ENCODER_COUNTS_PER_STEP
+#define M6_ENCODER_COUNTS_PER_STEP  0
+#endif
+#ifndef M6_STALL_MODE
+#define M6_STALL_MODE               STALL_MODE_OFF
+#endif
+#ifndef M6_STALL_THRESHOLD
+#define M6_STALL_THRESHOLD          0
+#endif
+#ifndef M6_SQUARING_OFFSET
+#define M6_SQUARING_OFFSET          0.0
+#endif
+
+// MOTOR 7
+#ifndef M7_MOTOR_MAP
+#define M7_MOTOR_MAP                AXIS_U_EXTERNAL
+#endif
+#ifndef M7_STEP_ANGLE
+#define M7_STEP_ANGLE               1.8
+#endif
+#ifndef M7_TRAVEL_PER_REV
+#define M7_TRAVEL_PER_REV           1.25
+#endif
+#ifndef M7_MICROSTEPS
+#define M7_MICROSTEPS               8
+#endif
+#ifndef M7_STEPS_PER_UNIT
+#define M7_STEPS_PER_UNIT           0
+#endif
+#ifndef M7_POLARITY
+#define M7_POLARITY                 0
+#endif
+#ifndef M7_ENABLE_POLARITY
+#define M7_ENABLE_POLARITY          IO_ACTIVE_LOW
+#endif
+#ifndef M7_STEP_POLARITY
+#define M7_STEP_POLARITY            IO_ACTIVE_HIGH
+#endif
+#ifndef M7_POWER_MODE
+#define M7_POWER_MODE               MOTOR_DISABLED
+#endif
+#ifndef M7_POWER_LEVEL
+#define M7_POWER_LEVEL              0.0
+#endif
+#ifndef M7_ENCODER_COUNTS_PER_STEP
+#define M7_ENCODER_COUNTS_PER_STEP  0
+#endif
+#ifndef M7_STALL_MODE
+#define M7_STALL_MODE               STALL_MODE_OFF
+#endif
+#ifndef M7_STALL_THRESHOLD
+#define M7_STALL_THRESHOLD          0
+#endif
+#ifndef M7_SQUARING_OFFSET
+#define M7_SQUARING_OFFSET          0.0
+#endif
+
+// MOTOR 8
+#ifndef M8_MOTOR_MAP
+#define M8_MOTOR_MAP                AXIS_V_EXTERNAL
+#endif
+#ifndef M8_STEP_ANGLE
+#define M8_STEP_ANGLE               1.8
+#endif
+#ifndef M8_TRAVEL_PER_REV
+#define M8_TRAVEL_PER_REV           1.25
+#endif
+#ifndef M8_MICROSTEPS
+#define M8_MICROSTEPS               8
+#endif
+#ifndef M8_STEPS_PER_UNIT
+#define M8_STEPS_PER_UNIT           0
+#endif
+#ifndef M8_POLARITY
+#define M8_POLARITY                 0
+#endif
+#ifndef M8_ENABLE_POLARITY
+#define M8_ENABLE_POLARITY          IO_ACTIVE_LOW
+#endif
+#ifndef M8_STEP_POLARITY
+#define M8_STEP_POLARITY            IO_ACTIVE_HIGH
+#endif
+#ifndef M8_POWER_MODE
+#define M8_POWER_MODE               MOTOR_DISABLED
+#endif
+#ifndef M8_POWER_LEVEL
+#define M8_POWER_LEVEL              0.0
+#endif
+#ifndef M8_ENCODER_COUNTS_PER_STEP
+#define M8_ENCODER_COUNTS_PER_STEP  0
+#endif
+#ifndef M8_STALL_MODE
+#define M8_STALL_MODE               STALL_MODE_OFF
+#endif
+#ifndef M8_STALL_THRESHOLD
+#define M8_STALL_THRESHOLD          0
+#endif
+#ifndef M8_SQUARING_OFFSET
+#define M8_SQUARING_OFFSET          0.0
+#endif
+
+// MOTOR 9
+#ifndef M9_MOTOR_MAP
+#define M9_MOTOR_MAP                AXIS_W_EXTERNAL
+#endif
+#ifndef M9_STEP_ANGLE
+#define M9_STEP_ANGLE               1.8
+#endif
+#ifndef M9_TRAVEL_PER_REV
+#define M9_TRAVEL_PER_REV           1.25
+#endif
+#ifndef M9_MICROSTEPS
+#define M9_MICROSTEPS               8
+#endif
+#ifndef M9_STEPS_PER_UNIT
+#define M9_STEPS_PER_UNIT           0
+#endif
+#ifndef M9_POLARITY
+#define M9_POLARITY                 0
+#endif
+#ifndef M9_ENABLE_POLARITY
+#define M9_ENABLE_POLARITY          IO_ACTIVE_LOW
+#endif
+#ifndef M9_STEP_POLARITY
+#define M9_STEP_POLARITY            IO_ACTIVE_HIGH
+#endif
+#ifndef M9_POWER_MODE
+#define M9_POWER_MODE               MOTOR_DISABLED
+#endif
+#ifndef M9_POWER_LEVEL
+#define M9_POWER_LEVEL              0.0
+#endif
+#ifndef M9_ENCODER_COUNTS_PER_STEP
+#define M9_ENCODER_COUNTS_PER_STEP  0
+#endif
+#ifndef M9_STALL_MODE
+#define M9_STALL_MODE               STALL_MODE_OFF
+#endif
+#ifndef M9_STALL_THRESHOLD
+#define M9_STALL_THRESHOLD          0
+#endif
+#ifndef M9_SQUARING_OFFSET
+#define M9_SQUARING_OFFSET          0.0
+#endif
 
 //*****************************************************************************
 //*** Axis Settings ***********************************************************
@@ -438,9 +908,24 @@
 #ifndef X_JERK_HIGH_SPEED
 #define X_JERK_HIGH_SPEED           1000.0                  // {xjh:
 #endif
+#ifndef X_ACCEL_MAX
+#define X_ACCEL_MAX                 0.0                     // {xac:  thousands of mm/min^2, 0 for jerk limit only
+#endif
+#ifndef X_BACKLASH
+#define X_BACKLASH                  0.0                     // {xbl:  mm taken up in the steps on reversal, 0 for none
+#endif
+#ifndef X_SHAPER_FREQUENCY
+#define X_SHAPER_FREQUENCY          0.0                     // {xsf:  Hz, 0 for no input shaping
+#endif
+#ifndef X_SHAPER_DAMPING
+#define X_SHAPER_DAMPING            0.1                     // {xsz:  damping ratio
+#endif
 #ifndef X_HOMING_INPUT
 #define X_HOMING_INPUT              0                       // {xhi:  input used for homing or 0 to disable
 #endif
+#ifndef X_HOMING_INPUT_2
+#define X_HOMING_INPUT_2            0                       // {xhs:  second homing input for a squared gantry or 0 for none
+#endif
 #ifndef X_HOMING_DIRECTION
 #define X_HOMING_DIRECTION          0                       // {xhd:  0=search moves negative, 1= search moves positive
 #endif
@@ -479,9 +964,24 @@
 #ifndef Y_JERK_HIGH_SPEED
 #define Y_JERK_HIGH_SPEED           1000.0
 #endif
+#ifndef Y_ACCEL_MAX
+#define Y_ACCEL_MAX                 0.0
+#endif
+#ifndef Y_BACKLASH
+#define Y_BACKLASH                  0.0
+#endif
+#ifndef Y_SHAPER_FREQUENCY
+#define Y_SHAPER_FREQUENCY          0.0
+#endif
+#ifndef Y_SHAPER_DAMPING
+#define Y_SHAPER_DAMPING            0.1
+#endif
 #ifndef Y_HOMING_INPUT
 #define Y_HOMING_INPUT              0
 #endif
+#ifndef Y_HOMING_INPUT_2
+#define Y_HOMING_INPUT_2            0                       // {yhs:  second homing input for a squared gantry or 0 for none
+#endif
 #ifndef Y_HOMING_DIRECTION
 #define Y_HOMING_DIRECTION          0
 #endif
@@ -520,9 +1020,24 @@
 #ifndef Z_JERK_HIGH_SPEED
 #define Z_JERK_HIGH_SPEED           500.0
 #endif
+#ifndef Z_ACCEL_MAX
+#define Z_ACCEL_MAX                 0.0
+#endif
+#ifndef Z_BACKLASH
+#define Z_BACKLASH                  0.0
+#endif
+#ifndef Z_SHAPER_FREQUENCY
+#define Z_SHAPER_FREQUENCY          0.0
+#endif
+#ifndef Z_SHAPER_DAMPING
+#define Z_SHAPER_DAMPING            0.1
+#endif
 #ifndef Z_HOMING_INPUT
 #define Z_HOMING_INPUT              0
 #endif
+#ifndef Z_HOMING_INPUT_2
+#define Z_HOMING_INPUT_2            0                       // {zhs:  second homing input for a squared gantry or 0 for none
+#endif
 #ifndef Z_HOMING_DIRECTION
 #define Z_HOMING_DIRECTION          0
 #endif
@@ -561,9 +1076,18 @@
 #ifndef U_JERK_HIGH_SPEED
 #define U_JERK_HIGH_SPEED           1000.0                  // {xjh:
 #endif
+#ifndef U_ACCEL_MAX
+#define U_ACCEL_MAX                 0.0
+#endif
+#ifndef U_BACKLASH
+#define U_BACKLASH                  0.0
+#endif
 #ifndef U_HOMING_INPUT
 #define U_HOMING_INPUT              0                       // {xhi:  input used for homing or 0 to disable
 #endif
+#ifndef U_HOMING_INPUT_2
+#define U_HOMING_INPUT_2            0                       // {uhs:  second homing input for a squared gantry or 0 for none
+#endif
 #ifndef U_HOMING_DIRECTION
 #define U_HOMING_DIRECTION          0                       // {xhd:  0=search moves negative, 1= search moves positive
 #endif
@@ -602,9 +1126,18 @@
 #ifndef V_JERK_HIGH_SPEED
 #define V_JERK_HIGH_SPEED           1000.0
 #endif
+#ifndef V_ACCEL_MAX
+#define V_ACCEL_MAX                 0.0
+#endif
+#ifndef V_BACKLASH
+#define V_BACKLASH                  0.0
+#endif
 #ifndef V_HOMING_INPUT
 #define V_HOMING_INPUT              0
 #endif
+#ifndef V_HOMING_INPUT_2
+#define V_HOMING_INPUT_2            0                       // {vhs:  second homing input for a squared gantry or 0 for none
+#endif
 #ifndef V_HOMING_DIRECTION
 #define V_HOMING_DIRECTION          0
 #endif
@@ -643,9 +1176,18 @@
 #ifndef W_JERK_HIGH_SPEED
 #define W_JERK_HIGH_SPEED           500.0
 #endif
+#ifndef W_ACCEL_MAX
+#define W_ACCEL_MAX                 0.0
+#endif
+#ifndef W_BACKLASH
+#define W_BACKLASH                  0.0
+#endif
 #ifndef W_HOMING_INPUT
 #define W_HOMING_INPUT              0
 #endif
+#ifndef W_HOMING_INPUT_2
+#define W_HOMING_INPUT_2            0                       // {whs:  second homing input for a squared gantry or 0 for none
+#endif
 #ifndef W_HOMING_DIRECTION
 #define W_HOMING_DIRECTION          0
 #endif
@@ -719,9 +1261,18 @@
 #ifndef A_JERK_HIGH_SPEED
 #define A_JERK_HIGH_SPEED           A_JERK_MAX
 #endif
+#ifndef A_ACCEL_MAX
+#define A_ACCEL_MAX                 0.0
+#endif
+#ifndef A_BACKLASH
+#define A_BACKLASH                  0.0
+#endif
 #ifndef A_HOMING_INPUT
 #define A_HOMING_INPUT              0
 #endif
+#ifndef A_HOMING_INPUT_2
+#define A_HOMING_INPUT_2            0                       // {ahs:  second homing input for a squared gantry or 0 for none
+#endif
 #ifndef A_HOMING_DIRECTION
 #define A_HOMING_DIRECTION          0
 #endif
@@ -763,9 +1314,18 @@
 #ifndef B_JERK_HIGH_SPEED
 #define B_JERK_HIGH_SPEED           B_JERK_MAX
 #endif
+#ifndef B_ACCEL_MAX
+#define B_ACCEL_MAX                 0.0
+#endif
+#ifndef B_BACKLASH
+#define B_BACKLASH                  0.0
+#endif
 #ifndef B_HOMING_INPUT
 #define B_HOMING_INPUT              0
 #endif
+#ifndef B_HOMING_INPUT_2
+#define B_HOMING_INPUT_2            0                       // {bhs:  second homing input for a squared gantry or 0 for none
+#endif
 #ifndef B_HOMING_DIRECTION
 #define B_HOMING_DIRECTION          0
 #endif
@@ -807,9 +1367,18 @@
 #ifndef C_JERK_HIGH_SPEED
 #define C_JERK_HIGH_SPEED           C_JERK_MAX
 #endif
+#ifndef C_ACCEL_MAX
+#define C_ACCEL_MAX                 0.0
+#endif
+#ifndef C_BACKLASH
+#define C_BACKLASH                  0.0
+#endif
 #ifndef C_HOMING_INPUT
 #define C_HOMING_INPUT              0
 #endif
+#ifndef C_HOMING_INPUT_2
+#define C_HOMING_INPUT_2            0                       // {chs:  second homing input for a squared gantry or 0 for none
+#endif
 #ifndef C_HOMING_DIRECTION
 #define C_HOMING_DIRECTION          0
 #endif
@@ -845,12 +1414,16 @@
     INPUT_ACTION_FAST_STOP
     INPUT_ACTION_HALT
     INPUT_ACTION_RESET
+    INPUT_ACTION_HALT_STEPS
 
     INPUT_FUNCTION_NONE
     INPUT_FUNCTION_LIMIT
     INPUT_FUNCTION_INTERLOCK
     INPUT_FUNCTION_SHUTDOWN
     INPUT_FUNCTION_PANIC
+    INPUT_FUNCTION_SYNC_CLOCK
+    INPUT_FUNCTION_SYNC_RUN
+    INPUT_FUNCTION_SPINDLE_INDEX
 */
 
 // Xmin on v9 board
@@ -1073,6 +1646,42 @@
 #define P1_PWM_PHASE_OFF            0.1
 #endif
 
+// PWM 2 starts out the same as PWM 1. A tool is mapped to it with {ttNpw:2}
+#ifndef P2_PWM_FREQUENCY
+#define P2_PWM_FREQUENCY            P1_PWM_FREQUENCY
+#endif
+#ifndef P2_CW_SPEED_LO
+#define P2_CW_SPEED_LO              P1_CW_SPEED_LO
+#endif
+#ifndef P2_CW_SPEED_HI
+#define P2_CW_SPEED_HI              P1_CW_SPEED_HI
+#endif
+#ifndef P2_CW_PHASE_LO
+#define P2_CW_PHASE_LO              P1_CW_PHASE_LO
+#endif
+#ifndef P2_CW_PHASE_HI
+#define P2_CW_PHASE_HI              P1_CW_PHASE_HI
+#endif
+#ifndef P2_CCW_SPEED_LO
+#define P2_CCW_SPEED_LO             P1_CCW_SPEED_LO
+#endif
+#ifndef P2_CCW_SPEED_HI
+#define P2_CCW_SPEED_HI             P1_CCW_SPEED_HI
+#endif
+#ifndef P2_CCW_PHASE_LO
+#define P2_CCW_PHASE_LO             P1_CCW_PHASE_LO
+#endif
+#ifndef P2_CCW_PHASE_HI
+#define P2_CCW_PHASE_HI             P1_CCW_PHASE_HI
+#endif
+#ifndef P2_PWM_PHASE_OFF
+#define P2_PWM_PHASE_OFF            P1_PWM_PHASE_OFF
+#endif
+
+#ifndef TOOL_PWM_CHANNEL
+#define TOOL_PWM_CHANNEL            1                       // {ttNpw: PWM channel a tool's spindle or laser runs on
+#endif
+
 // *** Heater Settings - relevant to 3dp machines *** //
 
 
@@ -1127,6 +1736,45 @@
 #define H3_DEFAULT_D                400.0
 #endif
 
+#ifndef H4_DEFAULT_ENABLE
+#define H4_DEFAULT_ENABLE           false
+#endif
+#ifndef H4_DEFAULT_P
+#define H4_DEFAULT_P                9.0
+#endif
+#ifndef H4_DEFAULT_I
+#define H4_DEFAULT_I                0.12
+#endif
+#ifndef H4_DEFAULT_D
+#define H4_DEFAULT_D                400.0
+#endif
+
+#ifndef H5_DEFAULT_ENABLE
+#define H5_DEFAULT_ENABLE           false
+#endif
+#ifndef H5_DEFAULT_P
+#define H5_DEFAULT_P                9.0
+#endif
+#ifndef H5_DEFAULT_I
+#define H5_DEFAULT_I                0.12
+#endif
+#ifndef H5_DEFAULT_D
+#define H5_DEFAULT_D                400.0
+#endif
+
+#ifndef H6_DEFAULT_ENABLE
+#define H6_DEFAULT_ENABLE           false
+#endif
+#ifndef H6_DEFAULT_P
+#define H6_DEFAULT_P                9.0
+#endif
+#ifndef H6_DEFAULT_I
+#define H6_DEFAULT_I                0.12
+#endif
+#ifndef H6_DEFAULT_D
+#define H6_DEFAULT_D                400.0
+#endif
+
 // *** DEFAULT COORDINATE SYSTEM OFFSETS ***
 
 #ifndef G54_X_OFFSET
@@ -1326,6 +1974,9 @@
 #ifndef TT1_C_OFFSET
 #define TT1_C_OFFSET 0
 #endif
+#ifndef TT1_PRESSURE_ADVANCE
+#define TT1_PRESSURE_ADVANCE 0                              // {tt1k: seconds of extruder velocity, 0 for none
+#endif
 
 #ifndef TT2_X_OFFSET
 #define TT2_X_OFFSET 0
@@ -1354,6 +2005,9 @@
 #ifndef TT2_C_OFFSET
 #define TT2_C_OFFSET 0
 #endif
+#ifndef TT2_PRESSURE_ADVANCE
+#define TT2_PRESSURE_ADVANCE 0
+#endif
 
 #ifndef TT3_X_OFFSET
 #define TT3_X_OFFSET 0
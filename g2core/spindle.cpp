@@ -36,6 +36,7 @@
 #include "settings.h"
 #include "pwm.h"
 #include "util.h"
+#include "gpio.h"
 
 /**** Allocate structures ****/
 
@@ -44,6 +45,39 @@ spSpindle_t spindle;
 /**** Static functions ****/
 
 static float _get_spindle_pwm (spSpindle_t &_spindle, pwmControl_t &_pwm);
+static void _set_spindle_pwm(void);
+static void _spinup_delay(const bool overlap);
+static bool _spinup_overlaps(void);
+static stat_t _spindle_surface_speed_sync(float speed);
+
+// Tachometer pulse timing, written from the input ISR
+static volatile uint32_t tach_last_pulse;   // cycle count at the last pulse
+static volatile uint32_t tach_period;       // cycles between the last two pulses, 0 if unknown
+static Motate::Timeout at_speed_timeout;    // limit on spindle.at_speed_wait
+static uint32_t spinup_ready_ms;            // SysTick time an overlapped spinup ends
+
+// Spindle index timing, written from the input ISR
+static volatile uint32_t index_count;       // index pulses seen
+static volatile uint32_t index_last;        // cycle count at the last index
+static volatile uint32_t index_period;      // cycles between the last two, 0 if unknown
+
+// Spindle synchronized motion, run from the exec and prep
+static struct spSync {
+    bool armed;                             // a queued wait is looking for the next index
+    bool active;                            // segment times are locked to the spindle
+    uint32_t arm_count;                     // index count when the wait was armed
+    float start_revs;                       // revolution count at the index the move started on
+    float planned_rps;                      // spindle speed the move was planned for
+    float planned_revs;                     // revolutions the planned segment times account for
+    Motate::Timeout timeout;                // limit on the wait for an index
+} sp_sync;
+
+// Spindle override ramp, stepped by the segment exec
+static struct spOverrideRamp {
+    volatile float target;                  // factor to ramp to - set by the main loop
+    volatile float dvdt;                    // factor change per minute
+    float factor;                           // factor applied to the PWM
+} sp_ovr = { 1.0, 0, 1.0 };
 
 #define SPINDLE_DIRECTION_ASSERT \
     if ((spindle.direction < SPINDLE_CW) || (spindle.direction > SPINDLE_CCW)) { \
@@ -58,15 +92,23 @@ void spindle_init()
 {
     SPINDLE_DIRECTION_ASSERT        // spindle needs an initial direction
     
-    if( pwm.c[PWM_1].frequency < 0 ) {
-        pwm.c[PWM_1].frequency = 0;
+    for (uint8_t chan = 0; chan < PWMS; chan++) {
+        if( pwm.c[chan].frequency < 0 ) {
+            pwm.c[chan].frequency = 0;
+        }
+        pwm_set_freq(chan, pwm.c[chan].frequency);
+        pwm_set_duty(chan, pwm.c[chan].phase_off);
     }
-    pwm_set_freq(PWM_1, pwm.c[PWM_1].frequency);
-    pwm_set_duty(PWM_1, pwm.c[PWM_1].phase_off);
+    spindle.raster_phase_off = pwm.c[spindle.pwm_channel].phase_off;
+    spindle.raster_phase_span = 0;
 }
 
 void spindle_reset()
 {
+    spindle_sync_end();
+    spindle.spinup_planned = false;
+    spindle.speed_mode = SPINDLE_SPEED_RPM;
+    spindle.planned_speed_mode = SPINDLE_SPEED_RPM;
     spindle_speed_immediate(0);
     spindle_control_immediate(SPINDLE_OFF);
 }
@@ -91,7 +133,8 @@ void spindle_reset()
  *      following the spindle change, but only if the planner had planned the spindle 
  *      operation to zero. (I.e. if the spindle controls / S words do not plan to zero 
  *      the delay is not run). Spindle_control_immediate() has no spinup delay or 
- *      dwell behavior.
+ *      dwell behavior. With {spup:1} the delay is overlapped with motion instead - see
+ *      spindle_spinup_wait_sync().
  *
  *    - SPINDLE_PAUSE is only applicable to CW and CCW states. It forces the spindle OFF and 
  *      sets spindle.state to PAUSE. A PAUSE received when not in CW or CCW state is ignored.
@@ -99,7 +142,7 @@ void spindle_reset()
  *    - SPINDLE_RESUME, if in a PAUSE state, reverts to previous SPINDLE_CW or SPINDLE_CCW.
  *      The SPEED is not changed, and if it were changed in the interim the "new" speed 
  *      is used. If RESUME is received from spindle_control_sync() the usual spinup delay 
- *      behavior occurs. If RESUME is received when not in a PAUSED state it is ignored. 
+ *      behavior occurs, and is never overlapped. If RESUME is received when not in a PAUSED state it is ignored. 
  *      This recognizes that the main reason an immediate command would be issued - either 
  *      manually by the user or by an alarm or some other program function - is to stop 
  *      a spindle. So the Resume should be ignored for safety.
@@ -165,6 +208,7 @@ static void _exec_spindle_control(float *value, bool *flag)
     int8_t enable_bit = 0;                  // default to 0=off
     int8_t dir_bit = -1;                    // -1 will skip setting the direction. 0 & 1 are valid values
     bool spinup_delay = false;
+    bool overlap = (value[1] != 0);         // only set for CW and CCW
 
     switch (action) {
         case SPINDLE_NOP: { return; }
@@ -191,6 +235,7 @@ static void _exec_spindle_control(float *value, bool *flag)
             dir_bit = spindle.direction-1;  // spindle direction was stored as '1' & '2'
             spindle.state = spindle.direction;
             spinup_delay = true;
+            overlap = false;                // resuming from a hold waits out the spinup
             break; 
         }
         default: {}                         // reversals not handled yet
@@ -213,10 +258,12 @@ static void _exec_spindle_control(float *value, bool *flag)
     } else {
         spindle_enable_pin.set();           // drive pin HI
     }
-    pwm_set_duty(PWM_1, _get_spindle_pwm(spindle, pwm));
+    _set_spindle_pwm();
 
     if (spinup_delay) {
-        mp_request_out_of_band_dwell(spindle.spinup_delay);
+        _spinup_delay(overlap);
+    } else {
+        spindle.at_speed_wait = false;      // stopped or paused - nothing to wait for
     }
 }
 
@@ -227,7 +274,7 @@ static void _exec_spindle_control(float *value, bool *flag)
 
 stat_t spindle_control_immediate(spControl control)
 {
-    float value[] = { (float)control };
+    float value[] = { (float)control, 0 };
     _exec_spindle_control(value, nullptr);
     return(STAT_OK);
 }
@@ -240,8 +287,10 @@ stat_t spindle_control_sync(spControl control)  // uses spControl arg: OFF, CW,
     }
     
     // queue the spindle control
-    float value[] = { (float)control };
+    bool overlap = _spinup_overlaps() && ((control == SPINDLE_CW) || (control == SPINDLE_CCW));
+    float value[] = { (float)control, (float)overlap };
     mp_queue_command(_exec_spindle_control, value, nullptr);
+    spindle.spinup_planned |= overlap;
     return(STAT_OK);
 }
 
@@ -259,10 +308,11 @@ static void _exec_spindle_speed(float *value, bool *flag)
     float previous_speed = spindle.speed;
 
     spindle.speed = value[0];
-    pwm_set_duty(PWM_1, _get_spindle_pwm(spindle, pwm));
+    _set_spindle_pwm();
 
-    if (fp_ZERO(previous_speed)) {
-        mp_request_out_of_band_dwell(spindle.spinup_delay);
+    if (fp_ZERO(previous_speed) || (fp_NOT_ZERO(spindle.tach_ppr) &&
+        ((spindle.state == SPINDLE_CW) || (spindle.state == SPINDLE_CCW)))) {
+        _spinup_delay(value[1] != 0);       // with a tach any change of speed waits for the spindle
     }
 }
 
@@ -276,36 +326,428 @@ static stat_t _casey_jones(float speed)
 stat_t spindle_speed_immediate(float speed)
 {
     ritorno(_casey_jones(speed));
-    float value[] = { speed };
+    float value[] = { speed, 0 };
+    spindle.planned_speed = speed;
     _exec_spindle_speed(value, nullptr);
     return (STAT_OK);
 }
 
 stat_t spindle_speed_sync(float speed)
 {
+    if (spindle.planned_speed_mode == SPINDLE_SPEED_CSS) {
+        return (_spindle_surface_speed_sync(speed));
+    }
     ritorno(_casey_jones(speed));
-    float value[] = { speed };
+    bool overlap = _spinup_overlaps() && (fp_ZERO(spindle.planned_speed) || fp_NOT_ZERO(spindle.tach_ppr));
+    float value[] = { speed, (float)overlap };
+    spindle.planned_speed = speed;
     mp_queue_command(_exec_spindle_speed, value, nullptr);
+    spindle.spinup_planned |= overlap;
     return (STAT_OK);
 }
 
 /****************************************************************************************
- * _get_spindle_pwm() - return PWM phase (duty cycle) for dir and speed
+ * _exec_spindle_speed_mode()    - switch between RPM and constant surface speed
+ * _exec_surface_speed()         - set the surface speed
+ * _spindle_surface_speed_sync() - queue a G96 S word
+ * spindle_speed_mode_sync()     - queue G96 or G97
+ * spindle_css_update()          - set the spindle speed for the radius of a segment
+ *
+ *  In G96 the S word is a surface speed - m/min in G21 and ft/min in G20 - and the
+ *  spindle is run at the RPM that gives that speed at the tool's X radius, which is its
+ *  distance from X0 of the work coordinates. The segment runner calls spindle_css_update()
+ *  with the X of every segment it loads, so the spindle speeds up through a facing pass
+ *  as the tool moves in. The duty cycle is posted for the loader (pwm_post_duty()) so it
+ *  changes as that segment starts, not as it is computed. The speed is held in {spsn:} to
+ *  {spsm:} (and the PWM's speed range), which caps it near the center. Changes smaller than
+ *  SPINDLE_CSS_DEADBAND are not sent. The speed is set directly, not through S, so it
+ *  doesn't run the spinup wait.
+ *
+ *  G97 returns S to RPM, leaving the spindle at the last speed until the next S word.
+ */
+
+static void _exec_spindle_speed_mode(float *value, bool *flag)
+{
+    spindle.speed_mode = (spSpeedMode)value[0];
+    if (spindle.speed_mode == SPINDLE_SPEED_CSS) {
+        spindle_css_update(mp_get_runtime_display_position(AXIS_X));
+        pwm_latch();                            // commands run from the loader - apply it now
+    }
+}
+
+static void _exec_surface_speed(float *value, bool *flag)
+{
+    spindle.surface_speed = value[0];
+    spindle_css_update(mp_get_runtime_display_position(AXIS_X));
+    pwm_latch();
+}
+
+static stat_t _spindle_surface_speed_sync(float speed)
+{
+    if (speed < 0) {
+        return (STAT_S_WORD_IS_INVALID);
+    }
+    float value[] = { (cm->gm.units_mode == INCHES) ? (speed * 12 * MM_PER_INCH) : (speed * 1000) };
+    mp_queue_command(_exec_surface_speed, value, nullptr);
+    return (STAT_OK);
+}
+
+stat_t spindle_speed_mode_sync(uint8_t mode)
+{
+    spindle.planned_speed_mode = (spSpeedMode)mode;
+    float value[] = { (float)mode };
+    mp_queue_command(_exec_spindle_speed_mode, value, nullptr);
+    return (STAT_OK);
+}
+
+void spindle_css_update(const float radius)
+{
+    if ((spindle.speed_mode != SPINDLE_SPEED_CSS) ||
+        ((spindle.state != SPINDLE_CW) && (spindle.state != SPINDLE_CCW))) {
+        return;
+    }
+    float r = fabs(radius);
+    float speed = (r > EPSILON) ? (spindle.surface_speed / (2 * M_PI * r)) : spindle.speed_max;
+    speed = min(max(speed, spindle.speed_min), spindle.speed_max);
+    if (fabs(speed - spindle.speed) < SPINDLE_CSS_DEADBAND) {
+        return;
+    }
+    spindle.speed = speed;
+    float duty = _get_spindle_pwm(spindle, pwm);
+    spindle.raster_phase_span = duty - spindle.raster_phase_off;
+    pwm_post_duty(spindle.pwm_channel, duty);   // the loader applies it as the segment starts
+}
+
+/****************************************************************************************
+ * _spinup_delay()            - hold motion after a spindle start or speed change
+ * spindle_tach_pulse()       - time a tachometer pulse
+ * spindle_get_actual_speed() - return the spindle speed read by the tachometer (RPM)
+ * spindle_is_spinning_up()   - return true while motion must wait for the spindle
+ *
+ *  Without a tachometer the spindle waits out the fixed spinup delay {spde:}. With one
+ *  ({sptp:} > 0 and an input set to the tach function) motion is held only until the
+ *  measured speed is within {spat:} of S. mp_exec_move() polls spindle_is_spinning_up()
+ *  between short out-of-band dwells, so the wait ends within SPINDLE_AT_SPEED_POLL_MS of
+ *  the spindle reaching speed. Failing to get there in SPINDLE_AT_SPEED_TIMEOUT_MS alarms.
+ *
+ *  The tach input timestamps each leading edge with the CPU cycle counter, which is finer
+ *  than a millisecond tick and works as a timer capture at any practical pulse rate.
+ */
+
+static void _spinup_delay(const bool overlap)
+{
+    if (fp_ZERO(spindle.tach_ppr)) {
+        if (overlap) {
+            spindle_spinup_start(spindle.spinup_delay);
+        } else {
+            mp_request_out_of_band_dwell(spindle.spinup_delay);
+        }
+        return;
+    }
+    spindle.at_speed_wait = true;
+    spindle.at_speed_overlap = overlap;
+    at_speed_timeout.set(SPINDLE_AT_SPEED_TIMEOUT_MS);
+}
+
+void spindle_tach_pulse(const uint32_t cycles)
+{
+    tach_period = cycles - tach_last_pulse;
+    tach_last_pulse = cycles;
+}
+
+float spindle_get_actual_speed()
+{
+    uint32_t period = tach_period;
+    if ((period == 0) || fp_ZERO(spindle.tach_ppr) ||
+        (cycles_to_usec(cycle_count() - tach_last_pulse) > (SPINDLE_TACH_STALE_MS * 1000.0))) {
+        return (0);
+    }
+    return (60000000.0 / (cycles_to_usec(period) * spindle.tach_ppr));
+}
+
+static bool _spinning_up()
+{
+    if (!spindle.at_speed_wait) {
+        return (false);
+    }
+    if ((spindle.state != SPINDLE_CW) && (spindle.state != SPINDLE_CCW)) {
+        spindle.at_speed_wait = false;
+        return (false);
+    }
+    if (fabs(spindle_get_actual_speed() - spindle.speed) <= (spindle.speed * spindle.at_speed_tolerance)) {
+        spindle.at_speed_wait = false;
+        return (false);
+    }
+    if (at_speed_timeout.isPast()) {
+        spindle.at_speed_wait = false;
+        cm_alarm(STAT_SPINDLE_NOT_AT_SPEED, "spindle tach");
+        return (false);
+    }
+    return (true);
+}
+
+bool spindle_is_spinning_up()
+{
+    if (spindle.at_speed_overlap) {         // left to the queued wait
+        return (false);
+    }
+    return (_spinning_up());
+}
+
+/****************************************************************************************
+ * _spinup_overlaps()          - true if a spindle start should be overlapped with motion
+ * spindle_spinup_start()      - start or extend an overlapped spinup - called from execs
+ * _spinup_wait()              - wait condition: the spinup is over
+ * spindle_spinup_wait_sync()  - queue the wait for a spinup ahead of a feed
+ *
+ *  Usually a spindle start holds all motion for its spinup. With {spup:1} an M3/M4 or
+ *  an S word that starts the spindle only marks a spinup as planned. Traverses queued
+ *  behind it run while the spindle comes up to speed, and the first feed queues a wait
+ *  in front of itself (from cm_straight_feed() and cm_arc_feed()) that holds the queue
+ *  for whatever is left of the {spde:} delay, or until the tach reads S. Coolant starts
+ *  with a delay {cosu:} share the same window, which ends at the later of the two.
+ *
+ *  The wait is a command block, so the feed starts from rest. Resuming from a feedhold
+ *  is never overlapped, as the move it resumes is usually a feed.
+ */
+
+static bool _spinup_overlaps()
+{
+    return (spindle.spinup_overlap &&
+            (fp_NOT_ZERO(spindle.spinup_delay) || fp_NOT_ZERO(spindle.tach_ppr)));
+}
+
+void spindle_spinup_start(const float seconds)
+{
+    uint32_t ready = SysTickTimer_getValue() + (uint32_t)(seconds * 1000);
+    if ((int32_t)(ready - spinup_ready_ms) > 0) {   // a spinup already running may end later
+        spinup_ready_ms = ready;
+    }
+}
+
+static bool _spinup_wait(const float value[])
+{
+    if (_spinning_up()) {                   // alarms and lets go on a tach timeout
+        return (false);
+    }
+    return ((int32_t)(SysTickTimer_getValue() - spinup_ready_ms) >= 0);
+}
+
+stat_t spindle_spinup_wait_sync()
+{
+    if (!spindle.spinup_planned) {
+        return (STAT_OK);
+    }
+    spindle.spinup_planned = false;
+    float value[AXES] = { 0 };
+    mp_queue_wait(_spinup_wait, value);
+    return (STAT_OK);
+}
+
+/****************************************************************************************
+ * spindle_index_pulse()       - time an index pulse
+ * spindle_has_index()         - true if an input is set to the spindle index function
+ * spindle_get_index_speed()   - spindle speed read from the index (revolutions per second)
+ * _get_index_revolutions()    - revolutions seen, including the part since the last index
+ * spindle_sync_wait()         - start a synchronized move on the next index - a queued wait
+ * spindle_sync_end()          - stop locking segment times to the spindle
+ * spindle_sync_segment_time() - a segment time locked to the spindle's phase
+ *
+ *  Spindle synchronized motion (G33) locks the time of a move to the turning spindle, so
+ *  the tool advances one pitch per revolution. The phase reference is a once per rev index
+ *  input, timed with the cycle counter the same way as the tach. Between pulses the phase
+ *  is interpolated from the last period, which is as fine as a timer capture of the index.
+ *
+ *  The move is queued behind a wait (mp_queue_wait()) that holds the queue until the next
+ *  index, so each pass of a thread starts at the same angle. From then on the prep counts
+ *  planned_revs - the revolutions the spindle should have made in the planned time of
+ *  the segments loaded so far. st_prep_line() scales the segment time by the
+ *  ratio of planned to actual spindle speed, trimmed by the phase error spread over
+ *  SPINDLE_SYNC_LOCK_REVS (up to SPINDLE_SYNC_TRIM_MAX), so a spindle that slows under
+ *  the cut slows the move with it. Acceleration at the ends of the move is planned as
+ *  usual; it lands in the same place on every pass because the start is locked.
+ *
+ *  A feedhold drops the lock, as the phase can't be kept through a stop. Feed overrides
+ *  are applied by the planner and stretch the move against the spindle, so they should be
+ *  left at 100% while threading.
+ */
+
+void spindle_index_pulse(const uint32_t cycles)
+{
+    index_period = cycles - index_last;
+    index_last = cycles;
+    index_count++;
+}
+
+bool spindle_has_index()
+{
+    for (uint8_t i = 0; i < D_IN_CHANNELS; i++) {
+        if ((d_in[i].function == INPUT_FUNCTION_SPINDLE_INDEX) && (d_in[i].state != INPUT_DISABLED)) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+float spindle_get_index_speed()
+{
+    uint32_t period = index_period;
+    if ((period == 0) ||
+        (cycles_to_usec(cycle_count() - index_last) > (SPINDLE_TACH_STALE_MS * 1000.0))) {
+        return (0);
+    }
+    return (1000000.0 / cycles_to_usec(period));
+}
+
+static float _get_index_revolutions()
+{
+    uint32_t count;
+    uint32_t last;
+    uint32_t period;
+    do {                                    // the ISR can land between the reads
+        count = index_count;
+        last = index_last;
+        period = index_period;
+    } while (count != index_count);
+
+    float revs = (float)count;
+    if (period != 0) {
+        revs += min((float)(cycle_count() - last) / (float)period, (float)0.999);
+    }
+    return (revs);
+}
+
+bool spindle_sync_wait(const float value[])
+{
+    if (!sp_sync.armed) {
+        sp_sync.armed = true;
+        sp_sync.arm_count = index_count;
+        sp_sync.timeout.set(SPINDLE_SYNC_INDEX_TIMEOUT_MS);
+        return (false);
+    }
+    if (index_count == sp_sync.arm_count) {
+        if (sp_sync.timeout.isPast()) {
+            sp_sync.armed = false;
+            cm_alarm(STAT_SPINDLE_MUST_BE_TURNING, "spindle index");
+            return (true);
+        }
+        return (false);
+    }
+    sp_sync.armed = false;
+    sp_sync.start_revs = (float)sp_sync.arm_count + 1;  // the index that ended the wait
+    sp_sync.planned_rps = value[0];
+    sp_sync.planned_revs = 0;
+    sp_sync.active = true;
+    return (true);
+}
+
+void spindle_sync_end()
+{
+    sp_sync.armed = false;
+    sp_sync.active = false;
+}
+
+float spindle_sync_segment_time(const float segment_time)
+{
+    if (!sp_sync.active) {
+        return (segment_time);
+    }
+    float rps = spindle_get_index_speed();
+    if ((cm1.hold_state != FEEDHOLD_OFF) || (rps == 0)) {
+        sp_sync.active = false;                // the phase is lost - run the rest as planned
+        return (segment_time);
+    }
+    float error = (sp_sync.planned_revs - (_get_index_revolutions() - sp_sync.start_revs)); // + is ahead
+    float trim = min(max(error / SPINDLE_SYNC_LOCK_REVS, -SPINDLE_SYNC_TRIM_MAX), SPINDLE_SYNC_TRIM_MAX);
+    float scale = min(max((sp_sync.planned_rps / rps) * (1 + trim), SPINDLE_SYNC_SCALE_MIN), SPINDLE_SYNC_SCALE_MAX);
+    sp_sync.planned_revs += segment_time * 60 * sp_sync.planned_rps;   // segment time is in minutes
+    return (segment_time * scale);
+}
+
+/****************************************************************************************
+ * _set_spindle_pwm()       - set the PWM for the spindle state and note it for scanlines
+ * spindle_raster_power()   - set the PWM for a scanline pixel (0 - 255)
+ * spindle_raster_end()     - return the PWM to the spindle state after a scanline
+ * spindle_velocity_intensity() - intensity for a feed segment when velocity sync is on
+ *
+ *  The raster functions are called from the stepper loader, so they only scale the duty
+ *  cycle worked out when the spindle was last changed. Spindle commands also run from the
+ *  loader, so the two stay in queue order.
+ *
+ *  Velocity sync is a laser mode that recomputes the power for every segment of a feed
+ *  move so the energy per mm holds through acceleration and deceleration and corners don't
+ *  burn darker. The segment runner passes the ratio of the segment velocity to the block's
+ *  cruise velocity, and the result rides the scanline intensity path to the loader. The
+ *  two-point calibration maps ratio 0 to {spv0:} and ratio 1 to {spv1:} (as fractions of S)
+ *  to take up a laser's non-linear response at low power. Returns -1 if sync is off.
+ */
+
+static void _set_spindle_pwm()
+{
+    float duty = _get_spindle_pwm(spindle, pwm);
+    spindle.raster_phase_off = pwm.c[spindle.pwm_channel].phase_off;
+    spindle.raster_phase_span = duty - spindle.raster_phase_off;
+    pwm_set_duty(spindle.pwm_channel, duty);
+}
+
+void spindle_raster_power(const uint8_t intensity)
+{
+    pwm_set_duty(spindle.pwm_channel, spindle.raster_phase_off + spindle.raster_phase_span * (intensity * (1.0f / 255)));
+}
+
+void spindle_raster_end()
+{
+    pwm_set_duty(spindle.pwm_channel, spindle.raster_phase_off + spindle.raster_phase_span);
+}
+
+/****************************************************************************************
+ * spindle_set_pwm_channel() - drive the spindle from another PWM channel (0 - PWMS-1)
+ *
+ *  Called from M6 with the new tool's {ttNpw:}, in queue order with the other spindle
+ *  commands and the posted duty cycles. The old channel goes to its phase off and the
+ *  new one takes up the spindle state through its own speed range and phase curve, so the
+ *  switch is a few stores and two pin writes. Anything out of range (e.g. T0) leaves the
+ *  channel as it is.
+ */
+
+void spindle_set_pwm_channel(const uint8_t channel)
+{
+    if ((channel >= PWMS) || (channel == spindle.pwm_channel)) {
+        return;
+    }
+    pwm_set_duty(spindle.pwm_channel, pwm.c[spindle.pwm_channel].phase_off);   // also drops a posted duty
+    spindle.pwm_channel = channel;
+    _set_spindle_pwm();
+}
+
+int16_t spindle_velocity_intensity(const float velocity_ratio)
+{
+    if (!spindle.velocity_sync) {
+        return (-1);
+    }
+    float ratio = min(max(velocity_ratio, 0.0f), 1.0f);
+    float power = spindle.velocity_power_lo + (spindle.velocity_power_hi - spindle.velocity_power_lo) * ratio;
+    return ((int16_t)(min(max(power, 0.0f), 1.0f) * 255 + 0.5));
+}
+
+/****************************************************************************************
+ * _get_spindle_pwm() - return PWM phase (duty cycle) for dir and speed on the spindle's channel
  */
 
 static float _get_spindle_pwm (spSpindle_t &_spindle, pwmControl_t &_pwm)
 {
+    const pwmConfigChannel_t &c = _pwm.c[_spindle.pwm_channel];
     float speed_lo, speed_hi, phase_lo, phase_hi;
     if (_spindle.direction == SPINDLE_CW ) {
-        speed_lo = _pwm.c[PWM_1].cw_speed_lo;
-        speed_hi = _pwm.c[PWM_1].cw_speed_hi;
-        phase_lo = _pwm.c[PWM_1].cw_phase_lo;
-        phase_hi = _pwm.c[PWM_1].cw_phase_hi;
+        speed_lo = c.cw_speed_lo;
+        speed_hi = c.cw_speed_hi;
+        phase_lo = c.cw_phase_lo;
+        phase_hi = c.cw_phase_hi;
     } else { // if (direction == SPINDLE_CCW ) {
-        speed_lo = _pwm.c[PWM_1].ccw_speed_lo;
-        speed_hi = _pwm.c[PWM_1].ccw_speed_hi;
-        phase_lo = _pwm.c[PWM_1].ccw_phase_lo;
-        phase_hi = _pwm.c[PWM_1].ccw_phase_hi;
+        speed_lo = c.ccw_speed_lo;
+        speed_hi = c.ccw_speed_hi;
+        phase_lo = c.ccw_phase_lo;
+        phase_hi = c.ccw_phase_hi;
     }
 
     if ((_spindle.state == SPINDLE_CW) || (_spindle.state == SPINDLE_CCW)) {
@@ -316,18 +758,33 @@ static float _get_spindle_pwm (spSpindle_t &_spindle, pwmControl_t &_pwm)
         if (_spindle.speed > speed_hi) {
             _spindle.speed = speed_hi;
         }
-        // normalize speed to [0..1]
-        float speed = (_spindle.speed - speed_lo) / (speed_hi - speed_lo);
+        // apply the override and normalize speed to [0..1]
+        float speed = min(max(_spindle.speed * sp_ovr.factor, speed_lo), speed_hi);
+        speed = (speed - speed_lo) / (speed_hi - speed_lo);
         return ((speed * (phase_hi - phase_lo)) + phase_lo);
     } else {
-        return (_pwm.c[PWM_1].phase_off);
+        return (c.phase_off);
     }
 }
 
 /****************************************************************************************
- * spindle_override_control()
- * spindle_start_override()
- * spindle_end_override()
+ * spindle_override_control() - M51
+ * spindle_start_override()   - ramp the spindle override to a new factor
+ * spindle_end_override()     - ramp the spindle override back to 1.0
+ * spindle_override_update()  - step the ramp by a segment of dt minutes
+ * spindle_override_settle()  - finish the ramp at once
+ * spindle_feed_link()        - the factor the feed override is scaled by
+ *
+ *  The override scales S on its way to the PWM. A change is ramped over ramp_time
+ *  (minutes, as in mp_start_feed_override()), stepped by the segment exec so the spindle
+ *  follows in real time with the motion. Each step is posted for the loader like a G96
+ *  speed (see spindle_css_update()). With no motion running there is nothing to step the
+ *  ramp, so the change is made at once, and a ramp the motion runs out on is finished
+ *  when the cycle ends. The ramp holds through a feedhold.
+ *
+ *  With {spfl:1} the feed override follows the spindle override over the same ramp, which
+ *  holds the chip load as the operator tunes the spindle speed. It multiplies M50 (and
+ *  adaptive feed) and is held to the feed override limits.
  */
 
 stat_t spindle_override_control(const float P_word, const bool P_flag) // M51
@@ -361,12 +818,51 @@ stat_t spindle_override_control(const float P_word, const bool P_flag) // M51
 
 void spindle_start_override(const float ramp_time, const float override_factor)
 {
-    return;
+    if (cm->motion_state != MOTION_RUN) {
+        sp_ovr.dvdt = 0;
+        sp_ovr.target = sp_ovr.factor = override_factor;
+        _set_spindle_pwm();
+    } else {
+        sp_ovr.dvdt = (override_factor - sp_ovr.factor) / ramp_time;
+        sp_ovr.target = override_factor;
+    }
+    if (spindle.feed_link) {
+        mp_relink_feed_override(ramp_time);
+    }
 }
 
 void spindle_end_override(const float ramp_time)
 {
-    return;
+    spindle_start_override(ramp_time, 1.0);
+}
+
+void spindle_override_update(const float dt)
+{
+    float target = sp_ovr.target;
+    if (sp_ovr.factor == target) {
+        return;
+    }
+    float factor = sp_ovr.factor + sp_ovr.dvdt * dt;
+    if ((sp_ovr.dvdt > 0) ? (factor >= target) : (factor <= target)) {
+        factor = target;
+    }
+    sp_ovr.factor = factor;
+    if ((spindle.state == SPINDLE_CW) || (spindle.state == SPINDLE_CCW)) {
+        float duty = _get_spindle_pwm(spindle, pwm);
+        spindle.raster_phase_span = duty - spindle.raster_phase_off;
+        pwm_post_duty(spindle.pwm_channel, duty);
+    }
+}
+
+void spindle_override_settle()
+{
+    spindle_override_update(SPINDLE_OVERRIDE_RAMP_TIME * SPINDLE_OVERRIDE_MAX);  // more than any ramp
+    pwm_latch();
+}
+
+float spindle_feed_link()
+{
+    return (spindle.feed_link ? (float)sp_ovr.target : 1.0f);
 }
 
 /****************************
@@ -403,16 +899,52 @@ stat_t sp_get_spph(nvObj_t *nv) { return(get_integer(nv, spindle.pause_enable));
 stat_t sp_set_spph(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)spindle.pause_enable, 0, 1)); }
 stat_t sp_get_spde(nvObj_t *nv) { return(get_float(nv, spindle.spinup_delay)); }
 stat_t sp_set_spde(nvObj_t *nv) { return(set_float_range(nv, spindle.spinup_delay, 0, SPINDLE_DWELL_MAX)); }
+stat_t sp_get_spup(nvObj_t *nv) { return(get_integer(nv, spindle.spinup_overlap)); }
+stat_t sp_set_spup(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)spindle.spinup_overlap, 0, 1)); }
 
 stat_t sp_get_spsn(nvObj_t *nv) { return(get_float(nv, spindle.speed_min)); }
 stat_t sp_set_spsn(nvObj_t *nv) { return(set_float_range(nv, spindle.speed_min, SPINDLE_SPEED_MIN, SPINDLE_SPEED_MAX)); }
 stat_t sp_get_spsm(nvObj_t *nv) { return(get_float(nv, spindle.speed_max)); }
 stat_t sp_set_spsm(nvObj_t *nv) { return(set_float_range(nv, spindle.speed_max, SPINDLE_SPEED_MIN, SPINDLE_SPEED_MAX)); }
 
+stat_t sp_get_sptp(nvObj_t *nv) { return(get_float(nv, spindle.tach_ppr)); }
+stat_t sp_set_sptp(nvObj_t *nv) { return(set_float_range(nv, spindle.tach_ppr, 0, 1000)); }
+stat_t sp_get_spat(nvObj_t *nv) { return(get_float(nv, spindle.at_speed_tolerance)); }
+stat_t sp_set_spat(nvObj_t *nv) { return(set_float_range(nv, spindle.at_speed_tolerance, 0, 1)); }
+stat_t sp_get_spsa(nvObj_t *nv) { return(get_float(nv, spindle_get_actual_speed())); }
+
+stat_t sp_get_spvs(nvObj_t *nv) { return(get_integer(nv, spindle.velocity_sync)); }
+stat_t sp_set_spvs(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)spindle.velocity_sync, 0, 1)); }
+stat_t sp_get_spv0(nvObj_t *nv) { return(get_float(nv, spindle.velocity_power_lo)); }
+stat_t sp_set_spv0(nvObj_t *nv) { return(set_float_range(nv, spindle.velocity_power_lo, 0, 1)); }
+stat_t sp_get_spv1(nvObj_t *nv) { return(get_float(nv, spindle.velocity_power_hi)); }
+stat_t sp_set_spv1(nvObj_t *nv) { return(set_float_range(nv, spindle.velocity_power_hi, 0, 1)); }
+
 stat_t sp_get_spoe(nvObj_t *nv) { return(get_integer(nv, spindle.override_enable)); }
-stat_t sp_set_spoe(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)spindle.override_enable, 0, 1)); }
+stat_t sp_set_spoe(nvObj_t *nv)
+{
+    ritorno(set_integer(nv, (uint8_t &)spindle.override_enable, 0, 1));
+    if (cm->gmx.m48_enable) {               // apply it now
+        spindle_start_override(SPINDLE_OVERRIDE_RAMP_TIME, spindle.override_enable ? spindle.override_factor : 1.0);
+    }
+    return (STAT_OK);
+}
 stat_t sp_get_spo(nvObj_t *nv) { return(get_float(nv, spindle.override_factor)); }
-stat_t sp_set_spo(nvObj_t *nv) { return(set_float_range(nv, spindle.override_factor, SPINDLE_OVERRIDE_MIN, SPINDLE_OVERRIDE_MAX)); }
+stat_t sp_set_spo(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, spindle.override_factor, SPINDLE_OVERRIDE_MIN, SPINDLE_OVERRIDE_MAX));
+    if (cm->gmx.m48_enable && spindle.override_enable) {    // apply it now if the override is in effect
+        spindle_start_override(SPINDLE_OVERRIDE_RAMP_TIME, spindle.override_factor);
+    }
+    return (STAT_OK);
+}
+stat_t sp_get_spfl(nvObj_t *nv) { return(get_integer(nv, spindle.feed_link)); }
+stat_t sp_set_spfl(nvObj_t *nv)
+{
+    ritorno(set_integer(nv, (uint8_t &)spindle.feed_link, 0, 1));
+    mp_relink_feed_override(FEED_OVERRIDE_RAMP_TIME);
+    return (STAT_OK);
+}
 
 // These are provided as a way to view and control spindles without using M commands
 stat_t sp_get_spc(nvObj_t *nv) { return(get_integer(nv, spindle.state)); }
@@ -434,10 +966,18 @@ const char fmt_spep[] = "[spep] spindle enable polarity%5d [0=active_low,1=activ
 const char fmt_spdp[] = "[spdp] spindle direction polarity%2d [0=CW_low,1=CW_high]\n";
 const char fmt_spph[] = "[spph] spindle pause on hold%7d [0=no,1=pause_on_hold]\n";
 const char fmt_spde[] = "[spde] spindle spinup delay%10.1f seconds\n";
+const char fmt_spup[] = "[spup] spindle spinup overlap%6d [0=hold motion,1=traverses run]\n";
 const char fmt_spsn[] = "[spsn] spindle speed min%14.2f rpm\n";
 const char fmt_spsm[] = "[spsm] spindle speed max%14.2f rpm\n";
+const char fmt_sptp[] = "[sptp] spindle tach pulses per rev%4.0f [0=no tach]\n";
+const char fmt_spat[] = "[spat] spindle at-speed tolerance%5.3f x S\n";
+const char fmt_spsa[] = "[spsa] spindle actual speed%11.0f rpm\n";
+const char fmt_spvs[] = "[spvs] spindle velocity sync%7d [0=off,1=scale laser power with velocity]\n";
+const char fmt_spv0[] = "[spv0] spindle velocity power lo%7.3f x S at zero velocity\n";
+const char fmt_spv1[] = "[spv1] spindle velocity power hi%7.3f x S at cruise velocity\n";
 const char fmt_spoe[] = "[spoe] spindle speed override ena%2d [0=disable,1=enable]\n";
 const char fmt_spo[]  = "[spo]  spindle speed override%10.3f [0.050 < spo < 2.000]\n";
+const char fmt_spfl[] = "[spfl] spindle override feed link%3d [0=off,1=feed follows spindle override]\n";
 
 void sp_print_spc(nvObj_t *nv)  { text_print(nv, fmt_spc);}     // TYPE_INT
 void sp_print_sps(nvObj_t *nv)  { text_print(nv, fmt_sps);}     // TYPE_FLOAT
@@ -446,9 +986,17 @@ void sp_print_spep(nvObj_t *nv) { text_print(nv, fmt_spep);}    // TYPE_INT
 void sp_print_spdp(nvObj_t *nv) { text_print(nv, fmt_spdp);}    // TYPE_INT
 void sp_print_spph(nvObj_t *nv) { text_print(nv, fmt_spph);}    // TYPE_INT
 void sp_print_spde(nvObj_t *nv) { text_print(nv, fmt_spde);}    // TYPE_FLOAT
+void sp_print_spup(nvObj_t *nv) { text_print(nv, fmt_spup);}    // TYPE_INT
 void sp_print_spsn(nvObj_t *nv) { text_print(nv, fmt_spsn);}    // TYPE_FLOAT
 void sp_print_spsm(nvObj_t *nv) { text_print(nv, fmt_spsm);}    // TYPE_FLOAT
+void sp_print_sptp(nvObj_t *nv) { text_print(nv, fmt_sptp);}    // TYPE_FLOAT
+void sp_print_spat(nvObj_t *nv) { text_print(nv, fmt_spat);}    // TYPE_FLOAT
+void sp_print_spsa(nvObj_t *nv) { text_print(nv, fmt_spsa);}    // TYPE_FLOAT
+void sp_print_spvs(nvObj_t *nv) { text_print(nv, fmt_spvs);}    // TYPE_INT
+void sp_print_spv0(nvObj_t *nv) { text_print(nv, fmt_spv0);}    // TYPE_FLOAT
+void sp_print_spv1(nvObj_t *nv) { text_print(nv, fmt_spv1);}    // TYPE_FLOAT
 void sp_print_spoe(nvObj_t *nv) { text_print(nv, fmt_spoe);}    // TYPE INT
 void sp_print_spo(nvObj_t *nv)  { text_print(nv, fmt_spo);}     // TYPE FLOAT
+void sp_print_spfl(nvObj_t *nv) { text_print(nv, fmt_spfl);}    // TYPE_INT
 
 #endif // __TEXT_MODE
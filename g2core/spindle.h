@@ -32,7 +32,19 @@
 #define SPINDLE_OVERRIDE_FACTOR 1.00
 #define SPINDLE_OVERRIDE_MIN 0.05       // 5%
 #define SPINDLE_OVERRIDE_MAX 2.00       // 200%
-#define SPINDLE_OVERRIDE_RAMP_TIME 1    // change sped in seconds
+#define SPINDLE_OVERRIDE_RAMP_TIME (1.0/60)  // ramp time in minutes, as FEED_OVERRIDE_RAMP_TIME
+
+#define SPINDLE_AT_SPEED_POLL_MS 5      // dwell slice run while waiting for the tachometer
+#define SPINDLE_AT_SPEED_TIMEOUT_MS 20000   // alarm if the tachometer has not reached speed by then
+#define SPINDLE_TACH_STALE_MS 500       // no tach pulse for this long reads as stopped
+
+#define SPINDLE_SYNC_LOCK_REVS 0.5      // revolutions a synchronized move takes to run out a phase error
+#define SPINDLE_SYNC_TRIM_MAX 0.10      // most the phase lock stretches or shrinks a segment time
+#define SPINDLE_SYNC_SCALE_MIN 0.5      // bounds on the segment time scale, speed ratio included
+#define SPINDLE_SYNC_SCALE_MAX 2.0
+#define SPINDLE_SYNC_INDEX_TIMEOUT_MS 2000  // alarm if a synchronized move sees no index by then
+
+#define SPINDLE_CSS_DEADBAND 1.0        // RPM - smallest constant surface speed change sent to the PWM
 
 typedef enum {
     SPINDLE_DISABLED = 0,       // spindle will not operate
@@ -57,6 +69,11 @@ typedef enum {                  // how spindle controls are presented by the Gco
 } spControl;
 #define SPINDLE_ACTION_MAX SPINDLE_RESUME
 
+typedef enum {                  // how S words are read
+    SPINDLE_SPEED_RPM = 0,      // G97 - S is RPM
+    SPINDLE_SPEED_CSS           // G96 - S is surface speed, m/min (G21) or ft/min (G20)
+} spSpeedMode;
+
 // *** NOTE: The spindle polarity active hi/low values currently agree with ioMode in gpio.h
 // These will all need to be changed to ACTIVE_HIGH = 0, ACTIVE_LOW = 1
 // See: https://github.com/synthetos/g2_private/wiki/GPIO-Design-Discussion#settings-common-to-all-io-types
@@ -92,16 +109,43 @@ typedef struct spSpindle {
     spPolarity  dir_polarity;       // {spdp:} 0=clockwise low, 1=clockwise high
     bool        pause_enable;       // {spph:} pause on feedhold
     float       spinup_delay;       // {spde:} optional delay on spindle start (set to 0 to disable)
+    bool        spinup_overlap;     // {spup:} traverses run during spinup, the next feed waits
+    bool        spinup_planned;     // a spinup was queued that the next feed must wait for
 //    float       spindown_delay;     // {spds:} optional delay on spindle stop (set to 0 to disable)
 
     bool        override_enable;    // {spoe:} TRUE = spindle speed override enabled (see also m48_enable in canonical machine)
     float       override_factor;    // {spo:}  1.0000 x S spindle speed. Go up or down from there
+    bool        feed_link;          // {spfl:} scale the feed override with the spindle override
     
     // Spindle speed controller variables
     ESCState    esc_state;          // state management for ESC controller
     uint32_t    esc_boot_timer;     // When the ESC last booted up
     uint32_t    esc_lockout_timer;  // When the ESC lockout last triggered
 
+    // Scanline PWM - pixel intensities scale the duty cycle between off and the current S
+    float       raster_phase_off;   // PWM duty cycle for intensity 0
+    float       raster_phase_span;  // PWM duty cycle added at intensity 255
+    uint8_t     pwm_channel;        // PWM channel of the current tool - see spindle_set_pwm_channel()
+
+    // Velocity synchronized laser power - see spindle_velocity_intensity()
+    bool        velocity_sync;      // {spvs:} scale the PWM with segment velocity on feed moves
+    float       velocity_power_lo;  // {spv0:} fraction of S at zero velocity
+    float       velocity_power_hi;  // {spv1:} fraction of S at the block's cruise velocity
+
+    // Tachometer feedback - see spindle_tach_pulse(). Requires an input set to the tach function
+    float       tach_ppr;           // {sptp:} tach pulses per revolution, 0 = no tach (use spinup delay)
+    float       at_speed_tolerance; // {spat:} at speed when within this fraction of S
+    bool        at_speed_wait;      // motion is held until the tach reads S
+    bool        at_speed_overlap;   // ...but only by a queued spinup wait, not in mp_exec_move()
+
+    // Spindle synchronized motion (G33) - see spindle_sync_segment_time(). Requires an index input
+    float       planned_speed;      // S as last queued, used to plan synchronized feeds
+
+    // Constant surface speed (G96) - see spindle_css_update()
+    spSpeedMode speed_mode;         // G96/G97 at the runtime
+    spSpeedMode planned_speed_mode; // G96/G97 as last queued, to read S words
+    float       surface_speed;      // G96 S in mm/min
+
 } spSpindle_t;
 extern spSpindle_t spindle;
 
@@ -116,10 +160,33 @@ stat_t spindle_control_immediate(spControl control);
 stat_t spindle_control_sync(spControl control);
 stat_t spindle_speed_immediate(float speed);    // S parameter
 stat_t spindle_speed_sync(float speed);         // S parameter
+stat_t spindle_speed_mode_sync(uint8_t mode);   // G96, G97
+void spindle_css_update(const float radius);    // called from the segment exec
 
 stat_t spindle_override_control(const float P_word, const bool P_flag); // M51
 void spindle_start_override(const float ramp_time, const float override_factor);
 void spindle_end_override(const float ramp_time);
+void spindle_override_update(const float dt);   // called from the segment exec
+void spindle_override_settle(void);             // called when motion stops
+float spindle_feed_link(void);                  // called from mp_start_feed_override()
+
+void spindle_raster_power(const uint8_t intensity);   // called from the stepper loader
+void spindle_raster_end(void);
+void spindle_set_pwm_channel(const uint8_t channel);  // called at M6
+int16_t spindle_velocity_intensity(const float velocity_ratio);  // called from segment exec
+
+void spindle_tach_pulse(const uint32_t cycles); // called from the tach input ISR
+float spindle_get_actual_speed(void);
+bool spindle_is_spinning_up(void);              // called from mp_exec_move()
+void spindle_spinup_start(const float seconds); // start an overlapped spinup (also coolant)
+stat_t spindle_spinup_wait_sync(void);          // called before queuing a feed
+
+void spindle_index_pulse(const uint32_t cycles);    // called from the index input ISR
+bool spindle_has_index(void);
+float spindle_get_index_speed(void);
+bool spindle_sync_wait(const float value[]);        // queued by mp_queue_wait()
+void spindle_sync_end(void);
+float spindle_sync_segment_time(const float segment_time);  // called from st_prep_line()
 
 stat_t sp_get_spmo(nvObj_t *nv);
 stat_t sp_set_spmo(nvObj_t *nv);
@@ -132,6 +199,8 @@ stat_t sp_set_spph(nvObj_t *nv);
 
 stat_t sp_get_spde(nvObj_t *nv);
 stat_t sp_set_spde(nvObj_t *nv);
+stat_t sp_get_spup(nvObj_t *nv);
+stat_t sp_set_spup(nvObj_t *nv);
 //stat_t sp_get_spdn(nvObj_t *nv);
 //stat_t sp_set_spdn(nvObj_t *nv);
 
@@ -140,10 +209,25 @@ stat_t sp_set_spsn(nvObj_t *nv);
 stat_t sp_get_spsm(nvObj_t *nv);
 stat_t sp_set_spsm(nvObj_t *nv);
 
+stat_t sp_get_sptp(nvObj_t *nv);
+stat_t sp_set_sptp(nvObj_t *nv);
+stat_t sp_get_spat(nvObj_t *nv);
+stat_t sp_set_spat(nvObj_t *nv);
+stat_t sp_get_spsa(nvObj_t *nv);
+
+stat_t sp_get_spvs(nvObj_t *nv);
+stat_t sp_set_spvs(nvObj_t *nv);
+stat_t sp_get_spv0(nvObj_t *nv);
+stat_t sp_set_spv0(nvObj_t *nv);
+stat_t sp_get_spv1(nvObj_t *nv);
+stat_t sp_set_spv1(nvObj_t *nv);
+
 stat_t sp_get_spoe(nvObj_t* nv);
 stat_t sp_set_spoe(nvObj_t* nv);
 stat_t sp_get_spo(nvObj_t* nv);
 stat_t sp_set_spo(nvObj_t* nv);
+stat_t sp_get_spfl(nvObj_t* nv);
+stat_t sp_set_spfl(nvObj_t* nv);
 
 stat_t sp_get_spc(nvObj_t* nv);
 stat_t sp_set_spc(nvObj_t* nv);
@@ -159,11 +243,19 @@ stat_t sp_set_sps(nvObj_t* nv);
     void sp_print_spdp(nvObj_t* nv);
     void sp_print_spph(nvObj_t* nv);
     void sp_print_spde(nvObj_t* nv);
+    void sp_print_spup(nvObj_t* nv);
 //    void sp_print_spdn(nvObj_t* nv);
     void sp_print_spsn(nvObj_t* nv);
     void sp_print_spsm(nvObj_t* nv);
+    void sp_print_sptp(nvObj_t* nv);
+    void sp_print_spat(nvObj_t* nv);
+    void sp_print_spsa(nvObj_t* nv);
+    void sp_print_spvs(nvObj_t* nv);
+    void sp_print_spv0(nvObj_t* nv);
+    void sp_print_spv1(nvObj_t* nv);
     void sp_print_spoe(nvObj_t* nv);
     void sp_print_spo(nvObj_t* nv);
+    void sp_print_spfl(nvObj_t* nv);
     void sp_print_spc(nvObj_t* nv);
     void sp_print_sps(nvObj_t* nv);
 
@@ -174,11 +266,19 @@ stat_t sp_set_sps(nvObj_t* nv);
     #define sp_print_spdp tx_print_stub
     #define sp_print_spph tx_print_stub
     #define sp_print_spde tx_print_stub
+    #define sp_print_spup tx_print_stub
 //    #define sp_print_spdn tx_print_stub
     #define sp_print_spsn tx_print_stub
     #define sp_print_spsm tx_print_stub
+    #define sp_print_sptp tx_print_stub
+    #define sp_print_spat tx_print_stub
+    #define sp_print_spsa tx_print_stub
+    #define sp_print_spvs tx_print_stub
+    #define sp_print_spv0 tx_print_stub
+    #define sp_print_spv1 tx_print_stub
     #define sp_print_spoe tx_print_stub
     #define sp_print_spo tx_print_stub
+    #define sp_print_spfl tx_print_stub
     #define sp_print_spc tx_print_stub
     #define sp_print_sps tx_print_stub
 
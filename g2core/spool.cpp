@@ -0,0 +1,721 @@
+/*
+ * spool.cpp - job spooling to internal flash
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "spool.h"
+#include "checkpoint.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "report.h"
+#include "xio.h"
+#include "text_parser.h"
+#include "util.h"
+
+#include <new>
+
+#if SPOOL_ENABLED == true
+
+#if !(defined(__SAM3X8E__) || defined(__SAM3X8C__))
+#error SPOOL_ENABLED is only supported on SAM3X
+#endif
+
+/***********************************************************************************
+ **** STRUCTURE ALLOCATIONS ********************************************************
+ ***********************************************************************************/
+
+spoolSingleton_t spool;
+
+static xio_flash_file _spool_file {nullptr, 0};     // rebuilt for each run
+
+/***********************************************************************************
+ **** GENERIC STATIC FUNCTIONS AND VARIABLES ***************************************
+ ***********************************************************************************/
+
+
+#define SPOOL_RESERVED_TOP ((2 * 64 * 256) + CHECKPOINT_RESERVED)   // the persistence log areas and checkpoints
+#define SPOOL_SIZE (SPOOL_PAGES * SPOOL_PAGE_SIZE)
+#define SPOOL_ADDR (IFLASH1_ADDR + IFLASH1_SIZE - SPOOL_RESERVED_TOP - SPOOL_SIZE)
+#define SPOOL_DATA_ADDR (SPOOL_ADDR + SPOOL_PAGE_SIZE)
+#define SPOOL_DATA_MAX (SPOOL_SIZE - SPOOL_PAGE_SIZE)
+
+static_assert(SPOOL_PAGE_SIZE == IFLASH1_PAGE_SIZE, "SPOOL_PAGE_SIZE must match the flash page size");
+static_assert(sizeof(spoolHeader_t) <= SPOOL_PAGE_SIZE, "spoolHeader_t must fit in the header page");
+static_assert((SPOOL_SIZE + SPOOL_RESERVED_TOP) <= (IFLASH1_SIZE / 2), "the spool must leave the bottom half of bank 1 for code");
+
+static uint8_t _running_job;                        // job last started by spool_run(), until it's done
+
+static const spoolHeader_t *_header()
+{
+    return ((const spoolHeader_t *)SPOOL_ADDR);
+}
+
+static uint8_t _jobs()
+{
+    if (spool.recording || (_header()->magic != SPOOL_MAGIC) || (_header()->jobs > SPOOL_JOBS)) {
+        return (0);
+    }
+    return (_header()->jobs);
+}
+
+static const spoolJob_t *_job(uint8_t job)          // job numbered from 1, nullptr if it isn't stored
+{
+    if ((job == 0) || (job > _jobs())) {
+        return (nullptr);
+    }
+    const spoolJob_t *j = &_header()->job[job-1];
+    if ((j->offset + j->length) > SPOOL_DATA_MAX) {
+        return (nullptr);
+    }
+    return (j);
+}
+
+/*
+ * _spool_program() - erase and write a page, and wait for it. Flash bank 1 can't be read until it's done.
+ *
+ *  Waiting for FRDY first also lets any write persistence.cpp has started finish.
+ */
+
+static bool _spool_program(uint16_t page, const void *src)
+{
+    while ((EFC1->EEFC_FSR & EEFC_FSR_FRDY) == 0);
+    uint32_t addr = SPOOL_ADDR + (page * SPOOL_PAGE_SIZE);
+    volatile uint32_t *latch = (volatile uint32_t *)addr;
+    const uint32_t *words = (const uint32_t *)src;
+    for (uint8_t i=0; i < (SPOOL_PAGE_SIZE / 4); i++) {
+        latch[i] = words[i];
+    }
+    __DSB();
+    EFC1->EEFC_FCR = EEFC_FCR_FKEY(0x5A) |
+                     EEFC_FCR_FARG((addr - IFLASH1_ADDR) / SPOOL_PAGE_SIZE) |
+                     EEFC_FCR_FCMD(0x03);           // EWP
+    uint32_t status;
+    while (((status = EFC1->EEFC_FSR) & EEFC_FSR_FRDY) == 0);
+    return ((status & (EEFC_FSR_FCMDE | EEFC_FSR_FLOCKE)) == 0);
+}
+
+/*
+ * _spool_flush() - program the staged page and start a fresh one
+ */
+
+static stat_t _spool_flush()
+{
+    if (spool.fill == 0) {
+        return (STAT_OK);
+    }
+    memset(&spool.page[spool.fill], 0xFF, SPOOL_PAGE_SIZE - spool.fill);
+    if (!_spool_program(spool.page_number, spool.page)) {
+        spool.recording = false;
+        return (STAT_FILE_SIZE_EXCEEDED);
+    }
+    spool.page_number++;
+    spool.fill = 0;
+    return (STAT_OK);
+}
+
+/*
+ * _spool_begin() - start uploading job number 'job' (from 0) at byte offset 'start'
+ */
+
+static void _spool_begin(uint8_t job, uint32_t start)
+{
+    spool.recording = true;
+    spool.job = job;
+    spool.start = start;
+    spool.length = 0;
+    spool.lines = 0;
+    spool.crc = 0;
+    spool.fill = 0;
+    spool.page_number = 1 + (start / SPOOL_PAGE_SIZE);
+}
+
+/***********************************************************************************
+ **** CODE *************************************************************************
+ ***********************************************************************************/
+
+void spool_init()
+{
+    memset(&spool, 0, sizeof(spool));
+    _running_job = 0;
+}
+
+bool spool_is_recording()
+{
+    return (spool.recording);
+}
+
+/*
+ * spool_write_line() - store a line of the job being uploaded, with a LF terminator
+ */
+
+stat_t spool_write_line(const char *line)
+{
+    uint16_t length = strlen(line);
+    if ((spool.start + spool.length + length + 1) > SPOOL_DATA_MAX) {
+        return (STAT_FILE_SIZE_EXCEEDED);
+    }
+    for (uint16_t i=0; i <= length; i++) {
+        uint8_t c = (i == length) ? LF : line[i];
+        spool.page[spool.fill++] = c;
+        if (spool.fill == SPOOL_PAGE_SIZE) {
+            ritorno(_spool_flush());
+        }
+    }
+    spool.crc = crc32((const uint8_t *)line, length, spool.crc);
+    spool.crc = crc32((const uint8_t *)"\n", 1, spool.crc);
+    spool.length += length + 1;
+    spool.lines++;
+    return (STAT_OK);
+}
+
+/*
+ * spool_find_line() - find the line of a spooled job with N word linenum - its offset in the job
+ * spool_run()       - run a spooled job (from 1) from offset after checking its CRC
+ * spool_running_job() - the job last started, 0 once it's done or if none was
+ */
+
+stat_t spool_find_line(uint8_t job, int32_t linenum, uint32_t *offset)
+{
+    const spoolJob_t *j = _job(job);
+    if (j == nullptr) {
+        return (STAT_FILE_NOT_OPEN);
+    }
+    const char *data = (const char *)SPOOL_DATA_ADDR + j->offset;
+    uint32_t length = j->length;
+    for (uint32_t start = 0; start < length; ) {
+        uint32_t i = start;
+        while ((i < length) && ((data[i] == ' ') || (data[i] == '\t'))) {
+            i++;
+        }
+        if ((i < length) && (toupper(data[i]) == 'N')) {
+            int32_t n = 0;
+            bool digits = false;
+            while ((++i < length) && isdigit(data[i])) {
+                n = (n * 10) + (data[i] - '0');
+                digits = true;
+            }
+            if (digits && (n == linenum)) {
+                *offset = start;
+                return (STAT_OK);
+            }
+        }
+        while ((i < length) && (data[i] != LF)) {
+            i++;
+        }
+        start = i + 1;
+    }
+    return (STAT_EOF);
+}
+
+stat_t spool_run(uint8_t job, uint32_t offset)
+{
+    const spoolJob_t *j = _job(job);
+    if ((j == nullptr) || (offset >= j->length)) {
+        return (STAT_FILE_NOT_OPEN);
+    }
+    const uint8_t *data = (const uint8_t *)SPOOL_DATA_ADDR + j->offset;
+    uint32_t crc = 0;
+    for (uint32_t done = 0; done < j->length; ) {
+        uint16_t chunk = std::min(j->length - done, (uint32_t)0x8000);
+        crc = crc32(data + done, chunk, crc);
+        done += chunk;
+    }
+    if (crc != j->crc) {
+        return (STAT_CHECKSUM_MATCH_FAILED);
+    }
+    new (&_spool_file) xio_flash_file((const char *)data + offset, j->length - offset);
+    if (!xio_send_file(_spool_file)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);         // a file is already running
+    }
+    _running_job = job;
+    return (STAT_OK);
+}
+
+uint8_t spool_running_job()
+{
+    return (_running_job);
+}
+
+/***********************************************************************************
+ * JOB QUEUE
+ ***********************************************************************************/
+
+/*
+ * _queue_report() - report a job done, the queue done (i 0), or the queue stopped (e 0)
+ */
+
+static void _queue_report(bool ok, uint8_t position, uint8_t job, uint32_t ms)
+{
+    char buf[80];
+    sprintf(buf, "{\"spq\":{\"e\":%i,\"i\":%i,\"j\":%i,\"t\":%0.1f}}\n",
+            (int)ok, (int)position, (int)job, (double)(ms / 1000.0));
+    xio_writeline(buf);
+}
+
+/*
+ * _queue_stop() - stop the queue, reporting the job that was running
+ */
+
+static void _queue_stop(bool ok)
+{
+    if (spool.q.state == SPOOL_QUEUE_RUNNING) {
+        _queue_report(ok, spool.q.index + 1, spool.q.job[spool.q.index], SysTickTimer_getValue() - spool.q.job_ms);
+    }
+    spool.q.state = SPOOL_QUEUE_OFF;
+    spool.q.in_pallet = false;
+}
+
+/*
+ * _queue_start_job() - run the queued job at index
+ * _queue_start_pallet() - run the pallet change job before the job at index
+ */
+
+static void _queue_start_job()
+{
+    spool.q.in_pallet = false;
+    spool.q.state = SPOOL_QUEUE_RUNNING;
+    spool.q.job_ms = SysTickTimer_getValue();
+    stat_t status = spool_run(spool.q.job[spool.q.index], 0);
+    if (status != STAT_OK) {
+        rpt_exception(status, "queued job did not start");
+        _queue_stop(false);
+    }
+}
+
+static void _queue_start_pallet()
+{
+    spool.q.in_pallet = true;
+    spool.q.state = SPOOL_QUEUE_RUNNING;
+    stat_t status = spool_run(spool.q.pallet_job, 0);
+    if (status != STAT_OK) {
+        rpt_exception(status, "pallet change job did not start");
+        _queue_stop(false);
+    }
+}
+
+static bool _job_is_done()
+{
+    return (!xio_file_is_sending(_spool_file) && !mp_has_runnable_buffer(mp) && !cm_get_runtime_busy() &&
+            (cm->hold_state == FEEDHOLD_OFF) && (cm->cycle_type == CYCLE_NONE));
+}
+
+/*
+ * spool_queue_callback() - see a spooled job to its end and start the next queued one
+ *
+ *  Called from the main loop. A job is done when its file has been read and the machine
+ *  has come to rest with nothing queued.
+ */
+
+stat_t spool_queue_callback()
+{
+    if ((_running_job == 0) && (spool.q.state != SPOOL_QUEUE_WAITING)) {
+        return (STAT_NOOP);
+    }
+    if ((cm->machine_state == MACHINE_ALARM) || (cm->machine_state == MACHINE_SHUTDOWN) ||
+        (cm->machine_state == MACHINE_PANIC)) {
+        _running_job = 0;
+        if (spool.q.state != SPOOL_QUEUE_OFF) {
+            _queue_stop(false);
+        }
+        return (STAT_OK);
+    }
+    if (spool.q.state == SPOOL_QUEUE_WAITING) {
+        if (spool.q.cycle_start) {
+            spool.q.cycle_start = false;
+            _queue_start_job();
+        }
+        return (STAT_OK);
+    }
+    if (!_job_is_done()) {
+        return (STAT_NOOP);
+    }
+    _running_job = 0;
+    if (spool.q.state == SPOOL_QUEUE_OFF) {
+        return (STAT_OK);                           // a job run with {spr:}
+    }
+
+    uint32_t now = SysTickTimer_getValue();
+    if (!spool.q.in_pallet) {
+        _queue_report(true, spool.q.index + 1, spool.q.job[spool.q.index], now - spool.q.job_ms);
+        if (++spool.q.index >= spool.q.count) {
+            _queue_report(true, 0, 0, now - spool.q.queue_ms);
+            spool.q.state = SPOOL_QUEUE_OFF;
+            spool.q.index = 0;
+            return (STAT_OK);
+        }
+        if ((spool.q.pallet_job != 0) && !spool.q.stop_requested) {
+            _queue_start_pallet();
+            return (STAT_OK);
+        }
+    }
+    if (spool.q.stop_requested) {
+        spool.q.state = SPOOL_QUEUE_OFF;
+        spool.q.in_pallet = false;
+        return (STAT_OK);
+    }
+    if (spool.q.wait) {
+        spool.q.in_pallet = false;
+        spool.q.cycle_start = false;
+        spool.q.state = SPOOL_QUEUE_WAITING;
+        sr_request_status_report(SR_REQUEST_IMMEDIATE);
+        return (STAT_OK);
+    }
+    _queue_start_job();
+    return (STAT_OK);
+}
+
+/*
+ * spool_queue_cycle_start() - a cycle start with nothing to resume - releases a waiting queue
+ * spool_queue_abort()       - the input was flushed by a job kill or queue flush - stop the queue
+ */
+
+void spool_queue_cycle_start()
+{
+    if (spool.q.state == SPOOL_QUEUE_WAITING) {
+        spool.q.cycle_start = true;
+    }
+}
+
+void spool_queue_abort()
+{
+    _running_job = 0;
+    if (spool.q.state != SPOOL_QUEUE_OFF) {
+        _queue_stop(false);
+    }
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * spool_get_spu() - get upload state
+ * spool_set_spu() - clear the spool and start uploading job 1 (true), or end an upload (false)
+ * spool_set_spa() - start uploading the next job (true), or end an upload (false)
+ */
+
+stat_t spool_get_spu(nvObj_t *nv)
+{
+    nv->value_int = spool.recording;
+    nv->valuetype = TYPE_BOOLEAN;
+    return (STAT_OK);
+}
+
+static stat_t _spool_end_upload()
+{
+    if (!spool.recording) {
+        return (STAT_OK);
+    }
+    ritorno(_spool_flush());
+    spool.recording = false;
+
+    uint8_t jobs = _jobs();
+    spoolHeader_t *h = (spoolHeader_t *)spool.page;
+    memset(spool.page, 0xFF, SPOOL_PAGE_SIZE);
+    if (jobs != 0) {
+        memcpy(h, _header(), sizeof(spoolHeader_t));
+    }
+    h->magic = SPOOL_MAGIC;
+    h->jobs = spool.job + 1;
+    h->job[spool.job].offset = spool.start;
+    h->job[spool.job].length = spool.length;
+    h->job[spool.job].lines = spool.lines;
+    h->job[spool.job].crc = spool.crc;
+    if (!_spool_program(0, spool.page)) {
+        return (STAT_FILE_NOT_OPEN);
+    }
+    return (STAT_OK);
+}
+
+static bool _spool_busy()
+{
+    return (spool.recording || (cm->cycle_type != CYCLE_NONE) || (_running_job != 0) ||
+            (spool.q.state != SPOOL_QUEUE_OFF));
+}
+
+stat_t spool_set_spu(nvObj_t *nv)
+{
+    if (!nv->value_int) {
+        return (_spool_end_upload());
+    }
+    if (_spool_busy()) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    memset(spool.page, 0xFF, SPOOL_PAGE_SIZE);
+    _spool_program(0, spool.page);                  // drop the old jobs before their pages are reused
+    _spool_begin(0, 0);
+    return (STAT_OK);
+}
+
+stat_t spool_set_spa(nvObj_t *nv)
+{
+    if (!nv->value_int) {
+        return (_spool_end_upload());
+    }
+    if (_spool_busy()) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    uint8_t jobs = _jobs();
+    if (jobs == SPOOL_JOBS) {
+        return (STAT_FILE_SIZE_EXCEEDED);
+    }
+    uint32_t start = 0;
+    if (jobs != 0) {
+        const spoolJob_t *last = &_header()->job[jobs-1];
+        start = ((last->offset + last->length + SPOOL_PAGE_SIZE - 1) / SPOOL_PAGE_SIZE) * SPOOL_PAGE_SIZE;
+    }
+    if (start >= SPOOL_DATA_MAX) {
+        return (STAT_FILE_SIZE_EXCEEDED);
+    }
+    _spool_begin(jobs, start);                      // pages past the last job are still erased or unused
+    return (STAT_OK);
+}
+
+/*
+ * spool_get_spj() - get the number of jobs stored
+ * spool_get_spl() - get the length of the last job stored, 0 if there is none
+ * spool_get_spn() - get the number of lines in it
+ * spool_set_spr() - run a spooled job
+ */
+
+stat_t spool_get_spj(nvObj_t *nv)
+{
+    nv->value_int = _jobs();
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t spool_get_spl(nvObj_t *nv)
+{
+    const spoolJob_t *j = _job(_jobs());
+    nv->value_int = (j != nullptr) ? j->length : 0;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t spool_get_spn(nvObj_t *nv)
+{
+    const spoolJob_t *j = _job(_jobs());
+    nv->value_int = (j != nullptr) ? j->lines : 0;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t spool_set_spr(nvObj_t *nv)
+{
+    if (nv->value_int <= 0) {
+        return (STAT_OK);
+    }
+    if (spool.q.state != SPOOL_QUEUE_OFF) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    return (spool_run(nv->value_int, 0));
+}
+
+/*
+ * spool_get_spq()  - get the job queue as a list of job numbers
+ * spool_set_spq()  - set the job queue from a list of job numbers: "1,2,2,3"
+ * spool_get_spqr() - true if the queue is running or waiting
+ * spool_set_spqr() - start the queue (true) or stop it after the running job (false)
+ */
+
+stat_t spool_get_spq(nvObj_t *nv)
+{
+    char buf[SPOOL_QUEUE_MAX * 4 + 1];
+    char *p = buf;
+    *p = NUL;
+    for (uint8_t i = 0; i < spool.q.count; i++) {
+        p += sprintf(p, (i == 0) ? "%i" : ",%i", (int)spool.q.job[i]);
+    }
+    nv->valuetype = TYPE_STRING;
+    return (nv_copy_string(nv, buf));
+}
+
+stat_t spool_set_spq(nvObj_t *nv)
+{
+    if (nv->valuetype != TYPE_STRING) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    if (spool.q.state != SPOOL_QUEUE_OFF) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    uint8_t job[SPOOL_QUEUE_MAX];
+    uint8_t count = 0;
+    for (const char *p = *nv->stringp; *p != NUL; ) {
+        if ((*p == ',') || (*p == ' ')) {
+            p++;
+            continue;
+        }
+        if (!isdigit(*p) || (count == SPOOL_QUEUE_MAX)) {
+            return (STAT_INPUT_VALUE_RANGE_ERROR);
+        }
+        uint16_t n = 0;
+        while (isdigit(*p)) {
+            n = (n * 10) + (*p++ - '0');
+        }
+        if ((n == 0) || (n > SPOOL_JOBS)) {
+            return (STAT_INPUT_VALUE_RANGE_ERROR);
+        }
+        job[count++] = n;
+    }
+    memcpy(spool.q.job, job, count);
+    spool.q.count = count;
+    spool.q.index = 0;
+    return (STAT_OK);
+}
+
+stat_t spool_get_spqr(nvObj_t *nv)
+{
+    nv->value_int = (spool.q.state != SPOOL_QUEUE_OFF);
+    nv->valuetype = TYPE_BOOLEAN;
+    return (STAT_OK);
+}
+
+stat_t spool_set_spqr(nvObj_t *nv)
+{
+    if (!nv->value_int) {
+        if (spool.q.state == SPOOL_QUEUE_WAITING) {
+            spool.q.state = SPOOL_QUEUE_OFF;
+        }
+        spool.q.stop_requested = true;
+        return (STAT_OK);
+    }
+    if (_spool_busy() || (spool.q.count == 0)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    for (uint8_t i = 0; i < spool.q.count; i++) {
+        if (_job(spool.q.job[i]) == nullptr) {
+            return (STAT_FILE_NOT_OPEN);            // check them all now, not part way through a shift
+        }
+    }
+    if ((spool.q.pallet_job != 0) && (_job(spool.q.pallet_job) == nullptr)) {
+        return (STAT_FILE_NOT_OPEN);
+    }
+    spool.q.index = 0;
+    spool.q.stop_requested = false;
+    spool.q.queue_ms = SysTickTimer_getValue();
+    _queue_start_job();
+    return (STAT_OK);
+}
+
+/*
+ * spool_get_spqp()/spool_set_spqp() - pallet change job
+ * spool_get_spqw()/spool_set_spqw() - wait for cycle start between jobs
+ * spool_get_spqs() - queue state
+ * spool_get_spqi() - position of the job running or next, from 1
+ */
+
+stat_t spool_get_spqp(nvObj_t *nv) { return (get_integer(nv, spool.q.pallet_job)); }
+stat_t spool_set_spqp(nvObj_t *nv) { return (set_integer(nv, spool.q.pallet_job, 0, SPOOL_JOBS)); }
+stat_t spool_get_spqw(nvObj_t *nv) { return (get_integer(nv, spool.q.wait)); }
+stat_t spool_set_spqw(nvObj_t *nv) { return (set_integer(nv, spool.q.wait, 0, 1)); }
+stat_t spool_get_spqs(nvObj_t *nv) { return (get_integer(nv, spool.q.state)); }
+
+stat_t spool_get_spqi(nvObj_t *nv)
+{
+    nv->value_int = spool.q.index + 1;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_spu[] = "[spu] spool upload%16d [0=off,1=uploading]\n";
+static const char fmt_spj[] = "[spj] spooled jobs%16d\n";
+static const char fmt_spl[] = "[spl] spooled job length%10d bytes\n";
+static const char fmt_spn[] = "[spn] spooled job lines%11d\n";
+static const char fmt_spq[] = "[spq] job queue%19s\n";
+static const char fmt_spqp[] = "[spqp] pallet change job%10d [0=none]\n";
+static const char fmt_spqw[] = "[spqw] wait between jobs%10d [0=no,1=wait for cycle start]\n";
+static const char fmt_spqs[] = "[spqs] job queue state%12d [0=off,1=running,2=waiting]\n";
+static const char fmt_spqi[] = "[spqi] job queue position%9d\n";
+
+void spool_print_spu(nvObj_t *nv) { text_print(nv, fmt_spu);}    // TYPE_BOOLEAN
+void spool_print_spj(nvObj_t *nv) { text_print(nv, fmt_spj);}    // TYPE_INTEGER
+void spool_print_spl(nvObj_t *nv) { text_print(nv, fmt_spl);}    // TYPE_INTEGER
+void spool_print_spn(nvObj_t *nv) { text_print(nv, fmt_spn);}    // TYPE_INTEGER
+void spool_print_spq(nvObj_t *nv) { text_print(nv, fmt_spq);}    // TYPE_STRING
+void spool_print_spqp(nvObj_t *nv) { text_print(nv, fmt_spqp);}  // TYPE_INTEGER
+void spool_print_spqw(nvObj_t *nv) { text_print(nv, fmt_spqw);}  // TYPE_INTEGER
+void spool_print_spqs(nvObj_t *nv) { text_print(nv, fmt_spqs);}  // TYPE_INTEGER
+void spool_print_spqi(nvObj_t *nv) { text_print(nv, fmt_spqi);}  // TYPE_INTEGER
+
+#endif // __TEXT_MODE
+
+#else // SPOOL_ENABLED
+
+void spool_init()
+{
+    return;
+}
+
+bool spool_is_recording()
+{
+    return (false);
+}
+
+stat_t spool_write_line(const char *line)
+{
+    return (STAT_FILE_NOT_OPEN);
+}
+
+stat_t spool_find_line(uint8_t job, int32_t linenum, uint32_t *offset)
+{
+    return (STAT_FILE_NOT_OPEN);
+}
+
+stat_t spool_run(uint8_t job, uint32_t offset)
+{
+    return (STAT_FILE_NOT_OPEN);
+}
+
+uint8_t spool_running_job()
+{
+    return (0);
+}
+
+stat_t spool_queue_callback()
+{
+    return (STAT_NOOP);
+}
+
+void spool_queue_cycle_start()
+{
+    return;
+}
+
+void spool_queue_abort()
+{
+    return;
+}
+
+#endif // SPOOL_ENABLED
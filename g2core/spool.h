@@ -0,0 +1,197 @@
+/*
+ * spool.h - job spooling to internal flash
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * JOB SPOOLING
+ *
+ *  When SPOOL_ENABLED is true jobs can be uploaded once into internal flash and then run
+ *  from there, so a slow or glitchy host connection can't starve the planner mid-job.
+ *
+ *    {spu:t}   clear the spool and start uploading job 1. Gcode lines received after this
+ *              are stored, not run, and each gets the usual response so the host streams as
+ *              it normally would. JSON, $ commands and controls are still handled meanwhile.
+ *    {spa:t}   start uploading the next job, keeping the ones already stored
+ *    {spu:f}   end the upload (or {spa:f}). A job is only valid once this has been received.
+ *    {spj:n}   number of jobs stored, up to SPOOL_JOBS
+ *    {spl:n}   length in bytes of the last job stored, 0 if there is none
+ *    {spn:n}   lines in the last job stored
+ *    {spr:n}   run job n - {spr:t} runs job 1. It is played by the flash file device, like a
+ *              compiled-in xio_flash_file, so lines are read straight out of flash with no
+ *              read-ahead needed and the USB channels stay free for control.
+ *
+ *  A job can also be run from one of its lines (spool_run()), which is how a checkpoint
+ *  resume re-enters it - see checkpoint.h.
+ *
+ *  The spool is SPOOL_PAGES pages of flash bank 1 just below the area persistence.cpp uses
+ *  and the checkpoint ring. Page 0 holds a header with the offset, length, line count and
+ *  CRC32 of each job; it is rewritten when an upload ends, so an interrupted upload leaves
+ *  the jobs before it. Each job starts on a fresh page. Lines are staged in a RAM page and
+ *  each full page is programmed with erase-and-write while the upload waits, about 5 ms per
+ *  256 bytes - the upload is flow controlled by the RX buffer meanwhile.
+ *
+ *  The flash backend is SAM3X only, as for persistence. There is no SD card or SPI flash
+ *  driver in Motate yet; a block device for either would replace the _spool_program() calls.
+ *
+ * JOB QUEUE
+ *
+ *  The controller can run spooled jobs back to back without the host:
+ *
+ *    {spq:"1,2,2,3"}   jobs to run, in order, up to SPOOL_QUEUE_MAX - a job may repeat
+ *    {spqr:t}  start the queue. {spqr:f} stops it once the job running now is done
+ *    {spqp:n}  job to run between queued jobs - a pallet or part change - 0 for none
+ *    {spqw:t}  wait for a cycle start (~) before each queued job
+ *              after the first - once the pallet change job has run, if there is one
+ *    {spqs:n}  queue state: 0 = off, 1 = running, 2 = waiting for cycle start
+ *    {spqi:n}  position in the queue of the job running or next, from 1
+ *
+ *  Each queued job is timed from its start until its file has been read and the machine is
+ *  idle again, and reported as it ends: {"spq":{"e":1,"i":position,"j":job,"t":seconds}}.
+ *  When the queue has run out it reports {"spq":{"e":1,"i":0,"j":0,"t":total seconds}}. An
+ *  alarm, shutdown, job kill or queue flush stops the queue, reported with "e":0.
+ */
+
+#ifndef SPOOL_H_ONCE
+#define SPOOL_H_ONCE
+
+#include "config.h"  // needed for nvObj_t definition
+
+#if SPOOL_ENABLED == true
+
+#define SPOOL_PAGE_SIZE 256                                 // bytes per flash page
+#ifndef SPOOL_PAGES
+#define SPOOL_PAGES 256                                     // pages in the spool, including the header page
+#endif
+#define SPOOL_MAGIC 0x324C4F50                              // "POL2"
+#ifndef SPOOL_JOBS
+#define SPOOL_JOBS 8                                        // jobs the header can hold
+#endif
+#ifndef SPOOL_QUEUE_MAX
+#define SPOOL_QUEUE_MAX 16                                  // entries in the job queue
+#endif
+
+typedef struct spoolJob {
+    uint32_t offset;                // byte offset of the job from the first data page
+    uint32_t length;                // bytes in the job
+    uint32_t lines;                 // lines in the job
+    uint32_t crc;                   // CRC32 of the job bytes
+} spoolJob_t;
+
+typedef struct spoolHeader {
+    uint32_t magic;                 // SPOOL_MAGIC if the header is valid
+    uint32_t jobs;                  // jobs stored
+    spoolJob_t job[SPOOL_JOBS];
+} spoolHeader_t;
+
+typedef enum {
+    SPOOL_QUEUE_OFF = 0,            // not running
+    SPOOL_QUEUE_RUNNING,            // a job or the pallet change job is running
+    SPOOL_QUEUE_WAITING             // waiting for a cycle start to run the next job
+} spoolQueueState;
+
+typedef struct spoolQueue {
+    uint8_t job[SPOOL_QUEUE_MAX];   // {spq:} jobs to run, in order
+    uint8_t count;                  // entries in job[]
+    uint8_t pallet_job;             // {spqp:} job run between queued jobs, 0 for none
+    uint8_t wait;                   // {spqw:} 1 to wait for cycle start before each job after the first
+    spoolQueueState state;          // {spqs:}
+    uint8_t index;                  // entry running or next
+    bool in_pallet;                 // the pallet change job is running, not job[index]
+    bool stop_requested;            // {spqr:f} - stop once the running job is done
+    bool cycle_start;               // a cycle start was requested while waiting
+    uint32_t job_ms;                // SysTick time the running job started
+    uint32_t queue_ms;              // SysTick time the queue started
+} spoolQueue_t;
+
+//**** spool singleton ****
+
+typedef struct spoolSingleton {
+    bool recording;                 // an upload is in progress
+    uint8_t job;                    // job being uploaded, from 0
+    uint32_t start;                 // its offset from the first data page
+    uint32_t length;                // bytes stored so far
+    uint32_t lines;                 // lines stored so far
+    uint32_t crc;                   // running CRC32 of the bytes stored
+    uint16_t fill;                  // bytes in the staged page
+    uint16_t page_number;           // page the staged page will be programmed to
+    uint8_t page[SPOOL_PAGE_SIZE];  // RAM copy of the page being filled
+    spoolQueue_t q;
+} spoolSingleton_t;
+
+#endif // SPOOL_ENABLED
+
+//**** spool function prototypes ****
+
+void spool_init(void);
+bool spool_is_recording(void);
+stat_t spool_write_line(const char *line);
+stat_t spool_find_line(uint8_t job, int32_t linenum, uint32_t *offset);
+stat_t spool_run(uint8_t job, uint32_t offset);
+uint8_t spool_running_job(void);
+stat_t spool_queue_callback(void);
+void spool_queue_cycle_start(void);
+void spool_queue_abort(void);
+
+stat_t spool_get_spu(nvObj_t *nv);
+stat_t spool_set_spu(nvObj_t *nv);
+stat_t spool_set_spa(nvObj_t *nv);
+stat_t spool_get_spj(nvObj_t *nv);
+stat_t spool_get_spl(nvObj_t *nv);
+stat_t spool_get_spn(nvObj_t *nv);
+stat_t spool_set_spr(nvObj_t *nv);
+stat_t spool_get_spq(nvObj_t *nv);
+stat_t spool_set_spq(nvObj_t *nv);
+stat_t spool_get_spqr(nvObj_t *nv);
+stat_t spool_set_spqr(nvObj_t *nv);
+stat_t spool_get_spqp(nvObj_t *nv);
+stat_t spool_set_spqp(nvObj_t *nv);
+stat_t spool_get_spqw(nvObj_t *nv);
+stat_t spool_set_spqw(nvObj_t *nv);
+stat_t spool_get_spqs(nvObj_t *nv);
+stat_t spool_get_spqi(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void spool_print_spu(nvObj_t *nv);
+    void spool_print_spj(nvObj_t *nv);
+    void spool_print_spl(nvObj_t *nv);
+    void spool_print_spn(nvObj_t *nv);
+    void spool_print_spq(nvObj_t *nv);
+    void spool_print_spqp(nvObj_t *nv);
+    void spool_print_spqw(nvObj_t *nv);
+    void spool_print_spqs(nvObj_t *nv);
+    void spool_print_spqi(nvObj_t *nv);
+#else
+    #define spool_print_spu tx_print_stub
+    #define spool_print_spj tx_print_stub
+    #define spool_print_spl tx_print_stub
+    #define spool_print_spn tx_print_stub
+    #define spool_print_spq tx_print_stub
+    #define spool_print_spqp tx_print_stub
+    #define spool_print_spqw tx_print_stub
+    #define spool_print_spqs tx_print_stub
+    #define spool_print_spqi tx_print_stub
+#endif
+
+#endif  // End of include guard: SPOOL_H_ONCE
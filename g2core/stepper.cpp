@@ -32,13 +32,22 @@
 #include "g2core.h"
 #include "config.h"
 #include "stepper.h"
+#include "cpuload.h"
 #include "encoder.h"
+#include "kinematics.h"
 #include "planner.h"
 #include "hardware.h"
 #include "text_parser.h"
 #include "util.h"
 #include "controller.h"
 #include "xio.h"
+#include "profiler.h"
+#include "spindle.h"
+#include "pwm.h"
+#include "pso.h"
+#include "sync.h"
+#include "gpio.h"
+#include "persistence.h"
 
 /**** Debugging output with semihosting ****/
 
@@ -51,12 +60,26 @@
 /**** Allocate structures ****/
 
 stConfig_t st_cfg;
-stPrepSingleton_t st_pre;
-static stRunSingleton_t st_run;
+CACHE_ALIGNED stPrepSingleton_t st_pre;     // used by the exec and loader interrupts
+CACHE_ALIGNED static stRunSingleton_t st_run;  // used by the DDA interrupt
+static stOdometer_t st_odo;                 // motor wear counters - see Motor odometers in stepper.h
+#ifdef STEP_PULSE_NS
+static uint32_t _step_pulse_cycles;         // STEP_PULSE_NS in core clock cycles - see Timed step pulses
+#endif
 
 /**** Static functions ****/
 
 static void _load_move(void);
+static void _update_step_ports(void);
+static void _report_stalls(void);
+static void _apply_power_scale(void);
+static void _init_direction_timing(void);
+static void _flush_held_directions(void);
+static inline int32_t _reversed_accumulator(const uint8_t motor, const uint32_t ticks_X_substeps,
+                                            const int32_t accumulator, const uint32_t increment);
+#ifdef STEP_SCHEDULE
+static void _reset_schedule(void);
+#endif
 
 /**** Setup motate ****/
 
@@ -70,11 +93,25 @@ dda_timer_type dda_timer     {kTimerUpToMatch, FREQUENCY_DDA};      // stepper p
 exec_timer_type exec_timer;         // triggers calculation of next+1 stepper segment
 fwd_plan_timer_type fwd_plan_timer; // triggers planning of next block
 
+// SysTickEvent for motor power timeouts - flags st_motor_power_callback() when the earliest is due
+static volatile bool power_event_armed = false;
+static volatile bool power_event_due = false;
+static volatile uint32_t power_event_ms;    // SysTick ms of the earliest timeout scheduled
+
+Motate::SysTickEvent motor_power_systick_event {[] {
+    if (power_event_armed && ((int32_t)(SysTickTimer.getValue() - power_event_ms) >= 0)) {
+        power_event_armed = false;
+        power_event_due = true;
+    }
+}, nullptr};
+
 // SystickEvent for handling dwells (must be registered before it is active)
-Motate::SysTickEvent dwell_systick_event {[&] {
+Motate::SysTickEvent dwell_systick_event {[] {
     if (--st_run.dwell_ticks_downcount == 0) {
         SysTickTimer.unregisterEvent(&dwell_systick_event);
+        PROF_BEGIN(_start);
         _load_move();       // load the next move at the current interrupt level
+        PROF_END(_start, PROF_LOAD);
     }
 }, nullptr};
 
@@ -127,6 +164,7 @@ void stepper_init()
     memset(&st_run, 0, sizeof(st_run));            // clear all values, pointers and status
     memset(&st_pre, 0, sizeof(st_pre));            // clear all values, pointers and status
     stepper_init_assertions();
+    _update_step_ports();
 
     // setup DDA timer
     // Longer duty cycles stretch ON pulses but 75% is about the upper limit and about
@@ -135,8 +173,11 @@ void stepper_init()
     dda_timer.setInterrupts(kInterruptOnOverflow | kInterruptPriorityHighest);
 
     // setup software interrupt exec timer & initial condition
+    cycle_counter_init();                       // used to measure exec + prep time - see {segx:}
+#ifdef STEP_PULSE_NS
+    _step_pulse_cycles = (uint32_t)(((uint64_t)STEP_PULSE_NS * SystemCoreClock) / 1000000000);
+#endif
     exec_timer.setInterrupts(kInterruptOnSoftwareTrigger | kInterruptPriorityHigh);
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC;
 
     // setup software interrupt forward plan timer & initial condition
     fwd_plan_timer.setInterrupts(kInterruptOnSoftwareTrigger | kInterruptPriorityMedium);
@@ -147,6 +188,8 @@ void stepper_init()
         st_run.mot[motor].power_level_dynamic = st_cfg.mot[motor].power_level_scaled;
     }
     board_stepper_init();
+    _init_direction_timing();
+    SysTickTimer.registerEvent(&motor_power_systick_event); // motor power timeouts - see st_motor_power_callback()
     stepper_reset();                            // reset steppers to known state
 }
 
@@ -161,14 +204,35 @@ void stepper_reset()
     dda_timer.stop();                                   // stop all movement
     st_run.dda_ticks_downcount = 0;                     // signal the runtime is not busy
     st_run.dwell_ticks_downcount = 0;
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC;    // set to EXEC or it won't restart
+    for (uint8_t slot=0; slot<PREP_RING_SIZE; slot++) {
+        st_pre.seg[slot].block_type = BLOCK_TYPE_NULL;
+        st_pre.seg[slot].buffer_state = PREP_BUFFER_OWNED_BY_EXEC; // set to EXEC or it won't restart
+    }
+    st_pre.w = 0;
+    st_pre.r = 0;
+    st_pre.command_queued = false;
+    st_pre.dda_ticks_remainder = 0;
+    st_pre.output_set = 0;
+    st_pre.output_clear = 0;
+    st_run.steps_halted = false;
+    pso_reset();
+    sync_reset();
+    st_run.dda_divisor = 1;                             // the timer starts out at FREQUENCY_DDA
+    dda_timer.setModeAndFrequency(kTimerUpToMatch, FREQUENCY_DDA);
+    if (st_run.raster_active) {                         // hand the spindle PWM back
+        spindle_raster_end();
+        st_run.raster_active = false;
+    }
 
+    _flush_held_directions();                           // don't leave a reversal half done
     for (uint8_t motor=0; motor<MOTORS; motor++) {
         st_pre.mot[motor].prev_direction = STEP_INITIAL_DIRECTION;
-        st_pre.mot[motor].direction = STEP_INITIAL_DIRECTION;
         st_run.mot[motor].substep_accumulator = 0;      // will become max negative during per-motor setup;
         st_pre.mot[motor].corrected_steps = 0;          // diagnostic only - no action effect
     }
+#ifdef STEP_SCHEDULE
+    _reset_schedule();
+#endif
     mp_set_steps_to_runtime_position();                 // reset encoder to agree with the above
 }
 
@@ -207,6 +271,27 @@ bool st_runtime_isbusy()
     return (st_run.dda_ticks_downcount || st_run.dwell_ticks_downcount);    // returns false if down count is zero
 }
 
+/*
+ * st_halt_steps()   - stop step output immediately - safe to call from any interrupt
+ * st_steps_halted() - return true if step output was stopped and is waiting on a reset
+ *
+ *  The downcount is zeroed first, so a DDA interrupt that gets in ahead of the timer stop
+ *  stops the timer itself. The loader stays off until stepper_reset(), which is run by the
+ *  halt the main loop does on seeing st_steps_halted() - see _step_halt_handler().
+ */
+
+void st_halt_steps()
+{
+    st_run.steps_halted = true;
+    st_run.dda_ticks_downcount = 0;
+    dda_timer.stop();
+}
+
+bool st_steps_halted()
+{
+    return (st_run.steps_halted);
+}
+
 /*
  * st_clc() - clear counters
  */
@@ -218,31 +303,242 @@ stat_t st_clc(nvObj_t *nv)    // clear diagnostic counters, reset stepper prep
 }
 
 /*
+ * st_request_power_scale() - request a run current scale for the motors (called from exec)
+ * _apply_power_scale()     - push a changed scale to the motor drivers from the main loop
+ *
+ *  The scale is 1.0 except in the cruise (body) section of a move, where the motors need
+ *  little torque. Exec runs ahead of the loader, and the exec side restores full current
+ *  before the body ends, so the drivers see the change before the tail is stepped.
+ *  Driver writes are done from the main loop as they go through the SPI queue.
+ */
+
+static volatile float power_scale_requested = 1.0;
+static float power_scale_applied = 1.0;
+
+void st_request_power_scale(const float scale)
+{
+    power_scale_requested = scale;
+}
+
+static void _apply_power_scale()
+{
+    float scale = power_scale_requested;
+    if (fp_EQ(scale, power_scale_applied)) {
+        return;
+    }
+    power_scale_applied = scale;
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
+        Motors[motor]->setPowerScale(power_scale_applied, st_cfg.hold_power);
+    }
+}
+
+/*
+ * st_schedule_motor_power() - schedule the power event for a motor timeout, return its deadline
  * st_motor_power_callback() - callback to manage motor power sequencing
  *
- *  Handles motor power-down timing, low-power idle, and adaptive motor power
+ *  Motor power timeouts are events rather than polled. A motor's timeout starts when the
+ *  loader finds it stopped (Stepper::motionStopped()), which schedules the power event for
+ *  its deadline - the event keeps only the earliest. A SysTick event flags it when that
+ *  millisecond comes, and the callback then gives every counting motor its powerTimeout():
+ *  those that have run out are de-energized and the rest re-schedule. The next load that
+ *  moves a motor enables it, which cancels its timeout. So the timeouts cost nothing until
+ *  one is due, and aren't put off by a busy planner.
+ *
+ *  Drivers that do housekeeping every pass (Trinamic polling, servo settling) still get it
+ *  in periodicCheck(), when there is time for it.
  */
 
+// start the power timeouts of motors left running with the machine stopped
+static void _start_idle_power_timeouts()
+{
+    if (st_runtime_isbusy() || (cm_get_machine_state() == MACHINE_CYCLE)) {
+        return;                     // the loader starts them when the motion stops
+    }
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
+        Motors[motor]->idleStopped();
+    }
+}
+
+uint32_t st_schedule_motor_power(const uint32_t timeout_ms)
+{
+    uint32_t deadline = SysTickTimer.getValue() + timeout_ms;
+    if (!power_event_armed || ((int32_t)(deadline - power_event_ms) < 0)) {
+        power_event_ms = deadline;
+    }
+    power_event_armed = true;
+    return (deadline);
+}
+
 stat_t st_motor_power_callback()     // called by controller
 {
+    _report_stalls();
+    _apply_power_scale();
+    if (power_event_due) {
+        power_event_due = false;
+        uint32_t now = SysTickTimer.getValue();
+        for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
+            Motors[motor]->powerTimeout(now);
+        }
+    }
     if (!mp_is_phat_city_time()) {   // don't process this if you are time constrained in the planner
         return (STAT_NOOP);
     }
 
     bool have_actually_stopped = false;
     if ((!st_runtime_isbusy()) &&
-        (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_LOADER) &&
+        (st_pre.seg[st_pre.r].buffer_state != PREP_BUFFER_OWNED_BY_LOADER) &&
         (cm_get_machine_state() != MACHINE_CYCLE)) {    // if there are no moves to load...
         have_actually_stopped = true;
     }
-
-    // manage power for each motor individually
     for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
         Motors[motor]->periodicCheck(have_actually_stopped);
     }
     return (STAT_OK);
 }
 
+/*
+ * st_odometer_callback() - add up the motors' energized hours and persist the odometers
+ *
+ *  The hours go by each motor's power level as it is now, so they are as fine as the
+ *  callback period (TASK_ODOMETER_MS). See Motor odometers in stepper.h.
+ */
+
+stat_t st_odometer_callback()     // called by controller
+{
+    const uint32_t now = SysTickTimer_getValue();
+    const uint32_t elapsed = now - st_odo.tick_ms;
+    st_odo.tick_ms = now;
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
+        const float power = Motors[motor]->getCurrentPowerLevel(motor);
+        if (power > 0) {
+            st_odo.mot[motor].energized_ms += elapsed;
+            st_odo.mot[motor].full_power_ms += (uint32_t)((power * elapsed) + 0.5f);
+        }
+    }
+    if (((now - st_odo.persisted_ms) < ODOMETER_PERSIST_MS) || (cm_get_cycle_type() != CYCLE_NONE)) {
+        return (STAT_NOOP);
+    }
+    st_odo.persisted_ms = now;
+    st_persist_odometers();
+    return (STAT_OK);
+}
+
+/*
+ * st_persist_odometers() - write the motor odometers to persistence
+ * st_restore_odometers() - set the motor odometers from persistence, whichever build wrote them
+ *
+ *  The odometers aren't settings. config_init() restores them when the store is from another
+ *  build, and a defaults load persists them into its fresh area, so neither loses them.
+ */
+
+static const char *const _odometer_tokens[] = { "ost", "orv", "oen", "opw", "opk" };
+
+static bool _odometer_index(nvObj_t *nv, const uint8_t motor, const uint8_t i)
+{
+    sprintf((char *)nv->token, "%d%s", motor+1, _odometer_tokens[i]);
+    return ((nv->index = nv_get_index((const char *)"", nv->token)) != NO_MATCH);
+}
+
+void st_persist_odometers()
+{
+    nvObj_t nv;
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
+        for (uint8_t i=0; i < (sizeof(_odometer_tokens) / sizeof(_odometer_tokens[0])); i++) {
+            if (_odometer_index(&nv, motor, i)) {
+                nv_get(&nv);
+                nv_persist(&nv);    // Note: nv_persist() only writes values that have changed
+            }
+        }
+    }
+}
+
+void st_restore_odometers()
+{
+    nvObj_t nv;
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
+        for (uint8_t i=0; i < (sizeof(_odometer_tokens) / sizeof(_odometer_tokens[0])); i++) {
+            if (_odometer_index(&nv, motor, i) && (read_persistent_value(&nv) == STAT_OK)) {
+                cfgArray[nv.index].set(&nv);
+            }
+        }
+    }
+}
+
+/*
+ * st_motor_stalled()         - handle a stall reported by a motor driver (may be called from an ISR)
+ * st_axis_can_sense_stall()  - true if a motor on the axis is set up for sensorless homing
+ * st_set_axis_stall_detect() - arm or disarm stall sensing on the axis' motors
+ * st_reset_stall_detect()    - return all motors to their run time stall sensing
+ * _report_stalls()           - report run time stalls from the main loop
+ *
+ *  A driver that senses stalls ({1sm:} > 0) reports through st_motor_stalled(). A homing cycle
+ *  takes the stall as its homing switch. Otherwise motors in STALL_MODE_HOMING_AND_RUN stop
+ *  the machine with a feedhold, which reacts well before the position error from the lost
+ *  steps could show up as a following error.
+ */
+
+static volatile uint16_t stalled_motors = 0;    // motors that stalled since the last report
+
+void st_motor_stalled(Stepper *motor)
+{
+    for (uint8_t m = MOTOR_1; m < MOTORS; m++) {
+        if (Motors[m] != motor) {
+            continue;
+        }
+        if (cm_homing_motor_stalled(m)) {
+            return;
+        }
+        if (st_cfg.mot[m].stall_mode == STALL_MODE_HOMING_AND_RUN) {
+            cm_request_feedhold(FEEDHOLD_TYPE_HOLD, FEEDHOLD_EXIT_STOP);
+            stalled_motors |= (1 << m);
+        }
+        return;
+    }
+}
+
+bool st_axis_can_sense_stall(const uint8_t axis)
+{
+    for (uint8_t m = MOTOR_1; m < MOTORS; m++) {
+        if ((st_cfg.mot[m].motor_map == axis) && (st_cfg.mot[m].stall_mode != STALL_MODE_OFF) &&
+            Motors[m]->canSenseStall()) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+void st_set_axis_stall_detect(const uint8_t axis, const bool armed)
+{
+    for (uint8_t m = MOTOR_1; m < MOTORS; m++) {
+        if ((st_cfg.mot[m].motor_map == axis) && (st_cfg.mot[m].stall_mode != STALL_MODE_OFF)) {
+            Motors[m]->setStallDetect(armed);
+        }
+    }
+}
+
+void st_reset_stall_detect()
+{
+    for (uint8_t m = MOTOR_1; m < MOTORS; m++) {
+        Motors[m]->setStallDetect(st_cfg.mot[m].stall_mode == STALL_MODE_HOMING_AND_RUN);
+    }
+}
+
+static void _report_stalls()
+{
+    if (stalled_motors == 0) {
+        return;
+    }
+    uint16_t motors = stalled_motors;
+    stalled_motors = 0;
+    for (uint8_t m = MOTOR_1; m < MOTORS; m++) {
+        if (motors & (1 << m)) {
+            char msg[10];
+            sprintf(msg, "motor %d", m+1);
+            rpt_exception(STAT_MOTOR_STALL, msg);
+        }
+    }
+}
+
 /******************************
  * Interrupt Service Routines *
  ******************************/
@@ -260,92 +556,494 @@ stat_t st_motor_power_callback()     // called by controller
  *    - run the DDA for each channel
  *    - decrement the downcount - if it reaches zero load the next segment
  *
+ *  The motors are serviced from a compile-time list (DDA_MOTOR_LIST) that the templates below
+ *  expand into the same straight-line code as a hand unrolled loop: each motor is called on its
+ *  concrete type, so stepStart() / stepEnd() inline and there is no per-motor #if or vtable
+ *  lookup. _load_move() and the power timeouts use the same list, so boards with more than
+ *  6 motors only need to declare motor_7 .. motor_9 (and their Motors[] entries). The ISR and
+ *  the loader cost grows by one motor's worth per motor in the list; {profdd:} and {profld:}
+ *  report what they take on the board at hand (see profiler.h). The sim builds with 4 to 9
+ *  motors (SIM_MOTORS in board/sim.mk) to exercise the larger lists.
+ *
  *  Note that the motor_N.step.isNull() tests are compile-time tests, not run-time tests.
  *  If motor_N is not defined that if{} clause (i.e. that motor) drops out of the complied code.
  */
 
+#if MOTORS == 1
+#define DDA_MOTOR_LIST motor_1
+#elif MOTORS == 2
+#define DDA_MOTOR_LIST motor_1, motor_2
+#elif MOTORS == 3
+#define DDA_MOTOR_LIST motor_1, motor_2, motor_3
+#elif MOTORS == 4
+#define DDA_MOTOR_LIST motor_1, motor_2, motor_3, motor_4
+#elif MOTORS == 5
+#define DDA_MOTOR_LIST motor_1, motor_2, motor_3, motor_4, motor_5
+#elif MOTORS == 6
+#define DDA_MOTOR_LIST motor_1, motor_2, motor_3, motor_4, motor_5, motor_6
+#elif MOTORS == 7
+#define DDA_MOTOR_LIST motor_1, motor_2, motor_3, motor_4, motor_5, motor_6, motor_7
+#elif MOTORS == 8
+#define DDA_MOTOR_LIST motor_1, motor_2, motor_3, motor_4, motor_5, motor_6, motor_7, motor_8
+#elif MOTORS == 9
+#define DDA_MOTOR_LIST motor_1, motor_2, motor_3, motor_4, motor_5, motor_6, motor_7, motor_8, motor_9
+#else
+#error "DDA_MOTOR_LIST supports 1 to 9 motors"
+#endif
+
+/*
+ *  Port-grouped step and direction output
+ *
+ *  A board that uses StepDirStepper for every motor can list its PIO ports in board_stepper.h:
+ *
+ *    #define STEP_PORT_LETTERS 'A', 'B', 'C', 'D'
+ *
+ *  The DDA then ORs the step pins of every motor that steps this tick into one mask per port
+ *  and asserts each port with at most two writes (one for active-high, one for active-low
+ *  pins), so all axes step together and the ISR no longer does 2 x MOTORS pin writes. The
+ *  port and bit of each pin come from the Motate pin types, so the list only has to say which
+ *  ports exist. Direction changes in _load_move() are gathered and written the same way.
+ *
+ *  Step polarity is a runtime setting, so _update_step_ports() rebuilds the active-low masks
+ *  at init and whenever {Nsp:} changes.
+ */
+
+#ifdef STEP_PORT_LETTERS
+
+constexpr char _step_port_letters[] = { STEP_PORT_LETTERS };
+#define STEP_PORTS (sizeof(_step_port_letters))
+
+// index of a port in STEP_PORT_LETTERS - unused (null) pins have no port and map to 0 with an empty mask
+constexpr uint8_t _step_port_index(const char letter, const uint8_t i = 0) {
+    return ((letter == 0) ? 0 :
+           ((i >= STEP_PORTS) ? 0xFF :
+           ((_step_port_letters[i] == letter) ? i : _step_port_index(letter, i+1))));
+}
+
+typedef struct stStepPort {
+    uint32_t step_active_low;           // step pins on this port with active low polarity
+    uint32_t step_start;                // step pins to assert this tick
+    uint32_t step_asserted;             // step pins asserted last tick, to clear this tick
+    uint32_t dir_set;                   // direction pins to set (CCW) at load
+    uint32_t dir_clear;                 // direction pins to clear (CW) at load
+} stStepPort_t;
+
+static stStepPort_t st_port[STEP_PORTS];
+
+template <typename M>
+struct _stepPins {
+    typedef typename M::step_pin_type step_pin;
+    typedef typename M::dir_pin_type dir_pin;
+    static constexpr uint8_t step_port = _step_port_index(step_pin::portLetter);
+    static constexpr uint8_t dir_port = _step_port_index(dir_pin::portLetter);
+    static_assert(step_port != 0xFF, "A step pin is on a port missing from STEP_PORT_LETTERS");
+    static_assert(dir_port != 0xFF, "A direction pin is on a port missing from STEP_PORT_LETTERS");
+};
+
+static inline void _build_step_ports() {}
+
+template <typename M, typename... Ms>
+static inline void _build_step_ports(M &motor, Ms &... motors)
+{
+    if (motor.getStepPolarity() == IO_ACTIVE_LOW) {
+        st_port[_stepPins<M>::step_port].step_active_low |= _stepPins<M>::step_pin::mask;
+    }
+    _build_step_ports(motors...);
+}
+
+static void _update_step_ports()
+{
+    for (uint8_t i=0; i<STEP_PORTS; i++) {
+        st_port[i].step_active_low = 0;
+    }
+    _build_step_ports(DDA_MOTOR_LIST);
+}
+
+// write the gathered masks to each port - I is the index of the head of the letter list
+template <uint8_t I>
+static inline void _write_step_ports() {}
+
+template <uint8_t I, char L, char... Ls>
+static inline void _write_step_ports()
+{
+    stStepPort_t *p = &st_port[I];
+    if (p->step_start) {
+        Port32<L> port;
+        port.set(p->step_start & ~p->step_active_low);
+        port.clear(p->step_start & p->step_active_low);
+        p->step_asserted = p->step_start;
+        p->step_start = 0;
+    }
+    _write_step_ports<I+1, Ls...>();
+}
+
+template <uint8_t I>
+static inline void _clear_step_ports() {}
+
+template <uint8_t I, char L, char... Ls>
+static inline void _clear_step_ports()
+{
+    stStepPort_t *p = &st_port[I];
+    if (p->step_asserted) {
+        Port32<L> port;
+        port.set(p->step_asserted & p->step_active_low);
+        port.clear(p->step_asserted & ~p->step_active_low);
+        p->step_asserted = 0;
+    }
+    _clear_step_ports<I+1, Ls...>();
+}
+
+template <uint8_t I>
+static inline void _write_dir_ports() {}
+
+template <uint8_t I, char L, char... Ls>
+static inline void _write_dir_ports()
+{
+    stStepPort_t *p = &st_port[I];
+    if (p->dir_set | p->dir_clear) {
+        Port32<L> port;
+        port.set(p->dir_set);
+        port.clear(p->dir_clear);
+        p->dir_set = 0;
+        p->dir_clear = 0;
+    }
+    _write_dir_ports<I+1, Ls...>();
+}
+
+template <uint8_t I>
+static inline bool _step_ports_asserted() { return (false); }
+
+template <uint8_t I, char L, char... Ls>
+static inline bool _step_ports_asserted()
+{
+    return ((st_port[I].step_asserted != 0) || _step_ports_asserted<I+1, Ls...>());
+}
+
+#define _dda_step_end(...) _clear_step_ports<0, STEP_PORT_LETTERS>()
+#define _dda_step_asserted() _step_ports_asserted<0, STEP_PORT_LETTERS>()
+#define _dda_step_write() _write_step_ports<0, STEP_PORT_LETTERS>()
+#define _dda_dir_write() _write_dir_ports<0, STEP_PORT_LETTERS>()
+
+template <uint8_t N, typename M>
+static inline void _dda_step(M &motor) {
+    st_port[_stepPins<M>::step_port].step_start |= _stepPins<M>::step_pin::mask;
+}
+
+template <uint8_t N, typename M>
+static inline void _set_direction(M &motor, const uint8_t direction) {
+    if (direction == DIRECTION_CW) {
+        st_port[_stepPins<M>::dir_port].dir_clear |= _stepPins<M>::dir_pin::mask;
+    } else {
+        st_port[_stepPins<M>::dir_port].dir_set |= _stepPins<M>::dir_pin::mask;
+    }
+}
+
+/*
+ *  Step schedule mode
+ *
+ *  Defining STEP_SCHEDULE in board_stepper.h (with STEP_PORT_LETTERS) moves the DDA out of the
+ *  HI interrupt. st_prep_line() runs every motor's accumulator over the whole segment and
+ *  writes the per-tick port masks into the schedule for its prep ring slot. _load_move()
+ *  points the DDA at the slot it loads, and each DDA tick then only plays one word per port. The tick rate is
+ *  unchanged, but the HI ISR costs the same for any number of motors. The accumulator work
+ *  moves to the exec interrupt, where the {seg:} budget check accounts for it.
+ *
+ *  In this mode the accumulators, phase correction and direction flip belong to prep. The
+ *  schedule also records the signed step count of each motor. The loader hands that count
+ *  to the encoders when the segment has played out, instead of counting every tick.
+ */
+
+#ifdef STEP_SCHEDULE
+
+#define STEP_SCHEDULE_TICKS ((uint32_t)(NOM_SEGMENT_TIME_MAX * 60 * FREQUENCY_DDA) + 1)
+
+typedef struct stStepSchedule {
+    uint32_t mask[STEP_SCHEDULE_TICKS][STEP_PORTS]; // step pins to assert on each DDA tick
+    int16_t steps[MOTORS];                          // signed steps in the schedule, for the encoders
+} stStepSchedule_t;
+
+typedef struct stScheduler {
+    stStepSchedule_t buf[PREP_RING_SIZE]; // one schedule per prep ring slot
+    stStepSchedule_t *run;              // schedule being played (nullptr until the first load)
+    const uint32_t *tick;               // next tick of the schedule being played
+    int32_t accumulator[MOTORS];        // DDA phase accumulators
+    uint8_t direction[MOTORS];          // direction of the last segment scheduled for each motor
+} stScheduler_t;
+
+static stScheduler_t st_sched;
+
+static void _reset_schedule()
+{
+    st_sched.run = nullptr;
+    for (uint8_t motor=0; motor<MOTORS; motor++) {
+        st_sched.accumulator[motor] = 0;
+        st_sched.direction[motor] = STEP_INITIAL_DIRECTION;
+    }
+}
+
+// run one motor's DDA over the segment - same arithmetic as the per-tick DDA and _load_move()
+template <uint8_t N>
+static inline void _schedule_motors(stPrepSegment_t *seg, stStepSchedule_t *sched) {}
+
+template <uint8_t N, typename M, typename... Ms>
+static inline void _schedule_motors(stPrepSegment_t *seg, stStepSchedule_t *sched, M &motor, Ms &... motors)
+{
+    stPrepSegmentMotor_t *pm = &seg->mot[N];
+    sched->steps[N] = 0;
+    if (pm->substep_increment != 0) {
+        int32_t accumulator = st_sched.accumulator[N];
+        if (pm->accumulator_correction_flag == true) {
+            pm->accumulator_correction_flag = false;
+            accumulator = (int32_t)(((int64_t)accumulator * pm->accumulator_correction) >> ACCUMULATOR_CORRECTION_SHIFT);
+        }
+        if (pm->direction != st_sched.direction[N]) {
+            st_sched.direction[N] = pm->direction;
+            accumulator = _reversed_accumulator(N, seg->dda_ticks_X_substeps, accumulator, pm->substep_increment);
+        }
+        const uint32_t pin = _stepPins<M>::step_pin::mask;
+        uint32_t *mask = &sched->mask[0][_stepPins<M>::step_port];
+        int16_t steps = 0;
+        for (uint32_t tick=0; tick < seg->dda_ticks; tick++, mask += STEP_PORTS) {
+            if ((accumulator += pm->substep_increment) > 0) {
+                *mask |= pin;
+                accumulator -= seg->dda_ticks_X_substeps;
+                steps++;
+            }
+        }
+        st_sched.accumulator[N] = accumulator;
+        sched->steps[N] = steps * pm->step_sign;
+    }
+    _schedule_motors<N+1>(seg, sched, motors...);
+}
+
+static stat_t _build_schedule(stPrepSegment_t *seg)
+{
+    if (seg->dda_ticks > STEP_SCHEDULE_TICKS) {         // never supposed to happen
+        return (cm_panic(STAT_INTERNAL_ERROR, "st_prep_line() segment longer than step schedule"));
+    }
+    stStepSchedule_t *sched = &st_sched.buf[st_pre.w];
+    memset(sched->mask, 0, seg->dda_ticks * sizeof(sched->mask[0]));
+    _schedule_motors<MOTOR_1>(seg, sched, DDA_MOTOR_LIST);
+    return (STAT_OK);
+}
+
+// called by _load_move() - credit the segment that just finished and start the next one
+static inline void _load_schedule()
+{
+    if (st_sched.run != nullptr) {
+        for (uint8_t motor=0; motor<MOTORS; motor++) {
+            en.en[motor].steps_run = st_sched.run->steps[motor];
+        }
+    }
+    st_sched.run = &st_sched.buf[st_pre.r];
+    st_sched.tick = &st_sched.run->mask[0][0];
+}
+
+// play one tick of the schedule - I is the index of the head of the letter list
+template <uint8_t I>
+static inline void _play_step_ports(const uint32_t *tick) {}
+
+template <uint8_t I, char L, char... Ls>
+static inline void _play_step_ports(const uint32_t *tick)
+{
+    const uint32_t start = tick[I];
+    if (start) {
+        stStepPort_t *p = &st_port[I];
+        Port32<L> port;
+        port.set(start & ~p->step_active_low);
+        port.clear(start & p->step_active_low);
+        p->step_asserted = start;
+    }
+    _play_step_ports<I+1, Ls...>(tick);
+}
+
+#endif // STEP_SCHEDULE
+
+#else // !STEP_PORT_LETTERS - each motor writes its own pins
+
+static void _update_step_ports() {}
+
+static bool _step_asserted;             // some motor's step pin is up
+
+// clear the step pins set during the previous interrupt
+static inline void _dda_step_end() { _step_asserted = false; }
+
+template <typename M, typename... Ms>
+static inline void _dda_step_end(M &motor, Ms &... motors)
+{
+    motor.stepEnd();
+    _dda_step_end(motors...);
+}
+
+#define _dda_step_write()
+#define _dda_dir_write()
+
+template <uint8_t N, typename M>
+static inline void _dda_step(M &motor) { motor.stepStart(); _step_asserted = true; }
+
+#define _dda_step_asserted() (_step_asserted)
+
+template <uint8_t N, typename M>
+static inline void _set_direction(M &motor, const uint8_t direction) { motor.setDirection(direction); }
+
+#endif // STEP_PORT_LETTERS
+
+#if defined(STEP_SCHEDULE) && !defined(STEP_PORT_LETTERS)
+#error "STEP_SCHEDULE requires STEP_PORT_LETTERS"
+#endif
+
+/*
+ *  Timed step pulses
+ *
+ *  By default a step pulse is raised in one DDA interrupt and dropped at the top of the next,
+ *  so it lasts a whole DDA tick. A motor that steps on consecutive ticks only gets the few
+ *  cycles between the drop and the next raise as its low time, which limits clean step rates
+ *  to about half of FREQUENCY_DDA. The last segment of a move also needs one more interrupt
+ *  just to drop its pulses.
+ *
+ *  Defining STEP_PULSE_NS in hardware.h (or board_stepper.h) ends the pulse in the interrupt
+ *  that raised it. The ISR spins on the DWT cycle counter until STEP_PULSE_NS has passed since
+ *  the last pin went up, then drops them all. A motor can then step cleanly on every DDA tick
+ *  and the timer stops as soon as the last segment has played out. The spin costs STEP_PULSE_NS
+ *  of each tick that steps (ticks that don't step don't wait), so set it to the drivers'
+ *  minimum pulse width - 1 to 2 us for most step/direction drivers.
+ */
+#ifdef STEP_PULSE_NS
+
+static_assert(STEP_PULSE_NS * 2 <= 1000000000 / FREQUENCY_DDA, "STEP_PULSE_NS must be under half a DDA tick");
+
+static inline void _dda_step_pulse()
+{
+    if (_dda_step_asserted()) {
+        const uint32_t start = cycle_count();
+        while ((cycle_count() - start) < _step_pulse_cycles);
+        _dda_step_end(DDA_MOTOR_LIST);
+    }
+}
+
+#endif // STEP_PULSE_NS
+
+/*
+ * _reversed_accumulator()   - substep accumulator for a motor that has just reversed
+ * _write_held_directions()  - write the direction changes the loader held back
+ * _flush_held_directions()  - write them now - used by stepper_reset()
+ *
+ *  Flipping the accumulator about its midpoint keeps the step phase across the reversal.
+ *  It is then pushed back, if need be, so the first step comes no sooner than the motor's
+ *  lead ticks. See Direction timing in stepper.h
+ */
+
+static inline int32_t _reversed_accumulator(const uint8_t motor, const uint32_t ticks_X_substeps,
+                                            const int32_t accumulator, const uint32_t increment)
+{
+    int32_t reversed = -((int32_t)ticks_X_substeps + accumulator);
+    const int32_t lead = -(int32_t)(st_run.mot[motor].dir_lead_ticks * increment);
+    return ((reversed > lead) ? lead : reversed);
+}
+
+template <uint8_t N>
+static inline void _write_held_directions() { st_run.dir_held = 0; }
+
+template <uint8_t N, typename M, typename... Ms>
+static inline void _write_held_directions(M &motor, Ms &... motors)
+{
+    if (st_run.dir_held & (1 << N)) {
+        _set_direction<N>(motor, st_pre.mot[N].prev_direction);
+    }
+    _write_held_directions<N+1>(motors...);
+}
+
+static void _flush_held_directions()
+{
+    st_run.dir_hold_downcount = 0;
+    if (st_run.dir_held) {
+        _write_held_directions<MOTOR_1>(DDA_MOTOR_LIST);
+        _dda_dir_write();
+    }
+}
+
+// convert each driver's direction timing to DDA ticks - called once the drivers are up
+static void _init_direction_timing()
+{
+    const uint32_t tick_ns = 1000000000UL / FREQUENCY_DDA;
+    for (uint8_t motor=0; motor<MOTORS; motor++) {
+        const uint32_t setup = (Motors[motor]->getDirectionSetupNs() + tick_ns - 1) / tick_ns;
+        const uint32_t hold = (Motors[motor]->getDirectionHoldNs() + tick_ns - 1) / tick_ns;
+        st_run.mot[motor].dir_hold_ticks = hold;
+        st_run.mot[motor].dir_lead_ticks = hold + setup;
+    }
+}
+
+// run the DDA for each motor - N is the motor index of the head of the list
+template <uint8_t N>
+static inline void _dda_step_start() {}
+
+template <uint8_t N, typename M, typename... Ms>
+static inline void _dda_step_start(M &motor, Ms &... motors)
+{
+    if ((st_run.mot[N].substep_accumulator += st_run.mot[N].substep_increment) > 0) {
+        _dda_step<N>(motor);        // turn step bit on (or queue it for the port write)
+        st_run.mot[N].substep_accumulator -= st_run.dda_ticks_X_substeps;
+        INCREMENT_ENCODER(N);
+    }
+    _dda_step_start<N+1>(motors...);
+}
+
 namespace Motate {            // Must define timer interrupts inside the Motate namespace
 template<>
-void dda_timer_type::interrupt()
+HOT_PATH void dda_timer_type::interrupt()
 {
+    ldScope _ld(LOAD_DDA);
+    PROF_BEGIN(_start);             // the end-of-segment tick below is not profiled
     dda_timer.getInterruptCause();  // clear interrupt condition
 
+#ifndef STEP_PULSE_NS
     // clear all steps from the previous interrupt
-    motor_1.stepEnd();
-    motor_2.stepEnd();
-#if MOTORS > 2
-    motor_3.stepEnd();
-#endif
-#if MOTORS > 3
-    motor_4.stepEnd();
-#endif
-#if MOTORS > 4
-    motor_5.stepEnd();
-#endif
-#if MOTORS > 5
-    motor_6.stepEnd();
+    _dda_step_end(DDA_MOTOR_LIST);
 #endif
 
     // process last DDA tick after end of segment
     if (st_run.dda_ticks_downcount == 0) {
         dda_timer.stop(); // turn it off or it will keep stepping out the last segment
+        if (pso.pulse_downcount) {
+            pso_end_pulse(); // don't leave a PSO pulse up while stopped
+        }
         return;
     }
 
-//  The following code would work, but it's faster on the M3 to loop unroll it. Perhaps not on the M7
-//    for (uint8_t motor=0; motor<MOTORS; motor++) {
-//        if  ((st_run.mot[motor].substep_accumulator += st_run.mot[motor].substep_increment) > 0) {
-//            Motors[motor]->stepStart();        // turn step bit on
-//            st_run.mot[motor].substep_accumulator -= st_run.dda_ticks_X_substeps;
-//            INCREMENT_ENCODER(motor);
-//        }
-//    }
+    // write direction changes held back by the loader - see Direction timing in stepper.h
+    if (st_run.dir_hold_downcount && (--st_run.dir_hold_downcount == 0)) {
+        _write_held_directions<MOTOR_1>(DDA_MOTOR_LIST);
+        _dda_dir_write();
+    }
 
     // process DDAs for each motor
-    if  ((st_run.mot[MOTOR_1].substep_accumulator += st_run.mot[MOTOR_1].substep_increment) > 0) {
-        motor_1.stepStart();        // turn step bit on
-        st_run.mot[MOTOR_1].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_1);
-    }
-    if ((st_run.mot[MOTOR_2].substep_accumulator += st_run.mot[MOTOR_2].substep_increment) > 0) {
-        motor_2.stepStart();        // turn step bit on
-        st_run.mot[MOTOR_2].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_2);
-    }
-#if MOTORS > 2
-    if ((st_run.mot[MOTOR_3].substep_accumulator += st_run.mot[MOTOR_3].substep_increment) > 0) {
-        motor_3.stepStart();        // turn step bit on
-        st_run.mot[MOTOR_3].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_3);
-    }
-#endif
-#if MOTORS > 3
-    if ((st_run.mot[MOTOR_4].substep_accumulator += st_run.mot[MOTOR_4].substep_increment) > 0) {
-        motor_4.stepStart();        // turn step bit on
-        st_run.mot[MOTOR_4].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_4);
-    }
+#ifdef STEP_SCHEDULE
+    _play_step_ports<0, STEP_PORT_LETTERS>(st_sched.tick);
+    st_sched.tick += STEP_PORTS;
+#else
+    _dda_step_start<MOTOR_1>(DDA_MOTOR_LIST);
+    _dda_step_write();
 #endif
-#if MOTORS > 4
-    if ((st_run.mot[MOTOR_5].substep_accumulator += st_run.mot[MOTOR_5].substep_increment) > 0) {
-        motor_5.stepStart();        // turn step bit on
-        st_run.mot[MOTOR_5].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_5);
-    }
-#endif
-#if MOTORS > 5
-    if ((st_run.mot[MOTOR_6].substep_accumulator += st_run.mot[MOTOR_6].substep_increment) > 0) {
-        motor_6.stepStart();        // turn step bit on
-        st_run.mot[MOTOR_6].substep_accumulator -= st_run.dda_ticks_X_substeps;
-        INCREMENT_ENCODER(MOTOR_6);
-    }
+#ifdef STEP_PULSE_NS
+    _dda_step_pulse();              // hold the pulses for STEP_PULSE_NS and drop them
 #endif
+    pso_dda_tick();                 // position synchronized output
+    sync_dda_tick();                // multi-board sync clock
 
     // Process end of segment.
     // One more interrupt will occur to turn of any pulses set in this pass.
     if (--st_run.dda_ticks_downcount == 0) {
+        PROF_BEGIN(_load_start);
         _load_move();       // load the next move at the current interrupt level
+        PROF_END(_load_start, PROF_LOAD);
+#ifdef STEP_PULSE_NS
+        if (st_run.dda_ticks_downcount == 0) {
+            dda_timer.stop();   // nothing loaded and no pulses left up, so no need for the extra tick
+        }
+#endif
     }
+    PROF_END(_start, PROF_DDA_ISR);
 } // MOTATE_TIMER_INTERRUPT
 } // namespace Motate
 
@@ -353,11 +1051,34 @@ void dda_timer_type::interrupt()
  * Exec sequencing code   - computes and prepares next load segment
  * st_request_exec_move() - SW interrupt to request to execute a move
  * exec_timer interrupt   - interrupt handler for calling exec function
+ * _prep_slot_is_free()   - true if exec may prepare into the next ring slot
+ * _prep_commit()         - hand the slot exec just prepared to the loader
+ *
+ *  Exec keeps re-requesting itself after each line segment until the prep ring is full, so it
+ *  runs ahead of the loader in bursts. A queued command is only freed from the planner when
+ *  the loader runs it, so exec holds off until then or it would prep the same command again.
  */
 
+static inline uint8_t _prep_next(const uint8_t slot) { return ((slot + 1 < PREP_RING_SIZE) ? slot + 1 : 0); }
+
+static inline bool _prep_slot_is_free()
+{
+    return ((st_pre.seg[st_pre.w].buffer_state == PREP_BUFFER_OWNED_BY_EXEC) && !st_pre.command_queued);
+}
+
+static void _prep_commit()
+{
+    stPrepSegment_t *seg = &st_pre.seg[st_pre.w];
+    if (seg->block_type == BLOCK_TYPE_COMMAND) {
+        st_pre.command_queued = true;
+    }
+    seg->buffer_state = PREP_BUFFER_OWNED_BY_LOADER;
+    st_pre.w = _prep_next(st_pre.w);
+}
+
 void st_request_exec_move()
 {
-    if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_EXEC) { // bother interrupting
+    if (_prep_slot_is_free()) {                             // bother interrupting
         exec_timer.setInterruptPending();
         return;
     }
@@ -367,11 +1088,25 @@ namespace Motate {    // Define timer inside Motate namespace
     template<>
     void exec_timer_type::interrupt()
     {
+        ldScope _ld(LOAD_EXEC);
         exec_timer.getInterruptCause();                    // clears the interrupt condition
-        if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_EXEC) {
-            if (mp_exec_move() != STAT_NOOP) {
-                st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER; // flip it back
+        if (_prep_slot_is_free()) {
+            uint32_t start = cycle_count();
+            stat_t status = mp_exec_move();                // includes st_prep_line()
+            uint32_t cycles = cycle_count() - start;
+            if (cycles > mp_seg.exec_cycles_max) {
+                mp_seg.exec_cycles_max = cycles;           // worst case for the {seg:} budget
+            }
+#ifdef __PROFILER
+            prof_record(PROF_EXEC_ISR, cycles);
+#endif
+            if (status != STAT_NOOP) {
+                bool run_ahead = (st_pre.seg[st_pre.w].block_type == BLOCK_TYPE_ALINE);
+                _prep_commit();                            // hand it to the loader
                 st_request_load_move();
+                if (run_ahead) {
+                    st_request_exec_move();                // keep going while there is room in the ring
+                }
                 return;
             }
         }
@@ -392,8 +1127,12 @@ namespace Motate {    // Define timer inside Motate namespace
     template<>
     void fwd_plan_timer_type::interrupt()
     {
+        ldScope _ld(LOAD_FWD_PLAN);
         fwd_plan_timer.getInterruptCause();     // clears the interrupt condition
-        if (mp_forward_plan() != STAT_NOOP) {   // We now have a move to exec.
+        PROF_BEGIN(_start);
+        stat_t status = mp_forward_plan();
+        PROF_END(_start, PROF_FWD_PLAN_ISR);
+        if (status != STAT_NOOP) {              // We now have a move to exec.
             st_request_exec_move();
             return;
         }
@@ -415,8 +1154,10 @@ void st_request_load_move()
     if (st_runtime_isbusy()) {                                      // don't request a load if the runtime is busy
         return;
     }
-    if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_LOADER) {       // bother interrupting
+    if (st_pre.seg[st_pre.r].buffer_state == PREP_BUFFER_OWNED_BY_LOADER) { // bother interrupting
+       PROF_BEGIN(_start);
        _load_move();
+       PROF_END(_start, PROF_LOAD);
     }
 }
 
@@ -433,191 +1174,178 @@ void st_request_load_move()
  *   - If axis has 0 steps the motor power must be set accord to the power mode
  */
 
-static void _load_move()
-{
-    // Be aware that dda_ticks_downcount must equal zero for the loader to run.
-    // So the initial load must also have this set to zero as part of initialization
-    if (st_runtime_isbusy()) {
-        return;                     // exit if the runtime is busy
-    }
+// start every motor's power timeout
+static inline void _motion_stopped() {}
 
-    // If there are no moves to load start motor power timeouts
-    if (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_LOADER) {
-        motor_1.motionStopped();    // ...start motor power timeouts
-        motor_2.motionStopped();
-#if (MOTORS > 2)
-        motor_3.motionStopped();
-#endif
-#if (MOTORS > 3)
-        motor_4.motionStopped();
-#endif
-#if (MOTORS > 4)
-        motor_5.motionStopped();
-#endif
-#if (MOTORS > 5)
-        motor_6.motionStopped();
-#endif
-        return;
-    } // if (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_LOADER)
+template <typename M, typename... Ms>
+static inline void _motion_stopped(M &motor, Ms &... motors)
+{
+    motor.motionStopped();
+    _motion_stopped(motors...);
+}
 
-    // handle aline loads first (most common case)
-    if (st_pre.block_type == BLOCK_TYPE_ALINE) {
+// load each motor's values for the segment - N is the motor index of the head of the list
+template <uint8_t N>
+static inline void _load_motors(stPrepSegment_t *seg) {}
 
-        //**** setup the new segment ****
+template <uint8_t N, typename M, typename... Ms>
+static inline void _load_motors(stPrepSegment_t *seg, M &motor, Ms &... motors)
+{
+    // a position motor is sent the segment's target and takes no steps (see Position motors in stepper.h)
+    if (seg->position_motors & (1 << N)) {
+        st_run.mot[N].substep_increment = 0;
+        en.en[N].encoder_steps = (int32_t)en.en[N].target_steps;    // the last target has been reached
+        motor.enable();
+        motor.setTargetPosition(st_cfg.mot[N].polarity ? -seg->target_steps[N] : seg->target_steps[N],
+                                seg->position_time);
+
+    // the following if() statement sets the runtime substep increment value or zeroes it
+    } else if ((st_run.mot[N].substep_increment = seg->mot[N].substep_increment) != 0) {
+
+        // NB: If motor has 0 steps the following is all skipped. This ensures that state comparisons
+        //     always operate on the last segment actually run by this motor, regardless of how many
+        //     segments it may have been inactive in between.
+
+        st_odo.mot[N].steps += seg->mot[N].odometer_steps;
+
+        // Apply accumulator correction if the time base has changed since previous segment
+        if (seg->mot[N].accumulator_correction_flag == true) {
+            seg->mot[N].accumulator_correction_flag = false;
+            st_run.mot[N].substep_accumulator = (int32_t)(((int64_t)st_run.mot[N].substep_accumulator * seg->mot[N].accumulator_correction) >> ACCUMULATOR_CORRECTION_SHIFT);
+        }
 
-        debug_trap_if_true((st_run.dda_ticks_downcount != 0), "_load_move() downcount is not zero");
-        st_run.dda_ticks_downcount = st_pre.dda_ticks;
-        st_run.dda_ticks_X_substeps = st_pre.dda_ticks_X_substeps;
+        // Detect direction change and if so:
+        //    Set the direction bit in hardware.
+        //    Compensate for direction change by flipping substep accumulator value about its midpoint.
+
+        if (seg->mot[N].direction != st_pre.mot[N].prev_direction) {
+            st_pre.mot[N].prev_direction = seg->mot[N].direction;
+            st_odo.mot[N].reversals++;
+            st_run.mot[N].substep_accumulator = _reversed_accumulator(N, st_run.dda_ticks_X_substeps,
+                                                                      st_run.mot[N].substep_accumulator,
+                                                                      st_run.mot[N].substep_increment);
+            if (st_run.mot[N].dir_hold_ticks == 0) {
+                _set_direction<N>(motor, seg->mot[N].direction);
+            } else {                                    // the DDA writes it when the hold is up
+                st_run.dir_held |= (1 << N);
+                if (st_run.dir_hold_downcount < st_run.mot[N].dir_hold_ticks) {
+                    st_run.dir_hold_downcount = st_run.mot[N].dir_hold_ticks;
+                }
+            }
+        }
 
-        // INLINED VERSION: 4.3us
-        //**** MOTOR_1 LOAD ****
+        // Enable the stepper and start/update motor power management
+        motor.enable();
+        SET_ENCODER_STEP_SIGN(N, seg->mot[N].step_sign);
 
-        // These sections are somewhat optimized for execution speed. The whole load operation
-        // is supposed to take < 5 uSec (Arm M3 core). Be careful if you mess with this.
+    } else {  // Motor has 0 steps; might need to energize motor for power mode processing
+        motor.motionStopped();
+    }
+    // accumulate counted steps to the step position and zero out counted steps for the segment currently being loaded
+    ACCUMULATE_ENCODER(N);
+    LATCH_FOLLOWING_ERROR(N, seg->target_steps[N]);
 
-        // the following if() statement sets the runtime substep increment value or zeroes it
-        if ((st_run.mot[MOTOR_1].substep_increment = st_pre.mot[MOTOR_1].substep_increment) != 0) {
+    _load_motors<N+1>(seg, motors...);
+}
 
-            // NB: If motor has 0 steps the following is all skipped. This ensures that state comparisons
-            //     always operate on the last segment actually run by this motor, regardless of how many
-            //     segments it may have been inactive in between.
+// called by _load_move() - switch the segment's synchronized outputs (M62, M63)
+static void _load_outputs(const stPrepSegment_t *seg)
+{
+    for (uint8_t i=0; i<D_OUT_CHANNELS; i++) {
+        if (seg->output_set & (1 << i)) {
+            gpio_set_output(i, 1.0);
+        } else if (seg->output_clear & (1 << i)) {
+            gpio_set_output(i, 0.0);
+        }
+    }
+}
 
-            // Apply accumulator correction if the time base has changed since previous segment
-            if (st_pre.mot[MOTOR_1].accumulator_correction_flag == true) {
-                st_pre.mot[MOTOR_1].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_1].substep_accumulator *= st_pre.mot[MOTOR_1].accumulator_correction;
-            }
+HOT_PATH static void _load_move()
+{
+    // Be aware that dda_ticks_downcount must equal zero for the loader to run.
+    // So the initial load must also have this set to zero as part of initialization
+    if (st_runtime_isbusy() || st_run.steps_halted) {
+        return;                     // exit if the runtime is busy, or halted until stepper_reset()
+    }
+    stPrepSegment_t *seg = &st_pre.seg[st_pre.r];
 
-            // Detect direction change and if so:
-            //    Set the direction bit in hardware.
-            //    Compensate for direction change by flipping substep accumulator value about its midpoint.
+    // If there are no moves to load start motor power timeouts
+    if (seg->buffer_state != PREP_BUFFER_OWNED_BY_LOADER) {
+        if (st_run.raster_active) { // don't leave the laser on a pixel while stopped
+            spindle_raster_power(0);
+        }
+        _motion_stopped(DDA_MOTOR_LIST);    // ...start motor power timeouts
+        return;
+    } // if (seg->buffer_state != PREP_BUFFER_OWNED_BY_LOADER)
+
+    // Scanline pixels drive the spindle PWM in step with the segments. Anything else that
+    // follows a scanline gets the spindle's own PWM back before it runs, so a command that
+    // changes the spindle (e.g. M5) always has the last word
+    if (seg->block_type == BLOCK_TYPE_ALINE && seg->raster_intensity >= 0) {
+        spindle_raster_power(seg->raster_intensity);
+        st_run.raster_active = true;
+    } else if (st_run.raster_active) {
+        spindle_raster_end();
+        st_run.raster_active = false;
+    }
 
-            if (st_pre.mot[MOTOR_1].direction != st_pre.mot[MOTOR_1].prev_direction) {
-                st_pre.mot[MOTOR_1].prev_direction = st_pre.mot[MOTOR_1].direction;
-                st_run.mot[MOTOR_1].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_1].substep_accumulator);
-                motor_1.setDirection(st_pre.mot[MOTOR_1].direction);
-            }
+    // handle aline loads first (most common case)
+    if (seg->block_type == BLOCK_TYPE_ALINE) {
+        pwm_latch();                                    // duty cycles the exec posted for this segment
 
-            // Enable the stepper and start/update motor power management
-            motor_1.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_1, st_pre.mot[MOTOR_1].step_sign);
+        //**** setup the new segment ****
 
-        } else {  // Motor has 0 steps; might need to energize motor for power mode processing
-            motor_1.motionStopped();
-        }
-        // accumulate counted steps to the step position and zero out counted steps for the segment currently being loaded
-        ACCUMULATE_ENCODER(MOTOR_1);
-
-#if (MOTORS >= 2)
-        if ((st_run.mot[MOTOR_2].substep_increment = st_pre.mot[MOTOR_2].substep_increment) != 0) {
-            if (st_pre.mot[MOTOR_2].accumulator_correction_flag == true) {
-                st_pre.mot[MOTOR_2].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_2].substep_accumulator *= st_pre.mot[MOTOR_2].accumulator_correction;
-            }
-            if (st_pre.mot[MOTOR_2].direction != st_pre.mot[MOTOR_2].prev_direction) {
-                st_pre.mot[MOTOR_2].prev_direction = st_pre.mot[MOTOR_2].direction;
-                st_run.mot[MOTOR_2].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_2].substep_accumulator);
-                motor_2.setDirection(st_pre.mot[MOTOR_2].direction);
-            }
-            motor_2.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_2, st_pre.mot[MOTOR_2].step_sign);
-        } else {
-            motor_2.motionStopped();
-        }
-        ACCUMULATE_ENCODER(MOTOR_2);
-#endif
-#if (MOTORS >= 3)
-        if ((st_run.mot[MOTOR_3].substep_increment = st_pre.mot[MOTOR_3].substep_increment) != 0) {
-            if (st_pre.mot[MOTOR_3].accumulator_correction_flag == true) {
-                st_pre.mot[MOTOR_3].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_3].substep_accumulator *= st_pre.mot[MOTOR_3].accumulator_correction;
-            }
-            if (st_pre.mot[MOTOR_3].direction != st_pre.mot[MOTOR_3].prev_direction) {
-                st_pre.mot[MOTOR_3].prev_direction = st_pre.mot[MOTOR_3].direction;
-                st_run.mot[MOTOR_3].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_3].substep_accumulator);
-                motor_3.setDirection(st_pre.mot[MOTOR_3].direction);
-            }
-            motor_3.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_3, st_pre.mot[MOTOR_3].step_sign);
-        } else {
-            motor_3.motionStopped();
-        }
-        ACCUMULATE_ENCODER(MOTOR_3);
-#endif
-#if (MOTORS >= 4)
-        if ((st_run.mot[MOTOR_4].substep_increment = st_pre.mot[MOTOR_4].substep_increment) != 0) {
-            if (st_pre.mot[MOTOR_4].accumulator_correction_flag == true) {
-                st_pre.mot[MOTOR_4].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_4].substep_accumulator *= st_pre.mot[MOTOR_4].accumulator_correction;
-            }
-            if (st_pre.mot[MOTOR_4].direction != st_pre.mot[MOTOR_4].prev_direction) {
-                st_pre.mot[MOTOR_4].prev_direction = st_pre.mot[MOTOR_4].direction;
-                st_run.mot[MOTOR_4].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_4].substep_accumulator);
-                motor_4.setDirection(st_pre.mot[MOTOR_4].direction);
-            }
-            motor_4.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_4, st_pre.mot[MOTOR_4].step_sign);
-        } else {
-            motor_4.motionStopped();
-        }
-        ACCUMULATE_ENCODER(MOTOR_4);
-#endif
-#if (MOTORS >= 5)
-        if ((st_run.mot[MOTOR_5].substep_increment = st_pre.mot[MOTOR_5].substep_increment) != 0) {
-            if (st_pre.mot[MOTOR_5].accumulator_correction_flag == true) {
-                st_pre.mot[MOTOR_5].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_5].substep_accumulator *= st_pre.mot[MOTOR_5].accumulator_correction;
-            }
-            if (st_pre.mot[MOTOR_5].direction != st_pre.mot[MOTOR_5].prev_direction) {
-                st_pre.mot[MOTOR_5].prev_direction = st_pre.mot[MOTOR_5].direction;
-                st_run.mot[MOTOR_5].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_5].substep_accumulator);
-                motor_5.setDirection(st_pre.mot[MOTOR_5].direction);
-            }
-            motor_5.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_5, st_pre.mot[MOTOR_5].step_sign);
-        } else {
-            motor_5.motionStopped();
+        debug_trap_if_true((st_run.dda_ticks_downcount != 0), "_load_move() downcount is not zero");
+        st_run.dda_ticks_downcount = seg->dda_ticks;
+        st_run.dda_ticks_X_substeps = seg->dda_ticks_X_substeps;
+        pso.increment = seg->pso_increment;
+        pso.pulse_ticks = seg->pso_pulse_ticks;
+        if (seg->output_set || seg->output_clear) {
+            _load_outputs(seg);
         }
-        ACCUMULATE_ENCODER(MOTOR_5);
-#endif
-#if (MOTORS >= 6)
-        if ((st_run.mot[MOTOR_6].substep_increment = st_pre.mot[MOTOR_6].substep_increment) != 0) {
-            if (st_pre.mot[MOTOR_6].accumulator_correction_flag == true) {
-                st_pre.mot[MOTOR_6].accumulator_correction_flag = false;
-                st_run.mot[MOTOR_6].substep_accumulator *= st_pre.mot[MOTOR_6].accumulator_correction;
-            }
-            if (st_pre.mot[MOTOR_6].direction != st_pre.mot[MOTOR_6].prev_direction) {
-                st_pre.mot[MOTOR_6].prev_direction = st_pre.mot[MOTOR_6].direction;
-                st_run.mot[MOTOR_6].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_6].substep_accumulator);
-                motor_6.setDirection(st_pre.mot[MOTOR_6].direction);
-            }
-            motor_6.enable();
-            SET_ENCODER_STEP_SIGN(MOTOR_6, st_pre.mot[MOTOR_6].step_sign);
-        } else {
-            motor_6.motionStopped();
+        if (seg->dda_divisor != st_run.dda_divisor) {  // change the DDA rate
+            st_run.dda_divisor = seg->dda_divisor;
+            dda_timer.setModeAndFrequency(kTimerUpToMatch, FREQUENCY_DDA / st_run.dda_divisor);
         }
-        ACCUMULATE_ENCODER(MOTOR_6);
+        sync_load_segment(st_run.dda_divisor);
+#ifdef STEP_SCHEDULE
+        _load_schedule();
 #endif
 
+        // The motor values are loaded by _load_motors(), which the compiler unrolls over the
+        // motor list. The whole load operation is supposed to take < 5 uSec (Arm M3 core).
+        // Be careful if you mess with this.
+        _load_motors<MOTOR_1>(seg, DDA_MOTOR_LIST);
+
+        _dda_dir_write();                               // write any gathered direction changes
+
         //**** do this last ****
 
         dda_timer.start();                              // start the DDA timer if not already running
 
     // handle dwells and commands
-    } else if (st_pre.block_type == BLOCK_TYPE_DWELL) {
-        st_run.dwell_ticks_downcount = st_pre.dwell_ticks;
+    } else if (seg->block_type == BLOCK_TYPE_DWELL) {
+        st_run.dwell_ticks_downcount = seg->dwell_ticks + 1;   // the tick it starts in is partial
         SysTickTimer.registerEvent(&dwell_systick_event); // We now use SysTick events to handle dwells
 
     // handle synchronous commands
-    } else if (st_pre.block_type == BLOCK_TYPE_COMMAND) {
-        mp_runtime_command(st_pre.bf);
+    } else if (seg->block_type == BLOCK_TYPE_COMMAND) {
+        mp_runtime_command(seg->bf);
 
     } // else null - which is okay in many cases
 
     // all other cases drop to here (e.g. Null moves after Mcodes skip to here)
-    st_pre.block_type = BLOCK_TYPE_NULL;
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC;    // we are done with the prep buffer - flip the flag back
+    const blockType loaded = seg->block_type;
+    if (loaded == BLOCK_TYPE_COMMAND) {
+        st_pre.command_queued = false;                  // the command has run and freed its planner buffer
+    }
+    seg->block_type = BLOCK_TYPE_NULL;
+    seg->buffer_state = PREP_BUFFER_OWNED_BY_EXEC;      // we are done with the prep slot - flip the flag back
+    st_pre.r = _prep_next(st_pre.r);
     st_request_exec_move();                             // exec and prep next move
+    if ((loaded != BLOCK_TYPE_ALINE) && (loaded != BLOCK_TYPE_DWELL)) {
+        st_request_load_move();                         // nothing is running - load the next slot now
+    }
 }
 
 /***********************************************************************************
@@ -636,39 +1364,128 @@ static void _load_move()
  *
  *    - following_error[] is a vector of measured errors to the step count. Used for correction.
  *
+ *    - target_steps[] is the absolute position in steps at the end of the segment. The loader
+ *      latches the following error against it when the segment completes (see encoder.h).
+ *
  *    - segment_time - how many minutes the segment should run. If timing is not
  *      100% accurate this will affect the move velocity, but not the distance traveled.
  *
+ *    - raster_intensity - scanline pixel or velocity-synced power (0-255) the loader applies
+ *      to the spindle PWM when the segment starts, or -1 to leave the PWM alone.
+ *
  * NOTE:  Many of the expressions are sensitive to casting and execution order to avoid long-term
  *        accuracy errors due to floating point round off. One earlier failed attempt was:
  *          dda_ticks_X_substeps = (int32_t)((microseconds/1000000) * f_dda * dda_substeps);
  */
 
-stat_t st_prep_line(float travel_steps[], float following_error[], float segment_time)
+/*
+ * _take_up_backlash() - add the backlash a motor still owes to its travel for the segment
+ *
+ *  A reversal moves the motor's backlash target by the backlash towards the new direction;
+ *  the steps still owed are the difference to what has been injected, limited to
+ *  BACKLASH_TAKEUP_VELOCITY over the segment. A reversal part way through a take-up just
+ *  moves the target back.
+ */
+
+static void _take_up_backlash(const uint8_t motor, float travel_steps[], const float segment_time)
+{
+    stPrepMotor_t *pm = &st_pre.mot[motor];
+    if (!fp_ZERO(travel_steps[motor])) {
+        const int8_t direction = (travel_steps[motor] > 0) ? 1 : -1;
+        if (direction != pm->backlash_direction) {
+            if (pm->backlash_direction != 0) {                  // the first move only sets the side
+                pm->backlash_target += direction * st_cfg.mot[motor].backlash_steps;
+            }
+            pm->backlash_direction = direction;
+        }
+    }
+    const float owed = pm->backlash_target - pm->backlash_steps;
+    if (fp_ZERO(owed)) {
+        return;
+    }
+    const float limit = BACKLASH_TAKEUP_VELOCITY * st_cfg.mot[motor].steps_per_unit * segment_time;
+    const float steps = (owed > 0) ? min(owed, limit) : max(owed, -limit);
+    travel_steps[motor] += steps;
+    pm->backlash_steps += steps;
+}
+
+/*
+ * st_get_backlash_steps() - steps a motor is ahead of the runtime for backlash, as of the last segment prepped
+ */
+
+float st_get_backlash_steps(const uint8_t motor) { return (st_pre.mot[motor].backlash_steps); }
+
+HOT_PATH stat_t st_prep_line(float travel_steps[], float following_error[], const float target_steps[], float segment_time,
+                             const float pso_length,
+                             const int16_t raster_intensity)
 {
+    stPrepSegment_t *seg = &st_pre.seg[st_pre.w];
+
     // trap assertion failures and other conditions that would prevent queuing the line
-    if (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_EXEC) {     // never supposed to happen
+    if (seg->buffer_state != PREP_BUFFER_OWNED_BY_EXEC) {       // never supposed to happen
         return (cm_panic(STAT_INTERNAL_ERROR, "st_prep_line() prep sync error"));
     } else if (isinf(segment_time)) {                           // never supposed to happen
         return (cm_panic(STAT_PREP_LINE_MOVE_TIME_IS_INFINITE, "st_prep_line()"));
     } else if (isnan(segment_time)) {                           // never supposed to happen
         return (cm_panic(STAT_PREP_LINE_MOVE_TIME_IS_NAN, "st_prep_line()"));
     }
+    segment_time = sync_segment_time(segment_time);     // a sync follower runs a little slower or faster
+    segment_time = spindle_sync_segment_time(segment_time); // G33 follows the spindle
+
     // setup segment parameters
+    // - dda_divisor sets the DDA rate for the segment from its fastest motor (see DDA_DIVISOR_MAX)
     // - dda_ticks is the integer number of DDA clock ticks needed to play out the segment
     // - ticks_X_substeps is the maximum depth of the DDA accumulator (as a negative number)
 
-    st_pre.dda_ticks = (int32_t)(segment_time * 60 * FREQUENCY_DDA);  // NB: converts minutes to seconds
-    st_pre.dda_ticks_X_substeps = st_pre.dda_ticks * DDA_SUBSTEPS;
+    for (uint8_t motor=0; motor<MOTORS; motor++) {          // see Backlash compensation in stepper.h
+        if ((st_cfg.mot[motor].backlash_steps > 0) && !(st_pre.motor_inhibit & (1 << motor))) {
+            _take_up_backlash(motor, travel_steps, segment_time);
+        }
+    }
+
+    float steps_max = 1;                                    // also keeps DDA_TICKS_PER_STEP_MIN ticks in the segment
+    seg->position_motors = 0;
+    for (uint8_t motor=0; motor<MOTORS; motor++) {
+        if (st_pre.motor_inhibit & (1 << motor)) {
+            continue;
+        }
+        if (Motors[motor]->takesPosition()) {               // position motors don't use the DDA
+            seg->position_motors |= (1 << motor);
+        } else {
+            steps_max = max(steps_max, (float)fabs(travel_steps[motor]));
+        }
+    }
+    seg->position_time = segment_time * 60;
+    const float segment_ticks = segment_time * DDA_TICKS_PER_MINUTE + st_pre.dda_ticks_remainder;
+    const float divisor_max = segment_ticks / (steps_max * DDA_TICKS_PER_STEP_MIN);
+    seg->dda_divisor = DDA_DIVISOR_MAX;
+    while ((seg->dda_divisor > 1) && ((float)seg->dda_divisor > divisor_max)) {
+        seg->dda_divisor >>= 1;
+    }
+    seg->dda_ticks = (uint32_t)(segment_ticks / seg->dda_divisor);
+    st_pre.dda_ticks_remainder = segment_ticks - (float)(seg->dda_ticks * seg->dda_divisor);
+    seg->dda_ticks_X_substeps = seg->dda_ticks * DDA_SUBSTEPS;
+    seg->raster_intensity = raster_intensity;
+    seg->pso_increment = pso_tick_increment(pso_length, seg->dda_ticks);
+    if (seg->pso_increment) {
+        seg->pso_pulse_ticks = pso_pulse_ticks(seg->dda_divisor);
+    }
+    seg->output_set = st_pre.output_set;
+    seg->output_clear = st_pre.output_clear;
+    st_pre.output_set = 0;
+    st_pre.output_clear = 0;
 
     // setup motor parameters
 
     float correction_steps;
     for (uint8_t motor=0; motor<MOTORS; motor++) {          // remind us that this is motors, not axes
+        seg->target_steps[motor] = target_steps[motor] + st_pre.mot[motor].backlash_steps; // for following error, even if idle
 
-        // Skip this motor if there are no new steps. Leave all other values intact.
-        if (fp_ZERO(travel_steps[motor])) {
-            st_pre.mot[motor].substep_increment = 0;        // substep increment also acts as a motor flag
+        // Skip this motor if there are no new steps, it is inhibited or it takes a position instead.
+        // Leave all other values intact.
+        if (fp_ZERO(travel_steps[motor]) || (st_pre.motor_inhibit & (1 << motor)) ||
+            (seg->position_motors & (1 << motor))) {
+            seg->mot[motor].substep_increment = 0;        // substep increment also acts as a motor flag
             continue;
         }
 
@@ -676,23 +1493,24 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
         // Set the step_sign which is used by the stepper ISR to accumulate step position
 
         if (travel_steps[motor] >= 0) {                    // positive direction
-            st_pre.mot[motor].direction = DIRECTION_CW ^ st_cfg.mot[motor].polarity;
-            st_pre.mot[motor].step_sign = 1;
+            seg->mot[motor].direction = DIRECTION_CW ^ st_cfg.mot[motor].polarity;
+            seg->mot[motor].step_sign = 1;
         } else {
-            st_pre.mot[motor].direction = DIRECTION_CCW ^ st_cfg.mot[motor].polarity;
-            st_pre.mot[motor].step_sign = -1;
+            seg->mot[motor].direction = DIRECTION_CCW ^ st_cfg.mot[motor].polarity;
+            seg->mot[motor].step_sign = -1;
         }
 
         // Detect segment time changes and setup the accumulator correction factor and flag.
         // Putting this here computes the correct factor even if the motor was dormant for some number
         // of previous moves. Correction is computed based on the last segment time actually used.
 
-        if (fabs(segment_time - st_pre.mot[motor].prev_segment_time) > 0.0000001) { // highly tuned FP != compare
-            if (fp_NOT_ZERO(st_pre.mot[motor].prev_segment_time)) {                 // special case to skip first move
-                st_pre.mot[motor].accumulator_correction_flag = true;
-                st_pre.mot[motor].accumulator_correction = segment_time / st_pre.mot[motor].prev_segment_time;
+        if (seg->dda_ticks != st_pre.mot[motor].prev_dda_ticks) {
+            if (st_pre.mot[motor].prev_dda_ticks != 0) {                           // special case to skip first move
+                seg->mot[motor].accumulator_correction_flag = true;
+                seg->mot[motor].accumulator_correction =
+                    ((uint32_t)seg->dda_ticks << ACCUMULATOR_CORRECTION_SHIFT) / (uint32_t)st_pre.mot[motor].prev_dda_ticks;
             }
-            st_pre.mot[motor].prev_segment_time = segment_time;
+            st_pre.mot[motor].prev_dda_ticks = seg->dda_ticks;
         }
 
         // 'Nudge' correction strategy. Inject a single, scaled correction value then hold off
@@ -716,23 +1534,96 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
         // Compute substeb increment. The accumulator must be *exactly* the incoming
         // fractional steps times the substep multiplier or positional drift will occur.
         // Rounding is performed to eliminate a negative bias in the uint32 conversion
-        // that results in long-term negative drift. (fabs/round order doesn't matter)
-
-        st_pre.mot[motor].substep_increment = round(fabs(travel_steps[motor] * DDA_SUBSTEPS));
+        // that results in long-term negative drift. Whole steps are multiplied out in
+        // integer so only the fractional step goes through a float multiply.
+
+        const float steps = fabs(travel_steps[motor]);
+        const uint32_t whole_steps = (uint32_t)steps;
+        seg->mot[motor].substep_increment = (whole_steps * DDA_SUBSTEPS) +
+                                              (uint32_t)(((steps - whole_steps) * (float)DDA_SUBSTEPS) + 0.5f);
+
+        // Odometer: the whole steps go to the loader with the segment, the fraction is carried.
+        // The peak rate only takes a divide when it goes up.
+
+        const float counted = steps + st_pre.mot[motor].odometer_carry;
+        seg->mot[motor].odometer_steps = (uint32_t)counted;
+        st_pre.mot[motor].odometer_carry = counted - seg->mot[motor].odometer_steps;
+        if (steps > st_odo.mot[motor].peak_rate * seg->position_time) {
+            st_odo.mot[motor].peak_rate = steps / seg->position_time;
+        }
     }
-    st_pre.block_type = BLOCK_TYPE_ALINE;
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER;    // signal that prep buffer is ready
+#ifdef STEP_SCHEDULE
+    ritorno(_build_schedule(seg));                          // run the DDA for the whole segment
+#endif
+    seg->block_type = BLOCK_TYPE_ALINE;                 // exec ISR commits the slot to the loader
     return (STAT_OK);
 }
 
 /*
  * st_prep_null() - Keeps the loader happy. Otherwise performs no action
+ *
+ *  Only touches the slot exec is writing - slots already committed to the loader are left alone.
  */
 
 void st_prep_null()
 {
-    st_pre.block_type = BLOCK_TYPE_NULL;
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC;    // signal that prep buffer is empty
+    stPrepSegment_t *seg = &st_pre.seg[st_pre.w];
+    if (seg->buffer_state == PREP_BUFFER_OWNED_BY_EXEC) {
+        seg->block_type = BLOCK_TYPE_NULL;
+    }
+}
+
+/*
+ * st_get_step_phase() - steps a motor has run past its last whole step, ticks_ago DDA ticks back
+ *
+ *  Reads the running segment's DDA accumulator, which climbs from -dda_ticks_X_substeps to 0
+ *  between steps, so its depth is the motor's position between two steps. Stepping back by
+ *  ticks_ago (at FREQUENCY_DDA) takes out the latency between an input edge and the ISR that
+ *  reads this.
+ *  The result is unsigned (apply the step sign) and is 0 for a motor that is not moving.
+ *  Called from input ISRs via en_take_encoder_snapshot().
+ */
+
+float st_get_step_phase(const uint8_t motor, const float ticks_ago)
+{
+    const uint32_t increment = st_run.mot[motor].substep_increment;
+    if ((increment == 0) || (st_run.dda_ticks_X_substeps == 0)) {
+        return (0);
+    }
+    const float depth = (float)st_run.dda_ticks_X_substeps;
+    const float run_ticks_ago = ticks_ago / st_run.dda_divisor;   // the segment may run the DDA slower
+    return (((float)st_run.mot[motor].substep_accumulator + depth - ((float)increment * run_ticks_ago)) / depth);
+}
+
+/*
+ * st_inhibit_motors()       - stop stepping the motors in the mask for the rest of the move
+ * st_clear_motor_inhibits() - let all motors step again
+ *
+ *  Used by homing to stop each axis (or each side of a squared gantry) at its own switch
+ *  while the rest of the move runs on. Inhibit may be called from an input ISR: it zeroes
+ *  the running segment and every prepared slot, and st_prep_line() drops the motors from
+ *  segments it has yet to prepare. Planner and runtime positions keep advancing, so the
+ *  caller must resync steps (mp_set_steps_to_runtime_position()) once motion has stopped.
+ *  With STEP_SCHEDULE the slots already scheduled are not rebuilt, so an inhibit can be
+ *  up to PREP_RING_SIZE segments late.
+ */
+
+void st_inhibit_motors(const uint16_t motor_mask)
+{
+    st_pre.motor_inhibit |= motor_mask;
+    for (uint8_t motor=0; motor<MOTORS; motor++) {
+        if (motor_mask & (1 << motor)) {
+            st_run.mot[motor].substep_increment = 0;
+            for (uint8_t i=0; i<PREP_RING_SIZE; i++) {
+                st_pre.seg[i].mot[motor].substep_increment = 0;
+            }
+        }
+    }
+}
+
+void st_clear_motor_inhibits()
+{
+    st_pre.motor_inhibit = 0;
 }
 
 /*
@@ -741,21 +1632,26 @@ void st_prep_null()
 
 void st_prep_command(void *bf)
 {
-    st_pre.block_type = BLOCK_TYPE_COMMAND;
-    st_pre.bf = (mpBuf_t *)bf;
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER;    // signal that prep buffer is ready
+    stPrepSegment_t *seg = &st_pre.seg[st_pre.w];
+    seg->block_type = BLOCK_TYPE_COMMAND;
+    seg->bf = (mpBuf_t *)bf;
 }
 
 /*
  * st_prep_dwell()      - Add a dwell to the move buffer
+ *
+ *  Dwells are timed by dwell_systick_event, not the DDA, which is stopped for the dwell.
+ *  The time is rounded up to whole SysTicks, and _load_move() adds one for the partial
+ *  tick the dwell starts in, so a dwell is never short - it ends within a tick after the
+ *  time asked for.
  */
 
 void st_prep_dwell(float microseconds)
 {
-    st_pre.block_type = BLOCK_TYPE_DWELL;
+    stPrepSegment_t *seg = &st_pre.seg[st_pre.w];
+    seg->block_type = BLOCK_TYPE_DWELL;
     // we need dwell_ticks to be at least 1
-    st_pre.dwell_ticks = std::max((uint32_t)((microseconds/1000000) * FREQUENCY_DWELL), 1UL);
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER;    // signal that prep buffer is ready
+    seg->dwell_ticks = std::max((uint32_t)ceil((microseconds / 1000000) * FREQUENCY_DWELL - 0.001), (uint32_t)1);
 }
 
 /*
@@ -768,11 +1664,23 @@ void st_prep_dwell(float microseconds)
 
 void st_prep_out_of_band_dwell(float microseconds)
 {
-    if (!st_runtime_isbusy()) {
+    if (!st_runtime_isbusy() && _prep_slot_is_free()) {
         st_prep_dwell(microseconds);
-        st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER;    // signal that prep buffer is ready
+        _prep_commit();                                     // signal that prep slot is ready
         st_request_load_move();
-    }    
+    }
+}
+
+/*
+ * st_prep_outputs() - switch outputs as the next segment prepped starts (M62, M63)
+ *
+ *  Call before st_prep_line() for the segment. Bit 0 is output 1.
+ */
+
+void st_prep_outputs(const uint16_t set, const uint16_t clear)
+{
+    st_pre.output_set |= set;
+    st_pre.output_clear |= clear;
 }
 
 /*
@@ -813,6 +1721,7 @@ static float _set_motor_steps_per_unit(nvObj_t *nv)
                                    (360 * st_cfg.mot[m].microsteps);
 
     st_cfg.mot[m].steps_per_unit = 1/st_cfg.mot[m].units_per_step;
+    kn_config_changed();
     return (st_cfg.mot[m].steps_per_unit);
 }
 
@@ -873,6 +1782,7 @@ stat_t st_set_ma(nvObj_t *nv)
     uint8_t remap_axis[9] = { 0,1,2,6,7,8,3,4,5 };
     nv->value_int = remap_axis[nv->value_int];
     ritorno(set_integer(nv, st_cfg.mot[_motor(nv->index)].motor_map, 0, AXES)); 
+    kn_config_changed();
     nv->value_int = external_axis;
     return(STAT_OK);
 }
@@ -944,6 +1854,7 @@ stat_t st_set_su(nvObj_t *nv)
     // You could scale any one of the other values, but TR makes the most sense
     st_cfg.mot[m].travel_rev = (360.0 * st_cfg.mot[m].microsteps) / 
                                (st_cfg.mot[m].steps_per_unit * st_cfg.mot[m].step_angle);
+    kn_config_changed();
     return(STAT_OK);
 }
 
@@ -965,6 +1876,7 @@ stat_t st_set_pm(nvObj_t *nv)
     // to both set and take effect immediately.
     ritorno(set_integer(nv, (uint8_t &)cs.null, 0, MOTOR_POWER_MODE_MAX_VALUE ));
     Motors[_motor(nv->index)]->setPowerMode((stPowerMode)nv->value_int);
+    _start_idle_power_timeouts();
     return (STAT_OK);
 }
 
@@ -987,6 +1899,63 @@ stat_t st_set_pl(nvObj_t *nv)
     return(STAT_OK);
 }
 
+/*
+ * st_get_ec() - get encoder counts per step
+ * st_set_ec() - set encoder counts per step
+ *
+ *  0 counts steps for the motor's encoder. A positive value reads the hardware quadrature
+ *  encoder assigned to the motor in hardware.h (see encoder.h) and scales its counts to steps.
+ */
+stat_t st_get_ec(nvObj_t *nv) { return(get_float(nv, en.en[_motor(nv->index)].counts_per_step)); }
+stat_t st_set_ec(nvObj_t *nv)
+{
+    stat_t status = en_set_counts_per_step(_motor(nv->index), nv->value_flt);
+    if (status == STAT_INPUT_VALUE_RANGE_ERROR) {
+        nv_add_conditional_message((const char *)"*** WARNING *** Motor has no hardware encoder input");
+    }
+    return (status);
+}
+
+/*
+ * st_get_sm() - get stall sensing mode
+ * st_set_sm() - set stall sensing mode
+ * st_get_sg() - get stall sensing threshold
+ * st_set_sg() - set stall sensing threshold
+ *
+ *  Stall sensing needs a driver that supports it (e.g. Trinamic2130 StallGuard2). A lower
+ *  threshold is more sensitive. See st_motor_stalled().
+ */
+stat_t st_get_sm(nvObj_t *nv) { return(get_integer(nv, st_cfg.mot[_motor(nv->index)].stall_mode)); }
+stat_t st_set_sm(nvObj_t *nv)
+{
+    uint8_t m = _motor(nv->index);
+    ritorno(set_integer(nv, st_cfg.mot[m].stall_mode, STALL_MODE_OFF, STALL_MODE_MAX));
+    if ((st_cfg.mot[m].stall_mode != STALL_MODE_OFF) && !Motors[m]->canSenseStall()) {
+        nv_add_conditional_message((const char *)"*** WARNING *** Motor driver can't sense stalls");
+    }
+    Motors[m]->setStallDetect(st_cfg.mot[m].stall_mode == STALL_MODE_HOMING_AND_RUN);
+    return (STAT_OK);
+}
+
+stat_t st_get_sg(nvObj_t *nv) { return(get_float(nv, st_cfg.mot[_motor(nv->index)].stall_threshold)); }
+stat_t st_set_sg(nvObj_t *nv)
+{
+    uint8_t m = _motor(nv->index);
+    ritorno(set_float_range(nv, st_cfg.mot[m].stall_threshold, -64, 63));
+    Motors[m]->setStallThreshold(st_cfg.mot[m].stall_threshold);
+    return (STAT_OK);
+}
+
+/*
+ * st_get_sq() - get gantry squaring offset
+ * st_set_sq() - set gantry squaring offset
+ *
+ *  Only used on an axis with a second homing input {xhs:}. After the latch the motor is
+ *  stepped this far on its own, with the other motors of the axis held, then locked back.
+ */
+stat_t st_get_sq(nvObj_t *nv) { return(get_float(nv, st_cfg.mot[_motor(nv->index)].squaring_offset)); }
+stat_t st_set_sq(nvObj_t *nv) { return(set_float_range(nv, st_cfg.mot[_motor(nv->index)].squaring_offset, -1000, 1000)); }
+
 /*
  * st_get_pwr()	- get current motor power
  *
@@ -1006,6 +1975,86 @@ stat_t st_get_pwr(nvObj_t *nv)
 	return (STAT_OK);
 }
 
+/*
+ * st_get_ost(), st_set_ost() - motor odometer steps
+ * st_get_orv(), st_set_orv() - motor odometer direction reversals
+ * st_get_oen(), st_set_oen() - motor odometer hours energized
+ * st_get_opw(), st_set_opw() - motor odometer hours at full power
+ * st_get_opk(), st_set_opk() - motor odometer peak step rate
+ *
+ *  The setters load the persisted values at boot, and clear a counter when a motor is
+ *  replaced. The steps and reversals are also written by the loader interrupt, so those
+ *  are read and written with interrupts off.
+ */
+
+#define MS_PER_HOUR 3600000.0
+
+static stat_t _get_odometer(nvObj_t *nv, const float value)
+{
+    nv->value_flt = value;
+    nv->valuetype = TYPE_FLOAT;
+    nv->precision = cfgArray[nv->index].precision;
+    return (STAT_OK);
+}
+
+static stat_t _set_odometer(nvObj_t *nv)
+{
+    if (nv->value_flt < 0) {
+        nv->valuetype = TYPE_NULL;
+        return (STAT_INPUT_LESS_THAN_MIN_VALUE);
+    }
+    return (STAT_OK);
+}
+
+stat_t st_get_ost(nvObj_t *nv)
+{
+    __disable_irq();
+    const uint64_t steps = st_odo.mot[_motor(nv->index)].steps;
+    __enable_irq();
+    return (_get_odometer(nv, (float)steps));
+}
+
+stat_t st_set_ost(nvObj_t *nv)
+{
+    ritorno(_set_odometer(nv));
+    __disable_irq();
+    st_odo.mot[_motor(nv->index)].steps = (uint64_t)nv->value_flt;
+    __enable_irq();
+    return (STAT_OK);
+}
+
+stat_t st_get_orv(nvObj_t *nv) { return (_get_odometer(nv, (float)st_odo.mot[_motor(nv->index)].reversals)); }
+stat_t st_set_orv(nvObj_t *nv)
+{
+    ritorno(_set_odometer(nv));
+    st_odo.mot[_motor(nv->index)].reversals = (uint32_t)nv->value_flt;
+    return (STAT_OK);
+}
+
+stat_t st_get_oen(nvObj_t *nv) { return (_get_odometer(nv, st_odo.mot[_motor(nv->index)].energized_ms / MS_PER_HOUR)); }
+stat_t st_set_oen(nvObj_t *nv)
+{
+    ritorno(_set_odometer(nv));
+    st_odo.mot[_motor(nv->index)].energized_ms = (uint64_t)(nv->value_flt * MS_PER_HOUR);
+    return (STAT_OK);
+}
+
+stat_t st_get_opw(nvObj_t *nv) { return (_get_odometer(nv, st_odo.mot[_motor(nv->index)].full_power_ms / MS_PER_HOUR)); }
+stat_t st_set_opw(nvObj_t *nv)
+{
+    ritorno(_set_odometer(nv));
+    st_odo.mot[_motor(nv->index)].full_power_ms = (uint64_t)(nv->value_flt * MS_PER_HOUR);
+    return (STAT_OK);
+}
+
+stat_t st_get_opk(nvObj_t *nv) { return (_get_odometer(nv, st_odo.mot[_motor(nv->index)].peak_rate)); }
+stat_t st_set_opk(nvObj_t *nv)
+{
+    ritorno(_set_odometer(nv));
+    st_odo.mot[_motor(nv->index)].peak_rate = nv->value_flt;
+    return (STAT_OK);
+}
+
 stat_t st_set_ep(nvObj_t *nv)            // set motor enable polarity
 {
     if (nv->value_int < IO_ACTIVE_LOW) { return (STAT_INPUT_LESS_THAN_MIN_VALUE); }
@@ -1040,6 +2089,7 @@ stat_t st_set_sp(nvObj_t *nv)            // set motor step polarity
     if (motor > MOTORS) { return STAT_INPUT_VALUE_RANGE_ERROR; };
 
     Motors[motor]->setStepPolarity((ioMode)nv->value_int);
+    _update_step_ports();
     return (STAT_OK);
 }
 
@@ -1075,6 +2125,19 @@ stat_t st_set_mt(nvObj_t *nv) { return(set_float_range(nv, st_cfg.motor_power_ti
                                                            MOTOR_TIMEOUT_SECONDS_MIN,
                                                            MOTOR_TIMEOUT_SECONDS_MAX)); }
 
+stat_t st_get_mcp(nvObj_t *nv) { return(get_float(nv, st_cfg.cruise_power)); }
+stat_t st_set_mcp(nvObj_t *nv) { return(set_float_range(nv, st_cfg.cruise_power, 0.0, 1.0)); }
+
+stat_t st_get_mhp(nvObj_t *nv) { return(get_float(nv, st_cfg.hold_power)); }
+stat_t st_set_mhp(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, st_cfg.hold_power, 0.0, 1.0));
+    for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
+        Motors[motor]->setPowerScale(power_scale_applied, st_cfg.hold_power);
+    }
+    return(STAT_OK);
+}
+
 // Make sure this function is not part of initialization --> f00
 // nv->value is seconds of timeout
 stat_t st_set_me(nvObj_t *nv)
@@ -1082,6 +2145,7 @@ stat_t st_set_me(nvObj_t *nv)
     for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
         Motors[motor]->enable(nv->value_int);   // nv->value is the timeout or 0 for default
     }
+    _start_idle_power_timeouts();
     return (STAT_OK);
 }
 
@@ -1131,6 +2195,8 @@ static const char *const msg_units[] = { msg_units0, msg_units1, msg_units2 };
 static const char fmt_me[] = "motors energized\n";
 static const char fmt_md[] = "motors de-energized\n";
 static const char fmt_mt[] = "[mt]  motor idle timeout%14.2f seconds\n";
+static const char fmt_mcp[] = "[mcp] motor cruise power%14.3f [fraction of power level]\n";
+static const char fmt_mhp[] = "[mhp] motor hold power%16.3f [fraction of power level]\n";
 static const char fmt_0ma[] = "[%s%s] m%s map to axis%15d [0=X,1=Y,2=Z...]\n";
 static const char fmt_0sa[] = "[%s%s] m%s step angle%20.3f%s\n";
 static const char fmt_0tr[] = "[%s%s] m%s travel per revolution%10.4f%s\n";
@@ -1141,11 +2207,22 @@ static const char fmt_0ep[] = "[%s%s] m%s enable polarity%11d [0=active HIGH,1=a
 static const char fmt_0sp[] = "[%s%s] m%s step polarity%13d [0=active HIGH,1=active LOW]\n";
 static const char fmt_0pm[] = "[%s%s] m%s power management%10d [0=disabled,1=always on,2=in cycle,3=when moving]\n";
 static const char fmt_0pl[] = "[%s%s] m%s motor power level%13.3f [0.000=minimum, 1.000=maximum]\n";
+static const char fmt_0ec[] = "[%s%s] m%s encoder counts per step%7.3f [0=count steps]\n";
+static const char fmt_0sm[] = "[%s%s] m%s stall mode%19d [0=off,1=homing,2=homing and run]\n";
+static const char fmt_0sg[] = "[%s%s] m%s stall threshold%14.0f [-64=most sensitive, 63=least]\n";
+static const char fmt_0sq[] = "[%s%s] m%s squaring offset%15.3f%s\n";
 static const char fmt_pwr[] = "[%s%s] Motor %c power level:%12.3f\n";
+static const char fmt_0ost[] = "[%s%s] m%s odometer steps%15.0f\n";
+static const char fmt_0orv[] = "[%s%s] m%s odometer reversals%11.0f\n";
+static const char fmt_0oen[] = "[%s%s] m%s odometer energized%11.2f hours\n";
+static const char fmt_0opw[] = "[%s%s] m%s odometer at full power%7.2f hours\n";
+static const char fmt_0opk[] = "[%s%s] m%s odometer peak rate%11.0f steps/s\n";
 
 void st_print_me(nvObj_t *nv) { text_print(nv, fmt_me);}    // TYPE_NULL - message only
 void st_print_md(nvObj_t *nv) { text_print(nv, fmt_md);}    // TYPE_NULL - message only
 void st_print_mt(nvObj_t *nv) { text_print(nv, fmt_mt);}    // TYPE_FLOAT
+void st_print_mcp(nvObj_t *nv) { text_print(nv, fmt_mcp);}  // TYPE_FLOAT
+void st_print_mhp(nvObj_t *nv) { text_print(nv, fmt_mhp);}  // TYPE_FLOAT
 
 static void _print_motor_int(nvObj_t *nv, const char *format)
 {
@@ -1181,6 +2258,15 @@ void st_print_ep(nvObj_t *nv) { _print_motor_int(nv, fmt_0ep);}
 void st_print_sp(nvObj_t *nv) { _print_motor_int(nv, fmt_0sp);}
 void st_print_pm(nvObj_t *nv) { _print_motor_int(nv, fmt_0pm);}
 void st_print_pl(nvObj_t *nv) { _print_motor_flt(nv, fmt_0pl);}
+void st_print_ec(nvObj_t *nv) { _print_motor_flt(nv, fmt_0ec);}
+void st_print_sm(nvObj_t *nv) { _print_motor_int(nv, fmt_0sm);}
+void st_print_sg(nvObj_t *nv) { _print_motor_flt(nv, fmt_0sg);}
+void st_print_sq(nvObj_t *nv) { _print_motor_flt_units(nv, fmt_0sq, cm_get_units_mode(MODEL));}
 void st_print_pwr(nvObj_t *nv){ _print_motor_pwr(nv, fmt_pwr);}
+void st_print_ost(nvObj_t *nv) { _print_motor_flt(nv, fmt_0ost);}
+void st_print_orv(nvObj_t *nv) { _print_motor_flt(nv, fmt_0orv);}
+void st_print_oen(nvObj_t *nv) { _print_motor_flt(nv, fmt_0oen);}
+void st_print_opw(nvObj_t *nv) { _print_motor_flt(nv, fmt_0opw);}
+void st_print_opk(nvObj_t *nv) { _print_motor_flt(nv, fmt_0opk);}
 
 #endif // __TEXT_MODE
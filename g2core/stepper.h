@@ -160,7 +160,7 @@
  *    the "segment", usually ~1ms worth of pulses
  *
  *  - When the current segment is finished the stepper interrupt LOADs the next segment
- *    from the prep buffer, reloads the timers, and starts the next segment. At the end
+ *    from the prep ring, reloads the timers, and starts the next segment. At the end
  *    of the load the stepper interrupt routine requests an "exec" of the next move in
  *    order to prepare for the next load operation. It does this by calling the exec
  *    using a software interrupt (actually a timer, since that's all we've got).
@@ -177,7 +177,9 @@
  *
  *  - Once the segment has been computed the exec handler finishes up by running the
  *    PREP routine in stepper.cpp. This computes the DDA values and gets the segment
- *    into the prep buffer - and ready for the next LOAD operation.
+ *    into the prep ring - and ready for a later LOAD operation. Exec keeps preparing
+ *    line segments until the ring is full (PREP_RING_SIZE), so a slow exec no longer
+ *    has to finish inside the segment that is currently playing.
  *
  *  - The main loop runs in background to receive gcode blocks, parse them, and send
  *    them to the planner in order to keep the planner queue full so that when the
@@ -271,8 +273,7 @@ typedef enum {                          // used w/start and stop flags to sequen
     MOTOR_OFF = 0,                      // motor is stopped and deenergized
     MOTOR_IDLE,                         // motor is stopped and may be partially energized for torque maintenance
     MOTOR_RUNNING,                      // motor is running (and fully energized)
-    MOTOR_POWER_TIMEOUT_START,          // transitional state to start power-down timeout
-    MOTOR_POWER_TIMEOUT_COUNTDOWN       // count down the time to de-energizing motor
+    MOTOR_POWER_TIMEOUT_COUNTDOWN       // stopped - de-energizes when the power event fires (see st_schedule_motor_power())
 } stPowerState;
 
 typedef enum {
@@ -287,6 +288,7 @@ typedef enum {
 #define Vcc         3.3                 // volts
 #define MaxVref    2.25                 // max vref for driver circuit. Our ckt is 2.25 volts
 #define POWER_LEVEL_SCALE_FACTOR ((MaxVref/Vcc)) // scale power level setting for voltage range
+#define MOTOR_POWER_RESTORE_LEAD (float)(0.020/60) // minutes before the end of a body to restore full current
 
 // Min/Max timeouts allowed for motor disable. Allow for inertial stop; must be non-zero
 #define MOTOR_TIMEOUT_SECONDS_MIN   (float)0.1      // seconds !!! SHOULD NEVER BE ZERO !!!
@@ -295,6 +297,28 @@ typedef enum {
 // Step generation constants
 #define STEP_INITIAL_DIRECTION        DIRECTION_CW
 
+/* Direction timing
+ *
+ *  External drivers need the direction line stable for a hold time after the last step
+ *  and a setup time before the next one. Each driver declares these (see getDirectionSetupNs()
+ *  and getDirectionHoldNs()), and the board can set the defaults for its StepDirSteppers in
+ *  hardware.h or board_stepper.h. stepper_init() turns them into DDA ticks at FREQUENCY_DDA.
+ *  A slower DDA rate only lengthens the ticks, so the timing still holds.
+ *
+ *  When a motor reverses, the loader holds the new direction back for the hold ticks. The
+ *  DDA writes it afterwards. The motor's substep accumulator is biased so its first step
+ *  comes at least the hold plus setup ticks into the segment. A reversing motor is near
+ *  zero speed, so the bias costs a fraction of a step period. Any phase it loses shows up
+ *  as following error and is taken out by step correction. FREQUENCY_DDA no longer has to
+ *  come down to suit a slow driver.
+ */
+#ifndef DIRECTION_SETUP_NS
+#define DIRECTION_SETUP_NS      0       // ns the direction must be stable before a step
+#endif
+#ifndef DIRECTION_HOLD_NS
+#define DIRECTION_HOLD_NS       0       // ns the direction must be held after a step
+#endif
+
 /* DDA substepping
  *
  *  DDA Substepping is a fixed.point scheme to increase the resolution of the DDA pulse generation
@@ -308,29 +332,114 @@ typedef enum {
  *
  *    MAX_LONG == 2^31, maximum signed long (depth of accumulator. NB: accumulator values are negative)
  *    FREQUENCY_DDA == DDA clock rate in Hz.
- *    NOM_SEGMENT_TIME == upper bound of segment time in minutes
+ *    NOM_SEGMENT_TIME_MAX == upper bound of segment time in minutes ({seg:} can only shorten it)
  *    0.90 == a safety factor used to reduce the result from theoretical maximum
  *
  *  The number is about 8.5 million for the Xmega running a 50 KHz DDA with 5 millisecond segments
  *  The ARM is roughly the same as the DDA clock rate is 4x higher but the segment time is ~1/5
  *  Decreasing the nominal segment time increases the number precision.
  */
-#define DDA_SUBSTEPS ((MAX_LONG * 0.90) / (FREQUENCY_DDA * (NOM_SEGMENT_TIME * 60)))
+#define DDA_SUBSTEPS ((int32_t)((MAX_LONG * 0.90) / (FREQUENCY_DDA * (NOM_SEGMENT_TIME_MAX * 60))))
+
+/*
+ *  Segment prep is done in integer / fixed point wherever the inputs allow it. The stepper
+ *  ISRs run at HI and MED priority on parts without an FPU:
+ *
+ *    - DDA_SUBSTEPS is an integer, so dda_ticks_X_substeps is an exact integer product.
+ *    - substep_increment is built from the integer and fractional step counts separately. The
+ *      fractional part (< 1 step) times DDA_SUBSTEPS fits a float mantissa to within 1 substep.
+ *    - Accumulator phase correction is keyed on dda_ticks rather than float segment time, and the
+ *      ratio is a Q16 factor (ACCUMULATOR_CORRECTION_SHIFT). The loader then needs only a 32x32
+ *      multiply and a shift instead of an int->float->int round trip. (dda_ticks << 16) must fit
+ *      in 32 bits, which allows segments up to 65535 DDA ticks (over 100 ms at 400 KHz).
+ */
+#define ACCUMULATOR_CORRECTION_SHIFT 16     // Q16 fixed point accumulator correction factor
+#define DDA_TICKS_PER_MINUTE ((float)(60 * FREQUENCY_DDA))  // converts segment time in minutes to DDA ticks
+
+/* Adaptive DDA rate
+ *
+ *  A segment doesn't need the DDA at FREQUENCY_DDA unless its motors step fast. Each segment
+ *  runs the DDA at FREQUENCY_DDA / dda_divisor, where st_prep_line() picks the largest power of
+ *  2 up to DDA_DIVISOR_MAX that still leaves DDA_TICKS_PER_STEP_MIN ticks between the steps of
+ *  the segment's fastest motor (and at least that many ticks in the segment). A step lands on
+ *  a DDA tick, so its timing error stays under 1/DDA_TICKS_PER_STEP_MIN of the step period, and
+ *  slow moves take a fraction of the interrupts. The loader reprograms the timer when the
+ *  divisor changes. Step pulses last one DDA tick, so they get longer at the lower rates.
+ *
+ *  The part of a segment's time that doesn't fill a whole tick is carried into the next
+ *  segment (st_pre.dda_ticks_remainder), so the coarser ticks don't change the move's time.
+ *  Set DDA_DIVISOR_MAX to 1 to always run the DDA at FREQUENCY_DDA.
+ */
+#ifndef DDA_DIVISOR_MAX                     // boards can override these values in hardware.h
+#define DDA_DIVISOR_MAX 16                  // lowest DDA rate is FREQUENCY_DDA / DDA_DIVISOR_MAX - power of 2
+#endif
+#ifndef DDA_TICKS_PER_STEP_MIN
+#define DDA_TICKS_PER_STEP_MIN 8            // fewest DDA ticks per step of the fastest motor
+#endif
+static_assert((DDA_DIVISOR_MAX >= 1) && ((DDA_DIVISOR_MAX & (DDA_DIVISOR_MAX - 1)) == 0), "DDA_DIVISOR_MAX must be a power of 2");
 
 /* Step correction settings
  *
  *  Step correction settings determine how the encoder error is fed back to correct position errors.
- *  Since the following_error is running 2 segments behind the current segment you have to be careful
- *  not to overcompensate. The threshold determines if a correction should be applied, and the factor
- *  is how much. The holdoff is how many segments to wait before applying another correction. If threshold
- *  is too small and/or amount too large and/or holdoff is too small you may get a runaway correction
- *  and error will grow instead of shrink (or oscillate).
+ *  The following_error is latched when a segment finishes, so it runs up to PREP_RING_SIZE segments
+ *  behind the segment being prepped and you have to be careful not to overcompensate. The threshold
+ *  determines if a correction should be applied, and the factor is how much. The holdoff is how many
+ *  segments to wait before applying another correction, and must be longer than the prep ring so a
+ *  correction is seen by the encoder before the next one is applied. If threshold is too small and/or
+ *  amount too large and/or holdoff is too small you may get a runaway correction and error will grow
+ *  instead of shrink (or oscillate).
  */
 #define STEP_CORRECTION_THRESHOLD   (float)2.00     // magnitude of forwarding error to apply correction (in steps)
 #define STEP_CORRECTION_FACTOR      (float)0.25     // factor to apply to step correction for a single segment
 #define STEP_CORRECTION_MAX         (float)0.60     // max step correction allowed in a single segment
 #define STEP_CORRECTION_HOLDOFF            5        // minimum number of segments to wait between error correction
 
+/* Backlash compensation
+ *
+ *  An axis with backlash ({xbl:}) loses that much travel each time it reverses. st_prep_line()
+ *  makes it up in the steps: when a motor on the axis reverses, the backlash is added to its
+ *  steps over the following segments, no faster than BACKLASH_TAKEUP_VELOCITY on top of the move,
+ *  so the velocity bump stays bounded and no extra planner blocks are needed. The planner,
+ *  runtime and reported positions never see it - the steps sent to the encoders carry it, and
+ *  the following error (and so the step correction) is taken against targets that include it.
+ *
+ *  The first move after power-up sets the side the slack is taken up on without compensating.
+ *  Homing leaves the slack on the side of its last (backoff) move.
+ */
+#define BACKLASH_TAKEUP_VELOCITY    (float)500      // mm/min (or deg/min) added to a move while taking up backlash
+#define BACKLASH_MAX                (float)5        // largest {xbl:} accepted, in mm (or deg)
+
+/* Position motors
+ *
+ *  A driver that sets its position directly - a hobby servo's pulse width, for one - returns
+ *  true from takesPosition(). st_prep_line() leaves it out of the DDA, so it costs no step
+ *  interrupts and does not slow the DDA rate for the other motors. The loader passes it the
+ *  target of each segment, in steps, as the segment starts (setTargetPosition()), and counts
+ *  the previous target as reached for the following error. Backlash is carried in the target.
+ */
+
+/* Motor odometers
+ *
+ *  Each motor keeps lifetime wear counters for maintenance scheduling:
+ *
+ *    {1ost:}  steps taken                  {1orv:}  direction reversals
+ *    {1oen:}  hours energized              {1opw:}  hours at full power - energized hours x power level
+ *    {1opk:}  peak step rate, steps per second
+ *
+ *  Nothing is counted per step. st_prep_line() works out the whole steps in each segment
+ *  (carrying the fraction to the next) and keeps the peak rate; the loader adds the segment's
+ *  steps and any reversal as the segment starts. st_odometer_callback() adds up the hours from
+ *  each motor's present power level.
+ *
+ *  The counters are persisted every ODOMETER_PERSIST_MS, once the machine is out of a cycle.
+ *  They aren't settings, so a defaults load or a new firmware build keeps them (see
+ *  config_init()). Set one to zero when its motor is replaced. JSON and the store carry them
+ *  as floats, which are good to 7 digits - plenty for wear data.
+ */
+#ifndef ODOMETER_PERSIST_MS
+#define ODOMETER_PERSIST_MS 600000          // 10 minutes between writes of the odometers
+#endif
+
 /*
  * Stepper control structures
  *
@@ -350,6 +459,13 @@ typedef enum {
 
 // Motor config structure
 
+typedef enum {                              // stall sensing modes for {1sm:}
+    STALL_MODE_OFF = 0,                     // stall sensing not used
+    STALL_MODE_HOMING,                      // sensorless homing on axes with no homing input
+    STALL_MODE_HOMING_AND_RUN               // also feedhold on a stall during normal motion
+} stStallMode;
+#define STALL_MODE_MAX STALL_MODE_HOMING_AND_RUN
+
 typedef struct cfgMotor {                   // per-motor configs
     // public
     uint8_t motor_map;                      // map motor to axis
@@ -360,6 +476,12 @@ typedef struct cfgMotor {                   // per-motor configs
     float travel_rev;                       // mm or deg of travel per motor revolution
     float steps_per_unit;                   // microsteps per mm (or degree) of travel
     float units_per_step;                   // mm or degrees of travel per microstep
+    float backlash_steps;                   // axis backlash in steps, 0 for none - set by kn_config_changed()
+
+    uint8_t stall_mode;                     // see stStallMode - needs a driver that senses stalls
+    float stall_threshold;                  // driver stall sensitivity (Trinamic SGT, -64 to 63)
+
+    float squaring_offset;                  // mm or deg stepped alone after a gantry homing latch (see cycle_homing.cpp)
 
     // private
     float power_level_scaled;               // scaled to internal range - must be between 0 and 1
@@ -367,6 +489,8 @@ typedef struct cfgMotor {                   // per-motor configs
 
 typedef struct stConfig {                   // stepper configs
     float motor_power_timeout;              // seconds before setting motors to idle current (currently this is OFF)
+    float cruise_power;                     // run current in the body of a move as a fraction of the power level
+    float hold_power;                       // standstill current as a fraction of the power level
     cfgMotor_t mot[MOTORS];                 // settings for motors 1-N
 } stConfig_t;
 
@@ -376,6 +500,8 @@ typedef struct stRunMotor {                 // one per controlled motor
     uint32_t substep_increment;             // total steps in axis times substeps factor
     int32_t substep_accumulator;            // DDA phase angle accumulator
     bool motor_flag;                        // true if motor is participating in this move
+    uint16_t dir_hold_ticks;                // DDA ticks to hold the old direction after a reversal
+    uint16_t dir_lead_ticks;                // DDA ticks before the first step after a reversal (hold + setup)
     uint32_t power_systick;                 // sys_tick for next motor power state transition
     float power_level_dynamic;              // power level for this segment of idle
 } stRunMotor_t;
@@ -385,54 +511,124 @@ typedef struct stRunSingleton {             // Stepper static values and axis pa
     uint32_t dda_ticks_downcount;           // dda tick down-counter (unscaled)
     uint32_t dwell_ticks_downcount;         // dwell tick down-counter (unscaled)
     uint32_t dda_ticks_X_substeps;          // ticks multiplied by scaling factor
+    uint32_t dda_divisor;                   // DDA timer is running at FREQUENCY_DDA / dda_divisor
+    uint16_t dir_hold_downcount;            // DDA ticks until the held directions are written
+    uint32_t dir_held;                      // motors whose direction change is being held back
+    bool raster_active;                     // the spindle PWM is being driven by scanline pixels
+    volatile bool steps_halted;             // step output was stopped by st_halt_steps() - cleared by stepper_reset()
     stRunMotor_t mot[MOTORS];               // runtime motor structures
     magic_t magic_end;
 } stRunSingleton_t;
 
-// Motor prep structure. Used by exec/prep ISR (MED) and read-only during load
-// Must be careful about volatiles in this one
+/*
+ *  Prepared segments are held in a single-producer / single-consumer ring. Exec (MED) fills
+ *  seg[w] and commits it; the loader (HI) runs seg[r] and hands it back. Exec can therefore
+ *  run up to PREP_RING_SIZE segments ahead of the steppers in bursts, which absorbs main loop
+ *  and exec jitter that would otherwise stall motion. Each slot's buffer_state is the only
+ *  handshake, so no locking is needed. A deeper ring also delays feedholds and overrides by
+ *  up to PREP_RING_SIZE-1 segments, as they take effect at exec time.
+ */
+#ifndef PREP_RING_SIZE                      // boards can override this value in hardware.h
+#define PREP_RING_SIZE 4                    // prepared segments in the ring (2 minimum)
+#endif
+static_assert(PREP_RING_SIZE >= 2, "PREP_RING_SIZE must be at least 2");
+static_assert(STEP_CORRECTION_HOLDOFF > PREP_RING_SIZE, "STEP_CORRECTION_HOLDOFF must exceed PREP_RING_SIZE");
 
-typedef struct stPrepMotor {
-    uint32_t substep_increment;             // total steps in axis times substep factor
-    bool motor_flag;                        // true if motor is participating in this move
+// Prepared segment motor values. Written by exec/prep ISR (MED), read during load (HI)
 
-    // direction and direction change
+typedef struct stPrepSegmentMotor {
+    uint32_t substep_increment;             // total steps in axis times substep factor
     uint8_t direction;                      // travel direction corrected for polarity (CW==0. CCW==1)
-    uint8_t prev_direction;                 // travel direction from previous segment run for this motor
     int8_t step_sign;                       // set to +1 or -1 for encoders
+    uint8_t accumulator_correction_flag;    // signals accumulator needs correction
+    int32_t accumulator_correction;         // Q16 factor for adjusting accumulator between segments
+    uint32_t odometer_steps;                // whole steps in the segment, for the odometer
+} stPrepSegmentMotor_t;
+
+typedef struct stPrepSegment {
+    volatile prepBufferState buffer_state;  // slot state - owned by exec or loader
+    struct mpBuffer *bf;                    // static pointer to relevant buffer
+    blockType block_type;                   // move type (requires planner.h)
+
+    uint32_t dda_ticks;                     // DDA ticks for the move
+    uint32_t dda_divisor;                   // DDA rate for the move is FREQUENCY_DDA / dda_divisor
+    uint32_t dwell_ticks;                   // dwell ticks remaining
+    uint32_t dda_ticks_X_substeps;          // DDA ticks scaled by substep factor
+    float target_steps[MOTORS];             // position at end of segment - for following error
+    int16_t raster_intensity;               // scanline pixel or velocity-synced power, -1 to leave the PWM alone
+    uint32_t pso_increment;                 // PSO accumulator increment per DDA tick, 0 if none (see pso.h)
+    uint32_t pso_pulse_ticks;               // PSO pulse width in DDA ticks at this segment's DDA rate
+    uint16_t output_set;                    // outputs the loader turns on with the segment (M62) - bit 0 is output 1
+    uint16_t output_clear;                  // outputs the loader turns off with the segment (M63)
+    uint16_t position_motors;               // motors set by position rather than steps - bit 0 is motor 1
+    float position_time;                    // segment time in seconds, for position motors
+    stPrepSegmentMotor_t mot[MOTORS];       // per-motor segment values
+} stPrepSegment_t;
+
+// Motor prep state that persists across segments
+// Must be careful about volatiles in this one
+
+typedef struct stPrepMotor {
+    // direction change
+    uint8_t prev_direction;                 // travel direction from previous segment run for this motor (loader)
 
     // following error correction
     int32_t correction_holdoff;             // count down segments between corrections
     float corrected_steps;                  // accumulated correction steps for the cycle (for diagnostic display only)
 
+    // backlash compensation
+    int8_t backlash_direction;              // direction of the last move (+1 or -1), 0 before the first
+    float backlash_target;                  // steps the motor should be ahead of the runtime for the slack taken up
+    float backlash_steps;                   // steps it is ahead now - injected so far
+
     // accumulator phase correction
-    float prev_segment_time;                // segment time from previous segment run for this motor
-    float accumulator_correction;           // factor for adjusting accumulator between segments
-    uint8_t accumulator_correction_flag;    // signals accumulator needs correction
+    int32_t prev_dda_ticks;                 // DDA ticks of previous segment prepped for this motor
+
+    // odometer
+    float odometer_carry;                   // fraction of a step prepped but not yet counted
 } stPrepMotor_t;
 
 typedef struct stPrepSingleton {
     magic_t magic_start;                    // magic number to test memory integrity
-    volatile prepBufferState buffer_state;  // prep buffer state - owned by exec or loader
-    struct mpBuffer *bf;                    // static pointer to relevant buffer
-    blockType block_type;                   // move type (requires planner.h)
-
-    uint32_t dda_ticks;                     // DDA ticks for the move
-    uint32_t dwell_ticks;                   // dwell ticks remaining
-    uint32_t dda_ticks_X_substeps;          // DDA ticks scaled by substep factor
+    stPrepSegment_t seg[PREP_RING_SIZE];    // ring of prepared segments
+    uint8_t w;                              // slot exec prepares next (MED)
+    volatile uint8_t r;                     // slot the loader runs next (HI)
+    volatile bool command_queued;           // a command is in the ring - exec holds off until it has run
+    volatile uint16_t motor_inhibit;        // motors held still regardless of the move (homing switch hits)
+    float dda_ticks_remainder;              // FREQUENCY_DDA ticks of segment time carried into the next segment
+    uint16_t output_set;                    // outputs for the next segment prepped - see st_prep_outputs()
+    uint16_t output_clear;
     stPrepMotor_t mot[MOTORS];              // prep time motor structs
     magic_t magic_end;
 } stPrepSingleton_t;
 
+// Motor odometers - see Motor odometers, above
+
+typedef struct stOdometerMotor {
+    uint64_t steps;                         // steps taken - added by the loader (HI)
+    uint32_t reversals;                     // direction changes - added by the loader (HI)
+    float peak_rate;                        // fastest segment in steps per second - kept by prep (MED)
+    uint64_t energized_ms;                  // time energized - added up in the main loop
+    uint64_t full_power_ms;                 // time energized weighted by the power level
+} stOdometerMotor_t;
+
+typedef struct stOdometer {
+    uint32_t tick_ms;                       // SysTick time the hours were last added up
+    uint32_t persisted_ms;                  // SysTick time the counters were last persisted
+    stOdometerMotor_t mot[MOTORS];
+} stOdometer_t;
+
 extern stConfig_t st_cfg;                   // config struct is exposed. The rest are private
 extern stPrepSingleton_t st_pre;            // only used by config_app diagnostics
 
 
 /**** Stepper (base object) ****/
 
+uint32_t st_schedule_motor_power(const uint32_t timeout_ms);    // used by the power timeouts below
+
 struct Stepper {
 protected:
-    Timeout _motor_disable_timeout;         // this is the timeout object that will let us know when time is u
+    uint32_t _power_deadline;               // SysTick ms the power timeout runs out
     uint32_t _motor_disable_timeout_ms;     // the number of ms that the timeout is reset to
     stPowerState _power_state;              // state machine for managing motor power
     stPowerMode _power_mode;                // See stPowerMode for values
@@ -522,47 +718,54 @@ public:
             return;
         }
         this->_disableImpl();
-        _motor_disable_timeout.clear();
         _power_state = MOTOR_IDLE; // or MOTOR_OFF
     };
 
-    // turn off motor is only powered when moving
+    // start the power timeout of a motor that has stopped - called by the loader, so keep it short
     void motionStopped() {
         if (_power_mode == MOTOR_POWERED_IN_CYCLE) {
             this->enable();
-            _power_state = MOTOR_POWER_TIMEOUT_START;
+            _power_state = MOTOR_POWER_TIMEOUT_COUNTDOWN;
+            _power_deadline = st_schedule_motor_power(_motor_disable_timeout_ms);
         } else if (_power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
             if (_power_state == MOTOR_RUNNING) {
-                _power_state = MOTOR_POWER_TIMEOUT_START;
+                _power_state = MOTOR_POWER_TIMEOUT_COUNTDOWN;
+                _power_deadline = st_schedule_motor_power(st_cfg.motor_power_timeout * 1000.0);
             }
         }
     };
 
-    virtual void periodicCheck(bool have_actually_stopped) // can be overridden
-    {
-        if (have_actually_stopped && _power_state == MOTOR_RUNNING) {
-            _power_state = MOTOR_POWER_TIMEOUT_START;    // ...start motor power timeouts
+    // start the power timeout of a motor left running with the machine stopped (e.g. by {me:})
+    void idleStopped() {
+        if (_power_state != MOTOR_RUNNING) {
+            return;
         }
-
-        // start timeouts initiated during a load so the loader does not need to burn these cycles
-        if (_power_state == MOTOR_POWER_TIMEOUT_START && _power_mode != MOTOR_ALWAYS_POWERED) {
+        if (_power_mode == MOTOR_POWERED_IN_CYCLE) {
             _power_state = MOTOR_POWER_TIMEOUT_COUNTDOWN;
-            if (_power_mode == MOTOR_POWERED_IN_CYCLE) {
-                _motor_disable_timeout.set(_motor_disable_timeout_ms);
-            } else if (_power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
-                _motor_disable_timeout.set(st_cfg.motor_power_timeout * 1000.0);
-          }
+            _power_deadline = st_schedule_motor_power(_motor_disable_timeout_ms);
+        } else if (_power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
+            motionStopped();
         }
+    };
 
-        // count down and time out the motor
-        if (_power_state == MOTOR_POWER_TIMEOUT_COUNTDOWN) {
-            if (_motor_disable_timeout.isPast()) {
-                disable();
-				sr_request_status_report(SR_REQUEST_TIMED);
-            }
+    // de-energize the motor if its timeout has run out, or re-schedule it - called when the power event fires
+    void powerTimeout(const uint32_t now) {
+        if (_power_state != MOTOR_POWER_TIMEOUT_COUNTDOWN) {
+            return;                         // cancelled by enable() on the next load
+        }
+        int32_t remaining = (int32_t)(_power_deadline - now);
+        if (remaining > 0) {
+            st_schedule_motor_power(remaining);
+        } else {
+            disable();
+            sr_request_status_report(SR_REQUEST_TIMED);
         }
     };
 
+    virtual void periodicCheck(bool have_actually_stopped) // driver housekeeping every pass - can be overridden
+    {
+    };
+
     /* Functions that must be implemented in subclasses */
 
     virtual bool canStep() { return true; };
@@ -573,6 +776,20 @@ public:
     virtual void setDirection(uint8_t new_direction) { /* must override */ };
     virtual void setMicrosteps(const uint8_t microsteps) { /* must override */ };
     virtual void setPowerLevel(float new_pl) { /* must override */ };
+    virtual void setPowerScale(const float run_scale, const float hold_scale) {};
+    virtual uint32_t getDirectionSetupNs() const { return 0; };    // see Direction timing
+    virtual uint32_t getDirectionHoldNs() const { return 0; };
+
+    /* Stall sensing - drivers that can sense a stall override these and call st_motor_stalled() */
+
+    virtual bool canSenseStall() { return false; };
+    virtual void setStallThreshold(const float threshold) {};
+    virtual void setStallDetect(const bool armed) {};
+
+    /* Position output - drivers that set a position instead of taking steps override these */
+
+    virtual bool takesPosition() { return false; };
+    virtual void setTargetPosition(const float target_steps, const float seconds) {};
 };
 
 
@@ -584,18 +801,36 @@ void stepper_init_assertions(void);
 stat_t stepper_test_assertions(void);
 
 bool st_runtime_isbusy(void);
+void st_halt_steps(void);
+bool st_steps_halted(void);
 stat_t st_clc(nvObj_t *nv);
 void st_set_motor_power(const uint8_t motor);
 stat_t st_motor_power_callback(void);
+stat_t st_odometer_callback(void);
+void st_persist_odometers(void);
+void st_restore_odometers(void);
+void st_request_power_scale(const float scale);
+
+void st_motor_stalled(Stepper *motor);
+bool st_axis_can_sense_stall(const uint8_t axis);
+void st_set_axis_stall_detect(const uint8_t axis, const bool armed);
+void st_reset_stall_detect(void);
 
 void st_request_forward_plan(void);
 void st_request_exec_move(void);
 void st_request_load_move(void);
 void st_prep_null(void);
+float st_get_step_phase(const uint8_t motor, const float ticks_ago);
+float st_get_backlash_steps(const uint8_t motor);
+void st_inhibit_motors(const uint16_t motor_mask);
+void st_clear_motor_inhibits(void);
 void st_prep_command(void *bf);        // use a void pointer since we don't know about mpBuf_t yet)
 void st_prep_dwell(float microseconds);
 void st_prep_out_of_band_dwell(float microseconds);
-stat_t st_prep_line(float travel_steps[], float following_error[], float segment_time);
+void st_prep_outputs(const uint16_t set, const uint16_t clear);
+stat_t st_prep_line(float travel_steps[], float following_error[], const float target_steps[], float segment_time,
+                    const float pso_length,
+                    const int16_t raster_intensity);
 
 stat_t st_get_ma(nvObj_t *nv);
 stat_t st_set_ma(nvObj_t *nv);
@@ -619,11 +854,33 @@ stat_t st_get_pm(nvObj_t *nv);
 stat_t st_set_pm(nvObj_t *nv);
 stat_t st_get_pl(nvObj_t *nv);
 stat_t st_set_pl(nvObj_t *nv);
+stat_t st_get_ec(nvObj_t *nv);
+stat_t st_set_ec(nvObj_t *nv);
+stat_t st_get_sm(nvObj_t *nv);
+stat_t st_set_sm(nvObj_t *nv);
+stat_t st_get_sg(nvObj_t *nv);
+stat_t st_set_sg(nvObj_t *nv);
+stat_t st_get_sq(nvObj_t *nv);
+stat_t st_set_sq(nvObj_t *nv);
 
 stat_t st_get_pwr(nvObj_t *nv);
+stat_t st_get_ost(nvObj_t *nv);
+stat_t st_set_ost(nvObj_t *nv);
+stat_t st_get_orv(nvObj_t *nv);
+stat_t st_set_orv(nvObj_t *nv);
+stat_t st_get_oen(nvObj_t *nv);
+stat_t st_set_oen(nvObj_t *nv);
+stat_t st_get_opw(nvObj_t *nv);
+stat_t st_set_opw(nvObj_t *nv);
+stat_t st_get_opk(nvObj_t *nv);
+stat_t st_set_opk(nvObj_t *nv);
 
 stat_t st_get_mt(nvObj_t *nv);
 stat_t st_set_mt(nvObj_t *nv);
+stat_t st_get_mcp(nvObj_t *nv);
+stat_t st_set_mcp(nvObj_t *nv);
+stat_t st_get_mhp(nvObj_t *nv);
+stat_t st_set_mhp(nvObj_t *nv);
 stat_t st_set_md(nvObj_t *nv);
 stat_t st_set_me(nvObj_t *nv);
 stat_t st_get_dw(nvObj_t *nv);
@@ -640,8 +897,19 @@ stat_t st_get_dw(nvObj_t *nv);
     void st_print_sp(nvObj_t *nv);
     void st_print_pm(nvObj_t *nv);
     void st_print_pl(nvObj_t *nv);
+    void st_print_ec(nvObj_t *nv);
+    void st_print_sm(nvObj_t *nv);
+    void st_print_sg(nvObj_t *nv);
+    void st_print_sq(nvObj_t *nv);
     void st_print_pwr(nvObj_t *nv);
+    void st_print_ost(nvObj_t *nv);
+    void st_print_orv(nvObj_t *nv);
+    void st_print_oen(nvObj_t *nv);
+    void st_print_opw(nvObj_t *nv);
+    void st_print_opk(nvObj_t *nv);
     void st_print_mt(nvObj_t *nv);
+    void st_print_mcp(nvObj_t *nv);
+    void st_print_mhp(nvObj_t *nv);
     void st_print_me(nvObj_t *nv);
     void st_print_md(nvObj_t *nv);
 
@@ -657,8 +925,19 @@ stat_t st_get_dw(nvObj_t *nv);
     #define st_print_sp tx_print_stub
     #define st_print_pm tx_print_stub
     #define st_print_pl tx_print_stub
+    #define st_print_ec tx_print_stub
+    #define st_print_sm tx_print_stub
+    #define st_print_sg tx_print_stub
+    #define st_print_sq tx_print_stub
     #define st_print_pwr tx_print_stub
+    #define st_print_ost tx_print_stub
+    #define st_print_orv tx_print_stub
+    #define st_print_oen tx_print_stub
+    #define st_print_opw tx_print_stub
+    #define st_print_opk tx_print_stub
     #define st_print_mt tx_print_stub
+    #define st_print_mcp tx_print_stub
+    #define st_print_mhp tx_print_stub
     #define st_print_me tx_print_stub
     #define st_print_md tx_print_stub
 
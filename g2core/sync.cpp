@@ -0,0 +1,216 @@
+/*
+ * sync.cpp - motion time synchronization between boards
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "sync.h"
+#include "canonical_machine.h"
+#include "stepper.h"
+#include "gpio.h"
+#include "text_parser.h"
+#include "util.h"
+
+syncSingleton_t sy;
+
+/*
+ * sync_reset() - restart the clock and drop the outputs - called by stepper_reset()
+ */
+
+void sync_reset()
+{
+    sy.increment = 0;
+    sy.accumulator = 0;
+    sy.periods = 0;
+    sy.edges = 0;
+    sy.trim = 0;
+    sy.error = 0;
+    sy.level = false;
+    sy.run = false;
+    if (sy.clock_output) {
+        gpio_set_output(sy.clock_output-1, 0);
+    }
+    if (sy.run_output) {
+        gpio_set_output(sy.run_output-1, 0);
+    }
+}
+
+static stat_t _sync_restart()                   // after a config change
+{
+    sync_reset();
+    sy.tick_increment = 0;
+    if ((sy.mode != SYNC_OFF) && (sy.period >= SYNC_PERIOD_MIN)) {  // the period is set after the mode
+        sy.tick_increment = (uint32_t)(4294967296.0 / ((sy.period / 1000) * FREQUENCY_DDA));
+    }
+    return (STAT_OK);
+}
+
+/*
+ * sync_period_end() - a period of motion time has run - from the DDA ISR
+ *
+ *  The master toggles its clock output, so each edge is a period. A follower just counts.
+ */
+
+void sync_period_end()
+{
+    sy.periods++;
+    if ((sy.mode == SYNC_MASTER) && sy.clock_output) {
+        sy.level = !sy.level;
+        gpio_set_output(sy.clock_output-1, sy.level ? 1.0 : 0.0);
+    }
+}
+
+/*
+ * sync_clock_edge() - an edge of the master's clock - from the follower's input ISR
+ *
+ *  The phase error is the periods run less the master's edges, plus the part of a period
+ *  run since. The DDA ISR can wrap the accumulator while it is read, so the read is
+ *  repeated until the period count holds still.
+ */
+
+void sync_clock_edge()
+{
+    if (sy.mode != SYNC_FOLLOWER) {
+        return;
+    }
+    uint32_t periods;
+    uint32_t accumulator;
+    do {
+        periods = sy.periods;
+        accumulator = sy.accumulator;
+    } while (periods != sy.periods);
+
+    sy.edges++;
+    float error = (float)(int32_t)(periods - sy.edges) + (float)accumulator / 4294967296.0;
+    sy.error = error;
+    sy.trim = min(max(error / SYNC_LOCK_PERIODS, -SYNC_TRIM_MAX), SYNC_TRIM_MAX);
+}
+
+/*
+ * sync_run_edge()   - the master's run line changed - from the follower's input ISR
+ * sync_hold_start() - true if a follower must not start motion - the run line is down
+ *
+ *  The restart is only requested from a feedhold. A follower that is stopped starts by
+ *  itself once sync_hold_start() lets it.
+ */
+
+void sync_run_edge(const bool active)
+{
+    if (sy.mode != SYNC_FOLLOWER) {
+        return;
+    }
+    if (!active) {
+        cm_request_feedhold(FEEDHOLD_TYPE_HOLD, FEEDHOLD_EXIT_CYCLE);
+    } else if (cm1.hold_state != FEEDHOLD_OFF) {
+        cm_request_cycle_start();               // only sets the request from a feedhold
+    }
+}
+
+bool sync_hold_start()
+{
+    if (sy.mode != SYNC_FOLLOWER) {
+        return (false);
+    }
+    for (uint8_t i = 0; i < D_IN_CHANNELS; i++) {
+        if ((d_in[i].function == INPUT_FUNCTION_SYNC_RUN) && (d_in[i].state != INPUT_DISABLED)) {
+            return (d_in[i].state != INPUT_ACTIVE);
+        }
+    }
+    return (false);                             // no run line, nothing to wait for
+}
+
+/*
+ * sync_callback() - drive the master's run output from the main loop
+ */
+
+stat_t sync_callback()
+{
+    if ((sy.mode != SYNC_MASTER) || (sy.run_output == 0)) {
+        return (STAT_NOOP);
+    }
+    bool run = (cm1.motion_state == MOTION_RUN) && (cm1.hold_state == FEEDHOLD_OFF);
+    if (run != sy.run) {
+        sy.run = run;
+        gpio_set_output(sy.run_output-1, run ? 1.0 : 0.0);
+    }
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+stat_t sync_get_syn(nvObj_t *nv)  { return (get_integer(nv, sy.mode)); }
+stat_t sync_get_synp(nvObj_t *nv) { return (get_float(nv, sy.period)); }
+stat_t sync_get_synk(nvObj_t *nv) { return (get_integer(nv, sy.clock_output)); }
+stat_t sync_get_synr(nvObj_t *nv) { return (get_integer(nv, sy.run_output)); }
+stat_t sync_get_syne(nvObj_t *nv) { return (get_float(nv, sy.error * sy.period * 1000)); }
+
+stat_t sync_set_syn(nvObj_t *nv)
+{
+    int32_t mode;
+    ritorno(set_int32(nv, mode, 0, SYNC_MODE_MAX));
+    sy.mode = mode;
+    return (_sync_restart());
+}
+
+stat_t sync_set_synp(nvObj_t *nv)
+{
+    ritorno(set_float_range(nv, sy.period, SYNC_PERIOD_MIN, 1000));
+    return (_sync_restart());
+}
+
+stat_t sync_set_synk(nvObj_t *nv)
+{
+    int32_t output;
+    ritorno(set_int32(nv, output, 0, D_OUT_CHANNELS));
+    sync_reset();                               // drop the old output before moving to the new one
+    sy.clock_output = output;
+    return (_sync_restart());
+}
+
+stat_t sync_set_synr(nvObj_t *nv)
+{
+    int32_t output;
+    ritorno(set_int32(nv, output, 0, D_OUT_CHANNELS));
+    sync_reset();
+    sy.run_output = output;
+    return (_sync_restart());
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_syn[]  = "[syn]  sync mode%21d [0=off,1=master,2=follower]\n";
+static const char fmt_synp[] = "[synp] sync clock period%13.1f ms\n";
+static const char fmt_synk[] = "[synk] sync clock output%13d [0=none]\n";
+static const char fmt_synr[] = "[synr] sync run output%15d [0=none]\n";
+static const char fmt_syne[] = "Sync phase error:%16.0f us\n";
+
+void sync_print_syn(nvObj_t *nv)  { text_print(nv, fmt_syn);}
+void sync_print_synp(nvObj_t *nv) { text_print(nv, fmt_synp);}
+void sync_print_synk(nvObj_t *nv) { text_print(nv, fmt_synk);}
+void sync_print_synr(nvObj_t *nv) { text_print(nv, fmt_synr);}
+void sync_print_syne(nvObj_t *nv) { text_print(nv, fmt_syne);}
+
+#endif // __TEXT_MODE
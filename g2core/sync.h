@@ -0,0 +1,141 @@
+/*
+ * sync.h - motion time synchronization between boards
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * MULTI-BOARD SYNCHRONIZATION
+ *
+ *  Boards that share a machine run their own G-code, and keep their motion in step over
+ *  two wires. One board is the master {syn:1}, the others follow {syn:2}.
+ *
+ *  Clock: every board counts its motion time - the time its DDA runs - in periods of
+ *  {synp:} ms. The master toggles its clock output {synk:} at the end of every period. A
+ *  follower sees each edge on an input set to the sync clock function. At the edge it
+ *  compares the periods it has run with the master's, which gives its phase error
+ *  ({syne:}, + is ahead). It then trims its segment times by the error spread over
+ *  SYNC_LOCK_PERIODS, up to SYNC_TRIM_MAX, so its steps are pulled onto the master's
+ *  timeline. The clock is counted in the DDA ISR the same way PSO is (see pso.h), so
+ *  its edges are within a DDA tick of the period.
+ *
+ *  Run: the master holds its run output {synr:} up while it is moving and not in a
+ *  feedhold. A follower with an input set to the sync run function doesn't start motion
+ *  while the line is down. It feedholds when the line drops, and restarts when it comes
+ *  back.
+ *
+ *  Both boards must be planned for the same motion time (same moves, same limits) for
+ *  the clock to keep them together. Dwells don't run the DDA, so they aren't counted.
+ */
+
+#ifndef SYNC_H_ONCE
+#define SYNC_H_ONCE
+
+#include "config.h"  // needed for nvObj_t definition
+
+typedef enum {
+    SYNC_OFF = 0,                   // not synchronized
+    SYNC_MASTER,                    // drive the clock and run lines
+    SYNC_FOLLOWER                   // lock to them
+} syncMode;
+#define SYNC_MODE_MAX SYNC_FOLLOWER
+
+#define SYNC_LOCK_PERIODS 8.0       // periods a follower takes to run out a phase error
+#define SYNC_TRIM_MAX 0.05          // most a follower stretches or shrinks its segment times
+#define SYNC_START_POLL_MS 1        // how often a follower waiting on the run line looks at it
+#define SYNC_PERIOD_MIN 1.0         // ms - keeps the per tick increment in range
+
+typedef struct syncSingleton {
+    // config
+    uint8_t mode;                   // syncMode
+    float period;                   // clock period, ms
+    uint8_t clock_output;           // master's clock output number, 0 = none
+    uint8_t run_output;             // master's run output number, 0 = none
+
+    // DDA ISR (HI)
+    uint32_t tick_increment;        // fraction of the period per FREQUENCY_DDA tick, scaled to 2^32
+    uint32_t increment;             // fraction of the period per DDA tick, for this segment
+    uint32_t accumulator;           // fraction of the period run so far, scaled to 2^32
+    volatile uint32_t periods;      // periods run
+    bool level;                     // master's clock output level
+
+    // input ISR (follower) and main loop (master)
+    uint32_t edges;                 // master clock edges seen (follower)
+    volatile float trim;            // fraction added to the segment times (follower)
+    volatile float error;           // phase error at the last edge, periods (follower)
+    bool run;                       // run output level (master)
+} syncSingleton_t;
+
+extern syncSingleton_t sy;
+
+void sync_reset(void);
+void sync_period_end(void);
+void sync_clock_edge(void);
+void sync_run_edge(const bool active);
+bool sync_hold_start(void);
+stat_t sync_callback(void);
+
+/*
+ * sync_dda_tick()     - advance the clock one DDA tick - from the DDA ISR, keep it short
+ * sync_load_segment() - set the clock rate for a segment - from the loader
+ * sync_segment_time() - a segment time with the follower's trim applied - from prep
+ */
+
+static inline void sync_dda_tick()
+{
+    if (sy.increment) {
+        const uint32_t before = sy.accumulator;
+        sy.accumulator += sy.increment;
+        if (sy.accumulator < before) {
+            sync_period_end();
+        }
+    }
+}
+
+static inline void sync_load_segment(const uint32_t dda_divisor)
+{
+    sy.increment = sy.tick_increment * dda_divisor;
+}
+
+static inline float sync_segment_time(const float segment_time)
+{
+    return ((sy.mode == SYNC_FOLLOWER) ? segment_time * (1 + sy.trim) : segment_time);
+}
+
+stat_t sync_get_syn(nvObj_t *nv);
+stat_t sync_set_syn(nvObj_t *nv);
+stat_t sync_get_synp(nvObj_t *nv);
+stat_t sync_set_synp(nvObj_t *nv);
+stat_t sync_get_synk(nvObj_t *nv);
+stat_t sync_set_synk(nvObj_t *nv);
+stat_t sync_get_synr(nvObj_t *nv);
+stat_t sync_set_synr(nvObj_t *nv);
+stat_t sync_get_syne(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void sync_print_syn(nvObj_t *nv);
+    void sync_print_synp(nvObj_t *nv);
+    void sync_print_synk(nvObj_t *nv);
+    void sync_print_synr(nvObj_t *nv);
+    void sync_print_syne(nvObj_t *nv);
+#else
+    #define sync_print_syn tx_print_stub
+    #define sync_print_synp tx_print_stub
+    #define sync_print_synk tx_print_stub
+    #define sync_print_synr tx_print_stub
+    #define sync_print_syne tx_print_stub
+#endif
+
+#endif  // End of include guard: SYNC_H_ONCE
@@ -32,12 +32,14 @@
 #include "text_parser.h"        // #4
 
 #include "temperature.h"
+#include "adaptive.h"
 #include "planner.h"
 #include "hardware.h"
 #include "pwm.h"
 #include "report.h"
 #include "util.h"
 #include "settings.h"
+#include "xio.h"
 
 
 /**** Local safety/limit settings ****/
@@ -94,6 +96,27 @@
 #define TEMP_MIN_RISE_DEGREES_FROM_TARGET (float)10.0
 #endif
 
+// The PID loop runs every TEMP_PID_PERIOD milliseconds. The temperature reads are table
+// lookups so the loop is cheap to run faster, but the PID factors are per-tick and must be
+// retuned if this is changed.
+#ifndef TEMP_PID_PERIOD
+#define TEMP_PID_PERIOD 100
+#endif
+
+// PID autotune relay settings. The relay switches the heater full on below
+// target - TEMP_AUTOTUNE_HYSTERESIS and full off above target + TEMP_AUTOTUNE_HYSTERESIS.
+// Gains are computed from the average of TEMP_AUTOTUNE_CYCLES full oscillations,
+// and the cycle fails if they have not been seen within TEMP_AUTOTUNE_TIMEOUT ms.
+#ifndef TEMP_AUTOTUNE_HYSTERESIS
+#define TEMP_AUTOTUNE_HYSTERESIS (float)1.0
+#endif
+#ifndef TEMP_AUTOTUNE_CYCLES
+#define TEMP_AUTOTUNE_CYCLES 5
+#endif
+#ifndef TEMP_AUTOTUNE_TIMEOUT
+#define TEMP_AUTOTUNE_TIMEOUT (float)(20.0 * 60.0 * 1000.0) // twenty minutes
+#endif
+
 
 /**** Allocate structures ****/
 
@@ -107,13 +130,37 @@ using namespace Motate;
 const float kSystemVoltage = 3.3;
 
 
+// Each thermistor and output is its own template type, bound to its pins. The heaters reach them
+// through these interfaces so they can all be kept in one array and run by one loop.
+
+struct TemperatureSensor {
+    virtual float temperature() = 0;    // degrees C, or -1 if the sensor has failed
+    virtual float get_resistance() = 0;
+    virtual float get_adc() = 0;
+    virtual float get_load() = 0;       // the ADC reading as a fraction of full scale
+    virtual void sample() = 0;          // take in the readings since the last call - once per PID tick
+};
+
+struct HeaterOutput {
+    virtual void init() = 0;
+    virtual void write(const float value) = 0;
+    virtual float read() = 0;
+};
+
 template<pin_number adc_pin_num, uint16_t min_temp = 0, uint16_t max_temp = 300, uint32_t table_size=64>
-struct Thermistor {
+struct Thermistor : TemperatureSensor {
     float c1, c2, c3, pullup_resistance, inline_resistance;
     // We'll pull adc top value from the adc_pin.getTop()
 
+    // Lookup table of {adc value, temperature} pairs at even temperature steps from min_temp
+    // to max_temp. ADC values fall as temperature rises. Built by setup().
+    float lookup_table[table_size][2];
+
     ADCPin<adc_pin_num> adc_pin;
-    uint16_t raw_adc_value = 0;
+    float raw_adc_value = 0;            // oversampled ADC reading, updated once per PID tick by sample()
+
+    volatile uint32_t adc_sum = 0;      // conversions accumulated by the ADC interrupt since the last sample()
+    volatile uint16_t adc_count = 0;
 
     typedef Thermistor<adc_pin_num, min_temp, max_temp, table_size> type;
 
@@ -150,21 +197,56 @@ struct Thermistor {
         c2 = (x-c3*v)/z;
         c1 = 1/temp_low_fixed-c3*pow(a1,3)-c2*a1;
 
-        //        int16_t temp = min_temp;
-        //        for (int i=0; temp < max_temp && i < table_size; i++) {
-        //            lookup_table[i][0] = adc_value(temp);
-        //            lookup_table[i][0] = temp;
-        //
-        //            temp += (min_temp-max_temp)/(table_size-1);
-        //        }
+        for (uint32_t i=0; i < table_size; i++) {
+            float temp = min_temp + (float)(max_temp - min_temp) * i / (table_size-1);
+            lookup_table[i][0] = adc_value(temp);
+            lookup_table[i][1] = temp;
+        }
     };
 
-//    uint16_t adc_value_(int16_t temp) {
-//        float y = (c1 - (1/(temp+273.15))) / (2*c3);
-//        float x = sqrt(pow(c2 / (3*c3),3) + pow(y,2));
-//        float r = exp((x-y) - (x+y)); // resistance of thermistor
-//        return (r / (pullup_resistance + r)) * (adc_pin.getTop());
-//    };
+    // Inverse of the Steinhart-Hart equation - the ADC value the thermistor reads at temp.
+    // The closed form can take the root of a negative for some fits, so bisect ln(r) over
+    // the connected resistance range instead. 1/T rises with ln(r). Only run from setup().
+    float adc_value(float temp) {
+        float Tinv = 1/(temp+273.15);
+        float lnr_low = 0;
+        float lnr_high = log(TEMP_MIN_DISCONNECTED_RESISTANCE);
+        for (uint8_t i=0; i < 32; i++) {
+            float lnr = (lnr_low + lnr_high) / 2;
+            if ((c1 + (c2*lnr) + (c3*pow(lnr,3))) > Tinv) {
+                lnr_high = lnr;
+            } else {
+                lnr_low = lnr;
+            }
+        }
+        float r = exp((lnr_low + lnr_high) / 2); // resistance of thermistor
+        return ((r + inline_resistance) / (pullup_resistance + r + inline_resistance)) * (adc_pin.getTop());
+    };
+
+    // Binary search the table and interpolate between the bracketing entries. Readings
+    // outside the table (including a failed sensor) fall back to temperature_exact().
+    float temperature() override {
+        float adc = raw_adc_value;
+        if ((adc < 1) || (adc > lookup_table[0][0]) || (adc < lookup_table[table_size-1][0])) {
+            return temperature_exact();
+        }
+        uint32_t low = 0;
+        uint32_t high = table_size-1;
+        while ((high - low) > 1) {
+            uint32_t mid = (low + high) / 2;
+            if (adc > lookup_table[mid][0]) {
+                high = mid;
+            } else {
+                low = mid;
+            }
+        }
+        float span = lookup_table[low][0] - lookup_table[high][0];
+        if (span <= 0) {
+            return lookup_table[low][1];
+        }
+        float fraction = (lookup_table[low][0] - adc) / span;
+        return lookup_table[low][1] + fraction * (lookup_table[high][1] - lookup_table[low][1]);
+    };
 
     float temperature_exact() {
         // Sanity check:
@@ -172,7 +254,7 @@ struct Thermistor {
             return -1; // invalid temperature from a thermistor
         }
 
-        float v = (float)raw_adc_value * kSystemVoltage / (adc_pin.getTop()); // convert the 10 bit ADC value to a voltage
+        float v = raw_adc_value * kSystemVoltage / (adc_pin.getTop()); // convert the ADC value to a voltage
         float r = ((pullup_resistance * v) / (kSystemVoltage - v)) - inline_resistance;   // resistance of thermistor
 
         if ((r < 0) || (r > TEMP_MIN_DISCONNECTED_RESISTANCE)) {
@@ -184,18 +266,44 @@ struct Thermistor {
         return (1/Tinv) - 273.15; // final temperature
     };
 
-    float get_resistance() {
+    float get_resistance() override {
         if (raw_adc_value < 1) {
             return -1; // invalid temperature from a thermistor
         }
 
-        float v = (float)raw_adc_value * kSystemVoltage / (adc_pin.getTop()); // convert the 10 bit ADC value to a voltage
+        float v = raw_adc_value * kSystemVoltage / (adc_pin.getTop()); // convert the ADC value to a voltage
         return ((pullup_resistance * v) / (kSystemVoltage - v)) - inline_resistance;   // resistance of thermistor
     }
 
     // Call back function from the ADC to tell it that the ADC has a new sample...
+    // Just accumulate it - filtering is done in one batch per PID tick by sample()
     void adc_has_new_value() {
-        raw_adc_value = (adc_pin.getRaw() + (9 * raw_adc_value))/10;
+        adc_sum += adc_pin.getRaw();
+        adc_count++;
+    };
+
+    // Decimate the conversions accumulated since the last call into raw_adc_value. The
+    // average of N conversions keeps the fractional part, so the reading gains resolution
+    // as well as losing noise. Keeps the previous reading if nothing has been converted.
+    float get_adc() override {
+        return raw_adc_value;
+    };
+
+    float get_load() override {
+        return raw_adc_value / adc_pin.getTop();
+    };
+
+    void sample() override {
+        __disable_irq();
+        uint32_t sum = adc_sum;
+        uint16_t count = adc_count;
+        adc_sum = 0;
+        adc_count = 0;
+        __enable_irq();
+
+        if (count > 0) {
+            raw_adc_value = (float)sum / count;
+        }
     };
 };
 
@@ -245,35 +353,80 @@ void ADCPin<kADC0_PinNumber>::interrupt() {
 }
 #endif
 
-float last_reported_temp1 = 0; // keep track of what we've reported for SR generation
-float last_reported_temp2 = 0;
-float last_reported_temp3 = 0;
+// Heaters 4 and up are board specific - the board names their pins in its pinout
+#if (HEATERS >= 4)
+Thermistor<HEATER4_ADC_PIN> thermistor4 {
+    /*T1:*/     20.0, /*T2:*/  190.0, /*T3:*/ 255.0,
+    /*R1:*/ 140000.0, /*R2:*/  490.0, /*R3:*/ 109.0, /*pullup_resistance:*/ 4700, /*inline_resistance:*/ 4700
+    };
+namespace Motate {
+template<>
+void ADCPin<HEATER4_ADC_PIN>::interrupt() {
+    thermistor4.adc_has_new_value();
+};
+}
+#endif
+#if (HEATERS >= 5)
+Thermistor<HEATER5_ADC_PIN> thermistor5 {
+    /*T1:*/     20.0, /*T2:*/  190.0, /*T3:*/ 255.0,
+    /*R1:*/ 140000.0, /*R2:*/  490.0, /*R3:*/ 109.0, /*pullup_resistance:*/ 4700, /*inline_resistance:*/ 4700
+    };
+namespace Motate {
+template<>
+void ADCPin<HEATER5_ADC_PIN>::interrupt() {
+    thermistor5.adc_has_new_value();
+};
+}
+#endif
+#if (HEATERS >= 6)
+Thermistor<HEATER6_ADC_PIN> thermistor6 {
+    /*T1:*/     20.0, /*T2:*/  190.0, /*T3:*/ 255.0,
+    /*R1:*/ 140000.0, /*R2:*/  490.0, /*R3:*/ 109.0, /*pullup_resistance:*/ 4700, /*inline_resistance:*/ 4700
+    };
+namespace Motate {
+template<>
+void ADCPin<HEATER6_ADC_PIN>::interrupt() {
+    thermistor6.adc_has_new_value();
+};
+}
+#endif
 
 
-// Output 1 FET info
-// DO_1: Extruder1_PWM
-const int16_t fet_pin1_freq = 100;
+// Heater FET outputs
+template<pin_number output_pin_num>
+struct HeaterFET : HeaterOutput {
 #if TEMPERATURE_OUTPUT_ON == 1
-PWMOutputPin<kOutput1_PinNumber> fet_pin1;// {kPWMPinInverted};
+    PWMOutputPin<output_pin_num> fet_pin;// {kPWMPinInverted};
 #else
-PWMOutputPin<-1> fet_pin1;// {kPWMPinInverted};
+    PWMOutputPin<-1> fet_pin;// {kPWMPinInverted};
 #endif
+    const uint32_t frequency;
+
+    HeaterFET(const uint32_t frequency_) : frequency{ frequency_ } {};
+
+    void init() override { fet_pin.setFrequency(frequency); };
+    void write(const float value) override { fet_pin = value; };
+    float read() override { return (float)fet_pin; };
+};
+
+// DO_1: Extruder1_PWM
+HeaterFET<kOutput1_PinNumber> fet1 {100};
 
 // DO_2: Extruder2_PWM
-const int16_t fet_pin2_freq = 100;
-#if TEMPERATURE_OUTPUT_ON == 1
-PWMOutputPin<kOutput2_PinNumber> fet_pin2;// {kPWMPinInverted};
-#else
-PWMOutputPin<-1> fet_pin2;// {kPWMPinInverted};
-#endif
+HeaterFET<kOutput2_PinNumber> fet2 {100};
 
 // DO_11: Heated Bed FET
 // Warning, HeatBED is likely NOT a PWM pin, so it'll be binary output (duty cucle >= 50%).
-const int16_t fet_pin3_freq = 100;
-#if TEMPERATURE_OUTPUT_ON == 1
-PWMOutputPin<kOutput11_PinNumber> fet_pin3;// {kPWMPinInverted};
-#else
-PWMOutputPin<-1> fet_pin3;// {kPWMPinInverted};
+HeaterFET<kOutput11_PinNumber> fet3 {100};
+
+#if (HEATERS >= 4)
+HeaterFET<HEATER4_OUTPUT_PIN> fet4 {100};
+#endif
+#if (HEATERS >= 5)
+HeaterFET<HEATER5_OUTPUT_PIN> fet5 {100};
+#endif
+#if (HEATERS >= 6)
+HeaterFET<HEATER6_OUTPUT_PIN> fet6 {100};
 #endif
 
 
@@ -441,46 +594,157 @@ struct PID {
 // NOTICE, the JSON alters incoming values for these!
 // {he1p:9} == 9.0/100.0 here
 
-PID pid1 { 9.0, 0.11, 400.0, TEMP_MIN_RISE_DEGREES_OVER_TIME }; // default values
-PID pid2 { 7.5, 0.12, 400.0, TEMP_MIN_RISE_DEGREES_OVER_TIME }; // default values
-PID pid3 { 7.5, 0.12, 400.0, TEMP_MIN_BED_RISE_DEGREES_OVER_TIME }; // default values
 Timeout pid_timeout;
 
 
-template<pin_number heater_fan_pinnum>
+// The fan curve is common to all heater fans; only the pin write is bound to the fan's pin
 struct HeaterFan {
-#if TEMPERATURE_OUTPUT_ON == 1
-    PWMOutputPin<heater_fan_pinnum> heater_fan_pin;
-#endif
     float min_value = MIN_FAN_VALUE;
     float max_value = MAX_FAN_VALUE;
     float low_temp = MIN_FAN_TEMP;
     float high_temp = MIN_FAN_TEMP;
 
-    HeaterFan() {
+    virtual void write(const float value) = 0;
+
+    void newTemp(float temp) {
+        if ((temp > low_temp) && (temp < high_temp)) {
+            write(max_value * (((temp - low_temp)/(high_temp - low_temp))*(1.0 - min_value) + min_value));
+        } else if (temp > high_temp) {
+            write(max_value);
+        } else {
+            write(0.0);
+        }
+    }
+};
+
+template<pin_number heater_fan_pinnum>
+struct HeaterFanPin : HeaterFan {
+#if TEMPERATURE_OUTPUT_ON == 1
+    PWMOutputPin<heater_fan_pinnum> heater_fan_pin;
+#endif
+
+    HeaterFanPin() {
 #if TEMPERATURE_OUTPUT_ON == 1
         heater_fan_pin.setFrequency(200000);
         heater_fan_pin = 0;
 #endif
     }
 
-    void newTemp(float temp) {
+    void write(const float value) override {
 #if TEMPERATURE_OUTPUT_ON == 1
-        if ((temp > low_temp) && (temp < high_temp)) {
-            heater_fan_pin = max_value * (((temp - low_temp)/(high_temp - low_temp))*(1.0 - min_value) + min_value);
-        } else if (temp > high_temp) {
-            heater_fan_pin = max_value;
-        } else {
-            heater_fan_pin = 0.0;
-        }
+        heater_fan_pin = value;
 #endif
     }
 };
 
-HeaterFan<kOutput3_PinNumber> heater_fan1;
+HeaterFanPin<kOutput3_PinNumber> heater_fan1;
+
+
+// One heater zone: its sensor, output, optional fan and PID. The PID loop walks only the
+// enabled heaters, listed in enabled_heaters[] by _update_enabled_heaters().
+
+struct Heater {
+    TemperatureSensor *sensor;
+    HeaterOutput *output;
+    HeaterFan *fan;                 // nullptr if the heater has no fan
+    PID pid;
+    float last_reported_temp;       // keep track of what we've reported for SR generation
+};
+
+Heater heaters[HEATERS] = {
+    { &thermistor1, &fet1, &heater_fan1, { 9.0, 0.11, 400.0, TEMP_MIN_RISE_DEGREES_OVER_TIME }, 0 },    // default values
+#if (HEATERS >= 2)
+    { &thermistor2, &fet2, nullptr,      { 7.5, 0.12, 400.0, TEMP_MIN_RISE_DEGREES_OVER_TIME }, 0 },
+#endif
+#if (HEATERS >= 3)
+    { &thermistor3, &fet3, nullptr,      { 7.5, 0.12, 400.0, TEMP_MIN_BED_RISE_DEGREES_OVER_TIME }, 0 },
+#endif
+#if (HEATERS >= 4)
+    { &thermistor4, &fet4, nullptr,      { 7.5, 0.12, 400.0, TEMP_MIN_RISE_DEGREES_OVER_TIME }, 0 },
+#endif
+#if (HEATERS >= 5)
+    { &thermistor5, &fet5, nullptr,      { 7.5, 0.12, 400.0, TEMP_MIN_RISE_DEGREES_OVER_TIME }, 0 },
+#endif
+#if (HEATERS >= 6)
+    { &thermistor6, &fet6, nullptr,      { 7.5, 0.12, 400.0, TEMP_MIN_RISE_DEGREES_OVER_TIME }, 0 },
+#endif
+};
+
+uint8_t enabled_heaters[HEATERS];   // indexes into heaters[] of the enabled heaters
+uint8_t enabled_heater_count = 0;
+
+// PID autotune cycle state - see cm_autotune_cycle_start()
+struct Autotune {
+    Heater *heater;                 // heater being tuned, or nullptr if no autotune is running
+    uint8_t heater_number;          // 1-based, for the gain setters
+    float target;                   // temperature the relay oscillates around
+    bool saved_enable;              // heater settings restored when the cycle ends
+    float saved_set_point;
+
+    bool heating;                   // relay state
+    bool timing;                    // true once the first full on switch has been seen
+    stat_t status;                  // set by the relay if the sensor fails or the heater runs away
+    uint32_t on_tick;               // SysTick at the last relay switch to full on
+    float temp_max;                 // extremes seen since the last switch to full on
+    float temp_min;
+    uint8_t cycles;                 // full oscillations measured
+    float period_sum;               // sums of the measured periods (ms) and amplitudes (C)
+    float amplitude_sum;
+    Timeout timeout;
+};
+Autotune autotune;
 
 /**** Static functions ****/
 
+/*
+ * _update_enabled_heaters() - rebuild the list of heaters the PID loop runs
+ */
+static void _update_enabled_heaters()
+{
+    enabled_heater_count = 0;
+    for (uint8_t i=0; i < HEATERS; i++) {
+        if (heaters[i].pid._enable) {
+            enabled_heaters[enabled_heater_count++] = i;
+        }
+    }
+}
+
+static Heater *_get_heater(const uint8_t heater);
+
+/*
+ * _autotune_relay() - relay feedback output for the heater being tuned, run once per PID tick
+ *
+ *  One oscillation runs from one switch to full on to the next. The first oscillation
+ *  includes the warm up, so timing starts at the first switch to full on.
+ */
+static float _autotune_relay(const float temp)
+{
+    if ((temp < 0) || (temp > TEMP_MAX_SETPOINT)) {
+        autotune.status = STAT_TEMPERATURE_CONTROL_ERROR;
+        return (0.0);
+    }
+    autotune.temp_max = max(autotune.temp_max, temp);
+    autotune.temp_min = min(autotune.temp_min, temp);
+
+    if (autotune.heating) {
+        if (temp > (autotune.target + TEMP_AUTOTUNE_HYSTERESIS)) {
+            autotune.heating = false;
+        }
+    } else if (temp < (autotune.target - TEMP_AUTOTUNE_HYSTERESIS)) {
+        autotune.heating = true;
+        uint32_t now = SysTickTimer.getValue();
+        if (autotune.timing) {
+            autotune.period_sum += (float)(now - autotune.on_tick);
+            autotune.amplitude_sum += (autotune.temp_max - autotune.temp_min) / 2;
+            autotune.cycles++;
+        }
+        autotune.timing = true;
+        autotune.on_tick = now;
+        autotune.temp_max = temp;
+        autotune.temp_min = temp;
+    }
+    return (autotune.heating ? 1.0 : 0.0);
+}
 
 /*
  * temperature_init()
@@ -488,11 +752,9 @@ HeaterFan<kOutput3_PinNumber> heater_fan1;
 void temperature_init()
 {
     // setup heater PWM
-    fet_pin1.setFrequency(fet_pin1_freq);
-    fet_pin1.setInterrupts(kInterruptOnOverflow|kInterruptPriorityLowest);
-
-    fet_pin2.setFrequency(fet_pin2_freq);
-    fet_pin3.setFrequency(fet_pin3_freq);
+    for (uint8_t i=0; i < HEATERS; i++) {
+        heaters[i].output->init();
+    }
 
 //    fan_pin1 = 0;
 //    fan_pin1.setFrequency(200000);
@@ -512,16 +774,14 @@ void temperature_init()
 void temperature_reset()
 {
     // make setpoint 0
-    fet_pin1 = 0.0f;
-    pid1._set_point = 0.0;
-
-    fet_pin2 = 0.0f;
-    pid2._set_point = 0.0;
-
-    fet_pin3 = 0.0f;
-    pid3._set_point = 0.0;
+    for (uint8_t i=0; i < HEATERS; i++) {
+        heaters[i].output->write(0.0);
+        heaters[i].pid._set_point = 0.0;
+    }
+    _update_enabled_heaters();
+    adaptive_reset();
 
-    pid_timeout.set(100);
+    pid_timeout.set(TEMP_PID_PERIOD);
 }
 
 // Minimum difference in temp before it'll trigger an SR
@@ -531,63 +791,181 @@ stat_t temperature_callback()
 {
     if (cm->machine_state == MACHINE_ALARM) {
         // Force the heaters off (redundant with the safety circuit)
-        fet_pin1 = 0.0;
-        fet_pin2 = 0.0;
-        fet_pin3 = 0.0;
-
         // Force all PIDs to off too
-        pid1._set_point = 0.0;
-        pid2._set_point = 0.0;
-        pid3._set_point = 0.0;
-
+        for (uint8_t i=0; i < HEATERS; i++) {
+            heaters[i].output->write(0.0);
+            heaters[i].pid._set_point = 0.0;
+        }
         return (STAT_OK);
     }
 
     if (pid_timeout.isPast()) {
-        pid_timeout.set(100);
+        pid_timeout.set(TEMP_PID_PERIOD);
 
-        float temp = 0.0;
-        bool sr_requested = false;
+        // All sensors are sampled so {heNan:} stays current on disabled heaters too.
+        // Only the enabled heaters pay for a temperature read and a PID update.
+        for (uint8_t i=0; i < HEATERS; i++) {
+            heaters[i].sensor->sample();
+        }
+        adaptive_feed_update(TEMP_PID_PERIOD / 1000.0);
 
-        if (pid1._enable) {
-            temp = thermistor1.temperature_exact();
-            fet_pin1 = pid1.getNewOutput(temp);
+        bool sr_requested = false;
+        for (uint8_t n=0; n < enabled_heater_count; n++) {
+            Heater *heater = &heaters[enabled_heaters[n]];
+            float temp = heater->sensor->temperature();
+            if (heater == autotune.heater) {
+                heater->output->write(_autotune_relay(temp));
+            } else {
+                heater->output->write(heater->pid.getNewOutput(temp));
+            }
 
-            if (fabs(temp - last_reported_temp1) > kTempDiffSRTrigger) {
-                last_reported_temp1 = temp;
+            if (heater->fan != nullptr) {
+                heater->fan->newTemp(temp);
+            }
+            if (fabs(temp - heater->last_reported_temp) > kTempDiffSRTrigger) {
+                heater->last_reported_temp = temp;
                 sr_requested = true;
             }
         }
 
-        heater_fan1.newTemp(temp);
+        if (sr_requested) {
+            rpt_post_event(RPT_EVENT_TEMPERATURE);
+        }
+    }
+    return (STAT_OK);
+}
+
 
-        if (pid2._enable) {
-            temp = thermistor2.temperature_exact();
-            fet_pin2 = pid2.getNewOutput(temp);
+/****************************************************************************************
+ * PID autotune cycle
+ *
+ * cm_autotune_cycle_start()    - start relay feedback tuning of one heater
+ * cm_autotune_cycle_callback() - main loop callback, ends the cycle
+ *
+ *  {heNtu:T} tunes heater N at T degrees C using the Astrom-Hagglund relay method. The
+ *  PID loop drives the heater full on or full off around T (see _autotune_relay()), which
+ *  settles into a steady oscillation. Its period Tu and half amplitude a give the ultimate
+ *  gain Ku = 4d / (pi * a) for a relay of amplitude d = 0.5 (output 0 to 1) around 0.5.
+ *
+ *  The classic Ziegler-Nichols PID gains follow: Kp = 0.6Ku, Ki = 1.2Ku/Tu, Kd = 0.075Ku*Tu.
+ *  The PID factors are per tick, so Ki is scaled by the PID period and Kd divided by it.
+ *  The gains are written and persisted through the heNp, heNi and heNd settings.
+ *
+ *  The autotune runs as a machine cycle so Gcode and other commands wait until it is done.
+ *  It is aborted by anything that ends the cycle, such as a job kill.
+ */
 
-            if (fabs(temp - last_reported_temp2) > kTempDiffSRTrigger) {
-                last_reported_temp2 = temp;
-                sr_requested = true;
-            }
-        }
+static void _autotune_restore()
+{
+    Heater *heater = autotune.heater;
+    autotune.heater = nullptr;
+    heater->pid._enable = autotune.saved_enable;
+    heater->pid._set_point = autotune.saved_set_point;
+    heater->output->write(0.0);
+    _update_enabled_heaters();
+}
 
-        if (pid3._enable) {
-            temp = thermistor3.temperature_exact();
-            fet_pin3 = pid3.getNewOutput(temp);
+static void _autotune_set_gain(const char *key, const float value)
+{
+    nvObj_t nv;
+    nv.group[0] = NUL;
+    sprintf(nv.token, "he%d%s", autotune.heater_number, key);
+    nv.index = nv_get_index((const char *)"", nv.token);
+    nv.value_flt = value;
+    nv_set(&nv);
+    nv_persist(&nv);
+}
 
-            if (fabs(temp - last_reported_temp3) > kTempDiffSRTrigger) {
-                last_reported_temp3 = temp;
-                sr_requested = true;
-            }
-        }
+static stat_t _autotune_exit(const stat_t status)
+{
+    _autotune_restore();
+    cm_canned_cycle_end();
+    if (status != STAT_OK) {
+        return (cm_alarm(status, "heater autotune failed"));
+    }
+    return (STAT_OK);
+}
 
-        if (sr_requested) {
-            sr_request_status_report(SR_REQUEST_TIMED);
-        }
+static stat_t _autotune_finish()
+{
+    float period = autotune.period_sum / autotune.cycles / 1000.0;    // Tu in seconds
+    float amplitude = autotune.amplitude_sum / autotune.cycles;
+    if ((period <= 0) || (amplitude <= 0)) {
+        return (_autotune_exit(STAT_TEMPERATURE_CONTROL_ERROR));
     }
+    float ku = (4 * 0.5) / (M_PI * amplitude);
+    float dt = TEMP_PID_PERIOD / 1000.0;
+    float p = 0.6 * ku;
+    float i = 1.2 * ku / period * dt;
+    float d = 0.075 * ku * period / dt;
+
+    _autotune_set_gain("p", p * 100.0);     // the setters take the JSON scale - see PID
+    _autotune_set_gain("i", i * 100.0);
+    _autotune_set_gain("d", d * 100.0);
+
+    char buffer[128];
+    sprintf(buffer, "{\"tune\":{\"he\":%d,\"ku\":%0.4f,\"tu\":%0.1f,\"p\":%0.3f,\"i\":%0.5f,\"d\":%0.5f}}\n",
+            autotune.heater_number, ku, period, p * 100.0, i * 100.0, d * 100.0);
+    xio_writeline(buffer);
+    return (_autotune_exit(STAT_OK));
+}
+
+stat_t cm_autotune_cycle_start(const uint8_t heater_number, const float target)
+{
+    ritorno(cm_is_alarmed());
+    if ((cm->machine_state == MACHINE_CYCLE) || !mp_runtime_is_idle() ||
+        (mp_get_planner_buffers(mp) != mp->q.queue_size)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    Heater *heater = _get_heater(heater_number);
+    if ((heater == nullptr) || (target < TEMP_OFF_BELOW) || (target > TEMP_MAX_SETPOINT)) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    autotune.heater_number = heater_number;
+    autotune.target = target;
+    autotune.saved_enable = heater->pid._enable;
+    autotune.saved_set_point = heater->pid._set_point;
+    autotune.heating = true;
+    autotune.timing = false;
+    autotune.status = STAT_OK;
+    autotune.temp_max = 0;
+    autotune.temp_min = TEMP_MAX_SETPOINT;
+    autotune.cycles = 0;
+    autotune.period_sum = 0;
+    autotune.amplitude_sum = 0;
+    autotune.timeout.set(TEMP_AUTOTUNE_TIMEOUT);
+
+    heater->pid._enable = true;
+    heater->pid._set_point = target;    // so heNst reports what is being tuned
+    autotune.heater = heater;
+    _update_enabled_heaters();
+
+    cm->machine_state = MACHINE_CYCLE;
+    cm->cycle_type = CYCLE_AUTOTUNE;
     return (STAT_OK);
 }
 
+stat_t cm_autotune_cycle_callback()
+{
+    if (autotune.heater == nullptr) {
+        return (STAT_NOOP);                 // exit if not tuning
+    }
+    if (cm->cycle_type != CYCLE_AUTOTUNE) { // the cycle was ended from outside, e.g. job kill
+        _autotune_restore();
+        return (STAT_NOOP);
+    }
+    if (autotune.status != STAT_OK) {
+        return (_autotune_exit(autotune.status));
+    }
+    if (autotune.cycles >= TEMP_AUTOTUNE_CYCLES) {
+        return (_autotune_finish());
+    }
+    if (autotune.timeout.isPast()) {
+        return (_autotune_exit(STAT_TEMPERATURE_CONTROL_ERROR));
+    }
+    return (STAT_EAGAIN);                   // hold off other commands while tuning
+}
+
 
 /********************************
  * END OF TEMPERATURE FUNCTIONS *
@@ -597,53 +975,77 @@ stat_t temperature_callback()
  * CONFIGURATION AND INTERFACE FUNCTIONS
  * Functions to get and set variables from the cfgArray table
  ***********************************************************************************/
-/*  In these function there are usually 3 PIDs, so a simple switch works.
- *  The default is a failsafe - can only get there if it's set up in config_app, but not here.
+/*  In these functions the heater is found from the group or token number. A heater number
+ *  outside 1..HEATERS is a failsafe - can only get there if it's set up in config_app, but not here.
  */
 
 // helpers 
 
-char _get_heater_number(nvObj_t *nv) {  // In these functions nv->group == "he1", "he2", or "he3"
+static Heater *_get_heater(const uint8_t heater) {   // heater is 1-based
+    if ((heater < 1) || (heater > HEATERS)) {
+        return (nullptr);
+    }
+    return (&heaters[heater-1]);
+}
+
+static uint8_t _get_heater_number(nvObj_t *nv) {   // In these functions nv->group == "he1", "he2", ...
     if (!nv->group[0]) {
-        return nv->token[2];
+        return (nv->token[2] - '0');
     }
-    return nv->group[2];
+    return (nv->group[2] - '0');
+}
+
+static Heater *_get_heater(nvObj_t *nv) {
+    return _get_heater(_get_heater_number(nv));
 }
 
-char _get_pid_number(nvObj_t *nv) { // In these functions, nv->group == "pid1", "pid2", or "pid3"
+static Heater *_get_pid_heater(nvObj_t *nv) { // In these functions, nv->group == "pid1", "pid2", ...
     if (!nv->group[0]) {
-        return nv->token[3];
+        return _get_heater(nv->token[3] - '0');
     }
-    return nv->group[3];
+    return _get_heater(nv->group[3] - '0');
+}
+
+static stat_t _get_heater_float(nvObj_t *nv, const float value) {
+    nv->value_flt = value;
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
 }
 
 /****************************************************************************************
  * cm_get_heater_enable() - get enable value
  * cm_set_heater_enable() - enable/disable heater
  *
- *  Enable is a boolean type so it's already been type and range checked before it gets here
+ *  Enable is a boolean type so it's already been type and range checked before it gets here.
+ *  A heater that is disabled is also turned off, as the PID loop no longer updates it.
  */
 
 stat_t cm_get_heater_enable(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_int = pid1._enable; break; }
-        case '2': { nv->value_int = pid2._enable; break; }
-        case '3': { nv->value_int = pid3._enable; break; }
-        default: { return(STAT_INPUT_VALUE_RANGE_ERROR); break; }
+    Heater *heater = _get_heater(nv);
+    if (heater == nullptr) {
+        return(STAT_INPUT_VALUE_RANGE_ERROR);
     }
+    nv->value_int = heater->pid._enable;
     nv->valuetype = TYPE_BOOLEAN;
     return (STAT_OK);
 }
 
 stat_t cm_set_heater_enable(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { pid1._enable = nv->value_int; break; }
-        case '2': { pid2._enable = nv->value_int; break; }
-        case '3': { pid3._enable = nv->value_int; break; }
-        default: { return(STAT_INPUT_VALUE_RANGE_ERROR); break; }
+    Heater *heater = _get_heater(nv);
+    if (heater == nullptr) {
+        return(STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    heater->pid._enable = nv->value_int;
+    if (!heater->pid._enable) {
+        heater->output->write(0.0);
+        if (heater->fan != nullptr) {
+            heater->fan->write(0.0);
+        }
     }
+    _update_enabled_heaters();
     return (STAT_OK);
 }
 
@@ -658,71 +1060,38 @@ stat_t cm_set_heater_enable(nvObj_t *nv)
 
 stat_t cm_get_heater_p(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {  // there are three of them, so we can use a simple switch
-        case '1': { nv->value_flt = pid1._p_factor * 100.0; break; }
-        case '2': { nv->value_flt = pid2._p_factor * 100.0; break; }
-        case '3': { nv->value_flt = pid3._p_factor * 100.0; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *heater = _get_heater(nv);
+    return (_get_heater_float(nv, (heater == nullptr) ? 0.0 : heater->pid._p_factor * 100.0));
 }
 stat_t cm_set_heater_p(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { pid1._p_factor = nv->value_flt / 100.0; break; }
-        case '2': { pid2._p_factor = nv->value_flt / 100.0; break; }
-        case '3': { pid3._p_factor = nv->value_flt / 100.0; break; }
-        default: { break; }
-    }
+    Heater *heater = _get_heater(nv);
+    if (heater != nullptr) { heater->pid._p_factor = nv->value_flt / 100.0; }
     return (STAT_OK);
 }
 
 stat_t cm_get_heater_i(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = pid1._i_factor * 100.0; break; }
-        case '2': { nv->value_flt = pid2._i_factor * 100.0; break; }
-        case '3': { nv->value_flt = pid3._i_factor * 100.0; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *heater = _get_heater(nv);
+    return (_get_heater_float(nv, (heater == nullptr) ? 0.0 : heater->pid._i_factor * 100.0));
 }
 
 stat_t cm_set_heater_i(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { pid1._i_factor = nv->value_flt / 100.0; break; }
-        case '2': { pid2._i_factor = nv->value_flt / 100.0; break; }
-        case '3': { pid3._i_factor = nv->value_flt / 100.0; break; }
-        default: { break; }
-    }
+    Heater *heater = _get_heater(nv);
+    if (heater != nullptr) { heater->pid._i_factor = nv->value_flt / 100.0; }
     return (STAT_OK);
 }
 
 stat_t cm_get_heater_d(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = pid1._d_factor * 100.0; break; }
-        case '2': { nv->value_flt = pid2._d_factor * 100.0; break; }
-        case '3': { nv->value_flt = pid3._d_factor * 100.0; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *heater = _get_heater(nv);
+    return (_get_heater_float(nv, (heater == nullptr) ? 0.0 : heater->pid._d_factor * 100.0));
 }
 stat_t cm_set_heater_d(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { pid1._d_factor = nv->value_flt / 100.0; break; }
-        case '2': { pid2._d_factor = nv->value_flt / 100.0; break; }
-        case '3': { pid3._d_factor = nv->value_flt / 100.0; break; }
-        default: { break; }
-    }
+    Heater *heater = _get_heater(nv);
+    if (heater != nullptr) { heater->pid._d_factor = nv->value_flt / 100.0; }
     return (STAT_OK);
 }
 
@@ -735,37 +1104,25 @@ stat_t cm_set_heater_d(nvObj_t *nv)
 
 float cm_get_set_temperature(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return pid1._set_point; break; }
-        case 2: { return pid2._set_point; break; }
-        case 3: { return pid3._set_point; break; }
-        default: { break; }
-    }
-    return 0.0;
+    Heater *h = _get_heater(heater);
+    return ((h == nullptr) ? 0.0 : h->pid._set_point);
 }
 
 stat_t cm_get_set_temperature(nvObj_t *nv)
 {
-    nv->value_flt = cm_get_set_temperature(_get_heater_number(nv) - '0');
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    return (_get_heater_float(nv, cm_get_set_temperature(_get_heater_number(nv))));
 }
 
 void cm_set_set_temperature(const uint8_t heater, const float value)
 {
-    switch(heater) {
-        case 1: { pid1._set_point = min(TEMP_MAX_SETPOINT, value); break; }
-        case 2: { pid2._set_point = min(TEMP_MAX_SETPOINT, value); break; }
-        case 3: { pid3._set_point = min(TEMP_MAX_SETPOINT, value); break; }
-
-        // default to quiet the compiler
-        default: { break; }
+    Heater *h = _get_heater(heater);
+    if (h != nullptr) {
+        h->pid._set_point = min(TEMP_MAX_SETPOINT, value);
     }
 }
 stat_t cm_set_set_temperature(nvObj_t *nv)
 {
-    cm_set_set_temperature(_get_heater_number(nv) - '0', nv->value_flt);
+    cm_set_set_temperature(_get_heater_number(nv), nv->value_flt);
     return (STAT_OK);
 }
 
@@ -774,38 +1131,32 @@ stat_t cm_set_set_temperature(nvObj_t *nv)
  * cm_set_fan_power() - set the set high-value setting of the heater fan
  */
 
+static HeaterFan *_get_fan(const uint8_t heater)
+{
+    Heater *h = _get_heater(heater);
+    return ((h == nullptr) ? nullptr : h->fan);
+}
+
 float cm_get_fan_power(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return min(1.0f, heater_fan1.max_value); }
-//      case 2: { return min(1.0f, heater_fan2.max_value); }
-//      case 3: { return min(1.0f, heater_fan3.max_value); }
-        default: { break; }
-    }
-    return 0.0;
+    HeaterFan *fan = _get_fan(heater);
+    return ((fan == nullptr) ? 0.0 : min(1.0f, fan->max_value));
 }
 
 stat_t cm_get_fan_power(nvObj_t *nv)
 {
-    nv->value_flt = cm_get_fan_power(_get_heater_number(nv) - '0');
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    return (_get_heater_float(nv, cm_get_fan_power(_get_heater_number(nv))));
 }
 
 void cm_set_fan_power(const uint8_t heater, const float value)
 {
-    switch(heater) {
-        case 1: { heater_fan1.max_value = max(0.0f, value); break; }
-//      case 2: { heater_fan2.max_value = max(0.0, value); break; }
-//      case 3: { heater_fan3.max_value = max(0.0, value); break; }
-        default: { break; }
-    }
+    HeaterFan *fan = _get_fan(heater);
+    if (fan != nullptr) { fan->max_value = max(0.0f, value); }
 }
 
 stat_t cm_set_fan_power(nvObj_t *nv)
 {
-    cm_set_fan_power(_get_heater_number(nv) - '0', nv->value_flt);
+    cm_set_fan_power(_get_heater_number(nv), nv->value_flt);
     return (STAT_OK);
 }
 
@@ -816,25 +1167,14 @@ stat_t cm_set_fan_power(nvObj_t *nv)
 
 stat_t cm_get_fan_min_power(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = heater_fan1.min_value; break; }
-//      case '2': { nv->value_flt = heater_fan2.min_value; break; }
-//      case '3': { nv->value_flt = heater_fan3.min_value; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    HeaterFan *fan = _get_fan(_get_heater_number(nv));
+    return (_get_heater_float(nv, (fan == nullptr) ? 0.0 : fan->min_value));
 }
 
 stat_t cm_set_fan_min_power(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { heater_fan1.max_value = min(0.0f, nv->value_flt); break; }
-//      case '2': { heater_fan2.min_value = min(0.0, nv->value_flt); break; }
-//      case '3': { heater_fan3.min_value = min(0.0, nv->value_flt); break; }
-        default: { break; }
-    }
+    HeaterFan *fan = _get_fan(_get_heater_number(nv));
+    if (fan != nullptr) { fan->max_value = min(0.0f, nv->value_flt); }
     return (STAT_OK);
 }
 
@@ -845,25 +1185,14 @@ stat_t cm_set_fan_min_power(nvObj_t *nv)
 
 stat_t cm_get_fan_low_temp(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = heater_fan1.low_temp; break; }
-//      case '2': { nv->value_flt = heater_fan2.low_temp; break; }
-//      case '3': { nv->value_flt = heater_fan3.low_temp; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }    
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    HeaterFan *fan = _get_fan(_get_heater_number(nv));
+    return (_get_heater_float(nv, (fan == nullptr) ? 0.0 : fan->low_temp));
 }
 
 stat_t cm_set_fan_low_temp(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { heater_fan1.low_temp = min(0.0f, nv->value_flt); break; }
-//      case '2': { heater_fan2.low_temp = min(0.0f, nv->value_flt); break; }
-//      case '3': { heater_fan3.low_temp = min(0.0f, nv->value_flt); break; }
-        default: { break; }
-    }
+    HeaterFan *fan = _get_fan(_get_heater_number(nv));
+    if (fan != nullptr) { fan->low_temp = min(0.0f, nv->value_flt); }
     return (STAT_OK);
 }
 
@@ -874,25 +1203,14 @@ stat_t cm_set_fan_low_temp(nvObj_t *nv)
 
 stat_t cm_get_fan_high_temp(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = heater_fan1.high_temp; break; }
-//      case '2': { nv->value_flt = heater_fan2.high_temp; break; }
-//      case '3': { nv->value_flt = heater_fan3.high_temp; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    HeaterFan *fan = _get_fan(_get_heater_number(nv));
+    return (_get_heater_float(nv, (fan == nullptr) ? 0.0 : fan->high_temp));
 }
 
 stat_t cm_set_fan_high_temp(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { heater_fan1.high_temp = min(0.0f, nv->value_flt); break; }
-//      case '2': { heater_fan2.high_temp = min(0.0f, nv->value_flt); break; }
-//      case '3': { heater_fan3.high_temp = min(0.0f, nv->value_flt); break; }
-        default: { break; }
-    }
+    HeaterFan *fan = _get_fan(_get_heater_number(nv));
+    if (fan != nullptr) { fan->high_temp = min(0.0f, nv->value_flt); }
     return (STAT_OK);
 }
 
@@ -902,18 +1220,13 @@ stat_t cm_set_fan_high_temp(nvObj_t *nv)
 
 bool cm_get_at_temperature(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return pid1._at_set_point; }
-        case 2: { return pid2._at_set_point; }
-        case 3: { return pid3._at_set_point; }
-        default: { break; }
-    }
-    return false;
+    Heater *h = _get_heater(heater);
+    return ((h == nullptr) ? false : h->pid._at_set_point);
 }
 
 stat_t cm_get_at_temperature(nvObj_t *nv)
 {
-    nv->value_int = cm_get_at_temperature(_get_heater_number(nv) - '0');
+    nv->value_int = cm_get_at_temperature(_get_heater_number(nv));
     nv->precision = GET_TABLE_WORD(precision);
     nv->valuetype = TYPE_BOOLEAN;
     return (STAT_OK);
@@ -925,21 +1238,13 @@ stat_t cm_get_at_temperature(nvObj_t *nv)
 
 float cm_get_heater_output(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return (float)fet_pin1; }
-        case 2: { return (float)fet_pin2; }
-        case 3: { return (float)fet_pin3; }
-        default: { break; }
-    }
-    return 0.0;
+    Heater *h = _get_heater(heater);
+    return ((h == nullptr) ? 0.0 : h->output->read());
 }
 
 stat_t cm_get_heater_output(nvObj_t *nv)
 {
-    nv->value_flt = cm_get_heater_output(_get_heater_number(nv) - '0');
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    return (_get_heater_float(nv, cm_get_heater_output(_get_heater_number(nv))));
 }
 
 /****************************************************************************************
@@ -948,15 +1253,18 @@ stat_t cm_get_heater_output(nvObj_t *nv)
 
 stat_t cm_get_heater_adc(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = (float)thermistor1.raw_adc_value; break; }
-        case '2': { nv->value_flt = (float)thermistor2.raw_adc_value; break; }
-        case '3': { nv->value_flt = (float)thermistor3.raw_adc_value; break; }
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *heater = _get_heater(nv);
+    return (_get_heater_float(nv, (heater == nullptr) ? 0.0 : heater->sensor->get_adc()));
+}
+
+/****************************************************************************************
+ * temperature_get_load() - get a heater's adc value as a fraction of full scale (see adaptive.h)
+ */
+
+float temperature_get_load(const uint8_t heater)
+{
+    Heater *h = _get_heater(heater);
+    return ((h == nullptr) ? 0.0 : h->sensor->get_load());
 }
 
 /****************************************************************************************
@@ -965,21 +1273,16 @@ stat_t cm_get_heater_adc(nvObj_t *nv)
 
 float cm_get_temperature(const uint8_t heater)
 {
-    switch(heater) {
-        case 1: { return (last_reported_temp1 = thermistor1.temperature_exact()); }
-        case 2: { return (last_reported_temp2 = thermistor2.temperature_exact()); }
-        case 3: { return (last_reported_temp3 = thermistor3.temperature_exact()); }
-        default: { break; }
+    Heater *h = _get_heater(heater);
+    if (h == nullptr) {
+        return 0.0;
     }
-    return 0.0;
+    return (h->last_reported_temp = h->sensor->temperature());
 }
 
 stat_t cm_get_temperature(nvObj_t *nv)
 {
-    nv->value_flt = cm_get_temperature(_get_heater_number(nv) - '0');
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    return (_get_heater_float(nv, cm_get_temperature(_get_heater_number(nv))));
 }
 
 /****************************************************************************************
@@ -988,18 +1291,26 @@ stat_t cm_get_temperature(nvObj_t *nv)
 
 stat_t cm_get_thermistor_resistance(nvObj_t *nv)
 {
-    switch(_get_heater_number(nv)) {
-        case '1': { nv->value_flt = thermistor1.get_resistance(); break; }
-        case '2': { nv->value_flt = thermistor2.get_resistance(); break; }
-        case '3': { nv->value_flt = thermistor3.get_resistance(); break; }
+    Heater *heater = _get_heater(nv);
+    return (_get_heater_float(nv, (heater == nullptr) ? 0.0 : heater->sensor->get_resistance()));
+}
 
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+
+/****************************************************************************************
+ * cm_get_heater_autotune() - get the temperature being tuned at, or 0 if not tuning
+ * cm_set_heater_autotune() - start an autotune of the heater at the given temperature
+ */
+
+stat_t cm_get_heater_autotune(nvObj_t *nv)
+{
+    Heater *heater = _get_heater(nv);
+    return (_get_heater_float(nv, ((heater != nullptr) && (heater == autotune.heater)) ? autotune.target : 0.0));
 }
 
+stat_t cm_set_heater_autotune(nvObj_t *nv)
+{
+    return (cm_autotune_cycle_start(_get_heater_number(nv), nv->value_flt));
+}
 
 /****************************************************************************************
  * cm_get_pid_p() - get the active P of the PID (read-only)
@@ -1009,47 +1320,20 @@ stat_t cm_get_thermistor_resistance(nvObj_t *nv)
 
 stat_t cm_get_pid_p(nvObj_t *nv)
 {
-    switch(_get_pid_number(nv)) {
-        case '1': { nv->value_flt = pid1._proportional; break; }
-        case '2': { nv->value_flt = pid2._proportional; break; }
-        case '3': { nv->value_flt = pid3._proportional; break; }
-
-            // Failsafe. We can only get here if we set it up in config_app, but not here.
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *heater = _get_pid_heater(nv);
+    return (_get_heater_float(nv, (heater == nullptr) ? 0.0 : heater->pid._proportional));
 }
 
 stat_t cm_get_pid_i(nvObj_t *nv)
 {
-    switch(_get_pid_number(nv)) {
-        case '1': { nv->value_flt = pid1._integral; break; }
-        case '2': { nv->value_flt = pid2._integral; break; }
-        case '3': { nv->value_flt = pid3._integral; break; }
-
-            // Failsafe. We can only get here if we set it up in config_app, but not here.
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *heater = _get_pid_heater(nv);
+    return (_get_heater_float(nv, (heater == nullptr) ? 0.0 : heater->pid._integral));
 }
 
 stat_t cm_get_pid_d(nvObj_t *nv)
 {
-    switch(_get_pid_number(nv)) {
-        case '1': { nv->value_flt = pid1._derivative; break; }
-        case '2': { nv->value_flt = pid2._derivative; break; }
-        case '3': { nv->value_flt = pid3._derivative; break; }
-
-            // Failsafe. We can only get here if we set it up in config_app, but not here.
-        default: { nv->value_flt = 0.0; break; }
-    }
-    nv->precision = GET_TABLE_WORD(precision);
-    nv->valuetype = TYPE_FLOAT;
-    return (STAT_OK);
+    Heater *heater = _get_pid_heater(nv);
+    return (_get_heater_float(nv, (heater == nullptr) ? 0.0 : heater->pid._derivative));
 }
 
 /***********************************************************************************
@@ -37,6 +37,9 @@ void   temperature_init();
 void   temperature_reset();
 stat_t temperature_callback();
 
+stat_t cm_autotune_cycle_start(const uint8_t heater, const float target);
+stat_t cm_autotune_cycle_callback();
+
 stat_t cm_get_heater_enable(nvObj_t *nv);
 stat_t cm_set_heater_enable(nvObj_t *nv);
 
@@ -46,6 +49,8 @@ stat_t cm_get_heater_i(nvObj_t* nv);
 stat_t cm_set_heater_i(nvObj_t* nv);
 stat_t cm_get_heater_d(nvObj_t* nv);
 stat_t cm_set_heater_d(nvObj_t* nv);
+stat_t cm_get_heater_autotune(nvObj_t* nv);
+stat_t cm_set_heater_autotune(nvObj_t* nv);
 stat_t cm_get_pid_p(nvObj_t* nv);
 stat_t cm_get_pid_i(nvObj_t* nv);
 stat_t cm_get_pid_d(nvObj_t* nv);
@@ -76,6 +81,7 @@ float cm_get_heater_output(const uint8_t heater);
 stat_t cm_get_heater_output(nvObj_t* nv);
 
 stat_t cm_get_heater_adc(nvObj_t* nv);
+float temperature_get_load(const uint8_t heater);
 
 float cm_get_temperature(const uint8_t heater);
 stat_t cm_get_temperature(nvObj_t* nv);
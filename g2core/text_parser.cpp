@@ -100,29 +100,38 @@ stat_t text_parser(char *str)
 static stat_t _text_parser_kernal(char *str, nvObj_t *nv)
 {
     char *rd, *wr;                              // read and write pointers
-//  char separators[] = {"="};                  // STRICT: only separator allowed is = sign
-    char separators[] = {" =:|\t"};             // RELAXED: any separator someone might use
+    char *sep = NULL;                           // first separator, if any
 
-    // pre-process and normalize the string
+    // pre-process and normalize the string, finding the separator in the same pass
+    // RELAXED separators: any of " =:|\t" someone might use (STRICT would be only =)
 //  nv_reset_nv(nv);                            // initialize config object (not required)
     nv_copy_string(nv, str);                    // make a copy for eventual reporting
     if (*str == '$') str++;                     // ignore leading $
-    for (rd = wr = str; *rd != NUL; rd++, wr++) {
-        *wr = tolower(*rd);                     // convert string to lower case
-        if (*rd == ',') { *wr = *(++rd);}       // skip over commas
+    for (rd = wr = str; *rd != NUL; rd++) {
+        char c = *rd;
+        if (c == ',') { continue; }             // skip over commas
+        if ((c >= 'A') && (c <= 'Z')) {         // convert string to lower case
+            c += 'a' - 'A';
+        }
+        if (sep == NULL) {
+            switch (c) {
+                case ' ': case '=': case ':': case '|': case '\t': { sep = wr; }
+            }
+        }
+        *wr++ = c;
     }
     *wr = NUL;                                  // terminate the string
 
     // parse fields into the nv struct
     nv->valuetype = TYPE_NULL;
-    if ((rd = strpbrk(str, separators)) == NULL) { // no value part
+    if (sep == NULL) {                          // no value part
         strncpy(nv->token, str, TOKEN_LEN);
     } else {
-        *rd = NUL;                              // terminate at end of name
+        *sep = NUL;                             // terminate at end of name
         strncpy(nv->token, str, TOKEN_LEN);
-        str = ++rd;
+        str = ++sep;
         nv->value_int = atol(str);              // collect the number as an integer
-        nv->value_flt = strtof(str, &rd);       // collect the number as a float - rd used as end pointer
+        nv->value_flt = strtofloat(str, &rd);   // collect the number as a float - rd used as end pointer
         if (rd != str) {
             nv->valuetype = TYPE_FLOAT;         // provisionally set it as a float
         }
@@ -145,9 +154,168 @@ static stat_t _text_parser_kernal(char *str, nvObj_t *nv)
     return (STAT_OK);
 }
 
+/************************************************************************************
+ * _text_format() - sprintf() for the text mode formats, without the stdio overhead
+ * _text_utoa()   - helper: unsigned integer to ASCII
+ * _text_ftoa()   - helper: float to ASCII at a fixed precision, as "%.Nf" would
+ *
+ *  Every setting read or write in text mode prints its value through one of the fmt_
+ *  strings, which use only %[-][0][width][.precision][l] with d, i, u, f, s or c, and %%.
+ *  These are done here with the arguments taken in order from args[]. The output is the
+ *  same as sprintf()'s, including round-half-even ties in the last float digit.
+ *
+ *  Returns false for anything it won't do - other conversions, an argument of the wrong
+ *  type, floats that are not finite or won't fit 32 bits, or output longer than len - so
+ *  the caller can fall back to sprintf().
+ */
+typedef struct txArg {
+    char type;                          // 'f' float, 'i' integer, 's' string
+    union {
+        float f;
+        int32_t i;
+        const char *s;
+    };
+} txArg_t;
+
+#define TEXT_NUMBER_LEN 24              // longest number _text_format() will produce
+
+static const uint32_t _text_pow10[] = { 1, 10, 100, 1000, 10000, 100000,
+                                        1000000, 10000000, 100000000, 1000000000 };
+
+static int _text_utoa(char *str, uint32_t n)
+{
+    char digits[10];
+    int len = 0;
+    do {
+        digits[len++] = '0' + (n % 10);
+        n /= 10;
+    } while (n);
+    for (int i = 0; i < len; i++) {
+        str[i] = digits[len-1-i];
+    }
+    return (len);
+}
+
+static int _text_ftoa(char *str, float n, int precision)
+{
+    if (!isfinite(n) || (fabs(n) >= 4.0e9) || (precision > 9)) {
+        return (-1);
+    }
+    char *p = str;
+    if (signbit(n)) {                   // printf keeps the sign of -0.0 and rounds-to-zero values
+        *p++ = '-';
+        n = -n;
+    }
+    uint32_t whole = (uint32_t)n;
+    double scaled = (double)(n - (float)whole) * _text_pow10[precision]; // exact in a double
+    uint32_t frac = (uint32_t)scaled;
+    double rem = scaled - frac;
+    if ((rem > 0.5) || ((rem == 0.5) && ((precision ? frac : whole) & 1))) {
+        if (++frac == _text_pow10[precision]) {
+            frac = 0;
+            whole++;
+        }
+    }
+    p += _text_utoa(p, whole);
+    if (precision) {
+        *p++ = '.';
+        for (int i = precision-1; i >= 0; i--) {
+            p[i] = '0' + (frac % 10);
+            frac /= 10;
+        }
+        p += precision;
+    }
+    return (p - str);
+}
+
+static bool _text_format(char *buf, int len, const char *format, const txArg_t *args, uint8_t count)
+{
+    char *out = buf;
+    char *end = buf + len - 1;          // leave room for the NUL
+    uint8_t a = 0;
+
+    for (const char *f = format; *f != NUL; f++) {
+        if ((*f != '%') || (*(++f) == '%')) {
+            if (out == end) { return (false); }
+            *out++ = *f;
+            continue;
+        }
+        bool left = false;
+        bool zero = false;
+        for (;; f++) {
+            if (*f == '-') { left = true; }
+            else if (*f == '0') { zero = true; }
+            else break;
+        }
+        int width = 0;
+        while (isdigit(*f)) { width = width*10 + (*f++ - '0'); }
+        int precision = -1;
+        if (*f == '.') {
+            precision = 0;
+            while (isdigit(*(++f))) { precision = precision*10 + (*f - '0'); }
+        }
+        while (*f == 'l') { f++; }
+        if (a == count) { return (false); }
+        const txArg_t *arg = &args[a++];
+
+        char num[TEXT_NUMBER_LEN];
+        const char *field = num;
+        int n;
+        switch (*f) {
+            case 'd': case 'i': case 'u': {
+                if ((arg->type != 'i') || (precision >= 0)) { return (false); }
+                uint32_t v = (uint32_t)arg->i;
+                n = 0;
+                if ((*f != 'u') && (arg->i < 0)) {
+                    num[n++] = '-';
+                    v = -v;
+                }
+                n += _text_utoa(num+n, v);
+                break;
+            }
+            case 'f': {
+                if (arg->type != 'f') { return (false); }
+                if ((n = _text_ftoa(num, arg->f, (precision < 0) ? 6 : precision)) < 0) { return (false); }
+                break;
+            }
+            case 's': {
+                if ((arg->type != 's') || zero) { return (false); }
+                field = arg->s;
+                for (n = 0; (field[n] != NUL) && ((precision < 0) || (n < precision)); n++);
+                break;
+            }
+            case 'c': {
+                if ((arg->type != 'i') || zero) { return (false); }
+                num[0] = (char)arg->i;
+                n = 1;
+                break;
+            }
+            default: { return (false); }
+        }
+        int pad = (width > n) ? width - n : 0;
+        if (out + n + pad > end) { return (false); }
+        if (left) {
+            memcpy(out, field, n);
+            memset(out + n, ' ', pad);
+        } else if (zero) {
+            int sign = (*field == '-') ? 1 : 0;
+            memcpy(out, field, sign);
+            memset(out + sign, '0', pad);
+            memcpy(out + sign + pad, field + sign, n - sign);
+        } else {
+            memset(out, ' ', pad);
+            memcpy(out + pad, field, n);
+        }
+        out += n + pad;
+    }
+    *out = NUL;
+    return (true);
+}
+
 /************************************************************************************
  * text_response() - text mode responses
  */
+static_assert(TEXT_RESPONSE_LEN <= NV_ARENA_RESERVE, "TEXT_RESPONSE_LEN must fit the nv arena reserve");
 static const char prompt_ok[] = "g2core[%s] ok> ";
 static const char prompt_err[] = "g2core[%s] err[%d]: %s: %s ";
 
@@ -157,7 +325,11 @@ void text_response(const stat_t status, char *buf)
          return;
     }
 
-    char buffer[128];
+    uint16_t mark = nv_arena_mark();
+    char *buffer = nv_arena_alloc(TEXT_RESPONSE_LEN, true);
+    if (buffer == nullptr) {
+        return;
+    }
     char *p = buffer;
 
     char units[] = "inch";
@@ -166,7 +338,12 @@ void text_response(const stat_t status, char *buf)
     }
 
     if ((status == STAT_OK) || (status == STAT_EAGAIN) || (status == STAT_NOOP)) {
-        p += sprintf(p, prompt_ok, (char *)units);
+        txArg_t arg = { 's', { .s = units } };
+        if (_text_format(p, TEXT_RESPONSE_LEN, prompt_ok, &arg, 1)) {
+            p += strlen(p);
+        } else {
+            p += sprintf(p, prompt_ok, (char *)units);
+        }
     } else {
         p += sprintf(p, prompt_err, (char *)units, (int)status, get_status_message(status), buf);
     }
@@ -177,6 +354,7 @@ void text_response(const stat_t status, char *buf)
     }
     sprintf(p, "\n");
     xio_writeline(buffer);
+    nv_arena_release(mark);
 }
 
 /***** PRINT FUNCTIONS ********************************************************
@@ -240,32 +418,48 @@ void text_print_nul(nvObj_t *nv, const char *string)
 
 void text_print_str(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, *nv->stringp);
+    txArg_t arg = { 's', { .s = *nv->stringp } };
+    if (!_text_format(cs.out_buf, OUTPUT_BUFFER_LEN, format, &arg, 1)) {
+        sprintf(cs.out_buf, format, *nv->stringp);
+    }
     xio_writeline(cs.out_buf);
 }
 
 void text_print_int(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, nv->value_int);
+    txArg_t arg = { 'i', { .i = nv->value_int } };
+    if (!_text_format(cs.out_buf, OUTPUT_BUFFER_LEN, format, &arg, 1)) {
+        sprintf(cs.out_buf, format, nv->value_int);
+    }
     xio_writeline(cs.out_buf);
 }
 
 void text_print_flt(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, nv->value_flt);
+    txArg_t arg = { 'f', { .f = nv->value_flt } };
+    if (!_text_format(cs.out_buf, OUTPUT_BUFFER_LEN, format, &arg, 1)) {
+        sprintf(cs.out_buf, format, nv->value_flt);
+    }
     xio_writeline(cs.out_buf);
 }
 
 void text_print_flt_units(nvObj_t *nv, const char *format, const char *units)
 {
-    sprintf(cs.out_buf, format, nv->value_flt, units);
+    txArg_t args[] = { { 'f', { .f = nv->value_flt } }, { 's', { .s = units } } };
+    if (!_text_format(cs.out_buf, OUTPUT_BUFFER_LEN, format, args, 2)) {
+        sprintf(cs.out_buf, format, nv->value_flt, units);
+    }
     xio_writeline(cs.out_buf);
 }
 
 void text_print_bool(nvObj_t *nv, const char *format)
 {
 //    sprintf(cs.out_buf, format, !!((uint32_t)nv->value)?"True":"False");
-    sprintf(cs.out_buf, format, (nv->value_int ? "True" : "False"));
+    const char *value = (nv->value_int ? "True" : "False");
+    txArg_t arg = { 's', { .s = value } };
+    if (!_text_format(cs.out_buf, OUTPUT_BUFFER_LEN, format, &arg, 1)) {
+        sprintf(cs.out_buf, format, value);
+    }
     xio_writeline(cs.out_buf);
 }
 
@@ -38,9 +38,10 @@ enum textFormats {              // text output print modes
     TEXT_MULTILINE_FORMATTED    // print formatted values on separate lines with formatted print per line
 };
 
+#define TEXT_RESPONSE_LEN 128   // prompt line, taken from the nv arena
+
 typedef struct txtSingleton {   // text mode data
 
-    char    format[NV_FORMAT_LEN + 1];
     uint8_t text_verbosity;     // see enum in this file for settings
 
 } txtSingleton_t;
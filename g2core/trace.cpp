@@ -0,0 +1,105 @@
+/*
+ * trace.cpp - RAM ring of recent motion segments for debugging
+ * This file is part of g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "controller.h"
+#include "trace.h"
+#include "util.h"
+#include "xio.h"
+
+#ifdef __SEGMENT_TRACE
+
+trTrace_t tr;
+
+/*
+ * tr_freeze_and_dump() - stop recording and start sending the trace
+ * trace_callback()     - send one trace line per pass through the main loop
+ */
+
+void tr_freeze_and_dump()
+{
+    tr.frozen = true;
+    tr.dump_seq = (tr.seq > SEGMENT_TRACE_SIZE) ? (tr.seq - SEGMENT_TRACE_SIZE) : 0;
+    tr.dump_pending = true;
+}
+
+stat_t trace_callback()
+{
+    if (!tr.dump_pending) {
+        return (STAT_NOOP);
+    }
+    if (tr.dump_seq >= tr.seq) {
+        tr.dump_pending = false;                // done - stay frozen until {trc:0}
+        return (STAT_OK);
+    }
+    trSegment_t *s = &tr.seg[tr.dump_seq++ & (SEGMENT_TRACE_SIZE-1)];
+    char *b = cs.out_buf;
+
+    b += sprintf(b, "{\"trc\":[%lu,%d,%0.3f,%0.1f,[", (unsigned long)s->seq, (int)s->section,
+                 (double)s->velocity, (double)(s->time * 60000000));
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        b += sprintf(b, (motor == 0) ? "%0.3f" : ",%0.3f", (double)s->travel_steps[motor]);
+    }
+    b += sprintf(b, "],[");
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        b += sprintf(b, (motor == 0) ? "%0.3f" : ",%0.3f", (double)s->following_error[motor]);
+    }
+    sprintf(b, "]]}\n");
+    xio_writeline(cs.out_buf);
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * tr_get() - return the number of segments held
+ * tr_set() - 0 clears the trace and resumes recording, anything else freezes and dumps it
+ */
+
+stat_t tr_get(nvObj_t *nv)
+{
+    return (get_integer(nv, (tr.seq > SEGMENT_TRACE_SIZE) ? SEGMENT_TRACE_SIZE : tr.seq));
+}
+
+stat_t tr_set(nvObj_t *nv)
+{
+    if (nv->value_int == 0) {
+        tr.frozen = true;                       // keep the exec ISR out while clearing
+        tr.dump_pending = false;
+        tr.seq = 0;
+        tr.frozen = false;
+    } else {
+        tr_freeze_and_dump();
+    }
+    return (tr_get(nv));
+}
+
+#endif  // __SEGMENT_TRACE
@@ -0,0 +1,106 @@
+/*
+ * trace.h - RAM ring of recent motion segments for debugging
+ * This file is part of g2core project
+ *
+ * Copyright (c) 2018 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * SEGMENT TRACE
+ *
+ *  Records the last SEGMENT_TRACE_SIZE segments produced by _exec_aline_segment() in a RAM
+ *  ring: section, segment velocity and time, and travel steps and following error per motor.
+ *  Recording is a short copy in the exec ISR. Nothing is sent until it is asked for, so the
+ *  trace does not change timing the way __PLANNER_DIAGNOSTICS does.
+ *
+ *    {trc:n}   returns the number of segments held
+ *    {trc:1}   freezes the trace and dumps it, oldest segment first, one line per segment:
+ *              {"trc":[seq,section,velocity,time_us,[travel_steps...],[following_error...]]}
+ *    {trc:0}   clears the trace and resumes recording
+ *
+ *  section is 0=head, 1=body, 2=tail. velocity is in mm/min. An alarm also freezes and
+ *  dumps the trace, so it holds the segments leading up to the alarm until cleared.
+ */
+
+#ifndef TRACE_H_ONCE
+#define TRACE_H_ONCE
+
+// The host simulator (board/sim) also writes every segment to its trace file
+#ifdef __SIMULATOR
+void sim_trace_segment(const uint8_t section, const float velocity, const float time, const float travel_steps[]);
+#define SIM_TRACE_SEGMENT(section, velocity, time, steps) sim_trace_segment(section, velocity, time, steps)
+#else
+#define SIM_TRACE_SEGMENT(section, velocity, time, steps)
+#endif
+
+#ifdef __SEGMENT_TRACE
+
+#define SEGMENT_TRACE_SIZE 32           // segments held - must be a power of 2
+
+typedef struct trSegment {
+    uint32_t seq;                       // segment number since the trace was cleared
+    uint8_t section;                    // moveSection
+    float velocity;                     // segment velocity
+    float time;                         // segment time in minutes
+    float travel_steps[MOTORS];         // steps commanded for the segment
+    float following_error[MOTORS];      // following error the segment was corrected for
+} trSegment_t;
+
+typedef struct trTrace {
+    trSegment_t seg[SEGMENT_TRACE_SIZE];
+    uint32_t seq;                       // segments recorded since cleared - next one goes in seg[seq % size]
+    volatile bool frozen;               // stop recording (dumping or holding an alarm trace)
+    bool dump_pending;                  // trace_callback() has lines to send
+    uint32_t dump_seq;                  // next segment to dump
+} trTrace_t;
+
+extern trTrace_t tr;
+
+inline void tr_record(const uint8_t section, const float velocity, const float time,
+                      const float travel_steps[], const float following_error[])
+{
+    if (tr.frozen) { return; }
+    trSegment_t *s = &tr.seg[tr.seq & (SEGMENT_TRACE_SIZE-1)];
+    s->seq = tr.seq++;
+    s->section = section;
+    s->velocity = velocity;
+    s->time = time;
+    memcpy(s->travel_steps, travel_steps, sizeof(s->travel_steps));
+    memcpy(s->following_error, following_error, sizeof(s->following_error));
+}
+
+#define TRACE_SEGMENT(section, velocity, time, steps, error) \
+    { tr_record(section, velocity, time, steps, error); SIM_TRACE_SEGMENT(section, velocity, time, steps); }
+
+void tr_freeze_and_dump(void);
+stat_t trace_callback(void);
+stat_t tr_get(nvObj_t *nv);
+stat_t tr_set(nvObj_t *nv);
+
+#else
+
+#define TRACE_SEGMENT(section, velocity, time, steps, error) SIM_TRACE_SEGMENT(section, velocity, time, steps)
+#define tr_freeze_and_dump()
+
+#endif  // __SEGMENT_TRACE
+
+#endif  // End of include guard: TRACE_H_ONCE
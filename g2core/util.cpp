@@ -218,6 +218,29 @@ uint16_t compute_checksum(char const *string, const uint16_t length)
     return (h % HASHMASK);
 }
 
+/*
+ * crc32()        - calculate the standard (zlib) CRC32 of a buffer
+ * crc32_update() - add one byte to a running CRC32 that's kept inverted (see util.h)
+ *
+ *  Pass the previous result as crc to continue a running CRC across buffers.
+ *  Table driven a nibble at a time - 64 bytes of table and two lookups per byte - so it's
+ *  cheap enough for the line checksum (see _verify_checksum()).
+ */
+
+const uint32_t crc32_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t crc32(const uint8_t *data, const uint16_t length, uint32_t crc)
+{
+    crc = ~crc;
+    for (uint16_t i=0; i<length; i++) {
+        crc = crc32_update(crc, data[i]);
+    }
+    return (~crc);
+}
+
 /*
  * SysTickTimer_getValue() - this is a hack to get around some compatibility problems
  */
@@ -292,6 +315,64 @@ int c_strreverse(char * const t, const int count_, char hold = 0) {
     : count_;
 }
 
+static const uint32_t _pow10_int[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+static const float _pow10_flt[] = { 1.0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10 };
+
+/*
+ * _floattoa_scaled() - fast path for floattoa()
+ *
+ *  Splits off the integer part (exact in float), scales the fraction to an integer count
+ *  of the last digit, rounds once, and prints both parts with integer divides. Returns -1
+ *  for values that won't fit 32 bits, leaving them to the digit loop in floattoa().
+ */
+
+static int _floattoa_scaled(char *str, float n, int precision, int maxlen)
+{
+    if ((precision > 9) || (n >= (float)4294967295.0)) {
+        return (-1);
+    }
+    uint32_t integer_part_ = (uint32_t)n;
+    uint32_t frac_part_ = (uint32_t)(((n - integer_part_) * _pow10_flt[precision]) + (float)0.5);
+    if (frac_part_ >= _pow10_int[precision]) {     // the fraction rounded up to the next integer
+        frac_part_ -= _pow10_int[precision];
+        integer_part_++;
+    }
+
+    char digits_[10];
+    int count_ = 0;
+    do {
+        uint32_t t_ = integer_part_ / 10;
+        digits_[count_++] = '0' + (integer_part_ - (t_*10));
+        integer_part_ = t_;
+    } while (integer_part_ > 0);
+
+    // strip trailing zeroes from the fraction before printing it
+    while ((precision > 0) && (frac_part_ % 10 == 0)) {
+        frac_part_ /= 10;
+        precision--;
+    }
+    int length_ = count_ + ((precision > 0) ? (precision + 1) : 0);
+    if (length_ > maxlen) {
+        *str = 0;
+        return 0;
+    }
+    char *b_ = str;
+    while (count_ > 0) {
+        *b_++ = digits_[--count_];
+    }
+    if (precision > 0) {
+        *b_++ = '.';
+        for (int i = precision-1; i >= 0; i--) {
+            uint32_t t_ = frac_part_ / 10;
+            b_[i] = '0' + (frac_part_ - (t_*10));
+            frac_part_ = t_;
+        }
+        b_ += precision;
+    }
+    *b_ = 0;
+    return length_;
+}
+
 char floattoa(char *str, float n, int precision, int maxlen /*= 16*/) // maxlen = 16
 {
     // handle special cases
@@ -312,6 +393,11 @@ char floattoa(char *str, float n, int precision, int maxlen /*= 16*/) // maxlen
         return floattoa(b_, -n, precision, maxlen-1) + 1;
     }
 
+    if ((length_ = _floattoa_scaled(str, n, precision, maxlen)) >= 0) {
+        return length_;
+    }
+    length_ = 0;
+
     n += round_lookup_[precision];
     int int_length_ = 0;
     int integer_part_ = (int)n;
@@ -366,6 +452,92 @@ char floattoa(char *str, float n, int precision, int maxlen /*= 16*/) // maxlen
     return length_;
 }
 
+/***********************************************************************************
+ * strtofloat() - ASCII to float, a faster strtof() for the parsers
+ *
+ *  Accepts optional leading spaces and sign, digits with an optional decimal point, and
+ *  an optional exponent. Up to 9 significant digits are accumulated as an integer and
+ *  scaled by an exact power of ten, so up to 7 digits the result is correctly rounded.
+ *  Longer mantissas are split at the decimal point so the integer part stays exact, which
+ *  keeps them within one unit of the last place.
+ *  Further digits are below float precision and only move the exponent.
+ *  Sets *end to the first character not used, or to str if there were no digits.
+ */
+
+float strtofloat(const char *str, char **end)
+{
+    const char *p = str;
+    bool negative = false;
+    uint32_t mantissa = 0;
+    uint8_t digits = 0;                             // significant digits in mantissa
+    int16_t exponent = 0;
+    bool has_digits = false;
+
+    while ((*p == ' ') || (*p == '\t')) {
+        p++;
+    }
+    if (*p == '-') {
+        negative = true;
+        p++;
+    } else if (*p == '+') {
+        p++;
+    }
+    for (; isdigit(*p); p++) {
+        has_digits = true;
+        if (digits < 9) {
+            mantissa = (mantissa * 10) + (*p - '0');
+            if (mantissa != 0) { digits++; }
+        } else {
+            exponent++;
+        }
+    }
+    if (*p == '.') {
+        for (p++; isdigit(*p); p++) {
+            has_digits = true;
+            if (digits < 9) {
+                mantissa = (mantissa * 10) + (*p - '0');
+                if (mantissa != 0) { digits++; }
+                exponent--;
+            }
+        }
+    }
+    if (!has_digits) {
+        if (end != NULL) { *end = (char *)str; }
+        return (0);
+    }
+    if ((*p == 'e') || (*p == 'E')) {
+        const char *q = p+1;
+        bool exp_negative = (*q == '-');
+        if ((*q == '-') || (*q == '+')) {
+            q++;
+        }
+        if (isdigit(*q)) {
+            int16_t e = 0;
+            for (; isdigit(*q); q++) {
+                if (e < 100) { e = (e * 10) + (*q - '0'); }
+            }
+            exponent += exp_negative ? -e : e;
+            p = q;
+        }
+    }
+    if (end != NULL) { *end = (char *)p; }
+
+    float value;
+    if ((exponent < 0) && (exponent >= -9) && (mantissa > (1UL << 24))) { // too many bits for one rounding - split at the decimal point
+        uint32_t integer = mantissa / _pow10_int[-exponent];
+        value = (float)integer + ((float)(mantissa - (integer * _pow10_int[-exponent])) / _pow10_flt[-exponent]);
+    } else if (exponent < 0) {
+        value = (float)mantissa;
+        for (; exponent < -10; exponent += 10) { value /= _pow10_flt[10]; }
+        value /= _pow10_flt[-exponent];
+    } else {
+        value = (float)mantissa;
+        for (; exponent > 10; exponent -= 10) { value *= _pow10_flt[10]; }
+        value *= _pow10_flt[exponent];
+    }
+    return (negative ? -value : value);
+}
+
 /***********************************************************************************
  * inttoa() - integer to ASCII
  *
@@ -95,7 +95,16 @@ float max4(float x1, float x2, float x3, float x4);
 uint8_t isnumber(char c);
 char *escape_string(char *dst, char *src);
 uint16_t compute_checksum(char const *string, const uint16_t length);
+uint32_t crc32(const uint8_t *data, const uint16_t length, uint32_t crc = 0);
+
+extern const uint32_t crc32_nibble[16];
+inline uint32_t crc32_update(uint32_t crc, const uint8_t c) {  // one byte of a running (inverted) CRC32
+    crc ^= c;
+    crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+    return ((crc >> 4) ^ crc32_nibble[crc & 0x0F]);
+}
 char floattoa(char *buffer, float in, int precision, int maxlen = 16);
+float strtofloat(const char *str, char **end);
 char inttoa(char *str, int n);
 
 //*** other utilities ***
@@ -114,7 +123,9 @@ using std::max;
 template <typename T>
 inline T square(const T x) { return (x)*(x); }        /* UNSAFE */
 
+#ifndef __SIMULATOR                    // the host C++ library already has abs(float)
 inline float abs(const float a) { return fabs(a); }
+#endif
 
 #ifndef avg
 template <typename T>
@@ -196,6 +207,43 @@ constexpr float c_atof(char *&p_) { return (*p_ == '-') ? (c_atof_int_(++p_, 0)
 //    return count_>1 ? (hold=*t, *t=*(t+(count_-1)), *(t+(count_-1))=hold), c_strreverse(t+1, count_-2), count_ : count_;
 //}
 
+/*** Cycle counting ***
+ *
+ * cycle_counter_init() - enable the Cortex-M DWT cycle counter
+ * cycle_count()        - return the free-running CPU cycle count
+ * cycles_to_usec()     - convert a cycle count to microseconds
+ *
+ *  The DWT counter runs at the core clock and costs a single load to read, so it is cheap
+ *  enough to bracket ISR work. It wraps every ~50 seconds at 84 MHz; take differences of
+ *  two readings as uint32_t and wrap-around is harmless. The M7 needs its lock cleared first.
+ */
+inline void cycle_counter_init() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#if (__CORTEX_M == 0x07)
+    DWT->LAR = 0xC5ACCE55;
+#endif
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+inline uint32_t cycle_count() { return (DWT->CYCCNT); }
+
+inline float cycles_to_usec(const uint32_t cycles) { return ((float)cycles * (1000000.0 / SystemCoreClock)); }
+
+/*** Cache line alignment ***
+ *
+ * CACHE_ALIGNED - align a structure used by the step and exec interrupts to a D-cache line
+ *
+ *  The Cortex-M7 (SAMS70) has a 32 byte D-cache line. Aligning the stepper and runtime
+ *  structures keeps their leading fields in lines of their own rather than sharing them with
+ *  whatever the linker put before them. The M3 has no D-cache so this is a no-op there.
+ */
+#if (__CORTEX_M == 0x07)
+#define CACHE_ALIGNED alignas(32)
+#else
+#define CACHE_ALIGNED
+#endif
+
 /*** Debug and DIAGNOSTICS  ***
  *
  *  This section collects debug and DIAGNOSTIC functions used by the project. 
@@ -38,9 +38,45 @@
 #include "controller.h"
 #include "util.h"
 #include "settings.h"
+#include "eta.h"
+#include "cpuload.h"
+#include "capture.h"
 
 #include "board_xio.h"
 
+// Buffer sizes not set by the board. RX and TX sizes must be powers of 2.
+#ifndef XIO_USB_RX_BUFFER_SIZE
+#define XIO_USB_RX_BUFFER_SIZE      1024    // RX ring for each USB serial port
+#endif
+#ifndef XIO_USB_TX_BUFFER_SIZE
+#define XIO_USB_TX_BUFFER_SIZE      1024    // TX ring for each USB serial port
+#endif
+#ifndef XIO_UART_RX_BUFFER_SIZE
+#define XIO_UART_RX_BUFFER_SIZE     1024
+#endif
+#ifndef XIO_UART_TX_BUFFER_SIZE
+#define XIO_UART_TX_BUFFER_SIZE     1024
+#endif
+#ifndef XIO_NET_RX_BUFFER_SIZE
+#define XIO_NET_RX_BUFFER_SIZE      1024    // RX ring for each network client
+#endif
+#ifndef XIO_NET_TX_BUFFER_SIZE
+#define XIO_NET_TX_BUFFER_SIZE      1024
+#endif
+#ifndef XIO_LINE_BUFFER_SIZE
+#define XIO_LINE_BUFFER_SIZE        RX_BUFFER_SIZE  // longest line returned - longer lines are split
+#endif
+static_assert(XIO_LINE_BUFFER_SIZE <= RX_BUFFER_SIZE, "XIO_LINE_BUFFER_SIZE can't exceed RX_BUFFER_SIZE");
+#ifndef XIO_TX_PACKET_SIZE
+#define XIO_TX_PACKET_SIZE          64      // TX coalescing packet - a full speed USB bulk packet
+#endif
+#ifndef XIO_TX_COALESCE_US
+#define XIO_TX_COALESCE_US          500     // longest a partial packet is held
+#endif
+
+xioStats_t xio_stats;
+uint8_t xio_tx_coalesce = XIO_TX_COALESCE;
+
 #include "MotateBuffer.h"
 using Motate::RXBuffer;
 using Motate::TXBuffer;
@@ -114,6 +150,7 @@ struct xioDeviceWrapperBase {                // C++ base class for device primit
 
     bool isAlwaysDataAndCtrl() { return caps & DEV_IS_ALWAYS_BOTH; }
     bool isMuteAsSecondary() { return caps & DEV_IS_MUTE_SECONDARY; }
+    bool isBinary() { return caps & DEV_IS_BINARY; }
 
     bool isConnected() { return flags & DEV_IS_CONNECTED; }
     bool isNotConnected() { return !(flags & DEV_IS_CONNECTED); }
@@ -166,6 +203,12 @@ struct xioDeviceWrapperBase {                // C++ base class for device primit
     virtual int16_t write(const char *buffer, int16_t len) { return -1; };
 
     virtual char *readline(devflags_t limit_flags, uint16_t &size) { return nullptr; };
+    virtual uint16_t readBytes(char *buffer, uint16_t size) { return 0; };
+    virtual uint16_t rxSpace() { return 0; };
+    virtual uint16_t bufferBytes() { return 0; };   // RAM taken by this device's buffers
+    virtual void sniff() {};                        // look for priority controls - called from SysTick
+    virtual void txCallback(bool now) {};           // pass on a held TX packet that has waited long enough
+    virtual bool rxPending() { return false; };     // there is input that a readline() could act on
 
 #if MARLIN_COMPAT_ENABLED == true
     virtual void exitFakeBootloaderMode() {};
@@ -197,7 +240,8 @@ struct xio_t {
 
     bool othersConnected(xioDeviceWrapperBase* except) {
         for (int8_t i = 0; i < _dev_count; ++i) {
-            if((DeviceWrappers[i] != except) && (!DeviceWrappers[i]->isAlwaysDataAndCtrl()) && DeviceWrappers[i]->isConnected()) {
+            if((DeviceWrappers[i] != except) && (!DeviceWrappers[i]->isAlwaysDataAndCtrl()) &&
+               (!DeviceWrappers[i]->isBinary()) && DeviceWrappers[i]->isConnected()) {
                 return true;
             }
         }
@@ -398,6 +442,102 @@ struct xio_t {
     };
 #endif
 
+    /*
+     * readBinary()  - read raw bytes from the binary channel, returns the number read
+     * writeBinary() - write raw bytes to the binary channel
+     *
+     *  Only a device constructed with DEV_IS_BINARY carries the binary channel. It never takes
+     *  a CTRL or DATA role, so readline() and write() do not see it.
+     */
+    uint16_t readBinary(char *buffer, uint16_t size)
+    {
+        for (uint8_t dev=0; dev < _dev_count; dev++) {
+            if (DeviceWrappers[dev]->isBinary() && DeviceWrappers[dev]->isConnected()) {
+                return DeviceWrappers[dev]->readBytes(buffer, size);
+            }
+        }
+        return 0;
+    };
+
+    /*
+     * txCallback() - pass on held TX packets that have waited XIO_TX_COALESCE_US, or all of them if now
+     */
+    void txCallback(bool now)
+    {
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            DeviceWrappers[i]->txCallback(now);
+        }
+    };
+
+    /*
+     * sniff() - move newly arrived single character controls into each device's priority lane
+     */
+    void sniff()
+    {
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            DeviceWrappers[i]->sniff();
+        }
+    };
+
+    /*
+     * rxPending() - true if any device has input to act on
+     */
+    bool rxPending()
+    {
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            if (DeviceWrappers[i]->rxPending()) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    /*
+     * bufferBytes() - RAM taken by all device buffers
+     */
+    uint32_t bufferBytes()
+    {
+        uint32_t bytes = 0;
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            bytes += DeviceWrappers[i]->bufferBytes();
+        }
+        return bytes;
+    };
+
+    /*
+     * rxSpace() - bytes the active data device can still receive without overrunning
+     */
+    uint16_t rxSpace()
+    {
+        for (uint8_t dev=0; dev < _dev_count; dev++) {
+            if (DeviceWrappers[dev]->isDataAndActive()) {
+                return DeviceWrappers[dev]->rxSpace();
+            }
+        }
+        return 0;
+    };
+
+    size_t writeBinary(const char *buffer, size_t size)
+    {
+        size_t total_written = 0;
+        for (uint8_t dev=0; dev < _dev_count; dev++) {
+            if (DeviceWrappers[dev]->isBinary() && DeviceWrappers[dev]->isConnected()) {
+                const char *buf = buffer;
+                int16_t to_write = size;
+                while (to_write > 0) {
+                    int16_t written = DeviceWrappers[dev]->write(buf, to_write);
+                    if (written < 0) {
+                        break;                  // disconnected
+                    }
+                    buf += written;
+                    to_write -= written;
+                    total_written += written;
+                }
+            }
+        }
+        return total_written;
+    };
+
     uint16_t magic_end;
 };
 
@@ -450,6 +590,39 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
 
     bool _last_returned_a_control = false;
 
+    uint32_t _full_since = 0;           // SysTick when the buffer was seen full, 0 if it isn't
+
+    uint16_t _view_end;                 // offset just past the line last returned in place
+    bool     _view_pending = false;     // true while that line is still in use - _read_offset is held at it
+
+    /*
+     * PRIORITY LANE
+     *
+     *  Single character controls (! ~ % ENQ ^D ^X) don't wait for _scanBuffer() to reach them.
+     *  sniff() runs from the SysTick interrupt (and from readline()) over the characters that
+     *  have arrived since it last ran. It tracks line starts the same way the scanner does,
+     *  and queues each control at the start of a line here with the offset just past it.
+     *  readline() returns queued controls before anything else, so hold latency doesn't grow
+     *  with how much data is buffered ahead of the '!'.
+     *
+     *  The scanner never goes past _sniff_offset, so every control has been queued by the time
+     *  the scanner sees it; the scanner then just steps over it. A flush to the command
+     *  (% and ^D) discards up to the offset queued with the control.
+     */
+    struct PriorityControl {
+        char c;
+        uint16_t offset;                // offset just past the control character
+    };
+    static constexpr uint8_t _priority_count = 8;                   // must be 2^N
+    volatile PriorityControl _priority[_priority_count];
+    volatile uint8_t _priority_write_idx = 0;   // written by sniff()
+    volatile uint8_t _priority_read_idx = 0;    // written by readline()
+    volatile uint16_t _sniff_offset = 0;        // next character sniff() will look at
+    volatile bool _sniff_at_start_of_line = true;
+    volatile bool _sniffing = false;            // set while the main loop is in sniff() or resetting it
+    uint16_t _flush_offset;                     // offset queued with the last control returned from the lane
+    bool     _flush_from_lane = false;          // the last control returned came from the lane
+
 #if MARLIN_COMPAT_ENABLED == true
     enum class STK500V2_State {
         Done,      // not in the faked stk500v2 bootloader
@@ -555,7 +728,106 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
     }
 
     bool _isMoreToScan() {
-        return _canBeRead(_scan_offset);
+        return ((_scan_offset != _sniff_offset) && _canBeRead(_scan_offset));
+    };
+
+    static bool _isPriorityControl(const char c) {
+        return ((c == '!')         ||       // feedhold
+                (c == '~')         ||       // cycle start
+                (c == ENQ)         ||       // request ENQ/ack
+                (c == CHAR_RESET)  ||       // ^X - reset (aka cancel, terminate)
+                (c == CHAR_ALARM)  ||       // ^D - request job kill (end of transmission)
+                (c == '%' && cm_has_hold()) // flush (only in feedhold or part of control header)
+                );
+    };
+
+    /*
+     * sniff() - queue the single character controls among the characters that arrived since the last call
+     *
+     *  Called from the SysTick interrupt, and from readline() through _sniffNow(). The interrupt
+     *  skips its turn if it lands while the main loop is in here.
+     */
+    void sniff() {
+        uint16_t write_offset = _getWriteOffset();
+        uint16_t offset = _sniff_offset;
+        while (offset != write_offset) {
+            char c = _data[offset];
+            uint16_t next = (offset+1)&(_size-1);
+#if MARLIN_COMPAT_ENABLED == true
+            if (_stk_parser_state != STK500V2_State::Done) {
+                // the stk500v2 parser sees everything in bootloader mode
+            } else
+#endif
+            if ((c == '\r') || (c == '\n')) {
+                _sniff_at_start_of_line = true;
+            }
+            else if (_sniff_at_start_of_line && _isPriorityControl(c)) {
+                uint8_t write_idx = _priority_write_idx;
+                uint8_t next_idx = (write_idx+1)&(_priority_count-1);
+                if (next_idx == _priority_read_idx) {
+                    break;                  // lane is full - pick this one up on a later pass
+                }
+                _priority[write_idx].c = c;
+                _priority[write_idx].offset = next;
+                _priority_write_idx = next_idx;
+            }
+            else {
+                _sniff_at_start_of_line = false;
+            }
+            offset = next;
+        }
+        _sniff_offset = offset;
+    };
+
+    void _sniffNow() {
+        _sniffing = true;
+        sniff();
+        _sniffing = false;
+    };
+
+    void sniffFromInterrupt() {
+        if (!_sniffing) {
+            sniff();
+        }
+    };
+
+    // restart the sniffer at offset with an empty lane
+    void _resetSniff(uint16_t offset) {
+        _sniffing = true;
+        _sniff_offset = offset;
+        _sniff_at_start_of_line = true;
+        _priority_read_idx = _priority_write_idx;
+        _sniffing = false;
+    };
+
+    // SWAR byte tests - true if any byte in the word is zero, or is the character c
+    static bool _hasZeroByte(const uint32_t v) { return (((v - 0x01010101) & ~v & 0x80808080) != 0); }
+    static bool _hasByte(const uint32_t v, const char c) { return (_hasZeroByte(v ^ (0x01010101 * (uint8_t)c))); }
+
+    /*
+     * _scanWords() - skip through the middle of a line 4 characters at a time
+     *
+     *  Past the first character of a line only line ends, NULs and the line length matter
+     *  (single character controls are only recognized at the start of a line), so whole
+     *  words that have none of those are skipped without the per-character classification.
+     *  It stops at the first word that has one, and _scanBuffer() takes it from there.
+     */
+    void _scanWords() {
+        if (_at_start_of_line || _ignore_until_next_line) {
+            return;
+        }
+        uint16_t write_offset = _sniff_offset;
+        while ((((write_offset - _scan_offset) & (_size-1)) >= 4) &&
+               ((_scan_offset + 4) <= _size) &&
+               ((_last_line_length + 4) < (_line_buffer_size - 1))) {
+            uint32_t word;
+            memcpy(&word, &_data[_scan_offset], sizeof(word));
+            if (_hasZeroByte(word) || _hasByte(word, '\r') || _hasByte(word, '\n')) {
+                return;
+            }
+            _scan_offset = (_scan_offset + 4) & (_size-1);
+            _last_line_length += 4;
+        }
     };
 
     /*
@@ -628,6 +900,15 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
     bool _scanBuffer() {
         _last_scan_offset = _scan_offset;
         while (_isMoreToScan()) {
+#if MARLIN_COMPAT_ENABLED == true
+            if (_stk_parser_state == STK500V2_State::Done)
+#endif
+            {
+                _scanWords();
+                if (!_isMoreToScan()) {
+                    break;
+                }
+            }
             bool ends_line  = false;
             bool is_control = false;
             char c = _data[_scan_offset];
@@ -729,22 +1010,20 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
             {
                 // don't do anything
             }
-            // Classify the line if it's a single character 
-            else if (_at_start_of_line &&
-                ((c == '!')         ||      // feedhold
-                 (c == '~')         ||      // cycle start
-                 (c == ENQ)         ||      // request ENQ/ack
-                 (c == CHAR_RESET)  ||      // ^X - reset (aka cancel, terminate)
-                 (c == CHAR_ALARM)  ||      // ^D - request job kill (end of transmission)
-                 (c == '%' && cm_has_hold()) // flush (only in feedhold or part of control header)
-                ))
+            // Single character controls were already queued in the priority lane by sniff(),
+            // so step over them. They mustn't end up at the front of the next line.
+            else if (_at_start_of_line && _isPriorityControl(c))
             {
-
-                _line_start_offset = _scan_offset;
-
-                // single-character control
-                is_control = true;
-                ends_line  = true;
+                uint16_t next = _getNextScanOffset();
+                if (_read_offset == _scan_offset) {
+                    _read_offset = next;            // nothing unread ahead of it
+                } else if (_skip_sections.isFull()) {
+                    break;                          // come back once some lines have been read
+                } else {
+                    _skip_sections.addSkip(_scan_offset, next);
+                }
+                _scan_offset = next;
+                continue;
             }
             else {
                 if (_at_start_of_line) {
@@ -792,6 +1071,7 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
             } // if ends_line
             else if (_last_line_length == (_line_buffer_size - 1)) {
                 // force an end-of-line, splitting this line into two lines
+                xio_stats.lines_too_long++;
                 _ignore_until_next_line = true;
                 _line_start_offset = _scan_offset;
                 _lines_found++;
@@ -819,6 +1099,24 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
      * If the control was the first char of the buffer it also moves the _data_offset, marking it as read
      */
     char *readline(bool control_only, uint16_t &line_size) {
+        _releaseView();
+        _trackFull();
+        _sniffNow();
+
+        // priority controls go first, whatever else is buffered
+        if (_priority_read_idx != _priority_write_idx) {
+            volatile PriorityControl &control = _priority[_priority_read_idx];
+            _line_buffer[0] = control.c;
+            _line_buffer[1] = 0;
+            line_size = 1;
+            _flush_offset = control.offset;
+            _priority_read_idx = (_priority_read_idx+1)&(_priority_count-1);
+            _last_returned_a_control = true;
+            _flush_from_lane = true;
+            return _line_buffer;
+        }
+        _flush_from_lane = false;
+
         // This is tricky: if we don't have room for more skip_sections, then we
         // can't scan any more for controls. So we don't scan, amd hope some lines are read.
         bool found_control = _skip_sections.isFull() ? false : _scanBuffer();
@@ -914,6 +1212,25 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
             c = _data[_read_offset];
         }
 
+        // If the line is contiguous in _data (it usually is) we don't copy it. The terminator is
+        // replaced with a NUL in place and a pointer into _data is returned. _read_offset stays at
+        // the start of the line until the next call, so the transfer can't write over it while the
+        // caller is parsing it. Lines that wrap, or are too long, are copied into _line_buffer.
+        uint16_t view_limit = std::min((uint32_t)_size, (uint32_t)_read_offset + (_line_buffer_size - 1));
+        uint16_t end = _read_offset;
+        while ((end < view_limit) && (_data[end] != '\r') && (_data[end] != '\n')) {
+            end++;
+        }
+        if (end < view_limit) {
+            char *line = (char *)&_data[_read_offset];
+            line_size = end - _read_offset;
+            _data[end] = 0;
+            _view_end = (end+1)&(_size-1);
+            _view_pending = true;
+            --_lines_found;
+            return line;
+        }
+
         while (line_size < (_line_buffer_size - 1)) {
             _read_offset = (_read_offset+1)&(_size-1);
 
@@ -947,16 +1264,75 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
     }; // readline
 
 
+    /*
+     * readBytes() - copy up to size raw bytes out of the buffer, for the binary channel
+     *
+     *  No line scanning is done, so it must not be mixed with readline() on the same device.
+     */
+    uint16_t readBytes(char *buffer, uint16_t size) {
+        _releaseView();
+        _trackFull();
+        uint16_t count = 0;
+        while ((count < size) && _canBeRead(_read_offset)) {
+            buffer[count++] = _data[_read_offset];
+            _read_offset = (_read_offset+1)&(_size-1);
+        }
+        _scan_offset = _read_offset;
+        _line_start_offset = _read_offset;
+        _restartTransfer();
+        return count;
+    };
+
+    // bytes that can arrive before the buffer is full - lines scanned but not yet read still take space
+    uint16_t space() {
+        return ((_read_offset - _getWriteOffset() - 1) & (_size-1));
+    };
+
+    // true if there's anything readline() could act on: a queued control, a complete line, or characters
+    // not yet scanned. A partial line that has already been scanned doesn't count.
+    bool hasPending() {
+        return ((_priority_read_idx != _priority_write_idx) || (_lines_found > 0) ||
+                _isMoreToScan() || (_sniff_offset != _getWriteOffset()));
+    };
+
+    // true if there are unread bytes, for the binary channel
+    bool hasBytes() {
+        return (_canBeRead(_read_offset));
+    };
+
+    // let the space under the line last returned in place be reused
+    void _releaseView() {
+        if (_view_pending) {
+            _read_offset = _view_end;
+            _view_pending = false;
+        }
+    };
+
+    // accumulate the time the buffer spends full, when the host is stalled by flow control
+    void _trackFull() {
+        if (space() == 0) {
+            if (_full_since == 0) {
+                _full_since = SysTickTimer_getValue() | 1;
+            }
+        } else if (_full_since != 0) {
+            xio_stats.rx_full_ms += SysTickTimer_getValue() - _full_since;
+            _full_since = 0;
+        }
+    };
+
     // this is called from flushRead()
     void flush() {
+        _view_pending = false;
         parent_type::flush();
         _scan_offset = _read_offset;
+        _resetSniff(_read_offset);
 
         // This is similar to the % "queue flush" handling above, except we flush
         // the scan to the to the read (which was just set tot he write by the parent),
         // not the other way around.
 
         // record that we have 0 lines (of data) in the buffer
+        xio_stats.lines_dropped += _lines_found;
         _lines_found = 0;
 
         // and clear out any skip sections we have
@@ -984,10 +1360,23 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
         // we haven't scanned yet, beyond where we got the command we want to
         // flush to.
 
-        // move the read buffer up to where we ended scanning
-        _read_offset = _scan_offset;
+        // move the read buffer up to where we ended scanning - or, for a control from the
+        // priority lane, to just past the control, and scan again from there
+        _view_pending = false;
+        if (_flush_from_lane) {
+            _read_offset = _flush_offset;
+            _scan_offset = _flush_offset;
+            _line_start_offset = _flush_offset;
+            _at_start_of_line = true;
+            _ignore_until_next_line = false;
+            _last_line_length = 0;
+            _flush_from_lane = false;
+        } else {
+            _read_offset = _scan_offset;
+        }
 
         // record that we have 0 lines (of data) in the buffer
+        xio_stats.lines_dropped += _lines_found;
         _lines_found = 0;
 
         // and clear out any skip sections we have
@@ -1016,13 +1405,16 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
  *     void setConnectionCallback(std::function<void(bool)> &&callback)
  */
 
-template<typename Device>
+template<typename Device, uint16_t _rx_size, uint16_t _tx_size, uint16_t _line_size = XIO_LINE_BUFFER_SIZE>
 struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for reading and writing
     Device _dev;
 
-    // TODO - make _buffer_size, _header_count, and _line_buffer_size configurable
-    LineRXBuffer<1024, Device> _rx_buffer;
-    TXBuffer<1024, Device> _tx_buffer;
+    LineRXBuffer<_rx_size, Device, 8, _line_size> _rx_buffer;
+    TXBuffer<_tx_size, Device> _tx_buffer;
+
+    char _tx_pack[XIO_TX_PACKET_SIZE];              // small writes held to fill a packet - see xioStats
+    uint16_t _tx_pack_len = 0;
+    uint32_t _tx_pack_start;                        // cycle count when the first byte was held
 
     xioDeviceWrapper(Device dev, uint8_t _caps) : xioDeviceWrapperBase(_caps), _dev{dev}, _rx_buffer{_dev}, _tx_buffer{_dev}
     {
@@ -1041,6 +1433,7 @@ struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for re
     };
 
     void flush() final {
+        _tx_pack_len = 0;
         _tx_buffer.flush();
         return _dev->flush();
     }
@@ -1060,11 +1453,64 @@ struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for re
         return _rx_buffer.flushToCommand();
     }
 
+    /*
+     * write() - write to the TX buffer, holding small writes to fill a packet
+     *
+     *  The whole buffer is always taken. Returns -1 if the device isn't connected.
+     */
     virtual int16_t write(const char *buffer, int16_t len) final {
         if (!isConnected()) {
             return -1;
         }
-        return _tx_buffer.write(buffer, len);
+        const bool line_end = (len > 0) && (buffer[len-1] == '\n');
+        if (line_end) {
+            xio_stats.tx_lines++;
+        }
+        if (!xio_tx_coalesce || isBinary()) {
+            _txSendPack();
+            _txSend(buffer, len);
+            return len;
+        }
+        for (int16_t taken = 0; taken < len; ) {
+            if (_tx_pack_len == 0) {
+                _tx_pack_start = cycle_count();
+            }
+            int16_t n = std::min((int16_t)(len - taken), (int16_t)(XIO_TX_PACKET_SIZE - _tx_pack_len));
+            memcpy(&_tx_pack[_tx_pack_len], &buffer[taken], n);
+            _tx_pack_len += n;
+            taken += n;
+            if (_tx_pack_len == XIO_TX_PACKET_SIZE) {
+                _txSendPack();
+            }
+        }
+        if (line_end) {
+            _txSendPack();
+        }
+        return len;
+    }
+
+    virtual void txCallback(bool now) final {
+        if (_tx_pack_len && (now ||
+            ((cycle_count() - _tx_pack_start) > (uint32_t)XIO_TX_COALESCE_US * (SystemCoreClock / 1000000)))) {
+            _txSendPack();
+        }
+    }
+
+    void _txSendPack() {
+        if (_tx_pack_len) {
+            _txSend(_tx_pack, _tx_pack_len);
+            _tx_pack_len = 0;
+        }
+    }
+
+    // blocks until the TX buffer has taken it all, as xio_t::write() did
+    void _txSend(const char *buffer, int16_t len) {
+        xio_stats.tx_writes++;
+        while ((len > 0) && isConnected()) {
+            int16_t written = _tx_buffer.write(buffer, len);
+            buffer += written;
+            len -= written;
+        }
     }
 
     virtual char *readline(devflags_t limit_flags, uint16_t &size) final {
@@ -1076,6 +1522,31 @@ struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for re
         return NULL;
     };
 
+    virtual uint16_t readBytes(char *buffer, uint16_t size) final {
+        return _rx_buffer.readBytes(buffer, size);
+    };
+
+    virtual uint16_t rxSpace() final {
+        return (isConnected() ? _rx_buffer.space() : 0);
+    };
+
+    virtual uint16_t bufferBytes() final {
+        return (sizeof(_rx_buffer) + sizeof(_tx_buffer) + sizeof(_tx_pack));
+    };
+
+    virtual void sniff() final {
+        if (isConnected() && !isBinary()) {
+            _rx_buffer.sniffFromInterrupt();
+        }
+    };
+
+    virtual bool rxPending() final {
+        if (!isConnected()) {
+            return false;
+        }
+        return (isBinary() ? _rx_buffer.hasBytes() : _rx_buffer.hasPending());
+    };
+
     void connectedStateChanged(bool connected) {
         if (connected) {
             if (isNotConnected()) {
@@ -1099,6 +1570,10 @@ struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for re
 
                 setAsConnectedAndReady();
 
+                if (isBinary()) {               // the binary channel takes no CTRL or DATA role
+                    return;
+                }
+
                 if (isAlwaysDataAndCtrl()) {    // Case 1 (ignoring others)
                     setActive();
                     controller_set_connected(true);
@@ -1139,6 +1614,7 @@ struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for re
             } // flags & DEV_IS_DISCONNECTED
 
         } else { // disconnected
+            _tx_pack_len = 0;                       // don't send a stale response to the next connection
             if (isConnected()) {
 
                 //USB0 has just disconnected
@@ -1226,12 +1702,14 @@ struct xioFlashFileDeviceWrapper : xioDeviceWrapperBase {    // describes a devi
         // to flush the file, just forget about it
         // next time it's used it'll get reset
         _current_file = nullptr;
+        eta_file_end();
         cs.responses_suppressed = false;
     }
 
     bool flushToCommand() final {
         // the end of the file is the next "command"
         _current_file = nullptr;
+        eta_file_end();
         cs.responses_suppressed = false;
         return false;
     }
@@ -1246,28 +1724,32 @@ struct xioFlashFileDeviceWrapper : xioDeviceWrapperBase {    // describes a devi
             return nullptr;
         }
 
-        const char *from = _current_file->readline(!(limit_flags & DEV_IS_DATA), line_size);
-        if ((nullptr == from) && (_current_file->isDone())) {
+        // the line is copied (and expanded, if the file is compressed) into the line buffer
+        char *line = _current_file->readline(!(limit_flags & DEV_IS_DATA), line_size, _line_buffer, _line_buffer_size - 1);
+        if ((nullptr == line) && (_current_file->isDone())) {
             // all done sending this file, "close" it
             _current_file = nullptr;
+            eta_file_end();
             cs.responses_suppressed = false;
             clearActive();
             return nullptr;
         }
-        char *dst_ptr = _line_buffer;
-
-        uint16_t count = std::min(line_size, uint16_t(_line_buffer_size - 2));
-
-        while (count--) {
-            *dst_ptr++ = *from++;
+        if (nullptr == line) {
+            return nullptr;     // not a control - wait for a data read
         }
-
-        // null-terminate the string
-        *dst_ptr = 0;
+        eta_file_line(_line_buffer);
 
         cs.responses_suppressed = true;
         return _line_buffer;
     };
+
+    uint16_t bufferBytes() final {
+        return sizeof(_line_buffer);
+    };
+
+    bool rxPending() final {
+        return (_current_file != nullptr);
+    };
 };
 
 xioFlashFileDeviceWrapper<> flashFileWrapper {};
@@ -1275,16 +1757,25 @@ xioFlashFileDeviceWrapper<> flashFileWrapper {};
 // ALLOCATIONS
 // Declare a device wrapper class for SerialUSB and SerialUSB1
 #if XIO_HAS_USB == 1
-xioDeviceWrapper<decltype(&SerialUSB)> serialUSB0Wrapper {
+xioDeviceWrapper<decltype(&SerialUSB), XIO_USB_RX_BUFFER_SIZE, XIO_USB_TX_BUFFER_SIZE> serialUSB0Wrapper {
     &SerialUSB,
     (DEV_CAN_READ | DEV_CAN_WRITE | DEV_CAN_BE_CTRL | DEV_CAN_BE_DATA)
 };
 #if USB_SERIAL_PORTS_EXPOSED == 2
-xioDeviceWrapper<decltype(&SerialUSB1)> serialUSB1Wrapper {
+#if BINARY_MOTION_ENABLED == true
+xioDeviceWrapper<decltype(&SerialUSB1), XIO_USB_RX_BUFFER_SIZE, XIO_USB_TX_BUFFER_SIZE> serialUSB1Wrapper {
+    &SerialUSB1,
+    (DEV_CAN_READ | DEV_CAN_WRITE | DEV_IS_BINARY)
+};
+#else
+xioDeviceWrapper<decltype(&SerialUSB1), XIO_USB_RX_BUFFER_SIZE, XIO_USB_TX_BUFFER_SIZE> serialUSB1Wrapper {
     &SerialUSB1,
     (DEV_CAN_READ | DEV_CAN_WRITE | DEV_CAN_BE_CTRL | DEV_CAN_BE_DATA)
 };
 #endif
+#elif BINARY_MOTION_ENABLED == true
+#error BINARY_MOTION_ENABLED requires USB_SERIAL_PORTS_EXPOSED == 2
+#endif
 #endif // XIO_HAS_USB
 #if XIO_HAS_UART==1
 #if defined(XIO_UART_MUTES_WHEN_USB_CONNECTED) && (XIO_UART_MUTES_WHEN_USB_CONNECTED==1)
@@ -1292,11 +1783,27 @@ constexpr devflags_t _serial0ExtraFlags = DEV_IS_ALWAYS_BOTH | DEV_IS_MUTE_SECON
 #else
 constexpr devflags_t _serial0ExtraFlags = DEV_IS_ALWAYS_BOTH;
 #endif
-xioDeviceWrapper<decltype(&Serial)> serial0Wrapper {
+xioDeviceWrapper<decltype(&Serial), XIO_UART_RX_BUFFER_SIZE, XIO_UART_TX_BUFFER_SIZE> serial0Wrapper {
     &Serial,
     (DEV_CAN_READ | DEV_CAN_WRITE | _serial0ExtraFlags)
 };
 #endif // XIO_HAS_UART
+#if XIO_HAS_NET == 1
+// Network clients take roles just like the USB endpoints - see connectedStateChanged()
+#if (XIO_NET_CLIENTS < 1) || (XIO_NET_CLIENTS > 2)
+#error XIO_NET_CLIENTS must be 1 or 2
+#endif
+xioDeviceWrapper<decltype(&NetClient0), XIO_NET_RX_BUFFER_SIZE, XIO_NET_TX_BUFFER_SIZE> net0Wrapper {
+    &NetClient0,
+    (DEV_CAN_READ | DEV_CAN_WRITE | DEV_CAN_BE_CTRL | DEV_CAN_BE_DATA)
+};
+#if XIO_NET_CLIENTS == 2
+xioDeviceWrapper<decltype(&NetClient1), XIO_NET_RX_BUFFER_SIZE, XIO_NET_TX_BUFFER_SIZE> net1Wrapper {
+    &NetClient1,
+    (DEV_CAN_READ | DEV_CAN_WRITE | DEV_CAN_BE_CTRL | DEV_CAN_BE_DATA)
+};
+#endif
+#endif // XIO_HAS_NET
 
 // Define the xio singleton (and initialize it to hold our two deviceWrappers)
 //xio_t xio = { &serialUSB0Wrapper, &serialUSB1Wrapper };
@@ -1308,6 +1815,12 @@ xio_t xio = {
     &serialUSB1Wrapper,
 #endif
 #endif // XIO_HAS_USB
+#if XIO_HAS_NET == 1
+    &net0Wrapper,
+#if XIO_NET_CLIENTS == 2
+    &net1Wrapper,
+#endif
+#endif // XIO_HAS_NET
 #if XIO_HAS_UART == 1
     &serial0Wrapper
 #endif
@@ -1328,6 +1841,11 @@ xio_t xio = {
  *  http://www.cprogramming.com/c++11/c++11-lambda-closures.html
  */
 
+// Priority lane sniffer - see LineRXBuffer
+Motate::SysTickEvent xio_sniff_systick_event {[&] {
+    xio.sniff();
+}, nullptr};
+
 void xio_init()
 {
     board_xio_init();
@@ -1338,9 +1856,28 @@ void xio_init()
     serialUSB1Wrapper.init();
 #endif
 #endif
+#if XIO_HAS_NET == 1
+    net0Wrapper.init();
+#if XIO_NET_CLIENTS == 2
+    net1Wrapper.init();
+#endif
+#endif
 #if XIO_HAS_UART == 1
     serial0Wrapper.init();
 #endif
+    SysTickTimer.registerEvent(&xio_sniff_systick_event);
+}
+
+/*
+ * xio_callback() - pass on held TX packets - see xioStats
+ */
+
+stat_t xio_callback()
+{
+    if (xio_tx_coalesce) {
+        xio.txCallback(false);
+    }
+    return (STAT_OK);
 }
 
 stat_t xio_test_assertions()
@@ -1357,6 +1894,7 @@ stat_t xio_test_assertions()
 
 size_t xio_write(const char *buffer, size_t size, bool only_to_muted /*= false*/)
 {
+    ldScope _ld(LOAD_COMMS);
     return xio.write(buffer, size, only_to_muted);
 }
 
@@ -1369,14 +1907,53 @@ size_t xio_write(const char *buffer, size_t size, bool only_to_muted /*= false*/
 
 char *xio_readline(devflags_t &flags, uint16_t &size)
 {
-    return xio.readline(flags, size);
+    ldScope _ld(LOAD_COMMS);
+    char *line = xio.readline(flags, size);
+    CAPTURE_LINE(line);                         // see capture.h
+    return (line);
 }
 
 int16_t xio_writeline(const char *buffer, bool only_to_muted /*= false*/)
 {
+    ldScope _ld(LOAD_COMMS);
     return xio.writeline(buffer, only_to_muted);
 }
 
+/*
+ * xio_get_rx_space() - bytes the active data device can receive before its RX buffer is full
+ */
+
+uint16_t xio_get_rx_space()
+{
+    return xio.rxSpace();
+}
+
+/*
+ * xio_rx_pending() - true if any device has input a readline() could act on
+ */
+
+bool xio_rx_pending()
+{
+    return xio.rxPending();
+}
+
+#if BINARY_MOTION_ENABLED == true
+/*
+ * xio_read_binary()  - read raw bytes from the binary motion channel (SerialUSB1)
+ * xio_write_binary() - write raw bytes to the binary motion channel
+ */
+
+uint16_t xio_read_binary(char *buffer, uint16_t size)
+{
+    return xio.readBinary(buffer, size);
+}
+
+size_t xio_write_binary(const char *buffer, size_t size)
+{
+    return xio.writeBinary(buffer, size);
+}
+#endif
+
 /*
  * write() - return true of the device is currently "connected" (there's a fair bit of interpretation)
  */
@@ -1391,7 +1968,19 @@ bool xio_connected()
  */
 
 bool xio_send_file(xio_flash_file &file) {
-    return flashFileWrapper.sendFile(file);
+    if (!flashFileWrapper.sendFile(file)) {
+        return false;
+    }
+    eta_file_start(file);
+    return true;
+}
+
+/*
+ * xio_file_is_sending() - true until the last line of the file has been read, or it's flushed
+ */
+
+bool xio_file_is_sending(const xio_flash_file &file) {
+    return (flashFileWrapper._current_file == &file);
 }
 
 /*
@@ -1448,6 +2037,40 @@ int _write( int file, char *ptr, int len )
 //    return (STAT_OK);
 //}
 
+/*
+ * xio_get_rxsb() - get RAM taken by the RX, TX and line buffers of all devices
+ * xio_set_rxs()  - clear all RX counters (the counters are read with get_int32)
+ */
+
+stat_t xio_get_rxsb(nvObj_t *nv)
+{
+    nv->value_int = xio.bufferBytes();
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t xio_set_rxs(nvObj_t *nv)
+{
+    memset(&xio_stats, 0, sizeof(xio_stats));
+    return (STAT_OK);
+}
+
+/*
+ * xio_get_txc() - get TX coalescing
+ * xio_set_txc() - set it - turning it off passes on any held packets
+ */
+
+stat_t xio_get_txc(nvObj_t *nv) { return (get_integer(nv, xio_tx_coalesce)); }
+
+stat_t xio_set_txc(nvObj_t *nv)
+{
+    ritorno(set_integer(nv, xio_tx_coalesce, 0, 1));
+    if (!xio_tx_coalesce) {
+        xio.txCallback(true);
+    }
+    return (STAT_OK);
+}
+
 /***********************************************************************************
  * TEXT MODE SUPPORT
  * Functions to print variables from the cfgArray table
@@ -1457,5 +2080,19 @@ int _write( int file, char *ptr, int len )
 
 static const char fmt_spi[] = "[spi] SPI state%20d [0=disabled,1=enabled]\n";
 void xio_print_spi(nvObj_t *nv) { text_print(nv, fmt_spi);} // TYPE_INT
+static const char fmt_rxsb[] = "[rxsb] buffer RAM%18d bytes\n";
+static const char fmt_rxsd[] = "[rxsd] lines dropped%15d\n";
+static const char fmt_rxsl[] = "[rxsl] lines too long%14d\n";
+static const char fmt_rxsf[] = "[rxsf] RX buffer full%14d ms\n";
+void xio_print_rxsb(nvObj_t *nv) { text_print(nv, fmt_rxsb);} // TYPE_INT
+void xio_print_rxsd(nvObj_t *nv) { text_print(nv, fmt_rxsd);} // TYPE_INT
+void xio_print_rxsl(nvObj_t *nv) { text_print(nv, fmt_rxsl);} // TYPE_INT
+void xio_print_rxsf(nvObj_t *nv) { text_print(nv, fmt_rxsf);} // TYPE_INT
+static const char fmt_rxsw[] = "[rxsw] TX writes%19d\n";
+static const char fmt_rxsr[] = "[rxsr] TX lines%20d\n";
+static const char fmt_txc[]  = "[txc]  TX coalescing%15d [0=off,1=on]\n";
+void xio_print_rxsw(nvObj_t *nv) { text_print(nv, fmt_rxsw);} // TYPE_INT
+void xio_print_rxsr(nvObj_t *nv) { text_print(nv, fmt_rxsr);} // TYPE_INT
+void xio_print_txc(nvObj_t *nv)  { text_print(nv, fmt_txc);}  // TYPE_INT
 
 #endif // __TEXT_MODE
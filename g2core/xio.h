@@ -71,6 +71,7 @@ typedef uint16_t devflags_t;                // might need to bump to 32 be 16 or
 #define DEV_IS_MUTE_SECONDARY (0x0008)        // device is "muted" as a non-primary device
 #define DEV_CAN_READ          (0x0010)
 #define DEV_CAN_WRITE         (0x0020)
+#define DEV_IS_BINARY         (0x0040)        // device carries the binary motion channel, never text
 
 // Device state flags
 // channel state
@@ -96,6 +97,8 @@ enum xioDeviceEnum {                        // reconfigure this enum as you add
     DEV_USB0=0,                             // must be 0
     DEV_USB1,                               // must be 1
     DEV_UART1,                              // must be 2
+    DEV_NET0,                               // network clients - see XIO_HAS_NET
+    DEV_NET1,
 //  DEV_SPI0,                               // We can't have it here until we actually define it
     DEV_FLASH_FILE,                         // must be 0
     DEV_MAX
@@ -111,21 +114,57 @@ enum xioSPIMode {
 
 #define RX_BUFFER_SIZE       512            // maximum length of recieved lines from xio_readline
 
+/*
+ * xioStats - RX and TX counters, totalled over all devices
+ *
+ *  Each device's RX, TX and line buffer sizes are set in board_xio.h (see XIO_USB_RX_BUFFER_SIZE
+ *  and friends). These counters, and the RAM the buffers take, are reported in the {rxs:n} group
+ *  so the sizes can be chosen for a streaming workload. Setting any counter clears them all.
+ *
+ *  TX coalescing {txc:1} packs the many small writes that make up a response (the serialized
+ *  JSON, its footer, log lines) into XIO_TX_PACKET_SIZE byte packets before they reach the
+ *  device's TX buffer, so each response goes out in as few USB transfers as it can. A packet
+ *  is passed on when it fills, when a write ends a line, or when it has waited XIO_TX_COALESCE_US
+ *  (from xio_callback()). {rxsw:} / {rxsr:} is the writes per response - compare it with
+ *  {txc:0}. Binary channel writes are never held.
+ */
+typedef struct xioStats {
+    uint32_t lines_dropped;                 // complete lines thrown away by a flush or disconnect
+    uint32_t lines_too_long;                // lines split because they didn't fit the line buffer
+    uint32_t rx_full_ms;                    // time an RX buffer has spent full - flow control stalls
+    uint32_t tx_writes;                     // writes passed to a device's TX buffer
+    uint32_t tx_lines;                      // lines written - responses, reports and the like
+} xioStats_t;
+
+extern xioStats_t xio_stats;
+extern uint8_t xio_tx_coalesce;             // {txc: hold small writes to fill a packet
+
 /**** function prototypes ****/
 
 void xio_init(void);
 stat_t xio_test_assertions(void);
+stat_t xio_callback(void);
 
 size_t xio_write(const char *buffer, size_t size, bool only_to_muted = false);
 char *xio_readline(devflags_t &flags, uint16_t &size);
 int16_t xio_writeline(const char *buffer, bool only_to_muted = false);
+uint16_t xio_get_rx_space(void);
+bool xio_rx_pending(void);
 bool xio_connected();
 void xio_flush_to_command();
 #if MARLIN_COMPAT_ENABLED == true
 void xio_exit_fake_bootloader();
 #endif
+#if BINARY_MOTION_ENABLED == true
+uint16_t xio_read_binary(char *buffer, uint16_t size);
+size_t xio_write_binary(const char *buffer, size_t size);
+#endif
 
 stat_t xio_set_spi(nvObj_t *nv);
+stat_t xio_get_rxsb(nvObj_t *nv);
+stat_t xio_set_rxs(nvObj_t *nv);
+stat_t xio_get_txc(nvObj_t *nv);
+stat_t xio_set_txc(nvObj_t *nv);
 
 /**** newlib-nano support function(s) ****/
 extern "C" {
@@ -165,25 +204,66 @@ extern "C" {
 #define CHAR_QUEUE_FLUSH (char)'%'  // Feedhold Exit and Flush  
 
 /**** xio_flash_file - object to hold in-flash (compiled-in) "files" to run ****/
+/*
+ *  A flash file is either plain text, or text compressed by byte pair encoding with
+ *  Resources/gcode/compress_gcode.py. In a compressed file, bytes 0x80-0xFF stand for the
+ *  pair of bytes at pairs[2*(b-0x80)], each of which may itself be a pair, up to
+ *  XIO_FLASH_PAIR_DEPTH deep. They are expanded on a small stack as the file is read, so
+ *  decoding needs no RAM window and no more than a table lookup per byte. G-code typically
+ *  compresses to 40-50% of its size.
+ *
+ *  readline() copies the next line into the caller's buffer, without the newline, and
+ *  truncates it to buffer_size-1 characters. It returns nullptr if there is no line, or if
+ *  control_only is set and the next line isn't a control.
+ */
+
+#define XIO_FLASH_PAIRS 128                 // pair codes 0x80-0xFF
+#define XIO_FLASH_PAIR_DEPTH 12             // deepest nesting of pairs - the encoder keeps to it
 
 struct xio_flash_file {
     const char * const _data;
-    const int32_t _length;
+    const int32_t _length;                  // bytes of _data - compressed bytes if _pairs is set
+    const uint8_t * const _pairs;           // pair table, nullptr for a plain text file
 
     int32_t _read_offset = 0;
+    uint8_t _stack[XIO_FLASH_PAIR_DEPTH+1]; // bytes being expanded, next one on top
+    uint8_t _sp = 0;
 
-    xio_flash_file(const char * const data, int32_t length) : _data{data}, _length{length} {};
+    xio_flash_file(const char * const data, int32_t length, const uint8_t * const pairs = nullptr) :
+        _data{data}, _length{length}, _pairs{pairs} {};
 
     void reset() {
         _read_offset = 0;
+        _sp = 0;
+    };
+
+    int16_t _next(bool consume) {           // next character, or -1 at the end of the file
+        if (_pairs == nullptr) {
+            if (_read_offset == _length) { return -1; }
+            return ((uint8_t)(consume ? _data[_read_offset++] : _data[_read_offset]));
+        }
+        while (true) {
+            if (_sp == 0) {
+                if (_read_offset == _length) { return -1; }
+                _stack[_sp++] = _data[_read_offset++];
+            }
+            uint8_t c = _stack[_sp-1];
+            if (c < 0x80) {
+                if (consume) { _sp--; }
+                return (c);
+            }
+            const uint8_t *pair = &_pairs[(c - 0x80) * 2];
+            _stack[_sp-1] = pair[1];
+            _stack[_sp++] = pair[0];
+        }
     };
 
-    const char *readline(bool control_only, uint16_t &line_size) {
+    char *readline(bool control_only, uint16_t &line_size, char *buffer, uint16_t buffer_size) {
         line_size = 0;
-        if (_read_offset == _length) { return nullptr; }
+        if (isDone()) { return nullptr; }
 
         if (control_only) {
-            char c = _data[_read_offset];
+            char c = _next(false);
             if (!
                 ((c == '!')         ||
                  (c == '~')         ||
@@ -197,44 +277,59 @@ struct xio_flash_file {
             }
         }
 
-        const char *line_start = _data + _read_offset;
-
-        while (_read_offset < _length) {
-            char c = _data[_read_offset++];
-
-            if (c == '\n') {
-                break;
+        int16_t c;
+        while (((c = _next(true)) >= 0) && (c != '\n')) {
+            if (line_size < buffer_size-1) {
+                buffer[line_size++] = c;
             }
-
-            line_size++;
         }
-
-        return line_start;
+        buffer[line_size] = NUL;
+        return buffer;
     };
 
     bool isDone() {
-        return _read_offset == _length;
+        return ((_read_offset == _length) && (_sp == 0));
     }
 };
 
-/**** convenience function to construct a xio_flash_file ****/
+/**** convenience functions to construct a xio_flash_file ****/
 
 template <int32_t length>
 constexpr xio_flash_file make_xio_flash_file(const char (&data)[length]) {
     return {data, length};
 }
 
+template <int32_t length>
+xio_flash_file make_xio_flash_file(const uint8_t (&data)[length], const uint8_t (&pairs)[XIO_FLASH_PAIRS*2]) {
+    return {(const char *)data, length, pairs};
+}
+
 /**** function prototype for file-sending ****/
 
 bool xio_send_file(xio_flash_file &file);
+bool xio_file_is_sending(const xio_flash_file &file);
 
 #ifdef __TEXT_MODE
 
     void xio_print_spi(nvObj_t *nv);
+    void xio_print_rxsb(nvObj_t *nv);
+    void xio_print_rxsd(nvObj_t *nv);
+    void xio_print_rxsl(nvObj_t *nv);
+    void xio_print_rxsf(nvObj_t *nv);
+    void xio_print_rxsw(nvObj_t *nv);
+    void xio_print_rxsr(nvObj_t *nv);
+    void xio_print_txc(nvObj_t *nv);
 
 #else
 
     #define xio_print_spi tx_print_stub
+    #define xio_print_rxsb tx_print_stub
+    #define xio_print_rxsd tx_print_stub
+    #define xio_print_rxsl tx_print_stub
+    #define xio_print_rxsf tx_print_stub
+    #define xio_print_rxsw tx_print_stub
+    #define xio_print_rxsr tx_print_stub
+    #define xio_print_txc tx_print_stub
 
 #endif // __TEXT_MODE
 